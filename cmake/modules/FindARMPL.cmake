@@ -0,0 +1,37 @@
+# - Try to find armpl - the ARM Performance Libraries
+# Once done this will define
+#  ARMPL_FOUND - System has armpl
+#  ARMPL_INCLUDE_DIRS - The armpl include directories, providing the FFTW3 interface
+#  ARMPL_LIBRARIES - The libraries needed to use armpl
+
+find_path(ARMPL_INCLUDE_DIR
+            NAMES fftw3.h armpl.h
+            HINTS $ENV{ARMPL_DIR}/include
+            PATHS)
+
+find_library(ARMPL_LIBRARY
+            NAMES armpl_lp64 armpl
+            HINTS $ENV{ARMPL_DIR}/lib
+            PATHS)
+
+find_library(ARMPL_STATIC_LIBRARY
+            NAMES libarmpl_lp64.a libarmpl.a
+            HINTS $ENV{ARMPL_DIR}/lib
+            PATHS)
+
+set(ARMPL_LIBRARIES ${ARMPL_LIBRARY} -lm)
+set(ARMPL_STATIC_LIBRARIES ${ARMPL_STATIC_LIBRARY} -lm)
+set(ARMPL_INCLUDE_DIRS ${ARMPL_INCLUDE_DIR})
+
+include(FindPackageHandleStandardArgs)
+# handle the QUIETLY and REQUIRED arguments and set ARMPL_FOUND to TRUE
+# if all listed variables are TRUE
+find_package_handle_standard_args(armpl  DEFAULT_MSG
+                                  ARMPL_LIBRARY ARMPL_INCLUDE_DIR)
+
+if(ARMPL_FOUND)
+  MESSAGE(STATUS "Found ARMPL_INCLUDE_DIRS: ${ARMPL_INCLUDE_DIRS}" )
+  MESSAGE(STATUS "Found ARMPL_LIBRARIES: ${ARMPL_LIBRARIES}" )
+endif(ARMPL_FOUND)
+
+mark_as_advanced(ARMPL_INCLUDE_DIR ARMPL_LIBRARY ARMPL_STATIC_LIBRARY)
@@ -0,0 +1,323 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Channel hub between one eNB and several UEs over the ZMQ or shared memory no-RF devices. Every subframe, the
+ * downlink of the eNB is broadcast to all UEs and the uplinks of all UEs are summed for the eNB, each link going
+ * through its own channel model. The UEs are split in groups, each served by its own thread.
+ *
+ * Example with shared memory, the eNB using "tx_name=enb_dl,rx_name=enb_ul" and the UE n using
+ * "tx_name=ue<n>_ul,rx_name=ue<n>_dl":
+ *   channel_hub -d shm -e tx_name=enb_ul,rx_name=enb_dl -u tx_name=ue%d_dl,rx_name=ue%d_ul -n 32 -w 4
+ */
+
+#include <memory>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#include "srslte/phy/channel/channel.h"
+#include "srslte/phy/rf/rf.h"
+#include "srslte/srslte.h"
+
+static const char* rf_devname  = "shm";
+static const char* enb_args    = "";
+static const char* ue_args_fmt = "";
+static uint32_t    nof_ues     = 1;
+static uint32_t    nof_workers = 1;
+static double      srate       = 23.04e6;
+static float       snr_dB      = NAN;
+static const char* fading      = "none";
+static float       delay_us    = 0.0f;
+
+static volatile bool go_exit = false;
+
+void usage(char* prog)
+{
+  printf("Usage: %s -e enb_args -u ue_args\n", prog);
+  printf("\t-d RF device name [Default %s]\n", rf_devname);
+  printf("\t-e RF args of the eNB side\n");
+  printf("\t-u RF args of the UE side, every %%d is replaced by the UE index\n");
+  printf("\t-n Number of UEs [Default %d]\n", nof_ues);
+  printf("\t-w Number of worker threads, each serving a group of UEs [Default %d]\n", nof_workers);
+  printf("\t-s Sampling rate [Default %.2f MHz]\n", srate / 1e6);
+  printf("\t-S AWGN SNR in dB [Default disabled]\n");
+  printf("\t-f Fading model (none, epa5, eva70, etu300, ...) [Default %s]\n", fading);
+  printf("\t-D Propagation delay in us [Default disabled]\n");
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "deunwsSfD")) != -1) {
+    switch (opt) {
+      case 'd':
+        rf_devname = argv[optind];
+        break;
+      case 'e':
+        enb_args = argv[optind];
+        break;
+      case 'u':
+        ue_args_fmt = argv[optind];
+        break;
+      case 'n':
+        nof_ues = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'w':
+        nof_workers = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        srate = strtod(argv[optind], NULL);
+        break;
+      case 'S':
+        snr_dB = strtof(argv[optind], NULL);
+        break;
+      case 'f':
+        fading = argv[optind];
+        break;
+      case 'D':
+        delay_us = strtof(argv[optind], NULL);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  if (strlen(enb_args) == 0 || strlen(ue_args_fmt) == 0 || nof_ues == 0 || nof_workers == 0) {
+    usage(argv[0]);
+    exit(-1);
+  }
+  nof_workers = SRSLTE_MIN(nof_workers, nof_ues);
+}
+
+void sig_int_handler(int signo)
+{
+  if (signo == SIGINT) {
+    go_exit = true;
+  }
+}
+
+/* Opens a hub side device. The hub forwards every sample with the timestamp it was received with, so it must not pad
+ * its Tx on reception as the eNB and UE do. */
+static int open_device(srslte_rf_t* rf, const char* args)
+{
+  char rf_args[RF_PARAM_LEN] = {};
+  snprintf(rf_args, RF_PARAM_LEN, "%s,tx_align=false", args);
+
+  if (srslte_rf_open_devname(rf, rf_devname, rf_args, 1)) {
+    ERROR("Error opening rf with args %s\n", rf_args);
+    return SRSLTE_ERROR;
+  }
+  srslte_rf_set_rx_srate(rf, srate);
+  srslte_rf_set_tx_srate(rf, srate);
+  return SRSLTE_SUCCESS;
+}
+
+static srslte::channel_ptr create_channel(uint32_t seed)
+{
+  srslte::channel::args_t args = {};
+  args.enable                  = true;
+  args.awgn_enable             = !isnan(snr_dB);
+  args.awgn_snr_dB             = snr_dB;
+  args.fading_enable           = strcmp(fading, "none") != 0;
+  args.fading_model            = fading;
+  args.delay_enable            = delay_us > 0.0f;
+  args.delay_min_us            = delay_us;
+  args.delay_max_us            = delay_us;
+
+  if (!args.awgn_enable && !args.fading_enable && !args.delay_enable) {
+    return nullptr;
+  }
+
+  srslte::channel_ptr ch = std::unique_ptr<srslte::channel>(new srslte::channel(args, 1, seed));
+  ch->set_srate((uint32_t)srate);
+  return ch;
+}
+
+typedef struct {
+  srslte_rf_t         rf;
+  srslte::channel_ptr dl_channel;
+  srslte::channel_ptr ul_channel;
+  cf_t*               dl_buffer;
+  cf_t*               ul_buffer;
+} ue_link_t;
+
+typedef struct {
+  std::vector<ue_link_t*> ues;
+  cf_t*                   ul_sum;
+  pthread_t               thread;
+} worker_t;
+
+// Shared between the main thread and the workers, only written by the main thread between barriers
+static cf_t*              dl_buffer = NULL;
+static uint32_t           sf_len    = 0;
+static srslte_timestamp_t sf_time   = {};
+static bool               stop      = false;
+static pthread_barrier_t  sf_start;
+static pthread_barrier_t  sf_end;
+
+static void* worker_thread(void* arg)
+{
+  worker_t* w = (worker_t*)arg;
+
+  while (true) {
+    pthread_barrier_wait(&sf_start);
+    if (stop) {
+      break;
+    }
+
+    // Downlink broadcast to every UE of the group first, so that all of them can progress
+    for (ue_link_t* ue : w->ues) {
+      cf_t* buffer = dl_buffer;
+      if (ue->dl_channel) {
+        cf_t* in[SRSLTE_MAX_CHANNELS]  = {dl_buffer};
+        cf_t* out[SRSLTE_MAX_CHANNELS] = {ue->dl_buffer};
+        ue->dl_channel->run(in, out, sf_len, sf_time);
+        buffer = ue->dl_buffer;
+      }
+      srslte_rf_send_timed2(&ue->rf, buffer, sf_len, sf_time.full_secs, sf_time.frac_secs, false, false);
+    }
+
+    // Uplink sum of the group
+    srslte_vec_cf_zero(w->ul_sum, sf_len);
+    for (ue_link_t* ue : w->ues) {
+      srslte_rf_recv_with_time(&ue->rf, ue->ul_buffer, sf_len, true, NULL, NULL);
+      if (ue->ul_channel) {
+        cf_t* inout[SRSLTE_MAX_CHANNELS] = {ue->ul_buffer};
+        ue->ul_channel->run(inout, inout, sf_len, sf_time);
+      }
+      srslte_vec_sum_ccc(w->ul_sum, ue->ul_buffer, w->ul_sum, sf_len);
+    }
+
+    pthread_barrier_wait(&sf_end);
+  }
+
+  return NULL;
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  signal(SIGINT, sig_int_handler);
+
+  sf_len = (uint32_t)(srate / 1000);
+
+  srslte_rf_t enb_rf;
+  if (open_device(&enb_rf, enb_args)) {
+    exit(-1);
+  }
+
+  dl_buffer       = srslte_vec_cf_malloc(sf_len);
+  cf_t* ul_buffer = srslte_vec_cf_malloc(sf_len);
+  if (!dl_buffer || !ul_buffer) {
+    perror("malloc");
+    exit(-1);
+  }
+
+  // Create the UE links and distribute them over the workers
+  std::vector<ue_link_t> ues(nof_ues);
+  std::vector<worker_t>  workers(nof_workers);
+  for (uint32_t i = 0; i < nof_ues; i++) {
+    char args[RF_PARAM_LEN] = {};
+    // The format may use the UE index several times
+    snprintf(args, RF_PARAM_LEN, ue_args_fmt, i, i, i, i);
+
+    ue_link_t* ue = &ues[i];
+    if (open_device(&ue->rf, args)) {
+      exit(-1);
+    }
+    // Every link gets its own seed so that the UEs see independent channels
+    ue->dl_channel = create_channel(2 * i);
+    ue->ul_channel = create_channel(2 * i + 1);
+    ue->dl_buffer  = srslte_vec_cf_malloc(sf_len);
+    ue->ul_buffer  = srslte_vec_cf_malloc(sf_len);
+    if (!ue->dl_buffer || !ue->ul_buffer) {
+      perror("malloc");
+      exit(-1);
+    }
+    workers[i % nof_workers].ues.push_back(ue);
+  }
+
+  pthread_barrier_init(&sf_start, NULL, nof_workers + 1);
+  pthread_barrier_init(&sf_end, NULL, nof_workers + 1);
+  for (worker_t& w : workers) {
+    w.ul_sum = srslte_vec_cf_malloc(sf_len);
+    if (!w.ul_sum) {
+      perror("malloc");
+      exit(-1);
+    }
+    if (pthread_create(&w.thread, NULL, worker_thread, &w)) {
+      perror("pthread_create");
+      exit(-1);
+    }
+  }
+
+  printf("Serving %d UEs with %d workers at %.2f MHz. Press Ctrl+C to exit\n", nof_ues, nof_workers, srate / 1e6);
+
+  uint64_t nof_sf = 0;
+  while (!go_exit) {
+    if (srslte_rf_recv_with_time(&enb_rf, dl_buffer, sf_len, true, &sf_time.full_secs, &sf_time.frac_secs) < 0) {
+      ERROR("Error receiving from eNB\n");
+      break;
+    }
+
+    pthread_barrier_wait(&sf_start);
+    pthread_barrier_wait(&sf_end);
+
+    srslte_vec_cf_copy(ul_buffer, workers[0].ul_sum, sf_len);
+    for (uint32_t i = 1; i < nof_workers; i++) {
+      srslte_vec_sum_ccc(ul_buffer, workers[i].ul_sum, ul_buffer, sf_len);
+    }
+
+    if (srslte_rf_send_timed2(&enb_rf, ul_buffer, sf_len, sf_time.full_secs, sf_time.frac_secs, false, false) < 0) {
+      ERROR("Error sending to eNB\n");
+      break;
+    }
+    nof_sf++;
+  }
+
+  // Release the workers
+  stop = true;
+  pthread_barrier_wait(&sf_start);
+  for (worker_t& w : workers) {
+    pthread_join(w.thread, NULL);
+    free(w.ul_sum);
+  }
+  pthread_barrier_destroy(&sf_start);
+  pthread_barrier_destroy(&sf_end);
+
+  for (ue_link_t& ue : ues) {
+    srslte_rf_close(&ue.rf);
+    free(ue.dl_buffer);
+    free(ue.ul_buffer);
+  }
+  srslte_rf_close(&enb_rf);
+  free(dl_buffer);
+  free(ul_buffer);
+
+  printf("Forwarded %" PRIu64 " subframes\n", nof_sf);
+  exit(0);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Plans offline, without time limit, every DFT the eNodeB uses for all the bandwidths up to a number of PRB and
+ * stores the resulting FFTW wisdom. Installing the output as the system-wide wisdom file makes the planning at start-up
+ * and at cell reconfiguration immediate.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "srslte/srslte.h"
+
+static uint32_t max_prb        = SRSLTE_MAX_PRB;
+static char*    output_file    = "/etc/srslte/fftwisdom";
+static double   time_limit_s   = -1.0;
+static bool     standard_rates = false;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [pots]\n", prog);
+  printf("\t-p maximum number of PRB [Default %d]\n", max_prb);
+  printf("\t-o output wisdom file [Default %s]\n", output_file);
+  printf("\t-t planning time limit per transform in seconds, negative for none [Default %.1f]\n", time_limit_s);
+  printf("\t-s use standard LTE sampling rates [Default %s]\n", standard_rates ? "yes" : "no");
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "pots")) != -1) {
+    switch (opt) {
+      case 'p':
+        max_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'o':
+        output_file = argv[optind];
+        break;
+      case 't':
+        time_limit_s = strtod(argv[optind], NULL);
+        break;
+      case 's':
+        standard_rates = true;
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  srslte_dft_precoding_t precoding = {};
+
+  parse_args(argc, argv);
+
+  srslte_use_standard_symbol_size(standard_rates);
+  srslte_dft_set_plan_time_limit(time_limit_s);
+
+  // OFDM modulators and demodulators
+  if (srslte_enb_dl_preplan(max_prb) || srslte_enb_ul_preplan(max_prb)) {
+    ERROR("Error planning OFDM transforms for %d PRB\n", max_prb);
+    exit(-1);
+  }
+
+  // Transform precoding
+  for (uint32_t i = 0; i < 2; i++) {
+    if (srslte_dft_precoding_init(&precoding, max_prb, i == 0)) {
+      ERROR("Error planning transform precoding for %d PRB\n", max_prb);
+      exit(-1);
+    }
+    srslte_dft_precoding_free(&precoding);
+  }
+
+  if (srslte_dft_export_wisdom(output_file)) {
+    ERROR("Error writing wisdom file %s\n", output_file);
+    exit(-1);
+  }
+
+  printf("Wisdom for up to %d PRB written to %s\n", max_prb, output_file);
+
+  exit(0);
+}
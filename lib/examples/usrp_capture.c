@@ -40,6 +40,17 @@ char*       rf_args = "";
 float       rf_gain = 40.0, rf_freq = -1.0, rf_rate = 0.96e6;
 int         nof_samples     = -1;
 int         nof_rx_antennas = 1;
+char*       sample_format   = "cf32";
+
+static srslte_datatype_t parse_sample_format(const char* str)
+{
+  if (strcmp(str, "sc16") == 0) {
+    return SRSLTE_COMPLEX_SHORT_BIN;
+  } else if (strcmp(str, "sc8") == 0) {
+    return SRSLTE_COMPLEX_BYTE_BIN;
+  }
+  return SRSLTE_COMPLEX_FLOAT_BIN;
+}
 
 void int_handler(int dummy)
 {
@@ -54,13 +65,14 @@ void usage(char* prog)
   printf("\t-r RF Rate [Default %.6f Hz]\n", rf_rate);
   printf("\t-n nof_samples [Default %d]\n", nof_samples);
   printf("\t-A nof_rx_antennas [Default %d]\n", nof_rx_antennas);
+  printf("\t-t sample format in the file: cf32, sc16 or sc8 [Default %s]\n", sample_format);
   printf("\t-v srslte_verbose\n");
 }
 
 void parse_args(int argc, char** argv)
 {
   int opt;
-  while ((opt = getopt(argc, argv, "agrnvfoA")) != -1) {
+  while ((opt = getopt(argc, argv, "agrnvfoAt")) != -1) {
     switch (opt) {
       case 'o':
         output_file_name = argv[optind];
@@ -83,6 +95,9 @@ void parse_args(int argc, char** argv)
       case 'A':
         nof_rx_antennas = (int)strtol(argv[optind], NULL, 10);
         break;
+      case 't':
+        sample_format = argv[optind];
+        break;
       case 'v':
         srslte_verbose++;
         break;
@@ -120,7 +135,15 @@ int main(int argc, char** argv)
     }
   }
 
-  srslte_filesink_init(&sink, output_file_name, SRSLTE_COMPLEX_FLOAT_BIN);
+  if (srslte_filesink_init(&sink, output_file_name, parse_sample_format(sample_format))) {
+    exit(-1);
+  }
+
+  // Write the file in another thread, so the reception doesn't wait for the disk
+  if (srslte_filesink_set_async(&sink, 8 * 1024 * 1024)) {
+    ERROR("Error starting the file writer\n");
+    exit(-1);
+  }
 
   printf("Opening RF device...\n");
   if (srslte_rf_open_multi(&rf, rf_args, nof_rx_antennas)) {
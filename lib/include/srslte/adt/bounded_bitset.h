@@ -114,15 +114,9 @@ public:
   {
     assert_within_bounds_(startpos, false);
     assert_within_bounds_(endpos, false);
-    // NOTE: can be optimized
-    if (value) {
-      for (size_t i = startpos; i < endpos; ++i) {
-        set_(i);
-      }
-    } else {
-      for (size_t i = startpos; i < endpos; ++i) {
-        reset_(i);
-      }
+    for (size_t w = first_word_(startpos, endpos); w < end_word_(startpos, endpos); ++w) {
+      word_t mask = word_mask_(w, startpos, endpos);
+      buffer[w]   = value ? (buffer[w] | mask) : (buffer[w] & ~mask);
     }
     return *this;
   }
@@ -156,9 +150,8 @@ public:
   {
     assert_within_bounds_(start, false);
     assert_within_bounds_(stop, false);
-    // NOTE: can be optimized
-    for (size_t i = start; i < stop; ++i) {
-      if (test_(i)) {
+    for (size_t w = first_word_(start, stop); w < end_word_(start, stop); ++w) {
+      if ((buffer[w] & word_mask_(w, start, stop)) != static_cast<word_t>(0)) {
         return true;
       }
     }
@@ -171,15 +164,76 @@ public:
   {
     size_t result = 0;
     for (size_t i = 0; i < nof_words_(); i++) {
-      //      result += __builtin_popcountl(buffer[i]);
-      word_t w = buffer[i];
-      for (; w; w >>= 1u) {
-        result += (w & 1u);
-      }
+      result += __builtin_popcountll(buffer[i]);
+    }
+    return result;
+  }
+
+  /// Number of set bits in [startpos, endpos)
+  size_t count(size_t startpos, size_t endpos) const
+  {
+    assert_within_bounds_(startpos, false);
+    assert_within_bounds_(endpos, false);
+    size_t result = 0;
+    for (size_t w = first_word_(startpos, endpos); w < end_word_(startpos, endpos); ++w) {
+      result += __builtin_popcountll(buffer[w] & word_mask_(w, startpos, endpos));
     }
     return result;
   }
 
+  /// Returns the lowest position in [startpos, endpos) whose bit is equal to value, or -1 if there is none
+  int find_lowest(size_t startpos, size_t endpos, bool value = true) const
+  {
+    assert_within_bounds_(startpos, false);
+    assert_within_bounds_(endpos, false);
+    if (startpos >= endpos) {
+      return -1;
+    }
+    if (not reversed) {
+      for (size_t w = first_word_(startpos, endpos); w < end_word_(startpos, endpos); ++w) {
+        word_t bits = (value ? buffer[w] : ~buffer[w]) & word_mask_(w, startpos, endpos);
+        if (bits != static_cast<word_t>(0)) {
+          return w * bits_per_word + __builtin_ctzll(bits);
+        }
+      }
+    } else {
+      // The lowest position is the highest bit in the buffer
+      for (size_t w = end_word_(startpos, endpos); w > first_word_(startpos, endpos); --w) {
+        word_t bits = (value ? buffer[w - 1] : ~buffer[w - 1]) & word_mask_(w - 1, startpos, endpos);
+        if (bits != static_cast<word_t>(0)) {
+          return size() - 1 - ((w - 1) * bits_per_word + bits_per_word - 1 - __builtin_clzll(bits));
+        }
+      }
+    }
+    return -1;
+  }
+
+  /// Returns the lowest position from startpos where len consecutive bits are zero, or -1 if there is none
+  int find_lowest_zeros(size_t len, size_t startpos = 0) const
+  {
+    while (startpos + len <= size()) {
+      int start = find_lowest(startpos, size(), false);
+      if (start < 0 or (size_t)start + len > size()) {
+        return -1;
+      }
+      int stop = find_lowest(start, start + len, true);
+      if (stop < 0) {
+        return start;
+      }
+      startpos = stop + 1;
+    }
+    return -1;
+  }
+
+  /// Calls f(pos) for the positions of the set bits, in increasing order
+  template <typename F>
+  void for_each(F&& f) const
+  {
+    for (int pos = find_lowest(0, size()); pos >= 0; pos = find_lowest(pos + 1, size())) {
+      f((size_t)pos);
+    }
+  }
+
   bool operator==(const bounded_bitset<N, reversed>& other) const noexcept
   {
     if (size() != other.size()) {
@@ -322,6 +376,27 @@ private:
 
   static word_t maskbit(size_t pos) { return (static_cast<word_t>(1)) << (pos % bits_per_word); }
 
+  // The word operations work on the buffer positions of [startpos, endpos), which are mirrored for a reversed bitset
+  size_t first_word_(size_t startpos, size_t endpos) const
+  {
+    return (reversed ? size() - endpos : startpos) / bits_per_word;
+  }
+
+  size_t end_word_(size_t startpos, size_t endpos) const
+  {
+    return startpos < endpos ? ((reversed ? size() - startpos : endpos) - 1) / bits_per_word + 1 : 0;
+  }
+
+  /// Bits of the word w that are in [startpos, endpos)
+  word_t word_mask_(size_t w, size_t startpos, size_t endpos) const
+  {
+    size_t first = reversed ? size() - endpos : startpos;
+    size_t last  = reversed ? size() - startpos : endpos;
+    size_t lo    = first > w * bits_per_word ? first - w * bits_per_word : 0;
+    size_t hi    = last - w * bits_per_word < bits_per_word ? last - w * bits_per_word : bits_per_word;
+    return (~static_cast<word_t>(0) >> (bits_per_word - (hi - lo))) << lo;
+  }
+
   static size_t max_nof_words_() { return (N - 1) / bits_per_word + 1; }
 };
 
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_MPSC_QUEUE_H
+#define SRSLTE_MPSC_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ *
+ * @file mpsc_queue.h
+ *
+ * @brief Bounded lock-free queue with multiple producers and a single consumer
+ *
+ * Every slot carries a sequence number that tells whether it is free for the producer of a given position or holds
+ * the element the consumer expects next. Producers claim a position with a CAS on the tail, so they never wait for
+ * each other or for the consumer, and a push fails instead of blocking when the queue is full. Only one thread may
+ * pop at a time.
+ */
+
+namespace srslte {
+
+template <typename T>
+class mpsc_queue
+{
+public:
+  /// The capacity is rounded up to a power of two
+  explicit mpsc_queue(size_t capacity)
+  {
+    size_t n = 1;
+    while (n < capacity) {
+      n <<= 1u;
+    }
+    mask = n - 1;
+    slots.reset(new slot_t[n]);
+    for (size_t i = 0; i < n; ++i) {
+      slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+  mpsc_queue(const mpsc_queue&) = delete;
+  mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+  size_t capacity() const { return mask + 1; }
+
+  /// Number of elements, including the ones still being written. Only exact when no push or pop is in progress
+  size_t size() const
+  {
+    auto n = (intptr_t)tail.load(std::memory_order_acquire) - (intptr_t)head.load(std::memory_order_acquire);
+    return n <= 0 ? 0 : std::min((size_t)n, capacity());
+  }
+  bool empty() const { return size() == 0; }
+
+  /// Called by any producer. Returns false if the queue is full, in which case t is not moved from
+  template <typename U>
+  bool try_push(U&& t)
+  {
+    size_t  pos = tail.load(std::memory_order_relaxed);
+    slot_t* s;
+    while (true) {
+      s           = &slots[pos & mask];
+      size_t seq  = s->seq.load(std::memory_order_acquire);
+      auto   diff = (intptr_t)seq - (intptr_t)pos;
+      if (diff == 0) {
+        if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+    s->data = std::forward<U>(t);
+    s->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Called by the consumer only. Returns false if the queue is empty or the next element is still being written
+  bool try_pop(T& t)
+  {
+    size_t  pos = head.load(std::memory_order_relaxed);
+    slot_t* s   = &slots[pos & mask];
+    if (s->seq.load(std::memory_order_acquire) != pos + 1) {
+      return false;
+    }
+    t = std::move(s->data);
+    s->seq.store(pos + mask + 1, std::memory_order_release);
+    head.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  struct slot_t {
+    std::atomic<size_t> seq;
+    T                   data;
+  };
+
+  std::unique_ptr<slot_t[]> slots;
+  size_t                    mask = 0;
+  // The tail is shared by the producers and the head is owned by the consumer, keep them in different cache lines
+  alignas(64) std::atomic<size_t> tail{0};
+  alignas(64) std::atomic<size_t> head{0};
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_MPSC_QUEUE_H
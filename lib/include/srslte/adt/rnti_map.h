@@ -0,0 +1,241 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_RNTI_MAP_H
+#define SRSLTE_RNTI_MAP_H
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ *
+ * @file rnti_map.h
+ *
+ * @brief Map from RNTI to T with O(1) lookup and contiguous iteration
+ *
+ * The elements are stored in blocks that are allocated once and recycled, so the address of an element does not
+ * change while it is in the map and inserting or erasing does not allocate memory in steady state. A dense array
+ * of pointers to the elements is used for iteration, and a table indexed by RNTI points into it. Erasing moves
+ * the last element of the dense array into the erased position, so the iteration order is not the RNTI order.
+ *
+ * The table covers the whole RNTI range and takes 128 KB in every instance, so the map is meant for the few
+ * long-lived per-carrier or per-cell UE containers, not for small or temporary sets of RNTIs.
+ */
+
+namespace srslte {
+
+template <typename T>
+class rnti_map
+{
+public:
+  using key_type   = uint16_t;
+  using value_type = std::pair<const uint16_t, T>;
+
+private:
+  static const uint16_t invalid_pos = UINT16_MAX;
+  static const size_t   block_size  = 32;
+
+  using storage_t = typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type;
+  using dense_t   = std::vector<value_type*>;
+
+  template <typename V, typename It>
+  class iter_impl
+  {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = V;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = V*;
+    using reference         = V&;
+
+    iter_impl() = default;
+    explicit iter_impl(It it_) : it(it_) {}
+    template <typename V2, typename It2>
+    iter_impl(const iter_impl<V2, It2>& other) : it(other.it)
+    {}
+
+    reference operator*() const { return **it; }
+    pointer   operator->() const { return *it; }
+    reference operator[](difference_type n) const { return *it[n]; }
+
+    iter_impl& operator++()
+    {
+      ++it;
+      return *this;
+    }
+    iter_impl operator++(int) { return iter_impl(it++); }
+    iter_impl& operator--()
+    {
+      --it;
+      return *this;
+    }
+    iter_impl operator--(int) { return iter_impl(it--); }
+    iter_impl& operator+=(difference_type n)
+    {
+      it += n;
+      return *this;
+    }
+    iter_impl& operator-=(difference_type n)
+    {
+      it -= n;
+      return *this;
+    }
+    iter_impl       operator+(difference_type n) const { return iter_impl(it + n); }
+    iter_impl       operator-(difference_type n) const { return iter_impl(it - n); }
+    difference_type operator-(const iter_impl& other) const { return it - other.it; }
+    bool            operator==(const iter_impl& other) const { return it == other.it; }
+    bool            operator!=(const iter_impl& other) const { return it != other.it; }
+    bool            operator<(const iter_impl& other) const { return it < other.it; }
+
+  private:
+    template <typename V2, typename It2>
+    friend class iter_impl;
+    friend class rnti_map;
+    It it;
+  };
+
+public:
+  using iterator       = iter_impl<value_type, typename dense_t::iterator>;
+  using const_iterator = iter_impl<const value_type, typename dense_t::const_iterator>;
+
+  rnti_map() : pos(UINT16_MAX + 1, invalid_pos) {}
+  rnti_map(const rnti_map&) = delete;
+  /// The moved-from map is left empty and usable
+  rnti_map(rnti_map&& other) : rnti_map() { swap(other); }
+  rnti_map& operator=(const rnti_map&) = delete;
+  /// The elements of this map are destroyed before taking the ones of other, which is left empty and usable
+  rnti_map& operator=(rnti_map&& other)
+  {
+    if (this != &other) {
+      clear();
+      swap(other);
+    }
+    return *this;
+  }
+  ~rnti_map() { clear(); }
+
+  void swap(rnti_map& other)
+  {
+    pos.swap(other.pos);
+    dense.swap(other.dense);
+    free_list.swap(other.free_list);
+    blocks.swap(other.blocks);
+  }
+
+  size_t size() const { return dense.size(); }
+  bool   empty() const { return dense.empty(); }
+
+  /// Iteration follows the insertion order, as changed by the erased elements, not the RNTI order
+  iterator       begin() { return iterator(dense.begin()); }
+  iterator       end() { return iterator(dense.end()); }
+  const_iterator begin() const { return const_iterator(dense.begin()); }
+  const_iterator end() const { return const_iterator(dense.end()); }
+
+  size_t count(uint16_t rnti) const { return pos[rnti] != invalid_pos ? 1 : 0; }
+
+  iterator find(uint16_t rnti)
+  {
+    return pos[rnti] != invalid_pos ? iterator(dense.begin() + pos[rnti]) : end();
+  }
+  const_iterator find(uint16_t rnti) const
+  {
+    return pos[rnti] != invalid_pos ? const_iterator(dense.begin() + pos[rnti]) : end();
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(uint16_t rnti, Args&&... args)
+  {
+    if (pos[rnti] != invalid_pos) {
+      return {iterator(dense.begin() + pos[rnti]), false};
+    }
+    if (free_list.empty()) {
+      alloc_block();
+    }
+    value_type* e = new (free_list.back()) value_type(std::piecewise_construct,
+                                                     std::forward_as_tuple(rnti),
+                                                     std::forward_as_tuple(std::forward<Args>(args)...));
+    free_list.pop_back();
+    pos[rnti] = (uint16_t)dense.size();
+    dense.push_back(e);
+    return {iterator(dense.end() - 1), true};
+  }
+
+  T& operator[](uint16_t rnti) { return emplace(rnti).first->second; }
+
+  size_t erase(uint16_t rnti)
+  {
+    if (pos[rnti] == invalid_pos) {
+      return 0;
+    }
+    // Move the last element into the hole to keep the dense array contiguous
+    uint16_t    idx        = pos[rnti];
+    value_type* e          = dense[idx];
+    dense[idx]             = dense.back();
+    pos[dense[idx]->first] = idx;
+    pos[rnti]              = invalid_pos;
+    dense.pop_back();
+
+    e->~value_type();
+    free_list.push_back(reinterpret_cast<storage_t*>(e));
+    return 1;
+  }
+
+  iterator erase(iterator it)
+  {
+    size_t idx = it.it - dense.begin();
+    erase((*it).first);
+    return iterator(dense.begin() + idx);
+  }
+
+  void clear()
+  {
+    while (not dense.empty()) {
+      erase(dense.back()->first);
+    }
+  }
+
+private:
+  void alloc_block()
+  {
+    blocks.emplace_back(new storage_t[block_size]);
+    for (size_t i = block_size; i > 0; --i) {
+      free_list.push_back(&blocks.back()[i - 1]);
+    }
+  }
+
+  std::vector<uint16_t>                     pos; ///< position of every RNTI in the dense array
+  dense_t                                   dense;
+  std::vector<storage_t*>                   free_list;
+  std::vector<std::unique_ptr<storage_t[]>> blocks;
+};
+
+template <typename T>
+const uint16_t rnti_map<T>::invalid_pos;
+
+} // namespace srslte
+
+#endif // SRSLTE_RNTI_MAP_H
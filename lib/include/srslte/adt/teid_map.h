@@ -0,0 +1,144 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_TEID_MAP_H
+#define SRSLTE_TEID_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ *
+ * @file teid_map.h
+ *
+ * @brief Map from locally allocated GTP TEIDs to T with O(1) lookup
+ *
+ * The map allocates the TEIDs itself, from a dense index space. The low bits of a TEID are the index of its slot and
+ * the high bits the generation of the slot, which is incremented every time the slot is reused. A lookup is an array
+ * access plus a comparison, and a TEID that was erased does not match the new owner of its slot. TEID 0 is never
+ * allocated. Pointers returned by find() are invalidated by emplace().
+ */
+
+namespace srslte {
+
+template <typename T>
+class teid_map
+{
+public:
+  static const uint32_t index_bits = 16;
+  static const uint32_t max_size   = 1u << index_bits;
+
+  size_t size() const { return count; }
+  bool   empty() const { return count == 0; }
+
+  /// Allocates a TEID for a T built from args. Returns 0 if all the TEIDs are in use
+  template <typename... Args>
+  uint32_t emplace(Args&&... args)
+  {
+    uint32_t idx;
+    if (not free_slots.empty()) {
+      idx = free_slots.back();
+      free_slots.pop_back();
+    } else if (slots.size() < max_size) {
+      idx = slots.size();
+      slots.emplace_back();
+    } else {
+      return 0;
+    }
+    slot_t& s = slots[idx];
+    if (++s.generation == 0) {
+      s.generation = 1;
+    }
+    s.teid  = ((uint32_t)s.generation << index_bits) | idx;
+    s.value = T(std::forward<Args>(args)...);
+    count++;
+    return s.teid;
+  }
+
+  T* find(uint32_t teid)
+  {
+    uint32_t idx = teid & index_mask;
+    if (idx >= slots.size() or slots[idx].teid != teid or teid == 0) {
+      return nullptr;
+    }
+    return &slots[idx].value;
+  }
+  const T* find(uint32_t teid) const { return const_cast<teid_map*>(this)->find(teid); }
+
+  bool erase(uint32_t teid)
+  {
+    if (find(teid) == nullptr) {
+      return false;
+    }
+    uint32_t idx     = teid & index_mask;
+    slots[idx].teid  = 0;
+    slots[idx].value = T();
+    free_slots.push_back(idx);
+    count--;
+    return true;
+  }
+
+  void clear()
+  {
+    for (uint32_t idx = 0; idx < slots.size(); ++idx) {
+      if (slots[idx].teid != 0) {
+        erase(slots[idx].teid);
+      }
+    }
+  }
+
+  /// Calls f(teid, value) for every element, in index order
+  template <typename F>
+  void for_each(F&& f)
+  {
+    for (slot_t& s : slots) {
+      if (s.teid != 0) {
+        f(s.teid, s.value);
+      }
+    }
+  }
+
+private:
+  static const uint32_t index_mask = max_size - 1;
+
+  struct slot_t {
+    uint32_t teid       = 0; ///< 0 while the slot is free
+    uint16_t generation = 0;
+    T        value{};
+  };
+
+  std::vector<slot_t>   slots;
+  std::vector<uint32_t> free_slots;
+  size_t                count = 0;
+};
+
+template <typename T>
+const uint32_t teid_map<T>::index_bits;
+template <typename T>
+const uint32_t teid_map<T>::max_size;
+template <typename T>
+const uint32_t teid_map<T>::index_mask;
+
+} // namespace srslte
+
+#endif // SRSLTE_TEID_MAP_H
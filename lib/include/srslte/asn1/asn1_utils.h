@@ -25,9 +25,11 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstddef>
 #include <cstring>
 #include <limits>
 #include <map>
+#include <new>
 #include <sstream>
 #include <stdarg.h> /* va_list, va_start, va_arg, va_end */
 #include <stdint.h>
@@ -135,6 +137,86 @@ public:
   SRSASN_CODE align_bytes_zero();
 };
 
+/************************
+      memory arena
+************************/
+
+/**
+ * Monotonic memory arena for the dynamic arrays of the ASN.1 types (dyn_array, dyn_seq_of, dyn_octstring, ext_array).
+ * While an arena_scope is active in a thread, the arrays allocated by that thread, e.g. while a message is unpacked or
+ * built for packing, take their memory from the current block of the arena instead of the heap. Each block counts its
+ * live allocations. The current block is rewound once they are all released, so the next message reuses the same
+ * memory, and a full block is freed when its last allocation is released. Objects may therefore outlive the scope and
+ * be destroyed from any thread, but the arena itself must only be used by the thread that owns it.
+ */
+class mem_arena
+{
+public:
+  explicit mem_arena(size_t block_size_ = ASN_16K);
+  mem_arena(const mem_arena&) = delete;
+  mem_arena& operator=(const mem_arena&) = delete;
+  ~mem_arena();
+
+  /// Returns nullptr if the allocation is too big for the blocks of the arena
+  void* allocate(size_t sz, void*& block);
+
+  struct block_t;
+
+private:
+  block_t* cur = nullptr;
+  size_t   block_size;
+};
+
+/// Makes the arrays allocated by this thread use the given arena until the scope is destroyed
+class arena_scope
+{
+public:
+  explicit arena_scope(mem_arena& arena);
+  arena_scope(const arena_scope&) = delete;
+  arena_scope& operator=(const arena_scope&) = delete;
+  ~arena_scope();
+
+private:
+  mem_arena* prev;
+};
+
+namespace detail {
+
+// Header in front of the arrays. block is nullptr if the array is on the heap
+struct alignas(std::max_align_t) array_header {
+  void*    block;
+  uint32_t count;
+};
+
+// Allocates sz bytes plus the header, from the arena of the thread if there is one
+array_header* allocate_array(size_t sz);
+void          deallocate_array(array_header* h);
+
+template <class T>
+T* new_array(uint32_t n)
+{
+  static_assert(alignof(T) <= alignof(array_header), "Over-aligned types are not supported by the ASN.1 arrays");
+  array_header* h = allocate_array(n * sizeof(T));
+  h->count        = n;
+  T* data         = reinterpret_cast<T*>(h + 1);
+  for (uint32_t i = 0; i < n; ++i) {
+    new (&data[i]) T;
+  }
+  return data;
+}
+
+template <class T>
+void delete_array(T* data)
+{
+  array_header* h = reinterpret_cast<array_header*>(data) - 1;
+  for (uint32_t i = 0; i < h->count; ++i) {
+    data[i].~T();
+  }
+  deallocate_array(h);
+}
+
+} // namespace detail
+
 /*********************
   function helpers
 *********************/
@@ -147,19 +229,19 @@ public:
   using const_iterator = const T*;
 
   dyn_array() = default;
-  explicit dyn_array(uint32_t new_size) : size_(new_size), cap_(new_size) { data_ = new T[size_]; }
+  explicit dyn_array(uint32_t new_size) : size_(new_size), cap_(new_size) { data_ = detail::new_array<T>(size_); }
   dyn_array(const dyn_array<T>& other) : dyn_array(&other[0], other.size_) {}
   dyn_array(const T* ptr, uint32_t nof_items)
   {
     size_ = nof_items;
     cap_  = nof_items;
-    data_ = new T[cap_];
+    data_ = detail::new_array<T>(cap_);
     std::copy(ptr, ptr + size_, data_);
   }
   ~dyn_array()
   {
     if (data_ != NULL) {
-      delete[] data_;
+      detail::delete_array(data_);
     }
   }
   uint32_t      size() const { return size_; }
@@ -187,7 +269,7 @@ public:
     T* old_data = data_;
     cap_        = new_size > new_cap ? new_size : new_cap;
     if (cap_ > 0) {
-      data_ = new T[cap_];
+      data_ = detail::new_array<T>(cap_);
       if (old_data != NULL) {
         std::copy(&old_data[0], &old_data[size_], data_);
       }
@@ -196,7 +278,7 @@ public:
     }
     size_ = new_size;
     if (old_data != NULL) {
-      delete[] old_data;
+      detail::delete_array(old_data);
     }
   }
   iterator erase(iterator it)
@@ -309,7 +391,7 @@ public:
   ~ext_array()
   {
     if (not is_in_small_buffer()) {
-      delete[] head;
+      detail::delete_array(head);
     }
   }
   ext_array<T, Nthres>& operator=(const ext_array<T, Nthres>& other)
@@ -349,11 +431,11 @@ public:
     }
     T*       old_data = head;
     uint32_t newcap   = new_size + 5;
-    head              = new T[newcap];
-    std::copy(&small_buffer.data[0], &small_buffer.data[size_], head);
+    head              = detail::new_array<T>(newcap);
+    std::copy(&old_data[0], &old_data[size_], head);
     size_ = new_size;
     if (old_data != &small_buffer.data[0]) {
-      delete[] old_data;
+      detail::delete_array(old_data);
     }
     small_buffer.cap_ = newcap;
   }
@@ -47,6 +47,7 @@ struct drb_to_add_mod_s;
 // mac
 struct sched_request_cfg_c;
 struct mac_main_cfg_s;
+struct drx_cfg_c;
 struct rach_cfg_common_s;
 struct time_align_timer_opts;
 struct ant_info_ded_s;
@@ -113,6 +114,7 @@ void set_mac_cfg_t_sched_request_cfg(mac_cfg_t* cfg, const asn1::rrc::sched_requ
 void set_mac_cfg_t_main_cfg(mac_cfg_t* cfg, const asn1::rrc::mac_main_cfg_s& asn1_type);
 void set_mac_cfg_t_rach_cfg_common(mac_cfg_t* cfg, const asn1::rrc::rach_cfg_common_s& asn1_type);
 void set_mac_cfg_t_time_alignment(mac_cfg_t* cfg, const asn1::rrc::time_align_timer_opts asn1_type);
+drx_cfg_t make_drx_cfg(const asn1::rrc::drx_cfg_c& asn1_type);
 
 srsenb::sched_interface::ant_info_ded_t make_ant_info_ded(const asn1::rrc::ant_info_ded_s& asn1_type);
 
@@ -23,6 +23,7 @@
 #define SRSLTE_BASIC_PNF_H
 
 #include "basic_vnf_api.h"
+#include "basic_vnf_shm.h"
 #include "common.h"
 #include "srslte/common/block_queue.h"
 #include "srslte/common/buffer_pool.h"
@@ -88,31 +89,42 @@ public:
 
   ~srslte_basic_pnf() { stop(); };
 
+  /// Exchanges the messages with a VNF in the same host through the shared-memory rings of the given name, instead of
+  /// UDP. Has to be called before start()
+  bool use_shm(const std::string& shm_name)
+  {
+    return tx_ring.open(basic_vnf_api::shm_ring_name(shm_name, false)) and
+           rx_ring.open(basic_vnf_api::shm_ring_name(shm_name, true));
+  }
+
   bool start()
   {
-    // create socket
-    sockfd = socket(AF_INET, SOCK_DGRAM, 0);
-    if (sockfd < 0) {
-      perror("socket");
-      return false;
-    }
+    // the rings are already mapped when the VNF is in the same host
+    if (not tx_ring.is_open()) {
+      // create socket
+      sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+      if (sockfd < 0) {
+        perror("socket");
+        return false;
+      }
 
-    int enable = 1;
+      int enable = 1;
 #if defined(SO_REUSEADDR)
-    if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(int)) < 0) {
-      perror("setsockopt(SO_REUSEADDR) failed");
-    }
+      if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(int)) < 0) {
+        perror("setsockopt(SO_REUSEADDR) failed");
+      }
 #endif
 #if defined(SO_REUSEPORT)
-    if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(int)) < 0) {
-      perror("setsockopt(SO_REUSEPORT) failed");
-    }
+      if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(int)) < 0) {
+        perror("setsockopt(SO_REUSEPORT) failed");
+      }
 #endif
 
-    bzero(&servaddr, sizeof(servaddr));
-    servaddr.sin_family      = AF_INET;
-    servaddr.sin_addr.s_addr = inet_addr(vnf_addr.c_str());
-    servaddr.sin_port        = htons(vnf_port);
+      bzero(&servaddr, sizeof(servaddr));
+      servaddr.sin_family      = AF_INET;
+      servaddr.sin_addr.s_addr = inet_addr(vnf_addr.c_str());
+      servaddr.sin_port        = htons(vnf_port);
+    }
 
     // start main thread
     running = true;
@@ -180,6 +192,18 @@ private:
 
     while (running) {
       // receive response
+      if (rx_ring.is_open()) {
+        uint32_t       len = 0;
+        const uint8_t* msg = rx_ring.wait_front(RX_TIMEOUT_MS, &len);
+        if (msg == nullptr) {
+          printf("Error: Didn't receive response after %dms\n", RX_TIMEOUT_MS);
+          continue;
+        }
+        handle_msg(msg, len);
+        rx_ring.pop();
+        update_rtt();
+        continue;
+      }
       int ret = poll(&fd, 1, RX_TIMEOUT_MS);
       switch (ret) {
         case -1:
@@ -195,16 +219,40 @@ private:
           handle_msg(rx_buffer->data(), recv_ret);
           break;
       }
+      update_rtt();
+    }
+  };
 
-      std::lock_guard<std::mutex> lock(mutex);
-      auto                        rtt =
-          std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tti_start_time)
-              .count();
+  void update_rtt()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto                        rtt =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tti_start_time)
+            .count();
+
+    // FIXME: add averaging
+    metrics.avg_rtt_us = rtt;
+  }
 
-      // FIXME: add averaging
-      metrics.avg_rtt_us = rtt;
+  //! The messages of the PNF are built in its stack, so they are copied to the ring slot
+  void send_msg(const void* msg, uint32_t len)
+  {
+    if (tx_ring.is_open()) {
+      uint8_t* slot = tx_ring.reserve();
+      if (slot == nullptr) {
+        printf("Error: the VNF is not reading, dropping %s\n",
+               basic_vnf_api::msg_type_text[((const msg_header_t*)msg)->type]);
+        return;
+      }
+      memcpy(slot, msg, len);
+      tx_ring.commit(len);
+      return;
     }
-  };
+    int n = 0;
+    if ((n = sendto(sockfd, msg, len, 0, (struct sockaddr*)&servaddr, sizeof(servaddr))) < 0) {
+      printf("sendto failed, ret=%d\n", n);
+    }
+  }
 
   void ul_handler_thread()
   {
@@ -313,10 +361,7 @@ private:
     sf_ind.t1             = 0;
     sf_ind.tb_len         = tb_len > 0 ? tb_len : rand_dist(rand_gen);
 
-    int n = 0;
-    if ((n = sendto(sockfd, &sf_ind, sizeof(sf_ind), 0, (struct sockaddr*)&servaddr, sizeof(servaddr))) < 0) {
-      printf("sendto failed, ret=%d\n", n);
-    }
+    send_msg(&sf_ind, sizeof(sf_ind));
   }
 
   int handle_msg(const uint8_t* buffer, const uint32_t len)
@@ -407,10 +452,7 @@ private:
       memset(rx_ind.pdus[0].data, 0xab, rx_ind.pdus[0].length);
     }
 
-    int n = 0;
-    if ((n = sendto(sockfd, &rx_ind, sizeof(rx_ind), 0, (struct sockaddr*)&servaddr, sizeof(servaddr))) < 0) {
-      printf("sendto failed, ret=%d\n", n);
-    }
+    send_msg(&rx_ind, sizeof(rx_ind));
   }
 
   void send_dl_ind(uint32_t tti_, srslte::unique_byte_buffer_t tb = {})
@@ -491,10 +533,7 @@ private:
       memset(dl_ind.pdus[0].data, 0xab, tb_size);
     }
 
-    int n = 0;
-    if ((n = sendto(sockfd, &dl_ind, sizeof(dl_ind), 0, (struct sockaddr*)&servaddr, sizeof(servaddr))) < 0) {
-      printf("sendto failed, ret=%d\n", n);
-    }
+    send_msg(&dl_ind, sizeof(dl_ind));
   }
 
   void send_ul_ind(uint32_t tti_)
@@ -509,10 +548,7 @@ private:
     ul_ind.pdus.type   = basic_vnf_api::PUSCH;
     ul_ind.pdus.length = tb_len > 0 ? tb_len : rand_dist(rand_gen);
 
-    int n = 0;
-    if ((n = sendto(sockfd, &ul_ind, sizeof(ul_ind), 0, (struct sockaddr*)&servaddr, sizeof(servaddr))) < 0) {
-      printf("sendto failed, ret=%d\n", n);
-    }
+    send_msg(&ul_ind, sizeof(ul_ind));
   }
 
   std::unique_ptr<std::thread> tx_thread, rx_thread;
@@ -539,6 +575,9 @@ private:
   int                sockfd   = 0;
   struct sockaddr_in servaddr = {};
 
+  // used instead of the socket when the VNF runs in the same host
+  basic_vnf_api::shm_ring tx_ring, rx_ring;
+
   // For random number generation
   std::mt19937                            rand_gen;
   std::uniform_int_distribution<uint16_t> rand_dist;
@@ -23,6 +23,7 @@
 #define SRSLTE_BASIC_VNF_H
 
 #include "basic_vnf_api.h"
+#include "basic_vnf_shm.h"
 #include "common.h"
 #include "srslte/common/logmap.h"
 #include "srslte/common/threads.h"
@@ -66,6 +67,11 @@ private:
   // senders
   int send_dl_config_request();
 
+  /// Buffer where the next message to the PNF is written, the next slot of the shared-memory ring or the staging
+  /// buffer of the UDP socket. Returns nullptr if the ring is full
+  uint8_t* get_tx_buffer();
+  void     send_tx_buffer(uint32_t len);
+
   // helpers
   uint32_t calc_full_msg_len(const basic_vnf_api::tx_request_msg_t& msg);
 
@@ -84,6 +90,9 @@ private:
   int                sockfd   = 0;
   struct sockaddr_in servaddr = {}, client_addr = {};
 
+  // used instead of the socket when the PNF runs in the same host
+  basic_vnf_api::shm_ring tx_ring, rx_ring;
+
   uint32_t last_sf_indication_time = 0;
 };
 
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_BASIC_VNF_SHM_H
+#define SRSLTE_BASIC_VNF_SHM_H
+
+#include "basic_vnf_api.h"
+#include "srslte/common/choice_type.h"
+#include <atomic>
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <string>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+namespace basic_vnf_api {
+
+/// Ring of one direction of the P7 interface
+inline std::string shm_ring_name(const std::string& name, bool to_pnf)
+{
+  return "/" + name + (to_pnf ? "_p7_dl" : "_p7_ul");
+}
+
+/**
+ * Transport of the messages between the VNF and the PNF running in the same host. Each direction is a ring of message
+ * slots in shared memory, with one producer and one consumer. The producer builds the message in place in the slot
+ * returned by reserve(), and the consumer handles it in place before calling pop(), so the TBs are never copied into
+ * staging buffers or socket buffers. Whichever side maps the ring first initializes it, and the last one to unmap
+ * it destroys it.
+ */
+class shm_ring
+{
+public:
+  static const uint32_t nof_slots = 16;
+  static const size_t   slot_size = srslte::static_max<sizeof(sf_ind_msg_t),
+                                                     sizeof(dl_conf_msg_t),
+                                                     sizeof(tx_request_msg_t),
+                                                     sizeof(rx_data_ind_msg_t),
+                                                     sizeof(dl_ind_msg_t),
+                                                     sizeof(ul_ind_msg_t)>::value;
+
+  shm_ring() = default;
+  ~shm_ring() { close(); }
+  shm_ring(const shm_ring&) = delete;
+  shm_ring& operator=(const shm_ring&) = delete;
+
+  bool open(const std::string& name_)
+  {
+    name = name_;
+    for (uint32_t attempt = 0; attempt < max_open_attempts; ++attempt) {
+      if (attach()) {
+        return true;
+      }
+      if (fd < 0) {
+        return false;
+      }
+      // The ring was being destroyed or initialized by the peer, try again with the current one
+      close();
+    }
+    return false;
+  }
+
+  void close()
+  {
+    if (fd < 0) {
+      return;
+    }
+    // Only the last user destroys the ring, the peer may still be waiting on its semaphore
+    if (ring != nullptr and ring->magic.load(std::memory_order_relaxed) == ring_magic and
+        flock(fd, LOCK_EX | LOCK_NB) == 0) {
+      ring->magic.store(0, std::memory_order_relaxed);
+      sem_destroy(&ring->nof_msgs);
+      shm_unlink(name.c_str());
+    }
+    if (ring != nullptr) {
+      munmap(ring, sizeof(ring_t));
+      ring = nullptr;
+    }
+    ::close(fd); // releases the lock
+    fd = -1;
+  }
+
+  bool is_open() const { return ring != nullptr; }
+
+  /// Slot where the producer writes the next message. Returns nullptr if the consumer is nof_slots messages behind
+  uint8_t* reserve()
+  {
+    uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+    if (tail - ring->head.load(std::memory_order_acquire) >= nof_slots) {
+      return nullptr;
+    }
+    return ring->slots[tail % nof_slots];
+  }
+
+  /// Publishes the message of len bytes written in the slot returned by reserve()
+  void commit(uint32_t len)
+  {
+    uint32_t tail               = ring->tail.load(std::memory_order_relaxed);
+    ring->len[tail % nof_slots] = len;
+    ring->tail.store(tail + 1, std::memory_order_release);
+    sem_post(&ring->nof_msgs);
+  }
+
+  /// Waits up to timeout_ms for the next message, which stays valid until pop(). Returns nullptr on timeout
+  const uint8_t* wait_front(uint32_t timeout_ms, uint32_t* len)
+  {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000;
+    }
+    if (sem_timedwait(&ring->nof_msgs, &ts) != 0) {
+      return nullptr;
+    }
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    *len          = ring->len[head % nof_slots];
+    return ring->slots[head % nof_slots];
+  }
+
+  /// Releases the slot of the message returned by wait_front()
+  void pop() { ring->head.fetch_add(1, std::memory_order_release); }
+
+private:
+  static const uint32_t ring_magic        = 0x56464e50;
+  static const uint32_t max_open_attempts = 3;
+
+  struct ring_t {
+    std::atomic<uint32_t> magic;
+    std::atomic<uint32_t> head; ///< Next message of the consumer
+    std::atomic<uint32_t> tail; ///< Next slot of the producer
+    sem_t                 nof_msgs;
+    uint32_t              len[nof_slots];
+    alignas(64) uint8_t   slots[nof_slots][slot_size];
+  };
+
+  /// Maps the ring and holds a shared lock on it while it is in use. The side that gets the exclusive lock has no
+  /// peer attached, not even one that crashed, so it initializes the ring again whatever a previous run left in it
+  bool attach()
+  {
+    fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0) {
+      return false;
+    }
+    bool first = flock(fd, LOCK_EX | LOCK_NB) == 0;
+    if (not first and flock(fd, LOCK_SH) < 0) {
+      return false;
+    }
+    // The last user of the ring unlinked it between the open and the lock
+    struct stat st = {};
+    if (fstat(fd, &st) < 0 or st.st_nlink == 0) {
+      return false;
+    }
+    if (first and ftruncate(fd, sizeof(ring_t)) < 0) {
+      return false;
+    }
+    void* ptr = mmap(nullptr, sizeof(ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+      return false;
+    }
+    ring = (ring_t*)ptr;
+
+    if (first) {
+      if (ring->magic.load(std::memory_order_relaxed) == ring_magic) {
+        sem_destroy(&ring->nof_msgs);
+      }
+      ring->head.store(0, std::memory_order_relaxed);
+      ring->tail.store(0, std::memory_order_relaxed);
+      sem_init(&ring->nof_msgs, 1, 0);
+      ring->magic.store(ring_magic, std::memory_order_release);
+      // The peer blocked on the shared lock only gets it once the ring is initialized
+      return flock(fd, LOCK_SH) == 0;
+    }
+    // The peer that got the exclusive lock may have failed to initialize the ring
+    return ring->magic.load(std::memory_order_acquire) == ring_magic;
+  }
+
+  ring_t*     ring = nullptr;
+  int         fd   = -1;
+  std::string name;
+};
+
+} // namespace basic_vnf_api
+
+#endif // SRSLTE_BASIC_VNF_SHM_H
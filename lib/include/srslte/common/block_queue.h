@@ -98,6 +98,56 @@ public:
 
   bool try_pop(myobj* value) { return pop_(value, false); }
 
+  /// Pushes the values of [first, last) in order until the queue is full, taking the lock once. Returns the iterator
+  /// to the first value that was not pushed, the values before it are moved into the queue
+  template <typename It>
+  It try_push_many(It first, It last)
+  {
+    if (!enable) {
+      return first;
+    }
+    pthread_mutex_lock(&mutex);
+    It it = first;
+    for (; it != last && check_queue_space_unlocked(false); ++it) {
+      if (mutexed_callback) {
+        mutexed_callback->pushing(*it);
+      }
+      q.push(std::move(*it));
+    }
+    pthread_mutex_unlock(&mutex);
+    if (it != first) {
+      pthread_cond_broadcast(&cv_empty);
+    }
+    return it;
+  }
+
+  /// Pops values from the front and passes them to f, taking the lock once, for as long as the queue is not empty and
+  /// f returns true. f is called with the lock held. Returns the number of values popped
+  template <typename F>
+  size_t try_pop_while(F&& f)
+  {
+    if (!enable) {
+      return 0;
+    }
+    pthread_mutex_lock(&mutex);
+    size_t count = 0;
+    bool   more  = true;
+    while (more && !q.empty()) {
+      myobj value = std::move(q.front());
+      if (mutexed_callback) {
+        mutexed_callback->popping(value);
+      }
+      q.pop();
+      count++;
+      more = f(std::move(value));
+    }
+    if (count > 0) {
+      pthread_cond_broadcast(&cv_full);
+    }
+    pthread_mutex_unlock(&mutex);
+    return count;
+  }
+
   myobj wait_pop()
   { // blocking pop
     myobj value = myobj();
@@ -23,9 +23,10 @@
 #define SRSLTE_BUFFER_POOL_H
 
 #include <algorithm>
+#include <atomic>
+#include <limits>
 #include <map>
-#include <pthread.h>
-#include <stack>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -35,15 +36,60 @@
 
 #include "srslte/common/common.h"
 #include "srslte/common/log.h"
+#include "srslte/phy/utils/mem_accounting.h"
 
 namespace srslte {
 
+/******************************************************************************
+ * Free list of the buffer indexes 0..N-1 of a pool
+ *
+ * The list is a lock-free stack linked through an array of next indexes. Its
+ * head carries a tag that changes with every update, so that a thread that was
+ * preempted in the middle of a pop does not take a stale chain (ABA). A list
+ * with thread caches lets each thread keep up to 2*cache_batch free indexes,
+ * which are moved from and to the shared stack cache_batch at a time, so a
+ * thread that allocates and frees many buffers rarely touches shared state.
+ * Buffers in a thread cache can only be allocated by that thread, unless
+ * another thread is blocked waiting for a buffer, in which case the cache is
+ * given back on the next deallocation. Caches are given back when their
+ * thread exits.
+ *****************************************************************************/
+namespace detail {
+
+struct free_index_stack;
+
+class free_index_list
+{
+public:
+  static const uint32_t no_index    = std::numeric_limits<uint32_t>::max();
+  static const uint32_t cache_batch = 16;
+
+  free_index_list(uint32_t nof_indexes, bool thread_cache);
+  free_index_list(const free_index_list&) = delete;
+  free_index_list& operator=(const free_index_list&) = delete;
+  ~free_index_list();
+
+  /// Returns no_index if there are no free indexes and blocking is false
+  uint32_t pop(bool blocking);
+  void     push(uint32_t idx);
+  /// Free indexes in the shared stack, not counting those in the thread caches
+  uint32_t nof_free() const;
+
+private:
+  std::shared_ptr<free_index_stack> stack;
+  bool                              use_thread_cache;
+  uint64_t                          id;
+};
+
+} // namespace detail
+
 /******************************************************************************
  * Buffer pool
  *
  * Preallocates a large number of buffer_t and provides allocate and
  * deallocate functions. Provides quick object creation and deletion as well
- * as object reuse.
+ * as object reuse. Allocation and deallocation are lock-free, a mutex is only
+ * taken by blocking allocations when the pool is empty.
  * Singleton class of byte_buffer_t (but other pools of different type can be created)
  *****************************************************************************/
 
@@ -52,43 +98,37 @@ class buffer_pool
 {
 public:
   // non-static methods
-  buffer_pool(int capacity_ = -1)
+  buffer_pool(int capacity_ = -1, bool thread_cache = false) :
+    capacity(capacity_ > 0 ? (uint32_t)capacity_ : POOL_SIZE),
+    buffers(new buffer_t[capacity]),
+    in_use(new std::atomic<bool>[capacity]),
+    free_list(capacity, thread_cache)
   {
-    uint32_t nof_buffers = POOL_SIZE;
-    if (capacity_ > 0) {
-      nof_buffers = (uint32_t)capacity_;
-    }
-    pthread_mutex_init(&mutex, nullptr);
-    pthread_cond_init(&cv_not_empty, nullptr);
-    for (uint32_t i = 0; i < nof_buffers; i++) {
-      buffer_t* b = new buffer_t;
-      available.push(b);
+    for (uint32_t i = 0; i < capacity; i++) {
+      in_use[i].store(false, std::memory_order_relaxed);
     }
-    capacity = nof_buffers;
+    srslte_mem_account(SRSLTE_MEM_TAG_BUFFER_POOL, (int64_t)(capacity * sizeof(buffer_t)), capacity);
   }
-
   ~buffer_pool()
   {
-    // this destructor assumes all buffers have been properly deallocated
-    while (available.size()) {
-      delete available.top();
-      available.pop();
-    }
-
-    for (uint32_t i = 0; i < used.size(); i++) {
-      delete used[i];
-    }
-    pthread_cond_destroy(&cv_not_empty);
-    pthread_mutex_destroy(&mutex);
+    srslte_mem_account(SRSLTE_MEM_TAG_BUFFER_POOL, -(int64_t)(capacity * sizeof(buffer_t)), -(int64_t)capacity);
   }
+  buffer_pool(const buffer_pool&) = delete;
+  buffer_pool& operator=(const buffer_pool&) = delete;
 
   void print_all_buffers()
   {
-    printf("%d buffers in queue\n", (int)used.size());
+    uint32_t nof_used = 0;
+    for (uint32_t i = 0; i < capacity; i++) {
+      nof_used += in_use[i].load(std::memory_order_relaxed) ? 1 : 0;
+    }
+    printf("%d buffers in queue\n", (int)nof_used);
 #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
     std::map<std::string, uint32_t> buffer_cnt;
-    for (uint32_t i = 0; i < used.size(); i++) {
-      buffer_cnt[strlen(used[i]->debug_name) ? used[i]->debug_name : "Undefined"]++;
+    for (uint32_t i = 0; i < capacity; i++) {
+      if (in_use[i].load(std::memory_order_relaxed)) {
+        buffer_cnt[strlen(buffers[i].debug_name) ? buffers[i].debug_name : "Undefined"]++;
+      }
     }
     std::map<std::string, uint32_t>::iterator it;
     for (it = buffer_cnt.begin(); it != buffer_cnt.end(); it++) {
@@ -97,95 +137,145 @@ public:
 #endif
   }
 
-  uint32_t nof_available_pdus() { return available.size(); }
+  uint32_t nof_available_pdus() { return free_list.nof_free(); }
+  /// Buffers that are not in the shared free list, i.e. allocated or kept in a thread cache
+  uint32_t nof_used_pdus() { return capacity - nof_available_pdus(); }
 
-  bool is_almost_empty() { return available.size() < capacity / 20; }
+  bool is_almost_empty() { return nof_available_pdus() < capacity / 20; }
 
   buffer_t* allocate(const char* debug_name = nullptr, bool blocking = false)
   {
-    pthread_mutex_lock(&mutex);
-    buffer_t* b = nullptr;
-
-    if (available.size() > 0) {
-      b = available.top();
-      used.push_back(b);
-      available.pop();
-
-      if (is_almost_empty()) {
-        printf("Warning buffer pool capacity is %f %%\n", (float)100 * available.size() / capacity);
-      }
-#ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
-      if (debug_name) {
-        strncpy(b->debug_name, debug_name, SRSLTE_BUFFER_POOL_LOG_NAME_LEN);
-        b->debug_name[SRSLTE_BUFFER_POOL_LOG_NAME_LEN - 1] = 0;
-      }
-#endif
-    } else if (blocking) {
-      // blocking allocation
-      while (available.size() == 0) {
-        pthread_cond_wait(&cv_not_empty, &mutex);
-      }
-
-      // retrieve the new buffer
-      b = available.top();
-      used.push_back(b);
-      available.pop();
-
-      // do not print any warning
-    } else {
+    uint32_t idx = free_list.pop(blocking);
+    if (idx == detail::free_index_list::no_index) {
       printf("Error - buffer pool is empty\n");
 
 #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
       print_all_buffers();
 #endif
+      return nullptr;
     }
+    // blocking allocations do not print any warning
+    return take(idx, debug_name, not blocking);
+  }
 
-    pthread_mutex_unlock(&mutex);
-    return b;
+  // Returns nullptr without any error if the pool is empty
+  buffer_t* try_allocate(const char* debug_name = nullptr)
+  {
+    uint32_t idx = free_list.pop(false);
+    return idx != detail::free_index_list::no_index ? take(idx, debug_name, true) : nullptr;
+  }
+
+  // The buffers are in one array, so whether a buffer belongs to the pool is found from its address
+  bool contains(const void* b) const
+  {
+    uintptr_t offset = (uintptr_t)b - (uintptr_t)buffers.get();
+    return b != nullptr and (uintptr_t)b >= (uintptr_t)buffers.get() and offset % sizeof(buffer_t) == 0 and
+           offset / sizeof(buffer_t) < capacity;
   }
 
   bool deallocate(buffer_t* b)
   {
-    bool ret = false;
-    pthread_mutex_lock(&mutex);
-    typename std::vector<buffer_t*>::iterator elem = std::find(used.begin(), used.end(), b);
-    if (elem != used.end()) {
-      used.erase(elem);
-      available.push(b);
-      ret = true;
-    }
-    pthread_cond_signal(&cv_not_empty);
-    pthread_mutex_unlock(&mutex);
-    return ret;
+    if (not contains(b)) {
+      return false;
+    }
+    uint32_t idx = ((uintptr_t)b - (uintptr_t)buffers.get()) / sizeof(buffer_t);
+    // A buffer deallocated twice only goes back to the free list once
+    if (not in_use[idx].exchange(false, std::memory_order_relaxed)) {
+      return false;
+    }
+    free_list.push(idx);
+    return true;
   }
 
 private:
-  static const int       POOL_SIZE = 4096;
-  std::stack<buffer_t*>  available;
-  std::vector<buffer_t*> used;
-  pthread_mutex_t        mutex;
-  pthread_cond_t         cv_not_empty;
-  uint32_t               capacity;
+  buffer_t* take(uint32_t idx, const char* debug_name, bool warn)
+  {
+    buffer_t* b = &buffers[idx];
+    in_use[idx].store(true, std::memory_order_relaxed);
+
+    if (warn and is_almost_empty()) {
+      printf("Warning buffer pool capacity is %f %%\n", (float)100 * nof_available_pdus() / capacity);
+    }
+#ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
+    if (debug_name) {
+      strncpy(b->debug_name, debug_name, SRSLTE_BUFFER_POOL_LOG_NAME_LEN);
+      b->debug_name[SRSLTE_BUFFER_POOL_LOG_NAME_LEN - 1] = 0;
+    }
+#endif
+    return b;
+  }
+
+  static const uint32_t                POOL_SIZE = 4096;
+  uint32_t                             capacity;
+  std::unique_ptr<buffer_t[]>          buffers;
+  std::unique_ptr<std::atomic<bool>[]> in_use;
+  detail::free_index_list              free_list;
 };
 
+/******************************************************************************
+ * Byte buffer pool
+ *
+ * Keeps the byte buffers in size classes. Buffers allocated without a size
+ * have the maximum size, buffers allocated for nof_bytes come from the
+ * smallest class they fit in, or from a larger class when that one is empty.
+ *****************************************************************************/
 class byte_buffer_pool
 {
 public:
+  // The small classes have less headroom, enough for the GTP-U, PDCP and RLC headers
+  static const uint32_t small_buffer_headroom       = 128;
+  static const uint32_t small_byte_buffer_capacity  = 256 + small_buffer_headroom;
+  static const uint32_t medium_byte_buffer_capacity = 2048 + small_buffer_headroom;
+
+  typedef sized_byte_buffer_t<small_byte_buffer_capacity, small_buffer_headroom>         small_byte_buffer_t;
+  typedef sized_byte_buffer_t<medium_byte_buffer_capacity, small_buffer_headroom>        medium_byte_buffer_t;
+  typedef sized_byte_buffer_t<SRSLTE_MAX_BUFFER_SIZE_BYTES, SRSLTE_BUFFER_HEADER_OFFSET> large_byte_buffer_t;
+
   // Singleton static methods
   static std::unique_ptr<byte_buffer_pool> instance;
   static byte_buffer_pool* get_instance(int capacity = -1);
   static void              cleanup();
-  byte_buffer_pool(int capacity = -1)
-  {
-    log  = nullptr;
-    pool = new buffer_pool<byte_buffer_t>(capacity);
-  }
+  // Each size class has capacity buffers. The byte buffers are allocated and freed by many threads, which keep caches
+  // of them
+  byte_buffer_pool(int capacity = -1) :
+    log(nullptr),
+    small_pool(capacity, true),
+    medium_pool(capacity, true),
+    large_pool(capacity, true),
+    view_pool(capacity, true)
+  {}
   byte_buffer_pool(const byte_buffer_pool& other) = delete;
   byte_buffer_pool& operator=(const byte_buffer_pool& other) = delete;
-  ~byte_buffer_pool() { delete pool; }
   byte_buffer_t* allocate(const char* debug_name = nullptr, bool blocking = false)
   {
-    return pool->allocate(debug_name, blocking);
+    return large_pool.allocate(debug_name, blocking);
+  }
+  byte_buffer_t* allocate(uint32_t nof_bytes, const char* debug_name, bool blocking = false)
+  {
+    byte_buffer_t* b = nullptr;
+    if (nof_bytes <= small_byte_buffer_t::max_payload) {
+      b = small_pool.try_allocate(debug_name);
+    }
+    if (b == nullptr and nof_bytes <= medium_byte_buffer_t::max_payload) {
+      b = medium_pool.try_allocate(debug_name);
+    }
+    if (b == nullptr and nof_bytes <= large_byte_buffer_t::max_payload) {
+      b = large_pool.allocate(debug_name, blocking);
+    }
+    return b;
+  }
+  /// Returns a view of nof_bytes of someone else's buffer, or nullptr when there are no views left
+  byte_buffer_t* allocate_view(uint8_t*                               bytes,
+                               uint32_t                               nof_bytes,
+                               byte_buffer_view_t::release_callback_t callback,
+                               void*                                  owner,
+                               void*                                  arg)
+  {
+    byte_buffer_view_t* b = view_pool.try_allocate();
+    if (b != nullptr) {
+      b->set_view(bytes, nof_bytes, callback, owner, arg);
+    }
+    return b;
   }
   void set_log(srslte::log* log) { this->log = log; }
   void deallocate(byte_buffer_t* b)
@@ -193,8 +283,25 @@ public:
     if (!b) {
       return;
     }
+    // A view does not own its bytes, they are given back to their owner
+    if (view_pool.contains(b)) {
+      byte_buffer_view_t* v = static_cast<byte_buffer_view_t*>(b);
+      v->release();
+      v->clear();
+      view_pool.deallocate(v);
+      return;
+    }
     b->clear();
-    if (!pool->deallocate(b)) {
+    // The size class of the buffer is given by its capacity
+    bool found = false;
+    if (b->get_capacity() == small_byte_buffer_capacity) {
+      found = small_pool.deallocate(static_cast<small_byte_buffer_t*>(b));
+    } else if (b->get_capacity() == medium_byte_buffer_capacity) {
+      found = medium_pool.deallocate(static_cast<medium_byte_buffer_t*>(b));
+    } else if (b->get_capacity() == SRSLTE_MAX_BUFFER_SIZE_BYTES) {
+      found = large_pool.deallocate(static_cast<large_byte_buffer_t*>(b));
+    }
+    if (!found) {
       if (log) {
 #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
         log->error("Deallocating PDU: Addr=0x%p, name=%s not found in pool\n", b, b->debug_name);
@@ -211,11 +318,23 @@ public:
     }
     b = nullptr;
   }
-  void print_all_buffers() { pool->print_all_buffers(); }
+  uint32_t nof_used()
+  {
+    return small_pool.nof_used_pdus() + medium_pool.nof_used_pdus() + large_pool.nof_used_pdus();
+  }
+  void print_all_buffers()
+  {
+    small_pool.print_all_buffers();
+    medium_pool.print_all_buffers();
+    large_pool.print_all_buffers();
+  }
 
 private:
-  srslte::log*                log;
-  buffer_pool<byte_buffer_t>* pool;
+  srslte::log*                      log;
+  buffer_pool<small_byte_buffer_t>  small_pool;
+  buffer_pool<medium_byte_buffer_t> medium_pool;
+  buffer_pool<large_byte_buffer_t>  large_pool;
+  buffer_pool<byte_buffer_view_t>   view_pool;
 };
 
 inline void byte_buffer_deleter::operator()(byte_buffer_t* buf) const
@@ -236,6 +355,24 @@ allocate_unique_buffer(byte_buffer_pool& pool, const char* debug_name, bool bloc
   return unique_byte_buffer_t(pool.allocate(debug_name, blocking), byte_buffer_deleter(&pool));
 }
 
+/// Allocates a buffer with room for at least nof_bytes after the headroom, from the smallest size class available
+inline unique_byte_buffer_t
+allocate_unique_buffer(byte_buffer_pool& pool, uint32_t nof_bytes, const char* debug_name, bool blocking = false)
+{
+  return unique_byte_buffer_t(pool.allocate(nof_bytes, debug_name, blocking), byte_buffer_deleter(&pool));
+}
+
+/// Wraps nof_bytes of someone else's buffer without copying them, see byte_buffer_view_t. Null if there are no views
+inline unique_byte_buffer_t allocate_unique_buffer_view(byte_buffer_pool&                      pool,
+                                                        uint8_t*                               bytes,
+                                                        uint32_t                               nof_bytes,
+                                                        byte_buffer_view_t::release_callback_t callback,
+                                                        void*                                  owner,
+                                                        void*                                  arg)
+{
+  return unique_byte_buffer_t(pool.allocate_view(bytes, nof_bytes, callback, owner, arg), byte_buffer_deleter(&pool));
+}
+
 } // namespace srslte
 
 #endif // SRSLTE_BUFFER_POOL_H
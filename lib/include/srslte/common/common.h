@@ -27,6 +27,7 @@
 *******************************************************************************/
 
 #include "srslte/adt/span.h"
+#include <algorithm>
 #include <memory>
 #include <stdint.h>
 #include <string.h>
@@ -43,8 +44,17 @@
 
 #define SRSLTE_N_MCH_LCIDS 32
 
-#define FDD_HARQ_DELAY_DL_MS 4
-#define FDD_HARQ_DELAY_UL_MS 4
+// Subframes between a reception and the transmission that answers it. 36.213 sets 4, the HARQ_DELAY_MS build option
+// lowers it for low-latency testbeds. The DL and UL delays, the TX advance and the HARQ RTT all follow it
+#ifndef FDD_HARQ_DELAY_MS
+#define FDD_HARQ_DELAY_MS 4
+#endif
+#if FDD_HARQ_DELAY_MS < 2 || FDD_HARQ_DELAY_MS > 4
+#error "FDD_HARQ_DELAY_MS must be between 2 and 4"
+#endif
+
+#define FDD_HARQ_DELAY_DL_MS FDD_HARQ_DELAY_MS
+#define FDD_HARQ_DELAY_UL_MS FDD_HARQ_DELAY_MS
 #define MSG3_DELAY_MS 2 // Delay added to FDD_HARQ_DELAY_DL_MS
 
 #define TTI_SUB(a, b) ((((a) + 10240) - (b)) % 10240)
@@ -98,61 +108,106 @@ namespace srslte {
  * Generic buffers with headroom to accommodate packet headers and custom
  * copy constructors & assignment operators for quick copying. Byte buffer
  * holds a next pointer to support linked lists.
+ *
+ * A byte_buffer_t created on its own owns storage of the maximum size. The
+ * buffers of the pool use the storage of their size class instead, see
+ * sized_byte_buffer_t.
+ *
+ * The storage is not cleared, neither on construction nor by clear(). Users
+ * must not read past what they wrote. Building with ENABLE_BUFFER_ZEROING, the
+ * default for Debug builds, clears the whole storage on construction and by
+ * clear(), as a hardening and debug aid.
  *****************************************************************************/
+
 class byte_buffer_t
 {
 public:
-  uint32_t N_bytes;
-  uint8_t  buffer[SRSLTE_MAX_BUFFER_SIZE_BYTES];
-  uint8_t* msg;
+  /// Timing metadata carried with the packet through the layers for the latency metrics, 0 when not set. The times are
+  /// given by srslte::latency_clock_ns()
+  struct buffer_metadata_t {
+    uint64_t rx_ns;      ///< Entry of the packet into the stack, e.g. its reception by GTP-U
+    uint64_t enqueue_ns; ///< Entry of the packet into the queue of the layer that holds it
+  };
+
+  uint32_t          N_bytes;
+  uint8_t*          buffer;
+  uint8_t*          msg;
+  buffer_metadata_t md;
 #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
   char debug_name[SRSLTE_BUFFER_POOL_LOG_NAME_LEN];
 #endif
 
-  byte_buffer_t() : N_bytes(0)
+  byte_buffer_t() :
+    N_bytes(0),
+    buffer(new uint8_t[SRSLTE_MAX_BUFFER_SIZE_BYTES]),
+    md(),
+    capacity(SRSLTE_MAX_BUFFER_SIZE_BYTES),
+    headroom(SRSLTE_BUFFER_HEADER_OFFSET),
+    owns_buffer(true)
   {
+#ifdef ENABLE_BUFFER_ZEROING
     bzero(buffer, SRSLTE_MAX_BUFFER_SIZE_BYTES);
+#endif
 #ifdef ENABLE_TIMESTAMP
     timestamp_is_set = false;
 #endif
-    msg  = &buffer[SRSLTE_BUFFER_HEADER_OFFSET];
+    msg  = &buffer[headroom];
     next = NULL;
 #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
     bzero(debug_name, SRSLTE_BUFFER_POOL_LOG_NAME_LEN);
 #endif
   }
-  byte_buffer_t(const byte_buffer_t& buf)
+  byte_buffer_t(const byte_buffer_t& buf) :
+    buffer(new uint8_t[SRSLTE_MAX_BUFFER_SIZE_BYTES]),
+    md(buf.md),
+    capacity(SRSLTE_MAX_BUFFER_SIZE_BYTES),
+    headroom(SRSLTE_BUFFER_HEADER_OFFSET),
+    owns_buffer(true)
   {
+#ifdef ENABLE_BUFFER_ZEROING
     bzero(buffer, SRSLTE_MAX_BUFFER_SIZE_BYTES);
-    msg  = &buffer[SRSLTE_BUFFER_HEADER_OFFSET];
+#endif
+    msg  = &buffer[headroom];
     next = NULL;
     // copy actual contents
     N_bytes = buf.N_bytes;
     memcpy(msg, buf.msg, N_bytes);
   }
+  ~byte_buffer_t()
+  {
+    if (owns_buffer) {
+      delete[] buffer;
+    }
+  }
+  // Copies the contents, which are truncated if they do not fit after the headroom of this buffer
   byte_buffer_t& operator=(const byte_buffer_t& buf)
   {
     // avoid self assignment
     if (&buf == this)
       return *this;
-    bzero(buffer, SRSLTE_MAX_BUFFER_SIZE_BYTES);
-    msg     = &buffer[SRSLTE_BUFFER_HEADER_OFFSET];
+    msg     = &buffer[headroom];
     next    = NULL;
-    N_bytes = buf.N_bytes;
+    N_bytes = std::min(buf.N_bytes, capacity - headroom);
+    md      = buf.md;
     memcpy(msg, buf.msg, N_bytes);
     return *this;
   }
   void clear()
   {
-    msg     = &buffer[SRSLTE_BUFFER_HEADER_OFFSET];
+#ifdef ENABLE_BUFFER_ZEROING
+    bzero(buffer, capacity);
+#endif
+    msg     = &buffer[headroom];
     N_bytes = 0;
+    md      = {};
 #ifdef ENABLE_TIMESTAMP
     timestamp_is_set = false;
 #endif
   }
+  uint32_t get_capacity() const { return capacity; }
   uint32_t get_headroom() { return msg - buffer; }
   // Returns the remaining space from what is reported to be the length of msg
-  uint32_t get_tailroom() { return (sizeof(buffer) - (msg - buffer) - N_bytes); }
+  uint32_t get_tailroom() { return (capacity - (msg - buffer) - N_bytes); }
   long     get_latency_us()
   {
 #ifdef ENABLE_TIMESTAMP
@@ -180,14 +235,109 @@ public:
     N_bytes += size;
   }
 
+protected:
+  // Buffer over storage that is owned by the caller. Without zeroing, the pages of the buffers that are never used are
+  // not brought into memory
+  byte_buffer_t(uint8_t* storage, uint32_t capacity_, uint32_t headroom_) :
+    N_bytes(0),
+    buffer(storage),
+    md(),
+    capacity(capacity_),
+    headroom(headroom_),
+    owns_buffer(false)
+  {
+#ifdef ENABLE_BUFFER_ZEROING
+    bzero(buffer, capacity);
+#endif
+#ifdef ENABLE_TIMESTAMP
+    timestamp_is_set = false;
+#endif
+    msg  = &buffer[headroom];
+    next = NULL;
+#ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
+    bzero(debug_name, SRSLTE_BUFFER_POOL_LOG_NAME_LEN);
+#endif
+  }
+
+  // Moves the buffer to other storage that is owned by the caller, used by the views
+  void set_storage(uint8_t* storage, uint32_t capacity_, uint32_t headroom_)
+  {
+    buffer   = storage;
+    capacity = capacity_;
+    headroom = headroom_;
+    msg      = &buffer[headroom];
+    N_bytes  = 0;
+  }
+
 private:
 #ifdef ENABLE_TIMESTAMP
   struct timeval timestamp[3];
   bool           timestamp_is_set;
 #endif
+  uint32_t       capacity;
+  uint32_t       headroom;
+  bool           owns_buffer;
   byte_buffer_t* next;
 };
 
+/**
+ * Byte buffer with its storage of capacity_ bytes embedded, headroom_ of them reserved for headers. The size classes
+ * of the buffer pool are built from it
+ */
+template <uint32_t capacity_, uint32_t headroom_>
+class sized_byte_buffer_t : public byte_buffer_t
+{
+public:
+  static const uint32_t max_payload = capacity_ - headroom_;
+
+  sized_byte_buffer_t() : byte_buffer_t(storage, capacity_, headroom_) {}
+  sized_byte_buffer_t(const sized_byte_buffer_t&) = delete;
+  sized_byte_buffer_t& operator=(const sized_byte_buffer_t&) = delete;
+
+private:
+  uint8_t storage[capacity_];
+};
+
+template <uint32_t capacity_, uint32_t headroom_>
+const uint32_t sized_byte_buffer_t<capacity_, headroom_>::max_payload;
+
+/**
+ * Byte buffer over nof_bytes that belong to a larger buffer of someone else, e.g. an RLC PDU inside a received MAC
+ * PDU, so that they are passed on without being copied. There is no headroom nor tailroom. The owner is told by the
+ * release callback when the view goes back to the pool, so that it keeps its buffer until all the views are released
+ */
+class byte_buffer_view_t : public byte_buffer_t
+{
+public:
+  typedef void (*release_callback_t)(void* owner, void* arg);
+
+  byte_buffer_view_t() : byte_buffer_t(nullptr, 0, 0) {}
+  byte_buffer_view_t(const byte_buffer_view_t&) = delete;
+  byte_buffer_view_t& operator=(const byte_buffer_view_t&) = delete;
+
+  void set_view(uint8_t* bytes, uint32_t nof_bytes, release_callback_t callback_, void* owner_, void* arg_)
+  {
+    set_storage(bytes, nof_bytes, 0);
+    N_bytes  = nof_bytes;
+    callback = callback_;
+    owner    = owner_;
+    arg      = arg_;
+  }
+  void release()
+  {
+    if (callback != nullptr) {
+      callback(owner, arg);
+    }
+    callback = nullptr;
+    set_storage(nullptr, 0, 0);
+  }
+
+private:
+  release_callback_t callback = nullptr;
+  void*              owner    = nullptr;
+  void*              arg      = nullptr;
+};
+
 struct bit_buffer_t {
   uint32_t N_bits;
   uint8_t  buffer[SRSLTE_MAX_BUFFER_SIZE_BITS];
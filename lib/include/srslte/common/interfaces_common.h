@@ -43,6 +43,7 @@ typedef struct {
   std::string type;
   std::string log_level;
   double      srate_hz;
+  float       srate_passband;
   float       dl_freq;
   float       ul_freq;
   float       freq_offset;
@@ -59,6 +60,8 @@ typedef struct {
   std::string device_args;
   std::string time_adv_nsamples;
   std::string continuous_tx;
+  bool        tx_async;       // Hand the transmissions to the driver from a dedicated thread
+  bool        rx_dev_threads; // Receive from every RF device in its own thread
 
   std::array<rf_args_band_t, SRSLTE_MAX_CARRIERS> ch_rx_bands;
   std::array<rf_args_band_t, SRSLTE_MAX_CARRIERS> ch_tx_bands;
@@ -71,6 +74,7 @@ struct vnf_args_t {
   uint16_t    bind_port;
   std::string log_level;
   int         log_hex_limit;
+  std::string shm_name; ///< Name of the shared-memory rings with a PNF in the same host. UDP is used if empty
 };
 
 class srslte_gw_config_t
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*! \brief Minimal io_uring ring, used by the socket handlers when the kernel supports it
+ *
+ */
+
+#ifndef SRSLTE_IO_URING_H
+#define SRSLTE_IO_URING_H
+
+#ifdef HAVE_IO_URING
+
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+
+namespace srslte {
+
+/**
+ * Ring of submission and completion queues, set up with the raw system calls. The ring is not thread-safe, all the
+ * calls must come from the thread that owns it
+ */
+class io_uring_queue
+{
+public:
+  io_uring_queue() = default;
+  io_uring_queue(const io_uring_queue&) = delete;
+  io_uring_queue& operator=(const io_uring_queue&) = delete;
+  ~io_uring_queue() { reset(); }
+
+  /// Sets up the ring with room for nof_entries submissions. Returns false if the kernel does not support io_uring
+  bool init(uint32_t nof_entries);
+  void reset();
+  bool is_init() const { return ring_fd >= 0; }
+
+  /// Next free submission entry, cleared, or nullptr if the submission queue is full
+  io_uring_sqe* get_sqe();
+
+  /// Submits the queued entries and waits until there are wait_nr completions. Returns the number of entries
+  /// submitted, or -errno
+  int submit_and_wait(uint32_t wait_nr);
+
+  /// Calls f for each available completion, in order, and hands the completions back to the kernel. Returns the number
+  /// of completions
+  template <typename F>
+  uint32_t for_each_cqe(F&& f)
+  {
+    uint32_t head  = *cq_khead;
+    uint32_t tail  = __atomic_load_n(cq_ktail, __ATOMIC_ACQUIRE);
+    uint32_t count = tail - head;
+    for (; head != tail; ++head) {
+      f(cqes[head & cq_mask]);
+    }
+    __atomic_store_n(cq_khead, head, __ATOMIC_RELEASE);
+    return count;
+  }
+
+  /// Registers a ring of nof_entries buffers for buffer group bgid, nof_entries is a power of two. Returns nullptr if
+  /// provided buffer rings are not supported
+  io_uring_buf_ring* setup_buf_ring(uint16_t bgid, uint32_t nof_entries);
+  void               free_buf_ring(io_uring_buf_ring* br, uint16_t bgid, uint32_t nof_entries);
+
+  /// Hands a buffer to the kernel through a buffer ring
+  static void buf_ring_add(io_uring_buf_ring* br, uint32_t nof_entries, void* addr, uint32_t len, uint16_t bid)
+  {
+    uint16_t tail = br->tail;
+    // in C++ the empty struct in front of br->bufs takes space, so the entries are addressed from the ring start
+    io_uring_buf* buf = &((io_uring_buf*)br)[tail & (nof_entries - 1)];
+    buf->addr         = (uint64_t)(uintptr_t)addr;
+    buf->len          = len;
+    buf->bid          = bid;
+    __atomic_store_n(&br->tail, (uint16_t)(tail + 1), __ATOMIC_RELEASE);
+  }
+
+  static void prep_read(io_uring_sqe* sqe, int fd, void* buf, uint32_t len, uint64_t user_data);
+  static void prep_poll_add(io_uring_sqe* sqe, int fd, uint32_t poll_mask, uint64_t user_data);
+  /// Multishot recvmsg into the buffers of group bgid. Each buffer starts with an io_uring_recvmsg_out header
+  static void prep_recvmsg_multishot(io_uring_sqe* sqe, int fd, msghdr* msg, uint16_t bgid, uint64_t user_data);
+  static void prep_cancel(io_uring_sqe* sqe, uint64_t target_user_data, uint64_t user_data);
+
+private:
+  int    ring_fd = -1;
+  void*  ring    = nullptr;
+  size_t ring_sz = 0;
+
+  uint32_t*     sq_khead   = nullptr;
+  uint32_t*     sq_ktail   = nullptr;
+  uint32_t      sq_mask    = 0;
+  uint32_t      sq_entries = 0;
+  uint32_t      sqe_head   = 0; // first entry not yet submitted
+  uint32_t      sqe_tail   = 0; // next free entry
+  io_uring_sqe* sqes       = nullptr;
+  size_t        sqes_sz    = 0;
+
+  uint32_t*     cq_khead = nullptr;
+  uint32_t*     cq_ktail = nullptr;
+  uint32_t      cq_mask  = 0;
+  io_uring_cqe* cqes     = nullptr;
+};
+
+} // namespace srslte
+
+#else // HAVE_IO_URING
+
+namespace srslte {
+
+// Without io_uring support the socket handlers always use epoll
+class io_uring_queue
+{};
+
+} // namespace srslte
+
+#endif // HAVE_IO_URING
+
+#endif // SRSLTE_IO_URING_H
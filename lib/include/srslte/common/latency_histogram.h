@@ -0,0 +1,158 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_LATENCY_HISTOGRAM_H
+#define SRSLTE_LATENCY_HISTOGRAM_H
+
+#include "srslte/common/metrics_counter.h"
+#include <array>
+#include <stdint.h>
+#include <time.h>
+
+namespace srslte {
+
+/// Monotonic time in ns, as stored in the timing metadata of the byte buffers
+inline uint64_t latency_clock_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/// Summary of the latencies observed since the last read. The percentiles are the upper bounds of the buckets they fall
+/// in, so they are above the exact percentile by less than a quarter of it
+typedef struct {
+  uint32_t count;
+  float    mean_us;
+  uint32_t p50_us;
+  uint32_t p99_us;
+  uint32_t max_us;
+} latency_stats_t;
+
+/**
+ * Histogram of latencies, observed by the data path and read by the metrics thread.
+ *
+ * The latencies are counted in microseconds, one bucket per microsecond below 4 us and 4 buckets per octave above, so
+ * the percentiles keep the same relative resolution from microseconds to seconds. Like metrics_counter, all the
+ * operations are relaxed atomic: the observations are never lost nor blocked by the reader, but the buckets are not
+ * read as a consistent snapshot.
+ */
+class latency_histogram
+{
+public:
+  /// The last bucket holds the latencies from about 15 s up
+  static const uint32_t nof_buckets = 96;
+
+  void observe(uint64_t latency_us)
+  {
+    buckets[bucket_of(latency_us)]++;
+    sum_us += latency_us;
+    max_us.store_max(latency_us > UINT32_MAX ? UINT32_MAX : (uint32_t)latency_us);
+  }
+
+  /// Observes the time from start_ns until end_ns, as given by latency_clock_ns(). A start of 0 means that the start
+  /// time was not recorded, and nothing is observed
+  void observe_interval(uint64_t start_ns, uint64_t end_ns)
+  {
+    if (start_ns != 0 and end_ns >= start_ns) {
+      observe((end_ns - start_ns) / 1000);
+    }
+  }
+
+  latency_stats_t get() const
+  {
+    std::array<uint32_t, nof_buckets> counts;
+    for (uint32_t i = 0; i < nof_buckets; i++) {
+      counts[i] = buckets[i].load();
+    }
+    return summarize(counts, sum_us.load(), max_us.load());
+  }
+
+  /// Returns the summary of the latencies observed since the last reset and resets the histogram
+  latency_stats_t read_and_reset()
+  {
+    std::array<uint32_t, nof_buckets> counts;
+    for (uint32_t i = 0; i < nof_buckets; i++) {
+      counts[i] = buckets[i].read_and_reset();
+    }
+    return summarize(counts, sum_us.read_and_reset(), max_us.read_and_reset());
+  }
+
+  void reset() { read_and_reset(); }
+
+  static uint32_t bucket_of(uint64_t latency_us)
+  {
+    if (latency_us < 4) {
+      return latency_us;
+    }
+    uint32_t msb    = 63 - __builtin_clzll(latency_us);
+    uint32_t bucket = (msb - 1) * 4 + ((latency_us >> (msb - 2)) & 3u);
+    return (bucket < nof_buckets) ? bucket : nof_buckets - 1;
+  }
+
+  /// Upper bound of the latencies counted in the bucket
+  static uint32_t bucket_limit_us(uint32_t bucket)
+  {
+    if (bucket < 4) {
+      return bucket + 1;
+    }
+    uint32_t msb = bucket / 4 + 1;
+    return (5 + bucket % 4) << (msb - 2);
+  }
+
+private:
+  static latency_stats_t summarize(const std::array<uint32_t, nof_buckets>& counts, uint64_t sum, uint32_t max)
+  {
+    latency_stats_t s = {};
+    for (uint32_t c : counts) {
+      s.count += c;
+    }
+    if (s.count == 0) {
+      return s;
+    }
+    s.mean_us = (float)sum / s.count;
+    s.max_us  = max;
+    s.p50_us  = percentile(counts, (s.count + 1) / 2, max);
+    s.p99_us  = percentile(counts, s.count - s.count / 100, max);
+    return s;
+  }
+
+  /// Upper bound of the latency of the n-th lowest observation, never above the maximum
+  static uint32_t percentile(const std::array<uint32_t, nof_buckets>& counts, uint32_t n, uint32_t max)
+  {
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < nof_buckets; i++) {
+      acc += counts[i];
+      if (acc >= n) {
+        return (bucket_limit_us(i) < max) ? bucket_limit_us(i) : max;
+      }
+    }
+    return max;
+  }
+
+  std::array<metrics_counter<uint32_t>, nof_buckets> buckets;
+  metrics_counter<uint64_t>                          sum_us;
+  metrics_counter<uint32_t>                          max_us;
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_LATENCY_HISTOGRAM_H
@@ -27,12 +27,12 @@
 #include "polarssl/aes.h"
 #include "polarssl/sha256.h"
 
-void sha256(const unsigned char* key,
-            size_t               keylen,
-            const unsigned char* input,
-            size_t               ilen,
-            unsigned char        output[32],
-            int                  is224)
+inline void sha256(const unsigned char* key,
+                   size_t               keylen,
+                   const unsigned char* input,
+                   size_t               ilen,
+                   unsigned char        output[32],
+                   int                  is224)
 {
   sha256_hmac(key, keylen, input, ilen, output, is224);
 }
@@ -43,41 +43,118 @@ void sha256(const unsigned char* key,
 
 #include "mbedtls/aes.h"
 #include "mbedtls/md.h"
+#include "mbedtls/sha256.h"
+#include <string.h>
 
 typedef mbedtls_aes_context aes_context;
 
 #define AES_ENCRYPT 1
 #define AES_DECRYPT 0
 
-int aes_setkey_enc(aes_context* ctx, const unsigned char* key, unsigned int keysize)
+inline int aes_setkey_enc(aes_context* ctx, const unsigned char* key, unsigned int keysize)
 {
   return mbedtls_aes_setkey_enc(ctx, key, keysize);
 }
 
-int aes_crypt_ecb(aes_context* ctx, int mode, const unsigned char input[16], unsigned char output[16])
+inline int aes_crypt_ecb(aes_context* ctx, int mode, const unsigned char input[16], unsigned char output[16])
 {
   return mbedtls_aes_crypt_ecb(ctx, mode, input, output);
 }
 
-int aes_crypt_ctr(aes_context*         ctx,
-                  size_t               length,
-                  size_t*              nc_off,
-                  unsigned char        nonce_counter[16],
-                  unsigned char        stream_block[16],
-                  const unsigned char* input,
-                  unsigned char*       output)
+inline int aes_crypt_ctr(aes_context*         ctx,
+                         size_t               length,
+                         size_t*              nc_off,
+                         unsigned char        nonce_counter[16],
+                         unsigned char        stream_block[16],
+                         const unsigned char* input,
+                         unsigned char*       output)
 {
   return mbedtls_aes_crypt_ctr(ctx, length, nc_off, nonce_counter, stream_block, input, output);
 }
 
-void sha256(const unsigned char* key,
-            size_t               keylen,
-            const unsigned char* input,
-            size_t               ilen,
-            unsigned char        output[32],
-            int                  is224)
+/// HMAC-SHA256 keeping the hash states of the inner and outer padded keys, so that every message costs one hash block
+/// less on each side. The keys are only processed when they change.
+class sha256_hmac_ctx
 {
-  mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), key, keylen, input, ilen, output);
+public:
+  static const size_t block_len = 64;
+
+  sha256_hmac_ctx()
+  {
+    mbedtls_sha256_init(&inner);
+    mbedtls_sha256_init(&outer);
+  }
+  ~sha256_hmac_ctx()
+  {
+    mbedtls_sha256_free(&inner);
+    mbedtls_sha256_free(&outer);
+  }
+  sha256_hmac_ctx(const sha256_hmac_ctx&) = delete;
+  sha256_hmac_ctx& operator=(const sha256_hmac_ctx&) = delete;
+
+  /// Keys longer than a block are not supported
+  void set_key(const unsigned char* key, size_t keylen)
+  {
+    if (key_len == keylen and memcmp(cur_key, key, keylen) == 0) {
+      return;
+    }
+    unsigned char pad[block_len];
+    memset(pad, 0x36, block_len);
+    for (size_t i = 0; i < keylen; i++) {
+      pad[i] ^= key[i];
+    }
+    mbedtls_sha256_starts(&inner, 0);
+    mbedtls_sha256_update(&inner, pad, block_len);
+
+    memset(pad, 0x5c, block_len);
+    for (size_t i = 0; i < keylen; i++) {
+      pad[i] ^= key[i];
+    }
+    mbedtls_sha256_starts(&outer, 0);
+    mbedtls_sha256_update(&outer, pad, block_len);
+
+    memcpy(cur_key, key, keylen);
+    key_len = keylen;
+  }
+
+  void hmac(const unsigned char* input, size_t ilen, unsigned char output[32]) const
+  {
+    mbedtls_sha256_context ctx;
+    unsigned char          inner_hash[32];
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_clone(&ctx, &inner);
+    mbedtls_sha256_update(&ctx, input, ilen);
+    mbedtls_sha256_finish(&ctx, inner_hash);
+    mbedtls_sha256_clone(&ctx, &outer);
+    mbedtls_sha256_update(&ctx, inner_hash, sizeof(inner_hash));
+    mbedtls_sha256_finish(&ctx, output);
+    mbedtls_sha256_free(&ctx);
+  }
+
+private:
+  mbedtls_sha256_context inner;
+  mbedtls_sha256_context outer;
+  unsigned char          cur_key[block_len] = {};
+  size_t                 key_len            = block_len + 1;
+};
+
+inline void sha256(const unsigned char* key,
+                   size_t               keylen,
+                   const unsigned char* input,
+                   size_t               ilen,
+                   unsigned char        output[32],
+                   int                  is224)
+{
+  if (keylen > sha256_hmac_ctx::block_len) {
+    mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), key, keylen, input, ilen, output);
+    return;
+  }
+
+  // The key derivations of TS 33.401 use every key several times in a row (e.g. KeNB for KRRCenc, KRRCint, KUPenc
+  // and KUPint), the padded keys of the last one are kept by every thread
+  static thread_local sha256_hmac_ctx ctx;
+  ctx.set_key(key, keylen);
+  ctx.hmac(input, ilen, output);
 }
 
 #endif // HAVE_MBEDTLS
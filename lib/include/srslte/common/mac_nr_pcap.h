@@ -22,6 +22,7 @@
 #ifndef SRSLTE_MAC_NR_PCAP_H
 #define SRSLTE_MAC_NR_PCAP_H
 
+#include "srslte/common/pcap_writer.h"
 #include <string>
 
 namespace srslte {
@@ -47,8 +48,8 @@ public:
 private:
   bool        enable_write = false;
   std::string filename;
-  FILE*       pcap_file = nullptr;
-  uint32_t    ue_id     = 0;
+  pcap_writer writer;
+  uint32_t    ue_id = 0;
   void        pack_and_write(uint8_t* pdu,
                              uint32_t pdu_len_bytes,
                              uint32_t tti,
@@ -23,6 +23,7 @@
 #define SRSLTE_MAC_PCAP_H
 
 #include "srslte/common/pcap.h"
+#include "srslte/common/pcap_writer.h"
 #include <stdint.h>
 
 namespace srslte {
@@ -33,7 +34,7 @@ public:
   mac_pcap();
   ~mac_pcap();
   void enable(bool en);
-  void open(const char* filename, uint32_t ue_id = 0);
+  void open(const char* filename, uint32_t ue_id = 0, const pcap_rotation_t& rotation = {});
   void close();
 
   void set_ue_id(uint16_t ue_id);
@@ -55,18 +56,18 @@ public:
   void write_sl_crnti(uint8_t* pdu, uint32_t pdu_len_bytes, uint16_t rnti, uint32_t reTX, uint32_t tti, uint8_t cc_idx);
 
 private:
-  bool     enable_write;
-  FILE*    pcap_file;
-  uint32_t ue_id;
-  void     pack_and_write(uint8_t* pdu,
-                          uint32_t pdu_len_bytes,
-                          uint32_t reTX,
-                          bool     crc_ok,
-                          uint8_t  cc_idx,
-                          uint32_t tti,
-                          uint16_t crnti_,
-                          uint8_t  direction,
-                          uint8_t  rnti_type);
+  bool        enable_write;
+  pcap_writer writer;
+  uint32_t    ue_id;
+  void        pack_and_write(uint8_t* pdu,
+                             uint32_t pdu_len_bytes,
+                             uint32_t reTX,
+                             bool     crc_ok,
+                             uint8_t  cc_idx,
+                             uint32_t tti,
+                             uint16_t crnti_,
+                             uint8_t  direction,
+                             uint8_t  rnti_type);
 };
 
 } // namespace srslte
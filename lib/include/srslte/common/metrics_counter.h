@@ -0,0 +1,75 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_METRICS_COUNTER_H
+#define SRSLTE_METRICS_COUNTER_H
+
+#include <atomic>
+
+namespace srslte {
+
+/**
+ * Counter of a metric, incremented by the data path and read by the metrics thread.
+ *
+ * All the operations are relaxed atomic, so neither side takes a lock or waits for the other, and an increment is
+ * never lost when the metrics thread reads and resets the counter at the same time. The counters of an object are
+ * not read as a consistent snapshot, which is fine for metrics.
+ */
+template <typename T>
+class metrics_counter
+{
+public:
+  metrics_counter(T value_ = 0) : value(value_) {}
+  metrics_counter(const metrics_counter&) = delete;
+  metrics_counter& operator=(const metrics_counter&) = delete;
+
+  metrics_counter& operator++()
+  {
+    value.fetch_add(1, std::memory_order_relaxed);
+    return *this;
+  }
+  T operator++(int) { return value.fetch_add(1, std::memory_order_relaxed); }
+  metrics_counter& operator+=(T v)
+  {
+    value.fetch_add(v, std::memory_order_relaxed);
+    return *this;
+  }
+  /// Sets the value, for metrics that hold the last value of something instead of a count
+  void store(T v) { value.store(v, std::memory_order_relaxed); }
+  /// Raises the value to v if it is lower, for metrics that hold the maximum of something
+  void store_max(T v)
+  {
+    T cur = value.load(std::memory_order_relaxed);
+    while (cur < v and not value.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {
+    }
+  }
+
+  T    load() const { return value.load(std::memory_order_relaxed); }
+  T    read_and_reset() { return value.exchange(0, std::memory_order_relaxed); }
+  void reset() { value.store(0, std::memory_order_relaxed); }
+
+private:
+  std::atomic<T> value;
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_METRICS_COUNTER_H
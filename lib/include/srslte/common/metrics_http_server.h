@@ -0,0 +1,63 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_METRICS_HTTP_SERVER_H
+#define SRSLTE_METRICS_HTTP_SERVER_H
+
+#include "srslte/common/threads.h"
+#include <atomic>
+#include <functional>
+#include <string>
+
+namespace srslte {
+
+/**
+ * Minimal HTTP server that answers GET /metrics with the text returned by a handler, for Prometheus and other
+ * scrapers of the OpenMetrics text format. Requests are served one at a time by its own thread, so the handler is
+ * never called concurrently.
+ */
+class metrics_http_server : public thread
+{
+public:
+  explicit metrics_http_server(const std::string& thread_name = "METRICS_HTTP") : thread(thread_name) {}
+  ~metrics_http_server();
+  metrics_http_server(const metrics_http_server&) = delete;
+  metrics_http_server& operator=(const metrics_http_server&) = delete;
+
+  /// Listens on the given address and port and starts serving. A port of 0 picks a free one, see get_port()
+  bool init(const std::string& address, uint16_t port, std::function<std::string()> handler_);
+  void stop();
+
+  uint16_t get_port() const { return port; }
+
+private:
+  void run_thread() override;
+  void serve(int fd);
+
+  std::function<std::string()> handler;
+  int                          listen_fd = -1;
+  uint16_t                     port      = 0;
+  std::atomic<bool>            running{false};
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_METRICS_HTTP_SERVER_H
@@ -21,17 +21,22 @@
 
 /******************************************************************************
  *  File:         multiqueue.h
- *  Description:  General-purpose non-blocking multiqueue. It behaves as a list
- *                of bounded/unbounded queues.
+ *  Description:  General-purpose multiqueue. It behaves as a list of bounded
+ *                queues with many producers and a single consumer. Producers
+ *                push without locks and only take the mutex to wake up the
+ *                consumer when it sleeps, or to block when a queue is full.
  *****************************************************************************/
 
 #ifndef SRSLTE_MULTIQUEUE_H
 #define SRSLTE_MULTIQUEUE_H
 
 #include "srslte/adt/move_callback.h"
+#include "srslte/adt/mpsc_queue.h"
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <vector>
@@ -39,54 +44,22 @@
 namespace srslte {
 
 #define MULTIQUEUE_DEFAULT_CAPACITY (8192) // Default per-queue capacity
+#define MULTIQUEUE_MAX_QUEUES (128)        // Maximum number of queues, including the erased ones
 
+/**
+ * List of bounded lock-free queues, each one fed by any number of threads and all of them drained by a single
+ * consumer thread through wait_pop()/try_pop(). The capacity of each queue is rounded up to a power of two.
+ * The consumer serves the queues in round-robin and only sleeps when all of them are empty, and a producer only
+ * locks the mutex when it has to wake up the sleeping consumer.
+ */
 template <typename myobj>
 class multiqueue_handler
 {
-  class circular_buffer
-  {
-  public:
-    circular_buffer(uint32_t cap) : buffer(cap + 1) {}
-    circular_buffer(circular_buffer&& other) noexcept
-    {
-      active       = other.active;
-      other.active = false;
-      widx         = other.widx;
-      ridx         = other.ridx;
-      buffer       = std::move(other.buffer);
-    }
-
-    std::condition_variable cv_full;
-    bool                    active = true;
-
-    bool   empty() const { return widx == ridx; }
-    size_t size() const { return widx >= ridx ? widx - ridx : widx + (buffer.size() - ridx); }
-    bool   full() const { return (ridx > 0) ? widx == ridx - 1 : widx == buffer.size() - 1; }
-    size_t capacity() const { return buffer.size() - 1; }
-
-    template <typename T>
-    void push(T&& o) noexcept
-    {
-      buffer[widx++] = std::forward<T>(o);
-      if (widx >= buffer.size()) {
-        widx = 0;
-      }
-    }
-
-    void pop() noexcept
-    {
-      ridx++;
-      if (ridx >= buffer.size()) {
-        ridx = 0;
-      }
-    }
-
-    myobj&       front() noexcept { return buffer[ridx]; }
-    const myobj& front() const noexcept { return buffer[ridx]; }
-
-  private:
-    std::vector<myobj> buffer;
-    size_t             widx = 0, ridx = 0;
+  struct queue_t {
+    explicit queue_t(uint32_t cap) : ring(cap), capacity(cap) {}
+    mpsc_queue<myobj> ring;
+    uint32_t          capacity; ///< Requested capacity, before rounding
+    std::atomic<bool> active{true};
   };
 
 public:
@@ -109,23 +82,30 @@ public:
     int                        queue_id = -1;
   };
 
-  explicit multiqueue_handler(uint32_t capacity_ = MULTIQUEUE_DEFAULT_CAPACITY) : capacity(capacity_) {}
+  explicit multiqueue_handler(uint32_t capacity_ = MULTIQUEUE_DEFAULT_CAPACITY) :
+    queues(new std::unique_ptr<queue_t>[MULTIQUEUE_MAX_QUEUES]),
+    capacity(capacity_)
+  {}
   ~multiqueue_handler() { reset(); }
 
+  /// Unblocks the waiting threads and discards all the queued objects. The queues cannot be used afterwards
   void reset()
   {
-    std::unique_lock<std::mutex> lock(mutex);
-    running = false;
-    while (nof_threads_waiting > 0) {
-      uint32_t size = queues.size();
-      cv_empty.notify_one();
-      for (uint32_t i = 0; i < size; ++i) {
-        queues[i].cv_full.notify_all();
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      running = false;
+      while (nof_threads_waiting > 0) {
+        cv_empty.notify_one();
+        cv_full.notify_all();
+        // wait for all threads to unblock
+        cv_exit.wait(lock);
       }
-      // wait for all threads to unblock
-      cv_exit.wait(lock);
     }
-    queues.clear();
+    std::lock_guard<std::mutex> pop_lock(pop_mutex);
+    for (uint32_t i = 0; i < nof_queues_.load(std::memory_order_relaxed); ++i) {
+      queues[i]->active = false;
+      clear_(*queues[i]);
+    }
   }
 
   /**
@@ -135,23 +115,28 @@ public:
    */
   int add_queue(uint32_t capacity_)
   {
-    uint32_t                    qidx = 0;
-    std::lock_guard<std::mutex> lock(mutex);
+    std::lock_guard<std::mutex> lock(pop_mutex);
     if (not running) {
       return -1;
     }
-    for (; qidx < queues.size() and queues[qidx].active; ++qidx)
+    uint32_t n = nof_queues_.load(std::memory_order_relaxed), qidx = 0;
+    for (; qidx < n and queues[qidx]->active; ++qidx)
       ;
 
     // check if there is a free queue of the required size
-    if (qidx == queues.size() || queues[qidx].capacity() != capacity_) {
-      // create new queue
-      queues.emplace_back(capacity_);
-      qidx = queues.size() - 1; // update qidx to the last element
-    } else {
-      queues[qidx].active = true;
+    if (qidx < n and queues[qidx]->capacity == capacity_) {
+      // drop the objects pushed through stale handles after the queue was erased
+      clear_(*queues[qidx]);
+      queues[qidx]->active = true;
+      return (int)qidx;
     }
-    return (int)qidx;
+    if (n == MULTIQUEUE_MAX_QUEUES) {
+      return -1;
+    }
+    // create new queue. The consumer only looks at it once the new number of queues is visible
+    queues[n].reset(new queue_t(capacity_));
+    nof_queues_.store(n + 1, std::memory_order_release);
+    return (int)n;
   }
 
   /**
@@ -162,166 +147,219 @@ public:
 
   int nof_queues()
   {
-    std::lock_guard<std::mutex> lock(mutex);
-    uint32_t                    count = 0;
-    for (uint32_t i = 0; i < queues.size(); ++i) {
-      count += queues[i].active ? 1 : 0;
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < nof_queues_.load(std::memory_order_acquire); ++i) {
+      count += queues[i]->active ? 1 : 0;
     }
     return count;
   }
 
+  /// Pushes the object, blocking while the queue is full
   template <typename FwdRef>
   void push(int q_idx, FwdRef&& value)
   {
-    {
+    if (not is_queue_active_(q_idx)) {
+      return;
+    }
+    queue_t& q = *queues[q_idx];
+    if (not q.ring.try_push(std::forward<FwdRef>(value))) {
       std::unique_lock<std::mutex> lock(mutex);
-      while (is_queue_active_(q_idx) and queues[q_idx].full()) {
+      nof_producers_waiting.fetch_add(1, std::memory_order_relaxed);
+      // pairs with the fence of the consumer after it frees a slot
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      bool pushed = false;
+      while (is_queue_active_(q_idx) and not(pushed = q.ring.try_push(std::forward<FwdRef>(value)))) {
         nof_threads_waiting++;
-        queues[q_idx].cv_full.wait(lock);
+        cv_full.wait(lock);
         nof_threads_waiting--;
       }
-      if (not is_queue_active_(q_idx)) {
+      nof_producers_waiting.fetch_sub(1, std::memory_order_relaxed);
+      if (not pushed) {
         cv_exit.notify_one();
         return;
       }
-      queues[q_idx].push(std::forward<FwdRef>(value));
     }
-    cv_empty.notify_one();
+    notify_consumer_();
   }
 
   bool try_push(int q_idx, const myobj& value)
   {
-    {
-      std::lock_guard<std::mutex> lock(mutex);
-      if (not is_queue_active_(q_idx) or queues[q_idx].full()) {
-        return false;
-      }
-      queues[q_idx].push(value);
+    if (not is_queue_active_(q_idx) or not queues[q_idx]->ring.try_push(value)) {
+      return false;
     }
-    cv_empty.notify_one();
+    notify_consumer_();
     return true;
   }
 
   std::pair<bool, myobj> try_push(int q_idx, myobj&& value)
   {
-    {
-      std::lock_guard<std::mutex> lck(mutex);
-      if (not is_queue_active_(q_idx) or queues[q_idx].full()) {
-        return {false, std::move(value)};
-      }
-      queues[q_idx].push(std::move(value));
+    if (not is_queue_active_(q_idx) or not queues[q_idx]->ring.try_push(std::move(value))) {
+      return {false, std::move(value)};
     }
-    cv_empty.notify_one();
+    notify_consumer_();
     return {true, std::move(value)};
   }
 
+  /// Called by the consumer. Blocks until there is an object to pop. Returns its queue index, or -1 after reset()
   int wait_pop(myobj* value)
   {
-    std::unique_lock<std::mutex> lock(mutex);
-    while (running) {
-      if (round_robin_pop_(value)) {
-        if (nof_threads_waiting > 0) {
-          lock.unlock();
-          queues[spin_idx].cv_full.notify_one();
-        }
-        return spin_idx;
+    while (true) {
+      int qidx = try_pop(value);
+      if (qidx >= 0) {
+        return qidx;
+      }
+      std::unique_lock<std::mutex> lock(mutex);
+      consumer_waiting.store(true, std::memory_order_relaxed);
+      // pairs with the fence of the producers after a push. Either they see the flag, or we see their object
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (running and not has_pending_()) {
+        nof_threads_waiting++;
+        cv_empty.wait(lock);
+        nof_threads_waiting--;
+      }
+      consumer_waiting.store(false, std::memory_order_relaxed);
+      if (not running) {
+        cv_exit.notify_one();
+        return -1;
       }
-      nof_threads_waiting++;
-      cv_empty.wait(lock);
-      nof_threads_waiting--;
     }
-    cv_exit.notify_one();
-    return -1;
   }
 
+  /// Called by the consumer. Returns the queue index of the popped object, or -1 if all the queues are empty
   int try_pop(myobj* value)
   {
-    std::unique_lock<std::mutex> lock(mutex);
-    if (running) {
-      if (round_robin_pop_(value)) {
-        if (nof_threads_waiting > 0) {
-          lock.unlock();
-          queues[spin_idx].cv_full.notify_one();
-        }
-        return spin_idx;
+    myobj tmp;
+    int   qidx;
+    {
+      std::lock_guard<std::mutex> pop_lock(pop_mutex);
+      if (not running or not round_robin_pop_(value != nullptr ? *value : tmp)) {
+        return -1;
       }
-      // didn't find any task
-      return -1;
+      qidx = spin_idx;
     }
-    cv_exit.notify_one();
-    return -1;
+    notify_producers_();
+    return qidx;
   }
 
-  bool empty(int qidx)
+  /// Called by the consumer. Appends up to max_objs objects to values, taking turns between the queues, without
+  /// blocking. Returns the number of objects popped
+  uint32_t try_pop_batch(std::vector<myobj>* values, uint32_t max_objs)
   {
-    std::lock_guard<std::mutex> lck(mutex);
-    return queues[qidx].empty();
+    uint32_t count = 0;
+    {
+      std::lock_guard<std::mutex> pop_lock(pop_mutex);
+      if (not running) {
+        return 0;
+      }
+      myobj tmp;
+      for (; count < max_objs and round_robin_pop_(tmp); ++count) {
+        values->push_back(std::move(tmp));
+      }
+    }
+    if (count > 0) {
+      notify_producers_();
+    }
+    return count;
   }
 
-  size_t size(int qidx)
-  {
-    std::lock_guard<std::mutex> lck(mutex);
-    return queues[qidx].size();
-  }
+  bool empty(int qidx) { return queues[qidx]->ring.empty(); }
 
-  size_t max_size(int qidx)
-  {
-    std::lock_guard<std::mutex> lck(mutex);
-    return queues[qidx].capacity();
-  }
+  size_t size(int qidx) { return queues[qidx]->ring.size(); }
 
-  const myobj& front(int qidx)
-  {
-    std::lock_guard<std::mutex> lck(mutex);
-    return queues[qidx].front();
-  }
+  size_t max_size(int qidx) { return queues[qidx]->ring.capacity(); }
 
   void erase_queue(int qidx)
   {
-    std::lock_guard<std::mutex> lck(mutex);
+    std::lock_guard<std::mutex> pop_lock(pop_mutex);
     if (is_queue_active_(qidx)) {
-      queues[qidx].active = false;
-      while (not queues[qidx].empty()) {
-        queues[qidx].pop();
-      }
+      queues[qidx]->active = false;
+      clear_(*queues[qidx]);
     }
+    // producers blocked on the erased queue give up
+    std::lock_guard<std::mutex> lock(mutex);
+    cv_full.notify_all();
   }
 
-  bool is_queue_active(int qidx)
-  {
-    std::lock_guard<std::mutex> lck(mutex);
-    return is_queue_active_(qidx);
-  }
+  bool is_queue_active(int qidx) { return is_queue_active_(qidx); }
 
   queue_handle get_queue_handler() { return {this, add_queue()}; }
   queue_handle get_queue_handler(uint32_t size) { return {this, add_queue(size)}; }
 
 private:
-  bool is_queue_active_(int qidx) const { return running and queues[qidx].active; }
+  bool is_queue_active_(int qidx) const
+  {
+    return running and qidx >= 0 and qidx < (int)nof_queues_.load(std::memory_order_acquire) and
+           queues[qidx]->active;
+  }
+
+  bool has_pending_() const
+  {
+    for (uint32_t i = 0; i < nof_queues_.load(std::memory_order_acquire); ++i) {
+      if (queues[i]->active and not queues[i]->ring.empty()) {
+        return true;
+      }
+    }
+    return false;
+  }
 
-  bool round_robin_pop_(myobj* value)
+  // Called with the pop_mutex held
+  bool round_robin_pop_(myobj& value)
   {
-    // Round-robin for all queues
-    for (const circular_buffer& q : queues) {
-      spin_idx = (spin_idx + 1) % queues.size();
-      if (is_queue_active_(spin_idx) and not queues[spin_idx].empty()) {
-        if (value) {
-          *value = std::move(queues[spin_idx].front());
-        }
-        queues[spin_idx].pop();
+    uint32_t n = nof_queues_.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < n; ++i) {
+      spin_idx = (spin_idx + 1) % n;
+      if (queues[spin_idx]->active and queues[spin_idx]->ring.try_pop(value)) {
         return true;
       }
     }
     return false;
   }
 
-  std::mutex                   mutex;
-  std::condition_variable      cv_empty, cv_exit;
-  uint32_t                     spin_idx = 0;
-  bool                         running  = true;
-  std::vector<circular_buffer> queues;
-  uint32_t                     capacity            = 0;
-  uint32_t                     nof_threads_waiting = 0;
+  // Called with the pop_mutex held
+  void clear_(queue_t& q)
+  {
+    myobj tmp;
+    while (q.ring.try_pop(tmp)) {
+    }
+  }
+
+  void notify_consumer_()
+  {
+    // pairs with the fence of the consumer before it goes to sleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumer_waiting.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(mutex);
+      cv_empty.notify_one();
+    }
+  }
+
+  void notify_producers_()
+  {
+    // pairs with the fence of a producer before it waits for room in a full queue
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (nof_producers_waiting.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(mutex);
+      cv_full.notify_all();
+    }
+  }
+
+  // The queues are never moved or freed while the multiqueue exists, so the producers can use them without locks
+  std::unique_ptr<std::unique_ptr<queue_t>[]> queues;
+  std::atomic<uint32_t>                       nof_queues_{0};
+  uint32_t                                    capacity = 0;
+  std::atomic<bool>                           running{true};
+
+  // Held by the consumer while popping, and when adding or erasing queues. Written on every pop, so it is kept away
+  // from the flags that the producers read on every push
+  alignas(64) std::mutex pop_mutex;
+  uint32_t               spin_idx = 0;
+
+  // Sleep and wake-up state. The mutex is only locked by the threads that go to sleep and by the ones that wake them up
+  alignas(64) std::atomic<bool> consumer_waiting{false};
+  std::atomic<uint32_t>         nof_producers_waiting{0};
+  std::mutex                    mutex;
+  std::condition_variable       cv_empty, cv_full, cv_exit;
+  uint32_t                      nof_threads_waiting = 0;
 };
 
 //! Specialization for tasks
@@ -23,28 +23,28 @@
 #define SRSLTE_NAS_PCAP_H
 
 #include "srslte/common/pcap.h"
+#include "srslte/common/pcap_writer.h"
 
 namespace srslte {
 
 class nas_pcap
 {
 public:
-  nas_pcap()
+  nas_pcap() : writer("NAS_PCAP")
   {
     enable_write = false;
     ue_id        = 0;
-    pcap_file    = NULL;
   }
   void enable();
-  void open(const char* filename, uint32_t ue_id = 0);
+  void open(const char* filename, uint32_t ue_id = 0, const pcap_rotation_t& rotation = {});
   void close();
   void write_nas(uint8_t* pdu, uint32_t pdu_len_bytes);
 
 private:
-  bool     enable_write;
-  FILE*    pcap_file;
-  uint32_t ue_id;
-  void     pack_and_write(uint8_t* pdu, uint32_t pdu_len_bytes);
+  bool        enable_write;
+  pcap_writer writer;
+  uint32_t    ue_id;
+  void        pack_and_write(uint8_t* pdu, uint32_t pdu_len_bytes);
 };
 
 } // namespace srslte
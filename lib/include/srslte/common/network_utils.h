@@ -28,12 +28,14 @@
 
 #include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <netinet/sctp.h>
 #include <queue>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h> // for the pipe
+#include <vector>
 
 namespace srslte {
 
@@ -109,27 +111,46 @@ int  tcp_send(int remotefd, const void* buf, size_t nbytes);
  * Rx multisocket handler
  ***************************/
 
+class io_uring_queue;
+
 /**
- * Description - Instantiates a thread that will block waiting for IO from multiple sockets, via a select
+ * Description - Instantiates a thread that will block waiting for IO from multiple sockets, via epoll
  *               The user can register their own (socket fd, data handler) in this class via the
- *               add_socket_handler(fd, task) API or its other variants
+ *               add_socket_handler(fd, task) API or its other variants. Datagram sockets registered with
+ *               add_socket_pdu_batch_handler(fd, task) are read with recvmmsg, up to MAX_RECV_BATCH packets
+ *               per syscall, and their packets are passed to the task as a batch.
+ *               With use_io_uring, and if the kernel supports it, the thread waits on an io_uring instead.
+ *               Datagram sockets then have a multishot recvmsg that fills pool buffers handed to the kernel
+ *               beforehand, so no syscall is made per packet, and the rest of the sockets are polled through the
+ *               ring
  */
 class rx_multisocket_handler final : public thread
 {
 public:
+  struct rx_datagram_t {
+    srslte::unique_byte_buffer_t pdu;
+    sockaddr_in                  from;
+  };
+  using recvfrom_batch_t          = std::vector<rx_datagram_t>;
+  using recvfrom_batch_callback_t = std::function<void(recvfrom_batch_t)>;
+
   // polymorphic callback to handle the socket recv
   class recv_task
   {
   public:
     virtual ~recv_task()            = default;
     virtual bool operator()(int fd) = 0; // returns false, if socket needs to be removed
+    // batch callback of datagram sockets, whose packets can be received without calling the task
+    virtual recvfrom_batch_callback_t* get_batch_callback() { return nullptr; }
   };
   using task_callback_t     = std::unique_ptr<recv_task>;
   using recvfrom_callback_t = std::function<void(srslte::unique_byte_buffer_t, const sockaddr_in&)>;
   using sctp_recv_callback_t =
       std::function<void(srslte::unique_byte_buffer_t, const sockaddr_in&, const sctp_sndrcvinfo&, int)>;
 
-  rx_multisocket_handler(std::string name_, srslte::log_ref log_, int thread_prio = 65);
+  static const uint32_t MAX_RECV_BATCH = 32;
+
+  rx_multisocket_handler(std::string name_, srslte::log_ref log_, int thread_prio = 65, bool use_io_uring = false);
   rx_multisocket_handler(rx_multisocket_handler&&)      = delete;
   rx_multisocket_handler(const rx_multisocket_handler&) = delete;
   rx_multisocket_handler& operator=(const rx_multisocket_handler&) = delete;
@@ -142,17 +163,30 @@ public:
   // convenience methods for recv using buffer pool
   bool add_socket_pdu_handler(int fd, recvfrom_callback_t pdu_task);
   bool add_socket_sctp_pdu_handler(int fd, sctp_recv_callback_t task);
+  bool add_socket_pdu_batch_handler(int fd, recvfrom_batch_callback_t batch_task);
+
+  bool uses_io_uring() const { return uring != nullptr; }
 
   void run_thread() override;
 
 private:
-  // used to unlock select
+  // used to unlock epoll_wait
   struct ctrl_cmd_t {
-    enum class cmd_id_t { EXIT, NEW_FD, RM_FD };
+    enum class cmd_id_t { EXIT, RM_FD, ADD_FD };
     cmd_id_t cmd    = cmd_id_t::EXIT;
     int      new_fd = -1;
   };
-  bool remove_socket_unprotected(int fd, fd_set* total_fd_set, int* max_fd);
+  struct uring_socket_t;
+  bool remove_socket_unprotected(int fd);
+
+  // io_uring backend, only used from the handler thread
+  void run_uring_thread();
+  void uring_handle_cqe(uint64_t user_data, int32_t res, uint32_t flags);
+  void uring_add_socket(int fd);
+  void uring_remove_socket(int fd);
+  void uring_arm_ctrl();
+  void uring_arm(uring_socket_t& s);
+  void uring_release_closed();
 
   // args
   std::string               name;
@@ -163,7 +197,16 @@ private:
   std::mutex                     socket_mutex;
   std::map<int, task_callback_t> active_sockets;
   bool                           running   = false;
-  int                            pipefd[2] = {};
+  int                            pipefd[2] = {-1, -1};
+  int                            epoll_fd  = -1;
+
+  // io_uring state
+  std::unique_ptr<io_uring_queue>                 uring;
+  std::map<int, std::unique_ptr<uring_socket_t> > uring_sockets;
+  std::vector<std::unique_ptr<uring_socket_t> >   uring_closing; // removed, waiting for their last completion
+  std::vector<uring_socket_t*>                    uring_ready;   // sockets with received packets or to be re-armed
+  ctrl_cmd_t                                      uring_ctrl_msg;
+  uint16_t                                        uring_next_bgid = 0;
 };
 
 } // namespace srslte
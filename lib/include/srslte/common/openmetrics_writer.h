@@ -0,0 +1,71 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_OPENMETRICS_WRITER_H
+#define SRSLTE_OPENMETRICS_WRITER_H
+
+#include <stdio.h>
+#include <string>
+
+namespace srslte {
+
+/// Builds the text of a scrape in the Prometheus/OpenMetrics text format. The names are prefixed with the given
+/// prefix, and the samples of a family have to be added right after it
+class openmetrics_writer
+{
+public:
+  explicit openmetrics_writer(std::string prefix_) : prefix(std::move(prefix_)) {}
+
+  /// Starts a family of samples. The type is "gauge" or "counter", the names of counters end in _total
+  void family(const char* name_, const char* type, const char* help)
+  {
+    name = prefix + name_;
+    text += "# HELP " + name + " " + help + "\n";
+    text += "# TYPE " + name + " " + type + "\n";
+  }
+
+  /// Adds a sample of the current family. The labels are given without braces, e.g. rnti="0x46",cell="0"
+  void sample(const std::string& labels, double value)
+  {
+    char v[32];
+    snprintf(v, sizeof(v), "%.15g", value);
+    text += name;
+    if (not labels.empty()) {
+      text += "{" + labels + "}";
+    }
+    text += " ";
+    text += v;
+    text += "\n";
+  }
+  void sample(double value) { sample("", value); }
+
+  std::string&       str() { return text; }
+  const std::string& get_prefix() const { return prefix; }
+
+private:
+  std::string prefix;
+  std::string name;
+  std::string text;
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_OPENMETRICS_WRITER_H
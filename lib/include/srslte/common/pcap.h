@@ -31,6 +31,9 @@
 #define UDP_DLT 149 // UDP needs to be selected as protocol
 #define S1AP_LTE_DLT 150
 
+/* Maximum length of the context that precedes a PDU in a PCAP packet */
+#define PCAP_CONTEXT_HEADER_MAX 256
+
 /* This structure gets written to the start of the file */
 typedef struct pcap_hdr_s {
   unsigned int   magic_number;  /* magic number */
@@ -196,18 +199,27 @@ FILE* LTE_PCAP_Open(uint32_t DLT, const char* fileName);
 /* Close the PCAP file */
 void LTE_PCAP_Close(FILE* fd);
 
+/* Pack the mac-context of a MAC PDU into context_header, returns its length */
+int LTE_PCAP_MAC_PackContext(const MAC_Context_Info_t* context, unsigned char* context_header);
+
 /* Write an individual MAC PDU (PCAP packet header + mac-context + mac-pdu) */
 int LTE_PCAP_MAC_WritePDU(FILE* fd, MAC_Context_Info_t* context, const unsigned char* PDU, unsigned int length);
 
 /* Write an individual NAS PDU (PCAP packet header + nas-context + nas-pdu) */
 int LTE_PCAP_NAS_WritePDU(FILE* fd, NAS_Context_Info_t* context, const unsigned char* PDU, unsigned int length);
 
+/* Pack the UDP header and rlc-context of an RLC PDU into context_header, returns their length */
+int LTE_PCAP_RLC_PackContext(const RLC_Context_Info_t* context, unsigned int length, unsigned char* context_header);
+
 /* Write an individual RLC PDU (PCAP packet header + UDP header + rlc-context + rlc-pdu) */
 int LTE_PCAP_RLC_WritePDU(FILE* fd, RLC_Context_Info_t* context, const unsigned char* PDU, unsigned int length);
 
 /* Write an individual S1AP PDU (PCAP packet header + s1ap-context + s1ap-pdu) */
 int LTE_PCAP_S1AP_WritePDU(FILE* fd, S1AP_Context_Info_t* context, const unsigned char* PDU, unsigned int length);
 
+/* Pack the UDP header and nr-mac-context of an NR MAC PDU into context_header, returns their length */
+int NR_PCAP_MAC_PackContext(const mac_nr_context_info_t* context, unsigned int length, unsigned char* context_header);
+
 /* Write an individual NR MAC PDU (PCAP packet header + UDP header + nr-mac-context + mac-pdu) */
 int NR_PCAP_MAC_WritePDU(FILE* fd, mac_nr_context_info_t* context, const unsigned char* PDU, unsigned int length);
 
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#ifndef SRSLTE_PCAP_WRITER_H
+#define SRSLTE_PCAP_WRITER_H
+
+#include "srslte/common/pcap.h"
+#include "srslte/common/threads.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace srslte {
+
+/// Rotation of the capture files. A new file is started when the current one would exceed max_file_size bytes or
+/// holds packets spanning max_file_duration seconds, zero disables the limit
+struct pcap_rotation_t {
+  uint64_t max_file_size     = 0;
+  uint32_t max_file_duration = 0;
+};
+
+/**
+ * Writes the packets of a PCAP file from a background thread
+ *
+ * The producers take the timestamp and copy the context and the PDU into a preallocated byte ring, claiming their
+ * space with a CAS on the tail, so they never take a lock or make a system call. The writer thread wakes up
+ * periodically, moves the packets of the ring into a large buffer and writes it to the file at once. When the ring is
+ * full the packet is dropped and counted. close() lets the producers in flight finish before the last drain. Rotated
+ * files are named like the first one with the file index before the extension, e.g. enb_mac.1.pcap.
+ */
+class pcap_writer : public thread
+{
+public:
+  static const uint32_t default_ring_size = 4 * 1024 * 1024;
+
+  /// The ring size is rounded up to a power of two
+  explicit pcap_writer(const std::string& thread_name = "PCAP_WRITER", uint32_t ring_size = default_ring_size);
+  ~pcap_writer();
+  pcap_writer(const pcap_writer&) = delete;
+  pcap_writer& operator=(const pcap_writer&) = delete;
+
+  /// Opens the file and starts the writer thread. Must not be called concurrently with write()
+  bool open(uint32_t dlt, const std::string& filename, const pcap_rotation_t& rotation = {});
+  /// Writes the pending packets, closes the file and stops the writer thread
+  void close();
+  bool is_open() const { return running.load(std::memory_order_relaxed); }
+
+  /// Thread-safe. Queues a packet made of the context followed by the PDU. Returns false if the packet was dropped
+  bool write(const uint8_t* context, uint32_t context_len, const uint8_t* pdu, uint32_t pdu_len);
+
+  uint64_t nof_dropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+  bool     queue_packet(const uint8_t* context, uint32_t context_len, const uint8_t* pdu, uint32_t pdu_len);
+  void     run_thread() override;
+  uint32_t drain();
+  void     append_packet(const uint8_t* packet, uint32_t len);
+  void     flush_buffer();
+  bool     open_file();
+
+  // Every record starts with its committed length, with padding_flag set for the padding at the end of the ring
+  static const uint32_t record_header_size = 8;
+  static const uint32_t padding_flag       = 1u << 31u;
+  static const uint32_t write_buffer_size  = 1024 * 1024;
+
+  std::atomic<uint32_t>* record_word(uint64_t pos)
+  {
+    return reinterpret_cast<std::atomic<uint32_t>*>(ring.get() + (pos & ring_mask));
+  }
+
+  std::unique_ptr<uint8_t[]> ring;
+  uint32_t                   ring_size = 0;
+  uint32_t                   ring_mask = 0;
+  std::atomic<uint64_t>      tail{0};
+  char                       pad[64 - sizeof(std::atomic<uint64_t>)];
+  std::atomic<uint64_t>      head{0};
+  std::atomic<uint64_t>      dropped{0};
+  std::atomic<bool>          running{false};
+  std::atomic<uint32_t>      nof_writers{0};
+
+  // Used by the writer thread only
+  uint32_t             dlt = 0;
+  std::string          base_filename;
+  pcap_rotation_t      rotation;
+  FILE*                file       = nullptr;
+  uint32_t             file_index = 0;
+  uint64_t             file_size  = 0;
+  bool                 file_empty = true;
+  uint32_t             file_start = 0;
+  std::vector<uint8_t> write_buffer;
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_PCAP_WRITER_H
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_PERF_COUNTERS_H
+#define SRSLTE_PERF_COUNTERS_H
+
+#include <cstdint>
+
+/**
+ *
+ * @file perf_counters.h
+ *
+ * @brief Hardware performance counters of the calling thread
+ *
+ * Every thread opens its own group of counters with perf_event_open the first time it reads them, so a read is a
+ * single system call and counts only the code of that thread. The difference of two reads around a region, e.g. a
+ * TTI stage, tells whether it is bound by computation (high IPC) or by memory (many cache misses), without attaching
+ * an external profiler to the real-time process. The counters are only read once they are enabled.
+ */
+
+namespace srslte {
+
+struct perf_counter_values {
+  uint64_t cycles        = 0;
+  uint64_t instructions  = 0;
+  uint64_t l1d_misses    = 0;
+  uint64_t llc_misses    = 0;
+  uint64_t branch_misses = 0;
+
+  perf_counter_values& operator+=(const perf_counter_values& other)
+  {
+    cycles += other.cycles;
+    instructions += other.instructions;
+    l1d_misses += other.l1d_misses;
+    llc_misses += other.llc_misses;
+    branch_misses += other.branch_misses;
+    return *this;
+  }
+  perf_counter_values operator-(const perf_counter_values& other) const
+  {
+    perf_counter_values d;
+    d.cycles        = cycles - other.cycles;
+    d.instructions  = instructions - other.instructions;
+    d.l1d_misses    = l1d_misses - other.l1d_misses;
+    d.llc_misses    = llc_misses - other.llc_misses;
+    d.branch_misses = branch_misses - other.branch_misses;
+    return d;
+  }
+
+  /// Instructions per cycle
+  double ipc() const { return cycles > 0 ? (double)instructions / cycles : 0; }
+  /// Events per thousand instructions, e.g. the LLC misses
+  double per_kinstr(uint64_t events) const { return instructions > 0 ? 1000.0 * events / instructions : 0; }
+};
+
+namespace perf_counters {
+
+/// Enables the reading of the counters in all the threads. Returns false, and leaves them disabled, if the kernel
+/// does not allow this process to count the cycles and instructions (see /proc/sys/kernel/perf_event_paranoid)
+bool enable();
+
+bool is_enabled();
+
+/// Reads the counters of the calling thread. The events the CPU does not support read as 0. Returns false if the
+/// counters are disabled or could not be opened
+bool read(perf_counter_values* values);
+
+} // namespace perf_counters
+
+} // namespace srslte
+
+#endif // SRSLTE_PERF_COUNTERS_H
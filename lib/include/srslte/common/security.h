@@ -27,6 +27,7 @@
  *****************************************************************************/
 
 #include "srslte/common/common.h"
+#include <memory>
 
 namespace srslte {
 
@@ -169,6 +170,66 @@ uint8_t security_128_eea3(uint8_t* key,
                           uint32_t msg_len,
                           uint8_t* msg_out);
 
+/******************************************************************************
+ * 128-EEA2/EIA2 with an expanded key
+ *****************************************************************************/
+
+/**
+ * AES-128 key schedule and CMAC subkeys of a 128-EEA2/EIA2 key
+ *
+ * Expanding the key costs about as much as ciphering a short PDU, so the PDCP entities expand their keys once and
+ * reuse them for every PDU. The AES rounds run through mbedTLS, which uses the AES-NI instructions when the CPU has
+ * them.
+ */
+class security_aes128_key
+{
+public:
+  security_aes128_key();
+  ~security_aes128_key();
+  security_aes128_key(security_aes128_key&&);
+  security_aes128_key& operator=(security_aes128_key&&);
+  security_aes128_key(const security_aes128_key&) = delete;
+  security_aes128_key& operator=(const security_aes128_key&) = delete;
+
+  /// Expands the 16 byte key, unless it is the key already held
+  void set(const uint8_t* key);
+
+private:
+  struct impl;
+  std::unique_ptr<impl> pimpl;
+
+  friend uint8_t security_128_eia2(const security_aes128_key& key,
+                                   uint32_t                   count,
+                                   uint32_t                   bearer,
+                                   uint8_t                    direction,
+                                   const uint8_t*             msg,
+                                   uint32_t                   msg_len,
+                                   uint8_t*                   mac);
+  friend uint8_t security_128_eea2(const security_aes128_key& key,
+                                   uint32_t                   count,
+                                   uint8_t                    bearer,
+                                   uint8_t                    direction,
+                                   const uint8_t*             msg,
+                                   uint32_t                   msg_len,
+                                   uint8_t*                   msg_out);
+};
+
+uint8_t security_128_eia2(const security_aes128_key& key,
+                          uint32_t                   count,
+                          uint32_t                   bearer,
+                          uint8_t                    direction,
+                          const uint8_t*             msg,
+                          uint32_t                   msg_len,
+                          uint8_t*                   mac);
+
+uint8_t security_128_eea2(const security_aes128_key& key,
+                          uint32_t                   count,
+                          uint8_t                    bearer,
+                          uint8_t                    direction,
+                          const uint8_t*             msg,
+                          uint32_t                   msg_len,
+                          uint8_t*                   msg_out);
+
 /******************************************************************************
  * Authentication
  *****************************************************************************/
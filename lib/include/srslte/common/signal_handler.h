@@ -41,6 +41,9 @@ extern "C" {
 static srslog::sink*       log_sink = nullptr;
 static bool                running = true;
 
+// Set on SIGUSR1, the application prints the memory of each subsystem from its main loop
+static volatile sig_atomic_t mem_dump_requested = 0;
+
 static void srslte_signal_handler(int signal)
 {
   switch (signal) {
@@ -72,6 +75,16 @@ void srslte_register_signal_handler()
   signal(SIGALRM, srslte_signal_handler);
 }
 
+static void srslte_mem_dump_signal_handler(int signal)
+{
+  mem_dump_requested = 1;
+}
+
+void srslte_register_mem_dump_signal_handler()
+{
+  signal(SIGUSR1, srslte_mem_dump_signal_handler);
+}
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
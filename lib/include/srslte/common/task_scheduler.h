@@ -66,13 +66,13 @@ public:
   void defer_task(srslte::move_task_t func) { internal_tasks.push_back(std::move(func)); }
 
   //! Delegates a task to a thread pool that runs in the background
-  void enqueue_background_task(std::function<void(uint32_t)> f)
+  void enqueue_background_task(srslte::task_thread_pool::task_t f)
   {
     if (background_tasks.nof_workers() > 0) {
       background_tasks.push_task(std::move(f));
     } else {
       external_tasks.push(background_queue_id,
-                          std::bind([](const std::function<void(uint32_t)>& task) { task(0); }, std::move(f)));
+                          std::bind([](const srslte::task_thread_pool::task_t& task) { task(0); }, std::move(f)));
     }
   }
 
@@ -101,20 +101,25 @@ public:
     return false;
   }
 
-  //! Processes the next task in the multiqueue if it exists.
+  //! Processes the pending tasks in the multiqueue, popping them in batches.
   void run_pending_tasks()
   {
     run_all_internal_tasks();
-    srslte::move_task_t task{};
-    while (external_tasks.try_pop(&task) >= 0) {
-      task();
-      run_all_internal_tasks();
+    std::vector<srslte::move_task_t> batch;
+    while (external_tasks.try_pop_batch(&batch, max_task_batch) > 0) {
+      for (srslte::move_task_t& task : batch) {
+        task();
+        run_all_internal_tasks();
+      }
+      batch.clear();
     }
   }
 
   srslte::timer_handler* get_timer_handler() { return &timers; }
 
 private:
+  static const uint32_t max_task_batch = 16;
+
   void run_all_internal_tasks()
   {
     // Perform pending stack deferred tasks
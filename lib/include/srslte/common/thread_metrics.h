@@ -0,0 +1,114 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_THREAD_METRICS_H
+#define SRSLTE_THREAD_METRICS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ *
+ * @file thread_metrics.h
+ *
+ * @brief Histograms of the values observed by every thread, e.g. processing times and queue depths
+ *
+ * Every thread counts its observations in histograms that only it writes, so observing a value takes no lock and
+ * touches no shared cache line. The histograms of the threads are read and merged when the metrics are exported.
+ */
+
+namespace srslte {
+
+enum class thread_metric : uint8_t {
+  phy_worker_time_us,
+  sched_time_us,
+  stack_queue_depth,
+  buffer_pool_used,
+  nof_metrics
+};
+
+/// Name of the metric in the exported metrics, without the application prefix
+const char* to_string(thread_metric metric);
+
+namespace thread_metrics {
+
+/// Bucket i counts the values in (2^(i-1), 2^i], the first one also smaller values and the last one larger values
+const uint32_t nof_buckets = 24;
+
+struct histogram_t {
+  std::string thread_name;
+  uint64_t    buckets[nof_buckets];
+  uint64_t    count;
+  uint64_t    sum;
+};
+
+/// Upper bound of the values counted in the bucket
+inline uint64_t bucket_limit(uint32_t bucket)
+{
+  return uint64_t(1) << bucket;
+}
+
+/// Counts a value in the histogram of the metric of the calling thread
+void observe(thread_metric metric, uint32_t value);
+
+/// Returns the histograms of the metric, merged by thread name and ordered by it. Threads may be observing meanwhile
+std::vector<histogram_t> collect(thread_metric metric);
+
+/// Appends the histograms of all the metrics, labelled with the thread, in the OpenMetrics text format
+void write_openmetrics(const std::string& prefix, std::string& out);
+
+/// Appends the CPU time of every thread of the process, read from /proc, in the OpenMetrics text format
+void write_thread_cpu_time(const std::string& prefix, std::string& out);
+
+/// Appends the memory counted for every subsystem by mem_accounting.h and the resident memory of the process
+void write_memory_usage(const std::string& prefix, std::string& out);
+
+} // namespace thread_metrics
+
+/// Observes the time in microseconds from its construction until stop() or its destruction
+class thread_metric_timer
+{
+public:
+  explicit thread_metric_timer(thread_metric metric_) : metric(metric_), start(std::chrono::steady_clock::now()) {}
+  ~thread_metric_timer() { stop(); }
+  thread_metric_timer(const thread_metric_timer&) = delete;
+  thread_metric_timer& operator=(const thread_metric_timer&) = delete;
+
+  void stop()
+  {
+    if (running) {
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      thread_metrics::observe(metric, (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+      running = false;
+    }
+  }
+
+private:
+  thread_metric                         metric;
+  std::chrono::steady_clock::time_point start;
+  bool                                  running = true;
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_THREAD_METRICS_H
@@ -29,7 +29,9 @@
 #ifndef SRSLTE_THREAD_POOL_H
 #define SRSLTE_THREAD_POOL_H
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -39,6 +41,7 @@
 #include <string>
 #include <vector>
 
+#include "srslte/adt/move_callback.h"
 #include "srslte/common/threads.h"
 
 namespace srslte {
@@ -78,6 +81,13 @@ public:
   worker*  get_worker(uint32_t id);
   uint32_t get_nof_workers();
 
+  // Limits wait_worker() and wait_worker_nb() to the first workers, the rest stay idle until the limit is raised
+  void     set_nof_active_workers(uint32_t nof_active);
+  uint32_t get_nof_active_workers();
+
+  // Waits until none of the workers is working. Returns false if the pool is stopped
+  bool wait_idle();
+
 private:
   bool find_finished_worker(uint32_t tti, uint32_t* id);
 
@@ -86,6 +96,7 @@ private:
   std::vector<worker*>                 workers     = {};
   uint32_t                             nof_workers = 0;
   uint32_t                             max_workers = 0;
+  uint32_t                             max_active  = 0;
   bool                                 running     = false;
   std::condition_variable              cvar_queue  = {};
   std::mutex                           mutex_queue = {};
@@ -93,29 +104,41 @@ private:
   std::vector<std::condition_variable> cvar_worker = {};
 };
 
+/**
+ * Pool of threads that run tasks. Each worker has its own task queues, one per priority. Tasks pushed from outside the
+ * pool go to the workers in turn, and tasks pushed by a worker go to its own queues. A worker runs its own tasks first
+ * and, when it has none left, steals the tasks of the other workers. High priority tasks of all the workers are run
+ * before the normal ones
+ */
 class task_thread_pool
 {
-  using task_t = std::function<void(uint32_t worker_id)>;
-
 public:
+  using task_t = srslte::move_callback<void(uint32_t worker_id)>;
+  enum class task_priority { high, normal };
+
   explicit task_thread_pool(uint32_t nof_workers);
   ~task_thread_pool();
   void start(int32_t prio = -1, uint32_t mask = 255);
   void stop();
 
-  void     push_task(const task_t& task);
-  void     push_task(task_t&& task);
+  void     push_task(task_t&& task, task_priority priority = task_priority::normal);
   uint32_t nof_pending_tasks();
   size_t   nof_workers() const { return workers.size(); }
 
 private:
+  static const uint32_t nof_priorities = 2;
+
+  struct worker_queue_t {
+    std::mutex         mutex;
+    std::deque<task_t> tasks[nof_priorities];
+  };
+
   class worker_t : public thread
   {
   public:
     explicit worker_t(task_thread_pool* parent_, uint32_t id);
     void     stop();
     void     setup(int32_t prio, uint32_t mask);
-    bool     is_running() const { return running; }
     uint32_t id() const { return id_; }
 
     void run_thread() override;
@@ -123,16 +146,20 @@ private:
   private:
     bool wait_task(task_t* task);
 
-    task_thread_pool* parent  = nullptr;
-    uint32_t          id_     = 0;
-    bool              running = false;
+    task_thread_pool* parent = nullptr;
+    uint32_t          id_    = 0;
   };
 
-  std::queue<task_t>      pending_tasks;
-  std::vector<worker_t>   workers;
-  std::mutex              queue_mutex;
-  std::condition_variable cv_empty;
-  bool                    running;
+  bool pop_task(uint32_t worker_id, task_t* task);
+
+  std::vector<worker_t>                         workers;
+  std::vector<std::unique_ptr<worker_queue_t> > queues;
+  std::atomic<uint32_t>                         nof_pending{0};  ///< tasks in all the queues
+  std::atomic<uint32_t>                         nof_sleeping{0}; ///< workers waiting for a task
+  std::atomic<uint32_t>                         next_queue{0};
+  std::mutex                                    sleep_mutex;
+  std::condition_variable                       cv_empty;
+  std::atomic<bool>                             running;
 };
 
 } // namespace srslte
@@ -41,6 +41,26 @@ bool threads_new_rt_cpu(pthread_t* thread, void* (*start_routine)(void*), void*
 bool threads_new_rt_mask(pthread_t* thread, void* (*start_routine)(void*), void* arg, int mask, int prio_offset);
 void threads_print_self();
 
+/* Thread placement by role. A role applies to the thread of the same name and to its numbered instances, e.g. WORKER
+ * places WORKER0, WORKER1... A role ending with '_' applies to all the threads whose name starts with it. The
+ * placement is "cpus[:policy[:priority]]" where cpus is a list of CPUs and ranges such as "2,4-5" (empty keeps the
+ * affinity), policy is other, fifo or rr and priority is the real-time priority of fifo and rr. Placements are set at
+ * start-up, before the threads are created. */
+bool threads_set_placement(const char* role, const char* placement);
+// Applies the placement of the thread name, if any, to the calling thread
+bool threads_apply_placement(const char* name);
+// Applies the placements to the threads of the process which are already running, looking them up by name
+void threads_apply_placement_all();
+
+/* NUMA placement. The node of a placement is the node of all its CPUs, or -1 if the CPUs are on several nodes or
+ * the system has no NUMA support. */
+int threads_placement_node(const char* name);
+// Places the threads role0, role1... each on the CPUs of one NUMA node of the placement of role (or of the process
+// if role has none), taking the nodes in turn. Returns false if the CPUs are all on one node
+bool threads_spread_placement(const char* role, int nof_threads);
+// Memory first touched by the calling thread is allocated on node, or on the local node if node is -1
+bool threads_set_memory_node(int node);
+
 #ifdef __cplusplus
 }
 
@@ -84,6 +104,7 @@ public:
   {
     name = name_;
     pthread_setname_np(pthread_self(), name.c_str());
+    threads_apply_placement(name.c_str());
   }
 
   void wait_thread_finish() { pthread_join(_thread, NULL); }
@@ -108,6 +129,7 @@ private:
   static void* thread_function_entry(void* _this)
   {
     pthread_setname_np(pthread_self(), ((thread*)_this)->name.c_str());
+    threads_apply_placement(((thread*)_this)->name.c_str());
     ((thread*)_this)->run_thread();
     return NULL;
   }
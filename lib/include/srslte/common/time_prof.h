@@ -23,6 +23,7 @@
 #define SRSLTE_TIME_PROF_H
 
 #include "srslte/common/logmap.h"
+#include "srslte/common/perf_counters.h"
 #include <chrono>
 
 #ifdef ENABLE_TIMEPROF
@@ -33,22 +34,33 @@
 
 namespace srslte {
 
-// individual time interval measure
+// individual time interval measure, which also counts the hardware events of the interval once the perf counters
+// are enabled
 class tprof_measure
 {
 public:
   using tpoint = std::chrono::time_point<std::chrono::high_resolution_clock>;
 
   tprof_measure() = default;
-  void                     start() { t1 = std::chrono::high_resolution_clock::now(); }
+  void start()
+  {
+    has_counters = perf_counters::read(&c1);
+    t1           = std::chrono::high_resolution_clock::now();
+  }
   std::chrono::nanoseconds stop()
   {
-    auto t2 = std::chrono::high_resolution_clock::now();
+    auto                t2 = std::chrono::high_resolution_clock::now();
+    perf_counter_values c2;
+    counters = (has_counters and perf_counters::read(&c2)) ? c2 - c1 : perf_counter_values{};
     return std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1);
   }
+  /// Hardware events of the last interval, all 0 when the perf counters are disabled
+  const perf_counter_values& get_counters() const { return counters; }
 
 private:
-  tpoint t1;
+  tpoint              t1;
+  perf_counter_values c1, counters;
+  bool                has_counters = false;
 };
 
 template <typename Prof, bool Enabled = TPROF_ENABLE_DEFAULT>
@@ -65,7 +77,7 @@ public:
   std::chrono::nanoseconds stop()
   {
     auto d = meas.stop();
-    prof(d);
+    prof(d, meas.get_counters());
     return d;
   }
 
@@ -103,7 +115,7 @@ struct mutexed_tprof {
     {
       auto                        d = meas.stop();
       std::lock_guard<std::mutex> lock(h->mutex);
-      h->prof(d);
+      h->prof(d, meas.get_counters());
       return d;
     }
     void defer_stop() { deferred = true; }
@@ -143,6 +155,7 @@ struct mutexed_tprof<Prof, false> {
 struct avg_time_stats {
   avg_time_stats(const char* name_, const char* logname, size_t print_period_);
   void operator()(std::chrono::nanoseconds duration);
+  void operator()(std::chrono::nanoseconds duration, const perf_counter_values& counters) { (*this)(duration); }
 
   srslte::log_ref log_ptr;
   std::string     name;
@@ -157,11 +170,14 @@ class sliding_window_stats
 public:
   sliding_window_stats(const char* name_, const char* logname, size_t print_period_ = 10);
   void operator()(std::chrono::nanoseconds duration);
+  /// Also aggregates the hardware events of the window, which are logged with the durations if they were counted
+  void operator()(std::chrono::nanoseconds duration, const perf_counter_values& counters);
 
   srslte::log_ref                       log_ptr;
   std::string                           name;
   std::vector<std::chrono::nanoseconds> sliding_window;
   size_t                                window_idx = 0;
+  perf_counter_values                   window_counters;
 };
 using sliding_window_stats_ms = sliding_window_stats<std::chrono::milliseconds>;
 
@@ -49,16 +49,25 @@ public:
   virtual void timer_expired(uint32_t timer_id) = 0;
 };
 
+/**
+ * Running timers are kept in a hashed timing wheel: one list per slot of WHEEL_SIZE ticks, with each timer in the
+ * slot of its timeout. Starting and stopping a timer is O(1), and a step only visits the timers of the current slot,
+ * which expire now or one or more wheel turns later.
+ */
 class timer_handler
 {
   constexpr static uint32_t MAX_TIMER_DURATION = std::numeric_limits<uint32_t>::max() / 4;
-  constexpr static uint32_t MAX_TIMER_VALUE    = std::numeric_limits<uint32_t>::max() / 2;
+  constexpr static uint32_t WHEEL_SIZE         = 1024;
+  constexpr static uint32_t NULL_TIMER_ID      = std::numeric_limits<uint32_t>::max();
 
   struct timer_impl {
     timer_handler*                parent;
     uint32_t                      duration = 0, timeout = 0;
-    bool                          running = false;
-    bool                          active  = false;
+    bool                          running  = false;
+    bool                          active   = false;
+    bool                          in_wheel = false;
+    uint32_t                      slot     = 0;
+    uint32_t                      prev = NULL_TIMER_ID, next = NULL_TIMER_ID; // Neighbours in the wheel slot
     std::function<void(uint32_t)> callback;
 
     explicit timer_impl(timer_handler* parent_) : parent(parent_) {}
@@ -106,25 +115,32 @@ class timer_handler
         return;
       }
       timeout = parent->cur_time + duration;
-      parent->running_timers.emplace(id(), timeout);
+      parent->wheel_remove(id());
+      parent->wheel_insert(id());
       running = true;
     }
 
     void stop()
     {
+      std::unique_lock<std::mutex> lock(parent->mutex);
       running = false; // invalidates trigger
       if (not is_expired()) {
         timeout = 0; // if it has already expired, then do not alter is_expired() state
       }
+      parent->wheel_remove(id());
     }
 
     void clear()
     {
       stop();
       duration = 0;
-      active   = false;
       callback = std::function<void(uint32_t)>();
       // leave run_id unchanged. Since the timeout was changed, we shall not get spurious triggering
+      std::unique_lock<std::mutex> lock(parent->mutex);
+      if (active) {
+        active = false;
+        parent->free_ids.push_back(id());
+      }
     }
 
     void trigger()
@@ -211,44 +227,45 @@ public:
     uint32_t       timer_id;
   };
 
-  explicit timer_handler(uint32_t capacity = 64)
+  explicit timer_handler(uint32_t capacity = 64) :
+    wheel_head(WHEEL_SIZE, uint32_t{NULL_TIMER_ID}),
+    wheel_tail(WHEEL_SIZE, uint32_t{NULL_TIMER_ID})
   {
     timer_list.reserve(capacity);
-    // reserve a priority queue using a vector
-    std::vector<timer_run> v;
-    v.reserve(capacity);
-    std::priority_queue<timer_run> q(std::less<timer_run>(), std::move(v));
-    running_timers = std::move(q);
+    free_ids.reserve(capacity);
+    expired.reserve(capacity);
   }
 
   void step_all()
   {
     std::unique_lock<std::mutex> lock(mutex);
     cur_time++;
-    while (not running_timers.empty()) {
-      uint32_t    next_timeout = running_timers.top().timeout;
-      timer_impl* ptr          = &timer_list[running_timers.top().timer_id];
-      if (not ptr->is_running() or next_timeout != ptr->timeout) {
-        // remove timers that were explicitly stopped, or re-run, to avoid unnecessary priority_queue growth
-        running_timers.pop();
-        continue;
-      }
-      if (cur_time < next_timeout) {
-        break;
+
+    // Take out the timers of the current slot that expire now, the others are at least one wheel turn away
+    expired.clear();
+    uint32_t slot = cur_time % WHEEL_SIZE;
+    for (uint32_t id = wheel_head[slot]; id != NULL_TIMER_ID;) {
+      timer_impl* ptr  = &timer_list[id];
+      uint32_t    next = ptr->next;
+      if ((int32_t)(cur_time - ptr->timeout) >= 0) {
+        wheel_remove(id);
+        expired.emplace_back(id, ptr->timeout);
       }
-      // if the timer_run and timer_impl timeouts do not match, it means that timer_impl::timeout was overwritten.
-      // in such case, do not trigger
-      uint32_t timeout = running_timers.top().timeout;
-      running_timers.pop();
+      id = next;
+    }
 
-      if (ptr->timeout == timeout) {
+    for (const timer_run& e : expired) {
+      timer_impl* ptr = &timer_list[e.timer_id];
+      // if the timer_run and timer_impl timeouts do not match, it means that the timer was re-run by the callback of
+      // another timer. in such case, do not trigger
+      if (ptr->timeout == e.timeout) {
         // unlock mutex, it could be that the callback tries to run a timer too
         lock.unlock();
 
         // Call callback
         ptr->trigger();
 
-        // Lock again to keep protecting the queue
+        // Lock again to keep protecting the wheel
         lock.lock();
       }
     }
@@ -256,12 +273,13 @@ public:
 
   void stop_all()
   {
+    std::unique_lock<std::mutex> lock(mutex);
     // does not call callback
-    while (not running_timers.empty()) {
-      running_timers.pop();
-    }
+    std::fill(wheel_head.begin(), wheel_head.end(), uint32_t{NULL_TIMER_ID});
+    std::fill(wheel_tail.begin(), wheel_tail.end(), uint32_t{NULL_TIMER_ID});
     for (auto& i : timer_list) {
-      i.running = false;
+      i.running  = false;
+      i.in_wheel = false;
     }
   }
 
@@ -298,36 +316,67 @@ private:
     uint32_t timeout;
 
     timer_run(uint32_t timer_id_, uint32_t timeout_) : timer_id(timer_id_), timeout(timeout_) {}
-
-    bool operator<(const timer_run& other) const
-    {
-      // returns true, if other.timeout is lower than timeout, accounting for wrap around
-      if (timeout > other.timeout) {
-        return (timeout - other.timeout) < MAX_TIMER_VALUE / 2;
-      }
-      return (other.timeout - timeout) > MAX_TIMER_VALUE / 2;
-    }
   };
 
   uint32_t alloc_timer()
   {
-    uint32_t i = 0;
-    for (; i < timer_list.size(); ++i) {
-      if (not timer_list[i].active) {
-        break;
-      }
-    }
-    if (i == timer_list.size()) {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint32_t                     i;
+    if (free_ids.empty()) {
+      i = timer_list.size();
       timer_list.emplace_back(this);
+    } else {
+      i = free_ids.back();
+      free_ids.pop_back();
     }
     timer_list[i].active = true;
     return i;
   }
 
-  std::vector<timer_impl>        timer_list;
-  std::priority_queue<timer_run> running_timers;
-  uint32_t                       cur_time = 0;
-  std::mutex                     mutex; // Protect priority queue
+  // Called with the mutex held
+  void wheel_insert(uint32_t id)
+  {
+    timer_impl& t = timer_list[id];
+    // A timeout that is already due, i.e. a zero duration, is handled in the next step
+    t.slot = ((int32_t)(t.timeout - cur_time) > 0 ? t.timeout : cur_time + 1) % WHEEL_SIZE;
+    t.prev = wheel_tail[t.slot];
+    t.next = NULL_TIMER_ID;
+    if (t.prev == NULL_TIMER_ID) {
+      wheel_head[t.slot] = id;
+    } else {
+      timer_list[t.prev].next = id;
+    }
+    wheel_tail[t.slot] = id;
+    t.in_wheel         = true;
+  }
+
+  // Called with the mutex held
+  void wheel_remove(uint32_t id)
+  {
+    timer_impl& t = timer_list[id];
+    if (not t.in_wheel) {
+      return;
+    }
+    if (t.prev == NULL_TIMER_ID) {
+      wheel_head[t.slot] = t.next;
+    } else {
+      timer_list[t.prev].next = t.next;
+    }
+    if (t.next == NULL_TIMER_ID) {
+      wheel_tail[t.slot] = t.prev;
+    } else {
+      timer_list[t.next].prev = t.prev;
+    }
+    t.in_wheel = false;
+  }
+
+  std::vector<timer_impl> timer_list;
+  std::vector<uint32_t>   free_ids;   ///< Inactive entries of timer_list
+  std::vector<uint32_t>   wheel_head; ///< First timer of each wheel slot
+  std::vector<uint32_t>   wheel_tail; ///< Last timer of each wheel slot
+  std::vector<timer_run>  expired;    ///< Timers expiring in the current step
+  uint32_t                cur_time = 0;
+  std::mutex              mutex; // Protect the wheel and the free list
 };
 
 using unique_timer = timer_handler::unique_timer;
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+
+#ifndef SRSLTE_TTI_DEADLINE_WATCHDOG_H
+#define SRSLTE_TTI_DEADLINE_WATCHDOG_H
+
+#include "srslte/common/log.h"
+#include "srslte/common/threads.h"
+#include "srslte/phy/common/timestamp.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace srslte {
+
+struct deadline_watchdog_args_t {
+  std::string dump_filename;           ///< File where the snapshots of the misses are appended, empty disables them
+  uint32_t    tx_margin_us   = 100;    ///< Minimum time between the Tx handover to the radio and the Tx time
+  uint32_t    rx_lag_us      = 1000;   ///< Maximum delay of the reception of a subframe after it is on air
+  uint32_t    max_dumps      = 10;     ///< Maximum number of snapshots written
+  uint32_t    dump_period_ms = 1000;   ///< Minimum time between snapshots
+};
+
+/**
+ * Detects the TTIs that miss their real-time deadline
+ *
+ * The watchdog maps the RF timestamps onto the host clock with the smallest delay seen between the end of a received
+ * subframe and its reception over a window of TTIs. A TTI misses its deadline when its subframe is received more
+ * than rx_lag_us later than that, i.e. the receiving thread falls behind the radio, or when its Tx signal is handed to
+ * the radio less than tx_margin_us before its Tx time, which would end in a late burst.
+ *
+ * Every miss is counted and logged. If a dump file is given, a background thread then appends a snapshot to it with
+ * the stages recorded by tti_trace for the offending and the previous TTIs, and the text given by every context
+ * source, e.g. the last scheduler decisions and the queue depths.
+ */
+class tti_deadline_watchdog : public thread
+{
+public:
+  enum class miss_type { rx_behind, tx_late };
+
+  explicit tti_deadline_watchdog(const std::string& thread_name = "WATCHDOG");
+  ~tti_deadline_watchdog();
+  tti_deadline_watchdog(const tti_deadline_watchdog&) = delete;
+  tti_deadline_watchdog& operator=(const tti_deadline_watchdog&) = delete;
+
+  /// Starts the snapshot thread if a dump file is given
+  void init(const deadline_watchdog_args_t& args_, srslte::log* log_h_);
+  void stop();
+
+  /// Called by the receiving thread after receiving the subframe of the TTI starting at rx_time
+  void rx_done(uint32_t tti, const srslte_timestamp_t& rx_time);
+  /// Called by any thread before handing the Tx signal of the TTI to the radio
+  void tx_ready(uint32_t tti, const srslte_timestamp_t& tx_time);
+
+  uint64_t get_nof_misses() const { return nof_misses.load(std::memory_order_relaxed); }
+
+  /// Adds a function whose text is added to the snapshots under the given name. It is called from the snapshot thread
+  static void add_context_source(const std::string& name, std::function<std::string()> source);
+  static void remove_context_source(const std::string& name);
+
+private:
+  /// The time is the reception delay for rx_behind misses and the time left until the Tx time for tx_late ones
+  struct miss_t {
+    uint32_t  tti;
+    miss_type type;
+    int64_t   time_ns;
+    uint64_t  index;
+  };
+
+  void        miss(uint32_t tti, miss_type type, int64_t time_ns);
+  void        run_thread() override;
+  std::string build_snapshot(const miss_t& m);
+
+  deadline_watchdog_args_t args;
+  srslte::log*             log_h = nullptr;
+
+  // Smallest delay between the end of a subframe on air and its reception, in the current and the previous windows
+  std::atomic<int64_t> offset_ns{INT64_MAX};
+  int64_t              window_min_ns      = INT64_MAX;
+  int64_t              prev_window_min_ns = INT64_MAX;
+  uint32_t             window_count       = 0;
+  bool                 rx_behind          = false;
+
+  std::atomic<uint64_t> nof_misses{0};
+
+  std::mutex              mutex;
+  std::condition_variable cvar;
+  std::vector<miss_t>     pending;
+  bool                    running         = false;
+  uint32_t                nof_dumps       = 0; ///< Snapshots requested, written or pending
+  int64_t                 last_request_ns = 0;
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_TTI_DEADLINE_WATCHDOG_H
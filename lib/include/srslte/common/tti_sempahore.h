@@ -19,11 +19,13 @@
  *
  */
 
-#include <assert.h>
-#include <condition_variable>
-#include <deque>
+#include <array>
+#include <atomic>
+#include <climits>
 #include <inttypes.h>
-#include <mutex>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #ifndef SRSLTE_TTI_SEMPAHORE_H_
 #define SRSLTE_TTI_SEMPAHORE_H_
@@ -35,17 +37,44 @@ namespace srslte {
  * push) and waits until the enqueued object is the first (method wait). The first element is released by method
  * release. The method release_all waits for all the elements to be released.
  *
+ * The queue is a ring of tickets: push() gives the next ticket to an element and release() moves the head to the next
+ * one, so neither takes a lock. A waiter spins for a short while and then sleeps on a futex on the head with a bitset
+ * derived from its ticket, so that a release only wakes the thread whose turn it is (and wait_all()). Elements are
+ * pushed by a single thread, the one that dispatches the workers, and an element is in the queue at most once.
+ *
  * @tparam T Object identifier type
  */
 template <class T>
 class tti_semaphore
 {
 private:
-  std::mutex              mutex; ///< Used for scope mutexes
-  std::condition_variable cvar;  ///< Used for notifying element identifier releases
-  std::deque<T>           fifo;  ///< Queue to keep order
+  static const uint32_t capacity   = 64;        ///< Maximum number of elements in the queue
+  static const uint32_t any_bit    = 1u << 31u; ///< Futex bit of the waiters for any release
+  static const uint32_t spin_count = 256;       ///< Checks of the head before sleeping
+
+  std::array<std::atomic<T>, capacity> slots;       ///< Element identifier of each pending ticket
+  std::atomic<uint32_t>                head{0};     ///< Ticket of the first element
+  std::atomic<uint32_t>                tail{0};     ///< Ticket of the next pushed element
+  std::atomic<uint32_t>                sleepers{0}; ///< Threads sleeping on the head, releases skip the wake if zero
+
+  static uint32_t ticket_bit(uint32_t ticket) { return 1u << (ticket % 31u); }
+
+  /// Sleeps until the head is not h, or a release with a bit in mask. Returns at once if the head is not h already
+  void sleep_on_head(uint32_t h, uint32_t mask)
+  {
+    for (uint32_t i = 0; i < spin_count; i++) {
+      if (head.load(std::memory_order_acquire) != h) {
+        return;
+      }
+    }
+    sleepers++;
+    syscall(SYS_futex, &head, FUTEX_WAIT_BITSET_PRIVATE, h, nullptr, nullptr, mask);
+    sleepers--;
+  }
 
 public:
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "The futex word must be a plain 32-bit integer");
+
   /**
    * Waits for the first element of the queue match the element identifier provided.
    *
@@ -53,12 +82,28 @@ public:
    */
   void wait(T id)
   {
-    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      uint32_t h = head.load(std::memory_order_acquire);
+      uint32_t t = tail.load(std::memory_order_acquire);
 
-    // While the FIFO is not empty and the front ID does not match the provided element identifier, keep waiting
-    while (not fifo.empty() and fifo.front() != id) {
-      // Wait for a release
-      cvar.wait(lock);
+      // Nothing to wait for if the queue is empty
+      if (h == t) {
+        return;
+      }
+
+      // Find the ticket of the element and wait for its turn
+      for (uint32_t ticket = h; ticket != t; ticket++) {
+        if (slots[ticket % capacity].load(std::memory_order_relaxed) == id) {
+          while (h != ticket) {
+            sleep_on_head(h, ticket_bit(ticket));
+            h = head.load(std::memory_order_acquire);
+          }
+          return;
+        }
+      }
+
+      // The element is not in the queue, wait for any release and look again
+      sleep_on_head(h, any_bit);
     }
   }
 
@@ -69,10 +114,18 @@ public:
    */
   void push(T id)
   {
-    std::unique_lock<std::mutex> lock(mutex);
+    uint32_t t = tail.load(std::memory_order_relaxed);
+
+    // Wait for a free slot, the pools of workers never have this many elements pending
+    uint32_t h = head.load(std::memory_order_acquire);
+    while (t - h >= capacity) {
+      sleep_on_head(h, any_bit);
+      h = head.load(std::memory_order_acquire);
+    }
 
     // Append the element identifier
-    fifo.push_back(id);
+    slots[t % capacity].store(id, std::memory_order_relaxed);
+    tail.store(t + 1, std::memory_order_release);
   }
 
   /**
@@ -80,13 +133,13 @@ public:
    */
   void release()
   {
-    std::unique_lock<std::mutex> lock(mutex);
-
     // Pop first element
-    fifo.pop_front();
+    uint32_t h = head.fetch_add(1) + 1;
 
-    // Notify release
-    cvar.notify_all();
+    // Wake the owner of the next ticket and the threads waiting for any release
+    if (sleepers.load() > 0) {
+      syscall(SYS_futex, &head, FUTEX_WAKE_BITSET_PRIVATE, INT_MAX, nullptr, nullptr, any_bit | ticket_bit(h));
+    }
   }
 
   /**
@@ -94,11 +147,10 @@ public:
    */
   void wait_all()
   {
-    std::unique_lock<std::mutex> lock(mutex);
-
-    // Wait until the FIFO is empty
-    while (not fifo.empty()) {
-      cvar.wait(lock);
+    uint32_t h = head.load(std::memory_order_acquire);
+    while (h != tail.load(std::memory_order_acquire)) {
+      sleep_on_head(h, any_bit);
+      h = head.load(std::memory_order_acquire);
     }
   }
 };
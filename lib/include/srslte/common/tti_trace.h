@@ -0,0 +1,176 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#ifndef SRSLTE_TTI_TRACE_H
+#define SRSLTE_TTI_TRACE_H
+
+#include "srslte/common/perf_counters.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ *
+ * @file tti_trace.h
+ *
+ * @brief Timing of the processing stages of every TTI
+ *
+ * A span records the start and duration of a stage of a TTI, e.g. the FFT or the DL scheduler, in a buffer owned by
+ * the calling thread, so recording takes no lock and touches no shared cache line. Every thread keeps its last
+ * spans, which can be exported to the Chrome trace format and opened with chrome://tracing or Perfetto, and a
+ * histogram of the durations of each stage, from which the percentiles of the stages are computed at any time.
+ * Once the perf counters are enabled, the spans also add up the hardware events of every stage, e.g. its IPC.
+ *
+ * The spans are only recorded when the build defines ENABLE_TTI_TRACE, otherwise they compile to nothing.
+ */
+
+namespace srslte {
+
+enum class tti_stage : uint8_t {
+  rf_recv,
+  fft,
+  chest,
+  pdcch_decode,
+  pdsch_decode,
+  pusch_decode,
+  pucch_decode,
+  dl_sched,
+  ul_sched,
+  mac_pdu_build,
+  pdsch_encode,
+  pusch_encode,
+  ifft,
+  rf_send,
+  worker,
+  nof_stages
+};
+
+const char* to_string(tti_stage stage);
+
+namespace tti_trace {
+
+struct span_t {
+  uint64_t  start_ns;
+  uint32_t  duration_ns;
+  uint32_t  tti;
+  tti_stage stage;
+};
+
+struct thread_spans_t {
+  std::string         thread_name;
+  uint32_t            tid;
+  std::vector<span_t> spans;
+};
+
+struct stage_summary_t {
+  uint64_t count;
+  uint32_t p50_us;
+  uint32_t p99_us;
+  uint32_t max_us;
+};
+
+/// Number of spans kept by every thread
+const uint32_t thread_buffer_size = 16384;
+
+inline uint64_t now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/// Sets the TTI of the spans of the calling thread that do not give one
+void     set_thread_tti(uint32_t tti);
+uint32_t get_thread_tti();
+
+/// Records a stage of a TTI in the buffer of the calling thread
+void record(tti_stage stage, uint32_t tti, uint64_t start_ns, uint64_t end_ns);
+
+/// Adds the hardware events of a stage to the totals of the calling thread
+void record_counters(tti_stage stage, const perf_counter_values& counters);
+
+/// Returns the spans kept by every thread that recorded any, oldest first. Threads may be recording meanwhile
+std::vector<thread_spans_t> collect();
+
+/// Returns the spans of all the threads that belong to the given TTI
+std::vector<span_t> collect_tti(uint32_t tti);
+
+/// Percentiles of the durations of the stage since the start of the process, with a resolution of 1/4 of an octave
+stage_summary_t get_summary(tti_stage stage);
+
+/// Hardware events of the stage since the start of the process, all 0 if the perf counters were not enabled
+perf_counter_values get_counters(tti_stage stage);
+
+/// Returns a table with the summary of every stage that was recorded
+std::string summary_to_string();
+
+/// Writes the spans kept by every thread to a file in the Chrome trace event format
+bool write_chrome_trace(const std::string& filename);
+
+} // namespace tti_trace
+
+/// Records the time from its construction until stop() or its destruction as a stage of a TTI. The TTI is the one set
+/// by the thread if none is given
+class tti_span
+{
+public:
+#ifdef ENABLE_TTI_TRACE
+  explicit tti_span(tti_stage stage_) : tti_span(stage_, tti_trace::get_thread_tti()) {}
+  tti_span(tti_stage stage_, uint32_t tti_) :
+    stage(stage_),
+    tti(tti_),
+    has_counters(perf_counters::read(&start_counters)),
+    start_ns(tti_trace::now_ns())
+  {}
+  ~tti_span() { stop(); }
+  tti_span(const tti_span&) = delete;
+  tti_span& operator=(const tti_span&) = delete;
+
+  void stop()
+  {
+    if (running) {
+      tti_trace::record(stage, tti, start_ns, tti_trace::now_ns());
+      perf_counter_values end_counters;
+      if (has_counters and perf_counters::read(&end_counters)) {
+        tti_trace::record_counters(stage, end_counters - start_counters);
+      }
+      running = false;
+    }
+  }
+
+private:
+  tti_stage           stage;
+  uint32_t            tti;
+  perf_counter_values start_counters;
+  bool                has_counters;
+  uint64_t            start_ns;
+  bool                running = true;
+#else
+  explicit tti_span(tti_stage) {}
+  tti_span(tti_stage, uint32_t) {}
+  void stop() {}
+#endif
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_TTI_TRACE_H
@@ -34,6 +34,13 @@ public:
    * @param gain Relative gain
    */
   virtual void cmd_cell_gain(uint32_t cell_id, float gain) = 0;
+
+  /**
+   * Changes the PCI of a cell without restarting the eNodeB. The attached UEs must find the cell again
+   * @param cell_id Provides a cell identifier
+   * @param pci New Physical Cell Identifier
+   */
+  virtual void cmd_cell_pci(uint32_t cell_id, uint32_t pci) = 0;
 };
 } // namespace srsenb
 
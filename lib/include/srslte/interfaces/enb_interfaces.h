@@ -132,6 +132,17 @@ public:
    */
   virtual int cqi_info(uint32_t tti, uint16_t rnti, uint32_t cc_idx, uint32_t cqi_value) = 0;
 
+  /**
+   * PHY callback for giving MAC the Channel Quality information of a subband of a given RNTI, TTI and eNb cell/carrier
+   * @param tti the given TTI
+   * @param rnti the UE identifier in the eNb
+   * @param cc_idx The eNb Cell/Carrier where the measurement corresponds
+   * @param sb_idx the subband index, as defined for higher layer configured subband reports in TS 36.213 7.2.1
+   * @param cqi_value the corresponding Channel Quality Information of the subband
+   * @return SRSLTE_SUCCESS if no error occurs, SRSLTE_ERROR* if an error occurs
+   */
+  virtual int sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t cc_idx, uint32_t sb_idx, uint32_t cqi_value) = 0;
+
   /**
    * PHY callback for giving MAC the SNR in dB of an UL transmission for a given RNTI at a given carrier
    *
@@ -143,6 +154,19 @@ public:
    */
   virtual int snr_info(uint32_t tti, uint16_t rnti, uint32_t cc_idx, float snr_db) = 0;
 
+  /**
+   * PHY callback for giving MAC the per subband SNR in dB of the Sounding Reference Signal of a given RNTI
+   *
+   * @param tti The measurement was made
+   * @param rnti The UE identifier in the eNb
+   * @param cc_idx The eNb Cell/Carrier where the SRS was received
+   * @param snr_db The SNR of the SRS in each subband, with the subband size of the higher layer configured subband
+   * reports in TS 36.213 7.2.1. Subbands not sounded in this TTI are NAN
+   * @param nof_sb Number of subbands in snr_db
+   * @return SRSLTE_SUCCESS if no error occurs, SRSLTE_ERROR* if an error occurs
+   */
+  virtual int ul_sb_snr_info(uint32_t tti, uint16_t rnti, uint32_t cc_idx, const float* snr_db, uint32_t nof_sb) = 0;
+
   /**
    * PHY callback for giving MAC the Time Aligment information in microseconds of a given RNTI during a TTI processing
    *
@@ -356,6 +380,8 @@ class pdcp_interface_gtpu
 {
 public:
   virtual void write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu) = 0;
+  /// Writes the SDUs of one bearer in order. The SDUs are moved out of the vector, which is left empty
+  virtual void write_sdus(uint16_t rnti, uint32_t lcid, std::vector<srslte::unique_byte_buffer_t>& sdus) = 0;
 };
 
 // PDCP interface for RRC
@@ -549,12 +575,15 @@ typedef struct {
   std::string gtp_bind_addr;
   std::string s1c_bind_addr;
   std::string enb_name;
+  uint16_t    nof_sctp_streams; // SCTP streams requested to the MME, stream 0 is kept for non UE-associated signalling
 } s1ap_args_t;
 
 typedef struct {
   uint32_t                      nof_prb; ///< Needed to dimension MAC softbuffers for all cells
+  bool                          pusch_8bit_softbuffers = false; ///< 8-bit UL softbuffers for the 8-bit PUSCH decoder
   sched_interface::sched_args_t sched;
   int                           nr_tb_size = -1;
+  std::string                   sched_trace_filename; ///< Records the scheduler inputs to this file, if not empty
 } mac_args_t;
 
 class stack_interface_s1ap_lte
@@ -28,6 +28,7 @@
 #include "srsenb/hdr/stack/mac/mac_metrics.h"
 #include "srsenb/hdr/stack/rrc/rrc_metrics.h"
 #include "srsenb/hdr/stack/upper/common_enb.h"
+#include "srsenb/hdr/stack/upper/rlc_metrics.h"
 #include "srsenb/hdr/stack/upper/s1ap_metrics.h"
 #include "srslte/common/metrics_hub.h"
 #include "srslte/radio/radio_metrics.h"
@@ -37,9 +38,10 @@
 namespace srsenb {
 
 struct stack_metrics_t {
-  mac_metrics_t  mac[ENB_METRICS_MAX_USERS];
-  rrc_metrics_t  rrc;
-  s1ap_metrics_t s1ap;
+  mac_metrics_t    mac[ENB_METRICS_MAX_USERS];
+  rlc_ue_metrics_t rlc[ENB_METRICS_MAX_USERS]; ///< Of the users in the order of mac
+  rrc_metrics_t    rrc;
+  s1ap_metrics_t   s1ap;
 };
 
 typedef struct {
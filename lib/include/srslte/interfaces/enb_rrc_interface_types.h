@@ -47,6 +47,7 @@ struct rrc_meas_cfg_t {
   std::vector<meas_cell_cfg_t>               meas_cells;
   std::vector<asn1::rrc::report_cfg_eutra_s> meas_reports;
   asn1::rrc::quant_cfg_eutra_s               quant_cfg;
+  int ho_prep_rsrp_thres = -1; ///< RSRP range (0..97) above which intra-eNB targets are prepared. -1 disables it
   // TODO: Add blacklist cells
   // TODO: Add multiple meas configs
 };
@@ -74,12 +74,24 @@ public:
                                                struct sctp_sndrcvinfo enb_sri)               = 0;
 };
 
+// Authentication vector generated by the HSS for a UE procedure
+struct auth_info_answer_t {
+  uint64_t imsi;
+  uint32_t mme_ue_s1ap_id;
+  bool     found; // false if the IMSI is not a subscriber
+  uint8_t  k_asme[32];
+  uint8_t  autn[16];
+  uint8_t  rand[16];
+  uint8_t  xres[16];
+};
+
 class hss_interface_nas // NAS -> HSS
 {
 public:
-  virtual bool gen_auth_info_answer(uint64_t imsi, uint8_t* k_asme, uint8_t* autn, uint8_t* rand, uint8_t* xres) = 0;
-  virtual bool gen_update_loc_answer(uint64_t imsi, uint8_t* qci)                                                = 0;
-  virtual bool resync_sqn(uint64_t imsi, uint8_t* auts)                                                          = 0;
+  // The vector is generated in a HSS worker, after resynchronizing the SQN with auts if it is not null, and is handed
+  // back to the MME thread
+  virtual void gen_auth_info_answer_async(uint64_t imsi, uint32_t mme_ue_s1ap_id, const uint8_t* auts) = 0;
+  virtual bool gen_update_loc_answer(uint64_t imsi, uint8_t* qci)                                       = 0;
 };
 
 class mme_interface_nas // NAS -> MME
@@ -107,6 +107,8 @@ class pdcp_interface_sdap_nr
 {
 public:
   virtual void write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t pdu) = 0;
+  /// Writes the SDUs of one bearer in order. The SDUs are moved out of the vector, which is left empty
+  virtual void write_sdus(uint16_t rnti, uint32_t lcid, std::vector<srslte::unique_byte_buffer_t>& sdus) = 0;
 };
 
 /*****************************
@@ -121,6 +123,8 @@ class sdap_interface_gtpu_nr
 {
 public:
   virtual void write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t pdu) = 0;
+  /// Writes the SDUs of one bearer in order. The SDUs are moved out of the vector, which is left empty
+  virtual void write_sdus(uint16_t rnti, uint32_t lcid, std::vector<srslte::unique_byte_buffer_t>& sdus) = 0;
 };
 
 /*****************************
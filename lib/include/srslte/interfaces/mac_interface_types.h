@@ -108,6 +108,30 @@ struct rach_cfg_t {
   }
 };
 
+// DRX configuration, the timers are in subframes (TS 36.321 Section 5.7)
+struct drx_cfg_t {
+  bool     enabled;
+  uint32_t on_duration_timer;
+  uint32_t inactivity_timer;
+  uint32_t retx_timer;
+  uint32_t long_cycle;
+  uint32_t long_cycle_offset;
+  uint32_t short_cycle;       ///< 0 if the short DRX cycle is not configured
+  uint32_t short_cycle_timer; ///< In short DRX cycles
+  drx_cfg_t() { reset(); }
+  void reset()
+  {
+    enabled           = false;
+    on_duration_timer = 0;
+    inactivity_timer  = 0;
+    retx_timer        = 0;
+    long_cycle        = 0;
+    long_cycle_offset = 0;
+    short_cycle       = 0;
+    short_cycle_timer = 0;
+  }
+};
+
 struct mac_cfg_t {
   // Default constructor with default values as in 36.331 9.2.2
   mac_cfg_t() { set_defaults(); }
@@ -124,6 +148,7 @@ struct mac_cfg_t {
     bsr_cfg.reset();
     phr_cfg.reset();
     harq_cfg.reset();
+    drx_cfg.reset();
     time_alignment_timer = -1;
   }
 
@@ -132,6 +157,7 @@ struct mac_cfg_t {
   sr_cfg_t      sr_cfg;
   rach_cfg_t    rach_cfg;
   ul_harq_cfg_t harq_cfg;
+  drx_cfg_t     drx_cfg;
   int           time_alignment_timer = -1;
 };
 
@@ -29,6 +29,7 @@
 
 #include "srslte/common/security.h"
 #include <stdint.h>
+#include <vector>
 
 namespace srslte {
 
@@ -110,6 +111,15 @@ enum class pdcp_discard_timer_t {
   infinity = 0
 };
 
+// ROHC configuration of a DRB, TS 36.331 PDCP-Config headerCompression. Profile 0x0000 is always supported. The native
+// compressor only implements that profile, the others need an external compressor, see set_hdr_compressor(). RRC
+// fills max_cid and profiles from the PDCP-Config but leaves enabled unset, so it never turns on the native compressor
+struct pdcp_rohc_config_t {
+  bool                  enabled = false;
+  uint16_t              max_cid = 15; ///< Largest CID the compressor may use. Above 15, CIDs are coded as large CIDs
+  std::vector<uint16_t> profiles;     ///< Profiles configured besides 0x0000, e.g. 0x0001 for RTP/UDP/IP
+};
+
 class pdcp_config_t
 {
 public:
@@ -141,8 +151,7 @@ public:
   pdcp_t_reordering_t  t_reordering  = pdcp_t_reordering_t::ms500;
   pdcp_discard_timer_t discard_timer = pdcp_discard_timer_t::infinity;
 
-  // TODO: Support the following configurations
-  // bool do_rohc;
+  pdcp_rohc_config_t rohc;
 };
 
 // Specifies in which direction security (integrity and ciphering) are enabled for PDCP
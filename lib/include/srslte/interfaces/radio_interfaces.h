@@ -136,6 +136,25 @@ public:
    */
   virtual bool rx_now(rf_buffer_interface& buffer, rf_timestamp_interface& rxd_time) = 0;
 
+  /**
+   * Same as rx_now() storing interleaved int16 IQ samples, full scale is INT16_MAX, without converting them to float.
+   * It is only available when has_rx_s() returns true
+   *
+   * @param buffer Int16 buffers of 2 * nof_samples elements, indexed like the channels of rf_buffer_interface
+   * @param nof_samples Number of samples to receive in every channel
+   * @param rxd_time Time at which the samples were received
+   * @return it returns true if the reception was successful, otherwise it returns false
+   */
+  virtual bool rx_now_s(int16_t* buffer[SRSLTE_MAX_CHANNELS], uint32_t nof_samples, rf_timestamp_interface& rxd_time)
+  {
+    return false;
+  }
+
+  /**
+   * @return true if the radio can currently receive int16 samples through rx_now_s()
+   */
+  virtual bool has_rx_s() { return false; }
+
   /**
    * Sets the TX frequency for all antennas in the provided carrier index
    * @param carrier_idx Index of the carrier to change the frequency
@@ -124,6 +124,20 @@ struct rlc_um_nr_config_t {
   int32_t             t_reassembly_ms; // Timer used by rx to detect PDU loss (ms)
 };
 
+///< Active queue management of the Tx SDU queue. Without it, SDUs are only dropped when the queue is full
+enum class rlc_aqm_mode_t { none, codel, pie, nulltype };
+inline std::string to_string(const rlc_aqm_mode_t& mode)
+{
+  constexpr static const char* options[] = {"none", "CoDel", "PIE"};
+  return enum_to_text(options, (uint32_t)rlc_aqm_mode_t::nulltype, (uint32_t)mode);
+}
+
+struct rlc_aqm_config_t {
+  rlc_aqm_mode_t mode;
+  uint32_t       target_ms;   // Queueing delay to keep, 0 for the default of the mode (CoDel 5 ms, PIE 15 ms)
+  uint32_t       interval_ms; // CoDel interval or PIE update period, 0 for the default (CoDel 100 ms, PIE 15 ms)
+};
+
 #define RLC_TX_QUEUE_LEN (256)
 
 enum class srslte_rat_t { lte, nr, nulltype };
@@ -142,6 +156,7 @@ public:
   rlc_um_config_t    um;
   rlc_um_nr_config_t um_nr;
   uint32_t           tx_queue_length;
+  rlc_aqm_config_t   aqm;
 
   rlc_config_t() :
     rat(srslte_rat_t::lte),
@@ -149,7 +164,8 @@ public:
     am(),
     um(),
     um_nr(),
-    tx_queue_length(RLC_TX_QUEUE_LEN){};
+    tx_queue_length(RLC_TX_QUEUE_LEN),
+    aqm(){};
 
   // Factory for MCH
   static rlc_config_t mch_config()
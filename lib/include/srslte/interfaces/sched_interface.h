@@ -20,7 +20,9 @@
  */
 
 #include "srslte/common/common.h"
+#include "srslte/interfaces/mac_interface_types.h"
 #include "srslte/srslte.h"
+#include <string>
 #include <vector>
 
 #ifndef SRSLTE_SCHED_INTERFACE_H
@@ -53,13 +55,18 @@ public:
   } cell_cfg_sib_t;
 
   struct sched_args_t {
-    int      pdsch_mcs            = -1;
-    int      pdsch_max_mcs        = 28;
-    int      pusch_mcs            = -1;
-    int      pusch_max_mcs        = 28;
-    uint32_t min_nof_ctrl_symbols = 1;
-    uint32_t max_nof_ctrl_symbols = 3;
-    int      max_aggr_level       = 3;
+    int         pdsch_mcs            = -1;
+    int         pdsch_max_mcs        = 28;
+    int         pusch_mcs            = -1;
+    int         pusch_max_mcs        = 28;
+    uint32_t    min_nof_ctrl_symbols = 1;
+    uint32_t    max_nof_ctrl_symbols = 3;
+    int         max_aggr_level       = 3;
+    std::string policy               = "time_rr"; ///< time_rr, pf or max_ci
+    uint32_t    pf_window            = 100;       ///< Number of TTIs the PF metric averages the served rates over
+    uint32_t    nof_cc_workers       = 0;         ///< Threads allocating the carriers in parallel, 0 to disable
+    uint32_t    max_pdcch_leaves     = 64;        ///< Max PDCCH allocation combinations kept per DCI, 0 for no limit
+    float       target_bler          = 0;         ///< Target BLER of the outer loop link adaptation, 0 to disable
   };
 
   struct cell_cfg_t {
@@ -145,6 +152,7 @@ public:
     std::vector<cc_cfg_t>               supported_cc_list; ///< list of UE supported CCs. First index for PCell
     ant_info_ded_t                      dl_ant_info;
     bool                                use_tbs_index_alt = false;
+    srslte::drx_cfg_t                   drx_cfg;
   };
 
   typedef struct {
@@ -283,6 +291,8 @@ public:
   virtual int dl_ri_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t ri_value)          = 0;
   virtual int dl_pmi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t pmi_value)        = 0;
   virtual int dl_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t cqi_value)        = 0;
+  virtual int
+  dl_sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi_value) = 0;
 
   /* UL information */
   virtual int ul_crc_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, bool crc)                          = 0;
@@ -290,6 +300,8 @@ public:
   virtual int ul_bsr(uint16_t rnti, uint32_t lcg_id, uint32_t bsr)                                             = 0;
   virtual int ul_phr(uint16_t rnti, int phr)                                                                   = 0;
   virtual int ul_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t cqi, uint32_t ul_ch_code) = 0;
+  virtual int
+  ul_sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi_value) = 0;
 
   /* Run Scheduler for this tti */
   virtual int dl_sched(uint32_t tti, uint32_t enb_cc_idx, dl_sched_res_t& sched_result) = 0;
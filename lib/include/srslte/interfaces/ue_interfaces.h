@@ -40,6 +40,7 @@
 #include "srslte/common/interfaces_common.h"
 #include "srslte/common/security.h"
 #include "srslte/common/stack_procedure.h"
+#include "srslte/common/tti_deadline_watchdog.h"
 #include "srslte/common/tti_point.h"
 #include "srslte/phy/channel/channel.h"
 #include "srslte/phy/rf/rf.h"
@@ -91,6 +92,7 @@ public:
   virtual void generate_as_keys_ho(uint32_t pci, uint32_t earfcn, int ncc, srslte::as_security_config_t* sec_cfg) = 0;
   virtual void store_keys_before_ho(const srslte::as_security_config_t& as_cfg)                                   = 0;
   virtual void restore_keys_from_failed_ho(srslte::as_security_config_t* as_cfg)                                  = 0;
+  virtual bool get_imsi_vec(uint8_t* imsi_, uint32_t n)                                                           = 0;
 };
 
 // GW interface for NAS
@@ -354,6 +356,9 @@ public:
   virtual void write_pdu_bcch_dlsch(uint8_t* payload, uint32_t nof_bytes)         = 0;
   virtual void write_pdu_pcch(srslte::unique_byte_buffer_t payload)               = 0;
   virtual void write_pdu_mch(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes) = 0;
+
+  /* Same as above, but the RLC may keep the PDU buffer instead of copying it, e.g. a view into the MAC PDU */
+  virtual void write_pdu(uint32_t lcid, srslte::unique_byte_buffer_t pdu) { write_pdu(lcid, pdu->msg, pdu->N_bytes); }
 };
 
 /** MAC interface
@@ -420,6 +425,10 @@ public:
   virtual uint16_t get_dl_sched_rnti(uint32_t tti) = 0;
   virtual uint16_t get_ul_sched_rnti(uint32_t tti) = 0;
 
+  /* Query the MAC whether the TTI is in the DRX Active Time, i.e. whether the PDCCH for the C-RNTI is monitored.
+   * Always true if DRX is not configured */
+  virtual bool is_drx_active_time(uint32_t tti) = 0;
+
   /* Indicate reception of UL dci.
    * payload_ptr points to memory where MAC PDU must be written by MAC layer */
   virtual void new_grant_ul(uint32_t cc_idx, mac_grant_ul_t grant, tb_action_ul_t* action) = 0;
@@ -466,8 +475,9 @@ public:
   virtual void bcch_start_rx(int si_window_start, int si_window_length) = 0;
   virtual void bcch_stop_rx()                                           = 0;
 
-  /* Instructs the MAC to start receiving PCCH */
-  virtual void pcch_start_rx() = 0;
+  /* Instructs the MAC to start receiving PCCH in the subframe po_sf_idx of the frames with SFN mod paging_cycle equal
+   * to pf_offset (TS 36.304 Section 7.1). A paging_cycle of 0 searches the P-RNTI in every subframe */
+  virtual void pcch_start_rx(uint32_t paging_cycle, uint32_t pf_offset, uint32_t po_sf_idx) = 0;
 
   /* RRC configures a logical channel */
   virtual void setup_lcid(uint32_t lcid, uint32_t lcg, uint32_t priority, int PBR_x_tti, uint32_t BSD) = 0;
@@ -512,6 +522,8 @@ typedef struct {
   uint32_t pdsch_max_its   = 8;
   bool     meas_evm        = false;
   int      nof_phy_threads = 3;
+  uint32_t nof_cc_helpers  = 0; ///< Threads decoding the SCells of a TTI in parallel with its worker, 0 to disable
+  bool     idle_drx        = false;
 
   int worker_cpu_mask   = -1;
   int sync_cpu_affinity = -1;
@@ -536,16 +548,26 @@ typedef struct {
   float       sfo_ema                      = DEFAULT_SFO_EMA_COEFF;
   uint32_t    sfo_correct_period           = DEFAULT_SAMPLE_OFFSET_CORRECT_PERIOD;
   uint32_t    cfo_loop_pss_conv            = DEFAULT_PSS_STABLE_TIMEOUT;
+  uint32_t    pss_track_max_period         = DEFAULT_TRACK_MAX_PERIOD;
   uint32_t    cfo_ref_mask                 = 1023;
   bool        interpolate_subframe_enabled = false;
+  bool        wiener_enabled               = false;
+  bool        wiener_filter_bank           = false;
   bool        estimator_fil_auto           = false;
   float       estimator_fil_stddev         = 1.0f;
   uint32_t    estimator_fil_order          = 4;
   float       snr_to_cqi_offset            = 0.0f;
+  uint32_t    pmi_max_age                  = 0;
   std::string sss_algorithm                = "full";
+  uint32_t    cs_prescreen_frames          = 0;
+  float       cs_prescreen_min_psr         = 2.0f;
+  float       cs_early_exit_psr            = 0.0f;
   float       rx_gain_offset               = 62;
   bool        pdsch_csi_enabled            = true;
+  bool        pdsch_irc_enabled            = false;
   bool        pdsch_8bit_decoder           = false;
+  bool        pdsch_c16_storage            = false;
+  uint32_t    pdsch_cb_workers             = 0;
   uint32_t    intra_freq_meas_len_ms       = 20;
   uint32_t    intra_freq_meas_period_ms    = 200;
   float       force_ul_amplitude           = 0.0f;
@@ -555,6 +577,8 @@ typedef struct {
   uint32_t nof_in_sync_events     = 10;
   uint32_t nof_out_of_sync_events = 20;
 
+  srslte::deadline_watchdog_args_t deadline_watchdog;
+
   srslte::channel::args_t dl_channel_args;
   srslte::channel::args_t ul_channel_args;
 
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_DRX_H
+#define SRSLTE_DRX_H
+
+#include "srslte/common/common.h"
+#include "srslte/common/tti_point.h"
+#include "srslte/interfaces/mac_interface_types.h"
+#include <array>
+
+namespace srslte {
+
+/**
+ * Active Time of the DRX operation of a UE in RRC_CONNECTED (TS 36.321 Section 5.7). The UE MAC and the eNB scheduler
+ * feed it with the same events, so both agree on the subframes in which the UE monitors the PDCCH. Every timer is
+ * stored as the interval of TTIs in which it runs, so the Active Time can be queried for any TTI close to the last one
+ * stepped. Only FDD is supported, the DL HARQ RTT is 8 subframes.
+ *
+ * The events are tracked even if DRX is not configured, so that the timers started before a reconfiguration are
+ * honoured by both ends. Conditions of the Active Time known only by the UE (e.g. a pending SR) are not tracked here.
+ */
+class drx_active_time
+{
+public:
+  void set_config(const drx_cfg_t& cfg_) { cfg = cfg_; }
+  void reset();
+
+  /// Stops the timers that expired before the TTI, must be called once every TTI
+  void step(tti_point tti);
+
+  /// Returns true if the UE monitors the PDCCH in the TTI
+  bool is_active(tti_point tti) const;
+
+  /// A PDCCH for the UE was transmitted in the TTI, (re)starts the inactivity timer
+  void new_pdcch(tti_point tti);
+
+  /// The DL transport block of the HARQ process transmitted in the TTI was not decoded, its retransmission timer starts
+  /// after the HARQ RTT
+  void dl_tb_failed(tti_point tti, uint32_t pid);
+
+  /// A DRX Command MAC CE was received in the TTI, stops the on duration and inactivity timers
+  void drx_command(tti_point tti);
+
+  const drx_cfg_t& get_config() const { return cfg; }
+
+private:
+  const static uint32_t harq_rtt = FDD_HARQ_DELAY_DL_MS + FDD_HARQ_DELAY_UL_MS;
+
+  struct drx_timer_t {
+    bool      running = false;
+    tti_point start;
+    tti_point stop;
+    void      run(tti_point start_, uint32_t duration);
+    bool      contains(tti_point tti) const { return running and tti >= start and tti < stop; }
+  };
+
+  uint32_t cycle_pos(tti_point tti, uint32_t* cycle) const;
+  void     start_short_cycle(tti_point tti);
+
+  drx_cfg_t cfg;
+
+  drx_timer_t                       inactivity;
+  drx_timer_t                       short_cycle;
+  drx_timer_t                       on_duration_stop; ///< Remainder of an on duration stopped by a DRX Command
+  std::array<drx_timer_t, harq_rtt> retx;           ///< Retransmission timer of each DL HARQ process
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_DRX_H
@@ -59,26 +59,27 @@ public:
 
   mac_nr_sch_subpdu(mac_nr_sch_pdu* parent_);
 
-  nr_lcid_sch_t get_type();
-  bool          is_sdu();
-  bool          is_valid_lcid();
-  bool          is_var_len_ce();
-  bool          is_ul_ccch();
+  nr_lcid_sch_t get_type() const;
+  bool          is_sdu() const;
+  bool          is_valid_lcid() const;
+  bool          is_var_len_ce() const;
+  bool          is_ul_ccch() const;
 
   int32_t  read_subheader(const uint8_t* ptr);
-  uint32_t get_total_length();
-  uint32_t get_sdu_length();
-  uint32_t get_lcid();
-  uint8_t* get_sdu();
+  uint32_t get_total_length() const;
+  uint32_t get_sdu_length() const;
+  uint32_t get_lcid() const;
+  uint8_t* get_sdu() const;
 
-  void set_sdu(const uint32_t lcid_, const uint8_t* payload_, const uint32_t len_);
+  /// long_len forces the 16-bit L field, e.g. for the SDUs written in place after a subheader of 3 bytes
+  void set_sdu(const uint32_t lcid_, const uint8_t* payload_, const uint32_t len_, bool long_len = false);
 
   void set_padding(const uint32_t len_);
 
   uint32_t write_subpdu(const uint8_t* start_);
 
 private:
-  uint32_t sizeof_ce(uint32_t lcid, bool is_ul);
+  static uint32_t sizeof_ce(uint32_t lcid, bool is_ul);
 
   // protected:
   uint32_t lcid          = 0;
@@ -88,28 +89,40 @@ private:
   uint8_t* sdu           = nullptr;
 
   mac_nr_sch_pdu* parent = nullptr;
-  srslte::log_ref log_h;
 };
 
+/**
+ * The subPDUs are views of the TB: unpack() only reads the subheaders, the SDUs stay in the TB, and the SDUs are
+ * written in place by the packer. The list of subPDUs keeps its capacity between PDUs, so a long-lived PDU object
+ * doesn't allocate once it has seen the largest number of subPDUs per TB.
+ */
 class mac_nr_sch_pdu
 {
 public:
-  mac_nr_sch_pdu(bool ulsch_ = false) : ulsch(ulsch_) {}
+  mac_nr_sch_pdu(bool ulsch_ = false) : ulsch(ulsch_) { subpdus.reserve(nof_subpdus_hint); }
 
   void                     pack();
   void                     unpack(const uint8_t* payload, const uint32_t& len);
-  uint32_t                 get_num_subpdus();
-  const mac_nr_sch_subpdu& get_subpdu(const uint32_t& index);
-  bool                     is_ulsch();
+  uint32_t                 get_num_subpdus() const;
+  const mac_nr_sch_subpdu& get_subpdu(const uint32_t& index) const;
+  bool                     is_ulsch() const;
 
   void init_tx(byte_buffer_t* buffer_, uint32_t pdu_len_, bool is_ulsch_ = false);
   void init_rx(bool ulsch_ = false);
 
   uint32_t add_sdu(const uint32_t lcid_, const uint8_t* payload_, const uint32_t len_);
 
-  uint32_t get_remaing_len();
+  /// Room for the largest SDU of the LCID that fits in the PDU, for the caller to write it in place, e.g. RLC, instead
+  /// of copying it with add_sdu(). Sets max_len_ and returns nullptr if there is no room
+  uint8_t* reserve_sdu(const uint32_t lcid_, uint32_t* max_len_);
+  /// Adds the SDU of len_ bytes written in the room returned by reserve_sdu()
+  uint32_t commit_sdu(const uint32_t len_);
+
+  uint32_t get_remaing_len() const;
 
 private:
+  static const uint32_t nof_subpdus_hint = 16;
+
   uint32_t size_header_sdu(const uint32_t lcid_, const uint32_t nbytes);
 
   bool                           ulsch = false;
@@ -118,6 +131,10 @@ private:
   byte_buffer_t* buffer        = nullptr;
   uint32_t       pdu_len       = 0;
   uint32_t       remaining_len = 0;
+
+  // SDU reserved by reserve_sdu()
+  uint32_t reserved_lcid       = 0;
+  uint32_t reserved_header_len = 0;
 };
 
 } // namespace srslte
@@ -22,11 +22,12 @@
 #ifndef SRSLTE_PDU_QUEUE_H
 #define SRSLTE_PDU_QUEUE_H
 
-#include "srslte/common/block_queue.h"
+#include "srslte/adt/mpsc_queue.h"
 #include "srslte/common/buffer_pool.h"
 #include "srslte/common/log.h"
 #include "srslte/common/timers.h"
 #include "srslte/mac/pdu.h"
+#include <atomic>
 
 /* Logical Channel Demultiplexing and MAC CE dissassemble */
 
@@ -42,13 +43,22 @@ public:
     virtual void process_pdu(uint8_t* buff, uint32_t len, channel_t channel) = 0;
   };
 
-  pdu_queue(uint32_t pool_size = DEFAULT_POOL_SIZE) : pool(pool_size), callback(NULL) {}
+  pdu_queue(uint32_t pool_size_ = DEFAULT_POOL_SIZE) :
+    pdu_q(pool_size_), pool_size(pool_size_), pool(pool_size_), callback(NULL)
+  {}
   void init(process_callback* callback, log_ref log_h_);
 
   uint8_t* request(uint32_t len);
+  /// Drops a reference to the PDU, which goes back to the pool when no views of it are left
   void     deallocate(uint8_t* pdu);
   void     push(uint8_t* ptr, uint32_t len, channel_t channel = DCH);
 
+  /// Returns a view of the nof_bytes at ptr inside the PDU, which is kept until the view is released. Returns nullptr
+  /// when the PDU buffers are running low, then the caller must copy the bytes instead
+  unique_byte_buffer_t share(uint8_t* pdu, uint8_t* ptr, uint32_t nof_bytes);
+
+  /// Called by a single thread. Dispatches the PDUs pushed before the call, the ones pushed meanwhile wait for the
+  /// next call
   bool process_pdus();
 
 private:
@@ -56,17 +66,22 @@ private:
   const static int MAX_PDU_LEN       = 150 * 1024 / 8; // ~ 150 Mbps
 
   typedef struct {
-    uint8_t   ptr[MAX_PDU_LEN];
-    uint32_t  len;
-    channel_t channel;
+    uint8_t               ptr[MAX_PDU_LEN];
+    uint32_t              len;
+    channel_t             channel;
+    std::atomic<uint32_t> nof_refs; ///< The owner of the PDU plus its views
 #ifdef SRSLTE_BUFFER_POOL_LOG_ENABLED
     char debug_name[128];
 #endif
 
   } pdu_t;
 
-  block_queue<pdu_t*> pdu_q;
-  buffer_pool<pdu_t>  pool;
+  static void release_view(void* owner, void* pdu);
+
+  // Every PDU comes from the pool, so a queue with a slot per PDU never fills up and the PHY workers never block
+  mpsc_queue<pdu_t*> pdu_q;
+  uint32_t           pool_size;
+  buffer_pool<pdu_t> pool;
 
   process_callback* callback;
   log_ref           log_h;
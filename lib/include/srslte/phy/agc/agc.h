@@ -43,6 +43,8 @@
 #define SRSLTE_AGC_HOLD_COUNT (20)        /* Number of frames to wait after setting the gain before start measuring */
 #define SRSLTE_AGC_MIN_MEASUREMENTS (10)  /* Minimum number of measurements  */
 #define SRSLTE_AGC_MIN_GAIN_OFFSET (2.0f) /* Mimum of gain offset to set the radio gain */
+#define SRSLTE_AGC_BLOCK_LEN (128)        /* Number of consecutive samples of a block of the power measurement */
+#define SRSLTE_AGC_DEFAULT_DECIMATION (4) /* One block out of this many is measured */
 
 typedef enum SRSLTE_API { SRSLTE_AGC_MODE_ENERGY = 0, SRSLTE_AGC_MODE_PEAK_AMPLITUDE } srslte_agc_mode_t;
 
@@ -81,6 +83,7 @@ typedef struct SRSLTE_API {
   uint32_t           nof_frames;
   uint32_t           frame_cnt;
   uint32_t           hold_cnt;
+  uint32_t           decimation;
   float*             y_tmp;
   srslte_agc_state_t state;
 } srslte_agc_t;
@@ -103,6 +106,9 @@ SRSLTE_API float srslte_agc_get_gain(srslte_agc_t* q);
 
 SRSLTE_API void srslte_agc_set_gain(srslte_agc_t* q, float init_gain_value_db);
 
+/* Measures one block of SRSLTE_AGC_BLOCK_LEN samples out of every decimation blocks. 1 measures every sample */
+SRSLTE_API void srslte_agc_set_decimation(srslte_agc_t* q, uint32_t decimation);
+
 SRSLTE_API void srslte_agc_process(srslte_agc_t* q, cf_t* signal, uint32_t len);
 
 #endif // SRSLTE_AGC_H
@@ -47,6 +47,8 @@
 #include "srslte/phy/sync/pss.h"
 #include "wiener_dl.h"
 
+#define SRSLTE_CHEST_DL_MAX_REF_SYMB 4
+
 typedef struct SRSLTE_API {
   cf_t*    ce[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS];
   uint32_t nof_re;
@@ -65,6 +67,11 @@ typedef struct SRSLTE_API {
   float    rssi_dbm;
   float    cfo;
   float    sync_error;
+
+  /* Port 0 CRS of every receive antenna minus their channel estimate, that is the interference plus noise. They are
+   * stored by reference symbol, 2 * nof_prb pilots each. nof_crs_residual is 0 when they are not estimated */
+  cf_t*    crs_residual[SRSLTE_MAX_PORTS];
+  uint32_t nof_crs_residual;
 } srslte_chest_dl_res_t;
 
 // Noise estimation algorithm
@@ -96,6 +103,10 @@ typedef struct SRSLTE_API {
   cf_t* tmp_noise;
   cf_t* tmp_cfo_estimate;
 
+  /* Per-port CRS positions computed at set_cell: first RE of every reference symbol and OFDM symbol index */
+  uint32_t pilot_re_offset[SRSLTE_MAX_PORTS][SRSLTE_CHEST_DL_MAX_REF_SYMB];
+  uint32_t pilot_nsymbol[SRSLTE_MAX_PORTS][SRSLTE_CHEST_DL_MAX_REF_SYMB];
+
 #ifdef FREQ_SEL_SNR
   float snr_vector[12000];
   float pilot_power[12000];
@@ -124,6 +135,7 @@ typedef struct SRSLTE_API {
 
   srslte_chest_dl_estimator_alg_t estimator_alg;
   srslte_chest_dl_noise_alg_t     noise_alg;
+  srslte_wiener_dl_mode_t         wiener_mode;
 
   srslte_chest_filter_t       filter_type;
   float                       filter_coef[2];
@@ -133,6 +145,7 @@ typedef struct SRSLTE_API {
   bool     cfo_estimate_enable;
   uint32_t cfo_estimate_sf_mask;
   bool     sync_error_enable;
+  bool     crs_residual_enable;
 
 } srslte_chest_dl_cfg_t;
 
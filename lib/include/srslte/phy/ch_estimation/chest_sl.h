@@ -78,6 +78,10 @@ typedef struct SRSLTE_API {
 
   cf_t* r_sequence_rx[SRSLTE_SL_MAX_DMRS_SYMB];
 
+  // Configuration r_sequence was generated with for the PSSCH, which is only generated again when it changes
+  srslte_chest_sl_cfg_t pssch_seq_cfg;
+  bool                  pssch_seq_valid;
+
   cf_t* ce;
   cf_t* ce_average;
   cf_t* noise_tmp;
@@ -113,6 +117,7 @@ SRSLTE_API int srslte_chest_sl_get_dmrs(srslte_chest_sl_t* q, cf_t* sf_buffer, c
 
 SRSLTE_API void srslte_chest_sl_ls_estimate(srslte_chest_sl_t* q, cf_t* sf_buffer);
 
+// Only the REs of the bands of the channel are written in equalized_sf_buffer
 SRSLTE_API void srslte_chest_sl_ls_equalize(srslte_chest_sl_t* q, cf_t* sf_buffer, cf_t* equalized_sf_buffer);
 
 SRSLTE_API void srslte_chest_sl_ls_estimate_equalize(srslte_chest_sl_t* q, cf_t* sf_buffer, cf_t* equalized_sf_buffer);
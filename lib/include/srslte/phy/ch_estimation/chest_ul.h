@@ -59,9 +59,10 @@ typedef struct SRSLTE_API {
 typedef struct {
   srslte_cell_t cell;
 
-  srslte_refsignal_ul_t             dmrs_signal;
-  srslte_refsignal_ul_dmrs_pregen_t dmrs_pregen;
-  bool                              dmrs_signal_configured;
+  srslte_refsignal_ul_t                   dmrs_signal;
+  srslte_refsignal_ul_dmrs_cache_t        dmrs_cache;
+  const srslte_refsignal_ul_dmrs_cache_t* dmrs_cache_shared;
+  bool                                    dmrs_signal_configured;
 
   srslte_refsignal_srs_pregen_t srs_pregen;
   bool                          srs_signal_configured;
@@ -95,6 +96,10 @@ SRSLTE_API void srslte_chest_ul_res_free(srslte_chest_ul_res_t* q);
 
 SRSLTE_API int srslte_chest_ul_set_cell(srslte_chest_ul_t* q, srslte_cell_t cell);
 
+/* Makes the estimator use a DMRS cache set for the same cell and configuration instead of its own one. The cache is
+ * not copied and must outlive the estimator */
+SRSLTE_API void srslte_chest_ul_set_dmrs_cache(srslte_chest_ul_t* q, const srslte_refsignal_ul_dmrs_cache_t* cache);
+
 SRSLTE_API void srslte_chest_ul_pregen(srslte_chest_ul_t*                 q,
                                        srslte_refsignal_dmrs_pusch_cfg_t* cfg,
                                        srslte_refsignal_srs_cfg_t*        srs_cfg);
@@ -118,4 +123,13 @@ SRSLTE_API int srslte_chest_ul_estimate_srs(srslte_chest_ul_t*                 q
                                             cf_t*                              input,
                                             srslte_chest_ul_res_t*             res);
 
+/* SNR in dB of the subbands of sb_size PRB, from the pilots and noise of the last srslte_chest_ul_estimate_srs() call.
+ * snr_sb_db holds ceil(nof_prb / sb_size) values, NAN for the subbands that were not sounded */
+SRSLTE_API int srslte_chest_ul_srs_snr_sb(srslte_chest_ul_t*          q,
+                                          srslte_ul_sf_cfg_t*         sf,
+                                          srslte_refsignal_srs_cfg_t* cfg,
+                                          srslte_chest_ul_res_t*      res,
+                                          uint32_t                    sb_size,
+                                          float*                      snr_sb_db);
+
 #endif // SRSLTE_CHEST_UL_H
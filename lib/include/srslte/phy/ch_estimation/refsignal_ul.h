@@ -71,6 +71,12 @@ typedef struct SRSLTE_API {
   bool     configured;
 } srslte_refsignal_srs_cfg_t;
 
+/* PUCCH DMRS of a subframe without the format 2a/2b modulation of the second symbol, valid for the configuration key */
+typedef struct SRSLTE_API {
+  srslte_pucch_seq_key_t key;
+  cf_t                   r[SRSLTE_NRE * 3 * SRSLTE_NOF_SLOTS_PER_SF];
+} srslte_refsignal_dmrs_pucch_cache_t;
+
 /** Uplink DeModulation Reference Signal (DMRS) */
 typedef struct SRSLTE_API {
   srslte_cell_t cell;
@@ -83,6 +89,8 @@ typedef struct SRSLTE_API {
   uint32_t f_gh[SRSLTE_NSLOTS_X_FRAME];
   uint32_t u_pucch[SRSLTE_NSLOTS_X_FRAME];
   uint32_t v_pusch[SRSLTE_NSLOTS_X_FRAME][SRSLTE_NOF_DELTA_SS];
+
+  srslte_refsignal_dmrs_pucch_cache_t pucch_cache[SRSLTE_NOF_SF_X_FRAME];
 } srslte_refsignal_ul_t;
 
 typedef struct {
@@ -94,6 +102,19 @@ typedef struct {
   cf_t* r[SRSLTE_NOF_SF_X_FRAME];
 } srslte_refsignal_srs_pregen_t;
 
+/* PUSCH DMRS base sequences of a cell. Only the r_uv sequences of the groups and sequences used by the cell are stored,
+ * and the cyclic shift of a slot is applied as a phase rotation when the DMRS is generated. The cache is read-only once
+ * set, so it can be shared by all the estimators of a cell */
+typedef struct SRSLTE_API {
+  uint32_t max_prb;
+  uint32_t nof_prb;
+  uint32_t u[SRSLTE_NSLOTS_X_FRAME];
+  uint32_t v[SRSLTE_NSLOTS_X_FRAME];
+  uint32_t n_cs[SRSLTE_NSLOTS_X_FRAME][SRSLTE_NOF_CSHIFT];
+  cf_t**   r_uv[SRSLTE_NOF_GROUPS_U][SRSLTE_NOF_SEQUENCES_U]; // Indexed by number of PRB
+  cf_t*    cs_phasor[SRSLTE_NRE];                            // exp(j*2*pi*n_cs*n/12) for every n_cs
+} srslte_refsignal_ul_dmrs_cache_t;
+
 SRSLTE_API int srslte_refsignal_ul_init(srslte_refsignal_ul_t* q, uint32_t max_prb);
 
 SRSLTE_API int srslte_refsignal_ul_set_cell(srslte_refsignal_ul_t* q, srslte_cell_t cell);
@@ -106,6 +127,9 @@ SRSLTE_API uint32_t srslte_refsignal_dmrs_N_rs(srslte_pucch_format_t format, srs
 
 SRSLTE_API uint32_t srslte_refsignal_dmrs_pucch_symbol(uint32_t m, srslte_pucch_format_t format, srslte_cp_t cp);
 
+SRSLTE_API float
+srslte_refsignal_dmrs_pucch_w_arg(srslte_pucch_format_t format, srslte_cp_t cp, uint32_t n_oc, uint32_t m);
+
 SRSLTE_API int srslte_refsignal_dmrs_pusch_pregen_init(srslte_refsignal_ul_dmrs_pregen_t* pregen, uint32_t max_prb);
 
 SRSLTE_API int srslte_refsignal_dmrs_pusch_pregen(srslte_refsignal_ul_t*             q,
@@ -121,6 +145,20 @@ SRSLTE_API int srslte_refsignal_dmrs_pusch_pregen_put(srslte_refsignal_ul_t*
                                                       srslte_pusch_cfg_t*                pusch_cfg,
                                                       cf_t*                              sf_symbols);
 
+SRSLTE_API int srslte_refsignal_dmrs_pusch_cache_init(srslte_refsignal_ul_dmrs_cache_t* cache, uint32_t max_prb);
+
+SRSLTE_API int srslte_refsignal_dmrs_pusch_cache_set(srslte_refsignal_ul_t*             q,
+                                                     srslte_refsignal_ul_dmrs_cache_t*  cache,
+                                                     srslte_refsignal_dmrs_pusch_cfg_t* cfg);
+
+SRSLTE_API void srslte_refsignal_dmrs_pusch_cache_free(srslte_refsignal_ul_dmrs_cache_t* cache);
+
+SRSLTE_API int srslte_refsignal_dmrs_pusch_cache_gen(const srslte_refsignal_ul_dmrs_cache_t* cache,
+                                                     uint32_t                                nof_prb,
+                                                     uint32_t                                sf_idx,
+                                                     uint32_t                                cyclic_shift_for_dmrs,
+                                                     cf_t*                                   r_pusch);
+
 SRSLTE_API int srslte_refsignal_dmrs_pusch_gen(srslte_refsignal_ul_t*             q,
                                                srslte_refsignal_dmrs_pusch_cfg_t* cfg,
                                                uint32_t                           nof_prb,
@@ -200,6 +238,8 @@ SRSLTE_API uint32_t srslte_refsignal_srs_rb_L_cs(uint32_t bw_cfg, uint32_t nof_p
 
 SRSLTE_API uint32_t srslte_refsignal_srs_M_sc(srslte_refsignal_ul_t* q, srslte_refsignal_srs_cfg_t* cfg);
 
+SRSLTE_API uint32_t srslte_refsignal_srs_k0_ue(srslte_refsignal_srs_cfg_t* cfg, uint32_t nof_prb, uint32_t tti);
+
 SRSLTE_API uint32_t srslte_refsignal_get_q(uint32_t u, uint32_t v, uint32_t N_sz);
 
 #endif // SRSLTE_REFSIGNAL_UL_H
@@ -36,6 +36,16 @@
 #define SRSLTE_WIENER_DL_XFIFO_SIZE (400U)
 #define SRSLTE_WIENER_DL_TIMEFIFO_SIZE (32U)
 #define SRSLTE_WIENER_DL_CXFIFO_SIZE (400U)
+#define SRSLTE_WIENER_DL_BANK_NOF_SNR (11U)  // Filter bank SNR points, from 0 to 30 dB in 3 dB steps
+#define SRSLTE_WIENER_DL_BANK_NOF_DELAY (6U) // Filter bank RMS delay spread points, from 50 ns to 1.6 us doubling
+
+// Wiener matrix type, maps the reference signals of two PRB pairs to their resource elements
+typedef cf_t srslte_wiener_dl_wm_t[SRSLTE_WIENER_DL_MIN_RE][SRSLTE_WIENER_DL_MIN_REF];
+
+typedef enum {
+  SRSLTE_WIENER_DL_MODE_ADAPTIVE = 0, // Wiener matrices trained online and inverted at runtime
+  SRSLTE_WIENER_DL_MODE_FILTER_BANK,  // Wiener matrices taken from a precomputed bank, indexed by SNR and delay spread
+} srslte_wiener_dl_mode_t;
 
 typedef struct {
   cf_t*    hls_fifo_1[SRSLTE_WIENER_DL_HLS_FIFO_SIZE]; // Least square channel estimates on odd pilots
@@ -51,6 +61,11 @@ typedef struct {
   uint32_t sumlen; // length of dynamic average window for time domain channel correlation vector
   uint32_t skip;   // pilot OFDM symbols to skip when training Wiener matrices (skip = 1,..,4)
   uint32_t cnt;    // counter for skipping pilot OFDM symbols
+  cf_t     freq_corr;    // averaged correlation between adjacent reference signals (filter bank mode)
+  float    freq_power;   // averaged power of the reference signals (filter bank mode)
+  float    delay_spread; // RMS delay spread estimate in seconds (filter bank mode)
+  const srslte_wiener_dl_wm_t* wm1; // Wiener matrix for the pilots in the fifth symbol of the slot
+  const srslte_wiener_dl_wm_t* wm2; // Wiener matrix for the pilots in the first symbol of the slot
 } srslte_wiener_dl_state_t;
 
 typedef struct {
@@ -72,10 +87,11 @@ typedef struct {
   srslte_wiener_dl_state_t* state[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS];
 
   // Wiener matrices
-  cf_t wm1[SRSLTE_WIENER_DL_MIN_RE][SRSLTE_WIENER_DL_MIN_REF];
-  cf_t wm2[SRSLTE_WIENER_DL_MIN_RE][SRSLTE_WIENER_DL_MIN_REF];
-  bool wm_computed;
-  bool ready;
+  srslte_wiener_dl_mode_t mode;
+  srslte_wiener_dl_wm_t   wm1;
+  srslte_wiener_dl_wm_t   wm2;
+  bool                    wm_computed;
+  bool                    ready;
 
   // Calculation support
   cf_t hlsv[SRSLTE_WIENER_DL_MIN_RE];
@@ -115,6 +131,8 @@ SRSLTE_API int srslte_wiener_dl_set_cell(srslte_wiener_dl_t* q, srslte_cell_t ce
 
 SRSLTE_API void srslte_wiener_dl_reset(srslte_wiener_dl_t* q);
 
+SRSLTE_API int srslte_wiener_dl_set_mode(srslte_wiener_dl_t* q, srslte_wiener_dl_mode_t mode);
+
 SRSLTE_API int srslte_wiener_dl_run(srslte_wiener_dl_t* q,
                                     uint32_t            tx,
                                     uint32_t            rx,
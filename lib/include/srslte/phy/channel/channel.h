@@ -26,9 +26,13 @@
 #include "fading.h"
 #include "hst.h"
 #include "rlf.h"
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <srslte/common/log_filter.h>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace srslte {
 
@@ -67,7 +71,8 @@ public:
     uint32_t rlf_t_off_ms = 2000;
   } args_t;
 
-  channel(const args_t& channel_args, uint32_t _nof_channels);
+  // Channels created with different seeds have independent fading and noise realisations
+  channel(const args_t& channel_args, uint32_t _nof_channels, uint32_t _seed = 0);
   ~channel();
   void set_logger(log_filter* _log_h);
   void set_srate(uint32_t srate);
@@ -75,18 +80,35 @@ public:
   void run(cf_t* in[SRSLTE_MAX_CHANNELS], cf_t* out[SRSLTE_MAX_CHANNELS], uint32_t len, const srslte_timestamp_t& t);
 
 private:
-  float                    hst_init_phase              = 0.0f;
-  srslte_channel_fading_t* fading[SRSLTE_MAX_CHANNELS] = {};
-  srslte_channel_delay_t*  delay[SRSLTE_MAX_CHANNELS]  = {};
-  srslte_channel_awgn_t*   awgn                        = nullptr;
-  srslte_channel_hst_t*    hst                         = nullptr;
-  srslte_channel_rlf_t*    rlf                         = nullptr;
-  cf_t*                    buffer_in                   = nullptr;
-  cf_t*                    buffer_out                  = nullptr;
-  log_filter*              log_h                       = nullptr;
-  uint32_t                 nof_channels                = 0;
-  uint32_t                 current_srate               = 0;
-  args_t                   args                        = {};
+  void run_channel(uint32_t i);
+  void worker_loop(uint32_t i);
+
+  float                    hst_init_phase                  = 0.0f;
+  srslte_channel_fading_t* fading[SRSLTE_MAX_CHANNELS]     = {};
+  srslte_channel_delay_t*  delay[SRSLTE_MAX_CHANNELS]      = {};
+  srslte_channel_awgn_t*   awgn[SRSLTE_MAX_CHANNELS]       = {};
+  srslte_channel_hst_t*    hst                             = nullptr;
+  srslte_channel_rlf_t*    rlf                             = nullptr;
+  cf_t*                    buffer_in[SRSLTE_MAX_CHANNELS]  = {};
+  cf_t*                    buffer_out[SRSLTE_MAX_CHANNELS] = {};
+  log_filter*              log_h                           = nullptr;
+  uint32_t                 nof_channels                    = 0;
+  uint32_t                 current_srate                   = 0;
+  uint32_t                 seed                            = 0;
+  args_t                   args                            = {};
+
+  // The channels with fading or noise run in parallel, the first one in the caller thread and each of the others in
+  // its own worker. The workers wait for run() to publish the samples of the next call
+  std::vector<std::thread>  workers;
+  std::mutex                workers_mutex;
+  std::condition_variable   workers_cvar;
+  uint64_t                  job_id       = 0;
+  uint32_t                  nof_pending  = 0;
+  bool                      workers_quit = false;
+  cf_t**                    job_in       = nullptr;
+  cf_t**                    job_out      = nullptr;
+  uint32_t                  job_len      = 0;
+  const srslte_timestamp_t* job_t        = nullptr;
 };
 
 typedef std::unique_ptr<channel> channel_ptr;
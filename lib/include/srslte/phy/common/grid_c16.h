@@ -0,0 +1,68 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/**********************************************************************************************
+ *  File:         grid_c16.h
+ *
+ *  Description:  Subframe resource grid stored as interleaved int16 (re, im) samples with one
+ *                block floating point scale per OFDM symbol. It takes half the memory of a
+ *                cf_t grid and the quantisation error of each symbol is relative to its peak.
+ *
+ *  Reference:
+ *********************************************************************************************/
+
+#ifndef SRSLTE_GRID_C16_H
+#define SRSLTE_GRID_C16_H
+
+#include "srslte/config.h"
+#include "srslte/phy/common/phy_common.h"
+#include <stdint.h>
+
+typedef struct SRSLTE_API {
+  int16_t* iq;
+  float    scale[SRSLTE_NOF_SLOTS_PER_SF * SRSLTE_MAX_NSYMB];
+  uint32_t max_re_symbol;
+  uint32_t nof_re_symbol;
+  uint32_t nof_symbols;
+} srslte_grid_c16_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SRSLTE_API int srslte_grid_c16_init(srslte_grid_c16_t* q, uint32_t max_prb);
+
+SRSLTE_API void srslte_grid_c16_free(srslte_grid_c16_t* q);
+
+/* Stores the first nof_symbols OFDM symbols of a grid of nof_prb PRB */
+SRSLTE_API int srslte_grid_c16_store(srslte_grid_c16_t* q, const cf_t* grid, uint32_t nof_prb, uint32_t nof_symbols);
+
+/* Widens OFDM symbol l of the grid into symbol, which must hold nof_re_symbol samples */
+SRSLTE_API void srslte_grid_c16_load_symbol(const srslte_grid_c16_t* q, uint32_t l, cf_t* symbol);
+
+/* Multiplies OFDM symbol l by a real gain without touching the samples */
+SRSLTE_API void srslte_grid_c16_scale_symbol(srslte_grid_c16_t* q, uint32_t l, float gain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SRSLTE_GRID_C16_H
@@ -24,6 +24,7 @@
 
 #include "srslte/config.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 /**********************************************************************************************
  *  File:         dft.h
@@ -57,7 +58,9 @@ typedef struct SRSLTE_API {
   void*             in;        // Input buffer
   void*             out;       // Output buffer
   void*             p;         // DFT plan
+  void*             dev;       // Backend implementing the plan
   bool              is_guru;
+  bool              is_cached; // Plan is owned by the process-wide plan cache and shared with other objects
   bool              forward; // Forward transform?
   bool              mirror;  // Shift negative and positive frequencies?
   bool              db;      // Provide output in dB?
@@ -82,6 +85,21 @@ SRSLTE_API int srslte_dft_plan_guru_c(srslte_dft_plan_t* plan,
                                       int                idist,
                                       int                odist);
 
+/* Guru plan running how_many_outer batches of how_many transforms each, all in a single FFTW execution */
+SRSLTE_API int srslte_dft_plan_guru_batch_c(srslte_dft_plan_t* plan,
+                                            int                dft_points,
+                                            srslte_dft_dir_t   dir,
+                                            cf_t*              in_buffer,
+                                            cf_t*              out_buffer,
+                                            int                istride,
+                                            int                ostride,
+                                            int                how_many,
+                                            int                idist,
+                                            int                odist,
+                                            int                how_many_outer,
+                                            int                idist_outer,
+                                            int                odist_outer);
+
 SRSLTE_API int srslte_dft_plan_r(srslte_dft_plan_t* plan, int dft_points, srslte_dft_dir_t dir);
 
 SRSLTE_API int srslte_dft_replan(srslte_dft_plan_t* plan, const int new_dft_points);
@@ -102,6 +120,23 @@ SRSLTE_API int srslte_dft_replan_r(srslte_dft_plan_t* plan, int new_dft_points);
 
 SRSLTE_API void srslte_dft_plan_free(srslte_dft_plan_t* plan);
 
+/* Backend selection. New plans use the selected backend, the first available one by default or the one named by the
+ * SRSLTE_DFT_BACKEND environment variable. Existing plans keep the backend they were created with. */
+
+SRSLTE_API int srslte_dft_set_backend(const char* name);
+
+SRSLTE_API const char* srslte_dft_get_backend();
+
+SRSLTE_API uint32_t srslte_dft_get_available_backends(const char** names, uint32_t max_names);
+
+/* Plan cache and FFTW wisdom */
+
+SRSLTE_API void srslte_dft_set_plan_time_limit(double seconds);
+
+SRSLTE_API int srslte_dft_import_wisdom(const char* filename);
+
+SRSLTE_API int srslte_dft_export_wisdom(const char* filename);
+
 /* Set options */
 
 SRSLTE_API void srslte_dft_plan_set_mirror(srslte_dft_plan_t* plan, bool val);
@@ -68,6 +68,7 @@ typedef struct SRSLTE_API {
   srslte_ofdm_cfg_t cfg;
   srslte_dft_plan_t fft_plan;
   srslte_dft_plan_t fft_plan_sf[2];
+  srslte_dft_plan_t fft_plan_sf_batch; // Guru plan transforming all the subframe symbols in a single execution
   uint32_t          max_prb;
   uint32_t          nof_symbols;
   uint32_t          nof_guards;
@@ -104,6 +105,10 @@ SRSLTE_API void srslte_ofdm_rx_sf(srslte_ofdm_t* q);
 
 SRSLTE_API void srslte_ofdm_rx_sf_ng(srslte_ofdm_t* q, cf_t* input, cf_t* output);
 
+/* Demodulates a subframe of interleaved int16 IQ samples, converting each sample to float (divided by scale) while
+ * filling the DFT input. Without frequency shift or MBSFN only the samples read by the DFT are written into in_buffer */
+SRSLTE_API void srslte_ofdm_rx_sf_s(srslte_ofdm_t* q, const int16_t* input, float scale);
+
 SRSLTE_API int
 srslte_ofdm_tx_init(srslte_ofdm_t* q, srslte_cp_t cp_type, cf_t* in_buffer, cf_t* out_buffer, uint32_t nof_prb);
 
@@ -114,6 +119,11 @@ SRSLTE_API void srslte_ofdm_tx_free(srslte_ofdm_t* q);
 
 SRSLTE_API void srslte_ofdm_tx_sf(srslte_ofdm_t* q);
 
+/* Plans the DFT of every standard bandwidth up to cfg->nof_prb for the given options, buffers are ignored */
+SRSLTE_API int srslte_ofdm_rx_preplan(const srslte_ofdm_cfg_t* cfg);
+
+SRSLTE_API int srslte_ofdm_tx_preplan(const srslte_ofdm_cfg_t* cfg);
+
 SRSLTE_API int srslte_ofdm_set_freq_shift(srslte_ofdm_t* q, float freq_shift);
 
 SRSLTE_API void srslte_ofdm_set_normalize(srslte_ofdm_t* q, bool normalize_enable);
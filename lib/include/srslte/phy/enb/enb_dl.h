@@ -84,9 +84,22 @@ typedef struct SRSLTE_API {
   float sss_signal0[SRSLTE_SSS_LEN];
   float sss_signal5[SRSLTE_SSS_LEN];
 
+  // Cell-static signals built by srslte_enb_dl_set_cell(). For each subframe index, the OFDM symbols after the
+  // first one that carry CRS, PSS or SSS (back to back, flagged in sf_template_mask), and the first symbol with the
+  // PCFICH of each CFI
+  cf_t*    sf_template[SRSLTE_NOF_SF_X_FRAME][SRSLTE_MAX_PORTS];
+  uint32_t sf_template_mask[SRSLTE_NOF_SF_X_FRAME];
+  cf_t*    symbol0_template[SRSLTE_NOF_SF_X_FRAME][3][SRSLTE_MAX_PORTS];
+
   uint32_t              nof_common_locations[3];
   srslte_dci_location_t common_locations[3][SRSLTE_MAX_CANDIDATES_COM];
 
+  uint32_t max_prb;
+
+  // Transmitter 0 is the pdsch above, transmitters 1 to nof_pdsch_tx are stored here
+  srslte_pdsch_t* pdsch_tx;
+  uint32_t        nof_pdsch_tx;
+
 } srslte_enb_dl_t;
 
 typedef struct {
@@ -95,11 +108,18 @@ typedef struct {
   uint32_t n_dmrs;
 } srslte_enb_dl_phich_t;
 
+/* Fills the shared DFT plan cache for all the bandwidths up to max_prb, call before creating the objects */
+SRSLTE_API int srslte_enb_dl_preplan(uint32_t max_prb);
+
 /* This function shall be called just after the initial synchronization */
 SRSLTE_API int srslte_enb_dl_init(srslte_enb_dl_t* q, cf_t* out_buffer[SRSLTE_MAX_PORTS], uint32_t max_prb);
 
 SRSLTE_API void srslte_enb_dl_free(srslte_enb_dl_t* q);
 
+/* Creates nof_pdsch_tx additional PDSCH transmitters, call after srslte_enb_dl_init() and before
+ * srslte_enb_dl_set_cell(). Each transmitter can encode a different grant of the same subframe concurrently */
+SRSLTE_API int srslte_enb_dl_add_pdsch_tx(srslte_enb_dl_t* q, uint32_t nof_pdsch_tx);
+
 SRSLTE_API int srslte_enb_dl_set_cell(srslte_enb_dl_t* q, srslte_cell_t cell);
 
 SRSLTE_API int srslte_enb_dl_add_rnti(srslte_enb_dl_t* q, uint16_t rnti);
@@ -112,13 +132,37 @@ SRSLTE_API void srslte_enb_dl_put_base(srslte_enb_dl_t* q, srslte_dl_sf_cfg_t* d
 
 SRSLTE_API void srslte_enb_dl_put_phich(srslte_enb_dl_t* q, srslte_phich_grant_t* grant, bool ack);
 
+SRSLTE_API int srslte_enb_dl_put_phich_batch(srslte_enb_dl_t*     q,
+                                             srslte_phich_grant_t grants[],
+                                             const uint8_t        acks[],
+                                             uint32_t             nof_acks);
+
 SRSLTE_API int srslte_enb_dl_put_pdcch_dl(srslte_enb_dl_t* q, srslte_dci_cfg_t* dci_cfg, srslte_dci_dl_t* dci_dl);
 
 SRSLTE_API int srslte_enb_dl_put_pdcch_ul(srslte_enb_dl_t* q, srslte_dci_cfg_t* dci_cfg, srslte_dci_ul_t* dci_ul);
 
+SRSLTE_API int srslte_enb_dl_pack_pdcch_dl(srslte_enb_dl_t*  q,
+                                           srslte_dci_cfg_t* dci_cfg,
+                                           srslte_dci_dl_t*  dci_dl,
+                                           srslte_dci_msg_t* dci_msg);
+
+SRSLTE_API int srslte_enb_dl_pack_pdcch_ul(srslte_enb_dl_t*  q,
+                                           srslte_dci_cfg_t* dci_cfg,
+                                           srslte_dci_ul_t*  dci_ul,
+                                           srslte_dci_msg_t* dci_msg);
+
+/* Encodes the DCI messages packed with srslte_enb_dl_pack_pdcch_dl/ul for the whole subframe at once */
+SRSLTE_API int srslte_enb_dl_put_pdcch_batch(srslte_enb_dl_t* q, srslte_dci_msg_t dci_msgs[], uint32_t nof_msgs);
+
 SRSLTE_API int
 srslte_enb_dl_put_pdsch(srslte_enb_dl_t* q, srslte_pdsch_cfg_t* pdsch, uint8_t* data[SRSLTE_MAX_CODEWORDS]);
 
+/* Same as srslte_enb_dl_put_pdsch() using the PDSCH transmitter tx_idx, 0 being the default one */
+SRSLTE_API int srslte_enb_dl_put_pdsch_tx(srslte_enb_dl_t*    q,
+                                          uint32_t            tx_idx,
+                                          srslte_pdsch_cfg_t* pdsch,
+                                          uint8_t*            data[SRSLTE_MAX_CODEWORDS]);
+
 SRSLTE_API int srslte_enb_dl_put_pmch(srslte_enb_dl_t* q, srslte_pmch_cfg_t* pmch_cfg, uint8_t* data);
 
 SRSLTE_API void srslte_enb_dl_gen_signal(srslte_enb_dl_t* q);
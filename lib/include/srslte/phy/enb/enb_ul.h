@@ -49,8 +49,17 @@
 
 #include "srslte/config.h"
 
+/* Additional PUSCH receiver. It holds everything a PUSCH decode writes to, so that several users can be decoded
+ * concurrently from the same subframe symbols */
+typedef struct SRSLTE_API {
+  srslte_chest_ul_res_t chest_res;
+  srslte_chest_ul_t     chest;
+  srslte_pusch_t        pusch;
+} srslte_enb_ul_pusch_rx_t;
+
 typedef struct SRSLTE_API {
   srslte_cell_t cell;
+  uint32_t      max_prb;
 
   cf_t*                 sf_symbols;
   srslte_chest_ul_res_t chest_res;
@@ -60,13 +69,28 @@ typedef struct SRSLTE_API {
   srslte_pusch_t    pusch;
   srslte_pucch_t    pucch;
 
+  // Receiver 0 is the chest/pusch pair above, receivers 1 to nof_pusch_rx are stored here
+  srslte_enb_ul_pusch_rx_t* pusch_rx;
+  uint32_t                  nof_pusch_rx;
+
 } srslte_enb_ul_t;
 
+/* Fills the shared DFT plan cache for all the bandwidths up to max_prb, call before creating the objects */
+SRSLTE_API int srslte_enb_ul_preplan(uint32_t max_prb);
+
 /* This function shall be called just after the initial synchronization */
 SRSLTE_API int srslte_enb_ul_init(srslte_enb_ul_t* q, cf_t* in_buffer, uint32_t max_prb);
 
 SRSLTE_API void srslte_enb_ul_free(srslte_enb_ul_t* q);
 
+/* Creates nof_pusch_rx additional PUSCH receivers, call after srslte_enb_ul_init() and before
+ * srslte_enb_ul_set_cell() */
+SRSLTE_API int srslte_enb_ul_add_pusch_rx(srslte_enb_ul_t* q, uint32_t nof_pusch_rx);
+
+/* Makes all the PUSCH receivers use a DMRS cache shared with other eNB UL objects of the same cell, call after
+ * srslte_enb_ul_add_pusch_rx() and before srslte_enb_ul_set_cell() */
+SRSLTE_API void srslte_enb_ul_set_dmrs_cache(srslte_enb_ul_t* q, const srslte_refsignal_ul_dmrs_cache_t* cache);
+
 SRSLTE_API int srslte_enb_ul_set_cell(srslte_enb_ul_t*                   q,
                                       srslte_cell_t                      cell,
                                       srslte_refsignal_dmrs_pusch_cfg_t* pusch_cfg,
@@ -78,6 +102,10 @@ SRSLTE_API void srslte_enb_ul_rem_rnti(srslte_enb_ul_t* q, uint16_t rnti);
 
 SRSLTE_API void srslte_enb_ul_fft(srslte_enb_ul_t* q);
 
+/* Same as srslte_enb_ul_fft() demodulating interleaved int16 IQ samples, full scale is INT16_MAX, instead of the
+ * input buffer given at init, which is overwritten */
+SRSLTE_API void srslte_enb_ul_fft_s(srslte_enb_ul_t* q, const int16_t* input);
+
 SRSLTE_API int srslte_enb_ul_get_pucch(srslte_enb_ul_t*    q,
                                        srslte_ul_sf_cfg_t* ul_sf,
                                        srslte_pucch_cfg_t* cfg,
@@ -88,4 +116,25 @@ SRSLTE_API int srslte_enb_ul_get_pusch(srslte_enb_ul_t*    q,
                                        srslte_pusch_cfg_t* cfg,
                                        srslte_pusch_res_t* res);
 
+/* Same as srslte_enb_ul_get_pusch() using the PUSCH receiver rx_idx (0 is the default one). Calls with different
+ * receivers can run concurrently once srslte_enb_ul_fft() has returned */
+SRSLTE_API int srslte_enb_ul_get_pusch_rx(srslte_enb_ul_t*    q,
+                                          uint32_t            rx_idx,
+                                          srslte_ul_sf_cfg_t* ul_sf,
+                                          srslte_pusch_cfg_t* cfg,
+                                          srslte_pusch_res_t* res);
+
+/* Estimates the SRS of a UE with the default receiver. The wideband measurements are left in q->chest_res and the SNR
+ * of the subbands of sb_size PRB in snr_sb_db, NAN for the subbands that were not sounded */
+SRSLTE_API int srslte_enb_ul_get_srs(srslte_enb_ul_t*                   q,
+                                     srslte_ul_sf_cfg_t*                ul_sf,
+                                     srslte_refsignal_srs_cfg_t*        srs_cfg,
+                                     srslte_refsignal_dmrs_pusch_cfg_t* dmrs_cfg,
+                                     uint32_t                           sb_size,
+                                     float*                             snr_sb_db);
+
+SRSLTE_API srslte_chest_ul_res_t* srslte_enb_ul_pusch_rx_chest_res(srslte_enb_ul_t* q, uint32_t rx_idx);
+
+SRSLTE_API srslte_pusch_t* srslte_enb_ul_pusch_rx_pusch(srslte_enb_ul_t* q, uint32_t rx_idx);
+
 #endif // SRSLTE_ENB_UL_H
@@ -33,6 +33,7 @@
 #define SRSLTE_CRC_H
 
 #include "srslte/config.h"
+#include <stdbool.h>
 #include <stdint.h>
 
 typedef struct SRSLTE_API {
@@ -43,6 +44,10 @@ typedef struct SRSLTE_API {
   uint64_t crcmask;
   uint64_t crchighbit;
   uint32_t srslte_crc_out;
+
+  // Carry-less multiplication folding constants, x^(128*d+64) mod P and x^(128*d) mod P for d = 1..4
+  bool     use_clmul;
+  uint64_t clmul_k[4][2];
 } srslte_crc_t;
 
 SRSLTE_API int srslte_crc_init(srslte_crc_t* h, uint32_t srslte_crc_poly, int srslte_crc_order);
@@ -69,8 +74,21 @@ static inline uint64_t srslte_crc_checksum_get(srslte_crc_t* h)
   return (h->crcinit & h->crcmask);
 }
 
+/* Feeds nof_bytes bytes to the running checksum, same as calling srslte_crc_checksum_put_byte() for each of them */
+SRSLTE_API void srslte_crc_checksum_put_bytes(srslte_crc_t* h, const uint8_t* data, uint32_t nof_bytes);
+
 SRSLTE_API uint32_t srslte_crc_checksum_byte(srslte_crc_t* h, uint8_t* data, int len);
 
+/**
+ * Computes the checksum of nof_blocks byte buffers in one call. len[i] is the number of bits of data[i], and must be a
+ * multiple of 8. The checksum of each block is written in checksum[i].
+ */
+SRSLTE_API void srslte_crc_checksum_byte_batch(srslte_crc_t*   h,
+                                               uint8_t**       data,
+                                               const uint32_t* len,
+                                               uint32_t        nof_blocks,
+                                               uint32_t*       checksum);
+
 SRSLTE_API uint32_t srslte_crc_checksum(srslte_crc_t* h, uint8_t* data, int len);
 
 #endif // SRSLTE_CRC_H
@@ -42,6 +42,8 @@
 #endif
 SRSLTE_API int srslte_rm_conv_tx(uint8_t* input, uint32_t in_len, uint8_t* output, uint32_t out_len);
 
+SRSLTE_API int srslte_rm_conv_tx_table(uint32_t in_len, uint16_t* table);
+
 SRSLTE_API int srslte_rm_conv_rx(float* input, uint32_t in_len, float* output, uint32_t out_len);
 
 /************* FIX THIS. MOVE ALL PROCESSING TO INT16 AND HAVE ONLY 1 IMPLEMENTATION ******/
@@ -64,6 +64,19 @@ SRSLTE_API int srslte_rm_turbo_tx_lut(uint8_t* w_buff,
                                       uint32_t w_offset,
                                       uint32_t rv_idx);
 
+/* Same as srslte_rm_turbo_tx_lut() reading the systematic bits from split onwards from systematic_tail, see
+ * srslte_bit_interleaver_run_split(). The systematic bits are only read with rv_idx 0 */
+SRSLTE_API int srslte_rm_turbo_tx_lut_split(uint8_t*       w_buff,
+                                            const uint8_t* systematic,
+                                            const uint8_t* systematic_tail,
+                                            uint32_t       split,
+                                            uint8_t*       parity,
+                                            uint8_t*       output,
+                                            uint32_t       cb_idx,
+                                            uint32_t       out_len,
+                                            uint32_t       w_offset,
+                                            uint32_t       rv_idx);
+
 SRSLTE_API int srslte_rm_turbo_rx(float*   w_buff,
                                   uint32_t buff_len,
                                   float*   input,
@@ -34,9 +34,13 @@
 #include "srslte/config.h"
 #include "srslte/phy/common/phy_common.h"
 
+/* The soft bits and decoded data of each codeblock are allocated the first time the codeblock is decoded. The 8-bit
+ * softbuffers hold saturated int8_t soft bits for the 8-bit turbo decoder, with half the memory of the 16-bit ones. */
 typedef struct SRSLTE_API {
   uint32_t  max_cb;
+  bool      is_8bit;
   int16_t** buffer_f;
+  int8_t**  buffer_b;
   uint8_t** data;
   bool*     cb_crc;
   bool      tb_crc;
@@ -51,6 +55,14 @@ typedef struct SRSLTE_API {
 
 SRSLTE_API int srslte_softbuffer_rx_init(srslte_softbuffer_rx_t* q, uint32_t nof_prb);
 
+SRSLTE_API int srslte_softbuffer_rx_init_8bit(srslte_softbuffer_rx_t* q, uint32_t nof_prb);
+
+SRSLTE_API int16_t* srslte_softbuffer_rx_get_cb(srslte_softbuffer_rx_t* q, uint32_t cb_idx);
+
+SRSLTE_API int8_t* srslte_softbuffer_rx_get_cb_8bit(srslte_softbuffer_rx_t* q, uint32_t cb_idx);
+
+SRSLTE_API uint8_t* srslte_softbuffer_rx_get_data(srslte_softbuffer_rx_t* q, uint32_t cb_idx);
+
 SRSLTE_API void srslte_softbuffer_rx_reset(srslte_softbuffer_rx_t* p);
 
 SRSLTE_API void srslte_softbuffer_rx_reset_tbs(srslte_softbuffer_rx_t* q, uint32_t tbs);
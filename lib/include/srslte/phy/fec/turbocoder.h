@@ -67,6 +67,17 @@ SRSLTE_API int srslte_tcod_encode_lut(srslte_tcod_t* h,
                                       uint32_t       cblen_idx,
                                       bool           last_cb);
 
+/* Same as srslte_tcod_encode_lut() for a CB with CB CRC that is not the last one of the TB. The data is only read from
+ * input, which must be readable up to the CB size. The CB CRC and the systematic tail bits, which follow the data in
+ * the systematic bits, are written into tail (4 bytes) */
+SRSLTE_API int srslte_tcod_encode_lut_cb(srslte_tcod_t* h,
+                                         srslte_crc_t*  crc_tb,
+                                         srslte_crc_t*  crc_cb,
+                                         const uint8_t* input,
+                                         uint8_t*       tail,
+                                         uint8_t*       parity,
+                                         uint32_t       cblen_idx);
+
 SRSLTE_API void srslte_tcod_gentable();
 
 #endif // SRSLTE_TURBOCODER_H
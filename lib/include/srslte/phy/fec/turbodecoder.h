@@ -36,6 +36,7 @@
 
 #include "srslte/config.h"
 #include "srslte/phy/fec/cbsegm.h"
+#include "srslte/phy/fec/crc.h"
 #include "srslte/phy/fec/tc_interl.h"
 
 #define SRSLTE_TCOD_RATE 3
@@ -55,8 +56,11 @@
 #include "srslte/phy/fec/turbodecoder_impl.h"
 #undef LLR_IS_16BIT
 
-#define SRSLTE_TDEC_NOF_AUTO_MODES_8 2
-#define SRSLTE_TDEC_NOF_AUTO_MODES_16 3
+#define SRSLTE_TDEC_NOF_AUTO_MODES_8 3
+#define SRSLTE_TDEC_NOF_AUTO_MODES_16 4
+
+// Number of sub-block interleavers (1, 8, 16, 32 or 64 sub-blocks)
+#define SRSLTE_TDEC_NOF_INTERLEAVERS 5
 
 typedef enum { SRSLTE_TDEC_8, SRSLTE_TDEC_16 } srslte_tdec_llr_type_t;
 
@@ -90,7 +94,7 @@ typedef struct SRSLTE_API {
   uint32_t               current_long_cb;
   uint32_t               current_inter_idx;
   int                    current_cbidx;
-  srslte_tc_interl_t     interleaver[4][SRSLTE_NOF_TC_CB_SIZES];
+  srslte_tc_interl_t     interleaver[SRSLTE_TDEC_NOF_INTERLEAVERS][SRSLTE_NOF_TC_CB_SIZES];
   int                    n_iter;
 } srslte_tdec_t;
 
@@ -120,4 +124,22 @@ SRSLTE_API void srslte_tdec_iteration_8bit(srslte_tdec_t* h, int8_t* input, uint
 SRSLTE_API int
 srslte_tdec_run_all_8bit(srslte_tdec_t* h, int8_t* input, uint8_t* output, uint32_t nof_iterations, uint32_t long_cb);
 
+/* Runs up to max_iterations half-iterations, stopping as soon as the CRC of the first crc_len decided bits is
+ * correct. Returns true if the CRC matched. srslte_tdec_get_nof_iterations() returns the half-iterations used. */
+SRSLTE_API bool srslte_tdec_run_all_crc(srslte_tdec_t* h,
+                                        int16_t*       input,
+                                        uint8_t*       output,
+                                        uint32_t       max_iterations,
+                                        uint32_t       long_cb,
+                                        srslte_crc_t*  crc,
+                                        uint32_t       crc_len);
+
+SRSLTE_API bool srslte_tdec_run_all_crc_8bit(srslte_tdec_t* h,
+                                             int8_t*        input,
+                                             uint8_t*       output,
+                                             uint32_t       max_iterations,
+                                             uint32_t       long_cb,
+                                             srslte_crc_t*  crc,
+                                             uint32_t       crc_len);
+
 #endif // SRSLTE_TURBODECODER_H
@@ -183,7 +183,8 @@
 #define use_saturated_add
 #define divide_output 1
 
-#define INF 0
+// Known trellis states must stand out from the others, or the first bits of the codeblock are decided blindly
+#define INF 64
 
 inline static simd_type_t simd_rb_shift_128(simd_type_t v, const int l)
 {
@@ -284,7 +285,7 @@ inline static simd_type_t simd_rb_shift_128(simd_type_t v, const int l)
                   0)
 #define simd_rb_shift simd_rb_shift_256
 
-#define INF 0
+#define INF 64
 
 #define normalize_max
 #define normalize_period 1
@@ -299,6 +300,82 @@ inline static simd_type_t simd_rb_shift_256(simd_type_t v, const int l)
   return _mm256_blendv_epi8(hi, low, _mm256_set1_epi32(0x00FF00FF));
 }
 
+#else
+#ifdef WINIMP_IS_AVX512_16
+
+#ifndef LV_HAVE_AVX512
+#error "Selected AVX512 window decoder but instruction set not supported"
+#endif
+
+#include <immintrin.h>
+
+#define WINIMP avx512_16
+#define nof_blocks 32
+
+#define llr_t int16_t
+
+#define simd_type_t __m512i
+#define simd_load _mm512_loadu_si512
+#define simd_store _mm512_storeu_si512
+#define simd_add _mm512_adds_epi16
+#define simd_sub _mm512_subs_epi16
+#define simd_max _mm512_max_epi16
+#define simd_set1 _mm512_set1_epi16
+#define simd_insert(v, x, pos) _mm512_mask_set1_epi16(v, (__mmask32)1U << (pos), x)
+#define simd_rb_shift _mm512_srai_epi16
+
+// Shift one element across the whole 512-bit register. Out-of-range elements are overwritten by the caller.
+#define simd_move_right(v) _mm512_alignr_epi8(_mm512_shuffle_i32x4(v, v, _MM_SHUFFLE(3, 3, 2, 1)), v, 2)
+#define simd_move_left(v) _mm512_alignr_epi8(v, _mm512_shuffle_i32x4(v, v, _MM_SHUFFLE(2, 1, 0, 0)), 14)
+
+#define normalize_period 2
+#define win_overlap_len 40
+
+#define INF 10000
+
+#else
+#ifdef WINIMP_IS_AVX512_8
+
+#ifndef LV_HAVE_AVX512
+#error "Selected AVX512 window decoder but instruction set not supported"
+#endif
+
+#include <immintrin.h>
+
+#define WINIMP avx512_8
+#define nof_blocks 64
+
+#define llr_t int8_t
+
+#define simd_type_t __m512i
+#define simd_load _mm512_loadu_si512
+#define simd_store _mm512_storeu_si512
+#define simd_add _mm512_adds_epi8
+#define simd_sub _mm512_subs_epi8
+#define simd_max _mm512_max_epi8
+#define simd_set1 _mm512_set1_epi8
+#define simd_insert(v, x, pos) _mm512_mask_set1_epi8(v, (__mmask64)1ULL << (pos), x)
+#define simd_rb_shift simd_rb_shift_512
+
+// Shift one element across the whole 512-bit register. Out-of-range elements are overwritten by the caller.
+#define simd_move_right(v) _mm512_alignr_epi8(_mm512_shuffle_i32x4(v, v, _MM_SHUFFLE(3, 3, 2, 1)), v, 1)
+#define simd_move_left(v) _mm512_alignr_epi8(v, _mm512_shuffle_i32x4(v, v, _MM_SHUFFLE(2, 1, 0, 0)), 15)
+
+#define INF 64
+
+#define normalize_max
+#define normalize_period 1
+#define win_overlap_len 40
+#define use_saturated_add
+#define divide_output 1
+
+inline static simd_type_t simd_rb_shift_512(simd_type_t v, const int l)
+{
+  __m512i low = _mm512_srai_epi16(_mm512_slli_epi16(v, 8), l + 8);
+  __m512i hi  = _mm512_srai_epi16(v, l);
+  return _mm512_mask_blend_epi8((__mmask64)0x5555555555555555ULL, hi, low);
+}
+
 #else
 #ifdef WINIMP_IS_NEON16
 #include <arm_neon.h>
@@ -407,6 +484,8 @@ inline static uint8x16_t v_load_s8(int i15,
 #endif
 #endif
 #endif
+#endif
+#endif
 
 typedef struct SRSLTE_API {
   uint32_t max_long_cb;
@@ -591,7 +670,11 @@ static void MAKE_FUNC(beta)(MAKE_TYPE* s, llr_t* input, llr_t* app, llr_t* parit
 #endif
 
       for (int i = 0; i < 8; i++) {
+#ifdef simd_move_right
+        old[i] = simd_move_right(old[i]);
+#else
         old[i] = simd_shuffle(old[i], move_right);
+#endif
       }
       // last sub-block state is calculated from the trellis
       llr_t trellis_old[8];
@@ -727,7 +810,11 @@ static void MAKE_FUNC(alpha)(MAKE_TYPE* s, llr_t* input, llr_t* app, llr_t* pari
       }
 #endif
       for (int i = 0; i < 8; i++) {
+#ifdef simd_move_left
+        old[i] = simd_move_left(old[i]);
+#else
         old[i] = simd_shuffle(old[i], move_left);
+#endif
       }
 #ifdef WINIMP_IS_AVX16
       for (int i = 0; i < 8; i++) {
@@ -908,6 +995,21 @@ void MAKE_FUNC(
     INSERT8_INPUT(parity1, 24, 2);
 #endif
 
+#if nof_blocks >= 64
+    INSERT8_INPUT(syst, 32, 0);
+    INSERT8_INPUT(parity0, 32, 1);
+    INSERT8_INPUT(parity1, 32, 2);
+    INSERT8_INPUT(syst, 40, 0);
+    INSERT8_INPUT(parity0, 40, 1);
+    INSERT8_INPUT(parity1, 40, 2);
+    INSERT8_INPUT(syst, 48, 0);
+    INSERT8_INPUT(parity0, 48, 1);
+    INSERT8_INPUT(parity1, 48, 2);
+    INSERT8_INPUT(syst, 56, 0);
+    INSERT8_INPUT(parity0, 56, 1);
+    INSERT8_INPUT(parity1, 56, 2);
+#endif
+
     simd_store(systPtr++, syst);
     simd_store(parity0Ptr++, parity0);
     simd_store(parity1Ptr++, parity1);
@@ -1025,4 +1127,12 @@ void MAKE_FUNC(decision_byte)(llr_t* app1, uint8_t* output, uint32_t long_cb)
 
 #ifdef divide_output
 #undef divide_output
+#endif
+
+#ifdef simd_move_right
+#undef simd_move_right
+#endif
+
+#ifdef simd_move_left
+#undef simd_move_left
 #endif
\ No newline at end of file
@@ -24,7 +24,9 @@
  *
  *  Description:  File sink.
  *                Supports writing floats, complex floats and complex shorts
- *                to file in text or binary formats.
+ *                to file in text or binary formats, and complex bytes in
+ *                binary format. The binary writes can be handed to a
+ *                writer thread through two buffers.
  *
  *  Reference:
  *****************************************************************************/
@@ -32,6 +34,8 @@
 #ifndef SRSLTE_FILESINK_H
 #define SRSLTE_FILESINK_H
 
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -43,14 +47,33 @@
 typedef struct SRSLTE_API {
   FILE*             f;
   srslte_datatype_t type;
+  uint8_t*          staging; // Interleaved and converted samples of write_multi
+
+  // Asynchronous writer
+  bool            async;
+  bool            quit;
+  pthread_t       thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cvar;
+  uint8_t*        buffer[2];
+  uint32_t        buffer_len;  // Size of each buffer
+  uint32_t        fill_idx;    // Buffer being filled by the caller
+  uint32_t        fill_len;    // Bytes in the buffer being filled
+  uint32_t        pending_len; // Bytes of the other buffer not written to the file yet
 } srslte_filesink_t;
 
 SRSLTE_API int srslte_filesink_init(srslte_filesink_t* q, char* filename, srslte_datatype_t type);
 
+/* Binary writes are copied to one of two buffers of buffer_len bytes, and a thread writes each buffer to the file once
+ * it is full, so the caller only waits for the disk if it fills both. The remaining samples are written by free */
+SRSLTE_API int srslte_filesink_set_async(srslte_filesink_t* q, uint32_t buffer_len);
+
 SRSLTE_API void srslte_filesink_free(srslte_filesink_t* q);
 
 SRSLTE_API int srslte_filesink_write(srslte_filesink_t* q, void* buffer, int nsamples);
 
+/* The samples of the channels are interleaved. The buffers are complex floats for the complex binary types, which are
+ * converted to the type of the file */
 SRSLTE_API int srslte_filesink_write_multi(srslte_filesink_t* q, void** buffer, int nsamples, int nchannels);
 
 #endif // SRSLTE_FILESINK_H
@@ -24,7 +24,9 @@
  *
  *  Description:  File source.
  *                Supports reading floats, complex floats and complex shorts
- *                from file in text or binary formats.
+ *                from file in text or binary formats, and complex bytes in
+ *                binary format. Binary files are memory mapped when
+ *                possible, and read ahead of the current position.
  *
  *  Reference:
  *****************************************************************************/
@@ -42,6 +44,13 @@
 typedef struct SRSLTE_API {
   FILE*             f;
   srslte_datatype_t type;
+  uint8_t*          staging; // Interleaved samples of read_multi, if the file isn't mapped
+
+  // Memory mapped binary file
+  uint8_t* map;
+  size_t   map_len;
+  size_t   offset;          // Read position, in bytes
+  size_t   prefetch_offset; // End of the data requested to the kernel
 } srslte_filesource_t;
 
 SRSLTE_API int srslte_filesource_init(srslte_filesource_t* q, char* filename, srslte_datatype_t type);
@@ -52,6 +61,8 @@ SRSLTE_API void srslte_filesource_seek(srslte_filesource_t* q, int pos);
 
 SRSLTE_API int srslte_filesource_read(srslte_filesource_t* q, void* buffer, int nsamples);
 
+/* The samples of the channels are interleaved in the file. The buffers are complex floats for the complex binary types,
+ * which are converted from the type of the file */
 SRSLTE_API int srslte_filesource_read_multi(srslte_filesource_t* q, void** buffer, int nsamples, int nof_channels);
 
 #endif // SRSLTE_FILESOURCE_H
@@ -22,6 +22,8 @@
 #ifndef SRSLTE_FORMAT_H
 #define SRSLTE_FORMAT_H
 
+#include <stdint.h>
+
 typedef enum {
   SRSLTE_TEXT,
   SRSLTE_FLOAT,
@@ -29,7 +31,30 @@ typedef enum {
   SRSLTE_COMPLEX_SHORT,
   SRSLTE_FLOAT_BIN,
   SRSLTE_COMPLEX_FLOAT_BIN,
-  SRSLTE_COMPLEX_SHORT_BIN
+  SRSLTE_COMPLEX_SHORT_BIN,
+  SRSLTE_COMPLEX_BYTE_BIN
 } srslte_datatype_t;
 
+/* Full scale of the complex short and byte binary files, the samples of the multi-channel read and write functions
+ * being converted from and to complex floats */
+#define SRSLTE_FILE_SC16_SCALE 32767.0f
+#define SRSLTE_FILE_SC8_SCALE 127.0f
+
+/* Size of one sample of the binary types, 0 for the text types */
+static inline uint32_t srslte_datatype_bin_size(srslte_datatype_t type)
+{
+  switch (type) {
+    case SRSLTE_FLOAT_BIN:
+      return sizeof(float);
+    case SRSLTE_COMPLEX_FLOAT_BIN:
+      return 2 * sizeof(float);
+    case SRSLTE_COMPLEX_SHORT_BIN:
+      return 2 * sizeof(int16_t);
+    case SRSLTE_COMPLEX_BYTE_BIN:
+      return 2 * sizeof(int8_t);
+    default:
+      return 0;
+  }
+}
+
 #endif // SRSLTE_FORMAT_H
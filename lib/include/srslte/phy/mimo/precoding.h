@@ -79,6 +79,24 @@ SRSLTE_API int srslte_predecoding_single_multi(cf_t*  y[SRSLTE_MAX_PORTS],
                                                float  scaling,
                                                float  noise_estimate);
 
+/* Estimates the spatial covariance R of the interference plus noise received by nof_rxant antennas from nof_samples
+ * samples of every antenna, e.g. the reference signals minus their channel estimate. R is stored by rows */
+SRSLTE_API int srslte_predecoding_irc_covariance(cf_t* n[SRSLTE_MAX_PORTS], int nof_rxant, int nof_samples, cf_t* R);
+
+/* Interference Rejection Combining (IRC) equalizer of one layer received by up to 4 antennas,
+ * x = (h'R^-1h)^-1 h'R^-1 y, where R is the interference plus noise covariance of the antennas stored by rows. R is
+ * assumed constant along the nof_symbols, call it for every group of PRB the covariance is estimated for. With a
+ * diagonal R it is a Maximum Ratio Combining (MRC) equalizer. If csi is not NULL, the SINR after combining h'R^-1h is
+ * stored in it */
+SRSLTE_API int srslte_predecoding_single_irc(cf_t*       y[SRSLTE_MAX_PORTS],
+                                             cf_t*       h[SRSLTE_MAX_PORTS],
+                                             const cf_t* R,
+                                             cf_t*       x,
+                                             float*      csi,
+                                             int         nof_rxant,
+                                             int         nof_symbols,
+                                             float       scaling);
+
 SRSLTE_API int srslte_predecoding_diversity(cf_t* y,
                                             cf_t* h[SRSLTE_MAX_PORTS],
                                             cf_t* x[SRSLTE_MAX_LAYERS],
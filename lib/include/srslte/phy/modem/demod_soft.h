@@ -35,6 +35,7 @@
 
 #include "modem_table.h"
 #include "srslte/config.h"
+#include "srslte/phy/common/sequence.h"
 
 SRSLTE_API int srslte_demod_soft_demodulate(srslte_mod_t modulation, const cf_t* symbols, float* llr, int nsymbols);
 
@@ -42,4 +43,19 @@ SRSLTE_API int srslte_demod_soft_demodulate_s(srslte_mod_t modulation, const cf_
 
 SRSLTE_API int srslte_demod_soft_demodulate_b(srslte_mod_t modulation, const cf_t* symbols, int8_t* llr, int nsymbols);
 
+/* Demodulate and descramble with the beginning of the sequence seq in a single pass over the LLRs. Same result as
+ * srslte_demod_soft_demodulate_s() followed by srslte_scrambling_s_offset() */
+SRSLTE_API int srslte_demod_soft_demodulate_s_scrambled(srslte_mod_t             modulation,
+                                                        const cf_t*              symbols,
+                                                        short*                   llr,
+                                                        int                      nsymbols,
+                                                        const srslte_sequence_t* seq);
+
+/* 8-bit version of srslte_demod_soft_demodulate_s_scrambled() */
+SRSLTE_API int srslte_demod_soft_demodulate_b_scrambled(srslte_mod_t             modulation,
+                                                        const cf_t*              symbols,
+                                                        int8_t*                  llr,
+                                                        int                      nsymbols,
+                                                        const srslte_sequence_t* seq);
+
 #endif // SRSLTE_DEMOD_SOFT_H
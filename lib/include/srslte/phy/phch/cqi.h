@@ -157,8 +157,14 @@ srslte_cqi_periodic_send(const srslte_cqi_report_cfg_t* periodic_cfg, uint32_t t
 SRSLTE_API bool
 srslte_cqi_periodic_ri_send(const srslte_cqi_report_cfg_t* periodic_cfg, uint32_t tti, srslte_frame_type_t frame_type);
 
+SRSLTE_API int srslte_cqi_hl_get_subband_size(int nof_prb);
+
 SRSLTE_API int srslte_cqi_hl_get_no_subbands(int nof_prb);
 
+SRSLTE_API uint32_t srslte_cqi_hl_get_subband_cqi(const srslte_cqi_cfg_t*        cfg,
+                                                  const srslte_cqi_hl_subband_t* msg,
+                                                  uint32_t                       sb_idx);
+
 SRSLTE_API uint8_t srslte_cqi_from_snr(float snr);
 
 SRSLTE_API float srslte_cqi_to_coderate(uint32_t cqi, bool use_alt_table);
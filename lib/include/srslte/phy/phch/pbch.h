@@ -64,6 +64,7 @@ typedef struct SRSLTE_API {
   cf_t*    d;
   float*   llr;
   float*   temp;
+  float*   rm_frames; // de-rate matched LLR of each port hypothesis, frame and position in the 40 ms
   float    rm_f[SRSLTE_BCH_ENCODED_LEN];
   uint8_t* rm_b;
   uint8_t  data[SRSLTE_BCH_PAYLOADCRC_LEN];
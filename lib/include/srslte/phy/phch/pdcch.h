@@ -47,6 +47,19 @@
 
 typedef enum SRSLTE_API { SEARCH_UE, SEARCH_COMMON } srslte_pdcch_search_mode_t;
 
+#define SRSLTE_PDCCH_MAX_DECODED_CANDIDATES 96
+
+/* Locations whose mean absolute LLR is below this value carry no PDCCH and are not decoded */
+#define SRSLTE_PDCCH_MIN_ENERGY 0.3f
+
+/* Result of decoding one PDCCH candidate, reused by any search asking for the same location and payload size */
+typedef struct SRSLTE_API {
+  srslte_dci_location_t location;
+  uint32_t              nof_bits;
+  uint16_t              crc_rem;
+  uint8_t               payload[SRSLTE_DCI_MAX_BITS + 16];
+} srslte_pdcch_candidate_t;
+
 /* PDCCH object */
 typedef struct SRSLTE_API {
   srslte_cell_t cell;
@@ -66,6 +79,7 @@ typedef struct SRSLTE_API {
   uint8_t* e;
   float    rm_f[3 * (SRSLTE_DCI_MAX_BITS + 16)];
   float*   llr;
+  float*   cce_energy; ///< Mean absolute LLR of every CCE, computed once by srslte_pdcch_extract_llr()
 
   /* tx & rx objects */
   srslte_modem_table_t mod;
@@ -73,6 +87,14 @@ typedef struct SRSLTE_API {
   srslte_viterbi_t     decoder;
   srslte_crc_t         crc;
 
+  /* DCI encoder tables */
+  uint8_t   cc_table[1 << 7][3];           ///< Coded bits of the tail-biting convolutional encoder for every state
+  uint16_t* rm_table[SRSLTE_DCI_MAX_BITS]; ///< Rate matching circular buffer of every DCI size, built on first use
+
+  /* candidates decoded since the last call to srslte_pdcch_extract_llr() */
+  srslte_pdcch_candidate_t candidates[SRSLTE_PDCCH_MAX_DECODED_CANDIDATES];
+  uint32_t                 nof_candidates;
+
 } srslte_pdcch_t;
 
 SRSLTE_API int srslte_pdcch_init_ue(srslte_pdcch_t* q, uint32_t max_prb, uint32_t nof_rx_antennas);
@@ -93,6 +115,13 @@ SRSLTE_API int srslte_pdcch_encode(srslte_pdcch_t*     q,
                                    srslte_dci_msg_t*   msg,
                                    cf_t*               sf_symbols[SRSLTE_MAX_PORTS]);
 
+/* Encoding function: all the DCI messages of the subframe are scrambled, modulated and mapped in one pass */
+SRSLTE_API int srslte_pdcch_encode_batch(srslte_pdcch_t*     q,
+                                         srslte_dl_sf_cfg_t* sf,
+                                         srslte_dci_msg_t    msgs[],
+                                         uint32_t            nof_msgs,
+                                         cf_t*               sf_symbols[SRSLTE_MAX_PORTS]);
+
 /* Decoding functions: Extract the LLRs and save them in the srslte_pdcch_t object */
 
 SRSLTE_API int srslte_pdcch_extract_llr(srslte_pdcch_t*        q,
@@ -100,6 +129,9 @@ SRSLTE_API int srslte_pdcch_extract_llr(srslte_pdcch_t*        q,
                                         srslte_chest_dl_res_t* channel,
                                         cf_t*                  sf_symbols[SRSLTE_MAX_PORTS]);
 
+/* Decoding functions: Mean absolute LLR of a location, the same metric srslte_pdcch_decode_msg uses to skip it */
+SRSLTE_API float srslte_pdcch_location_energy(srslte_pdcch_t* q, const srslte_dci_location_t* location);
+
 /* Decoding functions: Try to decode a DCI message after calling srslte_pdcch_extract_llr */
 SRSLTE_API int
 srslte_pdcch_decode_msg(srslte_pdcch_t* q, srslte_dl_sf_cfg_t* sf, srslte_dci_cfg_t* dci_cfg, srslte_dci_msg_t* msg);
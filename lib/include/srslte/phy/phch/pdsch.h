@@ -32,6 +32,7 @@
 
 #include "srslte/config.h"
 #include "srslte/phy/ch_estimation/chest_dl.h"
+#include "srslte/phy/common/grid_c16.h"
 #include "srslte/phy/common/phy_common.h"
 #include "srslte/phy/mimo/layermap.h"
 #include "srslte/phy/mimo/precoding.h"
@@ -44,10 +45,11 @@
 #include "srslte/phy/phch/sch.h"
 #include "srslte/phy/scrambling/scrambling.h"
 
+/// Scrambling sequences of an RNTI, generated the first time the RNTI is scheduled in each subframe and codeword, and
+/// as long as the largest transport block so far
 typedef struct {
   srslte_sequence_t seq[SRSLTE_MAX_CODEWORDS][SRSLTE_NOF_SF_X_FRAME];
   uint32_t          cell_id;
-  bool              sequence_generated;
 } srslte_pdsch_user_t;
 
 /* PDSCH object */
@@ -72,6 +74,8 @@ typedef struct SRSLTE_API {
 
   float* csi[SRSLTE_MAX_CODEWORDS]; /* Channel Strengh Indicator */
 
+  cf_t* symbol_c16; /* OFDM symbol widened from an int16 grid (Rx only) */
+
   /* tx & rx objects */
   srslte_modem_table_t mod[SRSLTE_MOD_NITEMS];
 
@@ -118,6 +122,10 @@ SRSLTE_API int srslte_pdsch_encode(srslte_pdsch_t*     q,
                                    uint8_t*            data[SRSLTE_MAX_CODEWORDS],
                                    cf_t*               sf_symbols[SRSLTE_MAX_PORTS]);
 
+/* Returns true if srslte_pdsch_encode() only writes the resource elements of the grant. Otherwise the power allocation
+ * rescales whole OFDM symbols and grants of the same subframe can not be encoded concurrently */
+SRSLTE_API bool srslte_pdsch_encode_is_grant_local(const srslte_pdsch_t* q, const srslte_pdsch_cfg_t* cfg);
+
 SRSLTE_API int srslte_pdsch_decode(srslte_pdsch_t*        q,
                                    srslte_dl_sf_cfg_t*    sf,
                                    srslte_pdsch_cfg_t*    cfg,
@@ -125,6 +133,16 @@ SRSLTE_API int srslte_pdsch_decode(srslte_pdsch_t*        q,
                                    cf_t*                  sf_symbols[SRSLTE_MAX_PORTS],
                                    srslte_pdsch_res_t     data[SRSLTE_MAX_CODEWORDS]);
 
+/* Same as srslte_pdsch_decode() but reads the grids and the channel estimates from their int16 copies. The noise
+ * estimate is still taken from channel. The grids are rescaled in place if the power allocation requires it */
+SRSLTE_API int srslte_pdsch_decode_c16(srslte_pdsch_t*        q,
+                                       srslte_dl_sf_cfg_t*    sf,
+                                       srslte_pdsch_cfg_t*    cfg,
+                                       srslte_chest_dl_res_t* channel,
+                                       srslte_grid_c16_t      sf_symbols[SRSLTE_MAX_PORTS],
+                                       srslte_grid_c16_t      ce[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS],
+                                       srslte_pdsch_res_t     data[SRSLTE_MAX_CODEWORDS]);
+
 SRSLTE_API int srslte_pdsch_select_pmi(srslte_pdsch_t*        q,
                                        srslte_chest_dl_res_t* channel,
                                        uint32_t               nof_layers,
@@ -60,6 +60,7 @@ typedef struct SRSLTE_API {
   float                 rs_power;
   bool                  power_scale;
   bool                  csi_enable;
+  bool                  irc_enable;
   bool                  use_tbs_index_alt;
 
   union {
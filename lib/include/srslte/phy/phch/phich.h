@@ -52,6 +52,9 @@
 #define SRSLTE_PHICH_NORM_NSF 4
 #define SRSLTE_PHICH_EXT_NSF 2
 
+/* Ng=2 and m_i=2 with 110 PRB give 56 groups, twice as many for the extended CP */
+#define SRSLTE_PHICH_MAX_NGROUPS 112
+
 /* phich object */
 typedef struct SRSLTE_API {
   srslte_cell_t cell;
@@ -69,6 +72,10 @@ typedef struct SRSLTE_API {
   cf_t d0[SRSLTE_PHICH_MAX_NSYMB];
   cf_t z[SRSLTE_PHICH_NBITS];
 
+  /* per group buffers of the batched encoder and decoder */
+  cf_t d_group[SRSLTE_PHICH_MAX_NGROUPS][SRSLTE_PHICH_MAX_NSYMB];
+  bool group_used[SRSLTE_PHICH_MAX_NGROUPS];
+
   /* bit message */
   uint8_t data[SRSLTE_PHICH_NBITS];
   float   data_rx[SRSLTE_PHICH_NBITS];
@@ -112,12 +119,27 @@ SRSLTE_API int srslte_phich_decode(srslte_phich_t*         q,
                                    cf_t*                   sf_symbols[SRSLTE_MAX_PORTS],
                                    srslte_phich_res_t*     result);
 
+SRSLTE_API int srslte_phich_decode_batch(srslte_phich_t*               q,
+                                         srslte_dl_sf_cfg_t*           sf,
+                                         srslte_chest_dl_res_t*        channel,
+                                         const srslte_phich_resource_t n_phich[],
+                                         uint32_t                      nof_hi,
+                                         cf_t*                         sf_symbols[SRSLTE_MAX_PORTS],
+                                         srslte_phich_res_t            result[]);
+
 SRSLTE_API int srslte_phich_encode(srslte_phich_t*         q,
                                    srslte_dl_sf_cfg_t*     sf,
                                    srslte_phich_resource_t n_phich,
                                    uint8_t                 ack,
                                    cf_t*                   sf_symbols[SRSLTE_MAX_PORTS]);
 
+SRSLTE_API int srslte_phich_encode_batch(srslte_phich_t*               q,
+                                         srslte_dl_sf_cfg_t*           sf,
+                                         const srslte_phich_resource_t n_phich[],
+                                         const uint8_t                 ack[],
+                                         uint32_t                      nof_hi,
+                                         cf_t*                         sf_symbols[SRSLTE_MAX_PORTS]);
+
 SRSLTE_API void srslte_phich_reset(srslte_phich_t* q, cf_t* slot_symbols[SRSLTE_MAX_PORTS]);
 
 SRSLTE_API uint32_t srslte_phich_ngroups(srslte_phich_t* q);
@@ -43,8 +43,12 @@
 #include "srslte/phy/phch/regs.h"
 #include "srslte/phy/phch/sch.h"
 #include "srslte/phy/scrambling/scrambling.h"
+/* Scrambling sequences of an MBSFN area, shared by all the PMCH objects of the process */
 typedef struct {
   srslte_sequence_t seq[SRSLTE_NOF_SF_X_FRAME];
+  uint16_t          area_id;
+  uint32_t          len;       // Length of the sequences, in bits
+  uint32_t          nof_users; // PMCH objects that set the area
 } srslte_pmch_seq_t;
 
 typedef struct SRSLTE_API {
@@ -101,6 +101,7 @@ typedef struct SRSLTE_API {
 
   // scrambling
   srslte_sequence_t scrambling_seq;
+  uint32_t          scrambling_c_init; ///< Seed of scrambling_seq, regenerated when the configuration changes it
 
   // modulation
   srslte_mod_t         mod_idx;
@@ -34,12 +34,14 @@
 #include "srslte/phy/ch_estimation/chest_ul.h"
 #include "srslte/phy/common/phy_common.h"
 #include "srslte/phy/common/sequence.h"
+#include "srslte/phy/dft/dft.h"
 #include "srslte/phy/modem/mod.h"
 #include "srslte/phy/phch/cqi.h"
 #include "srslte/phy/phch/pucch_cfg.h"
 #include "srslte/phy/phch/uci.h"
 
 #define SRSLTE_PUCCH_N_SEQ SRSLTE_NRE
+#define SRSLTE_PUCCH_NOF_GROUPS (30)
 #define SRSLTE_PUCCH2_NOF_BITS SRSLTE_UCI_CQI_CODED_PUCCH_B
 #define SRSLTE_PUCCH2_N_SF (5)
 #define SRSLTE_PUCCH_1A_2A_NOF_ACK (1)
@@ -58,6 +60,13 @@
 #define SRSLTE_PUCCH_DEFAULT_THRESHOLD_FORMAT3 (0.5f)
 #define SRSLTE_PUCCH_DEFAULT_THRESHOLD_DMRS (0.4f)
 
+/* Base sequence of the PUCCH formats 1 and 2 in a subframe. The PUCCH symbols are the sequence scaled by the modulated
+ * UCI symbols, so it is only generated again when the configuration changes */
+typedef struct {
+  srslte_pucch_seq_key_t key;
+  cf_t                   seq[SRSLTE_PUCCH_MAX_SYMBOLS];
+} srslte_pucch_seq_cache_t;
+
 typedef struct {
   srslte_sequence_t seq_f2[SRSLTE_NOF_SF_X_FRAME];
   uint32_t          cell_id;
@@ -83,6 +92,21 @@ typedef struct SRSLTE_API {
   uint32_t f_gh[SRSLTE_NSLOTS_X_FRAME];
   float    tmp_arg[SRSLTE_PUCCH_N_SEQ];
 
+  /* base sequences of the formats 1 (index 0) and 2 (index 1) for every subframe */
+  srslte_pucch_seq_cache_t seq_cache[SRSLTE_NOF_SF_X_FRAME][2];
+
+  /* eNodeB: PUCCH RBs of the received subframe despread for all the cyclic shifts. Every symbol of the RB is multiplied
+   * by the conjugated base sequence and transformed, so the bin k holds the symbol of the UEs with cyclic shift k. The
+   * RBs are despread once per subframe and shared by all the UEs multiplexed in them */
+  srslte_dft_plan_t despread_dft;
+  cf_t*             despread;                                                  // [slot][n_prb][l][k]
+  uint32_t          despread_count;                                            // current received subframe
+  uint32_t          despread_gen[SRSLTE_NOF_SLOTS_PER_SF][SRSLTE_MAX_PRB];     // subframe where the RB was despread
+  uint32_t          despread_u[SRSLTE_NOF_SLOTS_PER_SF][SRSLTE_MAX_PRB];       // group number of the despread RB
+  uint32_t          despread_tti;
+  const cf_t*       despread_input;
+  cf_t              despread_r_u[SRSLTE_PUCCH_NOF_GROUPS][SRSLTE_PUCCH_N_SEQ]; // conjugated base sequences
+
   cf_t* z;
   cf_t* z_tmp;
   cf_t* ce;
@@ -113,6 +137,17 @@ SRSLTE_API int srslte_pucch_set_rnti(srslte_pucch_t* q, uint16_t rnti);
 
 SRSLTE_API void srslte_pucch_free_rnti(srslte_pucch_t* q, uint16_t rnti);
 
+/* srslte_pucch_decode() despreads the PUCCH RBs of the formats 1 and 2 once per subframe, for all the UEs. They are
+ * despread again when the TTI or the subframe buffer change, this function forces it when the same buffer is reused */
+SRSLTE_API void srslte_pucch_despread_reset(srslte_pucch_t* q);
+
+/* Helpers for the caches of the sequences generated from a PUCCH configuration */
+SRSLTE_API bool srslte_pucch_seq_key_match(const srslte_pucch_seq_key_t* key,
+                                           const srslte_pucch_cfg_t*     cfg,
+                                           bool                          shortened);
+
+SRSLTE_API void srslte_pucch_seq_key_set(srslte_pucch_seq_key_t* key, const srslte_pucch_cfg_t* cfg, bool shortened);
+
 /* These functions do not modify the state and run in real-time */
 SRSLTE_API void srslte_pucch_uci_gen_cfg(srslte_pucch_t* q, srslte_pucch_cfg_t* cfg, srslte_uci_data_t* uci_data);
 
@@ -86,4 +86,16 @@ typedef struct SRSLTE_API {
 
 } srslte_pucch_cfg_t;
 
+/* Parameters of a PUCCH configuration that its base sequences and DMRS depend on, the key of their caches */
+typedef struct SRSLTE_API {
+  bool                  valid;
+  srslte_pucch_format_t format;
+  uint32_t              n_pucch;
+  uint32_t              N_cs;
+  uint32_t              delta_pucch_shift;
+  uint32_t              n_rb_2;
+  bool                  group_hopping_en;
+  bool                  shortened;
+} srslte_pucch_seq_key_t;
+
 #endif // SRSLTE_PUCCH_CFG_H
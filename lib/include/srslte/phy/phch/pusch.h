@@ -45,10 +45,11 @@
 #include "srslte/phy/phch/sch.h"
 #include "srslte/phy/scrambling/scrambling.h"
 
+/// Scrambling sequences of an RNTI, generated the first time the RNTI is scheduled in each subframe, and as long as
+/// the largest transport block so far
 typedef struct {
   srslte_sequence_t seq[SRSLTE_NOF_SF_X_FRAME];
   uint32_t          cell_id;
-  bool              sequence_generated;
 } srslte_pusch_user_t;
 
 /* PUSCH object */
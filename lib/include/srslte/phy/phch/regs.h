@@ -52,6 +52,7 @@ typedef struct SRSLTE_API {
 typedef struct SRSLTE_API {
   uint32_t            nof_regs;
   srslte_regs_reg_t** regs;
+  uint32_t*           re_idx; // Index in the subframe of every RE of the channel, in REG order
 } srslte_regs_ch_t;
 
 typedef struct SRSLTE_API {
@@ -39,6 +39,7 @@
 #include "srslte/phy/phch/pdsch_cfg.h"
 #include "srslte/phy/phch/pusch_cfg.h"
 #include "srslte/phy/phch/uci.h"
+#include <pthread.h>
 
 #ifndef SRSLTE_RX_NULL
 #define SRSLTE_RX_NULL 10000
@@ -48,6 +49,74 @@
 #define SRSLTE_TX_NULL 100
 #endif
 
+#define SRSLTE_SCH_MAX_CB_WORKERS 8
+#define SRSLTE_SCH_MAX_CB_JOBS 16
+
+/* Decoder context owned by one codeblock worker thread */
+typedef struct SRSLTE_API {
+  srslte_tdec_t decoder;
+  srslte_crc_t  crc_tb;
+  srslte_crc_t  crc_cb;
+  uint8_t*      cb_data;
+  pthread_t     pthread;
+  bool          thread_running;
+  void*         pool;
+} srslte_sch_cb_worker_t;
+
+/* Codeblock handed to an offload backend, with its soft bits already de-rate matched */
+typedef struct SRSLTE_API {
+  void*         llr; // 3 * cb_len + 12 soft bits, int8_t if llr_is_8bit or int16_t otherwise
+  bool          llr_is_8bit;
+  uint32_t      cb_len;
+  uint32_t      max_iterations;
+  srslte_crc_t* crc; // checks the first crc_len decided bits, for early stopping
+  uint32_t      crc_len;
+  uint8_t*      data; // decided bits, packed like srslte_tdec_run_all_crc() writes them
+
+  // Written by the backend
+  bool     done; // codeblocks left undone are decoded by the CPU
+  bool     crc_ok;
+  uint32_t nof_iterations;
+} srslte_sch_cb_offload_task_t;
+
+/* Backend decoding batches of codeblocks outside the CPU workers, e.g. a GPU batched turbo decoder. It is called from
+ * a dedicated pool thread with the codeblocks queued by all the transport blocks in flight, while the CPU workers keep
+ * taking codeblocks from the same queue */
+typedef struct SRSLTE_API {
+  void* ctx;
+  void (*decode)(void* ctx, srslte_sch_cb_offload_task_t* tasks, uint32_t nof_tasks);
+  uint32_t max_batch; // codeblocks per batch
+  uint32_t budget_us; // time a batch may take, the batches are shrunk by the measured latency to fit (0 unlimited)
+} srslte_sch_cb_offload_t;
+
+/* Pool of turbo decoder contexts shared by any number of srslte_sch_t objects. The codeblocks of the transport blocks
+ * being decoded are queued oldest first, fanned out to the pool workers and the calling threads, and joined before
+ * the transport block CRC check. Several threads can decode transport blocks through the same pool at once */
+typedef struct SRSLTE_API {
+  uint32_t               nof_workers;
+  srslte_sch_cb_worker_t workers[SRSLTE_SCH_MAX_CB_WORKERS];
+
+  pthread_mutex_t mutex;
+  pthread_cond_t  cvar_job;
+  pthread_cond_t  cvar_done;
+
+  // Transport blocks with codeblocks not taken by any thread yet
+  void*    jobs[SRSLTE_SCH_MAX_CB_JOBS];
+  uint32_t nof_jobs;
+  bool     quit;
+
+  // Offload backend and its thread
+  srslte_sch_cb_offload_t       offload;
+  srslte_sch_cb_worker_t        offload_worker;
+  srslte_sch_cb_offload_task_t* offload_tasks;
+  void**                        offload_jobs;
+  uint32_t*                     offload_job_tasks;
+  uint8_t*                      offload_data;
+  float                         offload_us_cb; // average latency of a codeblock in a batch
+  uint64_t                      nof_cb_offload;
+  uint64_t                      nof_cb_fallback;
+} srslte_sch_cb_pool_t;
+
 /* DL-SCH AND UL-SCH common functions */
 typedef struct SRSLTE_API {
 
@@ -71,6 +140,8 @@ typedef struct SRSLTE_API {
 
   srslte_uci_cqi_pusch_t uci_cqi;
 
+  srslte_sch_cb_pool_t* cb_pool;
+
 } srslte_sch_t;
 
 SRSLTE_API int srslte_sch_init(srslte_sch_t* q);
@@ -81,6 +152,15 @@ SRSLTE_API void srslte_sch_set_max_noi(srslte_sch_t* q, uint32_t max_iterations)
 
 SRSLTE_API float srslte_sch_last_noi(srslte_sch_t* q);
 
+SRSLTE_API int srslte_sch_cb_pool_init(srslte_sch_cb_pool_t* pool, uint32_t nof_workers);
+
+SRSLTE_API void srslte_sch_cb_pool_free(srslte_sch_cb_pool_t* pool);
+
+/* Starts the thread feeding the offload backend, call once after srslte_sch_cb_pool_init() */
+SRSLTE_API int srslte_sch_cb_pool_set_offload(srslte_sch_cb_pool_t* pool, const srslte_sch_cb_offload_t* offload);
+
+SRSLTE_API void srslte_sch_set_cb_pool(srslte_sch_t* q, srslte_sch_cb_pool_t* pool);
+
 SRSLTE_API int srslte_dlsch_encode(srslte_sch_t* q, srslte_pdsch_cfg_t* cfg, uint8_t* data, uint8_t* e_bits);
 
 SRSLTE_API int srslte_dlsch_encode2(srslte_sch_t*       q,
@@ -92,9 +92,9 @@ SRSLTE_API void srslte_interp_linear_vector3(srslte_interp_linsrslte_vec_t* q,
 /* Interpolation within a vector */
 
 typedef struct {
-  cf_t*    diff_vec;
-  cf_t*    diff_vec2;
-  float*   ramp;
+  cf_t* diff_vec;
+  // Fills M samples per input sample, with M fixed at compile time for the factors of the reference signals
+  void (*expand)(const cf_t* input, const cf_t* diff, cf_t* output, uint32_t len, uint32_t M);
   uint32_t vector_len;
   uint32_t M;
   uint32_t max_vector_len;
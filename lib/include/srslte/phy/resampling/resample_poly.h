@@ -0,0 +1,145 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         resample_poly.h
+ *
+ *  Description:  Rational rate polyphase resampler. The rate is changed by
+ *                interp/decim using a Kaiser windowed low-pass filter that is
+ *                designed at initialisation from the requested passband and
+ *                stopband attenuation. Supports complex float and interleaved
+ *                int16 IQ samples, and keeps its state between calls.
+ *
+ *  Reference:    Multirate Signal Processing for Communication Systems
+ *                fredric j. harris
+ *****************************************************************************/
+
+#ifndef SRSLTE_RESAMPLE_POLY_H
+#define SRSLTE_RESAMPLE_POLY_H
+
+#include <stdint.h>
+
+#include "srslte/config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Default filter design parameters
+ */
+#define SRSLTE_RESAMPLE_POLY_DEFAULT_PASSBAND 0.8f
+#define SRSLTE_RESAMPLE_POLY_DEFAULT_ATTENUATION_DB 60.0f
+
+/**
+ * Polyphase resampler internal buffers
+ */
+typedef struct SRSLTE_API {
+  uint32_t interp;        // Interpolation factor (L)
+  uint32_t decim;         // Decimation factor (M)
+  uint32_t nof_taps;      // Taps per polyphase branch
+  uint32_t max_input_len; // Maximum number of input samples per call
+  float*   filter;        // interp branches of nof_taps time-reversed coefficients
+  cf_t*    state;         // nof_taps - 1 samples of history followed by the input
+  uint32_t next_t;        // Position of the next output sample in the interpolated grid, relative to the input
+  cf_t*    tmp_in;        // Conversion buffers for int16 samples
+  cf_t*    tmp_out;
+} srslte_resample_poly_t;
+
+/**
+ * Initialise a polyphase resampler converting the rate by interp/decim, the ratio is reduced internally.
+ * @param q Object pointer
+ * @param interp Interpolation factor
+ * @param decim Decimation factor
+ * @param max_input_len Maximum number of input samples per call
+ * @param passband Passband edge as a fraction of the lowest of the input and output Nyquist frequencies (0 to 1)
+ * @param attenuation_db Stopband attenuation in dB
+ * @return SRSLTE_SUCCESS if no error, otherwise an SRSLTE error code
+ */
+SRSLTE_API int srslte_resample_poly_init(srslte_resample_poly_t* q,
+                                         uint32_t                interp,
+                                         uint32_t                decim,
+                                         uint32_t                max_input_len,
+                                         float                   passband,
+                                         float                   attenuation_db);
+
+/**
+ * Get the group delay of the resampler filter.
+ * @param q Object pointer
+ * @return the delay in number of output samples
+ */
+SRSLTE_API float srslte_resample_poly_get_delay(srslte_resample_poly_t* q);
+
+/**
+ * Get the number of output samples that the next call with nof_input samples will produce.
+ * @param q Object pointer
+ * @param nof_input Number of input samples
+ * @return the number of output samples
+ */
+SRSLTE_API uint32_t srslte_resample_poly_nof_output(srslte_resample_poly_t* q, uint32_t nof_input);
+
+/**
+ * Get the number of input samples needed for the next call to produce exactly nof_output samples. Only exact if the
+ * resampler does not interpolate (interp <= decim).
+ * @param q Object pointer
+ * @param nof_output Number of output samples
+ * @return the number of input samples
+ */
+SRSLTE_API uint32_t srslte_resample_poly_nof_input(srslte_resample_poly_t* q, uint32_t nof_output);
+
+/**
+ * Clears the resampler history.
+ * @param q Object pointer
+ */
+SRSLTE_API void srslte_resample_poly_reset(srslte_resample_poly_t* q);
+
+/**
+ * Resample complex float samples.
+ * @param q Object pointer
+ * @param input Points at the input buffer
+ * @param output Points at the output buffer, it shall fit srslte_resample_poly_nof_output() samples
+ * @param nof_input Number of input samples, up to max_input_len
+ * @return the number of output samples or an SRSLTE error code
+ */
+SRSLTE_API int srslte_resample_poly_run(srslte_resample_poly_t* q, const cf_t* input, cf_t* output, uint32_t nof_input);
+
+/**
+ * Resample interleaved int16 IQ samples.
+ * @param q Object pointer
+ * @param input Points at the input buffer, 2 * nof_input values
+ * @param output Points at the output buffer, it shall fit 2 * srslte_resample_poly_nof_output() values
+ * @param nof_input Number of input IQ samples, up to max_input_len
+ * @return the number of output IQ samples or an SRSLTE error code
+ */
+SRSLTE_API int
+srslte_resample_poly_run_s(srslte_resample_poly_t* q, const int16_t* input, int16_t* output, uint32_t nof_input);
+
+/**
+ * Free the resampler buffers
+ * @param q Object pointer
+ */
+SRSLTE_API void srslte_resample_poly_free(srslte_resample_poly_t* q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SRSLTE_RESAMPLE_POLY_H
@@ -71,6 +71,26 @@ typedef struct {
 
 typedef void (*srslte_rf_error_handler_t)(void* arg, srslte_rf_error_t error);
 
+#define SRSLTE_RF_METRICS_NOF_BINS 16
+#define SRSLTE_RF_METRICS_MAX_CHANNELS 20
+
+/**
+ * Telemetry of an RF device, accumulated since it was last read. The histograms have logarithmic bins in microseconds:
+ * bin 0 counts values below 1 us, bin i counts values in [2^(i-1), 2^i) us and the last bin also counts larger values.
+ */
+typedef struct {
+  uint32_t nof_recv;                                      ///< Number of receive calls
+  uint32_t recv_latency_hist[SRSLTE_RF_METRICS_NOF_BINS]; ///< Duration of the driver receive calls
+  uint32_t rx_delay_hist[SRSLTE_RF_METRICS_NOF_BINS];     ///< Time from the last sample on air until it is handed to
+                                                          ///< the caller, above the smallest time seen
+  uint32_t nof_ts_jumps; ///< Receptions not starting where the previous one ended
+  int64_t  max_ts_jump;  ///< Largest timestamp jump in samples, positive if samples were lost
+  uint32_t overflow;     ///< Receive overflows, they affect every channel of the stream
+  uint32_t rx_late;      ///< Receive commands issued too late
+  uint32_t late[SRSLTE_RF_METRICS_MAX_CHANNELS];      ///< Transmissions that reached the device late, per channel
+  uint32_t underflow[SRSLTE_RF_METRICS_MAX_CHANNELS]; ///< Transmit underflows, per channel
+} srslte_rf_metrics_t;
+
 SRSLTE_API int srslte_rf_open(srslte_rf_t* h, char* args);
 
 SRSLTE_API int srslte_rf_open_multi(srslte_rf_t* h, char* args, uint32_t nof_channels);
@@ -127,6 +147,20 @@ SRSLTE_API int srslte_rf_recv_with_time_multi(srslte_rf_t* h,
                                               time_t*      secs,
                                               double*      frac_secs);
 
+/**
+ * Receives interleaved int16 IQ samples, full scale is INT16_MAX. Devices opened with a native int16 host format (e.g.
+ * UHD rx_cpu_format=sc16) avoid any conversion.
+ * @return the number of received samples or SRSLTE_ERROR if the device does not support it
+ */
+SRSLTE_API int srslte_rf_recv_with_time_multi_s(srslte_rf_t* h,
+                                                int16_t**    data,
+                                                uint32_t     nsamples,
+                                                bool         blocking,
+                                                time_t*      secs,
+                                                double*      frac_secs);
+
+SRSLTE_API bool srslte_rf_has_recv_s(srslte_rf_t* h);
+
 SRSLTE_API double srslte_rf_set_tx_srate(srslte_rf_t* h, double freq);
 
 SRSLTE_API int srslte_rf_set_tx_gain(srslte_rf_t* h, double gain);
@@ -139,6 +173,12 @@ SRSLTE_API void srslte_rf_get_time(srslte_rf_t* h, time_t* secs, double* frac_se
 
 SRSLTE_API int srslte_rf_sync(srslte_rf_t* rf);
 
+/**
+ * Reads and resets the telemetry of the device
+ * @return SRSLTE_SUCCESS, or SRSLTE_ERROR if the device does not provide it
+ */
+SRSLTE_API int srslte_rf_get_metrics(srslte_rf_t* rf, srslte_rf_metrics_t* metrics);
+
 SRSLTE_API int srslte_rf_send(srslte_rf_t* h, void* data, uint32_t nsamples, bool blocking);
 
 SRSLTE_API int
@@ -57,6 +57,9 @@ SRSLTE_API void srslte_cfo_set_tol(srslte_cfo_t* h, float tol);
 
 SRSLTE_API void srslte_cfo_correct(srslte_cfo_t* h, const cf_t* input, cf_t* output, float freq);
 
+// Corrects the same frequency on nof_ports buffers in one pass, NULL buffers are skipped
+SRSLTE_API void srslte_cfo_correct_multi(srslte_cfo_t* h, cf_t** input, cf_t** output, uint32_t nof_ports, float freq);
+
 SRSLTE_API void
 srslte_cfo_correct_offset(srslte_cfo_t* h, const cf_t* input, cf_t* output, float freq, int cexp_offset, int nsamples);
 
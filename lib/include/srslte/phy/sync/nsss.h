@@ -79,9 +79,11 @@ typedef struct SRSLTE_API {
   uint32_t             input_size;
   uint32_t             subframe_sz;
   uint32_t             fft_size, max_fft_size;
+  uint32_t             corr_len; // FFT size of the correlation, rounded up from input_size + filter length
   srslte_conv_fft_cc_t conv_fft;
 
   cf_t*  nsss_signal_time[SRSLTE_NUM_PCI];
+  cf_t*  nsss_signal_freq[SRSLTE_NUM_PCI]; // conjugated in the correlation
   cf_t*  tmp_input;
   cf_t*  conv_output;
   float* conv_output_abs;
@@ -137,6 +137,8 @@ SRSLTE_API int srslte_pss_set_N_id_2(srslte_pss_t* q, uint32_t N_id_2);
 
 SRSLTE_API int srslte_pss_find_pss(srslte_pss_t* q, const cf_t* input, float* corr_peak_value);
 
+SRSLTE_API int srslte_pss_find_pss_all(srslte_pss_t* q, const cf_t* input, float psr[3], uint32_t peak_pos[3]);
+
 SRSLTE_API int srslte_pss_chest(srslte_pss_t* q, const cf_t* input, cf_t ce[SRSLTE_PSS_LEN]);
 
 SRSLTE_API float srslte_pss_cfo_compute(srslte_pss_t* q, const cf_t* pss_recv);
@@ -35,6 +35,13 @@ typedef struct {
   cf_t*                correlation;
   srslte_conv_fft_cc_t conv_fft_cc;
 
+  // Frequency domain of the subframes of a buffer shared by the searches of several cells
+  cf_t*       buffer_fft[SRSLTE_NOF_SF_X_FRAME];
+  const cf_t* shared_buffer;
+  uint32_t    shared_nsamples;
+  uint32_t    buffer_fft_len;
+  uint32_t    buffer_fft_valid; // Bitmap of the subframes of buffer_fft already computed
+
   // Results
   bool     found;
   float    rsrp_dBfs;
@@ -50,6 +57,14 @@ SRSLTE_API int srslte_refsignal_dl_sync_set_cell(srslte_refsignal_dl_sync_t* q,
 
 SRSLTE_API void srslte_refsignal_dl_sync_free(srslte_refsignal_dl_sync_t* q);
 
+/**
+ * Declares that buffer is going to be searched for several cells, in which case the FFT of its subframes done by the
+ * peak search is computed once and shared by all the cells until the next call. It has to be called again whenever
+ * the content of the buffer changes
+ */
+SRSLTE_API int
+srslte_refsignal_dl_sync_set_buffer(srslte_refsignal_dl_sync_t* q, const cf_t* buffer, uint32_t nsamples);
+
 SRSLTE_API void srslte_refsignal_dl_sync_run(srslte_refsignal_dl_sync_t* q, cf_t* buffer, uint32_t nsamples);
 
 SRSLTE_API void srslte_refsignal_dl_sync_measure_sf(srslte_refsignal_dl_sync_t* q,
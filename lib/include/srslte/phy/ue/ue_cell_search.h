@@ -70,6 +70,10 @@ typedef struct SRSLTE_API {
 
   uint32_t max_frames;
   uint32_t nof_valid_frames;  // number of 5 ms frames to scan 
+
+  uint32_t prescreen_frames;  // number of 5 ms frames correlated with the three PSS before scanning (0 disables)
+  float    prescreen_min_psr; // N_id_2 whose best PSR in the prescreen is lower are not scanned
+  float    early_exit_psr;    // stop scanning a N_id_2 once consistent detections reach this PSR (0 disables)
     
   uint32_t *mode_ntimes;
   uint8_t *mode_counted; 
@@ -102,6 +106,10 @@ SRSLTE_API int srslte_ue_cellsearch_scan(srslte_ue_cellsearch_t * q,
 SRSLTE_API int srslte_ue_cellsearch_set_nof_valid_frames(srslte_ue_cellsearch_t *q, 
                                                          uint32_t nof_frames);
 
+SRSLTE_API void srslte_ue_cellsearch_set_prescreen(srslte_ue_cellsearch_t* q, uint32_t nof_frames, float min_psr);
+
+SRSLTE_API void srslte_ue_cellsearch_set_early_exit(srslte_ue_cellsearch_t* q, float min_psr);
+
 
 
 
@@ -36,6 +36,7 @@
 #include <stdbool.h>
 
 #include "srslte/phy/ch_estimation/chest_dl.h"
+#include "srslte/phy/common/grid_c16.h"
 #include "srslte/phy/common/phy_common.h"
 #include "srslte/phy/dft/ofdm.h"
 
@@ -67,6 +68,9 @@
 
 #define SRSLTE_MAX_DCI_MSG SRSLTE_MAX_CARRIERS
 
+// HI received by the UE in a subframe of a carrier, two in TDD UL/DL configuration 0 (36.213 Section 9.1.2)
+#define SRSLTE_UE_DL_MAX_PHICH 2
+
 typedef struct SRSLTE_API {
   srslte_dci_format_t   formats[SRSLTE_MAX_FORMATS];
   srslte_dci_location_t loc[SRSLTE_MAX_CANDIDATES];
@@ -74,9 +78,22 @@ typedef struct SRSLTE_API {
   uint32_t              nof_formats;
 } dci_blind_search_t;
 
+// PMI selected for a number of layers and the channel estimate it was computed from
+typedef struct SRSLTE_API {
+  bool     valid;
+  uint32_t pmi;
+  float    sinr_db;
+  float    snr_db;
+  uint32_t estimate_idx;
+} srslte_ue_dl_pmi_cache_t;
+
+// Maximum SNR variation in dB for reusing a PMI selection from a previous subframe
+#define SRSLTE_UE_DL_PMI_CACHE_MAX_SNR_DELTA_DB 1.0f
+
 typedef struct SRSLTE_API {
   // Cell configuration
   srslte_cell_t cell;
+  uint32_t      max_prb;
   uint32_t      nof_rx_antennas;
   uint16_t      current_mbsfn_area_id;
   uint16_t      pregen_rnti;
@@ -98,10 +115,19 @@ typedef struct SRSLTE_API {
   srslte_chest_dl_res_t chest_res;
   srslte_ofdm_t         fft[SRSLTE_MAX_PORTS];
   srslte_ofdm_t         fft_mbsfn;
+  uint32_t              nof_estimates;
+
+  // Last PMI selection for each number of layers
+  srslte_ue_dl_pmi_cache_t pmi_cache[SRSLTE_MAX_LAYERS];
 
   // Buffers to store channel symbols after demodulation
   cf_t* sf_symbols[SRSLTE_MAX_PORTS];
 
+  // Optional int16 copies of the channel symbols and the channel estimates, the PDSCH is decoded from them
+  bool              c16_storage;
+  srslte_grid_c16_t sf_symbols_c16[SRSLTE_MAX_PORTS];
+  srslte_grid_c16_t ce_c16[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS];
+
   // Variables for blind DCI search
   dci_blind_search_t current_ss_ue[SRSLTE_MI_MAX_REGS][SRSLTE_NOF_CFI][SRSLTE_NOF_SF_X_FRAME];
   dci_blind_search_t current_ss_common[SRSLTE_MI_MAX_REGS][SRSLTE_NOF_CFI];
@@ -126,6 +152,7 @@ typedef struct SRSLTE_API {
   srslte_chest_dl_cfg_t chest_cfg;
   uint32_t              last_ri;
   float                 snr_to_cqi_offset;
+  uint32_t              pmi_max_age; // Subframes a PMI selection is reused for while the SNR is stable, 0 disables it
 } srslte_ue_dl_cfg_t;
 
 typedef struct {
@@ -177,6 +204,16 @@ SRSLTE_API void srslte_ue_dl_set_mi_manual(srslte_ue_dl_t* q, uint32_t mi_idx);
 
 SRSLTE_API void srslte_ue_dl_set_mi_auto(srslte_ue_dl_t* q);
 
+/* Keeps an int16 copy of the channel symbols and the channel estimates of every normal subframe and decodes the PDSCH
+ * from it. The copy halves the memory the PDSCH extraction reads, the control channels still use the cf_t buffers */
+SRSLTE_API int srslte_ue_dl_set_c16_storage(srslte_ue_dl_t* q, bool enable);
+
+/* Perform signal demodulation and store the signal in the object */
+SRSLTE_API int srslte_ue_dl_decode_fft(srslte_ue_dl_t* q, srslte_dl_sf_cfg_t* sf);
+
+/* Perform channel estimation and PCFICH decoding on the signal demodulated by decode_fft() */
+SRSLTE_API int srslte_ue_dl_estimate(srslte_ue_dl_t* q, srslte_dl_sf_cfg_t* sf, srslte_ue_dl_cfg_t* cfg);
+
 /* Perform signal demodulation and channel estimation and store signals in the object */
 SRSLTE_API int srslte_ue_dl_decode_fft_estimate(srslte_ue_dl_t* q, srslte_dl_sf_cfg_t* sf, srslte_ue_dl_cfg_t* cfg);
 
@@ -221,6 +258,14 @@ SRSLTE_API int srslte_ue_dl_decode_phich(srslte_ue_dl_t*       q,
                                          srslte_phich_grant_t* grant,
                                          srslte_phich_res_t*   result);
 
+/* Decodes the nof_grants HI of the subframe at once, equalizing each PHICH group a single time */
+SRSLTE_API int srslte_ue_dl_decode_phich_batch(srslte_ue_dl_t*            q,
+                                               srslte_dl_sf_cfg_t*        sf,
+                                               srslte_ue_dl_cfg_t*        cfg,
+                                               const srslte_phich_grant_t grant[],
+                                               uint32_t                   nof_grants,
+                                               srslte_phich_res_t         result[]);
+
 SRSLTE_API int srslte_ue_dl_select_ri(srslte_ue_dl_t* q, uint32_t* ri, float* cn);
 
 SRSLTE_API void srslte_ue_dl_gen_cqi_periodic(srslte_ue_dl_t*     q,
@@ -69,6 +69,8 @@
 
 #define DEFAULT_CFO_EMA_TRACK 0.05
 
+#define DEFAULT_TRACK_MAX_PERIOD 1 // Maximum number of PSS occasions between PSS correlations in tracking (1 disables)
+
 typedef enum SRSLTE_API { SYNC_MODE_PSS, SYNC_MODE_GNSS } srslte_ue_sync_mode_t;
 typedef enum SRSLTE_API { SF_FIND, SF_TRACK} srslte_ue_sync_state_t;
 
@@ -136,6 +138,12 @@ typedef struct SRSLTE_API {
   uint32_t pss_stable_timeout;
   bool     pss_is_stable;
 
+  /* Low power tracking: while the time and the PSS CFO are stable, the PSS is correlated every track_period PSS
+   * occasions only, doubling it up to track_max_period */
+  uint32_t track_max_period;
+  uint32_t track_period;
+  uint32_t track_skip_cnt;
+
   uint32_t peak_idx;
   int next_rf_sample_offset;
   int last_sample_offset; 
@@ -266,6 +274,8 @@ SRSLTE_API void srslte_ue_sync_set_sfo_correct_period(srslte_ue_sync_t *q,
 SRSLTE_API void srslte_ue_sync_set_sfo_ema(srslte_ue_sync_t *q,
                                            float ema_coefficient);
 
+SRSLTE_API void srslte_ue_sync_set_track_max_period(srslte_ue_sync_t* q, uint32_t max_period);
+
 SRSLTE_API void srslte_ue_sync_get_last_timestamp(srslte_ue_sync_t *q, 
                                                   srslte_timestamp_t *timestamp);
 
@@ -35,12 +35,20 @@
 
 #include "srslte/config.h"
 
+/* Maximum number of input bits that srslte_bit_interleaver_run_split() reads from its tail buffer */
+#define SRSLTE_BIT_INTERLEAVER_MAX_TAIL 32
+
 typedef struct {
   uint32_t  nof_bits;
   uint16_t* interleaver;
   uint16_t* byte_idx;
   uint8_t*  bit_mask;
   uint8_t   n_128;
+
+  // Output positions of the last SRSLTE_BIT_INTERLEAVER_MAX_TAIL input bits
+  uint32_t nof_tail;
+  uint16_t tail_in[SRSLTE_BIT_INTERLEAVER_MAX_TAIL];
+  uint16_t tail_out[SRSLTE_BIT_INTERLEAVER_MAX_TAIL];
 } srslte_bit_interleaver_t;
 
 SRSLTE_API void srslte_bit_interleaver_init(srslte_bit_interleaver_t* q, uint16_t* interleaver, uint32_t nof_bits);
@@ -50,6 +58,15 @@ SRSLTE_API void srslte_bit_interleaver_free(srslte_bit_interleaver_t* q);
 SRSLTE_API void
 srslte_bit_interleaver_run(srslte_bit_interleaver_t* q, uint8_t* input, uint8_t* output, uint16_t w_offset);
 
+/* Same as srslte_bit_interleaver_run() without output offset, reading the input bits from split onwards from tail
+ * instead of input. split is a multiple of 8 and at most SRSLTE_BIT_INTERLEAVER_MAX_TAIL bits are left in tail. The
+ * bytes of input after split are read but ignored, so they must be readable */
+SRSLTE_API void srslte_bit_interleaver_run_split(srslte_bit_interleaver_t* q,
+                                                 const uint8_t*            input,
+                                                 const uint8_t*            tail,
+                                                 uint32_t                  split,
+                                                 uint8_t*                  output);
+
 SRSLTE_API void srslte_bit_interleave(uint8_t* input, uint8_t* output, uint16_t* interleaver, uint32_t nof_bits);
 
 SRSLTE_API void
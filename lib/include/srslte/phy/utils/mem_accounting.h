@@ -0,0 +1,78 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         mem_accounting.h
+ *
+ *  Description:  Process-wide accounting of the memory used by each subsystem.
+ *
+ *                Memory allocated with srslte_mem_malloc() is counted under
+ *                its tag until it is released with srslte_mem_free(). Memory
+ *                allocated by other means, e.g. the preallocated pools, is
+ *                reported with srslte_mem_account(). The counters are relaxed
+ *                atomics, so they can be read at any time from any thread.
+ *****************************************************************************/
+
+#ifndef SRSLTE_MEM_ACCOUNTING_H
+#define SRSLTE_MEM_ACCOUNTING_H
+
+#include "srslte/config.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum SRSLTE_API {
+  SRSLTE_MEM_TAG_SOFTBUFFER = 0, // HARQ softbuffers
+  SRSLTE_MEM_TAG_SEQUENCE,       // Scrambling sequences, most of them per RNTI
+  SRSLTE_MEM_TAG_BUFFER_POOL,    // Preallocated buffer pools, byte buffers included
+  SRSLTE_MEM_TAG_NOF_TAGS
+} srslte_mem_tag_t;
+
+typedef struct SRSLTE_API {
+  int64_t bytes;
+  int64_t objects;
+} srslte_mem_usage_t;
+
+SRSLTE_API const char* srslte_mem_tag_string(srslte_mem_tag_t tag);
+
+/* Allocates size bytes aligned as srslte_vec_malloc() does and counts them under the tag */
+SRSLTE_API void* srslte_mem_malloc(srslte_mem_tag_t tag, size_t size);
+
+/* Releases memory allocated with srslte_mem_malloc(), it accepts NULL */
+SRSLTE_API void srslte_mem_free(void* ptr);
+
+/* Adds (or subtracts, with negative values) bytes and objects allocated by other means to the tag */
+SRSLTE_API void srslte_mem_account(srslte_mem_tag_t tag, int64_t bytes, int64_t objects);
+
+SRSLTE_API srslte_mem_usage_t srslte_mem_get_usage(srslte_mem_tag_t tag);
+
+/* Prints the usage of every tag, one line each */
+SRSLTE_API void srslte_mem_fprint(FILE* stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SRSLTE_MEM_ACCOUNTING_H
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         ringbuffer_spsc.h
+ *
+ *  Description:  Lock-free single producer, single consumer ring buffer with
+ *                the same API as srslte_ringbuffer_t. Exactly one thread may
+ *                write and exactly one thread may read at a time.
+ *
+ *                The memory is mapped twice back to back, so any region of up
+ *                to capacity bytes starting anywhere in the ring is contiguous.
+ *                This allows handing out pointers into the ring with the
+ *                reserve/commit calls instead of copying. The capacity is
+ *                rounded up to a multiple of the page size.
+ *
+ *                Blocking calls spin for a while and then poll with short
+ *                sleeps instead of waiting on a condition variable.
+ *****************************************************************************/
+
+#ifndef SRSLTE_RINGBUFFER_SPSC_H
+#define SRSLTE_RINGBUFFER_SPSC_H
+
+#include "srslte/config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SRSLTE_RINGBUFFER_SPSC_CACHE_LINE 64
+
+typedef struct {
+  uint8_t* buffer;
+  uint32_t capacity;
+  bool     active;
+
+  // Monotonic byte counters, each written by one side only and kept in its own cache line
+  uint64_t wpm __attribute__((aligned(SRSLTE_RINGBUFFER_SPSC_CACHE_LINE)));
+  uint64_t rpm __attribute__((aligned(SRSLTE_RINGBUFFER_SPSC_CACHE_LINE)));
+} srslte_ringbuffer_spsc_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SRSLTE_API int srslte_ringbuffer_spsc_init(srslte_ringbuffer_spsc_t* q, int capacity);
+
+SRSLTE_API void srslte_ringbuffer_spsc_free(srslte_ringbuffer_spsc_t* q);
+
+// must not be called while the producer or the consumer are using the buffer
+SRSLTE_API void srslte_ringbuffer_spsc_reset(srslte_ringbuffer_spsc_t* q);
+
+SRSLTE_API int srslte_ringbuffer_spsc_status(srslte_ringbuffer_spsc_t* q);
+
+SRSLTE_API int srslte_ringbuffer_spsc_space(srslte_ringbuffer_spsc_t* q);
+
+SRSLTE_API int srslte_ringbuffer_spsc_resize(srslte_ringbuffer_spsc_t* q, int capacity);
+
+// write to the buffer immediately, if there isnt enough space it will overflow
+SRSLTE_API int srslte_ringbuffer_spsc_write(srslte_ringbuffer_spsc_t* q, void* ptr, int nof_bytes);
+
+// block forever until there is enough space then write to buffer
+SRSLTE_API int srslte_ringbuffer_spsc_write_block(srslte_ringbuffer_spsc_t* q, void* ptr, int nof_bytes);
+
+// block for timeout_ms milliseconds, then either write to buffer if there is space or return an error without writing
+SRSLTE_API int
+srslte_ringbuffer_spsc_write_timed(srslte_ringbuffer_spsc_t* q, void* ptr, int nof_bytes, int32_t timeout_ms);
+
+// read from buffer, blocking until there is enough samples
+SRSLTE_API int srslte_ringbuffer_spsc_read(srslte_ringbuffer_spsc_t* q, void* ptr, int nof_bytes);
+
+// read from buffer, blocking for timeout_ms milliseconds until there is enough samples or return an error
+SRSLTE_API int
+srslte_ringbuffer_spsc_read_timed(srslte_ringbuffer_spsc_t* q, void* p, int nof_bytes, int32_t timeout_ms);
+
+// read from buffer without copying, *p points to nof_bytes contiguous bytes inside the ring which are released at once
+SRSLTE_API int
+srslte_ringbuffer_spsc_read_block(srslte_ringbuffer_spsc_t* q, void** p, int nof_bytes, int32_t timeout_ms);
+
+// wait until nof_bytes can be written and point *p to them, the data is published with write_commit. A negative
+// timeout waits forever and a zero timeout does not wait
+SRSLTE_API int
+srslte_ringbuffer_spsc_write_reserve(srslte_ringbuffer_spsc_t* q, void** p, int nof_bytes, int32_t timeout_ms);
+
+SRSLTE_API void srslte_ringbuffer_spsc_write_commit(srslte_ringbuffer_spsc_t* q, int nof_bytes);
+
+// wait until nof_bytes can be read and point *p to them, the space is released with read_commit
+SRSLTE_API int
+srslte_ringbuffer_spsc_read_reserve(srslte_ringbuffer_spsc_t* q, void** p, int nof_bytes, int32_t timeout_ms);
+
+SRSLTE_API void srslte_ringbuffer_spsc_read_commit(srslte_ringbuffer_spsc_t* q, int nof_bytes);
+
+SRSLTE_API void srslte_ringbuffer_spsc_stop(srslte_ringbuffer_spsc_t* q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SRSLTE_RINGBUFFER_SPSC_H
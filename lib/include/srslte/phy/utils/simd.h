@@ -128,7 +128,7 @@
 
 #define SRSLTE_SIMD_B_SIZE 64
 #define SRSLTE_SIMD_S_SIZE 32
-#define SRSLTE_SIMD_C16_SIZE 0
+#define SRSLTE_SIMD_C16_SIZE 32
 
 #else
 #ifdef LV_HAVE_AVX2
@@ -669,6 +669,43 @@ static inline simd_cf_t srslte_simd_cfi_loadu(const cf_t* ptr)
   return ret;
 }
 
+/* Loads SRSLTE_SIMD_CF_SIZE complex samples taken every stride samples from an interleaved complex vector */
+static inline simd_cf_t srslte_simd_cfi_load_stride(const cf_t* ptr, uint32_t stride)
+{
+  simd_cf_t ret;
+#ifdef LV_HAVE_AVX512
+  __m512i idx = _mm512_mullo_epi32(
+      _mm512_setr_epi32(0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F),
+      _mm512_set1_epi32(2 * stride));
+  ret.re = _mm512_i32gather_ps(idx, (float*)(ptr), 4);
+  ret.im = _mm512_i32gather_ps(idx, (float*)(ptr) + 1, 4);
+#else /* LV_HAVE_AVX512 */
+#ifdef LV_HAVE_AVX2
+  // Same element order as srslte_simd_cfi_load, so the result can be mixed with other loaded vectors
+  __m256i idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7), _mm256_set1_epi32(2 * stride));
+  ret.re      = _mm256_i32gather_ps((float*)(ptr), idx, 4);
+  ret.im      = _mm256_i32gather_ps((float*)(ptr) + 1, idx, 4);
+#else /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_SSE
+  ret.re = _mm_setr_ps(__real__ ptr[0], __real__ ptr[stride], __real__ ptr[2 * stride], __real__ ptr[3 * stride]);
+  ret.im = _mm_setr_ps(__imag__ ptr[0], __imag__ ptr[stride], __imag__ ptr[2 * stride], __imag__ ptr[3 * stride]);
+#else
+#ifdef HAVE_NEON
+  ret.val[0] = vdupq_n_f32(__real__ ptr[0]);
+  ret.val[1] = vdupq_n_f32(__imag__ ptr[0]);
+  ret.val[0] = vsetq_lane_f32(__real__ ptr[stride], ret.val[0], 1);
+  ret.val[1] = vsetq_lane_f32(__imag__ ptr[stride], ret.val[1], 1);
+  ret.val[0] = vsetq_lane_f32(__real__ ptr[2 * stride], ret.val[0], 2);
+  ret.val[1] = vsetq_lane_f32(__imag__ ptr[2 * stride], ret.val[1], 2);
+  ret.val[0] = vsetq_lane_f32(__real__ ptr[3 * stride], ret.val[0], 3);
+  ret.val[1] = vsetq_lane_f32(__imag__ ptr[3 * stride], ret.val[1], 3);
+#endif /* HAVE_NEON */
+#endif /* LV_HAVE_SSE */
+#endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
+  return ret;
+}
+
 static inline simd_cf_t srslte_simd_cf_load(const float* re, const float* im)
 {
   simd_cf_t ret;
@@ -1662,7 +1699,7 @@ static inline simd_c16_t srslte_simd_c16i_load(const c16_t* ptr)
   simd_c16_t ret;
 #ifdef LV_HAVE_AVX512
   __m512i in1 = _mm512_load_si512((__m512i*)(ptr));
-  __m512i in2 = _mm512_load_si512((__m512i*)(ptr + 8));
+  __m512i in2 = _mm512_load_si512((__m512i*)(ptr + 16));
   ret.re.m512 = _mm512_mask_blend_epi16(
       0xAAAAAAAA, in1, _mm512_shufflelo_epi16(_mm512_shufflehi_epi16(in2, 0b10100000), 0b10100000));
   ret.im.m512 = _mm512_mask_blend_epi16(
@@ -1694,6 +1731,10 @@ static inline simd_c16_t srslte_simd_c16i_load(const c16_t* ptr)
 static inline simd_c16_t srslte_simd_c16_load(const int16_t* re, const int16_t* im)
 {
   simd_c16_t ret;
+#ifdef LV_HAVE_AVX512
+  ret.re.m512 = _mm512_load_si512((__m512i*)(re));
+  ret.im.m512 = _mm512_load_si512((__m512i*)(im));
+#else /* LV_HAVE_AVX512 */
 #ifdef LV_HAVE_AVX2
   ret.re.m256 = _mm256_load_si256((__m256i*)(re));
   ret.im.m256 = _mm256_load_si256((__m256i*)(im));
@@ -1708,12 +1749,17 @@ static inline simd_c16_t srslte_simd_c16_load(const int16_t* re, const int16_t*
 #endif /* HAVE_NEON */
 #endif /* LV_HAVE_SSE */
 #endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
   return ret;
 }
 
 static inline simd_c16_t srslte_simd_c16_loadu(const int16_t* re, const int16_t* im)
 {
   simd_c16_t ret;
+#ifdef LV_HAVE_AVX512
+  ret.re.m512 = _mm512_loadu_si512((__m512i*)(re));
+  ret.im.m512 = _mm512_loadu_si512((__m512i*)(im));
+#else /* LV_HAVE_AVX512 */
 #ifdef LV_HAVE_AVX2
   ret.re.m256 = _mm256_loadu_si256((__m256i*)(re));
   ret.im.m256 = _mm256_loadu_si256((__m256i*)(im));
@@ -1728,11 +1774,18 @@ static inline simd_c16_t srslte_simd_c16_loadu(const int16_t* re, const int16_t*
 #endif /* HAVE_NEON */
 #endif /* LV_HAVE_SSE */
 #endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
   return ret;
 }
 
 static inline void srslte_simd_c16i_store(c16_t* ptr, simd_c16_t simdreg)
 {
+#ifdef LV_HAVE_AVX512
+  __m512i re_sw = _mm512_shufflelo_epi16(_mm512_shufflehi_epi16(simdreg.re.m512, 0b10110001), 0b10110001);
+  __m512i im_sw = _mm512_shufflelo_epi16(_mm512_shufflehi_epi16(simdreg.im.m512, 0b10110001), 0b10110001);
+  _mm512_store_si512((__m512i*)(ptr), _mm512_mask_blend_epi16(0xAAAAAAAA, simdreg.re.m512, im_sw));
+  _mm512_store_si512((__m512i*)(ptr + 16), _mm512_mask_blend_epi16(0xAAAAAAAA, re_sw, simdreg.im.m512));
+#else /* LV_HAVE_AVX512 */
 #ifdef LV_HAVE_AVX2
   __m256i re_sw = _mm256_shufflelo_epi16(_mm256_shufflehi_epi16(simdreg.re.m256, 0b10110001), 0b10110001);
   __m256i im_sw = _mm256_shufflelo_epi16(_mm256_shufflehi_epi16(simdreg.im.m256, 0b10110001), 0b10110001);
@@ -1750,10 +1803,17 @@ static inline void srslte_simd_c16i_store(c16_t* ptr, simd_c16_t simdreg)
 #endif /* HAVE_NEON */
 #endif /* LV_HAVE_SSE */
 #endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
 }
 
 static inline void srslte_simd_c16i_storeu(c16_t* ptr, simd_c16_t simdreg)
 {
+#ifdef LV_HAVE_AVX512
+  __m512i re_sw = _mm512_shufflelo_epi16(_mm512_shufflehi_epi16(simdreg.re.m512, 0b10110001), 0b10110001);
+  __m512i im_sw = _mm512_shufflelo_epi16(_mm512_shufflehi_epi16(simdreg.im.m512, 0b10110001), 0b10110001);
+  _mm512_storeu_si512((__m512i*)(ptr), _mm512_mask_blend_epi16(0xAAAAAAAA, simdreg.re.m512, im_sw));
+  _mm512_storeu_si512((__m512i*)(ptr + 16), _mm512_mask_blend_epi16(0xAAAAAAAA, re_sw, simdreg.im.m512));
+#else /* LV_HAVE_AVX512 */
 #ifdef LV_HAVE_AVX2
   __m256i re_sw = _mm256_shufflelo_epi16(_mm256_shufflehi_epi16(simdreg.re.m256, 0b10110001), 0b10110001);
   __m256i im_sw = _mm256_shufflelo_epi16(_mm256_shufflehi_epi16(simdreg.im.m256, 0b10110001), 0b10110001);
@@ -1771,10 +1831,15 @@ static inline void srslte_simd_c16i_storeu(c16_t* ptr, simd_c16_t simdreg)
 #endif /* HAVE_NEON */
 #endif /* LV_HAVE_SSE */
 #endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
 }
 
 static inline void srslte_simd_c16_store(int16_t* re, int16_t* im, simd_c16_t simdreg)
 {
+#ifdef LV_HAVE_AVX512
+  _mm512_store_si512((__m512i*)re, simdreg.re.m512);
+  _mm512_store_si512((__m512i*)im, simdreg.im.m512);
+#else /* LV_HAVE_AVX512 */
 #ifdef LV_HAVE_AVX2
   _mm256_store_si256((__m256i*)re, simdreg.re.m256);
   _mm256_store_si256((__m256i*)im, simdreg.im.m256);
@@ -1789,10 +1854,15 @@ static inline void srslte_simd_c16_store(int16_t* re, int16_t* im, simd_c16_t si
 #endif /* HAVE_NEON */
 #endif /* LV_HAVE_SSE */
 #endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
 }
 
 static inline void srslte_simd_c16_storeu(int16_t* re, int16_t* im, simd_c16_t simdreg)
 {
+#ifdef LV_HAVE_AVX512
+  _mm512_storeu_si512((__m512i*)re, simdreg.re.m512);
+  _mm512_storeu_si512((__m512i*)im, simdreg.im.m512);
+#else /* LV_HAVE_AVX512 */
 #ifdef LV_HAVE_AVX2
   _mm256_storeu_si256((__m256i*)re, simdreg.re.m256);
   _mm256_storeu_si256((__m256i*)im, simdreg.im.m256);
@@ -1807,11 +1877,18 @@ static inline void srslte_simd_c16_storeu(int16_t* re, int16_t* im, simd_c16_t s
 #endif /* HAVE_NEON */
 #endif /* LV_HAVE_SSE */
 #endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
 }
 
 static inline simd_c16_t srslte_simd_c16_prod(simd_c16_t a, simd_c16_t b)
 {
   simd_c16_t ret;
+#ifdef LV_HAVE_AVX512
+  ret.re.m512 = _mm512_sub_epi16(_mm512_mulhrs_epi16(a.re.m512, _mm512_slli_epi16(b.re.m512, 1)),
+                                 _mm512_mulhrs_epi16(a.im.m512, _mm512_slli_epi16(b.im.m512, 1)));
+  ret.im.m512 = _mm512_add_epi16(_mm512_mulhrs_epi16(a.re.m512, _mm512_slli_epi16(b.im.m512, 1)),
+                                 _mm512_mulhrs_epi16(a.im.m512, _mm512_slli_epi16(b.re.m512, 1)));
+#else /* LV_HAVE_AVX512 */
 #ifdef LV_HAVE_AVX2
   ret.re.m256 = _mm256_sub_epi16(_mm256_mulhrs_epi16(a.re.m256, _mm256_slli_epi16(b.re.m256, 1)),
                                  _mm256_mulhrs_epi16(a.im.m256, _mm256_slli_epi16(b.im.m256, 1)));
@@ -1825,12 +1902,17 @@ static inline simd_c16_t srslte_simd_c16_prod(simd_c16_t a, simd_c16_t b)
                               _mm_mulhrs_epi16(a.im.m128, _mm_slli_epi16(b.re.m128, 1)));
 #endif /* LV_HAVE_SSE */
 #endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
   return ret;
 }
 
 static inline simd_c16_t srslte_simd_c16_add(simd_c16_t a, simd_c16_t b)
 {
   simd_c16_t ret;
+#ifdef LV_HAVE_AVX512
+  ret.re.m512 = _mm512_add_epi16(a.re.m512, b.re.m512);
+  ret.im.m512 = _mm512_add_epi16(a.im.m512, b.im.m512);
+#else /* LV_HAVE_AVX512 */
 #ifdef LV_HAVE_AVX2
   ret.re.m256 = _mm256_add_epi16(a.re.m256, b.re.m256);
   ret.im.m256 = _mm256_add_epi16(a.im.m256, b.im.m256);
@@ -1845,12 +1927,17 @@ static inline simd_c16_t srslte_simd_c16_add(simd_c16_t a, simd_c16_t b)
 #endif /* HAVE_NEON */
 #endif /* LV_HAVE_SSE */
 #endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
   return ret;
 }
 
 static inline simd_c16_t srslte_simd_c16_zero(void)
 {
   simd_c16_t ret;
+#ifdef LV_HAVE_AVX512
+  ret.re.m512 = _mm512_setzero_si512();
+  ret.im.m512 = _mm512_setzero_si512();
+#else /* LV_HAVE_AVX512 */
 #ifdef LV_HAVE_AVX2
   ret.re.m256 = _mm256_setzero_si256();
   ret.im.m256 = _mm256_setzero_si256();
@@ -1865,6 +1952,7 @@ static inline simd_c16_t srslte_simd_c16_zero(void)
 #endif /* HAVE_NEON    */
 #endif /* LV_HAVE_SSE  */
 #endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
   return ret;
 }
 
@@ -1909,6 +1997,30 @@ static inline simd_s_t srslte_simd_convert_2f_s(simd_f_t a, simd_f_t b)
 #endif /* LV_HAVE_AVX512 */
 }
 
+/* Converts the first and second halves of a into lo and hi respectively */
+static inline void srslte_simd_convert_s_2f(simd_s_t a, simd_f_t* lo, simd_f_t* hi)
+{
+#ifdef LV_HAVE_AVX512
+  *lo = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm512_castsi512_si256(a)));
+  *hi = _mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm512_extracti64x4_epi64(a, 1)));
+#else /* LV_HAVE_AVX512 */
+#ifdef LV_HAVE_AVX2
+  *lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(a)));
+  *hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(a, 1)));
+#else
+#ifdef LV_HAVE_SSE
+  *lo = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(a));
+  *hi = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_srli_si128(a, 8)));
+#else
+#ifdef HAVE_NEON
+  *lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(a)));
+  *hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(a)));
+#endif /* HAVE_NEON */
+#endif /* LV_HAVE_SSE */
+#endif /* LV_HAVE_AVX2 */
+#endif /* LV_HAVE_AVX512 */
+}
+
 #endif /* SRSLTE_SIMD_F_SIZE && SRSLTE_SIMD_C16_SIZE */
 
 #if SRSLTE_SIMD_B_SIZE
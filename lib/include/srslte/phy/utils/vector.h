@@ -79,6 +79,10 @@ SRSLTE_API void srslte_vec_xor_bbb(int8_t* x, int8_t* y, int8_t* z, const uint32
 SRSLTE_API float srslte_vec_acc_ff(const float* x, const uint32_t len);
 SRSLTE_API cf_t srslte_vec_acc_cc(const cf_t* x, const uint32_t len);
 
+/* Buffers of at least threshold bytes are allocated on transparent 2 MB hugepages, their size rounded up to a
+ * multiple of 2 MB. A threshold of 0 disables hugepages. Set at start-up, before the buffers are allocated */
+SRSLTE_API void srslte_vec_set_hugepage_threshold(uint32_t threshold);
+
 SRSLTE_API void* srslte_vec_malloc(uint32_t size);
 SRSLTE_API cf_t*  srslte_vec_cf_malloc(uint32_t size);
 SRSLTE_API float* srslte_vec_f_malloc(uint32_t size);
@@ -139,6 +143,11 @@ SRSLTE_API void srslte_vec_convert_conj_cs(const cf_t* x, const float scale, int
 SRSLTE_API void srslte_vec_convert_if(const int16_t* x, const float scale, float* z, const uint32_t len);
 SRSLTE_API void srslte_vec_convert_fb(const float* x, const float scale, int8_t* z, const uint32_t len);
 
+/* Block floating point storage of complex samples as interleaved int16 (re, im) with a common scale, which halves the
+ * memory of the block. srslte_vec_convert_cf_cs() returns the scale srslte_vec_convert_cs_cf() needs to restore it */
+SRSLTE_API float srslte_vec_convert_cf_cs(const cf_t* x, int16_t* z, const uint32_t len);
+SRSLTE_API void  srslte_vec_convert_cs_cf(const int16_t* x, const float scale, cf_t* z, const uint32_t len);
+
 SRSLTE_API void srslte_vec_lut_sss(const short* x, const unsigned short* lut, short* y, const uint32_t len);
 SRSLTE_API void srslte_vec_lut_bbb(const int8_t* x, const unsigned short* lut, int8_t* y, const uint32_t len);
 SRSLTE_API void srslte_vec_lut_sis(const short* x, const unsigned int* lut, short* y, const uint32_t len);
@@ -159,6 +168,10 @@ SRSLTE_API void srslte_vec_prod_cfc(const cf_t* x, const float* y, cf_t* z, cons
 /* conjugate vector product (element-wise) */
 SRSLTE_API void srslte_vec_prod_conj_ccc(const cf_t* x, const cf_t* y, cf_t* z, const uint32_t len);
 
+/* z[i] = x[i * stride] * conj(y[i]), returns the energy of the strided samples of x (channel estimation) */
+SRSLTE_API float
+srslte_vec_prod_conj_stride_ccc(const cf_t* x, const uint32_t stride, const cf_t* y, cf_t* z, const uint32_t len);
+
 /* real vector product (element-wise) */
 SRSLTE_API void srslte_vec_prod_fff(const float* x, const float* y, float* z, const uint32_t len);
 SRSLTE_API void srslte_vec_prod_sss(const int16_t* x, const int16_t* y, int16_t* z, const uint32_t len);
@@ -281,12 +294,24 @@ SRSLTE_API void srslte_vec_interleave(const cf_t* x, const cf_t* y, cf_t* z, con
 
 SRSLTE_API void srslte_vec_interleave_add(const cf_t* x, const cf_t* y, cf_t* z, const int len);
 
+/* z[i] = x[idx[i]] */
+SRSLTE_API void srslte_vec_gather_cf(const cf_t* x, const uint32_t* idx, cf_t* z, const uint32_t len);
+
+/* z[idx[i]] = x[i], the indices shall not repeat */
+SRSLTE_API void srslte_vec_scatter_cf(const cf_t* x, const uint32_t* idx, cf_t* z, const uint32_t len);
+
 SRSLTE_API void srslte_vec_gen_sine(cf_t amplitude, float freq, cf_t* z, int len);
 
 SRSLTE_API void srslte_vec_apply_cfo(const cf_t* x, float cfo, cf_t* z, int len);
 
+/* Applies the same CFO to nof_ports vectors in one pass, sharing the rotating phasor */
+SRSLTE_API void srslte_vec_apply_cfo_multi(cf_t** x, float cfo, cf_t** z, int nof_ports, int len);
+
 SRSLTE_API float srslte_vec_estimate_frequency(const cf_t* x, int len);
 
+/* Instruction set used by the vector kernels; with ENABLE_SIMD_DISPATCH it is the one selected for the running CPU */
+SRSLTE_API const char* srslte_vec_simd_isa();
+
 #ifdef __cplusplus
 }
 #endif
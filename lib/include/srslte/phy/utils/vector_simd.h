@@ -88,6 +88,9 @@ SRSLTE_API void srslte_vec_prod_ccc_simd(const cf_t* x, const cf_t* y, cf_t* z,
 
 SRSLTE_API void srslte_vec_prod_conj_ccc_simd(const cf_t* x, const cf_t* y, cf_t* z, const int len);
 
+SRSLTE_API float
+srslte_vec_prod_conj_stride_ccc_simd(const cf_t* x, const int stride, const cf_t* y, cf_t* z, const int len);
+
 /* SIMD Division */
 SRSLTE_API void srslte_vec_div_ccc_simd(const cf_t* x, const cf_t* y, cf_t* z, const int len);
 
@@ -100,6 +103,8 @@ SRSLTE_API cf_t srslte_vec_dot_prod_conj_ccc_simd(const cf_t* x, const cf_t* y,
 
 SRSLTE_API cf_t srslte_vec_dot_prod_ccc_simd(const cf_t* x, const cf_t* y, const int len);
 
+SRSLTE_API cf_t srslte_vec_dot_prod_cfc_simd(const cf_t* x, const float* y, const int len);
+
 #ifdef ENABLE_C16
 SRSLTE_API c16_t srslte_vec_dot_prod_ccc_c16i_simd(const c16_t* x, const c16_t* y, const int len);
 #endif /* ENABLE_C16 */
@@ -128,10 +133,16 @@ SRSLTE_API void srslte_vec_interleave_simd(const cf_t* x, const cf_t* y, cf_t* z
 
 SRSLTE_API void srslte_vec_interleave_add_simd(const cf_t* x, const cf_t* y, cf_t* z, const int len);
 
+SRSLTE_API void srslte_vec_gather_cf_simd(const cf_t* x, const uint32_t* idx, cf_t* z, const int len);
+
+SRSLTE_API void srslte_vec_scatter_cf_simd(const cf_t* x, const uint32_t* idx, cf_t* z, const int len);
+
 SRSLTE_API void srslte_vec_gen_sine_simd(cf_t amplitude, float freq, cf_t* z, int len);
 
 SRSLTE_API void srslte_vec_apply_cfo_simd(const cf_t* x, float cfo, cf_t* z, int len);
 
+SRSLTE_API void srslte_vec_apply_cfo_multi_simd(cf_t** x, float cfo, cf_t** z, int nof_ports, int len);
+
 SRSLTE_API float srslte_vec_estimate_frequency_simd(const cf_t* x, int len);
 
 /* SIMD Find Max functions */
@@ -26,12 +26,16 @@
 #include "srslte/common/interfaces_common.h"
 #include "srslte/common/log_filter.h"
 #include "srslte/interfaces/radio_interfaces.h"
+#include "srslte/phy/resampling/resample_poly.h"
 #include "srslte/phy/resampling/resampler.h"
 #include "srslte/phy/rf/rf.h"
 #include "srslte/radio/radio_base.h"
 #include "srslte/srslte.h"
+#include <atomic>
+#include <condition_variable>
 #include <list>
 #include <string>
+#include <thread>
 
 #ifndef SRSLTE_RADIO_H
 #define SRSLTE_RADIO_H
@@ -66,6 +70,8 @@ public:
   void tx_end() override;
   bool tx(rf_buffer_interface& buffer, const rf_timestamp_interface& tx_time) override;
   bool rx_now(rf_buffer_interface& buffer, rf_timestamp_interface& rxd_time) override;
+  bool rx_now_s(int16_t* buffer[SRSLTE_MAX_CHANNELS], uint32_t nof_samples, rf_timestamp_interface& rxd_time) override;
+  bool has_rx_s() override;
 
   // setter
   void set_tx_freq(const uint32_t& carrier_idx, const double& freq) override;
@@ -104,13 +110,16 @@ private:
   srslte::logger*                                         logger      = nullptr;
   phy_interface_radio*                                    phy         = nullptr;
   cf_t*                                                   zeros       = nullptr;
-  std::array<cf_t*, SRSLTE_MAX_CHANNELS>                  dummy_buffers;
+  std::vector<std::array<cf_t*, SRSLTE_MAX_CHANNELS> >    dummy_buffers; ///< Per RF device
+  uint32_t                                                dummy_buffer_len = 0;
   std::mutex                                              tx_mutex;
   std::mutex                                              rx_mutex;
   std::array<std::vector<cf_t>, SRSLTE_MAX_CHANNELS>      tx_buffer;
   std::array<std::vector<cf_t>, SRSLTE_MAX_CHANNELS>      rx_buffer;
-  std::array<srslte_resampler_fft_t, SRSLTE_MAX_CHANNELS> interpolators = {};
-  std::array<srslte_resampler_fft_t, SRSLTE_MAX_CHANNELS> decimators    = {};
+  std::array<srslte_resampler_fft_t, SRSLTE_MAX_CHANNELS> interpolators      = {};
+  std::array<srslte_resampler_fft_t, SRSLTE_MAX_CHANNELS> decimators         = {};
+  std::array<srslte_resample_poly_t, SRSLTE_MAX_CHANNELS> poly_interpolators = {};
+  std::array<srslte_resample_poly_t, SRSLTE_MAX_CHANNELS> poly_decimators    = {};
 
   rf_timestamp_t end_of_burst_time  = {};
   bool           is_start_of_burst  = false;
@@ -125,11 +134,58 @@ private:
   double         cur_tx_srate       = 0.0;
   double         cur_rx_srate       = 0.0;
   double         fix_srate_hz       = 0.0;
+  float          srate_passband     = SRSLTE_RESAMPLE_POLY_DEFAULT_PASSBAND;
   uint32_t       nof_antennas       = 0;
   uint32_t       nof_channels       = 0;
   uint32_t       nof_channels_x_dev = 0;
   uint32_t       nof_carriers       = 0;
 
+  // Tx lead time statistics, the lead time is the time left until a burst is on air when it is handed to the driver
+  std::mutex          metrics_mutex;
+  std::atomic<double> rx_time_end    = {-1.0}; ///< End of the last reception in seconds, negative before any reception
+  double              tx_lead_sum_ms = 0.0;
+  uint32_t            tx_lead_count  = 0;
+  float               tx_lead_min_ms = INFINITY;
+
+  /**
+   * Asynchronous transmission queue. When enabled, tx() and tx_end() only copy the request into one of the
+   * pre-allocated slots and return. A dedicated thread resamples and hands the slots to the driver in order, dropping
+   * the bursts that would reach the radio late.
+   */
+  typedef struct {
+    std::array<std::vector<cf_t>, SRSLTE_MAX_CHANNELS> samples;
+    std::array<bool, SRSLTE_MAX_CHANNELS>              has_samples; ///< False for the channels given as nullptr
+    rf_timestamp_t                                     tx_time;
+    uint32_t                                           nof_samples;
+    bool                                               end_of_burst; ///< The slot is a tx_end() request
+  } tx_slot_t;
+  constexpr static uint32_t                 tx_async_nof_slots = 2;
+  std::array<tx_slot_t, tx_async_nof_slots> tx_slots           = {};
+  uint32_t                                  tx_slots_w         = 0; ///< Slots written by the producers
+  uint32_t                                  tx_slots_r         = 0; ///< Slots consumed by the Tx thread
+  std::mutex                                tx_async_mutex;
+  std::condition_variable                   tx_async_cvar;
+  std::thread                               tx_async_thread;
+  bool                                      tx_async           = false;
+  bool                                      tx_async_running   = false;
+  bool                                      tx_async_sob       = true; ///< Start of burst as seen by the producers
+
+  /**
+   * Per device reception. When enabled with several devices, rx_now() wakes one thread for each device but the first,
+   * receives from the first device itself and then joins the others. Every device writes straight into its own
+   * channels of the buffer, so nothing is copied, and the threads report their completion through atomic counters.
+   */
+  std::vector<std::thread>                               rx_dev_threads;
+  std::array<std::atomic<uint32_t>, SRSLTE_MAX_CHANNELS> rx_dev_done    = {}; ///< Last request completed by each thread
+  std::array<bool, SRSLTE_MAX_CHANNELS>                  rx_dev_ret     = {};
+  const rf_buffer_interface*                             rx_dev_buffer  = nullptr;
+  rf_timestamp_interface*                                rx_dev_time    = nullptr;
+  uint32_t                                               rx_dev_req     = 0; ///< Requests issued by rx_now()
+  std::atomic<bool>                                      rx_dev_running = {false};
+  bool                                                   rx_dev_aligned = false; ///< Streams aligned since they started
+  std::mutex                                             rx_dev_mutex;
+  std::condition_variable                                rx_dev_cvar;
+
   std::vector<double> cur_tx_freqs = {};
   std::vector<double> cur_rx_freqs = {};
 
@@ -180,6 +236,30 @@ private:
    */
   bool tx_dev(const uint32_t& device_idx, rf_buffer_interface& buffer, const srslte_timestamp_t& tx_time_);
 
+  /**
+   * Helper methods for transmitting from the calling thread, the caller is responsible for serialising them. tx_now()
+   * resamples the buffer in place.
+   */
+  bool tx_now(rf_buffer_interface& buffer, const rf_timestamp_interface& tx_time);
+  void tx_end_now();
+
+  /**
+   * Computes the lead time of a transmission and accumulates it into the metrics
+   * @param tx_time Timestamp to transmit
+   * @return the lead time in seconds, or INFINITY if nothing has been received yet
+   */
+  double tx_lead(const rf_timestamp_interface& tx_time);
+
+  /**
+   * Helper methods for the asynchronous transmission. tx_async_push() copies the buffer into the next free slot,
+   * waiting for one if all are in use, or enqueues an end of burst if buffer is nullptr. tx_async_flush() waits until
+   * the Tx thread has consumed every slot.
+   */
+  bool tx_async_push(const rf_buffer_interface* buffer, const rf_timestamp_interface& tx_time);
+  void tx_async_flush();
+  void tx_async_run();
+  void tx_async_stop();
+
   /**
    * Helper method for receiving over a single RF device. This function maps automatically the logical receive buffers
    * to the physical RF buffers for the given device.
@@ -187,9 +267,27 @@ private:
    * @param device_idx Device index
    * @param buffer Common receive buffers
    * @param rxd_time Points at the receive time (write only)
+   * @param int16 The buffer pointers hold interleaved int16 samples, received through srslte_rf_recv_with_time_multi_s()
    * @return it returns true if the reception was successful, otherwise it returns false
    */
-  bool rx_dev(const uint32_t& device_idx, const rf_buffer_interface& buffer, srslte_timestamp_t* rxd_time);
+  bool rx_dev(const uint32_t&            device_idx,
+              const rf_buffer_interface& buffer,
+              srslte_timestamp_t*        rxd_time,
+              bool                       int16 = false);
+
+  /**
+   * Helper method that starts the Rx streams of all devices on the first reception
+   */
+  void rx_start_streaming();
+
+  /**
+   * Helper methods for the per device reception. rx_dev_join() receives from all devices in parallel and, on the
+   * first call after the streams start, compensates the timestamp offset of every device with the first one.
+   */
+  bool rx_dev_join(const rf_buffer_interface& buffer, rf_timestamp_interface& rxd_time);
+  void rx_dev_align(const rf_timestamp_interface& rxd_time, uint32_t nof_samples);
+  void rx_dev_run(uint32_t device_idx);
+  void rx_dev_stop();
 
   /**
    * Helper method for mapping logical channels into physical radio buffers.
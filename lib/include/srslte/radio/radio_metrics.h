@@ -22,6 +22,8 @@
 #ifndef SRSLTE_RADIO_METRICS_H
 #define SRSLTE_RADIO_METRICS_H
 
+#include "srslte/phy/rf/rf.h"
+
 namespace srslte {
 
 typedef struct {
@@ -29,6 +31,12 @@ typedef struct {
   uint32_t rf_u;
   uint32_t rf_l;
   bool     rf_error;
+  uint32_t tx_late_drop;   ///< Bursts dropped by the asynchronous transmission because they would have been late
+  float    tx_lead_min_ms; ///< Minimum time left until a burst is on air when it is handed to the driver
+  float    tx_lead_avg_ms; ///< Average time left until a burst is on air when it is handed to the driver
+
+  // Telemetry of all the RF devices merged, the channels are numbered across devices. Zero if they do not provide it.
+  srslte_rf_metrics_t dev;
 } rf_metrics_t;
 
 } // namespace srslte
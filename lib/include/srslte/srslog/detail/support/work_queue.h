@@ -23,119 +23,237 @@
 #define SRSLOG_DETAIL_SUPPORT_WORK_QUEUE_H
 
 #include "srslte/srslog/detail/support/thread_utils.h"
-#include <queue>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
 
+/// Capacity of the queue of each producer thread. Must be a power of two.
 #ifndef SRSLOG_QUEUE_CAPACITY
-#define SRSLOG_QUEUE_CAPACITY 8192
+#define SRSLOG_QUEUE_CAPACITY 2048
 #endif
 
 namespace srslog {
 
 namespace detail {
 
-//:TODO: this is a temp work queue.
-
-/// Thread safe generic data type work queue.
+/// Thread safe generic data type work queue with many producers and a single
+/// consumer.
+/// Each producer thread pushes into its own lock-free ring, so producers never
+/// wait for each other or for the consumer. The consumer drains the rings in
+/// batches and only sleeps when all of them are empty, in which case the next
+/// push wakes it up. Elements of the same producer are popped in order, there
+/// is no ordering between producers. A full ring discards new elements.
 template <typename T, size_t capacity = SRSLOG_QUEUE_CAPACITY>
 class work_queue
 {
-  std::queue<T> queue;
-  mutable condition_variable cond_var;
+  static_assert((capacity & (capacity - 1)) == 0,
+                "The queue capacity must be a power of two");
+  static constexpr size_t mask = capacity - 1;
   static constexpr size_t threshold = capacity * 0.98;
 
+  /// Ring of a single producer thread. The ring of a thread that has exited
+  /// gets reused by a new thread once it has been drained.
+  struct ring {
+    ring() : slots(new T[capacity]) {}
+
+    size_t size() const
+    {
+      return tail.load(std::memory_order_acquire) -
+             head.load(std::memory_order_acquire);
+    }
+
+    std::unique_ptr<T[]> slots;
+    /// Written by the consumer.
+    std::atomic<size_t> head{0};
+    char pad[64];
+    /// Written by the producer.
+    std::atomic<size_t> tail{0};
+    /// False once the producer thread has exited.
+    std::atomic<bool> owned{true};
+  };
+
+  /// Rings used by the calling thread, one for each work queue it pushed to.
+  struct thread_rings {
+    ~thread_rings()
+    {
+      for (auto& r : rings) {
+        r.second->owned = false;
+      }
+    }
+    std::vector<std::pair<uint64_t, std::shared_ptr<ring>>> rings;
+  };
+
 public:
-  work_queue() = default;
+  work_queue() : id(next_queue_id()) {}
 
   work_queue(const work_queue&) = delete;
   work_queue& operator=(const work_queue&) = delete;
 
   /// Inserts a new element into the back of the queue.
-  void push(const T& value)
-  {
-    cond_var.lock();
-    // Discard the new element if we reach the maximum capacity.
-    if (queue.size() > capacity) {
-      cond_var.unlock();
-      return;
-    }
-    queue.push(value);
-    cond_var.signal();
-    cond_var.unlock();
-  }
+  void push(const T& value) { push(T(value)); }
 
   /// Inserts a new element into the back of the queue.
   void push(T&& value)
   {
-    cond_var.lock();
+    ring& r = get_thread_ring();
+    size_t tail = r.tail.load(std::memory_order_relaxed);
     // Discard the new element if we reach the maximum capacity.
-    if (queue.size() > capacity) {
-      cond_var.unlock();
+    if (tail - r.head.load(std::memory_order_acquire) >= capacity) {
       return;
     }
-    queue.push(std::move(value));
-    cond_var.signal();
-    cond_var.unlock();
+    r.slots[tail & mask] = std::move(value);
+    r.tail.store(tail + 1, std::memory_order_release);
+
+    // Pairs with the fence of the consumer before it goes to sleep: either it
+    // sees the new element or we see that it is sleeping.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumer_sleeping.load(std::memory_order_relaxed)) {
+      cond_var_scoped_lock lock(cond_var);
+      cond_var.signal();
+    }
   }
 
-  /// Extracts the top most element from the queue.
-  /// NOTE: This method blocks while the queue is empty.
-  T pop()
+  /// Moves up to max_items elements into the back of items, taking them in
+  /// turns from each producer. Returns the number of extracted elements.
+  /// NOTE: only the consumer thread may call this method.
+  size_t pop_batch(std::vector<T>& items, size_t max_items)
   {
-    cond_var.lock();
+    refresh_consumer_rings();
 
-    while (queue.empty()) {
-      cond_var.wait();
+    size_t count = 0;
+    for (size_t i = 0, e = consumer_rings.size(); i != e && count < max_items;
+         ++i) {
+      ring& r = *consumer_rings[(next_ring + i) % e];
+      size_t head = r.head.load(std::memory_order_relaxed);
+      size_t tail = r.tail.load(std::memory_order_acquire);
+      for (; head != tail && count < max_items; ++head, ++count) {
+        items.push_back(std::move(r.slots[head & mask]));
+      }
+      r.head.store(head, std::memory_order_release);
     }
+    ++next_ring;
 
-    T elem = std::move(queue.front());
-    queue.pop();
-
-    cond_var.unlock();
-
-    return elem;
+    return count;
   }
 
-  /// Extracts the top most element from the queue.
-  /// NOTE: This method blocks while the queue is empty or or until the
-  /// programmed timeout expires. Returns a pair with a bool indicating if the
-  /// pop has been successful.
-  std::pair<bool, T> timed_pop(unsigned timeout_ms)
+  /// Moves up to max_items elements into the back of items.
+  /// NOTE: This method blocks while the queue is empty or until the programmed
+  /// timeout expires. Returns the number of extracted elements.
+  /// NOTE: only the consumer thread may call this method.
+  size_t
+  timed_pop_batch(std::vector<T>& items, size_t max_items, unsigned timeout_ms)
   {
+    if (size_t count = pop_batch(items, max_items)) {
+      return count;
+    }
+
     // Build an absolute time reference for the expiration time.
     timespec ts = condition_variable::build_timeout(timeout_ms);
 
     cond_var.lock();
-
+    consumer_sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
     bool timedout = false;
-    while (queue.empty() && !timedout) {
+    while (!has_pending() && !timedout) {
       timedout = cond_var.wait(ts);
     }
-
-    // Did we wake up on timeout?
-    if (timedout && queue.empty()) {
-      cond_var.unlock();
-      return {false, T{}};
-    }
-
-    // Here we have been woken up normally.
-    T Item = std::move(queue.front());
-    queue.pop();
-
+    consumer_sleeping.store(false, std::memory_order_relaxed);
     cond_var.unlock();
 
-    return {true, std::move(Item)};
+    return pop_batch(items, max_items);
   }
 
-  /// Capacity of the queue.
+  /// Capacity of the queue of each producer thread.
   size_t get_capacity() const { return capacity; }
 
-  /// Returns true when the queue is almost full, otherwise returns false.
+  /// Returns true when the queue of a producer is almost full, otherwise
+  /// returns false.
+  /// NOTE: only the consumer thread may call this method.
   bool is_almost_full() const
   {
-    cond_var_scoped_lock lock(cond_var);
+    for (const auto& r : consumer_rings) {
+      if (r->size() > threshold) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  static uint64_t next_queue_id()
+  {
+    static std::atomic<uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// Returns the ring of the calling thread, creating or reusing one the first
+  /// time the thread pushes to this queue.
+  ring& get_thread_ring()
+  {
+    static thread_local thread_rings local;
+    for (const auto& r : local.rings) {
+      if (r.first == id) {
+        return *r.second;
+      }
+    }
+
+    std::shared_ptr<ring> r;
+    {
+      scoped_lock lock(rings_mutex);
+      for (const auto& old_ring : rings) {
+        if (!old_ring->owned && old_ring->size() == 0) {
+          old_ring->owned = true;
+          r = old_ring;
+          break;
+        }
+      }
+      if (!r) {
+        r = std::make_shared<ring>();
+        rings.push_back(r);
+        rings_version.fetch_add(1, std::memory_order_release);
+      }
+    }
+    local.rings.emplace_back(id, r);
+
+    return *r;
+  }
+
+  /// Updates the consumer copy of the ring list when a ring has been added.
+  void refresh_consumer_rings()
+  {
+    size_t version = rings_version.load(std::memory_order_acquire);
+    if (version == consumer_version) {
+      return;
+    }
+    scoped_lock lock(rings_mutex);
+    consumer_rings = rings;
+    consumer_version = rings_version.load(std::memory_order_relaxed);
+  }
 
-    return queue.size() > threshold;
+  bool has_pending()
+  {
+    refresh_consumer_rings();
+    for (const auto& r : consumer_rings) {
+      if (r->size() != 0) {
+        return true;
+      }
+    }
+    return false;
   }
+
+private:
+  const uint64_t id;
+  mutex rings_mutex;
+  std::vector<std::shared_ptr<ring>> rings;
+  std::atomic<size_t> rings_version{0};
+  std::atomic<bool> consumer_sleeping{false};
+  mutable condition_variable cond_var;
+
+  // Only accessed by the consumer.
+  std::vector<std::shared_ptr<ring>> consumer_rings;
+  size_t consumer_version = 0;
+  size_t next_ring = 0;
 };
 
 } // namespace detail
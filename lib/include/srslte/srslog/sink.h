@@ -22,6 +22,7 @@
 #ifndef SRSLOG_SINK_H
 #define SRSLOG_SINK_H
 
+#include "srslte/srslog/detail/log_entry.h"
 #include "srslte/srslog/detail/support/error_string.h"
 #include "srslte/srslog/detail/support/memory_buffer.h"
 
@@ -39,6 +40,15 @@ public:
 
   /// Flushes any buffered contents to the backing store.
   virtual detail::error_string flush() = 0;
+
+  /// Sinks that do not store text encode the log entry themselves, appending
+  /// it to the buffer that is later passed to write(). Returns false when the
+  /// entry should be formatted as text.
+  virtual bool encode(const detail::log_entry& entry,
+                      fmt::memory_buffer& buffer)
+  {
+    return false;
+  }
 };
 
 } // namespace srslog
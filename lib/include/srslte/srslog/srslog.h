@@ -171,6 +171,13 @@ sink& fetch_stderr_sink();
 /// NOTE: Any '#' characters in the id will get removed.
 sink& fetch_file_sink(const std::string& path, size_t max_size = 0);
 
+/// Returns an instance of a sink that writes into a file in the specified path
+/// in the srslog binary format, which is much cheaper to write than text. The
+/// srslog_decoder tool converts these files to text. The max_size value works
+/// as in the text file sink.
+/// NOTE: Any '#' characters in the id will get removed.
+sink& fetch_binary_file_sink(const std::string& path, size_t max_size = 0);
+
 /// Creates a new sink that writes into the a file in the specified path and
 /// registers it into a sink repository so that it can be later retrieved in
 /// other parts of the application. Returns a pointer to the newly created sink
@@ -38,9 +38,11 @@ extern "C" {
 #include "srslte/phy/utils/cexptab.h"
 #include "srslte/phy/utils/convolution.h"
 #include "srslte/phy/utils/debug.h"
+#include "srslte/phy/utils/mem_accounting.h"
 #include "srslte/phy/utils/ringbuffer.h"
 #include "srslte/phy/utils/vector.h"
 
+#include "srslte/phy/common/grid_c16.h"
 #include "srslte/phy/common/phy_common.h"
 #include "srslte/phy/common/sequence.h"
 #include "srslte/phy/common/timestamp.h"
@@ -55,6 +57,7 @@ extern "C" {
 #include "srslte/phy/resampling/decim.h"
 #include "srslte/phy/resampling/interp.h"
 #include "srslte/phy/resampling/resample_arb.h"
+#include "srslte/phy/resampling/resample_poly.h"
 
 #include "srslte/phy/channel/ch_awgn.h"
 
@@ -32,7 +32,11 @@
 
 #include "srslte/common/block_queue.h"
 #include "srslte/common/common.h"
+#include "srslte/common/latency_histogram.h"
+#include "srslte/common/metrics_counter.h"
+#include "srslte/upper/rlc_aqm.h"
 #include <pthread.h>
+#include <vector>
 
 namespace srslte {
 
@@ -41,7 +45,16 @@ class byte_buffer_queue : public block_queue<unique_byte_buffer_t>::call_mutexed
 public:
   byte_buffer_queue(int capacity = 128) : queue(capacity) { queue.set_mutexed_itf(this); }
   // increase/decrease unread_bytes inside push/pop mutexed operations
-  void pushing(const unique_byte_buffer_t& msg) final { unread_bytes += msg->N_bytes; }
+  void pushing(const unique_byte_buffer_t& msg) final
+  {
+    unread_bytes += msg->N_bytes;
+    if (sojourn_delay != nullptr or aqm != nullptr) {
+      msg->md.enqueue_ns = latency_clock_ns();
+      if (upper_delay != nullptr) {
+        upper_delay->observe_interval(msg->md.rx_ns, msg->md.enqueue_ns);
+      }
+    }
+  }
   void popping(const unique_byte_buffer_t& msg) final
   {
     if (unread_bytes > msg->N_bytes) {
@@ -49,6 +62,24 @@ public:
     } else {
       unread_bytes = 0;
     }
+    if (sojourn_delay != nullptr) {
+      sojourn_delay->observe_interval(msg->md.enqueue_ns, latency_clock_ns());
+    }
+  }
+
+  /// Stamps the messages with their enqueue time and counts their time in the queue in sojourn_delay_. The time from
+  /// the entry of the messages into the stack until they are queued is counted in upper_delay_, when given
+  void set_delay_histograms(latency_histogram* sojourn_delay_, latency_histogram* upper_delay_ = nullptr)
+  {
+    sojourn_delay = sojourn_delay_;
+    upper_delay   = upper_delay_;
+  }
+  /// Lets aqm_ drop messages at the head of the queue when they are read, counting them in drops_. Pass nullptr to
+  /// disable it
+  void set_aqm(rlc_aqm* aqm_, metrics_counter<uint32_t>* drops_)
+  {
+    aqm   = aqm_;
+    drops = drops_;
   }
   void write(unique_byte_buffer_t msg) { queue.push(std::move(msg)); }
 
@@ -57,9 +88,51 @@ public:
     return queue.try_push(std::move(msg));
   }
 
-  unique_byte_buffer_t read() { return queue.wait_pop(); }
+  /// Writes the messages in order until the queue is full, taking the lock once. Returns the number of messages
+  /// written, which are moved out of msgs
+  uint32_t try_write_many(std::vector<unique_byte_buffer_t>& msgs)
+  {
+    return queue.try_push_many(msgs.begin(), msgs.end()) - msgs.begin();
+  }
 
-  bool try_read(unique_byte_buffer_t* msg) { return queue.try_pop(msg); }
+  unique_byte_buffer_t read()
+  {
+    unique_byte_buffer_t msg = queue.wait_pop();
+    while (not queue.empty() and aqm_drops(msg)) {
+      msg = queue.wait_pop();
+    }
+    return msg;
+  }
+
+  /// Passes the messages to f, in order and taking the lock once, for as long as f returns true. The messages dropped
+  /// by the AQM are not passed to f but are included in the returned count
+  template <typename F>
+  uint32_t read_while(F&& f)
+  {
+    if (aqm == nullptr) {
+      return queue.try_pop_while(std::forward<F>(f));
+    }
+    // unread_bytes instead of the queue size, as the lock is already taken
+    return queue.try_pop_while([this, &f](unique_byte_buffer_t msg) {
+      if (unread_bytes > 0 and aqm_drops(msg)) {
+        return true;
+      }
+      return f(std::move(msg));
+    });
+  }
+
+  bool try_read(unique_byte_buffer_t* msg)
+  {
+    if (not queue.try_pop(msg)) {
+      return false;
+    }
+    while (not queue.empty() and aqm_drops(*msg)) {
+      if (not queue.try_pop(msg)) {
+        return false;
+      }
+    }
+    return true;
+  }
 
   void     resize(uint32_t capacity) { queue.resize(capacity); }
   uint32_t size() { return (uint32_t)queue.size(); }
@@ -85,8 +158,23 @@ public:
   bool is_full() { return queue.full(); }
 
 private:
+  bool aqm_drops(const unique_byte_buffer_t& msg)
+  {
+    if (aqm == nullptr or not aqm->drop_head(msg->md.enqueue_ns, latency_clock_ns(), unread_bytes)) {
+      return false;
+    }
+    if (drops != nullptr) {
+      ++(*drops);
+    }
+    return true;
+  }
+
   block_queue<unique_byte_buffer_t> queue;
-  uint32_t                          unread_bytes = 0;
+  uint32_t                          unread_bytes  = 0;
+  latency_histogram*                sojourn_delay = nullptr;
+  latency_histogram*                upper_delay   = nullptr;
+  rlc_aqm*                          aqm           = nullptr;
+  metrics_counter<uint32_t>*        drops         = nullptr;
 };
 
 } // namespace srslte
@@ -38,6 +38,9 @@ public:
   void init(srsue::rlc_interface_pdcp* rlc_, srsue::rrc_interface_pdcp* rrc_, srsue::gw_interface_pdcp* gw_);
   void stop();
 
+  // Cipher the DRB PDUs in the background task pool of the task scheduler, see pdcp_entity_lte
+  void set_crypto_offload(bool enable);
+
   // GW interface
   bool is_lcid_enabled(uint32_t lcid);
 
@@ -72,6 +75,7 @@ private:
   srsue::gw_interface_pdcp*  gw  = nullptr;
   srslte::task_sched_handle  task_sched;
   srslte::log_ref            pdcp_log;
+  bool                       crypto_offload = false;
 
   std::map<uint16_t, std::unique_ptr<pdcp_entity_base> > pdcp_array, pdcp_array_mrb;
 
@@ -54,6 +54,40 @@ typedef enum {
 } pdcp_d_c_t;
 static const char pdcp_d_c_text[PDCP_D_C_N_ITEMS][20] = {"Control PDU", "Data PDU"};
 
+/****************************************************************************
+ * Header compression
+ * Ref: 3GPP TS 36.323 section 5.5 and RFC 3095
+ ***************************************************************************/
+
+/**
+ * Header compression stage of a DRB
+ *
+ * The compressor takes the SDUs before the PDCP header is added, and the decompressor the received SDUs after
+ * deciphering, in the order they are delivered to upper layers. Both work in place. The stage may be native, see
+ * make_rohc_compressor(), or wrap an external ROHC library, and is handed to the entity with set_hdr_compressor().
+ */
+class pdcp_hdr_compressor
+{
+public:
+  virtual ~pdcp_hdr_compressor() = default;
+
+  /// Returns false if the SDU could not be compressed and has to be dropped
+  virtual bool compress(byte_buffer_t* sdu) = 0;
+
+  /// Returns false if the packet could not be decompressed and has to be dropped
+  virtual bool decompress(byte_buffer_t* pdu) = 0;
+
+  /// Interspersed ROHC feedback received from the peer decompressor
+  virtual void handle_feedback(const uint8_t* feedback, uint32_t len) {}
+
+  /// Restarts the compressor in IR state and clears the decompressor context, on PDCP re-establishment
+  virtual void reset() = 0;
+};
+
+/// Returns the native ROHC compressor for the configuration of a bearer, or nullptr if ROHC is not enabled.
+/// The native compressor only implements the uncompressed profile 0x0000, whatever other profiles are configured
+std::unique_ptr<pdcp_hdr_compressor> make_rohc_compressor(const pdcp_rohc_config_t& cfg);
+
 /****************************************************************************
  * PDCP Entity interface
  * Common interface for LTE and NR PDCP entities
@@ -115,6 +149,12 @@ public:
 
   void config_security(as_security_config_t sec_cfg_);
 
+  // Cipher TX DRB PDUs in the background task pool of the task scheduler. Only used by LTE entities
+  void set_crypto_offload(bool enable) { crypto_offload = enable; }
+
+  // Replaces the header compression stage of a DRB, e.g. with one backed by an external ROHC library
+  void set_hdr_compressor(std::unique_ptr<pdcp_hdr_compressor> compressor) { hdr_compressor = std::move(compressor); }
+
   // GW/SDAP/RRC interface
   virtual void write_sdu(unique_byte_buffer_t sdu) = 0;
 
@@ -151,6 +191,26 @@ protected:
 
   srslte::as_security_config_t sec_cfg = {};
 
+  // Expanded 128-EEA2/EIA2 keys, set on first use after each key change
+  srslte::security_aes128_key aes_enc_key;
+  srslte::security_aes128_key aes_int_key;
+
+  // TX ciphering configuration, rebuilt when the keys change so that PDUs already handed to another thread keep
+  // the one they were submitted with
+  struct tx_cipher_ctx_t {
+    CIPHERING_ALGORITHM_ID_ENUM algo;
+    as_key_t                    k_enc;
+    security_aes128_key         aes_key;
+    uint8_t                     bearer;
+    uint8_t                     direction;
+
+    void cipher_in_place(uint8_t* msg, uint32_t msg_len, uint32_t count) const;
+  };
+  std::shared_ptr<const tx_cipher_ctx_t> tx_cipher_ctx;
+  bool                                   crypto_offload = false;
+
+  std::unique_ptr<pdcp_hdr_compressor> hdr_compressor;
+
   // Security functions
   void integrity_generate(uint8_t* msg, uint32_t msg_len, uint32_t count, uint8_t* mac);
   bool integrity_verify(uint8_t* msg, uint32_t msg_len, uint32_t count, uint8_t* mac);
@@ -164,6 +224,12 @@ protected:
   void     write_data_header(const srslte::unique_byte_buffer_t& sdu, uint32_t count);
   void     extract_mac(const unique_byte_buffer_t& pdu, uint8_t* mac);
   void     append_mac(const unique_byte_buffer_t& sdu, uint8_t* mac);
+
+  // Header compression functions. They return false if the packet has to be dropped
+  void init_hdr_compressor(const pdcp_rohc_config_t& rohc_cfg);
+  bool compress_header(const unique_byte_buffer_t& sdu);
+  bool decompress_header(const unique_byte_buffer_t& pdu);
+  void handle_rohc_feedback(const unique_byte_buffer_t& pdu);
 };
 
 inline uint32_t pdcp_entity_base::HFN(uint32_t count)
@@ -29,6 +29,7 @@
 #include "srslte/common/threads.h"
 #include "srslte/interfaces/ue_interfaces.h"
 #include "srslte/upper/pdcp_entity_base.h"
+#include <map>
 
 namespace srslte {
 
@@ -83,6 +84,20 @@ private:
   void handle_srb_pdu(srslte::unique_byte_buffer_t pdu);
   void handle_um_drb_pdu(srslte::unique_byte_buffer_t pdu);
   void handle_am_drb_pdu(srslte::unique_byte_buffer_t pdu);
+
+  // DRB PDUs ciphered in the background task pool. They are written to RLC in the order they were submitted
+  struct tx_crypto_queue_t {
+    pdcp_entity_lte*                                                entity   = nullptr;
+    uint32_t                                                        next_idx = 0;
+    uint32_t                                                        next_tx  = 0;
+    std::map<uint32_t, std::pair<uint32_t, unique_byte_buffer_t> > done; ///< Index -> (SN, PDU)
+  };
+  const static uint32_t              max_crypto_jobs = 1024;
+  std::shared_ptr<tx_crypto_queue_t> tx_crypto;
+
+  void submit_crypto_job(unique_byte_buffer_t pdu, uint32_t tx_count, bool do_encryption);
+  void tx_crypto_done(uint32_t idx, uint32_t sn, unique_byte_buffer_t pdu);
+  void log_tx_pdu(const unique_byte_buffer_t& pdu, uint32_t sn);
 };
 
 } // namespace srslte
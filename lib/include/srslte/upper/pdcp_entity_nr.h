@@ -31,10 +31,97 @@
 #include "srslte/common/task_scheduler.h"
 #include "srslte/common/threads.h"
 #include "srslte/interfaces/ue_interfaces.h"
+#include <algorithm>
 #include <map>
+#include <vector>
 
 namespace srslte {
 
+/**
+ * Reception buffer of the PDCP NR entity, indexed by COUNT
+ *
+ * The stored COUNTs are always within a reordering window of RX_DELIV, so the COUNT modulo the buffer size selects
+ * the slot without collisions. A bitmap tells which slots hold a PDU, so that the run of consecutive PDUs that can be
+ * delivered, or the next stored PDU, are found a word at a time.
+ */
+class pdcp_nr_rx_buffer
+{
+public:
+  /// Sizes the buffer for window_size COUNTs, which has to be a power of two
+  void init(uint32_t window_size)
+  {
+    mask = std::max(window_size, 64u) - 1;
+    pdus.clear();
+    pdus.resize(mask + 1);
+    active.assign((mask + 1) / 64, 0);
+    count = 0;
+  }
+
+  bool has(uint32_t rx_count) const { return (active[idx(rx_count) / 64] & bit(idx(rx_count))) != 0; }
+
+  void add(uint32_t rx_count, unique_byte_buffer_t pdu)
+  {
+    uint32_t i = idx(rx_count);
+    if (not has(rx_count)) {
+      active[i / 64] |= bit(i);
+      count++;
+    }
+    pdus[i] = std::move(pdu);
+  }
+
+  /// Removes and returns the PDU of rx_count, see has()
+  unique_byte_buffer_t take(uint32_t rx_count)
+  {
+    uint32_t i = idx(rx_count);
+    active[i / 64] &= ~bit(i);
+    count--;
+    return std::move(pdus[i]);
+  }
+
+  /// Returns the number of consecutive COUNTs stored from rx_count onwards
+  uint32_t run_length(uint32_t rx_count) const
+  {
+    uint32_t n = 0;
+    while (n <= mask) {
+      uint32_t i     = idx(rx_count + n);
+      uint32_t avail = 64 - i % 64;
+      uint64_t holes = ~(active[i / 64] >> (i % 64));
+      if (holes != 0 and (uint32_t)__builtin_ctzll(holes) < avail) {
+        return n + __builtin_ctzll(holes);
+      }
+      n += avail;
+    }
+    return mask + 1;
+  }
+
+  /// Returns the first stored COUNT in [rx_count, end), or end if there is none
+  uint32_t next_stored(uint32_t rx_count, uint32_t end) const
+  {
+    while (rx_count != end) {
+      uint32_t i     = idx(rx_count);
+      uint32_t avail = std::min(64 - i % 64, end - rx_count);
+      uint64_t bits  = active[i / 64] >> (i % 64);
+      if (bits != 0 and (uint32_t)__builtin_ctzll(bits) < avail) {
+        return rx_count + __builtin_ctzll(bits);
+      }
+      rx_count += avail;
+    }
+    return end;
+  }
+
+  size_t size() const { return count; }
+  bool   empty() const { return count == 0; }
+
+private:
+  uint32_t        idx(uint32_t rx_count) const { return rx_count & mask; }
+  static uint64_t bit(uint32_t i) { return 1ULL << (i % 64); }
+
+  std::vector<unique_byte_buffer_t> pdus;
+  std::vector<uint64_t>             active;
+  uint32_t                          mask  = 0;
+  size_t                            count = 0;
+};
+
 /****************************************************************************
  * NR PDCP Entity
  * PDCP entity for 5G NR
@@ -86,8 +173,8 @@ private:
   uint32_t window_size = 0;
 
   // Reordering Queue / Timers
-  std::map<uint32_t, unique_byte_buffer_t> reorder_queue;
-  timer_handler::unique_timer              reordering_timer;
+  pdcp_nr_rx_buffer           reorder_queue;
+  timer_handler::unique_timer reordering_timer;
 
   // Pass to Upper Layers Helper function
   void deliver_all_consecutive_counts();
@@ -143,7 +230,7 @@ inline void pdcp_entity_nr::pass_to_upper_layers(unique_byte_buffer_t sdu)
 {
   if (is_srb()) {
     rrc->write_pdu(lcid, std::move(sdu));
-  } else {
+  } else if (decompress_header(sdu)) {
     gw->write_pdu(lcid, std::move(sdu));
   }
 }
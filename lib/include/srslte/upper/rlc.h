@@ -57,6 +57,7 @@ public:
 
   // PDCP interface
   void write_sdu(uint32_t lcid, unique_byte_buffer_t sdu);
+  void write_sdus(uint32_t lcid, std::vector<unique_byte_buffer_t>& sdus);
   void write_sdu_mch(uint32_t lcid, unique_byte_buffer_t sdu);
   bool rb_is_um(uint32_t lcid);
   void discard_sdu(uint32_t lcid, uint32_t discard_sn);
@@ -70,6 +71,7 @@ public:
   int      read_pdu_mch(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes);
   int      get_increment_sequence_num();
   void     write_pdu(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes);
+  void     write_pdu(uint32_t lcid, srslte::unique_byte_buffer_t pdu);
   void     write_pdu_bcch_bch(srslte::unique_byte_buffer_t pdu);
   void     write_pdu_bcch_dlsch(uint8_t* payload, uint32_t nof_bytes);
   void     write_pdu_pcch(srslte::unique_byte_buffer_t pdu);
@@ -22,6 +22,7 @@
 #ifndef SRSLTE_RLC_AM_LTE_H
 #define SRSLTE_RLC_AM_LTE_H
 
+#include "srslte/adt/circular_array.h"
 #include "srslte/common/buffer_pool.h"
 #include "srslte/common/common.h"
 #include "srslte/common/log.h"
@@ -32,7 +33,8 @@
 #include "srslte/upper/rlc_common.h"
 #include <deque>
 #include <list>
-#include <map>
+#include <memory>
+#include <vector>
 
 namespace srslte {
 
@@ -54,6 +56,118 @@ struct rlc_amd_tx_pdu_t {
   bool                 is_acked;
 };
 
+/**
+ * Window of PDUs indexed by SN, with a slot for each of the RLC_AM_WINDOW_SIZE SNs of the window
+ *
+ * The window state variables keep the SNs held at the same time within RLC_AM_WINDOW_SIZE of each other, so the SN
+ * modulo the window size selects the slot without collisions. A bitmap tells which slots hold a PDU, so finding a PDU
+ * does not search, and the status PDU is built by scanning the bitmap a word at a time.
+ *
+ * The PDUs carry the AMD header with its full array of LIs, so the slots only point to them. A PDU is allocated when
+ * its SN is first added and goes back to a free list when removed, to be reused by later SNs. The bearer thus holds
+ * as many PDUs as were ever in the window at the same time, without allocating in the steady state, and clear()
+ * releases them all.
+ */
+template <class T>
+class rlc_ringbuffer_t
+{
+public:
+  /// Returns the slot of sn, replacing the PDU it held if any
+  T& add_pdu(uint32_t sn)
+  {
+    uint32_t idx = sn % RLC_AM_WINDOW_SIZE;
+    if (test(idx)) {
+      *window[idx] = T();
+    } else {
+      if (free_pdus.empty()) {
+        window[idx].reset(new T());
+      } else {
+        window[idx] = std::move(free_pdus.back());
+        free_pdus.pop_back();
+      }
+      active[idx / 64] |= bit(idx);
+      count++;
+    }
+    sns[idx] = sn;
+    return *window[idx];
+  }
+
+  void remove_pdu(uint32_t sn)
+  {
+    if (has_sn(sn)) {
+      uint32_t idx = sn % RLC_AM_WINDOW_SIZE;
+      *window[idx] = T();
+      free_pdus.push_back(std::move(window[idx]));
+      active[idx / 64] &= ~bit(idx);
+      count--;
+    }
+  }
+
+  /// The window must hold sn, see has_sn()
+  T&       operator[](uint32_t sn) { return *window[sn]; }
+  const T& operator[](uint32_t sn) const { return *window[sn]; }
+
+  bool has_sn(uint32_t sn) const
+  {
+    uint32_t idx = sn % RLC_AM_WINDOW_SIZE;
+    return test(idx) and sns[idx] == sn;
+  }
+
+  /// Returns which of the 64 SNs from sn onwards hold a PDU, bit i standing for sn + i. Unlike has_sn(), it does not
+  /// check the SN stored in each slot, so the SNs must be within the window span
+  uint64_t occupancy(uint32_t sn) const
+  {
+    uint32_t idx   = sn % RLC_AM_WINDOW_SIZE;
+    uint32_t w     = idx / 64;
+    uint32_t shift = idx % 64;
+    uint64_t ret   = active[w] >> shift;
+    if (shift > 0) {
+      ret |= active[(w + 1) % nof_words] << (64 - shift);
+    }
+    return ret;
+  }
+
+  size_t size() const { return count; }
+  bool   empty() const { return count == 0; }
+
+  void clear()
+  {
+    for (std::unique_ptr<T>& pdu : window) {
+      pdu.reset();
+    }
+    free_pdus.clear();
+    free_pdus.shrink_to_fit();
+    for (uint64_t& w : active) {
+      w = 0;
+    }
+    count = 0;
+  }
+
+  /// Calls f(sn, pdu) for every PDU in the window, in slot order
+  template <typename F>
+  void for_each(F&& f)
+  {
+    for (uint32_t w = 0; w < nof_words; w++) {
+      for (uint64_t bits = active[w]; bits != 0; bits &= bits - 1) {
+        uint32_t idx = w * 64 + __builtin_ctzll(bits);
+        f(sns[idx], *window[idx]);
+      }
+    }
+  }
+
+private:
+  static const uint32_t nof_words = RLC_AM_WINDOW_SIZE / 64;
+
+  static uint64_t bit(uint32_t idx) { return 1ULL << (idx % 64); }
+  bool            test(uint32_t idx) const { return (active[idx / 64] & bit(idx)) != 0; }
+
+  circular_array<std::unique_ptr<T>, RLC_AM_WINDOW_SIZE> window;
+  circular_array<uint32_t, RLC_AM_WINDOW_SIZE>           sns;
+  std::vector<std::unique_ptr<T> >                       free_pdus;
+  uint64_t                                               active[nof_words] = {};
+  size_t                                                 count             = 0;
+};
+
 struct rlc_amd_retx_t {
   uint32_t sn;
   bool     is_segment;
@@ -88,8 +202,10 @@ public:
   uint32_t get_buffer_state();
   int      read_pdu(uint8_t* payload, uint32_t nof_bytes);
   void     write_pdu(uint8_t* payload, uint32_t nof_bytes);
+  void     write_pdu(unique_byte_buffer_t pdu) override;
 
   rlc_bearer_metrics_t get_metrics();
+  rlc_bearer_metrics_t get_and_reset_metrics();
   void                 reset_metrics();
 
   void set_bsr_callback(bsr_callback_t callback);
@@ -154,8 +270,9 @@ private:
     rlc_am_config_t cfg = {};
 
     // TX SDU buffers
-    byte_buffer_queue    tx_sdu_queue;
-    unique_byte_buffer_t tx_sdu;
+    byte_buffer_queue        tx_sdu_queue;
+    unique_byte_buffer_t     tx_sdu;
+    std::unique_ptr<rlc_aqm> aqm;
 
     bool tx_enabled = false;
 
@@ -188,8 +305,8 @@ private:
     bsr_callback_t bsr_callback;
 
     // Tx windows
-    std::map<uint32_t, rlc_amd_tx_pdu_t> tx_window;
-    std::deque<rlc_amd_retx_t>           retx_queue;
+    rlc_ringbuffer_t<rlc_amd_tx_pdu_t> tx_window;
+    std::deque<rlc_amd_retx_t>         retx_queue;
 
     // Mutexes
     pthread_mutex_t mutex;
@@ -210,6 +327,8 @@ private:
     void stop();
 
     void write_pdu(uint8_t* payload, uint32_t nof_bytes);
+    // Data PDUs that are not segments keep the buffer in the Rx window instead of a copy
+    void write_pdu(unique_byte_buffer_t pdu);
 
     uint32_t get_num_rx_bytes();
     void     reset_metrics();
@@ -224,7 +343,11 @@ private:
     void reset_status(); // called when status PDU has been sent
 
   private:
-    void handle_data_pdu(uint8_t* payload, uint32_t nof_bytes, rlc_amd_pdu_header_t& header);
+    void write_pdu(uint8_t* payload, uint32_t nof_bytes, unique_byte_buffer_t pdu);
+    void handle_data_pdu(uint8_t*              payload,
+                         uint32_t              nof_bytes,
+                         rlc_amd_pdu_header_t& header,
+                         unique_byte_buffer_t  pdu = nullptr);
     void handle_data_pdu_segment(uint8_t* payload, uint32_t nof_bytes, rlc_amd_pdu_header_t& header);
     void reassemble_rx_sdus();
     bool inside_rx_window(const int16_t sn);
@@ -261,8 +384,8 @@ private:
     pthread_mutex_t mutex;
 
     // Rx windows
-    std::map<uint32_t, rlc_amd_rx_pdu_t>          rx_window;
-    std::map<uint32_t, rlc_amd_rx_pdu_segments_t> rx_segments;
+    rlc_ringbuffer_t<rlc_amd_rx_pdu_t>          rx_window;
+    rlc_ringbuffer_t<rlc_amd_rx_pdu_segments_t> rx_segments;
 
     // Metrics
     uint32_t num_rx_bytes = 0;
@@ -293,7 +416,7 @@ private:
   rlc_am_lte_tx tx;
   rlc_am_lte_rx rx;
 
-  rlc_bearer_metrics_t metrics = {};
+  rlc_bearer_metrics_counters metrics;
 };
 
 /****************************************************************************
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_RLC_AQM_H
+#define SRSLTE_RLC_AQM_H
+
+#include "srslte/interfaces/rlc_interface_types.h"
+#include <random>
+#include <stdint.h>
+
+namespace srslte {
+
+/**
+ * Active queue management of the RLC Tx SDU queue, deciding at dequeue time whether the SDU at the head is dropped.
+ *
+ * CoDel (RFC 8289) drops when the sojourn time of the SDUs has stayed above the target for an interval, at a rate that
+ * grows with the square root of the number of drops. PIE (RFC 8033) keeps a drop probability that follows the sojourn
+ * time against its target, updated periodically, and here drops at the head too, so the delay is measured instead of
+ * estimated from the departure rate.
+ *
+ * An SDU is never dropped when at most one MTU is left behind it, so the queue is never emptied by the AQM.
+ * It is used by the reader of the queue only and is not thread-safe.
+ */
+class rlc_aqm
+{
+public:
+  explicit rlc_aqm(const rlc_aqm_config_t& cfg);
+
+  /// Decides on the SDU just taken from the head of the queue, given when it was queued and the bytes left in the
+  /// queue. Returns true when the SDU has to be dropped
+  bool drop_head(uint64_t enqueue_ns, uint64_t now_ns, uint32_t queue_bytes);
+
+  rlc_aqm_mode_t get_mode() const { return mode; }
+  double         get_drop_probability() const { return pie.drop_prob; }
+
+  static const uint32_t mtu_bytes = 1500;
+
+private:
+  bool codel_drop(uint64_t sojourn_ns, uint64_t now_ns, uint32_t queue_bytes);
+  bool pie_drop(uint64_t sojourn_ns, uint64_t now_ns, uint32_t queue_bytes);
+  void pie_update(double qdelay_s);
+
+  rlc_aqm_mode_t mode;
+  uint64_t       target_ns;
+  uint64_t       interval_ns;
+
+  struct codel_state {
+    uint64_t first_above_time = 0;
+    uint64_t drop_next        = 0;
+    uint32_t count            = 0;
+    uint32_t lastcount        = 0;
+    bool     dropping         = false;
+  } codel;
+
+  struct pie_state {
+    double   drop_prob       = 0;
+    double   accu_prob       = 0;
+    double   qdelay_old      = 0;
+    double   qdelay          = 0;
+    double   burst_allowance = 0;
+    uint64_t last_update     = 0;
+  } pie;
+  std::minstd_rand                       rng;
+  std::uniform_real_distribution<double> uniform{0.0, 1.0};
+};
+
+} // namespace srslte
+
+#endif // SRSLTE_RLC_AQM_H
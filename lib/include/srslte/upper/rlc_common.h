@@ -26,6 +26,7 @@
 #include "srslte/common/logmap.h"
 #include "srslte/upper/rlc_metrics.h"
 #include <stdlib.h>
+#include <vector>
 
 namespace srslte {
 
@@ -249,6 +250,15 @@ public:
     }
   }
 
+  void write_pdu_s(unique_byte_buffer_t pdu)
+  {
+    if (suspended) {
+      queue_rx_pdu(pdu->msg, pdu->N_bytes);
+    } else {
+      write_pdu(std::move(pdu));
+    }
+  }
+
   void write_sdu_s(unique_byte_buffer_t sdu)
   {
     if (suspended) {
@@ -258,14 +268,33 @@ public:
     }
   }
 
+  void write_sdus_s(std::vector<unique_byte_buffer_t>& sdus)
+  {
+    if (suspended) {
+      for (unique_byte_buffer_t& sdu : sdus) {
+        queue_tx_sdu(std::move(sdu));
+      }
+    } else {
+      write_sdus(sdus);
+    }
+  }
+
   virtual rlc_mode_t get_mode()   = 0;
   virtual uint32_t   get_bearer() = 0;
 
-  virtual rlc_bearer_metrics_t get_metrics()   = 0;
-  virtual void                 reset_metrics() = 0;
+  virtual rlc_bearer_metrics_t get_metrics()           = 0;
+  virtual rlc_bearer_metrics_t get_and_reset_metrics() = 0;
+  virtual void                 reset_metrics()         = 0;
 
   // PDCP interface
   virtual void write_sdu(unique_byte_buffer_t sdu)                = 0;
+  // Burst of SDUs, the bearers that can enqueue them at once override it
+  virtual void write_sdus(std::vector<unique_byte_buffer_t>& sdus)
+  {
+    for (unique_byte_buffer_t& sdu : sdus) {
+      write_sdu(std::move(sdu));
+    }
+  }
   virtual void discard_sdu(uint32_t discard_sn)                   = 0;
   virtual bool sdu_queue_is_full()                                = 0;
 
@@ -275,6 +304,8 @@ public:
   virtual uint32_t get_buffer_state()                              = 0;
   virtual int      read_pdu(uint8_t* payload, uint32_t nof_bytes)  = 0;
   virtual void     write_pdu(uint8_t* payload, uint32_t nof_bytes) = 0;
+  // PDU whose buffer can be kept by the bearer instead of copied, the bearers that can do so override it
+  virtual void write_pdu(unique_byte_buffer_t pdu) { write_pdu(pdu->msg, pdu->N_bytes); }
 
   virtual void set_bsr_callback(bsr_callback_t callback) = 0;
 
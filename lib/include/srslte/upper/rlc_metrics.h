@@ -23,6 +23,8 @@
 #define SRSLTE_RLC_METRICS_H
 
 #include "srslte/common/common.h"
+#include "srslte/common/latency_histogram.h"
+#include "srslte/common/metrics_counter.h"
 #include <iostream>
 
 namespace srslte {
@@ -41,8 +43,68 @@ typedef struct {
   uint64_t num_tx_pdu_bytes;
   uint64_t num_rx_pdu_bytes;
   uint32_t num_lost_pdus;    //< Lost PDUs registered at Rx
+
+  // Latency metrics, of the SDUs sent since the last read
+  latency_stats_t upper_delay; //< From the entry of the SDU into the stack (GTP-U or GW) until it is queued at Tx
+  latency_stats_t queue_delay; //< Time of the SDU in the Tx SDU queue
 } rlc_bearer_metrics_t;
 
+/// Metrics of a bearer as counted by its entity. The data path updates them without locking and the metrics thread
+/// reads them without taking any lock of the entity
+struct rlc_bearer_metrics_counters {
+  metrics_counter<uint32_t> num_tx_sdus;
+  metrics_counter<uint32_t> num_rx_sdus;
+  metrics_counter<uint64_t> num_tx_sdu_bytes;
+  metrics_counter<uint64_t> num_rx_sdu_bytes;
+  metrics_counter<uint32_t> num_lost_sdus;
+  metrics_counter<uint32_t> num_tx_pdus;
+  metrics_counter<uint32_t> num_rx_pdus;
+  metrics_counter<uint64_t> num_tx_pdu_bytes;
+  metrics_counter<uint64_t> num_rx_pdu_bytes;
+  metrics_counter<uint32_t> num_lost_pdus;
+  latency_histogram         upper_delay;
+  latency_histogram         queue_delay;
+
+  rlc_bearer_metrics_t get() const
+  {
+    rlc_bearer_metrics_t m = {};
+    m.num_tx_sdus          = num_tx_sdus.load();
+    m.num_rx_sdus          = num_rx_sdus.load();
+    m.num_tx_sdu_bytes     = num_tx_sdu_bytes.load();
+    m.num_rx_sdu_bytes     = num_rx_sdu_bytes.load();
+    m.num_lost_sdus        = num_lost_sdus.load();
+    m.num_tx_pdus          = num_tx_pdus.load();
+    m.num_rx_pdus          = num_rx_pdus.load();
+    m.num_tx_pdu_bytes     = num_tx_pdu_bytes.load();
+    m.num_rx_pdu_bytes     = num_rx_pdu_bytes.load();
+    m.num_lost_pdus        = num_lost_pdus.load();
+    m.upper_delay          = upper_delay.get();
+    m.queue_delay          = queue_delay.get();
+    return m;
+  }
+
+  /// Returns the metrics counted since the last reset and resets them, without losing concurrent updates
+  rlc_bearer_metrics_t read_and_reset()
+  {
+    rlc_bearer_metrics_t m = {};
+    m.num_tx_sdus          = num_tx_sdus.read_and_reset();
+    m.num_rx_sdus          = num_rx_sdus.read_and_reset();
+    m.num_tx_sdu_bytes     = num_tx_sdu_bytes.read_and_reset();
+    m.num_rx_sdu_bytes     = num_rx_sdu_bytes.read_and_reset();
+    m.num_lost_sdus        = num_lost_sdus.read_and_reset();
+    m.num_tx_pdus          = num_tx_pdus.read_and_reset();
+    m.num_rx_pdus          = num_rx_pdus.read_and_reset();
+    m.num_tx_pdu_bytes     = num_tx_pdu_bytes.read_and_reset();
+    m.num_rx_pdu_bytes     = num_rx_pdu_bytes.read_and_reset();
+    m.num_lost_pdus        = num_lost_pdus.read_and_reset();
+    m.upper_delay          = upper_delay.read_and_reset();
+    m.queue_delay          = queue_delay.read_and_reset();
+    return m;
+  }
+
+  void reset() { read_and_reset(); }
+};
+
 typedef struct {
   rlc_bearer_metrics_t bearer[SRSLTE_N_RADIO_BEARERS];
   rlc_bearer_metrics_t mrb_bearer[SRSLTE_N_MCH_LCIDS];
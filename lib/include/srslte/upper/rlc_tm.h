@@ -45,6 +45,7 @@ public:
   uint32_t   get_bearer() override;
 
   rlc_bearer_metrics_t get_metrics() override;
+  rlc_bearer_metrics_t get_and_reset_metrics() override;
   void                 reset_metrics() override;
 
   // PDCP interface
@@ -69,7 +70,7 @@ private:
 
   bool tx_enabled = true;
 
-  rlc_bearer_metrics_t metrics = {};
+  rlc_bearer_metrics_counters metrics;
 
   // Thread-safe queues for MAC messages
   byte_buffer_queue ul_queue;
@@ -54,6 +54,7 @@ public:
 
   // PDCP interface
   void write_sdu(unique_byte_buffer_t sdu);
+  void write_sdus(std::vector<unique_byte_buffer_t>& sdus);
   void discard_sdu(uint32_t discard_sn);
   bool sdu_queue_is_full();
 
@@ -62,9 +63,11 @@ public:
   uint32_t get_buffer_state();
   int      read_pdu(uint8_t* payload, uint32_t nof_bytes);
   void     write_pdu(uint8_t* payload, uint32_t nof_bytes);
+  void     write_pdu(unique_byte_buffer_t pdu) override;
   int      get_increment_sequence_num();
 
   rlc_bearer_metrics_t get_metrics();
+  rlc_bearer_metrics_t get_and_reset_metrics();
   void                 reset_metrics();
 
   void set_bsr_callback(bsr_callback_t callback) {}
@@ -85,6 +88,7 @@ protected:
     void             discard_sdu(uint32_t discard_sn);
     bool             sdu_queue_is_full();
     int              try_write_sdu(unique_byte_buffer_t sdu);
+    uint32_t         try_write_sdus(std::vector<unique_byte_buffer_t>& sdus);
     void             reset_metrics();
     bool             has_data();
     virtual uint32_t get_buffer_state() = 0;
@@ -96,16 +100,21 @@ protected:
 
     rlc_config_t cfg = {};
 
+    rlc_bearer_metrics_counters& metrics;
+
     // TX SDU buffers
-    byte_buffer_queue    tx_sdu_queue;
-    unique_byte_buffer_t tx_sdu;
+    byte_buffer_queue        tx_sdu_queue;
+    unique_byte_buffer_t     tx_sdu;
+    std::unique_ptr<rlc_aqm> aqm;
 
     // Mutexes
     std::mutex mutex;
 
+    // Called with the mutex held
     virtual int build_data_pdu(unique_byte_buffer_t pdu, uint8_t* payload, uint32_t nof_bytes) = 0;
 
     // helper functions
+    void         configure_aqm(const rlc_aqm_config_t& aqm_cfg);
     virtual void debug_state() = 0;
     virtual void reset()       = 0;
   };
@@ -123,6 +132,8 @@ protected:
     virtual void reestablish() = 0;
 
     virtual void handle_data_pdu(uint8_t* payload, uint32_t nof_bytes) = 0;
+    // PDU whose buffer can be kept in the Rx window, the receivers that can do so override it
+    virtual void handle_data_pdu(unique_byte_buffer_t pdu) { handle_data_pdu(pdu->msg, pdu->N_bytes); }
 
   protected:
     byte_buffer_pool*          pool = nullptr;
@@ -131,7 +142,7 @@ protected:
     srsue::pdcp_interface_rlc* pdcp   = nullptr;
     srsue::rrc_interface_rlc*  rrc    = nullptr;
 
-    rlc_bearer_metrics_t& metrics;
+    rlc_bearer_metrics_counters& metrics;
 
     std::string  rb_name;
     rlc_config_t cfg = {};
@@ -162,7 +173,7 @@ protected:
   bool tx_enabled = false;
   bool rx_enabled = false;
 
-  rlc_bearer_metrics_t metrics = {};
+  rlc_bearer_metrics_counters metrics;
 };
 
 } // namespace srslte
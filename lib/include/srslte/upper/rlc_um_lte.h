@@ -85,6 +85,7 @@ private:
     void reestablish();
     bool configure();
     void handle_data_pdu(uint8_t* payload, uint32_t nof_bytes);
+    void handle_data_pdu(unique_byte_buffer_t pdu);
     void reassemble_rx_sdus();
     bool pdu_belongs_to_rx_sdu();
     bool inside_reordering_window(uint16_t sn);
@@ -94,6 +95,7 @@ private:
 
   private:
     void reset();
+    void handle_data_pdu(uint8_t* payload, uint32_t nof_bytes, unique_byte_buffer_t pdu_buf);
 
     // Rx window
     std::map<uint32_t, rlc_umd_pdu_t> rx_window;
@@ -103,16 +103,17 @@ private:
     uint32_t RX_Next_Highest    = 0; // the SN following the SN of the UMD PDU with the highest SN among
                                      // received UMD PDUs. It serves as the higher edge of the reassembly window.
 
-    // Rx window
+    // Rx window. The payload of every segment is copied once, from the MAC PDU to its offset in the SDU buffer, so
+    // only the received byte ranges are kept per segment
     typedef struct {
-      std::map<uint32_t, rlc_umd_pdu_nr_t> segments; // Map of segments with SO as key
-      unique_byte_buffer_t                 sdu;
-      uint32_t                             next_expected_so;
-      uint32_t                             total_sdu_length;
+      std::map<uint32_t, uint32_t> segments; // Length of the byte ranges not contiguous to SO=0 yet, with SO as key
+      unique_byte_buffer_t         sdu;
+      uint32_t                     next_expected_so;
+      uint32_t                     total_sdu_length; // 0 until the last segment is received
     } rlc_umd_pdu_segments_nr_t;
     std::map<uint32_t, rlc_umd_pdu_segments_nr_t> rx_window;
 
-    void update_total_sdu_length(rlc_umd_pdu_segments_nr_t& pdu_segments, const rlc_umd_pdu_nr_t& rx_pdu);
+    bool write_segment(const rlc_um_nr_pdu_header_t& header, const uint8_t* payload, const uint32_t nof_bytes);
 
     // TS 38.322 Sec. 7.3
     srslte::timer_handler::unique_timer reassembly_timer; // to detect loss of RLC PDUs at lower layers
@@ -21,6 +21,7 @@
 
 #include "srslte/asn1/asn1_utils.h"
 #include "srslte/common/logmap.h"
+#include <atomic>
 #include <cmath>
 #include <stdio.h>
 
@@ -84,6 +85,97 @@ void log_debug(const char* format, ...)
   va_end(args);
 }
 
+/************************
+      memory arena
+************************/
+
+struct alignas(std::max_align_t) mem_arena::block_t {
+  explicit block_t(size_t cap_) : cap(cap_) {}
+
+  std::atomic<uint32_t> refs{1}; // live allocations, plus one while this is the current block of the arena
+  size_t                offset = 0;
+  size_t                cap;
+};
+
+static thread_local mem_arena* current_arena = nullptr;
+
+static void release_block(mem_arena::block_t* block)
+{
+  if (block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    block->~block_t();
+    ::operator delete(block);
+  }
+}
+
+mem_arena::mem_arena(size_t block_size_) : block_size(block_size_) {}
+
+mem_arena::~mem_arena()
+{
+  if (cur != nullptr) {
+    release_block(cur);
+  }
+}
+
+void* mem_arena::allocate(size_t sz, void*& block)
+{
+  sz = ceil_frac(sz, alignof(block_t)) * alignof(block_t);
+  // big arrays would waste most of a block, they go to the heap
+  if (sz > block_size / 4) {
+    return nullptr;
+  }
+  if (cur != nullptr and cur->refs.load(std::memory_order_acquire) == 1) {
+    // all the allocations of the current block were released
+    cur->offset = 0;
+  }
+  if (cur == nullptr or cur->offset + sz > cur->cap) {
+    if (cur != nullptr) {
+      release_block(cur);
+    }
+    cur = new (::operator new(sizeof(block_t) + block_size)) block_t(block_size);
+  }
+  void* p = reinterpret_cast<uint8_t*>(cur + 1) + cur->offset;
+  cur->offset += sz;
+  cur->refs.fetch_add(1, std::memory_order_relaxed);
+  block = cur;
+  return p;
+}
+
+arena_scope::arena_scope(mem_arena& arena) : prev(current_arena)
+{
+  current_arena = &arena;
+}
+
+arena_scope::~arena_scope()
+{
+  current_arena = prev;
+}
+
+namespace detail {
+
+array_header* allocate_array(size_t sz)
+{
+  sz += sizeof(array_header);
+  void* block = nullptr;
+  void* p     = current_arena != nullptr ? current_arena->allocate(sz, block) : nullptr;
+  if (p == nullptr) {
+    p = ::operator new(sz);
+  }
+  array_header* h = static_cast<array_header*>(p);
+  h->block        = block;
+  return h;
+}
+
+void deallocate_array(array_header* h)
+{
+  if (h->block != nullptr) {
+    release_block(static_cast<mem_arena::block_t*>(h->block));
+  } else {
+    ::operator delete(h);
+  }
+}
+
+} // namespace detail
+
 /************************
      error handling
 ************************/
@@ -132,12 +224,40 @@ int bit_ref_impl<Ptr>::distance_bytes() const
   return ((int)(ptr - start_ptr)) + ((offset) ? 1 : 0);
 }
 
+// Reads the 8 bytes at ptr as a big endian word
+static inline uint64_t load_be64(const uint8_t* ptr)
+{
+  uint64_t w;
+  memcpy(&w, ptr, sizeof(w));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  w = __builtin_bswap64(w);
+#endif
+  return w;
+}
+
 SRSASN_CODE bit_ref::pack(uint32_t val, uint32_t n_bits)
 {
   if (n_bits >= 32) {
     log_error("This method only supports packing up to 32 bits\n");
     return SRSASN_ERROR_ENCODE_FAIL;
   }
+  if (n_bits == 0) {
+    return SRSASN_SUCCESS;
+  }
+
+  // The whole field is written at once, keeping the bits before the offset and zeroing the ones after the field
+  uint32_t nof_bytes = (offset + n_bits + 7) / 8;
+  if (ptr + nof_bytes <= max_ptr) {
+    uint64_t w = ((uint64_t)(*ptr & (uint8_t)(0xffu << (8u - offset))) << 56u) |
+                 ((uint64_t)(val & ((1u << n_bits) - 1u)) << (64u - offset - n_bits));
+    for (uint32_t i = 0; i < nof_bytes; ++i) {
+      ptr[i] = (uint8_t)(w >> (56u - 8u * i));
+    }
+    ptr += (offset + n_bits) / 8;
+    offset = (offset + n_bits) % 8;
+    return SRSASN_SUCCESS;
+  }
+
   uint32_t mask;
   while (n_bits > 0) {
     if (ptr >= max_ptr) {
@@ -171,6 +291,32 @@ SRSASN_CODE unpack_bits(T& val, Ptr& ptr, uint8_t& offset, const uint8_t* max_pt
     return SRSASN_ERROR_DECODE_FAIL;
   }
   val = 0;
+  if (n_bits == 0) {
+    return SRSASN_SUCCESS;
+  }
+
+  // Fields that fit in a word are read with a single load and bounds check, the word is only loaded byte by byte
+  // near the end of the buffer
+  if (offset + n_bits <= 64) {
+    uint32_t nof_bytes = (offset + n_bits + 7) / 8;
+    if (ptr + nof_bytes > max_ptr) {
+      log_error("Buffer size limit was achieved\n");
+      return SRSASN_ERROR_DECODE_FAIL;
+    }
+    uint64_t w = 0;
+    if (ptr + sizeof(uint64_t) <= max_ptr) {
+      w = load_be64(ptr);
+    } else {
+      for (uint32_t i = 0; i < nof_bytes; ++i) {
+        w |= (uint64_t)ptr[i] << (56u - 8u * i);
+      }
+    }
+    val = static_cast<T>((w << offset) >> (64u - n_bits));
+    ptr += (offset + n_bits) / 8;
+    offset = (offset + n_bits) % 8;
+    return SRSASN_SUCCESS;
+  }
+
   while (n_bits > 0) {
     if (ptr >= max_ptr) {
       log_error("Buffer size limit was achieved\n");
@@ -183,7 +329,7 @@ SRSASN_CODE unpack_bits(T& val, Ptr& ptr, uint8_t& offset, const uint8_t* max_pt
       n_bits = 0;
     } else {
       auto mask = static_cast<uint8_t>((1u << (8u - offset)) - 1u);
-      val += ((uint32_t)((*ptr) & mask)) << (n_bits - 8 + offset);
+      val += ((uint64_t)((*ptr) & mask)) << (n_bits - 8 + offset);
       n_bits -= 8 - offset;
       offset = 0;
       ptr++;
@@ -241,12 +387,13 @@ SRSASN_CODE bit_ref_impl<Ptr>::unpack_bytes(uint8_t* buf, uint32_t n_bytes)
   if (offset == 0) {
     // Aligned case
     memcpy(buf, ptr, n_bytes);
-    ptr += n_bytes;
   } else {
+    // Each byte straddles two bytes of the buffer
     for (uint32_t i = 0; i < n_bytes; ++i) {
-      HANDLE_CODE(unpack(buf[i], 8));
+      buf[i] = (uint8_t)((ptr[i] << offset) | (ptr[i + 1] >> (8u - offset)));
     }
   }
+  ptr += n_bytes;
   return SRSASN_SUCCESS;
 }
 
@@ -304,12 +451,15 @@ SRSASN_CODE bit_ref::pack_bytes(const uint8_t* buf, uint32_t n_bytes)
   if (offset == 0) {
     // Aligned case
     memcpy(ptr, buf, n_bytes);
-    ptr += n_bytes;
   } else {
-    for (uint32_t i = 0; i < n_bytes; ++i) {
-      pack(buf[i], 8);
+    // Each byte straddles two bytes of the buffer, the bits after the last one are zeroed
+    ptr[0] = (uint8_t)((ptr[0] & (uint8_t)(0xffu << (8u - offset))) | (buf[0] >> offset));
+    for (uint32_t i = 1; i < n_bytes; ++i) {
+      ptr[i] = (uint8_t)((buf[i - 1] << (8u - offset)) | (buf[i] >> offset));
     }
+    ptr[n_bytes] = (uint8_t)(buf[n_bytes - 1] << (8u - offset));
   }
+  ptr += n_bytes;
   return SRSASN_SUCCESS;
 }
 
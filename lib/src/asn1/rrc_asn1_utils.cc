@@ -275,6 +275,29 @@ srslte::pdcp_config_t make_drb_pdcp_config_t(const uint8_t bearer_id, bool is_ue
                     sn_len,
                     t_reordering,
                     discard_timer);
+
+  if (pdcp_cfg.hdr_compress.type() == pdcp_cfg_s::hdr_compress_c_::types_opts::rohc) {
+    // The profiles are kept for the logs, but the native compressor is not enabled: it only implements profile
+    // 0x0000, and the UE does not report support for any of the profiles RRC can configure
+    const pdcp_cfg_s::hdr_compress_c_::rohc_s_& rohc = pdcp_cfg.hdr_compress.rohc();
+    if (rohc.max_cid_present) {
+      cfg.rohc.max_cid = rohc.max_cid;
+    }
+    const std::pair<bool, uint16_t> profiles[] = {{rohc.profiles.profile0x0001, 0x0001},
+                                                  {rohc.profiles.profile0x0002, 0x0002},
+                                                  {rohc.profiles.profile0x0003, 0x0003},
+                                                  {rohc.profiles.profile0x0004, 0x0004},
+                                                  {rohc.profiles.profile0x0006, 0x0006},
+                                                  {rohc.profiles.profile0x0101, 0x0101},
+                                                  {rohc.profiles.profile0x0102, 0x0102},
+                                                  {rohc.profiles.profile0x0103, 0x0103},
+                                                  {rohc.profiles.profile0x0104, 0x0104}};
+    for (const auto& p : profiles) {
+      if (p.first) {
+        cfg.rohc.profiles.push_back(p.second);
+      }
+    }
+  }
   return cfg;
 }
 
@@ -312,6 +335,9 @@ void set_mac_cfg_t_main_cfg(mac_cfg_t* cfg, const asn1::rrc::mac_main_cfg_s& asn
       cfg->harq_cfg.max_harq_tx = asn1_type.ul_sch_cfg.max_harq_tx.to_number();
     }
   }
+  if (asn1_type.drx_cfg_present) {
+    cfg->drx_cfg = make_drx_cfg(asn1_type.drx_cfg);
+  }
   // TimeAlignmentDedicated overwrites Common??
   cfg->time_alignment_timer = asn1_type.time_align_timer_ded.to_number();
 }
@@ -350,6 +376,83 @@ void set_mac_cfg_t_time_alignment(mac_cfg_t* cfg, const asn1::rrc::time_align_ti
   cfg->time_alignment_timer = asn1_type.to_number();
 }
 
+drx_cfg_t make_drx_cfg(const asn1::rrc::drx_cfg_c& asn1_type)
+{
+  drx_cfg_t cfg;
+  if (asn1_type.type() != asn1::rrc::setup_e::setup) {
+    return cfg;
+  }
+  const asn1::rrc::drx_cfg_c::setup_s_& setup = asn1_type.setup();
+
+  cfg.enabled           = true;
+  cfg.on_duration_timer = setup.on_dur_timer.to_number();
+  cfg.inactivity_timer  = setup.drx_inactivity_timer.to_number();
+  cfg.retx_timer        = setup.drx_retx_timer.to_number();
+
+  using offset_t         = asn1::rrc::drx_cfg_c::setup_s_::long_drx_cycle_start_offset_c_;
+  const offset_t& offset = setup.long_drx_cycle_start_offset;
+  cfg.long_cycle         = offset.type().to_number();
+  switch (offset.type().value) {
+    case offset_t::types::sf10:
+      cfg.long_cycle_offset = offset.sf10();
+      break;
+    case offset_t::types::sf20:
+      cfg.long_cycle_offset = offset.sf20();
+      break;
+    case offset_t::types::sf32:
+      cfg.long_cycle_offset = offset.sf32();
+      break;
+    case offset_t::types::sf40:
+      cfg.long_cycle_offset = offset.sf40();
+      break;
+    case offset_t::types::sf64:
+      cfg.long_cycle_offset = offset.sf64();
+      break;
+    case offset_t::types::sf80:
+      cfg.long_cycle_offset = offset.sf80();
+      break;
+    case offset_t::types::sf128:
+      cfg.long_cycle_offset = offset.sf128();
+      break;
+    case offset_t::types::sf160:
+      cfg.long_cycle_offset = offset.sf160();
+      break;
+    case offset_t::types::sf256:
+      cfg.long_cycle_offset = offset.sf256();
+      break;
+    case offset_t::types::sf320:
+      cfg.long_cycle_offset = offset.sf320();
+      break;
+    case offset_t::types::sf512:
+      cfg.long_cycle_offset = offset.sf512();
+      break;
+    case offset_t::types::sf640:
+      cfg.long_cycle_offset = offset.sf640();
+      break;
+    case offset_t::types::sf1024:
+      cfg.long_cycle_offset = offset.sf1024();
+      break;
+    case offset_t::types::sf1280:
+      cfg.long_cycle_offset = offset.sf1280();
+      break;
+    case offset_t::types::sf2048:
+      cfg.long_cycle_offset = offset.sf2048();
+      break;
+    case offset_t::types::sf2560:
+      cfg.long_cycle_offset = offset.sf2560();
+      break;
+    default:
+      cfg.enabled = false;
+      break;
+  }
+
+  if (setup.short_drx_present) {
+    cfg.short_cycle       = setup.short_drx.short_drx_cycle.to_number();
+    cfg.short_cycle_timer = setup.short_drx.drx_short_cycle_timer;
+  }
+  return cfg;
+}
+
 srsenb::sched_interface::ant_info_ded_t make_ant_info_ded(const asn1::rrc::ant_info_ded_s& asn1_type)
 {
   srsenb::sched_interface::ant_info_ded_t ant_ded = {};
@@ -54,6 +54,14 @@ srslte_basic_vnf::srslte_basic_vnf(const vnf_args_t& args_, srslte::logger* logg
       m_ue_stack = (srsue::stack_interface_phy_nr*)stack_;
     }
 
+    if (not m_args.shm_name.empty()) {
+      if (not tx_ring.open(basic_vnf_api::shm_ring_name(m_args.shm_name, true)) or
+          not rx_ring.open(basic_vnf_api::shm_ring_name(m_args.shm_name, false))) {
+        log_h->error("Couldn't map the shared memory rings %s\n", m_args.shm_name.c_str());
+        return;
+      }
+    }
+
     log_h->info("Initializing VNF for gNB\n");
     start();
   } else {
@@ -68,6 +76,22 @@ srslte_basic_vnf::~srslte_basic_vnf()
 
 void srslte_basic_vnf::run_thread()
 {
+  if (rx_ring.is_open()) {
+    running = true;
+    log_h->info("Started VNF handler on shared memory %s\n", m_args.shm_name.c_str());
+    while (running) {
+      uint32_t       len = 0;
+      const uint8_t* msg = rx_ring.wait_front(RX_TIMEOUT_MS, &len);
+      if (msg != nullptr) {
+        // handled in place, the slot is only released afterwards
+        handle_msg(msg, len);
+        rx_ring.pop();
+      }
+    }
+    log_h->info("VNF thread stopped\n");
+    return;
+  }
+
   // Bind to UDP socket
   sockfd = socket(AF_INET, SOCK_DGRAM, 0);
   if (sockfd < 0) {
@@ -262,25 +286,28 @@ int srslte_basic_vnf::handle_rx_data_ind(basic_vnf_api::rx_data_ind_msg_t* msg)
 
 int srslte_basic_vnf::dl_config_request(const srsenb::phy_interface_stack_nr::dl_config_request_t& request)
 {
+  auto* dl_conf = (basic_vnf_api::dl_conf_msg_t*)get_tx_buffer();
+  if (dl_conf == nullptr) {
+    log_h->error("Dropping %s, the PNF is not reading\n", basic_vnf_api::msg_type_text[basic_vnf_api::DL_CONFIG]);
+    return SRSLTE_ERROR;
+  }
+
   // Generate DL Config
-  basic_vnf_api::dl_conf_msg_t dl_conf = {};
-  dl_conf.header.type                  = basic_vnf_api::DL_CONFIG;
-  dl_conf.header.msg_len               = sizeof(dl_conf) - sizeof(basic_vnf_api::msg_header_t);
+  *dl_conf                = {};
+  dl_conf->header.type    = basic_vnf_api::DL_CONFIG;
+  dl_conf->header.msg_len = sizeof(*dl_conf) - sizeof(basic_vnf_api::msg_header_t);
 
-  dl_conf.t1      = last_sf_indication_time; // play back the time
-  dl_conf.t2      = 0xaa;                    // FIXME: add timestamp
-  dl_conf.tti     = request.tti;
-  dl_conf.beam_id = request.beam_id;
+  dl_conf->t1      = last_sf_indication_time; // play back the time
+  dl_conf->t2      = 0xaa;                    // FIXME: add timestamp
+  dl_conf->tti     = request.tti;
+  dl_conf->beam_id = request.beam_id;
 
   // Send entire struct
-  uint32_t len = sizeof(dl_conf);
+  uint32_t len = sizeof(*dl_conf);
 
   // Send it to PNF
-  log_h->info("Sending %s (%d B)\n", basic_vnf_api::msg_type_text[dl_conf.header.type], len);
-  int n = 0;
-  if ((n = sendto(sockfd, &dl_conf, len, MSG_CONFIRM, (struct sockaddr*)&client_addr, sizeof(client_addr))) < 0) {
-    log_h->error("sendto failed, ret=%d\n", n);
-  }
+  log_h->info("Sending %s (%d B)\n", basic_vnf_api::msg_type_text[dl_conf->header.type], len);
+  send_tx_buffer(len);
 
   return 0;
 }
@@ -288,37 +315,39 @@ int srslte_basic_vnf::dl_config_request(const srsenb::phy_interface_stack_nr::dl
 /// Tx request from UE, i.e. UL transmission
 int srslte_basic_vnf::tx_request(const srsue::phy_interface_stack_nr::tx_request_t& request)
 {
+  auto* tx_req_msg = (basic_vnf_api::tx_request_msg_t*)get_tx_buffer();
+  if (tx_req_msg == nullptr) {
+    log_h->error("Dropping %s, the PNF is not reading\n", basic_vnf_api::msg_type_text[basic_vnf_api::TX_REQUEST]);
+    return SRSLTE_ERROR;
+  }
+
   // Generate Tx request
-  m_tx_req_msg->header.type    = basic_vnf_api::TX_REQUEST;
-  m_tx_req_msg->header.msg_len = 0; // set further down
+  tx_req_msg->header.type    = basic_vnf_api::TX_REQUEST;
+  tx_req_msg->header.msg_len = 0; // set further down
 
-  m_tx_req_msg->tti = request.tti;
+  tx_req_msg->tti = request.tti;
 
-  m_tx_req_msg->nof_pdus       = 1;
-  m_tx_req_msg->pdus[0].index  = 0;
-  m_tx_req_msg->pdus[0].type   = basic_vnf_api::PUSCH;
-  m_tx_req_msg->pdus[0].length = request.tb_len;
+  tx_req_msg->nof_pdus       = 1;
+  tx_req_msg->pdus[0].index  = 0;
+  tx_req_msg->pdus[0].type   = basic_vnf_api::PUSCH;
+  tx_req_msg->pdus[0].length = request.tb_len;
 
   if (request.tb_len <= MAX_PDU_SIZE) {
     // copy data from TB0
-    memcpy(m_tx_req_msg->pdus[0].data, request.data, request.tb_len);
+    memcpy(tx_req_msg->pdus[0].data, request.data, request.tb_len);
   } else {
     log_h->error("Trying to send %d B PDU. Maximum size is %d B\n", request.tb_len, MAX_PDU_SIZE);
   }
 
   // calculate actual length of
-  uint32_t len = calc_full_msg_len(*m_tx_req_msg.get());
+  uint32_t len = calc_full_msg_len(*tx_req_msg);
 
   // update msg header length field
-  m_tx_req_msg->header.msg_len = len - sizeof(basic_vnf_api::msg_header_t);
+  tx_req_msg->header.msg_len = len - sizeof(basic_vnf_api::msg_header_t);
 
   // Send it to PNF
-  log_h->info("Sending %s (%d B)\n", basic_vnf_api::msg_type_text[m_tx_req_msg->header.type], len);
-  int n = 0;
-  if ((n = sendto(sockfd, m_tx_req_msg.get(), len, MSG_CONFIRM, (struct sockaddr*)&client_addr, sizeof(client_addr))) <
-      0) {
-    log_h->error("sendto failed, ret=%d\n", n);
-  }
+  log_h->info("Sending %s (%d B)\n", basic_vnf_api::msg_type_text[tx_req_msg->header.type], len);
+  send_tx_buffer(len);
 
   return 0;
 }
@@ -333,48 +362,50 @@ int srslte_basic_vnf::tx_request(const srsenb::phy_interface_stack_nr::tx_reques
     return SRSLTE_SUCCESS;
   }
 
+  auto* tx_req_msg = (basic_vnf_api::tx_request_msg_t*)get_tx_buffer();
+  if (tx_req_msg == nullptr) {
+    log_h->error("Dropping %s, the PNF is not reading\n", basic_vnf_api::msg_type_text[basic_vnf_api::TX_REQUEST]);
+    return SRSLTE_ERROR;
+  }
+
   // Generate Tx request
-  m_tx_req_msg->header.type    = basic_vnf_api::TX_REQUEST;
-  m_tx_req_msg->header.msg_len = 0; // set further down
+  tx_req_msg->header.type    = basic_vnf_api::TX_REQUEST;
+  tx_req_msg->header.msg_len = 0; // set further down
 
-  m_tx_req_msg->nof_pdus = request.nof_pdus;
-  m_tx_req_msg->tti      = request.tti;
+  tx_req_msg->nof_pdus = request.nof_pdus;
+  tx_req_msg->tti      = request.tti;
 
-  for (uint32_t i = 0; i < m_tx_req_msg->nof_pdus; ++i) {
+  for (uint32_t i = 0; i < tx_req_msg->nof_pdus; ++i) {
     if (request.pdus[i].length <= MAX_PDU_SIZE) {
-      m_tx_req_msg->pdus[i].index  = i;
-      m_tx_req_msg->pdus[i].type   = request.pdus[i].pbch.mib_present ? basic_vnf_api::MAC_PBCH : basic_vnf_api::PDSCH;
-      m_tx_req_msg->pdus[i].length = request.pdus[i].length;
+      tx_req_msg->pdus[i].index  = i;
+      tx_req_msg->pdus[i].type   = request.pdus[i].pbch.mib_present ? basic_vnf_api::MAC_PBCH : basic_vnf_api::PDSCH;
+      tx_req_msg->pdus[i].length = request.pdus[i].length;
       // copy data from TB0
-      memcpy(m_tx_req_msg->pdus[i].data, request.pdus[i].data[0], m_tx_req_msg->pdus[i].length);
+      memcpy(tx_req_msg->pdus[i].data, request.pdus[i].data[0], tx_req_msg->pdus[i].length);
     } else {
       log_h->error("Trying to send %d B PDU. Maximum size is %d B\n", request.pdus[i].length, MAX_PDU_SIZE);
     }
   }
 
   // calculate actual length of message
-  uint32_t len = calc_full_msg_len(*m_tx_req_msg.get());
+  uint32_t len = calc_full_msg_len(*tx_req_msg);
 
   // update msg header length field
-  m_tx_req_msg->header.msg_len = len - sizeof(basic_vnf_api::msg_header_t);
+  tx_req_msg->header.msg_len = len - sizeof(basic_vnf_api::msg_header_t);
 
   // Send it to PNF
-  log_h->info("Sending %s (%d B)\n", basic_vnf_api::msg_type_text[m_tx_req_msg->header.type], len);
+  log_h->info("Sending %s (%d B)\n", basic_vnf_api::msg_type_text[tx_req_msg->header.type], len);
   if (log_h->get_level() == LOG_LEVEL_DEBUG) {
-    for (uint32_t i = 0; i < m_tx_req_msg->nof_pdus; ++i) {
-      log_h->debug_hex(m_tx_req_msg->pdus[i].data,
-                       m_tx_req_msg->pdus[i].length,
+    for (uint32_t i = 0; i < tx_req_msg->nof_pdus; ++i) {
+      log_h->debug_hex(tx_req_msg->pdus[i].data,
+                       tx_req_msg->pdus[i].length,
                        "Sending PDU %s:%d (%d bytes)\n",
-                       basic_vnf_api::msg_type_text[m_tx_req_msg->header.type],
-                       m_tx_req_msg->pdus[i].index,
-                       m_tx_req_msg->pdus[i].length);
+                       basic_vnf_api::msg_type_text[tx_req_msg->header.type],
+                       tx_req_msg->pdus[i].index,
+                       tx_req_msg->pdus[i].length);
     }
   }
-  int n = 0;
-  if ((n = sendto(sockfd, m_tx_req_msg.get(), len, MSG_CONFIRM, (struct sockaddr*)&client_addr, sizeof(client_addr))) <
-      0) {
-    log_h->error("sendto failed, ret=%d\n", n);
-  }
+  send_tx_buffer(len);
 
   return 0;
 }
@@ -392,6 +423,27 @@ uint32_t srslte_basic_vnf::calc_full_msg_len(const basic_vnf_api::tx_request_msg
   return len;
 }
 
+uint8_t* srslte_basic_vnf::get_tx_buffer()
+{
+  if (tx_ring.is_open()) {
+    return tx_ring.reserve();
+  }
+  return (uint8_t*)m_tx_req_msg.get();
+}
+
+void srslte_basic_vnf::send_tx_buffer(uint32_t len)
+{
+  if (tx_ring.is_open()) {
+    tx_ring.commit(len);
+    return;
+  }
+  int n = 0;
+  if ((n = sendto(sockfd, m_tx_req_msg.get(), len, MSG_CONFIRM, (struct sockaddr*)&client_addr, sizeof(client_addr))) <
+      0) {
+    log_h->error("sendto failed, ret=%d\n", n);
+  }
+}
+
 bool srslte_basic_vnf::stop()
 {
   if (running) {
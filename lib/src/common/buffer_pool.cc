@@ -20,15 +20,203 @@
  */
 
 #include "srslte/common/buffer_pool.h"
+#include <condition_variable>
+#include <mutex>
 #include <pthread.h>
 #include <stdio.h>
 #include <string>
 
 namespace srslte {
 
+namespace detail {
+
+const uint32_t free_index_list::no_index;
+const uint32_t free_index_list::cache_batch;
+
+/// Lock-free stack of indexes, shared by a free_index_list and the thread caches of its indexes
+struct free_index_stack {
+  explicit free_index_stack(uint32_t nof_indexes) : next(new std::atomic<uint32_t>[nof_indexes])
+  {
+    for (uint32_t i = 0; i < nof_indexes; ++i) {
+      next[i].store(i + 1 < nof_indexes ? i + 1 : free_index_list::no_index, std::memory_order_relaxed);
+    }
+    head.store(make_head(nof_indexes > 0 ? 0 : free_index_list::no_index, 0));
+    count.store(nof_indexes);
+  }
+
+  static uint64_t make_head(uint32_t idx, uint32_t tag) { return ((uint64_t)tag << 32u) | idx; }
+
+  /// Pushes the chain of n indexes from first to last, which are already linked through next
+  void push_chain(uint32_t first, uint32_t last, uint32_t n)
+  {
+    uint64_t old_head = head.load(std::memory_order_relaxed);
+    uint64_t new_head;
+    do {
+      next[last].store((uint32_t)old_head, std::memory_order_relaxed);
+      new_head = make_head(first, (uint32_t)(old_head >> 32u) + 1);
+    } while (not head.compare_exchange_weak(old_head, new_head));
+    count.fetch_add(n, std::memory_order_relaxed);
+
+    if (nof_waiters.load() > 0) {
+      std::lock_guard<std::mutex> lock(mutex);
+      cvar.notify_all();
+    }
+  }
+
+  /// Pops up to max_n indexes into out. Returns the number of indexes popped
+  uint32_t pop_chain(uint32_t* out, uint32_t max_n)
+  {
+    uint64_t old_head = head.load();
+    uint64_t new_head;
+    uint32_t n;
+    do {
+      // If the chain changes while it is walked the tag does too, and the exchange fails
+      uint32_t idx = (uint32_t)old_head;
+      for (n = 0; idx != free_index_list::no_index and n < max_n; ++n) {
+        out[n] = idx;
+        idx    = next[idx].load(std::memory_order_relaxed);
+      }
+      if (n == 0) {
+        return 0;
+      }
+      new_head = make_head(idx, (uint32_t)(old_head >> 32u) + 1);
+    } while (not head.compare_exchange_weak(old_head, new_head));
+    count.fetch_sub(n, std::memory_order_relaxed);
+    return n;
+  }
+
+  uint32_t pop_blocking()
+  {
+    uint32_t                     idx;
+    std::unique_lock<std::mutex> lock(mutex);
+    nof_waiters++;
+    while (pop_chain(&idx, 1) == 0) {
+      cvar.wait(lock);
+    }
+    nof_waiters--;
+    return idx;
+  }
+
+  std::unique_ptr<std::atomic<uint32_t>[]> next;
+  std::atomic<uint64_t>                    head;
+  std::atomic<uint32_t>                    count;
+  std::atomic<uint32_t>                    nof_waiters{0};
+  std::mutex                               mutex;
+  std::condition_variable                  cvar;
+};
+
+namespace {
+
+struct thread_cache {
+  thread_cache(uint64_t list_id_, std::shared_ptr<free_index_stack> stack_) : list_id(list_id_), stack(stack_) {}
+
+  /// Gives the last n indexes back to the shared stack
+  void give_back(free_index_stack& s, uint32_t n)
+  {
+    uint32_t first = nof_indexes - n;
+    for (uint32_t i = first; i + 1 < nof_indexes; ++i) {
+      s.next[indexes[i]].store(indexes[i + 1], std::memory_order_relaxed);
+    }
+    s.push_chain(indexes[first], indexes[nof_indexes - 1], n);
+    nof_indexes = first;
+  }
+
+  uint64_t                        list_id;
+  std::weak_ptr<free_index_stack> stack;
+  uint32_t                        nof_indexes = 0;
+  uint32_t                        indexes[2 * free_index_list::cache_batch];
+};
+
+struct thread_cache_list {
+  ~thread_cache_list()
+  {
+    for (std::unique_ptr<thread_cache>& c : caches) {
+      std::shared_ptr<free_index_stack> s = c->stack.lock();
+      if (s != nullptr and c->nof_indexes > 0) {
+        c->give_back(*s, c->nof_indexes);
+      }
+    }
+  }
+
+  thread_cache* find(uint64_t list_id, const std::shared_ptr<free_index_stack>& stack)
+  {
+    for (std::unique_ptr<thread_cache>& c : caches) {
+      if (c->list_id == list_id) {
+        return c.get();
+      }
+    }
+    // The caches of the lists that were destroyed are dropped before adding a new one
+    caches.erase(std::remove_if(caches.begin(),
+                                caches.end(),
+                                [](const std::unique_ptr<thread_cache>& c) { return c->stack.expired(); }),
+                 caches.end());
+    caches.emplace_back(new thread_cache(list_id, stack));
+    return caches.back().get();
+  }
+
+  std::vector<std::unique_ptr<thread_cache> > caches;
+};
+
+thread_local thread_cache_list local_caches;
+std::atomic<uint64_t>          next_list_id{0};
+
+} // namespace
+
+free_index_list::free_index_list(uint32_t nof_indexes, bool thread_cache) :
+  stack(new free_index_stack(nof_indexes)),
+  use_thread_cache(thread_cache),
+  id(next_list_id++)
+{}
+
+free_index_list::~free_index_list() = default;
+
+uint32_t free_index_list::pop(bool blocking)
+{
+  uint32_t idx;
+  if (use_thread_cache) {
+    thread_cache* c = local_caches.find(id, stack);
+    if (c->nof_indexes == 0) {
+      c->nof_indexes = stack->pop_chain(c->indexes, cache_batch);
+    }
+    if (c->nof_indexes > 0) {
+      return c->indexes[--c->nof_indexes];
+    }
+  } else if (stack->pop_chain(&idx, 1) == 1) {
+    return idx;
+  }
+  return blocking ? stack->pop_blocking() : no_index;
+}
+
+void free_index_list::push(uint32_t idx)
+{
+  if (not use_thread_cache) {
+    stack->push_chain(idx, idx, 1);
+    return;
+  }
+  thread_cache* c              = local_caches.find(id, stack);
+  c->indexes[c->nof_indexes++] = idx;
+  if (stack->nof_waiters.load() > 0) {
+    // Another thread is blocked until a buffer is free
+    c->give_back(*stack, c->nof_indexes);
+  } else if (c->nof_indexes == 2 * cache_batch) {
+    c->give_back(*stack, cache_batch);
+  }
+}
+
+uint32_t free_index_list::nof_free() const
+{
+  return stack->count.load(std::memory_order_relaxed);
+}
+
+} // namespace detail
+
 std::unique_ptr<byte_buffer_pool> byte_buffer_pool::instance;
 static pthread_mutex_t instance_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+const uint32_t byte_buffer_pool::small_buffer_headroom;
+const uint32_t byte_buffer_pool::small_byte_buffer_capacity;
+const uint32_t byte_buffer_pool::medium_byte_buffer_capacity;
+
 byte_buffer_pool* byte_buffer_pool::get_instance(int capacity)
 {
   pthread_mutex_lock(&instance_mutex);
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/io_uring.h"
+
+#ifdef HAVE_IO_URING
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace srslte {
+
+bool io_uring_queue::init(uint32_t nof_entries)
+{
+  reset();
+
+  io_uring_params params = {};
+  int             fd     = (int)syscall(__NR_io_uring_setup, nof_entries, &params);
+  if (fd < 0) {
+    return false;
+  }
+  // Older kernels map the two rings separately, and without NODROP the completions past the end of the ring are lost
+  if (not(params.features & IORING_FEAT_SINGLE_MMAP) or not(params.features & IORING_FEAT_NODROP)) {
+    close(fd);
+    return false;
+  }
+  ring_fd = fd;
+
+  // Both rings are in the same mapping
+  ring_sz = std::max(params.sq_off.array + params.sq_entries * sizeof(uint32_t),
+                     params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+  ring    = mmap(nullptr, ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (ring == MAP_FAILED) {
+    ring = nullptr;
+    reset();
+    return false;
+  }
+
+  sqes_sz = params.sq_entries * sizeof(io_uring_sqe);
+  void* p = mmap(nullptr, sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (p == MAP_FAILED) {
+    reset();
+    return false;
+  }
+  sqes = (io_uring_sqe*)p;
+
+  uint8_t* sq = (uint8_t*)ring;
+  sq_khead    = (uint32_t*)(sq + params.sq_off.head);
+  sq_ktail    = (uint32_t*)(sq + params.sq_off.tail);
+  sq_mask     = *(uint32_t*)(sq + params.sq_off.ring_mask);
+  sq_entries  = *(uint32_t*)(sq + params.sq_off.ring_entries);
+  // Each slot of the submission ring points to the entry with the same index
+  uint32_t* sq_array = (uint32_t*)(sq + params.sq_off.array);
+  for (uint32_t i = 0; i < sq_entries; ++i) {
+    sq_array[i] = i;
+  }
+  sqe_head = *sq_ktail;
+  sqe_tail = sqe_head;
+
+  uint8_t* cq = (uint8_t*)ring;
+  cq_khead    = (uint32_t*)(cq + params.cq_off.head);
+  cq_ktail    = (uint32_t*)(cq + params.cq_off.tail);
+  cq_mask     = *(uint32_t*)(cq + params.cq_off.ring_mask);
+  cqes        = (io_uring_cqe*)(cq + params.cq_off.cqes);
+  return true;
+}
+
+void io_uring_queue::reset()
+{
+  if (sqes != nullptr) {
+    munmap(sqes, sqes_sz);
+    sqes = nullptr;
+  }
+  if (ring != nullptr) {
+    munmap(ring, ring_sz);
+    ring = nullptr;
+  }
+  if (ring_fd >= 0) {
+    close(ring_fd);
+    ring_fd = -1;
+  }
+}
+
+io_uring_sqe* io_uring_queue::get_sqe()
+{
+  uint32_t head = __atomic_load_n(sq_khead, __ATOMIC_ACQUIRE);
+  if (sqe_tail - head >= sq_entries) {
+    return nullptr;
+  }
+  io_uring_sqe* sqe = &sqes[sqe_tail & sq_mask];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe_tail++;
+  return sqe;
+}
+
+int io_uring_queue::submit_and_wait(uint32_t wait_nr)
+{
+  uint32_t to_submit = sqe_tail - sqe_head;
+  if (to_submit > 0) {
+    __atomic_store_n(sq_ktail, sqe_tail, __ATOMIC_RELEASE);
+  }
+  if (to_submit == 0 and wait_nr == 0) {
+    return 0;
+  }
+  unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+  int      ret   = (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, wait_nr, flags, nullptr, 0);
+  if (ret < 0) {
+    return -errno;
+  }
+  sqe_head += ret;
+  return ret;
+}
+
+io_uring_buf_ring* io_uring_queue::setup_buf_ring(uint16_t bgid, uint32_t nof_entries)
+{
+  size_t sz = nof_entries * sizeof(io_uring_buf);
+  void*  p  = mmap(nullptr, sz, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  if (p == MAP_FAILED) {
+    return nullptr;
+  }
+  io_uring_buf_ring* br  = (io_uring_buf_ring*)p;
+  io_uring_buf_reg   reg = {};
+  reg.ring_addr          = (uint64_t)(uintptr_t)br;
+  reg.ring_entries       = nof_entries;
+  reg.bgid               = bgid;
+  if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+    munmap(p, sz);
+    return nullptr;
+  }
+  br->tail = 0;
+  return br;
+}
+
+void io_uring_queue::free_buf_ring(io_uring_buf_ring* br, uint16_t bgid, uint32_t nof_entries)
+{
+  io_uring_buf_reg reg = {};
+  reg.bgid             = bgid;
+  syscall(__NR_io_uring_register, ring_fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+  munmap(br, nof_entries * sizeof(io_uring_buf));
+}
+
+void io_uring_queue::prep_read(io_uring_sqe* sqe, int fd, void* buf, uint32_t len, uint64_t user_data)
+{
+  sqe->opcode    = IORING_OP_READ;
+  sqe->fd        = fd;
+  sqe->addr      = (uint64_t)(uintptr_t)buf;
+  sqe->len       = len;
+  sqe->off       = (uint64_t)-1; // current file position, as required by pipes
+  sqe->user_data = user_data;
+}
+
+void io_uring_queue::prep_poll_add(io_uring_sqe* sqe, int fd, uint32_t poll_mask, uint64_t user_data)
+{
+  sqe->opcode        = IORING_OP_POLL_ADD;
+  sqe->fd            = fd;
+  sqe->poll32_events = poll_mask;
+  sqe->user_data     = user_data;
+}
+
+void io_uring_queue::prep_recvmsg_multishot(io_uring_sqe* sqe, int fd, msghdr* msg, uint16_t bgid, uint64_t user_data)
+{
+  sqe->opcode    = IORING_OP_RECVMSG;
+  sqe->fd        = fd;
+  sqe->addr      = (uint64_t)(uintptr_t)msg;
+  sqe->len       = 1;
+  sqe->flags     = IOSQE_BUFFER_SELECT;
+  sqe->buf_group = bgid;
+  sqe->ioprio    = IORING_RECV_MULTISHOT;
+  sqe->user_data = user_data;
+}
+
+void io_uring_queue::prep_cancel(io_uring_sqe* sqe, uint64_t target_user_data, uint64_t user_data)
+{
+  sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+  sqe->fd        = -1;
+  sqe->addr      = target_user_data;
+  sqe->user_data = user_data;
+}
+
+} // namespace srslte
+
+#endif // HAVE_IO_URING
@@ -53,6 +53,18 @@
 *********************************************************************/
 void zero_tailing_bits(uint8* data, uint32 length_bits);
 
+/*********************************************************************
+    Name: milenage_aes_ctx
+
+    Description: Returns the AES round keys of the Milenage key K.
+                 The functions of an authentication all use the same
+                 K, the round keys of the last one are kept by every
+                 thread.
+
+    Document Reference: -
+*********************************************************************/
+static aes_context* milenage_aes_ctx(const uint8* k);
+
 /*******************************************************************************
                               FUNCTIONS
 *******************************************************************************/
@@ -579,11 +591,6 @@ uint32_t GET_WORD(uint32_t* DATA, uint32_t i)
   return WORD;
 }
 
-uint8_t GET_BIT(uint8_t* DATA, uint32_t i)
-{
-  return (DATA[i / 8] & (1 << (7 - (i % 8)))) ? 1 : 0;
-}
-
 LIBLTE_ERROR_ENUM liblte_security_128_eia3(const uint8* key,
                                            uint32       count,
                                            uint8        bearer,
@@ -634,10 +641,21 @@ LIBLTE_ERROR_ENUM liblte_security_128_eia3(const uint8* key,
 
     zuc_generate_keystream(&zuc_state, L, ks);
 
+    // Every set bit i of the message adds the keystream word starting at bit i. The words of the 8 bits of a byte are
+    // all taken from the 64 keystream bits starting at the first one
     uint32_t T = 0;
-    for (uint32_t i = 0; i < msg_len; i++) {
-      if (GET_BIT(msg, i)) {
-        T ^= GET_WORD(ks, i);
+    for (uint32_t i = 0; i < msg_len; i += 8) {
+      uint8_t byte = msg[i / 8];
+      if (msg_len - i < 8) {
+        byte &= (uint8_t)(0xFF << (8 - (msg_len - i)));
+      }
+      if (byte == 0) {
+        continue;
+      }
+      uint64_t w = ((uint64_t)GET_WORD(ks, i) << 32) | GET_WORD(ks, i + 32);
+      for (uint32_t j = 0; j < 8; j++) {
+        // Masked instead of branching, the message bits are not predictable
+        T ^= (uint32_t)(w >> (32 - j)) & -(uint32_t)((byte >> (7 - j)) & 1);
       }
     }
 
@@ -926,7 +944,6 @@ LIBLTE_ERROR_ENUM liblte_security_milenage_f1(uint8* k, uint8* op_c, uint8* rand
 {
   LIBLTE_ERROR_ENUM err = LIBLTE_ERROR_INVALID_INPUTS;
   uint32            i;
-  aes_context       ctx;
   uint8             temp[16];
   uint8             in1[16];
   uint8             out1[16];
@@ -934,13 +951,13 @@ LIBLTE_ERROR_ENUM liblte_security_milenage_f1(uint8* k, uint8* op_c, uint8* rand
 
   if (k != NULL && op_c != NULL && rand != NULL && sqn != NULL && amf != NULL && mac_a != NULL) {
     // Initialize the round keys
-    aes_setkey_enc(&ctx, k, 128);
+    aes_context* ctx = milenage_aes_ctx(k);
 
     // Compute temp
     for (i = 0; i < 16; i++) {
       input[i] = rand[i] ^ op_c[i];
     }
-    aes_crypt_ecb(&ctx, AES_ENCRYPT, input, temp);
+    aes_crypt_ecb(ctx, AES_ENCRYPT, input, temp);
 
     // Construct in1
     for (i = 0; i < 6; i++) {
@@ -959,7 +976,7 @@ LIBLTE_ERROR_ENUM liblte_security_milenage_f1(uint8* k, uint8* op_c, uint8* rand
     for (i = 0; i < 16; i++) {
       input[i] ^= temp[i];
     }
-    aes_crypt_ecb(&ctx, AES_ENCRYPT, input, out1);
+    aes_crypt_ecb(ctx, AES_ENCRYPT, input, out1);
     for (i = 0; i < 16; i++) {
       out1[i] ^= op_c[i];
     }
@@ -989,7 +1006,6 @@ LIBLTE_ERROR_ENUM
 liblte_security_milenage_f1_star(uint8* k, uint8* op_c, uint8* rand, uint8* sqn, uint8* amf, uint8* mac_s)
 {
   LIBLTE_ERROR_ENUM err = LIBLTE_ERROR_INVALID_INPUTS;
-  aes_context       ctx;
   uint32            i;
   uint8             temp[16];
   uint8             in1[16];
@@ -998,13 +1014,13 @@ liblte_security_milenage_f1_star(uint8* k, uint8* op_c, uint8* rand, uint8* sqn,
 
   if (k != NULL && op_c != NULL && rand != NULL && sqn != NULL && amf != NULL && mac_s != NULL) {
     // Initialize the round keys
-    aes_setkey_enc(&ctx, k, 128);
+    aes_context* ctx = milenage_aes_ctx(k);
 
     // Compute temp
     for (i = 0; i < 16; i++) {
       input[i] = rand[i] ^ op_c[i];
     }
-    aes_crypt_ecb(&ctx, AES_ENCRYPT, input, temp);
+    aes_crypt_ecb(ctx, AES_ENCRYPT, input, temp);
     // Construct in1
     for (i = 0; i < 6; i++) {
       in1[i]     = sqn[i];
@@ -1022,7 +1038,7 @@ liblte_security_milenage_f1_star(uint8* k, uint8* op_c, uint8* rand, uint8* sqn,
     for (i = 0; i < 16; i++) {
       input[i] ^= temp[i];
     }
-    aes_crypt_ecb(&ctx, AES_ENCRYPT, input, out1);
+    aes_crypt_ecb(ctx, AES_ENCRYPT, input, out1);
     for (i = 0; i < 16; i++) {
       out1[i] ^= op_c[i];
     }
@@ -1056,22 +1072,21 @@ liblte_security_milenage_f2345(uint8* k, uint8* op_c, uint8* rand, uint8* res, u
   uint8             temp[16];
   uint8             out[16];
   uint8             input[16];
-  aes_context       ctx;
 
   if (k != NULL && op_c != NULL && rand != NULL && res != NULL && ck != NULL && ik != NULL && ak != NULL) {
     // Initialize the round keys
-    aes_setkey_enc(&ctx, k, 128);
+    aes_context* ctx = milenage_aes_ctx(k);
     // Compute temp
     for (i = 0; i < 16; i++) {
       input[i] = rand[i] ^ op_c[i];
     }
-    mbedtls_aes_crypt_ecb(&ctx, AES_ENCRYPT, input, temp);
+    mbedtls_aes_crypt_ecb(ctx, AES_ENCRYPT, input, temp);
     // Compute out for RES and AK
     for (i = 0; i < 16; i++) {
       input[i] = temp[i] ^ op_c[i];
     }
     input[15] ^= 1;
-    mbedtls_aes_crypt_ecb(&ctx, AES_ENCRYPT, input, out);
+    mbedtls_aes_crypt_ecb(ctx, AES_ENCRYPT, input, out);
     for (i = 0; i < 16; i++) {
       out[i] ^= op_c[i];
     }
@@ -1091,7 +1106,7 @@ liblte_security_milenage_f2345(uint8* k, uint8* op_c, uint8* rand, uint8* res, u
       input[(i + 12) % 16] = temp[i] ^ op_c[i];
     }
     input[15] ^= 2;
-    mbedtls_aes_crypt_ecb(&ctx, AES_ENCRYPT, input, out);
+    mbedtls_aes_crypt_ecb(ctx, AES_ENCRYPT, input, out);
     for (i = 0; i < 16; i++) {
       out[i] ^= op_c[i];
     }
@@ -1106,7 +1121,7 @@ liblte_security_milenage_f2345(uint8* k, uint8* op_c, uint8* rand, uint8* res, u
       input[(i + 8) % 16] = temp[i] ^ op_c[i];
     }
     input[15] ^= 4;
-    mbedtls_aes_crypt_ecb(&ctx, AES_ENCRYPT, input, out);
+    mbedtls_aes_crypt_ecb(ctx, AES_ENCRYPT, input, out);
     for (i = 0; i < 16; i++) {
       out[i] ^= op_c[i];
     }
@@ -1134,7 +1149,6 @@ liblte_security_milenage_f2345(uint8* k, uint8* op_c, uint8* rand, uint8* res, u
 LIBLTE_ERROR_ENUM liblte_security_milenage_f5_star(uint8* k, uint8* op_c, uint8* rand, uint8* ak)
 {
   LIBLTE_ERROR_ENUM err = LIBLTE_ERROR_INVALID_INPUTS;
-  aes_context       ctx;
   uint32            i;
   uint8             temp[16];
   uint8             out[16];
@@ -1142,19 +1156,19 @@ LIBLTE_ERROR_ENUM liblte_security_milenage_f5_star(uint8* k, uint8* op_c, uint8*
 
   if (k != NULL && op_c != NULL && rand != NULL && ak != NULL) {
     // Initialize the round keys
-    aes_setkey_enc(&ctx, k, 128);
+    aes_context* ctx = milenage_aes_ctx(k);
 
     // Compute temp
     for (i = 0; i < 16; i++) {
       input[i] = rand[i] ^ op_c[i];
     }
-    aes_crypt_ecb(&ctx, AES_ENCRYPT, input, temp);
+    aes_crypt_ecb(ctx, AES_ENCRYPT, input, temp);
     // Compute out
     for (i = 0; i < 16; i++) {
       input[(i + 4) % 16] = temp[i] ^ op_c[i];
     }
     input[15] ^= 8;
-    aes_crypt_ecb(&ctx, AES_ENCRYPT, input, out);
+    aes_crypt_ecb(ctx, AES_ENCRYPT, input, out);
     for (i = 0; i < 16; i++) {
       out[i] ^= op_c[i];
     }
@@ -1179,12 +1193,11 @@ LIBLTE_ERROR_ENUM liblte_security_milenage_f5_star(uint8* k, uint8* op_c, uint8*
 LIBLTE_ERROR_ENUM liblte_compute_opc(uint8* k, uint8* op, uint8* op_c)
 {
   uint32            i;
-  aes_context       ctx;
   LIBLTE_ERROR_ENUM err = LIBLTE_ERROR_INVALID_INPUTS;
 
   if (k != NULL && op != NULL && op_c != NULL) {
-    aes_setkey_enc(&ctx, k, 128);
-    aes_crypt_ecb(&ctx, AES_ENCRYPT, op, op_c);
+    aes_context* ctx = milenage_aes_ctx(k);
+    aes_crypt_ecb(ctx, AES_ENCRYPT, op, op_c);
     for (i = 0; i < 16; i++) {
       op_c[i] ^= op[i];
     }
@@ -1205,3 +1218,24 @@ void zero_tailing_bits(uint8* data, uint32 length_bits)
   uint8 bits = (8 - (length_bits & 0x07)) & 0x07;
   data[(length_bits + 7) / 8 - 1] &= (uint8)(0xFF << bits);
 }
+
+/*********************************************************************
+    Name: milenage_aes_ctx
+
+    Description: Returns the AES round keys of the Milenage key K.
+
+    Document Reference: -
+*********************************************************************/
+aes_context* milenage_aes_ctx(const uint8* k)
+{
+  static thread_local aes_context ctx;
+  static thread_local uint8       cur_k[16];
+  static thread_local bool        valid = false;
+
+  if (!valid || memcmp(cur_k, k, 16) != 0) {
+    aes_setkey_enc(&ctx, k, 128);
+    memcpy(cur_k, k, 16);
+    valid = true;
+  }
+  return &ctx;
+}
@@ -25,11 +25,11 @@
 
 namespace srslte {
 
-mac_nr_pcap::mac_nr_pcap() {}
+mac_nr_pcap::mac_nr_pcap() : writer("MAC_NR_PCAP") {}
 
 mac_nr_pcap::~mac_nr_pcap()
 {
-  if (pcap_file) {
+  if (writer.is_open()) {
     close();
   }
 }
@@ -42,7 +42,7 @@ void mac_nr_pcap::open(const std::string& filename_, const uint16_t& ue_id_)
 {
   fprintf(stdout, "Opening MAC-NR PCAP with DLT=%d\n", UDP_DLT);
   filename     = filename_;
-  pcap_file    = LTE_PCAP_Open(UDP_DLT, filename.c_str());
+  writer.open(UDP_DLT, filename);
   ue_id        = ue_id_;
   enable_write = true;
 }
@@ -50,8 +50,7 @@ void mac_nr_pcap::close()
 {
   enable_write = false;
   fprintf(stdout, "Saving MAC-NR PCAP to %s\n", filename.c_str());
-  LTE_PCAP_Close(pcap_file);
-  pcap_file = nullptr;
+  writer.close();
 }
 
 void mac_nr_pcap::set_ue_id(const uint16_t& ue_id_)
@@ -79,7 +78,9 @@ void mac_nr_pcap::pack_and_write(uint8_t* pdu,
     context.sub_frame_number      = tti % 10;
 
     if (pdu) {
-      NR_PCAP_MAC_WritePDU(pcap_file, &context, pdu, pdu_len_bytes);
+      uint8_t context_header[PCAP_CONTEXT_HEADER_MAX];
+      int     context_len = NR_PCAP_MAC_PackContext(&context, pdu_len_bytes, context_header);
+      writer.write(context_header, context_len, pdu, pdu_len_bytes);
     }
   }
 }
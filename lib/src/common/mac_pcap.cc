@@ -27,7 +27,7 @@
 
 namespace srslte {
 
-mac_pcap::mac_pcap() : enable_write(false), ue_id(0), pcap_file(nullptr) {}
+mac_pcap::mac_pcap() : enable_write(false), writer("MAC_PCAP"), ue_id(0) {}
 
 mac_pcap::~mac_pcap()
 {
@@ -38,19 +38,18 @@ void mac_pcap::enable(bool en)
 {
   enable_write = true;
 }
-void mac_pcap::open(const char* filename, uint32_t ue_id)
+void mac_pcap::open(const char* filename, uint32_t ue_id, const pcap_rotation_t& rotation)
 {
-  pcap_file    = LTE_PCAP_Open(MAC_LTE_DLT, filename);
+  writer.open(MAC_LTE_DLT, filename, rotation);
   this->ue_id  = ue_id;
   enable_write = true;
 }
 void mac_pcap::close()
 {
   enable_write = false;
-  if (pcap_file != nullptr) {
+  if (writer.is_open()) {
     fprintf(stdout, "Saving MAC PCAP file\n");
-    LTE_PCAP_Close(pcap_file);
-    pcap_file = nullptr;
+    writer.close();
   }
 }
 
@@ -82,7 +81,9 @@ void mac_pcap::pack_and_write(uint8_t* pdu,
     context.sysFrameNumber     = (uint16_t)(tti / 10);
     context.subFrameNumber     = (uint16_t)(tti % 10);
     if (pdu) {
-      LTE_PCAP_MAC_WritePDU(pcap_file, &context, pdu, pdu_len_bytes);
+      uint8_t context_header[PCAP_CONTEXT_HEADER_MAX];
+      int     context_len = LTE_PCAP_MAC_PackContext(&context, context_header);
+      writer.write(context_header, context_len, pdu, pdu_len_bytes);
     }
   }
 }
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/metrics_http_server.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace srslte {
+
+namespace {
+
+/// Largest request header accepted
+const size_t max_request_size = 8192;
+
+void send_all(int fd, const std::string& data)
+{
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      return;
+    }
+    sent += n;
+  }
+}
+
+void send_response(int fd, const char* status, const char* content_type, const std::string& body)
+{
+  char header[256];
+  snprintf(header,
+           sizeof(header),
+           "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+           status,
+           content_type,
+           body.size());
+  send_all(fd, header + body);
+}
+
+} // namespace
+
+metrics_http_server::~metrics_http_server()
+{
+  stop();
+}
+
+bool metrics_http_server::init(const std::string& address, uint16_t port_, std::function<std::string()> handler_)
+{
+  handler = std::move(handler_);
+
+  sockaddr_in addr = {};
+  addr.sin_family  = AF_INET;
+  addr.sin_port    = htons(port_);
+  if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+    fprintf(stderr, "Invalid metrics HTTP address %s\n", address.c_str());
+    return false;
+  }
+
+  listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd < 0) {
+    perror("socket");
+    return false;
+  }
+  int enable = 1;
+  setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) != 0 or listen(listen_fd, 8) != 0) {
+    fprintf(stderr, "Listening for metrics scrapes on %s:%d: %s\n", address.c_str(), port_, strerror(errno));
+    close(listen_fd);
+    listen_fd = -1;
+    return false;
+  }
+
+  socklen_t len = sizeof(addr);
+  getsockname(listen_fd, (sockaddr*)&addr, &len);
+  port = ntohs(addr.sin_port);
+
+  running = true;
+  start(-1);
+  return true;
+}
+
+void metrics_http_server::stop()
+{
+  if (running) {
+    running = false;
+    wait_thread_finish();
+  }
+  if (listen_fd >= 0) {
+    close(listen_fd);
+    listen_fd = -1;
+  }
+}
+
+void metrics_http_server::run_thread()
+{
+  while (running) {
+    // Wake up periodically to check whether the server is stopped
+    pollfd p = {listen_fd, POLLIN, 0};
+    if (poll(&p, 1, 100) <= 0) {
+      continue;
+    }
+    int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      continue;
+    }
+    // A client that does not send its request in time does not block the scrapes of the others
+    timeval timeout = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    serve(fd);
+    close(fd);
+  }
+}
+
+void metrics_http_server::serve(int fd)
+{
+  std::string request;
+  char        buffer[1024];
+  while (request.find("\r\n\r\n") == std::string::npos) {
+    if (request.size() > max_request_size) {
+      send_response(fd, "431 Request Header Fields Too Large", "text/plain", "");
+      return;
+    }
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) {
+      return;
+    }
+    request.append(buffer, n);
+  }
+
+  // Request line: <method> <target> <version>
+  size_t method_end = request.find(' ');
+  if (method_end == std::string::npos) {
+    send_response(fd, "400 Bad Request", "text/plain", "");
+    return;
+  }
+  size_t      target_end = request.find_first_of(" ?\r", method_end + 1);
+  std::string method     = request.substr(0, method_end);
+  std::string target     = request.substr(method_end + 1, target_end - method_end - 1);
+
+  if (method != "GET") {
+    send_response(fd, "405 Method Not Allowed", "text/plain", "");
+  } else if (target != "/metrics") {
+    send_response(fd, "404 Not Found", "text/plain", "Metrics are served at /metrics\n");
+  } else {
+    send_response(fd, "200 OK", "text/plain; version=0.0.4; charset=utf-8", handler());
+  }
+}
+
+} // namespace srslte
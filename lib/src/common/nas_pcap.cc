@@ -30,24 +30,24 @@ void nas_pcap::enable()
 {
   enable_write = true;
 }
-void nas_pcap::open(const char* filename, uint32_t ue_id_)
+void nas_pcap::open(const char* filename, uint32_t ue_id_, const pcap_rotation_t& rotation)
 {
-  pcap_file    = LTE_PCAP_Open(NAS_LTE_DLT, filename);
+  writer.open(NAS_LTE_DLT, filename, rotation);
   ue_id        = ue_id_;
   enable_write = true;
 }
 void nas_pcap::close()
 {
   fprintf(stdout, "Saving NAS PCAP file (DLT=%d)\n", NAS_LTE_DLT);
-  LTE_PCAP_Close(pcap_file);
+  writer.close();
 }
 
 void nas_pcap::write_nas(uint8_t* pdu, uint32_t pdu_len_bytes)
 {
   if (enable_write) {
-    NAS_Context_Info_t context;
+    // NAS PDUs have no context
     if (pdu) {
-      LTE_PCAP_NAS_WritePDU(pcap_file, &context, pdu, pdu_len_bytes);
+      writer.write(nullptr, 0, pdu, pdu_len_bytes);
     }
   }
 }
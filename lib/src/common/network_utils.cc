@@ -20,8 +20,14 @@
  */
 
 #include "srslte/common/network_utils.h"
+#include "srslte/common/epoll_helper.h"
+#include "srslte/common/io_uring.h"
+#include "srslte/common/latency_histogram.h"
 
+#include <algorithm>
+#include <array>
 #include <netinet/sctp.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 
@@ -360,14 +366,15 @@ int tcp_send(int remotefd, const void* buf, size_t nbytes)
  **************************************************************/
 
 /**
- * Description: Specialization of recv_task for the case the received data is
- * in the form of unique_byte_buffer, and a recvfrom(...) call is used
+ * Description: Specialization of recv_task for datagram sockets. Each recvmmsg(...) call reads up to
+ * MAX_RECV_BATCH packets into buffers reserved from the pool beforehand, and the packets are passed to the callback
+ * as a single batch
  */
-class recvfrom_pdu_task final : public rx_multisocket_handler::recv_task
+class recvmmsg_pdu_task final : public rx_multisocket_handler::recv_task
 {
 public:
-  using callback_t = std::function<void(srslte::unique_byte_buffer_t pdu, const sockaddr_in& from)>;
-  explicit recvfrom_pdu_task(srslte::byte_buffer_pool* pool_, srslte::log_ref log_, callback_t func_) :
+  using callback_t = rx_multisocket_handler::recvfrom_batch_callback_t;
+  explicit recvmmsg_pdu_task(srslte::byte_buffer_pool* pool_, srslte::log_ref log_, callback_t func_) :
     pool(pool_),
     log_h(log_),
     func(std::move(func_))
@@ -376,29 +383,56 @@ public:
 
   bool operator()(int fd) override
   {
-    srslte::unique_byte_buffer_t pdu     = srslte::allocate_unique_buffer(*pool, "Rxsocket", true);
-    sockaddr_in                  from    = {};
-    socklen_t                    fromlen = sizeof(from);
+    for (uint32_t i = 0; i < MAX_BATCH; ++i) {
+      // the buffers handed to the callback in the previous call are replaced
+      if (pdus[i] == nullptr) {
+        pdus[i] = srslte::allocate_unique_buffer(*pool, "Rxsocket", true);
+      }
+      iovs[i].iov_base            = pdus[i]->msg;
+      iovs[i].iov_len             = pdus[i]->get_tailroom();
+      msgs[i].msg_hdr             = {};
+      msgs[i].msg_hdr.msg_name    = &addrs[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+      msgs[i].msg_hdr.msg_iov     = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen  = 1;
+    }
 
-    ssize_t n_recv = recvfrom(fd, pdu->msg, pdu->get_tailroom(), 0, (struct sockaddr*)&from, &fromlen);
-    if (n_recv == -1 and errno != EAGAIN) {
+    // the socket is readable, so this returns at least one packet unless it was consumed by someone else
+    int n_recv = recvmmsg(fd, msgs.data(), MAX_BATCH, MSG_DONTWAIT, nullptr);
+    if (n_recv == -1 and errno != EAGAIN and errno != EWOULDBLOCK) {
       log_h->error("Error reading from socket: %s\n", strerror(errno));
       return true;
     }
-    if (n_recv == -1 and errno == EAGAIN) {
+    if (n_recv <= 0) {
       log_h->debug("Socket timeout reached\n");
       return true;
     }
 
-    pdu->N_bytes = static_cast<uint32_t>(n_recv);
-    func(std::move(pdu), from);
+    // the packets of the batch share the reception time of the latency metrics
+    uint64_t                                 rx_ns = latency_clock_ns();
+    rx_multisocket_handler::recvfrom_batch_t batch(n_recv);
+    for (int i = 0; i < n_recv; ++i) {
+      pdus[i]->N_bytes  = msgs[i].msg_len;
+      pdus[i]->md.rx_ns = rx_ns;
+      batch[i].pdu      = std::move(pdus[i]);
+      batch[i].from     = addrs[i];
+    }
+    func(std::move(batch));
     return true;
   }
 
+  callback_t* get_batch_callback() override { return &func; }
+
 private:
-  srslte::byte_buffer_pool* pool = nullptr;
-  srslte::log_ref           log_h;
-  callback_t                func;
+  static const uint32_t MAX_BATCH = rx_multisocket_handler::MAX_RECV_BATCH;
+
+  srslte::byte_buffer_pool*                           pool = nullptr;
+  srslte::log_ref                                     log_h;
+  callback_t                                          func;
+  std::array<srslte::unique_byte_buffer_t, MAX_BATCH> pdus;
+  std::array<mmsghdr, MAX_BATCH>                      msgs;
+  std::array<iovec, MAX_BATCH>                        iovs;
+  std::array<sockaddr_in, MAX_BATCH>                  addrs;
 };
 
 class sctp_recvmsg_pdu_task final : public rx_multisocket_handler::recv_task
@@ -415,47 +449,128 @@ public:
 
   bool operator()(int fd) override
   {
-    // inside rx_sockets thread. Read socket
-    srslte::unique_byte_buffer_t pdu     = srslte::allocate_unique_buffer(*pool, "Rxsocket", true);
-    sockaddr_in                  from    = {};
-    socklen_t                    fromlen = sizeof(from);
-    sctp_sndrcvinfo              sri     = {};
-    int                          flags   = 0;
-    ssize_t n_recv = sctp_recvmsg(fd, pdu->msg, pdu->get_tailroom(), (struct sockaddr*)&from, &fromlen, &sri, &flags);
-    if (n_recv == -1 and errno != EAGAIN) {
-      log_h->error("Error reading from SCTP socket: %s\n", strerror(errno));
-      return true;
-    }
-    if (n_recv == -1 and errno == EAGAIN) {
-      log_h->debug("Socket timeout reached\n");
-      return true;
-    }
+    // inside rx_sockets thread. Read the messages that are already queued in the socket, up to a batch, so that a burst
+    // of S1AP messages does not take a wake up per message
+    for (uint32_t i = 0; i < MAX_BATCH; ++i) {
+      srslte::unique_byte_buffer_t pdu   = srslte::allocate_unique_buffer(*pool, "Rxsocket", true);
+      sockaddr_in                  from  = {};
+      sctp_sndrcvinfo              sri   = {};
+      int                          flags = 0;
+      ssize_t n_recv = recv_sctp(fd, pdu.get(), &from, &sri, &flags, i == 0 ? 0 : MSG_DONTWAIT);
+      if (n_recv == -1 and errno != EAGAIN and errno != EWOULDBLOCK) {
+        log_h->error("Error reading from SCTP socket: %s\n", strerror(errno));
+        return true;
+      }
+      if (n_recv == -1) {
+        log_h->debug("Socket timeout reached\n");
+        return true;
+      }
 
-    bool ret     = true;
-    pdu->N_bytes = static_cast<uint32_t>(n_recv);
-    if (flags & MSG_NOTIFICATION) {
-      // Received notification
-      union sctp_notification* notification = (union sctp_notification*)pdu->msg;
-      if (notification->sn_header.sn_type == SCTP_SHUTDOWN_EVENT) {
-        // Socket Shutdown
-        ret = false;
+      bool ret     = true;
+      pdu->N_bytes = static_cast<uint32_t>(n_recv);
+      if (flags & MSG_NOTIFICATION) {
+        // Received notification
+        union sctp_notification* notification = (union sctp_notification*)pdu->msg;
+        if (notification->sn_header.sn_type == SCTP_SHUTDOWN_EVENT) {
+          // Socket Shutdown
+          ret = false;
+        }
+      }
+      func(std::move(pdu), from, sri, flags);
+      if (not ret or n_recv == 0) {
+        return ret;
       }
     }
-    func(std::move(pdu), from, sri, flags);
-    return ret;
+    return true;
   }
 
 private:
+  static const uint32_t MAX_BATCH = rx_multisocket_handler::MAX_RECV_BATCH;
+
+  // sctp_recvmsg() with the flags of recvmsg()
+  static ssize_t
+  recv_sctp(int fd, srslte::byte_buffer_t* pdu, sockaddr_in* from, sctp_sndrcvinfo* sri, int* flags, int recv_flags)
+  {
+    iovec  iov                                           = {pdu->msg, pdu->get_tailroom()};
+    char   cmsg_buf[CMSG_SPACE(sizeof(sctp_sndrcvinfo))] = {};
+    msghdr msg                                           = {};
+    msg.msg_name                                         = from;
+    msg.msg_namelen                                      = sizeof(*from);
+    msg.msg_iov                                          = &iov;
+    msg.msg_iovlen                                       = 1;
+    msg.msg_control                                      = cmsg_buf;
+    msg.msg_controllen                                   = sizeof(cmsg_buf);
+
+    ssize_t n_recv = recvmsg(fd, &msg, recv_flags);
+    if (n_recv < 0) {
+      return n_recv;
+    }
+    *flags = msg.msg_flags;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level == IPPROTO_SCTP and cmsg->cmsg_type == SCTP_SNDRCV) {
+        memcpy(sri, CMSG_DATA(cmsg), sizeof(*sri));
+      }
+    }
+    return n_recv;
+  }
+
   srslte::byte_buffer_pool* pool = nullptr;
   srslte::log_ref           log_h;
   callback_t                func;
 };
 
+#ifdef HAVE_IO_URING
+
+// user_data of the ring operations that are not socket reads
+static const uint64_t URING_CTRL_USER_DATA   = 0;
+static const uint64_t URING_CANCEL_USER_DATA = 1;
+static const uint32_t URING_NOF_ENTRIES      = 256;
+
+/**
+ * Socket registered in the ring. Datagram sockets own a ring of pool buffers that the kernel fills through a
+ * multishot recvmsg. The other sockets are polled, and read by their recv_task
+ */
+struct rx_multisocket_handler::uring_socket_t {
+  static const uint32_t NOF_BUFS = 2 * MAX_RECV_BATCH;
+
+  int                                                fd         = -1;
+  recv_task*                                         task       = nullptr;
+  recvfrom_batch_callback_t*                         batch_func = nullptr;
+  bool                                               in_flight  = false; // the read or poll request is in the ring
+  bool                                               ready      = false; // queued in uring_ready
+  bool                                               removed    = false;
+  uint16_t                                           bgid       = 0;
+  io_uring_buf_ring*                                 buf_ring   = nullptr;
+  std::array<srslte::unique_byte_buffer_t, NOF_BUFS> bufs;
+  msghdr                                             msg = {};
+  recvfrom_batch_t                                   batch;
+};
+
+// Next submission entry, submitting the queued ones first if the queue is full
+static io_uring_sqe* uring_get_sqe(io_uring_queue& q)
+{
+  io_uring_sqe* sqe = q.get_sqe();
+  if (sqe == nullptr) {
+    q.submit_and_wait(0);
+    sqe = q.get_sqe();
+  }
+  return sqe;
+}
+
+#else
+
+struct rx_multisocket_handler::uring_socket_t {};
+
+#endif // HAVE_IO_URING
+
 /***************************************************************
  *                 Rx Multisocket Handler
  **************************************************************/
 
-rx_multisocket_handler::rx_multisocket_handler(std::string name_, srslte::log_ref log_, int thread_prio) :
+rx_multisocket_handler::rx_multisocket_handler(std::string     name_,
+                                               srslte::log_ref log_,
+                                               int             thread_prio,
+                                               bool            use_io_uring) :
   thread(name_),
   name(std::move(name_)),
   log_h(log_)
@@ -466,6 +581,26 @@ rx_multisocket_handler::rx_multisocket_handler(std::string name_, srslte::log_re
     rxSockInfo("Failed to open control pipe\n");
     return;
   }
+#ifdef HAVE_IO_URING
+  if (use_io_uring) {
+    uring.reset(new io_uring_queue);
+    if (not uring->init(URING_NOF_ENTRIES)) {
+      rxSockWarn("io_uring is not supported by the kernel, using epoll instead\n");
+      uring.reset();
+    }
+  }
+#else
+  if (use_io_uring) {
+    rxSockWarn("Built without io_uring support, using epoll instead\n");
+  }
+#endif
+  if (uring == nullptr) {
+    epoll_fd = epoll_create1(0);
+    if (epoll_fd == -1 or add_epoll(pipefd[0], epoll_fd) != SRSLTE_SUCCESS) {
+      rxSockError("Failed to create epoll instance: %s\n", strerror(errno));
+      return;
+    }
+  }
   start(thread_prio);
 }
 
@@ -490,6 +625,11 @@ void rx_multisocket_handler::stop()
     wait_thread_finish();
   }
 
+  uring.reset();
+  if (epoll_fd >= 0) {
+    close(epoll_fd);
+    epoll_fd = -1;
+  }
   if (pipefd[0] >= 0) {
     close(pipefd[0]);
     close(pipefd[1]);
@@ -504,9 +644,12 @@ void rx_multisocket_handler::stop()
  */
 bool rx_multisocket_handler::add_socket_pdu_handler(int fd, recvfrom_callback_t pdu_task)
 {
-  std::unique_ptr<srslte::rx_multisocket_handler::recv_task> task;
-  task.reset(new srslte::recvfrom_pdu_task(pool, log_h, std::move(pdu_task)));
-  return add_socket_handler(fd, std::move(task));
+  auto batch_task = [pdu_task](recvfrom_batch_t batch) {
+    for (rx_datagram_t& d : batch) {
+      pdu_task(std::move(d.pdu), d.from);
+    }
+  };
+  return add_socket_pdu_batch_handler(fd, std::move(batch_task));
 }
 
 /**
@@ -519,6 +662,16 @@ bool rx_multisocket_handler::add_socket_sctp_pdu_handler(int fd, sctp_recv_callb
   return add_socket_handler(fd, std::move(task));
 }
 
+/**
+ * Convenience method for reading batches of PDUs from a datagram socket
+ */
+bool rx_multisocket_handler::add_socket_pdu_batch_handler(int fd, recvfrom_batch_callback_t batch_task)
+{
+  srslte::rx_multisocket_handler::task_callback_t task;
+  task.reset(new srslte::recvmmsg_pdu_task(pool, log_h, std::move(batch_task)));
+  return add_socket_handler(fd, std::move(task));
+}
+
 bool rx_multisocket_handler::add_socket_handler(int fd, task_callback_t handler)
 {
   std::lock_guard<std::mutex> lock(socket_mutex);
@@ -531,16 +684,21 @@ bool rx_multisocket_handler::add_socket_handler(int fd, task_callback_t handler)
     return false;
   }
 
-  active_sockets.insert(std::pair<const int, task_callback_t>(fd, std::move(handler)));
-
-  // this unlocks the reading thread to add new connections
-  ctrl_cmd_t msg;
-  msg.cmd    = ctrl_cmd_t::cmd_id_t::NEW_FD;
-  msg.new_fd = fd;
-  if (write(pipefd[1], &msg, sizeof(msg)) != sizeof(msg)) {
-    rxSockError("while writing to control pipe\n");
+  if (uring != nullptr) {
+    // only the handler thread submits to the ring
+    ctrl_cmd_t msg;
+    msg.cmd    = ctrl_cmd_t::cmd_id_t::ADD_FD;
+    msg.new_fd = fd;
+    if (write(pipefd[1], &msg, sizeof(msg)) != sizeof(msg)) {
+      rxSockError("while writing to control pipe\n");
+      return false;
+    }
+  } else if (add_epoll(fd, epoll_fd) != SRSLTE_SUCCESS) {
+    // epoll_ctl can be called while the reading thread waits in epoll_wait
+    rxSockError("Failed to add fd=%d to the epoll instance\n", fd);
     return false;
   }
+  active_sockets.insert(std::pair<const int, task_callback_t>(fd, std::move(handler)));
 
   rxSockDebug("socket fd=%d has been registered.\n", fd);
   return true;
@@ -565,41 +723,47 @@ bool rx_multisocket_handler::remove_socket(int fd)
   return true;
 }
 
-bool rx_multisocket_handler::remove_socket_unprotected(int fd, fd_set* total_fd_set, int* max_fd)
+bool rx_multisocket_handler::remove_socket_unprotected(int fd)
 {
   if (fd < 0) {
     rxSockError("fd to be removed is not valid\n");
     return false;
   }
   active_sockets.erase(fd);
-  FD_CLR(fd, total_fd_set);
-  // assumes ordering
-  *max_fd = (active_sockets.empty()) ? pipefd[0] : std::max(pipefd[0], active_sockets.rbegin()->first);
+#ifdef HAVE_IO_URING
+  if (uring != nullptr) {
+    uring_remove_socket(fd);
+    rxSockDebug("Socket fd=%d has been successfully removed\n", fd);
+    return true;
+  }
+#endif
+  // fails harmlessly if the socket was already closed, which also removes it from the epoll instance
+  epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
   rxSockDebug("Socket fd=%d has been successfully removed\n", fd);
   return true;
 }
 
 void rx_multisocket_handler::run_thread()
 {
-  running = true;
-  fd_set total_fd_set, read_fd_set;
-  FD_ZERO(&total_fd_set);
-  int max_fd = 0;
+#ifdef HAVE_IO_URING
+  if (uring != nullptr) {
+    run_uring_thread();
+    return;
+  }
+#endif
 
-  FD_SET(pipefd[0], &total_fd_set);
-  max_fd = std::max(pipefd[0], max_fd);
+  const int   max_events = 16;
+  epoll_event events[max_events];
 
+  running = true;
   while (running) {
-    memcpy(&read_fd_set, &total_fd_set, sizeof(total_fd_set));
-    int n = select(max_fd + 1, &read_fd_set, nullptr, nullptr, nullptr);
+    int n = epoll_wait(epoll_fd, events, max_events, -1);
 
-    // handle select return
+    // handle epoll_wait return
     if (n == -1) {
-      rxSockError("Error from select(%d,...). Number of rx sockets: %d", max_fd + 1, (int)active_sockets.size() + 1);
-      continue;
-    }
-    if (n == 0) {
-      rxSockDebug("No data from select.\n");
+      if (errno != EINTR) {
+        rxSockError("Error from epoll_wait. Number of rx sockets: %d\n", (int)active_sockets.size() + 1);
+      }
       continue;
     }
 
@@ -607,21 +771,25 @@ void rx_multisocket_handler::run_thread()
     std::lock_guard<std::mutex> lock(socket_mutex);
 
     // call read callback for all SCTP/TCP/UDP connections
-    for (auto& handler_pair : active_sockets) {
-      int        fd       = handler_pair.first;
-      recv_task* callback = handler_pair.second.get();
-      if (not FD_ISSET(fd, &read_fd_set)) {
+    for (int i = 0; i < n; ++i) {
+      int  fd = events[i].data.fd;
+      auto it = active_sockets.find(fd);
+      if (it == active_sockets.end()) {
+        // the control pipe, or a socket removed by a previous control message
         continue;
       }
-      bool socket_valid = callback->operator()(fd);
+      bool socket_valid = it->second->operator()(fd);
       if (not socket_valid) {
         rxSockInfo("The socket fd=%d has been closed by peer\n", fd);
-        remove_socket_unprotected(fd, &total_fd_set, &max_fd);
+        remove_socket_unprotected(fd);
       }
     }
 
     // handle ctrl messages
-    if (FD_ISSET(pipefd[0], &read_fd_set)) {
+    for (int i = 0; i < n; ++i) {
+      if (events[i].data.fd != pipefd[0]) {
+        continue;
+      }
       ctrl_cmd_t msg;
       ssize_t    nrd = read(pipefd[0], &msg, sizeof(msg));
       if (nrd <= 0) {
@@ -632,17 +800,8 @@ void rx_multisocket_handler::run_thread()
         case ctrl_cmd_t::cmd_id_t::EXIT:
           running = false;
           return;
-        case ctrl_cmd_t::cmd_id_t::NEW_FD:
-          if (msg.new_fd >= 0) {
-            FD_SET(msg.new_fd, &total_fd_set);
-            max_fd = std::max(max_fd, msg.new_fd);
-          } else {
-            rxSockError("added fd is not valid\n");
-          }
-          break;
         case ctrl_cmd_t::cmd_id_t::RM_FD:
-          remove_socket_unprotected(msg.new_fd, &total_fd_set, &max_fd);
-          rxSockDebug("Socket fd=%d has been successfully removed\n", msg.new_fd);
+          remove_socket_unprotected(msg.new_fd);
           break;
         default:
           rxSockError("ctrl message command %d is not valid\n", (int)msg.cmd);
@@ -651,4 +810,235 @@ void rx_multisocket_handler::run_thread()
   }
 }
 
+#ifdef HAVE_IO_URING
+
+/***************************************************************
+ *                 Rx Multisocket io_uring Backend
+ **************************************************************/
+
+void rx_multisocket_handler::run_uring_thread()
+{
+  running = true;
+  uring_arm_ctrl();
+  while (running) {
+    int ret = uring->submit_and_wait(1);
+    if (ret < 0 and ret != -EINTR and ret != -EBUSY) {
+      rxSockError("Error from io_uring_enter: %s\n", strerror(-ret));
+      continue;
+    }
+
+    // Shared state area
+    std::lock_guard<std::mutex> lock(socket_mutex);
+
+    uring->for_each_cqe([this](const io_uring_cqe& cqe) { uring_handle_cqe(cqe.user_data, cqe.res, cqe.flags); });
+
+    // the packets received in this wakeup are passed to the task as a single batch per socket
+    for (uring_socket_t* s : uring_ready) {
+      s->ready = false;
+      if (s->removed) {
+        continue;
+      }
+      if (not s->batch.empty()) {
+        (*s->batch_func)(std::move(s->batch));
+        s->batch.clear();
+      }
+      if (not s->in_flight) {
+        uring_arm(*s);
+      }
+    }
+    uring_ready.clear();
+    uring_release_closed();
+  }
+
+  // the pending requests point to the sockets' state, so they are cancelled and waited for
+  std::lock_guard<std::mutex> lock(socket_mutex);
+  while (not uring_sockets.empty()) {
+    uring_remove_socket(uring_sockets.begin()->first);
+  }
+  while (not uring_closing.empty()) {
+    int ret = uring->submit_and_wait(1);
+    if (ret < 0 and ret != -EINTR and ret != -EBUSY) {
+      rxSockError("Error from io_uring_enter: %s\n", strerror(-ret));
+      for (auto& s : uring_closing) {
+        s->in_flight = false;
+      }
+    }
+    uring->for_each_cqe([this](const io_uring_cqe& cqe) { uring_handle_cqe(cqe.user_data, cqe.res, cqe.flags); });
+    uring_ready.clear();
+    uring_release_closed();
+  }
+}
+
+void rx_multisocket_handler::uring_handle_cqe(uint64_t user_data, int32_t res, uint32_t flags)
+{
+  if (user_data == URING_CANCEL_USER_DATA) {
+    return;
+  }
+  if (user_data == URING_CTRL_USER_DATA) {
+    if (res != sizeof(ctrl_cmd_t)) {
+      rxSockError("Unable to read control message.\n");
+      uring_arm_ctrl();
+      return;
+    }
+    switch (uring_ctrl_msg.cmd) {
+      case ctrl_cmd_t::cmd_id_t::EXIT:
+        running = false;
+        return;
+      case ctrl_cmd_t::cmd_id_t::RM_FD:
+        remove_socket_unprotected(uring_ctrl_msg.new_fd);
+        break;
+      case ctrl_cmd_t::cmd_id_t::ADD_FD:
+        uring_add_socket(uring_ctrl_msg.new_fd);
+        break;
+      default:
+        rxSockError("ctrl message command %d is not valid\n", (int)uring_ctrl_msg.cmd);
+    }
+    uring_arm_ctrl();
+    return;
+  }
+
+  uring_socket_t* s = (uring_socket_t*)(uintptr_t)user_data;
+  if (not(flags & IORING_CQE_F_MORE)) {
+    s->in_flight = false;
+  }
+  if (s->removed) {
+    return;
+  }
+
+  if (s->batch_func == nullptr) {
+    // the socket is readable
+    if (res < 0) {
+      rxSockError("Error polling fd=%d: %s\n", s->fd, strerror(-res));
+      remove_socket_unprotected(s->fd);
+      return;
+    }
+    if (not(*s->task)(s->fd)) {
+      rxSockInfo("The socket fd=%d has been closed by peer\n", s->fd);
+      remove_socket_unprotected(s->fd);
+      return;
+    }
+    uring_arm(*s);
+    return;
+  }
+
+  if (flags & IORING_CQE_F_BUFFER) {
+    uint16_t                     bid = flags >> IORING_CQE_BUFFER_SHIFT;
+    srslte::unique_byte_buffer_t pdu = std::move(s->bufs[bid]);
+    if (res > 0) {
+      // the buffer holds the recvmsg header, the source address and the packet
+      io_uring_recvmsg_out* out = (io_uring_recvmsg_out*)pdu->msg;
+      if (out->flags & MSG_TRUNC) {
+        rxSockWarn("Dropping truncated packet of %d bytes from fd=%d\n", out->payloadlen, s->fd);
+      } else {
+        rx_datagram_t d;
+        d.from = {};
+        memcpy(&d.from, pdu->msg + sizeof(*out), std::min<size_t>(out->namelen, sizeof(d.from)));
+        pdu->msg += sizeof(*out) + s->msg.msg_namelen + s->msg.msg_controllen;
+        pdu->N_bytes  = out->payloadlen;
+        pdu->md.rx_ns = latency_clock_ns();
+        d.pdu         = std::move(pdu);
+        s->batch.push_back(std::move(d));
+      }
+    }
+    // a new pool buffer takes the place of the received one
+    s->bufs[bid] = srslte::allocate_unique_buffer(*pool, "Rxsocket", true);
+    io_uring_queue::buf_ring_add(
+        s->buf_ring, uring_socket_t::NOF_BUFS, s->bufs[bid]->msg, s->bufs[bid]->get_tailroom(), bid);
+  } else if (res == -EBADF or res == -ENOTSOCK) {
+    rxSockError("Error reading from fd=%d: %s\n", s->fd, strerror(-res));
+    remove_socket_unprotected(s->fd);
+    return;
+  } else if (res < 0 and res != -ENOBUFS) {
+    // the request is re-armed below
+    rxSockError("Error reading from fd=%d: %s\n", s->fd, strerror(-res));
+  }
+
+  if ((not s->batch.empty() or not s->in_flight) and not s->ready) {
+    s->ready = true;
+    uring_ready.push_back(s);
+  }
+}
+
+void rx_multisocket_handler::uring_add_socket(int fd)
+{
+  auto it = active_sockets.find(fd);
+  if (it == active_sockets.end() or uring_sockets.count(fd) > 0) {
+    // removed before reaching the ring
+    return;
+  }
+
+  std::unique_ptr<uring_socket_t> s(new uring_socket_t);
+  s->fd         = fd;
+  s->task       = it->second.get();
+  s->batch_func = s->task->get_batch_callback();
+  if (s->batch_func != nullptr) {
+    s->bgid     = uring_next_bgid++;
+    s->buf_ring = uring->setup_buf_ring(s->bgid, uring_socket_t::NOF_BUFS);
+    if (s->buf_ring == nullptr) {
+      // the task reads the socket with recvmmsg instead
+      rxSockWarn("Failed to register the buffer ring of fd=%d, polling it instead\n", fd);
+      s->batch_func = nullptr;
+    } else {
+      for (uint16_t i = 0; i < uring_socket_t::NOF_BUFS; ++i) {
+        s->bufs[i] = srslte::allocate_unique_buffer(*pool, "Rxsocket", true);
+        io_uring_queue::buf_ring_add(
+            s->buf_ring, uring_socket_t::NOF_BUFS, s->bufs[i]->msg, s->bufs[i]->get_tailroom(), i);
+      }
+      s->msg.msg_namelen = sizeof(sockaddr_in);
+    }
+  }
+  uring_arm(*s);
+  uring_sockets[fd] = std::move(s);
+}
+
+void rx_multisocket_handler::uring_remove_socket(int fd)
+{
+  auto it = uring_sockets.find(fd);
+  if (it == uring_sockets.end()) {
+    return;
+  }
+  std::unique_ptr<uring_socket_t> s = std::move(it->second);
+  uring_sockets.erase(it);
+
+  // the socket is released once its request has completed
+  s->removed = true;
+  if (s->in_flight) {
+    io_uring_queue::prep_cancel(uring_get_sqe(*uring), (uintptr_t)s.get(), URING_CANCEL_USER_DATA);
+  }
+  uring_closing.push_back(std::move(s));
+}
+
+void rx_multisocket_handler::uring_arm_ctrl()
+{
+  io_uring_queue::prep_read(
+      uring_get_sqe(*uring), pipefd[0], &uring_ctrl_msg, sizeof(uring_ctrl_msg), URING_CTRL_USER_DATA);
+}
+
+void rx_multisocket_handler::uring_arm(uring_socket_t& s)
+{
+  io_uring_sqe* sqe = uring_get_sqe(*uring);
+  if (s.batch_func != nullptr) {
+    io_uring_queue::prep_recvmsg_multishot(sqe, s.fd, &s.msg, s.bgid, (uintptr_t)&s);
+  } else {
+    io_uring_queue::prep_poll_add(sqe, s.fd, POLLIN, (uintptr_t)&s);
+  }
+  s.in_flight = true;
+}
+
+void rx_multisocket_handler::uring_release_closed()
+{
+  for (auto it = uring_closing.begin(); it != uring_closing.end();) {
+    if ((*it)->in_flight) {
+      ++it;
+      continue;
+    }
+    if ((*it)->buf_ring != nullptr) {
+      uring->free_buf_ring((*it)->buf_ring, (*it)->bgid, uring_socket_t::NOF_BUFS);
+    }
+    it = uring_closing.erase(it);
+  }
+}
+
+#endif // HAVE_IO_URING
+
 } // namespace srslte
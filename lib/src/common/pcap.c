@@ -58,19 +58,11 @@ void LTE_PCAP_Close(FILE* fd)
   }
 }
 
-/* Write an individual PDU (PCAP packet header + mac-context + mac-pdu) */
-int LTE_PCAP_MAC_WritePDU(FILE* fd, MAC_Context_Info_t* context, const unsigned char* PDU, unsigned int length)
+/* Pack the mac-context that precedes a MAC PDU, returns its length */
+int LTE_PCAP_MAC_PackContext(const MAC_Context_Info_t* context, unsigned char* context_header)
 {
-  pcaprec_hdr_t packet_header;
-  char          context_header[256];
-  int           offset = 0;
-  uint16_t      tmp16;
-
-  /* Can't write if file wasn't successfully opened */
-  if (fd == NULL) {
-    printf("Error: Can't write to empty file handle\n");
-    return 0;
-  }
+  int      offset = 0;
+  uint16_t tmp16;
 
   /*****************************************************************/
   /* Context information (same as written by UDP heuristic clients */
@@ -113,6 +105,24 @@ int LTE_PCAP_MAC_WritePDU(FILE* fd, MAC_Context_Info_t* context, const unsigned
   /* Data tag immediately preceding PDU */
   context_header[offset++] = MAC_LTE_PAYLOAD_TAG;
 
+  return offset;
+}
+
+/* Write an individual PDU (PCAP packet header + mac-context + mac-pdu) */
+int LTE_PCAP_MAC_WritePDU(FILE* fd, MAC_Context_Info_t* context, const unsigned char* PDU, unsigned int length)
+{
+  pcaprec_hdr_t packet_header;
+  unsigned char context_header[PCAP_CONTEXT_HEADER_MAX];
+  int           offset = 0;
+
+  /* Can't write if file wasn't successfully opened */
+  if (fd == NULL) {
+    printf("Error: Can't write to empty file handle\n");
+    return 0;
+  }
+
+  offset = LTE_PCAP_MAC_PackContext(context, context_header);
+
   /****************************************************************/
   /* PCAP Header                                                  */
   struct timeval t;
@@ -163,21 +173,11 @@ int LTE_PCAP_NAS_WritePDU(FILE* fd, NAS_Context_Info_t* context, const unsigned
  * API functions for writing RLC-LTE PCAP files                           *
  **************************************************************************/
 
-/* Write an individual RLC PDU (PCAP packet header + UDP header + rlc-context + rlc-pdu) */
-int LTE_PCAP_RLC_WritePDU(FILE* fd, RLC_Context_Info_t* context, const unsigned char* PDU, unsigned int length)
+/* Pack the UDP header and rlc-context that precede an RLC PDU of the given length, returns their length */
+int LTE_PCAP_RLC_PackContext(const RLC_Context_Info_t* context, unsigned int length, unsigned char* context_header)
 {
-  pcaprec_hdr_t packet_header;
-  char          context_header[256] = {};
-  int           offset = 0;
-  uint16_t      tmp16;
-
-  /* Can't write if file wasn't successfully opened */
-  if (fd == NULL) {
-    printf("Error: Can't write to empty file handle\n");
-    return 0;
-  }
-
-  /*****************************************************************/
+  int      offset = 0;
+  uint16_t tmp16;
 
   // Add dummy UDP header, start with src and dest port
   context_header[offset++] = 0xde;
@@ -233,6 +233,24 @@ int LTE_PCAP_RLC_WritePDU(FILE* fd, RLC_Context_Info_t* context, const unsigned
   // Now the actual PDU
   context_header[offset++] = RLC_LTE_PAYLOAD_TAG;
 
+  return offset;
+}
+
+/* Write an individual RLC PDU (PCAP packet header + UDP header + rlc-context + rlc-pdu) */
+int LTE_PCAP_RLC_WritePDU(FILE* fd, RLC_Context_Info_t* context, const unsigned char* PDU, unsigned int length)
+{
+  pcaprec_hdr_t packet_header;
+  unsigned char context_header[PCAP_CONTEXT_HEADER_MAX];
+  int           offset = 0;
+
+  /* Can't write if file wasn't successfully opened */
+  if (fd == NULL) {
+    printf("Error: Can't write to empty file handle\n");
+    return 0;
+  }
+
+  offset = LTE_PCAP_RLC_PackContext(context, length, context_header);
+
   // PCAP header
   struct timeval t;
   gettimeofday(&t, NULL);
@@ -281,17 +299,10 @@ int LTE_PCAP_S1AP_WritePDU(FILE* fd, S1AP_Context_Info_t* context, const unsigne
  * API functions for writing MAC-NR PCAP files                           *
  **************************************************************************/
 
-/* Write an individual NR MAC PDU (PCAP packet header + UDP header + nr-mac-context + mac-pdu) */
-int NR_PCAP_MAC_WritePDU(FILE* fd, mac_nr_context_info_t* context, const unsigned char* PDU, unsigned int length)
+/* Pack the UDP header and nr-mac-context that precede an NR MAC PDU of the given length, returns their length */
+int NR_PCAP_MAC_PackContext(const mac_nr_context_info_t* context, unsigned int length, unsigned char* context_header)
 {
-  char context_header[256] = {};
-  int  offset              = 0;
-
-  /* Can't write if file wasn't successfully opened */
-  if (fd == NULL) {
-    printf("Error: Can't write to empty file handle\n");
-    return 0;
-  }
+  int offset = 0;
 
   // Add dummy UDP header, start with src and dest port
   context_header[offset++] = 0xde;
@@ -347,6 +358,23 @@ int NR_PCAP_MAC_WritePDU(FILE* fd, mac_nr_context_info_t* context, const unsigne
   /* Data tag immediately preceding PDU */
   context_header[offset++] = MAC_LTE_PAYLOAD_TAG;
 
+  return offset;
+}
+
+/* Write an individual NR MAC PDU (PCAP packet header + UDP header + nr-mac-context + mac-pdu) */
+int NR_PCAP_MAC_WritePDU(FILE* fd, mac_nr_context_info_t* context, const unsigned char* PDU, unsigned int length)
+{
+  unsigned char context_header[PCAP_CONTEXT_HEADER_MAX];
+  int           offset = 0;
+
+  /* Can't write if file wasn't successfully opened */
+  if (fd == NULL) {
+    printf("Error: Can't write to empty file handle\n");
+    return 0;
+  }
+
+  offset = NR_PCAP_MAC_PackContext(context, length, context_header);
+
   /****************************************************************/
   /* PCAP Header                                                  */
   struct timeval t;
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include "srslte/common/pcap_writer.h"
+#include <chrono>
+#include <string.h>
+#include <sys/time.h>
+#include <thread>
+
+namespace srslte {
+
+// Period at which the writer thread looks for new packets
+static const std::chrono::milliseconds poll_period(5);
+
+static std::string build_filename_with_index(const std::string& filename, uint32_t index)
+{
+  if (index == 0) {
+    return filename;
+  }
+  // The index goes before the extension, if there is one in the last path component
+  size_t dot   = filename.rfind('.');
+  size_t slash = filename.rfind('/');
+  if (dot == std::string::npos or dot == 0 or (slash != std::string::npos and dot < slash + 2)) {
+    return filename + "." + std::to_string(index);
+  }
+  return filename.substr(0, dot) + "." + std::to_string(index) + filename.substr(dot);
+}
+
+pcap_writer::pcap_writer(const std::string& thread_name, uint32_t ring_size_) : thread(thread_name)
+{
+  ring_size = 64 * 1024;
+  while (ring_size < ring_size_) {
+    ring_size <<= 1u;
+  }
+  ring_mask = ring_size - 1;
+}
+
+pcap_writer::~pcap_writer()
+{
+  close();
+}
+
+bool pcap_writer::open(uint32_t dlt_, const std::string& filename, const pcap_rotation_t& rotation_)
+{
+  close();
+
+  dlt           = dlt_;
+  base_filename = filename;
+  rotation      = rotation_;
+  file_index    = 0;
+  if (not open_file()) {
+    return false;
+  }
+
+  // The ring is allocated on the first open, as most captures are never enabled
+  if (ring == nullptr) {
+    ring.reset(new uint8_t[ring_size]);
+  }
+  memset(ring.get(), 0, ring_size);
+  tail.store(0, std::memory_order_relaxed);
+  head.store(0, std::memory_order_relaxed);
+  dropped.store(0, std::memory_order_relaxed);
+  write_buffer.reserve(write_buffer_size);
+
+  running.store(true, std::memory_order_release);
+  if (not start(-1)) {
+    running.store(false, std::memory_order_relaxed);
+    LTE_PCAP_Close(file);
+    file = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void pcap_writer::close()
+{
+  if (not running.exchange(false, std::memory_order_seq_cst)) {
+    return;
+  }
+  wait_thread_finish();
+
+  LTE_PCAP_Close(file);
+  file = nullptr;
+  if (dropped.load(std::memory_order_relaxed) > 0) {
+    fprintf(stdout,
+            "Dropped %" PRIu64 " packets of %s, the writer could not keep up\n",
+            dropped.load(std::memory_order_relaxed),
+            base_filename.c_str());
+  }
+}
+
+bool pcap_writer::write(const uint8_t* context, uint32_t context_len, const uint8_t* pdu, uint32_t pdu_len)
+{
+  if (not running.load(std::memory_order_relaxed)) {
+    return false;
+  }
+
+  // The writer thread does not stop while a producer is in flight, so a packet queued here is always written. A
+  // producer that finds the capture closed after registering raced with close() and its packet is counted as dropped
+  nof_writers.fetch_add(1, std::memory_order_seq_cst);
+  bool queued = running.load(std::memory_order_seq_cst) and queue_packet(context, context_len, pdu, pdu_len);
+  if (not queued) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+  nof_writers.fetch_sub(1, std::memory_order_release);
+  return queued;
+}
+
+bool pcap_writer::queue_packet(const uint8_t* context, uint32_t context_len, const uint8_t* pdu, uint32_t pdu_len)
+{
+  uint32_t packet_len = sizeof(pcaprec_hdr_t) + context_len + pdu_len;
+  uint32_t record_len = (record_header_size + packet_len + 7u) & ~7u;
+  if (record_len > ring_size / 2) {
+    return false;
+  }
+
+  // Claim the space of the record, together with the end of the ring if the record does not fit in it
+  uint64_t pos = tail.load(std::memory_order_relaxed);
+  uint32_t padding_len;
+  do {
+    uint32_t offset = pos & ring_mask;
+    padding_len     = (offset + record_len > ring_size) ? ring_size - offset : 0;
+    if (pos + padding_len + record_len - head.load(std::memory_order_acquire) > ring_size) {
+      return false;
+    }
+  } while (not tail.compare_exchange_weak(pos, pos + padding_len + record_len, std::memory_order_relaxed));
+
+  if (padding_len > 0) {
+    record_word(pos)->store(padding_len | padding_flag, std::memory_order_release);
+    pos += padding_len;
+  }
+
+  struct timeval t;
+  gettimeofday(&t, nullptr);
+  pcaprec_hdr_t packet_header;
+  packet_header.ts_sec   = t.tv_sec;
+  packet_header.ts_usec  = t.tv_usec;
+  packet_header.incl_len = context_len + pdu_len;
+  packet_header.orig_len = context_len + pdu_len;
+
+  uint8_t* p = ring.get() + (pos & ring_mask) + sizeof(uint32_t);
+  memcpy(p, &packet_len, sizeof(packet_len));
+  p += record_header_size - sizeof(uint32_t);
+  memcpy(p, &packet_header, sizeof(packet_header));
+  p += sizeof(packet_header);
+  if (context_len > 0) {
+    memcpy(p, context, context_len);
+    p += context_len;
+  }
+  memcpy(p, pdu, pdu_len);
+
+  record_word(pos)->store(record_len, std::memory_order_release);
+  return true;
+}
+
+void pcap_writer::run_thread()
+{
+  while (true) {
+    // Once running is seen false and no producer is in flight, every packet queued before close() is in the ring
+    bool stop = not running.load(std::memory_order_seq_cst) and nof_writers.load(std::memory_order_seq_cst) == 0;
+    if (drain() == 0) {
+      if (stop) {
+        break;
+      }
+      std::this_thread::sleep_for(poll_period);
+    }
+  }
+  flush_buffer();
+}
+
+uint32_t pcap_writer::drain()
+{
+  uint32_t nof_packets = 0;
+  uint64_t pos         = head.load(std::memory_order_relaxed);
+  uint64_t end         = tail.load(std::memory_order_acquire);
+  while (pos != end) {
+    uint32_t word = record_word(pos)->load(std::memory_order_acquire);
+    if (word == 0) {
+      // The record is still being copied
+      break;
+    }
+    uint32_t record_len = word & ~padding_flag;
+    uint8_t* record     = ring.get() + (pos & ring_mask);
+    if ((word & padding_flag) == 0) {
+      uint32_t packet_len;
+      memcpy(&packet_len, record + sizeof(uint32_t), sizeof(packet_len));
+      append_packet(record + record_header_size, packet_len);
+      nof_packets++;
+    }
+    // The producers expect a zero length in the free space
+    memset(record, 0, record_len);
+    pos += record_len;
+    head.store(pos, std::memory_order_release);
+  }
+  flush_buffer();
+  return nof_packets;
+}
+
+void pcap_writer::append_packet(const uint8_t* packet, uint32_t len)
+{
+  pcaprec_hdr_t packet_header;
+  memcpy(&packet_header, packet, sizeof(packet_header));
+
+  if (not file_empty) {
+    bool too_big  = rotation.max_file_size > 0 and file_size + len > rotation.max_file_size;
+    bool too_long = rotation.max_file_duration > 0 and packet_header.ts_sec >= file_start + rotation.max_file_duration;
+    if (too_big or too_long) {
+      flush_buffer();
+      LTE_PCAP_Close(file);
+      open_file();
+    }
+  }
+  if (file == nullptr) {
+    return;
+  }
+  if (file_empty) {
+    file_start = packet_header.ts_sec;
+    file_empty = false;
+  }
+
+  if (write_buffer.size() + len > write_buffer_size) {
+    flush_buffer();
+  }
+  write_buffer.insert(write_buffer.end(), packet, packet + len);
+  file_size += len;
+}
+
+void pcap_writer::flush_buffer()
+{
+  if (file != nullptr and not write_buffer.empty()) {
+    fwrite(write_buffer.data(), 1, write_buffer.size(), file);
+    fflush(file);
+  }
+  write_buffer.clear();
+}
+
+bool pcap_writer::open_file()
+{
+  file       = LTE_PCAP_Open(dlt, build_filename_with_index(base_filename, file_index++).c_str());
+  file_size  = sizeof(pcap_hdr_t);
+  file_empty = true;
+  return file != nullptr;
+}
+
+} // namespace srslte
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/perf_counters.h"
+#include <atomic>
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace srslte {
+
+namespace perf_counters {
+
+namespace {
+
+enum counter_idx { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, NOF_COUNTERS };
+
+std::atomic<bool> enabled{false};
+
+/// Group of counters of a thread, the cycles lead the group so that all of them are read at once
+struct thread_counters {
+  int      fd[NOF_COUNTERS] = {-1, -1, -1, -1, -1};
+  int      idx_in_group[NOF_COUNTERS];
+  uint32_t nof_open = 0;
+  bool     opened   = false;
+
+  ~thread_counters()
+  {
+    for (int f : fd) {
+      if (f >= 0) {
+        close(f);
+      }
+    }
+  }
+
+  int open_counter(uint32_t type, uint64_t config, int group_fd)
+  {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = type;
+    attr.config         = config;
+    attr.read_format    = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+  }
+
+  bool open()
+  {
+    opened = true;
+
+    const struct {
+      uint32_t type;
+      uint64_t config;
+    } events[NOF_COUNTERS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE,
+         PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8u) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16u)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+
+    for (uint32_t i = 0; i < NOF_COUNTERS; ++i) {
+      fd[i] = open_counter(events[i].type, events[i].config, i == CYCLES ? -1 : fd[CYCLES]);
+      if (fd[i] >= 0) {
+        idx_in_group[i] = nof_open++;
+      } else if (i == CYCLES) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool read(perf_counter_values* values)
+  {
+    if (not opened and not open()) {
+      return false;
+    }
+    if (fd[CYCLES] < 0) {
+      return false;
+    }
+
+    // The group is read as the number of counters followed by their values, in the order they were opened
+    uint64_t buffer[1 + NOF_COUNTERS] = {};
+    if (::read(fd[CYCLES], buffer, sizeof(buffer)) < (ssize_t)((1 + nof_open) * sizeof(uint64_t))) {
+      return false;
+    }
+    uint64_t v[NOF_COUNTERS] = {};
+    for (uint32_t i = 0; i < NOF_COUNTERS; ++i) {
+      if (fd[i] >= 0) {
+        v[i] = buffer[1 + idx_in_group[i]];
+      }
+    }
+    values->cycles        = v[CYCLES];
+    values->instructions  = v[INSTRUCTIONS];
+    values->l1d_misses    = v[L1D_MISSES];
+    values->llc_misses    = v[LLC_MISSES];
+    values->branch_misses = v[BRANCH_MISSES];
+    return true;
+  }
+};
+
+thread_local thread_counters local_counters;
+
+} // namespace
+
+bool enable()
+{
+  perf_counter_values values;
+  if (not local_counters.read(&values) or local_counters.fd[INSTRUCTIONS] < 0) {
+    return false;
+  }
+  enabled.store(true, std::memory_order_relaxed);
+  return true;
+}
+
+bool is_enabled()
+{
+  return enabled.load(std::memory_order_relaxed);
+}
+
+bool read(perf_counter_values* values)
+{
+  return is_enabled() and local_counters.read(values);
+}
+
+} // namespace perf_counters
+
+} // namespace srslte
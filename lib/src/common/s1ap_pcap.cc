@@ -30,23 +30,23 @@ void s1ap_pcap::enable()
 {
   enable_write = true;
 }
-void s1ap_pcap::open(const char* filename)
+void s1ap_pcap::open(const char* filename, const pcap_rotation_t& rotation)
 {
-  pcap_file    = LTE_PCAP_Open(S1AP_LTE_DLT, filename);
+  writer.open(S1AP_LTE_DLT, filename, rotation);
   enable_write = true;
 }
 void s1ap_pcap::close()
 {
   fprintf(stdout, "Saving S1AP PCAP file\n");
-  LTE_PCAP_Close(pcap_file);
+  writer.close();
 }
 
 void s1ap_pcap::write_s1ap(uint8_t* pdu, uint32_t pdu_len_bytes)
 {
   if (enable_write) {
-    S1AP_Context_Info_t context;
+    // S1AP PDUs have no context
     if (pdu) {
-      LTE_PCAP_S1AP_WritePDU(pcap_file, &context, pdu, pdu_len_bytes);
+      writer.write(nullptr, 0, pdu, pdu_len_bytes);
     }
   }
 }
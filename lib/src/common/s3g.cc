@@ -160,6 +160,54 @@ void s3g_deinitialize(S3G_STATE* state);
 *********************************************************************/
 void s3g_generate_keystream(S3G_STATE* state, uint32_t n, uint32_t* ks);
 
+/*********************************************************************
+    Name: s3g_tables_t
+
+    Description: Lookup tables for the multiplication and division by
+                 alpha and for the S-Boxes S1 and S2, one table per
+                 input byte. They are built once on first use.
+*********************************************************************/
+struct s3g_tables_t {
+  uint32_t mul_alpha[256];
+  uint32_t div_alpha[256];
+  uint32_t s1[4][256];
+  uint32_t s2[4][256];
+
+  s3g_tables_t();
+};
+
+static const s3g_tables_t& s3g_tables()
+{
+  static const s3g_tables_t tables;
+  return tables;
+}
+
+// Contribution of one input byte of S1 or S2 (Section 3.3) to the output word, for every byte position
+static void s3g_fill_sbox_tables(const uint8_t* sbox, uint8_t c, uint32_t table[4][256])
+{
+  for (uint32_t x = 0; x < 256; x++) {
+    uint32_t s  = sbox[x];
+    uint32_t m  = s3g_mul_x(sbox[x], c);
+    table[0][x] = (m << 24) | ((m ^ s) << 16) | (s << 8) | s;
+    table[1][x] = (s << 24) | (m << 16) | ((m ^ s) << 8) | s;
+    table[2][x] = (s << 24) | (s << 16) | (m << 8) | (m ^ s);
+    table[3][x] = ((m ^ s) << 24) | (s << 16) | (s << 8) | m;
+  }
+}
+
+s3g_tables_t::s3g_tables_t()
+{
+  for (uint32_t i = 0; i < 256; i++) {
+    uint8_t c    = (uint8_t)i;
+    mul_alpha[i] = ((((uint32_t)s3g_mul_x_pow(c, 23, 0xa9)) << 24) | (((uint32_t)s3g_mul_x_pow(c, 245, 0xa9)) << 16) |
+                    (((uint32_t)s3g_mul_x_pow(c, 48, 0xa9)) << 8) | (((uint32_t)s3g_mul_x_pow(c, 239, 0xa9))));
+    div_alpha[i] = ((((uint32_t)s3g_mul_x_pow(c, 16, 0xa9)) << 24) | (((uint32_t)s3g_mul_x_pow(c, 39, 0xa9)) << 16) |
+                    (((uint32_t)s3g_mul_x_pow(c, 6, 0xa9)) << 8) | (((uint32_t)s3g_mul_x_pow(c, 64, 0xa9))));
+  }
+  s3g_fill_sbox_tables(S, 0x1b, s1);
+  s3g_fill_sbox_tables(SQ, 0x69, s2);
+}
+
 /*********************************************************************
     Name: s3g_mul_x
 
@@ -205,8 +253,7 @@ uint8_t s3g_mul_x_pow(uint8_t v, uint8_t i, uint8_t c)
 *********************************************************************/
 uint32_t s3g_mul_alpha(uint8_t c)
 {
-  return ((((uint32_t)s3g_mul_x_pow(c, 23, 0xa9)) << 24) | (((uint32_t)s3g_mul_x_pow(c, 245, 0xa9)) << 16) |
-          (((uint32_t)s3g_mul_x_pow(c, 48, 0xa9)) << 8) | (((uint32_t)s3g_mul_x_pow(c, 239, 0xa9))));
+  return s3g_tables().mul_alpha[c];
 }
 
 /*********************************************************************
@@ -220,8 +267,7 @@ uint32_t s3g_mul_alpha(uint8_t c)
 *********************************************************************/
 uint32_t s3g_div_alpha(uint8_t c)
 {
-  return ((((uint32_t)s3g_mul_x_pow(c, 16, 0xa9)) << 24) | (((uint32_t)s3g_mul_x_pow(c, 39, 0xa9)) << 16) |
-          (((uint32_t)s3g_mul_x_pow(c, 6, 0xa9)) << 8) | (((uint32_t)s3g_mul_x_pow(c, 64, 0xa9))));
+  return s3g_tables().div_alpha[c];
 }
 
 /*********************************************************************
@@ -235,21 +281,8 @@ uint32_t s3g_div_alpha(uint8_t c)
 *********************************************************************/
 uint32_t s3g_s1(uint32_t w)
 {
-  uint8_t r0 = 0, r1 = 0, r2 = 0, r3 = 0;
-  uint8_t srw0 = S[(uint8_t)((w >> 24) & 0xff)];
-  uint8_t srw1 = S[(uint8_t)((w >> 16) & 0xff)];
-  uint8_t srw2 = S[(uint8_t)((w >> 8) & 0xff)];
-  uint8_t srw3 = S[(uint8_t)((w)&0xff)];
-
-  r0 = ((s3g_mul_x(srw0, 0x1b)) ^ (srw1) ^ (srw2) ^ ((s3g_mul_x(srw3, 0x1b)) ^ srw3));
-
-  r1 = (((s3g_mul_x(srw0, 0x1b)) ^ srw0) ^ (s3g_mul_x(srw1, 0x1b)) ^ (srw2) ^ (srw3));
-
-  r2 = ((srw0) ^ ((s3g_mul_x(srw1, 0x1b)) ^ srw1) ^ (s3g_mul_x(srw2, 0x1b)) ^ (srw3));
-
-  r3 = ((srw0) ^ (srw1) ^ ((s3g_mul_x(srw2, 0x1b)) ^ srw2) ^ (s3g_mul_x(srw3, 0x1b)));
-
-  return ((((uint32_t)r0) << 24) | (((uint32_t)r1) << 16) | (((uint32_t)r2) << 8) | (((uint32_t)r3)));
+  const s3g_tables_t& t = s3g_tables();
+  return t.s1[0][w >> 24] ^ t.s1[1][(w >> 16) & 0xff] ^ t.s1[2][(w >> 8) & 0xff] ^ t.s1[3][w & 0xff];
 }
 
 /*********************************************************************
@@ -263,21 +296,8 @@ uint32_t s3g_s1(uint32_t w)
 *********************************************************************/
 uint32_t s3g_s2(uint32_t w)
 {
-  uint8_t r0 = 0, r1 = 0, r2 = 0, r3 = 0;
-  uint8_t sqw0 = SQ[(uint8_t)((w >> 24) & 0xff)];
-  uint8_t sqw1 = SQ[(uint8_t)((w >> 16) & 0xff)];
-  uint8_t sqw2 = SQ[(uint8_t)((w >> 8) & 0xff)];
-  uint8_t sqw3 = SQ[(uint8_t)((w)&0xff)];
-
-  r0 = ((s3g_mul_x(sqw0, 0x69)) ^ (sqw1) ^ (sqw2) ^ ((s3g_mul_x(sqw3, 0x69)) ^ sqw3));
-
-  r1 = (((s3g_mul_x(sqw0, 0x69)) ^ sqw0) ^ (s3g_mul_x(sqw1, 0x69)) ^ (sqw2) ^ (sqw3));
-
-  r2 = ((sqw0) ^ ((s3g_mul_x(sqw1, 0x69)) ^ sqw1) ^ (s3g_mul_x(sqw2, 0x69)) ^ (sqw3));
-
-  r3 = ((sqw0) ^ (sqw1) ^ ((s3g_mul_x(sqw2, 0x69)) ^ sqw2) ^ (s3g_mul_x(sqw3, 0x69)));
-
-  return ((((uint32_t)r0) << 24) | (((uint32_t)r1) << 16) | (((uint32_t)r2) << 8) | (((uint32_t)r3)));
+  const s3g_tables_t& t = s3g_tables();
+  return t.s2[0][w >> 24] ^ t.s2[1][(w >> 16) & 0xff] ^ t.s2[2][(w >> 8) & 0xff] ^ t.s2[3][w & 0xff];
 }
 
 /*********************************************************************
@@ -294,11 +314,8 @@ void s3g_clock_lfsr(S3G_STATE* state, uint32_t f)
   uint32_t v = (((state->lfsr[0] << 8) & 0xffffff00) ^ (s3g_mul_alpha((uint8_t)((state->lfsr[0] >> 24) & 0xff))) ^
                 (state->lfsr[2]) ^ ((state->lfsr[11] >> 8) & 0x00ffffff) ^
                 (s3g_div_alpha((uint8_t)((state->lfsr[11]) & 0xff))) ^ (f));
-  uint8_t  i;
 
-  for (i = 0; i < 15; i++) {
-    state->lfsr[i] = state->lfsr[i + 1];
-  }
+  memmove(&state->lfsr[0], &state->lfsr[1], 15 * sizeof(uint32_t));
   state->lfsr[15] = v;
 }
 
@@ -456,11 +473,48 @@ uint64_t s3g_MUL64(uint64_t V, uint64_t P, uint64_t c)
 
   for (i = 0; i < 64; i++) {
     if ((P >> i) & 0x1)
-      result ^= s3g_MUL64xPOW(V, i, c);
+      result ^= V;
+    V = s3g_MUL64x(V, c);
   }
   return result;
 }
 
+/* MUL64 table.
+ * Input P: a 64-bit input.
+ * Input c: a 64-bit input.
+ * Output table: P multiplied by every 4-bit window of a 64-bit input,
+ * table[w][n] = MUL64(n << 4w, P, c).
+ * Lets MUL64 with a fixed P take 16 lookups, see s3g_MUL64_table.
+ */
+static void s3g_MUL64_init_table(uint64_t P, uint64_t c, uint64_t table[16][16])
+{
+  int w, b, n;
+
+  for (w = 0; w < 16; w++) {
+    table[w][0] = 0;
+    for (b = 0; b < 4; b++) {
+      for (n = 1 << b; n < 2 << b; n++)
+        table[w][n] = table[w][n ^ (1 << b)] ^ P;
+      P = s3g_MUL64x(P, c);
+    }
+  }
+}
+
+/* MUL64 with a table.
+ * Input V: a 64-bit input.
+ * Input table: table built by s3g_MUL64_init_table for P.
+ * Output : MUL64(V, P, c).
+ */
+static uint64_t s3g_MUL64_table(uint64_t V, const uint64_t table[16][16])
+{
+  uint64_t result = 0;
+  int      w      = 0;
+
+  for (w = 0; w < 16; w++)
+    result ^= table[w][(V >> (4 * w)) & 0xf];
+  return result;
+}
+
 /* mask8bit.
  * Input n: an integer in 1-7.
  * Output : an 8 bit mask.
@@ -491,6 +545,7 @@ uint8_t* s3g_f9(const uint8_t* key, uint32_t count, uint32_t fresh, uint32_t dir
   uint64_t       P;
   uint64_t       Q;
   uint64_t       c;
+  uint64_t       P_table[16][16];
   S3G_STATE      state, *state_ptr;
 
   uint64_t M_D_2;
@@ -523,13 +578,14 @@ uint8_t* s3g_f9(const uint8_t* key, uint32_t count, uint32_t fresh, uint32_t dir
     D = (length >> 6) + 2;
   EVAL = 0;
   c    = 0x1b;
+  s3g_MUL64_init_table(P, c, P_table);
 
   /* for 0 <= i <= D-3 */
   for (i = 0; i < D - 2; i++) {
     V    = EVAL ^ ((uint64_t)data[8 * i] << 56 | (uint64_t)data[8 * i + 1] << 48 | (uint64_t)data[8 * i + 2] << 40 |
                 (uint64_t)data[8 * i + 3] << 32 | (uint64_t)data[8 * i + 4] << 24 | (uint64_t)data[8 * i + 5] << 16 |
                 (uint64_t)data[8 * i + 6] << 8 | (uint64_t)data[8 * i + 7]);
-    EVAL = s3g_MUL64(V, P, c);
+    EVAL = s3g_MUL64_table(V, P_table);
   }
 
   /* for D-2 */
@@ -548,7 +604,7 @@ uint8_t* s3g_f9(const uint8_t* key, uint32_t count, uint32_t fresh, uint32_t dir
     M_D_2 |= (uint64_t)(data[8 * (D - 2) + i] & mask8bit(rem_bits)) << (8 * (7 - i));
 
   V    = EVAL ^ M_D_2;
-  EVAL = s3g_MUL64(V, P, c);
+  EVAL = s3g_MUL64_table(V, P_table);
 
   /* for D-1 */
   EVAL ^= length;
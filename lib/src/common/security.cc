@@ -21,6 +21,7 @@
 
 #include "srslte/common/security.h"
 #include "srslte/common/liblte_security.h"
+#include "srslte/common/liblte_ssl.h"
 #include "srslte/common/s3g.h"
 
 #ifdef HAVE_MBEDTLS
@@ -190,6 +191,137 @@ uint8_t security_128_eea3(uint8_t* key,
   return liblte_security_encryption_eea3(key, count, bearer, direction, msg, msg_len * 8, msg_out);
 }
 
+/******************************************************************************
+ * 128-EEA2/EIA2 with an expanded key
+ *****************************************************************************/
+
+struct security_aes128_key::impl {
+  aes_context ctx;
+  uint8_t     key[16];
+  uint8_t     K1[16]; // CMAC subkeys
+  uint8_t     K2[16];
+  bool        valid = false;
+};
+
+security_aes128_key::security_aes128_key() : pimpl(new impl) {}
+
+security_aes128_key::~security_aes128_key() = default;
+
+security_aes128_key::security_aes128_key(security_aes128_key&&) = default;
+
+security_aes128_key& security_aes128_key::operator=(security_aes128_key&&) = default;
+
+// Left shift of a 128 bit string followed by the conditional XOR of RFC4493 subkey generation
+static void cmac_subkey(const uint8_t* in, uint8_t* out)
+{
+  for (uint32_t i = 0; i < 15; i++) {
+    out[i] = (in[i] << 1u) | (in[i + 1] >> 7u);
+  }
+  out[15] = in[15] << 1u;
+  if (in[0] & 0x80) {
+    out[15] ^= 0x87;
+  }
+}
+
+void security_aes128_key::set(const uint8_t* key)
+{
+  if (pimpl->valid && memcmp(pimpl->key, key, 16) == 0) {
+    return;
+  }
+  memcpy(pimpl->key, key, 16);
+  aes_setkey_enc(&pimpl->ctx, key, 128);
+
+  uint8_t L[16] = {};
+  aes_crypt_ecb(&pimpl->ctx, AES_ENCRYPT, L, L);
+  cmac_subkey(L, pimpl->K1);
+  cmac_subkey(pimpl->K1, pimpl->K2);
+  pimpl->valid = true;
+}
+
+uint8_t security_128_eia2(const security_aes128_key& key,
+                          uint32_t                   count,
+                          uint32_t                   bearer,
+                          uint8_t                    direction,
+                          const uint8_t*             msg,
+                          uint32_t                   msg_len,
+                          uint8_t*                   mac)
+{
+  security_aes128_key::impl* k = key.pimpl.get();
+  if (not k->valid || (msg == nullptr && msg_len > 0) || mac == nullptr) {
+    return SRSLTE_ERROR;
+  }
+
+  // The CMAC input is COUNT, BEARER and DIRECTION padded to 8 bytes followed by the message, which is read in place
+  uint8_t T[16]   = {};
+  uint8_t blk[16] = {};
+  blk[0]          = (count >> 24u) & 0xFF;
+  blk[1]          = (count >> 16u) & 0xFF;
+  blk[2]          = (count >> 8u) & 0xFF;
+  blk[3]          = count & 0xFF;
+  blk[4]          = (bearer << 3u) | (direction << 2u);
+
+  uint32_t len = SRSLTE_MIN(msg_len, 8);
+  memcpy(&blk[8], msg, len);
+  const uint8_t* ptr = msg + len;
+  const uint8_t* end = msg + msg_len;
+
+  uint32_t nof_blocks = (msg_len + 8 + 15) / 16;
+  for (uint32_t i = 0; i < nof_blocks - 1; i++) {
+    for (uint32_t j = 0; j < 16; j++) {
+      T[j] ^= blk[j];
+    }
+    aes_crypt_ecb(&k->ctx, AES_ENCRYPT, T, T);
+
+    len = SRSLTE_MIN(end - ptr, 16);
+    memcpy(blk, ptr, len);
+    memset(&blk[len], 0, 16 - len);
+    ptr += len;
+  }
+
+  // The last block is either complete or padded with a single one bit
+  uint32_t       last_len = msg_len + 8 - 16 * (nof_blocks - 1);
+  const uint8_t* subkey   = k->K1;
+  if (last_len < 16) {
+    blk[last_len] = 0x80;
+    subkey        = k->K2;
+  }
+  for (uint32_t j = 0; j < 16; j++) {
+    T[j] ^= blk[j] ^ subkey[j];
+  }
+  aes_crypt_ecb(&k->ctx, AES_ENCRYPT, T, T);
+
+  memcpy(mac, T, 4);
+  return SRSLTE_SUCCESS;
+}
+
+uint8_t security_128_eea2(const security_aes128_key& key,
+                          uint32_t                   count,
+                          uint8_t                    bearer,
+                          uint8_t                    direction,
+                          const uint8_t*             msg,
+                          uint32_t                   msg_len,
+                          uint8_t*                   msg_out)
+{
+  security_aes128_key::impl* k = key.pimpl.get();
+  if (not k->valid || msg == nullptr || msg_out == nullptr) {
+    return SRSLTE_ERROR;
+  }
+
+  uint8_t stream_blk[16] = {};
+  uint8_t nonce_cnt[16]  = {};
+  size_t  nc_off         = 0;
+  nonce_cnt[0]           = (count >> 24u) & 0xFF;
+  nonce_cnt[1]           = (count >> 16u) & 0xFF;
+  nonce_cnt[2]           = (count >> 8u) & 0xFF;
+  nonce_cnt[3]           = count & 0xFF;
+  nonce_cnt[4]           = ((bearer & 0x1F) << 3u) | ((direction & 0x01) << 2u);
+
+  if (aes_crypt_ctr(&k->ctx, msg_len, &nc_off, nonce_cnt, stream_blk, msg, msg_out) != 0) {
+    return SRSLTE_ERROR;
+  }
+  return SRSLTE_SUCCESS;
+}
+
 /******************************************************************************
  * Authentication
  *****************************************************************************/
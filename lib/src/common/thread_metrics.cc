@@ -0,0 +1,316 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/thread_metrics.h"
+#include "srslte/common/openmetrics_writer.h"
+#include "srslte/phy/utils/mem_accounting.h"
+#include <algorithm>
+#include <atomic>
+#include <dirent.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace srslte {
+
+const char* to_string(thread_metric metric)
+{
+  static const char* names[] = {"phy_worker_time_us", "sched_time_us", "stack_queue_depth", "buffer_pool_used"};
+  return metric < thread_metric::nof_metrics ? names[(uint32_t)metric] : "unknown";
+}
+
+namespace thread_metrics {
+
+namespace {
+
+const uint32_t nof_metrics = (uint32_t)thread_metric::nof_metrics;
+
+const char* help(thread_metric metric)
+{
+  static const char* text[] = {"Processing time of a TTI by a PHY worker in microseconds",
+                               "Time taken by the MAC scheduler to allocate a TTI in microseconds",
+                               "Number of tasks pending in the stack queues, sampled every TTI",
+                               "Number of byte buffers taken from the pool, sampled every TTI"};
+  return text[(uint32_t)metric];
+}
+
+uint32_t bucket_of(uint32_t value)
+{
+  if (value <= 1) {
+    return 0;
+  }
+  // Smallest i such that value <= 2^i
+  return std::min<uint32_t>(32 - __builtin_clz(value - 1), nof_buckets - 1);
+}
+
+/// Histograms of a thread. Only the owner thread writes them, so the updates are plain stores, and they are read by
+/// any thread
+struct thread_buffer {
+  std::string           thread_name;
+  std::atomic<uint64_t> buckets[nof_metrics][nof_buckets];
+  std::atomic<uint64_t> count[nof_metrics];
+  std::atomic<uint64_t> sum[nof_metrics];
+
+  thread_buffer()
+  {
+    for (uint32_t m = 0; m < nof_metrics; ++m) {
+      for (uint32_t b = 0; b < nof_buckets; ++b) {
+        buckets[m][b].store(0, std::memory_order_relaxed);
+      }
+      count[m].store(0, std::memory_order_relaxed);
+      sum[m].store(0, std::memory_order_relaxed);
+    }
+  }
+};
+
+/// The buffers outlive their threads, so that the counts of the threads that exited are kept
+struct registry_t {
+  std::mutex                                  mutex;
+  std::vector<std::unique_ptr<thread_buffer>> buffers;
+};
+
+registry_t& registry()
+{
+  static registry_t r;
+  return r;
+}
+
+thread_local thread_buffer* local_buffer = nullptr;
+
+thread_buffer& get_local_buffer()
+{
+  if (local_buffer == nullptr) {
+    std::unique_ptr<thread_buffer> b(new thread_buffer);
+    char                           name[16] = {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+    b->thread_name = name;
+    local_buffer   = b.get();
+
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    registry().buffers.push_back(std::move(b));
+  }
+  return *local_buffer;
+}
+
+void add(std::atomic<uint64_t>& counter, uint64_t value)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/// Escapes a label value of the text format
+std::string escape(const std::string& s)
+{
+  std::string result;
+  for (char c : s) {
+    if (c == '\\' or c == '"') {
+      result += '\\';
+      result += c;
+    } else if (c == '\n') {
+      result += "\\n";
+    } else {
+      result += c;
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+void observe(thread_metric metric, uint32_t value)
+{
+  thread_buffer& b = get_local_buffer();
+  add(b.buckets[(uint32_t)metric][bucket_of(value)], 1);
+  add(b.sum[(uint32_t)metric], value);
+  add(b.count[(uint32_t)metric], 1);
+}
+
+std::vector<histogram_t> collect(thread_metric metric)
+{
+  std::map<std::string, histogram_t> merged;
+
+  std::lock_guard<std::mutex> lock(registry().mutex);
+  for (const auto& b : registry().buffers) {
+    if (b->count[(uint32_t)metric].load(std::memory_order_relaxed) == 0) {
+      continue;
+    }
+    auto it = merged.find(b->thread_name);
+    if (it == merged.end()) {
+      histogram_t h = {};
+      h.thread_name = b->thread_name;
+      it            = merged.emplace(b->thread_name, h).first;
+    }
+    histogram_t& h = it->second;
+    for (uint32_t i = 0; i < nof_buckets; ++i) {
+      h.buckets[i] += b->buckets[(uint32_t)metric][i].load(std::memory_order_relaxed);
+    }
+    h.sum += b->sum[(uint32_t)metric].load(std::memory_order_relaxed);
+  }
+
+  // The count is the sum of the buckets read, so that it is consistent with them while the owner keeps observing
+  std::vector<histogram_t> result;
+  for (auto& m : merged) {
+    m.second.count = 0;
+    for (uint32_t i = 0; i < nof_buckets; ++i) {
+      m.second.count += m.second.buckets[i];
+    }
+    result.push_back(m.second);
+  }
+  return result;
+}
+
+void write_openmetrics(const std::string& prefix, std::string& out)
+{
+  char line[256];
+  for (uint32_t m = 0; m < nof_metrics; ++m) {
+    std::vector<histogram_t> histograms = collect((thread_metric)m);
+    if (histograms.empty()) {
+      continue;
+    }
+    std::string name = prefix + to_string((thread_metric)m);
+    out += "# HELP " + name + " " + help((thread_metric)m) + "\n";
+    out += "# TYPE " + name + " histogram\n";
+    for (const histogram_t& h : histograms) {
+      std::string thread     = escape(h.thread_name);
+      uint64_t    cumulative = 0;
+      for (uint32_t i = 0; i < nof_buckets; ++i) {
+        cumulative += h.buckets[i];
+        if (i + 1 < nof_buckets) {
+          snprintf(line,
+                   sizeof(line),
+                   "%s_bucket{thread=\"%s\",le=\"%lu\"} %lu\n",
+                   name.c_str(),
+                   thread.c_str(),
+                   (unsigned long)bucket_limit(i),
+                   (unsigned long)cumulative);
+        } else {
+          snprintf(line,
+                   sizeof(line),
+                   "%s_bucket{thread=\"%s\",le=\"+Inf\"} %lu\n",
+                   name.c_str(),
+                   thread.c_str(),
+                   (unsigned long)cumulative);
+        }
+        out += line;
+      }
+      snprintf(line,
+               sizeof(line),
+               "%s_sum{thread=\"%s\"} %lu\n%s_count{thread=\"%s\"} %lu\n",
+               name.c_str(),
+               thread.c_str(),
+               (unsigned long)h.sum,
+               name.c_str(),
+               thread.c_str(),
+               (unsigned long)h.count);
+      out += line;
+    }
+  }
+}
+
+void write_thread_cpu_time(const std::string& prefix, std::string& out)
+{
+  DIR* dir = opendir("/proc/self/task");
+  if (dir == nullptr) {
+    return;
+  }
+
+  std::string name = prefix + "thread_cpu_seconds_total";
+  out += "# HELP " + name + " CPU time used by the thread in user and system mode\n";
+  out += "# TYPE " + name + " counter\n";
+
+  double         ticks_per_sec = (double)sysconf(_SC_CLK_TCK);
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%s/stat", entry->d_name);
+    FILE* f = fopen(path, "r");
+    if (f == nullptr) {
+      continue;
+    }
+    char   stat[1024] = {};
+    size_t len        = fread(stat, 1, sizeof(stat) - 1, f);
+    fclose(f);
+    stat[len] = '\0';
+
+    // The name is enclosed in parentheses and may contain spaces, utime and stime are the 12th and 13th fields after
+    char* open  = strchr(stat, '(');
+    char* close = strrchr(stat, ')');
+    if (open == nullptr or close == nullptr or close < open) {
+      continue;
+    }
+    std::string   thread(open + 1, close);
+    unsigned long utime = 0, stime = 0;
+    if (sscanf(close + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) != 2) {
+      continue;
+    }
+
+    char line[256];
+    snprintf(line,
+             sizeof(line),
+             "%s{thread=\"%s\",tid=\"%s\"} %.2f\n",
+             name.c_str(),
+             escape(thread).c_str(),
+             entry->d_name,
+             (utime + stime) / ticks_per_sec);
+    out += line;
+  }
+  closedir(dir);
+}
+
+void write_memory_usage(const std::string& prefix, std::string& out)
+{
+  srslte::openmetrics_writer w(prefix);
+
+  w.family("memory_bytes", "gauge", "Memory allocated by the subsystem");
+  for (uint32_t i = 0; i < SRSLTE_MEM_TAG_NOF_TAGS; i++) {
+    srslte_mem_tag_t tag = (srslte_mem_tag_t)i;
+    w.sample(std::string("subsystem=\"") + srslte_mem_tag_string(tag) + "\"", srslte_mem_get_usage(tag).bytes);
+  }
+  w.family("memory_objects", "gauge", "Allocations of the subsystem");
+  for (uint32_t i = 0; i < SRSLTE_MEM_TAG_NOF_TAGS; i++) {
+    srslte_mem_tag_t tag = (srslte_mem_tag_t)i;
+    w.sample(std::string("subsystem=\"") + srslte_mem_tag_string(tag) + "\"", srslte_mem_get_usage(tag).objects);
+  }
+
+  // The resident set size is the second field of statm, in pages
+  FILE* f = fopen("/proc/self/statm", "r");
+  if (f != nullptr) {
+    unsigned long size = 0, resident = 0;
+    if (fscanf(f, "%lu %lu", &size, &resident) == 2) {
+      w.family("resident_memory_bytes", "gauge", "Resident set size of the process");
+      w.sample((double)resident * sysconf(_SC_PAGESIZE));
+    }
+    fclose(f);
+  }
+
+  out += w.str();
+}
+
+} // namespace thread_metrics
+
+} // namespace srslte
@@ -20,6 +20,7 @@
  */
 
 #include "srslte/common/thread_pool.h"
+#include <algorithm>
 #include <assert.h>
 #include <chrono>
 #include <stdio.h>
@@ -73,6 +74,7 @@ thread_pool::thread_pool(uint32_t max_workers_) : workers(max_workers_), status(
   }
   running     = true;
   nof_workers = 0;
+  max_active  = max_workers;
 }
 
 void thread_pool::init_worker(uint32_t id, worker* obj, uint32_t prio, uint32_t mask)
@@ -146,7 +148,8 @@ void thread_pool::worker::finished()
 
 bool thread_pool::find_finished_worker(uint32_t tti, uint32_t* id)
 {
-  for (uint32_t i = 0; i < nof_workers; i++) {
+  uint32_t nof_active = std::min(nof_workers, max_active);
+  for (uint32_t i = 0; i < nof_active; i++) {
     if (status[i] == IDLE) {
       *id = i;
       return true;
@@ -248,16 +251,48 @@ uint32_t thread_pool::get_nof_workers()
   return nof_workers;
 }
 
+void thread_pool::set_nof_active_workers(uint32_t nof_active)
+{
+  std::lock_guard<std::mutex> lock(mutex_queue);
+  max_active = std::max(nof_active, 1u);
+  cvar_queue.notify_all();
+}
+
+uint32_t thread_pool::get_nof_active_workers()
+{
+  std::lock_guard<std::mutex> lock(mutex_queue);
+  return std::min(nof_workers, max_active);
+}
+
+bool thread_pool::wait_idle()
+{
+  std::unique_lock<std::mutex> lock(mutex_queue);
+  auto                         is_idle = [this]() {
+    return std::all_of(status.begin(), status.begin() + nof_workers, [](worker_status s) { return s == IDLE; });
+  };
+  while (running && !is_idle()) {
+    cvar_queue.wait(lock);
+  }
+  return running;
+}
+
 /**************************************************************************
  *  task_thread_pool - uses a queue to enqueue callables, that start
  *  once a worker is available
  *************************************************************************/
 
+const uint32_t task_thread_pool::nof_priorities;
+
+// The pool and the id of the worker running in the calling thread, if any
+static thread_local task_thread_pool* current_pool   = nullptr;
+static thread_local uint32_t          current_worker = 0;
+
 task_thread_pool::task_thread_pool(uint32_t nof_workers) : running(false)
 {
   workers.reserve(nof_workers);
   for (uint32_t i = 0; i < nof_workers; ++i) {
     workers.emplace_back(this, i);
+    queues.emplace_back(new worker_queue_t);
   }
 }
 
@@ -268,7 +303,7 @@ task_thread_pool::~task_thread_pool()
 
 void task_thread_pool::start(int32_t prio, uint32_t mask)
 {
-  std::lock_guard<std::mutex> lock(queue_mutex);
+  std::lock_guard<std::mutex> lock(sleep_mutex);
   running = true;
   for (worker_t& w : workers) {
     w.setup(prio, mask);
@@ -277,48 +312,64 @@ void task_thread_pool::start(int32_t prio, uint32_t mask)
 
 void task_thread_pool::stop()
 {
-  std::unique_lock<std::mutex> lock(queue_mutex);
+  std::unique_lock<std::mutex> lock(sleep_mutex);
   if (running) {
-    running              = false;
-    bool workers_running = false;
-    for (worker_t& w : workers) {
-      if (w.is_running()) {
-        workers_running = true;
-        break;
-      }
-    }
+    running = false;
     lock.unlock();
-    if (workers_running) {
-      cv_empty.notify_all();
-    }
+    cv_empty.notify_all();
     for (worker_t& w : workers) {
       w.stop();
     }
   }
 }
 
-void task_thread_pool::push_task(const task_t& task)
+void task_thread_pool::push_task(task_t&& task, task_priority priority)
 {
+  if (queues.empty()) {
+    return;
+  }
+  uint32_t idx = current_pool == this ? current_worker : next_queue++ % queues.size();
   {
-    std::lock_guard<std::mutex> lock(queue_mutex);
-    pending_tasks.push(task);
+    worker_queue_t&             q = *queues[idx];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    q.tasks[(uint32_t)priority].push_back(std::move(task));
+    nof_pending++;
+  }
+  // A worker that goes to sleep checks nof_pending after counting itself in nof_sleeping
+  if (nof_sleeping > 0) {
+    std::lock_guard<std::mutex> lock(sleep_mutex);
+    cv_empty.notify_one();
   }
-  cv_empty.notify_one();
 }
 
-void task_thread_pool::push_task(task_t&& task)
+uint32_t task_thread_pool::nof_pending_tasks()
 {
-  {
-    std::lock_guard<std::mutex> lock(queue_mutex);
-    pending_tasks.push(std::move(task));
-  }
-  cv_empty.notify_one();
+  return nof_pending;
 }
 
-uint32_t task_thread_pool::nof_pending_tasks()
+bool task_thread_pool::pop_task(uint32_t worker_id, task_t* task)
 {
-  std::lock_guard<std::mutex> lock(queue_mutex);
-  return pending_tasks.size();
+  for (uint32_t prio = 0; prio < nof_priorities; ++prio) {
+    // The own queue is served from the front and the queues of the other workers are stolen from the back
+    for (uint32_t i = 0; i < queues.size(); ++i) {
+      worker_queue_t&             q = *queues[(worker_id + i) % queues.size()];
+      std::lock_guard<std::mutex> lock(q.mutex);
+      std::deque<task_t>&         tasks = q.tasks[prio];
+      if (tasks.empty()) {
+        continue;
+      }
+      if (i == 0) {
+        *task = std::move(tasks.front());
+        tasks.pop_front();
+      } else {
+        *task = std::move(tasks.back());
+        tasks.pop_back();
+      }
+      nof_pending--;
+      return true;
+    }
+  }
+  return false;
 }
 
 task_thread_pool::worker_t::worker_t(srslte::task_thread_pool* parent_, uint32_t my_id) :
@@ -335,7 +386,6 @@ void task_thread_pool::worker_t::stop()
 
 void task_thread_pool::worker_t::setup(int32_t prio, uint32_t mask)
 {
-  running = true;
   if (mask == 255) {
     start(prio);
   } else {
@@ -345,31 +395,32 @@ void task_thread_pool::worker_t::setup(int32_t prio, uint32_t mask)
 
 bool task_thread_pool::worker_t::wait_task(task_t* task)
 {
-  std::unique_lock<std::mutex> lock(parent->queue_mutex);
-  while (parent->running and parent->pending_tasks.empty()) {
-    parent->cv_empty.wait(lock);
-  }
-  if (not parent->running) {
-    return false;
-  }
-  if (task) {
-    *task = std::move(parent->pending_tasks.front());
+  while (parent->running) {
+    if (parent->nof_pending > 0 and parent->pop_task(id_, task)) {
+      return true;
+    }
+    std::unique_lock<std::mutex> lock(parent->sleep_mutex);
+    parent->nof_sleeping++;
+    while (parent->running and parent->nof_pending == 0) {
+      parent->cv_empty.wait(lock);
+    }
+    parent->nof_sleeping--;
   }
-  parent->pending_tasks.pop();
-  return true;
+  return false;
 }
 
 void task_thread_pool::worker_t::run_thread()
 {
+  current_pool   = parent;
+  current_worker = id_;
+
   // main loop
   task_t task;
   while (wait_task(&task)) {
     task(id());
+    // the captures of the task are released before waiting for the next one
+    task = task_t{};
   }
-
-  // on exit, notify pool class
-  std::unique_lock<std::mutex> lock(parent->queue_mutex);
-  running = false;
 }
 
 } // namespace srslte
@@ -19,11 +19,18 @@
  *
  */
 
+#include <ctype.h>
+#include <dirent.h>
 #include <errno.h>
+#include <linux/mempolicy.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 
 #include "srslte/common/threads.h"
@@ -212,3 +219,342 @@ void threads_print_self()
 
   printf("Sched policy is %s. Priority is %d\n", p, param.sched_priority);
 }
+
+/* Thread placements, written at start-up before the threads they apply to are created */
+#define THREADS_MAX_PLACEMENTS 32
+#define THREADS_ROLE_LEN 16
+
+typedef struct {
+  char      role[THREADS_ROLE_LEN];
+  bool      cpus_enable;
+  cpu_set_t cpus;
+  int       policy; // -1 keeps the policy of the thread
+  int       priority;
+} threads_placement_t;
+
+static threads_placement_t placements[THREADS_MAX_PLACEMENTS];
+static int                 nof_placements = 0;
+
+// Parses a list of CPUs and ranges such as "0,2-3"
+static bool parse_cpus(const char* str, cpu_set_t* cpus)
+{
+  CPU_ZERO(cpus);
+  const char* ptr = str;
+  while (*ptr) {
+    char* end   = NULL;
+    long  first = strtol(ptr, &end, 10);
+    long  last  = first;
+    if (end == ptr || first < 0) {
+      return false;
+    }
+    ptr = end;
+    if (*ptr == '-') {
+      ptr++;
+      last = strtol(ptr, &end, 10);
+      if (end == ptr || last < first) {
+        return false;
+      }
+      ptr = end;
+    }
+    if (last >= CPU_SETSIZE) {
+      return false;
+    }
+    for (long i = first; i <= last; i++) {
+      CPU_SET((size_t)i, cpus);
+    }
+    if (*ptr == ',') {
+      ptr++;
+    } else if (*ptr) {
+      return false;
+    }
+  }
+  return CPU_COUNT(cpus) > 0;
+}
+
+// Replaces the placement of the role if it was already set
+static bool store_placement(const threads_placement_t* p)
+{
+  int idx = 0;
+  while (idx < nof_placements && strcmp(placements[idx].role, p->role) != 0) {
+    idx++;
+  }
+  if (idx == THREADS_MAX_PLACEMENTS) {
+    fprintf(stderr, "Too many thread placements\n");
+    return false;
+  }
+  placements[idx] = *p;
+  if (idx == nof_placements) {
+    nof_placements++;
+  }
+  return true;
+}
+
+bool threads_set_placement(const char* role, const char* placement)
+{
+  if (role == NULL || placement == NULL || strlen(role) == 0 || strlen(role) >= THREADS_ROLE_LEN) {
+    return false;
+  }
+  if (strlen(placement) == 0) {
+    return true;
+  }
+
+  threads_placement_t p = {};
+  strncpy(p.role, role, THREADS_ROLE_LEN - 1);
+  p.policy = -1;
+
+  // Split "cpus[:policy[:priority]]"
+  char  buffer[256] = {};
+  char* fields[3]   = {buffer, NULL, NULL};
+  strncpy(buffer, placement, sizeof(buffer) - 1);
+  for (int i = 1; i < 3; i++) {
+    char* sep = strchr(fields[i - 1], ':');
+    if (sep == NULL) {
+      break;
+    }
+    *sep      = '\0';
+    fields[i] = sep + 1;
+  }
+
+  if (strlen(fields[0]) > 0) {
+    if (!parse_cpus(fields[0], &p.cpus)) {
+      fprintf(stderr, "Invalid CPU list '%s' for thread %s\n", fields[0], role);
+      return false;
+    }
+    p.cpus_enable = true;
+  }
+
+  if (fields[1] != NULL && strlen(fields[1]) > 0) {
+    if (!strcasecmp(fields[1], "other")) {
+      p.policy = SCHED_OTHER;
+    } else if (!strcasecmp(fields[1], "fifo")) {
+      p.policy = SCHED_FIFO;
+    } else if (!strcasecmp(fields[1], "rr")) {
+      p.policy = SCHED_RR;
+    } else {
+      fprintf(stderr, "Invalid scheduling policy '%s' for thread %s\n", fields[1], role);
+      return false;
+    }
+  }
+
+  if (fields[2] != NULL && strlen(fields[2]) > 0) {
+    p.priority = (int)strtol(fields[2], NULL, 10);
+    if (p.policy != SCHED_FIFO && p.policy != SCHED_RR) {
+      fprintf(stderr, "A priority for thread %s needs the fifo or rr policy\n", role);
+      return false;
+    }
+    if (p.priority < sched_get_priority_min(p.policy) || p.priority > sched_get_priority_max(p.policy)) {
+      fprintf(stderr, "Invalid priority %d for thread %s\n", p.priority, role);
+      return false;
+    }
+  } else if (p.policy == SCHED_FIFO || p.policy == SCHED_RR) {
+    p.priority = sched_get_priority_max(p.policy) - DEFAULT_PRIORITY;
+  }
+
+  return store_placement(&p);
+}
+
+// A role matches the thread of the same name and its numbered instances, e.g. WORKER matches WORKER0 but SYNC does not
+// match SYNC_INTRA_MEASURE. A role ending with '_' matches all the names it starts, e.g. RF_ matches RF_RX0 and RF_TX
+static bool role_matches(const char* role, const char* name)
+{
+  size_t len = strlen(role);
+  if (strncmp(name, role, len) != 0) {
+    return false;
+  }
+  if (role[len - 1] == '_') {
+    return true;
+  }
+  for (const char* c = name + len; *c; c++) {
+    if (!isdigit((unsigned char)*c)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The longest matching role wins, so that WORKER1 is placed by its own role before the one of WORKER
+static const threads_placement_t* find_placement(const char* name)
+{
+  const threads_placement_t* found = NULL;
+  for (int i = 0; i < nof_placements; i++) {
+    size_t len = strlen(placements[i].role);
+    if (role_matches(placements[i].role, name) && (found == NULL || len > strlen(found->role))) {
+      found = &placements[i];
+    }
+  }
+  return found;
+}
+
+static void apply_placement(pid_t tid, const char* name, const threads_placement_t* p)
+{
+  if (p->cpus_enable && sched_setaffinity(tid, sizeof(cpu_set_t), &p->cpus)) {
+    fprintf(stderr, "Error setting the CPU affinity of thread %s: %s\n", name, strerror(errno));
+  }
+  if (p->policy >= 0) {
+    struct sched_param param = {};
+    param.sched_priority     = p->priority;
+    if (sched_setscheduler(tid, p->policy, &param)) {
+      fprintf(stderr, "Error setting the scheduling of thread %s: %s\n", name, strerror(errno));
+    }
+  }
+}
+
+bool threads_apply_placement(const char* name)
+{
+  const threads_placement_t* p = find_placement(name);
+  if (p == NULL) {
+    return false;
+  }
+  apply_placement((pid_t)syscall(SYS_gettid), name, p);
+  return true;
+}
+
+void threads_apply_placement_all()
+{
+  if (nof_placements == 0) {
+    return;
+  }
+
+  DIR* dir = opendir("/proc/self/task");
+  if (dir == NULL) {
+    perror("opendir");
+    return;
+  }
+
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != NULL) {
+    pid_t tid = (pid_t)strtol(entry->d_name, NULL, 10);
+    if (tid <= 0) {
+      continue;
+    }
+
+    char path[64] = {};
+    char name[32] = {};
+    snprintf(path, sizeof(path), "/proc/self/task/%d/comm", tid);
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+      continue;
+    }
+    if (fgets(name, sizeof(name), f) != NULL) {
+      name[strcspn(name, "\n")] = '\0';
+      const threads_placement_t* p = find_placement(name);
+      if (p != NULL) {
+        apply_placement(tid, name, p);
+      }
+    }
+    fclose(f);
+  }
+  closedir(dir);
+}
+
+// The NUMA node of a CPU is given by the nodeN entry in its sysfs directory. Returns -1 without NUMA support
+static int cpu_node(int cpu)
+{
+  char path[64] = {};
+  snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+  DIR* dir = opendir(path);
+  if (dir == NULL) {
+    return -1;
+  }
+  int            node = -1;
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (strncmp(entry->d_name, "node", 4) == 0 && isdigit((unsigned char)entry->d_name[4])) {
+      node = (int)strtol(entry->d_name + 4, NULL, 10);
+      break;
+    }
+  }
+  closedir(dir);
+  return node;
+}
+
+int threads_placement_node(const char* name)
+{
+  const threads_placement_t* p = find_placement(name);
+  if (p == NULL || !p->cpus_enable) {
+    return -1;
+  }
+  int node = -1;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (!CPU_ISSET((size_t)cpu, &p->cpus)) {
+      continue;
+    }
+    int n = cpu_node(cpu);
+    if (n < 0 || (node >= 0 && n != node)) {
+      return -1;
+    }
+    node = n;
+  }
+  return node;
+}
+
+bool threads_spread_placement(const char* role, int nof_threads)
+{
+  threads_placement_t p = {};
+  p.policy              = -1;
+  for (int i = 0; i < nof_placements; i++) {
+    if (strcmp(placements[i].role, role) == 0) {
+      p = placements[i];
+    }
+  }
+  // Without a placement, the threads are spread over the CPUs the process can run on
+  if (!p.cpus_enable && sched_getaffinity(0, sizeof(cpu_set_t), &p.cpus)) {
+    return false;
+  }
+
+  // The nodes, in the order of their first CPU
+  int node_of_cpu[CPU_SETSIZE];
+  int nodes[CPU_SETSIZE];
+  int nof_nodes = 0;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    node_of_cpu[cpu] = CPU_ISSET((size_t)cpu, &p.cpus) ? cpu_node(cpu) : -1;
+    if (node_of_cpu[cpu] < 0) {
+      continue;
+    }
+    int n = 0;
+    while (n < nof_nodes && nodes[n] != node_of_cpu[cpu]) {
+      n++;
+    }
+    if (n == nof_nodes) {
+      nodes[nof_nodes++] = node_of_cpu[cpu];
+    }
+  }
+  if (nof_nodes < 2) {
+    return false;
+  }
+
+  for (int i = 0; i < nof_threads; i++) {
+    threads_placement_t t = p;
+    if (snprintf(t.role, THREADS_ROLE_LEN, "%s%d", role, i) >= THREADS_ROLE_LEN) {
+      return false;
+    }
+    t.cpus_enable = true;
+    CPU_ZERO(&t.cpus);
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (node_of_cpu[cpu] == nodes[i % nof_nodes]) {
+        CPU_SET((size_t)cpu, &t.cpus);
+      }
+    }
+    if (!store_placement(&t)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool threads_set_memory_node(int node)
+{
+  unsigned long mask = 0;
+  if (node >= (int)(8 * sizeof(mask))) {
+    return false;
+  }
+  long ret;
+  if (node >= 0) {
+    mask = 1UL << (unsigned)node;
+    // maxnode counts one more than the number of bits in the mask
+    ret = syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, 8 * sizeof(mask) + 1);
+  } else {
+    ret = syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+  }
+  return ret == 0;
+}
@@ -95,6 +95,12 @@ sliding_window_stats<TUnit>::sliding_window_stats(const char* name_, const char*
 
 template <typename TUnit>
 void sliding_window_stats<TUnit>::operator()(nanoseconds duration)
+{
+  (*this)(duration, perf_counter_values{});
+}
+
+template <typename TUnit>
+void sliding_window_stats<TUnit>::operator()(nanoseconds duration, const perf_counter_values& counters)
 {
   using std::chrono::duration_cast;
   const char* unit_str = get_tunit_str<TUnit>();
@@ -103,6 +109,7 @@ void sliding_window_stats<TUnit>::operator()(nanoseconds duration)
   log_ptr->debug("%s: duration=%" PRId64 " %s\n", name.c_str(), dur.count(), unit_str);
 
   sliding_window[window_idx++] = duration;
+  window_counters += counters;
   if (window_idx == sliding_window.size()) {
     nanoseconds tsum  = accumulate(sliding_window.begin(), sliding_window.end(), std::chrono::nanoseconds{0});
     nanoseconds tmax  = *std::max_element(sliding_window.begin(), sliding_window.end());
@@ -115,7 +122,16 @@ void sliding_window_stats<TUnit>::operator()(nanoseconds duration)
                   duration_cast<TUnit>(tmax).count(),
                   duration_cast<TUnit>(tmin).count(),
                   unit_str);
-    window_idx = 0;
+    if (window_counters.cycles > 0) {
+      log_ptr->info("%s: IPC=%.2f, L1D misses=%.1f, LLC misses=%.2f, branch misses=%.2f per kinstr\n",
+                    name.c_str(),
+                    window_counters.ipc(),
+                    window_counters.per_kinstr(window_counters.l1d_misses),
+                    window_counters.per_kinstr(window_counters.llc_misses),
+                    window_counters.per_kinstr(window_counters.branch_misses));
+    }
+    window_idx      = 0;
+    window_counters = {};
   }
 }
 
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include "srslte/common/tti_deadline_watchdog.h"
+#include "srslte/common/common.h"
+#include "srslte/common/tti_trace.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+
+namespace srslte {
+
+namespace {
+
+/// Number of TTIs over which the smallest reception delay is taken, so that the clocks may drift slowly
+const uint32_t window_nof_tti = 1000;
+
+/// Number of TTIs before the offending one whose stages are in the snapshot
+const uint32_t snapshot_nof_tti = 4;
+
+/// Time given to the workers to finish the offending TTI before taking the snapshot
+const std::chrono::milliseconds snapshot_delay(20);
+
+struct context_registry_t {
+  std::mutex                                                         mutex;
+  std::vector<std::pair<std::string, std::function<std::string()> > > sources;
+};
+
+context_registry_t& context_registry()
+{
+  static context_registry_t r;
+  return r;
+}
+
+int64_t timestamp_ns(const srslte_timestamp_t& t)
+{
+  return (int64_t)t.full_secs * 1000000000 + (int64_t)(t.frac_secs * 1e9);
+}
+
+const char* to_string(tti_deadline_watchdog::miss_type type)
+{
+  return type == tti_deadline_watchdog::miss_type::rx_behind ? "rx_behind" : "tx_late";
+}
+
+} // namespace
+
+tti_deadline_watchdog::tti_deadline_watchdog(const std::string& thread_name) : thread(thread_name) {}
+
+tti_deadline_watchdog::~tti_deadline_watchdog()
+{
+  stop();
+}
+
+void tti_deadline_watchdog::init(const deadline_watchdog_args_t& args_, srslte::log* log_h_)
+{
+  args  = args_;
+  log_h = log_h_;
+  if (not args.dump_filename.empty()) {
+    running = true;
+    start(-1);
+  }
+}
+
+void tti_deadline_watchdog::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (not running) {
+      return;
+    }
+    running = false;
+  }
+  cvar.notify_one();
+  wait_thread_finish();
+}
+
+void tti_deadline_watchdog::rx_done(uint32_t tti, const srslte_timestamp_t& rx_time)
+{
+  int64_t delay_ns = (int64_t)tti_trace::now_ns() - (timestamp_ns(rx_time) + 1000000);
+
+  window_min_ns = std::min(window_min_ns, delay_ns);
+  if (++window_count == window_nof_tti) {
+    prev_window_min_ns = window_min_ns;
+    window_min_ns      = INT64_MAX;
+    window_count       = 0;
+  }
+  int64_t min_delay_ns = std::min(prev_window_min_ns, std::min(window_min_ns, delay_ns));
+  offset_ns.store(min_delay_ns, std::memory_order_relaxed);
+
+  // A late reception is reported once until the receiving thread catches up
+  int64_t lag_ns = delay_ns - min_delay_ns;
+  if (lag_ns > (int64_t)args.rx_lag_us * 1000) {
+    if (not rx_behind) {
+      rx_behind = true;
+      miss(tti, miss_type::rx_behind, lag_ns);
+    }
+  } else if (lag_ns < (int64_t)args.rx_lag_us * 500) {
+    rx_behind = false;
+  }
+}
+
+void tti_deadline_watchdog::tx_ready(uint32_t tti, const srslte_timestamp_t& tx_time)
+{
+  int64_t offset = offset_ns.load(std::memory_order_relaxed);
+  if (offset == INT64_MAX) {
+    return;
+  }
+  int64_t lead_ns = timestamp_ns(tx_time) - ((int64_t)tti_trace::now_ns() - offset);
+  if (lead_ns < (int64_t)args.tx_margin_us * 1000) {
+    miss(tti, miss_type::tx_late, lead_ns);
+  }
+}
+
+void tti_deadline_watchdog::miss(uint32_t tti, miss_type type, int64_t time_ns)
+{
+  uint64_t index = nof_misses.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (log_h != nullptr) {
+    if (type == miss_type::rx_behind) {
+      log_h->warning("Deadline miss in TTI %d: subframe received %.0f us late\n", tti, time_ns / 1000.0);
+    } else {
+      log_h->warning("Deadline miss in TTI %d: Tx handed to the radio %.0f us before its Tx time\n",
+                     tti,
+                     time_ns / 1000.0);
+    }
+  }
+
+  // Misses are rare, so the mutex is not in the way of the real-time threads
+  std::unique_lock<std::mutex> lock(mutex);
+  int64_t                      now_ns = (int64_t)tti_trace::now_ns();
+  if (not running or nof_dumps >= args.max_dumps or
+      (last_request_ns != 0 and now_ns - last_request_ns < (int64_t)args.dump_period_ms * 1000000)) {
+    return;
+  }
+  last_request_ns = now_ns;
+  nof_dumps++;
+  pending.push_back({tti, type, time_ns, index});
+  lock.unlock();
+  cvar.notify_one();
+}
+
+void tti_deadline_watchdog::run_thread()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    while (running and pending.empty()) {
+      cvar.wait(lock);
+    }
+    // The pending snapshots are written before stopping
+    if (pending.empty()) {
+      break;
+    }
+    miss_t m = pending.front();
+    pending.erase(pending.begin());
+    lock.unlock();
+
+    std::this_thread::sleep_for(snapshot_delay);
+    std::string snapshot = build_snapshot(m);
+    FILE*       f        = fopen(args.dump_filename.c_str(), "a");
+    if (f != nullptr) {
+      fwrite(snapshot.data(), 1, snapshot.size(), f);
+      fclose(f);
+    } else if (log_h != nullptr) {
+      log_h->error("Opening deadline miss snapshot file %s\n", args.dump_filename.c_str());
+    }
+
+    lock.lock();
+  }
+}
+
+std::string tti_deadline_watchdog::build_snapshot(const miss_t& m)
+{
+  struct stage_t {
+    const std::string* thread_name;
+    tti_trace::span_t  span;
+  };
+
+  char        line[256];
+  std::string s;
+  snprintf(line,
+           sizeof(line),
+           "=== Deadline miss %s in TTI %d, %.1f us, miss %lu\n",
+           to_string(m.type),
+           m.tti,
+           m.time_ns / 1000.0,
+           (unsigned long)m.index);
+  s += line;
+
+  // Stages of the offending TTI and of the previous ones, in start order
+  std::vector<tti_trace::thread_spans_t> threads = tti_trace::collect();
+  std::vector<stage_t>                   stages;
+  for (const tti_trace::thread_spans_t& t : threads) {
+    for (const tti_trace::span_t& span : t.spans) {
+      if (TTI_SUB(m.tti, span.tti) <= snapshot_nof_tti) {
+        stages.push_back({&t.thread_name, span});
+      }
+    }
+  }
+  std::sort(stages.begin(), stages.end(), [](const stage_t& a, const stage_t& b) {
+    return a.span.start_ns < b.span.start_ns;
+  });
+
+  s += "--- stages\n     tti stage          thread           start (us)  dur (us)\n";
+  for (const stage_t& stage : stages) {
+    snprintf(line,
+             sizeof(line),
+             "%8d %-14s %-16s %10.1f %9.1f\n",
+             stage.span.tti,
+             to_string(stage.span.stage),
+             stage.thread_name->c_str(),
+             (stage.span.start_ns - stages.front().span.start_ns) / 1000.0,
+             stage.span.duration_ns / 1000.0);
+    s += line;
+  }
+
+  std::lock_guard<std::mutex> lock(context_registry().mutex);
+  for (const auto& source : context_registry().sources) {
+    s += "--- " + source.first + "\n" + source.second();
+    if (not s.empty() and s.back() != '\n') {
+      s += '\n';
+    }
+  }
+  s += "\n";
+  return s;
+}
+
+void tti_deadline_watchdog::add_context_source(const std::string& name, std::function<std::string()> source)
+{
+  std::lock_guard<std::mutex> lock(context_registry().mutex);
+  context_registry().sources.emplace_back(name, std::move(source));
+}
+
+void tti_deadline_watchdog::remove_context_source(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(context_registry().mutex);
+  auto&                       sources = context_registry().sources;
+  sources.erase(std::remove_if(sources.begin(),
+                               sources.end(),
+                               [&name](const std::pair<std::string, std::function<std::string()> >& source) {
+                                 return source.first == name;
+                               }),
+                sources.end());
+}
+
+} // namespace srslte
@@ -0,0 +1,362 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include "srslte/common/tti_trace.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace srslte {
+
+const char* to_string(tti_stage stage)
+{
+  static const char* names[] = {"rf_recv",
+                                "fft",
+                                "chest",
+                                "pdcch_decode",
+                                "pdsch_decode",
+                                "pusch_decode",
+                                "pucch_decode",
+                                "dl_sched",
+                                "ul_sched",
+                                "mac_pdu_build",
+                                "pdsch_encode",
+                                "pusch_encode",
+                                "ifft",
+                                "rf_send",
+                                "worker"};
+  return stage < tti_stage::nof_stages ? names[(uint32_t)stage] : "unknown";
+}
+
+namespace tti_trace {
+
+namespace {
+
+const uint32_t nof_stages   = (uint32_t)tti_stage::nof_stages;
+const uint32_t nof_buckets  = 100;
+const uint32_t nof_counters = 5;
+
+/// The durations are counted in units of 64 ns, in 4 buckets per octave above 256 ns
+uint32_t bucket_of(uint32_t duration_ns)
+{
+  uint32_t v = duration_ns >> 6u;
+  if (v < 4) {
+    return v;
+  }
+  uint32_t msb = 31 - __builtin_clz(v);
+  return (msb - 1) * 4 + ((v >> (msb - 2)) & 3u);
+}
+
+/// Upper bound of the durations counted in the bucket
+uint64_t bucket_limit_ns(uint32_t bucket)
+{
+  if (bucket < 4) {
+    return (bucket + 1) * 64;
+  }
+  uint32_t msb = bucket / 4 + 1;
+  return ((uint64_t)(5 + bucket % 4) << (msb - 2)) * 64;
+}
+
+/// Spans and histograms of a thread. Only the owner thread writes them, so the updates are plain stores, and they
+/// are read by any thread. A reader copies the spans and then discards those that the owner overwrote meanwhile
+struct thread_buffer {
+  std::string               thread_name;
+  uint32_t                  tid = 0;
+  std::unique_ptr<span_t[]> spans{new span_t[thread_buffer_size]};
+  std::atomic<uint64_t>     nof_spans{0};
+  std::atomic<uint32_t>     histogram[nof_stages][nof_buckets];
+  std::atomic<uint32_t>     max_ns[nof_stages];
+  std::atomic<uint64_t>     counters[nof_stages][nof_counters];
+
+  thread_buffer()
+  {
+    for (uint32_t s = 0; s < nof_stages; ++s) {
+      for (uint32_t b = 0; b < nof_buckets; ++b) {
+        histogram[s][b].store(0, std::memory_order_relaxed);
+      }
+      max_ns[s].store(0, std::memory_order_relaxed);
+      for (uint32_t c = 0; c < nof_counters; ++c) {
+        counters[s][c].store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+};
+
+/// The buffers outlive their threads, so that the spans of the threads that exited can still be exported
+struct registry_t {
+  std::mutex                                  mutex;
+  std::vector<std::unique_ptr<thread_buffer>> buffers;
+};
+
+registry_t& registry()
+{
+  static registry_t r;
+  return r;
+}
+
+thread_local thread_buffer* local_buffer = nullptr;
+thread_local uint32_t       local_tti    = 0;
+
+thread_buffer& get_local_buffer()
+{
+  if (local_buffer == nullptr) {
+    std::unique_ptr<thread_buffer> b(new thread_buffer);
+    char                           name[16] = {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+    b->thread_name = name;
+    b->tid         = (uint32_t)syscall(SYS_gettid);
+    local_buffer   = b.get();
+
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    registry().buffers.push_back(std::move(b));
+  }
+  return *local_buffer;
+}
+
+void increment(std::atomic<uint32_t>& counter)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void add(std::atomic<uint64_t>& counter, uint64_t value)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+} // namespace
+
+void set_thread_tti(uint32_t tti)
+{
+  local_tti = tti;
+}
+
+uint32_t get_thread_tti()
+{
+  return local_tti;
+}
+
+void record(tti_stage stage, uint32_t tti, uint64_t start_ns, uint64_t end_ns)
+{
+  thread_buffer& b        = get_local_buffer();
+  uint32_t       duration = (uint32_t)std::min<uint64_t>(end_ns - start_ns, UINT32_MAX);
+
+  uint64_t n                                = b.nof_spans.load(std::memory_order_relaxed);
+  b.spans[n % thread_buffer_size].start_ns    = start_ns;
+  b.spans[n % thread_buffer_size].duration_ns = duration;
+  b.spans[n % thread_buffer_size].tti         = tti;
+  b.spans[n % thread_buffer_size].stage       = stage;
+  b.nof_spans.store(n + 1, std::memory_order_release);
+
+  increment(b.histogram[(uint32_t)stage][bucket_of(duration)]);
+  if (duration > b.max_ns[(uint32_t)stage].load(std::memory_order_relaxed)) {
+    b.max_ns[(uint32_t)stage].store(duration, std::memory_order_relaxed);
+  }
+}
+
+void record_counters(tti_stage stage, const perf_counter_values& counters)
+{
+  std::atomic<uint64_t>* c = get_local_buffer().counters[(uint32_t)stage];
+  add(c[0], counters.cycles);
+  add(c[1], counters.instructions);
+  add(c[2], counters.l1d_misses);
+  add(c[3], counters.llc_misses);
+  add(c[4], counters.branch_misses);
+}
+
+std::vector<thread_spans_t> collect()
+{
+  std::vector<thread_spans_t> result;
+
+  std::lock_guard<std::mutex> lock(registry().mutex);
+  for (const auto& b : registry().buffers) {
+    thread_spans_t t;
+    t.thread_name = b->thread_name;
+    t.tid         = b->tid;
+
+    uint64_t end   = b->nof_spans.load(std::memory_order_acquire);
+    uint64_t begin = end > thread_buffer_size ? end - thread_buffer_size : 0;
+    for (uint64_t i = begin; i < end; ++i) {
+      t.spans.push_back(b->spans[i % thread_buffer_size]);
+    }
+    // Drop the oldest spans if the thread overwrote them while they were copied
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t new_end = b->nof_spans.load(std::memory_order_relaxed);
+    if (new_end > begin + thread_buffer_size) {
+      size_t nof_overwritten = std::min<uint64_t>(new_end - begin - thread_buffer_size, t.spans.size());
+      t.spans.erase(t.spans.begin(), t.spans.begin() + nof_overwritten);
+    }
+
+    if (not t.spans.empty()) {
+      result.push_back(std::move(t));
+    }
+  }
+  return result;
+}
+
+std::vector<span_t> collect_tti(uint32_t tti)
+{
+  std::vector<span_t> result;
+  for (const thread_spans_t& t : collect()) {
+    for (const span_t& s : t.spans) {
+      if (s.tti == tti) {
+        result.push_back(s);
+      }
+    }
+  }
+  std::sort(result.begin(), result.end(), [](const span_t& a, const span_t& b) { return a.start_ns < b.start_ns; });
+  return result;
+}
+
+stage_summary_t get_summary(tti_stage stage)
+{
+  uint64_t histogram[nof_buckets] = {};
+  uint32_t max_ns                 = 0;
+  {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    for (const auto& b : registry().buffers) {
+      for (uint32_t i = 0; i < nof_buckets; ++i) {
+        histogram[i] += b->histogram[(uint32_t)stage][i].load(std::memory_order_relaxed);
+      }
+      max_ns = std::max(max_ns, b->max_ns[(uint32_t)stage].load(std::memory_order_relaxed));
+    }
+  }
+
+  stage_summary_t summary = {};
+  for (uint32_t i = 0; i < nof_buckets; ++i) {
+    summary.count += histogram[i];
+  }
+  if (summary.count == 0) {
+    return summary;
+  }
+
+  // The percentiles are the upper limits of their buckets, bounded by the maximum
+  uint64_t p50_rank = (summary.count + 1) / 2;
+  uint64_t p99_rank = summary.count - summary.count / 100;
+  uint64_t sum      = 0;
+  for (uint32_t i = 0; i < nof_buckets; ++i) {
+    uint64_t prev = sum;
+    sum += histogram[i];
+    uint32_t limit_us = (uint32_t)(std::min<uint64_t>(bucket_limit_ns(i), max_ns) / 1000);
+    if (prev < p50_rank and sum >= p50_rank) {
+      summary.p50_us = limit_us;
+    }
+    if (prev < p99_rank and sum >= p99_rank) {
+      summary.p99_us = limit_us;
+    }
+  }
+  summary.max_us = max_ns / 1000;
+  return summary;
+}
+
+perf_counter_values get_counters(tti_stage stage)
+{
+  perf_counter_values         total;
+  std::lock_guard<std::mutex> lock(registry().mutex);
+  for (const auto& b : registry().buffers) {
+    const std::atomic<uint64_t>* c = b->counters[(uint32_t)stage];
+    total.cycles += c[0].load(std::memory_order_relaxed);
+    total.instructions += c[1].load(std::memory_order_relaxed);
+    total.l1d_misses += c[2].load(std::memory_order_relaxed);
+    total.llc_misses += c[3].load(std::memory_order_relaxed);
+    total.branch_misses += c[4].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+std::string summary_to_string()
+{
+  // The hardware events are given per thousand instructions
+  bool        with_counters = perf_counters::is_enabled();
+  std::string s             = "Stage            count    p50 (us)  p99 (us)  max (us)";
+  s += with_counters ? "    IPC  L1D/ki  LLC/ki  brm/ki\n" : "\n";
+  for (uint32_t i = 0; i < nof_stages; ++i) {
+    stage_summary_t summary = get_summary((tti_stage)i);
+    if (summary.count == 0) {
+      continue;
+    }
+    char line[128];
+    snprintf(line,
+             sizeof(line),
+             "%-14s %9lu %9u %9u %9u",
+             to_string((tti_stage)i),
+             (unsigned long)summary.count,
+             summary.p50_us,
+             summary.p99_us,
+             summary.max_us);
+    s += line;
+    if (with_counters) {
+      perf_counter_values c = get_counters((tti_stage)i);
+      snprintf(line,
+               sizeof(line),
+               " %6.2f %7.1f %7.2f %7.2f",
+               c.ipc(),
+               c.per_kinstr(c.l1d_misses),
+               c.per_kinstr(c.llc_misses),
+               c.per_kinstr(c.branch_misses));
+      s += line;
+    }
+    s += "\n";
+  }
+  return s;
+}
+
+bool write_chrome_trace(const std::string& filename)
+{
+  FILE* f = fopen(filename.c_str(), "w");
+  if (f == nullptr) {
+    perror("Opening TTI trace file");
+    return false;
+  }
+
+  fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  bool first = true;
+  for (const thread_spans_t& t : collect()) {
+    fprintf(f,
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            first ? "" : ",\n",
+            t.tid,
+            t.thread_name.c_str());
+    first = false;
+    for (const span_t& s : t.spans) {
+      fprintf(f,
+              ",\n{\"name\":\"%s\",\"cat\":\"tti\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+              "\"args\":{\"tti\":%u}}",
+              to_string(s.stage),
+              t.tid,
+              s.start_ns / 1000.0,
+              s.duration_ns / 1000.0,
+              s.tti);
+    }
+  }
+  fprintf(f, "\n]}\n");
+  fclose(f);
+  return true;
+}
+
+} // namespace tti_trace
+
+} // namespace srslte
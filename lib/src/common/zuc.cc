@@ -66,32 +66,21 @@ u32 EK_d[16] = {0x44D7,
                 0x789A,
                 0x47AC};
 
-/* ——————————————————————- */
-/* c = a + b mod (2^31 – 1) */
-u32 AddM(u32 a, u32 b)
+/* s16 = 2^15 s15 + 2^17 s13 + 2^21 s10 + 2^20 s4 + (1 + 2^8) s0 + u mod (2^31 - 1)
+ * The terms are added in 64 bits and reduced at the end instead of after every addition */
+static u32 LFSRFeedback(zuc_state_t* state, u32 u)
 {
-  u32 c = a + b;
-  return (c & 0x7FFFFFFF) + (c >> 31);
+  unsigned long long f = (unsigned long long)state->LFSR_S0 + MulByPow2(state->LFSR_S0, 8) +
+                         MulByPow2(state->LFSR_S4, 20) + MulByPow2(state->LFSR_S10, 21) +
+                         MulByPow2(state->LFSR_S13, 17) + MulByPow2(state->LFSR_S15, 15) + u;
+  f = (f & 0x7FFFFFFF) + (f >> 31);
+  f = (f & 0x7FFFFFFF) + (f >> 31);
+  return (u32)f;
 }
 
-/* LFSR with initialization mode */
-void LFSRWithInitialisationMode(zuc_state_t* state, u32 u)
+/* update the state */
+static void LFSRShift(zuc_state_t* state, u32 f)
 {
-  u32 f, v;
-  f = state->LFSR_S0;
-  v = MulByPow2(state->LFSR_S0, 8);
-  f = AddM(f, v);
-  v = MulByPow2(state->LFSR_S4, 20);
-  f = AddM(f, v);
-  v = MulByPow2(state->LFSR_S10, 21);
-  f = AddM(f, v);
-  v = MulByPow2(state->LFSR_S13, 17);
-  f = AddM(f, v);
-  v = MulByPow2(state->LFSR_S15, 15);
-  f = AddM(f, v);
-  f = AddM(f, u);
-
-  /* update the state */
   state->LFSR_S0  = state->LFSR_S1;
   state->LFSR_S1  = state->LFSR_S2;
   state->LFSR_S2  = state->LFSR_S3;
@@ -110,39 +99,16 @@ void LFSRWithInitialisationMode(zuc_state_t* state, u32 u)
   state->LFSR_S15 = f;
 }
 
+/* LFSR with initialization mode */
+void LFSRWithInitialisationMode(zuc_state_t* state, u32 u)
+{
+  LFSRShift(state, LFSRFeedback(state, u));
+}
+
 /* LFSR with work mode */
 void LFSRWithWorkMode(zuc_state_t* state)
 {
-  u32 f, v;
-  f = state->LFSR_S0;
-  v = MulByPow2(state->LFSR_S0, 8);
-  f = AddM(f, v);
-  v = MulByPow2(state->LFSR_S4, 20);
-  f = AddM(f, v);
-  v = MulByPow2(state->LFSR_S10, 21);
-  f = AddM(f, v);
-  v = MulByPow2(state->LFSR_S13, 17);
-  f = AddM(f, v);
-  v = MulByPow2(state->LFSR_S15, 15);
-  f = AddM(f, v);
-
-  /* update the state */
-  state->LFSR_S0  = state->LFSR_S1;
-  state->LFSR_S1  = state->LFSR_S2;
-  state->LFSR_S2  = state->LFSR_S3;
-  state->LFSR_S3  = state->LFSR_S4;
-  state->LFSR_S4  = state->LFSR_S5;
-  state->LFSR_S5  = state->LFSR_S6;
-  state->LFSR_S6  = state->LFSR_S7;
-  state->LFSR_S7  = state->LFSR_S8;
-  state->LFSR_S8  = state->LFSR_S9;
-  state->LFSR_S9  = state->LFSR_S10;
-  state->LFSR_S10 = state->LFSR_S11;
-  state->LFSR_S11 = state->LFSR_S12;
-  state->LFSR_S12 = state->LFSR_S13;
-  state->LFSR_S13 = state->LFSR_S14;
-  state->LFSR_S14 = state->LFSR_S15;
-  state->LFSR_S15 = f;
+  LFSRShift(state, LFSRFeedback(state, 0));
 }
 
 /* BitReorganization */
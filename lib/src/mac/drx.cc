@@ -0,0 +1,124 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/mac/drx.h"
+#include <algorithm>
+
+namespace srslte {
+
+// TTIs are only ordered within half of the TTI space, longer timers are truncated
+void drx_active_time::drx_timer_t::run(tti_point start_, uint32_t duration)
+{
+  running = true;
+  start   = start_;
+  stop    = start_ + std::min(duration, 10240U / 2 - 1);
+}
+
+void drx_active_time::reset()
+{
+  inactivity.running       = false;
+  short_cycle.running      = false;
+  on_duration_stop.running = false;
+  for (auto& t : retx) {
+    t.running = false;
+  }
+}
+
+void drx_active_time::step(tti_point tti)
+{
+  auto expire = [tti](drx_timer_t& t) {
+    if (t.running and tti >= t.stop) {
+      t.running = false;
+    }
+  };
+  expire(inactivity);
+  expire(short_cycle);
+  expire(on_duration_stop);
+  std::for_each(retx.begin(), retx.end(), expire);
+}
+
+bool drx_active_time::is_active(tti_point tti) const
+{
+  if (not cfg.enabled) {
+    return true;
+  }
+  if (inactivity.contains(tti)) {
+    return true;
+  }
+  if (std::any_of(retx.begin(), retx.end(), [tti](const drx_timer_t& t) { return t.contains(tti); })) {
+    return true;
+  }
+
+  // The on duration timer starts at the beginning of every DRX cycle
+  uint32_t cycle = 0;
+  if (cycle_pos(tti, &cycle) >= cfg.on_duration_timer) {
+    return false;
+  }
+  return not on_duration_stop.contains(tti);
+}
+
+void drx_active_time::new_pdcch(tti_point tti)
+{
+  inactivity.run(tti, cfg.inactivity_timer + 1);
+
+  // The short DRX cycle is used once the inactivity timer expires
+  start_short_cycle(inactivity.stop);
+}
+
+void drx_active_time::dl_tb_failed(tti_point tti, uint32_t pid)
+{
+  retx[pid % retx.size()].run(tti + harq_rtt, cfg.retx_timer);
+}
+
+void drx_active_time::drx_command(tti_point tti)
+{
+  inactivity.running = false;
+
+  uint32_t cycle = 0;
+  uint32_t pos   = cycle_pos(tti, &cycle);
+  if (pos < cfg.on_duration_timer) {
+    on_duration_stop.run(tti, cfg.on_duration_timer - pos);
+  }
+
+  start_short_cycle(tti);
+}
+
+void drx_active_time::start_short_cycle(tti_point tti)
+{
+  if (cfg.short_cycle > 0) {
+    short_cycle.run(tti, cfg.short_cycle * cfg.short_cycle_timer);
+  } else {
+    short_cycle.running = false;
+  }
+}
+
+// Position of the TTI in its DRX cycle, 0 is the subframe in which the on duration timer starts. All the DRX cycles
+// divide the TTI space
+uint32_t drx_active_time::cycle_pos(tti_point tti, uint32_t* cycle) const
+{
+  *cycle = (cfg.short_cycle > 0 and short_cycle.contains(tti)) ? cfg.short_cycle : cfg.long_cycle;
+  if (*cycle == 0) {
+    return 0;
+  }
+  return (tti.to_uint() + 10240 - cfg.long_cycle_offset % *cycle) % *cycle;
+}
+
+} // namespace srslte
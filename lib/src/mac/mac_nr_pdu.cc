@@ -23,9 +23,9 @@
 
 namespace srslte {
 
-mac_nr_sch_subpdu::mac_nr_sch_subpdu(mac_nr_sch_pdu* parent_) : parent(parent_), log_h("MAC") {}
+mac_nr_sch_subpdu::mac_nr_sch_subpdu(mac_nr_sch_pdu* parent_) : parent(parent_) {}
 
-mac_nr_sch_subpdu::nr_lcid_sch_t mac_nr_sch_subpdu::get_type()
+mac_nr_sch_subpdu::nr_lcid_sch_t mac_nr_sch_subpdu::get_type() const
 {
   if (lcid >= 32) {
     return (nr_lcid_sch_t)lcid;
@@ -34,19 +34,19 @@ mac_nr_sch_subpdu::nr_lcid_sch_t mac_nr_sch_subpdu::get_type()
   return CCCH;
 }
 
-bool mac_nr_sch_subpdu::is_sdu()
+bool mac_nr_sch_subpdu::is_sdu() const
 {
   // for UL-SCH LCID 52 is also valid for carrying SDUs
   return (lcid <= 32 || (parent->is_ulsch() && lcid == 52));
 }
 
 // returns false for all reserved values in Table 6.2.1-1 and 6.2.1-2
-bool mac_nr_sch_subpdu::is_valid_lcid()
+bool mac_nr_sch_subpdu::is_valid_lcid() const
 {
   return (lcid <= 63 && ((parent->is_ulsch() && (lcid <= 32 || lcid >= 52)) || (lcid <= 32 || lcid >= 47)));
 }
 
-bool mac_nr_sch_subpdu::is_var_len_ce()
+bool mac_nr_sch_subpdu::is_var_len_ce() const
 {
   return false;
 }
@@ -78,13 +78,13 @@ int32_t mac_nr_sch_subpdu::read_subheader(const uint8_t* ptr)
     }
     sdu = (uint8_t*)ptr;
   } else {
-    log_h->warning("Invalid LCID (%d) in MAC PDU\n", lcid);
+    srslte::logmap::get("MAC")->warning("Invalid LCID (%d) in MAC PDU\n", lcid);
     return SRSLTE_ERROR;
   }
   return header_length;
 }
 
-void mac_nr_sch_subpdu::set_sdu(const uint32_t lcid_, const uint8_t* payload_, const uint32_t len_)
+void mac_nr_sch_subpdu::set_sdu(const uint32_t lcid_, const uint8_t* payload_, const uint32_t len_, bool long_len)
 {
   lcid          = lcid_;
   sdu           = const_cast<uint8_t*>(payload_);
@@ -94,11 +94,11 @@ void mac_nr_sch_subpdu::set_sdu(const uint32_t lcid_, const uint8_t* payload_, c
     F_bit      = false;
     sdu_length = sizeof_ce(lcid, parent->is_ulsch());
     if (len_ != static_cast<uint32_t>(sdu_length)) {
-      log_h->warning("Invalid SDU length of UL-SCH SDU (%d != %d)\n", len_, sdu_length);
+      srslte::logmap::get("MAC")->warning("Invalid SDU length of UL-SCH SDU (%d != %d)\n", len_, sdu_length);
     }
   }
 
-  if (sdu_length >= 256) {
+  if (sdu_length >= 256 or (long_len and not is_ul_ccch())) {
     F_bit = true;
     header_length += 1;
   }
@@ -133,12 +133,14 @@ uint32_t mac_nr_sch_subpdu::write_subpdu(const uint8_t* start_)
   } else if (header_length == 1) {
     // do nothing
   } else {
-    log_h->warning("Error while packing PDU. Unsupported header length (%d)\n", header_length);
+    srslte::logmap::get("MAC")->warning("Error while packing PDU. Unsupported header length (%d)\n", header_length);
   }
 
-  // copy SDU payload
+  // copy SDU payload, unless it was written in place
   if (sdu) {
-    memcpy(ptr, sdu, sdu_length);
+    if (sdu != ptr) {
+      memcpy(ptr, sdu, sdu_length);
+    }
   } else {
     // clear memory
     memset(ptr, 0, sdu_length);
@@ -150,22 +152,22 @@ uint32_t mac_nr_sch_subpdu::write_subpdu(const uint8_t* start_)
   return ptr - start_;
 }
 
-uint32_t mac_nr_sch_subpdu::get_total_length()
+uint32_t mac_nr_sch_subpdu::get_total_length() const
 {
   return (header_length + sdu_length);
 }
 
-uint32_t mac_nr_sch_subpdu::get_sdu_length()
+uint32_t mac_nr_sch_subpdu::get_sdu_length() const
 {
   return sdu_length;
 }
 
-uint32_t mac_nr_sch_subpdu::get_lcid()
+uint32_t mac_nr_sch_subpdu::get_lcid() const
 {
   return lcid;
 }
 
-uint8_t* mac_nr_sch_subpdu::get_sdu()
+uint8_t* mac_nr_sch_subpdu::get_sdu() const
 {
   return sdu;
 }
@@ -202,7 +204,7 @@ uint32_t mac_nr_sch_subpdu::sizeof_ce(uint32_t lcid, bool is_ul)
   return 0;
 }
 
-inline bool mac_nr_sch_subpdu::is_ul_ccch()
+inline bool mac_nr_sch_subpdu::is_ul_ccch() const
 {
   return (parent->is_ulsch() && (lcid == CCCH_SIZE_48 || lcid == CCCH_SIZE_64));
 }
@@ -245,17 +247,17 @@ void mac_nr_sch_pdu::unpack(const uint8_t* payload, const uint32_t& len)
   }
 }
 
-uint32_t mac_nr_sch_pdu::get_num_subpdus()
+uint32_t mac_nr_sch_pdu::get_num_subpdus() const
 {
   return subpdus.size();
 }
 
-const mac_nr_sch_subpdu& mac_nr_sch_pdu::get_subpdu(const uint32_t& index)
+const mac_nr_sch_subpdu& mac_nr_sch_pdu::get_subpdu(const uint32_t& index) const
 {
   return subpdus.at(index);
 }
 
-bool mac_nr_sch_pdu::is_ulsch()
+bool mac_nr_sch_pdu::is_ulsch() const
 {
   return ulsch;
 }
@@ -291,7 +293,7 @@ uint32_t mac_nr_sch_pdu::size_header_sdu(const uint32_t lcid, const uint32_t nby
   }
 }
 
-uint32_t mac_nr_sch_pdu::get_remaing_len()
+uint32_t mac_nr_sch_pdu::get_remaing_len() const
 {
   return remaining_len;
 }
@@ -323,4 +325,44 @@ uint32_t mac_nr_sch_pdu::add_sdu(const uint32_t lcid_, const uint8_t* payload_,
   return SRSLTE_SUCCESS;
 }
 
+uint8_t* mac_nr_sch_pdu::reserve_sdu(const uint32_t lcid_, uint32_t* max_len_)
+{
+  *max_len_ = 0;
+
+  // the 8-bit L field covers SDUs of up to 255 bytes
+  reserved_lcid       = lcid_;
+  reserved_header_len = size_header_sdu(lcid_, remaining_len > 257 ? 256 : 0);
+  if (remaining_len <= reserved_header_len) {
+    return nullptr;
+  }
+  *max_len_ = remaining_len - reserved_header_len;
+  return buffer->msg + buffer->N_bytes + reserved_header_len;
+}
+
+uint32_t mac_nr_sch_pdu::commit_sdu(const uint32_t len_)
+{
+  if (reserved_header_len + len_ > remaining_len) {
+    printf("Header and SDU exceed space in PDU (%d > %d).\n", reserved_header_len + len_, remaining_len);
+    return SRSLTE_ERROR;
+  }
+
+  mac_nr_sch_subpdu sch_pdu(this);
+  sch_pdu.set_sdu(reserved_lcid, buffer->msg + buffer->N_bytes + reserved_header_len, len_, reserved_header_len == 3);
+  if (sch_pdu.get_total_length() != reserved_header_len + len_) {
+    fprintf(stderr,
+            "Error writing subPDU (Length error: %d != %d)\n",
+            reserved_header_len + len_,
+            sch_pdu.get_total_length());
+    return SRSLTE_ERROR;
+  }
+  uint32_t length = sch_pdu.write_subpdu(buffer->msg + buffer->N_bytes);
+
+  buffer->N_bytes += length;
+  remaining_len -= length;
+
+  subpdus.push_back(sch_pdu);
+
+  return SRSLTE_SUCCESS;
+}
+
 } // namespace srslte
@@ -47,17 +47,43 @@ uint8_t* pdu_queue::request(uint32_t len)
     ERROR("Fatal error in memory alignment in struct pdu_queue::pdu_t\n");
     exit(-1);
   }
+  pdu->nof_refs.store(1, std::memory_order_relaxed);
 
   return pdu->ptr;
 }
 
 void pdu_queue::deallocate(uint8_t* pdu)
 {
+  if (pdu != nullptr && ((pdu_t*)pdu)->nof_refs.fetch_sub(1, std::memory_order_acq_rel) > 1) {
+    // Still viewed by an upper layer
+    return;
+  }
   if (!pool.deallocate((pdu_t*)pdu)) {
     log_h->warning("Error deallocating from buffer pool in deallocate(): buffer not created in this pool.\n");
   }
 }
 
+unique_byte_buffer_t pdu_queue::share(uint8_t* pdu, uint8_t* ptr, uint32_t nof_bytes)
+{
+  // Views keep the PDUs for as long as the upper layers hold them, e.g. waiting for reordering. Do not let them take
+  // the buffers that the PHY needs
+  if (pool.nof_available_pdus() < pool_size / 2 || ptr < pdu || ptr + nof_bytes > pdu + MAX_PDU_LEN) {
+    return nullptr;
+  }
+  ((pdu_t*)pdu)->nof_refs.fetch_add(1, std::memory_order_relaxed);
+  unique_byte_buffer_t view = allocate_unique_buffer_view(
+      *byte_buffer_pool::get_instance(), ptr, nof_bytes, pdu_queue::release_view, this, pdu);
+  if (view == nullptr) {
+    ((pdu_t*)pdu)->nof_refs.fetch_sub(1, std::memory_order_relaxed);
+  }
+  return view;
+}
+
+void pdu_queue::release_view(void* owner, void* pdu)
+{
+  static_cast<pdu_queue*>(owner)->deallocate(static_cast<uint8_t*>(pdu));
+}
+
 /* Demultiplexing of logical channels and dissassemble of MAC CE
  * This function enqueues the packet and returns quicly because ACK
  * deadline is important here.
@@ -68,7 +94,10 @@ void pdu_queue::push(uint8_t* ptr, uint32_t len, channel_t channel)
     pdu_t* pdu   = (pdu_t*)ptr;
     pdu->len     = len;
     pdu->channel = channel;
-    pdu_q.push(pdu);
+    if (!pdu_q.try_push(pdu)) {
+      log_h->error("Error pushing pdu: queue is full\n");
+      deallocate(ptr);
+    }
   } else {
     log_h->warning("Error pushing pdu: ptr is empty\n");
   }
@@ -76,15 +105,27 @@ void pdu_queue::push(uint8_t* ptr, uint32_t len, channel_t channel)
 
 bool pdu_queue::process_pdus()
 {
-  bool     have_data = false;
-  uint32_t cnt       = 0;
-  pdu_t*   pdu;
-  while (pdu_q.try_pop(&pdu)) {
-    if (callback) {
-      callback->process_pdu(pdu->ptr, pdu->len, pdu->channel);
+  // Take the PDUs in batches, so that the callbacks run back to back without touching the shared queue in between
+  const static uint32_t MAX_BATCH = 16;
+  pdu_t*                batch[MAX_BATCH];
+  uint32_t              cnt  = 0;
+  size_t                left = pdu_q.size();
+  while (left > 0) {
+    uint32_t nof_pdus = 0;
+    while (nof_pdus < MAX_BATCH && nof_pdus < left && pdu_q.try_pop(batch[nof_pdus])) {
+      nof_pdus++;
+    }
+    if (nof_pdus == 0) {
+      // The next PDU is still being written by a PHY worker
+      break;
+    }
+    for (uint32_t i = 0; i < nof_pdus; i++) {
+      if (callback) {
+        callback->process_pdu(batch[i]->ptr, batch[i]->len, batch[i]->channel);
+      }
     }
-    cnt++;
-    have_data = true;
+    cnt += nof_pdus;
+    left -= nof_pdus;
   }
   if (cnt > 20) {
     if (log_h) {
@@ -92,7 +133,7 @@ bool pdu_queue::process_pdus()
     }
     printf("Warning PDU queue dispatched %d packets\n", cnt);
   }
-  return have_data;
+  return cnt > 0;
 }
 
 } // namespace srslte
@@ -40,7 +40,8 @@ int srslte_agc_init_acc(srslte_agc_t* q, srslte_agc_mode_t mode, uint32_t nof_fr
   } else {
     q->y_tmp = NULL;
   }
-  q->target = SRSLTE_AGC_DEFAULT_TARGET;
+  q->target     = SRSLTE_AGC_DEFAULT_TARGET;
+  q->decimation = SRSLTE_AGC_DEFAULT_DECIMATION;
   srslte_agc_reset(q);
   return SRSLTE_SUCCESS;
 }
@@ -97,6 +98,55 @@ void srslte_agc_set_gain(srslte_agc_t* q, float init_gain_value_db)
   q->gain_db = init_gain_value_db;
 }
 
+void srslte_agc_set_decimation(srslte_agc_t* q, uint32_t decimation)
+{
+  if (q) {
+    q->decimation = SRSLTE_MAX(1, decimation);
+  }
+}
+
+/*
+ * Measures the RMS or the peak amplitude of one block of SRSLTE_AGC_BLOCK_LEN samples out of every decimation blocks,
+ * the gain only needs the power level and the blocks are spread over the whole subframe
+ */
+static float agc_measure(srslte_agc_t* q, cf_t* signal, uint32_t len)
+{
+  uint32_t block = SRSLTE_AGC_BLOCK_LEN;
+  uint32_t step  = SRSLTE_AGC_BLOCK_LEN * q->decimation;
+  float    y     = 0;
+  uint32_t count = 0;
+
+  // Without decimation, or if the signal is too short for it, every sample is measured
+  if (q->decimation <= 1 || len < step) {
+    block = len;
+    step  = len;
+  }
+
+  for (uint32_t i = 0; i < len; i += step) {
+    uint32_t n = SRSLTE_MIN(block, len - i);
+    float*   t;
+    float    peak;
+    switch (q->mode) {
+      case SRSLTE_AGC_MODE_ENERGY:
+        y += crealf(srslte_vec_dot_prod_conj_ccc(&signal[i], &signal[i], n));
+        break;
+      case SRSLTE_AGC_MODE_PEAK_AMPLITUDE:
+        t    = (float*)&signal[i];
+        peak = t[srslte_vec_max_fi(t, 2 * n)]; // take only positive max to avoid abs() (should be similar)
+        y    = SRSLTE_MAX(y, peak);
+        break;
+      default:
+        break;
+    }
+    count += n;
+  }
+
+  if (q->mode == SRSLTE_AGC_MODE_ENERGY && count > 0) {
+    y = sqrtf(y / count);
+  }
+  return y;
+}
+
 /*
  * Transition functions
  */
@@ -143,20 +193,11 @@ static inline void agc_run_state_measure(srslte_agc_t* q, cf_t* signal, uint32_t
 {
 
   // Perform measurement of the frame
-  float  y = 0;
-  float* t;
-  switch (q->mode) {
-    case SRSLTE_AGC_MODE_ENERGY:
-      y = sqrtf(crealf(srslte_vec_dot_prod_conj_ccc(signal, signal, len)) / len);
-      break;
-    case SRSLTE_AGC_MODE_PEAK_AMPLITUDE:
-      t = (float*)signal;
-      y = t[srslte_vec_max_fi(t, 2 * len)]; // take only positive max to avoid abs() (should be similar)
-      break;
-    default:
-      ERROR("Unsupported AGC mode\n");
-      return;
+  if (q->mode != SRSLTE_AGC_MODE_ENERGY && q->mode != SRSLTE_AGC_MODE_PEAK_AMPLITUDE) {
+    ERROR("Unsupported AGC mode\n");
+    return;
   }
+  float y = agc_measure(q, signal, len);
 
   // Perform averaging if configured
   if (q->nof_frames > 0) {
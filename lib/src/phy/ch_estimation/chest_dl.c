@@ -219,6 +219,11 @@ int srslte_chest_dl_res_init(srslte_chest_dl_res_t* q, uint32_t max_prb)
       }
       srslte_vec_cf_zero(q->ce[i][j], SRSLTE_SF_LEN_RE(max_prb, SRSLTE_CP_NORM));
     }
+    q->crs_residual[i] = srslte_vec_cf_malloc(SRSLTE_REFSIGNAL_MAX_NUM_SF(max_prb));
+    if (!q->crs_residual[i]) {
+      perror("malloc");
+      return -1;
+    }
   }
   return 0;
 }
@@ -253,6 +258,9 @@ void srslte_chest_dl_res_free(srslte_chest_dl_res_t* q)
         free(q->ce[i][j]);
       }
     }
+    if (q->crs_residual[i]) {
+      free(q->crs_residual[i]);
+    }
   }
 }
 
@@ -311,6 +319,28 @@ int srslte_chest_dl_set_cell(srslte_chest_dl_t* q, srslte_cell_t cell)
         fprintf(stderr, "Error initializing interpolator\n");
         return SRSLTE_ERROR;
       }
+
+      // The MBSFN reference signals of the areas already set depend on the cell
+      for (uint32_t i = 0; i < SRSLTE_MAX_MBSFN_AREA_IDS; i++) {
+        if (q->mbsfn_refs[i]) {
+          srslte_refsignal_free(q->mbsfn_refs[i]);
+          if (srslte_refsignal_mbsfn_init(q->mbsfn_refs[i], cell.nof_prb) ||
+              srslte_refsignal_mbsfn_set_cell(q->mbsfn_refs[i], cell, i)) {
+            ERROR("Error initializing MBSFN reference signal of area %d\n", i);
+            return SRSLTE_ERROR;
+          }
+        }
+      }
+
+      // Cache the CRS positions of every port, so the estimator does not recompute them for each subframe
+      for (uint32_t port_id = 0; port_id < SRSLTE_MAX_PORTS; port_id++) {
+        for (uint32_t l = 0; l < SRSLTE_CHEST_DL_MAX_REF_SYMB; l++) {
+          uint32_t nsymbol               = srslte_refsignal_cs_nsymbol(l, cell.cp, port_id);
+          uint32_t fidx                  = srslte_refsignal_cs_fidx(cell, l, port_id, 0);
+          q->pilot_nsymbol[port_id][l]   = nsymbol;
+          q->pilot_re_offset[port_id][l] = SRSLTE_RE_IDX(cell.nof_prb, nsymbol, fidx);
+        }
+      }
     }
     ret = SRSLTE_SUCCESS;
   }
@@ -578,19 +608,6 @@ static void average_pilots(srslte_chest_dl_t*     q,
   }
 }
 
-static float chest_dl_rssi(srslte_chest_dl_t* q, srslte_dl_sf_cfg_t* sf, cf_t* input, uint32_t port_id)
-{
-  uint32_t l;
-
-  float    rssi     = 0;
-  uint32_t nsymbols = srslte_refsignal_cs_nof_symbols(&q->csr_refs, sf, port_id);
-  for (l = 0; l < nsymbols; l++) {
-    cf_t* tmp = &input[srslte_refsignal_cs_nsymbol(l, q->cell.cp, port_id) * q->cell.nof_prb * SRSLTE_NRE];
-    rssi += srslte_vec_dot_prod_conj_ccc(tmp, tmp, q->cell.nof_prb * SRSLTE_NRE);
-  }
-  return rssi / nsymbols;
-}
-
 // CFO estimation algorithm taken from "Carrier Frequency Synchronization in the
 // Downlink of 3GPP LTE", Qi Wang, C. Mehlfuhrer, M. Rupp
 static float chest_estimate_cfo(srslte_chest_dl_t* q)
@@ -646,6 +663,8 @@ static void chest_interpolate_noise_est(srslte_chest_dl_t*     q,
   }
 
   if (q->wiener_dl && ch_mode == SRSLTE_SF_NORM && cfg->estimator_alg == SRSLTE_ESTIMATOR_ALG_WIENER) {
+    srslte_wiener_dl_set_mode(q->wiener_dl, cfg->wiener_mode);
+
     bool     ready   = q->wiener_dl->ready;
     uint32_t nre     = q->cell.nof_prb * SRSLTE_NRE;
     uint32_t nref    = q->cell.nof_prb * 2;
@@ -727,6 +746,45 @@ static void chest_interpolate_noise_est(srslte_chest_dl_t*     q,
   }
 }
 
+/* Computes the Least-squares estimates of a port in a single sweep over its reference symbols. The CRS are gathered
+ * straight from the resource grid using the positions cached at set_cell, so the received pilots are never copied.
+ * If rsrp or rssi are not NULL, the average power of the received pilots and of the symbols carrying them are returned
+ * while the symbols are still in cache.
+ */
+static void chest_dl_ls_estimate(srslte_chest_dl_t*  q,
+                                 srslte_dl_sf_cfg_t* sf,
+                                 cf_t*               input,
+                                 uint32_t            port_id,
+                                 float*              rsrp,
+                                 float*              rssi)
+{
+  uint32_t nsymb = srslte_refsignal_cs_nof_symbols(&q->csr_refs, sf, port_id);
+  uint32_t nref  = 2 * q->cell.nof_prb;
+  uint32_t nre   = SRSLTE_NRE * q->cell.nof_prb;
+  cf_t*    refs  = q->csr_refs.pilots[port_id / 2][sf->tti % 10];
+
+  float pilot_power  = 0.0f;
+  float symbol_power = 0.0f;
+  for (uint32_t l = 0; l < nsymb; l++) {
+    pilot_power += srslte_vec_prod_conj_stride_ccc(&input[q->pilot_re_offset[port_id][l]],
+                                                   SRSLTE_NRE / 2,
+                                                   &refs[l * nref],
+                                                   &q->pilot_estimates[l * nref],
+                                                   nref);
+    if (rssi) {
+      cf_t* symbol = &input[q->pilot_nsymbol[port_id][l] * nre];
+      symbol_power += __real__ srslte_vec_dot_prod_conj_ccc(symbol, symbol, nre);
+    }
+  }
+
+  if (rsrp) {
+    *rsrp = pilot_power / (nsymb * nref);
+  }
+  if (rssi) {
+    *rssi = symbol_power / nsymb;
+  }
+}
+
 static void
 chest_dl_estimate_correct_sync_error(srslte_chest_dl_t* q, srslte_dl_sf_cfg_t* sf, cf_t* input, uint32_t rxant_id)
 {
@@ -739,12 +797,8 @@ chest_dl_estimate_correct_sync_error(srslte_chest_dl_t* q, srslte_dl_sf_cfg_t* s
     uint32_t npilots = srslte_refsignal_cs_nof_re(&q->csr_refs, sf, cell_port_id);
     uint32_t nsymb   = srslte_refsignal_cs_nof_symbols(&q->csr_refs, sf, cell_port_id);
 
-    // Get references from the input signal
-    srslte_refsignal_cs_get_sf(&q->csr_refs, sf, cell_port_id, input, q->pilot_recv_signal);
-
     // Use the known CSR signal to compute Least-squares estimates
-    srslte_vec_prod_conj_ccc(
-        q->pilot_recv_signal, q->csr_refs.pilots[cell_port_id / 2][sf->tti % 10], q->pilot_estimates, npilots);
+    chest_dl_ls_estimate(q, sf, input, cell_port_id, NULL, NULL);
 
     // Estimate synchronization error from the phase shift
     float k   = (float)srslte_symbol_sz(q->cell.nof_prb) / 6.0f;
@@ -785,6 +839,29 @@ chest_dl_estimate_correct_sync_error(srslte_chest_dl_t* q, srslte_dl_sf_cfg_t* s
   }
 }
 
+/* Subtracts the channel estimate from the Least-squares estimate of every pilot of a port. The pilots are gathered again
+ * from the grid since the time averaging overwrites the Least-squares estimates */
+static void chest_dl_crs_residual(srslte_chest_dl_t*  q,
+                                  srslte_dl_sf_cfg_t* sf,
+                                  cf_t*               input,
+                                  cf_t*               ce,
+                                  uint32_t            port_id,
+                                  cf_t*               residual)
+{
+  uint32_t nsymb = srslte_refsignal_cs_nof_symbols(&q->csr_refs, sf, port_id);
+  uint32_t nref  = 2 * q->cell.nof_prb;
+  cf_t*    refs  = q->csr_refs.pilots[port_id / 2][sf->tti % 10];
+
+  for (uint32_t l = 0; l < nsymb; l++) {
+    cf_t* ce_pilots = &ce[q->pilot_re_offset[port_id][l]];
+    cf_t* res       = &residual[l * nref];
+    srslte_vec_prod_conj_stride_ccc(&input[q->pilot_re_offset[port_id][l]], SRSLTE_NRE / 2, &refs[l * nref], res, nref);
+    for (uint32_t k = 0; k < nref; k++) {
+      res[k] -= ce_pilots[k * SRSLTE_NRE / 2];
+    }
+  }
+}
+
 static int estimate_port(srslte_chest_dl_t*     q,
                          srslte_dl_sf_cfg_t*    sf,
                          srslte_chest_dl_cfg_t* cfg,
@@ -795,20 +872,14 @@ static int estimate_port(srslte_chest_dl_t*     q,
 {
   uint32_t npilots = srslte_refsignal_cs_nof_re(&q->csr_refs, sf, port_id);
 
-  /* Get references from the input signal */
-  srslte_refsignal_cs_get_sf(&q->csr_refs, sf, port_id, input, q->pilot_recv_signal);
-
-  /* Use the known CSR signal to compute Least-squares estimates */
-  srslte_vec_prod_conj_ccc(
-      q->pilot_recv_signal, q->csr_refs.pilots[port_id / 2][sf->tti % 10], q->pilot_estimates, npilots);
+  /* Use the known CSR signal to compute Least-squares estimates, RSRP and RSSI */
+  chest_dl_ls_estimate(q, sf, input, port_id, &q->rsrp[rxant_id][port_id], &q->rssi[rxant_id][port_id]);
 
   /* Compute RSRP for the channel estimates in this port */
   if (cfg->rsrp_neighbour) {
     double energy                   = cabsf(srslte_vec_acc_cc(q->pilot_estimates, npilots) / npilots);
     q->rsrp_corr[rxant_id][port_id] = energy * energy;
   }
-  q->rsrp[rxant_id][port_id] = srslte_vec_avg_power_cf(q->pilot_recv_signal, npilots);
-  q->rssi[rxant_id][port_id] = chest_dl_rssi(q, sf, input, port_id);
 
   chest_interpolate_noise_est(q, sf, cfg, input, ce, port_id, rxant_id);
 
@@ -1006,6 +1077,15 @@ int srslte_chest_dl_estimate_cfg(srslte_chest_dl_t*     q,
         }
       }
     }
+
+    if (cfg->crs_residual_enable && sf->sf_type != SRSLTE_SF_MBSFN && res->crs_residual[rxant_id]) {
+      chest_dl_crs_residual(q, sf, input[rxant_id], res->ce[0][rxant_id], 0, res->crs_residual[rxant_id]);
+    }
+  }
+
+  res->nof_crs_residual = 0;
+  if (cfg->crs_residual_enable && sf->sf_type != SRSLTE_SF_MBSFN) {
+    res->nof_crs_residual = srslte_refsignal_cs_nof_re(&q->csr_refs, sf, 0);
   }
 
   fill_res(q, res);
@@ -510,9 +510,8 @@ static void interpolate_pilots_sl_pscch(srslte_chest_sl_t* q)
 static void chest_sl_pscch_ls_estimate(srslte_chest_sl_t* q, cf_t* sf_buffer)
 {
   // Get Pilot Estimates
-  // Use the known DMRS signal to compute least-squares estimates
-  srslte_vec_cf_zero(q->ce, q->sf_n_re);
-
+  // Use the known DMRS signal to compute least-squares estimates. The interpolation fills the rest of the band, and
+  // the estimates outside of it are not used, so there is no need to clear them for every candidate
   uint32_t dmrs_idx = 0;
   for (uint32_t i = 0; i < srslte_sl_get_num_symbols(q->cell.tm, q->cell.cp); i++) {
     if (srslte_pscch_is_symbol(SRSLTE_SIDELINK_DMRS_SYMBOL, q->cell.tm, i, q->cell.cp)) {
@@ -996,62 +995,70 @@ static void get_subband_noise(srslte_chest_sl_t* q, uint32_t k_start, uint32_t k
   }
 }
 
-float srslte_chest_sl_estimate_noise(srslte_chest_sl_t* q)
+// Subcarriers of the channel being estimated, in up to two bands. Returns the number of bands
+static uint32_t chest_sl_get_bands(srslte_chest_sl_t* q, uint32_t* k_start, uint32_t* k_end)
 {
-  uint32_t sf_nsymbols = srslte_sl_get_num_symbols(q->cell.tm, q->cell.cp);
-  if (sf_nsymbols == 0) {
-    ERROR("Error estimating channel noise. Invalid number of OFDM symbols.\n");
-    return SRSLTE_ERROR;
-  }
-
-  srslte_vec_cf_zero(q->ce_average, q->sf_n_re);
-  q->noise_estimated = 0.0;
-
-  uint32_t k_start = 0;
-  uint32_t k_end   = 0;
-
   switch (q->channel) {
     case SRSLTE_SIDELINK_PSBCH:
-      k_start = q->cell.nof_prb * SRSLTE_NRE / 2 - 36;
-      k_end   = k_start + q->M_sc_rs;
-      get_subband_noise(q, k_start, k_end, sf_nsymbols);
-      break;
+      k_start[0] = q->cell.nof_prb * SRSLTE_NRE / 2 - 36;
+      k_end[0]   = k_start[0] + q->M_sc_rs;
+      return 1;
     case SRSLTE_SIDELINK_PSCCH:
-      k_start = q->chest_sl_cfg.prb_start_idx * SRSLTE_NRE;
-      k_end   = k_start + q->M_sc_rs;
-      get_subband_noise(q, k_start, k_end, sf_nsymbols);
-      break;
+      k_start[0] = q->chest_sl_cfg.prb_start_idx * SRSLTE_NRE;
+      k_end[0]   = k_start[0] + q->M_sc_rs;
+      return 1;
     case SRSLTE_SIDELINK_PSSCH:
       if (q->cell.tm == SRSLTE_SIDELINK_TM1 || q->cell.tm == SRSLTE_SIDELINK_TM2) {
         if (q->chest_sl_cfg.nof_prb <= q->sl_comm_resource_pool.prb_num) {
-          k_start = q->chest_sl_cfg.prb_start_idx * SRSLTE_NRE;
-          k_end   = (q->chest_sl_cfg.nof_prb + q->chest_sl_cfg.prb_start_idx) * SRSLTE_NRE;
-          get_subband_noise(q, k_start, k_end, sf_nsymbols);
+          k_start[0] = q->chest_sl_cfg.prb_start_idx * SRSLTE_NRE;
+          k_end[0]   = (q->chest_sl_cfg.nof_prb + q->chest_sl_cfg.prb_start_idx) * SRSLTE_NRE;
+          return 1;
+        }
+        // First band
+        k_start[0] = q->chest_sl_cfg.prb_start_idx * SRSLTE_NRE;
+        k_end[0]   = k_start[0] + q->sl_comm_resource_pool.prb_num * SRSLTE_NRE;
+
+        // Second band
+        if ((q->sl_comm_resource_pool.prb_num * 2) >
+            (q->sl_comm_resource_pool.prb_end - q->sl_comm_resource_pool.prb_start + 1)) {
+          k_start[1] = (q->sl_comm_resource_pool.prb_end + 1 - q->sl_comm_resource_pool.prb_num + 1) * SRSLTE_NRE;
         } else {
-          // First band
-          k_start = q->chest_sl_cfg.prb_start_idx * SRSLTE_NRE;
-          k_end   = k_start + q->sl_comm_resource_pool.prb_num * SRSLTE_NRE;
-          get_subband_noise(q, k_start, k_end, sf_nsymbols);
-
-          // Second band
-          if ((q->sl_comm_resource_pool.prb_num * 2) >
-              (q->sl_comm_resource_pool.prb_end - q->sl_comm_resource_pool.prb_start + 1)) {
-            k_start = (q->sl_comm_resource_pool.prb_end + 1 - q->sl_comm_resource_pool.prb_num + 1) * SRSLTE_NRE;
-          } else {
-            k_start = (q->sl_comm_resource_pool.prb_end + 1 - q->sl_comm_resource_pool.prb_num) * SRSLTE_NRE;
-          }
-          k_end = k_start + (q->chest_sl_cfg.nof_prb - q->sl_comm_resource_pool.prb_num) * SRSLTE_NRE;
-          get_subband_noise(q, k_start, k_end, sf_nsymbols);
+          k_start[1] = (q->sl_comm_resource_pool.prb_end + 1 - q->sl_comm_resource_pool.prb_num) * SRSLTE_NRE;
         }
+        k_end[1] = k_start[1] + (q->chest_sl_cfg.nof_prb - q->sl_comm_resource_pool.prb_num) * SRSLTE_NRE;
+        return 2;
       } else if (q->cell.tm == SRSLTE_SIDELINK_TM3 || q->cell.tm == SRSLTE_SIDELINK_TM4) {
-        k_start = q->chest_sl_cfg.prb_start_idx * SRSLTE_NRE;
-        k_end   = (q->chest_sl_cfg.nof_prb + q->chest_sl_cfg.prb_start_idx) * SRSLTE_NRE;
-        get_subband_noise(q, k_start, k_end, sf_nsymbols);
+        k_start[0] = q->chest_sl_cfg.prb_start_idx * SRSLTE_NRE;
+        k_end[0]   = (q->chest_sl_cfg.nof_prb + q->chest_sl_cfg.prb_start_idx) * SRSLTE_NRE;
+        return 1;
       }
-      break;
+      return 0;
     default:
-      ERROR("Invalid Sidelink channel");
-      return SRSLTE_ERROR;
+      return 0;
+  }
+}
+
+float srslte_chest_sl_estimate_noise(srslte_chest_sl_t* q)
+{
+  uint32_t sf_nsymbols = srslte_sl_get_num_symbols(q->cell.tm, q->cell.cp);
+  if (sf_nsymbols == 0) {
+    ERROR("Error estimating channel noise. Invalid number of OFDM symbols.\n");
+    return SRSLTE_ERROR;
+  }
+  if (q->channel != SRSLTE_SIDELINK_PSBCH && q->channel != SRSLTE_SIDELINK_PSCCH &&
+      q->channel != SRSLTE_SIDELINK_PSSCH) {
+    ERROR("Invalid Sidelink channel");
+    return SRSLTE_ERROR;
+  }
+
+  // Only the bands of the channel are averaged, the rest of ce_average is not used
+  q->noise_estimated = 0.0;
+
+  uint32_t k_start[2] = {};
+  uint32_t k_end[2]   = {};
+  uint32_t nof_bands  = chest_sl_get_bands(q, k_start, k_end);
+  for (uint32_t b = 0; b < nof_bands; b++) {
+    get_subband_noise(q, k_start[b], k_end[b], sf_nsymbols);
   }
   q->noise_estimated = q->noise_estimated / (float)sf_nsymbols;
   return q->noise_estimated;
@@ -1159,7 +1166,8 @@ int srslte_chest_sl_set_cell(srslte_chest_sl_t* q, srslte_cell_sl_t cell)
 {
   int ret = SRSLTE_ERROR_INVALID_INPUTS;
   if (q != NULL) {
-    q->cell = cell;
+    q->cell            = cell;
+    q->pssch_seq_valid = false;
     if (q->channel == SRSLTE_SIDELINK_PSBCH) {
       if (chest_sl_psbch_gen(q) != SRSLTE_SUCCESS) {
         return SRSLTE_ERROR;
@@ -1170,16 +1178,29 @@ int srslte_chest_sl_set_cell(srslte_chest_sl_t* q, srslte_cell_sl_t cell)
   return ret;
 }
 
+// The PSSCH DMRS only depends on N_X_ID, the number of PRB and, in TM3/4, the subframe
+static bool chest_sl_pssch_seq_is_current(srslte_chest_sl_t* q)
+{
+  const srslte_chest_sl_cfg_t* cfg = &q->chest_sl_cfg;
+  const srslte_chest_sl_cfg_t* gen = &q->pssch_seq_cfg;
+  if (!q->pssch_seq_valid || cfg->N_x_id != gen->N_x_id || cfg->nof_prb != gen->nof_prb) {
+    return false;
+  }
+  return q->cell.tm <= SRSLTE_SIDELINK_TM2 || cfg->sf_idx % 10 == gen->sf_idx % 10;
+}
+
 int srslte_chest_sl_set_cfg(srslte_chest_sl_t* q, srslte_chest_sl_cfg_t chest_sl_cfg)
 {
   int ret = SRSLTE_ERROR_INVALID_INPUTS;
   if (q != NULL) {
     q->chest_sl_cfg = chest_sl_cfg;
 
-    if (q->channel == SRSLTE_SIDELINK_PSSCH) {
+    if (q->channel == SRSLTE_SIDELINK_PSSCH && !chest_sl_pssch_seq_is_current(q)) {
       if (chest_sl_pssch_gen(q) != SRSLTE_SUCCESS) {
         return SRSLTE_ERROR;
       }
+      q->pssch_seq_cfg   = q->chest_sl_cfg;
+      q->pssch_seq_valid = true;
     }
     ret = SRSLTE_SUCCESS;
   }
@@ -1242,8 +1263,23 @@ void srslte_chest_sl_ls_equalize(srslte_chest_sl_t* q, cf_t* sf_buffer, cf_t* eq
 {
   srslte_chest_sl_estimate_noise(q);
 
-  // Perform channel equalization
-  srslte_predecoding_single(sf_buffer, q->ce_average, equalized_sf_buffer, NULL, q->sf_n_re, 1.0, q->noise_estimated);
+  // Perform channel equalization, only in the bands of the channel
+  uint32_t n_re       = q->cell.nof_prb * SRSLTE_NRE;
+  uint32_t k_start[2] = {};
+  uint32_t k_end[2]   = {};
+  uint32_t nof_bands  = chest_sl_get_bands(q, k_start, k_end);
+  for (uint32_t l = 0; l < q->sf_n_re / n_re; l++) {
+    for (uint32_t b = 0; b < nof_bands; b++) {
+      uint32_t k = l * n_re + k_start[b];
+      srslte_predecoding_single(&sf_buffer[k],
+                                &q->ce_average[k],
+                                &equalized_sf_buffer[k],
+                                NULL,
+                                k_end[b] - k_start[b],
+                                1.0,
+                                q->noise_estimated);
+    }
+  }
 }
 
 void srslte_chest_sl_ls_estimate_equalize(srslte_chest_sl_t* q, cf_t* sf_buffer, cf_t* equalized_sf_buffer)
@@ -99,7 +99,7 @@ int srslte_chest_ul_init(srslte_chest_ul_t* q, uint32_t max_prb)
 
     q->dmrs_signal_configured = false;
 
-    if (srslte_refsignal_dmrs_pusch_pregen_init(&q->dmrs_pregen, max_prb)) {
+    if (srslte_refsignal_dmrs_pusch_cache_init(&q->dmrs_cache, max_prb)) {
       ERROR("Error allocating memory for pregenerated signals\n");
       goto clean_exit;
     }
@@ -116,7 +116,7 @@ clean_exit:
 
 void srslte_chest_ul_free(srslte_chest_ul_t* q)
 {
-  srslte_refsignal_dmrs_pusch_pregen_free(&q->dmrs_signal, &q->dmrs_pregen);
+  srslte_refsignal_dmrs_pusch_cache_free(&q->dmrs_cache);
 
   srslte_refsignal_ul_free(&q->dmrs_signal);
   if (q->tmp_noise) {
@@ -189,11 +189,19 @@ int srslte_chest_ul_set_cell(srslte_chest_ul_t* q, srslte_cell_t cell)
   return ret;
 }
 
+void srslte_chest_ul_set_dmrs_cache(srslte_chest_ul_t* q, const srslte_refsignal_ul_dmrs_cache_t* cache)
+{
+  q->dmrs_cache_shared = cache;
+}
+
 void srslte_chest_ul_pregen(srslte_chest_ul_t*                 q,
                             srslte_refsignal_dmrs_pusch_cfg_t* cfg,
                             srslte_refsignal_srs_cfg_t*        srs_cfg)
 {
-  srslte_refsignal_dmrs_pusch_pregen(&q->dmrs_signal, &q->dmrs_pregen, cfg);
+  // A shared cache is set by its owner, there is nothing to generate
+  if (!q->dmrs_cache_shared) {
+    srslte_refsignal_dmrs_pusch_cache_set(&q->dmrs_signal, &q->dmrs_cache, cfg);
+  }
   q->dmrs_signal_configured = true;
 
   if (srs_cfg) {
@@ -389,11 +397,16 @@ int srslte_chest_ul_estimate_pusch(srslte_chest_ul_t*     q,
   /* Get references from the input signal */
   srslte_refsignal_dmrs_pusch_get(&q->dmrs_signal, cfg, input, q->pilot_recv_signal);
 
+  // Generate the known DMRS signal from the base sequences of the cell
+  const srslte_refsignal_ul_dmrs_cache_t* cache = q->dmrs_cache_shared ? q->dmrs_cache_shared : &q->dmrs_cache;
+  if (srslte_refsignal_dmrs_pusch_cache_gen(
+          cache, nof_prb, sf->tti % SRSLTE_NOF_SF_X_FRAME, cfg->grant.n_dmrs, q->pilot_known_signal)) {
+    ERROR("Error generating DMRS for nof_prb=%d\n", nof_prb);
+    return SRSLTE_ERROR;
+  }
+
   // Use the known DMRS signal to compute Least-squares estimates
-  srslte_vec_prod_conj_ccc(q->pilot_recv_signal,
-                           q->dmrs_pregen.r[cfg->grant.n_dmrs][sf->tti % SRSLTE_NOF_SF_X_FRAME][nof_prb],
-                           q->pilot_estimates,
-                           nrefs_sf);
+  srslte_vec_prod_conj_ccc(q->pilot_recv_signal, q->pilot_known_signal, q->pilot_estimates, nrefs_sf);
 
   // Estimate
   chest_ul_estimate(q, SRSLTE_NOF_SLOTS_PER_SF, nrefs_sym, 1, cfg->meas_ta_en, true, cfg->grant.n_prb, res);
@@ -548,4 +561,36 @@ int srslte_chest_ul_estimate_srs(srslte_chest_ul_t*                 q,
   chest_ul_estimate(q, 1, n_srs_re, 1, true, false, n_prb, res);
 
   return SRSLTE_SUCCESS;
-}
\ No newline at end of file
+}
+int srslte_chest_ul_srs_snr_sb(srslte_chest_ul_t*          q,
+                               srslte_ul_sf_cfg_t*         sf,
+                               srslte_refsignal_srs_cfg_t* cfg,
+                               srslte_chest_ul_res_t*      res,
+                               uint32_t                    sb_size,
+                               float*                      snr_sb_db)
+{
+  if (q == NULL || sf == NULL || cfg == NULL || res == NULL || snr_sb_db == NULL || sb_size == 0) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t n_srs_re = srslte_refsignal_srs_M_sc(&q->dmrs_signal, cfg);
+  uint32_t k0       = srslte_refsignal_srs_k0_ue(cfg, q->cell.nof_prb, sf->tti);
+  uint32_t nof_sb   = (q->cell.nof_prb + sb_size - 1) / sb_size;
+
+  for (uint32_t sb = 0; sb < nof_sb; sb++) {
+    // Pilot i is in sub-carrier k0 + 2 * i, select the pilots that fall in the subband
+    uint32_t k_begin = sb * sb_size * SRSLTE_NRE;
+    uint32_t k_end   = SRSLTE_MIN((sb + 1) * sb_size, q->cell.nof_prb) * SRSLTE_NRE;
+    uint32_t i_begin = SRSLTE_MIN(k_begin > k0 ? (k_begin - k0 + 1) / 2 : 0, n_srs_re);
+    uint32_t i_end   = SRSLTE_MIN(k_end > k0 ? (k_end - k0 + 1) / 2 : 0, n_srs_re);
+
+    if (i_end > i_begin && isnormal(res->noise_estimate)) {
+      float snr = srslte_vec_avg_power_cf(&q->pilot_recv_signal[i_begin], i_end - i_begin) / res->noise_estimate;
+      snr_sb_db[sb] = srslte_convert_power_to_dB(snr);
+    } else {
+      snr_sb_db[sb] = NAN;
+    }
+  }
+
+  return SRSLTE_SUCCESS;
+}
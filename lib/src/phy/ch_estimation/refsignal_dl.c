@@ -395,19 +395,22 @@ int srslte_refsignal_mbsfn_gen_seq(srslte_refsignal_t* q, srslte_cell_t cell, ui
     goto free_and_exit;
   }
 
+  // The sequence doesn't depend on the port, so it is generated once for both
   for (ns = 0; ns < SRSLTE_NOF_SF_X_FRAME; ns++) {
-    for (p = 0; p < 2; p++) {
-      uint32_t nsymbols = 3; // replace with function
-      for (l = 0; l < nsymbols; l++) {
-        uint32_t lp   = (srslte_refsignal_mbsfn_nsymbol(l)) % 6;
-        uint32_t slot = (l) ? (ns * 2 + 1) : (ns * 2);
-        c_init        = 512 * (7 * (slot + 1) + lp + 1) * (2 * N_mbsfn_id + 1) + N_mbsfn_id;
-        srslte_sequence_set_LTE_pr(&seq_mbsfn, SRSLTE_MAX_PRB * 20, c_init);
-        for (i = 0; i < 6 * q->cell.nof_prb; i++) {
-          uint32_t idx                   = SRSLTE_REFSIGNAL_PILOT_IDX_MBSFN(i, l, q->cell);
-          mp                             = i + 3 * (SRSLTE_MAX_PRB - cell.nof_prb);
-          __real__ q->pilots[p][ns][idx] = (1 - 2 * (float)seq_mbsfn.c[2 * mp + 0]) * M_SQRT1_2;
-          __imag__ q->pilots[p][ns][idx] = (1 - 2 * (float)seq_mbsfn.c[2 * mp + 1]) * M_SQRT1_2;
+    uint32_t nsymbols = 3; // replace with function
+    for (l = 0; l < nsymbols; l++) {
+      uint32_t lp   = (srslte_refsignal_mbsfn_nsymbol(l)) % 6;
+      uint32_t slot = (l) ? (ns * 2 + 1) : (ns * 2);
+      c_init        = 512 * (7 * (slot + 1) + lp + 1) * (2 * N_mbsfn_id + 1) + N_mbsfn_id;
+      srslte_sequence_set_LTE_pr(&seq_mbsfn, SRSLTE_MAX_PRB * 20, c_init);
+      for (i = 0; i < 6 * q->cell.nof_prb; i++) {
+        uint32_t idx = SRSLTE_REFSIGNAL_PILOT_IDX_MBSFN(i, l, q->cell);
+        mp           = i + 3 * (SRSLTE_MAX_PRB - cell.nof_prb);
+        float re     = (1 - 2 * (float)seq_mbsfn.c[2 * mp + 0]) * M_SQRT1_2;
+        float im     = (1 - 2 * (float)seq_mbsfn.c[2 * mp + 1]) * M_SQRT1_2;
+        for (p = 0; p < 2; p++) {
+          __real__ q->pilots[p][ns][idx] = re;
+          __imag__ q->pilots[p][ns][idx] = im;
         }
       }
     }
@@ -207,6 +207,8 @@ int srslte_refsignal_ul_set_cell(srslte_refsignal_ul_t* q, srslte_cell_t cell)
       if (srslte_pucch_n_cs_cell(q->cell, q->n_cs_cell)) {
         return SRSLTE_ERROR;
       }
+
+      bzero(q->pucch_cache, sizeof(q->pucch_cache));
     }
     ret = SRSLTE_SUCCESS;
   }
@@ -272,14 +274,23 @@ static void compute_r_uv_arg(srslte_refsignal_ul_t* q, uint32_t nof_prb, uint32_
   }
 }
 
+/* Calculates n_cs according to 5.5.2.1.1 of 36.211 */
+static uint32_t pusch_n_cs(srslte_refsignal_ul_t*             q,
+                           srslte_refsignal_dmrs_pusch_cfg_t* cfg,
+                           uint32_t                           cyclic_shift_for_dmrs,
+                           uint32_t                           ns)
+{
+  uint32_t n_dmrs_2_val = n_dmrs_2[cyclic_shift_for_dmrs];
+  return (n_dmrs_1[cfg->cyclic_shift] + n_dmrs_2_val + q->n_prs_pusch[cfg->delta_ss][ns]) % 12;
+}
+
 /* Calculates alpha according to 5.5.2.1.1 of 36.211 */
 static float pusch_alpha(srslte_refsignal_ul_t*             q,
                          srslte_refsignal_dmrs_pusch_cfg_t* cfg,
                          uint32_t                           cyclic_shift_for_dmrs,
                          uint32_t                           ns)
 {
-  uint32_t n_dmrs_2_val = n_dmrs_2[cyclic_shift_for_dmrs];
-  uint32_t n_cs         = (n_dmrs_1[cfg->cyclic_shift] + n_dmrs_2_val + q->n_prs_pusch[cfg->delta_ss][ns]) % 12;
+  uint32_t n_cs = pusch_n_cs(q, cfg, cyclic_shift_for_dmrs, ns);
 
   return 2 * M_PI * (n_cs) / 12;
 }
@@ -327,25 +338,36 @@ void srslte_refsignal_dmrs_pusch_get(srslte_refsignal_ul_t* q,
   }
 }
 
-/* Computes r sequence */
-static void compute_r(srslte_refsignal_ul_t*             q,
-                      srslte_refsignal_dmrs_pusch_cfg_t* cfg,
-                      uint32_t                           nof_prb,
-                      uint32_t                           ns,
-                      uint32_t                           delta_ss)
+/* Gets group hopping number u */
+static uint32_t
+pusch_u(srslte_refsignal_ul_t* q, srslte_refsignal_dmrs_pusch_cfg_t* cfg, uint32_t ns, uint32_t delta_ss)
 {
-  // Get group hopping number u
   uint32_t f_gh = 0;
   if (cfg->group_hopping_en) {
     f_gh = q->f_gh[ns];
   }
-  uint32_t u = (f_gh + (q->cell.id % 30) + delta_ss) % 30;
+  return (f_gh + (q->cell.id % 30) + delta_ss) % 30;
+}
 
-  // Get sequence hopping number v
+/* Gets sequence hopping number v */
+static uint32_t pusch_v(srslte_refsignal_ul_t* q, srslte_refsignal_dmrs_pusch_cfg_t* cfg, uint32_t nof_prb, uint32_t ns)
+{
   uint32_t v = 0;
   if (nof_prb >= 6 && cfg->sequence_hopping_en) {
     v = q->v_pusch[ns][cfg->delta_ss];
   }
+  return v;
+}
+
+/* Computes r sequence */
+static void compute_r(srslte_refsignal_ul_t*             q,
+                      srslte_refsignal_dmrs_pusch_cfg_t* cfg,
+                      uint32_t                           nof_prb,
+                      uint32_t                           ns,
+                      uint32_t                           delta_ss)
+{
+  uint32_t u = pusch_u(q, cfg, ns, delta_ss);
+  uint32_t v = pusch_v(q, cfg, nof_prb, ns);
 
   // Compute signal argument
   compute_r_uv_arg(q, nof_prb, u, v);
@@ -435,6 +457,138 @@ int srslte_refsignal_dmrs_pusch_pregen_put(srslte_refsignal_ul_t*             q,
   }
 }
 
+int srslte_refsignal_dmrs_pusch_cache_init(srslte_refsignal_ul_dmrs_cache_t* cache, uint32_t max_prb)
+{
+  if (cache == NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  bzero(cache, sizeof(srslte_refsignal_ul_dmrs_cache_t));
+  cache->max_prb = max_prb;
+
+  for (uint32_t n_cs = 0; n_cs < SRSLTE_NRE; n_cs++) {
+    cache->cs_phasor[n_cs] = srslte_vec_cf_malloc(SRSLTE_NRE * max_prb);
+    if (!cache->cs_phasor[n_cs]) {
+      srslte_refsignal_dmrs_pusch_cache_free(cache);
+      return SRSLTE_ERROR;
+    }
+    // The phase is reduced in integer arithmetic so that it does not lose precision for the last subcarriers
+    for (uint32_t i = 0; i < SRSLTE_NRE * max_prb; i++) {
+      cache->cs_phasor[n_cs][i] = cexpf(I * 2 * M_PI * ((n_cs * i) % SRSLTE_NRE) / SRSLTE_NRE);
+    }
+  }
+  return SRSLTE_SUCCESS;
+}
+
+static void dmrs_pusch_cache_reset(srslte_refsignal_ul_dmrs_cache_t* cache)
+{
+  for (uint32_t u = 0; u < SRSLTE_NOF_GROUPS_U; u++) {
+    for (uint32_t v = 0; v < SRSLTE_NOF_SEQUENCES_U; v++) {
+      if (cache->r_uv[u][v]) {
+        for (uint32_t n = 0; n <= cache->max_prb; n++) {
+          if (cache->r_uv[u][v][n]) {
+            free(cache->r_uv[u][v][n]);
+          }
+        }
+        free(cache->r_uv[u][v]);
+        cache->r_uv[u][v] = NULL;
+      }
+    }
+  }
+  cache->nof_prb = 0;
+}
+
+int srslte_refsignal_dmrs_pusch_cache_set(srslte_refsignal_ul_t*             q,
+                                          srslte_refsignal_ul_dmrs_cache_t*  cache,
+                                          srslte_refsignal_dmrs_pusch_cfg_t* cfg)
+{
+  if (q == NULL || cache == NULL || cfg == NULL || !pusch_cfg_isvalid(q, cfg, 0) || q->cell.nof_prb > cache->max_prb) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  dmrs_pusch_cache_reset(cache);
+
+  for (uint32_t ns = 0; ns < SRSLTE_NSLOTS_X_FRAME; ns++) {
+    uint32_t u = pusch_u(q, cfg, ns, cfg->delta_ss);
+
+    // v is stored for the allocations of 6 PRB or more, it is always 0 below
+    cache->u[ns] = u;
+    cache->v[ns] = pusch_v(q, cfg, 6, ns);
+    for (uint32_t cs = 0; cs < SRSLTE_NOF_CSHIFT; cs++) {
+      cache->n_cs[ns][cs] = pusch_n_cs(q, cfg, cs, ns);
+    }
+
+    // Generate the base sequences of this slot that are not in the cache yet
+    for (uint32_t n = 1; n <= q->cell.nof_prb; n++) {
+      if (!srslte_dft_precoding_valid_prb(n)) {
+        continue;
+      }
+      uint32_t v = pusch_v(q, cfg, n, ns);
+      if (!cache->r_uv[u][v]) {
+        cache->r_uv[u][v] = (cf_t**)calloc(sizeof(cf_t*), cache->max_prb + 1);
+        if (!cache->r_uv[u][v]) {
+          return SRSLTE_ERROR;
+        }
+      }
+      if (!cache->r_uv[u][v][n]) {
+        cache->r_uv[u][v][n] = srslte_vec_cf_malloc(SRSLTE_NRE * n);
+        if (!cache->r_uv[u][v][n]) {
+          return SRSLTE_ERROR;
+        }
+        compute_r_uv_arg(q, n, u, v);
+        for (uint32_t i = 0; i < SRSLTE_NRE * n; i++) {
+          cache->r_uv[u][v][n][i] = cexpf(I * q->tmp_arg[i]);
+        }
+      }
+    }
+  }
+  cache->nof_prb = q->cell.nof_prb;
+
+  return SRSLTE_SUCCESS;
+}
+
+void srslte_refsignal_dmrs_pusch_cache_free(srslte_refsignal_ul_dmrs_cache_t* cache)
+{
+  if (cache == NULL) {
+    return;
+  }
+  dmrs_pusch_cache_reset(cache);
+  for (uint32_t n_cs = 0; n_cs < SRSLTE_NRE; n_cs++) {
+    if (cache->cs_phasor[n_cs]) {
+      free(cache->cs_phasor[n_cs]);
+    }
+  }
+  bzero(cache, sizeof(srslte_refsignal_ul_dmrs_cache_t));
+}
+
+/* Generates the DMRS for PUSCH of a subframe from the cached base sequences, same output as
+ * srslte_refsignal_dmrs_pusch_gen() */
+int srslte_refsignal_dmrs_pusch_cache_gen(const srslte_refsignal_ul_dmrs_cache_t* cache,
+                                          uint32_t                                nof_prb,
+                                          uint32_t                                sf_idx,
+                                          uint32_t                                cyclic_shift_for_dmrs,
+                                          cf_t*                                   r_pusch)
+{
+  if (cache == NULL || r_pusch == NULL || !srslte_dft_precoding_valid_prb(nof_prb) || nof_prb > cache->nof_prb ||
+      sf_idx >= SRSLTE_NOF_SF_X_FRAME || cyclic_shift_for_dmrs >= SRSLTE_NOF_CSHIFT) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t M_sc = SRSLTE_NRE * nof_prb;
+  for (uint32_t ns = 2 * sf_idx; ns < 2 * (sf_idx + 1); ns++) {
+    uint32_t v    = nof_prb >= 6 ? cache->v[ns] : 0;
+    cf_t**   r_uv = cache->r_uv[cache->u[ns]][v];
+    if (r_uv == NULL || r_uv[nof_prb] == NULL) {
+      return SRSLTE_ERROR;
+    }
+
+    // Apply the cyclic shift of the slot as a phase rotation of the base sequence
+    srslte_vec_prod_ccc(
+        r_uv[nof_prb], cache->cs_phasor[cache->n_cs[ns][cyclic_shift_for_dmrs]], &r_pusch[(ns % 2) * M_sc], M_sc);
+  }
+  return SRSLTE_SUCCESS;
+}
+
 /* Generate DMRS for PUSCH signal according to 5.5.2.1 of 36.211 */
 int srslte_refsignal_dmrs_pusch_gen(srslte_refsignal_ul_t*             q,
                                     srslte_refsignal_dmrs_pusch_cfg_t* cfg,
@@ -536,6 +690,36 @@ uint32_t srslte_refsignal_dmrs_pucch_symbol(uint32_t m, srslte_pucch_format_t fo
   return 0;
 }
 
+/* Argument of the orthogonal sequence w(m) of the PUCCH DMRS symbol m, Tables 5.5.2.2.1-2 and 5.5.2.2.1-3 of 36.211 */
+float srslte_refsignal_dmrs_pucch_w_arg(srslte_pucch_format_t format, srslte_cp_t cp, uint32_t n_oc, uint32_t m)
+{
+  switch (format) {
+    case SRSLTE_PUCCH_FORMAT_1:
+    case SRSLTE_PUCCH_FORMAT_1A:
+    case SRSLTE_PUCCH_FORMAT_1B:
+      if (SRSLTE_CP_ISNORM(cp)) {
+        return (n_oc < 3 && m < 3) ? w_arg_pucch_format1_cpnorm[n_oc][m] : 0.0f;
+      } else {
+        return (n_oc < 3 && m < 2) ? w_arg_pucch_format1_cpext[n_oc][m] : 0.0f;
+      }
+    default:
+      // The formats 2 and 3 have no orthogonal sequence
+      return 0.0f;
+  }
+}
+
+/* Modulates the second DMRS symbol of each slot with the format 2a/2b bits */
+static void pucch_dmrs_apply_z_m_1(cf_t* r_pucch, uint32_t N_rs, cf_t z_m_1)
+{
+  if (z_m_1 == 1.0f || N_rs < 2) {
+    return;
+  }
+  for (uint32_t ns = 0; ns < SRSLTE_NOF_SLOTS_PER_SF; ns++) {
+    cf_t* r = &r_pucch[ns * SRSLTE_NRE * N_rs + SRSLTE_NRE];
+    srslte_vec_sc_prod_ccc(r, z_m_1, r, SRSLTE_NRE);
+  }
+}
+
 /* Generates DMRS for PUCCH according to 5.5.2.2 in 36.211 */
 int srslte_refsignal_dmrs_pucch_gen(srslte_refsignal_ul_t* q,
                                     srslte_ul_sf_cfg_t*    sf,
@@ -555,6 +739,15 @@ int srslte_refsignal_dmrs_pucch_gen(srslte_refsignal_ul_t* q,
       srslte_pucch_format2ab_mod_bits(cfg->format, cfg->pucch2_drs_bits, &z_m_1);
     }
 
+    // The sequences only depend on the configuration, the 2a/2b bits are applied on the cached copy
+    srslte_refsignal_dmrs_pucch_cache_t* cache = &q->pucch_cache[sf_idx];
+    if (srslte_pucch_seq_key_match(&cache->key, cfg, false)) {
+      memcpy(r_pucch, cache->r, sizeof(cf_t) * SRSLTE_NRE * N_rs * SRSLTE_NOF_SLOTS_PER_SF);
+      pucch_dmrs_apply_z_m_1(r_pucch, N_rs, z_m_1);
+      return SRSLTE_SUCCESS;
+    }
+    cache->key.valid = false;
+
     for (uint32_t ns = 2 * sf_idx; ns < 2 * (sf_idx + 1); ns++) {
       // Get group hopping number u
       uint32_t f_gh = 0;
@@ -605,16 +798,15 @@ int srslte_refsignal_dmrs_pucch_gen(srslte_refsignal_ul_t* q,
             ERROR("DMRS Generator: Unsupported format %d\n", cfg->format);
             return SRSLTE_ERROR;
         }
-        cf_t z_m = 1.0;
-        if (m == 1) {
-          z_m = z_m_1;
-        }
         for (uint32_t n = 0; n < SRSLTE_NRE; n++) {
-          r_pucch[(ns % 2) * SRSLTE_NRE * N_rs + m * SRSLTE_NRE + n] =
-              z_m * cexpf(I * (w[m] + q->tmp_arg[n] + alpha * n));
+          cache->r[(ns % 2) * SRSLTE_NRE * N_rs + m * SRSLTE_NRE + n] = cexpf(I * (w[m] + q->tmp_arg[n] + alpha * n));
         }
       }
     }
+    srslte_pucch_seq_key_set(&cache->key, cfg, false);
+
+    memcpy(r_pucch, cache->r, sizeof(cf_t) * SRSLTE_NRE * N_rs * SRSLTE_NOF_SLOTS_PER_SF);
+    pucch_dmrs_apply_z_m_1(r_pucch, N_rs, z_m_1);
     ret = SRSLTE_SUCCESS;
   }
   return ret;
@@ -913,7 +1105,7 @@ static uint32_t srs_Fb(srslte_refsignal_srs_cfg_t* cfg, uint32_t b, uint32_t nof
 }
 
 /* Returns k0: frequency-domain starting position for ue-specific SRS */
-static uint32_t srs_k0_ue(srslte_refsignal_srs_cfg_t* cfg, uint32_t nof_prb, uint32_t tti)
+uint32_t srslte_refsignal_srs_k0_ue(srslte_refsignal_srs_cfg_t* cfg, uint32_t nof_prb, uint32_t tti)
 {
 
   if (cfg->bw_cfg < 8 && cfg->B < 4 && cfg->k_tc < 2) {
@@ -1014,7 +1206,7 @@ int srslte_refsignal_srs_put(srslte_refsignal_ul_t*      q,
   int ret = SRSLTE_ERROR_INVALID_INPUTS;
   if (r_srs && q && sf_symbols && cfg) {
     uint32_t M_sc = srslte_refsignal_srs_M_sc(q, cfg);
-    uint32_t k0   = srs_k0_ue(cfg, q->cell.nof_prb, tti);
+    uint32_t k0   = srslte_refsignal_srs_k0_ue(cfg, q->cell.nof_prb, tti);
     for (int i = 0; i < M_sc; i++) {
       sf_symbols[SRSLTE_RE_IDX(q->cell.nof_prb, 2 * SRSLTE_CP_NSYMB(q->cell.cp) - 1, k0 + 2 * i)] = r_srs[i];
     }
@@ -1032,7 +1224,7 @@ int srslte_refsignal_srs_get(srslte_refsignal_ul_t*      q,
   int ret = SRSLTE_ERROR_INVALID_INPUTS;
   if (r_srs && q && sf_symbols && cfg) {
     uint32_t M_sc = srslte_refsignal_srs_M_sc(q, cfg);
-    uint32_t k0   = srs_k0_ue(cfg, q->cell.nof_prb, tti);
+    uint32_t k0   = srslte_refsignal_srs_k0_ue(cfg, q->cell.nof_prb, tti);
     for (int i = 0; i < M_sc; i++) {
       r_srs[i] = sf_symbols[SRSLTE_RE_IDX(q->cell.nof_prb, 2 * SRSLTE_CP_NSYMB(q->cell.cp) - 1, k0 + 2 * i)];
     }
@@ -36,6 +36,8 @@ srslte_cell_t cell = {6,              // nof_prb
                       SRSLTE_FDD};
 
 char* output_matlab = NULL;
+bool  test_wiener   = false;
+bool  test_residual = false;
 
 void usage(char* prog)
 {
@@ -47,13 +49,15 @@ void usage(char* prog)
   printf("\t-c cell_id (1000 tests all). [Default %d]\n", cell.id);
 
   printf("\t-o output matlab file [Default %s]\n", output_matlab ? output_matlab : "None");
+  printf("\t-w compare the Wiener filter bank with the adaptive Wiener estimator\n");
+  printf("\t-i check the covariance of the CRS residuals of 2 antennas with an interferer\n");
   printf("\t-v increase verbosity\n");
 }
 
 void parse_args(int argc, char** argv)
 {
   int opt;
-  while ((opt = getopt(argc, argv, "recov")) != -1) {
+  while ((opt = getopt(argc, argv, "recovwi")) != -1) {
     switch (opt) {
       case 'r':
         cell.nof_prb = (uint32_t)strtol(argv[optind], NULL, 10);
@@ -70,6 +74,12 @@ void parse_args(int argc, char** argv)
       case 'v':
         srslte_verbose++;
         break;
+      case 'w':
+        test_wiener = true;
+        break;
+      case 'i':
+        test_residual = true;
+        break;
       default:
         usage(argv[0]);
         exit(-1);
@@ -77,6 +87,208 @@ void parse_args(int argc, char** argv)
   }
 }
 
+#define WIENER_TEST_NOF_SF (40)     // Subframes estimated for each Wiener mode
+#define WIENER_TEST_NOF_WARMUP (20) // Subframes the estimators take to converge, not accounted in the MSE
+#define WIENER_TEST_SNR_DB (15.0f)
+#define WIENER_TEST_MAX_LOSS_DB (1.0f) // Maximum MSE loss of the filter bank with respect to the adaptive estimator
+
+// Estimates a static frequency selective channel with both Wiener modes and returns the MSE of the given one
+static float wiener_mse(srslte_wiener_dl_mode_t mode, const cf_t* h, cf_t* tx, cf_t* rx, cf_t* ce, uint32_t num_re)
+{
+  srslte_chest_dl_t     est = {};
+  srslte_chest_dl_res_t res = {};
+  srslte_chest_dl_cfg_t cfg = {};
+  float                 mse = 0.0f;
+  uint32_t              n   = 0;
+
+  cfg.estimator_alg = SRSLTE_ESTIMATOR_ALG_WIENER;
+  cfg.noise_alg     = SRSLTE_NOISE_ALG_REFS;
+  cfg.filter_type   = SRSLTE_CHEST_FILTER_GAUSS;
+  cfg.wiener_mode   = mode;
+
+  if (srslte_chest_dl_init(&est, cell.nof_prb, 1) || srslte_chest_dl_set_cell(&est, cell)) {
+    ERROR("Error initializing equalizer\n");
+    return NAN;
+  }
+  res.ce[0][0] = ce;
+
+  float noise_var = srslte_convert_dB_to_power(-WIENER_TEST_SNR_DB);
+  for (uint32_t sf_idx = 0; sf_idx < WIENER_TEST_NOF_SF; sf_idx++) {
+    srslte_dl_sf_cfg_t sf_cfg = {};
+    sf_cfg.tti                = sf_idx;
+
+    srslte_vec_cf_zero(tx, num_re);
+    srslte_refsignal_cs_put_sf(&est.csr_refs, &sf_cfg, 0, tx);
+    srslte_vec_prod_ccc(tx, h, rx, num_re);
+    srslte_ch_awgn_c(rx, rx, noise_var, num_re);
+
+    cf_t* input_m[SRSLTE_MAX_PORTS] = {rx};
+    srslte_chest_dl_estimate_cfg(&est, &sf_cfg, &cfg, input_m, &res);
+
+    if (sf_idx >= WIENER_TEST_NOF_WARMUP) {
+      for (uint32_t i = 0; i < num_re; i++) {
+        mse += __real__(ce[i] - h[i]) * __real__(ce[i] - h[i]) + __imag__(ce[i] - h[i]) * __imag__(ce[i] - h[i]);
+      }
+      n += num_re;
+    }
+  }
+
+  srslte_chest_dl_free(&est);
+  return mse / n;
+}
+
+static int wiener_test(void)
+{
+  uint32_t nre    = cell.nof_prb * SRSLTE_NRE;
+  uint32_t num_re = 2 * SRSLTE_CP_NSYMB(cell.cp) * nre;
+  int      ret    = SRSLTE_ERROR;
+
+  // A single cell is enough, the default of the other tests scans all of them
+  if (cell.id >= SRSLTE_NOF_NID_2 * SRSLTE_NOF_NID_1) {
+    cell.id = 1;
+  }
+
+  cf_t* h  = srslte_vec_cf_malloc(num_re);
+  cf_t* tx = srslte_vec_cf_malloc(num_re);
+  cf_t* rx = srslte_vec_cf_malloc(num_re);
+  cf_t* ce = srslte_vec_cf_malloc(num_re);
+  if (!h || !tx || !rx || !ce) {
+    perror("srslte_vec_malloc");
+    goto clean_exit;
+  }
+
+  // Static three tap channel with an RMS delay spread of about 400 ns
+  const float tap_delay[3] = {0.0f, 300e-9f, 900e-9f};
+  const float tap_gain[3]  = {0.8f, 0.5f, 0.33f};
+  for (uint32_t k = 0; k < nre; k++) {
+    cf_t hk = 0.0f;
+    for (uint32_t t = 0; t < 3; t++) {
+      hk += tap_gain[t] * cexpf(-I * 2.0f * (float)M_PI * k * 15e3f * tap_delay[t]);
+    }
+    for (uint32_t l = 0; l < 2 * SRSLTE_CP_NSYMB(cell.cp); l++) {
+      h[l * nre + k] = hk;
+    }
+  }
+
+  float mse_adaptive = wiener_mse(SRSLTE_WIENER_DL_MODE_ADAPTIVE, h, tx, rx, ce, num_re);
+  float mse_bank     = wiener_mse(SRSLTE_WIENER_DL_MODE_FILTER_BANK, h, tx, rx, ce, num_re);
+  printf("Wiener MSE: adaptive %.2f dB, filter bank %.2f dB\n",
+         srslte_convert_power_to_dB(mse_adaptive),
+         srslte_convert_power_to_dB(mse_bank));
+
+  if (isnormal(mse_adaptive) && isnormal(mse_bank) &&
+      srslte_convert_power_to_dB(mse_bank) <= srslte_convert_power_to_dB(mse_adaptive) + WIENER_TEST_MAX_LOSS_DB) {
+    ret = SRSLTE_SUCCESS;
+  }
+
+clean_exit:
+  if (h) {
+    free(h);
+  }
+  if (tx) {
+    free(tx);
+  }
+  if (rx) {
+    free(rx);
+  }
+  if (ce) {
+    free(ce);
+  }
+  printf("%s\n", ret ? "Error" : "OK");
+  return ret;
+}
+
+#define RESIDUAL_TEST_NOF_SF (10)
+#define RESIDUAL_TEST_INR_DB (20.0f)      // Interference to noise ratio
+#define RESIDUAL_TEST_MAX_ERROR_DB (1.5f) // Maximum error of the interference plus noise power
+#define RESIDUAL_TEST_MIN_CORR (0.9f)     // Minimum correlation between antennas, the interference dominates
+
+/* Two antennas receive the CRS through a static channel plus a flat interferer and noise. The CRS residuals must hold
+ * the interference plus noise: their power per antenna and their correlation between antennas are checked */
+static int residual_test(void)
+{
+  uint32_t              nre       = cell.nof_prb * SRSLTE_NRE;
+  uint32_t              num_re    = 2 * SRSLTE_CP_NSYMB(cell.cp) * nre;
+  const cf_t            g[2]      = {0.8f, 0.6f * cexpf(I * 1.0f)};
+  const float           noise_var = srslte_convert_dB_to_power(-RESIDUAL_TEST_INR_DB);
+  int                   ret       = SRSLTE_ERROR;
+  srslte_chest_dl_t     est       = {};
+  srslte_chest_dl_res_t res       = {};
+  srslte_chest_dl_cfg_t cfg       = {};
+  cf_t*                 tx        = srslte_vec_cf_malloc(num_re);
+  cf_t*                 rx[2]     = {srslte_vec_cf_malloc(num_re), srslte_vec_cf_malloc(num_re)};
+  cf_t                  R[4]      = {};
+
+  if (cell.id >= SRSLTE_NOF_NID_2 * SRSLTE_NOF_NID_1) {
+    cell.id = 1;
+  }
+
+  cfg.estimator_alg       = SRSLTE_ESTIMATOR_ALG_AVERAGE;
+  cfg.noise_alg           = SRSLTE_NOISE_ALG_REFS;
+  cfg.filter_type         = SRSLTE_CHEST_FILTER_GAUSS;
+  cfg.crs_residual_enable = true;
+
+  if (!tx || !rx[0] || !rx[1] || srslte_chest_dl_init(&est, cell.nof_prb, 2) || srslte_chest_dl_set_cell(&est, cell) ||
+      srslte_chest_dl_res_init(&res, cell.nof_prb)) {
+    ERROR("Error initializing equalizer\n");
+    goto clean_exit;
+  }
+
+  for (uint32_t sf_idx = 1; sf_idx <= RESIDUAL_TEST_NOF_SF; sf_idx++) {
+    srslte_dl_sf_cfg_t sf_cfg = {};
+    sf_cfg.tti                = sf_idx;
+
+    srslte_vec_cf_zero(tx, num_re);
+    srslte_refsignal_cs_put_sf(&est.csr_refs, &sf_cfg, 0, tx);
+    for (uint32_t i = 0; i < num_re; i++) {
+      cf_t interf = ((rand() % 2) ? M_SQRT1_2 : -M_SQRT1_2) + I * ((rand() % 2) ? M_SQRT1_2 : -M_SQRT1_2);
+      for (uint32_t j = 0; j < 2; j++) {
+        rx[j][i] = tx[i] * (1.0f + 0.5f * cexpf(I * 2.0f * (float)M_PI * (i % nre) / nre)) + g[j] * interf;
+      }
+    }
+    for (uint32_t j = 0; j < 2; j++) {
+      srslte_ch_awgn_c(rx[j], rx[j], sqrtf(noise_var / 2.0f), num_re);
+    }
+
+    if (srslte_chest_dl_estimate_cfg(&est, &sf_cfg, &cfg, rx, &res) || res.nof_crs_residual == 0) {
+      goto clean_exit;
+    }
+
+    cf_t R_sf[4];
+    srslte_predecoding_irc_covariance(res.crs_residual, 2, res.nof_crs_residual, R_sf);
+    for (uint32_t k = 0; k < 4; k++) {
+      R[k] += R_sf[k] / RESIDUAL_TEST_NOF_SF;
+    }
+  }
+
+  float err_db[2];
+  for (uint32_t j = 0; j < 2; j++) {
+    float expected = __real__(g[j] * conjf(g[j])) + noise_var;
+    err_db[j]      = srslte_convert_power_to_dB(__real__ R[3 * j] / expected);
+  }
+  float corr = cabsf(R[1]) / sqrtf(__real__ R[0] * __real__ R[3]);
+  printf("CRS residuals: power error %+.2f dB and %+.2f dB, correlation %.3f\n", err_db[0], err_db[1], corr);
+
+  if (fabsf(err_db[0]) < RESIDUAL_TEST_MAX_ERROR_DB && fabsf(err_db[1]) < RESIDUAL_TEST_MAX_ERROR_DB &&
+      corr > RESIDUAL_TEST_MIN_CORR) {
+    ret = SRSLTE_SUCCESS;
+  }
+
+clean_exit:
+  srslte_chest_dl_free(&est);
+  srslte_chest_dl_res_free(&res);
+  if (tx) {
+    free(tx);
+  }
+  for (uint32_t j = 0; j < 2; j++) {
+    if (rx[j]) {
+      free(rx[j]);
+    }
+  }
+  printf("%s\n", ret ? "Error" : "OK");
+  return ret;
+}
+
 int main(int argc, char** argv)
 {
   srslte_chest_dl_t est;
@@ -89,6 +301,14 @@ int main(int argc, char** argv)
 
   parse_args(argc, argv);
 
+  if (test_wiener) {
+    exit(wiener_test());
+  }
+
+  if (test_residual) {
+    exit(residual_test());
+  }
+
   if (output_matlab) {
     fmatlab = fopen(output_matlab, "w");
     if (!fmatlab) {
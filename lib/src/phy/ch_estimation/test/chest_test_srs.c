@@ -173,6 +173,21 @@ int srs_test_context_run(srs_test_context_t* q)
   TESTASSERT(fabsf(q->chest_ul_res.noise_estimate_dbm - n0_dbm) < CHEST_TEST_SRS_SNR_DB_TOLERANCE);
   TESTASSERT(fabsf(q->chest_ul_res.ta_us) < CHEST_TEST_SRS_TA_US_TOLERANCE);
 
+  // Assert the SNR of the subbands, only the sounded ones are measured
+  float    snr_sb_db[SRSLTE_MAX_PRB];
+  uint32_t sb_size = 4;
+  TESTASSERT(srslte_chest_ul_srs_snr_sb(&q->chest_ul, &ul_sf_cfg, &srs_cfg, &q->chest_ul_res, sb_size, snr_sb_db) ==
+             SRSLTE_SUCCESS);
+  uint32_t prb_begin = srslte_refsignal_srs_k0_ue(&srs_cfg, cell.nof_prb, ul_sf_cfg.tti) / SRSLTE_NRE;
+  uint32_t prb_end   = prb_begin + 2 * srslte_refsignal_srs_M_sc(&q->refsignal_ul, &srs_cfg) / SRSLTE_NRE;
+  for (uint32_t sb = 0; sb < (cell.nof_prb + sb_size - 1) / sb_size; sb++) {
+    if (sb * sb_size < prb_end && (sb + 1) * sb_size > prb_begin) {
+      TESTASSERT(fabsf(snr_sb_db[sb] - snr_db) < CHEST_TEST_SRS_SNR_DB_TOLERANCE);
+    } else {
+      TESTASSERT(isnan(snr_sb_db[sb]));
+    }
+  }
+
   return SRSLTE_SUCCESS;
 }
 
@@ -20,6 +20,7 @@
  */
 
 #include <assert.h>
+#include <pthread.h>
 #include <srslte/phy/ch_estimation/wiener_dl.h>
 #include <srslte/phy/utils/mat.h>
 #include <srslte/srslte.h>
@@ -34,6 +35,13 @@
 #define M_5_3 1.66666666666666666666f /* 5 / 3 */
 #define SRSLTE_WIENER_HALFREF_IDX (q->nof_ref / 2 - 1)
 
+// Filter bank parameters
+#define WIENER_DL_BANK_NOF_SHIFTS (6U)           // Possible reference signal frequency shifts
+#define WIENER_DL_BANK_SNR_STEP_DB (3.0f)        // SNR step between filter bank points
+#define WIENER_DL_BANK_MIN_DELAY (50e-9f)        // Smallest RMS delay spread in the filter bank
+#define WIENER_DL_SC_SPACING_HZ (15e3f)          // Subcarrier spacing
+#define WIENER_DL_DELAY_SPREAD_EMA_COEFF (0.01f) // Exponential moving average coefficient for the delay spread
+
 // Constants
 const float hlsv_sum_norm[SRSLTE_WIENER_DL_MIN_RE] = {0.0625f,
                                                       0.0638297872326845f,
@@ -84,6 +92,13 @@ const float hlsv_sum_norm[SRSLTE_WIENER_DL_MIN_RE] = {0.0625f,
                                                       1.4999999655f,
                                                       2.99999985900001};
 
+// Precomputed Wiener matrices for every reference signal shift, SNR and RMS delay spread. They are shared by all the
+// estimator objects of the process and generated only once.
+typedef srslte_wiener_dl_wm_t wiener_dl_bank_t[SRSLTE_WIENER_DL_BANK_NOF_SNR][SRSLTE_WIENER_DL_BANK_NOF_DELAY];
+
+static pthread_once_t    wiener_dl_bank_once = PTHREAD_ONCE_INIT;
+static wiener_dl_bank_t* wiener_dl_bank[WIENER_DL_BANK_NOF_SHIFTS];
+
 // Local state function prototypes
 static srslte_wiener_dl_state_t* srslte_wiener_dl_state_malloc(srslte_wiener_dl_t* q);
 static void                      srslte_wiener_dl_state_free(srslte_wiener_dl_state_t* q);
@@ -169,6 +184,11 @@ static srslte_wiener_dl_state_t* srslte_wiener_dl_state_malloc(srslte_wiener_dl_
     state->sumlen       = 1;
     state->skip         = 1;
     state->cnt          = 0;
+    state->delay_spread = 0.0f;
+    state->freq_corr    = 0.0f;
+    state->freq_power   = 0.0f;
+    state->wm1          = (const srslte_wiener_dl_wm_t*)&q->wm1;
+    state->wm2          = (const srslte_wiener_dl_wm_t*)&q->wm2;
 
     if (ret) {
       // Free all allocated memory
@@ -210,6 +230,11 @@ static void srslte_wiener_dl_state_reset(srslte_wiener_dl_t* q, srslte_wiener_dl
     state->sumlen       = 0;
     state->skip         = 0;
     state->cnt          = 0;
+    state->delay_spread = 0.0f;
+    state->freq_corr    = 0.0f;
+    state->freq_power   = 0.0f;
+    state->wm1          = (const srslte_wiener_dl_wm_t*)&q->wm1;
+    state->wm2          = (const srslte_wiener_dl_wm_t*)&q->wm2;
   }
 }
 
@@ -249,6 +274,106 @@ static void srslte_wiener_dl_state_free(srslte_wiener_dl_state_t* q)
   }
 }
 
+// Computes the Wiener matrix of a reference signal shift from the frequency correlation vector and the noise power.
+// The correlation matrix gets badly conditioned at high SNR and low delay spread, so the matrices are computed offline in
+// double precision with a Gauss-Jordan elimination instead of the single precision runtime inverter.
+static void wiener_dl_compute_wm(const double complex* acV, double N, uint32_t shift, srslte_wiener_dl_wm_t wm)
+{
+  double complex RH[SRSLTE_WIENER_DL_MIN_REF][2 * SRSLTE_WIENER_DL_MIN_REF];
+
+  // Square correlation matrix among reference signals plus noise, augmented with the identity
+  for (uint32_t i = 0; i < SRSLTE_WIENER_DL_MIN_REF; i++) {
+    for (uint32_t k = i; k < SRSLTE_WIENER_DL_MIN_REF; k++) {
+      RH[i][k] = acV[6 * (k - i)];
+      RH[k][i] = conj(RH[i][k]);
+    }
+    RH[i][i] += N;
+    for (uint32_t k = 0; k < SRSLTE_WIENER_DL_MIN_REF; k++) {
+      RH[i][SRSLTE_WIENER_DL_MIN_REF + k] = (i == k) ? 1.0 : 0.0;
+    }
+  }
+
+  // Invert with partial pivoting
+  for (uint32_t c = 0; c < SRSLTE_WIENER_DL_MIN_REF; c++) {
+    uint32_t pivot = c;
+    for (uint32_t r = c + 1; r < SRSLTE_WIENER_DL_MIN_REF; r++) {
+      if (cabs(RH[r][c]) > cabs(RH[pivot][c])) {
+        pivot = r;
+      }
+    }
+    for (uint32_t k = 0; k < 2 * SRSLTE_WIENER_DL_MIN_REF; k++) {
+      double complex tmp = RH[c][k];
+      RH[c][k]           = RH[pivot][k];
+      RH[pivot][k]       = tmp;
+    }
+
+    double complex inv = 1.0 / RH[c][c];
+    for (uint32_t k = 0; k < 2 * SRSLTE_WIENER_DL_MIN_REF; k++) {
+      RH[c][k] *= inv;
+    }
+    for (uint32_t r = 0; r < SRSLTE_WIENER_DL_MIN_REF; r++) {
+      if (r != c) {
+        double complex f = RH[r][c];
+        for (uint32_t k = 0; k < 2 * SRSLTE_WIENER_DL_MIN_REF; k++) {
+          RH[r][k] -= f * RH[c][k];
+        }
+      }
+    }
+  }
+
+  // Rectangular correlation between resource elements and reference signals times the inverse
+  for (uint32_t i = 0; i < SRSLTE_WIENER_DL_MIN_RE; i++) {
+    double complex hH[SRSLTE_WIENER_DL_MIN_REF];
+    for (uint32_t k = 0; k < SRSLTE_WIENER_DL_MIN_REF; k++) {
+      int m = shift + 6 * k - i;
+      hH[k] = (m >= 0) ? acV[m] : conj(acV[-m]);
+    }
+    for (uint32_t k = 0; k < SRSLTE_WIENER_DL_MIN_REF; k++) {
+      double complex acc = 0;
+      for (uint32_t j = 0; j < SRSLTE_WIENER_DL_MIN_REF; j++) {
+        acc += hH[j] * RH[j][SRSLTE_WIENER_DL_MIN_REF + k];
+      }
+      wm[i][k] = (cf_t)acc;
+    }
+  }
+}
+
+// Generates the filter bank assuming an exponential power delay profile, which has a frequency correlation
+// 1 / (1 + j2*pi*f*tau) for an RMS delay spread tau
+static void wiener_dl_bank_generate(void)
+{
+  for (uint32_t shift = 0; shift < WIENER_DL_BANK_NOF_SHIFTS; shift++) {
+    wiener_dl_bank[shift] = srslte_vec_malloc(sizeof(wiener_dl_bank_t));
+    if (!wiener_dl_bank[shift]) {
+      perror("malloc");
+      break;
+    }
+
+    for (uint32_t d = 0; d < SRSLTE_WIENER_DL_BANK_NOF_DELAY; d++) {
+      double         tau = WIENER_DL_BANK_MIN_DELAY * (double)(1U << d);
+      double complex acV[SRSLTE_WIENER_DL_MIN_RE];
+      for (uint32_t n = 0; n < SRSLTE_WIENER_DL_MIN_RE; n++) {
+        acV[n] = 1.0 / (1.0 - _Complex_I * 2.0 * M_PI * n * WIENER_DL_SC_SPACING_HZ * tau);
+      }
+
+      for (uint32_t s = 0; s < SRSLTE_WIENER_DL_BANK_NOF_SNR; s++) {
+        double N = pow(10.0, -WIENER_DL_BANK_SNR_STEP_DB * s / 10.0);
+        wiener_dl_compute_wm(acV, N, shift, (*wiener_dl_bank[shift])[s][d]);
+      }
+    }
+  }
+}
+
+__attribute__((destructor)) static void wiener_dl_bank_free()
+{
+  for (uint32_t shift = 0; shift < WIENER_DL_BANK_NOF_SHIFTS; shift++) {
+    if (wiener_dl_bank[shift]) {
+      free(wiener_dl_bank[shift]);
+      wiener_dl_bank[shift] = NULL;
+    }
+  }
+}
+
 int srslte_wiener_dl_init(srslte_wiener_dl_t* q, uint32_t max_prb, uint32_t max_tx_ports, uint32_t max_rx_ant)
 {
   int ret = SRSLTE_SUCCESS;
@@ -314,6 +439,15 @@ int srslte_wiener_dl_init(srslte_wiener_dl_t* q, uint32_t max_prb, uint32_t max_
       srslte_dft_run_c(&q->fft, q->filter, q->filter);
     }
 
+    // Make sure the filter bank is available
+    if (!ret) {
+      pthread_once(&wiener_dl_bank_once, wiener_dl_bank_generate);
+      if (!wiener_dl_bank[WIENER_DL_BANK_NOF_SHIFTS - 1]) {
+        ERROR("Error generating Wiener filter bank\n");
+        ret = SRSLTE_ERROR;
+      }
+    }
+
     // Initialise matrix inverter
     if (!ret) {
       q->matrix_inverter = calloc(sizeof(srslte_matrix_NxN_inv_t), 1);
@@ -371,6 +505,23 @@ void srslte_wiener_dl_reset(srslte_wiener_dl_t* q)
   }
 }
 
+int srslte_wiener_dl_set_mode(srslte_wiener_dl_t* q, srslte_wiener_dl_mode_t mode)
+{
+  int ret = SRSLTE_ERROR_INVALID_INPUTS;
+
+  if (q) {
+    if (q->mode != mode) {
+      q->mode        = mode;
+      q->ready       = false;
+      q->wm_computed = false;
+      srslte_wiener_dl_reset(q);
+    }
+    ret = SRSLTE_SUCCESS;
+  }
+
+  return ret;
+}
+
 static void circshift_dim1(cf_t** matrix, uint32_t ndim1, int32_t k)
 {
   // Check valid inputs
@@ -542,6 +693,61 @@ inline static cf_t _cmul(cf_t a, cf_t b)
   return ret;
 }
 
+// Estimates the RMS delay spread from the correlation between adjacent reference signals, 6 subcarriers apart. The
+// correlation and the power are averaged before the conversion, as a single symbol gives a very noisy correlation. The
+// correlation magnitude of an exponential power delay profile is 1 / sqrt(1 + (2*pi*f*tau)^2).
+static void
+wiener_dl_estimate_delay_spread(srslte_wiener_dl_t* q, srslte_wiener_dl_state_t* state, cf_t* pilots, float snr_lin)
+{
+  cf_t  corr  = srslte_vec_dot_prod_conj_ccc(&pilots[1], pilots, q->nof_ref - 1);
+  float power = __real__ srslte_vec_dot_prod_conj_ccc(pilots, pilots, q->nof_ref - 1);
+
+  // Remove the noise contribution from the pilot power
+  if (isnormal(snr_lin)) {
+    power /= 1.0f + 1.0f / snr_lin;
+  }
+
+  if (!isnormal(power) || !isfinite(__real__ corr) || !isfinite(__imag__ corr)) {
+    return;
+  }
+
+  if (state->freq_power > 0.0f) {
+    state->freq_corr  = SRSLTE_VEC_EMA(corr, state->freq_corr, WIENER_DL_DELAY_SPREAD_EMA_COEFF);
+    state->freq_power = SRSLTE_VEC_EMA(power, state->freq_power, WIENER_DL_DELAY_SPREAD_EMA_COEFF);
+  } else {
+    state->freq_corr  = corr;
+    state->freq_power = power;
+  }
+
+  float rho = SRSLTE_MIN(cabsf(state->freq_corr) / state->freq_power, 1.0f);
+  if (isnormal(rho)) {
+    state->delay_spread = sqrtf(1.0f / (rho * rho) - 1.0f) / (2.0f * (float)M_PI * 6.0f * WIENER_DL_SC_SPACING_HZ);
+  }
+}
+
+// Selects the Wiener matrices of the filter bank closest to the current SNR, after reference signal averaging, and
+// delay spread
+static void wiener_dl_bank_select(srslte_wiener_dl_state_t* state, uint32_t shift, float snr_lin)
+{
+  uint32_t snr_idx   = SRSLTE_WIENER_DL_BANK_NOF_SNR - 1;
+  uint32_t delay_idx = 0;
+
+  float snr_eff = snr_lin * SRSLTE_MAX(1, state->sumlen);
+  if (isfinite(snr_eff)) {
+    float idx = (snr_eff > 0.0f) ? roundf(srslte_convert_power_to_dB(snr_eff) / WIENER_DL_BANK_SNR_STEP_DB) : 0.0f;
+    snr_idx   = (uint32_t)SRSLTE_MIN(SRSLTE_MAX(idx, 0.0f), SRSLTE_WIENER_DL_BANK_NOF_SNR - 1);
+  }
+
+  if (isnormal(state->delay_spread)) {
+    float idx = roundf(log2f(state->delay_spread / WIENER_DL_BANK_MIN_DELAY));
+    delay_idx = (uint32_t)SRSLTE_MIN(SRSLTE_MAX(idx, 0.0f), SRSLTE_WIENER_DL_BANK_NOF_DELAY - 1);
+  }
+
+  state->wm2 = (const srslte_wiener_dl_wm_t*)&(*wiener_dl_bank[shift % WIENER_DL_BANK_NOF_SHIFTS])[snr_idx][delay_idx];
+  state->wm1 =
+      (const srslte_wiener_dl_wm_t*)&(*wiener_dl_bank[(shift + 3) % WIENER_DL_BANK_NOF_SHIFTS])[snr_idx][delay_idx];
+}
+
 static void
 srslte_wiener_dl_run_symbol_1_8(srslte_wiener_dl_t* q, srslte_wiener_dl_state_t* state, cf_t* pilots, float snr_lin)
 {
@@ -581,7 +787,7 @@ static void srslte_wiener_dl_run_symbol_2_9(srslte_wiener_dl_t* q, srslte_wiener
   srslte_vec_sc_prod_cfc(q->tmp, 1.0f / state->sumlen, q->tmp, q->nof_ref); // Scale sum
 
   // Estimate channel based on the wiener matrix 2
-  estimate_wiener(q, q->wm2, q->tmp, state->tfifo[0]);
+  estimate_wiener(q, *state->wm2, q->tmp, state->tfifo[0]);
 
   // Update internal states
   state->deltan       = 0.0f;
@@ -607,11 +813,21 @@ static void srslte_wiener_dl_run_symbol_5_12(srslte_wiener_dl_t*       q,
   srslte_vec_sc_prod_cfc(q->tmp, 1.0f / state->sumlen, q->tmp, q->nof_ref); // Scale sum
 
   // Estimate channel based on the wiener matrix 1
-  estimate_wiener(q, q->wm1, q->tmp, state->tfifo[0]);
+  estimate_wiener(q, *state->wm1, q->tmp, state->tfifo[0]);
 
   // Update internal states
   state->deltan       = 0.0f;
   state->invtpilotoff = M_1_4;
+
+  // The filter bank only needs the channel delay spread, skip the online training
+  if (q->mode == SRSLTE_WIENER_DL_MODE_FILTER_BANK) {
+    wiener_dl_estimate_delay_spread(q, state, pilots, snr_lin);
+    if (tx == q->nof_tx_ports - 1 && rx == q->nof_rx_ant - 1) {
+      q->wm_computed = true;
+    }
+    return;
+  }
+
   state->cnt++;
 
   // Online training of Wiener matrices (random sub-bands)
@@ -774,6 +990,9 @@ int srslte_wiener_dl_run(srslte_wiener_dl_t* q,
         q->ready = q->wm_computed;
       case 8:
         srslte_wiener_dl_run_symbol_1_8(q, state, pilots, snr_lin);
+        if (q->mode == SRSLTE_WIENER_DL_MODE_FILTER_BANK) {
+          wiener_dl_bank_select(state, shift, snr_lin);
+        }
         break;
       case 2:
       case 9:
@@ -25,7 +25,7 @@
 
 using namespace srslte;
 
-channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels)
+channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels, uint32_t _seed)
 {
   int      ret         = SRSLTE_SUCCESS;
   uint32_t srate_max   = (uint32_t)srslte_symbol_sz(SRSLTE_MAX_PRB) * 15000;
@@ -41,21 +41,23 @@ channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels)
 
   // Copy args
   args = channel_args;
-
-  // Allocate internal buffers
-  buffer_in  = srslte_vec_cf_malloc(buffer_size);
-  buffer_out = srslte_vec_cf_malloc(buffer_size);
-  if (!buffer_out || !buffer_in) {
-    ret = SRSLTE_ERROR;
-  }
+  seed = _seed;
 
   nof_channels = _nof_channels;
   for (uint32_t i = 0; i < nof_channels; i++) {
+    // Allocate internal buffers
+    buffer_in[i]  = srslte_vec_cf_malloc(buffer_size);
+    buffer_out[i] = srslte_vec_cf_malloc(buffer_size);
+    if (!buffer_out[i] || !buffer_in[i]) {
+      ret = SRSLTE_ERROR;
+    }
+
     // Create fading channel
     if (channel_args.fading_enable && !channel_args.fading_model.empty() && channel_args.fading_model != "none" &&
         ret == SRSLTE_SUCCESS) {
       fading[i] = (srslte_channel_fading_t*)calloc(sizeof(srslte_channel_fading_t), 1);
-      ret       = srslte_channel_fading_init(fading[i], srate_max, channel_args.fading_model.c_str(), 0x1234 * i);
+      ret       = srslte_channel_fading_init(
+          fading[i], srate_max, channel_args.fading_model.c_str(), seed + 0x1234 * i);
     } else {
       fading[i] = nullptr;
     }
@@ -72,13 +74,13 @@ channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels)
     } else {
       delay[i] = nullptr;
     }
-  }
 
-  // Create AWGN channnel
-  if (channel_args.awgn_enable && ret == SRSLTE_SUCCESS) {
-    awgn = (srslte_channel_awgn_t*)calloc(sizeof(srslte_channel_awgn_t), 1);
-    ret  = srslte_channel_awgn_init(awgn, 1234);
-    srslte_channel_awgn_set_n0(awgn, args.awgn_signal_power_dBfs - args.awgn_snr_dB);
+    // Create AWGN channnel, each channel has its own generator so they can run in parallel
+    if (channel_args.awgn_enable && ret == SRSLTE_SUCCESS) {
+      awgn[i] = (srslte_channel_awgn_t*)calloc(sizeof(srslte_channel_awgn_t), 1);
+      ret     = srslte_channel_awgn_init(awgn[i], seed + 1234 + 0x1234 * i);
+      srslte_channel_awgn_set_n0(awgn[i], args.awgn_signal_power_dBfs - args.awgn_snr_dB);
+    }
   }
 
   // Create high speed train
@@ -95,22 +97,26 @@ channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels)
 
   if (ret != SRSLTE_SUCCESS) {
     fprintf(stderr, "Error: Creating channel\n\n");
+    return;
+  }
+
+  // Start the workers of the other channels if they have expensive stages
+  if (nof_channels > 1 && (fading[0] != nullptr || awgn[0] != nullptr)) {
+    for (uint32_t i = 1; i < nof_channels; i++) {
+      workers.emplace_back(&channel::worker_loop, this, i);
+    }
   }
 }
 
 channel::~channel()
 {
-  if (buffer_in) {
-    free(buffer_in);
-  }
-
-  if (buffer_out) {
-    free(buffer_out);
+  {
+    std::lock_guard<std::mutex> lock(workers_mutex);
+    workers_quit = true;
   }
-
-  if (awgn) {
-    srslte_channel_awgn_free(awgn);
-    free(awgn);
+  workers_cvar.notify_all();
+  for (std::thread& w : workers) {
+    w.join();
   }
 
   if (hst) {
@@ -124,6 +130,19 @@ channel::~channel()
   }
 
   for (uint32_t i = 0; i < nof_channels; i++) {
+    if (buffer_in[i]) {
+      free(buffer_in[i]);
+    }
+
+    if (buffer_out[i]) {
+      free(buffer_out[i]);
+    }
+
+    if (awgn[i]) {
+      srslte_channel_awgn_free(awgn[i]);
+      free(awgn[i]);
+    }
+
     if (fading[i]) {
       srslte_channel_fading_free(fading[i]);
       free(fading[i]);
@@ -151,61 +170,110 @@ void channel::set_logger(log_filter* _log_h)
   log_h = _log_h;
 }
 
-void channel::run(cf_t*                     in[SRSLTE_MAX_CHANNELS],
-                  cf_t*                     out[SRSLTE_MAX_CHANNELS],
-                  uint32_t                  len,
-                  const srslte_timestamp_t& t)
+void channel::run_channel(uint32_t i)
 {
-  // Early return if pointers are not enabled
+  cf_t*                     in  = job_in[i];
+  cf_t*                     out = job_out[i];
+  uint32_t                  len = job_len;
+  const srslte_timestamp_t& t   = *job_t;
+
+  // Skip channel if any buffer is null
   if (in == nullptr || out == nullptr) {
     return;
   }
 
-  // For each channel
-  for (uint32_t i = 0; i < nof_channels; i++) {
-    // Skip iteration if any buffer is null
-    if (in[i] == nullptr || out[i] == nullptr) {
-      continue;
+  // If sampling rate is not set, copy input and skip rest of channel
+  if (current_srate == 0) {
+    if (in != out) {
+      srslte_vec_cf_copy(out, in, len);
     }
+    return;
+  }
 
-    // If sampling rate is not set, copy input and skip rest of channel
-    if (current_srate == 0) {
-      if (in[i] != out[i]) {
-        srslte_vec_cf_copy(out[i], in[i], len);
-      }
-      continue;
-    }
+  // Copy input buffer
+  srslte_vec_cf_copy(buffer_in[i], in, len);
 
-    // Copy input buffer
-    srslte_vec_cf_copy(buffer_in, in[i], len);
+  if (hst) {
+    srslte_channel_hst_execute(hst, buffer_in[i], buffer_out[i], len, &t);
+    srslte_vec_sc_prod_ccc(buffer_out[i], local_cexpf(hst_init_phase), buffer_in[i], len);
+  }
 
-    if (hst) {
-      srslte_channel_hst_execute(hst, buffer_in, buffer_out, len, &t);
-      srslte_vec_sc_prod_ccc(buffer_out, local_cexpf(hst_init_phase), buffer_in, len);
-    }
+  if (awgn[i]) {
+    srslte_channel_awgn_run_c(awgn[i], buffer_in[i], buffer_out[i], len);
+    srslte_vec_cf_copy(buffer_in[i], buffer_out[i], len);
+  }
 
-    if (awgn) {
-      srslte_channel_awgn_run_c(awgn, buffer_in, buffer_out, len);
-      srslte_vec_cf_copy(buffer_in, buffer_out, len);
-    }
+  if (fading[i]) {
+    srslte_channel_fading_execute(fading[i], buffer_in[i], buffer_out[i], len, t.full_secs + t.frac_secs);
+    srslte_vec_cf_copy(buffer_in[i], buffer_out[i], len);
+  }
 
-    if (fading[i]) {
-      srslte_channel_fading_execute(fading[i], buffer_in, buffer_out, len, t.full_secs + t.frac_secs);
-      srslte_vec_cf_copy(buffer_in, buffer_out, len);
+  if (delay[i]) {
+    srslte_channel_delay_execute(delay[i], buffer_in[i], buffer_out[i], len, &t);
+    srslte_vec_cf_copy(buffer_in[i], buffer_out[i], len);
+  }
+
+  if (rlf) {
+    srslte_channel_rlf_execute(rlf, buffer_in[i], buffer_out[i], len, &t);
+    srslte_vec_cf_copy(buffer_in[i], buffer_out[i], len);
+  }
+
+  // Copy output buffer
+  srslte_vec_cf_copy(out, buffer_in[i], len);
+}
+
+void channel::worker_loop(uint32_t i)
+{
+  uint64_t last_job_id = 0;
+
+  std::unique_lock<std::mutex> lock(workers_mutex);
+  while (true) {
+    workers_cvar.wait(lock, [this, last_job_id]() { return workers_quit || job_id != last_job_id; });
+    if (workers_quit) {
+      return;
     }
+    last_job_id = job_id;
 
-    if (delay[i]) {
-      srslte_channel_delay_execute(delay[i], buffer_in, buffer_out, len, &t);
-      srslte_vec_cf_copy(buffer_in, buffer_out, len);
+    lock.unlock();
+    run_channel(i);
+    lock.lock();
+
+    if (--nof_pending == 0) {
+      workers_cvar.notify_all();
     }
+  }
+}
+
+void channel::run(cf_t*                     in[SRSLTE_MAX_CHANNELS],
+                  cf_t*                     out[SRSLTE_MAX_CHANNELS],
+                  uint32_t                  len,
+                  const srslte_timestamp_t& t)
+{
+  // Early return if pointers are not enabled
+  if (in == nullptr || out == nullptr) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(workers_mutex);
+    job_in      = in;
+    job_out     = out;
+    job_len     = len;
+    job_t       = &t;
+    nof_pending = workers.size();
+    job_id++;
+  }
 
-    if (rlf) {
-      srslte_channel_rlf_execute(rlf, buffer_in, buffer_out, len, &t);
-      srslte_vec_cf_copy(buffer_in, buffer_out, len);
+  if (workers.empty()) {
+    for (uint32_t i = 0; i < nof_channels; i++) {
+      run_channel(i);
     }
+  } else {
+    workers_cvar.notify_all();
+    run_channel(0);
 
-    // Copy output buffer
-    srslte_vec_cf_copy(out[i], buffer_in, len);
+    std::unique_lock<std::mutex> lock(workers_mutex);
+    workers_cvar.wait(lock, [this]() { return nof_pending == 0; });
   }
 
   if (hst) {
@@ -248,7 +316,7 @@ void channel::set_srate(uint32_t srate)
       if (fading[i]) {
         srslte_channel_fading_free(fading[i]);
 
-        srslte_channel_fading_init(fading[i], srate, args.fading_model.c_str(), 0x1234 * i);
+        srslte_channel_fading_init(fading[i], srate, args.fading_model.c_str(), seed + 0x1234 * i);
       }
 
       if (delay[i]) {
@@ -267,7 +335,9 @@ void channel::set_srate(uint32_t srate)
 
 void channel::set_signal_power_dBfs(float power_dBfs)
 {
-  if (awgn != nullptr) {
-    srslte_channel_awgn_set_n0(awgn, power_dBfs - args.awgn_snr_dB);
+  for (uint32_t i = 0; i < nof_channels; i++) {
+    if (awgn[i] != nullptr) {
+      srslte_channel_awgn_set_n0(awgn[i], power_dBfs - args.awgn_snr_dB);
+    }
   }
 }
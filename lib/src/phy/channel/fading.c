@@ -21,6 +21,7 @@
 
 #include "srslte/phy/channel/fading.h"
 #include "srslte/phy/utils/random.h"
+#include "srslte/phy/utils/simd.h"
 #include "srslte/phy/utils/vector.h"
 #include <math.h>
 #include <stdio.h>
@@ -90,6 +91,8 @@ static inline __m128 _sine(const float* table, __m128 arg)
   __m128  argmod   = _mm_sub_ps(arg, _mm_mul_ps(turns, _mm_set1_ps(2.0f * (float)M_PI)));
   __m128  indexps  = _mm_mul_ps(argmod, _mm_set1_ps(1024.0f / (2.0f * (float)M_PI)));
   __m128i indexi32 = _mm_abs_epi32(_mm_cvtps_epi32(indexps));
+  // a phase rounded up to 2*pi wraps to the first entry of the table
+  indexi32 = _mm_and_si128(indexi32, _mm_set1_epi32(1023));
   _mm_store_si128((__m128i*)idx, indexi32);
 
   for (int i = 0; i < 4; i++) {
@@ -153,33 +156,57 @@ get_doppler_dispersion(srslte_channel_fading_t* q, float t, float F_d, float* al
 #endif /*LV_HAVE_SSE*/
 }
 
-static inline void generate_tap(float delay_ns, float power_db, float srate, cf_t* buf, uint32_t N, uint32_t path_delay)
+static inline void
+generate_tap(float delay_ns, float power_db, float srate, cf_t* buf, cf_t* temp, uint32_t N, uint32_t path_delay)
 {
   float amplitude = srslte_convert_dB_to_power(power_db);
   float O         = (delay_ns * 1e-9f * srate + path_delay) / (float)N;
   cf_t  a0        = amplitude / N;
 
-  srslte_vec_gen_sine(a0, -O, buf, N);
+  srslte_vec_gen_sine(a0, -O, temp, N);
+
+  // Store it FFT shifted
+  srslte_vec_cf_copy(buf, &temp[N / 2], N / 2);
+  srslte_vec_cf_copy(&buf[N / 2], temp, N / 2);
+}
+
+// z = z + h * x
+static inline void scale_accumulate(const cf_t* x, cf_t h, cf_t* z, uint32_t len)
+{
+  uint32_t i = 0;
+
+#if SRSLTE_SIMD_F_SIZE && !defined(HAVE_NEON)
+  // The tap and frequency response buffers are aligned and N is a power of two
+  const simd_f_t hre = srslte_simd_f_set1(__real__ h);
+  const simd_f_t him = srslte_simd_f_set1(__imag__ h);
+
+  for (; i + SRSLTE_SIMD_F_SIZE / 2 <= len; i += SRSLTE_SIMD_F_SIZE / 2) {
+    simd_f_t a  = srslte_simd_f_load((float*)&x[i]);
+    simd_f_t m1 = srslte_simd_f_mul(hre, a);
+    simd_f_t m2 = srslte_simd_f_mul(him, srslte_simd_f_swap(a));
+    simd_f_t r  = srslte_simd_f_add(srslte_simd_f_load((float*)&z[i]), srslte_simd_f_addsub(m1, m2));
+    srslte_simd_f_store((float*)&z[i], r);
+  }
+#endif /* SRSLTE_SIMD_F_SIZE */
+
+  for (; i < len; i++) {
+    z[i] += x[i] * h;
+  }
 }
 
 static inline void generate_taps(srslte_channel_fading_t* q, float time)
 {
-  // Generate taps
+  // Generate taps. The tap frequency responses are already FFT shifted, so each tap takes a single pass over h_freq
   for (int i = 0; i < nof_taps[q->model]; i++) {
     // Compute phase for the doppler dispersion
     cf_t a = get_doppler_dispersion(q, time, q->doppler, q->coeff_alpha[i], q->coeff_a[i], q->coeff_b[i]);
 
     if (i) {
-      // Copy tap frequency response
-      srslte_vec_sc_prod_ccc(q->h_tap[i], a, q->temp, q->N);
-
-      // Add to frequency response, shifts FFT at same time
-      srslte_vec_sum_ccc(q->h_freq, &q->temp[q->N / 2], q->h_freq, q->N / 2);
-      srslte_vec_sum_ccc(&q->h_freq[q->N / 2], q->temp, &q->h_freq[q->N / 2], q->N / 2);
+      // Add to frequency response
+      scale_accumulate(q->h_tap[i], a, q->h_freq, q->N);
     } else {
       // Copy tap frequency response
-      srslte_vec_sc_prod_ccc(&q->h_tap[i][q->N / 2], a, q->h_freq, q->N / 2);
-      srslte_vec_sc_prod_ccc(&q->h_tap[i][0], a, &q->h_freq[q->N / 2], q->N / 2);
+      srslte_vec_sc_prod_ccc(q->h_tap[i], a, q->h_freq, q->N);
     }
   }
   // at this stage, q->h_freq should contain the frequency response
@@ -232,6 +259,12 @@ int srslte_channel_fading_init(srslte_channel_fading_t* q, double srate, const c
     q->path_delay = q->N / 4;
     q->state_len  = 0;
 
+    q->temp = srslte_vec_cf_malloc(q->N);
+    if (!q->temp) {
+      fprintf(stderr, "Error: allocating temp\n");
+      goto clean_exit;
+    }
+
     // Initialise random number
     srslte_random_t* random = srslte_random_init(seed);
 
@@ -248,8 +281,13 @@ int srslte_channel_fading_init(srslte_channel_fading_t* q, double srate, const c
       q->h_tap[i] = srslte_vec_cf_malloc(q->N);
 
       // Generate tap frequency response
-      generate_tap(
-          excess_tap_delay_ns[q->model][i], relative_power_db[q->model][i], q->srate, q->h_tap[i], q->N, q->path_delay);
+      generate_tap(excess_tap_delay_ns[q->model][i],
+                   relative_power_db[q->model][i],
+                   q->srate,
+                   q->h_tap[i],
+                   q->temp,
+                   q->N,
+                   q->path_delay);
     }
 
     // Generate sine Table
@@ -273,12 +311,6 @@ int srslte_channel_fading_init(srslte_channel_fading_t* q, double srate, const c
     }
 
     // Allocate memory
-    q->temp = srslte_vec_cf_malloc(q->N);
-    if (!q->temp) {
-      fprintf(stderr, "Error: allocating h_freq\n");
-      goto clean_exit;
-    }
-
     q->h_freq = srslte_vec_cf_malloc(q->N);
     if (!q->h_freq) {
       fprintf(stderr, "Error: allocating h_freq\n");
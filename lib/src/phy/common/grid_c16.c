@@ -0,0 +1,81 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/phy/common/grid_c16.h"
+#include "srslte/phy/utils/debug.h"
+#include "srslte/phy/utils/vector.h"
+#include <string.h>
+
+int srslte_grid_c16_init(srslte_grid_c16_t* q, uint32_t max_prb)
+{
+  if (q == NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  bzero(q, sizeof(srslte_grid_c16_t));
+
+  q->max_re_symbol = SRSLTE_NRE * max_prb;
+  q->iq            = srslte_vec_i16_malloc(2 * q->max_re_symbol * SRSLTE_NOF_SLOTS_PER_SF * SRSLTE_MAX_NSYMB);
+  if (q->iq == NULL) {
+    ERROR("Error allocating int16 grid\n");
+    return SRSLTE_ERROR;
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+void srslte_grid_c16_free(srslte_grid_c16_t* q)
+{
+  if (q) {
+    if (q->iq) {
+      free(q->iq);
+    }
+    bzero(q, sizeof(srslte_grid_c16_t));
+  }
+}
+
+int srslte_grid_c16_store(srslte_grid_c16_t* q, const cf_t* grid, uint32_t nof_prb, uint32_t nof_symbols)
+{
+  uint32_t nof_re_symbol = SRSLTE_NRE * nof_prb;
+  if (q == NULL || grid == NULL || nof_re_symbol > q->max_re_symbol ||
+      nof_symbols > SRSLTE_NOF_SLOTS_PER_SF * SRSLTE_MAX_NSYMB) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  q->nof_re_symbol = nof_re_symbol;
+  q->nof_symbols   = nof_symbols;
+  for (uint32_t l = 0; l < nof_symbols; l++) {
+    q->scale[l] = srslte_vec_convert_cf_cs(&grid[l * nof_re_symbol], &q->iq[2 * l * nof_re_symbol], nof_re_symbol);
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+void srslte_grid_c16_load_symbol(const srslte_grid_c16_t* q, uint32_t l, cf_t* symbol)
+{
+  srslte_vec_convert_cs_cf(&q->iq[2 * l * q->nof_re_symbol], q->scale[l], symbol, q->nof_re_symbol);
+}
+
+void srslte_grid_c16_scale_symbol(srslte_grid_c16_t* q, uint32_t l, float gain)
+{
+  // The samples are restored dividing by the scale
+  q->scale[l] /= gain;
+}
@@ -22,6 +22,7 @@
 #include "srslte/phy/common/sequence.h"
 #include "srslte/phy/utils/bit.h"
 #include "srslte/phy/utils/debug.h"
+#include "srslte/phy/utils/mem_accounting.h"
 #include "srslte/phy/utils/vector.h"
 
 #ifdef LV_HAVE_SSE
@@ -146,12 +147,25 @@ static inline uint32_t sequence_gen_LTE_pr_memless_step_x2(uint32_t state)
 static uint32_t sequence_x1_init                    = 0;
 static uint32_t sequence_x2_init[SEQUENCE_SEED_LEN] = {};
 
+/**
+ * Expansion of a byte of the sequence, LSB first, to one bit per byte and to a packed byte (MSB first)
+ */
+static uint64_t sequence_unpack_lut[256] = {};
+static uint8_t  sequence_pack_lut[256]   = {};
+
 /**
  * C constructor, pre-computes X1 and X2 initial states
  */
 __attribute__((constructor)) __attribute__((unused)) static void srslte_lte_pr_pregen()
 {
 
+  for (uint32_t b = 0; b < 256; b++) {
+    for (uint32_t i = 0; i < 8; i++) {
+      sequence_unpack_lut[b] |= (uint64_t)((b >> i) & 1U) << (8U * i);
+      sequence_pack_lut[b] |= (uint8_t)(((b >> i) & 1U) << (7U - i));
+    }
+  }
+
   // Compute transition step
   sequence_x1_init = 1;
   for (uint32_t n = 0; n < SEQUENCE_NC; n++) {
@@ -215,6 +229,40 @@ static void sequence_gen_LTE_pr(uint8_t* pr, uint32_t len, uint32_t seed)
   }
 }
 
+/**
+ * Same as sequence_gen_LTE_pr() that also packs the sequence. Two parallel steps give 56 bits, which are expanded and
+ * packed a byte at a time, so the bits are never handled one by one but in the tail
+ */
+static void sequence_gen_LTE_pr_packed(uint8_t* pr, uint8_t* pr_bytes, uint32_t len, uint32_t seed)
+{
+  uint32_t n  = 0;
+  uint32_t x1 = sequence_x1_init;
+  uint32_t x2 = sequence_get_x2_init(seed);
+
+  for (; n + 2 * SEQUENCE_PAR_BITS <= len; n += 2 * SEQUENCE_PAR_BITS) {
+    uint64_t c = (x1 ^ x2) & SEQUENCE_MASK;
+    x1         = sequence_gen_LTE_pr_memless_step_par_x1(x1);
+    x2         = sequence_gen_LTE_pr_memless_step_par_x2(x2);
+    c |= (uint64_t)((x1 ^ x2) & SEQUENCE_MASK) << SEQUENCE_PAR_BITS;
+    x1 = sequence_gen_LTE_pr_memless_step_par_x1(x1);
+    x2 = sequence_gen_LTE_pr_memless_step_par_x2(x2);
+
+    for (uint32_t i = 0; i < 2 * SEQUENCE_PAR_BITS / 8; i++) {
+      uint8_t b = (uint8_t)(c >> (8U * i));
+      memcpy(&pr[n + 8 * i], &sequence_unpack_lut[b], sizeof(uint64_t));
+      pr_bytes[n / 8 + i] = sequence_pack_lut[b];
+    }
+  }
+
+  // The 56 bits of a step are a whole number of bytes, so the tail starts at a byte boundary
+  for (uint32_t i = n; i < len; i++) {
+    pr[i] = (uint8_t)((x1 ^ x2) & 1U);
+    x1    = sequence_gen_LTE_pr_memless_step_x1(x1);
+    x2    = sequence_gen_LTE_pr_memless_step_x2(x2);
+  }
+  srslte_bit_pack_vector(&pr[n], &pr_bytes[n / 8], len - n);
+}
+
 void srslte_sequence_state_init(srslte_sequence_state_t* s, uint32_t seed)
 {
   s->x1 = sequence_x1_init;
@@ -358,11 +406,8 @@ int srslte_sequence_LTE_pr(srslte_sequence_t* q, uint32_t len, uint32_t seed)
   }
   q->cur_len = len;
 
-  // Generate sequence
-  srslte_sequence_set_LTE_pr(q, len, seed);
-
-  // Pack PR sequence
-  srslte_bit_pack_vector(q->c, q->c_bytes, len);
+  // Generate and pack sequence
+  sequence_gen_LTE_pr_packed(q->c, q->c_bytes, len, seed);
 
   // Generate signed type values
   sequence_generate_signed(q->c, q->c_char, q->c_short, q->c_float, len);
@@ -376,23 +421,23 @@ int srslte_sequence_init(srslte_sequence_t* q, uint32_t len)
     srslte_sequence_free(q);
   }
   if (!q->c) {
-    q->c = srslte_vec_u8_malloc(len);
+    q->c = srslte_mem_malloc(SRSLTE_MEM_TAG_SEQUENCE, sizeof(uint8_t) * len);
     if (!q->c) {
       return SRSLTE_ERROR;
     }
-    q->c_bytes = srslte_vec_u8_malloc(len / 8 + 8);
+    q->c_bytes = srslte_mem_malloc(SRSLTE_MEM_TAG_SEQUENCE, sizeof(uint8_t) * (len / 8 + 8));
     if (!q->c_bytes) {
       return SRSLTE_ERROR;
     }
-    q->c_float = srslte_vec_f_malloc(len);
+    q->c_float = srslte_mem_malloc(SRSLTE_MEM_TAG_SEQUENCE, sizeof(float) * len);
     if (!q->c_float) {
       return SRSLTE_ERROR;
     }
-    q->c_short = srslte_vec_i16_malloc(len);
+    q->c_short = srslte_mem_malloc(SRSLTE_MEM_TAG_SEQUENCE, sizeof(int16_t) * len);
     if (!q->c_short) {
       return SRSLTE_ERROR;
     }
-    q->c_char = srslte_vec_i8_malloc(len);
+    q->c_char = srslte_mem_malloc(SRSLTE_MEM_TAG_SEQUENCE, sizeof(int8_t) * len);
     if (!q->c_char) {
       return SRSLTE_ERROR;
     }
@@ -404,19 +449,19 @@ int srslte_sequence_init(srslte_sequence_t* q, uint32_t len)
 void srslte_sequence_free(srslte_sequence_t* q)
 {
   if (q->c) {
-    free(q->c);
+    srslte_mem_free(q->c);
   }
   if (q->c_bytes) {
-    free(q->c_bytes);
+    srslte_mem_free(q->c_bytes);
   }
   if (q->c_float) {
-    free(q->c_float);
+    srslte_mem_free(q->c_float);
   }
   if (q->c_short) {
-    free(q->c_short);
+    srslte_mem_free(q->c_short);
   }
   if (q->c_char) {
-    free(q->c_char);
+    srslte_mem_free(q->c_char);
   }
   bzero(q, sizeof(srslte_sequence_t));
 }
@@ -0,0 +1,494 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/srslte.h"
+#include <complex.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "dft_dev.h"
+#include "srslte/phy/dft/dft.h"
+#include "srslte/phy/utils/vector.h"
+
+#define dft_ceil(a, b) ((a - 1) / b + 1)
+#define dft_floor(a, b) (a / b)
+
+/* Define implementation for Intel MKL DFTI */
+#ifdef ENABLE_MKL
+
+#include "dft_mkl_imp.h"
+
+static dft_dev_t dev_mkl = {"mkl",
+                            dft_mkl_plan_c,
+                            dft_mkl_plan_r,
+                            dft_mkl_plan_guru_c,
+                            dft_mkl_replan_c,
+                            dft_mkl_replan_r,
+                            dft_mkl_execute_c,
+                            dft_mkl_execute_guru_c,
+                            dft_mkl_execute_r,
+                            dft_mkl_plan_free,
+                            NULL,
+                            NULL,
+                            NULL};
+#endif
+
+/* Define implementation for FFTW, also used with the FFTW interface of ARM Performance Libraries */
+#ifdef ENABLE_FFTW
+
+#include "dft_fftw_imp.h"
+
+#ifdef ENABLE_ARMPL
+#define DFT_FFTW_DEVNAME "armpl"
+#else
+#define DFT_FFTW_DEVNAME "fftw"
+#endif
+
+static dft_dev_t dev_fftw = {DFT_FFTW_DEVNAME,
+                             dft_fftw_plan_c,
+                             dft_fftw_plan_r,
+                             dft_fftw_plan_guru_c,
+                             dft_fftw_replan_c,
+                             dft_fftw_replan_r,
+                             dft_fftw_execute_c,
+                             dft_fftw_execute_guru_c,
+                             dft_fftw_execute_r,
+                             dft_fftw_plan_free,
+                             dft_fftw_set_plan_time_limit,
+                             dft_fftw_import_wisdom,
+                             dft_fftw_export_wisdom};
+#endif
+
+/* Backends in order of preference, the first one is used unless another is selected */
+static dft_dev_t* available_backends[] = {
+#ifdef ENABLE_MKL
+    &dev_mkl,
+#endif
+#ifdef ENABLE_FFTW
+    &dev_fftw,
+#endif
+    NULL};
+
+// Environment variable selecting the DFT backend by name when several are available
+#define DFT_BACKEND_ENV "SRSLTE_DFT_BACKEND"
+
+static pthread_mutex_t dft_dev_mutex = PTHREAD_MUTEX_INITIALIZER;
+static dft_dev_t*      dft_dev       = NULL;
+
+static dft_dev_t* dft_find_dev(const char* name)
+{
+  for (uint32_t i = 0; available_backends[i] != NULL; i++) {
+    if (!strcasecmp(available_backends[i]->name, name)) {
+      return available_backends[i];
+    }
+  }
+  return NULL;
+}
+
+// Returns the backend new plans are created with, selects it on first use
+static dft_dev_t* dft_get_dev()
+{
+  pthread_mutex_lock(&dft_dev_mutex);
+  if (dft_dev == NULL) {
+    const char* name = getenv(DFT_BACKEND_ENV);
+    if (name != NULL) {
+      dft_dev = dft_find_dev(name);
+      if (dft_dev == NULL) {
+        ERROR("DFT backend %s is not available\n", name);
+      }
+    }
+    if (dft_dev == NULL) {
+      dft_dev = available_backends[0];
+    }
+  }
+  pthread_mutex_unlock(&dft_dev_mutex);
+
+  if (dft_dev == NULL) {
+    ERROR("No DFT backend available\n");
+  }
+
+  return dft_dev;
+}
+
+int srslte_dft_set_backend(const char* name)
+{
+  dft_dev_t* dev = (name != NULL) ? dft_find_dev(name) : NULL;
+  if (dev == NULL) {
+    ERROR("DFT backend %s is not available\n", name ? name : "(null)");
+    return SRSLTE_ERROR;
+  }
+
+  pthread_mutex_lock(&dft_dev_mutex);
+  dft_dev = dev;
+  pthread_mutex_unlock(&dft_dev_mutex);
+
+  return SRSLTE_SUCCESS;
+}
+
+const char* srslte_dft_get_backend()
+{
+  dft_dev_t* dev = dft_get_dev();
+  return (dev != NULL) ? dev->name : NULL;
+}
+
+uint32_t srslte_dft_get_available_backends(const char** names, uint32_t max_names)
+{
+  uint32_t n = 0;
+  for (; available_backends[n] != NULL; n++) {
+    if (names != NULL && n < max_names) {
+      names[n] = available_backends[n]->name;
+    }
+  }
+  return n;
+}
+
+void srslte_dft_set_plan_time_limit(double seconds)
+{
+  for (uint32_t i = 0; available_backends[i] != NULL; i++) {
+    if (available_backends[i]->dft_set_plan_time_limit) {
+      available_backends[i]->dft_set_plan_time_limit(seconds);
+    }
+  }
+}
+
+int srslte_dft_import_wisdom(const char* filename)
+{
+  dft_dev_t* dev = dft_get_dev();
+  if (dev == NULL || dev->dft_import_wisdom == NULL) {
+    return SRSLTE_ERROR;
+  }
+  return dev->dft_import_wisdom(filename);
+}
+
+int srslte_dft_export_wisdom(const char* filename)
+{
+  dft_dev_t* dev = dft_get_dev();
+  if (dev == NULL || dev->dft_export_wisdom == NULL) {
+    return SRSLTE_ERROR;
+  }
+  return dev->dft_export_wisdom(filename);
+}
+
+static void dft_plan_set_attributes(srslte_dft_plan_t* plan,
+                                    dft_dev_t*         dev,
+                                    int                dft_points,
+                                    srslte_dft_dir_t   dir,
+                                    srslte_dft_mode_t  mode,
+                                    bool               is_guru)
+{
+  plan->dev       = dev;
+  plan->size      = dft_points;
+  plan->init_size = plan->size;
+  plan->mode      = mode;
+  plan->dir       = dir;
+  plan->forward   = (dir == SRSLTE_DFT_FORWARD) ? true : false;
+  plan->mirror    = false;
+  plan->db        = false;
+  plan->norm      = false;
+  plan->dc        = false;
+  plan->is_guru   = is_guru;
+}
+
+int srslte_dft_plan(srslte_dft_plan_t* plan, const int dft_points, srslte_dft_dir_t dir, srslte_dft_mode_t mode)
+{
+  bzero(plan, sizeof(srslte_dft_plan_t));
+  if (mode == SRSLTE_DFT_COMPLEX) {
+    return srslte_dft_plan_c(plan, dft_points, dir);
+  } else {
+    return srslte_dft_plan_r(plan, dft_points, dir);
+  }
+  return 0;
+}
+
+int srslte_dft_replan(srslte_dft_plan_t* plan, const int new_dft_points)
+{
+  if (new_dft_points <= plan->init_size) {
+    if (plan->mode == SRSLTE_DFT_COMPLEX) {
+      return srslte_dft_replan_c(plan, new_dft_points);
+    } else {
+      return srslte_dft_replan_r(plan, new_dft_points);
+    }
+  } else {
+    ERROR("DFT: Error calling replan: new_dft_points (%d) must be lower or equal "
+          "dft_size passed initially (%d)\n",
+          new_dft_points,
+          plan->init_size);
+    return -1;
+  }
+}
+
+static int dft_plan_guru_(srslte_dft_plan_t* plan,
+                          dft_dev_t*         dev,
+                          const int          dft_points,
+                          srslte_dft_dir_t   dir,
+                          cf_t*              in_buffer,
+                          cf_t*              out_buffer,
+                          int                istride,
+                          int                ostride,
+                          uint32_t           nof_loops,
+                          const dft_loop_t*  loops)
+{
+  if (dev == NULL) {
+    return -1;
+  }
+
+  plan->p         = NULL;
+  plan->is_cached = false;
+  if (dev->dft_plan_guru_c(plan, dft_points, dir, in_buffer, out_buffer, istride, ostride, nof_loops, loops)) {
+    return -1;
+  }
+  dft_plan_set_attributes(plan, dev, dft_points, dir, SRSLTE_DFT_COMPLEX, true);
+  plan->in  = in_buffer;
+  plan->out = out_buffer;
+
+  return 0;
+}
+
+int srslte_dft_replan_guru_c(srslte_dft_plan_t* plan,
+                             const int          new_dft_points,
+                             cf_t*              in_buffer,
+                             cf_t*              out_buffer,
+                             int                istride,
+                             int                ostride,
+                             int                how_many,
+                             int                idist,
+                             int                odist)
+{
+  dft_dev_t*       dev   = (dft_dev_t*)plan->dev;
+  srslte_dft_dir_t dir   = plan->dir;
+  dft_loop_t       loops = {how_many, idist, odist};
+
+  /* Destroy current plan */
+  if (dev != NULL) {
+    dev->dft_plan_free(plan);
+  }
+
+  return dft_plan_guru_(plan, dev, new_dft_points, dir, in_buffer, out_buffer, istride, ostride, 1, &loops);
+}
+
+int srslte_dft_replan_c(srslte_dft_plan_t* plan, const int new_dft_points)
+{
+  dft_dev_t* dev = (dft_dev_t*)plan->dev;
+
+  if (dev == NULL || dev->dft_replan_c(plan, new_dft_points)) {
+    return -1;
+  }
+  plan->size = new_dft_points;
+  return 0;
+}
+
+int srslte_dft_plan_guru_c(srslte_dft_plan_t* plan,
+                           const int          dft_points,
+                           srslte_dft_dir_t   dir,
+                           cf_t*              in_buffer,
+                           cf_t*              out_buffer,
+                           int                istride,
+                           int                ostride,
+                           int                how_many,
+                           int                idist,
+                           int                odist)
+{
+  dft_loop_t loops = {how_many, idist, odist};
+
+  return dft_plan_guru_(plan, dft_get_dev(), dft_points, dir, in_buffer, out_buffer, istride, ostride, 1, &loops);
+}
+
+int srslte_dft_plan_guru_batch_c(srslte_dft_plan_t* plan,
+                                 const int          dft_points,
+                                 srslte_dft_dir_t   dir,
+                                 cf_t*              in_buffer,
+                                 cf_t*              out_buffer,
+                                 int                istride,
+                                 int                ostride,
+                                 int                how_many,
+                                 int                idist,
+                                 int                odist,
+                                 int                how_many_outer,
+                                 int                idist_outer,
+                                 int                odist_outer)
+{
+  // Loops are given from the outermost to the innermost
+  const dft_loop_t loops[DFT_MAX_LOOPS] = {{how_many_outer, idist_outer, odist_outer}, {how_many, idist, odist}};
+
+  return dft_plan_guru_(
+      plan, dft_get_dev(), dft_points, dir, in_buffer, out_buffer, istride, ostride, DFT_MAX_LOOPS, loops);
+}
+
+int srslte_dft_plan_c(srslte_dft_plan_t* plan, const int dft_points, srslte_dft_dir_t dir)
+{
+  dft_dev_t* dev = dft_get_dev();
+
+  plan->p         = NULL;
+  plan->is_cached = false;
+  if (dev == NULL || dev->dft_plan_c(plan, dft_points, dir)) {
+    return -1;
+  }
+  dft_plan_set_attributes(plan, dev, dft_points, dir, SRSLTE_DFT_COMPLEX, false);
+
+  return 0;
+}
+
+int srslte_dft_replan_r(srslte_dft_plan_t* plan, const int new_dft_points)
+{
+  dft_dev_t* dev = (dft_dev_t*)plan->dev;
+
+  if (dev == NULL || dev->dft_replan_r(plan, new_dft_points)) {
+    return -1;
+  }
+  plan->size = new_dft_points;
+  return 0;
+}
+
+int srslte_dft_plan_r(srslte_dft_plan_t* plan, const int dft_points, srslte_dft_dir_t dir)
+{
+  dft_dev_t* dev = dft_get_dev();
+
+  plan->p         = NULL;
+  plan->is_cached = false;
+  if (dev == NULL || dev->dft_plan_r(plan, dft_points, dir)) {
+    return -1;
+  }
+  dft_plan_set_attributes(plan, dev, dft_points, dir, SRSLTE_REAL, false);
+
+  return 0;
+}
+
+void srslte_dft_plan_set_mirror(srslte_dft_plan_t* plan, bool val)
+{
+  plan->mirror = val;
+}
+void srslte_dft_plan_set_db(srslte_dft_plan_t* plan, bool val)
+{
+  plan->db = val;
+}
+void srslte_dft_plan_set_norm(srslte_dft_plan_t* plan, bool val)
+{
+  plan->norm = val;
+}
+void srslte_dft_plan_set_dc(srslte_dft_plan_t* plan, bool val)
+{
+  plan->dc = val;
+}
+
+static void copy_pre(uint8_t* dst, uint8_t* src, int size_d, int len, bool forward, bool mirror, bool dc)
+{
+  int offset = dc ? 1 : 0;
+  if (mirror && !forward) {
+    int hlen = dft_floor(len, 2);
+    memset(dst, 0, (size_t)size_d * offset);
+    memcpy(&dst[size_d * offset], &src[size_d * hlen], (size_t)size_d * (len - hlen - offset));
+    memcpy(&dst[(len - hlen) * size_d], src, (size_t)size_d * hlen);
+  } else {
+    memcpy(dst, src, (size_t)size_d * len);
+  }
+}
+
+static void copy_post(uint8_t* dst, uint8_t* src, int size_d, int len, bool forward, bool mirror, bool dc)
+{
+  int offset = dc ? 1 : 0;
+  if (mirror && forward) {
+    int hlen = dft_ceil(len, 2);
+    memcpy(dst, &src[size_d * hlen], (size_t)size_d * (len - hlen));
+    memcpy(&dst[(len - hlen) * size_d], &src[size_d * offset], (size_t)size_d * (hlen - offset));
+  } else {
+    memcpy(dst, src, (size_t)size_d * len);
+  }
+}
+
+void srslte_dft_run(srslte_dft_plan_t* plan, const void* in, void* out)
+{
+  if (plan->mode == SRSLTE_DFT_COMPLEX) {
+    srslte_dft_run_c(plan, in, out);
+  } else {
+    srslte_dft_run_r(plan, in, out);
+  }
+}
+
+void srslte_dft_run_c_zerocopy(srslte_dft_plan_t* plan, const cf_t* in, cf_t* out)
+{
+  ((dft_dev_t*)plan->dev)->dft_execute_c(plan, in, out);
+}
+
+void srslte_dft_run_c(srslte_dft_plan_t* plan, const cf_t* in, cf_t* out)
+{
+  float norm;
+  int   i;
+  cf_t* f_out = plan->out;
+
+  copy_pre((uint8_t*)plan->in, (uint8_t*)in, sizeof(cf_t), plan->size, plan->forward, plan->mirror, plan->dc);
+  ((dft_dev_t*)plan->dev)->dft_execute_c(plan, plan->in, plan->out);
+  if (plan->norm) {
+    norm = 1.0 / sqrtf(plan->size);
+    srslte_vec_sc_prod_cfc(f_out, norm, f_out, plan->size);
+  }
+  if (plan->db) {
+    for (i = 0; i < plan->size; i++) {
+      f_out[i] = srslte_convert_power_to_dB(f_out[i]);
+    }
+  }
+  copy_post((uint8_t*)out, (uint8_t*)plan->out, sizeof(cf_t), plan->size, plan->forward, plan->mirror, plan->dc);
+}
+
+void srslte_dft_run_guru_c(srslte_dft_plan_t* plan)
+{
+  if (plan->is_guru == true) {
+    ((dft_dev_t*)plan->dev)->dft_execute_guru_c(plan);
+  } else {
+    ERROR("srslte_dft_run_guru_c: the selected plan is not guru!\n");
+  }
+}
+
+void srslte_dft_run_r(srslte_dft_plan_t* plan, const float* in, float* out)
+{
+  float  norm;
+  int    i;
+  int    len   = plan->size;
+  float* f_out = plan->out;
+
+  memcpy(plan->in, in, sizeof(float) * plan->size);
+  ((dft_dev_t*)plan->dev)->dft_execute_r(plan, plan->in, plan->out);
+  if (plan->norm) {
+    norm = 1.0 / plan->size;
+    srslte_vec_sc_prod_fff(f_out, norm, f_out, plan->size);
+  }
+  if (plan->db) {
+    for (i = 0; i < len; i++) {
+      f_out[i] = srslte_convert_power_to_dB(f_out[i]);
+    }
+  }
+  memcpy(out, plan->out, sizeof(float) * plan->size);
+}
+
+void srslte_dft_plan_free(srslte_dft_plan_t* plan)
+{
+  if (!plan)
+    return;
+  if (!plan->size)
+    return;
+
+  if (plan->dev) {
+    ((dft_dev_t*)plan->dev)->dft_plan_free(plan);
+  }
+  bzero(plan, sizeof(srslte_dft_plan_t));
+}
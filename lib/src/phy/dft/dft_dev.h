@@ -0,0 +1,63 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_DFT_DEV_H
+#define SRSLTE_DFT_DEV_H
+
+#include "srslte/phy/dft/dft.h"
+
+/* Batch loop of a guru plan */
+typedef struct {
+  int n;     // Number of transforms
+  int idist; // Distance between the inputs of two consecutive transforms
+  int odist; // Distance between the outputs of two consecutive transforms
+} dft_loop_t;
+
+/* Maximum number of nested batch loops in a guru plan */
+#define DFT_MAX_LOOPS 2
+
+/* DFT backend API. The generic layer in dft.c sets the plan attributes and applies the options; the backend is
+ * responsible for plan->p and, except for guru plans, for allocating plan->in and plan->out. */
+typedef struct {
+  const char* name;
+  int (*dft_plan_c)(srslte_dft_plan_t* plan, int dft_points, srslte_dft_dir_t dir);
+  int (*dft_plan_r)(srslte_dft_plan_t* plan, int dft_points, srslte_dft_dir_t dir);
+  int (*dft_plan_guru_c)(srslte_dft_plan_t* plan,
+                         int                dft_points,
+                         srslte_dft_dir_t   dir,
+                         cf_t*              in_buffer,
+                         cf_t*              out_buffer,
+                         int                istride,
+                         int                ostride,
+                         uint32_t           nof_loops,
+                         const dft_loop_t*  loops);
+  int (*dft_replan_c)(srslte_dft_plan_t* plan, int new_dft_points);
+  int (*dft_replan_r)(srslte_dft_plan_t* plan, int new_dft_points);
+  void (*dft_execute_c)(srslte_dft_plan_t* plan, const cf_t* in, cf_t* out);
+  void (*dft_execute_guru_c)(srslte_dft_plan_t* plan);
+  void (*dft_execute_r)(srslte_dft_plan_t* plan, const float* in, float* out);
+  void (*dft_plan_free)(srslte_dft_plan_t* plan);
+  void (*dft_set_plan_time_limit)(double seconds);
+  int (*dft_import_wisdom)(const char* filename);
+  int (*dft_export_wisdom)(const char* filename);
+} dft_dev_t;
+
+#endif // SRSLTE_DFT_DEV_H
@@ -27,14 +27,20 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "dft_fftw_imp.h"
 #include "srslte/phy/dft/dft.h"
-#include "srslte/phy/utils/vector.h"
-
-#define dft_ceil(a, b) ((a - 1) / b + 1)
-#define dft_floor(a, b) (a / b)
 
 #define FFTW_WISDOM_FILE "%s/.srslte_fftwisdom"
 
+// System-wide wisdom, typically generated offline with dft_wisdom_gen, is imported before the user one
+#define FFTW_SYSTEM_WISDOM_FILE "/etc/srslte/fftwisdom"
+
+// Upper bound of the time spent by FFTW planning a single transform, so that start-up time stays bounded
+#define FFTW_PLAN_TIME_LIMIT_S 0.5
+
+// Maximum number of distinct plans kept by the plan cache
+#define DFT_PLAN_CACHE_MAX_LEN 256
+
 static int get_fftw_wisdom_file(char* full_path, uint32_t n)
 {
   const char* homedir = NULL;
@@ -51,18 +57,97 @@ static int get_fftw_wisdom_file(char* full_path, uint32_t n)
 #define FFTW_TYPE 0
 #endif
 
-static pthread_mutex_t fft_mutex = PTHREAD_MUTEX_INITIALIZER;
+/*
+ * Process-wide plan cache. FFTW plans only depend on the transform geometry and on the alignment of the buffers they
+ * were created for, so every DFT object with the same parameters shares one plan and executes it on its own buffers
+ * through the FFTW new-array interface, which is thread-safe. Cached plans live until the process exits.
+ */
+typedef struct {
+  srslte_dft_mode_t mode;
+  int               sign; // FFTW sign for complex transforms, r2r kind for real transforms
+  int               size;
+  int               istride;
+  int               ostride;
+  int               howmany_rank;
+  fftwf_iodim       howmany_dims[2];
+  int               in_alignment;
+  int               out_alignment;
+  bool              in_place;
+} dft_plan_key_t;
+
+typedef struct {
+  dft_plan_key_t key;
+  fftwf_plan     p;
+} dft_plan_cache_entry_t;
+
+static pthread_mutex_t        fft_mutex = PTHREAD_MUTEX_INITIALIZER;
+static dft_plan_cache_entry_t plan_cache[DFT_PLAN_CACHE_MAX_LEN];
+static uint32_t               plan_cache_len = 0;
+
+static void dft_plan_key_init(dft_plan_key_t* key, srslte_dft_mode_t mode, int sign, int size, void* in, void* out)
+{
+  bzero(key, sizeof(dft_plan_key_t));
+  key->mode          = mode;
+  key->sign          = sign;
+  key->size          = size;
+  key->istride       = 1;
+  key->ostride       = 1;
+  key->in_alignment  = fftwf_alignment_of((float*)in);
+  key->out_alignment = fftwf_alignment_of((float*)out);
+  key->in_place      = (in == out);
+}
+
+// Returns the plan for the given key, plans it if it is not cached yet. It must be called with fft_mutex locked.
+static fftwf_plan dft_plan_cache_get(const dft_plan_key_t* key, void* in, void* out, bool* is_cached)
+{
+  for (uint32_t i = 0; i < plan_cache_len; i++) {
+    if (memcmp(&plan_cache[i].key, key, sizeof(dft_plan_key_t)) == 0) {
+      *is_cached = true;
+      return plan_cache[i].p;
+    }
+  }
+
+  fftwf_plan p = NULL;
+  if (key->mode == SRSLTE_DFT_COMPLEX) {
+    const fftwf_iodim iodim = {key->size, key->istride, key->ostride};
+    p = fftwf_plan_guru_dft(1, &iodim, key->howmany_rank, key->howmany_dims, in, out, key->sign, FFTW_TYPE);
+  } else {
+    p = fftwf_plan_r2r_1d(key->size, in, out, (fftwf_r2r_kind)key->sign, FFTW_TYPE);
+  }
+
+  *is_cached = false;
+  if (p && plan_cache_len < DFT_PLAN_CACHE_MAX_LEN) {
+    plan_cache[plan_cache_len].key = *key;
+    plan_cache[plan_cache_len].p   = p;
+    plan_cache_len++;
+    *is_cached = true;
+  }
+
+  return p;
+}
+
+// Releases the plan held by a DFT object. It must be called with fft_mutex locked.
+static void dft_plan_release(srslte_dft_plan_t* plan)
+{
+  if (plan->p && !plan->is_cached) {
+    fftwf_destroy_plan(plan->p);
+  }
+  plan->p         = NULL;
+  plan->is_cached = false;
+}
 
 // This function is called in the beggining of any executable where it is linked
 __attribute__((constructor)) static void srslte_dft_load()
 {
 #ifdef FFTW_WISDOM_FILE
   char full_path[256];
+  fftwf_import_wisdom_from_filename(FFTW_SYSTEM_WISDOM_FILE);
   get_fftw_wisdom_file(full_path, sizeof(full_path));
   fftwf_import_wisdom_from_filename(full_path);
 #else
   printf("Warning: FFTW Wisdom file not defined\n");
 #endif
+  fftwf_set_timelimit(FFTW_PLAN_TIME_LIMIT_S);
 }
 
 // This function is called in the ending of any executable where it is linked
@@ -73,35 +158,38 @@ __attribute__((destructor)) static void srslte_dft_exit()
   get_fftw_wisdom_file(full_path, sizeof(full_path));
   fftwf_export_wisdom_to_filename(full_path);
 #endif
+  pthread_mutex_lock(&fft_mutex);
+  for (uint32_t i = 0; i < plan_cache_len; i++) {
+    fftwf_destroy_plan(plan_cache[i].p);
+  }
+  plan_cache_len = 0;
+  pthread_mutex_unlock(&fft_mutex);
   fftwf_cleanup();
 }
 
-int srslte_dft_plan(srslte_dft_plan_t* plan, const int dft_points, srslte_dft_dir_t dir, srslte_dft_mode_t mode)
+void dft_fftw_set_plan_time_limit(double seconds)
 {
-  bzero(plan, sizeof(srslte_dft_plan_t));
-  if (mode == SRSLTE_DFT_COMPLEX) {
-    return srslte_dft_plan_c(plan, dft_points, dir);
-  } else {
-    return srslte_dft_plan_r(plan, dft_points, dir);
-  }
-  return 0;
+  pthread_mutex_lock(&fft_mutex);
+  fftwf_set_timelimit(seconds);
+  pthread_mutex_unlock(&fft_mutex);
 }
 
-int srslte_dft_replan(srslte_dft_plan_t* plan, const int new_dft_points)
+int dft_fftw_import_wisdom(const char* filename)
 {
-  if (new_dft_points <= plan->init_size) {
-    if (plan->mode == SRSLTE_DFT_COMPLEX) {
-      return srslte_dft_replan_c(plan, new_dft_points);
-    } else {
-      return srslte_dft_replan_r(plan, new_dft_points);
-    }
-  } else {
-    ERROR("DFT: Error calling replan: new_dft_points (%d) must be lower or equal "
-          "dft_size passed initially (%d)\n",
-          new_dft_points,
-          plan->init_size);
-    return -1;
-  }
+  pthread_mutex_lock(&fft_mutex);
+  int ret = fftwf_import_wisdom_from_filename(filename);
+  pthread_mutex_unlock(&fft_mutex);
+
+  return ret ? SRSLTE_SUCCESS : SRSLTE_ERROR;
+}
+
+int dft_fftw_export_wisdom(const char* filename)
+{
+  pthread_mutex_lock(&fft_mutex);
+  int ret = fftwf_export_wisdom_to_filename(filename);
+  pthread_mutex_unlock(&fft_mutex);
+
+  return ret ? SRSLTE_SUCCESS : SRSLTE_ERROR;
 }
 
 static void allocate(srslte_dft_plan_t* plan, int size_in, int size_out, int len)
@@ -110,281 +198,134 @@ static void allocate(srslte_dft_plan_t* plan, int size_in, int size_out, int len
   plan->out = fftwf_malloc((size_t)size_out * len);
 }
 
-int srslte_dft_replan_guru_c(srslte_dft_plan_t* plan,
-                             const int          new_dft_points,
-                             cf_t*              in_buffer,
-                             cf_t*              out_buffer,
-                             int                istride,
-                             int                ostride,
-                             int                how_many,
-                             int                idist,
-                             int                odist)
+int dft_fftw_plan_guru_c(srslte_dft_plan_t* plan,
+                         int                dft_points,
+                         srslte_dft_dir_t   dir,
+                         cf_t*              in_buffer,
+                         cf_t*              out_buffer,
+                         int                istride,
+                         int                ostride,
+                         uint32_t           nof_loops,
+                         const dft_loop_t*  loops)
 {
-  int sign = (plan->forward) ? FFTW_FORWARD : FFTW_BACKWARD;
-
-  const fftwf_iodim iodim        = {new_dft_points, istride, ostride};
-  const fftwf_iodim howmany_dims = {how_many, idist, odist};
-
-  pthread_mutex_lock(&fft_mutex);
-
-  /* Destroy current plan */
-  fftwf_destroy_plan(plan->p);
-
-  plan->p = fftwf_plan_guru_dft(1, &iodim, 1, &howmany_dims, in_buffer, out_buffer, sign, FFTW_TYPE);
-
-  pthread_mutex_unlock(&fft_mutex);
+  int sign = (dir == SRSLTE_DFT_FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD;
 
-  if (!plan->p) {
+  if (nof_loops > DFT_MAX_LOOPS) {
     return -1;
   }
-  plan->size      = new_dft_points;
-  plan->init_size = plan->size;
 
-  return 0;
-}
-
-int srslte_dft_replan_c(srslte_dft_plan_t* plan, const int new_dft_points)
-{
-  int sign = (plan->dir == SRSLTE_DFT_FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD;
+  dft_plan_key_t key;
+  dft_plan_key_init(&key, SRSLTE_DFT_COMPLEX, sign, dft_points, in_buffer, out_buffer);
+  key.istride      = istride;
+  key.ostride      = ostride;
+  key.howmany_rank = (int)nof_loops;
+  for (uint32_t i = 0; i < nof_loops; i++) {
+    key.howmany_dims[i].n  = loops[i].n;
+    key.howmany_dims[i].is = loops[i].idist;
+    key.howmany_dims[i].os = loops[i].odist;
+  }
 
   pthread_mutex_lock(&fft_mutex);
-  if (plan->p) {
-    fftwf_destroy_plan(plan->p);
-    plan->p = NULL;
-  }
-  plan->p = fftwf_plan_dft_1d(new_dft_points, plan->in, plan->out, sign, FFTW_TYPE);
+  plan->p = dft_plan_cache_get(&key, in_buffer, out_buffer, &plan->is_cached);
   pthread_mutex_unlock(&fft_mutex);
 
   if (!plan->p) {
     return -1;
   }
-  plan->size = new_dft_points;
+
   return 0;
 }
 
-int srslte_dft_plan_guru_c(srslte_dft_plan_t* plan,
-                           const int          dft_points,
-                           srslte_dft_dir_t   dir,
-                           cf_t*              in_buffer,
-                           cf_t*              out_buffer,
-                           int                istride,
-                           int                ostride,
-                           int                how_many,
-                           int                idist,
-                           int                odist)
+int dft_fftw_replan_c(srslte_dft_plan_t* plan, const int new_dft_points)
 {
-  int sign = (dir == SRSLTE_DFT_FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD;
+  int sign = (plan->dir == SRSLTE_DFT_FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD;
 
-  const fftwf_iodim iodim        = {dft_points, istride, ostride};
-  const fftwf_iodim howmany_dims = {how_many, idist, odist};
+  dft_plan_key_t key;
+  dft_plan_key_init(&key, SRSLTE_DFT_COMPLEX, sign, new_dft_points, plan->in, plan->out);
 
   pthread_mutex_lock(&fft_mutex);
+  dft_plan_release(plan);
+  plan->p = dft_plan_cache_get(&key, plan->in, plan->out, &plan->is_cached);
+  pthread_mutex_unlock(&fft_mutex);
 
-  plan->p = fftwf_plan_guru_dft(1, &iodim, 1, &howmany_dims, in_buffer, out_buffer, sign, FFTW_TYPE);
   if (!plan->p) {
     return -1;
   }
-  pthread_mutex_unlock(&fft_mutex);
-
-  plan->size      = dft_points;
-  plan->init_size = plan->size;
-  plan->mode      = SRSLTE_DFT_COMPLEX;
-  plan->dir       = dir;
-  plan->forward   = (dir == SRSLTE_DFT_FORWARD) ? true : false;
-  plan->mirror    = false;
-  plan->db        = false;
-  plan->norm      = false;
-  plan->dc        = false;
-  plan->is_guru   = true;
-
   return 0;
 }
 
-int srslte_dft_plan_c(srslte_dft_plan_t* plan, const int dft_points, srslte_dft_dir_t dir)
+int dft_fftw_plan_c(srslte_dft_plan_t* plan, const int dft_points, srslte_dft_dir_t dir)
 {
   allocate(plan, sizeof(fftwf_complex), sizeof(fftwf_complex), dft_points);
 
-  pthread_mutex_lock(&fft_mutex);
-
   int sign = (dir == SRSLTE_DFT_FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD;
-  plan->p  = fftwf_plan_dft_1d(dft_points, plan->in, plan->out, sign, FFTW_TYPE);
 
+  dft_plan_key_t key;
+  dft_plan_key_init(&key, SRSLTE_DFT_COMPLEX, sign, dft_points, plan->in, plan->out);
+
+  pthread_mutex_lock(&fft_mutex);
+  plan->p = dft_plan_cache_get(&key, plan->in, plan->out, &plan->is_cached);
   pthread_mutex_unlock(&fft_mutex);
 
   if (!plan->p) {
     return -1;
   }
-  plan->size      = dft_points;
-  plan->init_size = plan->size;
-  plan->mode      = SRSLTE_DFT_COMPLEX;
-  plan->dir       = dir;
-  plan->forward   = (dir == SRSLTE_DFT_FORWARD) ? true : false;
-  plan->mirror    = false;
-  plan->db        = false;
-  plan->norm      = false;
-  plan->dc        = false;
-  plan->is_guru   = false;
-
   return 0;
 }
 
-int srslte_dft_replan_r(srslte_dft_plan_t* plan, const int new_dft_points)
+int dft_fftw_replan_r(srslte_dft_plan_t* plan, const int new_dft_points)
 {
   int sign = (plan->dir == SRSLTE_DFT_FORWARD) ? FFTW_R2HC : FFTW_HC2R;
 
+  dft_plan_key_t key;
+  dft_plan_key_init(&key, SRSLTE_REAL, sign, new_dft_points, plan->in, plan->out);
+
   pthread_mutex_lock(&fft_mutex);
-  if (plan->p) {
-    fftwf_destroy_plan(plan->p);
-    plan->p = NULL;
-  }
-  plan->p = fftwf_plan_r2r_1d(new_dft_points, plan->in, plan->out, sign, FFTW_TYPE);
+  dft_plan_release(plan);
+  plan->p = dft_plan_cache_get(&key, plan->in, plan->out, &plan->is_cached);
   pthread_mutex_unlock(&fft_mutex);
 
   if (!plan->p) {
     return -1;
   }
-  plan->size = new_dft_points;
   return 0;
 }
 
-int srslte_dft_plan_r(srslte_dft_plan_t* plan, const int dft_points, srslte_dft_dir_t dir)
+int dft_fftw_plan_r(srslte_dft_plan_t* plan, const int dft_points, srslte_dft_dir_t dir)
 {
   allocate(plan, sizeof(float), sizeof(float), dft_points);
   int sign = (dir == SRSLTE_DFT_FORWARD) ? FFTW_R2HC : FFTW_HC2R;
 
+  dft_plan_key_t key;
+  dft_plan_key_init(&key, SRSLTE_REAL, sign, dft_points, plan->in, plan->out);
+
   pthread_mutex_lock(&fft_mutex);
-  plan->p = fftwf_plan_r2r_1d(dft_points, plan->in, plan->out, sign, FFTW_TYPE);
+  plan->p = dft_plan_cache_get(&key, plan->in, plan->out, &plan->is_cached);
   pthread_mutex_unlock(&fft_mutex);
 
   if (!plan->p) {
     return -1;
   }
-  plan->size      = dft_points;
-  plan->init_size = plan->size;
-  plan->mode      = SRSLTE_REAL;
-  plan->dir       = dir;
-  plan->forward   = (dir == SRSLTE_DFT_FORWARD) ? true : false;
-  plan->mirror    = false;
-  plan->db        = false;
-  plan->norm      = false;
-  plan->dc        = false;
-
   return 0;
 }
 
-void srslte_dft_plan_set_mirror(srslte_dft_plan_t* plan, bool val)
-{
-  plan->mirror = val;
-}
-void srslte_dft_plan_set_db(srslte_dft_plan_t* plan, bool val)
-{
-  plan->db = val;
-}
-void srslte_dft_plan_set_norm(srslte_dft_plan_t* plan, bool val)
-{
-  plan->norm = val;
-}
-void srslte_dft_plan_set_dc(srslte_dft_plan_t* plan, bool val)
-{
-  plan->dc = val;
-}
-
-static void copy_pre(uint8_t* dst, uint8_t* src, int size_d, int len, bool forward, bool mirror, bool dc)
-{
-  int offset = dc ? 1 : 0;
-  if (mirror && !forward) {
-    int hlen = dft_floor(len, 2);
-    memset(dst, 0, (size_t)size_d * offset);
-    memcpy(&dst[size_d * offset], &src[size_d * hlen], (size_t)size_d * (len - hlen - offset));
-    memcpy(&dst[(len - hlen) * size_d], src, (size_t)size_d * hlen);
-  } else {
-    memcpy(dst, src, (size_t)size_d * len);
-  }
-}
-
-static void copy_post(uint8_t* dst, uint8_t* src, int size_d, int len, bool forward, bool mirror, bool dc)
-{
-  int offset = dc ? 1 : 0;
-  if (mirror && forward) {
-    int hlen = dft_ceil(len, 2);
-    memcpy(dst, &src[size_d * hlen], (size_t)size_d * (len - hlen));
-    memcpy(&dst[(len - hlen) * size_d], &src[size_d * offset], (size_t)size_d * (hlen - offset));
-  } else {
-    memcpy(dst, src, (size_t)size_d * len);
-  }
-}
-
-void srslte_dft_run(srslte_dft_plan_t* plan, const void* in, void* out)
-{
-  if (plan->mode == SRSLTE_DFT_COMPLEX) {
-    srslte_dft_run_c(plan, in, out);
-  } else {
-    srslte_dft_run_r(plan, in, out);
-  }
-}
-
-void srslte_dft_run_c_zerocopy(srslte_dft_plan_t* plan, const cf_t* in, cf_t* out)
+void dft_fftw_execute_c(srslte_dft_plan_t* plan, const cf_t* in, cf_t* out)
 {
   fftwf_execute_dft(plan->p, (cf_t*)in, out);
 }
 
-void srslte_dft_run_c(srslte_dft_plan_t* plan, const cf_t* in, cf_t* out)
-{
-  float          norm;
-  int            i;
-  fftwf_complex* f_out = plan->out;
-
-  copy_pre((uint8_t*)plan->in, (uint8_t*)in, sizeof(cf_t), plan->size, plan->forward, plan->mirror, plan->dc);
-  fftwf_execute(plan->p);
-  if (plan->norm) {
-    norm = 1.0 / sqrtf(plan->size);
-    srslte_vec_sc_prod_cfc(f_out, norm, f_out, plan->size);
-  }
-  if (plan->db) {
-    for (i = 0; i < plan->size; i++) {
-      f_out[i] = srslte_convert_power_to_dB(f_out[i]);
-    }
-  }
-  copy_post((uint8_t*)out, (uint8_t*)plan->out, sizeof(cf_t), plan->size, plan->forward, plan->mirror, plan->dc);
-}
-
-void srslte_dft_run_guru_c(srslte_dft_plan_t* plan)
+void dft_fftw_execute_guru_c(srslte_dft_plan_t* plan)
 {
-  if (plan->is_guru == true) {
-    fftwf_execute(plan->p);
-  } else {
-    ERROR("srslte_dft_run_guru_c: the selected plan is not guru!\n");
-  }
+  fftwf_execute_dft(plan->p, plan->in, plan->out);
 }
 
-void srslte_dft_run_r(srslte_dft_plan_t* plan, const float* in, float* out)
+void dft_fftw_execute_r(srslte_dft_plan_t* plan, const float* in, float* out)
 {
-  float  norm;
-  int    i;
-  int    len   = plan->size;
-  float* f_out = plan->out;
-
-  memcpy(plan->in, in, sizeof(float) * plan->size);
-  fftwf_execute(plan->p);
-  if (plan->norm) {
-    norm = 1.0 / plan->size;
-    srslte_vec_sc_prod_fff(f_out, norm, f_out, plan->size);
-  }
-  if (plan->db) {
-    for (i = 0; i < len; i++) {
-      f_out[i] = srslte_convert_power_to_dB(f_out[i]);
-    }
-  }
-  memcpy(out, plan->out, sizeof(float) * plan->size);
+  fftwf_execute_r2r(plan->p, (float*)in, out);
 }
 
-void srslte_dft_plan_free(srslte_dft_plan_t* plan)
+void dft_fftw_plan_free(srslte_dft_plan_t* plan)
 {
-  if (!plan)
-    return;
-  if (!plan->size)
-    return;
-
   pthread_mutex_lock(&fft_mutex);
   if (!plan->is_guru) {
     if (plan->in)
@@ -392,8 +333,6 @@ void srslte_dft_plan_free(srslte_dft_plan_t* plan)
     if (plan->out)
       fftwf_free(plan->out);
   }
-  if (plan->p)
-    fftwf_destroy_plan(plan->p);
+  dft_plan_release(plan);
   pthread_mutex_unlock(&fft_mutex);
-  bzero(plan, sizeof(srslte_dft_plan_t));
 }
@@ -0,0 +1,274 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/srslte.h"
+#include <complex.h>
+#include <mkl_dfti.h>
+#include <mkl_service.h>
+#include <string.h>
+
+#include "dft_mkl_imp.h"
+#include "srslte/phy/dft/dft.h"
+
+#define DFT_MKL_ALIGNMENT 64
+
+/* Intel MKL DFTI plan. Committed descriptors are read-only and can be used from several threads. */
+typedef struct {
+  DFTI_DESCRIPTOR_HANDLE handle;
+  dft_loop_t             outer; // DFTI batches a single loop, the outer loop of guru plans is run by hand
+  bool                   in_place;
+  cf_t*                  cce; // Conjugate-even spectrum of real transforms, converted from/to FFTW half-complex
+} dft_mkl_plan_t;
+
+static bool dft_mkl_error(MKL_LONG status)
+{
+  if (status && !DftiErrorClass(status, DFTI_NO_ERROR)) {
+    ERROR("MKL DFTI: %s\n", DftiErrorMessage(status));
+    return true;
+  }
+  return false;
+}
+
+static void dft_mkl_release(dft_mkl_plan_t* h)
+{
+  if (h->handle) {
+    DftiFreeDescriptor(&h->handle);
+    h->handle = NULL;
+  }
+  if (h->cce) {
+    mkl_free(h->cce);
+    h->cce = NULL;
+  }
+}
+
+static int dft_mkl_commit_c(dft_mkl_plan_t*   h,
+                            int               dft_points,
+                            int               istride,
+                            int               ostride,
+                            const dft_loop_t* inner,
+                            bool              in_place)
+{
+  MKL_LONG is[2] = {0, istride};
+  MKL_LONG os[2] = {0, ostride};
+
+  h->in_place = in_place;
+  if (dft_mkl_error(DftiCreateDescriptor(&h->handle, DFTI_SINGLE, DFTI_COMPLEX, 1, (MKL_LONG)dft_points)) ||
+      dft_mkl_error(DftiSetValue(h->handle, DFTI_PLACEMENT, in_place ? DFTI_INPLACE : DFTI_NOT_INPLACE)) ||
+      dft_mkl_error(DftiSetValue(h->handle, DFTI_INPUT_STRIDES, is)) ||
+      dft_mkl_error(DftiSetValue(h->handle, DFTI_OUTPUT_STRIDES, os))) {
+    return -1;
+  }
+
+  if (inner != NULL && (dft_mkl_error(DftiSetValue(h->handle, DFTI_NUMBER_OF_TRANSFORMS, (MKL_LONG)inner->n)) ||
+                        dft_mkl_error(DftiSetValue(h->handle, DFTI_INPUT_DISTANCE, (MKL_LONG)inner->idist)) ||
+                        dft_mkl_error(DftiSetValue(h->handle, DFTI_OUTPUT_DISTANCE, (MKL_LONG)inner->odist)))) {
+    return -1;
+  }
+
+  if (dft_mkl_error(DftiCommitDescriptor(h->handle))) {
+    return -1;
+  }
+
+  return 0;
+}
+
+static int dft_mkl_commit_r(dft_mkl_plan_t* h, int dft_points)
+{
+  h->in_place = false;
+  h->cce      = mkl_malloc(sizeof(cf_t) * (dft_points / 2 + 1), DFT_MKL_ALIGNMENT);
+  if (!h->cce) {
+    return -1;
+  }
+
+  if (dft_mkl_error(DftiCreateDescriptor(&h->handle, DFTI_SINGLE, DFTI_REAL, 1, (MKL_LONG)dft_points)) ||
+      dft_mkl_error(DftiSetValue(h->handle, DFTI_PLACEMENT, DFTI_NOT_INPLACE)) ||
+      dft_mkl_error(DftiSetValue(h->handle, DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX)) ||
+      dft_mkl_error(DftiCommitDescriptor(h->handle))) {
+    return -1;
+  }
+
+  return 0;
+}
+
+static dft_mkl_plan_t* dft_mkl_new(srslte_dft_plan_t* plan, size_t size_d, int len)
+{
+  dft_mkl_plan_t* h = calloc(1, sizeof(dft_mkl_plan_t));
+  if (!h) {
+    return NULL;
+  }
+  h->outer.n = 1;
+
+  if (len > 0) {
+    plan->in  = mkl_malloc(size_d * len, DFT_MKL_ALIGNMENT);
+    plan->out = mkl_malloc(size_d * len, DFT_MKL_ALIGNMENT);
+  }
+
+  plan->p = h;
+  return h;
+}
+
+int dft_mkl_plan_c(srslte_dft_plan_t* plan, const int dft_points, srslte_dft_dir_t dir)
+{
+  dft_mkl_plan_t* h = dft_mkl_new(plan, sizeof(cf_t), dft_points);
+  if (!h || !plan->in || !plan->out) {
+    return -1;
+  }
+
+  return dft_mkl_commit_c(h, dft_points, 1, 1, NULL, false);
+}
+
+int dft_mkl_replan_c(srslte_dft_plan_t* plan, const int new_dft_points)
+{
+  dft_mkl_plan_t* h = (dft_mkl_plan_t*)plan->p;
+
+  dft_mkl_release(h);
+  return dft_mkl_commit_c(h, new_dft_points, 1, 1, NULL, false);
+}
+
+int dft_mkl_plan_r(srslte_dft_plan_t* plan, const int dft_points, srslte_dft_dir_t dir)
+{
+  dft_mkl_plan_t* h = dft_mkl_new(plan, sizeof(float), dft_points);
+  if (!h || !plan->in || !plan->out) {
+    return -1;
+  }
+
+  return dft_mkl_commit_r(h, dft_points);
+}
+
+int dft_mkl_replan_r(srslte_dft_plan_t* plan, const int new_dft_points)
+{
+  dft_mkl_plan_t* h = (dft_mkl_plan_t*)plan->p;
+
+  dft_mkl_release(h);
+  return dft_mkl_commit_r(h, new_dft_points);
+}
+
+int dft_mkl_plan_guru_c(srslte_dft_plan_t* plan,
+                        int                dft_points,
+                        srslte_dft_dir_t   dir,
+                        cf_t*              in_buffer,
+                        cf_t*              out_buffer,
+                        int                istride,
+                        int                ostride,
+                        uint32_t           nof_loops,
+                        const dft_loop_t*  loops)
+{
+  if (nof_loops == 0 || nof_loops > DFT_MAX_LOOPS) {
+    return -1;
+  }
+
+  dft_mkl_plan_t* h = dft_mkl_new(plan, 0, 0);
+  if (!h) {
+    return -1;
+  }
+
+  // The innermost loop is batched by the descriptor
+  if (nof_loops > 1) {
+    h->outer = loops[0];
+  }
+
+  return dft_mkl_commit_c(h, dft_points, istride, ostride, &loops[nof_loops - 1], in_buffer == out_buffer);
+}
+
+static void dft_mkl_compute_c(const srslte_dft_plan_t* plan, const dft_mkl_plan_t* h, cf_t* in, cf_t* out)
+{
+  if (plan->forward) {
+    if (h->in_place) {
+      DftiComputeForward(h->handle, in);
+    } else {
+      DftiComputeForward(h->handle, in, out);
+    }
+  } else {
+    if (h->in_place) {
+      DftiComputeBackward(h->handle, in);
+    } else {
+      DftiComputeBackward(h->handle, in, out);
+    }
+  }
+}
+
+void dft_mkl_execute_c(srslte_dft_plan_t* plan, const cf_t* in, cf_t* out)
+{
+  dft_mkl_plan_t* h = (dft_mkl_plan_t*)plan->p;
+
+  // The descriptor is committed out-of-place, in-place executions go through the plan input buffer
+  if (in == out) {
+    memcpy(plan->in, in, sizeof(cf_t) * plan->size);
+    in = plan->in;
+  }
+
+  dft_mkl_compute_c(plan, h, (cf_t*)in, out);
+}
+
+void dft_mkl_execute_guru_c(srslte_dft_plan_t* plan)
+{
+  dft_mkl_plan_t* h   = (dft_mkl_plan_t*)plan->p;
+  cf_t*           in  = plan->in;
+  cf_t*           out = plan->out;
+
+  for (int i = 0; i < h->outer.n; i++) {
+    dft_mkl_compute_c(plan, h, in + i * h->outer.idist, out + i * h->outer.odist);
+  }
+}
+
+void dft_mkl_execute_r(srslte_dft_plan_t* plan, const float* in, float* out)
+{
+  dft_mkl_plan_t* h   = (dft_mkl_plan_t*)plan->p;
+  int             n   = plan->size;
+  cf_t*           cce = h->cce;
+
+  // Real transforms follow the FFTW half-complex layout: r0, r1, ..., r(n/2), i((n+1)/2-1), ..., i1
+  if (plan->forward) {
+    DftiComputeForward(h->handle, (float*)in, (float*)cce);
+    for (int k = 0; k <= n / 2; k++) {
+      out[k] = crealf(cce[k]);
+    }
+    for (int k = 1; k < (n + 1) / 2; k++) {
+      out[n - k] = cimagf(cce[k]);
+    }
+  } else {
+    cce[0] = in[0];
+    for (int k = 1; k < (n + 1) / 2; k++) {
+      cce[k] = in[k] + I * in[n - k];
+    }
+    if (n % 2 == 0) {
+      cce[n / 2] = in[n / 2];
+    }
+    DftiComputeBackward(h->handle, (float*)cce, out);
+  }
+}
+
+void dft_mkl_plan_free(srslte_dft_plan_t* plan)
+{
+  dft_mkl_plan_t* h = (dft_mkl_plan_t*)plan->p;
+
+  if (!plan->is_guru) {
+    if (plan->in)
+      mkl_free(plan->in);
+    if (plan->out)
+      mkl_free(plan->out);
+  }
+  if (h) {
+    dft_mkl_release(h);
+    free(h);
+  }
+  plan->p = NULL;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLTE_DFT_MKL_IMP_H
+#define SRSLTE_DFT_MKL_IMP_H
+
+#include "dft_dev.h"
+
+SRSLTE_API int dft_mkl_plan_c(srslte_dft_plan_t* plan, int dft_points, srslte_dft_dir_t dir);
+
+SRSLTE_API int dft_mkl_plan_r(srslte_dft_plan_t* plan, int dft_points, srslte_dft_dir_t dir);
+
+SRSLTE_API int dft_mkl_plan_guru_c(srslte_dft_plan_t* plan,
+                                   int                dft_points,
+                                   srslte_dft_dir_t   dir,
+                                   cf_t*              in_buffer,
+                                   cf_t*              out_buffer,
+                                   int                istride,
+                                   int                ostride,
+                                   uint32_t           nof_loops,
+                                   const dft_loop_t*  loops);
+
+SRSLTE_API int dft_mkl_replan_c(srslte_dft_plan_t* plan, int new_dft_points);
+
+SRSLTE_API int dft_mkl_replan_r(srslte_dft_plan_t* plan, int new_dft_points);
+
+SRSLTE_API void dft_mkl_execute_c(srslte_dft_plan_t* plan, const cf_t* in, cf_t* out);
+
+SRSLTE_API void dft_mkl_execute_guru_c(srslte_dft_plan_t* plan);
+
+SRSLTE_API void dft_mkl_execute_r(srslte_dft_plan_t* plan, const float* in, float* out);
+
+SRSLTE_API void dft_mkl_plan_free(srslte_dft_plan_t* plan);
+
+#endif // SRSLTE_DFT_MKL_IMP_H
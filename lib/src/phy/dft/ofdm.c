@@ -184,6 +184,46 @@ static int ofdm_init_mbsfn_(srslte_ofdm_t* q, srslte_ofdm_cfg_t* cfg, srslte_dft
       }
     }
   }
+
+  // Batched plan covering both slots: the outer loop jumps slots, the inner loop jumps symbols within the slot
+  if (q->fft_plan_sf_batch.size) {
+    srslte_dft_plan_free(&q->fft_plan_sf_batch);
+  }
+  if (dir == SRSLTE_DFT_FORWARD) {
+    if (srslte_dft_plan_guru_batch_c(&q->fft_plan_sf_batch,
+                                     symbol_sz,
+                                     dir,
+                                     in_buffer + cp1 - q->window_offset_n,
+                                     q->tmp,
+                                     1,
+                                     1,
+                                     SRSLTE_CP_NSYMB(cp),
+                                     symbol_sz + cp2,
+                                     symbol_sz,
+                                     SRSLTE_NOF_SLOTS_PER_SF,
+                                     q->slot_sz,
+                                     symbol_sz * SRSLTE_CP_NSYMB(cp))) {
+      ERROR("Creating batched Guru DFT plan\n");
+      return SRSLTE_ERROR;
+    }
+  } else {
+    if (srslte_dft_plan_guru_batch_c(&q->fft_plan_sf_batch,
+                                     symbol_sz,
+                                     dir,
+                                     q->tmp,
+                                     out_buffer + cp1,
+                                     1,
+                                     1,
+                                     SRSLTE_CP_NSYMB(cp),
+                                     symbol_sz,
+                                     symbol_sz + cp2,
+                                     SRSLTE_NOF_SLOTS_PER_SF,
+                                     symbol_sz * SRSLTE_CP_NSYMB(cp),
+                                     q->slot_sz)) {
+      ERROR("Creating batched Guru inverse-DFT plan\n");
+      return SRSLTE_ERROR;
+    }
+  }
 #endif
 
   srslte_dft_plan_set_mirror(&q->fft_plan, true);
@@ -227,6 +267,9 @@ void srslte_ofdm_free_(srslte_ofdm_t* q)
       srslte_dft_plan_free(&q->fft_plan_sf[slot]);
     }
   }
+  if (q->fft_plan_sf_batch.init_size) {
+    srslte_dft_plan_free(&q->fft_plan_sf_batch);
+  }
 #endif
 
   if (q->tmp) {
@@ -241,6 +284,64 @@ void srslte_ofdm_free_(srslte_ofdm_t* q)
   bzero(q, sizeof(srslte_ofdm_t));
 }
 
+/* Initialises and releases a temporal OFDM object for every standard bandwidth up to cfg->nof_prb. The DFT plans stay in
+ * the shared plan cache, so objects initialised or reconfigured later with the same parameters do not run the planner.
+ */
+static int ofdm_preplan_(const srslte_ofdm_cfg_t* cfg, srslte_dft_dir_t dir)
+{
+  const uint32_t nof_prb_list[] = {6, 15, 25, 50, 75, 100};
+  int            ret            = SRSLTE_SUCCESS;
+
+  if (cfg == NULL || srslte_symbol_sz(cfg->nof_prb) <= SRSLTE_SUCCESS) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t buffer_len = SRSLTE_MAX(SRSLTE_SF_LEN_PRB(cfg->nof_prb), SRSLTE_SF_LEN_RE(cfg->nof_prb, SRSLTE_CP_NORM));
+  cf_t*    in_buffer  = srslte_vec_cf_malloc(buffer_len);
+  cf_t*    out_buffer = srslte_vec_cf_malloc(buffer_len);
+  if (!in_buffer || !out_buffer) {
+    perror("malloc");
+    ret = SRSLTE_ERROR;
+    goto clean_exit;
+  }
+
+  for (uint32_t i = 0; i < sizeof(nof_prb_list) / sizeof(nof_prb_list[0]) && ret == SRSLTE_SUCCESS; i++) {
+    if (nof_prb_list[i] > cfg->nof_prb) {
+      break;
+    }
+
+    srslte_ofdm_t     q        = {};
+    srslte_ofdm_cfg_t ofdm_cfg = *cfg;
+    ofdm_cfg.nof_prb           = nof_prb_list[i];
+    ofdm_cfg.symbol_sz         = 0;
+    ofdm_cfg.in_buffer         = in_buffer;
+    ofdm_cfg.out_buffer        = out_buffer;
+
+    ret = ofdm_init_mbsfn_(&q, &ofdm_cfg, dir);
+    srslte_ofdm_free_(&q);
+  }
+
+clean_exit:
+  if (in_buffer) {
+    free(in_buffer);
+  }
+  if (out_buffer) {
+    free(out_buffer);
+  }
+
+  return ret;
+}
+
+int srslte_ofdm_rx_preplan(const srslte_ofdm_cfg_t* cfg)
+{
+  return ofdm_preplan_(cfg, SRSLTE_DFT_FORWARD);
+}
+
+int srslte_ofdm_tx_preplan(const srslte_ofdm_cfg_t* cfg)
+{
+  return ofdm_preplan_(cfg, SRSLTE_DFT_BACKWARD);
+}
+
 int srslte_ofdm_rx_init(srslte_ofdm_t* q, srslte_cp_t cp, cf_t* in_buffer, cf_t* out_buffer, uint32_t max_prb)
 {
   bzero(q, sizeof(srslte_ofdm_t));
@@ -386,6 +487,45 @@ void srslte_ofdm_rx_slot_ng(srslte_ofdm_t* q, cf_t* input, cf_t* output)
   }
 }
 
+#ifndef AVOID_GURU
+/* Extracts the used subcarriers of nof_symbols consecutive DFT outputs in tmp.
+ * The window offset compensation, FFT shift and normalization are done in a single pass over the used subcarriers.
+ */
+static void ofdm_rx_symbols(srslte_ofdm_t* q, const cf_t* tmp, cf_t* output, uint32_t nof_symbols)
+{
+  uint32_t    symbol_sz = q->cfg.symbol_sz;
+  uint32_t    half_re   = q->nof_re / 2;
+  uint32_t    dc        = (q->fft_plan.dc) ? 1 : 0;
+  const cf_t* window    = q->window_offset_buffer;
+  float       norm      = 1.0f / sqrtf(q->fft_plan.size);
+
+  for (uint32_t i = 0; i < nof_symbols; i++) {
+    const cf_t* neg = tmp + symbol_sz - half_re;
+    const cf_t* pos = tmp + dc;
+
+    if (q->window_offset_n) {
+      // Apply frequency domain window offset while doing the FFT shift
+      srslte_vec_prod_ccc(neg, &window[symbol_sz - half_re], output, half_re);
+      srslte_vec_prod_ccc(pos, &window[dc], output + half_re, half_re);
+      if (q->fft_plan.norm) {
+        srslte_vec_sc_prod_cfc(output, norm, output, q->nof_re);
+      }
+    } else if (q->fft_plan.norm) {
+      // Normalize while doing the FFT shift
+      srslte_vec_sc_prod_cfc(neg, norm, output, half_re);
+      srslte_vec_sc_prod_cfc(pos, norm, output + half_re, half_re);
+    } else {
+      // Perform FFT shift
+      memcpy(output, neg, sizeof(cf_t) * half_re);
+      memcpy(output + half_re, pos, sizeof(cf_t) * half_re);
+    }
+
+    tmp += symbol_sz;
+    output += q->nof_re;
+  }
+}
+#endif /* AVOID_GURU */
+
 /* Transforms input samples into output OFDM symbols.
  * Performs FFT on a each symbol and removes CP.
  */
@@ -395,34 +535,25 @@ static void ofdm_rx_slot(srslte_ofdm_t* q, int slot_in_sf)
   srslte_ofdm_rx_slot_ng(
       q, q->cfg.in_buffer + slot_in_sf * q->slot_sz, q->cfg.out_buffer + slot_in_sf * q->nof_re * q->nof_symbols);
 #else
-  uint32_t nof_symbols = q->nof_symbols;
-  uint32_t nof_re = q->nof_re;
-  cf_t* output = q->cfg.out_buffer + slot_in_sf * nof_re * nof_symbols;
-  uint32_t symbol_sz = q->cfg.symbol_sz;
-  float norm = 1.0f / sqrtf(q->fft_plan.size);
-  cf_t* tmp = q->tmp;
-  uint32_t dc = (q->fft_plan.dc) ? 1 : 0;
-
   srslte_dft_run_guru_c(&q->fft_plan_sf[slot_in_sf]);
 
-  for (int i = 0; i < q->nof_symbols; i++) {
-    // Apply frequency domain window offset
-    if (q->window_offset_n) {
-      srslte_vec_prod_ccc(tmp, q->window_offset_buffer, tmp, symbol_sz);
-    }
-
-    // Perform FFT shift
-    memcpy(output, tmp + symbol_sz - nof_re / 2, sizeof(cf_t) * nof_re / 2);
-    memcpy(output + nof_re / 2, &tmp[dc], sizeof(cf_t) * nof_re / 2);
-
-    // Normalize output
-    if (q->fft_plan.norm) {
-      srslte_vec_sc_prod_cfc(output, norm, output, nof_re);
-    }
+  ofdm_rx_symbols(q, q->tmp, q->cfg.out_buffer + slot_in_sf * q->nof_re * q->nof_symbols, q->nof_symbols);
+#endif
+}
 
-    tmp += symbol_sz;
-    output += nof_re;
+/* Transforms a whole subframe of input samples into output OFDM symbols.
+ * All the symbols are transformed by a single DFT execution followed by a single post-processing pass.
+ */
+static void ofdm_rx_sf_batch(srslte_ofdm_t* q)
+{
+#ifdef AVOID_GURU
+  for (uint32_t n = 0; n < SRSLTE_NOF_SLOTS_PER_SF; n++) {
+    ofdm_rx_slot(q, n);
   }
+#else
+  srslte_dft_run_guru_c(&q->fft_plan_sf_batch);
+
+  ofdm_rx_symbols(q, q->tmp, q->cfg.out_buffer, q->nof_symbols * SRSLTE_NOF_SLOTS_PER_SF);
 #endif
 }
 
@@ -461,15 +592,41 @@ void srslte_ofdm_rx_sf(srslte_ofdm_t* q)
     srslte_vec_prod_ccc(q->cfg.in_buffer, q->shift_buffer, q->cfg.in_buffer, q->sf_sz);
   }
   if (!q->mbsfn_subframe) {
-    for (uint32_t n = 0; n < SRSLTE_NOF_SLOTS_PER_SF; n++) {
-      ofdm_rx_slot(q, n);
-    }
+    ofdm_rx_sf_batch(q);
   } else {
     ofdm_rx_slot_mbsfn(q, q->cfg.in_buffer, q->cfg.out_buffer);
     ofdm_rx_slot(q, 1);
   }
 }
 
+void srslte_ofdm_rx_sf_s(srslte_ofdm_t* q, const int16_t* input, float scale)
+{
+  uint32_t    symbol_sz = q->cfg.symbol_sz;
+  srslte_cp_t cp        = q->cfg.cp;
+  cf_t*       in_buffer = q->cfg.in_buffer;
+
+#ifndef AVOID_GURU
+  if (!isnormal(q->cfg.freq_shift_f) && !q->mbsfn_subframe) {
+    // Convert only the DFT windows, the cyclic prefix samples are never read by the batched plan
+    for (uint32_t n = 0; n < SRSLTE_NOF_SLOTS_PER_SF; n++) {
+      uint32_t offset = n * q->slot_sz;
+      for (uint32_t i = 0; i < q->nof_symbols; i++) {
+        offset += SRSLTE_CP_ISNORM(cp) ? SRSLTE_CP_LEN_NORM(i, symbol_sz) : SRSLTE_CP_LEN_EXT(symbol_sz);
+        uint32_t start = offset - q->window_offset_n;
+        srslte_vec_convert_if(&input[2 * start], scale, (float*)&in_buffer[start], 2 * symbol_sz);
+        offset += symbol_sz;
+      }
+    }
+    ofdm_rx_sf_batch(q);
+    return;
+  }
+#endif /* AVOID_GURU */
+
+  // Otherwise the whole subframe is needed
+  srslte_vec_convert_if(input, scale, (float*)in_buffer, 2 * q->sf_sz);
+  srslte_ofdm_rx_sf(q);
+}
+
 void srslte_ofdm_rx_sf_ng(srslte_ofdm_t* q, cf_t* input, cf_t* output)
 {
   uint32_t n;
@@ -486,18 +643,73 @@ void srslte_ofdm_rx_sf_ng(srslte_ofdm_t* q, cf_t* input, cf_t* output)
   }
 }
 
+#ifndef AVOID_GURU
+/* Maps nof_symbols consecutive OFDM symbols of used subcarriers into the inverse-DFT input tmp (FFT shift) */
+static void ofdm_tx_map_symbols(srslte_ofdm_t* q, const cf_t* input, cf_t* tmp, uint32_t nof_symbols)
+{
+  uint32_t symbol_sz = q->cfg.symbol_sz;
+  uint32_t nof_re    = q->nof_re;
+  uint32_t dc        = (q->fft_plan.dc) ? 1 : 0;
+
+  for (uint32_t i = 0; i < nof_symbols; i++) {
+    memcpy(&tmp[dc], &input[nof_re / 2], nof_re / 2 * sizeof(cf_t));
+    memcpy(&tmp[symbol_sz - nof_re / 2], &input[0], nof_re / 2 * sizeof(cf_t));
+
+    input += nof_re;
+    tmp += symbol_sz;
+  }
+}
+
+/* Zeroes the DC and guard subcarriers of nof_symbols consecutive inverse-DFT inputs, which ofdm_tx_map_symbols() does
+ * not write. The unshifted MBSFN path writes data into them */
+static void ofdm_tx_zero_guards(srslte_ofdm_t* q, cf_t* tmp, uint32_t nof_symbols)
+{
+  uint32_t symbol_sz = q->cfg.symbol_sz;
+  uint32_t nof_re    = q->nof_re;
+  uint32_t dc        = (q->fft_plan.dc) ? 1 : 0;
+
+  for (uint32_t i = 0; i < nof_symbols; i++) {
+    if (dc) {
+      tmp[0] = 0.0f;
+    }
+    srslte_vec_cf_zero(&tmp[dc + nof_re / 2], symbol_sz - nof_re - dc);
+    tmp += symbol_sz;
+  }
+}
+
+/* Normalizes the inverse-DFT outputs of one slot and adds their CP */
+static void ofdm_tx_add_cp(srslte_ofdm_t* q, cf_t* output)
+{
+  uint32_t    symbol_sz = q->cfg.symbol_sz;
+  srslte_cp_t cp        = q->cfg.cp;
+  float       norm      = 1.0f / sqrtf(symbol_sz);
+
+  for (uint32_t i = 0; i < q->nof_symbols; i++) {
+    int cp_len = SRSLTE_CP_ISNORM(cp) ? SRSLTE_CP_LEN_NORM(i, symbol_sz) : SRSLTE_CP_LEN_EXT(symbol_sz);
+
+    if (q->fft_plan.norm) {
+      srslte_vec_sc_prod_cfc(&output[cp_len], norm, &output[cp_len], symbol_sz);
+    }
+
+    /* add CP */
+    memcpy(output, &output[symbol_sz], cp_len * sizeof(cf_t));
+    output += symbol_sz + cp_len;
+  }
+}
+#endif /* AVOID_GURU */
+
 /* Transforms input OFDM symbols into output samples.
  * Performs FFT on a each symbol and adds CP.
  */
 static void ofdm_tx_slot(srslte_ofdm_t* q, int slot_in_sf)
 {
-  uint32_t    symbol_sz = q->cfg.symbol_sz;
-  srslte_cp_t cp        = q->cfg.cp;
-
   cf_t* input  = q->cfg.in_buffer + slot_in_sf * q->nof_re * q->nof_symbols;
   cf_t* output = q->cfg.out_buffer + slot_in_sf * q->slot_sz;
 
 #ifdef AVOID_GURU
+  uint32_t    symbol_sz = q->cfg.symbol_sz;
+  srslte_cp_t cp        = q->cfg.cp;
+
   for (int i = 0; i < q->nof_symbols; i++) {
     int cp_len = SRSLTE_CP_ISNORM(cp) ? SRSLTE_CP_LEN_NORM(i, symbol_sz) : SRSLTE_CP_LEN_EXT(symbol_sz);
     memcpy(&q->tmp[q->nof_guards], input, q->nof_re * sizeof(cf_t));
@@ -508,34 +720,30 @@ static void ofdm_tx_slot(srslte_ofdm_t* q, int slot_in_sf)
     output += symbol_sz + cp_len;
   }
 #else
-  uint32_t nof_symbols = q->nof_symbols;
-  uint32_t nof_re = q->nof_re;
-  float norm = 1.0f / sqrtf(symbol_sz);
-  cf_t* tmp = q->tmp;
+  ofdm_tx_zero_guards(q, q->tmp, q->nof_symbols);
+  ofdm_tx_map_symbols(q, input, q->tmp, q->nof_symbols);
 
-  bzero(tmp, q->slot_sz);
-  uint32_t dc = (q->fft_plan.dc) ? 1 : 0;
+  srslte_dft_run_guru_c(&q->fft_plan_sf[slot_in_sf]);
 
-  for (int i = 0; i < nof_symbols; i++) {
-    memcpy(&tmp[dc], &input[nof_re / 2], nof_re / 2 * sizeof(cf_t));
-    memcpy(&tmp[symbol_sz - nof_re / 2], &input[0], nof_re / 2 * sizeof(cf_t));
+  ofdm_tx_add_cp(q, output);
+#endif
+}
 
-    input += nof_re;
-    tmp += symbol_sz;
+/* Transforms a whole subframe of input OFDM symbols into output samples using a single inverse-DFT execution */
+static void ofdm_tx_sf_batch(srslte_ofdm_t* q)
+{
+#ifdef AVOID_GURU
+  for (uint32_t n = 0; n < SRSLTE_NOF_SLOTS_PER_SF; n++) {
+    ofdm_tx_slot(q, n);
   }
+#else
+  ofdm_tx_zero_guards(q, q->tmp, q->nof_symbols * SRSLTE_NOF_SLOTS_PER_SF);
+  ofdm_tx_map_symbols(q, q->cfg.in_buffer, q->tmp, q->nof_symbols * SRSLTE_NOF_SLOTS_PER_SF);
 
-  srslte_dft_run_guru_c(&q->fft_plan_sf[slot_in_sf]);
-
-  for (int i = 0; i < nof_symbols; i++) {
-    int cp_len = SRSLTE_CP_ISNORM(cp) ? SRSLTE_CP_LEN_NORM(i, symbol_sz) : SRSLTE_CP_LEN_EXT(symbol_sz);
-
-    if (q->fft_plan.norm) {
-      srslte_vec_sc_prod_cfc(&output[cp_len], norm, &output[cp_len], symbol_sz);
-    }
+  srslte_dft_run_guru_c(&q->fft_plan_sf_batch);
 
-    /* add CP */
-    memcpy(output, &output[symbol_sz], cp_len * sizeof(cf_t));
-    output += symbol_sz + cp_len;
+  for (uint32_t n = 0; n < SRSLTE_NOF_SLOTS_PER_SF; n++) {
+    ofdm_tx_add_cp(q, q->cfg.out_buffer + n * q->slot_sz);
   }
 #endif
 }
@@ -566,11 +774,8 @@ void srslte_ofdm_set_normalize(srslte_ofdm_t* q, bool normalize_enable)
 
 void srslte_ofdm_tx_sf(srslte_ofdm_t* q)
 {
-  uint32_t n;
   if (!q->mbsfn_subframe) {
-    for (n = 0; n < SRSLTE_NOF_SLOTS_PER_SF; n++) {
-      ofdm_tx_slot(q, n);
-    }
+    ofdm_tx_sf_batch(q);
   } else {
     ofdm_tx_slot_mbsfn(q, q->cfg.in_buffer, q->cfg.out_buffer);
     ofdm_tx_slot(q, 1);
@@ -0,0 +1,275 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "srslte/phy/utils/random.h"
+#include "srslte/srslte.h"
+
+#define MAX_BACKENDS 4
+#define MAX_ERROR 1e-4
+
+static const char* backend = NULL;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s\n", prog);
+  printf("\t-b DFT backend [Default all available]\n");
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "b")) != -1) {
+    switch (opt) {
+      case 'b':
+        backend = argv[optind];
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+// Reference DFT in double precision
+static void naive_dft(const cf_t* in, cf_t* out, int n, bool forward)
+{
+  double sign = forward ? -1.0 : 1.0;
+  for (int k = 0; k < n; k++) {
+    double complex acc = 0;
+    for (int t = 0; t < n; t++) {
+      acc += in[t] * cexp(sign * 2.0 * M_PI * I * (double)(((long)k * t) % n) / n);
+    }
+    out[k] = (cf_t)acc;
+  }
+}
+
+// Normalised error of x against the reference y
+static float dft_error(const cf_t* x, const cf_t* y, int n)
+{
+  double err = 0, pwr = 0;
+  for (int i = 0; i < n; i++) {
+    err += pow(cabsf(x[i] - y[i]), 2);
+    pwr += pow(cabsf(y[i]), 2);
+  }
+  return (float)sqrt(err / pwr);
+}
+
+static int test_dft_c(srslte_random_t random_gen, int n, bool forward, bool mirror, bool norm)
+{
+  int                ret  = SRSLTE_ERROR;
+  srslte_dft_plan_t  plan = {};
+  cf_t*              in   = srslte_vec_cf_malloc(n);
+  cf_t*              out  = srslte_vec_cf_malloc(n);
+  cf_t*              ref  = srslte_vec_cf_malloc(n);
+  cf_t*              tmp  = srslte_vec_cf_malloc(n);
+  srslte_dft_dir_t   dir  = forward ? SRSLTE_DFT_FORWARD : SRSLTE_DFT_BACKWARD;
+
+  if (!in || !out || !ref || !tmp || srslte_dft_plan_c(&plan, n, dir)) {
+    goto clean_exit;
+  }
+  srslte_dft_plan_set_mirror(&plan, mirror);
+  srslte_dft_plan_set_norm(&plan, norm);
+
+  srslte_random_uniform_complex_dist_vector(random_gen, in, n, -1.0f, +1.0f);
+  srslte_dft_run_c(&plan, in, out);
+
+  // Mirror swaps after forward transforms and before backward ones
+  if (mirror && !forward) {
+    srslte_vec_cf_copy(tmp, &in[n / 2], n - n / 2);
+    srslte_vec_cf_copy(&tmp[n - n / 2], in, n / 2);
+    naive_dft(tmp, ref, n, forward);
+  } else {
+    naive_dft(in, tmp, n, forward);
+    if (mirror) {
+      srslte_vec_cf_copy(ref, &tmp[(n + 1) / 2], n / 2);
+      srslte_vec_cf_copy(&ref[n / 2], tmp, (n + 1) / 2);
+    } else {
+      srslte_vec_cf_copy(ref, tmp, n);
+    }
+  }
+  if (norm) {
+    srslte_vec_sc_prod_cfc(ref, 1.0f / sqrtf(n), ref, n);
+  }
+
+  float err = dft_error(out, ref, n);
+  if (err > MAX_ERROR) {
+    printf("Error %d-point %s DFT mirror=%d norm=%d: %e\n", n, forward ? "forward" : "backward", mirror, norm, err);
+  } else {
+    ret = SRSLTE_SUCCESS;
+  }
+
+clean_exit:
+  srslte_dft_plan_free(&plan);
+  free(in);
+  free(out);
+  free(ref);
+  free(tmp);
+  return ret;
+}
+
+// Zero-padded batch of 2 x 3 transforms laid out like an OFDM subframe
+static int test_dft_guru(srslte_random_t random_gen, int n, bool forward)
+{
+  int               ret      = SRSLTE_ERROR;
+  srslte_dft_plan_t plan     = {};
+  int               nof_in   = 3;
+  int               nof_out  = 2;
+  int               idist    = n + 3;
+  int               idist_o  = nof_in * idist + 5;
+  int               len      = nof_out * idist_o;
+  cf_t*             in       = srslte_vec_cf_malloc(len);
+  cf_t*             out      = srslte_vec_cf_malloc(len);
+  cf_t*             ref      = srslte_vec_cf_malloc(n);
+  srslte_dft_dir_t  dir      = forward ? SRSLTE_DFT_FORWARD : SRSLTE_DFT_BACKWARD;
+
+  if (!in || !out || !ref) {
+    goto clean_exit;
+  }
+  srslte_random_uniform_complex_dist_vector(random_gen, in, len, -1.0f, +1.0f);
+  srslte_vec_cf_zero(out, len);
+
+  if (srslte_dft_plan_guru_batch_c(&plan, n, dir, in, out, 1, 1, nof_in, idist, idist, nof_out, idist_o, idist_o)) {
+    goto clean_exit;
+  }
+  srslte_dft_run_guru_c(&plan);
+
+  ret = SRSLTE_SUCCESS;
+  for (int i = 0; i < nof_out && ret == SRSLTE_SUCCESS; i++) {
+    for (int j = 0; j < nof_in && ret == SRSLTE_SUCCESS; j++) {
+      int offset = i * idist_o + j * idist;
+      naive_dft(&in[offset], ref, n, forward);
+      float err = dft_error(&out[offset], ref, n);
+      if (err > MAX_ERROR) {
+        printf("Error %d-point guru DFT batch %d,%d: %e\n", n, i, j, err);
+        ret = SRSLTE_ERROR;
+      }
+    }
+  }
+
+clean_exit:
+  srslte_dft_plan_free(&plan);
+  free(in);
+  free(out);
+  free(ref);
+  return ret;
+}
+
+// Forward real transform against the reference and round trip through the backward transform
+static int test_dft_r(srslte_random_t random_gen, int n)
+{
+  int               ret  = SRSLTE_ERROR;
+  srslte_dft_plan_t fwd  = {};
+  srslte_dft_plan_t bwd  = {};
+  float*            in   = srslte_vec_f_malloc(n);
+  float*            hc   = srslte_vec_f_malloc(n);
+  float*            out  = srslte_vec_f_malloc(n);
+  cf_t*             x    = srslte_vec_cf_malloc(n);
+  cf_t*             ref  = srslte_vec_cf_malloc(n);
+
+  if (!in || !hc || !out || !x || !ref || srslte_dft_plan_r(&fwd, n, SRSLTE_DFT_FORWARD) ||
+      srslte_dft_plan_r(&bwd, n, SRSLTE_DFT_BACKWARD)) {
+    goto clean_exit;
+  }
+  for (int i = 0; i < n; i++) {
+    in[i] = srslte_random_uniform_real_dist(random_gen, -1.0f, +1.0f);
+    x[i]  = in[i];
+  }
+  srslte_dft_run_r(&fwd, in, hc);
+  srslte_dft_plan_set_norm(&bwd, true);
+  srslte_dft_run_r(&bwd, hc, out);
+
+  // Half-complex layout r0, r1, ..., r(n/2), i((n+1)/2-1), ..., i1
+  naive_dft(x, ref, n, true);
+  for (int k = 0; k < n; k++) {
+    x[k] = (k <= n / 2) ? hc[k] + I * ((k > 0 && k < (n + 1) / 2) ? hc[n - k] : 0.0f) : conjf(x[n - k]);
+  }
+  float err = dft_error(x, ref, n);
+  for (int i = 0; i < n; i++) {
+    x[i]   = out[i];
+    ref[i] = in[i];
+  }
+  float err_rt = dft_error(x, ref, n);
+  if (err > MAX_ERROR || err_rt > MAX_ERROR) {
+    printf("Error %d-point real DFT: %e, round trip %e\n", n, err, err_rt);
+  } else {
+    ret = SRSLTE_SUCCESS;
+  }
+
+clean_exit:
+  srslte_dft_plan_free(&fwd);
+  srslte_dft_plan_free(&bwd);
+  free(in);
+  free(hc);
+  free(out);
+  free(x);
+  free(ref);
+  return ret;
+}
+
+int main(int argc, char** argv)
+{
+  const int       sizes[]    = {1, 12, 64, 128, 300, 384, 1024, 1200, 1536};
+  const char*     backends[MAX_BACKENDS];
+  uint32_t        nof_backends;
+  srslte_random_t random_gen = srslte_random_init(0);
+  int             ret        = SRSLTE_SUCCESS;
+
+  parse_args(argc, argv);
+
+  if (backend) {
+    backends[0]  = backend;
+    nof_backends = 1;
+  } else {
+    nof_backends = SRSLTE_MIN(srslte_dft_get_available_backends(backends, MAX_BACKENDS), MAX_BACKENDS);
+  }
+
+  for (uint32_t b = 0; b < nof_backends; b++) {
+    if (srslte_dft_set_backend(backends[b])) {
+      exit(-1);
+    }
+    printf("Testing DFT backend %s... ", backends[b]);
+    fflush(stdout);
+
+    for (uint32_t s = 0; s < sizeof(sizes) / sizeof(int); s++) {
+      int n = sizes[s];
+      for (int i = 0; i < 8; i++) {
+        if (test_dft_c(random_gen, n, i & 1, (i >> 1) & 1, (i >> 2) & 1)) {
+          ret = SRSLTE_ERROR;
+        }
+      }
+      if (test_dft_guru(random_gen, n, true) || test_dft_guru(random_gen, n, false) || test_dft_r(random_gen, n)) {
+        ret = SRSLTE_ERROR;
+      }
+    }
+    printf("%s\n", ret ? "Error" : "Ok");
+  }
+
+  srslte_random_free(random_gen);
+
+  exit(ret);
+}
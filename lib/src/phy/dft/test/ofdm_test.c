@@ -35,6 +35,10 @@ static int         nof_repetitions  = 1;
 static float       rx_window_offset = 0.5f;
 static float       freq_shift_f     = 0.0f;
 static uint32_t    force_symbol_sz  = 0;
+
+// Headroom of the int16 samples over their RMS value for the OFDM peak to average power ratio
+#define INT16_HEADROOM 8.0f
+
 static double      elapsed_us(struct timeval* ts_start, struct timeval* ts_end)
 {
   if (ts_end->tv_usec > ts_start->tv_usec) {
@@ -92,7 +96,8 @@ int main(int argc, char** argv)
   srslte_random_t random_gen = srslte_random_init(0);
   struct timeval  start, end;
   srslte_ofdm_t   fft = {}, ifft = {};
-  cf_t *          input, *outfft, *outifft;
+  cf_t *          input, *outfft, *outifft, *outifft_ref;
+  int16_t*        outifft_s;
   float           mse;
   uint32_t        n_prb, max_prb;
 
@@ -113,10 +118,12 @@ int main(int argc, char** argv)
     printf("Running test for %d PRB, %d RE... ", n_prb, n_re);
     fflush(stdout);
 
-    input   = srslte_vec_cf_malloc(n_re);
-    outfft  = srslte_vec_cf_malloc(n_re);
-    outifft = srslte_vec_cf_malloc(sf_len);
-    if (!input || !outfft || !outifft) {
+    input       = srslte_vec_cf_malloc(n_re);
+    outfft      = srslte_vec_cf_malloc(n_re);
+    outifft     = srslte_vec_cf_malloc(sf_len);
+    outifft_s   = srslte_vec_i16_malloc(2 * sf_len);
+    outifft_ref = srslte_vec_cf_malloc(sf_len);
+    if (!input || !outfft || !outifft || !outifft_s || !outifft_ref) {
       perror("malloc");
       exit(-1);
     }
@@ -159,6 +166,11 @@ int main(int argc, char** argv)
     gettimeofday(&end, NULL);
     printf(" Tx@%.1fMsps", (float)(sf_len * nof_repetitions) / elapsed_us(&start, &end));
 
+    // Keep an int16 copy of the transmitted subframe, the float Rx may modify its input. The scale follows the signal
+    // level, which decreases with the DFT size
+    float int16_scale = INT16_MAX / (INT16_HEADROOM * sqrtf(srslte_vec_avg_power_cf(outifft, sf_len)));
+    srslte_vec_convert_fi((float*)outifft, int16_scale, outifft_s, 2 * sf_len);
+
     // Execute Rx
     gettimeofday(&start, NULL);
     for (uint32_t i = 0; i < nof_repetitions; i++) {
@@ -171,19 +183,54 @@ int main(int argc, char** argv)
     srslte_vec_sub_ccc(input, outfft, outfft, n_re);
     mse = sqrtf(srslte_vec_avg_power_cf(outfft, n_re));
 
-    printf(" MSE=%.6f\n", mse);
+    printf(" MSE=%.6f", mse);
 
     if (mse >= 0.0001) {
+      printf("\nMSE too large\n");
+      exit(-1);
+    }
+
+    // Execute Rx from int16 samples
+    gettimeofday(&start, NULL);
+    for (uint32_t i = 0; i < nof_repetitions; i++) {
+      srslte_ofdm_rx_sf_s(&fft, outifft_s, int16_scale);
+    }
+    gettimeofday(&end, NULL);
+    printf(" Rx(int16)@%.1fMsps", (double)(sf_len * nof_repetitions) / elapsed_us(&start, &end));
+
+    srslte_vec_sub_ccc(input, outfft, outfft, n_re);
+    mse = sqrtf(srslte_vec_avg_power_cf(outfft, n_re));
+
+    printf(" MSE=%.6f\n", mse);
+
+    if (mse >= 0.001) {
       printf("MSE too large\n");
       exit(-1);
     }
 
+    // A MBSFN subframe must not leave data in the guard subcarriers of the following normal subframes
+    if (SRSLTE_CP_ISNORM(cp)) {
+      srslte_ofdm_tx_sf(&ifft);
+      srslte_vec_cf_copy(outifft_ref, outifft, sf_len);
+      srslte_ofdm_set_non_mbsfn_region(&ifft, 2);
+      ifft.mbsfn_subframe = true;
+      srslte_ofdm_tx_sf(&ifft);
+      ifft.mbsfn_subframe = false;
+      srslte_ofdm_tx_sf(&ifft);
+      if (memcmp(outifft_ref, outifft, sf_len * sizeof(cf_t)) != 0) {
+        printf("Subframe after MBSFN subframe does not match\n");
+        exit(-1);
+      }
+    }
+
     srslte_ofdm_rx_free(&fft);
     srslte_ofdm_tx_free(&ifft);
 
     free(input);
     free(outfft);
     free(outifft);
+    free(outifft_s);
+    free(outifft_ref);
 
     n_prb++;
   }
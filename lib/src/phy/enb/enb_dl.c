@@ -28,12 +28,41 @@
 
 #define CURRENT_FFTSIZE srslte_symbol_sz(q->cell.nof_prb)
 #define CURRENT_SFLEN_RE SRSLTE_NOF_RE(q->cell)
+#define CURRENT_SYMBOL_RE (SRSLTE_NRE * q->cell.nof_prb)
+
+static void clear_sf(srslte_enb_dl_t* q);
+static void put_sync(srslte_enb_dl_t* q, uint32_t sf_idx, cf_t* sf_symbols[SRSLTE_MAX_PORTS]);
+static void put_refs(srslte_enb_dl_t* q, srslte_dl_sf_cfg_t* dl_sf, cf_t* sf_symbols[SRSLTE_MAX_PORTS]);
 
 static float enb_dl_get_norm_factor(uint32_t nof_prb)
 {
   return 0.05f / sqrtf(nof_prb);
 }
 
+static void enb_dl_ofdm_cfg(srslte_ofdm_cfg_t* ofdm_cfg, uint32_t max_prb)
+{
+  ofdm_cfg->nof_prb   = max_prb;
+  ofdm_cfg->cp        = SRSLTE_CP_NORM;
+  ofdm_cfg->normalize = false;
+}
+
+int srslte_enb_dl_preplan(uint32_t max_prb)
+{
+  srslte_ofdm_cfg_t ofdm_cfg = {};
+  enb_dl_ofdm_cfg(&ofdm_cfg, max_prb);
+
+  // The iFFTs are initialised with normal CP and later resized to the cell CP, MBSFN always uses extended CP
+  for (uint32_t i = 0; i < 2; i++) {
+    ofdm_cfg.cp = (i == 0) ? SRSLTE_CP_NORM : SRSLTE_CP_EXT;
+    if (srslte_ofdm_tx_preplan(&ofdm_cfg)) {
+      ERROR("Error planning iFFT\n");
+      return SRSLTE_ERROR;
+    }
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
 int srslte_enb_dl_init(srslte_enb_dl_t* q, cf_t* out_buffer[SRSLTE_MAX_PORTS], uint32_t max_prb)
 {
   int ret = SRSLTE_ERROR_INVALID_INPUTS;
@@ -43,6 +72,8 @@ int srslte_enb_dl_init(srslte_enb_dl_t* q, cf_t* out_buffer[SRSLTE_MAX_PORTS], u
 
     bzero(q, sizeof(srslte_enb_dl_t));
 
+    q->max_prb = max_prb;
+
     for (int i = 0; i < SRSLTE_MAX_PORTS; i++) {
       q->sf_symbols[i] = srslte_vec_cf_malloc(SRSLTE_SF_LEN_RE(max_prb, SRSLTE_CP_NORM));
       if (!q->sf_symbols[i]) {
@@ -52,9 +83,7 @@ int srslte_enb_dl_init(srslte_enb_dl_t* q, cf_t* out_buffer[SRSLTE_MAX_PORTS], u
     }
 
     srslte_ofdm_cfg_t ofdm_cfg = {};
-    ofdm_cfg.nof_prb           = max_prb;
-    ofdm_cfg.cp                = SRSLTE_CP_NORM;
-    ofdm_cfg.normalize         = false;
+    enb_dl_ofdm_cfg(&ofdm_cfg, max_prb);
     for (int i = 0; i < SRSLTE_MAX_PORTS; i++) {
       ofdm_cfg.in_buffer  = q->sf_symbols[i];
       ofdm_cfg.out_buffer = out_buffer[i];
@@ -124,6 +153,88 @@ clean_exit:
   return ret;
 }
 
+static void free_templates(srslte_enb_dl_t* q)
+{
+  for (uint32_t sf_idx = 0; sf_idx < SRSLTE_NOF_SF_X_FRAME; sf_idx++) {
+    for (uint32_t p = 0; p < SRSLTE_MAX_PORTS; p++) {
+      if (q->sf_template[sf_idx][p]) {
+        free(q->sf_template[sf_idx][p]);
+        q->sf_template[sf_idx][p] = NULL;
+      }
+      for (uint32_t i = 0; i < 3; i++) {
+        if (q->symbol0_template[sf_idx][i][p]) {
+          free(q->symbol0_template[sf_idx][i][p]);
+          q->symbol0_template[sf_idx][i][p] = NULL;
+        }
+      }
+    }
+  }
+}
+
+/* Renders the signals that only depend on the cell and the subframe index, srslte_enb_dl_put_base() copies them
+ * instead of generating them in every TTI. Only the OFDM symbols that hold them are kept, zeroing the other symbols
+ * is cheaper than copying them. The PBCH changes with the SFN and is still encoded in every frame */
+static int build_templates(srslte_enb_dl_t* q)
+{
+  free_templates(q);
+
+  uint32_t           nof_symbols = SRSLTE_CP_NSYMB(q->cell.cp) * 2;
+  srslte_dl_sf_cfg_t dl_sf       = {};
+  dl_sf.sf_type                  = SRSLTE_SF_NORM;
+  for (uint32_t sf_idx = 0; sf_idx < SRSLTE_NOF_SF_X_FRAME; sf_idx++) {
+    // Render the whole subframe in the grid and keep the symbols that are not empty
+    dl_sf.tti = sf_idx;
+    clear_sf(q);
+    put_sync(q, sf_idx, q->sf_symbols);
+    put_refs(q, &dl_sf, q->sf_symbols);
+
+    uint32_t nof_static         = 0;
+    q->sf_template_mask[sf_idx] = 0;
+    for (uint32_t l = 1; l < nof_symbols; l++) {
+      for (uint32_t p = 0; p < q->cell.nof_ports; p++) {
+        if (srslte_vec_avg_power_cf(&q->sf_symbols[p][l * CURRENT_SYMBOL_RE], CURRENT_SYMBOL_RE) > 0) {
+          q->sf_template_mask[sf_idx] |= (1U << l);
+        }
+      }
+      nof_static += (q->sf_template_mask[sf_idx] >> l) & 1U;
+    }
+
+    for (uint32_t p = 0; p < q->cell.nof_ports; p++) {
+      q->sf_template[sf_idx][p] = srslte_vec_cf_malloc(SRSLTE_MAX(nof_static, 1) * CURRENT_SYMBOL_RE);
+      if (!q->sf_template[sf_idx][p]) {
+        perror("malloc");
+        return SRSLTE_ERROR;
+      }
+      cf_t* t = q->sf_template[sf_idx][p];
+      for (uint32_t l = 1; l < nof_symbols; l++) {
+        if (q->sf_template_mask[sf_idx] & (1U << l)) {
+          srslte_vec_cf_copy(t, &q->sf_symbols[p][l * CURRENT_SYMBOL_RE], CURRENT_SYMBOL_RE);
+          t += CURRENT_SYMBOL_RE;
+        }
+      }
+    }
+
+    // The PCFICH is in the first symbol, which also has CRS
+    for (uint32_t cfi = 1; cfi <= 3; cfi++) {
+      cf_t** symbol0 = q->symbol0_template[sf_idx][SRSLTE_CFI_IDX(cfi)];
+      for (uint32_t p = 0; p < q->cell.nof_ports; p++) {
+        symbol0[p] = srslte_vec_cf_malloc(CURRENT_SYMBOL_RE);
+        if (!symbol0[p]) {
+          perror("malloc");
+          return SRSLTE_ERROR;
+        }
+        srslte_vec_cf_copy(symbol0[p], q->sf_symbols[p], CURRENT_SYMBOL_RE);
+      }
+      dl_sf.cfi = cfi;
+      if (srslte_pcfich_encode(&q->pcfich, &dl_sf, symbol0)) {
+        ERROR("Error encoding the PCFICH template\n");
+        return SRSLTE_ERROR;
+      }
+    }
+  }
+  return SRSLTE_SUCCESS;
+}
+
 void srslte_enb_dl_free(srslte_enb_dl_t* q)
 {
   if (q) {
@@ -137,6 +248,12 @@ void srslte_enb_dl_free(srslte_enb_dl_t* q)
     srslte_phich_free(&q->phich);
     srslte_pdcch_free(&q->pdcch);
     srslte_pdsch_free(&q->pdsch);
+    if (q->pdsch_tx) {
+      for (uint32_t i = 0; i < q->nof_pdsch_tx; i++) {
+        srslte_pdsch_free(&q->pdsch_tx[i]);
+      }
+      free(q->pdsch_tx);
+    }
     srslte_pmch_free(&q->pmch);
     srslte_refsignal_free(&q->csr_signal);
     srslte_refsignal_free(&q->mbsfnr_signal);
@@ -145,10 +262,38 @@ void srslte_enb_dl_free(srslte_enb_dl_t* q)
         free(q->sf_symbols[i]);
       }
     }
+    free_templates(q);
     bzero(q, sizeof(srslte_enb_dl_t));
   }
 }
 
+int srslte_enb_dl_add_pdsch_tx(srslte_enb_dl_t* q, uint32_t nof_pdsch_tx)
+{
+  if (q == NULL || q->pdsch_tx != NULL || q->cell.nof_prb != 0) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  if (nof_pdsch_tx == 0) {
+    return SRSLTE_SUCCESS;
+  }
+
+  q->pdsch_tx = calloc(nof_pdsch_tx, sizeof(srslte_pdsch_t));
+  if (!q->pdsch_tx) {
+    perror("calloc");
+    return SRSLTE_ERROR;
+  }
+  q->nof_pdsch_tx = nof_pdsch_tx;
+
+  for (uint32_t i = 0; i < nof_pdsch_tx; i++) {
+    if (srslte_pdsch_init_enb(&q->pdsch_tx[i], q->max_prb)) {
+      ERROR("Error creating PDSCH object\n");
+      return SRSLTE_ERROR;
+    }
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
 int srslte_enb_dl_set_cell(srslte_enb_dl_t* q, srslte_cell_t cell)
 {
   int ret = SRSLTE_ERROR_INVALID_INPUTS;
@@ -199,6 +344,12 @@ int srslte_enb_dl_set_cell(srslte_enb_dl_t* q, srslte_cell_t cell)
         ERROR("Error creating PDSCH object\n");
         return SRSLTE_ERROR;
       }
+      for (uint32_t i = 0; i < q->nof_pdsch_tx; i++) {
+        if (srslte_pdsch_set_cell(&q->pdsch_tx[i], q->cell)) {
+          ERROR("Error creating PDSCH object\n");
+          return SRSLTE_ERROR;
+        }
+      }
 
       if (srslte_pmch_set_cell(&q->pmch, q->cell)) {
         ERROR("Error creating PMCH object\n");
@@ -223,6 +374,12 @@ int srslte_enb_dl_set_cell(srslte_enb_dl_t* q, srslte_cell_t cell)
         q->nof_common_locations[SRSLTE_CFI_IDX(cfi)] = srslte_pdcch_common_locations(
             &q->pdcch, q->common_locations[SRSLTE_CFI_IDX(cfi)], SRSLTE_MAX_CANDIDATES_COM, cfi);
       }
+
+      if (build_templates(q)) {
+        free_templates(q);
+        ERROR("Error building the static signal templates\n");
+        return SRSLTE_ERROR;
+      }
     }
     ret = SRSLTE_SUCCESS;
 
@@ -234,12 +391,23 @@ int srslte_enb_dl_set_cell(srslte_enb_dl_t* q, srslte_cell_t cell)
 
 int srslte_enb_dl_add_rnti(srslte_enb_dl_t* q, uint16_t rnti)
 {
-  return srslte_pdsch_set_rnti(&q->pdsch, rnti);
+  if (srslte_pdsch_set_rnti(&q->pdsch, rnti)) {
+    return SRSLTE_ERROR;
+  }
+  for (uint32_t i = 0; i < q->nof_pdsch_tx; i++) {
+    if (srslte_pdsch_set_rnti(&q->pdsch_tx[i], rnti)) {
+      return SRSLTE_ERROR;
+    }
+  }
+  return SRSLTE_SUCCESS;
 }
 
 void srslte_enb_dl_rem_rnti(srslte_enb_dl_t* q, uint16_t rnti)
 {
   srslte_pdsch_free_rnti(&q->pdsch, rnti);
+  for (uint32_t i = 0; i < q->nof_pdsch_tx; i++) {
+    srslte_pdsch_free_rnti(&q->pdsch_tx[i], rnti);
+  }
 }
 
 #ifdef resolve
@@ -308,27 +476,43 @@ static void clear_sf(srslte_enb_dl_t* q)
   }
 }
 
-static void put_sync(srslte_enb_dl_t* q)
+static void put_sync(srslte_enb_dl_t* q, uint32_t sf_idx, cf_t* sf_symbols[SRSLTE_MAX_PORTS])
 {
-  uint32_t sf_idx = q->dl_sf.tti % 10;
-
   if (sf_idx == 0 || sf_idx == 5) {
     for (int p = 0; p < q->cell.nof_ports; p++) {
-      srslte_pss_put_slot(q->pss_signal, q->sf_symbols[p], q->cell.nof_prb, q->cell.cp);
-      srslte_sss_put_slot(sf_idx ? q->sss_signal5 : q->sss_signal0, q->sf_symbols[p], q->cell.nof_prb, q->cell.cp);
+      srslte_pss_put_slot(q->pss_signal, sf_symbols[p], q->cell.nof_prb, q->cell.cp);
+      srslte_sss_put_slot(sf_idx ? q->sss_signal5 : q->sss_signal0, sf_symbols[p], q->cell.nof_prb, q->cell.cp);
     }
   }
 }
 
-static void put_refs(srslte_enb_dl_t* q)
+static void put_refs(srslte_enb_dl_t* q, srslte_dl_sf_cfg_t* dl_sf, cf_t* sf_symbols[SRSLTE_MAX_PORTS])
 {
-  uint32_t sf_idx = q->dl_sf.tti % 10;
-  if (q->dl_sf.sf_type == SRSLTE_SF_MBSFN) {
+  uint32_t sf_idx = dl_sf->tti % 10;
+  if (dl_sf->sf_type == SRSLTE_SF_MBSFN) {
     srslte_refsignal_mbsfn_put_sf(
-        q->cell, 0, q->csr_signal.pilots[0][sf_idx], q->mbsfnr_signal.pilots[0][sf_idx], q->sf_symbols[0]);
+        q->cell, 0, q->csr_signal.pilots[0][sf_idx], q->mbsfnr_signal.pilots[0][sf_idx], sf_symbols[0]);
   } else {
     for (int p = 0; p < q->cell.nof_ports; p++) {
-      srslte_refsignal_cs_put_sf(&q->csr_signal, &q->dl_sf, (uint32_t)p, q->sf_symbols[p]);
+      srslte_refsignal_cs_put_sf(&q->csr_signal, dl_sf, (uint32_t)p, sf_symbols[p]);
+    }
+  }
+}
+
+static void put_templates(srslte_enb_dl_t* q, uint32_t sf_idx)
+{
+  uint32_t nof_symbols = SRSLTE_CP_NSYMB(q->cell.cp) * 2;
+  cf_t**   symbol0     = q->symbol0_template[sf_idx][SRSLTE_CFI_IDX(q->dl_sf.cfi)];
+  for (int p = 0; p < q->cell.nof_ports; p++) {
+    srslte_vec_cf_copy(q->sf_symbols[p], symbol0[p], CURRENT_SYMBOL_RE);
+    const cf_t* t = q->sf_template[sf_idx][p];
+    for (uint32_t l = 1; l < nof_symbols; l++) {
+      if (q->sf_template_mask[sf_idx] & (1U << l)) {
+        srslte_vec_cf_copy(&q->sf_symbols[p][l * CURRENT_SYMBOL_RE], t, CURRENT_SYMBOL_RE);
+        t += CURRENT_SYMBOL_RE;
+      } else {
+        srslte_vec_cf_zero(&q->sf_symbols[p][l * CURRENT_SYMBOL_RE], CURRENT_SYMBOL_RE);
+      }
     }
   }
 }
@@ -355,11 +539,19 @@ void srslte_enb_dl_put_base(srslte_enb_dl_t* q, srslte_dl_sf_cfg_t* dl_sf)
 {
   srslte_ofdm_set_non_mbsfn_region(&q->ifft_mbsfn, dl_sf->non_mbsfn_region);
   q->dl_sf = *dl_sf;
-  clear_sf(q);
-  put_sync(q);
-  put_refs(q);
+
+  // The templates hold the FDD subframes, the MBSFN and TDD subframes are generated
+  uint32_t sf_idx = q->dl_sf.tti % 10;
+  if (q->dl_sf.sf_type == SRSLTE_SF_NORM && !q->dl_sf.tdd_config.configured && SRSLTE_CFI_ISVALID(q->dl_sf.cfi) &&
+      q->sf_template[sf_idx][0] != NULL) {
+    put_templates(q, sf_idx);
+  } else {
+    clear_sf(q);
+    put_sync(q, sf_idx, q->sf_symbols);
+    put_refs(q, &q->dl_sf, q->sf_symbols);
+    put_pcfich(q);
+  }
   put_mib(q);
-  put_pcfich(q);
 }
 
 void srslte_enb_dl_put_phich(srslte_enb_dl_t* q, srslte_phich_grant_t* grant, bool ack)
@@ -369,6 +561,24 @@ void srslte_enb_dl_put_phich(srslte_enb_dl_t* q, srslte_phich_grant_t* grant, bo
   srslte_phich_encode(&q->phich, &q->dl_sf, resource, ack, q->sf_symbols);
 }
 
+int srslte_enb_dl_put_phich_batch(srslte_enb_dl_t*     q,
+                                  srslte_phich_grant_t grants[],
+                                  const uint8_t        acks[],
+                                  uint32_t             nof_acks)
+{
+  srslte_phich_resource_t resources[SRSLTE_PHICH_MAX_NGROUPS * SRSLTE_PHICH_NORM_NSEQUENCES];
+
+  if (nof_acks > SRSLTE_PHICH_MAX_NGROUPS * SRSLTE_PHICH_NORM_NSEQUENCES) {
+    ERROR("Too many PHICH acks (%d)\n", nof_acks);
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  for (uint32_t i = 0; i < nof_acks; i++) {
+    srslte_phich_calc(&q->phich, &grants[i], &resources[i]);
+  }
+  return srslte_phich_encode_batch(&q->phich, &q->dl_sf, resources, acks, nof_acks, q->sf_symbols);
+}
+
 bool srslte_enb_dl_location_is_common_ncce(srslte_enb_dl_t* q, uint32_t ncce)
 {
   if (SRSLTE_CFI_ISVALID(q->dl_sf.cfi)) {
@@ -379,14 +589,41 @@ bool srslte_enb_dl_location_is_common_ncce(srslte_enb_dl_t* q, uint32_t ncce)
   }
 }
 
-int srslte_enb_dl_put_pdcch_dl(srslte_enb_dl_t* q, srslte_dci_cfg_t* dci_cfg, srslte_dci_dl_t* dci_dl)
+int srslte_enb_dl_pack_pdcch_dl(srslte_enb_dl_t*  q,
+                                srslte_dci_cfg_t* dci_cfg,
+                                srslte_dci_dl_t*  dci_dl,
+                                srslte_dci_msg_t* dci_msg)
 {
-  srslte_dci_msg_t dci_msg;
-  ZERO_OBJECT(dci_msg);
+  ZERO_OBJECT(*dci_msg);
 
-  if (srslte_dci_msg_pack_pdsch(&q->cell, &q->dl_sf, dci_cfg, dci_dl, &dci_msg)) {
+  if (srslte_dci_msg_pack_pdsch(&q->cell, &q->dl_sf, dci_cfg, dci_dl, dci_msg)) {
     ERROR("Error packing DL DCI\n");
+    return SRSLTE_ERROR;
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+int srslte_enb_dl_pack_pdcch_ul(srslte_enb_dl_t*  q,
+                                srslte_dci_cfg_t* dci_cfg,
+                                srslte_dci_ul_t*  dci_ul,
+                                srslte_dci_msg_t* dci_msg)
+{
+  ZERO_OBJECT(*dci_msg);
+
+  if (srslte_dci_msg_pack_pusch(&q->cell, &q->dl_sf, dci_cfg, dci_ul, dci_msg)) {
+    ERROR("Error packing UL DCI\n");
+    return SRSLTE_ERROR;
   }
+
+  return SRSLTE_SUCCESS;
+}
+
+int srslte_enb_dl_put_pdcch_dl(srslte_enb_dl_t* q, srslte_dci_cfg_t* dci_cfg, srslte_dci_dl_t* dci_dl)
+{
+  srslte_dci_msg_t dci_msg;
+
+  srslte_enb_dl_pack_pdcch_dl(q, dci_cfg, dci_dl, &dci_msg);
   if (srslte_pdcch_encode(&q->pdcch, &q->dl_sf, &dci_msg, q->sf_symbols)) {
     ERROR("Error encoding DL DCI message\n");
     return SRSLTE_ERROR;
@@ -398,11 +635,8 @@ int srslte_enb_dl_put_pdcch_dl(srslte_enb_dl_t* q, srslte_dci_cfg_t* dci_cfg, sr
 int srslte_enb_dl_put_pdcch_ul(srslte_enb_dl_t* q, srslte_dci_cfg_t* dci_cfg, srslte_dci_ul_t* dci_ul)
 {
   srslte_dci_msg_t dci_msg;
-  ZERO_OBJECT(dci_msg);
 
-  if (srslte_dci_msg_pack_pusch(&q->cell, &q->dl_sf, dci_cfg, dci_ul, &dci_msg)) {
-    ERROR("Error packing UL DCI\n");
-  }
+  srslte_enb_dl_pack_pdcch_ul(q, dci_cfg, dci_ul, &dci_msg);
   if (srslte_pdcch_encode(&q->pdcch, &q->dl_sf, &dci_msg, q->sf_symbols)) {
     ERROR("Error encoding UL DCI message\n");
     return SRSLTE_ERROR;
@@ -411,11 +645,38 @@ int srslte_enb_dl_put_pdcch_ul(srslte_enb_dl_t* q, srslte_dci_cfg_t* dci_cfg, sr
   return SRSLTE_SUCCESS;
 }
 
+int srslte_enb_dl_put_pdcch_batch(srslte_enb_dl_t* q, srslte_dci_msg_t dci_msgs[], uint32_t nof_msgs)
+{
+  if (srslte_pdcch_encode_batch(&q->pdcch, &q->dl_sf, dci_msgs, nof_msgs, q->sf_symbols)) {
+    ERROR("Error encoding %d DCI messages\n", nof_msgs);
+    return SRSLTE_ERROR;
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
 int srslte_enb_dl_put_pdsch(srslte_enb_dl_t* q, srslte_pdsch_cfg_t* pdsch, uint8_t* data[SRSLTE_MAX_CODEWORDS])
 {
   return srslte_pdsch_encode(&q->pdsch, &q->dl_sf, pdsch, data, q->sf_symbols);
 }
 
+int srslte_enb_dl_put_pdsch_tx(srslte_enb_dl_t*    q,
+                               uint32_t            tx_idx,
+                               srslte_pdsch_cfg_t* pdsch,
+                               uint8_t*            data[SRSLTE_MAX_CODEWORDS])
+{
+  if (tx_idx == 0) {
+    return srslte_enb_dl_put_pdsch(q, pdsch, data);
+  }
+
+  if (tx_idx > q->nof_pdsch_tx) {
+    ERROR("Invalid PDSCH transmitter %d (%d available)\n", tx_idx, q->nof_pdsch_tx + 1);
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  return srslte_pdsch_encode(&q->pdsch_tx[tx_idx - 1], &q->dl_sf, pdsch, data, q->sf_symbols);
+}
+
 int srslte_enb_dl_put_pmch(srslte_enb_dl_t* q, srslte_pmch_cfg_t* pmch_cfg, uint8_t* data)
 {
   return srslte_pmch_encode(&q->pmch, &q->dl_sf, pmch_cfg, data, q->sf_symbols);
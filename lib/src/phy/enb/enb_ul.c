@@ -26,6 +26,32 @@
 #include <math.h>
 #include <string.h>
 
+static void enb_ul_ofdm_cfg(srslte_ofdm_cfg_t* ofdm_cfg, uint32_t max_prb)
+{
+  ofdm_cfg->nof_prb          = max_prb;
+  ofdm_cfg->cp               = SRSLTE_CP_NORM;
+  ofdm_cfg->freq_shift_f     = -0.5f;
+  ofdm_cfg->normalize        = false;
+  ofdm_cfg->rx_window_offset = 0.5f;
+}
+
+int srslte_enb_ul_preplan(uint32_t max_prb)
+{
+  srslte_ofdm_cfg_t ofdm_cfg = {};
+  enb_ul_ofdm_cfg(&ofdm_cfg, max_prb);
+
+  // The FFT is initialised with normal CP and later resized to the cell CP
+  for (uint32_t i = 0; i < 2; i++) {
+    ofdm_cfg.cp = (i == 0) ? SRSLTE_CP_NORM : SRSLTE_CP_EXT;
+    if (srslte_ofdm_rx_preplan(&ofdm_cfg)) {
+      ERROR("Error planning FFT\n");
+      return SRSLTE_ERROR;
+    }
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
 int srslte_enb_ul_init(srslte_enb_ul_t* q, cf_t* in_buffer, uint32_t max_prb)
 {
   int ret = SRSLTE_ERROR_INVALID_INPUTS;
@@ -35,6 +61,8 @@ int srslte_enb_ul_init(srslte_enb_ul_t* q, cf_t* in_buffer, uint32_t max_prb)
 
     bzero(q, sizeof(srslte_enb_ul_t));
 
+    q->max_prb = max_prb;
+
     q->sf_symbols = srslte_vec_cf_malloc(SRSLTE_SF_LEN_RE(max_prb, SRSLTE_CP_NORM));
     if (!q->sf_symbols) {
       perror("malloc");
@@ -48,13 +76,9 @@ int srslte_enb_ul_init(srslte_enb_ul_t* q, cf_t* in_buffer, uint32_t max_prb)
     }
 
     srslte_ofdm_cfg_t ofdm_cfg = {};
-    ofdm_cfg.nof_prb           = max_prb;
-    ofdm_cfg.in_buffer         = in_buffer;
-    ofdm_cfg.out_buffer        = q->sf_symbols;
-    ofdm_cfg.cp                = SRSLTE_CP_NORM;
-    ofdm_cfg.freq_shift_f      = -0.5f;
-    ofdm_cfg.normalize         = false;
-    ofdm_cfg.rx_window_offset  = 0.5f;
+    enb_ul_ofdm_cfg(&ofdm_cfg, max_prb);
+    ofdm_cfg.in_buffer  = in_buffer;
+    ofdm_cfg.out_buffer = q->sf_symbols;
     if (srslte_ofdm_rx_init_cfg(&q->fft, &ofdm_cfg)) {
       ERROR("Error initiating FFT\n");
       goto clean_exit;
@@ -97,6 +121,17 @@ void srslte_enb_ul_free(srslte_enb_ul_t* q)
     srslte_pusch_free(&q->pusch);
     srslte_chest_ul_free(&q->chest);
 
+    if (q->pusch_rx) {
+      for (uint32_t i = 0; i < q->nof_pusch_rx; i++) {
+        srslte_chest_ul_free(&q->pusch_rx[i].chest);
+        srslte_pusch_free(&q->pusch_rx[i].pusch);
+        if (q->pusch_rx[i].chest_res.ce) {
+          free(q->pusch_rx[i].chest_res.ce);
+        }
+      }
+      free(q->pusch_rx);
+    }
+
     if (q->sf_symbols) {
       free(q->sf_symbols);
     }
@@ -107,6 +142,54 @@ void srslte_enb_ul_free(srslte_enb_ul_t* q)
   }
 }
 
+int srslte_enb_ul_add_pusch_rx(srslte_enb_ul_t* q, uint32_t nof_pusch_rx)
+{
+  if (q == NULL || q->pusch_rx != NULL || q->cell.nof_prb != 0) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  if (nof_pusch_rx == 0) {
+    return SRSLTE_SUCCESS;
+  }
+
+  q->pusch_rx = calloc(nof_pusch_rx, sizeof(srslte_enb_ul_pusch_rx_t));
+  if (!q->pusch_rx) {
+    perror("calloc");
+    return SRSLTE_ERROR;
+  }
+  q->nof_pusch_rx = nof_pusch_rx;
+
+  for (uint32_t i = 0; i < nof_pusch_rx; i++) {
+    srslte_enb_ul_pusch_rx_t* rx = &q->pusch_rx[i];
+
+    rx->chest_res.ce = srslte_vec_cf_malloc(SRSLTE_SF_LEN_RE(q->max_prb, SRSLTE_CP_NORM));
+    if (!rx->chest_res.ce) {
+      perror("malloc");
+      return SRSLTE_ERROR;
+    }
+
+    if (srslte_pusch_init_enb(&rx->pusch, q->max_prb)) {
+      ERROR("Error creating PUSCH object\n");
+      return SRSLTE_ERROR;
+    }
+
+    if (srslte_chest_ul_init(&rx->chest, q->max_prb)) {
+      ERROR("Error initiating channel estimator\n");
+      return SRSLTE_ERROR;
+    }
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+void srslte_enb_ul_set_dmrs_cache(srslte_enb_ul_t* q, const srslte_refsignal_ul_dmrs_cache_t* cache)
+{
+  srslte_chest_ul_set_dmrs_cache(&q->chest, cache);
+  for (uint32_t i = 0; i < q->nof_pusch_rx; i++) {
+    srslte_chest_ul_set_dmrs_cache(&q->pusch_rx[i].chest, cache);
+  }
+}
+
 int srslte_enb_ul_set_cell(srslte_enb_ul_t*                   q,
                            srslte_cell_t                      cell,
                            srslte_refsignal_dmrs_pusch_cfg_t* pusch_cfg,
@@ -141,6 +224,20 @@ int srslte_enb_ul_set_cell(srslte_enb_ul_t*                   q,
       // SRS is a dedicated configuration
       srslte_chest_ul_pregen(&q->chest, pusch_cfg, srs_cfg);
 
+      for (uint32_t i = 0; i < q->nof_pusch_rx; i++) {
+        if (srslte_pusch_set_cell(&q->pusch_rx[i].pusch, q->cell)) {
+          ERROR("Error creating PUSCH object\n");
+          return SRSLTE_ERROR;
+        }
+
+        if (srslte_chest_ul_set_cell(&q->pusch_rx[i].chest, cell)) {
+          ERROR("Error initiating channel estimator\n");
+          return SRSLTE_ERROR;
+        }
+
+        srslte_chest_ul_pregen(&q->pusch_rx[i].chest, pusch_cfg, srs_cfg);
+      }
+
       ret = SRSLTE_SUCCESS;
     }
   } else {
@@ -159,6 +256,12 @@ int srslte_enb_ul_add_rnti(srslte_enb_ul_t* q, uint16_t rnti)
     ERROR("Error setting PUSCH rnti\n");
     return -1;
   }
+  for (uint32_t i = 0; i < q->nof_pusch_rx; i++) {
+    if (srslte_pusch_set_rnti(&q->pusch_rx[i].pusch, rnti)) {
+      ERROR("Error setting PUSCH rnti\n");
+      return -1;
+    }
+  }
   return 0;
 }
 
@@ -166,11 +269,21 @@ void srslte_enb_ul_rem_rnti(srslte_enb_ul_t* q, uint16_t rnti)
 {
   srslte_pucch_free_rnti(&q->pucch, rnti);
   srslte_pusch_free_rnti(&q->pusch, rnti);
+  for (uint32_t i = 0; i < q->nof_pusch_rx; i++) {
+    srslte_pusch_free_rnti(&q->pusch_rx[i].pusch, rnti);
+  }
 }
 
 void srslte_enb_ul_fft(srslte_enb_ul_t* q)
 {
   srslte_ofdm_rx_sf(&q->fft);
+  srslte_pucch_despread_reset(&q->pucch);
+}
+
+void srslte_enb_ul_fft_s(srslte_enb_ul_t* q, const int16_t* input)
+{
+  srslte_ofdm_rx_sf_s(&q->fft, input, INT16_MAX);
+  srslte_pucch_despread_reset(&q->pucch);
 }
 
 static int get_pucch(srslte_enb_ul_t* q, srslte_ul_sf_cfg_t* ul_sf, srslte_pucch_cfg_t* cfg, srslte_pucch_res_t* res)
@@ -208,10 +321,12 @@ static int get_pucch(srslte_enb_ul_t* q, srslte_ul_sf_cfg_t* ul_sf, srslte_pucch
     // Configure resource
     cfg->n_pucch = n_pucch_i[i];
 
-    // Prepare configuration
-    if (srslte_chest_ul_estimate_pucch(&q->chest, ul_sf, cfg, q->sf_symbols, &q->chest_res)) {
-      ERROR("Error estimating PUCCH DMRS\n");
-      return SRSLTE_ERROR;
+    // The formats 1 and 2 are detected from the despread DMRS, the channel estimate is only needed for TA
+    if (cfg->format == SRSLTE_PUCCH_FORMAT_3 || cfg->meas_ta_en) {
+      if (srslte_chest_ul_estimate_pucch(&q->chest, ul_sf, cfg, q->sf_symbols, &q->chest_res)) {
+        ERROR("Error estimating PUCCH DMRS\n");
+        return SRSLTE_ERROR;
+      }
     }
 
     ret = srslte_pucch_decode(&q->pucch, ul_sf, cfg, &q->chest_res, q->sf_symbols, &pucch_res);
@@ -284,3 +399,55 @@ int srslte_enb_ul_get_pusch(srslte_enb_ul_t*    q,
 
   return srslte_pusch_decode(&q->pusch, ul_sf, cfg, &q->chest_res, q->sf_symbols, res);
 }
+
+int srslte_enb_ul_get_pusch_rx(srslte_enb_ul_t*    q,
+                               uint32_t            rx_idx,
+                               srslte_ul_sf_cfg_t* ul_sf,
+                               srslte_pusch_cfg_t* cfg,
+                               srslte_pusch_res_t* res)
+{
+  if (rx_idx == 0) {
+    return srslte_enb_ul_get_pusch(q, ul_sf, cfg, res);
+  }
+
+  if (rx_idx > q->nof_pusch_rx) {
+    ERROR("Invalid PUSCH receiver %d (%d available)\n", rx_idx, q->nof_pusch_rx + 1);
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  srslte_enb_ul_pusch_rx_t* rx = &q->pusch_rx[rx_idx - 1];
+
+  srslte_chest_ul_estimate_pusch(&rx->chest, ul_sf, cfg, q->sf_symbols, &rx->chest_res);
+
+  return srslte_pusch_decode(&rx->pusch, ul_sf, cfg, &rx->chest_res, q->sf_symbols, res);
+}
+
+int srslte_enb_ul_get_srs(srslte_enb_ul_t*                   q,
+                          srslte_ul_sf_cfg_t*                ul_sf,
+                          srslte_refsignal_srs_cfg_t*        srs_cfg,
+                          srslte_refsignal_dmrs_pusch_cfg_t* dmrs_cfg,
+                          uint32_t                           sb_size,
+                          float*                             snr_sb_db)
+{
+  if (srslte_chest_ul_estimate_srs(&q->chest, ul_sf, srs_cfg, dmrs_cfg, q->sf_symbols, &q->chest_res)) {
+    return SRSLTE_ERROR;
+  }
+
+  return srslte_chest_ul_srs_snr_sb(&q->chest, ul_sf, srs_cfg, &q->chest_res, sb_size, snr_sb_db);
+}
+
+srslte_chest_ul_res_t* srslte_enb_ul_pusch_rx_chest_res(srslte_enb_ul_t* q, uint32_t rx_idx)
+{
+  if (rx_idx == 0 || rx_idx > q->nof_pusch_rx) {
+    return &q->chest_res;
+  }
+  return &q->pusch_rx[rx_idx - 1].chest_res;
+}
+
+srslte_pusch_t* srslte_enb_ul_pusch_rx_pusch(srslte_enb_ul_t* q, uint32_t rx_idx)
+{
+  if (rx_idx == 0 || rx_idx > q->nof_pusch_rx) {
+    return &q->pusch;
+  }
+  return &q->pusch_rx[rx_idx - 1].pusch;
+}
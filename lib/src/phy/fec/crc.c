@@ -27,6 +27,14 @@
 #include "srslte/phy/utils/bit.h"
 #include "srslte/phy/utils/debug.h"
 
+/* The carry-less multiplication engine is compiled for the target ISA through function attributes and selected at
+ * runtime, so the same binary runs on CPUs without PCLMULQDQ.
+ */
+#if defined(LV_HAVE_SSE) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define CRC_HAVE_CLMUL 1
+#endif
+
 void gen_crc_table(srslte_crc_t* h)
 {
 
@@ -70,6 +78,33 @@ int srslte_crc_set_init(srslte_crc_t* crc_par, uint64_t crc_init_value)
   return 0;
 }
 
+// Computes x^k mod P, where P includes the x^order term
+static uint64_t crc_xpow_mod(uint32_t k, uint64_t poly, int order)
+{
+  uint64_t r = 1;
+  for (uint32_t i = 0; i < k; i++) {
+    r <<= 1;
+    if (r & ((uint64_t)1 << order)) {
+      r ^= poly;
+    }
+  }
+  return r;
+}
+
+static void gen_crc_clmul(srslte_crc_t* h)
+{
+  for (uint32_t d = 0; d < 4; d++) {
+    h->clmul_k[d][0] = crc_xpow_mod(128 * (d + 1) + 64, (uint32_t)h->polynom, h->order);
+    h->clmul_k[d][1] = crc_xpow_mod(128 * (d + 1), (uint32_t)h->polynom, h->order);
+  }
+
+#ifdef CRC_HAVE_CLMUL
+  h->use_clmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+#else
+  h->use_clmul = false;
+#endif
+}
+
 int srslte_crc_init(srslte_crc_t* h, uint32_t crc_poly, int crc_order)
 {
 
@@ -96,6 +131,9 @@ int srslte_crc_init(srslte_crc_t* h, uint32_t crc_poly, int crc_order)
   // generate lookup table
   gen_crc_table(h);
 
+  // generate folding constants
+  gen_crc_clmul(h);
+
   return 0;
 }
 
@@ -139,12 +177,89 @@ uint32_t srslte_crc_checksum(srslte_crc_t* h, uint8_t* data, int len)
   return crc;
 }
 
+#ifdef CRC_HAVE_CLMUL
+
+/* Folds the 128-bit remainder x forward by 128*d bits, with k = {x^(128*d+64) mod P, x^(128*d) mod P} */
+#define CRC_CLMUL_FOLD(x, k) _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x01), _mm_clmulepi64_si128(x, k, 0x10))
+
+/* Loads 16 bytes so that the first transmitted bit becomes the x^127 coefficient */
+#define CRC_CLMUL_LOAD(ptr) _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(ptr)), bswap)
+
+/* Folded CRC of nbytes >= 32 bytes starting from the register value init. The 128-bit blocks are folded with
+ * carry-less multiplications into a 128-bit value congruent with the message modulo P, which is finally reduced
+ * together with the remaining bytes using the byte table. Any polynomial order up to 32 works, the products never
+ * exceed 96 bits. A non-zero initial register is equivalent to adding it to the first order bits of the message.
+ */
+__attribute__((target("pclmul,ssse3"))) static uint32_t
+crc_checksum_byte_clmul(srslte_crc_t* h, const uint8_t* data, int nbytes, uint64_t init)
+{
+  const __m128i bswap   = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  const __m128i x_init  = _mm_set_epi64x((long long)(init << (64 - h->order)), 0);
+  int           nblocks = nbytes / 16;
+  int           i       = 0;
+  __m128i       x;
+
+  if (nblocks >= 8) {
+    // Four independent lanes hide the multiplication latency
+    const __m128i k4 = _mm_set_epi64x(h->clmul_k[3][1], h->clmul_k[3][0]);
+    const __m128i k3 = _mm_set_epi64x(h->clmul_k[2][1], h->clmul_k[2][0]);
+    const __m128i k2 = _mm_set_epi64x(h->clmul_k[1][1], h->clmul_k[1][0]);
+    const __m128i k1 = _mm_set_epi64x(h->clmul_k[0][1], h->clmul_k[0][0]);
+
+    __m128i x0 = _mm_xor_si128(CRC_CLMUL_LOAD(&data[0]), x_init);
+    __m128i x1 = CRC_CLMUL_LOAD(&data[16]);
+    __m128i x2 = CRC_CLMUL_LOAD(&data[32]);
+    __m128i x3 = CRC_CLMUL_LOAD(&data[48]);
+    for (i = 4; i + 4 <= nblocks; i += 4) {
+      x0 = _mm_xor_si128(CRC_CLMUL_FOLD(x0, k4), CRC_CLMUL_LOAD(&data[16 * i]));
+      x1 = _mm_xor_si128(CRC_CLMUL_FOLD(x1, k4), CRC_CLMUL_LOAD(&data[16 * i + 16]));
+      x2 = _mm_xor_si128(CRC_CLMUL_FOLD(x2, k4), CRC_CLMUL_LOAD(&data[16 * i + 32]));
+      x3 = _mm_xor_si128(CRC_CLMUL_FOLD(x3, k4), CRC_CLMUL_LOAD(&data[16 * i + 48]));
+    }
+    x = _mm_xor_si128(_mm_xor_si128(CRC_CLMUL_FOLD(x0, k3), CRC_CLMUL_FOLD(x1, k2)),
+                      _mm_xor_si128(CRC_CLMUL_FOLD(x2, k1), x3));
+  } else {
+    x = _mm_xor_si128(CRC_CLMUL_LOAD(&data[0]), x_init);
+    i = 1;
+  }
+
+  const __m128i k1 = _mm_set_epi64x(h->clmul_k[0][1], h->clmul_k[0][0]);
+  for (; i < nblocks; i++) {
+    x = _mm_xor_si128(CRC_CLMUL_FOLD(x, k1), CRC_CLMUL_LOAD(&data[16 * i]));
+  }
+
+  // Reduce the folded value and the remaining bytes
+  uint8_t folded[16];
+  _mm_storeu_si128((__m128i*)folded, _mm_shuffle_epi8(x, bswap));
+
+  h->crcinit = 0;
+  for (i = 0; i < 16; i++) {
+    srslte_crc_checksum_put_byte(h, folded[i]);
+  }
+  for (i = 16 * nblocks; i < nbytes; i++) {
+    srslte_crc_checksum_put_byte(h, data[i]);
+  }
+
+  return (uint32_t)srslte_crc_checksum_get(h);
+}
+
+#undef CRC_CLMUL_LOAD
+#undef CRC_CLMUL_FOLD
+
+#endif /* CRC_HAVE_CLMUL */
+
 // len is multiple of 8
 uint32_t srslte_crc_checksum_byte(srslte_crc_t* h, uint8_t* data, int len)
 {
   int      i;
   uint32_t crc = 0;
 
+#ifdef CRC_HAVE_CLMUL
+  if (h->use_clmul && len >= 256) {
+    return crc_checksum_byte_clmul(h, data, len / 8, 0);
+  }
+#endif /* CRC_HAVE_CLMUL */
+
   srslte_crc_set_init(h, 0);
 
   // Calculate CRC
@@ -156,6 +271,31 @@ uint32_t srslte_crc_checksum_byte(srslte_crc_t* h, uint8_t* data, int len)
   return crc;
 }
 
+void srslte_crc_checksum_put_bytes(srslte_crc_t* h, const uint8_t* data, uint32_t nof_bytes)
+{
+#ifdef CRC_HAVE_CLMUL
+  if (h->use_clmul && nof_bytes >= 32) {
+    crc_checksum_byte_clmul(h, data, nof_bytes, srslte_crc_checksum_get(h));
+    return;
+  }
+#endif /* CRC_HAVE_CLMUL */
+
+  for (uint32_t i = 0; i < nof_bytes; i++) {
+    srslte_crc_checksum_put_byte(h, data[i]);
+  }
+}
+
+void srslte_crc_checksum_byte_batch(srslte_crc_t*   h,
+                                    uint8_t**       data,
+                                    const uint32_t* len,
+                                    uint32_t        nof_blocks,
+                                    uint32_t*       checksum)
+{
+  for (uint32_t i = 0; i < nof_blocks; i++) {
+    checksum[i] = srslte_crc_checksum_byte(h, data[i], len[i]);
+  }
+}
+
 uint32_t srslte_crc_attach_byte(srslte_crc_t* h, uint8_t* data, int len)
 {
   uint32_t checksum = srslte_crc_checksum_byte(h, data, len);
@@ -88,6 +88,43 @@ int srslte_rm_conv_tx(uint8_t* input, uint32_t in_len, uint8_t* output, uint32_t
   return 0;
 }
 
+/**
+ * Computes the circular buffer of the rate matching for convolution encoder. The output bit k of
+ * srslte_rm_conv_tx() is input[table[k % in_len]], so the rate matching can be done with a gather.
+ *
+ * @param[in] in_len Number of coded bits, multiple of 3
+ * @param[output] table Index of the coded bit of every position of the circular buffer. Size in_len
+ * @return Number of positions of the circular buffer (in_len) or -1 on error
+ */
+int srslte_rm_conv_tx_table(uint32_t in_len, uint16_t* table)
+{
+  int nrows, ndummy, K_p;
+  int i, j, k, s;
+
+  nrows = (uint32_t)(in_len / 3 - 1) / NCOLS + 1;
+  if (nrows > NROWS_MAX) {
+    ERROR("Input too large. Max input length is %d\n", 3 * NCOLS * NROWS_MAX);
+    return -1;
+  }
+  K_p    = nrows * NCOLS;
+  ndummy = K_p - in_len / 3;
+  if (ndummy < 0) {
+    ndummy = 0;
+  }
+  /* Same order as the sub-block interleaver and bit collection, skipping the dummy bits */
+  k = 0;
+  for (s = 0; s < 3; s++) {
+    for (j = 0; j < NCOLS; j++) {
+      for (i = 0; i < nrows; i++) {
+        if (i * NCOLS + RM_PERM_CC[j] >= ndummy) {
+          table[k++] = (uint16_t)((i * NCOLS + RM_PERM_CC[j] - ndummy) * 3 + s);
+        }
+      }
+    }
+  }
+  return k;
+}
+
 /* Undoes Convolutional Code Rate Matching.
  * 3GPP TS 36.212 v10.1.0 section 5.1.4.2
  */
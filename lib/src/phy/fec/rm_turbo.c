@@ -20,6 +20,7 @@
  */
 
 #include <math.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -78,13 +79,22 @@ static uint16_t                 interleaver_parity_bits[192][2 * 6160];
 static srslte_bit_interleaver_t bit_interleavers_parity_bits[192];
 static uint16_t                 deinterleaver[192][4][18448];
 static int                      k0_vec[SRSLTE_NOF_TC_CB_SIZES][4][2];
-static bool                     rm_turbo_tables_generated = false;
+
+// Tables are generated lazily for each code block size the first time it is used
+static pthread_mutex_t rm_turbo_tables_mutex     = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t        rm_turbo_tables_refcount  = 0;
+static bool            rm_turbo_tables_ready[SRSLTE_NOF_TC_CB_SIZES];
 
 // Store deinterleaver version for sub-block turbo decoder
 #if SRSLTE_TDEC_EXPECT_INPUT_SB == 1
 // Prepare bit for sub-block decoder processing. These are the nof subblock sizes
+#ifdef LV_HAVE_AVX512
+#define NOF_DEINTER_TABLE_SB_IDX 4
+const static int deinter_table_sb_idx[NOF_DEINTER_TABLE_SB_IDX] = {8, 16, 32, 64};
+#else /* LV_HAVE_AVX512 */
 #define NOF_DEINTER_TABLE_SB_IDX 3
 const static int deinter_table_sb_idx[NOF_DEINTER_TABLE_SB_IDX] = {8, 16, 32};
+#endif /* LV_HAVE_AVX512 */
 int              deinter_table_idx_from_sb_len(uint32_t nof_subblocks)
 {
   for (int i = 0; i < NOF_DEINTER_TABLE_SB_IDX; i++) {
@@ -277,59 +287,86 @@ static void interleave_table_sb(uint16_t* in, uint16_t* out, uint32_t cb_idx, ui
 }
 #endif
 
-void srslte_rm_turbo_gentables()
+static void srslte_rm_turbo_gentables_cb(int cb_idx)
 {
-  if (!rm_turbo_tables_generated) {
-    rm_turbo_tables_generated = true;
-    for (int cb_idx = 0; cb_idx < SRSLTE_NOF_TC_CB_SIZES; cb_idx++) {
-      int cb_len = srslte_cbsegm_cbsize(cb_idx);
-      int in_len = 3 * cb_len + 12;
-
-      int nrows  = (in_len / 3 - 1) / NCOLS + 1;
-      int K_p    = nrows * NCOLS;
-      int ndummy = K_p - in_len / 3;
-      if (ndummy < 0) {
-        ndummy = 0;
-      }
+  int cb_len = srslte_cbsegm_cbsize(cb_idx);
+  int in_len = 3 * cb_len + 12;
 
-      for (int i = 0; i < 4; i++) {
-        k0_vec[cb_idx][i][0] = nrows * (2 * (uint16_t)ceilf((float)(3 * K_p) / (float)(8 * nrows)) * i + 2);
-        k0_vec[cb_idx][i][1] = -1;
-      }
-      srslte_rm_turbo_gentable_systematic(interleaver_systematic_bits[cb_idx], k0_vec[cb_idx], nrows, ndummy);
-      srslte_bit_interleaver_init(&bit_interleavers_systematic_bits[cb_idx],
-                                  interleaver_systematic_bits[cb_idx],
-                                  (uint32_t)srslte_cbsegm_cbsize(cb_idx) + 4);
+  int nrows  = (in_len / 3 - 1) / NCOLS + 1;
+  int K_p    = nrows * NCOLS;
+  int ndummy = K_p - in_len / 3;
+  if (ndummy < 0) {
+    ndummy = 0;
+  }
 
-      srslte_rm_turbo_gentable_parity(interleaver_parity_bits[cb_idx], k0_vec[cb_idx], in_len / 3, nrows, ndummy);
-      srslte_bit_interleaver_init(&bit_interleavers_parity_bits[cb_idx],
-                                  interleaver_parity_bits[cb_idx],
-                                  (uint32_t)(srslte_cbsegm_cbsize(cb_idx) + 4) * 2);
+  for (int i = 0; i < 4; i++) {
+    k0_vec[cb_idx][i][0] = nrows * (2 * (uint16_t)ceilf((float)(3 * K_p) / (float)(8 * nrows)) * i + 2);
+    k0_vec[cb_idx][i][1] = -1;
+  }
+  srslte_rm_turbo_gentable_systematic(interleaver_systematic_bits[cb_idx], k0_vec[cb_idx], nrows, ndummy);
+  srslte_bit_interleaver_init(&bit_interleavers_systematic_bits[cb_idx],
+                              interleaver_systematic_bits[cb_idx],
+                              (uint32_t)srslte_cbsegm_cbsize(cb_idx) + 4);
+
+  srslte_rm_turbo_gentable_parity(interleaver_parity_bits[cb_idx], k0_vec[cb_idx], in_len / 3, nrows, ndummy);
+  srslte_bit_interleaver_init(&bit_interleavers_parity_bits[cb_idx],
+                              interleaver_parity_bits[cb_idx],
+                              (uint32_t)(srslte_cbsegm_cbsize(cb_idx) + 4) * 2);
 
-      for (int i = 0; i < 4; i++) {
-        srslte_rm_turbo_gentable_receive(deinterleaver[cb_idx][i], in_len, i);
+  for (int i = 0; i < 4; i++) {
+    srslte_rm_turbo_gentable_receive(deinterleaver[cb_idx][i], in_len, i);
 
 #if SRSLTE_TDEC_EXPECT_INPUT_SB == 1
-        for (uint32_t s = 0; s < NOF_DEINTER_TABLE_SB_IDX; s++) {
-          interleave_table_sb(
-              deinterleaver[cb_idx][i], deinterleaver_sb[s][cb_idx][i], cb_idx, deinter_table_sb_idx[s]);
-        }
-#endif
+    for (uint32_t s = 0; s < NOF_DEINTER_TABLE_SB_IDX; s++) {
+      // Codeblocks shorter than the number of sub-blocks never use the table
+      if (cb_len < deinter_table_sb_idx[s]) {
+        continue;
       }
+      interleave_table_sb(deinterleaver[cb_idx][i], deinterleaver_sb[s][cb_idx][i], cb_idx, deinter_table_sb_idx[s]);
+    }
+#endif
+  }
+}
+
+/* Makes sure the tables of the given code block size are generated. The fast path is a single atomic load, so it is
+ * safe to be called from several PHY workers at once. Generation is serialized, since it uses shared temporal tables.
+ */
+static inline void srslte_rm_turbo_check_tables(uint32_t cb_idx)
+{
+  if (!__atomic_load_n(&rm_turbo_tables_ready[cb_idx], __ATOMIC_ACQUIRE)) {
+    pthread_mutex_lock(&rm_turbo_tables_mutex);
+    if (!rm_turbo_tables_ready[cb_idx]) {
+      srslte_rm_turbo_gentables_cb(cb_idx);
+      __atomic_store_n(&rm_turbo_tables_ready[cb_idx], true, __ATOMIC_RELEASE);
     }
+    pthread_mutex_unlock(&rm_turbo_tables_mutex);
   }
 }
 
+void srslte_rm_turbo_gentables()
+{
+  pthread_mutex_lock(&rm_turbo_tables_mutex);
+  rm_turbo_tables_refcount++;
+  pthread_mutex_unlock(&rm_turbo_tables_mutex);
+}
+
 void srslte_rm_turbo_free_tables()
 {
-  if (rm_turbo_tables_generated) {
+  pthread_mutex_lock(&rm_turbo_tables_mutex);
+  if (rm_turbo_tables_refcount > 0) {
+    rm_turbo_tables_refcount--;
+  }
+  // Only the last user releases the tables
+  if (rm_turbo_tables_refcount == 0) {
     for (int i = 0; i < SRSLTE_NOF_TC_CB_SIZES; i++) {
-      srslte_bit_interleaver_free(&bit_interleavers_systematic_bits[i]);
-      srslte_bit_interleaver_free(&bit_interleavers_parity_bits[i]);
+      if (rm_turbo_tables_ready[i]) {
+        srslte_bit_interleaver_free(&bit_interleavers_systematic_bits[i]);
+        srslte_bit_interleaver_free(&bit_interleavers_parity_bits[i]);
+        __atomic_store_n(&rm_turbo_tables_ready[i], false, __ATOMIC_RELEASE);
+      }
     }
-    rm_turbo_tables_generated = false;
   }
-  rm_turbo_tables_generated = false;
+  pthread_mutex_unlock(&rm_turbo_tables_mutex);
 }
 
 /**
@@ -355,17 +392,38 @@ int srslte_rm_turbo_tx_lut(uint8_t* w_buff,
                            uint32_t w_offset,
                            uint32_t rv_idx)
 {
+  return srslte_rm_turbo_tx_lut_split(w_buff, systematic, NULL, 0, parity, output, cb_idx, out_len, w_offset, rv_idx);
+}
+
+int srslte_rm_turbo_tx_lut_split(uint8_t*       w_buff,
+                                 const uint8_t* systematic,
+                                 const uint8_t* systematic_tail,
+                                 uint32_t       split,
+                                 uint8_t*       parity,
+                                 uint8_t*       output,
+                                 uint32_t       cb_idx,
+                                 uint32_t       out_len,
+                                 uint32_t       w_offset,
+                                 uint32_t       rv_idx)
+{
 
   if (rv_idx < 4 && cb_idx < SRSLTE_NOF_TC_CB_SIZES) {
 
     int in_len = 3 * srslte_cbsegm_cbsize(cb_idx) + 12;
 
+    srslte_rm_turbo_check_tables(cb_idx);
+
     /* Sub-block interleaver (5.1.4.1.1) and bit collection */
     if (rv_idx == 0) {
 
       // Systematic bits
       // srslte_bit_interleave(systematic, w_buff, interleaver_systematic_bits[cb_idx], in_len/3);
-      srslte_bit_interleaver_run(&bit_interleavers_systematic_bits[cb_idx], systematic, w_buff, 0);
+      if (systematic_tail) {
+        srslte_bit_interleaver_run_split(
+            &bit_interleavers_systematic_bits[cb_idx], systematic, systematic_tail, split, w_buff);
+      } else {
+        srslte_bit_interleaver_run(&bit_interleavers_systematic_bits[cb_idx], (uint8_t*)systematic, w_buff, 0);
+      }
 
       // Parity bits
       // srslte_bit_interleave_w_offset(parity, &w_buff[in_len/24], interleaver_parity_bits[cb_idx], 2*in_len/3, 4);
@@ -417,6 +475,8 @@ int srslte_rm_turbo_rx_lut_(int16_t* input,
 
   if (rv_idx < 4 && cb_idx < SRSLTE_NOF_TC_CB_SIZES) {
 
+    srslte_rm_turbo_check_tables(cb_idx);
+
 #if SRSLTE_TDEC_EXPECT_INPUT_SB == 1
     int       cb_len  = srslte_cbsegm_cbsize(cb_idx);
     int       idx     = deinter_table_idx_from_sb_len(srslte_tdec_autoimp_get_subblocks(cb_len));
@@ -433,30 +493,41 @@ int srslte_rm_turbo_rx_lut_(int16_t* input,
     uint16_t* deinter = deinterleaver[cb_idx][rv_idx];
 #endif
 
+    // Kernels combine up to one full circular buffer at a time, wrap-arounds are handled here
+    uint32_t out_len = 3 * srslte_cbsegm_cbsize(cb_idx) + 12;
+    for (uint32_t i = 0; i < in_len; i += out_len) {
+      uint32_t len = SRSLTE_MIN(out_len, in_len - i);
 #ifdef LV_HAVE_AVX
-    return srslte_rm_turbo_rx_lut_avx(input, output, deinter, in_len, cb_idx, rv_idx);
+      srslte_rm_turbo_rx_lut_avx(&input[i], output, deinter, len, cb_idx, rv_idx);
 #else
 #ifdef LV_HAVE_SSE
-    return srslte_rm_turbo_rx_lut_sse(input, output, deinter, in_len, cb_idx, rv_idx);
+      srslte_rm_turbo_rx_lut_sse(&input[i], output, deinter, len, cb_idx, rv_idx);
 #else
-    uint32_t out_len = 3 * srslte_cbsegm_cbsize(cb_idx) + 12;
-
-    for (int i = 0; i < in_len; i++) {
-      output[deinter[i % out_len]] += input[i];
-    }
-    return 0;
+      for (uint32_t j = 0; j < len; j++) {
+        output[deinter[j]] += input[i + j];
+      }
 #endif
 #endif
+    }
+    return 0;
   } else {
     printf("Invalid inputs rv_idx=%d, cb_idx=%d\n", rv_idx, cb_idx);
     return SRSLTE_ERROR_INVALID_INPUTS;
   }
 }
 
+/* The 8-bit soft bits saturate when combined, a wrapped-around sum would flip the sign of the strongest bits */
+static inline int8_t rm_turbo_sat_8bit(int16_t x)
+{
+  return (int8_t)(x > INT8_MAX ? INT8_MAX : (x < INT8_MIN ? INT8_MIN : x));
+}
+
 int srslte_rm_turbo_rx_lut_8bit(int8_t* input, int8_t* output, uint32_t in_len, uint32_t cb_idx, uint32_t rv_idx)
 {
   if (rv_idx < 4 && cb_idx < SRSLTE_NOF_TC_CB_SIZES) {
 
+    srslte_rm_turbo_check_tables(cb_idx);
+
 #if SRSLTE_TDEC_EXPECT_INPUT_SB == 1
     int       cb_len  = srslte_cbsegm_cbsize(cb_idx);
     int       idx     = deinter_table_idx_from_sb_len(srslte_tdec_autoimp_get_subblocks_8bit(cb_len));
@@ -473,19 +544,22 @@ int srslte_rm_turbo_rx_lut_8bit(int8_t* input, int8_t* output, uint32_t in_len,
     uint16_t* deinter = deinterleaver[cb_idx][rv_idx];
 #endif
 
-    // TODO: AVX version of rm_turbo_rx_lut not working
-    // Warning: Need to check if 8-bit sse version is correct
-
+    uint32_t out_len = 3 * srslte_cbsegm_cbsize(cb_idx) + 12;
+    for (uint32_t i = 0; i < in_len; i += out_len) {
+      uint32_t len = SRSLTE_MIN(out_len, in_len - i);
+#ifdef LV_HAVE_AVX
+      srslte_rm_turbo_rx_lut_avx_8bit(&input[i], output, deinter, len, cb_idx, rv_idx);
+#else
 #ifdef LV_HAVE_SSE
-    return srslte_rm_turbo_rx_lut_sse_8bit(input, output, deinter, in_len, cb_idx, rv_idx);
+      srslte_rm_turbo_rx_lut_sse_8bit(&input[i], output, deinter, len, cb_idx, rv_idx);
 #else
-    uint32_t  out_len = 3 * srslte_cbsegm_cbsize(cb_idx) + 12;
-
-    for (int i = 0; i < in_len; i++) {
-      output[deinter[i % out_len]] += input[i];
+      for (uint32_t j = 0; j < len; j++) {
+        output[deinter[j]] = rm_turbo_sat_8bit(output[deinter[j]] + input[i + j]);
+      }
+#endif
+#endif
     }
     return 0;
-#endif
   } else {
     printf("Invalid inputs rv_idx=%d, cb_idx=%d\n", rv_idx, cb_idx);
     return SRSLTE_ERROR_INVALID_INPUTS;
@@ -494,6 +568,10 @@ int srslte_rm_turbo_rx_lut_8bit(int8_t* input, int8_t* output, uint32_t in_len,
 
 #ifdef LV_HAVE_SSE
 
+/* The kernels below soft-combine at most one circular buffer (in_len <= out_len), the caller handles the wrap-arounds.
+ * Deinterleaver entries are unique within one buffer, so the scattered accumulations never conflict.
+ */
+
 #define SAVE_OUTPUT_16_SSE(j)                                                                                          \
   x = (int16_t)_mm_extract_epi16(xVal, j);                                                                             \
   l = (uint16_t)_mm_extract_epi16(lutVal, j);                                                                          \
@@ -507,8 +585,6 @@ int srslte_rm_turbo_rx_lut_sse(int16_t*  input,
                                uint32_t  rv_idx)
 {
   if (rv_idx < 4 && cb_idx < SRSLTE_NOF_TC_CB_SIZES) {
-    uint32_t out_len = 3 * srslte_cbsegm_cbsize(cb_idx) + 12;
-
     const __m128i* xPtr   = (const __m128i*)input;
     const __m128i* lutPtr = (const __m128i*)deinter;
     __m128i        xVal, lutVal;
@@ -516,64 +592,24 @@ int srslte_rm_turbo_rx_lut_sse(int16_t*  input,
     int16_t  x;
     uint16_t l;
 
-    /* Simplify load if we do not need to wrap (ie high rates) */
-    if (in_len <= out_len) {
-      for (int i = 0; i < in_len / 8; i++) {
-        xVal   = _mm_loadu_si128(xPtr);
-        lutVal = _mm_loadu_si128(lutPtr);
-
-        SAVE_OUTPUT_16_SSE(0);
-        SAVE_OUTPUT_16_SSE(1);
-        SAVE_OUTPUT_16_SSE(2);
-        SAVE_OUTPUT_16_SSE(3);
-        SAVE_OUTPUT_16_SSE(4);
-        SAVE_OUTPUT_16_SSE(5);
-        SAVE_OUTPUT_16_SSE(6);
-        SAVE_OUTPUT_16_SSE(7);
-
-        xPtr++;
-        lutPtr++;
-      }
-      for (int i = 8 * (in_len / 8); i < in_len; i++) {
-        output[deinter[i % out_len]] += input[i];
-      }
-    } else {
-      int intCnt   = 8;
-      int inputCnt = 0;
-      int nwrapps  = 0;
-      while (inputCnt < in_len - 8) {
-        xVal   = _mm_loadu_si128(xPtr);
-        lutVal = _mm_loadu_si128(lutPtr);
-
-        SAVE_OUTPUT_16_SSE(0);
-        SAVE_OUTPUT_16_SSE(1);
-        SAVE_OUTPUT_16_SSE(2);
-        SAVE_OUTPUT_16_SSE(3);
-        SAVE_OUTPUT_16_SSE(4);
-        SAVE_OUTPUT_16_SSE(5);
-        SAVE_OUTPUT_16_SSE(6);
-        SAVE_OUTPUT_16_SSE(7);
-
-        xPtr++;
-        lutPtr++;
-        intCnt += 8;
-        inputCnt += 8;
-        if (intCnt >= out_len && inputCnt < in_len - 8) {
-          /* Copy last elements */
-          for (int j = (nwrapps + 1) * out_len - 4; j < (nwrapps + 1) * out_len; j++) {
-            output[deinter[j % out_len]] += input[j];
-            inputCnt++;
-          }
-          /* And wrap pointers */
-          nwrapps++;
-          intCnt = 8;
-          xPtr   = (const __m128i*)&input[nwrapps * out_len];
-          lutPtr = (const __m128i*)deinter;
-        }
-      }
-      for (int i = inputCnt; i < in_len; i++) {
-        output[deinter[i % out_len]] += input[i];
-      }
+    for (int i = 0; i < in_len / 8; i++) {
+      xVal   = _mm_loadu_si128(xPtr);
+      lutVal = _mm_loadu_si128(lutPtr);
+
+      SAVE_OUTPUT_16_SSE(0);
+      SAVE_OUTPUT_16_SSE(1);
+      SAVE_OUTPUT_16_SSE(2);
+      SAVE_OUTPUT_16_SSE(3);
+      SAVE_OUTPUT_16_SSE(4);
+      SAVE_OUTPUT_16_SSE(5);
+      SAVE_OUTPUT_16_SSE(6);
+      SAVE_OUTPUT_16_SSE(7);
+
+      xPtr++;
+      lutPtr++;
+    }
+    for (int i = 8 * (in_len / 8); i < in_len; i++) {
+      output[deinter[i]] += input[i];
     }
 
     return 0;
@@ -586,12 +622,12 @@ int srslte_rm_turbo_rx_lut_sse(int16_t*  input,
 #define SAVE_OUTPUT_SSE_8(j)                                                                                           \
   x = (int8_t)_mm_extract_epi8(xVal, j);                                                                               \
   l = (uint16_t)_mm_extract_epi16(lutVal1, j);                                                                         \
-  output[l] += x;
+  output[l] = rm_turbo_sat_8bit(output[l] + x);
 
 #define SAVE_OUTPUT_SSE_8_2(j)                                                                                         \
   x = (int8_t)_mm_extract_epi8(xVal, j + 8);                                                                           \
   l = (uint16_t)_mm_extract_epi16(lutVal2, j);                                                                         \
-  output[l] += x;
+  output[l] = rm_turbo_sat_8bit(output[l] + x);
 
 int srslte_rm_turbo_rx_lut_sse_8bit(int8_t*   input,
                                     int8_t*   output,
@@ -601,8 +637,6 @@ int srslte_rm_turbo_rx_lut_sse_8bit(int8_t*   input,
                                     uint32_t  rv_idx)
 {
   if (rv_idx < 4 && cb_idx < SRSLTE_NOF_TC_CB_SIZES) {
-    uint32_t out_len = 3 * srslte_cbsegm_cbsize(cb_idx) + 12;
-
     const __m128i* xPtr   = (const __m128i*)input;
     const __m128i* lutPtr = (const __m128i*)deinter;
     __m128i        xVal, lutVal1, lutVal2;
@@ -610,92 +644,34 @@ int srslte_rm_turbo_rx_lut_sse_8bit(int8_t*   input,
     int8_t   x;
     uint16_t l;
 
-    /* Simplify load if we do not need to wrap (ie high rates) */
-    if (in_len <= out_len) {
-      for (int i = 0; i < in_len / 16; i++) {
-        xVal = _mm_loadu_si128(xPtr);
-        xPtr++;
-        lutVal1 = _mm_loadu_si128(lutPtr);
-        lutPtr++;
-        lutVal2 = _mm_loadu_si128(lutPtr);
-        lutPtr++;
-
-        SAVE_OUTPUT_SSE_8(0);
-        SAVE_OUTPUT_SSE_8(1);
-        SAVE_OUTPUT_SSE_8(2);
-        SAVE_OUTPUT_SSE_8(3);
-        SAVE_OUTPUT_SSE_8(4);
-        SAVE_OUTPUT_SSE_8(5);
-        SAVE_OUTPUT_SSE_8(6);
-        SAVE_OUTPUT_SSE_8(7);
-
-        SAVE_OUTPUT_SSE_8_2(0);
-        SAVE_OUTPUT_SSE_8_2(1);
-        SAVE_OUTPUT_SSE_8_2(2);
-        SAVE_OUTPUT_SSE_8_2(3);
-        SAVE_OUTPUT_SSE_8_2(4);
-        SAVE_OUTPUT_SSE_8_2(5);
-        SAVE_OUTPUT_SSE_8_2(6);
-        SAVE_OUTPUT_SSE_8_2(7);
-      }
-      for (int i = 16 * (in_len / 16); i < in_len; i++) {
-        output[deinter[i % out_len]] += input[i];
-      }
-    } else {
-      int intCnt   = 16;
-      int inputCnt = 0;
-      int nwrapps  = 0;
-      while (inputCnt < in_len - 16) {
-        xVal = _mm_loadu_si128(xPtr);
-        xPtr++;
-        lutVal1 = _mm_loadu_si128(lutPtr);
-        lutPtr++;
-        lutVal2 = _mm_loadu_si128(lutPtr);
-        lutPtr++;
-
-        SAVE_OUTPUT_SSE_8(0);
-        SAVE_OUTPUT_SSE_8(1);
-        SAVE_OUTPUT_SSE_8(2);
-        SAVE_OUTPUT_SSE_8(3);
-        SAVE_OUTPUT_SSE_8(4);
-        SAVE_OUTPUT_SSE_8(5);
-        SAVE_OUTPUT_SSE_8(6);
-        SAVE_OUTPUT_SSE_8(7);
-
-        SAVE_OUTPUT_SSE_8_2(0);
-        SAVE_OUTPUT_SSE_8_2(1);
-        SAVE_OUTPUT_SSE_8_2(2);
-        SAVE_OUTPUT_SSE_8_2(3);
-        SAVE_OUTPUT_SSE_8_2(4);
-        SAVE_OUTPUT_SSE_8_2(5);
-        SAVE_OUTPUT_SSE_8_2(6);
-        SAVE_OUTPUT_SSE_8_2(7);
-
-        intCnt += 16;
-        inputCnt += 16;
-        if (intCnt >= out_len && inputCnt < in_len - 16) {
-          /* Copy last elements */
-          if ((out_len % 16) == 12) {
-            for (int j = (nwrapps + 1) * out_len - 12; j < (nwrapps + 1) * out_len; j++) {
-              output[deinter[j % out_len]] += input[j];
-              inputCnt++;
-            }
-          } else {
-            for (int j = (nwrapps + 1) * out_len - 4; j < (nwrapps + 1) * out_len; j++) {
-              output[deinter[j % out_len]] += input[j];
-              inputCnt++;
-            }
-          }
-          /* And wrap pointers */
-          nwrapps++;
-          intCnt = 16;
-          xPtr   = (const __m128i*)&input[nwrapps * out_len];
-          lutPtr = (const __m128i*)deinter;
-        }
-      }
-      for (int i = inputCnt; i < in_len; i++) {
-        output[deinter[i % out_len]] += input[i];
-      }
+    for (int i = 0; i < in_len / 16; i++) {
+      xVal = _mm_loadu_si128(xPtr);
+      xPtr++;
+      lutVal1 = _mm_loadu_si128(lutPtr);
+      lutPtr++;
+      lutVal2 = _mm_loadu_si128(lutPtr);
+      lutPtr++;
+
+      SAVE_OUTPUT_SSE_8(0);
+      SAVE_OUTPUT_SSE_8(1);
+      SAVE_OUTPUT_SSE_8(2);
+      SAVE_OUTPUT_SSE_8(3);
+      SAVE_OUTPUT_SSE_8(4);
+      SAVE_OUTPUT_SSE_8(5);
+      SAVE_OUTPUT_SSE_8(6);
+      SAVE_OUTPUT_SSE_8(7);
+
+      SAVE_OUTPUT_SSE_8_2(0);
+      SAVE_OUTPUT_SSE_8_2(1);
+      SAVE_OUTPUT_SSE_8_2(2);
+      SAVE_OUTPUT_SSE_8_2(3);
+      SAVE_OUTPUT_SSE_8_2(4);
+      SAVE_OUTPUT_SSE_8_2(5);
+      SAVE_OUTPUT_SSE_8_2(6);
+      SAVE_OUTPUT_SSE_8_2(7);
+    }
+    for (int i = 16 * (in_len / 16); i < in_len; i++) {
+      output[deinter[i]] = rm_turbo_sat_8bit(output[deinter[i]] + input[i]);
     }
 
     return 0;
@@ -722,8 +698,6 @@ int srslte_rm_turbo_rx_lut_avx(int16_t*  input,
                                uint32_t  rv_idx)
 {
   if (rv_idx < 4 && cb_idx < SRSLTE_NOF_TC_CB_SIZES) {
-    uint32_t out_len = 3 * srslte_cbsegm_cbsize(cb_idx) + 12;
-
     const __m256i* xPtr   = (const __m256i*)input;
     const __m256i* lutPtr = (const __m256i*)deinter;
     __m256i        xVal, lutVal;
@@ -731,87 +705,32 @@ int srslte_rm_turbo_rx_lut_avx(int16_t*  input,
     int16_t  x;
     uint16_t l;
 
-    /* Simplify load if we do not need to wrap (ie high rates) */
-    if (in_len <= out_len) {
-      for (int i = 0; i < in_len / 16; i++) {
-        xVal   = _mm256_loadu_si256(xPtr);
-        lutVal = _mm256_loadu_si256(lutPtr);
-        SAVE_OUTPUT(0);
-        SAVE_OUTPUT(1);
-        SAVE_OUTPUT(2);
-        SAVE_OUTPUT(3);
-        SAVE_OUTPUT(4);
-        SAVE_OUTPUT(5);
-        SAVE_OUTPUT(6);
-        SAVE_OUTPUT(7);
-
-        SAVE_OUTPUT(8);
-        SAVE_OUTPUT(9);
-        SAVE_OUTPUT(10);
-        SAVE_OUTPUT(11);
-        SAVE_OUTPUT(12);
-        SAVE_OUTPUT(13);
-        SAVE_OUTPUT(14);
-        SAVE_OUTPUT(15);
-
-        xPtr++;
-        lutPtr++;
-      }
-      for (int i = 16 * (in_len / 16); i < in_len; i++) {
-        output[deinter[i % out_len]] += input[i];
-      }
-    } else {
-      int intCnt   = 16;
-      int inputCnt = 0;
-      int nwrapps  = 0;
-      while (inputCnt < in_len - 16) {
-        xVal   = _mm256_loadu_si256(xPtr);
-        lutVal = _mm256_loadu_si256(lutPtr);
-
-        SAVE_OUTPUT(0);
-        SAVE_OUTPUT(1);
-        SAVE_OUTPUT(2);
-        SAVE_OUTPUT(3);
-        SAVE_OUTPUT(4);
-        SAVE_OUTPUT(5);
-        SAVE_OUTPUT(6);
-        SAVE_OUTPUT(7);
-
-        SAVE_OUTPUT(8);
-        SAVE_OUTPUT(9);
-        SAVE_OUTPUT(10);
-        SAVE_OUTPUT(11);
-        SAVE_OUTPUT(12);
-        SAVE_OUTPUT(13);
-        SAVE_OUTPUT(14);
-        SAVE_OUTPUT(15);
-        xPtr++;
-        lutPtr++;
-        intCnt += 16;
-        inputCnt += 16;
-        if (intCnt >= out_len && inputCnt < in_len - 16) {
-          /* Copy last elements */
-          if ((out_len % 16) == 12) {
-            for (int j = (nwrapps + 1) * out_len - 12; j < (nwrapps + 1) * out_len; j++) {
-              output[deinter[j % out_len]] += input[j];
-              inputCnt++;
-            }
-          } else {
-            for (int j = (nwrapps + 1) * out_len - 4; j < (nwrapps + 1) * out_len; j++) {
-              output[deinter[j % out_len]] += input[j];
-              inputCnt++;
-            }
-          }
-          /* And wrap pointers */
-          nwrapps++;
-          intCnt = 16;
-          xPtr   = (const __m256i*)&input[nwrapps * out_len];
-          lutPtr = (const __m256i*)deinter;
-        }
-      }
-      for (int i = inputCnt; i < in_len; i++) {
-        output[deinter[i % out_len]] += input[i];
-      }
+    for (int i = 0; i < in_len / 16; i++) {
+      xVal   = _mm256_loadu_si256(xPtr);
+      lutVal = _mm256_loadu_si256(lutPtr);
+      SAVE_OUTPUT(0);
+      SAVE_OUTPUT(1);
+      SAVE_OUTPUT(2);
+      SAVE_OUTPUT(3);
+      SAVE_OUTPUT(4);
+      SAVE_OUTPUT(5);
+      SAVE_OUTPUT(6);
+      SAVE_OUTPUT(7);
+
+      SAVE_OUTPUT(8);
+      SAVE_OUTPUT(9);
+      SAVE_OUTPUT(10);
+      SAVE_OUTPUT(11);
+      SAVE_OUTPUT(12);
+      SAVE_OUTPUT(13);
+      SAVE_OUTPUT(14);
+      SAVE_OUTPUT(15);
+
+      xPtr++;
+      lutPtr++;
+    }
+    for (int i = 16 * (in_len / 16); i < in_len; i++) {
+      output[deinter[i]] += input[i];
     }
     return 0;
   } else {
@@ -823,12 +742,12 @@ int srslte_rm_turbo_rx_lut_avx(int16_t*  input,
 #define SAVE_OUTPUT8(j)                                                                                                \
   x = (int8_t)_mm256_extract_epi8(xVal, j);                                                                            \
   l = (uint16_t)_mm256_extract_epi16(lutVal1, j);                                                                      \
-  output[l] += x;
+  output[l] = rm_turbo_sat_8bit(output[l] + x);
 
 #define SAVE_OUTPUT8_2(j)                                                                                              \
-  x = (int8_t)_mm256_extract_epi8(xVal, j + 8);                                                                        \
+  x = (int8_t)_mm256_extract_epi8(xVal, j + 16);                                                                        \
   l = (uint16_t)_mm256_extract_epi16(lutVal2, j);                                                                      \
-  output[l] += x;
+  output[l] = rm_turbo_sat_8bit(output[l] + x);
 
 int srslte_rm_turbo_rx_lut_avx_8bit(int8_t*   input,
                                     int8_t*   output,
@@ -838,8 +757,6 @@ int srslte_rm_turbo_rx_lut_avx_8bit(int8_t*   input,
                                     uint32_t  rv_idx)
 {
   if (rv_idx < 4 && cb_idx < SRSLTE_NOF_TC_CB_SIZES) {
-    uint32_t out_len = 3 * srslte_cbsegm_cbsize(cb_idx) + 12;
-
     const __m256i* xPtr   = (const __m256i*)input;
     const __m256i* lutPtr = (const __m256i*)deinter;
     __m256i        xVal, lutVal1, lutVal2;
@@ -847,125 +764,52 @@ int srslte_rm_turbo_rx_lut_avx_8bit(int8_t*   input,
     int8_t   x;
     uint16_t l;
 
-    /* Simplify load if we do not need to wrap (ie high rates) */
-    if (in_len <= out_len) {
-      for (int i = 0; i < in_len / 32; i++) {
-        xVal = _mm256_loadu_si256(xPtr);
-        xPtr++;
-        lutVal1 = _mm256_loadu_si256(lutPtr);
-        lutPtr++;
-        lutVal2 = _mm256_loadu_si256(lutPtr);
-        lutPtr++;
-
-        SAVE_OUTPUT8(0);
-        SAVE_OUTPUT8(1);
-        SAVE_OUTPUT8(2);
-        SAVE_OUTPUT8(3);
-        SAVE_OUTPUT8(4);
-        SAVE_OUTPUT8(5);
-        SAVE_OUTPUT8(6);
-        SAVE_OUTPUT8(7);
-
-        SAVE_OUTPUT8(8);
-        SAVE_OUTPUT8(9);
-        SAVE_OUTPUT8(10);
-        SAVE_OUTPUT8(11);
-        SAVE_OUTPUT8(12);
-        SAVE_OUTPUT8(13);
-        SAVE_OUTPUT8(14);
-        SAVE_OUTPUT8(15);
-
-        SAVE_OUTPUT8_2(0);
-        SAVE_OUTPUT8_2(1);
-        SAVE_OUTPUT8_2(2);
-        SAVE_OUTPUT8_2(3);
-        SAVE_OUTPUT8_2(4);
-        SAVE_OUTPUT8_2(5);
-        SAVE_OUTPUT8_2(6);
-        SAVE_OUTPUT8_2(7);
-
-        SAVE_OUTPUT8_2(8);
-        SAVE_OUTPUT8_2(9);
-        SAVE_OUTPUT8_2(10);
-        SAVE_OUTPUT8_2(11);
-        SAVE_OUTPUT8_2(12);
-        SAVE_OUTPUT8_2(13);
-        SAVE_OUTPUT8_2(14);
-        SAVE_OUTPUT8_2(15);
-      }
-      for (int i = 32 * (in_len / 32); i < in_len; i++) {
-        output[deinter[i % out_len]] += input[i];
-      }
-    } else {
-      printf("wraps not implemented!\n");
-#ifdef kk
-      int intCnt   = 32;
-      int inputCnt = 0;
-      int nwrapps  = 0;
-      while (inputCnt < in_len - 32) {
-        xVal = _mm256_loadu_si256(xPtr);
-        xPtr++;
-        lutVal1 = _mm256_loadu_si256(lutPtr);
-        lutPtr++;
-        lutVal2 = _mm256_loadu_si256(lutPtr);
-        lutPtr++;
-
-        SAVE_OUTPUT8(0);
-        SAVE_OUTPUT8(1);
-        SAVE_OUTPUT8(2);
-        SAVE_OUTPUT8(3);
-        SAVE_OUTPUT8(4);
-        SAVE_OUTPUT8(5);
-        SAVE_OUTPUT8(6);
-        SAVE_OUTPUT8(7);
-
-        SAVE_OUTPUT8(8);
-        SAVE_OUTPUT8(9);
-        SAVE_OUTPUT8(10);
-        SAVE_OUTPUT8(11);
-        SAVE_OUTPUT8(12);
-        SAVE_OUTPUT8(13);
-        SAVE_OUTPUT8(14);
-        SAVE_OUTPUT8(15);
-
-        SAVE_OUTPUT8_2(0);
-        SAVE_OUTPUT8_2(1);
-        SAVE_OUTPUT8_2(2);
-        SAVE_OUTPUT8_2(3);
-        SAVE_OUTPUT8_2(4);
-        SAVE_OUTPUT8_2(5);
-        SAVE_OUTPUT8_2(6);
-        SAVE_OUTPUT8_2(7);
-
-        SAVE_OUTPUT8_2(8);
-        SAVE_OUTPUT8_2(9);
-        SAVE_OUTPUT8_2(10);
-        SAVE_OUTPUT8_2(11);
-        SAVE_OUTPUT8_2(12);
-        SAVE_OUTPUT8_2(13);
-        SAVE_OUTPUT8_2(14);
-        SAVE_OUTPUT8_2(15);
-
-        intCnt += 32;
-        inputCnt += 32;
-        if (intCnt >= out_len && inputCnt < in_len - 32) {
-          printf("warning rate matching wrapping remainder %d\n", out_len % 32);
-          /* Copy last elements */
-          for (int j = (nwrapps + 1) * out_len - (out_len % 32); j < (nwrapps + 1) * out_len; j++) {
-            output[deinter[j % out_len]] += input[j];
-            inputCnt++;
-          }
-          /* And wrap pointers */
-          nwrapps++;
-          intCnt = 32;
-          xPtr   = (const __m256i*)&input[nwrapps * out_len];
-          lutPtr = (const __m256i*)deinter;
-        }
-      }
-      for (int i = inputCnt; i < in_len; i++) {
-        output[deinter[i % out_len]] += input[i];
-      }
-#endif
+    for (int i = 0; i < in_len / 32; i++) {
+      xVal = _mm256_loadu_si256(xPtr);
+      xPtr++;
+      lutVal1 = _mm256_loadu_si256(lutPtr);
+      lutPtr++;
+      lutVal2 = _mm256_loadu_si256(lutPtr);
+      lutPtr++;
+
+      SAVE_OUTPUT8(0);
+      SAVE_OUTPUT8(1);
+      SAVE_OUTPUT8(2);
+      SAVE_OUTPUT8(3);
+      SAVE_OUTPUT8(4);
+      SAVE_OUTPUT8(5);
+      SAVE_OUTPUT8(6);
+      SAVE_OUTPUT8(7);
+
+      SAVE_OUTPUT8(8);
+      SAVE_OUTPUT8(9);
+      SAVE_OUTPUT8(10);
+      SAVE_OUTPUT8(11);
+      SAVE_OUTPUT8(12);
+      SAVE_OUTPUT8(13);
+      SAVE_OUTPUT8(14);
+      SAVE_OUTPUT8(15);
+
+      SAVE_OUTPUT8_2(0);
+      SAVE_OUTPUT8_2(1);
+      SAVE_OUTPUT8_2(2);
+      SAVE_OUTPUT8_2(3);
+      SAVE_OUTPUT8_2(4);
+      SAVE_OUTPUT8_2(5);
+      SAVE_OUTPUT8_2(6);
+      SAVE_OUTPUT8_2(7);
+
+      SAVE_OUTPUT8_2(8);
+      SAVE_OUTPUT8_2(9);
+      SAVE_OUTPUT8_2(10);
+      SAVE_OUTPUT8_2(11);
+      SAVE_OUTPUT8_2(12);
+      SAVE_OUTPUT8_2(13);
+      SAVE_OUTPUT8_2(14);
+      SAVE_OUTPUT8_2(15);
+    }
+    for (int i = 32 * (in_len / 32); i < in_len; i++) {
+      output[deinter[i]] = rm_turbo_sat_8bit(output[deinter[i]] + input[i]);
     }
     return 0;
   } else {
@@ -34,26 +34,39 @@
 #include "srslte/phy/fec/turbodecoder_gen.h"
 #include "srslte/phy/phch/ra.h"
 #include "srslte/phy/utils/debug.h"
+#include "srslte/phy/utils/mem_accounting.h"
 #include "srslte/phy/utils/vector.h"
 
 #define MAX_PDSCH_RE(cp) (2 * SRSLTE_CP_NSYMB(cp) * 12)
 
-int srslte_softbuffer_rx_init(srslte_softbuffer_rx_t* q, uint32_t nof_prb)
+static int softbuffer_rx_init(srslte_softbuffer_rx_t* q, uint32_t nof_prb, bool is_8bit)
 {
   int ret = SRSLTE_ERROR_INVALID_INPUTS;
 
   if (q != NULL) {
     bzero(q, sizeof(srslte_softbuffer_rx_t));
+    q->is_8bit = is_8bit;
 
     ret = srslte_ra_tbs_from_idx(SRSLTE_RA_NOF_TBS_IDX - 1, nof_prb);
     if (ret != SRSLTE_ERROR) {
       q->max_cb = (uint32_t)ret / (SRSLTE_TCOD_MAX_LEN_CB - 24) + 1;
       ret       = SRSLTE_ERROR;
 
-      q->buffer_f = srslte_vec_malloc(sizeof(int16_t*) * q->max_cb);
-      if (!q->buffer_f) {
-        perror("malloc");
-        goto clean_exit;
+      // TODO: Use HARQ buffer limitation based on UE category
+      if (is_8bit) {
+        q->buffer_b = srslte_vec_malloc(sizeof(int8_t*) * q->max_cb);
+        if (!q->buffer_b) {
+          perror("malloc");
+          goto clean_exit;
+        }
+        bzero(q->buffer_b, sizeof(int8_t*) * q->max_cb);
+      } else {
+        q->buffer_f = srslte_vec_malloc(sizeof(int16_t*) * q->max_cb);
+        if (!q->buffer_f) {
+          perror("malloc");
+          goto clean_exit;
+        }
+        bzero(q->buffer_f, sizeof(int16_t*) * q->max_cb);
       }
 
       q->data = srslte_vec_malloc(sizeof(uint8_t*) * q->max_cb);
@@ -61,6 +74,7 @@ int srslte_softbuffer_rx_init(srslte_softbuffer_rx_t* q, uint32_t nof_prb)
         perror("malloc");
         goto clean_exit;
       }
+      bzero(q->data, sizeof(uint8_t*) * q->max_cb);
 
       q->cb_crc = srslte_vec_malloc(sizeof(bool) * q->max_cb);
       if (!q->cb_crc) {
@@ -69,21 +83,6 @@ int srslte_softbuffer_rx_init(srslte_softbuffer_rx_t* q, uint32_t nof_prb)
       }
       bzero(q->cb_crc, sizeof(bool) * q->max_cb);
 
-      // TODO: Use HARQ buffer limitation based on UE category
-      for (uint32_t i = 0; i < q->max_cb; i++) {
-        q->buffer_f[i] = srslte_vec_i16_malloc(SOFTBUFFER_SIZE);
-        if (!q->buffer_f[i]) {
-          perror("malloc");
-          goto clean_exit;
-        }
-
-        q->data[i] = srslte_vec_u8_malloc(6144 / 8);
-        if (!q->data[i]) {
-          perror("malloc");
-          goto clean_exit;
-        }
-      }
-      // srslte_softbuffer_rx_reset(q);
       ret = SRSLTE_SUCCESS;
     }
   }
@@ -96,21 +95,95 @@ clean_exit:
   return ret;
 }
 
+int srslte_softbuffer_rx_init(srslte_softbuffer_rx_t* q, uint32_t nof_prb)
+{
+  return softbuffer_rx_init(q, nof_prb, false);
+}
+
+int srslte_softbuffer_rx_init_8bit(srslte_softbuffer_rx_t* q, uint32_t nof_prb)
+{
+  return softbuffer_rx_init(q, nof_prb, true);
+}
+
+/* Soft bits of a codeblock for the 16-bit decoder. Allocated and zeroed on the first call, returns NULL if the
+ * softbuffer is an 8-bit one or the allocation fails */
+int16_t* srslte_softbuffer_rx_get_cb(srslte_softbuffer_rx_t* q, uint32_t cb_idx)
+{
+  if (q->is_8bit || cb_idx >= q->max_cb) {
+    return NULL;
+  }
+  if (!q->buffer_f[cb_idx]) {
+    q->buffer_f[cb_idx] = srslte_mem_malloc(SRSLTE_MEM_TAG_SOFTBUFFER, sizeof(int16_t) * SOFTBUFFER_SIZE);
+    if (!q->buffer_f[cb_idx]) {
+      perror("malloc");
+      return NULL;
+    }
+    bzero(q->buffer_f[cb_idx], SOFTBUFFER_SIZE * sizeof(int16_t));
+  }
+  return q->buffer_f[cb_idx];
+}
+
+/* Soft bits of a codeblock for the 8-bit decoder. A 16-bit softbuffer gives its buffer to the 8-bit decoder, which
+ * only uses the first half of it */
+int8_t* srslte_softbuffer_rx_get_cb_8bit(srslte_softbuffer_rx_t* q, uint32_t cb_idx)
+{
+  if (!q->is_8bit) {
+    return (int8_t*)srslte_softbuffer_rx_get_cb(q, cb_idx);
+  }
+  if (cb_idx >= q->max_cb) {
+    return NULL;
+  }
+  if (!q->buffer_b[cb_idx]) {
+    q->buffer_b[cb_idx] = srslte_mem_malloc(SRSLTE_MEM_TAG_SOFTBUFFER, sizeof(int8_t) * SOFTBUFFER_SIZE);
+    if (!q->buffer_b[cb_idx]) {
+      perror("malloc");
+      return NULL;
+    }
+    bzero(q->buffer_b[cb_idx], SOFTBUFFER_SIZE * sizeof(int8_t));
+  }
+  return q->buffer_b[cb_idx];
+}
+
+/* Decoded bits of a codeblock, kept for the retransmissions of the transport block */
+uint8_t* srslte_softbuffer_rx_get_data(srslte_softbuffer_rx_t* q, uint32_t cb_idx)
+{
+  if (cb_idx >= q->max_cb) {
+    return NULL;
+  }
+  if (!q->data[cb_idx]) {
+    q->data[cb_idx] = srslte_mem_malloc(SRSLTE_MEM_TAG_SOFTBUFFER, sizeof(uint8_t) * 6144 / 8);
+    if (!q->data[cb_idx]) {
+      perror("malloc");
+      return NULL;
+    }
+    bzero(q->data[cb_idx], sizeof(uint8_t) * 6144 / 8);
+  }
+  return q->data[cb_idx];
+}
+
 void srslte_softbuffer_rx_free(srslte_softbuffer_rx_t* q)
 {
   if (q) {
     if (q->buffer_f) {
       for (uint32_t i = 0; i < q->max_cb; i++) {
         if (q->buffer_f[i]) {
-          free(q->buffer_f[i]);
+          srslte_mem_free(q->buffer_f[i]);
         }
       }
       free(q->buffer_f);
     }
+    if (q->buffer_b) {
+      for (uint32_t i = 0; i < q->max_cb; i++) {
+        if (q->buffer_b[i]) {
+          srslte_mem_free(q->buffer_b[i]);
+        }
+      }
+      free(q->buffer_b);
+    }
     if (q->data) {
       for (uint32_t i = 0; i < q->max_cb; i++) {
         if (q->data[i]) {
-          free(q->data[i]);
+          srslte_mem_free(q->data[i]);
         }
       }
       free(q->data);
@@ -135,14 +208,18 @@ void srslte_softbuffer_rx_reset(srslte_softbuffer_rx_t* q)
 
 void srslte_softbuffer_rx_reset_cb(srslte_softbuffer_rx_t* q, uint32_t nof_cb)
 {
-  if (q->buffer_f) {
+  if (q->data) {
     if (nof_cb > q->max_cb) {
       nof_cb = q->max_cb;
     }
+    // Only the codeblocks decoded so far have a buffer
     for (uint32_t i = 0; i < nof_cb; i++) {
-      if (q->buffer_f[i]) {
+      if (q->buffer_f && q->buffer_f[i]) {
         bzero(q->buffer_f[i], SOFTBUFFER_SIZE * sizeof(int16_t));
       }
+      if (q->buffer_b && q->buffer_b[i]) {
+        bzero(q->buffer_b[i], SOFTBUFFER_SIZE * sizeof(int8_t));
+      }
       if (q->data[i]) {
         bzero(q->data[i], sizeof(uint8_t) * 6144 / 8);
       }
@@ -173,7 +250,7 @@ int srslte_softbuffer_tx_init(srslte_softbuffer_tx_t* q, uint32_t nof_prb)
 
       // TODO: Use HARQ buffer limitation based on UE category
       for (uint32_t i = 0; i < q->max_cb; i++) {
-        q->buffer_b[i] = srslte_vec_u8_malloc(SOFTBUFFER_SIZE);
+        q->buffer_b[i] = srslte_mem_malloc(SRSLTE_MEM_TAG_SOFTBUFFER, sizeof(uint8_t) * SOFTBUFFER_SIZE);
         if (!q->buffer_b[i]) {
           perror("malloc");
           return SRSLTE_ERROR;
@@ -192,7 +269,7 @@ void srslte_softbuffer_tx_free(srslte_softbuffer_tx_t* q)
     if (q->buffer_b) {
       for (uint32_t i = 0; i < q->max_cb; i++) {
         if (q->buffer_b[i]) {
-          free(q->buffer_b[i]);
+          srslte_mem_free(q->buffer_b[i]);
         }
       }
       free(q->buffer_b);
@@ -20,6 +20,7 @@
  */
 
 #include <math.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -100,6 +101,55 @@ int main(int argc, char** argv)
   // generate CRC word
   crc_word = srslte_crc_checksum(&crc_p, data, num_bits);
 
+  // check the byte engines against the bit-wise CRC for every whole-byte length
+  uint32_t nof_bytes = num_bits / 8;
+  uint8_t* data_bytes = srslte_vec_u8_malloc(nof_bytes);
+  if (!data_bytes) {
+    perror("malloc");
+    exit(-1);
+  }
+  srslte_bit_pack_vector(data, data_bytes, 8 * nof_bytes);
+
+  bool use_clmul = crc_p.use_clmul;
+  for (uint32_t n = 0; n <= nof_bytes; n++) {
+    uint32_t bit_word = srslte_crc_checksum(&crc_p, data, 8 * n);
+
+    crc_p.use_clmul     = false;
+    uint32_t table_word = srslte_crc_checksum_byte(&crc_p, data_bytes, 8 * n);
+    crc_p.use_clmul     = use_clmul;
+    uint32_t byte_word  = srslte_crc_checksum_byte(&crc_p, data_bytes, 8 * n);
+
+    if (bit_word != table_word || bit_word != byte_word) {
+      ERROR("Byte CRC mismatch for %d bytes: 0x%x (bits), 0x%x (table), 0x%x\n", n, bit_word, table_word, byte_word);
+      exit(-1);
+    }
+  }
+
+  // check the batch interface with blocks of different lengths
+  uint8_t* batch_data[3]     = {data_bytes, &data_bytes[1], &data_bytes[nof_bytes / 2]};
+  uint32_t batch_len[3]      = {8 * nof_bytes, 8 * (nof_bytes - 1), 8 * (nof_bytes / 2)};
+  uint32_t batch_checksum[3] = {};
+  srslte_crc_checksum_byte_batch(&crc_p, batch_data, batch_len, 3, batch_checksum);
+  for (uint32_t i = 0; i < 3; i++) {
+    if (batch_checksum[i] != srslte_crc_checksum_byte(&crc_p, batch_data[i], batch_len[i])) {
+      ERROR("Batch CRC mismatch in block %d\n", i);
+      exit(-1);
+    }
+  }
+
+  // check that splitting the message across several put_bytes calls gives the same checksum
+  uint32_t full_word = srslte_crc_checksum_byte(&crc_p, data_bytes, 8 * nof_bytes);
+  for (uint32_t n = 0; n <= nof_bytes; n += 7) {
+    srslte_crc_set_init(&crc_p, 0);
+    srslte_crc_checksum_put_bytes(&crc_p, data_bytes, n);
+    srslte_crc_checksum_put_bytes(&crc_p, &data_bytes[n], nof_bytes - n);
+    if (srslte_crc_checksum_get(&crc_p) != full_word) {
+      ERROR("Streamed CRC mismatch when splitting at byte %d\n", n);
+      exit(-1);
+    }
+  }
+
+  free(data_bytes);
   free(data);
 
   // check if generated word is as expected
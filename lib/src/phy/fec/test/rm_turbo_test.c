@@ -36,6 +36,7 @@ uint32_t cb_idx     = 0;
 
 uint8_t systematic[6148], parity[2 * 6148];
 uint8_t systematic_bytes[6148 / 8 + 1], parity_bytes[2 * 6148 / 8 + 1];
+uint8_t systematic_split[6148 / 8 + 1];
 
 #define BUFFSZ (6176 * 3)
 
@@ -43,7 +44,8 @@ uint8_t bits[3 * 6144 + 12];
 uint8_t buff_b[BUFFSZ];
 float   buff_f[BUFFSZ];
 float   bits_f[3 * 6144 + 12];
-short   bits2_s[3 * 6144 + 12];
+int8_t  bits2_b[3 * 6176 + 12];
+short   bits2_s[3 * 6176 + 12];
 
 void usage(char* prog)
 {
@@ -80,6 +82,7 @@ int main(int argc, char** argv)
   int      i;
   uint8_t *rm_bits, *rm_bits2, *rm_bits2_bytes;
   short*   rm_bits_s;
+  int8_t*  rm_bits_b;
   float*   rm_bits_f;
 
   parse_args(argc, argv);
@@ -91,6 +94,11 @@ int main(int argc, char** argv)
     perror("malloc");
     exit(-1);
   }
+  rm_bits_b = srslte_vec_i8_malloc(nof_e_bits);
+  if (!rm_bits_b) {
+    perror("malloc");
+    exit(-1);
+  }
   rm_bits_f = srslte_vec_f_malloc(nof_e_bits);
   if (!rm_bits_f) {
     perror("malloc");
@@ -170,9 +178,46 @@ int main(int argc, char** argv)
 
       printf("OK TX...");
 
+      /* Same output reading the CB CRC and the tail bits from another buffer, whatever follows the CB data */
+      uint32_t split = srslte_cbsegm_cbsize(cb_idx) - 24;
+      memcpy(systematic_split, systematic_bytes, sizeof(systematic_split));
+      for (i = split / 8; i < long_cb_enc / 24 + 1; i++) {
+        systematic_split[i] = ~systematic_bytes[i];
+      }
+
+      bzero(buff_b, BUFFSZ * sizeof(uint8_t));
+      bzero(rm_bits2_bytes, nof_e_bits / 8);
+      srslte_rm_turbo_tx_lut_split(buff_b,
+                                   systematic_split,
+                                   &systematic_bytes[split / 8],
+                                   split,
+                                   parity_bytes,
+                                   rm_bits2_bytes,
+                                   cb_idx,
+                                   nof_e_bits,
+                                   0,
+                                   0);
+      if (rv_idx > 0) {
+        bzero(rm_bits2_bytes, nof_e_bits / 8);
+        srslte_rm_turbo_tx_lut_split(
+            buff_b, NULL, NULL, 0, parity_bytes, rm_bits2_bytes, cb_idx, nof_e_bits, 0, rv_idx);
+      }
+
+      srslte_bit_unpack_vector(rm_bits2_bytes, rm_bits2, nof_e_bits);
+
+      for (int i = 0; i < nof_e_bits; i++) {
+        if (rm_bits2[i] != rm_bits[i]) {
+          printf("Error in split TX bit %d\n", i);
+          exit(-1);
+        }
+      }
+
+      printf("OK TX split...");
+
       for (int i = 0; i < nof_e_bits; i++) {
         rm_bits_f[i] = rand() % 10 - 5;
         rm_bits_s[i] = (short)rm_bits_f[i];
+        rm_bits_b[i] = (int8_t)rm_bits_f[i];
       }
 
       srslte_vec_f_zero(buff_f, BUFFSZ);
@@ -188,12 +233,32 @@ int main(int argc, char** argv)
         }
       }
 
-      printf("OK RX\n");
+      printf("OK RX...");
+
+      // The 8-bit path writes the decoder input format, compare against the 16-bit one when both match
+      uint32_t cb_len = srslte_cbsegm_cbsize(cb_idx);
+      if (srslte_tdec_autoimp_get_subblocks(cb_len) == srslte_tdec_autoimp_get_subblocks_8bit(cb_len)) {
+        bzero(bits2_s, sizeof(bits2_s));
+        srslte_rm_turbo_rx_lut(rm_bits_s, bits2_s, nof_e_bits, cb_idx, rv_idx);
+
+        bzero(bits2_b, sizeof(bits2_b));
+        srslte_rm_turbo_rx_lut_8bit(rm_bits_b, bits2_b, nof_e_bits, cb_idx, rv_idx);
+
+        for (int i = 0; i < sizeof(bits2_b); i++) {
+          if (bits2_s[i] != bits2_b[i]) {
+            printf("error RX 8-bit in bit %d %d!=%d\n", i, bits2_s[i], bits2_b[i]);
+            exit(-1);
+          }
+        }
+      }
+
+      printf("OK RX 8-bit\n");
     }
   }
 
   srslte_rm_turbo_free_tables();
   free(rm_bits_s);
+  free(rm_bits_b);
   free(rm_bits_f);
   free(rm_bits);
   free(rm_bits2);
@@ -21,6 +21,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 #include <unistd.h>
 
@@ -59,6 +60,10 @@ uint8_t parity[3 * 6144 + 12];
 uint8_t parity_bits[3 * 6144 + 12];
 uint8_t output_bits[3 * 6144 + 12];
 uint8_t output_bits2[3 * 6144 + 12];
+uint8_t cb_bytes[6144 / 8 + 3];
+uint8_t tb_bytes[6144 / 8 + 3];
+uint8_t cb_tail[4];
+uint8_t parity2[3 * 6144 + 12];
 
 int main(int argc, char** argv)
 {
@@ -97,6 +102,12 @@ int main(int argc, char** argv)
       printf("error initialising CRC\n");
       exit(-1);
     }
+    srslte_crc_t crc_cb;
+    bzero(&crc_cb, sizeof(crc_cb));
+    if (srslte_crc_init(&crc_cb, SRSLTE_LTE_CRC24B, 24)) {
+      printf("error initialising CRC\n");
+      exit(-1);
+    }
 
     srslte_tcod_encode(&tcod, input_bits, output_bits, long_cb);
     srslte_tcod_encode_lut(&tcod, &crc_tb, NULL, input_bytes, parity, len, false);
@@ -120,6 +131,23 @@ int main(int argc, char** argv)
         exit(-1);
       }
     }
+
+    /* A CB with CB CRC encoded from the TB buffer matches the CB encoded in place, and the TB buffer is unchanged */
+    memcpy(cb_bytes, input_bytes, sizeof(cb_bytes));
+    srslte_crc_set_init(&crc_tb, 0);
+    srslte_tcod_encode_lut(&tcod, &crc_tb, &crc_cb, cb_bytes, parity, len, false);
+    uint32_t checksum_tb = srslte_crc_checksum_get(&crc_tb);
+
+    memcpy(tb_bytes, input_bytes, sizeof(tb_bytes));
+    srslte_crc_set_init(&crc_tb, 0);
+    srslte_tcod_encode_lut_cb(&tcod, &crc_tb, &crc_cb, tb_bytes, cb_tail, parity2, len);
+
+    if (memcmp(parity, parity2, (2 * long_cb + 8) / 8) != 0 ||
+        memcmp(&cb_bytes[long_cb / 8 - 3], cb_tail, sizeof(cb_tail)) != 0 ||
+        memcmp(tb_bytes, input_bytes, sizeof(tb_bytes)) != 0 || srslte_crc_checksum_get(&crc_tb) != checksum_tb) {
+      printf("error in CB encoded from the TB buffer, len=%d\n", len);
+      exit(-1);
+    }
   }
 
   srslte_tcod_free(&tcod);
@@ -0,0 +1,421 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Turbo decoder throughput benchmark. Sweeps codeblock sizes, number of half-iterations and decoder implementations
+ * (every one compiled in, with 16-bit and 8-bit LLRs) on a single thread and reports, for each configuration, the
+ * throughput per core, the cycles per decoded bit and the latency percentiles of a codeblock in CSV or JSON.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "srslte/phy/utils/random.h"
+#include "srslte/srslte.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC
+#endif
+
+#define MAX_LIST_LEN SRSLTE_NOF_TC_CB_SIZES
+
+typedef struct {
+  const char*             name;
+  srslte_tdec_impl_type_t type;
+  srslte_tdec_llr_type_t  llr_type;
+} bench_impl_t;
+
+static const bench_impl_t bench_impls[] = {
+    {"auto16", SRSLTE_TDEC_AUTO, SRSLTE_TDEC_16},
+    {"auto8", SRSLTE_TDEC_AUTO, SRSLTE_TDEC_8},
+    {"generic", SRSLTE_TDEC_GENERIC, SRSLTE_TDEC_16},
+    {"sse", SRSLTE_TDEC_SSE, SRSLTE_TDEC_16},
+    {"sse_win", SRSLTE_TDEC_SSE_WINDOW, SRSLTE_TDEC_16},
+    {"neon_win", SRSLTE_TDEC_NEON_WINDOW, SRSLTE_TDEC_16},
+    {"avx_win", SRSLTE_TDEC_AVX_WINDOW, SRSLTE_TDEC_16},
+    {"avx512_win", SRSLTE_TDEC_AVX512_WINDOW, SRSLTE_TDEC_16},
+    {"sse8_win", SRSLTE_TDEC_SSE8_WINDOW, SRSLTE_TDEC_8},
+    {"avx8_win", SRSLTE_TDEC_AVX8_WINDOW, SRSLTE_TDEC_8},
+    {"avx512_8_win", SRSLTE_TDEC_AVX512_8_WINDOW, SRSLTE_TDEC_8},
+};
+
+#define NOF_BENCH_IMPLS (sizeof(bench_impls) / sizeof(bench_impl_t))
+
+static char*    cb_len_list  = "40,512,1024,2048,3072,4096,6144";
+static char*    n_iter_list  = "4,8,16";
+static char*    impl_list    = "all";
+static uint32_t nof_cb       = 200;
+static float    ebno_db      = 5.0f;
+static uint32_t seed         = 0;
+static bool     json         = false;
+static char*    output_fname = NULL;
+
+void usage(char* prog)
+{
+  printf("Usage: %s [lidnesjo]\n", prog);
+  printf("\t-l comma separated codeblock sizes [Default %s]\n", cb_len_list);
+  printf("\t-i comma separated number of half-iterations [Default %s]\n", n_iter_list);
+  printf("\t-d comma separated decoder implementations or 'all' [Default %s]:", impl_list);
+  for (uint32_t i = 0; i < NOF_BENCH_IMPLS; i++) {
+    printf(" %s", bench_impls[i].name);
+  }
+  printf("\n");
+  printf("\t-n number of codeblocks per configuration [Default %d]\n", nof_cb);
+  printf("\t-e Eb/No in dB [Default %.1f]\n", ebno_db);
+  printf("\t-s seed [Default 0=time]\n");
+  printf("\t-j output JSON instead of CSV [Default CSV]\n");
+  printf("\t-o output file name [Default stdout]\n");
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "lidnesjo")) != -1) {
+    switch (opt) {
+      case 'l':
+        cb_len_list = argv[optind];
+        break;
+      case 'i':
+        n_iter_list = argv[optind];
+        break;
+      case 'd':
+        impl_list = argv[optind];
+        break;
+      case 'n':
+        nof_cb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'e':
+        ebno_db = strtof(argv[optind], NULL);
+        break;
+      case 's':
+        seed = (uint32_t)strtoul(argv[optind], NULL, 0);
+        break;
+      case 'j':
+        json = true;
+        break;
+      case 'o':
+        output_fname = argv[optind];
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+static uint32_t parse_list(const char* str, uint32_t* list)
+{
+  uint32_t n = 0;
+  char*    end;
+  while (n < MAX_LIST_LEN && *str) {
+    list[n++] = (uint32_t)strtoul(str, &end, 10);
+    if (*end != ',') {
+      break;
+    }
+    str = end + 1;
+  }
+  return n;
+}
+
+static bool impl_selected(const char* name)
+{
+  if (!strcmp(impl_list, "all")) {
+    return true;
+  }
+  size_t len = strlen(name);
+  for (const char* p = strstr(impl_list, name); p; p = strstr(p + 1, name)) {
+    if ((p == impl_list || p[-1] == ',') && (p[len] == ',' || p[len] == '\0')) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* The sub-block (window) implementations need codeblocks split in sub-blocks of more than 50 bits, the same rule
+ * the automatic selection follows */
+static bool impl_supports(srslte_tdec_t* tdec, const bench_impl_t* impl, uint32_t long_cb)
+{
+  if (impl->type == SRSLTE_TDEC_AUTO) {
+    return true;
+  }
+  int nof_sb = impl->llr_type == SRSLTE_TDEC_16 ? tdec->nof_blocks16[0] : tdec->nof_blocks8[0];
+  return nof_sb <= 1 || (!(long_cb % nof_sb) && long_cb > 50 * nof_sb);
+}
+
+static inline uint64_t bench_cycles()
+{
+#ifdef BENCH_HAVE_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static inline double bench_usec()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e6 + t.tv_nsec * 1e-3;
+}
+
+static int cmp_double(const void* a, const void* b)
+{
+  double x = *(const double*)a;
+  double y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+static double percentile(const double* sorted, uint32_t n, double p)
+{
+  uint32_t idx = (uint32_t)ceil(p * n) - 1;
+  return sorted[SRSLTE_MIN(idx, n - 1)];
+}
+
+int main(int argc, char** argv)
+{
+  uint32_t cb_lens[MAX_LIST_LEN];
+  uint32_t n_iters[MAX_LIST_LEN];
+  FILE*    f       = stdout;
+  bool     first   = true;
+  int      ret     = SRSLTE_SUCCESS;
+  uint32_t max_len = 0;
+
+  parse_args(argc, argv);
+
+  uint32_t nof_cb_lens = parse_list(cb_len_list, cb_lens);
+  uint32_t nof_n_iters = parse_list(n_iter_list, n_iters);
+  if (!nof_cb_lens || !nof_n_iters || !nof_cb) {
+    usage(argv[0]);
+    exit(-1);
+  }
+
+  for (uint32_t i = 0; i < nof_cb_lens; i++) {
+    int cb_idx = srslte_cbsegm_cbindex(cb_lens[i]);
+    if (cb_idx < 0) {
+      ERROR("Invalid codeblock size %d\n", cb_lens[i]);
+      exit(-1);
+    }
+    max_len = SRSLTE_MAX(max_len, cb_lens[i]);
+  }
+
+  if (!seed) {
+    seed = time(NULL);
+  }
+  srslte_random_t random_gen = srslte_random_init(seed);
+
+  if (output_fname) {
+    f = fopen(output_fname, "w");
+    if (!f) {
+      perror("fopen");
+      exit(-1);
+    }
+  }
+
+  // Every codeblock input starts SIMD aligned, as the decoders expect
+  uint32_t coded_length = 3 * max_len + SRSLTE_TCOD_TOTALTAIL;
+  uint32_t llr_stride   = ((coded_length + 63) / 64) * 64;
+  uint8_t* data_tx      = srslte_vec_u8_malloc(max_len * nof_cb);
+  uint8_t* data_rx      = srslte_vec_u8_malloc(max_len);
+  uint8_t* data_rx_bits = srslte_vec_u8_malloc(max_len);
+  uint8_t* symbols      = srslte_vec_u8_malloc(coded_length);
+  float*   llr          = srslte_vec_f_malloc(coded_length);
+  int16_t* llr_s        = srslte_vec_i16_malloc(llr_stride * nof_cb);
+  int8_t*  llr_b        = srslte_vec_i8_malloc(llr_stride * nof_cb);
+  double*  latency      = malloc(sizeof(double) * nof_cb);
+  if (!data_tx || !data_rx || !data_rx_bits || !symbols || !llr || !llr_s || !llr_b || !latency) {
+    perror("malloc");
+    exit(-1);
+  }
+
+  // Implementations that are not compiled in fail to initialise (reported in stderr) and are skipped
+  bool impl_available[NOF_BENCH_IMPLS];
+  for (uint32_t d = 0; d < NOF_BENCH_IMPLS; d++) {
+    srslte_tdec_t tdec;
+    impl_available[d] =
+        impl_selected(bench_impls[d].name) && !srslte_tdec_init_manual(&tdec, max_len, bench_impls[d].type);
+    if (impl_available[d]) {
+      srslte_tdec_free(&tdec);
+    }
+  }
+
+  srslte_tcod_t tcod;
+  if (srslte_tcod_init(&tcod, max_len)) {
+    ERROR("Error initiating Turbo coder\n");
+    exit(-1);
+  }
+
+  if (json) {
+    fprintf(f, "[\n");
+  } else {
+    fprintf(f,
+            "impl,llr_bits,cb_len,half_iterations,nof_cb,mbps_per_core,cycles_per_bit,mean_us,p50_us,p90_us,p99_us,"
+            "max_us,ber\n");
+  }
+
+  float esno_db = ebno_db + srslte_convert_power_to_dB(1.0f / 3.0f);
+  float var     = srslte_convert_dB_to_amplitude(-esno_db);
+
+  for (uint32_t l = 0; l < nof_cb_lens; l++) {
+    uint32_t long_cb   = cb_lens[l];
+    uint32_t coded_len = 3 * long_cb + SRSLTE_TCOD_TOTALTAIL;
+
+    // The same noisy codeblocks are decoded by every implementation
+    for (uint32_t n = 0; n < nof_cb; n++) {
+      uint8_t* tx = &data_tx[n * max_len];
+      for (uint32_t j = 0; j < long_cb; j++) {
+        tx[j] = (uint8_t)srslte_random_uniform_int_dist(random_gen, 0, 1);
+      }
+      srslte_tcod_encode(&tcod, tx, symbols, long_cb);
+      for (uint32_t j = 0; j < coded_len; j++) {
+        llr[j] = symbols[j] ? 1 : -1;
+      }
+      srslte_ch_awgn_f(llr, llr, var, coded_len);
+      for (uint32_t j = 0; j < coded_len; j++) {
+        llr_s[n * llr_stride + j] = (int16_t)SRSLTE_MAX(SRSLTE_MIN(100 * llr[j], INT16_MAX), -INT16_MAX);
+        llr_b[n * llr_stride + j] = (int8_t)SRSLTE_MAX(SRSLTE_MIN(20 * llr[j], INT8_MAX), -INT8_MAX);
+      }
+    }
+
+    for (uint32_t d = 0; d < NOF_BENCH_IMPLS; d++) {
+      const bench_impl_t* impl = &bench_impls[d];
+      if (!impl_available[d]) {
+        continue;
+      }
+
+      srslte_tdec_t tdec;
+      if (srslte_tdec_init_manual(&tdec, max_len, impl->type)) {
+        ERROR("Error initiating Turbo decoder %s\n", impl->name);
+        exit(-1);
+      }
+      srslte_tdec_force_not_sb(&tdec);
+      if (!impl_supports(&tdec, impl, long_cb)) {
+        srslte_tdec_free(&tdec);
+        continue;
+      }
+
+      for (uint32_t t = 0; t < nof_n_iters; t++) {
+        uint32_t errors     = 0;
+        uint64_t cycles     = 0;
+        double   total_usec = 0;
+
+        for (uint32_t n = 0; n < nof_cb; n++) {
+          double   t0 = bench_usec();
+          uint64_t c0 = bench_cycles();
+          if (impl->llr_type == SRSLTE_TDEC_16) {
+            srslte_tdec_run_all(&tdec, &llr_s[n * llr_stride], data_rx, n_iters[t], long_cb);
+          } else {
+            srslte_tdec_run_all_8bit(&tdec, &llr_b[n * llr_stride], data_rx, n_iters[t], long_cb);
+          }
+          cycles += bench_cycles() - c0;
+          latency[n] = bench_usec() - t0;
+          total_usec += latency[n];
+
+          srslte_bit_unpack_vector(data_rx, data_rx_bits, long_cb);
+          errors += srslte_bit_diff(&data_tx[n * max_len], data_rx_bits, long_cb);
+        }
+
+        qsort(latency, nof_cb, sizeof(double), cmp_double);
+
+        double mean_us   = total_usec / nof_cb;
+        double mbps      = long_cb / mean_us;
+        double cycles_pb = (double)cycles / ((double)long_cb * nof_cb);
+        double ber       = (double)errors / ((double)long_cb * nof_cb);
+        double p50       = percentile(latency, nof_cb, 0.50);
+        double p90       = percentile(latency, nof_cb, 0.90);
+        double p99       = percentile(latency, nof_cb, 0.99);
+        double max_us    = latency[nof_cb - 1];
+        int    llr_bits  = impl->llr_type == SRSLTE_TDEC_16 ? 16 : 8;
+
+        if (json) {
+          fprintf(f,
+                  "%s  {\"impl\": \"%s\", \"llr_bits\": %d, \"cb_len\": %d, \"half_iterations\": %d, \"nof_cb\": %d, "
+                  "\"mbps_per_core\": %.2f, \"cycles_per_bit\": %.2f, \"mean_us\": %.2f, \"p50_us\": %.2f, "
+                  "\"p90_us\": %.2f, \"p99_us\": %.2f, \"max_us\": %.2f, \"ber\": %.3e}",
+                  first ? "" : ",\n",
+                  impl->name,
+                  llr_bits,
+                  long_cb,
+                  n_iters[t],
+                  nof_cb,
+                  mbps,
+                  cycles_pb,
+                  mean_us,
+                  p50,
+                  p90,
+                  p99,
+                  max_us,
+                  ber);
+        } else {
+          fprintf(f,
+                  "%s,%d,%d,%d,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.3e\n",
+                  impl->name,
+                  llr_bits,
+                  long_cb,
+                  n_iters[t],
+                  nof_cb,
+                  mbps,
+                  cycles_pb,
+                  mean_us,
+                  p50,
+                  p90,
+                  p99,
+                  max_us,
+                  ber);
+        }
+        first = false;
+      }
+
+      srslte_tdec_free(&tdec);
+    }
+  }
+
+  if (json) {
+    fprintf(f, "\n]\n");
+  }
+
+  if (first) {
+    ERROR("No decoder implementation matches '%s'\n", impl_list);
+    ret = SRSLTE_ERROR;
+  }
+
+  if (f != stdout) {
+    fclose(f);
+  }
+
+  free(data_tx);
+  free(data_rx);
+  free(data_rx_bits);
+  free(symbols);
+  free(llr);
+  free(llr_s);
+  free(llr_b);
+  free(latency);
+  srslte_tcod_free(&tcod);
+  srslte_random_free(random_gen);
+
+  exit(ret);
+}
@@ -45,6 +45,7 @@ int nof_iterations  = MAX_ITERATIONS;
 int test_known_data = 0;
 int test_errors     = 0;
 int nof_repetitions = 1;
+int ref_type        = -1;
 
 srslte_tdec_impl_type_t tdec_type;
 
@@ -54,7 +55,7 @@ srslte_tdec_impl_type_t tdec_type;
 
 void usage(char* prog)
 {
-  printf("Usage: %s [kcinNledts]\n", prog);
+  printf("Usage: %s [kcinNledrts]\n", prog);
   printf("\t-k Test with known data (ignores frame_length) [Default disabled]\n");
   printf("\t-c nof_cb in parallel [Default %d]\n", nof_cb);
   printf("\t-i nof_iterations [Default %d]\n", nof_iterations);
@@ -63,6 +64,7 @@ void usage(char* prog)
   printf("\t-l frame_length [Default %d]\n", frame_length);
   printf("\t-e ebno in dB [Default scan]\n");
   printf("\t-d Decoder implementation type: 0: Generic, 1: SSE, 2: SSE-window\n");
+  printf("\t-r Reference decoder implementation type, the decoded bits must match it [Default disabled]\n");
   printf("\t-t test: check errors on exit [Default disabled]\n");
   printf("\t-s seed [Default 0=time]\n");
 }
@@ -70,7 +72,7 @@ void usage(char* prog)
 void parse_args(int argc, char** argv)
 {
   int opt;
-  while ((opt = getopt(argc, argv, "kcinNledts")) != -1) {
+  while ((opt = getopt(argc, argv, "kcinNledrts")) != -1) {
     switch (opt) {
       case 'c':
         nof_cb = (int)strtol(argv[optind], NULL, 10);
@@ -96,6 +98,9 @@ void parse_args(int argc, char** argv)
       case 'd':
         tdec_type = (srslte_tdec_impl_type_t)strtol(argv[optind], NULL, 10);
         break;
+      case 'r':
+        ref_type = (int)strtol(argv[optind], NULL, 10);
+        break;
       case 'e':
         ebno_db = strtof(argv[optind], NULL);
         break;
@@ -112,22 +117,38 @@ void parse_args(int argc, char** argv)
   }
 }
 
+static bool tdec_type_is_8bit(srslte_tdec_impl_type_t type)
+{
+  return type == SRSLTE_TDEC_SSE8_WINDOW || type == SRSLTE_TDEC_AVX8_WINDOW || type == SRSLTE_TDEC_AVX512_8_WINDOW;
+}
+
+static int
+run_decoder(srslte_tdec_t* h, srslte_tdec_impl_type_t type, int16_t* llr_s, int8_t* llr_c, uint8_t* out, uint32_t t)
+{
+  if (tdec_type_is_8bit(type)) {
+    return srslte_tdec_run_all_8bit(h, llr_c, out, t, frame_length);
+  }
+  return srslte_tdec_run_all(h, llr_s, out, t, frame_length);
+}
+
 int main(int argc, char** argv)
 {
   srslte_random_t random_gen = srslte_random_init(0);
   uint32_t        frame_cnt;
   float*          llr;
   short*          llr_s;
-  uint8_t*        llr_c;
-  uint8_t *       data_tx, *data_rx, *data_rx_bytes, *symbols;
+  int8_t*         llr_c;
+  uint8_t *       data_tx, *data_rx, *data_rx_bytes, *data_rx_bytes_ref, *symbols;
   uint32_t        i, j;
   float           var[SNR_POINTS];
   uint32_t        snr_points;
-  uint32_t        errors = 0;
+  uint32_t        errors         = 0;
+  uint32_t        ref_mismatches = 0;
   uint32_t        coded_length;
   struct timeval  tdata[3];
   float           mean_usec;
   srslte_tdec_t   tdec;
+  srslte_tdec_t   tdec_ref;
   srslte_tcod_t   tcod;
 
   parse_args(argc, argv);
@@ -166,6 +187,11 @@ int main(int argc, char** argv)
     perror("malloc");
     exit(-1);
   }
+  data_rx_bytes_ref = srslte_vec_u8_malloc(frame_length);
+  if (!data_rx_bytes_ref) {
+    perror("malloc");
+    exit(-1);
+  }
 
   symbols = srslte_vec_u8_malloc(coded_length);
   if (!symbols) {
@@ -182,7 +208,7 @@ int main(int argc, char** argv)
     perror("malloc");
     exit(-1);
   }
-  llr_c = srslte_vec_u8_malloc(coded_length);
+  llr_c = srslte_vec_i8_malloc(coded_length);
   if (!llr_c) {
     perror("malloc");
     exit(-1);
@@ -205,6 +231,14 @@ int main(int argc, char** argv)
 
   srslte_tdec_force_not_sb(&tdec);
 
+  if (ref_type >= 0) {
+    if (srslte_tdec_init_manual(&tdec_ref, frame_length, (srslte_tdec_impl_type_t)ref_type)) {
+      ERROR("Error initiating reference Turbo decoder\n");
+      exit(-1);
+    }
+    srslte_tdec_force_not_sb(&tdec_ref);
+  }
+
   float ebno_inc, esno_db;
   ebno_inc = (SNR_MAX - SNR_MIN) / SNR_POINTS;
   if (ebno_db == 100.0) {
@@ -250,11 +284,10 @@ int main(int argc, char** argv)
 
       for (j = 0; j < coded_length; j++) {
         llr_s[j] = (int16_t)(100 * llr[j]);
+        llr_c[j] = (int8_t)SRSLTE_MAX(-127.0f, SRSLTE_MIN(127.0f, 10 * llr[j]));
       }
 
       /* decoder */
-      srslte_tdec_new_cb(&tdec, frame_length);
-
       uint32_t t;
       if (nof_iterations == -1) {
         t = MAX_ITERATIONS;
@@ -264,12 +297,20 @@ int main(int argc, char** argv)
 
       gettimeofday(&tdata[1], NULL);
       for (int k = 0; k < nof_repetitions; k++) {
-        srslte_tdec_run_all(&tdec, llr_s, data_rx_bytes, t, frame_length);
+        run_decoder(&tdec, tdec_type, llr_s, llr_c, data_rx_bytes, t);
       }
       gettimeofday(&tdata[2], NULL);
       get_time_interval(tdata);
       mean_usec = (tdata[0].tv_sec * 1e6 + tdata[0].tv_usec) / nof_repetitions;
 
+      // Both decoders must take the same hard decisions on the same codeword
+      if (ref_type >= 0) {
+        run_decoder(&tdec_ref, (srslte_tdec_impl_type_t)ref_type, llr_s, llr_c, data_rx_bytes_ref, t);
+        if (memcmp(data_rx_bytes, data_rx_bytes_ref, frame_length / 8) != 0) {
+          ref_mismatches++;
+        }
+      }
+
       frame_cnt++;
       uint32_t errors_this = 0;
       srslte_bit_unpack_vector(data_rx_bytes, data_rx, frame_length);
@@ -293,6 +334,7 @@ int main(int argc, char** argv)
   }
 
   free(data_rx_bytes);
+  free(data_rx_bytes_ref);
   free(data_tx);
   free(symbols);
   free(llr);
@@ -301,10 +343,17 @@ int main(int argc, char** argv)
   free(data_rx);
 
   srslte_tdec_free(&tdec);
+  if (ref_type >= 0) {
+    srslte_tdec_free(&tdec_ref);
+  }
   srslte_tcod_free(&tcod);
   srslte_random_free(random_gen);
 
   printf("\n");
+  if (ref_mismatches) {
+    printf("%d frames differ from the reference decoder\n", ref_mismatches);
+    exit(-1);
+  }
   printf("Done\n");
   exit(0);
 }
@@ -19,6 +19,7 @@
  *
  */
 
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -44,7 +45,10 @@ static tcod_lut_t               tcod_lut[8][256];
 static uint16_t                 tcod_per_fw[188][6144];
 static srslte_bit_interleaver_t tcod_interleavers[188];
 
-static bool table_initiated = false;
+/* The tables are shared by all the encoders, they are generated by the first one and freed by the last one */
+static pthread_mutex_t table_mutex     = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t        table_refcount  = 0;
+static bool            table_initiated = false;
 
 int srslte_tcod_init(srslte_tcod_t* h, uint32_t max_long_cb)
 {
@@ -52,10 +56,13 @@ int srslte_tcod_init(srslte_tcod_t* h, uint32_t max_long_cb)
   h->max_long_cb = max_long_cb;
   h->temp        = srslte_vec_malloc(max_long_cb / 8);
 
+  pthread_mutex_lock(&table_mutex);
   if (!table_initiated) {
     table_initiated = true;
     srslte_tcod_gentable();
   }
+  table_refcount++;
+  pthread_mutex_unlock(&table_mutex);
   return 0;
 }
 
@@ -64,14 +71,20 @@ void srslte_tcod_free(srslte_tcod_t* h)
   h->max_long_cb = 0;
   if (h->temp) {
     free(h->temp);
+    h->temp = NULL;
   }
 
-  if (table_initiated) {
+  pthread_mutex_lock(&table_mutex);
+  if (table_refcount > 0) {
+    table_refcount--;
+  }
+  if (table_refcount == 0 && table_initiated) {
     for (int i = 0; i < 188; i++) {
       srslte_bit_interleaver_free(&tcod_interleavers[i]);
     }
     table_initiated = false;
   }
+  pthread_mutex_unlock(&table_mutex);
 }
 
 /* Expects bits (1 byte = 1 bit) and produces bits. The systematic and parity bits are interlaced in the output */
@@ -186,6 +199,84 @@ int srslte_tcod_encode(srslte_tcod_t* h, uint8_t* input, uint8_t* output, uint32
   return 0;
 }
 
+/* Runs the 2nd constituent encoder over the interleaved CB in h->temp and terminates both trellises. The systematic
+ * tail bits are written into sys_tail and the parity ones after the parity bits */
+static void tcod_encode_lut_2nd(srslte_tcod_t* h, uint8_t state0, uint8_t* parity, uint32_t long_cb, uint8_t* sys_tail)
+{
+  /* Parity bits for the 2nd constituent encoders */
+  uint8_t state1 = 0;
+  for (uint32_t i = 0; i < long_cb / 8; i++) {
+    tcod_lut_t l   = tcod_lut[state1][h->temp[i]];
+    uint8_t    out = l.output;
+    parity[long_cb / 8 + i] |= (out & 0xf0) >> 4;
+    parity[long_cb / 8 + i + 1] = (out & 0xf) << 4;
+    state1                      = l.next_state;
+  }
+
+  /* Tail bits */
+  uint8_t reg1_0, reg1_1, reg1_2, reg2_0, reg2_1, reg2_2;
+  uint8_t bit, in, out;
+  uint8_t k = 0;
+  uint8_t tail[12];
+
+  reg2_0 = (state1 & 4) >> 2;
+  reg2_1 = (state1 & 2) >> 1;
+  reg2_2 = state1 & 1;
+
+  reg1_0 = (state0 & 4) >> 2;
+  reg1_1 = (state0 & 2) >> 1;
+  reg1_2 = state0 & 1;
+
+  /* TAILING CODER #1 */
+  for (uint32_t j = 0; j < NOF_REGS; j++) {
+    bit = reg1_2 ^ reg1_1;
+
+    tail[k] = bit;
+    k++;
+
+    in  = bit ^ (reg1_2 ^ reg1_1);
+    out = reg1_2 ^ (reg1_0 ^ in);
+
+    reg1_2 = reg1_1;
+    reg1_1 = reg1_0;
+    reg1_0 = in;
+
+    tail[k] = out;
+    k++;
+  }
+
+  /* TAILING CODER #2 */
+  for (uint32_t j = 0; j < NOF_REGS; j++) {
+    bit = reg2_2 ^ reg2_1;
+
+    tail[k] = bit;
+    k++;
+
+    in  = bit ^ (reg2_2 ^ reg2_1);
+    out = reg2_2 ^ (reg2_0 ^ in);
+
+    reg2_2 = reg2_1;
+    reg2_1 = reg2_0;
+    reg2_0 = in;
+
+    tail[k] = out;
+    k++;
+  }
+
+  uint8_t tailv[3][4];
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 3; j++) {
+      tailv[j][i] = tail[3 * i + j];
+    }
+  }
+  uint8_t* x = tailv[0];
+  *sys_tail  = (srslte_bit_pack(&x, 4) << 4);
+  x          = tailv[1];
+  parity[long_cb / 8] |= (srslte_bit_pack(&x, 4) << 4);
+  x = tailv[2];
+  parity[2 * long_cb / 8] |= (srslte_bit_pack(&x, 4) & 0xf);
+}
+
 /* Expects bytes and produces bytes. The systematic and parity bits are interlaced in the output */
 int srslte_tcod_encode_lut(srslte_tcod_t* h,
                            srslte_crc_t*  crc_tb,
@@ -213,16 +304,13 @@ int srslte_tcod_encode_lut(srslte_tcod_t* h,
     if (crc_cb) {
       int block_size_nocrc = (long_cb - crc_cb->order - ((last_cb) ? crc_tb->order : 0)) / 8;
 
-      /* if CRC pointer is given */
+      /* if CRC pointer is given, put the whole block in the TB and CB CRC */
+      srslte_crc_checksum_put_bytes(crc_tb, input, block_size_nocrc);
+      srslte_crc_checksum_put_bytes(crc_cb, input, block_size_nocrc);
+
       for (int i = 0; i < block_size_nocrc; i++) {
         uint8_t in = input[i];
 
-        /* Put byte in TB CRC and save latest checksum */
-        srslte_crc_checksum_put_byte(crc_tb, in);
-
-        /* Put byte in CB CRC and save latest checksum */
-        srslte_crc_checksum_put_byte(crc_cb, in);
-
         /* Run actual encoder */
         tcod_lut_t l = tcod_lut[state0][in];
         parity[i]    = l.output;
@@ -262,11 +350,11 @@ int srslte_tcod_encode_lut(srslte_tcod_t* h,
       /* No CRC given */
       int block_size_nocrc = (long_cb - ((last_cb) ? crc_tb->order : 0)) / 8;
 
+      srslte_crc_checksum_put_bytes(crc_tb, input, block_size_nocrc);
+
       for (uint32_t i = 0; i < block_size_nocrc; i++) {
         uint8_t in = input[i];
 
-        srslte_crc_checksum_put_byte(crc_tb, in);
-
         tcod_lut_t l = tcod_lut[state0][in];
         parity[i]    = l.output;
         state0       = l.next_state;
@@ -292,83 +380,62 @@ int srslte_tcod_encode_lut(srslte_tcod_t* h,
     srslte_bit_interleaver_run(&tcod_interleavers[cblen_idx], input, h->temp, 0);
     // srslte_bit_interleave(input, h->temp, tcod_per_fw[cblen_idx], long_cb);
 
-    /* Parity bits for the 2nd constituent encoders */
-    uint8_t state1 = 0;
-    for (uint32_t i = 0; i < long_cb / 8; i++) {
-      tcod_lut_t l   = tcod_lut[state1][h->temp[i]];
-      uint8_t    out = l.output;
-      parity[long_cb / 8 + i] |= (out & 0xf0) >> 4;
-      parity[long_cb / 8 + i + 1] = (out & 0xf) << 4;
-      state1                      = l.next_state;
-    }
-
-    /* Tail bits */
-    uint8_t reg1_0, reg1_1, reg1_2, reg2_0, reg2_1, reg2_2;
-    uint8_t bit, in, out;
-    uint8_t k = 0;
-    uint8_t tail[12];
-
-    reg2_0 = (state1 & 4) >> 2;
-    reg2_1 = (state1 & 2) >> 1;
-    reg2_2 = state1 & 1;
-
-    reg1_0 = (state0 & 4) >> 2;
-    reg1_1 = (state0 & 2) >> 1;
-    reg1_2 = state0 & 1;
-
-    /* TAILING CODER #1 */
-    for (uint32_t j = 0; j < NOF_REGS; j++) {
-      bit = reg1_2 ^ reg1_1;
+    tcod_encode_lut_2nd(h, state0, parity, long_cb, &input[long_cb / 8]);
 
-      tail[k] = bit;
-      k++;
-
-      in  = bit ^ (reg1_2 ^ reg1_1);
-      out = reg1_2 ^ (reg1_0 ^ in);
-
-      reg1_2 = reg1_1;
-      reg1_1 = reg1_0;
-      reg1_0 = in;
+    return 3 * long_cb + TOTALTAIL;
+  } else {
+    return -1;
+  }
+}
 
-      tail[k] = out;
-      k++;
-    }
+int srslte_tcod_encode_lut_cb(srslte_tcod_t* h,
+                              srslte_crc_t*  crc_tb,
+                              srslte_crc_t*  crc_cb,
+                              const uint8_t* input,
+                              uint8_t*       tail,
+                              uint8_t*       parity,
+                              uint32_t       cblen_idx)
+{
+  if (cblen_idx >= 188 || crc_cb == NULL) {
+    return -1;
+  }
 
-    /* TAILING CODER #2 */
-    for (uint32_t j = 0; j < NOF_REGS; j++) {
-      bit = reg2_2 ^ reg2_1;
+  uint32_t long_cb = (uint32_t)srslte_cbsegm_cbsize(cblen_idx);
+  if (long_cb % 8) {
+    ERROR("Turbo coder LUT implementation long_cb must be multiple of 8\n");
+    return -1;
+  }
 
-      tail[k] = bit;
-      k++;
+  /* Parity bits for the 1st constituent encoder, the data is put in the TB and CB CRC */
+  uint32_t block_size_nocrc = (long_cb - crc_cb->order) / 8;
+  uint8_t  state0           = 0;
+  srslte_crc_set_init(crc_cb, 0);
+  srslte_crc_checksum_put_bytes(crc_tb, input, block_size_nocrc);
+  srslte_crc_checksum_put_bytes(crc_cb, input, block_size_nocrc);
+  for (uint32_t i = 0; i < block_size_nocrc; i++) {
+    tcod_lut_t l = tcod_lut[state0][input[i]];
+    parity[i]    = l.output;
+    state0       = l.next_state;
+  }
 
-      in  = bit ^ (reg2_2 ^ reg2_1);
-      out = reg2_2 ^ (reg2_0 ^ in);
+  /* The CB CRC goes to the tail buffer */
+  uint32_t checksum = (uint32_t)srslte_crc_checksum_get(crc_cb);
+  for (uint32_t i = 0; i < crc_cb->order / 8; i++) {
+    uint8_t    in = (uint8_t)((checksum >> (8 * (crc_cb->order / 8 - i - 1))) & 0xff);
+    tcod_lut_t l  = tcod_lut[state0][in];
 
-      reg2_2 = reg2_1;
-      reg2_1 = reg2_0;
-      reg2_0 = in;
+    tail[i]                      = in;
+    parity[block_size_nocrc + i] = l.output;
+    state0                       = l.next_state;
+  }
+  parity[long_cb / 8] = 0; // will put tail here later
 
-      tail[k] = out;
-      k++;
-    }
+  /* Interleave the data and the CB CRC */
+  srslte_bit_interleaver_run_split(&tcod_interleavers[cblen_idx], input, tail, 8 * block_size_nocrc, h->temp);
 
-    uint8_t tailv[3][4];
-    for (int i = 0; i < 4; i++) {
-      for (int j = 0; j < 3; j++) {
-        tailv[j][i] = tail[3 * i + j];
-      }
-    }
-    uint8_t* x         = tailv[0];
-    input[long_cb / 8] = (srslte_bit_pack(&x, 4) << 4);
-    x                  = tailv[1];
-    parity[long_cb / 8] |= (srslte_bit_pack(&x, 4) << 4);
-    x = tailv[2];
-    parity[2 * long_cb / 8] |= (srslte_bit_pack(&x, 4) & 0xf);
+  tcod_encode_lut_2nd(h, state0, parity, long_cb, &tail[crc_cb->order / 8]);
 
-    return 3 * long_cb + TOTALTAIL;
-  } else {
-    return -1;
-  }
+  return 3 * long_cb + TOTALTAIL;
 }
 
 void srslte_tcod_gentable()
@@ -97,6 +97,27 @@ srslte_tdec_8bit_impl_t avx8_win_impl = {tdec_winavx8_init,
                                          tdec_winavx8_decision_byte};
 #endif
 
+/* AVX512 window implementation */
+#ifdef LV_HAVE_AVX512
+#define WINIMP_IS_AVX512_16
+#include "srslte/phy/fec/turbodecoder_win.h"
+#undef WINIMP_IS_AVX512_16
+srslte_tdec_16bit_impl_t avx512_16_win_impl = {tdec_winavx512_16_init,
+                                               tdec_winavx512_16_free,
+                                               tdec_winavx512_16_dec,
+                                               tdec_winavx512_16_extract_input,
+                                               tdec_winavx512_16_decision_byte};
+
+#define WINIMP_IS_AVX512_8
+#include "srslte/phy/fec/turbodecoder_win.h"
+#undef WINIMP_IS_AVX512_8
+srslte_tdec_8bit_impl_t avx512_8_win_impl = {tdec_winavx512_8_init,
+                                             tdec_winavx512_8_free,
+                                             tdec_winavx512_8_dec,
+                                             tdec_winavx512_8_extract_input,
+                                             tdec_winavx512_8_decision_byte};
+#endif
+
 #ifdef HAVE_NEON
 #define WINIMP_IS_NEON16
 #include "srslte/phy/fec/turbodecoder_win.h"
@@ -112,8 +133,10 @@ srslte_tdec_16bit_impl_t arm16_win_impl = {tdec_winarm16_init,
 #define AUTO_16_SSE 0
 #define AUTO_16_SSEWIN 1
 #define AUTO_16_AVXWIN 2
+#define AUTO_16_AVX512WIN 3
 #define AUTO_8_SSEWIN 0
 #define AUTO_8_AVXWIN 1
+#define AUTO_8_AVX512WIN 2
 #define AUTO_16_GEN 0
 #define AUTO_16_NEONWIN 1
 
@@ -134,6 +157,8 @@ int srslte_tdec_init(srslte_tdec_t* h, uint32_t max_long_cb)
 uint32_t interleaver_idx(uint32_t nof_subblocks)
 {
   switch (nof_subblocks) {
+    case 64:
+      return 4;
     case 32:
       return 3;
     case 16:
@@ -195,6 +220,16 @@ int srslte_tdec_init_manual(srslte_tdec_t* h, uint32_t max_long_cb, srslte_tdec_
       h->current_llr_type = SRSLTE_TDEC_8;
       break;
 #endif /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_AVX512
+    case SRSLTE_TDEC_AVX512_WINDOW:
+      h->dec16[0]         = &avx512_16_win_impl;
+      h->current_llr_type = SRSLTE_TDEC_16;
+      break;
+    case SRSLTE_TDEC_AVX512_8_WINDOW:
+      h->dec8[0]          = &avx512_8_win_impl;
+      h->current_llr_type = SRSLTE_TDEC_8;
+      break;
+#endif /* LV_HAVE_AVX512 */
     default:
       ERROR("Error decoder %d not supported\n", dec_type);
       goto clean_and_exit;
@@ -255,6 +290,10 @@ int srslte_tdec_init_manual(srslte_tdec_t* h, uint32_t max_long_cb, srslte_tdec_
     h->dec16[AUTO_16_AVXWIN] = &avx16_win_impl;
     h->dec8[AUTO_8_AVXWIN]   = &avx8_win_impl;
 #endif /* LV_HAVE_AVX2 */
+#ifdef LV_HAVE_AVX512
+    h->dec16[AUTO_16_AVX512WIN] = &avx512_16_win_impl;
+    h->dec8[AUTO_8_AVX512WIN]   = &avx512_8_win_impl;
+#endif /* LV_HAVE_AVX512 */
 #else  /* HAVE_NEON | LV_HAVE_SSE */
     h->dec16[AUTO_16_SSE]    = &gen_impl;
     h->dec16[AUTO_16_SSEWIN] = &gen_impl;
@@ -275,18 +314,28 @@ int srslte_tdec_init_manual(srslte_tdec_t* h, uint32_t max_long_cb, srslte_tdec_
       }
     }
 
-    // Compute 1 interleaver for each possible nof_subblocks (1, 8, 16 or 32)
-    for (int s = 0; s < 4; s++) {
+    // Compute 1 interleaver for each possible nof_subblocks (1, 8, 16, 32 or 64)
+    for (int s = 0; s < SRSLTE_TDEC_NOF_INTERLEAVERS; s++) {
+#ifndef LV_HAVE_AVX512
+      // 64 sub-blocks are only used by the AVX512 8-bit decoder
+      if (s == SRSLTE_TDEC_NOF_INTERLEAVERS - 1) {
+        break;
+      }
+#endif /* LV_HAVE_AVX512 */
+      uint32_t nof_sb = s ? (8 << (s - 1)) : 1;
       for (int i = 0; i < SRSLTE_NOF_TC_CB_SIZES; i++) {
         if (srslte_tc_interl_init(&h->interleaver[s][i], srslte_cbsegm_cbsize(i)) < 0) {
           goto clean_and_exit;
         }
-        srslte_tc_interl_LTE_gen_interl(&h->interleaver[s][i], srslte_cbsegm_cbsize(i), s ? (8 << (s - 1)) : 1);
+        // Codeblocks shorter than the number of sub-blocks are never decoded with it
+        if (srslte_cbsegm_cbsize(i) >= nof_sb) {
+          srslte_tc_interl_LTE_gen_interl(&h->interleaver[s][i], srslte_cbsegm_cbsize(i), nof_sb);
+        }
       }
     }
   } else {
     uint32_t nof_subblocks;
-    if (dec_type < SRSLTE_TDEC_SSE8_WINDOW) {
+    if (h->current_llr_type == SRSLTE_TDEC_16) {
       if ((h->nof_blocks16[0] = h->dec16[0]->tdec_init(&h->dec16_hdlr[0], h->max_long_cb)) < 0) {
         goto clean_and_exit;
       }
@@ -301,8 +350,10 @@ int srslte_tdec_init_manual(srslte_tdec_t* h, uint32_t max_long_cb, srslte_tdec_
       if (srslte_tc_interl_init(&h->interleaver[interleaver_idx(nof_subblocks)][i], srslte_cbsegm_cbsize(i)) < 0) {
         goto clean_and_exit;
       }
-      srslte_tc_interl_LTE_gen_interl(
-          &h->interleaver[interleaver_idx(nof_subblocks)][i], srslte_cbsegm_cbsize(i), nof_subblocks);
+      if (srslte_cbsegm_cbsize(i) >= nof_subblocks) {
+        srslte_tc_interl_LTE_gen_interl(
+            &h->interleaver[interleaver_idx(nof_subblocks)][i], srslte_cbsegm_cbsize(i), nof_subblocks);
+      }
     }
   }
 
@@ -353,7 +404,7 @@ void srslte_tdec_free(srslte_tdec_t* h)
       h->dec16[td]->tdec_free(h->dec16_hdlr[td]);
     }
   }
-  for (int s = 0; s < 4; s++) {
+  for (int s = 0; s < SRSLTE_TDEC_NOF_INTERLEAVERS; s++) {
     for (int i = 0; i < SRSLTE_NOF_TC_CB_SIZES; i++) {
       srslte_tc_interl_free(&h->interleaver[s][i]);
     }
@@ -380,6 +431,11 @@ static void tdec_decision_byte(srslte_tdec_t* h, uint8_t* output)
 /* Returns number of subblocks in automatic mode for this long_cb */
 uint32_t srslte_tdec_autoimp_get_subblocks(uint32_t long_cb)
 {
+#ifdef LV_HAVE_AVX512
+  if (!(long_cb % 32) && long_cb > 1600) {
+    return 32;
+  } else
+#endif
 #ifdef LV_HAVE_AVX2
   if (!(long_cb % 16) && long_cb > 800) {
     return 16;
@@ -396,6 +452,8 @@ static int tdec_sb_idx(uint32_t long_cb)
 {
   uint32_t nof_sb = srslte_tdec_autoimp_get_subblocks(long_cb);
   switch (nof_sb) {
+    case 32:
+      return AUTO_16_AVX512WIN;
     case 16:
       return AUTO_16_AVXWIN;
     case 8:
@@ -409,6 +467,11 @@ static int tdec_sb_idx(uint32_t long_cb)
 
 uint32_t srslte_tdec_autoimp_get_subblocks_8bit(uint32_t long_cb)
 {
+#ifdef LV_HAVE_AVX512
+  if (!(long_cb % 64) && long_cb > 4096) {
+    return 64;
+  } else
+#endif
 #ifdef LV_HAVE_AVX2
   if (!(long_cb % 32) && long_cb > 2048) {
     return 32;
@@ -427,6 +490,8 @@ static int tdec_sb_idx_8(uint32_t long_cb)
 {
   uint32_t nof_sb = srslte_tdec_autoimp_get_subblocks_8bit(long_cb);
   switch (nof_sb) {
+    case 64:
+      return AUTO_8_AVX512WIN;
     case 32:
       return AUTO_8_AVXWIN;
     case 16:
@@ -470,7 +535,8 @@ static void tdec_iteration_8(srslte_tdec_t* h, int8_t* input)
       h->current_inter_idx = interleaver_idx(h->nof_blocks16[h->current_dec]);
     }
   } else {
-    h->current_dec = 0;
+    h->current_dec       = 0;
+    h->current_inter_idx = interleaver_idx(h->nof_blocks8[h->current_dec]);
   }
 
   if (h->current_llr_type == SRSLTE_TDEC_16) {
@@ -577,6 +643,55 @@ int srslte_tdec_run_all_8bit(srslte_tdec_t* h,
   return SRSLTE_SUCCESS;
 }
 
+bool srslte_tdec_run_all_crc(srslte_tdec_t* h,
+                             int16_t*       input,
+                             uint8_t*       output,
+                             uint32_t       max_iterations,
+                             uint32_t       long_cb,
+                             srslte_crc_t*  crc,
+                             uint32_t       crc_len)
+{
+  if (srslte_tdec_new_cb(h, long_cb) || crc == NULL || crc_len > long_cb) {
+    return false;
+  }
+
+  do {
+    tdec_iteration_16(h, input);
+    tdec_decision_byte(h, output);
+
+    // The remainder of the whole block including the attached parity is zero when the CRC is correct
+    if (!srslte_crc_checksum_byte(crc, output, crc_len)) {
+      return true;
+    }
+  } while (h->n_iter < max_iterations);
+
+  return false;
+}
+
+bool srslte_tdec_run_all_crc_8bit(srslte_tdec_t* h,
+                                  int8_t*        input,
+                                  uint8_t*       output,
+                                  uint32_t       max_iterations,
+                                  uint32_t       long_cb,
+                                  srslte_crc_t*  crc,
+                                  uint32_t       crc_len)
+{
+  if (srslte_tdec_new_cb(h, long_cb) || crc == NULL || crc_len > long_cb) {
+    return false;
+  }
+
+  do {
+    tdec_iteration_8(h, input);
+    tdec_decision_byte(h, output);
+
+    if (!srslte_crc_checksum_byte(crc, output, crc_len)) {
+      return true;
+    }
+  } while (h->n_iter < max_iterations);
+
+  return false;
+}
+
 int srslte_tdec_get_nof_iterations(srslte_tdec_t* h)
 {
   return h->n_iter;
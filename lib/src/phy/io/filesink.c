@@ -22,9 +22,13 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
 
 #include "srslte/phy/io/filesink.h"
+#include "srslte/phy/utils/vector.h"
+
+#define FILESINK_STAGING_LEN (64 * 1024)
 
 int srslte_filesink_init(srslte_filesink_t* q, char* filename, srslte_datatype_t type)
 {
@@ -38,14 +42,178 @@ int srslte_filesink_init(srslte_filesink_t* q, char* filename, srslte_datatype_t
   return 0;
 }
 
+static void* filesink_thread(void* arg)
+{
+  srslte_filesink_t* q = (srslte_filesink_t*)arg;
+
+  pthread_mutex_lock(&q->mutex);
+  while (true) {
+    while (q->pending_len == 0 && !q->quit) {
+      pthread_cond_wait(&q->cvar, &q->mutex);
+    }
+    if (q->pending_len == 0) {
+      break;
+    }
+    uint8_t* buffer = q->buffer[q->fill_idx ^ 1];
+    uint32_t len    = q->pending_len;
+    pthread_mutex_unlock(&q->mutex);
+
+    if (fwrite(buffer, 1, len, q->f) != len) {
+      perror("srslte_filesink_thread");
+    }
+
+    pthread_mutex_lock(&q->mutex);
+    q->pending_len = 0;
+    pthread_cond_broadcast(&q->cvar);
+  }
+  pthread_mutex_unlock(&q->mutex);
+  return NULL;
+}
+
+// Hands the buffer being filled to the writer thread, once it has written the other one
+static void filesink_hand_over(srslte_filesink_t* q)
+{
+  pthread_mutex_lock(&q->mutex);
+  while (q->pending_len > 0) {
+    pthread_cond_wait(&q->cvar, &q->mutex);
+  }
+  q->pending_len = q->fill_len;
+  q->fill_idx ^= 1;
+  pthread_cond_broadcast(&q->cvar);
+  pthread_mutex_unlock(&q->mutex);
+  q->fill_len = 0;
+}
+
+int srslte_filesink_set_async(srslte_filesink_t* q, uint32_t buffer_len)
+{
+  if (q->f == NULL || q->async || buffer_len == 0 || srslte_datatype_bin_size(q->type) == 0) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  for (uint32_t i = 0; i < 2; i++) {
+    q->buffer[i] = srslte_vec_u8_malloc(buffer_len);
+    if (q->buffer[i] == NULL) {
+      perror("malloc");
+      return SRSLTE_ERROR;
+    }
+  }
+  q->buffer_len = buffer_len;
+  pthread_mutex_init(&q->mutex, NULL);
+  pthread_cond_init(&q->cvar, NULL);
+  if (pthread_create(&q->thread, NULL, filesink_thread, q)) {
+    perror("pthread_create");
+    pthread_mutex_destroy(&q->mutex);
+    pthread_cond_destroy(&q->cvar);
+    return SRSLTE_ERROR;
+  }
+  q->async = true;
+  return SRSLTE_SUCCESS;
+}
+
 void srslte_filesink_free(srslte_filesink_t* q)
 {
+  if (q->async) {
+    if (q->fill_len > 0) {
+      filesink_hand_over(q);
+    }
+    pthread_mutex_lock(&q->mutex);
+    q->quit = true;
+    pthread_cond_broadcast(&q->cvar);
+    pthread_mutex_unlock(&q->mutex);
+    pthread_join(q->thread, NULL);
+    pthread_mutex_destroy(&q->mutex);
+    pthread_cond_destroy(&q->cvar);
+  }
+  for (uint32_t i = 0; i < 2; i++) {
+    if (q->buffer[i]) {
+      free(q->buffer[i]);
+    }
+  }
+  if (q->staging) {
+    free(q->staging);
+  }
   if (q->f) {
     fclose(q->f);
   }
   bzero(q, sizeof(srslte_filesink_t));
 }
 
+// Writes len bytes of binary samples, directly or through the writer thread. Returns the number of bytes written
+static size_t filesink_put(srslte_filesink_t* q, const uint8_t* data, size_t len)
+{
+  if (!q->async) {
+    return fwrite(data, 1, len, q->f);
+  }
+
+  size_t count = 0;
+  while (count < len) {
+    size_t n = SRSLTE_MIN(len - count, (size_t)(q->buffer_len - q->fill_len));
+    memcpy(&q->buffer[q->fill_idx][q->fill_len], &data[count], n);
+    q->fill_len += n;
+    count += n;
+    if (q->fill_len == q->buffer_len) {
+      filesink_hand_over(q);
+    }
+  }
+  return count;
+}
+
+static inline int16_t filesink_sc16(float x)
+{
+  return (int16_t)lrintf(SRSLTE_MAX(-32768.0f, SRSLTE_MIN(32767.0f, x * SRSLTE_FILE_SC16_SCALE)));
+}
+
+static inline int8_t filesink_sc8(float x)
+{
+  return (int8_t)lrintf(SRSLTE_MAX(-128.0f, SRSLTE_MIN(127.0f, x * SRSLTE_FILE_SC8_SCALE)));
+}
+
+// Interleaves the samples of the channels in out, in the binary type of the file. The conversions round to the nearest
+// integer, so they don't add a DC offset
+static void filesink_pack(srslte_datatype_t type, void** buffer, int offset, int nsamples, int nchannels, uint8_t* out)
+{
+  int i, j;
+
+  switch (type) {
+    case SRSLTE_FLOAT_BIN:
+      for (i = 0; i < nsamples; i++) {
+        for (j = 0; j < nchannels; j++) {
+          ((float*)out)[i * nchannels + j] = ((float**)buffer)[j][offset + i];
+        }
+      }
+      break;
+    case SRSLTE_COMPLEX_FLOAT_BIN:
+      for (i = 0; i < nsamples; i++) {
+        for (j = 0; j < nchannels; j++) {
+          ((cf_t*)out)[i * nchannels + j] = ((cf_t**)buffer)[j][offset + i];
+        }
+      }
+      break;
+    case SRSLTE_COMPLEX_SHORT_BIN:
+      for (i = 0; i < nsamples; i++) {
+        for (j = 0; j < nchannels; j++) {
+          cf_t     x = ((cf_t**)buffer)[j][offset + i];
+          int16_t* y = &((int16_t*)out)[2 * (i * nchannels + j)];
+          y[0]       = filesink_sc16(__real__ x);
+          y[1]       = filesink_sc16(__imag__ x);
+        }
+      }
+      break;
+    case SRSLTE_COMPLEX_BYTE_BIN:
+      for (i = 0; i < nsamples; i++) {
+        for (j = 0; j < nchannels; j++) {
+          cf_t    x = ((cf_t**)buffer)[j][offset + i];
+          int8_t* y = &((int8_t*)out)[2 * (i * nchannels + j)];
+          y[0]      = filesink_sc8(__real__ x);
+          y[1]      = filesink_sc8(__imag__ x);
+        }
+      }
+      break;
+    default:
+      break;
+  }
+}
+
 int srslte_filesink_write(srslte_filesink_t* q, void* buffer, int nsamples)
 {
   int             i    = 0;
@@ -82,14 +250,9 @@ int srslte_filesink_write(srslte_filesink_t* q, void* buffer, int nsamples)
     case SRSLTE_FLOAT_BIN:
     case SRSLTE_COMPLEX_FLOAT_BIN:
     case SRSLTE_COMPLEX_SHORT_BIN:
-      if (q->type == SRSLTE_FLOAT_BIN) {
-        size = sizeof(float);
-      } else if (q->type == SRSLTE_COMPLEX_FLOAT_BIN) {
-        size = sizeof(_Complex float);
-      } else if (q->type == SRSLTE_COMPLEX_SHORT_BIN) {
-        size = sizeof(_Complex short);
-      }
-      return fwrite(buffer, size, nsamples, q->f);
+    case SRSLTE_COMPLEX_BYTE_BIN:
+      size = srslte_datatype_bin_size(q->type);
+      return filesink_put(q, buffer, (size_t)size * nsamples) / size;
     default:
       i = -1;
       break;
@@ -100,10 +263,12 @@ int srslte_filesink_write(srslte_filesink_t* q, void* buffer, int nsamples)
 int srslte_filesink_write_multi(srslte_filesink_t* q, void** buffer, int nsamples, int nchannels)
 {
   int              i, j;
-  float**          fbuf = (float**)buffer;
-  _Complex float** cbuf = (_Complex float**)buffer;
-  _Complex short** sbuf = (_Complex short**)buffer;
-  int              size = 0;
+  float**          fbuf      = (float**)buffer;
+  _Complex float** cbuf      = (_Complex float**)buffer;
+  _Complex short** sbuf      = (_Complex short**)buffer;
+  int              size      = 0;
+  int              count     = 0;
+  int              chunk_len = 0;
 
   switch (q->type) {
     case SRSLTE_FLOAT:
@@ -130,25 +295,26 @@ int srslte_filesink_write_multi(srslte_filesink_t* q, void** buffer, int nsample
     case SRSLTE_FLOAT_BIN:
     case SRSLTE_COMPLEX_FLOAT_BIN:
     case SRSLTE_COMPLEX_SHORT_BIN:
-      if (q->type == SRSLTE_FLOAT_BIN) {
-        size = sizeof(float);
-      } else if (q->type == SRSLTE_COMPLEX_FLOAT_BIN) {
-        size = sizeof(_Complex float);
-      } else if (q->type == SRSLTE_COMPLEX_SHORT_BIN) {
-        size = sizeof(_Complex short);
+    case SRSLTE_COMPLEX_BYTE_BIN:
+      size = srslte_datatype_bin_size(q->type);
+      if (nchannels == 1 && (q->type == SRSLTE_FLOAT_BIN || q->type == SRSLTE_COMPLEX_FLOAT_BIN)) {
+        return filesink_put(q, buffer[0], (size_t)size * nsamples) / size;
       }
-      if (nchannels > 1) {
-        uint32_t count = 0;
-        for (i = 0; i < nsamples; i++) {
-          for (j = 0; j < nchannels; j++) {
-            count += fwrite(&cbuf[j][i], size, 1, q->f);
-          }
+      if (!q->staging) {
+        q->staging = srslte_vec_u8_malloc(FILESINK_STAGING_LEN);
+        if (!q->staging) {
+          perror("malloc");
+          return SRSLTE_ERROR;
         }
-        return count;
-      } else {
-        return fwrite(buffer[0], size, nsamples, q->f);
       }
-      break;
+      // Interleave and convert the samples in chunks that fit in the staging buffer
+      chunk_len = SRSLTE_MAX(1, FILESINK_STAGING_LEN / (size * nchannels));
+      for (i = 0; i < nsamples; i += chunk_len) {
+        j = SRSLTE_MIN(chunk_len, nsamples - i);
+        filesink_pack(q->type, buffer, i, j, nchannels, q->staging);
+        count += filesink_put(q, q->staging, (size_t)size * nchannels * j) / size;
+      }
+      return count;
     default:
       i = -1;
       break;
@@ -21,10 +21,31 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "srslte/phy/io/filesource.h"
 #include "srslte/phy/utils/debug.h"
+#include "srslte/phy/utils/vector.h"
+
+#define FILESOURCE_PREFETCH_LEN (16 * 1024 * 1024)
+#define FILESOURCE_STAGING_LEN (64 * 1024)
+
+// Asks the kernel to read the next window of the file, once less than half of the current one is ahead of the reader
+static void filesource_prefetch(srslte_filesource_t* q)
+{
+  if (q->prefetch_offset >= q->map_len || q->prefetch_offset > q->offset + FILESOURCE_PREFETCH_LEN / 2) {
+    return;
+  }
+  size_t page_mask = (size_t)sysconf(_SC_PAGESIZE) - 1;
+  size_t start     = SRSLTE_MAX(q->prefetch_offset, q->offset) & ~page_mask;
+  size_t len       = SRSLTE_MIN((size_t)FILESOURCE_PREFETCH_LEN, q->map_len - start);
+  madvise(&q->map[start], len, MADV_WILLNEED);
+  q->prefetch_offset = start + len;
+}
 
 int srslte_filesource_init(srslte_filesource_t* q, char* filename, srslte_datatype_t type)
 {
@@ -35,11 +56,29 @@ int srslte_filesource_init(srslte_filesource_t* q, char* filename, srslte_dataty
     return -1;
   }
   q->type = type;
+
+  // Map the regular binary files, the others are read with stdio
+  struct stat st;
+  if (srslte_datatype_bin_size(type) > 0 && fstat(fileno(q->f), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(q->f), 0);
+    if (map != MAP_FAILED) {
+      q->map     = (uint8_t*)map;
+      q->map_len = (size_t)st.st_size;
+      madvise(q->map, q->map_len, MADV_SEQUENTIAL);
+      filesource_prefetch(q);
+    }
+  }
   return 0;
 }
 
 void srslte_filesource_free(srslte_filesource_t* q)
 {
+  if (q->map) {
+    munmap(q->map, q->map_len);
+  }
+  if (q->staging) {
+    free(q->staging);
+  }
   if (q->f) {
     fclose(q->f);
   }
@@ -48,11 +87,62 @@ void srslte_filesource_free(srslte_filesource_t* q)
 
 void srslte_filesource_seek(srslte_filesource_t* q, int pos)
 {
+  if (q->map) {
+    q->offset          = SRSLTE_MIN((size_t)pos, q->map_len);
+    q->prefetch_offset = q->offset;
+    filesource_prefetch(q);
+    return;
+  }
   if (fseek(q->f, pos, SEEK_SET) != 0) {
     perror("srslte_filesource_seek");
   }
 }
 
+// Copies nsamples interleaved samples of the binary type of the file to the buffers of the channels
+static void
+filesource_unpack(srslte_datatype_t type, const uint8_t* in, cf_t** buffer, int offset, int nsamples, int nchannels)
+{
+  int i, j;
+
+  switch (type) {
+    case SRSLTE_COMPLEX_FLOAT_BIN:
+      if (nchannels == 1) {
+        memcpy(&buffer[0][offset], in, sizeof(cf_t) * nsamples);
+        break;
+      }
+      for (i = 0; i < nsamples; i++) {
+        for (j = 0; j < nchannels; j++) {
+          memcpy(&buffer[j][offset + i], &in[sizeof(cf_t) * (i * nchannels + j)], sizeof(cf_t));
+        }
+      }
+      break;
+    case SRSLTE_COMPLEX_SHORT_BIN:
+      if (nchannels == 1) {
+        srslte_vec_convert_if((const int16_t*)in, SRSLTE_FILE_SC16_SCALE, (float*)&buffer[0][offset], 2 * nsamples);
+        break;
+      }
+      for (i = 0; i < nsamples; i++) {
+        for (j = 0; j < nchannels; j++) {
+          const int16_t* x               = &((const int16_t*)in)[2 * (i * nchannels + j)];
+          __real__ buffer[j][offset + i] = x[0] / SRSLTE_FILE_SC16_SCALE;
+          __imag__ buffer[j][offset + i] = x[1] / SRSLTE_FILE_SC16_SCALE;
+        }
+      }
+      break;
+    case SRSLTE_COMPLEX_BYTE_BIN:
+      for (i = 0; i < nsamples; i++) {
+        for (j = 0; j < nchannels; j++) {
+          const int8_t* x                = &((const int8_t*)in)[2 * (i * nchannels + j)];
+          __real__ buffer[j][offset + i] = x[0] / SRSLTE_FILE_SC8_SCALE;
+          __imag__ buffer[j][offset + i] = x[1] / SRSLTE_FILE_SC8_SCALE;
+        }
+      }
+      break;
+    default:
+      break;
+  }
+}
+
 int read_complex_f(FILE* f, _Complex float* y)
 {
   char           in_str[64];
@@ -102,12 +192,14 @@ int srslte_filesource_read(srslte_filesource_t* q, void* buffer, int nsamples)
     case SRSLTE_FLOAT_BIN:
     case SRSLTE_COMPLEX_FLOAT_BIN:
     case SRSLTE_COMPLEX_SHORT_BIN:
-      if (q->type == SRSLTE_FLOAT_BIN) {
-        size = sizeof(float);
-      } else if (q->type == SRSLTE_COMPLEX_FLOAT_BIN) {
-        size = sizeof(_Complex float);
-      } else if (q->type == SRSLTE_COMPLEX_SHORT_BIN) {
-        size = sizeof(_Complex short);
+    case SRSLTE_COMPLEX_BYTE_BIN:
+      size = srslte_datatype_bin_size(q->type);
+      if (q->map) {
+        i = (int)SRSLTE_MIN((size_t)nsamples, (q->map_len - q->offset) / size);
+        memcpy(buffer, &q->map[q->offset], (size_t)size * i);
+        q->offset += (size_t)size * i;
+        filesource_prefetch(q);
+        return i;
       }
       return fread(buffer, size, nsamples, q->f);
       break;
@@ -120,22 +212,44 @@ int srslte_filesource_read(srslte_filesource_t* q, void* buffer, int nsamples)
 
 int srslte_filesource_read_multi(srslte_filesource_t* q, void** buffer, int nsamples, int nof_channels)
 {
-  int              i, j, count = 0;
+  int              i, n, count = 0;
   _Complex float** cbuf = (_Complex float**)buffer;
+  size_t           size = (size_t)srslte_datatype_bin_size(q->type) * nof_channels;
 
   switch (q->type) {
     case SRSLTE_FLOAT:
     case SRSLTE_COMPLEX_FLOAT:
     case SRSLTE_COMPLEX_SHORT:
     case SRSLTE_FLOAT_BIN:
-    case SRSLTE_COMPLEX_SHORT_BIN:
       ERROR("%s.%d:Read Mode not implemented\n", __FILE__, __LINE__);
       count = SRSLTE_ERROR;
       break;
     case SRSLTE_COMPLEX_FLOAT_BIN:
-      for (i = 0; i < nsamples; i++) {
-        for (j = 0; j < nof_channels; j++) {
-          count += fread(&cbuf[j][i], sizeof(cf_t), (size_t)1, q->f);
+    case SRSLTE_COMPLEX_SHORT_BIN:
+    case SRSLTE_COMPLEX_BYTE_BIN:
+      if (q->map) {
+        n = (int)SRSLTE_MIN((size_t)nsamples, (q->map_len - q->offset) / size);
+        filesource_unpack(q->type, &q->map[q->offset], cbuf, 0, n, nof_channels);
+        q->offset += size * n;
+        filesource_prefetch(q);
+        count = n * nof_channels;
+        break;
+      }
+      if (!q->staging) {
+        q->staging = srslte_vec_u8_malloc(FILESOURCE_STAGING_LEN);
+        if (!q->staging) {
+          perror("malloc");
+          return SRSLTE_ERROR;
+        }
+      }
+      // Read the interleaved samples in chunks that fit in the staging buffer
+      for (i = 0; i < nsamples; i += n) {
+        int chunk_len = SRSLTE_MIN(SRSLTE_MAX(1, FILESOURCE_STAGING_LEN / (int)size), nsamples - i);
+        n             = (int)fread(q->staging, size, chunk_len, q->f);
+        filesource_unpack(q->type, q->staging, cbuf, i, n, nof_channels);
+        count += n * nof_channels;
+        if (n < chunk_len) {
+          break;
         }
       }
       break;
@@ -427,6 +427,192 @@ int srslte_predecoding_single_multi(cf_t*  y[SRSLTE_MAX_PORTS],
 #endif
 }
 
+int srslte_predecoding_irc_covariance(cf_t* n[SRSLTE_MAX_PORTS], int nof_rxant, int nof_samples, cf_t* R)
+{
+  if (n == NULL || R == NULL || nof_rxant < 1 || nof_rxant > SRSLTE_MAX_PORTS || nof_samples < 1) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  // R is Hermitian, only the upper triangle is computed
+  float norm = 1.0f / (float)nof_samples;
+  for (int i = 0; i < nof_rxant; i++) {
+    R[i * nof_rxant + i] = crealf(srslte_vec_dot_prod_conj_ccc(n[i], n[i], nof_samples)) * norm;
+    for (int j = i + 1; j < nof_rxant; j++) {
+      R[i * nof_rxant + j] = srslte_vec_dot_prod_conj_ccc(n[i], n[j], nof_samples) * norm;
+      R[j * nof_rxant + i] = conjf(R[i * nof_rxant + j]);
+    }
+  }
+  return SRSLTE_SUCCESS;
+}
+
+typedef double _Complex irc_cd_t;
+
+static int irc_2x2_inv(irc_cd_t a[2][2], irc_cd_t a_inv[2][2])
+{
+  irc_cd_t det = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+  if (!isnormal(cabs(det))) {
+    return SRSLTE_ERROR;
+  }
+  irc_cd_t r  = 1.0 / det;
+  a_inv[0][0] = +a[1][1] * r;
+  a_inv[0][1] = -a[0][1] * r;
+  a_inv[1][0] = -a[1][0] * r;
+  a_inv[1][1] = +a[0][0] * r;
+  return SRSLTE_SUCCESS;
+}
+
+static void irc_2x2_prod(irc_cd_t a[2][2], irc_cd_t b[2][2], irc_cd_t c[2][2])
+{
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 2; j++) {
+      c[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j];
+    }
+  }
+}
+
+/* Inverts the covariance of up to 4 antennas. The 4x4 matrix is inverted by 2x2 blocks using the Schur complement and a
+ * 3x3 matrix is padded with the identity. The Schur complement of a covariance dominated by a strong interferer is the
+ * difference of two close values, so the inversion is done in double precision; it runs once per group of PRB */
+static int irc_cov_inv(const cf_t* R, int nof_rxant, cf_t R_inv[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS])
+{
+  irc_cd_t M[4][4];
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      M[i][j] = (i < nof_rxant && j < nof_rxant) ? R[i * nof_rxant + j] : (i == j ? 1.0 : 0.0);
+    }
+  }
+
+  if (nof_rxant == 1) {
+    if (!isnormal(creal(M[0][0]))) {
+      return SRSLTE_ERROR;
+    }
+    R_inv[0][0] = (cf_t)(1.0 / M[0][0]);
+    return SRSLTE_SUCCESS;
+  }
+
+  irc_cd_t A[2][2] = {{M[0][0], M[0][1]}, {M[1][0], M[1][1]}};
+  irc_cd_t A_inv[2][2];
+  if (irc_2x2_inv(A, A_inv)) {
+    return SRSLTE_ERROR;
+  }
+  if (nof_rxant == 2) {
+    for (int i = 0; i < 2; i++) {
+      for (int j = 0; j < 2; j++) {
+        R_inv[i][j] = (cf_t)A_inv[i][j];
+      }
+    }
+    return SRSLTE_SUCCESS;
+  }
+
+  irc_cd_t B[2][2] = {{M[0][2], M[0][3]}, {M[1][2], M[1][3]}};
+  irc_cd_t C[2][2] = {{M[2][0], M[2][1]}, {M[3][0], M[3][1]}};
+  irc_cd_t D[2][2] = {{M[2][2], M[2][3]}, {M[3][2], M[3][3]}};
+
+  // S = D - C A^-1 B
+  irc_cd_t A_inv_B[2][2], C_A_inv[2][2], C_A_inv_B[2][2], S[2][2], S_inv[2][2];
+  irc_2x2_prod(A_inv, B, A_inv_B);
+  irc_2x2_prod(C, A_inv, C_A_inv);
+  irc_2x2_prod(C, A_inv_B, C_A_inv_B);
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 2; j++) {
+      S[i][j] = D[i][j] - C_A_inv_B[i][j];
+    }
+  }
+  if (irc_2x2_inv(S, S_inv)) {
+    return SRSLTE_ERROR;
+  }
+
+  // R^-1 = [A^-1 + A^-1 B S^-1 C A^-1, -A^-1 B S^-1; -S^-1 C A^-1, S^-1]
+  irc_cd_t A_inv_B_S_inv[2][2], S_inv_C_A_inv[2][2], corr[2][2];
+  irc_2x2_prod(A_inv_B, S_inv, A_inv_B_S_inv);
+  irc_2x2_prod(S_inv, C_A_inv, S_inv_C_A_inv);
+  irc_2x2_prod(A_inv_B_S_inv, C_A_inv, corr);
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 2; j++) {
+      R_inv[i][j]         = (cf_t)(A_inv[i][j] + corr[i][j]);
+      R_inv[i][j + 2]     = (cf_t)(-A_inv_B_S_inv[i][j]);
+      R_inv[i + 2][j]     = (cf_t)(-S_inv_C_A_inv[i][j]);
+      R_inv[i + 2][j + 2] = (cf_t)S_inv[i][j];
+    }
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int srslte_predecoding_single_irc(cf_t*       y[SRSLTE_MAX_PORTS],
+                                  cf_t*       h[SRSLTE_MAX_PORTS],
+                                  const cf_t* R,
+                                  cf_t*       x,
+                                  float*      csi,
+                                  int         nof_rxant,
+                                  int         nof_symbols,
+                                  float       scaling)
+{
+  if (y == NULL || h == NULL || R == NULL || x == NULL || nof_rxant < 1 || nof_rxant > SRSLTE_MAX_PORTS) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  cf_t R_inv[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS] = {};
+  if (irc_cov_inv(R, nof_rxant, R_inv)) {
+    ERROR("Error predecoding IRC: singular covariance matrix\n");
+    return SRSLTE_ERROR;
+  }
+
+  int   i    = 0;
+  float norm = 1.0f / scaling;
+
+#if SRSLTE_SIMD_CF_SIZE != 0
+  simd_cf_t R_inv_v[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS];
+  for (int p = 0; p < nof_rxant; p++) {
+    for (int q = 0; q < nof_rxant; q++) {
+      R_inv_v[p][q] = srslte_simd_cf_set1(R_inv[p][q]);
+    }
+  }
+  simd_f_t _norm = srslte_simd_f_set1(norm);
+
+  for (; i < nof_symbols - SRSLTE_SIMD_CF_SIZE + 1; i += SRSLTE_SIMD_CF_SIZE) {
+    simd_cf_t hv[SRSLTE_MAX_PORTS];
+    for (int p = 0; p < nof_rxant; p++) {
+      hv[p] = srslte_simd_cfi_loadu(&h[p][i]);
+    }
+
+    // w = R^-1 h, x = w'y / w'h
+    simd_cf_t num = srslte_simd_cf_zero();
+    simd_f_t  den = srslte_simd_f_zero();
+    for (int p = 0; p < nof_rxant; p++) {
+      simd_cf_t w = srslte_simd_cf_prod(R_inv_v[p][0], hv[0]);
+      for (int q = 1; q < nof_rxant; q++) {
+        w = srslte_simd_cf_add(w, srslte_simd_cf_prod(R_inv_v[p][q], hv[q]));
+      }
+      num = srslte_simd_cf_add(num, srslte_simd_cf_conjprod(srslte_simd_cfi_loadu(&y[p][i]), w));
+      den = srslte_simd_f_add(den, srslte_simd_cf_re(srslte_simd_cf_conjprod(hv[p], w)));
+    }
+
+    srslte_simd_cfi_storeu(&x[i], srslte_simd_cf_mul(num, srslte_simd_f_mul(srslte_simd_f_rcp(den), _norm)));
+    if (csi) {
+      srslte_simd_f_storeu(&csi[i], den);
+    }
+  }
+#endif /* SRSLTE_SIMD_CF_SIZE != 0 */
+
+  for (; i < nof_symbols; i++) {
+    cf_t  num = 0.0f;
+    float den = 0.0f;
+    for (int p = 0; p < nof_rxant; p++) {
+      cf_t w = 0.0f;
+      for (int q = 0; q < nof_rxant; q++) {
+        w += R_inv[p][q] * h[q][i];
+      }
+      num += conjf(w) * y[p][i];
+      den += crealf(conjf(w) * h[p][i]);
+    }
+    x[i] = (den > 0.0f) ? num * norm / den : 0.0f;
+    if (csi) {
+      csi[i] = den;
+    }
+  }
+  return nof_symbols;
+}
+
 /* C implementatino of the SFBC equalizer */
 int srslte_predecoding_diversity_gen_(cf_t* y[SRSLTE_MAX_PORTS],
                                       cf_t* h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS],
@@ -1821,6 +2007,304 @@ static int srslte_predecoding_multiplex_2x1_mrc_csi(cf_t*  y[SRSLTE_MAX_PORTS],
   return SRSLTE_SUCCESS;
 }
 
+/* Codebook for transmission on four antenna ports, Table 6.3.4.2.3-2 of 36.211. The precoder of every index is
+ * W_n = I - 2 u_n u_n' / (u_n' u_n), from which a set of columns is taken for every number of layers */
+#define PRECODING_4TX_NOF_CODEBOOK 16
+
+static const cf_t precoding_4tx_u[PRECODING_4TX_NOF_CODEBOOK][4] = {
+    {1, -1, -1, -1},
+    {1, -_Complex_I, 1, _Complex_I},
+    {1, 1, -1, 1},
+    {1, _Complex_I, 1, -_Complex_I},
+    {1, (-1 - _Complex_I) * M_SQRT1_2, -_Complex_I, (1 - _Complex_I) * M_SQRT1_2},
+    {1, (1 - _Complex_I) * M_SQRT1_2, _Complex_I, (-1 - _Complex_I) * M_SQRT1_2},
+    {1, (1 + _Complex_I) * M_SQRT1_2, -_Complex_I, (-1 + _Complex_I) * M_SQRT1_2},
+    {1, (-1 + _Complex_I) * M_SQRT1_2, _Complex_I, (1 + _Complex_I) * M_SQRT1_2},
+    {1, -1, 1, 1},
+    {1, -_Complex_I, -1, -_Complex_I},
+    {1, 1, 1, -1},
+    {1, _Complex_I, -1, _Complex_I},
+    {1, -1, -1, 1},
+    {1, -1, 1, -1},
+    {1, 1, -1, -1},
+    {1, 1, 1, 1}};
+
+static const uint8_t precoding_4tx_columns[PRECODING_4TX_NOF_CODEBOOK][SRSLTE_MAX_LAYERS][SRSLTE_MAX_LAYERS] = {
+    {{0}, {0, 3}, {0, 1, 3}, {0, 1, 2, 3}},
+    {{0}, {0, 1}, {0, 1, 2}, {0, 1, 2, 3}},
+    {{0}, {0, 1}, {0, 1, 2}, {2, 1, 0, 3}},
+    {{0}, {0, 1}, {0, 1, 2}, {2, 1, 0, 3}},
+    {{0}, {0, 3}, {0, 1, 3}, {0, 1, 2, 3}},
+    {{0}, {0, 3}, {0, 1, 3}, {0, 1, 2, 3}},
+    {{0}, {0, 2}, {0, 2, 3}, {0, 2, 1, 3}},
+    {{0}, {0, 2}, {0, 2, 3}, {0, 2, 1, 3}},
+    {{0}, {0, 1}, {0, 1, 3}, {0, 1, 2, 3}},
+    {{0}, {0, 3}, {0, 2, 3}, {0, 1, 2, 3}},
+    {{0}, {0, 2}, {0, 1, 2}, {0, 2, 1, 3}},
+    {{0}, {0, 2}, {0, 2, 3}, {0, 2, 1, 3}},
+    {{0}, {0, 1}, {0, 1, 2}, {0, 1, 2, 3}},
+    {{0}, {0, 2}, {0, 1, 2}, {0, 2, 1, 3}},
+    {{0}, {0, 2}, {0, 1, 2}, {2, 1, 0, 3}},
+    {{0}, {0, 1}, {0, 1, 2}, {0, 1, 2, 3}}};
+
+/* Precoding matrix W[port][layer] for four antenna ports, including the 1/sqrt(nof_layers) normalization */
+static int precoding_4tx_matrix(int codebook_idx, int nof_layers, cf_t W[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS])
+{
+  if (codebook_idx < 0 || codebook_idx >= PRECODING_4TX_NOF_CODEBOOK || nof_layers < 1 ||
+      nof_layers > SRSLTE_MAX_LAYERS) {
+    ERROR("Invalid multiplex combination: codebook_idx=%d, nof_layers=%d, nof_ports=4\n", codebook_idx, nof_layers);
+    return SRSLTE_ERROR;
+  }
+
+  const cf_t* u    = precoding_4tx_u[codebook_idx];
+  float       norm = 1.0f / sqrtf((float)nof_layers);
+  for (int l = 0; l < nof_layers; l++) {
+    int c = precoding_4tx_columns[codebook_idx][nof_layers - 1][l];
+    for (int p = 0; p < SRSLTE_MAX_PORTS; p++) {
+      // u' u = 4 for all the codebook entries
+      W[p][l] = ((p == c ? 1.0f : 0.0f) - u[p] * conjf(u[c]) / 2.0f) * norm;
+    }
+  }
+  return SRSLTE_SUCCESS;
+}
+
+/* Writes the CSI of every layer in the codeword it is mapped to, Table 6.3.3.2-1 of 36.211 */
+static void predecoding_4tx_csi(float* csi[SRSLTE_MAX_CODEWORDS], const float* csi_layer, int nof_layers, int i)
+{
+  switch (nof_layers) {
+    case 1:
+      csi[0][i] = csi_layer[0];
+      break;
+    case 2:
+      csi[0][i] = csi_layer[0];
+      csi[1][i] = csi_layer[1];
+      break;
+    case 3:
+      csi[0][i]         = csi_layer[0];
+      csi[1][2 * i]     = csi_layer[1];
+      csi[1][2 * i + 1] = csi_layer[2];
+      break;
+    default:
+      csi[0][2 * i]     = csi_layer[0];
+      csi[0][2 * i + 1] = csi_layer[1];
+      csi[1][2 * i]     = csi_layer[2];
+      csi[1][2 * i + 1] = csi_layer[3];
+      break;
+  }
+}
+
+#if SRSLTE_SIMD_CF_SIZE != 0
+/* Reciprocal with one Newton-Raphson step on top of the approximation, which alone is not accurate enough for the
+ * pivots of an ill-conditioned four layer channel */
+static inline simd_f_t predecoding_4tx_rcp(simd_f_t a)
+{
+  simd_f_t r = srslte_simd_f_rcp(a);
+  return srslte_simd_f_mul(r, srslte_simd_f_sub(srslte_simd_f_set1(2.0f), srslte_simd_f_mul(a, r)));
+}
+#endif /* SRSLTE_SIMD_CF_SIZE != 0 */
+
+/* MMSE detector x = (H'H + No)^-1 H'y of up to 4 layers precoded over 4 ports, ZF if noise_estimate is 0. H'H + No is
+ * factorised as L D L' (Cholesky without square roots) for every RE, and the SIMD path processes SRSLTE_SIMD_CF_SIZE
+ * REs per step */
+static int srslte_predecoding_multiplex_4tx_mmse(cf_t*  y[SRSLTE_MAX_PORTS],
+                                                 cf_t*  h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS],
+                                                 cf_t*  x[SRSLTE_MAX_LAYERS],
+                                                 float* csi[SRSLTE_MAX_CODEWORDS],
+                                                 int    nof_rxant,
+                                                 int    nof_layers,
+                                                 int    codebook_idx,
+                                                 int    nof_symbols,
+                                                 float  scaling,
+                                                 float  noise_estimate)
+{
+  cf_t W[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS];
+  if (precoding_4tx_matrix(codebook_idx, nof_layers, W)) {
+    return SRSLTE_ERROR;
+  }
+  if (nof_rxant < 1 || nof_rxant > SRSLTE_MAX_PORTS) {
+    ERROR("Error predecoding multiplex: Invalid number of rx antennas %d\n", nof_rxant);
+    return SRSLTE_ERROR;
+  }
+
+  const int R    = nof_rxant;
+  const int L    = nof_layers;
+  float     norm = 1.0f / scaling;
+  int       i    = 0;
+
+#if SRSLTE_SIMD_CF_SIZE != 0
+  simd_cf_t _W[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS];
+  for (int p = 0; p < SRSLTE_MAX_PORTS; p++) {
+    for (int l = 0; l < L; l++) {
+      _W[p][l] = srslte_simd_cf_set1(W[p][l]);
+    }
+  }
+  simd_f_t _noise = srslte_simd_f_set1(noise_estimate);
+  simd_f_t _norm  = srslte_simd_f_set1(norm);
+
+  for (; i < nof_symbols - SRSLTE_SIMD_CF_SIZE + 1; i += SRSLTE_SIMD_CF_SIZE) {
+    // Effective channel H = h W, and H'y
+    simd_cf_t H[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS];
+    simd_cf_t z[SRSLTE_MAX_LAYERS];
+    for (int r = 0; r < R; r++) {
+      simd_cf_t h_r[SRSLTE_MAX_PORTS];
+      for (int p = 0; p < SRSLTE_MAX_PORTS; p++) {
+        h_r[p] = srslte_simd_cfi_load(&h[p][r][i]);
+      }
+      for (int l = 0; l < L; l++) {
+        H[r][l] = srslte_simd_cf_prod(h_r[0], _W[0][l]);
+        for (int p = 1; p < SRSLTE_MAX_PORTS; p++) {
+          H[r][l] = srslte_simd_cf_add(H[r][l], srslte_simd_cf_prod(h_r[p], _W[p][l]));
+        }
+      }
+      simd_cf_t y_r = srslte_simd_cfi_load(&y[r][i]);
+      for (int l = 0; l < L; l++) {
+        simd_cf_t t = srslte_simd_cf_conjprod(y_r, H[r][l]);
+        z[l]        = (r == 0) ? t : srslte_simd_cf_add(z[l], t);
+      }
+    }
+
+    // L D L' factorisation of A = H'H + No
+    simd_cf_t Lm[SRSLTE_MAX_LAYERS][SRSLTE_MAX_LAYERS];
+    simd_f_t  D[SRSLTE_MAX_LAYERS], D_rcp[SRSLTE_MAX_LAYERS];
+    for (int j = 0; j < L; j++) {
+      simd_f_t d = _noise;
+      for (int r = 0; r < R; r++) {
+        d = srslte_simd_f_add(d, srslte_simd_cf_re(srslte_simd_cf_conjprod(H[r][j], H[r][j])));
+      }
+      for (int k = 0; k < j; k++) {
+        simd_f_t l2 = srslte_simd_cf_re(srslte_simd_cf_conjprod(Lm[j][k], Lm[j][k]));
+        d           = srslte_simd_f_sub(d, srslte_simd_f_mul(l2, D[k]));
+      }
+      D[j]     = d;
+      D_rcp[j] = predecoding_4tx_rcp(d);
+
+      for (int m = j + 1; m < L; m++) {
+        simd_cf_t a = srslte_simd_cf_conjprod(H[0][j], H[0][m]);
+        for (int r = 1; r < R; r++) {
+          a = srslte_simd_cf_add(a, srslte_simd_cf_conjprod(H[r][j], H[r][m]));
+        }
+        for (int k = 0; k < j; k++) {
+          a = srslte_simd_cf_sub(a, srslte_simd_cf_mul(srslte_simd_cf_conjprod(Lm[m][k], Lm[j][k]), D[k]));
+        }
+        Lm[m][j] = srslte_simd_cf_mul(a, D_rcp[j]);
+      }
+    }
+
+    // Forward and backward substitution
+    for (int m = 0; m < L; m++) {
+      for (int k = 0; k < m; k++) {
+        z[m] = srslte_simd_cf_sub(z[m], srslte_simd_cf_prod(Lm[m][k], z[k]));
+      }
+    }
+    for (int m = L - 1; m >= 0; m--) {
+      z[m] = srslte_simd_cf_mul(z[m], D_rcp[m]);
+      for (int k = m + 1; k < L; k++) {
+        z[m] = srslte_simd_cf_sub(z[m], srslte_simd_cf_conjprod(z[k], Lm[k][m]));
+      }
+    }
+    for (int l = 0; l < L; l++) {
+      srslte_simd_cfi_store(&x[l][i], srslte_simd_cf_mul(z[l], _norm));
+    }
+
+    if (csi && csi[0]) {
+      // The SINR of every layer is 1 / [A^-1]_ll, with [A^-1]_ll = sum_k |[L^-1]_kl|^2 / D_k
+      float csi_layer[SRSLTE_MAX_LAYERS][SRSLTE_SIMD_CF_SIZE];
+      for (int l = 0; l < L; l++) {
+        simd_cf_t M[SRSLTE_MAX_LAYERS];
+        simd_f_t  a_inv = D_rcp[l];
+        for (int m = l + 1; m < L; m++) {
+          M[m] = srslte_simd_cf_neg(Lm[m][l]);
+          for (int k = l + 1; k < m; k++) {
+            M[m] = srslte_simd_cf_sub(M[m], srslte_simd_cf_prod(Lm[m][k], M[k]));
+          }
+          a_inv = srslte_simd_f_add(
+              a_inv, srslte_simd_f_mul(srslte_simd_cf_re(srslte_simd_cf_conjprod(M[m], M[m])), D_rcp[m]));
+        }
+        srslte_simd_f_storeu(csi_layer[l], predecoding_4tx_rcp(a_inv));
+      }
+      for (int k = 0; k < SRSLTE_SIMD_CF_SIZE; k++) {
+        float c[SRSLTE_MAX_LAYERS];
+        for (int l = 0; l < L; l++) {
+          c[l] = csi_layer[l][k];
+        }
+        predecoding_4tx_csi(csi, c, L, i + k);
+      }
+    }
+  }
+#endif /* SRSLTE_SIMD_CF_SIZE != 0 */
+
+  for (; i < nof_symbols; i++) {
+    cf_t H[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS];
+    cf_t z[SRSLTE_MAX_LAYERS] = {};
+    for (int r = 0; r < R; r++) {
+      for (int l = 0; l < L; l++) {
+        H[r][l] = 0.0f;
+        for (int p = 0; p < SRSLTE_MAX_PORTS; p++) {
+          H[r][l] += h[p][r][i] * W[p][l];
+        }
+        z[l] += y[r][i] * conjf(H[r][l]);
+      }
+    }
+
+    cf_t  Lm[SRSLTE_MAX_LAYERS][SRSLTE_MAX_LAYERS];
+    float D[SRSLTE_MAX_LAYERS];
+    for (int j = 0; j < L; j++) {
+      float d = noise_estimate;
+      for (int r = 0; r < R; r++) {
+        d += __real__(H[r][j] * conjf(H[r][j]));
+      }
+      for (int k = 0; k < j; k++) {
+        d -= __real__(Lm[j][k] * conjf(Lm[j][k])) * D[k];
+      }
+      D[j] = d;
+
+      for (int m = j + 1; m < L; m++) {
+        cf_t a = 0.0f;
+        for (int r = 0; r < R; r++) {
+          a += H[r][j] * conjf(H[r][m]);
+        }
+        for (int k = 0; k < j; k++) {
+          a -= Lm[m][k] * conjf(Lm[j][k]) * D[k];
+        }
+        Lm[m][j] = a / d;
+      }
+    }
+
+    for (int m = 0; m < L; m++) {
+      for (int k = 0; k < m; k++) {
+        z[m] -= Lm[m][k] * z[k];
+      }
+    }
+    for (int m = L - 1; m >= 0; m--) {
+      z[m] /= D[m];
+      for (int k = m + 1; k < L; k++) {
+        z[m] -= z[k] * conjf(Lm[k][m]);
+      }
+    }
+    for (int l = 0; l < L; l++) {
+      x[l][i] = z[l] * norm;
+    }
+
+    if (csi && csi[0]) {
+      float c[SRSLTE_MAX_LAYERS];
+      for (int l = 0; l < L; l++) {
+        cf_t  M[SRSLTE_MAX_LAYERS];
+        float a_inv = 1.0f / D[l];
+        for (int m = l + 1; m < L; m++) {
+          M[m] = -Lm[m][l];
+          for (int k = l + 1; k < m; k++) {
+            M[m] -= Lm[m][k] * M[k];
+          }
+          a_inv += __real__(M[m] * conjf(M[m])) / D[m];
+        }
+        c[l] = 1.0f / a_inv;
+      }
+      predecoding_4tx_csi(csi, c, L, i);
+    }
+  }
+  return SRSLTE_SUCCESS;
+}
+
 static int srslte_predecoding_multiplex(cf_t*  y[SRSLTE_MAX_PORTS],
                                         cf_t*  h[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS],
                                         cf_t*  x[SRSLTE_MAX_LAYERS],
@@ -1860,7 +2344,12 @@ static int srslte_predecoding_multiplex(cf_t*  y[SRSLTE_MAX_PORTS],
       }
     }
   } else if (nof_ports == 4) {
-    ERROR("Error predecoding multiplex: not implemented for %d Tx ports", nof_ports);
+    // Zero forcing is MMSE without the noise term
+    if (mimo_decoder == SRSLTE_MIMO_DECODER_ZF) {
+      noise_estimate = 0.0f;
+    }
+    return srslte_predecoding_multiplex_4tx_mmse(
+        y, h, x, csi, nof_rxant, nof_layers, codebook_idx, nof_symbols, scaling, noise_estimate);
   } else {
     ERROR("Error predecoding multiplex: Invalid combination of ports %d and rx antennas %d\n", nof_ports, nof_rxant);
   }
@@ -2095,6 +2584,58 @@ int srslte_precoding_cdd(cf_t* x[SRSLTE_MAX_LAYERS],
   }
 }
 
+static int srslte_precoding_multiplex_4tx(cf_t*    x[SRSLTE_MAX_LAYERS],
+                                          cf_t*    y[SRSLTE_MAX_PORTS],
+                                          int      nof_layers,
+                                          int      codebook_idx,
+                                          uint32_t nof_symbols,
+                                          float    scaling)
+{
+  cf_t W[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS];
+  if (precoding_4tx_matrix(codebook_idx, nof_layers, W)) {
+    return SRSLTE_ERROR;
+  }
+  for (int p = 0; p < SRSLTE_MAX_PORTS; p++) {
+    for (int l = 0; l < nof_layers; l++) {
+      W[p][l] *= scaling;
+    }
+  }
+
+  int i = 0;
+#if SRSLTE_SIMD_CF_SIZE != 0
+  simd_cf_t _W[SRSLTE_MAX_PORTS][SRSLTE_MAX_LAYERS];
+  for (int p = 0; p < SRSLTE_MAX_PORTS; p++) {
+    for (int l = 0; l < nof_layers; l++) {
+      _W[p][l] = srslte_simd_cf_set1(W[p][l]);
+    }
+  }
+
+  for (; i < (int)nof_symbols - SRSLTE_SIMD_CF_SIZE + 1; i += SRSLTE_SIMD_CF_SIZE) {
+    simd_cf_t _x[SRSLTE_MAX_LAYERS];
+    for (int l = 0; l < nof_layers; l++) {
+      _x[l] = srslte_simd_cfi_load(&x[l][i]);
+    }
+    for (int p = 0; p < SRSLTE_MAX_PORTS; p++) {
+      simd_cf_t _y = srslte_simd_cf_prod(_W[p][0], _x[0]);
+      for (int l = 1; l < nof_layers; l++) {
+        _y = srslte_simd_cf_add(_y, srslte_simd_cf_prod(_W[p][l], _x[l]));
+      }
+      srslte_simd_cfi_store(&y[p][i], _y);
+    }
+  }
+#endif /* SRSLTE_SIMD_CF_SIZE != 0 */
+
+  for (; i < nof_symbols; i++) {
+    for (int p = 0; p < SRSLTE_MAX_PORTS; p++) {
+      y[p][i] = W[p][0] * x[0][i];
+      for (int l = 1; l < nof_layers; l++) {
+        y[p][i] += W[p][l] * x[l][i];
+      }
+    }
+  }
+  return SRSLTE_SUCCESS;
+}
+
 int srslte_precoding_multiplex(cf_t*    x[SRSLTE_MAX_LAYERS],
                                cf_t*    y[SRSLTE_MAX_PORTS],
                                int      nof_layers,
@@ -2215,6 +2756,8 @@ int srslte_precoding_multiplex(cf_t*    x[SRSLTE_MAX_LAYERS],
     } else {
       ERROR("Not implemented");
     }
+  } else if (nof_ports == 4) {
+    return srslte_precoding_multiplex_4tx(x, y, nof_layers, codebook_idx, nof_symbols, scaling);
   } else {
     ERROR("Not implemented");
   }
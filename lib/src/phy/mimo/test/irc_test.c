@@ -0,0 +1,248 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "srslte/phy/utils/random.h"
+#include "srslte/srslte.h"
+
+static int             nof_symbols  = 1200;
+static int             nof_rx_ports = 2;
+static float           sir_db       = -10.0f;
+static float           snr_db       = 30.0f;
+static srslte_random_t random_gen   = NULL;
+
+void usage(char* prog)
+{
+  printf("Usage: %s [nrsi]\n", prog);
+  printf("\t-n num_symbols [Default %d]\n", nof_symbols);
+  printf("\t-r nof_rx_ports [Default %d]\n", nof_rx_ports);
+  printf("\t-s SNR in dB [Default %.1fdB]\n", snr_db);
+  printf("\t-i SIR in dB [Default %.1fdB]\n", sir_db);
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "nrsi")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_symbols = (int)strtol(argv[optind], NULL, 10);
+        break;
+      case 'r':
+        nof_rx_ports = (int)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        snr_db = strtof(argv[optind], NULL);
+        break;
+      case 'i':
+        sir_db = strtof(argv[optind], NULL);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+static cf_t random_qpsk()
+{
+  return (srslte_random_bool(random_gen, 0.5f) ? M_SQRT1_2 : -M_SQRT1_2) +
+         _Complex_I * (srslte_random_bool(random_gen, 0.5f) ? M_SQRT1_2 : -M_SQRT1_2);
+}
+
+/* Circularly-symmetric complex Gaussian sample (Box-Muller) */
+static cf_t random_gauss(float std_dev)
+{
+  float u1 = srslte_random_uniform_real_dist(random_gen, FLT_MIN, 1.0f);
+  float u2 = srslte_random_uniform_real_dist(random_gen, 0.0f, 2.0f * (float)M_PI);
+  return std_dev * sqrtf(-logf(u1)) * cexpf(_Complex_I * u2);
+}
+
+/* Fraction of QPSK symbols decided wrongly, the MSE is not meaningful for Rayleigh channels in deep fade */
+static float ser(cf_t* x, cf_t* x_hat, int n)
+{
+  int errors = 0;
+  for (int i = 0; i < n; i++) {
+    if ((__real__ x[i] > 0) != (__real__ x_hat[i] > 0) || (__imag__ x[i] > 0) != (__imag__ x_hat[i] > 0)) {
+      errors++;
+    }
+  }
+  return (float)errors / n;
+}
+
+static float mse(cf_t* a, cf_t* b, int n)
+{
+  float e = 0.0f;
+  for (int i = 0; i < n; i++) {
+    e += __real__((a[i] - b[i]) * conjf(a[i] - b[i]));
+  }
+  return e / n;
+}
+
+int main(int argc, char** argv)
+{
+  int    ret                 = SRSLTE_ERROR;
+  cf_t*  x                   = NULL;
+  cf_t*  x_irc               = NULL;
+  cf_t*  x_mrc               = NULL;
+  cf_t*  x_ref               = NULL;
+  float* csi                 = NULL;
+  cf_t*  y[SRSLTE_MAX_PORTS] = {};
+  cf_t*  h[SRSLTE_MAX_PORTS] = {};
+  cf_t*  n[SRSLTE_MAX_PORTS] = {};
+  cf_t   g[SRSLTE_MAX_PORTS] = {};
+  cf_t   R[SRSLTE_MAX_PORTS * SRSLTE_MAX_PORTS];
+  cf_t   R_mrc[SRSLTE_MAX_PORTS * SRSLTE_MAX_PORTS];
+
+  parse_args(argc, argv);
+  if (nof_rx_ports < 1 || nof_rx_ports > SRSLTE_MAX_PORTS || nof_symbols < 1) {
+    usage(argv[0]);
+    return SRSLTE_ERROR;
+  }
+
+  random_gen = srslte_random_init(0x1234);
+
+  x     = srslte_vec_cf_malloc(nof_symbols);
+  x_irc = srslte_vec_cf_malloc(nof_symbols);
+  x_mrc = srslte_vec_cf_malloc(nof_symbols);
+  x_ref = srslte_vec_cf_malloc(nof_symbols);
+  csi   = srslte_vec_f_malloc(nof_symbols);
+  if (!x || !x_irc || !x_mrc || !x_ref || !csi) {
+    goto quit;
+  }
+  for (int p = 0; p < nof_rx_ports; p++) {
+    y[p] = srslte_vec_cf_malloc(nof_symbols);
+    h[p] = srslte_vec_cf_malloc(nof_symbols);
+    n[p] = srslte_vec_cf_malloc(nof_symbols);
+    if (!y[p] || !h[p] || !n[p]) {
+      goto quit;
+    }
+  }
+
+  // The interferer channel is flat, as in a group of PRB, the desired one changes every symbol
+  float i_std = powf(10.0f, -sir_db / 20.0f);
+  float n_std = powf(10.0f, -snr_db / 20.0f);
+  for (int p = 0; p < nof_rx_ports; p++) {
+    g[p] = random_gauss(i_std);
+  }
+  for (int i = 0; i < nof_symbols; i++) {
+    x[i] = random_qpsk();
+
+    // The interference plus noise is also observed separately, as the residual of the reference signals
+    cf_t interf     = random_qpsk();
+    cf_t interf_res = random_qpsk();
+    for (int p = 0; p < nof_rx_ports; p++) {
+      h[p][i] = random_gauss(1.0f);
+      y[p][i] = h[p][i] * x[i] + g[p] * interf + random_gauss(n_std);
+      n[p][i] = g[p] * interf_res + random_gauss(n_std);
+    }
+  }
+
+  if (srslte_predecoding_irc_covariance(n, nof_rx_ports, nof_symbols, R)) {
+    goto quit;
+  }
+  if (srslte_predecoding_single_irc(y, h, R, x_irc, NULL, nof_rx_ports, nof_symbols, 1.0f) < 0) {
+    goto quit;
+  }
+
+  // With an identity covariance IRC is MRC
+  for (int i = 0; i < nof_rx_ports * nof_rx_ports; i++) {
+    R_mrc[i] = (i % (nof_rx_ports + 1) == 0) ? 1.0f : 0.0f;
+  }
+  if (srslte_predecoding_single_irc(y, h, R_mrc, x_mrc, csi, nof_rx_ports, nof_symbols, 1.0f) < 0) {
+    goto quit;
+  }
+  for (int i = 0; i < nof_symbols; i++) {
+    cf_t  num = 0.0f;
+    float den = 0.0f;
+    for (int p = 0; p < nof_rx_ports; p++) {
+      num += conjf(h[p][i]) * y[p][i];
+      den += __real__(conjf(h[p][i]) * h[p][i]);
+    }
+    x_ref[i] = num / den;
+  }
+  float mse_mrc_ref = mse(x_ref, x_mrc, nof_symbols);
+
+  // With an identity covariance the SINR after combining is h'h
+  float csi_err = 0.0f;
+  for (int i = 0; i < nof_symbols; i++) {
+    float hh = 0.0f;
+    for (int p = 0; p < nof_rx_ports; p++) {
+      hh += __real__(conjf(h[p][i]) * h[p][i]);
+    }
+    csi_err = fmaxf(csi_err, fabsf(csi[i] - hh) / hh);
+  }
+
+  float ser_irc = ser(x, x_irc, nof_symbols);
+  float ser_mrc = ser(x, x_mrc, nof_symbols);
+  printf("nof_rx_ports=%d; SIR=%.1f dB; SER IRC=%f; SER MRC=%f\n", nof_rx_ports, sir_db, ser_irc, ser_mrc);
+
+  if (mse_mrc_ref > 1e-4f || csi_err > 1e-4f) {
+    printf("MRC mismatch (%e, CSI %e)\n", mse_mrc_ref, csi_err);
+    goto quit;
+  }
+
+  // IRC rejects the interferer when there are more antennas than interferers
+  if (nof_rx_ports > 1 && (ser_irc > 0.01f || ser_irc > ser_mrc / 4)) {
+    goto quit;
+  }
+
+  ret = SRSLTE_SUCCESS;
+
+quit:
+  for (int p = 0; p < SRSLTE_MAX_PORTS; p++) {
+    if (y[p]) {
+      free(y[p]);
+    }
+    if (h[p]) {
+      free(h[p]);
+    }
+    if (n[p]) {
+      free(n[p]);
+    }
+  }
+  if (x) {
+    free(x);
+  }
+  if (x_irc) {
+    free(x_irc);
+  }
+  if (x_mrc) {
+    free(x_mrc);
+  }
+  if (x_ref) {
+    free(x_ref);
+  }
+  if (csi) {
+    free(csi);
+  }
+  if (random_gen) {
+    srslte_random_free(random_gen);
+  }
+  printf("%s\n", ret ? "Failed" : "Ok");
+  return ret;
+}
@@ -95,6 +95,9 @@ inline static void vshuff_s16_odd(int16x8_t a, int imm, int16x8_t* res)
 
 #ifdef LV_HAVE_SSE
 #include <smmintrin.h>
+#ifdef LV_HAVE_AVX2
+#include <immintrin.h>
+#endif
 void demod_16qam_lte_s_sse(const cf_t* symbols, short* llr, int nsymbols);
 #endif
 
@@ -108,6 +111,10 @@ void demod_16qam_lte_s_sse(const cf_t* symbols, short* llr, int nsymbols);
 #define SCALE_BYTE_CONV_QAM64 40
 #define SCALE_BYTE_CONV_QAM256 50
 
+/* Number of symbols demodulated before descrambling them, so that the LLRs are still in the L1 cache when the
+ * scrambling sequence is applied. It is a multiple of every kernel width and keeps the blocks SIMD aligned. */
+#define SCRAMBLED_BLOCK_NOF_SYMBOLS 256
+
 void demod_bpsk_lte_b(const cf_t* symbols, int8_t* llr, int nsymbols)
 {
   for (int i = 0; i < nsymbols; i++) {
@@ -824,7 +831,7 @@ void demod_256qam_lte(const cf_t* symbols, float* llr, int nsymbols)
   }
 }
 
-void demod_256qam_lte_b(const cf_t* symbols, int8_t* llr, int nsymbols)
+static void demod_256qam_lte_b_generic(const cf_t* symbols, int8_t* llr, int nsymbols)
 {
   for (int i = 0; i < nsymbols; i++) {
     float real = -__real__ symbols[i];
@@ -846,7 +853,7 @@ void demod_256qam_lte_b(const cf_t* symbols, int8_t* llr, int nsymbols)
   }
 }
 
-void demod_256qam_lte_s(const cf_t* symbols, short* llr, int nsymbols)
+static void demod_256qam_lte_s_generic(const cf_t* symbols, short* llr, int nsymbols)
 {
   for (int i = 0; i < nsymbols; i++) {
     float real = -__real__ symbols[i];
@@ -868,6 +875,294 @@ void demod_256qam_lte_s(const cf_t* symbols, short* llr, int nsymbols)
   }
 }
 
+/*
+ * The 256QAM kernels below compute the four LLR levels of every (real, imaginary) pair in fixed point, directly at
+ * the turbo decoder input scale, and then transpose them so that the eight LLRs of each symbol are contiguous. The
+ * 8-bit versions clamp the first level to -127 so that its absolute value cannot overflow.
+ */
+
+#ifdef HAVE_NEONv8
+
+void demod_256qam_lte_s_neon(const cf_t* symbols, short* llr, int nsymbols)
+{
+  const float* symbolsPtr = (const float*)symbols;
+  int16_t*     resultPtr  = llr;
+  float32x4_t  scale_v    = vdupq_n_f32(-SCALE_SHORT_CONV_QAM256);
+  int16x8_t    offset1    = vdupq_n_s16(8 * SCALE_SHORT_CONV_QAM256 / sqrtf(170));
+  int16x8_t    offset2    = vdupq_n_s16(4 * SCALE_SHORT_CONV_QAM256 / sqrtf(170));
+  int16x8_t    offset3    = vdupq_n_s16(2 * SCALE_SHORT_CONV_QAM256 / sqrtf(170));
+
+  for (int i = 0; i < nsymbols / 4; i++) {
+    int32x4_t symbol_i1 = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(symbolsPtr), scale_v));
+    int32x4_t symbol_i2 = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(symbolsPtr + 4), scale_v));
+    symbolsPtr += 8;
+
+    int16x8_t llr0 = vcombine_s16(vqmovn_s32(symbol_i1), vqmovn_s32(symbol_i2));
+    int16x8_t llr1 = vsubq_s16(vqabsq_s16(llr0), offset1);
+    int16x8_t llr2 = vsubq_s16(vqabsq_s16(llr1), offset2);
+    int16x8_t llr3 = vsubq_s16(vqabsq_s16(llr2), offset3);
+
+    // Each 32-bit word holds the real and imaginary LLR of one symbol and level
+    int32x4x2_t z01 = vzipq_s32(vreinterpretq_s32_s16(llr0), vreinterpretq_s32_s16(llr1));
+    int32x4x2_t z23 = vzipq_s32(vreinterpretq_s32_s16(llr2), vreinterpretq_s32_s16(llr3));
+
+    vst1q_s16(resultPtr, vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(z01.val[0]), vget_low_s32(z23.val[0]))));
+    vst1q_s16(resultPtr + 8, vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(z01.val[0]), vget_high_s32(z23.val[0]))));
+    vst1q_s16(resultPtr + 16, vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(z01.val[1]), vget_low_s32(z23.val[1]))));
+    vst1q_s16(resultPtr + 24, vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(z01.val[1]), vget_high_s32(z23.val[1]))));
+    resultPtr += 32;
+  }
+
+  demod_256qam_lte_s_generic(&symbols[4 * (nsymbols / 4)], resultPtr, nsymbols % 4);
+}
+
+void demod_256qam_lte_b_neon(const cf_t* symbols, int8_t* llr, int nsymbols)
+{
+  const float* symbolsPtr = (const float*)symbols;
+  int8_t*      resultPtr  = llr;
+  float32x4_t  scale_v    = vdupq_n_f32(-SCALE_BYTE_CONV_QAM256);
+  int8x16_t    min_v      = vdupq_n_s8(-INT8_MAX);
+  int8x16_t    offset1    = vdupq_n_s8(8 * SCALE_BYTE_CONV_QAM256 / sqrtf(170));
+  int8x16_t    offset2    = vdupq_n_s8(4 * SCALE_BYTE_CONV_QAM256 / sqrtf(170));
+  int8x16_t    offset3    = vdupq_n_s8(2 * SCALE_BYTE_CONV_QAM256 / sqrtf(170));
+
+  for (int i = 0; i < nsymbols / 8; i++) {
+    int32x4_t symbol_i1 = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(symbolsPtr), scale_v));
+    int32x4_t symbol_i2 = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(symbolsPtr + 4), scale_v));
+    int32x4_t symbol_i3 = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(symbolsPtr + 8), scale_v));
+    int32x4_t symbol_i4 = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(symbolsPtr + 12), scale_v));
+    symbolsPtr += 16;
+
+    int16x8_t symbol_12 = vcombine_s16(vqmovn_s32(symbol_i1), vqmovn_s32(symbol_i2));
+    int16x8_t symbol_34 = vcombine_s16(vqmovn_s32(symbol_i3), vqmovn_s32(symbol_i4));
+
+    int8x16_t llr0 = vmaxq_s8(vcombine_s8(vqmovn_s16(symbol_12), vqmovn_s16(symbol_34)), min_v);
+    int8x16_t llr1 = vsubq_s8(vabsq_s8(llr0), offset1);
+    int8x16_t llr2 = vsubq_s8(vabsq_s8(llr1), offset2);
+    int8x16_t llr3 = vsubq_s8(vabsq_s8(llr2), offset3);
+
+    // Each 16-bit word holds the real and imaginary LLR of one symbol and level
+    int16x8x2_t z01 = vzipq_s16(vreinterpretq_s16_s8(llr0), vreinterpretq_s16_s8(llr1));
+    int16x8x2_t z23 = vzipq_s16(vreinterpretq_s16_s8(llr2), vreinterpretq_s16_s8(llr3));
+    int32x4x2_t lo  = vzipq_s32(vreinterpretq_s32_s16(z01.val[0]), vreinterpretq_s32_s16(z23.val[0]));
+    int32x4x2_t hi  = vzipq_s32(vreinterpretq_s32_s16(z01.val[1]), vreinterpretq_s32_s16(z23.val[1]));
+
+    vst1q_s8(resultPtr, vreinterpretq_s8_s32(lo.val[0]));
+    vst1q_s8(resultPtr + 16, vreinterpretq_s8_s32(lo.val[1]));
+    vst1q_s8(resultPtr + 32, vreinterpretq_s8_s32(hi.val[0]));
+    vst1q_s8(resultPtr + 48, vreinterpretq_s8_s32(hi.val[1]));
+    resultPtr += 64;
+  }
+
+  demod_256qam_lte_b_generic(&symbols[8 * (nsymbols / 8)], resultPtr, nsymbols % 8);
+}
+
+#endif
+
+#ifdef LV_HAVE_SSE
+
+static void demod_256qam_lte_s_sse(const cf_t* symbols, short* llr, int nsymbols)
+{
+  const float* symbolsPtr = (const float*)symbols;
+  __m128i*     resultPtr  = (__m128i*)llr;
+  __m128       scale_v    = _mm_set1_ps(-SCALE_SHORT_CONV_QAM256);
+  __m128i      offset1    = _mm_set1_epi16(8 * SCALE_SHORT_CONV_QAM256 / sqrtf(170));
+  __m128i      offset2    = _mm_set1_epi16(4 * SCALE_SHORT_CONV_QAM256 / sqrtf(170));
+  __m128i      offset3    = _mm_set1_epi16(2 * SCALE_SHORT_CONV_QAM256 / sqrtf(170));
+
+  for (int i = 0; i < nsymbols / 4; i++) {
+    __m128i symbol_i1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(symbolsPtr), scale_v));
+    __m128i symbol_i2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(symbolsPtr + 4), scale_v));
+    symbolsPtr += 8;
+
+    __m128i llr0 = _mm_packs_epi32(symbol_i1, symbol_i2);
+    __m128i llr1 = _mm_sub_epi16(_mm_abs_epi16(llr0), offset1);
+    __m128i llr2 = _mm_sub_epi16(_mm_abs_epi16(llr1), offset2);
+    __m128i llr3 = _mm_sub_epi16(_mm_abs_epi16(llr2), offset3);
+
+    // Each 32-bit word holds the real and imaginary LLR of one symbol and level
+    __m128i llr01_lo = _mm_unpacklo_epi32(llr0, llr1);
+    __m128i llr23_lo = _mm_unpacklo_epi32(llr2, llr3);
+    __m128i llr01_hi = _mm_unpackhi_epi32(llr0, llr1);
+    __m128i llr23_hi = _mm_unpackhi_epi32(llr2, llr3);
+
+    _mm_storeu_si128(resultPtr++, _mm_unpacklo_epi64(llr01_lo, llr23_lo));
+    _mm_storeu_si128(resultPtr++, _mm_unpackhi_epi64(llr01_lo, llr23_lo));
+    _mm_storeu_si128(resultPtr++, _mm_unpacklo_epi64(llr01_hi, llr23_hi));
+    _mm_storeu_si128(resultPtr++, _mm_unpackhi_epi64(llr01_hi, llr23_hi));
+  }
+
+  demod_256qam_lte_s_generic(&symbols[4 * (nsymbols / 4)], (short*)resultPtr, nsymbols % 4);
+}
+
+static void demod_256qam_lte_b_sse(const cf_t* symbols, int8_t* llr, int nsymbols)
+{
+  const float* symbolsPtr = (const float*)symbols;
+  __m128i*     resultPtr  = (__m128i*)llr;
+  __m128       scale_v    = _mm_set1_ps(-SCALE_BYTE_CONV_QAM256);
+  __m128i      min_v      = _mm_set1_epi8(-INT8_MAX);
+  __m128i      offset1    = _mm_set1_epi8(8 * SCALE_BYTE_CONV_QAM256 / sqrtf(170));
+  __m128i      offset2    = _mm_set1_epi8(4 * SCALE_BYTE_CONV_QAM256 / sqrtf(170));
+  __m128i      offset3    = _mm_set1_epi8(2 * SCALE_BYTE_CONV_QAM256 / sqrtf(170));
+
+  for (int i = 0; i < nsymbols / 8; i++) {
+    __m128i symbol_i1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(symbolsPtr), scale_v));
+    __m128i symbol_i2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(symbolsPtr + 4), scale_v));
+    __m128i symbol_i3 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(symbolsPtr + 8), scale_v));
+    __m128i symbol_i4 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(symbolsPtr + 12), scale_v));
+    symbolsPtr += 16;
+
+    __m128i symbol_12 = _mm_packs_epi32(symbol_i1, symbol_i2);
+    __m128i symbol_34 = _mm_packs_epi32(symbol_i3, symbol_i4);
+
+    __m128i llr0 = _mm_max_epi8(_mm_packs_epi16(symbol_12, symbol_34), min_v);
+    __m128i llr1 = _mm_sub_epi8(_mm_abs_epi8(llr0), offset1);
+    __m128i llr2 = _mm_sub_epi8(_mm_abs_epi8(llr1), offset2);
+    __m128i llr3 = _mm_sub_epi8(_mm_abs_epi8(llr2), offset3);
+
+    // Each 16-bit word holds the real and imaginary LLR of one symbol and level
+    __m128i llr01_lo = _mm_unpacklo_epi16(llr0, llr1);
+    __m128i llr23_lo = _mm_unpacklo_epi16(llr2, llr3);
+    __m128i llr01_hi = _mm_unpackhi_epi16(llr0, llr1);
+    __m128i llr23_hi = _mm_unpackhi_epi16(llr2, llr3);
+
+    _mm_storeu_si128(resultPtr++, _mm_unpacklo_epi32(llr01_lo, llr23_lo));
+    _mm_storeu_si128(resultPtr++, _mm_unpackhi_epi32(llr01_lo, llr23_lo));
+    _mm_storeu_si128(resultPtr++, _mm_unpacklo_epi32(llr01_hi, llr23_hi));
+    _mm_storeu_si128(resultPtr++, _mm_unpackhi_epi32(llr01_hi, llr23_hi));
+  }
+
+  demod_256qam_lte_b_generic(&symbols[8 * (nsymbols / 8)], (int8_t*)resultPtr, nsymbols % 8);
+}
+
+#endif
+
+#ifdef LV_HAVE_AVX2
+
+static void demod_256qam_lte_s_avx2(const cf_t* symbols, short* llr, int nsymbols)
+{
+  const float* symbolsPtr = (const float*)symbols;
+  __m256i*     resultPtr  = (__m256i*)llr;
+  __m256       scale_v    = _mm256_set1_ps(-SCALE_SHORT_CONV_QAM256);
+  __m256i      offset1    = _mm256_set1_epi16(8 * SCALE_SHORT_CONV_QAM256 / sqrtf(170));
+  __m256i      offset2    = _mm256_set1_epi16(4 * SCALE_SHORT_CONV_QAM256 / sqrtf(170));
+  __m256i      offset3    = _mm256_set1_epi16(2 * SCALE_SHORT_CONV_QAM256 / sqrtf(170));
+
+  for (int i = 0; i < nsymbols / 8; i++) {
+    __m256i symbol_i1 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(symbolsPtr), scale_v));
+    __m256i symbol_i2 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(symbolsPtr + 8), scale_v));
+    symbolsPtr += 16;
+
+    // The pack works within 128-bit lanes, put the symbols back in order
+    __m256i llr0 = _mm256_permute4x64_epi64(_mm256_packs_epi32(symbol_i1, symbol_i2), 0xD8);
+    __m256i llr1 = _mm256_sub_epi16(_mm256_abs_epi16(llr0), offset1);
+    __m256i llr2 = _mm256_sub_epi16(_mm256_abs_epi16(llr1), offset2);
+    __m256i llr3 = _mm256_sub_epi16(_mm256_abs_epi16(llr2), offset3);
+
+    // Transpose within each lane, every output lane holds the eight LLRs of one symbol
+    __m256i llr01_lo = _mm256_unpacklo_epi32(llr0, llr1);
+    __m256i llr23_lo = _mm256_unpacklo_epi32(llr2, llr3);
+    __m256i llr01_hi = _mm256_unpackhi_epi32(llr0, llr1);
+    __m256i llr23_hi = _mm256_unpackhi_epi32(llr2, llr3);
+
+    __m256i r0 = _mm256_unpacklo_epi64(llr01_lo, llr23_lo);
+    __m256i r1 = _mm256_unpackhi_epi64(llr01_lo, llr23_lo);
+    __m256i r2 = _mm256_unpacklo_epi64(llr01_hi, llr23_hi);
+    __m256i r3 = _mm256_unpackhi_epi64(llr01_hi, llr23_hi);
+
+    _mm256_storeu_si256(resultPtr++, _mm256_permute2x128_si256(r0, r1, 0x20));
+    _mm256_storeu_si256(resultPtr++, _mm256_permute2x128_si256(r2, r3, 0x20));
+    _mm256_storeu_si256(resultPtr++, _mm256_permute2x128_si256(r0, r1, 0x31));
+    _mm256_storeu_si256(resultPtr++, _mm256_permute2x128_si256(r2, r3, 0x31));
+  }
+
+  demod_256qam_lte_s_sse(&symbols[8 * (nsymbols / 8)], (short*)resultPtr, nsymbols % 8);
+}
+
+static void demod_256qam_lte_b_avx2(const cf_t* symbols, int8_t* llr, int nsymbols)
+{
+  const float* symbolsPtr = (const float*)symbols;
+  __m256i*     resultPtr  = (__m256i*)llr;
+  __m256       scale_v    = _mm256_set1_ps(-SCALE_BYTE_CONV_QAM256);
+  __m256i      order      = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  __m256i      min_v      = _mm256_set1_epi8(-INT8_MAX);
+  __m256i      offset1    = _mm256_set1_epi8(8 * SCALE_BYTE_CONV_QAM256 / sqrtf(170));
+  __m256i      offset2    = _mm256_set1_epi8(4 * SCALE_BYTE_CONV_QAM256 / sqrtf(170));
+  __m256i      offset3    = _mm256_set1_epi8(2 * SCALE_BYTE_CONV_QAM256 / sqrtf(170));
+
+  for (int i = 0; i < nsymbols / 16; i++) {
+    __m256i symbol_i1 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(symbolsPtr), scale_v));
+    __m256i symbol_i2 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(symbolsPtr + 8), scale_v));
+    __m256i symbol_i3 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(symbolsPtr + 16), scale_v));
+    __m256i symbol_i4 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(symbolsPtr + 24), scale_v));
+    symbolsPtr += 32;
+
+    __m256i symbol_12 = _mm256_packs_epi32(symbol_i1, symbol_i2);
+    __m256i symbol_34 = _mm256_packs_epi32(symbol_i3, symbol_i4);
+
+    // The packs work within 128-bit lanes, put the symbols back in order
+    __m256i llr0 = _mm256_permutevar8x32_epi32(_mm256_packs_epi16(symbol_12, symbol_34), order);
+    llr0         = _mm256_max_epi8(llr0, min_v);
+    __m256i llr1 = _mm256_sub_epi8(_mm256_abs_epi8(llr0), offset1);
+    __m256i llr2 = _mm256_sub_epi8(_mm256_abs_epi8(llr1), offset2);
+    __m256i llr3 = _mm256_sub_epi8(_mm256_abs_epi8(llr2), offset3);
+
+    // Transpose within each lane, every output lane holds the LLRs of two symbols
+    __m256i llr01_lo = _mm256_unpacklo_epi16(llr0, llr1);
+    __m256i llr23_lo = _mm256_unpacklo_epi16(llr2, llr3);
+    __m256i llr01_hi = _mm256_unpackhi_epi16(llr0, llr1);
+    __m256i llr23_hi = _mm256_unpackhi_epi16(llr2, llr3);
+
+    __m256i r0 = _mm256_unpacklo_epi32(llr01_lo, llr23_lo);
+    __m256i r1 = _mm256_unpackhi_epi32(llr01_lo, llr23_lo);
+    __m256i r2 = _mm256_unpacklo_epi32(llr01_hi, llr23_hi);
+    __m256i r3 = _mm256_unpackhi_epi32(llr01_hi, llr23_hi);
+
+    _mm256_storeu_si256(resultPtr++, _mm256_permute2x128_si256(r0, r1, 0x20));
+    _mm256_storeu_si256(resultPtr++, _mm256_permute2x128_si256(r2, r3, 0x20));
+    _mm256_storeu_si256(resultPtr++, _mm256_permute2x128_si256(r0, r1, 0x31));
+    _mm256_storeu_si256(resultPtr++, _mm256_permute2x128_si256(r2, r3, 0x31));
+  }
+
+  demod_256qam_lte_b_sse(&symbols[16 * (nsymbols / 16)], (int8_t*)resultPtr, nsymbols % 16);
+}
+
+#endif
+
+void demod_256qam_lte_b(const cf_t* symbols, int8_t* llr, int nsymbols)
+{
+#ifdef LV_HAVE_AVX2
+  demod_256qam_lte_b_avx2(symbols, llr, nsymbols);
+#else
+#ifdef LV_HAVE_SSE
+  demod_256qam_lte_b_sse(symbols, llr, nsymbols);
+#else
+#ifdef HAVE_NEONv8
+  demod_256qam_lte_b_neon(symbols, llr, nsymbols);
+#else
+  demod_256qam_lte_b_generic(symbols, llr, nsymbols);
+#endif
+#endif
+#endif
+}
+
+void demod_256qam_lte_s(const cf_t* symbols, short* llr, int nsymbols)
+{
+#ifdef LV_HAVE_AVX2
+  demod_256qam_lte_s_avx2(symbols, llr, nsymbols);
+#else
+#ifdef LV_HAVE_SSE
+  demod_256qam_lte_s_sse(symbols, llr, nsymbols);
+#else
+#ifdef HAVE_NEONv8
+  demod_256qam_lte_s_neon(symbols, llr, nsymbols);
+#else
+  demod_256qam_lte_s_generic(symbols, llr, nsymbols);
+#endif
+#endif
+#endif
+}
+
 int srslte_demod_soft_demodulate(srslte_mod_t modulation, const cf_t* symbols, float* llr, int nsymbols)
 {
   switch (modulation) {
@@ -942,3 +1237,49 @@ int srslte_demod_soft_demodulate_b(srslte_mod_t modulation, const cf_t* symbols,
   }
   return 0;
 }
+
+int srslte_demod_soft_demodulate_s_scrambled(srslte_mod_t             modulation,
+                                             const cf_t*              symbols,
+                                             short*                   llr,
+                                             int                      nsymbols,
+                                             const srslte_sequence_t* seq)
+{
+  uint32_t nof_bits = srslte_mod_bits_x_symbol(modulation);
+  if (nof_bits == 0 || nsymbols < 0 || seq == NULL || nsymbols * nof_bits > seq->cur_len) {
+    ERROR("Invalid inputs for scrambled demodulation\n");
+    return -1;
+  }
+
+  for (int i = 0; i < nsymbols; i += SCRAMBLED_BLOCK_NOF_SYMBOLS) {
+    int      n   = SRSLTE_MIN(SCRAMBLED_BLOCK_NOF_SYMBOLS, nsymbols - i);
+    uint32_t off = i * nof_bits;
+    if (srslte_demod_soft_demodulate_s(modulation, &symbols[i], &llr[off], n)) {
+      return -1;
+    }
+    srslte_vec_neg_sss(&llr[off], &seq->c_short[off], &llr[off], n * nof_bits);
+  }
+  return 0;
+}
+
+int srslte_demod_soft_demodulate_b_scrambled(srslte_mod_t             modulation,
+                                             const cf_t*              symbols,
+                                             int8_t*                  llr,
+                                             int                      nsymbols,
+                                             const srslte_sequence_t* seq)
+{
+  uint32_t nof_bits = srslte_mod_bits_x_symbol(modulation);
+  if (nof_bits == 0 || nsymbols < 0 || seq == NULL || nsymbols * nof_bits > seq->cur_len) {
+    ERROR("Invalid inputs for scrambled demodulation\n");
+    return -1;
+  }
+
+  for (int i = 0; i < nsymbols; i += SCRAMBLED_BLOCK_NOF_SYMBOLS) {
+    int      n   = SRSLTE_MIN(SCRAMBLED_BLOCK_NOF_SYMBOLS, nsymbols - i);
+    uint32_t off = i * nof_bits;
+    if (srslte_demod_soft_demodulate_b(modulation, &symbols[i], &llr[off], n)) {
+      return -1;
+    }
+    srslte_vec_neg_bbb(&llr[off], &seq->c_char[off], &llr[off], n * nof_bits);
+  }
+  return 0;
+}
@@ -90,6 +90,8 @@ int main(int argc, char** argv)
   uint8_t *            input, *input_bytes, *output;
   cf_t *               symbols, *symbols_bytes;
   float*               llr;
+  short*               llr_s;
+  int8_t*              llr_b;
 
   parse_args(argc, argv);
 
@@ -140,6 +142,18 @@ int main(int argc, char** argv)
     exit(-1);
   }
 
+  llr_s = srslte_vec_i16_malloc(num_bits);
+  if (!llr_s) {
+    perror("malloc");
+    exit(-1);
+  }
+
+  llr_b = srslte_vec_i8_malloc(num_bits);
+  if (!llr_b) {
+    perror("malloc");
+    exit(-1);
+  }
+
   /* generate random data */
   for (i = 0; i < num_bits; i++) {
     input[i] = rand() % 2;
@@ -194,7 +208,47 @@ int main(int argc, char** argv)
     }
   }
 
+  /* check the fixed-point demodulators give the same hard decisions */
+  srslte_demod_soft_demodulate_s(modulation, symbols, llr_s, num_bits / mod.nbits_x_symbol);
+  srslte_demod_soft_demodulate_b(modulation, symbols, llr_b, num_bits / mod.nbits_x_symbol);
+  for (i = 0; i < num_bits && ret == SRSLTE_SUCCESS; i++) {
+    if (input[i] != (llr_s[i] > 0 ? 1 : 0)) {
+      ERROR("Error in bit %d (int16)\n", i);
+      ret = SRSLTE_ERROR;
+    } else if (input[i] != (llr_b[i] > 0 ? 1 : 0)) {
+      ERROR("Error in bit %d (int8)\n", i);
+      ret = SRSLTE_ERROR;
+    }
+  }
+
+  /* check the demodulation with descrambling against descrambling the demodulated LLRs */
+  srslte_sequence_t seq = {};
+  if (srslte_sequence_LTE_pr(&seq, num_bits, 1234)) {
+    ERROR("Error initializing scrambling sequence\n");
+    exit(-1);
+  }
+  short*  llr_s2 = srslte_vec_i16_malloc(num_bits);
+  int8_t* llr_b2 = srslte_vec_i8_malloc(num_bits);
+  if (!llr_s2 || !llr_b2) {
+    perror("malloc");
+    exit(-1);
+  }
+  srslte_scrambling_s_offset(&seq, llr_s, 0, num_bits);
+  srslte_scrambling_sb_offset(&seq, llr_b, 0, num_bits);
+  srslte_demod_soft_demodulate_s_scrambled(modulation, symbols, llr_s2, num_bits / mod.nbits_x_symbol, &seq);
+  srslte_demod_soft_demodulate_b_scrambled(modulation, symbols, llr_b2, num_bits / mod.nbits_x_symbol, &seq);
+  if (ret == SRSLTE_SUCCESS &&
+      (memcmp(llr_s, llr_s2, sizeof(short) * num_bits) != 0 || memcmp(llr_b, llr_b2, num_bits) != 0)) {
+    ERROR("Error in demodulation with descrambling\n");
+    ret = SRSLTE_ERROR;
+  }
+  free(llr_s2);
+  free(llr_b2);
+  srslte_sequence_free(&seq);
+
   free(llr);
+  free(llr_s);
+  free(llr_b);
   free(symbols);
   free(symbols_bytes);
   free(output);
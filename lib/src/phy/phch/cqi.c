@@ -605,7 +605,7 @@ uint8_t srslte_cqi_from_snr(float snr)
  * i.e., the number of RBs per subband as a function of the cell bandwidth
  * (Table 7.2.1-3 in TS 36.213)
  */
-static int cqi_hl_get_subband_size(int nof_prb)
+int srslte_cqi_hl_get_subband_size(int nof_prb)
 {
   if (nof_prb < 7) {
     return 0;
@@ -625,7 +625,7 @@ static int cqi_hl_get_subband_size(int nof_prb)
  */
 int srslte_cqi_hl_get_no_subbands(int nof_prb)
 {
-  int hl_size = cqi_hl_get_subband_size(nof_prb);
+  int hl_size = srslte_cqi_hl_get_subband_size(nof_prb);
   if (hl_size > 0) {
     return (int)ceil((float)nof_prb / hl_size);
   } else {
@@ -633,6 +633,17 @@ int srslte_cqi_hl_get_no_subbands(int nof_prb)
   }
 }
 
+/* Returns the CQI of a subband of a higher layer-configured subband report, from the wideband CQI and the 2-bit
+ * differential CQI of the subband (Table 7.2.1-2 in TS 36.213). The differential CQIs are ordered from the lowest
+ * subband, first, to the highest one.
+ */
+uint32_t srslte_cqi_hl_get_subband_cqi(const srslte_cqi_cfg_t* cfg, const srslte_cqi_hl_subband_t* msg, uint32_t sb_idx)
+{
+  uint32_t diff = (msg->subband_diff_cqi_cw0 >> (2 * (cfg->N - 1 - sb_idx))) & 0x3;
+  int      cqi  = (int)msg->wideband_cqi_cw0 + (diff == 3 ? -1 : (int)diff);
+  return (uint32_t)SRSLTE_MIN(SRSLTE_MAX(cqi, 0), 15);
+}
+
 void srslte_cqi_to_str(const uint8_t* cqi_value, int cqi_len, char* str, int str_len)
 {
   int i = 0;
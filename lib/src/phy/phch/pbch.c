@@ -190,6 +190,10 @@ int srslte_pbch_init(srslte_pbch_t* q)
     if (!q->temp) {
       goto clean;
     }
+    q->rm_frames = srslte_vec_f_malloc(SRSLTE_MAX_PORTS * 4 * 4 * SRSLTE_BCH_ENCODED_LEN);
+    if (!q->rm_frames) {
+      goto clean;
+    }
     q->rm_b = srslte_vec_u8_malloc(q->nof_symbols * 4 * 2);
     if (!q->rm_b) {
       goto clean;
@@ -227,6 +231,9 @@ void srslte_pbch_free(srslte_pbch_t* q)
   if (q->temp) {
     free(q->temp);
   }
+  if (q->rm_frames) {
+    free(q->rm_frames);
+  }
   if (q->rm_b) {
     free(q->rm_b);
   }
@@ -396,25 +403,44 @@ uint32_t srslte_pbch_crc_check(srslte_pbch_t* q, uint8_t* bits, uint32_t nof_por
   }
 }
 
-int decode_frame(srslte_pbch_t* q, uint32_t src, uint32_t dst, uint32_t n, uint32_t nof_bits, uint32_t nof_ports)
+static float* pbch_rm_frame(srslte_pbch_t* q, uint32_t nof_ports, uint32_t frame, uint32_t pos)
 {
-  int j;
-
-  if (dst + n <= 4 && src + n <= 4) {
-    srslte_vec_f_copy(&q->temp[dst * nof_bits], &q->llr[src * nof_bits], n * nof_bits);
+  return &q->rm_frames[(((nof_ports - 1) * 4 + frame) * 4 + pos) * SRSLTE_BCH_ENCODED_LEN];
+}
 
-    /* descramble */
-    srslte_scrambling_f_offset(&q->seq, &q->temp[dst * nof_bits], dst * nof_bits, n * nof_bits);
+/* De-rate matches the LLR of a frame as if it was in each of the 4 positions of the 40 ms. The rate matching
+ * combines the LLR linearly, so decoding several frames only needs to add their contributions
+ */
+static void pbch_rm_frames_add(srslte_pbch_t* q, uint32_t frame, uint32_t nof_bits, uint32_t nof_ports)
+{
+  srslte_vec_f_copy(q->temp, q->llr, nof_bits);
+  for (uint32_t j = nof_bits; j < 4 * nof_bits; j++) {
+    q->temp[j] = SRSLTE_RX_NULL;
+  }
 
-    for (j = 0; j < dst * nof_bits; j++) {
-      q->temp[j] = SRSLTE_RX_NULL;
-    }
-    for (j = (dst + n) * nof_bits; j < 4 * nof_bits; j++) {
-      q->temp[j] = SRSLTE_RX_NULL;
+  for (uint32_t pos = 0; pos < 4; pos++) {
+    /* descramble, the frame is moved to its position in the circular buffer */
+    if (pos > 0) {
+      srslte_vec_f_copy(&q->temp[pos * nof_bits], q->llr, nof_bits);
+      for (uint32_t j = (pos - 1) * nof_bits; j < pos * nof_bits; j++) {
+        q->temp[j] = SRSLTE_RX_NULL;
+      }
     }
+    srslte_scrambling_f_offset(&q->seq, &q->temp[pos * nof_bits], pos * nof_bits, nof_bits);
 
     /* unrate matching */
-    srslte_rm_conv_rx(q->temp, 4 * nof_bits, q->rm_f, SRSLTE_BCH_ENCODED_LEN);
+    srslte_rm_conv_rx(q->temp, 4 * nof_bits, pbch_rm_frame(q, nof_ports, frame, pos), SRSLTE_BCH_ENCODED_LEN);
+  }
+}
+
+static int decode_frame(srslte_pbch_t* q, uint32_t src, uint32_t dst, uint32_t n, uint32_t nof_ports)
+{
+  if (dst + n <= 4 && src + n <= 4) {
+    /* soft combine the frames */
+    srslte_vec_f_copy(q->rm_f, pbch_rm_frame(q, nof_ports, src, dst), SRSLTE_BCH_ENCODED_LEN);
+    for (uint32_t i = 1; i < n; i++) {
+      srslte_vec_sum_fff(q->rm_f, pbch_rm_frame(q, nof_ports, src + i, dst + i), q->rm_f, SRSLTE_BCH_ENCODED_LEN);
+    }
 
     /* Normalize LLR */
     srslte_vec_sc_prod_fff(q->rm_f, 1.0 / ((float)2 * n), q->rm_f, SRSLTE_BCH_ENCODED_LEN);
@@ -512,34 +538,34 @@ int srslte_pbch_decode(srslte_pbch_t*         q,
         }
 
         /* demodulate symbols */
-        srslte_demod_soft_demodulate(SRSLTE_MOD_QPSK, q->d, &q->llr[nof_bits * (frame_idx - 1)], q->nof_symbols);
+        srslte_demod_soft_demodulate(SRSLTE_MOD_QPSK, q->d, q->llr, q->nof_symbols);
+        pbch_rm_frames_add(q, frame_idx - 1, nof_bits, nant);
 
         /* We don't know where the 40 ms begin, so we try all combinations. E.g. if we received
          * 4 frames, try 1,2,3,4 individually, 12, 23, 34 in pairs, 123, 234 and finally 1234.
-         * We know they are ordered.
+         * We know they are ordered. The combinations without the last frame were tried in the previous calls.
          */
         for (nb = 0; nb < frame_idx; nb++) {
+          src = frame_idx - 1 - nb;
           for (dst = 0; (dst < 4 - nb); dst++) {
-            for (src = 0; src < frame_idx - nb; src++) {
-              ret = decode_frame(q, src, dst, nb + 1, nof_bits, nant);
-              if (ret == 1) {
-                if (sfn_offset) {
-                  *sfn_offset = (int)dst - src + frame_idx - 1;
-                }
-                if (nof_tx_ports) {
-                  *nof_tx_ports = nant;
-                }
-                if (bch_payload) {
-                  memcpy(bch_payload, q->data, sizeof(uint8_t) * SRSLTE_BCH_PAYLOAD_LEN);
-                }
-                INFO("Decoded PBCH: src=%d, dst=%d, nb=%d, sfn_offset=%d\n",
-                     src,
-                     dst,
-                     nb + 1,
-                     (int)dst - src + frame_idx - 1);
-                srslte_pbch_decode_reset(q);
-                return 1;
+            ret = decode_frame(q, src, dst, nb + 1, nant);
+            if (ret == 1) {
+              if (sfn_offset) {
+                *sfn_offset = (int)dst - src + frame_idx - 1;
+              }
+              if (nof_tx_ports) {
+                *nof_tx_ports = nant;
               }
+              if (bch_payload) {
+                memcpy(bch_payload, q->data, sizeof(uint8_t) * SRSLTE_BCH_PAYLOAD_LEN);
+              }
+              INFO("Decoded PBCH: src=%d, dst=%d, nb=%d, sfn_offset=%d\n",
+                   src,
+                   dst,
+                   nb + 1,
+                   (int)dst - src + frame_idx - 1);
+              srslte_pbch_decode_reset(q);
+              return 1;
             }
           }
         }
@@ -549,7 +575,11 @@ int srslte_pbch_decode(srslte_pbch_t*         q,
 
     /* If not found, make room for the next packet of radio frame symbols */
     if (q->frame_idx == 4) {
-      memmove(q->llr, &q->llr[nof_bits], nof_bits * 3 * sizeof(float));
+      for (nant = 1; nant <= SRSLTE_MAX_PORTS; nant++) {
+        memmove(pbch_rm_frame(q, nant, 0, 0),
+                pbch_rm_frame(q, nant, 1, 0),
+                3 * 4 * SRSLTE_BCH_ENCODED_LEN * sizeof(float));
+      }
       q->frame_idx = 3;
     }
   }
@@ -71,6 +71,20 @@ static int pdcch_init(srslte_pdcch_t* q, uint32_t max_prb, uint32_t nof_rx_anten
     }
 
     int poly[3] = {0x6D, 0x4F, 0x57};
+
+    /* Coded bits of the DCI encoder for every state of the shift register */
+    for (uint32_t sr = 0; sr < (1 << 7); sr++) {
+      for (uint32_t j = 0; j < 3; j++) {
+        uint32_t v = sr & poly[j];
+        uint8_t  p = 0;
+        while (v) {
+          p ^= 1;
+          v &= v - 1;
+        }
+        q->cc_table[sr][j] = p;
+      }
+    }
+
     if (srslte_viterbi_init(&q->decoder, SRSLTE_VITERBI_37, poly, SRSLTE_DCI_MAX_BITS + 16, true)) {
       goto clean;
     }
@@ -87,6 +101,12 @@ static int pdcch_init(srslte_pdcch_t* q, uint32_t max_prb, uint32_t nof_rx_anten
 
     srslte_vec_f_zero(q->llr, q->max_bits);
 
+    q->cce_energy = srslte_vec_f_malloc(q->max_bits / 72);
+    if (!q->cce_energy) {
+      goto clean;
+    }
+    srslte_vec_f_zero(q->cce_energy, q->max_bits / 72);
+
     q->d = srslte_vec_cf_malloc(q->max_bits / 2);
     if (!q->d) {
       goto clean;
@@ -139,6 +159,9 @@ void srslte_pdcch_free(srslte_pdcch_t* q)
   if (q->llr) {
     free(q->llr);
   }
+  if (q->cce_energy) {
+    free(q->cce_energy);
+  }
   if (q->d) {
     free(q->d);
   }
@@ -160,6 +183,11 @@ void srslte_pdcch_free(srslte_pdcch_t* q)
   for (int i = 0; i < SRSLTE_NOF_SF_X_FRAME; i++) {
     srslte_sequence_free(&q->seq[i]);
   }
+  for (int i = 0; i < SRSLTE_DCI_MAX_BITS; i++) {
+    if (q->rm_table[i]) {
+      free(q->rm_table[i]);
+    }
+  }
 
   srslte_modem_table_free(&q->mod);
   srslte_viterbi_free(&q->decoder);
@@ -371,6 +399,46 @@ int srslte_pdcch_dci_decode(srslte_pdcch_t* q, float* e, uint8_t* data, uint32_t
   }
 }
 
+/* Blind decoding asks for the same candidate several times, for instance Format0 and Format1A have the same size and
+ * the common search space is searched for the C-RNTI, SI-RNTI and P-RNTI. The CRC remainder does not depend on the
+ * RNTI, so each (location, size) pair only needs to be decoded once per subframe.
+ */
+static srslte_pdcch_candidate_t*
+pdcch_candidate_find(srslte_pdcch_t* q, srslte_dci_location_t* location, uint32_t nof_bits)
+{
+  for (uint32_t i = 0; i < q->nof_candidates; i++) {
+    srslte_pdcch_candidate_t* c = &q->candidates[i];
+    if (c->nof_bits == nof_bits && c->location.ncce == location->ncce && c->location.L == location->L) {
+      return c;
+    }
+  }
+  return NULL;
+}
+
+static void
+pdcch_candidate_save(srslte_pdcch_t* q, srslte_dci_location_t* location, uint32_t nof_bits, srslte_dci_msg_t* msg)
+{
+  if (q->nof_candidates < SRSLTE_PDCCH_MAX_DECODED_CANDIDATES) {
+    srslte_pdcch_candidate_t* c = &q->candidates[q->nof_candidates++];
+    c->location                 = *location;
+    c->nof_bits                 = nof_bits;
+    c->crc_rem                  = msg->rnti;
+    memcpy(c->payload, msg->payload, (nof_bits + 16) * sizeof(uint8_t));
+  }
+}
+
+/** Returns the mean absolute LLR of the bits of a location, averaging the per-CCE values computed by
+ * srslte_pdcch_extract_llr(). Locations below the decoding threshold can be skipped by the caller for every format.
+ */
+float srslte_pdcch_location_energy(srslte_pdcch_t* q, const srslte_dci_location_t* location)
+{
+  uint32_t nof_cce = 1u << location->L;
+  if (location->ncce + nof_cce > q->max_bits / 72) {
+    return 0.0f;
+  }
+  return srslte_vec_acc_ff(&q->cce_energy[location->ncce], nof_cce) / nof_cce;
+}
+
 /** Tries to decode a DCI message from the LLRs stored in the srslte_pdcch_t structure by the function
  * srslte_pdcch_extract_llr(). This function can be called multiple times.
  * The location to search for is obtained from msg.
@@ -389,13 +457,19 @@ int srslte_pdcch_decode_msg(srslte_pdcch_t* q, srslte_dl_sf_cfg_t* sf, srslte_dc
       uint32_t nof_bits = srslte_dci_format_sizeof(&q->cell, sf, dci_cfg, msg->format);
       uint32_t e_bits   = PDCCH_FORMAT_NOF_BITS(msg->location.L);
 
-      double mean = 0;
-      for (int i = 0; i < e_bits; i++) {
-        mean += fabsf(q->llr[msg->location.ncce * 72 + i]);
-      }
-      mean /= e_bits;
-      if (mean > 0.3) {
-        ret = srslte_pdcch_dci_decode(q, &q->llr[msg->location.ncce * 72], msg->payload, e_bits, nof_bits, &msg->rnti);
+      float mean = srslte_pdcch_location_energy(q, &msg->location);
+      if (mean > SRSLTE_PDCCH_MIN_ENERGY) {
+        srslte_pdcch_candidate_t* c = pdcch_candidate_find(q, &msg->location, nof_bits);
+        if (c) {
+          memcpy(msg->payload, c->payload, (nof_bits + 16) * sizeof(uint8_t));
+          msg->rnti = c->crc_rem;
+        } else {
+          ret = srslte_pdcch_dci_decode(
+              q, &q->llr[msg->location.ncce * 72], msg->payload, e_bits, nof_bits, &msg->rnti);
+          if (ret == SRSLTE_SUCCESS) {
+            pdcch_candidate_save(q, &msg->location, nof_bits, msg);
+          }
+        }
         if (ret == SRSLTE_SUCCESS) {
           msg->nof_bits = nof_bits;
           // Check format differentiation
@@ -444,6 +518,8 @@ int srslte_pdcch_extract_llr(srslte_pdcch_t*        q,
     nof_symbols     = e_bits / 2;
     ret             = SRSLTE_ERROR;
     srslte_vec_f_zero(q->llr, q->max_bits);
+    srslte_vec_f_zero(q->cce_energy, q->max_bits / 72);
+    q->nof_candidates = 0;
 
     DEBUG("Extracting LLRs: E: %d, SF: %d, CFI: %d\n", e_bits, sf->tti % 10, sf->cfi);
 
@@ -488,6 +564,15 @@ int srslte_pdcch_extract_llr(srslte_pdcch_t*        q,
     /* descramble */
     srslte_scrambling_f_offset(&q->seq[sf->tti % 10], q->llr, 0, e_bits);
 
+    /* energy of every CCE, shared by all the candidates and formats of the blind search */
+    for (i = 0; i < NOF_CCE(sf->cfi); i++) {
+      float acc = 0;
+      for (uint32_t j = 0; j < 72; j++) {
+        acc += fabsf(q->llr[i * 72 + j]);
+      }
+      q->cce_energy[i] = acc / 72;
+    }
+
     ret = SRSLTE_SUCCESS;
   }
   return ret;
@@ -513,17 +598,19 @@ void srslte_pdcch_dci_encode_conv(srslte_pdcch_t* q,
                                   uint8_t*        coded_data,
                                   uint16_t        rnti)
 {
-  srslte_convcoder_t encoder;
-  int                poly[3] = {0x6D, 0x4F, 0x57};
-  encoder.K                  = 7;
-  encoder.R                  = 3;
-  encoder.tail_biting        = true;
-  memcpy(encoder.poly, poly, 3 * sizeof(int));
-
   srslte_crc_attach(&q->crc, data, nof_bits);
   crc_set_mask_rnti(&data[nof_bits], rnti);
 
-  srslte_convcoder_encode(&encoder, data, coded_data, nof_bits + 16);
+  /* Tail-biting convolutional encoder (K=7, R=1/3): the shift register starts with the last 6 bits */
+  uint32_t len = nof_bits + 16;
+  uint32_t sr  = 0;
+  for (uint32_t i = len - 6; i < len; i++) {
+    sr = (sr << 1) | (data[i] & 1);
+  }
+  for (uint32_t i = 0; i < len; i++) {
+    sr = ((sr << 1) | (data[i] & 1)) & 0x7f;
+    memcpy(&coded_data[3 * i], q->cc_table[sr], 3);
+  }
 }
 
 /** 36.212 5.3.3.2 to 5.3.3.4
@@ -542,7 +629,23 @@ int srslte_pdcch_dci_encode(srslte_pdcch_t* q, uint8_t* data, uint8_t* e, uint32
       srslte_vec_fprint_b(stdout, tmp, 3 * (nof_bits + 16));
     }
 
-    srslte_rm_conv_tx(tmp, 3 * (nof_bits + 16), e, E);
+    /* The circular buffer of the rate matching only depends on the DCI size */
+    uint32_t in_len = 3 * (nof_bits + 16);
+    if (q->rm_table[nof_bits] == NULL) {
+      q->rm_table[nof_bits] = srslte_vec_u16_malloc(in_len);
+      if (q->rm_table[nof_bits] == NULL) {
+        return SRSLTE_ERROR;
+      }
+      srslte_rm_conv_tx_table(in_len, q->rm_table[nof_bits]);
+    }
+
+    const uint16_t* table = q->rm_table[nof_bits];
+    for (uint32_t k = 0, j = 0; k < E; k++) {
+      e[k] = tmp[table[j]];
+      if (++j == in_len) {
+        j = 0;
+      }
+    }
 
     return SRSLTE_SUCCESS;
   } else {
@@ -633,3 +736,92 @@ int srslte_pdcch_encode(srslte_pdcch_t*     q,
   }
   return ret;
 }
+
+/** Encodes all the DCI messages of a subframe. Every message is CRC attached, convolutionally encoded and
+ * rate matched on its own, then the CCE span covering all of them is scrambled, layer mapped, precoded and
+ * mapped to the resource elements in a single pass. The CCEs of the span not used by any message are
+ * transmitted as zeros.
+ */
+int srslte_pdcch_encode_batch(srslte_pdcch_t*     q,
+                              srslte_dl_sf_cfg_t* sf,
+                              srslte_dci_msg_t    msgs[],
+                              uint32_t            nof_msgs,
+                              cf_t*               sf_symbols[SRSLTE_MAX_PORTS])
+{
+  cf_t* x[SRSLTE_MAX_LAYERS];
+
+  if (q == NULL || sf == NULL || sf_symbols == NULL || (msgs == NULL && nof_msgs > 0) || sf->cfi < 1 ||
+      sf->cfi > 3) {
+    ERROR("Invalid parameters\n");
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  /* CCE span of the subframe */
+  uint32_t cce_begin = NOF_CCE(sf->cfi);
+  uint32_t cce_end   = 0;
+  for (uint32_t m = 0; m < nof_msgs; m++) {
+    srslte_dci_location_t* loc = &msgs[m].location;
+    if (!srslte_dci_location_isvalid(loc) || loc->ncce + PDCCH_FORMAT_NOF_CCE(loc->L) > NOF_CCE(sf->cfi) ||
+        msgs[m].nof_bits >= SRSLTE_DCI_MAX_BITS - 16) {
+      ERROR("Illegal DCI message nCCE: %d, L: %d, nof_cce: %d, nof_bits=%d\n",
+            loc->ncce,
+            loc->L,
+            NOF_CCE(sf->cfi),
+            msgs[m].nof_bits);
+      return SRSLTE_ERROR;
+    }
+    cce_begin = SRSLTE_MIN(cce_begin, loc->ncce);
+    cce_end   = SRSLTE_MAX(cce_end, loc->ncce + PDCCH_FORMAT_NOF_CCE(loc->L));
+  }
+  if (cce_end <= cce_begin) {
+    return SRSLTE_SUCCESS;
+  }
+
+  uint8_t* e           = &q->e[72 * cce_begin];
+  uint32_t nof_bits    = 72 * (cce_end - cce_begin);
+  uint32_t nof_symbols = nof_bits / 2;
+
+  /* Channel coding of every message into its CCEs */
+  for (uint32_t m = 0; m < nof_msgs; m++) {
+    uint32_t e_bits = PDCCH_FORMAT_NOF_BITS(msgs[m].location.L);
+    DEBUG("Encoding DCI: Nbits: %d, E: %d, nCCE: %d, L: %d, RNTI: 0x%x\n",
+          msgs[m].nof_bits,
+          e_bits,
+          msgs[m].location.ncce,
+          msgs[m].location.L,
+          msgs[m].rnti);
+    if (srslte_pdcch_dci_encode(
+            q, msgs[m].payload, &q->e[72 * msgs[m].location.ncce], msgs[m].nof_bits, e_bits, msgs[m].rnti)) {
+      return SRSLTE_ERROR;
+    }
+  }
+
+  srslte_scrambling_b_offset(&q->seq[sf->tti % 10], e, 72 * cce_begin, nof_bits);
+
+  /* Only the CCEs with a message are modulated, the rest of the span stays at zero */
+  srslte_vec_cf_zero(q->d, nof_symbols);
+  for (uint32_t m = 0; m < nof_msgs; m++) {
+    uint32_t offset = 72 * (msgs[m].location.ncce - cce_begin);
+    srslte_mod_modulate(&q->mod, &e[offset], &q->d[offset / 2], PDCCH_FORMAT_NOF_BITS(msgs[m].location.L));
+  }
+
+  /* layer mapping & precoding, a CCE is a whole number of precoding blocks */
+  for (uint32_t i = 0; i < q->cell.nof_ports; i++) {
+    x[i] = q->x[i];
+  }
+  memset(&x[q->cell.nof_ports], 0, sizeof(cf_t*) * (SRSLTE_MAX_LAYERS - q->cell.nof_ports));
+  if (q->cell.nof_ports > 1) {
+    srslte_layermap_diversity(q->d, x, q->cell.nof_ports, nof_symbols);
+    srslte_precoding_diversity(x, q->symbols, q->cell.nof_ports, nof_symbols / q->cell.nof_ports, 1.0f);
+  } else {
+    memcpy(q->symbols[0], q->d, nof_symbols * sizeof(cf_t));
+  }
+
+  /* mapping to resource elements */
+  for (uint32_t i = 0; i < q->cell.nof_ports; i++) {
+    srslte_regs_pdcch_put_offset(
+        q->regs, sf->cfi, q->symbols[i], sf_symbols[i], cce_begin * 9, (cce_end - cce_begin) * 9);
+  }
+
+  return SRSLTE_SUCCESS;
+}
@@ -40,6 +40,9 @@
 
 #define MAX_PDSCH_RE(cp) (2 * SRSLTE_CP_NSYMB(cp) * 12)
 
+/* Maximum number of RBG, the PRB groups the IRC covariance is estimated for */
+#define PDSCH_IRC_MAX_RBG ((SRSLTE_MAX_PRB + 3) / 4)
+
 /* 3GPP 36.213 Table 5.2-1: The cell-specific ratio rho_B / rho_A for 1, 2, or 4 cell specific antenna ports */
 const static float pdsch_cfg_cell_specific_ratio_table[2][4] = {
     /* One antenna port         */ {1.0f / 1.0f, 4.0f / 5.0f, 3.0f / 5.0f, 2.0f / 5.0f},
@@ -133,8 +136,10 @@ static inline uint32_t pdsch_cp_crs_offset(const srslte_cell_t* cell, uint32_t l
   return cell->id % 3;
 }
 
+/* When input_c16 is given the grid is read from it instead of input, widening one OFDM symbol at a time */
 static int srslte_pdsch_cp(const srslte_pdsch_t*       q,
                            cf_t*                       input,
+                           const srslte_grid_c16_t*    input_c16,
                            cf_t*                       output,
                            const srslte_pdsch_grant_t* grant,
                            uint32_t                    lstart_grant,
@@ -158,54 +163,78 @@ static int srslte_pdsch_cp(const srslte_pdsch_t*       q,
       // Grid symbol
       uint32_t lp = l + s * grant->nof_symb_slot[0];
 
-      // Iterate over PRB
-      for (uint32_t n = 0; n < q->cell.nof_prb; n++) {
+      // Grid row of the symbol
+      cf_t* in_row = NULL;
+      if (!put) {
+        if (input_c16 != NULL) {
+          srslte_grid_c16_load_symbol(input_c16, lp, q->symbol_c16);
+          in_row = q->symbol_c16;
+        } else {
+          in_row = &input[lp * q->cell.nof_prb * SRSLTE_NRE];
+        }
+      }
 
+      // Iterate over PRB
+      uint32_t n = 0;
+      while (n < q->cell.nof_prb) {
         // If this PRB is assigned
-        if (grant->prb_idx[s][n]) {
-          bool skip = pdsch_cp_skip_symbol(&q->cell, grant, sf_idx, s, l, n);
+        if (!grant->prb_idx[s][n]) {
+          n++;
+          continue;
+        }
 
-          // Get grid pointer
-          if (put) {
-            out_ptr = &output[(lp * q->cell.nof_prb + n) * SRSLTE_NRE];
+        bool skip = pdsch_cp_skip_symbol(&q->cell, grant, sf_idx, s, l, n);
+
+        // Get grid pointer
+        if (put) {
+          out_ptr = &output[(lp * q->cell.nof_prb + n) * SRSLTE_NRE];
+        } else {
+          in_ptr = &in_row[n * SRSLTE_NRE];
+        }
+
+        // This is a symbol in a normal PRB with or without references, copy all the following ones at once
+        if (!skip) {
+          uint32_t nof_run = 1;
+          while (n + nof_run < q->cell.nof_prb && grant->prb_idx[s][n + nof_run] &&
+                 !pdsch_cp_skip_symbol(&q->cell, grant, sf_idx, s, l, n + nof_run)) {
+            nof_run++;
+          }
+          if (has_crs) {
+            prb_cp_ref_run(&in_ptr, &out_ptr, crs_offset, nof_refs, nof_run, put);
           } else {
-            in_ptr = &input[(lp * q->cell.nof_prb + n) * SRSLTE_NRE];
+            prb_cp(&in_ptr, &out_ptr, nof_run);
           }
+          n += nof_run;
+          continue;
+        }
 
-          // This is a symbol in a normal PRB with or without references
-          if (!skip) {
+        if (q->cell.nof_prb % 2 != 0) {
+          // This is a symbol in a PRB with PBCH or Synch signals (SS).
+          // If the number or total PRB is odd, half of the the PBCH or SS will fall into the symbol
+          if (n == q->cell.nof_prb / 2 - 3) {
+            // Lower sync block half RB
             if (has_crs) {
-              prb_cp_ref(&in_ptr, &out_ptr, crs_offset, nof_refs, nof_refs, put);
+              prb_cp_ref(&in_ptr, &out_ptr, crs_offset, nof_refs, nof_refs / 2, put);
             } else {
-              prb_cp(&in_ptr, &out_ptr, 1);
+              prb_cp_half(&in_ptr, &out_ptr, 1);
             }
-          } else if (q->cell.nof_prb % 2 != 0) {
-            // This is a symbol in a PRB with PBCH or Synch signals (SS).
-            // If the number or total PRB is odd, half of the the PBCH or SS will fall into the symbol
-            if (n == q->cell.nof_prb / 2 - 3) {
-              // Lower sync block half RB
-              if (has_crs) {
-                prb_cp_ref(&in_ptr, &out_ptr, crs_offset, nof_refs, nof_refs / 2, put);
-              } else {
-                prb_cp_half(&in_ptr, &out_ptr, 1);
-              }
-            } else if (n == q->cell.nof_prb / 2 + 3) {
-              // Upper sync block half RB
-              // Skip half RB on the grid
-              if (put) {
-                out_ptr += SRSLTE_NRE / 2;
-              } else {
-                in_ptr += SRSLTE_NRE / 2;
-              }
-
-              if (has_crs) {
-                prb_cp_ref(&in_ptr, &out_ptr, crs_offset, nof_refs, nof_refs / 2, put);
-              } else {
-                prb_cp_half(&in_ptr, &out_ptr, 1);
-              }
+          } else if (n == q->cell.nof_prb / 2 + 3) {
+            // Upper sync block half RB
+            // Skip half RB on the grid
+            if (put) {
+              out_ptr += SRSLTE_NRE / 2;
+            } else {
+              in_ptr += SRSLTE_NRE / 2;
+            }
+
+            if (has_crs) {
+              prb_cp_ref(&in_ptr, &out_ptr, crs_offset, nof_refs, nof_refs / 2, put);
+            } else {
+              prb_cp_half(&in_ptr, &out_ptr, 1);
             }
           }
         }
+        n++;
       }
     }
   }
@@ -234,7 +263,7 @@ int srslte_pdsch_put(srslte_pdsch_t*       q,
                      uint32_t              lstart,
                      uint32_t              subframe)
 {
-  return srslte_pdsch_cp(q, symbols, sf_symbols, grant, lstart, subframe, true);
+  return srslte_pdsch_cp(q, symbols, NULL, sf_symbols, grant, lstart, subframe, true);
 }
 
 /**
@@ -251,7 +280,115 @@ int srslte_pdsch_get(srslte_pdsch_t*       q,
                      uint32_t              lstart,
                      uint32_t              subframe)
 {
-  return srslte_pdsch_cp(q, sf_symbols, symbols, grant, lstart, subframe, false);
+  return srslte_pdsch_cp(q, sf_symbols, NULL, symbols, grant, lstart, subframe, false);
+}
+
+/* Equalises nof_re extracted RE from re onwards with the interference plus noise covariance R */
+static int
+pdsch_irc_run(srslte_pdsch_t* q, const cf_t* R, cf_t* x, float* csi, uint32_t re, uint32_t nof_re, float scaling)
+{
+  if (nof_re == 0) {
+    return SRSLTE_SUCCESS;
+  }
+
+  cf_t* y[SRSLTE_MAX_PORTS] = {};
+  cf_t* h[SRSLTE_MAX_PORTS] = {};
+  for (uint32_t j = 0; j < q->nof_rx_antennas; j++) {
+    y[j] = &q->symbols[j][re];
+    h[j] = &q->ce[0][j][re];
+  }
+  if (srslte_predecoding_single_irc(y, h, R, &x[re], csi ? &csi[re] : NULL, q->nof_rx_antennas, nof_re, scaling) < 0) {
+    return SRSLTE_ERROR;
+  }
+  return SRSLTE_SUCCESS;
+}
+
+/* Interference Rejection Combining of a single layer. The interference plus noise covariance of every RBG is estimated
+ * from the port 0 CRS residuals of its PRB, then the RE of the grant are equalised with the covariance of their RBG.
+ * The grant is walked in the same order as srslte_pdsch_cp() extracts it, so every run of RE of the same RBG is
+ * contiguous in q->symbols and q->ce.
+ */
+static int pdsch_predecoding_irc(srslte_pdsch_t*        q,
+                                 srslte_pdsch_cfg_t*    cfg,
+                                 srslte_chest_dl_res_t* channel,
+                                 uint32_t               lstart_grant,
+                                 uint32_t               sf_idx,
+                                 cf_t*                  x,
+                                 float*                 csi,
+                                 float                  scaling)
+{
+  const srslte_pdsch_grant_t* grant    = &cfg->grant;
+  uint32_t                    nof_rx   = q->nof_rx_antennas;
+  uint32_t                    P        = srslte_ra_type0_P(q->cell.nof_prb);
+  uint32_t                    nof_rbg  = (q->cell.nof_prb + P - 1) / P;
+  uint32_t                    nref     = 2 * q->cell.nof_prb;
+  uint32_t                    nsymb    = channel->nof_crs_residual / nref;
+  uint32_t                    nof_refs = (q->cell.nof_ports == 1) ? 2 : 4;
+  cf_t                        R[PDSCH_IRC_MAX_RBG][SRSLTE_MAX_PORTS * SRSLTE_MAX_PORTS];
+
+  if (nsymb == 0 || nof_rbg > PDSCH_IRC_MAX_RBG) {
+    return SRSLTE_ERROR;
+  }
+
+  // Covariance of every RBG, averaged over the reference symbols
+  for (uint32_t g = 0; g < nof_rbg; g++) {
+    uint32_t prb0 = g * P;
+    uint32_t nprb = SRSLTE_MIN(P, q->cell.nof_prb - prb0);
+    srslte_vec_cf_zero(R[g], nof_rx * nof_rx);
+    for (uint32_t l = 0; l < nsymb; l++) {
+      cf_t* n[SRSLTE_MAX_PORTS] = {};
+      cf_t  R_l[SRSLTE_MAX_PORTS * SRSLTE_MAX_PORTS];
+      for (uint32_t j = 0; j < nof_rx; j++) {
+        n[j] = &channel->crs_residual[j][l * nref + 2 * prb0];
+      }
+      if (srslte_predecoding_irc_covariance(n, nof_rx, 2 * nprb, R_l)) {
+        return SRSLTE_ERROR;
+      }
+      for (uint32_t k = 0; k < nof_rx * nof_rx; k++) {
+        R[g][k] += R_l[k] / nsymb;
+      }
+    }
+  }
+
+  uint32_t re      = 0;
+  uint32_t run_re  = 0;
+  uint32_t run_rbg = 0;
+  for (uint32_t s = 0; s < SRSLTE_NOF_SLOTS_PER_SF; s++) {
+    uint32_t lstart = (s == 0) ? lstart_grant : 0;
+    for (uint32_t l = lstart; l < grant->nof_symb_slot[s]; l++) {
+      bool has_crs = SRSLTE_SYMBOL_HAS_REF(l, q->cell.cp, q->cell.nof_ports);
+      for (uint32_t n = 0; n < q->cell.nof_prb; n++) {
+        if (!grant->prb_idx[s][n]) {
+          continue;
+        }
+
+        // RE that srslte_pdsch_cp() takes from this PRB
+        uint32_t nof_re_prb = 0;
+        if (!pdsch_cp_skip_symbol(&q->cell, grant, sf_idx, s, l, n)) {
+          nof_re_prb = SRSLTE_NRE - (has_crs ? nof_refs : 0);
+        } else if (q->cell.nof_prb % 2 != 0 && (n == q->cell.nof_prb / 2 - 3 || n == q->cell.nof_prb / 2 + 3)) {
+          nof_re_prb = SRSLTE_NRE / 2 - (has_crs ? nof_refs / 2 : 0);
+        }
+
+        // Equalise the previous run when the RBG changes
+        if (n / P != run_rbg && re > run_re) {
+          if (pdsch_irc_run(q, R[run_rbg], x, csi, run_re, re - run_re, scaling)) {
+            return SRSLTE_ERROR;
+          }
+          run_re = re;
+        }
+        run_rbg = n / P;
+        re += nof_re_prb;
+      }
+    }
+  }
+
+  if (re != grant->nof_re) {
+    ERROR("Error IRC expected %d RE but the grant has %d\n", re, grant->nof_re);
+    return SRSLTE_ERROR;
+  }
+
+  return pdsch_irc_run(q, R[run_rbg], x, csi, run_re, re - run_re, scaling);
 }
 
 /** Initializes the PDSCH transmitter and receiver */
@@ -323,6 +460,13 @@ static int pdsch_init(srslte_pdsch_t* q, uint32_t max_prb, bool is_ue, uint32_t
       }
     }
 
+    if (q->is_ue) {
+      q->symbol_c16 = srslte_vec_cf_malloc(SRSLTE_NRE * max_prb);
+      if (!q->symbol_c16) {
+        goto clean;
+      }
+    }
+
     q->users = calloc(sizeof(srslte_pdsch_user_t*), q->is_ue ? 1 : (1 + SRSLTE_SIRNTI));
     if (!q->users) {
       ERROR("malloc");
@@ -462,6 +606,9 @@ void srslte_pdsch_free(srslte_pdsch_t* q)
       }
     }
   }
+  if (q->symbol_c16) {
+    free(q->symbol_c16);
+  }
   if (q->users) {
     if (q->is_ue) {
       srslte_pdsch_free_rnti(q, 0);
@@ -510,50 +657,35 @@ int srslte_pdsch_set_cell(srslte_pdsch_t* q, srslte_cell_t cell)
   return ret;
 }
 
-/* Precalculate the PDSCH scramble sequences for a given RNTI. This function takes a while
- * to execute, so shall be called once the final C-RNTI has been allocated for the session.
+static void pdsch_user_reset(srslte_pdsch_user_t* user, uint32_t cell_id)
+{
+  for (int sf_idx = 0; sf_idx < SRSLTE_NOF_SF_X_FRAME; sf_idx++) {
+    for (int j = 0; j < SRSLTE_MAX_CODEWORDS; j++) {
+      user->seq[j][sf_idx].cur_len = 0;
+    }
+  }
+  user->cell_id = cell_id;
+}
+
+/* Registers an RNTI. The scrambling sequences are only generated once the RNTI is scheduled, see get_user_sequence(),
+ * so the RNTIs that are never scheduled in a subframe take no memory for it.
  */
 int srslte_pdsch_set_rnti(srslte_pdsch_t* q, uint16_t rnti)
 {
   uint32_t rnti_idx = q->is_ue ? 0 : rnti;
 
-  // Decide whether re-generating the sequence
   if (!q->users[rnti_idx]) {
-    // If the sequence is not allocated generate
     q->users[rnti_idx] = calloc(1, sizeof(srslte_pdsch_user_t));
     if (!q->users[rnti_idx]) {
       ERROR("Alocating PDSCH user\n");
       return SRSLTE_ERROR;
     }
-  } else if (q->users[rnti_idx]->sequence_generated && q->users[rnti_idx]->cell_id == q->cell.id && !q->is_ue) {
-    // The sequence was generated, cell has not changed and it is eNb, save any efforts
-    return SRSLTE_SUCCESS;
+  } else if ((q->is_ue && q->ue_rnti != rnti) || q->users[rnti_idx]->cell_id != q->cell.id) {
+    // The buffers of the sequences of the previous C-RNTI or cell are kept, the sequences are generated again
+    pdsch_user_reset(q->users[rnti_idx], q->cell.id);
   }
-
-  // Set sequence as not generated
-  q->users[rnti_idx]->sequence_generated = false;
-
-  // For each subframe
-  for (int sf_idx = 0; sf_idx < SRSLTE_NOF_SF_X_FRAME; sf_idx++) {
-    // For each codeword
-    for (int j = 0; j < SRSLTE_MAX_CODEWORDS; j++) {
-      if (srslte_sequence_pdsch(&q->users[rnti_idx]->seq[j][sf_idx],
-                                rnti,
-                                j,
-                                SRSLTE_NOF_SLOTS_PER_SF * sf_idx,
-                                q->cell.id,
-                                q->max_re * srslte_mod_bits_x_symbol(SRSLTE_MOD_256QAM))) {
-        ERROR("Error initializing PDSCH scrambling sequence\n");
-        srslte_pdsch_free_rnti(q, rnti);
-        return SRSLTE_ERROR;
-      }
-    }
-  }
-
-  // Save generation states
-  q->ue_rnti                             = rnti;
-  q->users[rnti_idx]->cell_id            = q->cell.id;
-  q->users[rnti_idx]->sequence_generated = true;
+  q->users[rnti_idx]->cell_id = q->cell.id;
+  q->ue_rnti                  = rnti;
 
   return SRSLTE_SUCCESS;
 }
@@ -572,37 +704,51 @@ void srslte_pdsch_free_rnti(srslte_pdsch_t* q, uint16_t rnti)
     q->ue_rnti         = 0;
   }
 }
-static float apply_power_allocation(srslte_pdsch_t* q, srslte_pdsch_cfg_t* cfg, cf_t* sf_symbols_m[SRSLTE_MAX_PORTS])
+static float get_rho_b(const srslte_pdsch_t* q, const srslte_pdsch_cfg_t* cfg)
 {
+  uint32_t idx0                = (q->cell.nof_ports == 1) ? 0 : 1;
+  float    cell_specific_ratio = pdsch_cfg_cell_specific_ratio_table[idx0][cfg->p_b];
+  return sqrtf(cell_specific_ratio);
+}
 
+static void scale_symbol(srslte_pdsch_t* q, cf_t* sf_symbols, srslte_grid_c16_t* sf_symbols_c16, uint32_t l, float gain)
+{
+  if (sf_symbols_c16 != NULL) {
+    srslte_grid_c16_scale_symbol(sf_symbols_c16, l, gain);
+  } else {
+    uint32_t nof_re_symbol = SRSLTE_NRE * q->cell.nof_prb;
+    cf_t*    ptr           = sf_symbols + nof_re_symbol * l;
+    srslte_vec_sc_prod_cfc(ptr, gain, ptr, nof_re_symbol);
+  }
+}
+
+/* Scales the int16 grids of sf_symbols_c16 instead of sf_symbols_m when they are given */
+static float apply_power_allocation(srslte_pdsch_t*     q,
+                                    srslte_pdsch_cfg_t* cfg,
+                                    cf_t*               sf_symbols_m[SRSLTE_MAX_PORTS],
+                                    srslte_grid_c16_t*  sf_symbols_c16)
+{
   uint32_t nof_symbols_slot = cfg->grant.nof_symb_slot[0];
-  uint32_t nof_re_symbol    = SRSLTE_NRE * q->cell.nof_prb;
 
   /* Set power allocation according to 3GPP 36.213 clause 5.2 Downlink power allocation */
   float rho_a = srslte_convert_dB_to_amplitude(cfg->p_a) * ((q->cell.nof_ports == 1) ? 1.0f : M_SQRT2);
-
-  uint32_t idx0                = (q->cell.nof_ports == 1) ? 0 : 1;
-  float    cell_specific_ratio = pdsch_cfg_cell_specific_ratio_table[idx0][cfg->p_b];
-  float    rho_b               = sqrtf(cell_specific_ratio);
+  float rho_b = get_rho_b(q, cfg);
 
   /* Apply rho_b if required according to 3GPP 36.213 Table 5.2-2 */
   if (rho_b != 0.0f && rho_b != 1.0f) {
     float scaling = 1.0f / rho_b;
     for (uint32_t i = 0; i < q->nof_rx_antennas; i++) {
+      cf_t*              sf_symbols = sf_symbols_c16 ? NULL : sf_symbols_m[i];
+      srslte_grid_c16_t* grid_c16   = sf_symbols_c16 ? &sf_symbols_c16[i] : NULL;
       for (uint32_t j = 0; j < 2; j++) {
-        cf_t* ptr;
-        ptr = sf_symbols_m[i] + nof_re_symbol * (j * nof_symbols_slot + 0);
-        srslte_vec_sc_prod_cfc(ptr, scaling, ptr, nof_re_symbol);
+        scale_symbol(q, sf_symbols, grid_c16, j * nof_symbols_slot + 0, scaling);
         if (q->cell.cp == SRSLTE_CP_NORM) {
-          ptr = sf_symbols_m[i] + nof_re_symbol * (j * nof_symbols_slot + 4);
-          srslte_vec_sc_prod_cfc(ptr, scaling, ptr, nof_re_symbol);
+          scale_symbol(q, sf_symbols, grid_c16, j * nof_symbols_slot + 4, scaling);
         } else {
-          ptr = sf_symbols_m[i] + nof_re_symbol * (j * nof_symbols_slot + 3);
-          srslte_vec_sc_prod_cfc(ptr, scaling, ptr, nof_re_symbol);
+          scale_symbol(q, sf_symbols, grid_c16, j * nof_symbols_slot + 3, scaling);
         }
         if (q->cell.nof_ports == 4) {
-          ptr = sf_symbols_m[i] + nof_re_symbol * (j * nof_symbols_slot + 1);
-          srslte_vec_sc_prod_cfc(ptr, scaling, ptr, nof_re_symbol);
+          scale_symbol(q, sf_symbols, grid_c16, j * nof_symbols_slot + 1, scaling);
         }
       }
     }
@@ -610,19 +756,36 @@ static float apply_power_allocation(srslte_pdsch_t* q, srslte_pdsch_cfg_t* cfg,
   return rho_a;
 }
 
+bool srslte_pdsch_encode_is_grant_local(const srslte_pdsch_t* q, const srslte_pdsch_cfg_t* cfg)
+{
+  float rho_b = get_rho_b(q, cfg);
+  return rho_b == 0.0f || rho_b == 1.0f;
+}
+
 static srslte_sequence_t*
 get_user_sequence(srslte_pdsch_t* q, uint16_t rnti, uint32_t codeword_idx, uint32_t sf_idx, uint32_t len)
 {
-  uint32_t rnti_idx = q->is_ue ? 0 : rnti;
+  uint32_t             rnti_idx = q->is_ue ? 0 : rnti;
+  srslte_pdsch_user_t* user     = q->users[rnti_idx];
 
-  // The scrambling sequence is pregenerated for all RNTIs in the eNodeB but only for C-RNTI in the UE
-  if (q->users[rnti_idx] && q->users[rnti_idx]->sequence_generated && q->users[rnti_idx]->cell_id == q->cell.id &&
-      (!q->is_ue || q->ue_rnti == rnti)) {
-    return &q->users[rnti_idx]->seq[codeword_idx][sf_idx];
-  } else {
-    srslte_sequence_pdsch(&q->tmp_seq, rnti, codeword_idx, 2 * sf_idx, q->cell.id, len);
-    return &q->tmp_seq;
+  // The scrambling sequence is kept for all the registered RNTIs in the eNodeB but only for C-RNTI in the UE
+  if (user && (!q->is_ue || q->ue_rnti == rnti)) {
+    if (user->cell_id != q->cell.id) {
+      pdsch_user_reset(user, q->cell.id);
+    }
+    srslte_sequence_t* seq = &user->seq[codeword_idx][sf_idx];
+    if (seq->cur_len >= len) {
+      return seq;
+    }
+    // The first len bits don't depend on the length of the sequence, so it is only generated again for larger TBs
+    if (srslte_sequence_pdsch(seq, rnti, codeword_idx, SRSLTE_NOF_SLOTS_PER_SF * sf_idx, q->cell.id, len) ==
+        SRSLTE_SUCCESS) {
+      return seq;
+    }
+    seq->cur_len = 0;
   }
+  srslte_sequence_pdsch(&q->tmp_seq, rnti, codeword_idx, 2 * sf_idx, q->cell.id, len);
+  return &q->tmp_seq;
 }
 
 static void csi_correction(srslte_pdsch_t* q, srslte_pdsch_cfg_t* cfg, uint32_t codeword_idx, uint32_t tb_idx, void* e)
@@ -809,48 +972,54 @@ static int srslte_pdsch_codeword_decode(srslte_pdsch_t*     q,
          cfg->grant.tb[tb_idx].nof_bits,
          rv);
 
+    /* Select scrambling sequence */
+    srslte_sequence_t* seq =
+        get_user_sequence(q, cfg->rnti, codeword_idx, sf->tti % 10, cfg->grant.tb[tb_idx].nof_bits);
+    if (!seq) {
+      ERROR("Error getting user sequence for rnti=0x%x\n", cfg->rnti);
+      return -1;
+    }
+
     /* demodulate symbols
      * The MAX-log-MAP algorithm used in turbo decoding is unsensitive to SNR estimation,
      * thus we don't need tot set it in the LLRs normalization
      */
-    if (q->llr_is_8bit) {
-      srslte_demod_soft_demodulate_b(mcs->mod, q->d[codeword_idx], q->e[codeword_idx], cfg->grant.nof_re);
-    } else {
-      srslte_demod_soft_demodulate_s(mcs->mod, q->d[codeword_idx], q->e[codeword_idx], cfg->grant.nof_re);
-    }
     if (cfg->meas_evm_en && q->evm_buffer[codeword_idx]) {
+      /* The EVM is measured before descrambling, so demodulation and descrambling are done separately */
       if (q->llr_is_8bit) {
+        srslte_demod_soft_demodulate_b(mcs->mod, q->d[codeword_idx], q->e[codeword_idx], cfg->grant.nof_re);
         data[tb_idx].evm = srslte_evm_run_b(q->evm_buffer[codeword_idx],
                                             &q->mod[mcs->mod],
                                             q->d[codeword_idx],
                                             q->e[codeword_idx],
                                             cfg->grant.tb[tb_idx].nof_bits);
+        srslte_scrambling_sb_offset(seq, q->e[codeword_idx], 0, cfg->grant.tb[tb_idx].nof_bits);
       } else {
+        srslte_demod_soft_demodulate_s(mcs->mod, q->d[codeword_idx], q->e[codeword_idx], cfg->grant.nof_re);
         data[tb_idx].evm = srslte_evm_run_s(q->evm_buffer[codeword_idx],
                                             &q->mod[mcs->mod],
                                             q->d[codeword_idx],
                                             q->e[codeword_idx],
                                             cfg->grant.tb[tb_idx].nof_bits);
+        srslte_scrambling_s_offset(seq, q->e[codeword_idx], 0, cfg->grant.tb[tb_idx].nof_bits);
       }
     } else {
+      /* Demodulation and bit descrambling in a single pass */
+      int demod_ret;
+      if (q->llr_is_8bit) {
+        demod_ret = srslte_demod_soft_demodulate_b_scrambled(
+            mcs->mod, q->d[codeword_idx], q->e[codeword_idx], cfg->grant.nof_re, seq);
+      } else {
+        demod_ret = srslte_demod_soft_demodulate_s_scrambled(
+            mcs->mod, q->d[codeword_idx], q->e[codeword_idx], cfg->grant.nof_re, seq);
+      }
+      if (demod_ret) {
+        ERROR("Error demodulating PDSCH\n");
+        return -1;
+      }
       data[tb_idx].evm = NAN;
     }
 
-    /* Select scrambling sequence */
-    srslte_sequence_t* seq =
-        get_user_sequence(q, cfg->rnti, codeword_idx, sf->tti % 10, cfg->grant.tb[tb_idx].nof_bits);
-    if (!seq) {
-      ERROR("Error getting user sequence for rnti=0x%x\n", cfg->rnti);
-      return -1;
-    }
-
-    /* Bit scrambling */
-    if (q->llr_is_8bit) {
-      srslte_scrambling_sb_offset(seq, q->e[codeword_idx], 0, cfg->grant.tb[tb_idx].nof_bits);
-    } else {
-      srslte_scrambling_s_offset(seq, q->e[codeword_idx], 0, cfg->grant.tb[tb_idx].nof_bits);
-    }
-
     if (cfg->csi_enable) {
       csi_correction(q, cfg, codeword_idx, tb_idx, q->e[codeword_idx]);
     }
@@ -902,13 +1071,14 @@ static void* srslte_pdsch_decode_thread(void* arg)
   return q;
 }
 
-/** Decodes the PDSCH from the received symbols
- */
-int srslte_pdsch_decode(srslte_pdsch_t*        q,
+/* Decodes the PDSCH from either the cf_t grids and estimates or their int16 copies, whichever is not NULL */
+static int pdsch_decode(srslte_pdsch_t*        q,
                         srslte_dl_sf_cfg_t*    sf,
                         srslte_pdsch_cfg_t*    cfg,
                         srslte_chest_dl_res_t* channel,
                         cf_t*                  sf_symbols[SRSLTE_MAX_PORTS],
+                        srslte_grid_c16_t*     sf_symbols_c16,
+                        srslte_grid_c16_t (*ce_c16)[SRSLTE_MAX_PORTS],
                         srslte_pdsch_res_t     data[SRSLTE_MAX_CODEWORDS])
 {
 
@@ -916,7 +1086,8 @@ int srslte_pdsch_decode(srslte_pdsch_t*        q,
   uint32_t i;
   cf_t**   x;
 
-  if (q != NULL && sf_symbols != NULL && data != NULL && cfg != NULL) {
+  if (q != NULL && (sf_symbols != NULL || (sf_symbols_c16 != NULL && ce_c16 != NULL)) && data != NULL &&
+      cfg != NULL) {
 
     struct timeval t[3];
     if (cfg->meas_time_en) {
@@ -927,7 +1098,7 @@ int srslte_pdsch_decode(srslte_pdsch_t*        q,
 
     float pdsch_scaling = 1.0f;
     if (cfg->power_scale) {
-      float rho_a = apply_power_allocation(q, cfg, sf_symbols);
+      float rho_a = apply_power_allocation(q, cfg, sf_symbols, sf_symbols_c16);
       if (rho_a != 0.0f && isnormal(rho_a)) {
         pdsch_scaling = rho_a;
       }
@@ -950,15 +1121,19 @@ int srslte_pdsch_decode(srslte_pdsch_t*        q,
 
     // Extract Symbols and Channel Estimates
     uint32_t lstart = SRSLTE_NOF_CTRL_SYMBOLS(q->cell, sf->cfi);
+    uint32_t sf_idx = sf->tti % 10;
     for (int j = 0; j < q->nof_rx_antennas; j++) {
-      int n = srslte_pdsch_get(q, sf_symbols[j], q->symbols[j], &cfg->grant, lstart, sf->tti % 10);
+      int n = (sf_symbols_c16 != NULL)
+                  ? srslte_pdsch_cp(q, NULL, &sf_symbols_c16[j], q->symbols[j], &cfg->grant, lstart, sf_idx, false)
+                  : srslte_pdsch_get(q, sf_symbols[j], q->symbols[j], &cfg->grant, lstart, sf_idx);
       if (n != cfg->grant.nof_re) {
         ERROR("Error expecting %d symbols but got %d\n", cfg->grant.nof_re, n);
         return SRSLTE_ERROR;
       }
 
       for (i = 0; i < q->cell.nof_ports; i++) {
-        n = srslte_pdsch_get(q, channel->ce[i][j], q->ce[i][j], &cfg->grant, lstart, sf->tti % 10);
+        n = (ce_c16 != NULL) ? srslte_pdsch_cp(q, NULL, &ce_c16[i][j], q->ce[i][j], &cfg->grant, lstart, sf_idx, false)
+                             : srslte_pdsch_get(q, channel->ce[i][j], q->ce[i][j], &cfg->grant, lstart, sf_idx);
         if (n != cfg->grant.nof_re) {
           ERROR("Error expecting %d symbols but got %d\n", cfg->grant.nof_re, n);
           return SRSLTE_ERROR;
@@ -984,9 +1159,15 @@ int srslte_pdsch_decode(srslte_pdsch_t*        q,
       x = q->x;
     }
 
-    // Pre-decoder
+    // Pre-decoder, a single layer received by several antennas can use IRC when the CRS residuals are available
     uint32_t codebook_idx = nof_tb == 1 ? cfg->grant.pmi : (cfg->grant.pmi + 1);
-    if (srslte_predecoding_type(q->symbols,
+    bool     irc          = cfg->irc_enable && cfg->grant.tx_scheme == SRSLTE_TXSCHEME_PORT0 && q->nof_rx_antennas > 1 &&
+                 channel->nof_crs_residual > 0;
+    if (irc && pdsch_predecoding_irc(q, cfg, channel, lstart, sf_idx, x[0], q->csi[0], pdsch_scaling)) {
+      INFO("PDSCH IRC failed, using the default equalizer\n");
+      irc = false;
+    }
+    if (!irc && srslte_predecoding_type(q->symbols,
                                 q->ce,
                                 x,
                                 q->csi,
@@ -1025,6 +1206,7 @@ int srslte_pdsch_decode(srslte_pdsch_t*        q,
             h->ack                   = &data[tb_idx].crc;
             h->dl_sch.max_iterations = q->dl_sch.max_iterations;
             h->started               = true;
+            srslte_sch_set_cb_pool(&h->dl_sch, q->dl_sch.cb_pool);
             sem_post(&h->start);
 
           } else {
@@ -1056,7 +1238,9 @@ int srslte_pdsch_decode(srslte_pdsch_t*        q,
       }
     }
 
-    pdsch_decode_debug(q, cfg, sf_symbols, channel->ce);
+    if (sf_symbols != NULL) {
+      pdsch_decode_debug(q, cfg, sf_symbols, channel->ce);
+    }
 
     if (cfg->meas_time_en) {
       gettimeofday(&t[2], NULL);
@@ -1071,6 +1255,29 @@ int srslte_pdsch_decode(srslte_pdsch_t*        q,
   }
 }
 
+/** Decodes the PDSCH from the received symbols
+ */
+int srslte_pdsch_decode(srslte_pdsch_t*        q,
+                        srslte_dl_sf_cfg_t*    sf,
+                        srslte_pdsch_cfg_t*    cfg,
+                        srslte_chest_dl_res_t* channel,
+                        cf_t*                  sf_symbols[SRSLTE_MAX_PORTS],
+                        srslte_pdsch_res_t     data[SRSLTE_MAX_CODEWORDS])
+{
+  return pdsch_decode(q, sf, cfg, channel, sf_symbols, NULL, NULL, data);
+}
+
+int srslte_pdsch_decode_c16(srslte_pdsch_t*        q,
+                            srslte_dl_sf_cfg_t*    sf,
+                            srslte_pdsch_cfg_t*    cfg,
+                            srslte_chest_dl_res_t* channel,
+                            srslte_grid_c16_t      sf_symbols[SRSLTE_MAX_PORTS],
+                            srslte_grid_c16_t      ce[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS],
+                            srslte_pdsch_res_t     data[SRSLTE_MAX_CODEWORDS])
+{
+  return pdsch_decode(q, sf, cfg, channel, NULL, sf_symbols, ce, data);
+}
+
 static int srslte_pdsch_codeword_encode(srslte_pdsch_t*         q,
                                         srslte_dl_sf_cfg_t*     sf,
                                         srslte_pdsch_cfg_t*     cfg,
@@ -1171,7 +1378,7 @@ int srslte_pdsch_encode(srslte_pdsch_t*     q,
       return SRSLTE_ERROR_INVALID_INPUTS;
     }
 
-    float rho_a = apply_power_allocation(q, cfg, sf_symbols);
+    float rho_a = apply_power_allocation(q, cfg, sf_symbols, NULL);
 
     /* Implementation of 3GPP 36.212 Table 5.3.3.1.5-1 and Table 5.3.3.1.5-2 */
     for (uint32_t tb_idx = 0; tb_idx < SRSLTE_MAX_TB; tb_idx++) {
@@ -180,46 +180,37 @@ void srslte_phich_ack_encode(uint8_t ack, uint8_t bits[SRSLTE_PHICH_NBITS])
   memset(bits, ack, 3 * sizeof(uint8_t));
 }
 
-int srslte_phich_decode(srslte_phich_t*         q,
-                        srslte_dl_sf_cfg_t*     sf,
-                        srslte_chest_dl_res_t*  channel,
-                        srslte_phich_resource_t n_phich,
-                        cf_t*                   sf_symbols[SRSLTE_MAX_PORTS],
-                        srslte_phich_res_t*     result)
+static int phich_check_resource(srslte_phich_t* q, srslte_phich_resource_t* n_phich)
 {
-
-  /* Set pointers for layermapping & precoding */
-  int   i, j;
-  cf_t* x[SRSLTE_MAX_LAYERS];
-
-  if (q == NULL || sf_symbols == NULL) {
-    return SRSLTE_ERROR_INVALID_INPUTS;
-  }
-
-  uint32_t sf_idx = sf->tti % 10;
-
-  if (sf_idx >= SRSLTE_NOF_SF_X_FRAME) {
-    ERROR("Invalid nslot %d\n", sf_idx);
-    return SRSLTE_ERROR_INVALID_INPUTS;
-  }
-
   if (SRSLTE_CP_ISEXT(q->cell.cp)) {
-    if (n_phich.nseq >= SRSLTE_PHICH_EXT_NSEQUENCES) {
-      ERROR("Invalid nseq %d\n", n_phich.nseq);
+    if (n_phich->nseq >= SRSLTE_PHICH_EXT_NSEQUENCES) {
+      ERROR("Invalid nseq %d\n", n_phich->nseq);
       return SRSLTE_ERROR_INVALID_INPUTS;
     }
   } else {
-    if (n_phich.nseq >= SRSLTE_PHICH_NORM_NSEQUENCES) {
-      ERROR("Invalid nseq %d\n", n_phich.nseq);
+    if (n_phich->nseq >= SRSLTE_PHICH_NORM_NSEQUENCES) {
+      ERROR("Invalid nseq %d\n", n_phich->nseq);
       return SRSLTE_ERROR_INVALID_INPUTS;
     }
   }
-  if (n_phich.ngroup >= srslte_regs_phich_ngroups(q->regs)) {
-    ERROR("Invalid ngroup %d\n", n_phich.ngroup);
+  if (n_phich->ngroup >= srslte_regs_phich_ngroups(q->regs) || n_phich->ngroup >= SRSLTE_PHICH_MAX_NGROUPS) {
+    ERROR("Invalid ngroup %d\n", n_phich->ngroup);
     return SRSLTE_ERROR_INVALID_INPUTS;
   }
+  return SRSLTE_SUCCESS;
+}
 
-  DEBUG("Decoding PHICH Ngroup: %d, Nseq: %d\n", n_phich.ngroup, n_phich.nseq);
+/* Extracts and equalizes the symbols of one PHICH group and descrambles them into d */
+static int phich_equalize_group(srslte_phich_t*        q,
+                                uint32_t               sf_idx,
+                                srslte_chest_dl_res_t* channel,
+                                uint32_t               ngroup,
+                                cf_t*                  sf_symbols[SRSLTE_MAX_PORTS],
+                                cf_t*                  d)
+{
+  /* Set pointers for layermapping & precoding */
+  int   i;
+  cf_t* x[SRSLTE_MAX_LAYERS];
 
   /* number of layers equals number of ports */
   for (i = 0; i < SRSLTE_MAX_PORTS; i++) {
@@ -231,7 +222,7 @@ int srslte_phich_decode(srslte_phich_t*         q,
 
   /* extract symbols */
   for (int j = 0; j < q->nof_rx_antennas; j++) {
-    if (SRSLTE_PHICH_MAX_NSYMB != srslte_regs_phich_get(q->regs, sf_symbols[j], q->sf_symbols[j], n_phich.ngroup)) {
+    if (SRSLTE_PHICH_MAX_NSYMB != srslte_regs_phich_get(q->regs, sf_symbols[j], q->sf_symbols[j], ngroup)) {
       ERROR("There was an error getting the phich symbols\n");
       return SRSLTE_ERROR;
     }
@@ -239,7 +230,7 @@ int srslte_phich_decode(srslte_phich_t*         q,
 
     /* extract channel estimates */
     for (i = 0; i < q->cell.nof_ports; i++) {
-      if (SRSLTE_PHICH_MAX_NSYMB != srslte_regs_phich_get(q->regs, channel->ce[i][j], q->ce[i][j], n_phich.ngroup)) {
+      if (SRSLTE_PHICH_MAX_NSYMB != srslte_regs_phich_get(q->regs, channel->ce[i][j], q->ce[i][j], ngroup)) {
         ERROR("There was an error getting the phich symbols\n");
         return SRSLTE_ERROR;
       }
@@ -263,40 +254,48 @@ int srslte_phich_decode(srslte_phich_t*         q,
     srslte_vec_fprint_c(stdout, q->d0, SRSLTE_PHICH_MAX_NSYMB);
 
   if (SRSLTE_CP_ISEXT(q->cell.cp)) {
-    if (n_phich.ngroup % 2) {
+    if (ngroup % 2) {
       for (i = 0; i < SRSLTE_PHICH_EXT_MSYMB / 2; i++) {
-        q->d[2 * i + 0] = q->d0[4 * i + 2];
-        q->d[2 * i + 1] = q->d0[4 * i + 3];
+        d[2 * i + 0] = q->d0[4 * i + 2];
+        d[2 * i + 1] = q->d0[4 * i + 3];
       }
     } else {
       for (i = 0; i < SRSLTE_PHICH_EXT_MSYMB / 2; i++) {
-        q->d[2 * i + 0] = q->d0[4 * i];
-        q->d[2 * i + 1] = q->d0[4 * i + 1];
+        d[2 * i + 0] = q->d0[4 * i];
+        d[2 * i + 1] = q->d0[4 * i + 1];
       }
     }
   } else {
-    memcpy(q->d, q->d0, SRSLTE_PHICH_MAX_NSYMB * sizeof(cf_t));
+    memcpy(d, q->d0, SRSLTE_PHICH_MAX_NSYMB * sizeof(cf_t));
   }
 
   DEBUG("d: ");
   if (SRSLTE_VERBOSE_ISDEBUG())
-    srslte_vec_fprint_c(stdout, q->d, SRSLTE_PHICH_EXT_MSYMB);
+    srslte_vec_fprint_c(stdout, d, SRSLTE_PHICH_EXT_MSYMB);
+
+  srslte_scrambling_c(&q->seq[sf_idx], d);
+
+  return SRSLTE_SUCCESS;
+}
 
-  srslte_scrambling_c(&q->seq[sf_idx], q->d);
+/* Despreads the HI with orthogonal sequence nseq from the descrambled symbols of its group */
+static void phich_despread(srslte_phich_t* q, uint32_t nseq, const cf_t* d, srslte_phich_res_t* result)
+{
+  int i, j;
 
   /* De-spreading */
   if (SRSLTE_CP_ISEXT(q->cell.cp)) {
     for (i = 0; i < SRSLTE_PHICH_NBITS; i++) {
       q->z[i] = 0;
       for (j = 0; j < SRSLTE_PHICH_EXT_NSF; j++) {
-        q->z[i] += conjf(w_ext[n_phich.nseq][j]) * q->d[i * SRSLTE_PHICH_EXT_NSF + j] / SRSLTE_PHICH_EXT_NSF;
+        q->z[i] += conjf(w_ext[nseq][j]) * d[i * SRSLTE_PHICH_EXT_NSF + j] / SRSLTE_PHICH_EXT_NSF;
       }
     }
   } else {
     for (i = 0; i < SRSLTE_PHICH_NBITS; i++) {
       q->z[i] = 0;
       for (j = 0; j < SRSLTE_PHICH_NORM_NSF; j++) {
-        q->z[i] += conjf(w_normal[n_phich.nseq][j]) * q->d[i * SRSLTE_PHICH_NORM_NSF + j] / SRSLTE_PHICH_NORM_NSF;
+        q->z[i] += conjf(w_normal[nseq][j]) * d[i * SRSLTE_PHICH_NORM_NSF + j] / SRSLTE_PHICH_NORM_NSF;
       }
     }
   }
@@ -310,21 +309,15 @@ int srslte_phich_decode(srslte_phich_t*         q,
   if (result) {
     result->ack_value = srslte_phich_ack_decode(q->data_rx, &result->distance);
   }
-
-  return SRSLTE_SUCCESS;
 }
 
-/** Encodes ACK/NACK bits, modulates and inserts into resource.
- * The parameter ack is an array of srslte_phich_ngroups() pointers to buffers of nof_sequences uint8_ts
- */
-int srslte_phich_encode(srslte_phich_t*         q,
+int srslte_phich_decode(srslte_phich_t*         q,
                         srslte_dl_sf_cfg_t*     sf,
+                        srslte_chest_dl_res_t*  channel,
                         srslte_phich_resource_t n_phich,
-                        uint8_t                 ack,
-                        cf_t*                   sf_symbols[SRSLTE_MAX_PORTS])
+                        cf_t*                   sf_symbols[SRSLTE_MAX_PORTS],
+                        srslte_phich_res_t*     result)
 {
-  int i;
-
   if (q == NULL || sf_symbols == NULL) {
     return SRSLTE_ERROR_INVALID_INPUTS;
   }
@@ -336,34 +329,71 @@ int srslte_phich_encode(srslte_phich_t*         q,
     return SRSLTE_ERROR_INVALID_INPUTS;
   }
 
-  if (SRSLTE_CP_ISEXT(q->cell.cp)) {
-    if (n_phich.nseq >= SRSLTE_PHICH_EXT_NSEQUENCES) {
-      ERROR("Invalid nseq %d\n", n_phich.nseq);
-      return SRSLTE_ERROR_INVALID_INPUTS;
-    }
-  } else {
-    if (n_phich.nseq >= SRSLTE_PHICH_NORM_NSEQUENCES) {
-      ERROR("Invalid nseq %d\n", n_phich.nseq);
-      return SRSLTE_ERROR_INVALID_INPUTS;
-    }
+  if (phich_check_resource(q, &n_phich)) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  DEBUG("Decoding PHICH Ngroup: %d, Nseq: %d\n", n_phich.ngroup, n_phich.nseq);
+
+  if (phich_equalize_group(q, sf_idx, channel, n_phich.ngroup, sf_symbols, q->d)) {
+    return SRSLTE_ERROR;
   }
-  if (n_phich.ngroup >= srslte_regs_phich_ngroups(q->regs)) {
-    ERROR("Invalid ngroup %d\n", n_phich.ngroup);
+
+  phich_despread(q, n_phich.nseq, q->d, result);
+
+  return SRSLTE_SUCCESS;
+}
+
+/** Decodes nof_hi ACK/NACK bits of the same subframe. Each PHICH group is extracted and equalized once, regardless of
+ * the number of HI that share it.
+ */
+int srslte_phich_decode_batch(srslte_phich_t*               q,
+                              srslte_dl_sf_cfg_t*           sf,
+                              srslte_chest_dl_res_t*        channel,
+                              const srslte_phich_resource_t n_phich[],
+                              uint32_t                      nof_hi,
+                              cf_t*                         sf_symbols[SRSLTE_MAX_PORTS],
+                              srslte_phich_res_t            result[])
+{
+  if (q == NULL || sf_symbols == NULL || (nof_hi && (n_phich == NULL || result == NULL))) {
     return SRSLTE_ERROR_INVALID_INPUTS;
   }
 
-  /* Set pointers for layermapping & precoding */
-  cf_t* x[SRSLTE_MAX_LAYERS];
-  cf_t* symbols_precoding[SRSLTE_MAX_PORTS];
+  uint32_t sf_idx = sf->tti % 10;
 
-  /* number of layers equals number of ports */
-  for (i = 0; i < q->cell.nof_ports; i++) {
-    x[i] = q->x[i];
+  if (sf_idx >= SRSLTE_NOF_SF_X_FRAME) {
+    ERROR("Invalid nslot %d\n", sf_idx);
+    return SRSLTE_ERROR_INVALID_INPUTS;
   }
-  for (i = 0; i < SRSLTE_MAX_PORTS; i++) {
-    symbols_precoding[i] = q->sf_symbols[i];
+
+  bzero(q->group_used, sizeof(q->group_used));
+
+  for (uint32_t i = 0; i < nof_hi; i++) {
+    srslte_phich_resource_t resource = n_phich[i];
+    if (phich_check_resource(q, &resource)) {
+      return SRSLTE_ERROR_INVALID_INPUTS;
+    }
+
+    DEBUG("Decoding PHICH Ngroup: %d, Nseq: %d\n", resource.ngroup, resource.nseq);
+
+    if (!q->group_used[resource.ngroup]) {
+      if (phich_equalize_group(q, sf_idx, channel, resource.ngroup, sf_symbols, q->d_group[resource.ngroup])) {
+        return SRSLTE_ERROR;
+      }
+      q->group_used[resource.ngroup] = true;
+    }
+
+    phich_despread(q, resource.nseq, q->d_group[resource.ngroup], &result[i]);
   }
 
+  return SRSLTE_SUCCESS;
+}
+
+/* Encodes and modulates the ACK/NACK bit and spreads it with the orthogonal sequence nseq into d */
+static void phich_spread(srslte_phich_t* q, uint32_t nseq, uint8_t ack, cf_t* d)
+{
+  int i;
+
   /* encode ACK/NACK bit */
   srslte_phich_ack_encode(ack, q->data);
 
@@ -376,39 +406,61 @@ int srslte_phich_encode(srslte_phich_t*         q,
   /* Spread with w */
   if (SRSLTE_CP_ISEXT(q->cell.cp)) {
     for (i = 0; i < SRSLTE_PHICH_EXT_MSYMB; i++) {
-      q->d[i] = w_ext[n_phich.nseq][i % SRSLTE_PHICH_EXT_NSF] * q->z[i / SRSLTE_PHICH_EXT_NSF];
+      d[i] = w_ext[nseq][i % SRSLTE_PHICH_EXT_NSF] * q->z[i / SRSLTE_PHICH_EXT_NSF];
     }
   } else {
     for (i = 0; i < SRSLTE_PHICH_NORM_MSYMB; i++) {
-      q->d[i] = w_normal[n_phich.nseq][i % SRSLTE_PHICH_NORM_NSF] * q->z[i / SRSLTE_PHICH_NORM_NSF];
+      d[i] = w_normal[nseq][i % SRSLTE_PHICH_NORM_NSF] * q->z[i / SRSLTE_PHICH_NORM_NSF];
     }
   }
 
   DEBUG("d: ");
   if (SRSLTE_VERBOSE_ISDEBUG())
-    srslte_vec_fprint_c(stdout, q->d, SRSLTE_PHICH_EXT_MSYMB);
+    srslte_vec_fprint_c(stdout, d, SRSLTE_PHICH_EXT_MSYMB);
+}
 
-  srslte_scrambling_c(&q->seq[sf_idx], q->d);
+/* Scrambles the spread symbols d of one PHICH group, precodes them and adds them to the resource grid */
+static int phich_map_group(srslte_phich_t* q,
+                           uint32_t        sf_idx,
+                           uint32_t        ngroup,
+                           cf_t*           d,
+                           cf_t*           sf_symbols[SRSLTE_MAX_PORTS])
+{
+  int i;
+
+  /* Set pointers for layermapping & precoding */
+  cf_t* x[SRSLTE_MAX_LAYERS];
+  cf_t* symbols_precoding[SRSLTE_MAX_PORTS];
+
+  /* number of layers equals number of ports */
+  for (i = 0; i < q->cell.nof_ports; i++) {
+    x[i] = q->x[i];
+  }
+  for (i = 0; i < SRSLTE_MAX_PORTS; i++) {
+    symbols_precoding[i] = q->sf_symbols[i];
+  }
+
+  srslte_scrambling_c(&q->seq[sf_idx], d);
 
   /* align to REG */
   if (SRSLTE_CP_ISEXT(q->cell.cp)) {
-    if (n_phich.ngroup % 2) {
+    if (ngroup % 2) {
       for (i = 0; i < SRSLTE_PHICH_EXT_MSYMB / 2; i++) {
         q->d0[4 * i + 0] = 0;
         q->d0[4 * i + 1] = 0;
-        q->d0[4 * i + 2] = q->d[2 * i];
-        q->d0[4 * i + 3] = q->d[2 * i + 1];
+        q->d0[4 * i + 2] = d[2 * i];
+        q->d0[4 * i + 3] = d[2 * i + 1];
       }
     } else {
       for (i = 0; i < SRSLTE_PHICH_EXT_MSYMB / 2; i++) {
-        q->d0[4 * i + 0] = q->d[2 * i];
-        q->d0[4 * i + 1] = q->d[2 * i + 1];
+        q->d0[4 * i + 0] = d[2 * i];
+        q->d0[4 * i + 1] = d[2 * i + 1];
         q->d0[4 * i + 2] = 0;
         q->d0[4 * i + 3] = 0;
       }
     }
   } else {
-    memcpy(q->d0, q->d, SRSLTE_PHICH_MAX_NSYMB * sizeof(cf_t));
+    memcpy(q->d0, d, SRSLTE_PHICH_MAX_NSYMB * sizeof(cf_t));
   }
 
   DEBUG("d0: ");
@@ -427,7 +479,7 @@ int srslte_phich_encode(srslte_phich_t*         q,
 
   /* mapping to resource elements */
   for (i = 0; i < q->cell.nof_ports; i++) {
-    if (srslte_regs_phich_add(q->regs, q->sf_symbols[i], n_phich.ngroup, sf_symbols[i]) < 0) {
+    if (srslte_regs_phich_add(q->regs, q->sf_symbols[i], ngroup, sf_symbols[i]) < 0) {
       ERROR("Error putting PCHICH resource elements\n");
       return SRSLTE_ERROR;
     }
@@ -435,3 +487,83 @@ int srslte_phich_encode(srslte_phich_t*         q,
 
   return SRSLTE_SUCCESS;
 }
+
+/** Encodes ACK/NACK bits, modulates and inserts into resource.
+ * The parameter ack is an array of srslte_phich_ngroups() pointers to buffers of nof_sequences uint8_ts
+ */
+int srslte_phich_encode(srslte_phich_t*         q,
+                        srslte_dl_sf_cfg_t*     sf,
+                        srslte_phich_resource_t n_phich,
+                        uint8_t                 ack,
+                        cf_t*                   sf_symbols[SRSLTE_MAX_PORTS])
+{
+  if (q == NULL || sf_symbols == NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t sf_idx = sf->tti % 10;
+
+  if (sf_idx >= SRSLTE_NOF_SF_X_FRAME) {
+    ERROR("Invalid nslot %d\n", sf_idx);
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  if (phich_check_resource(q, &n_phich)) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  phich_spread(q, n_phich.nseq, ack, q->d);
+
+  return phich_map_group(q, sf_idx, n_phich.ngroup, q->d, sf_symbols);
+}
+
+/** Encodes the nof_hi ACK/NACK bits of a subframe. The spread sequences of the HI that share a PHICH group are summed
+ * before scrambling, so that scrambling, precoding and mapping run once per group instead of once per HI.
+ */
+int srslte_phich_encode_batch(srslte_phich_t*               q,
+                              srslte_dl_sf_cfg_t*           sf,
+                              const srslte_phich_resource_t n_phich[],
+                              const uint8_t                 ack[],
+                              uint32_t                      nof_hi,
+                              cf_t*                         sf_symbols[SRSLTE_MAX_PORTS])
+{
+  if (q == NULL || sf_symbols == NULL || (nof_hi && (n_phich == NULL || ack == NULL))) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t sf_idx = sf->tti % 10;
+
+  if (sf_idx >= SRSLTE_NOF_SF_X_FRAME) {
+    ERROR("Invalid nslot %d\n", sf_idx);
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t msymb = SRSLTE_PHICH_NBITS * srslte_phich_nsf(q);
+
+  bzero(q->group_used, sizeof(q->group_used));
+
+  for (uint32_t i = 0; i < nof_hi; i++) {
+    srslte_phich_resource_t resource = n_phich[i];
+    if (phich_check_resource(q, &resource)) {
+      return SRSLTE_ERROR_INVALID_INPUTS;
+    }
+
+    if (!q->group_used[resource.ngroup]) {
+      phich_spread(q, resource.nseq, ack[i], q->d_group[resource.ngroup]);
+      q->group_used[resource.ngroup] = true;
+    } else {
+      phich_spread(q, resource.nseq, ack[i], q->d);
+      srslte_vec_sum_ccc(q->d_group[resource.ngroup], q->d, q->d_group[resource.ngroup], msymb);
+    }
+  }
+
+  for (uint32_t ngroup = 0; ngroup < SRSLTE_PHICH_MAX_NGROUPS; ngroup++) {
+    if (q->group_used[ngroup]) {
+      if (phich_map_group(q, sf_idx, ngroup, q->d_group[ngroup], sf_symbols)) {
+        return SRSLTE_ERROR;
+      }
+    }
+  }
+
+  return SRSLTE_SUCCESS;
+}
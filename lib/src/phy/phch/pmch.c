@@ -21,6 +21,7 @@
 
 #include <assert.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -30,6 +31,7 @@
 
 #include "prb_dl.h"
 #include "srslte/phy/common/phy_common.h"
+#include "srslte/phy/modem/demod_soft.h"
 #include "srslte/phy/phch/pmch.h"
 #include "srslte/phy/utils/bit.h"
 #include "srslte/phy/utils/debug.h"
@@ -39,9 +41,51 @@
 
 const static srslte_mod_t modulations[4] = {SRSLTE_MOD_BPSK, SRSLTE_MOD_QPSK, SRSLTE_MOD_16QAM, SRSLTE_MOD_64QAM};
 
+/* The scrambling sequences only depend on the MBSFN area ID, so they are generated once for all the PMCH objects of
+ * the process (one per worker). Each area keeps the longest sequences generated so far, which are freed with their
+ * last user. */
+static pthread_mutex_t    pmch_seqs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static srslte_pmch_seq_t* pmch_seqs[SRSLTE_MAX_MBSFN_AREA_IDS];
+
+static srslte_pmch_seq_t* pmch_seq_alloc(uint16_t area_id, uint32_t len)
+{
+  srslte_pmch_seq_t* s = calloc(1, sizeof(srslte_pmch_seq_t));
+  if (!s) {
+    perror("calloc");
+    return NULL;
+  }
+  s->area_id = area_id;
+  s->len     = len;
+  for (uint32_t i = 0; i < SRSLTE_NOF_SF_X_FRAME; i++) {
+    if (srslte_sequence_pmch(&s->seq[i], 2 * i, area_id, len)) {
+      for (uint32_t j = 0; j <= i; j++) {
+        srslte_sequence_free(&s->seq[j]);
+      }
+      free(s);
+      return NULL;
+    }
+  }
+  return s;
+}
+
+/* Must be called with pmch_seqs_mutex locked */
+static void pmch_seq_release(srslte_pmch_seq_t* s)
+{
+  if (--s->nof_users > 0) {
+    return;
+  }
+  if (pmch_seqs[s->area_id] == s) {
+    pmch_seqs[s->area_id] = NULL;
+  }
+  for (uint32_t i = 0; i < SRSLTE_NOF_SF_X_FRAME; i++) {
+    srslte_sequence_free(&s->seq[i]);
+  }
+  free(s);
+}
+
 static int pmch_cp(srslte_pmch_t* q, cf_t* input, cf_t* output, uint32_t lstart_grant, bool put)
 {
-  uint32_t s, n, l, lp, lstart, lend, nof_refs;
+  uint32_t s, l, lp, lstart, lend, nof_refs;
   cf_t *   in_ptr = input, *out_ptr = output;
   uint32_t offset = 0;
 
@@ -56,34 +100,30 @@ static int pmch_cp(srslte_pmch_t* q, cf_t* input, cf_t* output, uint32_t lstart_
   nof_refs = 6;
   for (s = 0; s < 2; s++) {
     for (l = 0; l < SRSLTE_CP_EXT_NSYMB; l++) {
-      for (n = 0; n < q->cell.nof_prb; n++) {
-        // If this PRB is assigned
-        if (true) {
-          if (s == 0) {
-            lstart = lstart_grant;
-          } else {
-            lstart = 0;
-          }
-          lend = SRSLTE_CP_EXT_NSYMB;
-          lp   = l + s * SRSLTE_CP_EXT_NSYMB;
-          if (put) {
-            out_ptr = &output[(lp * q->cell.nof_prb + n) * SRSLTE_NRE];
+      // All the PRB are assigned, copy the whole symbol at once
+      if (s == 0) {
+        lstart = lstart_grant;
+      } else {
+        lstart = 0;
+      }
+      lend = SRSLTE_CP_EXT_NSYMB;
+      lp   = l + s * SRSLTE_CP_EXT_NSYMB;
+      if (put) {
+        out_ptr = &output[lp * q->cell.nof_prb * SRSLTE_NRE];
+      } else {
+        in_ptr = &input[lp * q->cell.nof_prb * SRSLTE_NRE];
+      }
+      // This is a symbol with or without references
+      if (l >= lstart && l < lend) {
+        if (SRSLTE_SYMBOL_HAS_REF_MBSFN(l, s)) {
+          if (l == 0 && s == 1) {
+            offset = 1;
           } else {
-            in_ptr = &input[(lp * q->cell.nof_prb + n) * SRSLTE_NRE];
-          }
-          // This is a symbol in a normal PRB with or without references
-          if (l >= lstart && l < lend) {
-            if (SRSLTE_SYMBOL_HAS_REF_MBSFN(l, s)) {
-              if (l == 0 && s == 1) {
-                offset = 1;
-              } else {
-                offset = 0;
-              }
-              prb_cp_ref(&in_ptr, &out_ptr, offset, nof_refs, nof_refs, put);
-            } else {
-              prb_cp(&in_ptr, &out_ptr, 1);
-            }
+            offset = 0;
           }
+          prb_cp_ref_run(&in_ptr, &out_ptr, offset, nof_refs, q->cell.nof_prb, put);
+        } else {
+          prb_cp(&in_ptr, &out_ptr, q->cell.nof_prb);
         }
       }
     }
@@ -252,37 +292,61 @@ int srslte_pmch_set_cell(srslte_pmch_t* q, srslte_cell_t cell)
   return ret;
 }
 
-/* Precalculate the scramble sequences for a given MBSFN area ID. This function takes a while
- * to execute.
+/* Precalculate the scramble sequences for a given MBSFN area ID. This function takes a while to execute the first time
+ * an area is set in the process, the other PMCH objects reuse the same sequences.
  */
 int srslte_pmch_set_area_id(srslte_pmch_t* q, uint16_t area_id)
 {
-  uint32_t i;
-  if (!q->seqs[area_id]) {
-    q->seqs[area_id] = calloc(1, sizeof(srslte_pmch_seq_t));
-    if (q->seqs[area_id]) {
-      for (i = 0; i < SRSLTE_NOF_SF_X_FRAME; i++) {
-        if (srslte_sequence_pmch(
-                &q->seqs[area_id]->seq[i], 2 * i, area_id, q->max_re * srslte_mod_bits_x_symbol(SRSLTE_MOD_64QAM))) {
-          return SRSLTE_ERROR;
-        }
-      }
+  uint32_t len = q->max_re * srslte_mod_bits_x_symbol(SRSLTE_MOD_64QAM);
+  if (q->seqs[area_id] && q->seqs[area_id]->len >= len) {
+    return SRSLTE_SUCCESS;
+  }
+
+  pthread_mutex_lock(&pmch_seqs_mutex);
+  srslte_pmch_seq_t* s = pmch_seqs[area_id];
+  if (!s || s->len < len) {
+    s = pmch_seq_alloc(area_id, len);
+    if (!s) {
+      pthread_mutex_unlock(&pmch_seqs_mutex);
+      return SRSLTE_ERROR;
     }
+    // The shorter sequences stay with their current users
+    pmch_seqs[area_id] = s;
+  }
+  s->nof_users++;
+  if (q->seqs[area_id]) {
+    pmch_seq_release(q->seqs[area_id]);
   }
+  q->seqs[area_id] = s;
+  pthread_mutex_unlock(&pmch_seqs_mutex);
+
   return SRSLTE_SUCCESS;
 }
 
 void srslte_pmch_free_area_id(srslte_pmch_t* q, uint16_t area_id)
 {
   if (q->seqs[area_id]) {
-    for (int i = 0; i < SRSLTE_NOF_SF_X_FRAME; i++) {
-      srslte_sequence_free(&q->seqs[area_id]->seq[i]);
-    }
-    free(q->seqs[area_id]);
+    pthread_mutex_lock(&pmch_seqs_mutex);
+    pmch_seq_release(q->seqs[area_id]);
+    pthread_mutex_unlock(&pmch_seqs_mutex);
     q->seqs[area_id] = NULL;
   }
 }
 
+/* Sequences of the area of cfg, set now if the area wasn't set or the cell grew since */
+static srslte_sequence_t* pmch_get_seq(srslte_pmch_t* q, srslte_dl_sf_cfg_t* sf, srslte_pmch_cfg_t* cfg)
+{
+  srslte_pmch_seq_t* s = q->seqs[cfg->area_id];
+  if (!s || s->len < cfg->pdsch_cfg.grant.tb[0].nof_bits) {
+    if (srslte_pmch_set_area_id(q, cfg->area_id)) {
+      ERROR("Error setting MBSFN area ID %d\n", cfg->area_id);
+      return NULL;
+    }
+    s = q->seqs[cfg->area_id];
+  }
+  return &s->seq[sf->tti % SRSLTE_NOF_SF_X_FRAME];
+}
+
 /** Decodes the pmch from the received symbols
  */
 int srslte_pmch_decode(srslte_pmch_t*         q,
@@ -310,6 +374,11 @@ int srslte_pmch_decode(srslte_pmch_t*         q,
          cfg->pdsch_cfg.grant.nof_prb,
          sf->cfi);
 
+    srslte_sequence_t* seq = pmch_get_seq(q, sf, cfg);
+    if (!seq) {
+      return SRSLTE_ERROR;
+    }
+
     /* number of layers equals number of ports */
     for (i = 0; i < q->cell.nof_ports; i++) {
       x[i] = q->x[i];
@@ -363,14 +432,15 @@ int srslte_pmch_decode(srslte_pmch_t*         q,
       srslte_vec_save_file("pmch_symbols.bin", q->d, cfg->pdsch_cfg.grant.nof_re * sizeof(cf_t));
     }
 
-    /* demodulate symbols
+    /* demodulate and descramble symbols in a single pass
      * The MAX-log-MAP algorithm used in turbo decoding is unsensitive to SNR estimation,
      * thus we don't need tot set it in thde LLRs normalization
      */
-    srslte_demod_soft_demodulate_s(cfg->pdsch_cfg.grant.tb[0].mod, q->d, q->e, cfg->pdsch_cfg.grant.nof_re);
-
-    /* descramble */
-    srslte_scrambling_s_offset(&q->seqs[cfg->area_id]->seq[sf->tti % 10], q->e, 0, cfg->pdsch_cfg.grant.tb[0].nof_bits);
+    if (srslte_demod_soft_demodulate_s_scrambled(
+            cfg->pdsch_cfg.grant.tb[0].mod, q->d, q->e, cfg->pdsch_cfg.grant.nof_re, seq)) {
+      ERROR("Error demodulating PMCH\n");
+      return SRSLTE_ERROR;
+    }
 
     if (SRSLTE_VERBOSE_ISDEBUG()) {
       DEBUG("SAVED FILE llr.dat: LLR estimates after demodulation and descrambling\n");
@@ -457,8 +527,11 @@ int srslte_pmch_encode(srslte_pmch_t*      q,
     }
 
     /* scramble */
-    srslte_scrambling_bytes(
-        &q->seqs[cfg->area_id]->seq[sf->tti % 10], (uint8_t*)q->e, cfg->pdsch_cfg.grant.tb[0].nof_bits);
+    srslte_sequence_t* seq = pmch_get_seq(q, sf, cfg);
+    if (!seq) {
+      return SRSLTE_ERROR;
+    }
+    srslte_scrambling_bytes(seq, (uint8_t*)q->e, cfg->pdsch_cfg.grant.tb[0].nof_bits);
 
     srslte_mod_modulate_bytes(
         &q->mod[cfg->pdsch_cfg.grant.tb[0].mod], (uint8_t*)q->e, q->d, cfg->pdsch_cfg.grant.tb[0].nof_bits);
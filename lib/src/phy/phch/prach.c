@@ -661,14 +661,19 @@ int srslte_prach_process(srslte_prach_t* p,
   float max_to_cancel = 0;
   cancellation_idx    = -1;
   int max_idx         = 0;
-  srslte_vec_cf_zero(p->cross, p->N_zc);
+  if (p->freq_domain_offset_calc) {
+    srslte_vec_cf_zero(p->cross, p->N_zc);
+  }
   srslte_vec_cf_zero(p->corr_freq, p->N_zc);
   for (int i = 0; i < p->num_ra_preambles; i++) {
     cf_t* root_spec = get_precoded_dft(p, p->root_seqs_idx[i]);
 
     srslte_vec_prod_conj_ccc(p->prach_bins, root_spec, p->corr_spec, p->N_zc);
 
-    srslte_vec_prod_conj_ccc(p->corr_spec, &p->corr_spec[1], p->cross, p->N_zc - 1);
+    // The cross-correlation is only used by the frequency domain time offset estimation
+    if (p->freq_domain_offset_calc) {
+      srslte_vec_prod_conj_ccc(p->corr_spec, &p->corr_spec[1], p->cross, p->N_zc - 1);
+    }
     if (p->successive_cancellation) {
       srslte_vec_cf_copy(p->corr_freq, p->corr_spec, p->N_zc);
     }
@@ -695,8 +700,10 @@ int srslte_prach_process(srslte_prach_t* p,
       }
       start += p->deadzone;
       p->peak_values[j] = 0;
-      for (int k = start; k < end; k++) {
-        if (p->corr[k] > p->peak_values[j]) {
+      if (end > start) {
+        // Vectorized search of the window peak
+        uint32_t k = start + srslte_vec_max_fi(&p->corr[start], end - start);
+        if (p->corr[k] > 0) {
           p->peak_values[j]  = p->corr[k];
           p->peak_offsets[j] = k - start;
           if (p->peak_values[j] > max_peak) {
@@ -76,6 +76,59 @@ void prb_cp_ref(cf_t** input, cf_t** output, int offset, int nof_refs, int nof_i
   }
 }
 
+// Copies nof_chunks chunks of len REs, leaving one RE between chunks on the grid side. The chunks of the cell-specific
+// reference signal patterns are 5 or 2 REs long, the constant lengths let the compiler inline the copies.
+static inline void prb_cp_chunks(cf_t** input, cf_t** output, int len, int nof_chunks, bool advance_output)
+{
+  cf_t* in         = *input;
+  cf_t* out        = *output;
+  int   in_stride  = advance_output ? len : len + 1;
+  int   out_stride = advance_output ? len + 1 : len;
+
+  switch (len) {
+    case 5:
+      for (int i = 0; i < nof_chunks; i++, in += in_stride, out += out_stride) {
+        memcpy(out, in, 5 * sizeof(cf_t));
+      }
+      break;
+    case 2:
+      for (int i = 0; i < nof_chunks; i++, in += in_stride, out += out_stride) {
+        memcpy(out, in, 2 * sizeof(cf_t));
+      }
+      break;
+    default:
+      for (int i = 0; i < nof_chunks; i++, in += in_stride, out += out_stride) {
+        memcpy(out, in, len * sizeof(cf_t));
+      }
+  }
+
+  *input  = in;
+  *output = out;
+}
+
+void prb_cp_ref_run(cf_t** input, cf_t** output, int offset, int nof_refs, int nof_prb, bool advance_output)
+{
+  int ref_interval = ((SRSLTE_NRE / nof_refs) - 1);
+  int nof_refs_run = nof_refs * nof_prb;
+
+  // The last chunk of each PRB and the first of the next one are contiguous, so all the chunks between the first and
+  // the last reference of the run have the same length
+  memcpy(*output, *input, offset * sizeof(cf_t));
+  print_indexes(*input, offset);
+  *input += offset;
+  *output += offset;
+  if (advance_output) {
+    (*output)++;
+  } else {
+    (*input)++;
+  }
+  prb_cp_chunks(input, output, ref_interval, nof_refs_run - 1, advance_output);
+  memcpy(*output, *input, (ref_interval - offset) * sizeof(cf_t));
+  print_indexes(*input, ref_interval - offset);
+  *output += (ref_interval - offset);
+  *input += (ref_interval - offset);
+}
+
 void prb_cp(cf_t** input, cf_t** output, int nof_prb)
 {
   memcpy(*output, *input, sizeof(cf_t) * SRSLTE_NRE * nof_prb);
@@ -24,6 +24,7 @@
 #include "srslte/config.h"
 
 void prb_cp_ref(cf_t** input, cf_t** output, int offset, int nof_refs, int nof_intervals, bool advance_input);
+void prb_cp_ref_run(cf_t** input, cf_t** output, int offset, int nof_refs, int nof_prb, bool advance_output);
 void prb_cp(cf_t** input, cf_t** output, int nof_prb);
 void prb_cp_half(cf_t** input, cf_t** output, int nof_prb);
 void prb_put_ref_(cf_t** input, cf_t** output, int offset, int nof_refs, int nof_intervals);
@@ -39,6 +39,9 @@ int srslte_pssch_init(srslte_pssch_t* q, srslte_cell_sl_t cell, srslte_sl_comm_r
   q->cell                  = cell;
   q->sl_comm_resource_pool = sl_comm_resource_pool;
 
+  bzero(&q->scrambling_seq, sizeof(srslte_sequence_t));
+  q->scrambling_c_init = 0;
+
   if (cell.tm == SRSLTE_SIDELINK_TM1 || cell.tm == SRSLTE_SIDELINK_TM2) {
     if (cell.cp == SRSLTE_CP_NORM) {
       q->nof_data_symbols = SRSLTE_PSSCH_TM12_NUM_DATA_SYMBOLS;
@@ -220,6 +223,18 @@ int srslte_pssch_init(srslte_pssch_t* q, srslte_cell_sl_t cell, srslte_sl_comm_r
   return SRSLTE_SUCCESS;
 }
 
+// The scrambling sequence only changes with N_X_ID and the subframe, so it is kept while they are the same
+static srslte_sequence_t* pssch_scrambling_seq(srslte_pssch_t* q)
+{
+  // Scrambling follows 3GPP TS 36.211 version 15.6.0 Release 15 Sec. 9.3.1
+  uint32_t c_init = q->pssch_cfg.N_x_id * 16384 + (q->pssch_cfg.sf_idx % 10) * 512 + 510;
+  if (c_init != q->scrambling_c_init || q->scrambling_seq.cur_len < q->G) {
+    srslte_sequence_LTE_pr(&q->scrambling_seq, q->G, c_init);
+    q->scrambling_c_init = c_init;
+  }
+  return &q->scrambling_seq;
+}
+
 int srslte_pssch_set_cfg(srslte_pssch_t* q, srslte_pssch_cfg_t pssch_cfg)
 {
   if (q == NULL) {
@@ -345,9 +360,7 @@ int srslte_pssch_encode(srslte_pssch_t* q, uint8_t* input, uint32_t input_len, c
   srslte_bit_unpack_vector(q->codeword_bytes, q->codeword, q->G);
 
   // Scrambling follows 3GPP TS 36.211 version 15.6.0 Release 15 Sec. 9.3.1
-  srslte_sequence_LTE_pr(
-      &q->scrambling_seq, q->G, q->pssch_cfg.N_x_id * 16384 + (q->pssch_cfg.sf_idx % 10) * 512 + 510);
-  srslte_scrambling_b(&q->scrambling_seq, q->codeword);
+  srslte_scrambling_b_offset(pssch_scrambling_seq(q), q->codeword, 0, q->G);
 
   // Modulation
   srslte_mod_modulate(&q->mod[q->mod_idx], q->codeword, q->symbols, q->G);
@@ -400,13 +413,8 @@ int srslte_pssch_decode(srslte_pssch_t* q, cf_t* equalized_sf_syms, uint8_t* out
   // Voided: Single layer
   // 3GPP TS 36.211 version 15.6.0 Release 15 Sec. 9.3.3
 
-  // Demodulation
-  srslte_demod_soft_demodulate_s(q->Qm / 2, q->symbols, q->llr, q->G / q->Qm);
-
-  // Descramble follows 3GPP TS 36.211 version 15.6.0 Release 15 Sec. 9.3.1
-  srslte_sequence_LTE_pr(
-      &q->scrambling_seq, q->G, q->pssch_cfg.N_x_id * 16384 + (q->pssch_cfg.sf_idx % 10) * 512 + 510);
-  srslte_scrambling_s(&q->scrambling_seq, q->llr);
+  // Demodulation and descrambling, 3GPP TS 36.211 version 15.6.0 Release 15 Sec. 9.3.1
+  srslte_demod_soft_demodulate_s_scrambled(q->mod_idx, q->symbols, q->llr, q->G / q->Qm, pssch_scrambling_seq(q));
 
   srslte_cbsegm(&q->cb_segm, q->sl_sch_tb_len);
   uint32_t L = SRSLTE_PSSCH_CRC_LEN;
@@ -73,6 +73,23 @@ int srslte_pucch_init_(srslte_pucch_t* q, bool is_ue)
 
     if (!q->is_ue) {
       q->ce = srslte_vec_cf_malloc(SRSLTE_PUCCH_MAX_SYMBOLS);
+
+      q->despread = srslte_vec_cf_malloc(SRSLTE_NOF_SLOTS_PER_SF * SRSLTE_MAX_PRB * SRSLTE_CP_NORM_NSYMB * SRSLTE_NRE);
+      if (!q->despread) {
+        goto clean_exit;
+      }
+      if (srslte_dft_plan_c(&q->despread_dft, SRSLTE_PUCCH_N_SEQ, SRSLTE_DFT_FORWARD)) {
+        ERROR("Error creating PUCCH despreading DFT\n");
+        goto clean_exit;
+      }
+      // The bin of the cyclic shift is the sum of the 12 subcarriers
+      for (uint32_t u = 0; u < SRSLTE_PUCCH_NOF_GROUPS; u++) {
+        srslte_refsignal_r_uv_arg_1prb(q->tmp_arg, u);
+        for (uint32_t n = 0; n < SRSLTE_PUCCH_N_SEQ; n++) {
+          q->despread_r_u[u][n] = cexpf(-I * q->tmp_arg[n]) / SRSLTE_PUCCH_N_SEQ;
+        }
+      }
+      srslte_pucch_despread_reset(q);
     }
 
     ret = SRSLTE_SUCCESS;
@@ -119,6 +136,10 @@ void srslte_pucch_free(srslte_pucch_t* q)
   if (q->ce) {
     free(q->ce);
   }
+  if (q->despread) {
+    srslte_dft_plan_free(&q->despread_dft);
+    free(q->despread);
+  }
 
   srslte_modem_table_free(&q->mod);
   bzero(q, sizeof(srslte_pucch_t));
@@ -140,6 +161,9 @@ int srslte_pucch_set_cell(srslte_pucch_t* q, srslte_cell_t cell)
       if (srslte_pucch_n_cs_cell(q->cell, q->n_cs_cell)) {
         return SRSLTE_ERROR;
       }
+
+      bzero(q->seq_cache, sizeof(q->seq_cache));
+      srslte_pucch_despread_reset(q);
     }
 
     ret = SRSLTE_SUCCESS;
@@ -147,6 +171,17 @@ int srslte_pucch_set_cell(srslte_pucch_t* q, srslte_cell_t cell)
   return ret;
 }
 
+void srslte_pucch_despread_reset(srslte_pucch_t* q)
+{
+  q->despread_count++;
+  if (q->despread_count == 0) {
+    // After wrapping around, no RB can be taken as despread in the current subframe
+    bzero(q->despread_gen, sizeof(q->despread_gen));
+    q->despread_count = 1;
+  }
+  q->despread_input = NULL;
+}
+
 void srslte_pucch_free_rnti(srslte_pucch_t* q, uint16_t rnti)
 {
   uint32_t rnti_idx = q->is_ue ? 0 : rnti;
@@ -469,26 +504,35 @@ static int pucch_get(srslte_pucch_t* q, srslte_ul_sf_cfg_t* sf, srslte_pucch_cfg
   return pucch_cp(q, sf, cfg, input, z, true);
 }
 
-static int encode_signal_format12(srslte_pucch_t*     q,
-                                  srslte_ul_sf_cfg_t* sf,
-                                  srslte_pucch_cfg_t* cfg,
-                                  uint8_t             bits[SRSLTE_PUCCH_MAX_BITS],
-                                  cf_t                z[SRSLTE_PUCCH_MAX_SYMBOLS],
-                                  bool                signal_only)
+bool srslte_pucch_seq_key_match(const srslte_pucch_seq_key_t* key, const srslte_pucch_cfg_t* cfg, bool shortened)
 {
-  if (!signal_only) {
-    if (uci_mod_bits(q, sf, cfg, bits)) {
-      ERROR("Error encoding PUCCH bits\n");
-      return SRSLTE_ERROR;
-    }
-  } else {
-    // Set all ones
-    for (uint32_t i = 0; i < SRSLTE_PUCCH_MAX_BITS / 2; i++) {
-      q->d[i] = 1.0f;
-    }
+  return key->valid && key->format == cfg->format && key->n_pucch == cfg->n_pucch && key->N_cs == cfg->N_cs &&
+         key->delta_pucch_shift == cfg->delta_pucch_shift && key->n_rb_2 == cfg->n_rb_2 &&
+         key->group_hopping_en == cfg->group_hopping_en && key->shortened == shortened;
+}
+
+void srslte_pucch_seq_key_set(srslte_pucch_seq_key_t* key, const srslte_pucch_cfg_t* cfg, bool shortened)
+{
+  key->valid             = true;
+  key->format            = cfg->format;
+  key->n_pucch           = cfg->n_pucch;
+  key->N_cs              = cfg->N_cs;
+  key->delta_pucch_shift = cfg->delta_pucch_shift;
+  key->n_rb_2            = cfg->n_rb_2;
+  key->group_hopping_en  = cfg->group_hopping_en;
+  key->shortened         = shortened;
+}
+
+/* Returns the base sequence of the formats 1 and 2 in the subframe, in the layout of the PUCCH symbols z */
+static cf_t* format12_seq(srslte_pucch_t* q, srslte_ul_sf_cfg_t* sf, srslte_pucch_cfg_t* cfg)
+{
+  uint32_t                  sf_idx = sf->tti % SRSLTE_NOF_SF_X_FRAME;
+  srslte_pucch_seq_cache_t* c      = &q->seq_cache[sf_idx][cfg->format >= SRSLTE_PUCCH_FORMAT_2 ? 1 : 0];
+  if (srslte_pucch_seq_key_match(&c->key, cfg, sf->shortened)) {
+    return c->seq;
   }
+
   uint32_t N_sf_0 = get_N_sf(cfg->format, 0, sf->shortened);
-  uint32_t sf_idx = sf->tti % SRSLTE_NOF_SF_X_FRAME;
   for (uint32_t ns = SRSLTE_NOF_SLOTS_PER_SF * sf_idx; ns < SRSLTE_NOF_SLOTS_PER_SF * (sf_idx + 1); ns++) {
     uint32_t N_sf = get_N_sf(cfg->format, ns % 2, sf->shortened);
     DEBUG("ns=%d, N_sf=%d\n", ns, N_sf);
@@ -507,8 +551,8 @@ static int encode_signal_format12(srslte_pucch_t*     q,
       if (cfg->format >= SRSLTE_PUCCH_FORMAT_2) {
         alpha = srslte_pucch_alpha_format2(q->n_cs_cell, cfg, ns, l);
         for (uint32_t n = 0; n < SRSLTE_PUCCH_N_SEQ; n++) {
-          z[(ns % 2) * N_sf * SRSLTE_PUCCH_N_SEQ + m * SRSLTE_PUCCH_N_SEQ + n] =
-              q->d[(ns % 2) * N_sf + m] * cexpf(I * (q->tmp_arg[n] + alpha * n));
+          c->seq[(ns % 2) * N_sf * SRSLTE_PUCCH_N_SEQ + m * SRSLTE_PUCCH_N_SEQ + n] =
+              cexpf(I * (q->tmp_arg[n] + alpha * n));
         }
       } else {
         uint32_t n_prime_ns = 0;
@@ -518,21 +562,51 @@ static int encode_signal_format12(srslte_pucch_t*     q,
         if (n_prime_ns % 2) {
           S_ns = M_PI / 2;
         }
-        DEBUG("PUCCH d_0: %.1f+%.1fi, alpha: %.1f, n_oc: %d, n_prime_ns: %d, n_rb_2=%d\n",
-              __real__ q->d[0],
-              __imag__ q->d[0],
-              alpha,
-              n_oc,
-              n_prime_ns,
-              cfg->n_rb_2);
+        DEBUG("PUCCH alpha: %.1f, n_oc: %d, n_prime_ns: %d, n_rb_2=%d\n", alpha, n_oc, n_prime_ns, cfg->n_rb_2);
 
         for (uint32_t n = 0; n < SRSLTE_PUCCH_N_SEQ; n++) {
-          z[(ns % 2) * N_sf_0 * SRSLTE_PUCCH_N_SEQ + m * SRSLTE_PUCCH_N_SEQ + n] =
-              q->d[0] * cexpf(I * (w_n_oc[N_sf_widx][n_oc % 3][m] + q->tmp_arg[n] + alpha * n + S_ns));
+          c->seq[(ns % 2) * N_sf_0 * SRSLTE_PUCCH_N_SEQ + m * SRSLTE_PUCCH_N_SEQ + n] =
+              cexpf(I * (w_n_oc[N_sf_widx][n_oc % 3][m] + q->tmp_arg[n] + alpha * n + S_ns));
         }
       }
     }
   }
+  srslte_pucch_seq_key_set(&c->key, cfg, sf->shortened);
+  return c->seq;
+}
+
+static int encode_signal_format12(srslte_pucch_t*     q,
+                                  srslte_ul_sf_cfg_t* sf,
+                                  srslte_pucch_cfg_t* cfg,
+                                  uint8_t             bits[SRSLTE_PUCCH_MAX_BITS],
+                                  cf_t                z[SRSLTE_PUCCH_MAX_SYMBOLS],
+                                  bool                signal_only)
+{
+  if (!signal_only) {
+    if (uci_mod_bits(q, sf, cfg, bits)) {
+      ERROR("Error encoding PUCCH bits\n");
+      return SRSLTE_ERROR;
+    }
+  } else {
+    // Set all ones
+    for (uint32_t i = 0; i < SRSLTE_PUCCH_MAX_BITS / 2; i++) {
+      q->d[i] = 1.0f;
+    }
+  }
+  cf_t*    seq    = format12_seq(q, sf, cfg);
+  uint32_t N_sf_0 = get_N_sf(cfg->format, 0, sf->shortened);
+  for (uint32_t slot = 0; slot < SRSLTE_NOF_SLOTS_PER_SF; slot++) {
+    uint32_t N_sf = get_N_sf(cfg->format, slot, sf->shortened);
+    for (uint32_t m = 0; m < N_sf; m++) {
+      if (cfg->format >= SRSLTE_PUCCH_FORMAT_2) {
+        uint32_t k = (slot * N_sf + m) * SRSLTE_PUCCH_N_SEQ;
+        srslte_vec_sc_prod_ccc(&seq[k], q->d[slot * N_sf + m], &z[k], SRSLTE_PUCCH_N_SEQ);
+      } else {
+        uint32_t k = (slot * N_sf_0 + m) * SRSLTE_PUCCH_N_SEQ;
+        srslte_vec_sc_prod_ccc(&seq[k], q->d[0], &z[k], SRSLTE_PUCCH_N_SEQ);
+      }
+    }
+  }
   return SRSLTE_SUCCESS;
 }
 
@@ -713,6 +787,297 @@ static int encode_bits(srslte_pucch_cfg_t*   cfg,
   return SRSLTE_SUCCESS;
 }
 
+/* Decodes the CQI from the equalized format 2 symbols in q->z */
+static int decode_symbols_format2(srslte_pucch_t*     q,
+                                  srslte_ul_sf_cfg_t* sf,
+                                  srslte_pucch_cfg_t* cfg,
+                                  uint8_t             pucch_bits[SRSLTE_CQI_MAX_BITS],
+                                  uint32_t            nof_uci_bits,
+                                  float*              correlation)
+{
+  int16_t            llr_pucch2[SRSLTE_CQI_MAX_BITS];
+  srslte_sequence_t* seq = get_user_sequence(q, cfg->rnti, sf->tti % SRSLTE_NOF_SF_X_FRAME);
+  if (!seq) {
+    ERROR("Decoding PUCCH2: could not generate sequence\n");
+    return SRSLTE_ERROR;
+  }
+
+  srslte_demod_soft_demodulate_s(SRSLTE_MOD_QPSK, q->z, llr_pucch2, SRSLTE_PUCCH2_NOF_BITS / 2);
+  srslte_scrambling_s_offset(seq, llr_pucch2, 0, SRSLTE_PUCCH2_NOF_BITS);
+
+  // Calculate the LLR RMS for normalising
+  float llr_pow = srslte_vec_avg_power_sf(llr_pucch2, SRSLTE_PUCCH2_NOF_BITS);
+
+  if (isnormal(llr_pow)) {
+    float llr_rms = sqrtf(llr_pow) * SRSLTE_PUCCH2_NOF_BITS;
+    *correlation  = ((float)srslte_uci_decode_cqi_pucch(&q->cqi, llr_pucch2, pucch_bits, nof_uci_bits)) / (llr_rms);
+  } else {
+    *correlation = 0;
+  }
+  return SRSLTE_SUCCESS;
+}
+
+/* Symbols of a UE in the formats 1 and 2 taken from the despread RBs, without the orthogonal sequences */
+typedef struct {
+  cf_t     x[SRSLTE_NOF_SLOTS_PER_SF][SRSLTE_PUCCH2_N_SF]; // data
+  cf_t     r[SRSLTE_NOF_SLOTS_PER_SF][3];                  // DMRS
+  cf_t     h[SRSLTE_NOF_SLOTS_PER_SF];                     // channel estimate
+  uint32_t N_sf[SRSLTE_NOF_SLOTS_PER_SF];
+  uint32_t N_rs;
+} pucch_despread_t;
+
+/* Orthogonal sequence of length 4 never used by the format 1. It carries no signal in the RBs of the format 1, so the
+ * data symbols despread with it measure the noise */
+static const float pucch_w_noise[4] = {+1, +1, -1, -1};
+
+/* The noise is not taken below 40 dB under the power of the RB, so a resource without signal is not detected from the
+ * rounding errors of a noiseless input */
+static const float pucch_despread_noise_floor = 1e-4f;
+
+static uint32_t despread_bin(float alpha)
+{
+  return (uint32_t)lroundf(alpha * SRSLTE_NRE / (2 * M_PI)) % SRSLTE_NRE;
+}
+
+/* Returns the RB n_prb of the slot despread for all the cyclic shifts, see srslte_pucch_t */
+static const cf_t*
+despread_rb(srslte_pucch_t* q, uint32_t slot, uint32_t n_prb, uint32_t u, const cf_t* sf_symbols)
+{
+  cf_t* d = &q->despread[(slot * SRSLTE_MAX_PRB + n_prb) * SRSLTE_CP_NORM_NSYMB * SRSLTE_NRE];
+  if (q->despread_gen[slot][n_prb] == q->despread_count && q->despread_u[slot][n_prb] == u) {
+    return d;
+  }
+
+  uint32_t nsymb = SRSLTE_CP_NSYMB(q->cell.cp);
+  cf_t     tmp[SRSLTE_NRE];
+  for (uint32_t l = 0; l < nsymb; l++) {
+    srslte_vec_prod_ccc(&sf_symbols[SRSLTE_RE_IDX(q->cell.nof_prb, l + slot * nsymb, n_prb * SRSLTE_NRE)],
+                        q->despread_r_u[u],
+                        tmp,
+                        SRSLTE_NRE);
+    srslte_dft_run_c(&q->despread_dft, tmp, &d[l * SRSLTE_NRE]);
+  }
+  q->despread_gen[slot][n_prb] = q->despread_count;
+  q->despread_u[slot][n_prb]   = u;
+  return d;
+}
+
+/* Takes the symbols of the UE from the despread RBs and estimates the channel of every slot from the DMRS. The format
+ * 2a/2b bits of the DMRS are detected here. Returns the power of the channel estimate over the power of the channel
+ * estimate plus the noise of the 12 subcarriers of the RB */
+static float despread_format12(srslte_pucch_t*     q,
+                               srslte_ul_sf_cfg_t* sf,
+                               srslte_pucch_cfg_t* cfg,
+                               const cf_t*         sf_symbols,
+                               pucch_despread_t*   s)
+{
+  uint32_t sf_idx    = sf->tti % SRSLTE_NOF_SF_X_FRAME;
+  float    noise     = 0.0f;
+  uint32_t nof_noise = 0;
+  float    rb_power  = 0.0f;
+
+  if (sf->tti != q->despread_tti || sf_symbols != q->despread_input) {
+    srslte_pucch_despread_reset(q);
+    q->despread_tti   = sf->tti;
+    q->despread_input = sf_symbols;
+  }
+
+  s->N_rs = srslte_refsignal_dmrs_N_rs(cfg->format, q->cell.cp);
+  for (uint32_t slot = 0; slot < SRSLTE_NOF_SLOTS_PER_SF; slot++) {
+    uint32_t ns    = SRSLTE_NOF_SLOTS_PER_SF * sf_idx + slot;
+    uint32_t n_prb = srslte_pucch_n_prb(&q->cell, cfg, slot);
+    if (n_prb >= q->cell.nof_prb) {
+      ERROR("Invalid PUCCH n_prb=%d\n", n_prb);
+      return -1.0f;
+    }
+    uint32_t f_gh = 0;
+    if (cfg->group_hopping_en) {
+      f_gh = q->f_gh[ns];
+    }
+    uint32_t    u = (f_gh + (q->cell.id % 30)) % 30;
+    const cf_t* d = despread_rb(q, slot, n_prb, u, sf_symbols);
+
+    for (uint32_t m = 0; m < s->N_rs; m++) {
+      uint32_t l = srslte_refsignal_dmrs_pucch_symbol(m, cfg->format, q->cell.cp);
+      rb_power += srslte_vec_avg_power_cf(&d[l * SRSLTE_NRE], SRSLTE_NRE) / (SRSLTE_NOF_SLOTS_PER_SF * s->N_rs);
+      if (cfg->format < SRSLTE_PUCCH_FORMAT_2) {
+        uint32_t n_oc  = 0;
+        float    alpha = srslte_pucch_alpha_format1(q->n_cs_cell, cfg, q->cell.cp, true, ns, l, &n_oc, NULL);
+        float    w     = srslte_refsignal_dmrs_pucch_w_arg(cfg->format, q->cell.cp, n_oc, m);
+        s->r[slot][m]  = d[l * SRSLTE_NRE + despread_bin(alpha)] * cexpf(-I * w);
+      } else {
+        float alpha   = srslte_pucch_alpha_format2(q->n_cs_cell, cfg, ns, l);
+        s->r[slot][m] = d[l * SRSLTE_NRE + despread_bin(alpha)];
+      }
+    }
+
+    s->N_sf[slot]      = get_N_sf(cfg->format, slot, sf->shortened);
+    uint32_t N_sf_widx = s->N_sf[slot] == 3 ? 1 : 0;
+    for (uint32_t m = 0; m < s->N_sf[slot]; m++) {
+      uint32_t l = get_pucch_symbol(m, cfg->format, q->cell.cp);
+      if (cfg->format < SRSLTE_PUCCH_FORMAT_2) {
+        uint32_t n_oc       = 0;
+        uint32_t n_prime_ns = 0;
+        float    alpha = srslte_pucch_alpha_format1(q->n_cs_cell, cfg, q->cell.cp, true, ns, l, &n_oc, &n_prime_ns);
+        float    S_ns  = (n_prime_ns % 2) ? M_PI / 2 : 0;
+        s->x[slot][m]  = d[l * SRSLTE_NRE + despread_bin(alpha)] * cexpf(-I * (w_n_oc[N_sf_widx][n_oc % 3][m] + S_ns));
+      } else {
+        float alpha   = srslte_pucch_alpha_format2(q->n_cs_cell, cfg, ns, l);
+        s->x[slot][m] = d[l * SRSLTE_NRE + despread_bin(alpha)];
+      }
+    }
+
+    // The cyclic shift of every UE follows n_cs_cell, the offset j being the same in all the symbols of the slot
+    if (cfg->format < SRSLTE_PUCCH_FORMAT_2 && s->N_sf[slot] == 4) {
+      for (uint32_t j = 0; j < SRSLTE_NRE; j++) {
+        cf_t v = 0;
+        for (uint32_t m = 0; m < 4; m++) {
+          uint32_t l = get_pucch_symbol(m, cfg->format, q->cell.cp);
+          v += d[l * SRSLTE_NRE + (q->n_cs_cell[ns][l] + j) % SRSLTE_NRE] * pucch_w_noise[m];
+        }
+        noise += __real__(v * conjf(v)) / 4;
+        nof_noise++;
+      }
+    }
+  }
+
+  // Select the format 2a/2b bits of the second DMRS symbol with the strongest channel estimate
+  uint32_t nof_drs_hyp = 1;
+  if (cfg->format == SRSLTE_PUCCH_FORMAT_2A) {
+    nof_drs_hyp = 2;
+  } else if (cfg->format == SRSLTE_PUCCH_FORMAT_2B) {
+    nof_drs_hyp = 4;
+  }
+  float power_max = -1.0f;
+  for (uint32_t hyp = 0; hyp < nof_drs_hyp; hyp++) {
+    uint8_t b[2]  = {hyp / 2, hyp % 2};
+    cf_t    z_m_1 = 1.0f;
+    if (cfg->format == SRSLTE_PUCCH_FORMAT_2A) {
+      b[0] = hyp;
+      b[1] = 0;
+    }
+    if (nof_drs_hyp > 1) {
+      srslte_pucch_format2ab_mod_bits(cfg->format, b, &z_m_1);
+    }
+
+    cf_t  h[SRSLTE_NOF_SLOTS_PER_SF];
+    float power = 0.0f;
+    for (uint32_t slot = 0; slot < SRSLTE_NOF_SLOTS_PER_SF; slot++) {
+      h[slot] = 0;
+      for (uint32_t m = 0; m < s->N_rs; m++) {
+        h[slot] += s->r[slot][m] * (m == 1 ? conjf(z_m_1) : 1.0f);
+      }
+      h[slot] /= s->N_rs;
+      power += __real__(h[slot] * conjf(h[slot]));
+    }
+    if (power > power_max) {
+      power_max = power;
+      memcpy(s->h, h, sizeof(h));
+      if (nof_drs_hyp > 1) {
+        cfg->pucch2_drs_bits[0] = b[0];
+        cfg->pucch2_drs_bits[1] = b[1];
+      }
+    }
+  }
+
+  // Without other noise reference, the format 2 uses the difference between the two DMRS of the slot
+  if (nof_noise == 0 && s->N_rs == 2) {
+    for (uint32_t slot = 0; slot < SRSLTE_NOF_SLOTS_PER_SF; slot++) {
+      cf_t v = 2.0f * (s->r[slot][0] - s->h[slot]);
+      noise += __real__(v * conjf(v)) / 2;
+      nof_noise++;
+    }
+  }
+  if (nof_noise == 0) {
+    return 1.0f;
+  }
+  noise = SRSLTE_MAX(noise / nof_noise, pucch_despread_noise_floor * rb_power);
+  return power_max / (power_max + SRSLTE_NOF_SLOTS_PER_SF * SRSLTE_NRE * noise / s->N_rs);
+}
+
+/* Correlation of the despread data symbols with the UCI symbol d after maximum ratio combining of the slots */
+static float despread_corr_format1(cf_t acc, float norm, cf_t d)
+{
+  return isnormal(norm) ? __real__(conjf(d) * acc) / norm : 0.0f;
+}
+
+/* Detects the formats 1 and 2 from the despread symbols. Returns 1 if detected, 0 if not and -1 on error */
+static int decode_signal_despread(srslte_pucch_t*     q,
+                                   srslte_ul_sf_cfg_t* sf,
+                                   srslte_pucch_cfg_t* cfg,
+                                   pucch_despread_t*   s,
+                                   uint8_t             pucch_bits[SRSLTE_CQI_MAX_BITS],
+                                   uint32_t            nof_uci_bits,
+                                   float*              correlation)
+{
+  int   detected = 0;
+  float corr = 0, corr_max = -1e9;
+
+  if (cfg->format >= SRSLTE_PUCCH_FORMAT_2) {
+    // Zero forcing of every slot
+    for (uint32_t slot = 0; slot < SRSLTE_NOF_SLOTS_PER_SF; slot++) {
+      float h_pow = __real__(s->h[slot] * conjf(s->h[slot]));
+      for (uint32_t m = 0; m < SRSLTE_PUCCH2_N_SF; m++) {
+        q->z[slot * SRSLTE_PUCCH2_N_SF + m] = isnormal(h_pow) ? s->x[slot][m] * conjf(s->h[slot]) / h_pow : 0.0f;
+      }
+    }
+    if (decode_symbols_format2(q, sf, cfg, pucch_bits, nof_uci_bits, correlation)) {
+      return SRSLTE_ERROR;
+    }
+    return 1;
+  }
+
+  // All the format 1 hypotheses share the combined symbol
+  cf_t  acc   = 0;
+  float x_pow = 0, h_pow = 0;
+  for (uint32_t slot = 0; slot < SRSLTE_NOF_SLOTS_PER_SF; slot++) {
+    for (uint32_t m = 0; m < s->N_sf[slot]; m++) {
+      acc += s->x[slot][m] * conjf(s->h[slot]);
+      x_pow += __real__(s->x[slot][m] * conjf(s->x[slot][m]));
+    }
+    h_pow += s->N_sf[slot] * __real__(s->h[slot] * conjf(s->h[slot]));
+  }
+  float norm = sqrtf(x_pow * h_pow);
+
+  switch (cfg->format) {
+    case SRSLTE_PUCCH_FORMAT_1:
+      corr     = despread_corr_format1(acc, norm, uci_encode_format1());
+      detected = corr >= cfg->threshold_format1;
+      break;
+    case SRSLTE_PUCCH_FORMAT_1A:
+      for (uint8_t b = 0; b < 2; b++) {
+        corr = despread_corr_format1(acc, norm, uci_encode_format1a(b));
+        if (corr > corr_max) {
+          corr_max      = corr;
+          pucch_bits[0] = b;
+        }
+      }
+      corr     = corr_max;
+      detected = corr > cfg->threshold_format1; // check with format1 in case ack+sr because ack only is binary
+      break;
+    case SRSLTE_PUCCH_FORMAT_1B:
+      for (uint8_t b = 0; b < 4; b++) {
+        uint8_t bits[2] = {b / 2, b % 2};
+        corr            = despread_corr_format1(acc, norm, uci_encode_format1b(bits));
+        if (corr > corr_max) {
+          corr_max      = corr;
+          pucch_bits[0] = bits[0];
+          pucch_bits[1] = bits[1];
+        }
+      }
+      corr     = corr_max;
+      detected = corr > cfg->threshold_format1;
+      break;
+    default:
+      ERROR("PUCCH format %d not implemented\n", cfg->format);
+      return SRSLTE_ERROR;
+  }
+  DEBUG("format %s despread corr=%f\n", srslte_pucch_format_text_short(cfg->format), corr);
+
+  *correlation = corr;
+  return detected;
+}
+
 static bool decode_signal(srslte_pucch_t*     q,
                           srslte_ul_sf_cfg_t* sf,
                           srslte_pucch_cfg_t* cfg,
@@ -721,13 +1086,11 @@ static bool decode_signal(srslte_pucch_t*     q,
                           uint32_t            nof_uci_bits,
                           float*              correlation)
 {
-  int16_t llr_pucch2[SRSLTE_CQI_MAX_BITS];
   bool    detected = false;
   float   corr = 0, corr_max = -1e9;
   uint8_t b_max = 0, b2_max = 0; // default bit value, eg. HI is NACK
 
-  srslte_sequence_t* seq;
-  cf_t               ref[SRSLTE_PUCCH_MAX_SYMBOLS];
+  cf_t ref[SRSLTE_PUCCH_MAX_SYMBOLS];
 
   switch (cfg->format) {
     case SRSLTE_PUCCH_FORMAT_1:
@@ -782,30 +1145,15 @@ static bool decode_signal(srslte_pucch_t*     q,
     case SRSLTE_PUCCH_FORMAT_2:
     case SRSLTE_PUCCH_FORMAT_2A:
     case SRSLTE_PUCCH_FORMAT_2B:
-      seq = get_user_sequence(q, cfg->rnti, sf->tti % SRSLTE_NOF_SF_X_FRAME);
-      if (seq) {
-        encode_signal_format12(q, sf, cfg, NULL, ref, true);
-        srslte_vec_prod_conj_ccc(q->z, ref, q->z_tmp, SRSLTE_PUCCH_MAX_SYMBOLS);
-        for (int i = 0; i < (SRSLTE_PUCCH2_N_SF * SRSLTE_NOF_SLOTS_PER_SF); i++) {
-          q->z[i] = srslte_vec_acc_cc(&q->z_tmp[i * SRSLTE_NRE], SRSLTE_NRE) / SRSLTE_NRE;
-        }
-        srslte_demod_soft_demodulate_s(SRSLTE_MOD_QPSK, q->z, llr_pucch2, SRSLTE_PUCCH2_NOF_BITS / 2);
-        srslte_scrambling_s_offset(seq, llr_pucch2, 0, SRSLTE_PUCCH2_NOF_BITS);
-
-        // Calculate the LLR RMS for normalising
-        float llr_pow = srslte_vec_avg_power_sf(llr_pucch2, SRSLTE_PUCCH2_NOF_BITS);
-
-        if (isnormal(llr_pow)) {
-          float llr_rms = sqrtf(llr_pow) * SRSLTE_PUCCH2_NOF_BITS;
-          corr = ((float)srslte_uci_decode_cqi_pucch(&q->cqi, llr_pucch2, pucch_bits, nof_uci_bits)) / (llr_rms);
-        } else {
-          corr = 0;
-        }
-        detected = true;
-      } else {
-        ERROR("Decoding PUCCH2: could not generate sequence\n");
+      encode_signal_format12(q, sf, cfg, NULL, ref, true);
+      srslte_vec_prod_conj_ccc(q->z, ref, q->z_tmp, SRSLTE_PUCCH_MAX_SYMBOLS);
+      for (int i = 0; i < (SRSLTE_PUCCH2_N_SF * SRSLTE_NOF_SLOTS_PER_SF); i++) {
+        q->z[i] = srslte_vec_acc_cc(&q->z_tmp[i * SRSLTE_NRE], SRSLTE_NRE) / SRSLTE_NRE;
+      }
+      if (decode_symbols_format2(q, sf, cfg, pucch_bits, nof_uci_bits, &corr)) {
         return -1;
       }
+      detected = true;
       break;
     case SRSLTE_PUCCH_FORMAT_3:
       corr     = (float)decode_signal_format3(q, sf, cfg, pucch_bits, q->z) / 4800.0f;
@@ -905,27 +1253,40 @@ int srslte_pucch_decode(srslte_pucch_t*        q,
     uint32_t nof_cqi_bits = srslte_cqi_size(&cfg->uci_cfg.cqi);
     uint32_t nof_uci_bits = cfg->uci_cfg.cqi.ri_len ? cfg->uci_cfg.cqi.ri_len : nof_cqi_bits;
 
-    int nof_re = pucch_get(q, sf, cfg, sf_symbols, q->z_tmp);
-    if (nof_re < 0) {
-      ERROR("Error getting PUCCH symbols\n");
-      return SRSLTE_ERROR;
-    }
+    // The eNodeB detects the formats 1 and 2 in the RBs despread for all the UEs, without the channel estimate
+    bool             despread = !q->is_ue && cfg->format < SRSLTE_PUCCH_FORMAT_3;
+    pucch_despread_t s        = {};
+    int              nof_re   = 0;
+    if (despread) {
+      data->dmrs_correlation = despread_format12(q, sf, cfg, sf_symbols, &s);
+      if (data->dmrs_correlation < 0) {
+        return SRSLTE_ERROR;
+      }
+    } else {
+      nof_re = pucch_get(q, sf, cfg, sf_symbols, q->z_tmp);
+      if (nof_re < 0) {
+        ERROR("Error getting PUCCH symbols\n");
+        return SRSLTE_ERROR;
+      }
 
-    if (pucch_get(q, sf, cfg, channel->ce, q->ce) < 0) {
-      ERROR("Error getting PUCCH symbols\n");
-      return SRSLTE_ERROR;
-    }
+      if (pucch_get(q, sf, cfg, channel->ce, q->ce) < 0) {
+        ERROR("Error getting PUCCH symbols\n");
+        return SRSLTE_ERROR;
+      }
 
-    // Equalization
-    srslte_predecoding_single(q->z_tmp, q->ce, q->z, NULL, nof_re, 1.0f, channel->noise_estimate);
+      // Equalization
+      srslte_predecoding_single(q->z_tmp, q->ce, q->z, NULL, nof_re, 1.0f, channel->noise_estimate);
+
+      if (isnormal(cfg->threshold_dmrs_detection)) {
+        cf_t  _dmrs_corr       = srslte_vec_acc_cc(q->ce, SRSLTE_NRE) / SRSLTE_NRE;
+        float rms              = __real__(conjf(_dmrs_corr) * _dmrs_corr);
+        float power            = srslte_vec_avg_power_cf(q->ce, SRSLTE_NRE);
+        data->dmrs_correlation = rms / power;
+      }
+    }
 
     // Perform DMRS Detection, if enabled
     if (isnormal(cfg->threshold_dmrs_detection)) {
-      cf_t  _dmrs_corr       = srslte_vec_acc_cc(q->ce, SRSLTE_NRE) / SRSLTE_NRE;
-      float rms              = __real__(conjf(_dmrs_corr) * _dmrs_corr);
-      float power            = srslte_vec_avg_power_cf(q->ce, SRSLTE_NRE);
-      data->dmrs_correlation = rms / power;
-
       // Return not detected if the ratio is 0, NAN, +/- Infinity or below threshold
       if (!isnormal(data->dmrs_correlation) || data->dmrs_correlation < cfg->threshold_dmrs_detection) {
         data->correlation = 0.0f;
@@ -935,12 +1296,20 @@ int srslte_pucch_decode(srslte_pucch_t*        q,
     }
 
     // Perform ML-decoding
-    bool pucch_found = decode_signal(q, sf, cfg, pucch_bits, nof_re, nof_uci_bits, &data->correlation);
+    int pucch_found = 0;
+    if (despread) {
+      pucch_found = decode_signal_despread(q, sf, cfg, &s, pucch_bits, nof_uci_bits, &data->correlation);
+      if (pucch_found < SRSLTE_SUCCESS) {
+        return SRSLTE_ERROR;
+      }
+    } else {
+      pucch_found = decode_signal(q, sf, cfg, pucch_bits, nof_re, nof_uci_bits, &data->correlation);
+    }
 
     // Convert bits to UCI data
-    decode_bits(cfg, pucch_found, pucch_bits, cfg->pucch2_drs_bits, &data->uci_data);
+    decode_bits(cfg, pucch_found > 0, pucch_bits, cfg->pucch2_drs_bits, &data->uci_data);
 
-    data->detected = pucch_found;
+    data->detected = pucch_found > 0;
 
     // Accept ACK and CQI only if correlation above threshold
     switch (cfg->format) {
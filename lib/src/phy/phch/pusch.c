@@ -259,46 +259,33 @@ int srslte_pusch_set_cell(srslte_pusch_t* q, srslte_cell_t cell)
   return ret;
 }
 
-/* Precalculate the PUSCH scramble sequences for a given RNTI. This function takes a while
- * to execute, so shall be called once the final C-RNTI has been allocated for the session.
+static void pusch_user_reset(srslte_pusch_user_t* user, uint32_t cell_id)
+{
+  for (int sf_idx = 0; sf_idx < SRSLTE_NOF_SF_X_FRAME; sf_idx++) {
+    user->seq[sf_idx].cur_len = 0;
+  }
+  user->cell_id = cell_id;
+}
+
+/* Registers an RNTI. The scrambling sequences are only generated once the RNTI is scheduled, see get_user_sequence(),
+ * so the RNTIs that are never scheduled in a subframe take no memory for it.
  * For the connection procedure, use srslte_pusch_encode() functions */
 int srslte_pusch_set_rnti(srslte_pusch_t* q, uint16_t rnti)
 {
   uint32_t rnti_idx = q->is_ue ? 0 : rnti;
 
-  // Decide whether re-generating the sequence
   if (!q->users[rnti_idx]) {
-    // If the sequence is not allocated generate
-    q->users[rnti_idx] = calloc(1, sizeof(srslte_pdsch_user_t));
+    q->users[rnti_idx] = calloc(1, sizeof(srslte_pusch_user_t));
     if (!q->users[rnti_idx]) {
-      ERROR("Alocating PDSCH user\n");
-      return SRSLTE_ERROR;
-    }
-  } else if (q->users[rnti_idx]->sequence_generated && q->users[rnti_idx]->cell_id == q->cell.id && !q->is_ue) {
-    // The sequence was generated, cell has not changed and it is eNb, save any efforts
-    return SRSLTE_SUCCESS;
-  }
-
-  // Set sequence as not generated
-  q->users[rnti_idx]->sequence_generated = false;
-
-  // For each subframe
-  for (int sf_idx = 0; sf_idx < SRSLTE_NOF_SF_X_FRAME; sf_idx++) {
-    if (srslte_sequence_pusch(&q->users[rnti_idx]->seq[sf_idx],
-                              rnti,
-                              SRSLTE_NOF_SLOTS_PER_SF * sf_idx,
-                              q->cell.id,
-                              q->max_re * srslte_mod_bits_x_symbol(SRSLTE_MOD_64QAM))) {
-      ERROR("Error initializing PUSCH scrambling sequence\n");
-      srslte_pusch_free_rnti(q, rnti);
+      ERROR("Alocating PUSCH user\n");
       return SRSLTE_ERROR;
     }
+  } else if ((q->is_ue && q->ue_rnti != rnti) || q->users[rnti_idx]->cell_id != q->cell.id) {
+    // The buffers of the sequences of the previous C-RNTI or cell are kept, the sequences are generated again
+    pusch_user_reset(q->users[rnti_idx], q->cell.id);
   }
-
-  // Save generation states
-  q->ue_rnti                             = rnti;
-  q->users[rnti_idx]->cell_id            = q->cell.id;
-  q->users[rnti_idx]->sequence_generated = true;
+  q->users[rnti_idx]->cell_id = q->cell.id;
+  q->ue_rnti                  = rnti;
 
   return SRSLTE_SUCCESS;
 }
@@ -323,17 +310,27 @@ static srslte_sequence_t* get_user_sequence(srslte_pusch_t* q, uint16_t rnti, ui
   uint32_t rnti_idx = q->is_ue ? 0 : rnti;
 
   if (SRSLTE_RNTI_ISUSER(rnti)) {
-    // The scrambling sequence is pregenerated for all RNTIs in the eNodeB but only for C-RNTI in the UE
-    if (q->users[rnti_idx] && q->users[rnti_idx]->sequence_generated && q->users[rnti_idx]->cell_id == q->cell.id &&
-        (!q->is_ue || q->ue_rnti == rnti)) {
-      return &q->users[rnti_idx]->seq[sf_idx];
-    } else {
-      if (srslte_sequence_pusch(&q->tmp_seq, rnti, 2 * sf_idx, q->cell.id, len)) {
-        ERROR("Error generating temporal scrambling sequence\n");
-        return NULL;
+    // The scrambling sequence is kept for all the registered RNTIs in the eNodeB but only for C-RNTI in the UE
+    srslte_pusch_user_t* user = q->users[rnti_idx];
+    if (user && (!q->is_ue || q->ue_rnti == rnti)) {
+      if (user->cell_id != q->cell.id) {
+        pusch_user_reset(user, q->cell.id);
+      }
+      srslte_sequence_t* seq = &user->seq[sf_idx];
+      if (seq->cur_len >= len) {
+        return seq;
       }
-      return &q->tmp_seq;
+      // The first len bits don't depend on the length of the sequence, so it is only generated again for larger TBs
+      if (srslte_sequence_pusch(seq, rnti, SRSLTE_NOF_SLOTS_PER_SF * sf_idx, q->cell.id, len) == SRSLTE_SUCCESS) {
+        return seq;
+      }
+      seq->cur_len = 0;
+    }
+    if (srslte_sequence_pusch(&q->tmp_seq, rnti, 2 * sf_idx, q->cell.id, len)) {
+      ERROR("Error generating temporal scrambling sequence\n");
+      return NULL;
     }
+    return &q->tmp_seq;
   } else {
     ERROR("Invalid RNTI=0x%x\n", rnti);
     return NULL;
@@ -525,37 +522,39 @@ int srslte_pusch_decode(srslte_pusch_t*        q,
     // DFT predecoding
     srslte_dft_precoding(&q->dft_precoding, q->z, q->d, cfg->grant.L_prb, cfg->grant.nof_symb);
 
-    // Soft demodulation
-    if (q->llr_is_8bit) {
-      srslte_demod_soft_demodulate_b(cfg->grant.tb.mod, q->d, q->q, cfg->grant.nof_re);
-    } else {
-      srslte_demod_soft_demodulate_s(cfg->grant.tb.mod, q->d, q->q, cfg->grant.nof_re);
+    // Generate scrambling sequence if not pre-generated
+    srslte_sequence_t* seq = get_user_sequence(q, cfg->rnti, sf->tti % 10, cfg->grant.tb.nof_bits);
+    if (!seq) {
+      ERROR("Error getting user sequence for rnti=0x%x\n", cfg->rnti);
+      return -1;
     }
 
     if (cfg->meas_evm_en && q->evm_buffer) {
+      // Soft demodulation, the EVM is measured before descrambling
       if (q->llr_is_8bit) {
+        srslte_demod_soft_demodulate_b(cfg->grant.tb.mod, q->d, q->q, cfg->grant.nof_re);
         out->evm = srslte_evm_run_b(q->evm_buffer, &q->mod[cfg->grant.tb.mod], q->d, q->q, cfg->grant.tb.nof_bits);
+        srslte_scrambling_sb_offset(seq, q->q, 0, cfg->grant.tb.nof_bits);
       } else {
+        srslte_demod_soft_demodulate_s(cfg->grant.tb.mod, q->d, q->q, cfg->grant.nof_re);
         out->evm = srslte_evm_run_s(q->evm_buffer, &q->mod[cfg->grant.tb.mod], q->d, q->q, cfg->grant.tb.nof_bits);
+        srslte_scrambling_s_offset(seq, q->q, 0, cfg->grant.tb.nof_bits);
       }
     } else {
+      // Soft demodulation and descrambling in a single pass
+      int demod_ret;
+      if (q->llr_is_8bit) {
+        demod_ret = srslte_demod_soft_demodulate_b_scrambled(cfg->grant.tb.mod, q->d, q->q, cfg->grant.nof_re, seq);
+      } else {
+        demod_ret = srslte_demod_soft_demodulate_s_scrambled(cfg->grant.tb.mod, q->d, q->q, cfg->grant.nof_re, seq);
+      }
+      if (demod_ret) {
+        ERROR("Error demodulating PUSCH\n");
+        return -1;
+      }
       out->evm = NAN;
     }
 
-    // Generate scrambling sequence if not pre-generated
-    srslte_sequence_t* seq = get_user_sequence(q, cfg->rnti, sf->tti % 10, cfg->grant.tb.nof_bits);
-    if (!seq) {
-      ERROR("Error getting user sequence for rnti=0x%x\n", cfg->rnti);
-      return -1;
-    }
-
-    // Descrambling
-    if (q->llr_is_8bit) {
-      srslte_scrambling_sb_offset(seq, q->q, 0, cfg->grant.tb.nof_bits);
-    } else {
-      srslte_scrambling_s_offset(seq, q->q, 0, cfg->grant.tb.nof_bits);
-    }
-
     // Set max number of iterations
     srslte_sch_set_max_noi(&q->ul_sch, cfg->max_nof_iterations);
 
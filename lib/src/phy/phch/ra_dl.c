@@ -131,9 +131,14 @@ static uint32_t ra_re_x_prb(const srslte_cell_t* cell, srslte_dl_sf_cfg_t* sf, u
   // remove references
   if (skip_refs) {
     if (sf->sf_type == SRSLTE_SF_NORM) {
+      // With extended CP and 4 control symbols, the second reference symbol of slot 0 is in the control region
+      bool ref_in_ctrl = (slot == 0 && nof_ctrl_symbols > SRSLTE_CP_NSYMB(cp_) - 3);
       switch (cell->nof_ports) {
         case 1:
         case 2:
+          if (ref_in_ctrl) {
+            break;
+          }
           if ((cp_ == SRSLTE_CP_NORM && nof_symbols >= 5) || (cp_ == SRSLTE_CP_EXT && nof_symbols >= 4)) {
             re -= 2 * (slot + 1) * cell->nof_ports;
           } else if (slot == 1) {
@@ -149,7 +154,7 @@ static uint32_t ra_re_x_prb(const srslte_cell_t* cell, srslte_dl_sf_cfg_t* sf, u
             } else if (nof_symbols >= 2) {
               re -= 8;
             }
-          } else {
+          } else if (!ref_in_ctrl) {
             if ((cp_ == SRSLTE_CP_NORM && nof_symbols >= 5) || (cp_ == SRSLTE_CP_EXT && nof_symbols >= 4)) {
               re -= 4;
               if (nof_ctrl_symbols == 1) {
@@ -27,17 +27,11 @@
 #include "srslte/phy/common/phy_common.h"
 #include "srslte/phy/phch/regs.h"
 #include "srslte/phy/utils/debug.h"
+#include "srslte/phy/utils/vector.h"
 
 #define REG_IDX(r, i, n) r->k[i] + r->l* n* SRSLTE_NRE
 
 srslte_regs_reg_t* regs_find_reg(srslte_regs_t* h, uint32_t k, uint32_t l);
-int                regs_put_reg(srslte_regs_reg_t* reg, cf_t* reg_data, cf_t* slot_symbols, uint32_t nof_prb);
-
-int regs_add_reg(srslte_regs_reg_t* reg, cf_t* reg_data, cf_t* slot_symbols, uint32_t nof_prb);
-
-int regs_get_reg(srslte_regs_reg_t* reg, cf_t* slot_symbols, cf_t* reg_data, uint32_t nof_prb);
-
-int regs_reset_reg(srslte_regs_reg_t* reg, cf_t* slot_symbols, uint32_t nof_prb);
 
 /***************************************************************
  *
@@ -53,6 +47,10 @@ void regs_pdcch_free(srslte_regs_t* h)
       free(h->pdcch[i].regs);
       h->pdcch[i].regs = NULL;
     }
+    if (h->pdcch[i].re_idx) {
+      free(h->pdcch[i].re_idx);
+      h->pdcch[i].re_idx = NULL;
+    }
   }
 }
 
@@ -181,12 +179,8 @@ int srslte_regs_pdcch_put_offset(srslte_regs_t* h,
     return SRSLTE_ERROR;
   }
   if (start_reg + nof_regs <= h->pdcch[cfi - 1].nof_regs) {
-    uint32_t i, k;
-    k = 0;
-    for (i = start_reg; i < start_reg + nof_regs; i++) {
-      regs_put_reg(h->pdcch[cfi - 1].regs[i], &d[k], slot_symbols, h->cell.nof_prb);
-      k += 4;
-    }
+    uint32_t k = nof_regs * REGS_RE_X_REG;
+    srslte_vec_scatter_cf(d, &h->pdcch[cfi - 1].re_idx[start_reg * REGS_RE_X_REG], slot_symbols, k);
     return k;
   } else {
     ERROR("Out of range: start_reg + nof_reg must be lower than %d\n", h->pdcch[cfi - 1].nof_regs);
@@ -215,12 +209,8 @@ int srslte_regs_pdcch_get_offset(srslte_regs_t* h,
     return SRSLTE_ERROR;
   }
   if (start_reg + nof_regs <= h->pdcch[cfi - 1].nof_regs) {
-    uint32_t i, k;
-    k = 0;
-    for (i = start_reg; i < start_reg + nof_regs; i++) {
-      regs_get_reg(h->pdcch[cfi - 1].regs[i], slot_symbols, &d[k], h->cell.nof_prb);
-      k += 4;
-    }
+    uint32_t k = nof_regs * REGS_RE_X_REG;
+    srslte_vec_gather_cf(slot_symbols, &h->pdcch[cfi - 1].re_idx[start_reg * REGS_RE_X_REG], d, k);
     return k;
   } else {
     ERROR("Out of range: start_reg + nof_reg must be lower than %d\n", h->pdcch[cfi - 1].nof_regs);
@@ -276,7 +266,7 @@ int regs_phich_init(srslte_regs_t* h, uint32_t phich_mi, bool mbsfn_or_sf1_6_tdd
   }
   h->ngroups_phich_m1 = (int)ceilf(ng * ((float)h->cell.nof_prb / 8));
   h->ngroups_phich    = (int)phich_mi * h->ngroups_phich_m1;
-  h->phich            = malloc(sizeof(srslte_regs_ch_t) * h->ngroups_phich);
+  h->phich            = calloc(h->ngroups_phich, sizeof(srslte_regs_ch_t));
   if (!h->phich) {
     perror("malloc");
     return -1;
@@ -384,6 +374,10 @@ void regs_phich_free(srslte_regs_t* h)
         free(h->phich[i].regs);
         h->phich[i].regs = NULL;
       }
+      if (h->phich[i].re_idx) {
+        free(h->phich[i].re_idx);
+        h->phich[i].re_idx = NULL;
+      }
     }
     free(h->phich);
     h->phich = NULL;
@@ -429,10 +423,10 @@ int srslte_regs_phich_add(srslte_regs_t* h, cf_t symbols[REGS_PHICH_NSYM], uint3
     ngroup /= 2;
   }
   srslte_regs_ch_t* rch = &h->phich[ngroup];
-  for (i = 0; i < rch->nof_regs && i * REGS_RE_X_REG < REGS_PHICH_NSYM; i++) {
-    regs_add_reg(rch->regs[i], &symbols[i * REGS_RE_X_REG], slot_symbols, h->cell.nof_prb);
+  for (i = 0; i < rch->nof_regs * REGS_RE_X_REG && i < REGS_PHICH_NSYM; i++) {
+    slot_symbols[rch->re_idx[i]] += symbols[i];
   }
-  return i * REGS_RE_X_REG;
+  return i;
 }
 
 /**
@@ -451,8 +445,8 @@ int srslte_regs_phich_reset(srslte_regs_t* h, cf_t* slot_symbols)
       ng = ngroup;
     }
     srslte_regs_ch_t* rch = &h->phich[ng];
-    for (i = 0; i < rch->nof_regs && i * REGS_RE_X_REG < REGS_PHICH_NSYM; i++) {
-      regs_reset_reg(rch->regs[i], slot_symbols, h->cell.nof_prb);
+    for (i = 0; i < rch->nof_regs * REGS_RE_X_REG && i < REGS_PHICH_NSYM; i++) {
+      slot_symbols[rch->re_idx[i]] = 0;
     }
   }
   return SRSLTE_SUCCESS;
@@ -465,7 +459,6 @@ int srslte_regs_phich_reset(srslte_regs_t* h, cf_t* slot_symbols)
  */
 int srslte_regs_phich_get(srslte_regs_t* h, cf_t* slot_symbols, cf_t symbols[REGS_PHICH_NSYM], uint32_t ngroup)
 {
-  uint32_t i;
   if (ngroup >= h->ngroups_phich) {
     ERROR("Error invalid ngroup %d\n", ngroup);
     return SRSLTE_ERROR_INVALID_INPUTS;
@@ -474,10 +467,9 @@ int srslte_regs_phich_get(srslte_regs_t* h, cf_t* slot_symbols, cf_t symbols[REG
     ngroup /= 2;
   }
   srslte_regs_ch_t* rch = &h->phich[ngroup];
-  for (i = 0; i < rch->nof_regs && i * REGS_RE_X_REG < REGS_PHICH_NSYM; i++) {
-    regs_get_reg(rch->regs[i], slot_symbols, &symbols[i * REGS_RE_X_REG], h->cell.nof_prb);
-  }
-  return i * REGS_RE_X_REG;
+  uint32_t          n   = SRSLTE_MIN(rch->nof_regs * REGS_RE_X_REG, REGS_PHICH_NSYM);
+  srslte_vec_gather_cf(slot_symbols, rch->re_idx, symbols, n);
+  return n;
 }
 
 /***************************************************************
@@ -529,6 +521,10 @@ void regs_pcfich_free(srslte_regs_t* h)
     free(h->pcfich.regs);
     h->pcfich.regs = NULL;
   }
+  if (h->pcfich.re_idx) {
+    free(h->pcfich.re_idx);
+    h->pcfich.re_idx = NULL;
+  }
 }
 
 uint32_t srslte_regs_pcfich_nregs(srslte_regs_t* h)
@@ -544,12 +540,9 @@ uint32_t srslte_regs_pcfich_nregs(srslte_regs_t* h)
 int srslte_regs_pcfich_put(srslte_regs_t* h, cf_t symbols[REGS_PCFICH_NSYM], cf_t* slot_symbols)
 {
   srslte_regs_ch_t* rch = &h->pcfich;
-
-  uint32_t i;
-  for (i = 0; i < rch->nof_regs && i * REGS_RE_X_REG < REGS_PCFICH_NSYM; i++) {
-    regs_put_reg(rch->regs[i], &symbols[i * REGS_RE_X_REG], slot_symbols, h->cell.nof_prb);
-  }
-  return i * REGS_RE_X_REG;
+  uint32_t          n   = SRSLTE_MIN(rch->nof_regs * REGS_RE_X_REG, REGS_PCFICH_NSYM);
+  srslte_vec_scatter_cf(symbols, rch->re_idx, slot_symbols, n);
+  return n;
 }
 
 /**
@@ -560,11 +553,9 @@ int srslte_regs_pcfich_put(srslte_regs_t* h, cf_t symbols[REGS_PCFICH_NSYM], cf_
 int srslte_regs_pcfich_get(srslte_regs_t* h, cf_t* slot_symbols, cf_t ch_data[REGS_PCFICH_NSYM])
 {
   srslte_regs_ch_t* rch = &h->pcfich;
-  uint32_t          i;
-  for (i = 0; i < rch->nof_regs && i * REGS_RE_X_REG < REGS_PCFICH_NSYM; i++) {
-    regs_get_reg(rch->regs[i], slot_symbols, &ch_data[i * REGS_RE_X_REG], h->cell.nof_prb);
-  }
-  return i * REGS_RE_X_REG;
+  uint32_t          n   = SRSLTE_MIN(rch->nof_regs * REGS_RE_X_REG, REGS_PCFICH_NSYM);
+  srslte_vec_gather_cf(slot_symbols, rch->re_idx, ch_data, n);
+  return n;
 }
 
 /***************************************************************
@@ -584,6 +575,25 @@ srslte_regs_reg_t* regs_find_reg(srslte_regs_t* h, uint32_t k, uint32_t l)
   return NULL;
 }
 
+/**
+ * Computes the subframe index of every RE of the channel REGs, so that the channel can be mapped with a single
+ * scatter or gather instead of going through the REG descriptors every subframe
+ */
+static int regs_ch_gen_re_idx(srslte_regs_t* h, srslte_regs_ch_t* ch)
+{
+  ch->re_idx = srslte_vec_u32_malloc(SRSLTE_MAX(ch->nof_regs * REGS_RE_X_REG, 1));
+  if (!ch->re_idx) {
+    perror("malloc");
+    return SRSLTE_ERROR;
+  }
+  for (uint32_t i = 0; i < ch->nof_regs; i++) {
+    for (uint32_t j = 0; j < REGS_RE_X_REG; j++) {
+      ch->re_idx[i * REGS_RE_X_REG + j] = REG_IDX(ch->regs[i], j, h->cell.nof_prb);
+    }
+  }
+  return SRSLTE_SUCCESS;
+}
+
 /**
  * Returns the number of REGs in a PRB
  * 36.211 Section 6.2.4
@@ -771,6 +781,21 @@ int srslte_regs_init_opts(srslte_regs_t* h, srslte_cell_t cell, uint32_t phich_m
       goto clean_and_exit;
     }
 
+    /* Build the RE tables of all the channels, for every CFI */
+    if (regs_ch_gen_re_idx(h, &h->pcfich)) {
+      goto clean_and_exit;
+    }
+    for (i = 0; h->phich && i < (SRSLTE_CP_ISEXT(h->cell.cp) ? h->ngroups_phich / 2 : h->ngroups_phich); i++) {
+      if (regs_ch_gen_re_idx(h, &h->phich[i])) {
+        goto clean_and_exit;
+      }
+    }
+    for (i = 0; i < 3; i++) {
+      if (regs_ch_gen_re_idx(h, &h->pdcch[i])) {
+        goto clean_and_exit;
+      }
+    }
+
     ret = SRSLTE_SUCCESS;
   }
 clean_and_exit:
@@ -781,52 +806,3 @@ clean_and_exit:
   }
   return ret;
 }
-
-/**
- * Puts one REG data (4 symbols) in the slot symbols array
- */
-int regs_put_reg(srslte_regs_reg_t* reg, cf_t* reg_data, cf_t* slot_symbols, uint32_t nof_prb)
-{
-  uint32_t i;
-  for (i = 0; i < REGS_RE_X_REG; i++) {
-    slot_symbols[REG_IDX(reg, i, nof_prb)] = reg_data[i];
-  }
-  return REGS_RE_X_REG;
-}
-
-/**
- * Adds one REG data (4 symbols) in the slot symbols array
- * Used by PHICH
- */
-int regs_add_reg(srslte_regs_reg_t* reg, cf_t* reg_data, cf_t* slot_symbols, uint32_t nof_prb)
-{
-  uint32_t i;
-  for (i = 0; i < REGS_RE_X_REG; i++) {
-    slot_symbols[REG_IDX(reg, i, nof_prb)] += reg_data[i];
-  }
-  return REGS_RE_X_REG;
-}
-
-/**
- * Reset REG data (4 symbols) in the slot symbols array
- */
-int regs_reset_reg(srslte_regs_reg_t* reg, cf_t* slot_symbols, uint32_t nof_prb)
-{
-  uint32_t i;
-  for (i = 0; i < REGS_RE_X_REG; i++) {
-    slot_symbols[REG_IDX(reg, i, nof_prb)] = 0;
-  }
-  return REGS_RE_X_REG;
-}
-
-/**
- * Gets one REG data (4 symbols) from the slot symbols array
- */
-int regs_get_reg(srslte_regs_reg_t* reg, cf_t* slot_symbols, cf_t* reg_data, uint32_t nof_prb)
-{
-  uint32_t i;
-  for (i = 0; i < REGS_RE_X_REG; i++) {
-    reg_data[i] = slot_symbols[REG_IDX(reg, i, nof_prb)];
-  }
-  return REGS_RE_X_REG;
-}
@@ -31,9 +31,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <sys/time.h>
 
 #define SRSLTE_PDSCH_MAX_TDEC_ITERS 10
 
+/* Bytes following the data of a CB in its systematic bits: 24-bit CB CRC and the tail bits */
+#define SCH_CB_TAIL_BYTES 4
+
 #ifdef LV_HAVE_SSE
 #include <immintrin.h>
 #endif /* LV_HAVE_SSE */
@@ -294,13 +298,18 @@ static int encode_tb_off(srslte_sch_t*           q,
 
       INFO("CB#%d: cb_len: %d, rlen: %d, wp: %d, rp: %d, E: %d\n", i, cb_len, rlen, wp, rp, n_e);
 
+      /* Systematic bits of the CB, the CB CRC and the tail bits are in cb_tail when read from the TB buffer */
+      uint8_t* cb_in = q->cb_in;
+      uint8_t  cb_tail[SCH_CB_TAIL_BYTES];
+      bool     from_tb = false;
+
       if (data) {
         bool last_cb = false;
 
-        /* Copy data to another buffer, making space for the Codeblock CRC */
         if (i < cb_segm->C - 1) {
-          // Copy data
-          memcpy(q->cb_in, &data[rp / 8], rlen * sizeof(uint8_t) / 8);
+          /* Encode the CB from the TB buffer without writing into it */
+          cb_in   = &data[rp / 8];
+          from_tb = true;
         } else {
           INFO("Last CB, appending parity: %d from %d and 24 to %d\n", rlen - 24, rp, rlen - 24);
 
@@ -312,25 +321,31 @@ static int encode_tb_off(srslte_sch_t*           q,
         /* Turbo Encoding
          * If Codeblock CRC is required it is given the CRC instance pointer, otherwise CRC pointer shall be NULL
          */
-        srslte_tcod_encode_lut(&q->encoder,
-                               &q->crc_tb,
-                               (cb_segm->C > 1) ? &q->crc_cb : NULL,
-                               q->cb_in,
-                               q->parity_bits,
-                               cblen_idx,
-                               last_cb);
+        if (from_tb) {
+          srslte_tcod_encode_lut_cb(&q->encoder, &q->crc_tb, &q->crc_cb, cb_in, cb_tail, q->parity_bits, cblen_idx);
+        } else {
+          srslte_tcod_encode_lut(&q->encoder,
+                                 &q->crc_tb,
+                                 (cb_segm->C > 1) ? &q->crc_cb : NULL,
+                                 q->cb_in,
+                                 q->parity_bits,
+                                 cblen_idx,
+                                 last_cb);
+        }
       }
       DEBUG("RM cblen_idx=%d, n_e=%d, wp=%d, nof_e_bits=%d\n", cblen_idx, n_e, wp, nof_e_bits);
 
       /* Rate matching */
-      if (srslte_rm_turbo_tx_lut(softbuffer->buffer_b[i],
-                                 q->cb_in,
-                                 q->parity_bits,
-                                 &e_bits[(wp + w_offset) / 8],
-                                 cblen_idx,
-                                 n_e,
-                                 (wp + w_offset) % 8,
-                                 rv)) {
+      if (srslte_rm_turbo_tx_lut_split(softbuffer->buffer_b[i],
+                                       cb_in,
+                                       from_tb ? cb_tail : NULL,
+                                       rlen,
+                                       q->parity_bits,
+                                       &e_bits[(wp + w_offset) / 8],
+                                       cblen_idx,
+                                       n_e,
+                                       (wp + w_offset) % 8,
+                                       rv)) {
         ERROR("Error in rate matching\n");
         return SRSLTE_ERROR;
       }
@@ -360,6 +375,519 @@ static int encode_tb(srslte_sch_t*           q,
   return encode_tb_off(q, soft_buffer, cb_segm, Qm, rv, nof_e_bits, data, e_bits, 0);
 }
 
+/* Arguments of the transport block being decoded, shared by all the threads decoding its codeblocks */
+typedef struct {
+  srslte_sch_t*           q;
+  srslte_softbuffer_rx_t* softbuffer;
+  srslte_cbsegm_t*        cb_segm;
+  uint32_t                Qm;
+  uint32_t                rv;
+  uint32_t                nof_e_bits;
+  void*                   e_bits;
+  uint8_t*                data;
+  uint32_t                cb_list[SRSLTE_MAX_CODEBLOCKS];
+  uint32_t                cb_noi[SRSLTE_MAX_CODEBLOCKS];
+  bool                    error;
+
+  // Protected by the pool mutex
+  uint32_t next_task;
+  uint32_t nof_tasks;
+  uint32_t nof_pending;
+} sch_cb_job_t;
+
+/* De-rate matches codeblock cb_idx into the softbuffer. Returns its soft bits, or NULL if the rate matching fails */
+static void* decode_cb_rm(srslte_sch_t*           q,
+                          srslte_softbuffer_rx_t* softbuffer,
+                          srslte_cbsegm_t*        cb_segm,
+                          uint32_t                Qm,
+                          uint32_t                rv,
+                          uint32_t                nof_e_bits,
+                          void*                   e_bits,
+                          uint32_t                cb_idx)
+{
+  int8_t*  e_bits_b = e_bits;
+  int16_t* e_bits_s = e_bits;
+
+  uint32_t cb_len_idx = cb_idx < cb_segm->C1 ? cb_segm->K1_idx : cb_segm->K2_idx;
+
+  uint32_t Gp    = nof_e_bits / Qm;
+  uint32_t gamma = cb_segm->C > 0 ? Gp % cb_segm->C : Gp;
+  uint32_t n_e   = Qm * (Gp / cb_segm->C);
+
+  uint32_t rp   = cb_idx * n_e;
+  uint32_t n_e2 = n_e;
+
+  if (cb_idx > cb_segm->C - gamma) {
+    n_e2 = n_e + Qm;
+    rp   = (cb_segm->C - gamma) * n_e + (cb_idx - (cb_segm->C - gamma)) * n_e2;
+  }
+
+  // The soft bits of the codeblock are allocated the first time it is decoded
+  int8_t*  soft_b = q->llr_is_8bit ? srslte_softbuffer_rx_get_cb_8bit(softbuffer, cb_idx) : NULL;
+  int16_t* soft_s = q->llr_is_8bit ? NULL : srslte_softbuffer_rx_get_cb(softbuffer, cb_idx);
+  if (soft_b == NULL && soft_s == NULL) {
+    ERROR("Error getting the soft bits of CB %d (%s-bit softbuffer, %s-bit decoder)\n",
+          cb_idx,
+          softbuffer->is_8bit ? "8" : "16",
+          q->llr_is_8bit ? "8" : "16");
+    return NULL;
+  }
+
+  if (q->llr_is_8bit) {
+    if (srslte_rm_turbo_rx_lut_8bit(&e_bits_b[rp], soft_b, n_e2, cb_len_idx, rv)) {
+      ERROR("Error in rate matching\n");
+      return NULL;
+    }
+    return soft_b;
+  }
+  if (srslte_rm_turbo_rx_lut(&e_bits_s[rp], soft_s, n_e2, cb_len_idx, rv)) {
+    ERROR("Error in rate matching\n");
+    return NULL;
+  }
+  return soft_s;
+}
+
+/* CRC checked by the turbo decoder: the codeblock CRC, or the transport block CRC if there is a single codeblock */
+static srslte_crc_t* decode_cb_crc(srslte_crc_t*    crc_tb,
+                                   srslte_crc_t*    crc_cb,
+                                   srslte_cbsegm_t* cb_segm,
+                                   uint32_t         cb_len,
+                                   uint32_t*        len_crc)
+{
+  if (cb_segm->C > 1) {
+    *len_crc = cb_len;
+    return crc_cb;
+  }
+  *len_crc = cb_segm->tbs + 24;
+  return crc_tb;
+}
+
+/* De-rate matches and decodes a single codeblock. The decided bits, including the codeblock CRC, are written to
+ * cb_data. Returns SRSLTE_ERROR if the rate matching fails */
+static int decode_cb(srslte_sch_t*           q,
+                     srslte_tdec_t*          decoder,
+                     srslte_crc_t*           crc_tb,
+                     srslte_crc_t*           crc_cb,
+                     srslte_softbuffer_rx_t* softbuffer,
+                     srslte_cbsegm_t*        cb_segm,
+                     uint32_t                Qm,
+                     uint32_t                rv,
+                     uint32_t                nof_e_bits,
+                     void*                   e_bits,
+                     uint32_t                cb_idx,
+                     uint8_t*                cb_data,
+                     uint32_t*               noi)
+{
+  uint32_t cb_len = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
+
+  void* soft = decode_cb_rm(q, softbuffer, cb_segm, Qm, rv, nof_e_bits, e_bits, cb_idx);
+  if (soft == NULL) {
+    return SRSLTE_ERROR;
+  }
+
+  uint32_t      len_crc = 0;
+  srslte_crc_t* crc_ptr = decode_cb_crc(crc_tb, crc_cb, cb_segm, cb_len, &len_crc);
+
+  // Run iterations and use CRC for early stopping
+  bool early_stop;
+  if (q->llr_is_8bit) {
+    early_stop = srslte_tdec_run_all_crc_8bit(decoder, soft, cb_data, q->max_iterations, cb_len, crc_ptr, len_crc);
+  } else {
+    early_stop = srslte_tdec_run_all_crc(decoder, soft, cb_data, q->max_iterations, cb_len, crc_ptr, len_crc);
+  }
+
+  *noi = (uint32_t)srslte_tdec_get_nof_iterations(decoder);
+
+  if (early_stop) {
+    softbuffer->cb_crc[cb_idx] = true;
+  }
+
+  INFO("CB %d: cb_len=%d, CRC=%s, iterations=%d/%d\n",
+       cb_idx,
+       cb_len,
+       early_stop ? "OK" : "KO",
+       *noi,
+       q->max_iterations);
+
+  return SRSLTE_SUCCESS;
+}
+
+/* The decided codeblock CRC overlaps the next codeblock, so only the codeblock data is copied into the TB */
+static void sch_cb_job_copy(sch_cb_job_t* job, uint32_t cb_idx, const uint8_t* cb_data)
+{
+  uint32_t cb_len = cb_idx < job->cb_segm->C1 ? job->cb_segm->K1 : job->cb_segm->K2;
+  uint32_t rlen   = job->cb_segm->C == 1 ? cb_len : (cb_len - 24);
+  memcpy(&job->data[cb_idx * rlen / 8], cb_data, rlen / 8 * sizeof(uint8_t));
+}
+
+/* Decodes the codeblock of task task_idx into a private buffer and copies the codeblock data into the TB */
+static void sch_cb_job_run(sch_cb_job_t*  job,
+                           srslte_tdec_t* decoder,
+                           srslte_crc_t*  crc_tb,
+                           srslte_crc_t*  crc_cb,
+                           uint8_t*       cb_data,
+                           uint32_t       task_idx)
+{
+  uint32_t cb_idx = job->cb_list[task_idx];
+
+  if (decode_cb(job->q,
+                decoder,
+                crc_tb,
+                crc_cb,
+                job->softbuffer,
+                job->cb_segm,
+                job->Qm,
+                job->rv,
+                job->nof_e_bits,
+                job->e_bits,
+                cb_idx,
+                cb_data,
+                &job->cb_noi[cb_idx])) {
+    job->error = true;
+  }
+
+  sch_cb_job_copy(job, cb_idx, cb_data);
+}
+
+/* Takes the next codeblock of the oldest transport block with codeblocks left. Call with the pool mutex locked */
+static sch_cb_job_t* sch_cb_pool_next_task(srslte_sch_cb_pool_t* pool, uint32_t* task_idx)
+{
+  while (pool->nof_jobs > 0) {
+    sch_cb_job_t* job = (sch_cb_job_t*)pool->jobs[0];
+    if (job->next_task < job->nof_tasks) {
+      *task_idx = job->next_task++;
+      return job;
+    }
+    pool->nof_jobs--;
+    memmove(&pool->jobs[0], &pool->jobs[1], pool->nof_jobs * sizeof(void*));
+  }
+  return NULL;
+}
+
+/* Call with the pool mutex locked */
+static void sch_cb_pool_task_done(srslte_sch_cb_pool_t* pool, sch_cb_job_t* job)
+{
+  job->nof_pending--;
+  if (job->nof_pending == 0) {
+    pthread_cond_broadcast(&pool->cvar_done);
+  }
+}
+
+static void* sch_cb_worker_thread(void* arg)
+{
+  srslte_sch_cb_worker_t* w    = (srslte_sch_cb_worker_t*)arg;
+  srslte_sch_cb_pool_t*   pool = (srslte_sch_cb_pool_t*)w->pool;
+
+  pthread_mutex_lock(&pool->mutex);
+  while (!pool->quit) {
+    uint32_t      task_idx = 0;
+    sch_cb_job_t* job      = sch_cb_pool_next_task(pool, &task_idx);
+    if (job == NULL) {
+      pthread_cond_wait(&pool->cvar_job, &pool->mutex);
+      continue;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    sch_cb_job_run(job, &w->decoder, &w->crc_tb, &w->crc_cb, w->cb_data, task_idx);
+
+    pthread_mutex_lock(&pool->mutex);
+    sch_cb_pool_task_done(pool, job);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+
+  return NULL;
+}
+
+/* Hands nof_tasks codeblocks to the offload backend and decodes on the CPU the ones it leaves undone */
+static void sch_cb_offload_run(srslte_sch_cb_pool_t* pool, uint32_t nof_tasks)
+{
+  srslte_sch_cb_worker_t* w = &pool->offload_worker;
+
+  for (uint32_t i = 0; i < nof_tasks; i++) {
+    sch_cb_job_t*                 job    = (sch_cb_job_t*)pool->offload_jobs[i];
+    srslte_sch_cb_offload_task_t* task   = &pool->offload_tasks[i];
+    uint32_t                      cb_idx = job->cb_list[pool->offload_job_tasks[i]];
+    srslte_cbsegm_t*              segm   = job->cb_segm;
+
+    task->llr_is_8bit    = job->q->llr_is_8bit;
+    task->cb_len         = cb_idx < segm->C1 ? segm->K1 : segm->K2;
+    task->max_iterations = job->q->max_iterations;
+    task->crc            = decode_cb_crc(&w->crc_tb, &w->crc_cb, segm, task->cb_len, &task->crc_len);
+    task->data           = &pool->offload_data[i * ((SRSLTE_TCOD_MAX_LEN_CB + 8) / 8)];
+    task->crc_ok         = false;
+    task->nof_iterations = 0;
+    task->llr = decode_cb_rm(job->q, job->softbuffer, segm, job->Qm, job->rv, job->nof_e_bits, job->e_bits, cb_idx);
+
+    // A codeblock that fails the rate matching fails its transport block, the backend does not see it
+    task->done = task->llr == NULL;
+    if (task->done) {
+      job->error = true;
+    }
+  }
+
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+  pool->offload.decode(pool->offload.ctx, pool->offload_tasks, nof_tasks);
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  float us_cb = (t[0].tv_sec * 1e6f + t[0].tv_usec) / nof_tasks;
+  pool->offload_us_cb = pool->offload_us_cb > 0 ? 0.9f * pool->offload_us_cb + 0.1f * us_cb : us_cb;
+
+  for (uint32_t i = 0; i < nof_tasks; i++) {
+    sch_cb_job_t*                 job    = (sch_cb_job_t*)pool->offload_jobs[i];
+    srslte_sch_cb_offload_task_t* task   = &pool->offload_tasks[i];
+    uint32_t                      cb_idx = job->cb_list[pool->offload_job_tasks[i]];
+
+    if (task->llr == NULL) {
+      continue;
+    }
+    if (task->done) {
+      job->cb_noi[cb_idx] = task->nof_iterations;
+      if (task->crc_ok) {
+        job->softbuffer->cb_crc[cb_idx] = true;
+      }
+      sch_cb_job_copy(job, cb_idx, task->data);
+      pool->nof_cb_offload++;
+    } else {
+      // The soft bits are de-rate matched already, running the rate matching again would combine them twice
+      srslte_tdec_t* dec = &w->decoder;
+      bool           ok  = task->llr_is_8bit ? srslte_tdec_run_all_crc_8bit(dec,
+                                                                          task->llr,
+                                                                          task->data,
+                                                                          task->max_iterations,
+                                                                          task->cb_len,
+                                                                          task->crc,
+                                                                          task->crc_len)
+                                     : srslte_tdec_run_all_crc(dec,
+                                                               task->llr,
+                                                               task->data,
+                                                               task->max_iterations,
+                                                               task->cb_len,
+                                                               task->crc,
+                                                               task->crc_len);
+      job->cb_noi[cb_idx] = (uint32_t)srslte_tdec_get_nof_iterations(dec);
+      if (ok) {
+        job->softbuffer->cb_crc[cb_idx] = true;
+      }
+      sch_cb_job_copy(job, cb_idx, task->data);
+      pool->nof_cb_fallback++;
+    }
+  }
+}
+
+static void* sch_cb_offload_thread(void* arg)
+{
+  srslte_sch_cb_pool_t* pool = (srslte_sch_cb_pool_t*)arg;
+
+  pthread_mutex_lock(&pool->mutex);
+  while (!pool->quit) {
+    // Only as many codeblocks as the backend is expected to decode within the budget, the CPU takes the rest
+    uint32_t max_batch = pool->offload.max_batch;
+    if (pool->offload.budget_us > 0 && pool->offload_us_cb > 0) {
+      max_batch = SRSLTE_MIN(max_batch, (uint32_t)(pool->offload.budget_us / pool->offload_us_cb));
+    }
+
+    uint32_t nof_tasks = 0;
+    while (nof_tasks < max_batch) {
+      uint32_t      task_idx = 0;
+      sch_cb_job_t* job      = sch_cb_pool_next_task(pool, &task_idx);
+      if (job == NULL) {
+        break;
+      }
+      pool->offload_jobs[nof_tasks]      = job;
+      pool->offload_job_tasks[nof_tasks] = task_idx;
+      nof_tasks++;
+    }
+
+    if (nof_tasks == 0) {
+      // A backend too slow for the budget is left idle, its estimate decays so that it is tried again later
+      if (max_batch == 0) {
+        pool->offload_us_cb *= 0.9f;
+      }
+      pthread_cond_wait(&pool->cvar_job, &pool->mutex);
+      continue;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    sch_cb_offload_run(pool, nof_tasks);
+
+    pthread_mutex_lock(&pool->mutex);
+    for (uint32_t i = 0; i < nof_tasks; i++) {
+      sch_cb_pool_task_done(pool, (sch_cb_job_t*)pool->offload_jobs[i]);
+    }
+  }
+  pthread_mutex_unlock(&pool->mutex);
+
+  return NULL;
+}
+
+static int sch_cb_worker_init(srslte_sch_cb_worker_t* w, srslte_sch_cb_pool_t* pool)
+{
+  w->pool = pool;
+  if (srslte_tdec_init(&w->decoder, SRSLTE_TCOD_MAX_LEN_CB)) {
+    ERROR("Error initiating Turbo Decoder\n");
+    return SRSLTE_ERROR;
+  }
+  if (srslte_crc_init(&w->crc_tb, SRSLTE_LTE_CRC24A, 24) || srslte_crc_init(&w->crc_cb, SRSLTE_LTE_CRC24B, 24)) {
+    ERROR("Error initiating CRC\n");
+    return SRSLTE_ERROR;
+  }
+  w->cb_data = srslte_vec_u8_malloc((SRSLTE_TCOD_MAX_LEN_CB + 8) / 8);
+  if (!w->cb_data) {
+    return SRSLTE_ERROR;
+  }
+  return SRSLTE_SUCCESS;
+}
+
+static void sch_cb_worker_free(srslte_sch_cb_worker_t* w)
+{
+  if (w->thread_running) {
+    pthread_join(w->pthread, NULL);
+  }
+  srslte_tdec_free(&w->decoder);
+  if (w->cb_data) {
+    free(w->cb_data);
+  }
+}
+
+int srslte_sch_cb_pool_init(srslte_sch_cb_pool_t* pool, uint32_t nof_workers)
+{
+  if (pool == NULL || nof_workers == 0 || nof_workers > SRSLTE_SCH_MAX_CB_WORKERS) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  bzero(pool, sizeof(srslte_sch_cb_pool_t));
+
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->cvar_job, NULL);
+  pthread_cond_init(&pool->cvar_done, NULL);
+
+  srslte_rm_turbo_gentables();
+
+  for (uint32_t i = 0; i < nof_workers; i++) {
+    srslte_sch_cb_worker_t* w = &pool->workers[i];
+    pool->nof_workers++;
+    if (sch_cb_worker_init(w, pool)) {
+      srslte_sch_cb_pool_free(pool);
+      return SRSLTE_ERROR;
+    }
+    if (pthread_create(&w->pthread, NULL, sch_cb_worker_thread, w)) {
+      ERROR("Error creating codeblock worker thread\n");
+      srslte_sch_cb_pool_free(pool);
+      return SRSLTE_ERROR;
+    }
+    w->thread_running = true;
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+int srslte_sch_cb_pool_set_offload(srslte_sch_cb_pool_t* pool, const srslte_sch_cb_offload_t* offload)
+{
+  if (pool == NULL || offload == NULL || offload->decode == NULL || offload->max_batch == 0 ||
+      pool->offload.decode != NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t max_batch      = offload->max_batch;
+  pool->offload_tasks     = calloc(max_batch, sizeof(srslte_sch_cb_offload_task_t));
+  pool->offload_jobs      = calloc(max_batch, sizeof(void*));
+  pool->offload_job_tasks = srslte_vec_u32_malloc(max_batch);
+  pool->offload_data      = srslte_vec_u8_malloc(max_batch * ((SRSLTE_TCOD_MAX_LEN_CB + 8) / 8));
+  if (!pool->offload_tasks || !pool->offload_jobs || !pool->offload_job_tasks || !pool->offload_data) {
+    return SRSLTE_ERROR;
+  }
+  if (sch_cb_worker_init(&pool->offload_worker, pool)) {
+    return SRSLTE_ERROR;
+  }
+
+  pool->offload = *offload;
+  if (pthread_create(&pool->offload_worker.pthread, NULL, sch_cb_offload_thread, pool)) {
+    ERROR("Error creating codeblock offload thread\n");
+    pool->offload.decode = NULL;
+    return SRSLTE_ERROR;
+  }
+  pool->offload_worker.thread_running = true;
+
+  return SRSLTE_SUCCESS;
+}
+
+void srslte_sch_cb_pool_free(srslte_sch_cb_pool_t* pool)
+{
+  if (pool == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&pool->mutex);
+  pool->quit = true;
+  pthread_cond_broadcast(&pool->cvar_job);
+  pthread_mutex_unlock(&pool->mutex);
+
+  for (uint32_t i = 0; i < pool->nof_workers; i++) {
+    sch_cb_worker_free(&pool->workers[i]);
+  }
+  sch_cb_worker_free(&pool->offload_worker);
+  free(pool->offload_tasks);
+  free(pool->offload_jobs);
+  free(pool->offload_job_tasks);
+  free(pool->offload_data);
+
+  pthread_cond_destroy(&pool->cvar_done);
+  pthread_cond_destroy(&pool->cvar_job);
+  pthread_mutex_destroy(&pool->mutex);
+  srslte_rm_turbo_free_tables();
+
+  bzero(pool, sizeof(srslte_sch_cb_pool_t));
+}
+
+void srslte_sch_set_cb_pool(srslte_sch_t* q, srslte_sch_cb_pool_t* pool)
+{
+  q->cb_pool = pool;
+}
+
+/* Decodes the codeblocks in job->cb_list using the pool workers and the calling thread */
+static void decode_tb_cb_pool(srslte_sch_t* q, sch_cb_job_t* job, uint32_t nof_tasks)
+{
+  srslte_sch_cb_pool_t* pool = q->cb_pool;
+
+  pthread_mutex_lock(&pool->mutex);
+  job->next_task   = 0;
+  job->nof_tasks   = nof_tasks;
+  job->nof_pending = nof_tasks;
+
+  // With too many transport blocks in flight the calling thread decodes its codeblocks alone
+  bool queued = pool->nof_jobs < SRSLTE_SCH_MAX_CB_JOBS;
+  if (queued) {
+    pool->jobs[pool->nof_jobs++] = job;
+    pthread_cond_broadcast(&pool->cvar_job);
+  }
+
+  // The calling thread decodes codeblocks too instead of just waiting
+  while (job->next_task < job->nof_tasks) {
+    uint32_t task_idx = job->next_task++;
+    pthread_mutex_unlock(&pool->mutex);
+
+    sch_cb_job_run(job, &q->decoder, &q->crc_tb, &q->crc_cb, q->cb_in, task_idx);
+
+    pthread_mutex_lock(&pool->mutex);
+    job->nof_pending--;
+  }
+
+  // The job lives in the caller stack, no thread may find it in the queue after returning
+  for (uint32_t i = 0; queued && i < pool->nof_jobs; i++) {
+    if (pool->jobs[i] == job) {
+      pool->nof_jobs--;
+      memmove(&pool->jobs[i], &pool->jobs[i + 1], (pool->nof_jobs - i) * sizeof(void*));
+      break;
+    }
+  }
+
+  while (job->nof_pending > 0) {
+    pthread_cond_wait(&pool->cvar_done, &pool->mutex);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+}
+
 bool decode_tb_cb(srslte_sch_t*           q,
                   srslte_softbuffer_rx_t* softbuffer,
                   srslte_cbsegm_t*        cb_segm,
@@ -369,10 +897,6 @@ bool decode_tb_cb(srslte_sch_t*           q,
                   void*                   e_bits,
                   uint8_t*                data)
 {
-
-  int8_t*  e_bits_b = e_bits;
-  int16_t* e_bits_s = e_bits;
-
   if (cb_segm->C > SRSLTE_MAX_CODEBLOCKS) {
     ERROR("Error SRSLTE_MAX_CODEBLOCKS=%d\n", SRSLTE_MAX_CODEBLOCKS);
     return false;
@@ -380,90 +904,81 @@ bool decode_tb_cb(srslte_sch_t*           q,
 
   q->avg_iterations = 0;
 
+  // Count the codeblocks not decoded yet
+  uint32_t nof_pending_cb = 0;
   for (int cb_idx = 0; cb_idx < cb_segm->C; cb_idx++) {
-    /* Do not process blocks with CRC Ok */
     if (softbuffer->cb_crc[cb_idx] == false) {
+      nof_pending_cb++;
+    }
+  }
 
-      uint32_t cb_len     = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
-      uint32_t cb_len_idx = cb_idx < cb_segm->C1 ? cb_segm->K1_idx : cb_segm->K2_idx;
-
-      uint32_t rlen  = cb_segm->C == 1 ? cb_len : (cb_len - 24);
-      uint32_t Gp    = nof_e_bits / Qm;
-      uint32_t gamma = cb_segm->C > 0 ? Gp % cb_segm->C : Gp;
-      uint32_t n_e   = Qm * (Gp / cb_segm->C);
-
-      uint32_t rp   = cb_idx * n_e;
-      uint32_t n_e2 = n_e;
-
-      if (cb_idx > cb_segm->C - gamma) {
-        n_e2 = n_e + Qm;
-        rp   = (cb_segm->C - gamma) * n_e + (cb_idx - (cb_segm->C - gamma)) * n_e2;
-      }
-
-      if (q->llr_is_8bit) {
-        if (srslte_rm_turbo_rx_lut_8bit(&e_bits_b[rp], (int8_t*)softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, rv)) {
-          ERROR("Error in rate matching\n");
-          return SRSLTE_ERROR;
-        }
+  if (q->cb_pool && nof_pending_cb > 1) {
+    sch_cb_job_t job = {};
+    job.q            = q;
+    job.softbuffer   = softbuffer;
+    job.cb_segm      = cb_segm;
+    job.Qm           = Qm;
+    job.rv           = rv;
+    job.nof_e_bits   = nof_e_bits;
+    job.e_bits       = e_bits;
+    job.data         = data;
+
+    uint32_t nof_tasks = 0;
+    for (int cb_idx = 0; cb_idx < cb_segm->C; cb_idx++) {
+      if (softbuffer->cb_crc[cb_idx] == false) {
+        job.cb_list[nof_tasks++] = cb_idx;
       } else {
-        if (srslte_rm_turbo_rx_lut(&e_bits_s[rp], softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, rv)) {
-          ERROR("Error in rate matching\n");
-          return SRSLTE_ERROR;
+        // Copy decoded data from previous transmissions
+        uint32_t cb_len = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
+        uint32_t rlen   = cb_segm->C == 1 ? cb_len : (cb_len - 24);
+        uint8_t* cb_data = srslte_softbuffer_rx_get_data(softbuffer, cb_idx);
+        if (cb_data == NULL) {
+          return false;
         }
+        memcpy(&data[cb_idx * rlen / 8], cb_data, rlen / 8 * sizeof(uint8_t));
       }
+    }
 
-      srslte_tdec_new_cb(&q->decoder, cb_len);
-
-      // Run iterations and use CRC for early stopping
-      bool     early_stop = false;
-      uint32_t cb_noi     = 0;
-      do {
-        if (q->llr_is_8bit) {
-          srslte_tdec_iteration_8bit(&q->decoder, (int8_t*)softbuffer->buffer_f[cb_idx], &data[cb_idx * rlen / 8]);
-        } else {
-          srslte_tdec_iteration(&q->decoder, softbuffer->buffer_f[cb_idx], &data[cb_idx * rlen / 8]);
-        }
-        q->avg_iterations++;
-        cb_noi++;
+    decode_tb_cb_pool(q, &job, nof_tasks);
 
-        uint32_t      len_crc;
-        srslte_crc_t* crc_ptr;
+    if (job.error) {
+      return false;
+    }
+    for (int i = 0; i < nof_tasks; i++) {
+      q->avg_iterations += job.cb_noi[job.cb_list[i]];
+    }
+  } else {
+    for (int cb_idx = 0; cb_idx < cb_segm->C; cb_idx++) {
+      uint32_t cb_len = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
+      uint32_t rlen   = cb_segm->C == 1 ? cb_len : (cb_len - 24);
 
-        if (cb_segm->C > 1) {
-          len_crc = cb_len;
-          crc_ptr = &q->crc_cb;
-        } else {
-          len_crc = cb_segm->tbs + 24;
-          crc_ptr = &q->crc_tb;
+      /* Do not process blocks with CRC Ok */
+      if (softbuffer->cb_crc[cb_idx] == false) {
+        uint32_t cb_noi = 0;
+        if (decode_cb(q,
+                      &q->decoder,
+                      &q->crc_tb,
+                      &q->crc_cb,
+                      softbuffer,
+                      cb_segm,
+                      Qm,
+                      rv,
+                      nof_e_bits,
+                      e_bits,
+                      cb_idx,
+                      &data[cb_idx * rlen / 8],
+                      &cb_noi)) {
+          return false;
         }
-
-        // CRC is OK
-        if (!srslte_crc_checksum_byte(crc_ptr, &data[cb_idx * rlen / 8], len_crc)) {
-
-          softbuffer->cb_crc[cb_idx] = true;
-          early_stop                 = true;
-
-          // CRC is error and exceeded maximum iterations for this CB.
-          // Early stop the whole transport block.
+        q->avg_iterations += cb_noi;
+      } else {
+        // Copy decoded data from previous transmissions
+        uint8_t* cb_data = srslte_softbuffer_rx_get_data(softbuffer, cb_idx);
+        if (cb_data == NULL) {
+          return false;
         }
-
-      } while (cb_noi < q->max_iterations && !early_stop);
-
-      INFO("CB %d: rp=%d, n_e=%d, cb_len=%d, CRC=%s, rlen=%d, iterations=%d/%d\n",
-           cb_idx,
-           rp,
-           n_e2,
-           cb_len,
-           early_stop ? "OK" : "KO",
-           rlen,
-           cb_noi,
-           q->max_iterations);
-
-    } else {
-      // Copy decoded data from previous transmissions
-      uint32_t cb_len = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
-      uint32_t rlen   = cb_segm->C == 1 ? cb_len : (cb_len - 24);
-      memcpy(&data[cb_idx * rlen / 8], softbuffer->data[cb_idx], rlen / 8 * sizeof(uint8_t));
+        memcpy(&data[cb_idx * rlen / 8], cb_data, rlen / 8 * sizeof(uint8_t));
+      }
     }
   }
 
@@ -478,7 +993,10 @@ bool decode_tb_cb(srslte_sch_t*           q,
       if (softbuffer->cb_crc[i]) {
         uint32_t cb_len = i < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
         uint32_t rlen   = cb_segm->C == 1 ? cb_len : (cb_len - 24);
-        memcpy(softbuffer->data[i], &data[i * rlen / 8], rlen / 8 * sizeof(uint8_t));
+        uint8_t* cb_data = srslte_softbuffer_rx_get_data(softbuffer, i);
+        if (cb_data != NULL) {
+          memcpy(cb_data, &data[i * rlen / 8], rlen / 8 * sizeof(uint8_t));
+        }
       }
     }
   }
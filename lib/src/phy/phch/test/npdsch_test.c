@@ -29,9 +29,11 @@
 #include "srslte/phy/ch_estimation/chest_dl_nbiot.h"
 #include "srslte/phy/ch_estimation/refsignal_dl.h"
 #include "srslte/phy/ch_estimation/refsignal_dl_nbiot.h"
+#include "srslte/phy/channel/ch_awgn.h"
 #include "srslte/phy/dft/ofdm.h"
 #include "srslte/phy/io/filesource.h"
 #include "srslte/phy/phch/npdsch.h"
+#include "srslte/phy/ue/ue_dl_nbiot.h"
 #include "srslte/phy/utils/debug.h"
 #include "srslte/phy/utils/vector.h"
 
@@ -55,11 +57,14 @@ uint32_t subframe   = 1;
 uint32_t rv_idx     = 0;
 uint16_t rnti       = 1234;
 uint16_t i_tbs_val  = 0;
+uint32_t i_sf       = 0;
+uint32_t i_rep      = 0;
+float    rep_n0_dB  = 16.0f;
 char*    input_file = NULL;
 
 void usage(char* prog)
 {
-  printf("Usage: %s [fmMlsrRFpnv] \n", prog);
+  printf("Usage: %s [fmMlsrRFpPxknNv] \n", prog);
   printf("\t-f read signal from file [Default generate it with pdsch_encode()]\n");
   printf("\t-m i_tbs value [Default %d]\n", i_tbs_val);
   printf("\t-M NB-IoT deployment mode (0=InbandSamePCI,1=InbandDifferentPCI,2=GuardBand,3=Standalone) [Default %d]\n",
@@ -71,13 +76,16 @@ void usage(char* prog)
   printf("\t-p Base cell cell nof_ports [Default %d]\n", nof_ports_lte);
   printf("\t-P NB-IoT cell nof_ports [Default %d]\n", nof_ports_nbiot);
   printf("\t-x Expected number of resource elements [Default %d]\n", expected_nof_re);
+  printf("\t-k i_sf value of the repetition test [Default %d]\n", i_sf);
+  printf("\t-n i_rep value of the repetition test, 0 skips it [Default %d]\n", i_rep);
+  printf("\t-N noise power of the repetition test in dB, the NPDSCH is at 0 dB [Default %.1f]\n", rep_n0_dB);
   printf("\t-v [set srslte_verbose to debug, default none]\n");
 }
 
 void parse_args(int argc, char** argv)
 {
   int opt;
-  while ((opt = getopt(argc, argv, "fmMlsrRpPvx")) != -1) {
+  while ((opt = getopt(argc, argv, "fmMlsrRpPvxknN")) != -1) {
     switch (opt) {
       case 'f':
         input_file = argv[optind];
@@ -109,6 +117,15 @@ void parse_args(int argc, char** argv)
       case 'x':
         expected_nof_re = (uint32_t)strtol(argv[optind], NULL, 10);
         break;
+      case 'k':
+        i_sf = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'n':
+        i_rep = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'N':
+        rep_n0_dB = strtof(argv[optind], NULL);
+        break;
       case 'v':
         srslte_verbose++;
         break;
@@ -470,6 +487,146 @@ quit:
   return ret;
 }
 
+/* Transmits all the repetitions of a grant to the UE DL object, in the order of TS 36.211 Section 10.2.3.4, until it
+ * stops expecting more subframes. The subframes carry the NPDSCH plus the noise of awgn, or only the noise.
+ * @return the result of the last subframe processed by the UE
+ */
+static int send_repetitions(srslte_nbiot_ue_dl_t*       ue_dl,
+                            srslte_npdsch_t*            npdsch,
+                            srslte_channel_awgn_t*      awgn,
+                            srslte_ra_nbiot_dl_grant_t* grant,
+                            bool                        with_signal,
+                            uint8_t*                    data,
+                            uint8_t*                    rx_data,
+                            uint32_t*                   nof_sf_used)
+{
+  srslte_npdsch_cfg_t cfg;
+  cf_t*               sf_symbols[SRSLTE_MAX_PORTS] = {ue_dl->sf_symbols};
+  int                 ret                          = SRSLTE_ERROR;
+
+  srslte_npdsch_cfg(&cfg, ue_dl->cell, grant, grant->start_sfidx);
+  srslte_nbiot_ue_dl_set_grant(ue_dl, grant);
+
+  *nof_sf_used = 0;
+  while (srslte_nbiot_ue_dl_has_grant(ue_dl) && *nof_sf_used < grant->nof_sf * grant->nof_rep) {
+    srslte_vec_cf_zero(ue_dl->sf_symbols, ue_dl->nof_re);
+    if (with_signal && srslte_npdsch_encode_rnti(npdsch, &cfg, NULL, data, rnti, sf_symbols)) {
+      fprintf(stderr, "Error encoding NPDSCH\n");
+      return SRSLTE_ERROR;
+    }
+    srslte_channel_awgn_run_c(awgn, ue_dl->sf_symbols, ue_dl->sf_symbols, ue_dl->nof_re);
+    for (uint32_t i = 0; i < ue_dl->nof_re; i++) {
+      ue_dl->ce[0][i] = 1.0f;
+    }
+    ret = srslte_nbiot_ue_dl_decode_npdsch_no_bcch(ue_dl, rx_data, SFN * 10 + SF_IDX, rnti);
+    (*nof_sf_used)++;
+  }
+  return ret;
+}
+
+/* Sends grants of i_sf and i_rep through the UE DL object, which combines their repetitions:
+ * - without noise, the TB is decoded at the end of the first cycle of min(nof_rep, 4) repetitions of each subframe;
+ * - at a noise power of rep_n0_dB, where a single cycle is not enough, combining the cycles decodes almost every TB
+ *   before the end;
+ * - on noise only, the early decode attempts never pass the CRC.
+ */
+int repetition_test(int argc, char** argv)
+{
+  int                        ret = SRSLTE_ERROR;
+  srslte_ra_nbiot_dl_grant_t grant;
+  srslte_ra_nbiot_dl_dci_t   dci;
+  srslte_nbiot_ue_dl_t       ue_dl;
+  srslte_npdsch_t            npdsch;
+  srslte_channel_awgn_t      awgn;
+  cf_t                       rx_buff[SRSLTE_SF_LEN_PRB_NBIOT];
+  cf_t*                      buff_ptrs[SRSLTE_MAX_PORTS] = {rx_buff, NULL, NULL, NULL};
+  uint8_t                    data[SRSLTE_NPDSCH_MAX_TBS / 8];
+  uint8_t                    rx_data[SRSLTE_NPDSCH_MAX_TBS / 8];
+  const uint32_t             nof_trials = 50;
+
+  parse_args(argc, argv);
+
+  if (i_rep == 0) {
+    printf("Skipping repetition test because the number of repetitions isn't given!\n");
+    return SRSLTE_SUCCESS;
+  }
+
+  srslte_nbiot_cell_t cell = {};
+  cell.base.nof_prb        = 1;
+  cell.base.cp             = SRSLTE_CP_NORM;
+  cell.base.nof_ports      = 1;
+  cell.nof_ports           = 1;
+  cell.mode                = SRSLTE_NBIOT_MODE_STANDALONE;
+  cell.n_id_ncell          = n_id_ncell;
+
+  bzero(&dci, sizeof(srslte_ra_nbiot_dl_dci_t));
+  dci.mcs_idx     = i_tbs_val;
+  dci.alloc.i_sf  = i_sf;
+  dci.alloc.i_rep = i_rep;
+  if (srslte_ra_nbiot_dl_dci_to_grant(&dci, &grant, SFN, SF_IDX, DUMMY_R_MAX, false, cell.mode)) {
+    fprintf(stderr, "Error computing resource allocation\n");
+    return ret;
+  }
+
+  if (srslte_nbiot_ue_dl_init(&ue_dl, buff_ptrs, SRSLTE_NBIOT_MAX_PRB, SRSLTE_NBIOT_NUM_RX_ANTENNAS) ||
+      srslte_nbiot_ue_dl_set_cell(&ue_dl, cell) || srslte_npdsch_init(&npdsch) ||
+      srslte_npdsch_set_cell(&npdsch, cell) || srslte_channel_awgn_init(&awgn, 1234)) {
+    fprintf(stderr, "Error initialising the repetition test\n");
+    return ret;
+  }
+  srslte_npdsch_set_rnti(&npdsch, rnti);
+  srslte_nbiot_ue_dl_set_rnti(&ue_dl, rnti);
+
+  uint32_t m             = SRSLTE_MIN(grant.nof_rep, 4);
+  uint32_t nof_sf_early  = grant.nof_sf * (grant.nof_rep > m ? m : grant.nof_rep);
+  uint32_t nof_sf_total  = grant.nof_sf * grant.nof_rep;
+  uint32_t nof_ok[3]     = {};
+  uint32_t nof_wrong[3]  = {};
+  uint32_t sum_nof_sf[3] = {};
+  float    n0_dB[3]      = {-100.0f, rep_n0_dB, 0.0f};
+
+  printf("Repetition test with %d subframes and %d repetitions\n", grant.nof_sf, grant.nof_rep);
+  for (uint32_t c = 0; c < 3; c++) {
+    srslte_channel_awgn_set_n0(&awgn, n0_dB[c]);
+    for (uint32_t t = 0; t < nof_trials; t++) {
+      for (uint32_t i = 0; i < grant.mcs[0].tbs / 8; i++) {
+        data[i] = (uint8_t)(rand() % 256);
+      }
+      uint32_t nof_sf = 0;
+      int      r      = send_repetitions(&ue_dl, &npdsch, &awgn, &grant, c < 2, data, rx_data, &nof_sf);
+      if (r == SRSLTE_SUCCESS) {
+        if (memcmp(data, rx_data, grant.mcs[0].tbs / 8) == 0 && c < 2) {
+          nof_ok[c]++;
+        } else {
+          nof_wrong[c]++;
+        }
+      }
+      sum_nof_sf[c] += nof_sf;
+    }
+    printf("  n0=%.0f dB: %d decoded, %d wrong, %.1f of %d subframes on average\n",
+           n0_dB[c],
+           nof_ok[c],
+           nof_wrong[c],
+           (float)sum_nof_sf[c] / nof_trials,
+           nof_sf_total);
+  }
+
+  if (nof_ok[0] != nof_trials || sum_nof_sf[0] != nof_trials * nof_sf_early) {
+    printf("Without noise, every TB must be decoded after %d subframes\n", nof_sf_early);
+  } else if (nof_ok[1] < nof_trials * 9 / 10 || (grant.nof_rep > m && sum_nof_sf[1] >= nof_trials * nof_sf_total)) {
+    printf("Combining the repetitions must decode most TBs before the end of the grant\n");
+  } else if (nof_wrong[0] + nof_wrong[1] + nof_wrong[2] > 0 || sum_nof_sf[2] != nof_trials * nof_sf_total) {
+    printf("No TB must be decoded wrongly or from noise\n");
+  } else {
+    ret = SRSLTE_SUCCESS;
+  }
+
+  srslte_channel_awgn_free(&awgn);
+  srslte_npdsch_free(&npdsch);
+  srslte_nbiot_ue_dl_free(&ue_dl);
+  return ret;
+}
+
 int main(int argc, char** argv)
 {
   int ret = SRSLTE_ERROR;
@@ -484,6 +641,11 @@ int main(int argc, char** argv)
     return ret;
   }
 
+  if (repetition_test(argc, argv) != SRSLTE_SUCCESS) {
+    printf("NPDSCH repetition test failed!\n");
+    return ret;
+  }
+
   ret = SRSLTE_SUCCESS;
   return ret;
 }
@@ -28,6 +28,9 @@
 
 #include "srslte/srslte.h"
 
+#define NOISE_VARIANCE 2.0f
+#define START_FRAME 1
+
 srslte_cell_t cell = {
     6,                 // nof_prb
     1,                 // nof_ports
@@ -129,6 +132,29 @@ int main(int argc, char** argv)
     exit(-1);
   }
 
+  /* In noise the frames are soft combined until the MIB decodes, starting in the middle of the 40 ms */
+  uint8_t bch_payload_comb[SRSLTE_BCH_PAYLOAD_LEN];
+  int     sfn_offset = -1;
+  int     ret        = 0;
+  int     nof_frames = 0;
+  srslte_pbch_decode_reset(&pbch);
+  for (nof_frames = 0; nof_frames < 4 && ret != 1; nof_frames++) {
+    srslte_pbch_encode(&pbch, bch_payload_tx, sf_symbols, START_FRAME + nof_frames);
+    for (i = 1; i < cell.nof_ports; i++) {
+      for (j = 0; j < nof_re; j++) {
+        sf_symbols[0][j] += sf_symbols[i][j];
+      }
+    }
+    srslte_ch_awgn_c(sf_symbols[0], sf_symbols[0], NOISE_VARIANCE, nof_re);
+    ret = srslte_pbch_decode(&pbch, &chest_dl_res, sf_symbols, bch_payload_comb, NULL, &sfn_offset);
+  }
+  printf("Decoded in noise after %d frames with SFN offset %d\n", nof_frames, sfn_offset);
+  if (ret != 1 || sfn_offset != (START_FRAME + nof_frames - 1) % 4 ||
+      memcmp(bch_payload_comb, bch_payload_tx, sizeof(uint8_t) * SRSLTE_BCH_PAYLOAD_LEN)) {
+    printf("Error decoding in noise\n");
+    exit(-1);
+  }
+
   srslte_pbch_free(&pbch);
 
   for (i = 0; i < cell.nof_ports; i++) {
@@ -22,8 +22,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/time.h>
 #include <unistd.h>
 
+#include "srslte/common/test_common.h"
 #include "srslte/srslte.h"
 
 srslte_cell_t cell = {.nof_prb         = 6,
@@ -153,6 +155,134 @@ int test_dci_payload_size()
   return 0;
 }
 
+// The table driven DCI encoder matches the convolutional encoder and rate matching, and encoding all the DCI of a
+// subframe at once gives the same resource grid as encoding them one by one
+int test_encode_batch(srslte_pdcch_t* pdcch, uint32_t nof_re)
+{
+  srslte_dci_msg_t   msgs[16];
+  srslte_dci_msg_t   msg;
+  cf_t*              grid_ref[SRSLTE_MAX_PORTS] = {};
+  cf_t*              grid[SRSLTE_MAX_PORTS]     = {};
+  srslte_dl_sf_cfg_t dl_sf;
+  ZERO_OBJECT(dl_sf);
+  dl_sf.cfi = cfi;
+
+  for (uint32_t p = 0; p < SRSLTE_MAX_PORTS; p++) {
+    grid_ref[p] = srslte_vec_cf_malloc(nof_re);
+    grid[p]     = srslte_vec_cf_malloc(nof_re);
+    if (!grid_ref[p] || !grid[p]) {
+      return SRSLTE_ERROR;
+    }
+  }
+
+  srslte_convcoder_t encoder;
+  int                poly[3] = {0x6D, 0x4F, 0x57};
+  encoder.K                  = 7;
+  encoder.R                  = 3;
+  encoder.tail_biting        = true;
+  memcpy(encoder.poly, poly, 3 * sizeof(int));
+
+  for (uint32_t nof_bits = 8; nof_bits < SRSLTE_DCI_MAX_BITS - 16; nof_bits++) {
+    for (uint32_t L = 0; L < 4 && (72u << L) < pdcch->max_bits; L++) {
+      uint8_t  data[SRSLTE_DCI_MAX_BITS + 16];
+      uint8_t  coded[3 * (SRSLTE_DCI_MAX_BITS + 16)];
+      uint8_t  e_ref[72 * 8];
+      uint8_t  e[72 * 8];
+      uint16_t rnti = (uint16_t)random();
+      for (uint32_t i = 0; i < nof_bits; i++) {
+        data[i] = (uint8_t)(random() & 1);
+      }
+      memcpy(msg.payload, data, nof_bits);
+
+      srslte_crc_attach(&pdcch->crc, data, nof_bits);
+      for (uint32_t i = 0; i < 16; i++) {
+        data[nof_bits + i] ^= (uint8_t)((rnti >> (15 - i)) & 1);
+      }
+      srslte_convcoder_encode(&encoder, data, coded, nof_bits + 16);
+      srslte_rm_conv_tx(coded, 3 * (nof_bits + 16), e_ref, 72 << L);
+
+      TESTASSERT(srslte_pdcch_dci_encode(pdcch, msg.payload, e, nof_bits, 72 << L, rnti) == SRSLTE_SUCCESS);
+      TESTASSERT(memcmp(e, e_ref, 72 << L) == 0);
+    }
+  }
+
+  for (uint32_t s = 0; s < 10; s++) {
+    dl_sf.tti = s;
+
+    // Random DCI in consecutive locations, leaving some CCEs empty
+    uint32_t nof_msgs = 0;
+    uint32_t ncce     = (uint32_t)(random() % 2);
+    while (nof_msgs < 16) {
+      uint32_t L = (uint32_t)(random() % 4);
+      ncce       = (ncce + (1u << L) - 1) / (1u << L) * (1u << L);
+      if (ncce + (1u << L) > pdcch->nof_cce[cfi - 1]) {
+        break;
+      }
+      ZERO_OBJECT(msgs[nof_msgs]);
+      msgs[nof_msgs].nof_bits = 20 + (uint32_t)(random() % 40);
+      msgs[nof_msgs].rnti     = (uint16_t)random();
+      for (uint32_t i = 0; i < msgs[nof_msgs].nof_bits; i++) {
+        msgs[nof_msgs].payload[i] = (uint8_t)(random() & 1);
+      }
+      srslte_dci_location_set(&msgs[nof_msgs].location, L, ncce);
+      ncce += (1u << L) + (uint32_t)(random() % 2);
+      nof_msgs++;
+    }
+
+    for (uint32_t p = 0; p < SRSLTE_MAX_PORTS; p++) {
+      srslte_vec_cf_zero(grid_ref[p], nof_re);
+      srslte_vec_cf_zero(grid[p], nof_re);
+    }
+    for (uint32_t i = 0; i < nof_msgs; i++) {
+      TESTASSERT(srslte_pdcch_encode(pdcch, &dl_sf, &msgs[i], grid_ref) == SRSLTE_SUCCESS);
+    }
+    TESTASSERT(srslte_pdcch_encode_batch(pdcch, &dl_sf, msgs, nof_msgs, grid) == SRSLTE_SUCCESS);
+    for (uint32_t p = 0; p < cell.nof_ports; p++) {
+      // Compared by value, the precoded empty CCEs may be negative zeros
+      for (uint32_t k = 0; k < nof_re; k++) {
+        TESTASSERT(grid[p][k] == grid_ref[p][k]);
+      }
+    }
+  }
+
+  // Time of both encoders for a full control region
+  uint32_t nof_msgs = SRSLTE_MIN(16, pdcch->nof_cce[cfi - 1]);
+  for (uint32_t i = 0; i < nof_msgs; i++) {
+    ZERO_OBJECT(msgs[i]);
+    msgs[i].nof_bits = 27;
+    msgs[i].rnti     = (uint16_t)(1234 + i);
+    srslte_dci_location_set(&msgs[i].location, 0, i);
+  }
+  struct timeval t[3];
+  uint32_t       nof_reps = 1000;
+  gettimeofday(&t[1], NULL);
+  for (uint32_t r = 0; r < nof_reps; r++) {
+    for (uint32_t i = 0; i < nof_msgs; i++) {
+      srslte_pdcch_encode(pdcch, &dl_sf, &msgs[i], grid_ref);
+    }
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  uint64_t t_single = t[0].tv_sec * 1000000UL + t[0].tv_usec;
+  gettimeofday(&t[1], NULL);
+  for (uint32_t r = 0; r < nof_reps; r++) {
+    srslte_pdcch_encode_batch(pdcch, &dl_sf, msgs, nof_msgs, grid);
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  uint64_t t_batch = t[0].tv_sec * 1000000UL + t[0].tv_usec;
+  printf("Encoding %d DCI: %.2f us one by one, %.2f us batched\n",
+         nof_msgs,
+         (double)t_single / nof_reps,
+         (double)t_batch / nof_reps);
+
+  for (uint32_t p = 0; p < SRSLTE_MAX_PORTS; p++) {
+    free(grid_ref[p]);
+    free(grid[p]);
+  }
+  return SRSLTE_SUCCESS;
+}
+
 typedef struct {
   srslte_dci_msg_t      dci_tx, dci_rx;
   srslte_dci_location_t dci_location;
@@ -213,6 +343,11 @@ int main(int argc, char** argv)
     exit(-1);
   }
 
+  if (test_encode_batch(&pdcch_tx, (uint32_t)nof_re) != SRSLTE_SUCCESS) {
+    ERROR("Error in the batched DCI encoder\n");
+    exit(-1);
+  }
+
   if (srslte_pdcch_init_ue(&pdcch_rx, cell.nof_prb, nof_rx_ant)) {
     ERROR("Error creating PDCCH object\n");
     exit(-1);
@@ -55,10 +55,17 @@ static char*       input_file                   = NULL;
 static int         M                            = 1;
 static bool        enable_256qam                = false;
 static bool        use_8_bit                    = false;
+static uint32_t    nof_cb_workers               = 0;
+static bool        enable_offload               = false;
+static bool        test_re_mapping              = false;
+static bool        test_c16                     = false;
+static float       c16_snr_db                   = 10.0f;
+static bool        test_irc                     = false;
+static float       irc_sir_db                   = 0.0f;
 
 void usage(char* prog)
 {
-  printf("Usage: %s [fmMbcsrtRFpnwav] \n", prog);
+  printf("Usage: %s [fmMbcsrtRFpnwaveq] \n", prog);
   printf("\t-f read signal from file [Default generate it with pdsch_encode()]\n");
   printf("\t-m MCS [Default %d]\n", mcs[0]);
   printf("\t-M MCS2 [Default %d]\n", mcs[1]);
@@ -76,6 +83,12 @@ void usage(char* prog)
   printf("\t-p pmi (multiplex only)  [Default %d]\n", pmi);
   printf("\t-w Swap Transport Blocks\n");
   printf("\t-j Enable PDSCH decoder coworker\n");
+  printf("\t-W Number of codeblock decoder workers [Default %d]\n", nof_cb_workers);
+  printf("\t-O Enable an emulated codeblock offload backend (needs -W)\n");
+  printf("\t-e Test the resource element mapping of random cells and allocations instead\n");
+  printf("\t-i Compare decoding from int16 grids against the float path at this SNR in dB instead [Default %.1f]\n",
+         c16_snr_db);
+  printf("\t-I Compare IRC against MRC with an interferer at this SIR in dB instead [Default %.1f]\n", irc_sir_db);
   printf("\t-v [set srslte_verbose to debug, default none]\n");
   printf("\t-q Enable/Disable 256QAM modulation (default %s)\n", enable_256qam ? "enabled" : "disabled");
 }
@@ -83,7 +96,7 @@ void usage(char* prog)
 void parse_args(int argc, char** argv)
 {
   int opt;
-  while ((opt = getopt(argc, argv, "fmMcsbrtRFpnqawvXxj")) != -1) {
+  while ((opt = getopt(argc, argv, "fmMcsbrtRFpnqawvXxjWOeiI")) != -1) {
     switch (opt) {
       case 'f':
         input_file = argv[optind];
@@ -136,6 +149,23 @@ void parse_args(int argc, char** argv)
       case 'j':
         enable_coworker = true;
         break;
+      case 'W':
+        nof_cb_workers = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'O':
+        enable_offload = true;
+        break;
+      case 'e':
+        test_re_mapping = true;
+        break;
+      case 'i':
+        test_c16   = true;
+        c16_snr_db = strtof(argv[optind], NULL);
+        break;
+      case 'I':
+        test_irc   = true;
+        irc_sir_db = strtof(argv[optind], NULL);
+        break;
       case 'v':
         srslte_verbose++;
         break;
@@ -149,6 +179,26 @@ void parse_args(int argc, char** argv)
   }
 }
 
+/* Emulated offload backend: decodes every other codeblock of the batch and leaves the rest to the CPU fallback */
+static void offload_decode(void* ctx, srslte_sch_cb_offload_task_t* tasks, uint32_t nof_tasks)
+{
+  srslte_tdec_t* tdec = (srslte_tdec_t*)ctx;
+  for (uint32_t i = 0; i < nof_tasks; i += 2) {
+    srslte_sch_cb_offload_task_t* t = &tasks[i];
+    if (t->done) {
+      continue;
+    }
+    if (t->llr_is_8bit) {
+      t->crc_ok = srslte_tdec_run_all_crc_8bit(
+          tdec, t->llr, t->data, t->max_iterations, t->cb_len, t->crc, t->crc_len);
+    } else {
+      t->crc_ok = srslte_tdec_run_all_crc(tdec, t->llr, t->data, t->max_iterations, t->cb_len, t->crc, t->crc_len);
+    }
+    t->nof_iterations = (uint32_t)srslte_tdec_get_nof_iterations(tdec);
+    t->done           = true;
+  }
+}
+
 static int check_softbits(srslte_pdsch_t*     pdsch_enb,
                           srslte_pdsch_t*     pdsch_ue,
                           srslte_pdsch_cfg_t* pdsch_cfg,
@@ -186,6 +236,611 @@ static int check_softbits(srslte_pdsch_t*     pdsch_enb,
   return ret;
 }
 
+/* Reference for the resource element mapping, TS 36.211 Section 6.4: true if the RE k of the symbol l in the slot s
+ * carries PDSCH. It is evaluated RE by RE so it does not share any of the PRB run handling of srslte_pdsch_cp().
+ */
+static bool re_is_pdsch(const srslte_cell_t*        c,
+                        const srslte_pdsch_grant_t* grant,
+                        uint32_t                    lstart,
+                        uint32_t                    sf_idx,
+                        uint32_t                    s,
+                        uint32_t                    l,
+                        uint32_t                    k)
+{
+  if (!grant->prb_idx[s][k / SRSLTE_NRE] || (s == 0 && l < lstart)) {
+    return false;
+  }
+
+  // Cell-specific reference signals, the two ports of each pair are 3 REs apart
+  if (SRSLTE_SYMBOL_HAS_REF(l, c->cp, c->nof_ports)) {
+    if (c->nof_ports == 1) {
+      if (k % 6 == (c->id + (l == 0 ? 0 : 3)) % 6) {
+        return false;
+      }
+    } else if (k % 3 == c->id % 3) {
+      return false;
+    }
+  }
+
+  // PBCH and synchronisation signals take the 72 central subcarriers
+  if (k + 36 >= c->nof_prb * SRSLTE_NRE / 2 && k < c->nof_prb * SRSLTE_NRE / 2 + 36) {
+    bool pbch = (s == 1 && sf_idx == 0 && l < 4);
+    bool sync;
+    if (c->frame_type == SRSLTE_FDD) {
+      sync = (s == 0 && (sf_idx == 0 || sf_idx == 5) && l >= grant->nof_symb_slot[s] - 2);
+    } else {
+      sync = (s == 1 && (sf_idx == 0 || sf_idx == 5) && l == grant->nof_symb_slot[s] - 1) ||
+             (s == 0 && (sf_idx == 1 || sf_idx == 6) && l == 2);
+    }
+    if (pbch || sync) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Checks that the encoder maps its symbols, and the decoder extracts the symbols and the channel estimates, exactly at
+ * the REs of re_is_pdsch() and in the same order, for random cells and allocations. The allocations mix single PRB,
+ * runs of several PRB and runs crossing the PBCH and synchronisation block, with 1, 2 and 4 ports.
+ */
+static int pdsch_re_mapping_test()
+{
+  const uint32_t         prb_list[]                      = {6, 15, 25, 50, 75, 100};
+  const uint32_t         port_list[]                     = {1, 2, 4};
+  const uint32_t         nof_trials                      = 2000;
+  const uint32_t         max_nof_re                      = SRSLTE_SF_LEN_RE(SRSLTE_MAX_PRB, SRSLTE_CP_NORM);
+  const uint32_t         max_tbs                         = SRSLTE_MAX_PRB * SRSLTE_NRE; // bytes, enough for MCS 0
+  int                    ret                             = SRSLTE_ERROR;
+  srslte_pdsch_t         pdsch_tx                        = {};
+  srslte_pdsch_t         pdsch_rx                        = {};
+  srslte_softbuffer_tx_t softbuffer_tx                   = {};
+  srslte_softbuffer_rx_t softbuffer_rx                   = {};
+  srslte_chest_dl_res_t  chest_res                       = {};
+  srslte_pdsch_res_t     pdsch_res[SRSLTE_MAX_CODEWORDS] = {};
+  cf_t*                  tx_symbols[SRSLTE_MAX_PORTS]    = {};
+  cf_t*                  rx_symbols[SRSLTE_MAX_PORTS]    = {};
+  uint8_t*               data_tx[SRSLTE_MAX_CODEWORDS]   = {};
+  uint8_t*               data_rx                         = srslte_vec_u8_malloc(max_tbs);
+  srslte_tdd_config_t    tdd_config                      = {1, 7, true};
+
+  data_tx[0]    = srslte_vec_u8_malloc(max_tbs);
+  rx_symbols[0] = srslte_vec_cf_malloc(max_nof_re);
+  for (uint32_t i = 0; i < SRSLTE_MAX_PORTS; i++) {
+    tx_symbols[i] = srslte_vec_cf_malloc(max_nof_re);
+    if (!tx_symbols[i]) {
+      goto quit;
+    }
+  }
+  if (!data_rx || !data_tx[0] || !rx_symbols[0] || srslte_pdsch_init_enb(&pdsch_tx, SRSLTE_MAX_PRB) ||
+      srslte_pdsch_init_ue(&pdsch_rx, SRSLTE_MAX_PRB, 1) || srslte_softbuffer_tx_init(&softbuffer_tx, SRSLTE_MAX_PRB) ||
+      srslte_softbuffer_rx_init(&softbuffer_rx, SRSLTE_MAX_PRB) ||
+      srslte_chest_dl_res_init(&chest_res, SRSLTE_MAX_PRB)) {
+    ERROR("Error initialising the RE mapping test\n");
+    goto quit;
+  }
+  bzero(data_tx[0], max_tbs);
+
+  // Every RE of the received grid and of the channel estimates is different, so a misplaced one is found
+  for (uint32_t k = 0; k < max_nof_re; k++) {
+    rx_symbols[0][k] = (float)k;
+    for (uint32_t i = 0; i < SRSLTE_MAX_PORTS; i++) {
+      chest_res.ce[i][0][k] = (float)k + _Complex_I * (float)(i + 1);
+    }
+  }
+
+  for (uint32_t t = 0; t < nof_trials; t++) {
+    srslte_cell_t c = cell;
+    c.nof_prb       = prb_list[rand() % 6];
+    c.nof_ports     = port_list[rand() % 3];
+    c.id            = rand() % 504;
+    c.cp            = (rand() % 4) ? SRSLTE_CP_NORM : SRSLTE_CP_EXT;
+    c.frame_type    = (rand() % 2) ? SRSLTE_FDD : SRSLTE_TDD;
+
+    srslte_dl_sf_cfg_t sf = {};
+    sf.tti                = rand() % 10;
+    sf.cfi                = 1 + rand() % 3;
+    if (c.frame_type == SRSLTE_TDD) {
+      sf.tdd_config = tdd_config;
+      if (srslte_sfidx_tdd_type(tdd_config, sf.tti) == SRSLTE_TDD_SF_U) {
+        continue;
+      }
+      // The control region of the subframes 1 and 6 is 2 symbols at most, TS 36.211 Table 6.7-1
+      if (sf.tti == 1 || sf.tti == 6) {
+        sf.cfi = (c.nof_prb > 10) ? 1 + rand() % 2 : 1;
+      }
+    }
+
+    // Half of the allocations take the whole bandwidth, the others are random RBG
+    srslte_dci_dl_t dci         = {};
+    dci.rnti                    = rnti;
+    dci.format                  = SRSLTE_DCI_FORMAT1;
+    dci.type0_alloc.rbg_bitmask = (rand() % 2) ? 0xffffffff : (uint32_t)rand();
+    dci.tb[0].mcs_idx           = 0;
+    dci.tb[1].mcs_idx           = 0;
+    dci.tb[1].rv                = 1;
+
+    srslte_pdsch_cfg_t pdsch_cfg = {};
+    srslte_tm_t        tm_trial  = (c.nof_ports == 1) ? SRSLTE_TM1 : SRSLTE_TM2;
+    if (srslte_pdsch_set_cell(&pdsch_tx, c) || srslte_pdsch_set_cell(&pdsch_rx, c) ||
+        srslte_ra_dl_dci_to_grant(&c, &sf, tm_trial, false, &dci, &pdsch_cfg.grant)) {
+      continue;
+    }
+    srslte_pdsch_set_rnti(&pdsch_tx, rnti);
+    srslte_pdsch_set_rnti(&pdsch_rx, rnti);
+    pdsch_cfg.rnti               = rnti;
+    pdsch_cfg.max_nof_iterations = 1;
+    pdsch_res[0].payload         = data_rx;
+
+    uint32_t nof_re = SRSLTE_NOF_RE(c);
+    for (uint32_t i = 0; i < c.nof_ports; i++) {
+      srslte_vec_cf_zero(tx_symbols[i], nof_re);
+    }
+    pdsch_cfg.softbuffers.tx[0] = &softbuffer_tx;
+    if (srslte_pdsch_encode(&pdsch_tx, &sf, &pdsch_cfg, data_tx, tx_symbols)) {
+      ERROR("Error encoding the PDSCH of trial %d\n", t);
+      goto quit;
+    }
+    pdsch_cfg.softbuffers.rx[0] = &softbuffer_rx;
+    srslte_softbuffer_rx_reset(&softbuffer_rx);
+    if (srslte_pdsch_decode(&pdsch_rx, &sf, &pdsch_cfg, &chest_res, rx_symbols, pdsch_res)) {
+      ERROR("Error decoding the PDSCH of trial %d\n", t);
+      goto quit;
+    }
+
+    uint32_t lstart = SRSLTE_NOF_CTRL_SYMBOLS(c, sf.cfi);
+    uint32_t idx    = 0;
+    for (uint32_t s = 0; s < SRSLTE_NOF_SLOTS_PER_SF; s++) {
+      for (uint32_t l = 0; l < pdsch_cfg.grant.nof_symb_slot[s]; l++) {
+        uint32_t lp = l + s * pdsch_cfg.grant.nof_symb_slot[0];
+        for (uint32_t k = 0; k < c.nof_prb * SRSLTE_NRE; k++) {
+          uint32_t re = lp * c.nof_prb * SRSLTE_NRE + k;
+          if (!re_is_pdsch(&c, &pdsch_cfg.grant, lstart, sf.tti, s, l, k)) {
+            for (uint32_t i = 0; i < c.nof_ports; i++) {
+              if (tx_symbols[i][re] != 0.0f) {
+                ERROR("Trial %d: port %d wrote RE %d of symbol %d slot %d\n", t, i, k, l, s);
+                goto quit;
+              }
+            }
+            continue;
+          }
+          if (idx >= pdsch_cfg.grant.nof_re) {
+            ERROR("Trial %d: more PDSCH REs than the %d of the grant\n", t, pdsch_cfg.grant.nof_re);
+            goto quit;
+          }
+          for (uint32_t i = 0; i < c.nof_ports; i++) {
+            if (tx_symbols[i][re] != pdsch_tx.symbols[i][idx] || pdsch_rx.ce[i][0][idx] != chest_res.ce[i][0][re]) {
+              ERROR("Trial %d: port %d RE %d of symbol %d slot %d is not PDSCH symbol %d\n", t, i, k, l, s, idx);
+              goto quit;
+            }
+          }
+          if (pdsch_rx.symbols[0][idx] != rx_symbols[0][re]) {
+            ERROR("Trial %d: RE %d of symbol %d slot %d is not the received PDSCH symbol %d\n", t, k, l, s, idx);
+            goto quit;
+          }
+          idx++;
+        }
+      }
+    }
+    if (idx != pdsch_cfg.grant.nof_re) {
+      ERROR("Trial %d: %d PDSCH REs instead of the %d of the grant\n", t, idx, pdsch_cfg.grant.nof_re);
+      goto quit;
+    }
+  }
+  ret = SRSLTE_SUCCESS;
+
+quit:
+  srslte_pdsch_free(&pdsch_tx);
+  srslte_pdsch_free(&pdsch_rx);
+  srslte_softbuffer_tx_free(&softbuffer_tx);
+  srslte_softbuffer_rx_free(&softbuffer_rx);
+  srslte_chest_dl_res_free(&chest_res);
+  for (uint32_t i = 0; i < SRSLTE_MAX_PORTS; i++) {
+    if (tx_symbols[i]) {
+      free(tx_symbols[i]);
+    }
+    if (rx_symbols[i]) {
+      free(rx_symbols[i]);
+    }
+  }
+  if (data_tx[0]) {
+    free(data_tx[0]);
+  }
+  if (data_rx) {
+    free(data_rx);
+  }
+  printf("RE mapping test %s\n", ret ? "failed" : "passed");
+  return ret;
+}
+
+/* Decodes the same noisy subframes from the cf_t grids and channel estimates and from their int16 copies, with 1 and 2
+ * ports and 2 receive antennas. The channel is frequency selective, so the int16 scale of each symbol is set by its
+ * strongest REs and the faded ones are quantised the coarsest. The equalised symbols of both paths must match within
+ * c16_max_evm_db and the BLER from the int16 copies can not exceed the float one by more than c16_max_bler_delta.
+ */
+static int pdsch_c16_test()
+{
+  const uint32_t         nof_subframes                              = 200;
+  const float            c16_max_evm_db                             = -40.0f;
+  const float            c16_max_bler_delta                         = 0.02f;
+  const uint32_t         nof_rx                                     = 2;
+  const uint32_t         nof_re                                     = SRSLTE_SF_LEN_RE(cell.nof_prb, cell.cp);
+  const uint32_t         nof_re_symbol                              = SRSLTE_NRE * cell.nof_prb;
+  const float            n0                                         = srslte_convert_dB_to_power(-c16_snr_db);
+  int                    ret                                        = SRSLTE_ERROR;
+  srslte_pdsch_t         pdsch_tx                                   = {};
+  srslte_pdsch_t         pdsch_rx                                   = {};
+  srslte_softbuffer_tx_t softbuffer_tx                              = {};
+  srslte_softbuffer_rx_t softbuffer_rx                              = {};
+  srslte_chest_dl_res_t  chest_res                                  = {};
+  srslte_pdsch_res_t     pdsch_res[SRSLTE_MAX_CODEWORDS]            = {};
+  srslte_grid_c16_t      rx_c16[SRSLTE_MAX_PORTS]                   = {};
+  srslte_grid_c16_t      ce_c16[SRSLTE_MAX_PORTS][SRSLTE_MAX_PORTS] = {};
+  cf_t*                  tx_symbols[SRSLTE_MAX_PORTS]               = {};
+  cf_t*                  rx_symbols[SRSLTE_MAX_PORTS]               = {};
+  cf_t*                  d_float                                    = srslte_vec_cf_malloc(nof_re);
+  uint8_t*               data_tx[SRSLTE_MAX_CODEWORDS]              = {};
+  uint8_t*               data_rx                                    = NULL;
+  srslte_random_t        random                                     = srslte_random_init(0x1234);
+
+  for (uint32_t i = 0; i < SRSLTE_MAX_PORTS; i++) {
+    tx_symbols[i] = srslte_vec_cf_malloc(nof_re);
+    rx_symbols[i] = srslte_vec_cf_malloc(nof_re);
+    if (!tx_symbols[i] || !rx_symbols[i] || srslte_grid_c16_init(&rx_c16[i], cell.nof_prb)) {
+      goto quit;
+    }
+    for (uint32_t j = 0; j < SRSLTE_MAX_PORTS; j++) {
+      if (srslte_grid_c16_init(&ce_c16[i][j], cell.nof_prb)) {
+        goto quit;
+      }
+    }
+  }
+  if (!d_float || srslte_pdsch_init_enb(&pdsch_tx, cell.nof_prb) ||
+      srslte_pdsch_init_ue(&pdsch_rx, cell.nof_prb, nof_rx) ||
+      srslte_softbuffer_tx_init(&softbuffer_tx, cell.nof_prb) ||
+      srslte_softbuffer_rx_init(&softbuffer_rx, cell.nof_prb) || srslte_chest_dl_res_init(&chest_res, cell.nof_prb)) {
+    ERROR("Error initialising the int16 grid test\n");
+    goto quit;
+  }
+  chest_res.noise_estimate = n0;
+
+  for (uint32_t nof_ports = 1; nof_ports <= 2; nof_ports++) {
+    srslte_cell_t c = cell;
+    c.nof_ports     = nof_ports;
+
+    srslte_dl_sf_cfg_t sf = {};
+    sf.tti                = subframe;
+    sf.cfi                = cfi;
+
+    srslte_dci_dl_t dci         = {};
+    dci.rnti                    = rnti;
+    dci.format                  = SRSLTE_DCI_FORMAT1;
+    dci.type0_alloc.rbg_bitmask = 0xffffffff;
+    dci.tb[0].mcs_idx           = mcs[0];
+    dci.tb[1].mcs_idx           = 0;
+    dci.tb[1].rv                = 1;
+
+    srslte_pdsch_cfg_t pdsch_cfg = {};
+    srslte_tm_t        tm_c16    = (nof_ports == 1) ? SRSLTE_TM1 : SRSLTE_TM2;
+    if (srslte_pdsch_set_cell(&pdsch_tx, c) || srslte_pdsch_set_cell(&pdsch_rx, c) ||
+        srslte_ra_dl_dci_to_grant(&c, &sf, tm_c16, enable_256qam, &dci, &pdsch_cfg.grant)) {
+      ERROR("Error setting the cell with %d ports\n", nof_ports);
+      goto quit;
+    }
+    srslte_pdsch_set_rnti(&pdsch_tx, rnti);
+    srslte_pdsch_set_rnti(&pdsch_rx, rnti);
+    pdsch_cfg.rnti               = rnti;
+    pdsch_cfg.decoder_type       = SRSLTE_MIMO_DECODER_MMSE;
+    pdsch_cfg.power_scale        = true;
+    pdsch_cfg.p_a                = 0.0f;
+    pdsch_cfg.p_b                = 1;
+    pdsch_cfg.max_nof_iterations = 8;
+
+    uint32_t tbs_bytes = pdsch_cfg.grant.tb[0].tbs / 8;
+    if (data_tx[0]) {
+      free(data_tx[0]);
+    }
+    if (data_rx) {
+      free(data_rx);
+    }
+    data_tx[0]           = srslte_vec_u8_malloc(pdsch_cfg.grant.tb[0].tbs);
+    data_rx              = srslte_vec_u8_malloc(pdsch_cfg.grant.tb[0].tbs);
+    pdsch_res[0].payload = data_rx;
+    if (!data_tx[0] || !data_rx) {
+      goto quit;
+    }
+
+    uint32_t nof_errors[2] = {};
+    double   err_power     = 0.0;
+    double   ref_power     = 0.0;
+    for (uint32_t n = 0; n < nof_subframes; n++) {
+      // Three taps with Rayleigh gains, drawn for every subframe, port and antenna
+      for (uint32_t i = 0; i < nof_ports; i++) {
+        for (uint32_t j = 0; j < nof_rx; j++) {
+          cf_t a[3];
+          for (uint32_t t = 0; t < 3; t++) {
+            a[t] = (srslte_random_gauss_dist(random, 1.0f) + _Complex_I * srslte_random_gauss_dist(random, 1.0f)) /
+                   sqrtf(6.0f);
+          }
+          for (uint32_t k = 0; k < nof_re_symbol; k++) {
+            cf_t h = a[0] + a[1] * cexpf(-_Complex_I * 2.0f * M_PI * 2.0f * k / nof_re_symbol) +
+                     a[2] * cexpf(-_Complex_I * 2.0f * M_PI * 5.0f * k / nof_re_symbol);
+            for (uint32_t l = 0; l < nof_re / nof_re_symbol; l++) {
+              chest_res.ce[i][j][l * nof_re_symbol + k] = h;
+            }
+          }
+        }
+      }
+
+      for (uint32_t k = 0; k < tbs_bytes; k++) {
+        data_tx[0][k] = (uint8_t)srslte_random_uniform_int_dist(random, 0, 255);
+      }
+      for (uint32_t i = 0; i < nof_ports; i++) {
+        srslte_vec_cf_zero(tx_symbols[i], nof_re);
+      }
+      pdsch_cfg.softbuffers.tx[0] = &softbuffer_tx;
+      srslte_softbuffer_tx_reset(&softbuffer_tx);
+      if (srslte_pdsch_encode(&pdsch_tx, &sf, &pdsch_cfg, data_tx, tx_symbols)) {
+        ERROR("Error encoding the PDSCH of subframe %d\n", n);
+        goto quit;
+      }
+
+      for (uint32_t j = 0; j < nof_rx; j++) {
+        srslte_vec_prod_ccc(tx_symbols[0], chest_res.ce[0][j], rx_symbols[j], nof_re);
+        for (uint32_t i = 1; i < nof_ports; i++) {
+          srslte_vec_prod_ccc(tx_symbols[i], chest_res.ce[i][j], d_float, nof_re);
+          srslte_vec_sum_ccc(rx_symbols[j], d_float, rx_symbols[j], nof_re);
+        }
+        srslte_ch_awgn_c(rx_symbols[j], rx_symbols[j], sqrtf(n0 / 2.0f), nof_re);
+
+        // The copies are taken before the float decoder applies the power allocation to the grid in place
+        srslte_grid_c16_store(&rx_c16[j], rx_symbols[j], c.nof_prb, nof_re / nof_re_symbol);
+        for (uint32_t i = 0; i < nof_ports; i++) {
+          srslte_grid_c16_store(&ce_c16[i][j], chest_res.ce[i][j], c.nof_prb, nof_re / nof_re_symbol);
+        }
+      }
+
+      pdsch_cfg.softbuffers.rx[0] = &softbuffer_rx;
+      srslte_softbuffer_rx_reset(&softbuffer_rx);
+      pdsch_res[0].crc = false;
+      if (srslte_pdsch_decode(&pdsch_rx, &sf, &pdsch_cfg, &chest_res, rx_symbols, pdsch_res)) {
+        ERROR("Error decoding the PDSCH of subframe %d\n", n);
+        goto quit;
+      }
+      nof_errors[0] += (pdsch_res[0].crc && memcmp(data_rx, data_tx[0], tbs_bytes) == 0) ? 0 : 1;
+      srslte_vec_cf_copy(d_float, pdsch_rx.d[0], pdsch_cfg.grant.nof_re);
+
+      srslte_softbuffer_rx_reset(&softbuffer_rx);
+      pdsch_res[0].crc = false;
+      if (srslte_pdsch_decode_c16(&pdsch_rx, &sf, &pdsch_cfg, &chest_res, rx_c16, ce_c16, pdsch_res)) {
+        ERROR("Error decoding the PDSCH of subframe %d from the int16 grids\n", n);
+        goto quit;
+      }
+      nof_errors[1] += (pdsch_res[0].crc && memcmp(data_rx, data_tx[0], tbs_bytes) == 0) ? 0 : 1;
+      for (uint32_t k = 0; k < pdsch_cfg.grant.nof_re; k++) {
+        err_power += __real__(pdsch_rx.d[0][k] - d_float[k]) * __real__(pdsch_rx.d[0][k] - d_float[k]) +
+                     __imag__(pdsch_rx.d[0][k] - d_float[k]) * __imag__(pdsch_rx.d[0][k] - d_float[k]);
+        ref_power += __real__ d_float[k] * __real__ d_float[k] + __imag__ d_float[k] * __imag__ d_float[k];
+      }
+    }
+
+    float bler[2] = {(float)nof_errors[0] / nof_subframes, (float)nof_errors[1] / nof_subframes};
+    float evm_db  = srslte_convert_power_to_dB((float)(err_power / ref_power));
+    printf("int16 grids with %d port(s) at %.1f dB: BLER float=%.3f int16=%.3f, EVM int16 vs float=%.1f dB\n",
+           nof_ports,
+           c16_snr_db,
+           bler[0],
+           bler[1],
+           evm_db);
+    if (evm_db > c16_max_evm_db || bler[1] > bler[0] + c16_max_bler_delta) {
+      goto quit;
+    }
+  }
+  ret = SRSLTE_SUCCESS;
+
+quit:
+  srslte_pdsch_free(&pdsch_tx);
+  srslte_pdsch_free(&pdsch_rx);
+  srslte_softbuffer_tx_free(&softbuffer_tx);
+  srslte_softbuffer_rx_free(&softbuffer_rx);
+  srslte_chest_dl_res_free(&chest_res);
+  for (uint32_t i = 0; i < SRSLTE_MAX_PORTS; i++) {
+    if (tx_symbols[i]) {
+      free(tx_symbols[i]);
+    }
+    if (rx_symbols[i]) {
+      free(rx_symbols[i]);
+    }
+    srslte_grid_c16_free(&rx_c16[i]);
+    for (uint32_t j = 0; j < SRSLTE_MAX_PORTS; j++) {
+      srslte_grid_c16_free(&ce_c16[i][j]);
+    }
+  }
+  if (d_float) {
+    free(d_float);
+  }
+  if (data_tx[0]) {
+    free(data_tx[0]);
+  }
+  if (data_rx) {
+    free(data_rx);
+  }
+  srslte_random_free(random);
+  printf("int16 grid test %s\n", ret ? "failed" : "passed");
+  return ret;
+}
+
+/* Decodes TM1 subframes received by 2 antennas with a flat interferer at irc_sir_db and a 20 dB SNR, with and without
+ * IRC. The channel estimates are ideal and the CRS residuals hold other samples of the same interference plus noise,
+ * as chest_dl would estimate them. IRC must reject the interferer: its BLER can not exceed irc_max_bler nor the MRC
+ * one.
+ */
+static int pdsch_irc_test()
+{
+  const uint32_t         nof_subframes                   = 100;
+  const float            irc_max_bler                    = 0.05f;
+  const uint32_t         nof_rx                          = 2;
+  const uint32_t         nof_re                          = SRSLTE_SF_LEN_RE(cell.nof_prb, cell.cp);
+  const uint32_t         nof_re_symbol                   = SRSLTE_NRE * cell.nof_prb;
+  const uint32_t         nof_residual                    = SRSLTE_REFSIGNAL_MAX_NUM_SF(cell.nof_prb);
+  const float            n0                              = srslte_convert_dB_to_power(-20.0f);
+  const float            i_std                           = sqrtf(srslte_convert_dB_to_power(-irc_sir_db) / 2.0f);
+  int                    ret                             = SRSLTE_ERROR;
+  srslte_pdsch_t         pdsch_tx                        = {};
+  srslte_pdsch_t         pdsch_rx                        = {};
+  srslte_softbuffer_tx_t softbuffer_tx                   = {};
+  srslte_softbuffer_rx_t softbuffer_rx                   = {};
+  srslte_chest_dl_res_t  chest_res                       = {};
+  srslte_pdsch_res_t     pdsch_res[SRSLTE_MAX_CODEWORDS] = {};
+  cf_t*                  tx_symbols[SRSLTE_MAX_PORTS]    = {};
+  cf_t*                  rx_symbols[SRSLTE_MAX_PORTS]    = {};
+  uint8_t*               data_tx[SRSLTE_MAX_CODEWORDS]   = {};
+  uint8_t*               data_rx                         = NULL;
+  srslte_random_t        random                          = srslte_random_init(0x1234);
+
+  for (uint32_t j = 0; j < nof_rx; j++) {
+    tx_symbols[j] = srslte_vec_cf_malloc(nof_re);
+    rx_symbols[j] = srslte_vec_cf_malloc(nof_re);
+    if (!tx_symbols[j] || !rx_symbols[j]) {
+      goto quit;
+    }
+  }
+
+  srslte_dl_sf_cfg_t sf = {};
+  sf.tti                = subframe;
+  sf.cfi                = cfi;
+
+  srslte_dci_dl_t dci         = {};
+  dci.rnti                    = rnti;
+  dci.format                  = SRSLTE_DCI_FORMAT1;
+  dci.type0_alloc.rbg_bitmask = 0xffffffff;
+  dci.tb[0].mcs_idx           = mcs[0];
+  dci.tb[1].mcs_idx           = 0;
+  dci.tb[1].rv                = 1;
+
+  srslte_pdsch_cfg_t pdsch_cfg = {};
+  if (srslte_pdsch_init_enb(&pdsch_tx, cell.nof_prb) || srslte_pdsch_init_ue(&pdsch_rx, cell.nof_prb, nof_rx) ||
+      srslte_softbuffer_tx_init(&softbuffer_tx, cell.nof_prb) ||
+      srslte_softbuffer_rx_init(&softbuffer_rx, cell.nof_prb) || srslte_chest_dl_res_init(&chest_res, cell.nof_prb) ||
+      srslte_pdsch_set_cell(&pdsch_tx, cell) || srslte_pdsch_set_cell(&pdsch_rx, cell) ||
+      srslte_ra_dl_dci_to_grant(&cell, &sf, SRSLTE_TM1, enable_256qam, &dci, &pdsch_cfg.grant)) {
+    ERROR("Error initialising the IRC test\n");
+    goto quit;
+  }
+  srslte_pdsch_set_rnti(&pdsch_tx, rnti);
+  srslte_pdsch_set_rnti(&pdsch_rx, rnti);
+  pdsch_cfg.rnti               = rnti;
+  pdsch_cfg.decoder_type       = SRSLTE_MIMO_DECODER_MMSE;
+  pdsch_cfg.csi_enable         = true;
+  pdsch_cfg.max_nof_iterations = 8;
+  chest_res.noise_estimate     = n0;
+  chest_res.nof_crs_residual   = nof_residual;
+
+  uint32_t tbs_bytes   = pdsch_cfg.grant.tb[0].tbs / 8;
+  data_tx[0]           = srslte_vec_u8_malloc(pdsch_cfg.grant.tb[0].tbs);
+  data_rx              = srslte_vec_u8_malloc(pdsch_cfg.grant.tb[0].tbs);
+  pdsch_res[0].payload = data_rx;
+  if (!data_tx[0] || !data_rx) {
+    goto quit;
+  }
+
+  uint32_t nof_errors[2] = {};
+  for (uint32_t n = 0; n < nof_subframes; n++) {
+    // Three taps with Rayleigh gains for the cell and a flat Rayleigh gain for the interferer, for every antenna
+    cf_t g[SRSLTE_MAX_PORTS] = {};
+    for (uint32_t j = 0; j < nof_rx; j++) {
+      cf_t a[3];
+      for (uint32_t t = 0; t < 3; t++) {
+        a[t] = (srslte_random_gauss_dist(random, 1.0f) + _Complex_I * srslte_random_gauss_dist(random, 1.0f)) /
+               sqrtf(6.0f);
+      }
+      for (uint32_t k = 0; k < nof_re_symbol; k++) {
+        cf_t h = a[0] + a[1] * cexpf(-_Complex_I * 2.0f * M_PI * 2.0f * k / nof_re_symbol) +
+                 a[2] * cexpf(-_Complex_I * 2.0f * M_PI * 5.0f * k / nof_re_symbol);
+        for (uint32_t l = 0; l < nof_re / nof_re_symbol; l++) {
+          chest_res.ce[0][j][l * nof_re_symbol + k] = h;
+        }
+      }
+      g[j] = (srslte_random_gauss_dist(random, 1.0f) + _Complex_I * srslte_random_gauss_dist(random, 1.0f)) /
+             sqrtf(2.0f);
+    }
+
+    for (uint32_t k = 0; k < tbs_bytes; k++) {
+      data_tx[0][k] = (uint8_t)srslte_random_uniform_int_dist(random, 0, 255);
+    }
+    srslte_vec_cf_zero(tx_symbols[0], nof_re);
+    pdsch_cfg.softbuffers.tx[0] = &softbuffer_tx;
+    srslte_softbuffer_tx_reset(&softbuffer_tx);
+    if (srslte_pdsch_encode(&pdsch_tx, &sf, &pdsch_cfg, data_tx, tx_symbols)) {
+      ERROR("Error encoding the PDSCH of subframe %d\n", n);
+      goto quit;
+    }
+
+    // Every RE carries an interfering QPSK symbol, the CRS residuals are made of other ones
+    for (uint32_t k = 0; k < SRSLTE_MAX(nof_re, nof_residual); k++) {
+      cf_t i_data = (srslte_random_bool(random, 0.5f) ? i_std : -i_std) +
+                    _Complex_I * (srslte_random_bool(random, 0.5f) ? i_std : -i_std);
+      cf_t i_crs = (srslte_random_bool(random, 0.5f) ? i_std : -i_std) +
+                   _Complex_I * (srslte_random_bool(random, 0.5f) ? i_std : -i_std);
+      for (uint32_t j = 0; j < nof_rx; j++) {
+        if (k < nof_re) {
+          rx_symbols[j][k] = tx_symbols[0][k] * chest_res.ce[0][j][k] + g[j] * i_data;
+        }
+        if (k < nof_residual) {
+          chest_res.crs_residual[j][k] = g[j] * i_crs;
+        }
+      }
+    }
+    for (uint32_t j = 0; j < nof_rx; j++) {
+      srslte_ch_awgn_c(rx_symbols[j], rx_symbols[j], sqrtf(n0 / 2.0f), nof_re);
+      srslte_ch_awgn_c(chest_res.crs_residual[j], chest_res.crs_residual[j], sqrtf(n0 / 2.0f), nof_residual);
+    }
+
+    // MRC first and IRC on the same subframe
+    for (uint32_t e = 0; e < 2; e++) {
+      pdsch_cfg.irc_enable        = (e == 1);
+      pdsch_cfg.softbuffers.rx[0] = &softbuffer_rx;
+      srslte_softbuffer_rx_reset(&softbuffer_rx);
+      pdsch_res[0].crc = false;
+      if (srslte_pdsch_decode(&pdsch_rx, &sf, &pdsch_cfg, &chest_res, rx_symbols, pdsch_res)) {
+        ERROR("Error decoding the PDSCH of subframe %d\n", n);
+        goto quit;
+      }
+      nof_errors[e] += (pdsch_res[0].crc && memcmp(data_rx, data_tx[0], tbs_bytes) == 0) ? 0 : 1;
+    }
+  }
+
+  float bler[2] = {(float)nof_errors[0] / nof_subframes, (float)nof_errors[1] / nof_subframes};
+  printf("Interferer at %.1f dB SIR: BLER MRC=%.3f IRC=%.3f\n", irc_sir_db, bler[0], bler[1]);
+  if (bler[1] <= irc_max_bler && bler[1] <= bler[0]) {
+    ret = SRSLTE_SUCCESS;
+  }
+
+quit:
+  srslte_pdsch_free(&pdsch_tx);
+  srslte_pdsch_free(&pdsch_rx);
+  srslte_softbuffer_tx_free(&softbuffer_tx);
+  srslte_softbuffer_rx_free(&softbuffer_rx);
+  srslte_chest_dl_res_free(&chest_res);
+  for (uint32_t j = 0; j < SRSLTE_MAX_PORTS; j++) {
+    if (tx_symbols[j]) {
+      free(tx_symbols[j]);
+    }
+    if (rx_symbols[j]) {
+      free(rx_symbols[j]);
+    }
+  }
+  if (data_tx[0]) {
+    free(data_tx[0]);
+  }
+  if (data_rx) {
+    free(data_rx);
+  }
+  srslte_random_free(random);
+  printf("IRC test %s\n", ret ? "failed" : "passed");
+  return ret;
+}
+
 int main(int argc, char** argv)
 {
   int                     ret  = -1;
@@ -201,6 +856,9 @@ int main(int argc, char** argv)
   cf_t*                   tx_slot_symbols[SRSLTE_MAX_PORTS];
   cf_t*                   rx_slot_symbols[SRSLTE_MAX_PORTS];
   srslte_pdsch_t          pdsch_tx, pdsch_rx;
+  srslte_sch_cb_pool_t    cb_pool;
+  bool                    cb_pool_ready = false;
+  srslte_tdec_t           offload_tdec  = {};
   srslte_ofdm_t           ofdm_tx[SRSLTE_MAX_PORTS];
   srslte_ofdm_t           ofdm_rx[SRSLTE_MAX_PORTS];
   srslte_chest_dl_t       chest;
@@ -226,6 +884,18 @@ int main(int argc, char** argv)
 
   parse_args(argc, argv);
 
+  if (test_re_mapping) {
+    exit(pdsch_re_mapping_test());
+  }
+
+  if (test_c16) {
+    exit(pdsch_c16_test());
+  }
+
+  if (test_irc) {
+    exit(pdsch_irc_test());
+  }
+
   if (tm == SRSLTE_TM1) {
     cell.nof_ports = 1;
     mcs[1]         = 0;
@@ -338,6 +1008,28 @@ int main(int argc, char** argv)
   pdsch_rx.llr_is_8bit        = use_8_bit;
   pdsch_rx.dl_sch.llr_is_8bit = use_8_bit;
 
+  if (nof_cb_workers) {
+    if (srslte_sch_cb_pool_init(&cb_pool, nof_cb_workers)) {
+      ERROR("Error creating codeblock decoder pool\n");
+      goto quit;
+    }
+    cb_pool_ready = true;
+    srslte_sch_set_cb_pool(&pdsch_rx.dl_sch, &cb_pool);
+
+    if (enable_offload) {
+      srslte_sch_cb_offload_t offload = {};
+      offload.ctx                     = &offload_tdec;
+      offload.decode                  = offload_decode;
+      offload.max_batch               = 8;
+      offload.budget_us               = 1000;
+      if (srslte_tdec_init(&offload_tdec, SRSLTE_TCOD_MAX_LEN_CB) ||
+          srslte_sch_cb_pool_set_offload(&cb_pool, &offload)) {
+        ERROR("Error setting the codeblock offload backend\n");
+        goto quit;
+      }
+    }
+  }
+
   srslte_pdsch_set_rnti(&pdsch_rx, rnti);
 
   for (uint32_t i = 0; i < SRSLTE_MAX_CODEWORDS; i++) {
@@ -347,7 +1039,9 @@ int main(int argc, char** argv)
       goto quit;
     }
 
-    if (srslte_softbuffer_rx_init(softbuffers_rx[i], cell.nof_prb)) {
+    int sb_ret = use_8_bit ? srslte_softbuffer_rx_init_8bit(softbuffers_rx[i], cell.nof_prb)
+                           : srslte_softbuffer_rx_init(softbuffers_rx[i], cell.nof_prb);
+    if (sb_ret) {
       ERROR("Error initiating RX soft buffer\n");
       goto quit;
     }
@@ -555,6 +1249,15 @@ quit:
   srslte_chest_dl_free(&chest);
   srslte_pdsch_free(&pdsch_tx);
   srslte_pdsch_free(&pdsch_rx);
+  if (cb_pool_ready) {
+    if (enable_offload) {
+      printf("Offloaded %" PRIu64 " codeblocks, %" PRIu64 " decoded by the CPU fallback\n",
+             cb_pool.nof_cb_offload,
+             cb_pool.nof_cb_fallback);
+    }
+    srslte_sch_cb_pool_free(&cb_pool);
+  }
+  srslte_tdec_free(&offload_tdec);
   for (uint32_t i = 0; i < SRSLTE_MAX_CODEWORDS; i++) {
     srslte_softbuffer_tx_free(softbuffers_tx[i]);
     if (softbuffers_tx[i]) {
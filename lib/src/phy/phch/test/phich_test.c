@@ -103,11 +103,18 @@ int main(int argc, char** argv)
   int            i, j;
   int            nof_re;
   cf_t*          slot_symbols[SRSLTE_MAX_PORTS];
+  cf_t*          batch_symbols[SRSLTE_MAX_PORTS];
   uint8_t        ack[50][SRSLTE_PHICH_NORM_NSEQUENCES];
   uint32_t       nsf;
   int            cid, max_cid;
   uint32_t       ngroup, nseq, max_nseq;
 
+  /* the same HI are also encoded and decoded at once with the batched functions */
+  static srslte_phich_resource_t batch_resource[SRSLTE_PHICH_MAX_NGROUPS * SRSLTE_PHICH_NORM_NSEQUENCES];
+  static uint8_t                 batch_ack[SRSLTE_PHICH_MAX_NGROUPS * SRSLTE_PHICH_NORM_NSEQUENCES];
+  static srslte_phich_res_t      batch_result[SRSLTE_PHICH_MAX_NGROUPS * SRSLTE_PHICH_NORM_NSEQUENCES];
+  uint32_t                       nof_hi;
+
   parse_args(argc, argv);
 
   max_nseq = SRSLTE_CP_ISNORM(cell.cp) ? SRSLTE_PHICH_NORM_NSEQUENCES : SRSLTE_PHICH_EXT_NSEQUENCES;
@@ -121,8 +128,9 @@ int main(int argc, char** argv)
   srslte_chest_dl_res_set_ones(&chest_res);
 
   for (i = 0; i < SRSLTE_MAX_PORTS; i++) {
-    slot_symbols[i] = srslte_vec_cf_malloc(nof_re);
-    if (!slot_symbols[i]) {
+    slot_symbols[i]  = srslte_vec_cf_malloc(nof_re);
+    batch_symbols[i] = srslte_vec_cf_malloc(nof_re);
+    if (!slot_symbols[i] || !batch_symbols[i]) {
       perror("malloc");
       exit(-1);
     }
@@ -164,6 +172,7 @@ int main(int argc, char** argv)
       srslte_phich_reset(&phich, slot_symbols);
 
       srslte_phich_resource_t resource;
+      nof_hi = 0;
 
       /* Transmit all PHICH groups and sequence numbers */
       for (ngroup = 0; ngroup < srslte_phich_ngroups(&phich); ngroup++) {
@@ -175,6 +184,28 @@ int main(int argc, char** argv)
           ack[ngroup][nseq] = rand() % 2;
 
           srslte_phich_encode(&phich, &dl_sf, resource, ack[ngroup][nseq], slot_symbols);
+
+          batch_resource[nof_hi] = resource;
+          batch_ack[nof_hi]      = ack[ngroup][nseq];
+          nof_hi++;
+        }
+      }
+
+      /* The batched encoder gives the same resource grid */
+      for (i = 0; i < cell.nof_ports; i++) {
+        srslte_vec_cf_copy(batch_symbols[i], slot_symbols[i], nof_re);
+      }
+      srslte_phich_reset(&phich, batch_symbols);
+      if (srslte_phich_encode_batch(&phich, &dl_sf, batch_resource, batch_ack, nof_hi, batch_symbols)) {
+        printf("Error encoding ACK batch\n");
+        exit(-1);
+      }
+      for (i = 0; i < cell.nof_ports; i++) {
+        for (j = 0; j < nof_re; j++) {
+          if (cabsf(batch_symbols[i][j] - slot_symbols[i][j]) > 1e-5) {
+            printf("Batched encoding mismatch in port %d RE %d\n", i, j);
+            exit(-1);
+          }
         }
       }
       /* combine outputs */
@@ -214,6 +245,18 @@ int main(int argc, char** argv)
           }
         }
       }
+
+      /* Receive them again at once */
+      if (srslte_phich_decode_batch(&phich, &dl_sf, &chest_res, batch_resource, nof_hi, slot_symbols, batch_result)) {
+        printf("Error decoding ACK batch\n");
+        exit(-1);
+      }
+      for (i = 0; i < nof_hi; i++) {
+        if (batch_ack[i] != batch_result[i].ack_value || batch_result[i].distance < 0.99) {
+          printf("Invalid received ACK in batch: %d!=%d\n", batch_ack[i], batch_result[i].ack_value);
+          exit(-1);
+        }
+      }
     }
     srslte_regs_free(&regs);
     cid++;
@@ -224,6 +267,7 @@ int main(int argc, char** argv)
 
   for (i = 0; i < SRSLTE_MAX_PORTS; i++) {
     free(slot_symbols[i]);
+    free(batch_symbols[i]);
   }
   printf("OK\n");
   exit(0);
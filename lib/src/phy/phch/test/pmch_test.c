@@ -121,6 +121,40 @@ void parse_args(int argc, char** argv)
   }
 }
 
+/* Checks that the grid holds the PMCH symbols exactly at the REs outside the control region and the MBSFN reference
+ * signals, TS 36.211 Section 6.10.2.2, and in the same order. These REs are found one by one, without the whole symbol
+ * copies of the PMCH, and with check_unused the others must be empty.
+ */
+static int check_re_mapping(const cf_t* grid, const cf_t* symbols, uint32_t nof_re, uint32_t lstart, bool check_unused)
+{
+  uint32_t idx = 0;
+  for (uint32_t s = 0; s < SRSLTE_NOF_SLOTS_PER_SF; s++) {
+    for (uint32_t l = 0; l < SRSLTE_CP_EXT_NSYMB; l++) {
+      for (uint32_t k = 0; k < cell.nof_prb * SRSLTE_NRE; k++) {
+        uint32_t re     = (l + s * SRSLTE_CP_EXT_NSYMB) * cell.nof_prb * SRSLTE_NRE + k;
+        bool     is_ref = SRSLTE_SYMBOL_HAS_REF_MBSFN(l, s) && k % 2 == ((l == 0 && s == 1) ? 1 : 0);
+        if ((s == 0 && l < lstart) || is_ref) {
+          if (check_unused && grid[re] != 0.0f) {
+            ERROR("RE %d of symbol %d slot %d is not PMCH but it was written\n", k, l, s);
+            return SRSLTE_ERROR;
+          }
+          continue;
+        }
+        if (idx >= nof_re || grid[re] != symbols[idx]) {
+          ERROR("RE %d of symbol %d slot %d is not PMCH symbol %d of %d\n", k, l, s, idx, nof_re);
+          return SRSLTE_ERROR;
+        }
+        idx++;
+      }
+    }
+  }
+  if (idx != nof_re) {
+    ERROR("Found %d PMCH REs instead of %d\n", idx, nof_re);
+    return SRSLTE_ERROR;
+  }
+  return SRSLTE_SUCCESS;
+}
+
 int main(int argc, char** argv)
 {
   uint32_t       i, j, k;
@@ -303,6 +337,11 @@ int main(int argc, char** argv)
     ERROR("Error encoding PDSCH\n");
     exit(-1);
   }
+  uint32_t lstart = SRSLTE_NOF_CTRL_SYMBOLS(cell, cfi);
+  if (check_re_mapping(tx_slot_symbols[0], pmch.symbols[0], pmch_cfg.pdsch_cfg.grant.nof_re, lstart, true)) {
+    ERROR("Error in the PMCH resource element mapping\n");
+    goto quit;
+  }
   gettimeofday(&t[2], NULL);
   get_time_interval(t);
   printf("ENCODED in %.2f (PHY bitrate=%.2f Mbps. Processing bitrate=%.2f Mbps)\n",
@@ -359,6 +398,10 @@ int main(int argc, char** argv)
   pdsch_res[0].payload = data_rx[0];
 
   r = srslte_pmch_decode(&pmch, &dl_sf, &pmch_cfg, &chest_dl_res, rx_slot_symbols, pdsch_res);
+  if (check_re_mapping(rx_slot_symbols[0], pmch.symbols[0], pmch_cfg.pdsch_cfg.grant.nof_re, lstart, false)) {
+    ERROR("Error in the PMCH resource element extraction\n");
+    goto quit;
+  }
   gettimeofday(&t[2], NULL);
   get_time_interval(t);
   printf("DECODED %s in %.2f (PHY bitrate=%.2f Mbps. Processing bitrate=%.2f Mbps)\n",
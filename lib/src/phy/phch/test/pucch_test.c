@@ -41,21 +41,23 @@ srslte_cell_t cell = {
 
 uint32_t subframe      = 0;
 bool     test_cqi_only = false;
+bool     test_multi_ue = false;
 
 void usage(char* prog)
 {
-  printf("Usage: %s [csNnv]\n", prog);
+  printf("Usage: %s [csNnmqv]\n", prog);
   printf("\t-c cell id [Default %d]\n", cell.id);
   printf("\t-s subframe [Default %d]\n", subframe);
   printf("\t-n nof_prb [Default %d]\n", cell.nof_prb);
   printf("\t-q Test CQI encoding/decoding only [Default %s].\n", test_cqi_only ? "yes" : "no");
+  printf("\t-m Test several UEs multiplexed in the same subframe only [Default %s].\n", test_multi_ue ? "yes" : "no");
   printf("\t-v [set verbose to debug, default none]\n");
 }
 
 void parse_args(int argc, char** argv)
 {
   int opt;
-  while ((opt = getopt(argc, argv, "csNnqv")) != -1) {
+  while ((opt = getopt(argc, argv, "csNnmqv")) != -1) {
     switch (opt) {
       case 's':
         subframe = (uint32_t)strtol(argv[optind], NULL, 10);
@@ -69,6 +71,9 @@ void parse_args(int argc, char** argv)
       case 'q':
         test_cqi_only = true;
         break;
+      case 'm':
+        test_multi_ue = true;
+        break;
       case 'v':
         srslte_verbose++;
         break;
@@ -133,6 +138,159 @@ int test_uci_cqi_pucch(void)
   return ret;
 }
 
+#define MULTI_UE_NOF_UE 12
+#define MULTI_UE_NOF_SF 10
+
+/* Checks the UCI decoded by the eNodeB against the UCI sent in the given format */
+static bool uci_match(srslte_pucch_format_t format, srslte_pucch_res_t* res, srslte_uci_value_t* uci)
+{
+  if (!res->detected) {
+    return false;
+  }
+  if (format == SRSLTE_PUCCH_FORMAT_1) {
+    return res->uci_data.scheduling_request;
+  }
+  uint32_t nof_ack = srslte_pucch_nof_ack_format(format);
+  if (nof_ack > 0 && !res->uci_data.ack.valid) {
+    return false;
+  }
+  for (uint32_t a = 0; a < nof_ack; a++) {
+    if (res->uci_data.ack.ack_value[a] != uci->ack.ack_value[a]) {
+      return false;
+    }
+  }
+  return format < SRSLTE_PUCCH_FORMAT_2 || res->uci_data.cqi.wideband.wideband_cqi == uci->cqi.wideband.wideband_cqi;
+}
+
+/*
+ * Several UEs with different formats and resources share the PUCCH RBs of a subframe. Every UE is decoded from the
+ * multiplexed subframe and from a subframe where it is alone, and both must match what it sent
+ */
+int test_pucch_multi_ue(void)
+{
+  int                   ret        = SRSLTE_ERROR;
+  srslte_pucch_t        pucch_ue   = {};
+  srslte_pucch_t        pucch_enb  = {};
+  srslte_refsignal_ul_t dmrs       = {};
+  srslte_chest_ul_res_t chest_res  = {};
+  srslte_pucch_cfg_t    cfg[MULTI_UE_NOF_UE];
+  srslte_uci_value_t    uci[MULTI_UE_NOF_UE];
+  cf_t                  pucch_dmrs[2 * SRSLTE_NRE * 3];
+  cf_t*                 sf_single  = srslte_vec_cf_malloc(SRSLTE_NOF_RE(cell));
+  cf_t*                 sf_multi   = srslte_vec_cf_malloc(SRSLTE_NOF_RE(cell));
+  uint32_t              nof_errors = 0;
+  srslte_random_t       random_gen = srslte_random_init(0);
+
+  if (!sf_single || !sf_multi || srslte_pucch_init_ue(&pucch_ue) || srslte_pucch_init_enb(&pucch_enb) ||
+      srslte_pucch_set_cell(&pucch_ue, cell) || srslte_pucch_set_cell(&pucch_enb, cell) ||
+      srslte_refsignal_ul_init(&dmrs, cell.nof_prb) || srslte_refsignal_ul_set_cell(&dmrs, cell)) {
+    ERROR("Error initiating PUCCH\n");
+    goto quit;
+  }
+
+  // The formats 1 use the RBs after the two RBs of the formats 2, both spread over two RBs
+  for (uint32_t i = 0; i < MULTI_UE_NOF_UE; i++) {
+    srslte_pucch_cfg_t* c = &cfg[i];
+    ZERO_OBJECT(*c);
+    c->rnti                              = (uint16_t)(0x46 + i);
+    c->delta_pucch_shift                 = 2;
+    c->N_cs                              = 0;
+    c->n_rb_2                            = 2;
+    c->format                            = (srslte_pucch_format_t)(i % SRSLTE_PUCCH_FORMAT_3);
+    c->n_pucch                           = c->format < SRSLTE_PUCCH_FORMAT_2 ? 3 * i : 2 * i;
+    c->threshold_format1                 = SRSLTE_PUCCH_DEFAULT_THRESHOLD_FORMAT1;
+    c->threshold_data_valid_format1a     = SRSLTE_PUCCH_DEFAULT_THRESHOLD_FORMAT1A;
+    c->threshold_data_valid_format2      = SRSLTE_PUCCH_DEFAULT_THRESHOLD_FORMAT2;
+    c->threshold_dmrs_detection          = SRSLTE_PUCCH_DEFAULT_THRESHOLD_DMRS;
+    c->uci_cfg.ack[0].nof_acks           = srslte_pucch_nof_ack_format(c->format);
+    c->uci_cfg.is_scheduling_request_tti = c->format == SRSLTE_PUCCH_FORMAT_1;
+    if (c->format >= SRSLTE_PUCCH_FORMAT_2) {
+      c->uci_cfg.cqi.data_enable = true;
+      c->uci_cfg.cqi.type        = SRSLTE_CQI_TYPE_WIDEBAND;
+    }
+    if (srslte_pucch_set_rnti(&pucch_enb, c->rnti)) {
+      ERROR("Error setting C-RNTI\n");
+      goto quit;
+    }
+  }
+
+  for (uint32_t tti = 0; tti < MULTI_UE_NOF_SF; tti++) {
+    srslte_ul_sf_cfg_t ul_sf;
+    ZERO_OBJECT(ul_sf);
+    ul_sf.tti = tti;
+
+    srslte_vec_cf_zero(sf_multi, SRSLTE_NOF_RE(cell));
+    for (uint32_t i = 0; i < MULTI_UE_NOF_UE; i++) {
+      ZERO_OBJECT(uci[i]);
+      uci[i].scheduling_request        = cfg[i].format == SRSLTE_PUCCH_FORMAT_1;
+      uci[i].ack.ack_value[0]          = (uint8_t)srslte_random_uniform_int_dist(random_gen, 0, 1);
+      uci[i].ack.ack_value[1]          = (uint8_t)srslte_random_uniform_int_dist(random_gen, 0, 1);
+      uci[i].cqi.wideband.wideband_cqi = (uint8_t)srslte_random_uniform_int_dist(random_gen, 0, 15);
+
+      srslte_vec_cf_zero(sf_single, SRSLTE_NOF_RE(cell));
+      if (srslte_pucch_set_rnti(&pucch_ue, cfg[i].rnti) ||
+          srslte_pucch_encode(&pucch_ue, &ul_sf, &cfg[i], &uci[i], sf_single) ||
+          srslte_refsignal_dmrs_pucch_gen(&dmrs, &ul_sf, &cfg[i], pucch_dmrs) ||
+          srslte_refsignal_dmrs_pucch_put(&dmrs, &cfg[i], pucch_dmrs, sf_single)) {
+        ERROR("Error encoding PUCCH\n");
+        goto quit;
+      }
+      srslte_vec_sum_ccc(sf_multi, sf_single, sf_multi, SRSLTE_NOF_RE(cell));
+
+      // Decode the UE alone, the buffer is reused for every UE so the despread RBs are discarded first
+      srslte_pucch_res_t res = {};
+      srslte_pucch_despread_reset(&pucch_enb);
+      if (srslte_pucch_decode(&pucch_enb, &ul_sf, &cfg[i], &chest_res, sf_single, &res)) {
+        ERROR("Error decoding PUCCH\n");
+        goto quit;
+      }
+      if (!uci_match(cfg[i].format, &res, &uci[i])) {
+        printf("tti=%d; rnti=0x%x; format=%d; n_pucch=%d; decoded alone wrong\n",
+               tti, cfg[i].rnti, cfg[i].format, cfg[i].n_pucch);
+        nof_errors++;
+      }
+    }
+
+    srslte_pucch_despread_reset(&pucch_enb);
+    for (uint32_t i = 0; i < MULTI_UE_NOF_UE; i++) {
+      srslte_pucch_res_t res = {};
+      if (srslte_pucch_decode(&pucch_enb, &ul_sf, &cfg[i], &chest_res, sf_multi, &res)) {
+        ERROR("Error decoding PUCCH\n");
+        goto quit;
+      }
+      if (!uci_match(cfg[i].format, &res, &uci[i])) {
+        printf("tti=%d; rnti=0x%x; format=%d; n_pucch=%d; decoded multiplexed wrong\n",
+               tti, cfg[i].rnti, cfg[i].format, cfg[i].n_pucch);
+        nof_errors++;
+      }
+    }
+  }
+
+  if (nof_errors == 0) {
+    ret = SRSLTE_SUCCESS;
+  }
+
+quit:
+  srslte_pucch_free(&pucch_ue);
+  srslte_pucch_free(&pucch_enb);
+  srslte_refsignal_ul_free(&dmrs);
+  srslte_random_free(random_gen);
+  if (sf_single) {
+    free(sf_single);
+  }
+  if (sf_multi) {
+    free(sf_multi);
+  }
+
+  printf("Multi-UE: %d errors in %d subframes of %d UEs\n", nof_errors, MULTI_UE_NOF_SF, MULTI_UE_NOF_UE);
+  if (ret) {
+    printf("Error\n");
+  } else {
+    printf("Ok\n");
+  }
+  return ret;
+}
+
 int main(int argc, char** argv)
 {
   srslte_pucch_t        pucch;
@@ -148,6 +306,10 @@ int main(int argc, char** argv)
     return test_uci_cqi_pucch();
   }
 
+  if (test_multi_ue) {
+    return test_pucch_multi_ue();
+  }
+
   if (srslte_pucch_init_ue(&pucch)) {
     ERROR("Error creating PDSCH object\n");
     exit(-1);
@@ -0,0 +1,298 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "srslte/phy/utils/random.h"
+#include "srslte/srslte.h"
+
+/*
+ * Checks the Reed-Muller decoders of the UCI against a brute force correlation with every codeword, which is how they
+ * were decoded before the fast Hadamard transform. Random words are encoded, noise is added and both decoders must
+ * give the same word and correlation.
+ */
+
+static uint32_t nof_trials = 200;
+static float    snr_db     = 0.0f;
+static uint32_t seed       = 0;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [nsv]\n", prog);
+  printf("\t-n number of random words per length [Default %d]\n", nof_trials);
+  printf("\t-s SNR in dB [Default %.1f]\n", snr_db);
+  printf("\t-v increase verbosity\n");
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "nsv")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_trials = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        snr_db = strtof(argv[optind], NULL);
+        break;
+      case 'v':
+        srslte_verbose++;
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+// Maps the coded bits to LLR with noise, bit 1 as a positive LLR
+static void uci_test_llr(srslte_random_t random_gen, const uint8_t* bits, int16_t* llr, uint32_t nof_llr)
+{
+  float std_dev = srslte_convert_dB_to_amplitude(-snr_db);
+  for (uint32_t i = 0; i < nof_llr; i++) {
+    float x = (bits[i] ? 1.0f : -1.0f) + srslte_random_gauss_dist(random_gen, std_dev);
+    llr[i]  = (int16_t)SRSLTE_MAX(SRSLTE_MIN(100.0f * x, 1000.0f), -1000.0f);
+  }
+}
+
+static int test_cqi_pucch(srslte_random_t random_gen)
+{
+  srslte_uci_cqi_pucch_t q = {};
+  srslte_uci_cqi_pucch_init(&q);
+
+  for (uint32_t nof_bits = 1; nof_bits < SRSLTE_UCI_MAX_CQI_LEN_PUCCH; nof_bits++) {
+    for (uint32_t t = 0; t < nof_trials; t++) {
+      uint8_t data[SRSLTE_UCI_MAX_CQI_LEN_PUCCH]    = {};
+      uint8_t bits[SRSLTE_UCI_CQI_CODED_PUCCH_B]    = {};
+      int16_t llr[SRSLTE_CQI_MAX_BITS]              = {};
+      uint8_t rx_data[SRSLTE_UCI_MAX_CQI_LEN_PUCCH] = {};
+
+      uint8_t* ptr = data;
+      srslte_bit_unpack(srslte_random_uniform_int_dist(random_gen, 0, (1 << nof_bits) - 1), &ptr, nof_bits);
+      srslte_uci_encode_cqi_pucch(data, nof_bits, bits);
+      uci_test_llr(random_gen, bits, llr, SRSLTE_UCI_CQI_CODED_PUCCH_B);
+
+      // Brute force correlation with all the words, the first maximum wins
+      uint32_t gold_w    = 0;
+      int32_t  gold_corr = INT32_MIN;
+      for (uint32_t w = 0; w < (1U << nof_bits); w++) {
+        uint8_t word[SRSLTE_UCI_MAX_CQI_LEN_PUCCH];
+        uint8_t cw[SRSLTE_UCI_CQI_CODED_PUCCH_B];
+        ptr = word;
+        srslte_bit_unpack(w, &ptr, nof_bits);
+        srslte_uci_encode_cqi_pucch(word, nof_bits, cw);
+        int32_t corr = 0;
+        for (uint32_t i = 0; i < SRSLTE_UCI_CQI_CODED_PUCCH_B; i++) {
+          corr += cw[i] ? llr[i] : -llr[i];
+        }
+        if (corr > gold_corr) {
+          gold_corr = corr;
+          gold_w    = w;
+        }
+      }
+
+      int32_t  corr = srslte_uci_decode_cqi_pucch(&q, llr, rx_data, nof_bits);
+      uint8_t* rx   = rx_data;
+      uint32_t w    = srslte_bit_pack(&rx, nof_bits);
+      if (w != gold_w || corr != gold_corr) {
+        ERROR("PUCCH CQI %d bits: decoded %x (corr=%d), brute force %x (corr=%d)\n",
+              nof_bits,
+              w,
+              corr,
+              gold_w,
+              gold_corr);
+        srslte_uci_cqi_pucch_free(&q);
+        return SRSLTE_ERROR;
+      }
+    }
+  }
+
+  srslte_uci_cqi_pucch_free(&q);
+  return SRSLTE_SUCCESS;
+}
+
+static int test_m_basis(srslte_random_t random_gen)
+{
+  for (uint32_t nof_bits = 1; nof_bits <= SRSLTE_UCI_MAX_ACK_SR_BITS; nof_bits++) {
+    for (uint32_t t = 0; t < nof_trials; t++) {
+      uint32_t nof_llr = SRSLTE_UCI_M_BASIS_SEQ_LEN * srslte_random_uniform_int_dist(random_gen, 1, 3);
+      uint8_t  data[SRSLTE_UCI_MAX_ACK_SR_BITS]     = {};
+      uint8_t  bits[3 * SRSLTE_UCI_M_BASIS_SEQ_LEN] = {};
+      int16_t  llr[3 * SRSLTE_UCI_M_BASIS_SEQ_LEN]  = {};
+      uint8_t  rx_data[SRSLTE_UCI_MAX_ACK_SR_BITS]  = {};
+
+      for (uint32_t i = 0; i < nof_bits; i++) {
+        data[i] = (uint8_t)srslte_random_uniform_int_dist(random_gen, 0, 1);
+      }
+      srslte_uci_encode_m_basis_bits(data, nof_bits, bits, nof_llr);
+      uci_test_llr(random_gen, bits, llr, nof_llr);
+
+      // Brute force correlation with all the words over all the LLR. The correlation starts at 0, so the word 0 is
+      // decoded if no word correlates positively
+      uint32_t gold_w    = 0;
+      int32_t  gold_corr = 0;
+      for (uint32_t w = 0; w < (1U << nof_bits); w++) {
+        uint8_t word[SRSLTE_UCI_MAX_ACK_SR_BITS];
+        uint8_t cw[3 * SRSLTE_UCI_M_BASIS_SEQ_LEN];
+        for (uint32_t i = 0; i < nof_bits; i++) {
+          word[i] = (uint8_t)((w >> i) & 1U);
+        }
+        srslte_uci_encode_m_basis_bits(word, nof_bits, cw, nof_llr);
+        int32_t corr = 0;
+        for (uint32_t i = 0; i < nof_llr; i++) {
+          corr += cw[i] ? llr[i] : -llr[i];
+        }
+        if (corr > gold_corr) {
+          gold_corr = corr;
+          gold_w    = w;
+        }
+      }
+
+      int32_t  corr = srslte_uci_decode_m_basis_bits(llr, nof_llr, rx_data, nof_bits);
+      uint32_t w    = 0;
+      for (uint32_t i = 0; i < nof_bits; i++) {
+        w |= (uint32_t)(rx_data[i] & 1U) << i;
+      }
+      if (w != gold_w || corr != gold_corr) {
+        ERROR("M-basis %d bits, %d LLR: decoded %x (corr=%d), brute force %x (corr=%d)\n",
+              nof_bits,
+              nof_llr,
+              w,
+              corr,
+              gold_w,
+              gold_corr);
+        return SRSLTE_ERROR;
+      }
+    }
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+static int test_cqi_pusch(srslte_random_t random_gen)
+{
+  srslte_uci_cqi_pusch_t q = {};
+  if (srslte_uci_cqi_init(&q)) {
+    ERROR("Error initialising UCI CQI\n");
+    return SRSLTE_ERROR;
+  }
+
+  // Without K_segm the CQI takes all the REs of the grant not used by the RI, which sets the number of LLR
+  srslte_pusch_cfg_t cfg = {};
+  cfg.grant.L_prb        = 1;
+  cfg.grant.nof_symb     = 12;
+  cfg.grant.tb.mod       = SRSLTE_MOD_QPSK;
+  uint32_t max_re        = cfg.grant.L_prb * SRSLTE_NRE * cfg.grant.nof_symb;
+
+  int16_t* llr = srslte_vec_i16_malloc(2 * max_re);
+  if (!llr) {
+    srslte_uci_cqi_free(&q);
+    return SRSLTE_ERROR;
+  }
+
+  int ret = SRSLTE_SUCCESS;
+  for (uint32_t nof_bits = 1; nof_bits <= 11 && ret == SRSLTE_SUCCESS; nof_bits++) {
+    for (uint32_t t = 0; t < nof_trials && ret == SRSLTE_SUCCESS; t++) {
+      uint32_t Q_prime_ri  = srslte_random_uniform_int_dist(random_gen, 0, max_re - 8);
+      uint32_t Q           = 2 * (max_re - Q_prime_ri);
+      uint8_t  data[11]    = {};
+      uint8_t  word[11]    = {};
+      uint8_t  rx_data[11] = {};
+      uint8_t  cw[SRSLTE_UCI_M_BASIS_SEQ_LEN];
+      uint8_t  bits[2 * SRSLTE_NRE * 12];
+
+      // The PUSCH CQI is the (32, O) code with the first CQI bit as the MSB of the word
+      uint32_t tx_w = srslte_random_uniform_int_dist(random_gen, 0, (1 << nof_bits) - 1);
+      uint8_t* ptr  = data;
+      srslte_bit_unpack(tx_w, &ptr, nof_bits);
+      srslte_uci_encode_m_basis_bits(data, nof_bits, bits, Q);
+      uci_test_llr(random_gen, bits, llr, Q);
+
+      // Brute force correlation of the accumulated repetitions with all the words, the first maximum wins
+      int32_t acc[SRSLTE_UCI_M_BASIS_SEQ_LEN] = {};
+      for (uint32_t i = 0; i < Q; i++) {
+        acc[i % SRSLTE_UCI_M_BASIS_SEQ_LEN] += llr[i];
+      }
+      uint32_t gold_w    = 0;
+      int32_t  gold_corr = INT32_MIN;
+      for (uint32_t w = 0; w < (1U << nof_bits); w++) {
+        ptr = word;
+        srslte_bit_unpack(w, &ptr, nof_bits);
+        srslte_uci_encode_m_basis_bits(word, nof_bits, cw, SRSLTE_UCI_M_BASIS_SEQ_LEN);
+        int32_t corr = 0;
+        for (uint32_t i = 0; i < SRSLTE_MIN(SRSLTE_UCI_M_BASIS_SEQ_LEN, Q); i++) {
+          corr += cw[i] ? acc[i] : -acc[i];
+        }
+        if (corr > gold_corr) {
+          gold_corr = corr;
+          gold_w    = w;
+        }
+      }
+
+      if (srslte_uci_decode_cqi_pusch(&q, &cfg, llr, 1.0f, Q_prime_ri, nof_bits, rx_data, NULL) < 0) {
+        ERROR("Error decoding PUSCH CQI\n");
+        ret = SRSLTE_ERROR;
+        break;
+      }
+      uint8_t* rx = rx_data;
+      uint32_t w  = srslte_bit_pack(&rx, nof_bits);
+      if (w != gold_w) {
+        ERROR("PUSCH CQI %d bits, %d LLR: decoded %x, brute force %x\n", nof_bits, Q, w, gold_w);
+        ret = SRSLTE_ERROR;
+      }
+    }
+  }
+
+  free(llr);
+  srslte_uci_cqi_free(&q);
+  return ret;
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  srslte_random_t random_gen = srslte_random_init(seed);
+  int             ret        = SRSLTE_SUCCESS;
+
+  if (test_cqi_pucch(random_gen)) {
+    ERROR("PUCCH CQI test failed\n");
+    ret = SRSLTE_ERROR;
+  }
+
+  if (test_m_basis(random_gen)) {
+    ERROR("M-basis test failed\n");
+    ret = SRSLTE_ERROR;
+  }
+
+  if (test_cqi_pusch(random_gen)) {
+    ERROR("PUSCH CQI test failed\n");
+    ret = SRSLTE_ERROR;
+  }
+
+  srslte_random_free(random_gen);
+
+  printf("%s\n", ret ? "Error" : "Ok");
+  return ret;
+}
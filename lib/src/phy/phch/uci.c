@@ -38,20 +38,17 @@
 #include "srslte/phy/utils/debug.h"
 #include "srslte/phy/utils/vector.h"
 
-/* Table 5.2.2.6.4-1: Basis sequence for (32, O) code */
-static uint8_t M_basis_seq[SRSLTE_UCI_M_BASIS_SEQ_LEN][SRSLTE_UCI_MAX_ACK_SR_BITS] = {
-    {1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1}, {1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1}, {1, 0, 0, 1, 0, 0, 1, 0, 1, 1, 1},
-    {1, 0, 1, 1, 0, 0, 0, 0, 1, 0, 1}, {1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1}, {1, 1, 0, 0, 1, 0, 1, 1, 1, 0, 1},
-    {1, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1}, {1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 1}, {1, 1, 0, 1, 1, 0, 0, 1, 0, 1, 1},
-    {1, 0, 1, 1, 1, 0, 1, 0, 0, 1, 1}, {1, 0, 1, 0, 0, 1, 1, 1, 0, 1, 1}, {1, 1, 1, 0, 0, 1, 1, 0, 1, 0, 1},
-    {1, 0, 0, 1, 0, 1, 0, 1, 1, 1, 1}, {1, 1, 0, 1, 0, 1, 0, 1, 0, 1, 1}, {1, 0, 0, 0, 1, 1, 0, 1, 0, 0, 1},
-    {1, 1, 0, 0, 1, 1, 1, 1, 0, 1, 1}, {1, 1, 1, 0, 1, 1, 1, 0, 0, 1, 0}, {1, 0, 0, 1, 1, 1, 0, 0, 1, 0, 0},
-    {1, 1, 0, 1, 1, 1, 1, 1, 0, 0, 0}, {1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0}, {1, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1},
-    {1, 1, 0, 1, 0, 0, 0, 0, 0, 1, 1}, {1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 1}, {1, 1, 1, 0, 1, 0, 0, 0, 1, 1, 1},
-    {1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 0}, {1, 1, 0, 0, 0, 1, 1, 1, 0, 0, 1}, {1, 0, 1, 1, 0, 1, 0, 0, 1, 1, 0},
-    {1, 1, 1, 1, 0, 1, 0, 1, 1, 1, 0}, {1, 0, 1, 0, 1, 1, 1, 0, 1, 0, 0}, {1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0},
-    {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}, {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
-};
+/// Computes the parity of the bits of d
+static inline bool uci_parity_u16(uint16_t d)
+{
+  d ^= (uint16_t)(d >> 8U);
+  d ^= (uint16_t)(d >> 4U);
+  d &= 0xf;
+  d = (0x6996U >> d) & 1U;
+
+  // Return false if 0, otherwise it returns true
+  return (d != 0);
+}
 
 static inline bool encode_M_basis_seq_u16(uint16_t w, uint32_t bit_idx)
 {
@@ -64,49 +61,167 @@ static inline bool encode_M_basis_seq_u16(uint16_t w, uint32_t bit_idx)
       0b00101110101, 0b00111111101, 0b11111111111, 0b00000000001,
   };
 
-  // Apply mask
-  uint16_t d = (uint16_t)w & M_basis_seq_b[bit_idx % SRSLTE_UCI_M_BASIS_SEQ_LEN];
+  // Apply mask and compute parity
+  return uci_parity_u16((uint16_t)w & M_basis_seq_b[bit_idx % SRSLTE_UCI_M_BASIS_SEQ_LEN]);
+}
 
-  // Compute parity
-  d ^= (uint16_t)(d >> 8U);
-  d ^= (uint16_t)(d >> 4U);
-  d &= 0xf;
-  d = (0x6996U >> d) & 1U;
+/// Table 5.2.3.3-1: Basis sequences for (20, A) code compressed in uint16_t types, bit n is the basis sequence n
+static const uint16_t M_basis_seq_pucch_b[SRSLTE_UCI_CQI_CODED_PUCCH_B] = {
+    0x0c03, 0x0e07, 0x1f49, 0x1d0d, 0x1c8f, 0x1dd3, 0x1f55, 0x1d99, 0x1e9b, 0x1e5d,
+    0x1ee5, 0x1d67, 0x1fa9, 0x1eab, 0x14b1, 0x16f3, 0x1a77, 0x1939, 0x00fb, 0x0061,
+};
 
-  // Return false if 0, otherwise it returns true
-  return (d != 0);
-}
+/* The basis sequences 1 to 5 of both codes take the 32 values of a 5 bit index along the 32 rows (the first 20 for
+ * the PUCCH code), so they make a first order Reed-Muller code. The correlation with all their combinations is the
+ * Walsh-Hadamard transform of the LLR sorted by that index, once for every combination of the remaining sequences,
+ * which are a mask applied to the LLR. The basis sequence 0 is all ones and only flips the sign of the correlation.
+ */
+static const uint8_t uci_rm_fht_idx[SRSLTE_UCI_M_BASIS_SEQ_LEN] = {
+    1,  3,  4,  6,  7,  9,  10, 12, 13, 14, 18, 19, 20, 21, 24, 25,
+    27, 28, 29, 16, 2,  5,  8,  11, 15, 17, 22, 23, 26, 30, 31, 0,
+};
 
-static uint8_t M_basis_seq_pucch[20][13] = {
-    {1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0}, {1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0},
-    {1, 0, 0, 1, 0, 0, 1, 0, 1, 1, 1, 1, 1}, {1, 0, 1, 1, 0, 0, 0, 0, 1, 0, 1, 1, 1},
-    {1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1, 1, 1}, {1, 1, 0, 0, 1, 0, 1, 1, 1, 0, 1, 1, 1},
-    {1, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1, 1, 1}, {1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 1, 1, 1},
-    {1, 1, 0, 1, 1, 0, 0, 1, 0, 1, 1, 1, 1}, {1, 0, 1, 1, 1, 0, 1, 0, 0, 1, 1, 1, 1},
-    {1, 0, 1, 0, 0, 1, 1, 1, 0, 1, 1, 1, 1}, {1, 1, 1, 0, 0, 1, 1, 0, 1, 0, 1, 1, 1},
-    {1, 0, 0, 1, 0, 1, 0, 1, 1, 1, 1, 1, 1}, {1, 1, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1, 1},
-    {1, 0, 0, 0, 1, 1, 0, 1, 0, 0, 1, 0, 1}, {1, 1, 0, 0, 1, 1, 1, 1, 0, 1, 1, 0, 1},
-    {1, 1, 1, 0, 1, 1, 1, 0, 0, 1, 0, 1, 1}, {1, 0, 0, 1, 1, 1, 0, 0, 1, 0, 0, 1, 1},
-    {1, 1, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0}, {1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0},
+/// Basis sequences 6 to 12 of the row of every index of the transform, bit 0 is the basis sequence 6
+static const uint8_t uci_rm_fht_mask[SRSLTE_UCI_M_BASIS_SEQ_LEN] = {
+    0x00, 0x30, 0x11, 0x38, 0x7d, 0x18, 0x74, 0x72, 0x16, 0x77, 0x7d, 0x1c, 0x76, 0x7a, 0x79, 0x0f,
+    0x01, 0x13, 0x7b, 0x75, 0x7e, 0x7a, 0x0c, 0x0e, 0x52, 0x5b, 0x05, 0x69, 0x64, 0x03, 0x07, 0x1f,
 };
 
+/// Number of masks transformed at once, laid out to fit in SIMD registers
+#define UCI_RM_NOF_LANES 8
+
+/// Accumulates the repetitions of the 32 bit codeword
+static void uci_rm_accumulate(const int16_t* llr, uint32_t nof_llr, int32_t llr_acc[SRSLTE_UCI_M_BASIS_SEQ_LEN])
+{
+  memset(llr_acc, 0, SRSLTE_UCI_M_BASIS_SEQ_LEN * sizeof(int32_t));
+  for (uint32_t i = 0; i < nof_llr; i += SRSLTE_UCI_M_BASIS_SEQ_LEN) {
+    for (uint32_t j = 0; j < SRSLTE_MIN(SRSLTE_UCI_M_BASIS_SEQ_LEN, nof_llr - i); j++) {
+      llr_acc[j] += llr[i + j];
+    }
+  }
+}
+
+/* Correlates the LLR of the first nof_rows rows with the codewords of all the words of nof_bits bits, for the codeword
+ * bit 1 as +1, and returns the word with maximum correlation. The bit n of the word selects the basis sequence n,
+ * counting from the LSB of the word or from its MSB if msb_first is set. The maximum correlation is returned in
+ * max_corr, which holds the correlation to exceed on input. Ties are resolved in favour of the lowest word, as the
+ * brute force search did. */
+static uint32_t
+uci_rm_decode(const int32_t* llr, uint32_t nof_rows, uint32_t nof_bits, bool msb_first, int32_t* max_corr)
+{
+  uint32_t nof_masks = (nof_bits > 6) ? 1U << (nof_bits - 6) : 1;
+  uint32_t nof_lanes = SRSLTE_MIN(nof_masks, UCI_RM_NOF_LANES);
+  uint32_t nof_idx   = 1U << (SRSLTE_MAX(SRSLTE_MIN(nof_bits, 6), 1) - 1);
+  uint32_t nof_bit0  = SRSLTE_MIN(nof_bits, 1) + 1;
+  uint32_t max_w     = 0;
+
+  // Position in the word of every basis sequence, and of all the combinations of the basis sequences 1 to 5
+  uint32_t word_bit[SRSLTE_UCI_MAX_CQI_LEN_PUCCH];
+  uint32_t word_idx[SRSLTE_UCI_M_BASIS_SEQ_LEN];
+  for (uint32_t n = 0; n < SRSLTE_UCI_MAX_CQI_LEN_PUCCH; n++) {
+    word_bit[n] = (msb_first && n < nof_bits) ? 1U << (nof_bits - 1 - n) : 1U << n;
+  }
+  word_idx[0] = 0;
+  for (uint32_t a = 1; a < nof_idx; a++) {
+    word_idx[a] = word_idx[a & (a - 1)] | word_bit[__builtin_ctz(a) + 1];
+  }
+
+  // LLR sorted by the index of the transform
+  int32_t llr_idx[SRSLTE_UCI_M_BASIS_SEQ_LEN] = {};
+  for (uint32_t i = 0; i < nof_rows; i++) {
+    llr_idx[uci_rm_fht_idx[i]] = llr[i];
+  }
+
+  // Sign and position in the word of the 3 LSB of the mask, which select the lane
+  int32_t  lane_sign[SRSLTE_UCI_M_BASIS_SEQ_LEN][UCI_RM_NOF_LANES];
+  uint32_t lane_word[UCI_RM_NOF_LANES] = {};
+  for (uint32_t p = 0; p < SRSLTE_UCI_M_BASIS_SEQ_LEN; p++) {
+    for (uint32_t l = 0; l < nof_lanes; l++) {
+      lane_sign[p][l] = 1 - 2 * (int32_t)((0x96U >> (l & uci_rm_fht_mask[p])) & 1U);
+    }
+  }
+  for (uint32_t l = 0; l < nof_lanes; l++) {
+    for (uint32_t c = 0; (1U << c) < nof_lanes; c++) {
+      lane_word[l] |= ((l >> c) & 1U) ? word_bit[6 + c] : 0;
+    }
+  }
+
+  for (uint32_t m = 0; m < nof_masks; m += UCI_RM_NOF_LANES) {
+    uint32_t word_mask = 0;
+    for (uint32_t c = 3; (1U << c) < nof_masks; c++) {
+      word_mask |= ((m >> c) & 1U) ? word_bit[6 + c] : 0;
+    }
+
+    // Apply the masks of all the lanes. Only the combinations of the first basis sequences are needed for short words,
+    // so the LLR of the indexes that differ in the unused sequences are added up before the transform
+    int32_t y[SRSLTE_UCI_M_BASIS_SEQ_LEN][UCI_RM_NOF_LANES];
+    memset(y, 0, nof_idx * sizeof(y[0]));
+    for (uint32_t p = 0; p < SRSLTE_UCI_M_BASIS_SEQ_LEN; p++) {
+      int32_t v = uci_parity_u16((uint16_t)(m & uci_rm_fht_mask[p])) ? -llr_idx[p] : llr_idx[p];
+      for (uint32_t l = 0; l < nof_lanes; l++) {
+        y[p % nof_idx][l] += v * lane_sign[p][l];
+      }
+    }
+
+    // Fast Walsh-Hadamard transform of all the lanes
+    for (uint32_t h = 1; h < nof_idx; h *= 2) {
+      for (uint32_t j = 0; j < nof_idx; j += 2 * h) {
+        for (uint32_t k = j; k < j + h; k++) {
+          for (uint32_t l = 0; l < nof_lanes; l++) {
+            int32_t t   = y[k][l];
+            y[k][l]     = t + y[k + h][l];
+            y[k + h][l] = t - y[k + h][l];
+          }
+        }
+      }
+    }
+
+    // The correlations are +y and -y, skip the search if none of them reaches the maximum
+    if (nof_lanes == UCI_RM_NOF_LANES) {
+      int32_t max_lane[UCI_RM_NOF_LANES] = {};
+      for (uint32_t a = 0; a < nof_idx; a++) {
+        for (uint32_t l = 0; l < UCI_RM_NOF_LANES; l++) {
+          max_lane[l] = SRSLTE_MAX(max_lane[l], abs(y[a][l]));
+        }
+      }
+      int32_t max_block = 0;
+      for (uint32_t l = 0; l < UCI_RM_NOF_LANES; l++) {
+        max_block = SRSLTE_MAX(max_block, max_lane[l]);
+      }
+      if (max_block < *max_corr) {
+        continue;
+      }
+    }
+
+    for (uint32_t l = 0; l < nof_lanes; l++) {
+      for (uint32_t a = 0; a < nof_idx; a++) {
+        uint32_t w    = word_mask | lane_word[l] | word_idx[a];
+        int32_t  c[2] = {-y[a][l], y[a][l]};
+        for (uint32_t b = 0; b < nof_bit0; b++, w |= word_bit[0]) {
+          if (c[b] > *max_corr || (c[b] == *max_corr && w < max_w)) {
+            *max_corr = c[b];
+            max_w     = w;
+          }
+        }
+      }
+    }
+  }
+
+  return max_w;
+}
+
 void srslte_uci_cqi_pucch_init(srslte_uci_cqi_pucch_t* q)
 {
   uint8_t word[16];
 
   uint32_t nwords = 1 << SRSLTE_UCI_MAX_CQI_LEN_PUCCH;
   q->cqi_table    = srslte_vec_malloc(nwords * sizeof(int8_t*));
-  q->cqi_table_s  = srslte_vec_malloc(nwords * sizeof(int16_t*));
 
   for (uint32_t w = 0; w < nwords; w++) {
-    q->cqi_table[w]   = srslte_vec_malloc(SRSLTE_UCI_CQI_CODED_PUCCH_B * sizeof(int8_t));
-    q->cqi_table_s[w] = srslte_vec_malloc(SRSLTE_UCI_CQI_CODED_PUCCH_B * sizeof(int16_t));
-    uint8_t* ptr      = word;
+    q->cqi_table[w] = srslte_vec_malloc(SRSLTE_UCI_CQI_CODED_PUCCH_B * sizeof(int8_t));
+    uint8_t* ptr    = word;
     srslte_bit_unpack(w, &ptr, SRSLTE_UCI_MAX_CQI_LEN_PUCCH);
     srslte_uci_encode_cqi_pucch(word, SRSLTE_UCI_MAX_CQI_LEN_PUCCH, q->cqi_table[w]);
-    for (int j = 0; j < SRSLTE_UCI_CQI_CODED_PUCCH_B; j++) {
-      q->cqi_table_s[w][j] = (int16_t)(2 * q->cqi_table[w][j] - 1);
-    }
   }
 }
 
@@ -117,12 +232,8 @@ void srslte_uci_cqi_pucch_free(srslte_uci_cqi_pucch_t* q)
     if (q->cqi_table[w]) {
       free(q->cqi_table[w]);
     }
-    if (q->cqi_table_s[w]) {
-      free(q->cqi_table_s[w]);
-    }
   }
   free(q->cqi_table);
-  free(q->cqi_table_s);
 }
 
 /* Encode UCI CQI/PMI as described in 5.2.3.3 of 36.212
@@ -130,12 +241,12 @@ void srslte_uci_cqi_pucch_free(srslte_uci_cqi_pucch_t* q)
 int srslte_uci_encode_cqi_pucch(uint8_t* cqi_data, uint32_t cqi_len, uint8_t b_bits[SRSLTE_UCI_CQI_CODED_PUCCH_B])
 {
   if (cqi_len <= SRSLTE_UCI_MAX_CQI_LEN_PUCCH) {
+    uint16_t w = 0;
+    for (uint32_t n = 0; n < cqi_len; n++) {
+      w |= (uint16_t)((cqi_data[n] & 1U) << n);
+    }
     for (uint32_t i = 0; i < SRSLTE_UCI_CQI_CODED_PUCCH_B; i++) {
-      uint64_t x = 0;
-      for (uint32_t n = 0; n < cqi_len; n++) {
-        x += cqi_data[n] * M_basis_seq_pucch[i][n];
-      }
-      b_bits[i] = (uint8_t)(x % 2);
+      b_bits[i] = uci_parity_u16(w & M_basis_seq_pucch_b[i]);
     }
     return SRSLTE_SUCCESS;
   } else {
@@ -168,18 +279,16 @@ int16_t srslte_uci_decode_cqi_pucch(srslte_uci_cqi_pucch_t* q,
                                     uint32_t                cqi_len)
 {
   if (cqi_len < SRSLTE_UCI_MAX_CQI_LEN_PUCCH && b_bits != NULL && cqi_data != NULL) {
-    uint32_t max_w    = 0;
-    int32_t  max_corr = INT32_MIN;
-    uint32_t nwords   = 1 << SRSLTE_UCI_MAX_CQI_LEN_PUCCH;
-    for (uint32_t w = 0; w < nwords; w += 1 << (SRSLTE_UCI_MAX_CQI_LEN_PUCCH - cqi_len)) {
-
-      // Calculate correlation with pregenerated word and select maximum
-      int32_t corr = srslte_vec_dot_prod_sss(q->cqi_table_s[w], b_bits, SRSLTE_UCI_CQI_CODED_PUCCH_B);
-      if (corr > max_corr) {
-        max_corr = corr;
-        max_w    = w;
-      }
+    int32_t llr[SRSLTE_UCI_CQI_CODED_PUCCH_B];
+    for (uint32_t i = 0; i < SRSLTE_UCI_CQI_CODED_PUCCH_B; i++) {
+      llr[i] = b_bits[i];
     }
+
+    // Calculate correlation with all the words and select maximum
+    int32_t  max_corr = INT32_MIN;
+    uint32_t max_w    = uci_rm_decode(llr, SRSLTE_UCI_CQI_CODED_PUCCH_B, cqi_len, true, &max_corr)
+                     << (SRSLTE_UCI_MAX_CQI_LEN_PUCCH - cqi_len);
+
     // Convert word to bits again
     uint8_t* ptr = cqi_data;
     srslte_bit_unpack(max_w, &ptr, SRSLTE_UCI_MAX_CQI_LEN_PUCCH);
@@ -233,36 +342,12 @@ int32_t srslte_uci_decode_m_basis_bits(const int16_t* llr, uint32_t nof_llr, uin
   // Limit data to maximum
   data_len = SRSLTE_MIN(data_len, SRSLTE_UCI_MAX_ACK_SR_BITS);
 
-  // Brute force all possible sequences
-  uint16_t max_guess = (1 << data_len); ///< Maximum guess bit combination
-  for (uint16_t guess = 0; guess < max_guess; guess++) {
-    int32_t corr = 0;
-
-    /// Compute correlation for the number of LLR
-    bool early_termination = false;
-    for (uint32_t i = 0; i < nof_llr && !early_termination; i++) {
-      // Encode guess word
-      bool d = encode_M_basis_seq_u16(guess, i);
-
-      // Correlate
-      corr += (int32_t)(d ? llr[i] : -llr[i]);
-
-      // Limit correlation to half range
-      corr = SRSLTE_MIN(corr, INT32_MAX / 2);
-
-      /// Early terminates if at least SRSLTE_UCI_M_BASIS_SEQ_LEN/4 LLR processed and negative correlation
-      early_termination |= (i > SRSLTE_UCI_M_BASIS_SEQ_LEN / 4) && (corr < 0);
-
-      /// Early terminates if the correlation overflows
-      early_termination |= (corr < -INT32_MAX / 2);
-    }
+  // Accumulate the repetitions of the basis sequences
+  int32_t llr_acc[SRSLTE_UCI_M_BASIS_SEQ_LEN];
+  uci_rm_accumulate(llr, nof_llr, llr_acc);
 
-    // Take decision
-    if (corr > max_corr) {
-      max_corr = corr;
-      max_data = guess;
-    }
-  }
+  // Correlate with all possible sequences at once and take decision
+  max_data = (uint16_t)uci_rm_decode(llr_acc, SRSLTE_UCI_M_BASIS_SEQ_LEN, data_len, false, &max_corr);
 
   // Unpack
   for (uint32_t i = 0; i < data_len; i++) {
@@ -280,14 +365,10 @@ void cqi_pusch_pregen(srslte_uci_cqi_pusch_t* q)
   for (int i = 0; i < 11; i++) {
     uint32_t nwords   = (1 << (i + 1));
     q->cqi_table[i]   = srslte_vec_u8_malloc(nwords * 32);
-    q->cqi_table_s[i] = srslte_vec_i16_malloc(nwords * 32);
     for (uint32_t w = 0; w < nwords; w++) {
       uint8_t* ptr = word;
       srslte_bit_unpack(w, &ptr, i + 1);
       srslte_uci_encode_m_basis_bits(word, i + 1, &q->cqi_table[i][32 * w], SRSLTE_UCI_M_BASIS_SEQ_LEN);
-      for (int j = 0; j < 32; j++) {
-        q->cqi_table_s[i][32 * w + j] = 2 * q->cqi_table[i][32 * w + j] - 1;
-      }
     }
   }
 }
@@ -298,9 +379,6 @@ void cqi_pusch_pregen_free(srslte_uci_cqi_pusch_t* q)
     if (q->cqi_table[i]) {
       free(q->cqi_table[i]);
     }
-    if (q->cqi_table_s[i]) {
-      free(q->cqi_table_s[i]);
-    }
   }
 }
 
@@ -376,25 +454,13 @@ int decode_cqi_short(srslte_uci_cqi_pusch_t* q, int16_t* q_bits, uint32_t Q, uin
 {
   if (nof_bits <= 11 && nof_bits > 0 && q != NULL && data != NULL && q_bits != NULL) {
     // Accumulate all copies of the 32-length sequence
-    if (Q > 32) {
-      int i = 1;
-      for (; i < Q / 32; i++) {
-        srslte_vec_sum_sss(&q_bits[i * 32], q_bits, q_bits, 32);
-      }
-      srslte_vec_sum_sss(&q_bits[i * 32], q_bits, q_bits, Q % 32);
-    }
+    int32_t llr[SRSLTE_UCI_M_BASIS_SEQ_LEN];
+    uci_rm_accumulate(q_bits, Q, llr);
 
-    uint32_t max_w    = 0;
+    // Calculate correlation with all the words and select maximum
     int32_t  max_corr = INT32_MIN;
-    for (uint32_t w = 0; w < (1 << nof_bits); w++) {
+    uint32_t max_w    = uci_rm_decode(llr, SRSLTE_MIN(SRSLTE_UCI_M_BASIS_SEQ_LEN, Q), nof_bits, true, &max_corr);
 
-      // Calculate correlation with pregenerated word and select maximum
-      int32_t corr = srslte_vec_dot_prod_sss(&q->cqi_table_s[nof_bits - 1][w * 32], q_bits, SRSLTE_MIN(32, Q));
-      if (corr > max_corr) {
-        max_corr = corr;
-        max_w    = w;
-      }
-    }
     // Convert word to bits again
     uint8_t* ptr = data;
     srslte_bit_unpack(max_w, &ptr, nof_bits);
@@ -547,61 +613,46 @@ int srslte_uci_encode_cqi_pusch(srslte_uci_cqi_pusch_t* q,
   }
 }
 
-/* Generates UCI-ACK bits and computes position in q bits */
-static int uci_ulsch_interleave_ack_gen(uint32_t          ack_q_bit_idx,
-                                        uint32_t          Qm,
-                                        uint32_t          H_prime_total,
-                                        uint32_t          N_pusch_symbs,
-                                        srslte_uci_bit_t* ack_bits)
+/* Computes the position in the q bits of the Q_prime UCI-ACK or UCI-RI symbols of the grant. The symbols take the rows
+ * of their columns from the bottom, the column offsets only depend on the grant so they are computed once. */
+static int uci_ulsch_interleave_gen(uint32_t          Q_prime,
+                                    uint32_t          Qm,
+                                    uint32_t          H_prime_total,
+                                    uint32_t          N_pusch_symbs,
+                                    bool              is_ri,
+                                    srslte_uci_bit_t* bits)
 {
-
   const uint32_t ack_column_set_norm[4] = {2, 3, 8, 9};
   const uint32_t ack_column_set_ext[4]  = {1, 2, 6, 7};
+  const uint32_t ri_column_set_norm[4]  = {1, 4, 7, 10};
+  const uint32_t ri_column_set_ext[4]   = {0, 3, 5, 8};
 
-  if (H_prime_total / N_pusch_symbs >= 1 + ack_q_bit_idx / 4) {
-    uint32_t row    = H_prime_total / N_pusch_symbs - 1 - ack_q_bit_idx / 4;
-    uint32_t colidx = (3 * ack_q_bit_idx) % 4;
-    uint32_t col    = N_pusch_symbs > 10 ? ack_column_set_norm[colidx] : ack_column_set_ext[colidx];
-    for (uint32_t k = 0; k < Qm; k++) {
-      ack_bits[k].position = row * Qm + (H_prime_total / N_pusch_symbs) * col * Qm + k;
-    }
-    return SRSLTE_SUCCESS;
-  } else {
-    ERROR("Error interleaving UCI-ACK bit idx %d for H_prime_total=%d and N_pusch_symbs=%d\n",
-          ack_q_bit_idx,
-          H_prime_total,
-          N_pusch_symbs);
-    return SRSLTE_ERROR;
-  }
-}
-
-/* Inserts UCI-RI bits into the correct positions in the g buffer before interleaving */
-static int uci_ulsch_interleave_ri_gen(uint32_t          ri_q_bit_idx,
-                                       uint32_t          Qm,
-                                       uint32_t          H_prime_total,
-                                       uint32_t          N_pusch_symbs,
-                                       srslte_uci_bit_t* ri_bits)
-{
-
-  static uint32_t ri_column_set_norm[4] = {1, 4, 7, 10};
-  static uint32_t ri_column_set_ext[4]  = {0, 3, 5, 8};
+  const uint32_t* column_set = is_ri ? (N_pusch_symbs > 10 ? ri_column_set_norm : ri_column_set_ext)
+                                     : (N_pusch_symbs > 10 ? ack_column_set_norm : ack_column_set_ext);
 
-  if (H_prime_total / N_pusch_symbs >= 1 + ri_q_bit_idx / 4) {
-    uint32_t row    = H_prime_total / N_pusch_symbs - 1 - ri_q_bit_idx / 4;
-    uint32_t colidx = (3 * ri_q_bit_idx) % 4;
-    uint32_t col    = N_pusch_symbs > 10 ? ri_column_set_norm[colidx] : ri_column_set_ext[colidx];
+  uint32_t nof_rows = H_prime_total / N_pusch_symbs;
+  uint32_t column_offset[4];
+  for (uint32_t j = 0; j < 4; j++) {
+    column_offset[j] = nof_rows * column_set[(3 * j) % 4] * Qm;
+  }
 
+  uint32_t nof_symbols = SRSLTE_MIN(Q_prime, 4 * nof_rows);
+  for (uint32_t i = 0; i < nof_symbols; i++) {
+    uint32_t position = (nof_rows - 1 - i / 4) * Qm + column_offset[i % 4];
     for (uint32_t k = 0; k < Qm; k++) {
-      ri_bits[k].position = row * Qm + (H_prime_total / N_pusch_symbs) * col * Qm + k;
+      bits[Qm * i + k].position = position + k;
     }
-    return SRSLTE_SUCCESS;
-  } else {
-    ERROR("Error interleaving UCI-RI bit idx %d for H_prime_total=%d and N_pusch_symbs=%d\n",
-          ri_q_bit_idx,
+  }
+
+  if (nof_symbols < Q_prime) {
+    ERROR("Error interleaving UCI-%s bit idx %d for H_prime_total=%d and N_pusch_symbs=%d\n",
+          is_ri ? "RI" : "ACK",
+          nof_symbols,
           H_prime_total,
           N_pusch_symbs);
     return SRSLTE_ERROR;
   }
+  return SRSLTE_SUCCESS;
 }
 
 static uint32_t Q_prime_ri_ack(srslte_pusch_cfg_t* cfg, uint32_t O, uint32_t O_cqi, float beta)
@@ -680,12 +731,10 @@ encode_ack_long(const uint8_t* data, uint32_t O_ack, uint8_t Q_m, uint32_t Q_pri
     return 0;
   }
 
+  uint8_t q[SRSLTE_UCI_M_BASIS_SEQ_LEN];
+  srslte_uci_encode_m_basis_bits(data, O_ack, q, SRSLTE_UCI_M_BASIS_SEQ_LEN);
   for (uint32_t i = 0; i < Q_ack; i++) {
-    uint32_t q_i = 0;
-    for (uint32_t n = 0; n < O_ack; n++) {
-      q_i = (q_i + (data[n] * M_basis_seq[i % 32][n])) % 2;
-    }
-    q_encoded_bits[i].type = q_i ? UCI_BIT_1 : UCI_BIT_0;
+    q_encoded_bits[i].type = q[i % SRSLTE_UCI_M_BASIS_SEQ_LEN] ? UCI_BIT_1 : UCI_BIT_0;
   }
 
   return Q_ack;
@@ -796,13 +845,7 @@ int srslte_uci_encode_ack_ri(srslte_pusch_cfg_t* cfg,
 
   // Generate interleaver positions
   if (Q_ack > 0) {
-    for (uint32_t i = 0; i < Q_prime; i++) {
-      if (input_is_ri) {
-        uci_ulsch_interleave_ri_gen(i, Qm, H_prime_total, cfg->grant.nof_symb, &bits[Qm * i]);
-      } else {
-        uci_ulsch_interleave_ack_gen(i, Qm, H_prime_total, cfg->grant.nof_symb, &bits[Qm * i]);
-      }
-    }
+    uci_ulsch_interleave_gen(Q_prime, Qm, H_prime_total, cfg->grant.nof_symb, input_is_ri, bits);
 
     // TDD-bundling scrambling
     if (!input_is_ri && N_bundle && O_ack > 0) {
@@ -841,13 +884,9 @@ int srslte_uci_decode_ack_ri(srslte_pusch_cfg_t* cfg,
       (nof_bits == 1) ? Qm : (nof_bits == 2) ? Qm * 3 : SRSLTE_UCI_M_BASIS_SEQ_LEN; ///< Number of required LLR
   uint32_t count_acc = 0;                                                           ///< LLR counter
 
-  for (uint32_t i = 0; i < Qprime; i++) {
-    if (is_ri) {
-      uci_ulsch_interleave_ri_gen(i, Qm, H_prime_total, cfg->grant.nof_symb, &ack_ri_bits[count_acc]);
-    } else {
-      uci_ulsch_interleave_ack_gen(i, Qm, H_prime_total, cfg->grant.nof_symb, &ack_ri_bits[count_acc]);
-    }
+  uci_ulsch_interleave_gen(Qprime, Qm, H_prime_total, cfg->grant.nof_symb, is_ri, ack_ri_bits);
 
+  for (uint32_t i = 0; i < Qprime; i++) {
     /// Extract and accumulate LLR
     for (uint32_t j = 0; j < Qm; j++, count_acc++) {
       // Calculate circular LLR index
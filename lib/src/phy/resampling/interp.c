@@ -187,6 +187,52 @@ void srslte_interp_linear_vector3(srslte_interp_linsrslte_vec_t* q,
   }
 }
 
+/* Fills the M samples between each input sample and the next one. The kernels with a constant M let the compiler
+ * unroll the inner loop for the interpolation factors of the CRS (6 RE, or 3 RE for the ports 2 and 3) and the
+ * MBSFN reference signals (2 RE), which are fixed for all the bandwidths.
+ */
+static void
+interp_linear_expand_generic(const cf_t* input, const cf_t* diff, cf_t* output, uint32_t len, uint32_t M)
+{
+  for (uint32_t i = 0; i < len; i++) {
+    for (uint32_t j = 0; j < M; j++) {
+      output[i * M + j] = input[i] + diff[i] * (float)j;
+    }
+  }
+}
+
+#define INTERP_LINEAR_EXPAND(FIXED_M)                                                                                  \
+  static void interp_linear_expand_##FIXED_M(                                                                          \
+      const cf_t* input, const cf_t* diff, cf_t* output, uint32_t len, uint32_t M)                                     \
+  {                                                                                                                    \
+    for (uint32_t i = 0; i < len; i++) {                                                                               \
+      for (uint32_t j = 0; j < FIXED_M; j++) {                                                                         \
+        output[i * FIXED_M + j] = input[i] + diff[i] * (float)j;                                                       \
+      }                                                                                                                \
+    }                                                                                                                  \
+  }
+
+INTERP_LINEAR_EXPAND(2)
+INTERP_LINEAR_EXPAND(3)
+INTERP_LINEAR_EXPAND(6)
+
+static void interp_linear_set_kernel(srslte_interp_lin_t* q)
+{
+  switch (q->M) {
+    case 2:
+      q->expand = interp_linear_expand_2;
+      break;
+    case 3:
+      q->expand = interp_linear_expand_3;
+      break;
+    case 6:
+      q->expand = interp_linear_expand_6;
+      break;
+    default:
+      q->expand = interp_linear_expand_generic;
+  }
+}
+
 int srslte_interp_linear_init(srslte_interp_lin_t* q, uint32_t vector_len, uint32_t M)
 {
   int ret = SRSLTE_ERROR_INVALID_INPUTS;
@@ -198,28 +244,12 @@ int srslte_interp_linear_init(srslte_interp_lin_t* q, uint32_t vector_len, uint3
       perror("malloc");
       return SRSLTE_ERROR;
     }
-    q->diff_vec2 = srslte_vec_cf_malloc(M * vector_len);
-    if (!q->diff_vec2) {
-      perror("malloc");
-      free(q->diff_vec);
-      return SRSLTE_ERROR;
-    }
-    q->ramp = srslte_vec_f_malloc(M);
-    if (!q->ramp) {
-      perror("malloc");
-      free(q->ramp);
-      free(q->diff_vec);
-      return SRSLTE_ERROR;
-    }
-
-    for (int i = 0; i < M; i++) {
-      q->ramp[i] = (float)i;
-    }
 
     q->vector_len     = vector_len;
     q->M              = M;
     q->max_vector_len = vector_len;
     q->max_M          = M;
+    interp_linear_set_kernel(q);
   }
   return ret;
 }
@@ -229,12 +259,6 @@ void srslte_interp_linear_free(srslte_interp_lin_t* q)
   if (q->diff_vec) {
     free(q->diff_vec);
   }
-  if (q->diff_vec2) {
-    free(q->diff_vec2);
-  }
-  if (q->ramp) {
-    free(q->ramp);
-  }
 
   bzero(q, sizeof(srslte_interp_lin_t));
 }
@@ -242,13 +266,9 @@ void srslte_interp_linear_free(srslte_interp_lin_t* q)
 int srslte_interp_linear_resize(srslte_interp_lin_t* q, uint32_t vector_len, uint32_t M)
 {
   if (vector_len <= q->max_vector_len && M <= q->max_M) {
-
-    for (int i = 0; i < M; i++) {
-      q->ramp[i] = (float)i;
-    }
-
     q->vector_len = vector_len;
     q->M          = M;
+    interp_linear_set_kernel(q);
     return SRSLTE_SUCCESS;
   } else {
     ERROR("Error resizing interp_linear: vector_len and M must be lower or equal than initialized\n");
@@ -267,14 +287,8 @@ void srslte_interp_linear_offset(srslte_interp_lin_t* q, cf_t* input, cf_t* outp
   }
   srslte_vec_sub_ccc(&input[1], input, q->diff_vec, (q->vector_len - 1));
   srslte_vec_sc_prod_cfc(q->diff_vec, (float)1 / q->M, q->diff_vec, q->vector_len - 1);
-  for (i = 0; i < q->vector_len - 1; i++) {
-    for (j = 0; j < q->M; j++) {
-      output[i * q->M + j + off_st] = input[i];
-      q->diff_vec2[i * q->M + j]    = q->diff_vec[i];
-    }
-    srslte_vec_prod_cfc(&q->diff_vec2[i * q->M], q->ramp, &q->diff_vec2[i * q->M], q->M);
-  }
-  srslte_vec_sum_ccc(&output[off_st], q->diff_vec2, &output[off_st], q->M * (q->vector_len - 1));
+  i = q->vector_len - 1;
+  q->expand(input, q->diff_vec, &output[off_st], i, q->M);
 
   if (q->vector_len > 1) {
     diff = input[q->vector_len - 1] - input[q->vector_len - 2];
@@ -0,0 +1,271 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "srslte/phy/resampling/resample_poly.h"
+#include "srslte/phy/utils/debug.h"
+#include "srslte/phy/utils/vector.h"
+
+/**
+ * Limits for the filter design, the number of taps per branch is bounded to keep the run time predictable
+ */
+#define RESAMPLE_POLY_MIN_ATTENUATION_DB 21.0f
+#define RESAMPLE_POLY_MAX_TAPS_PER_PHASE 512
+
+static uint32_t resample_poly_gcd(uint32_t a, uint32_t b)
+{
+  while (b != 0) {
+    uint32_t t = b;
+    b          = a % b;
+    a          = t;
+  }
+  return a;
+}
+
+// Zeroth order modified Bessel function of the first kind, power series
+static double resample_poly_bessel_i0(double x)
+{
+  double sum  = 1.0;
+  double term = 1.0;
+  for (uint32_t k = 1; k < 64; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < 1e-12 * sum) {
+      break;
+    }
+  }
+  return sum;
+}
+
+// Kaiser windowed-sinc low-pass, written directly in polyphase order with time-reversed branches
+static void resample_poly_design(srslte_resample_poly_t* q, float passband, float attenuation_db)
+{
+  uint32_t L = q->interp;
+  uint32_t N = L * q->nof_taps;
+
+  // Frequencies are normalised to the interpolated rate, the lowest Nyquist frequency bounds the passband
+  double nyquist = 0.5 / SRSLTE_MAX(q->interp, q->decim);
+  double fc      = nyquist * (1.0 + passband) / 2.0;
+
+  double A    = attenuation_db;
+  double beta = 0.0;
+  if (A > 50.0) {
+    beta = 0.1102 * (A - 8.7);
+  } else if (A > 21.0) {
+    beta = 0.5842 * pow(A - 21.0, 0.4) + 0.07886 * (A - 21.0);
+  }
+
+  double i0_beta = resample_poly_bessel_i0(beta);
+  double center  = (N - 1) / 2.0;
+  for (uint32_t n = 0; n < N; n++) {
+    double x    = n - center;
+    double sinc = (x == 0.0) ? 1.0 : sin(2.0 * M_PI * fc * x) / (2.0 * M_PI * fc * x);
+    double r    = x / (center > 0.0 ? center : 1.0);
+    double w    = resample_poly_bessel_i0(beta * sqrt(SRSLTE_MAX(0.0, 1.0 - r * r))) / i0_beta;
+
+    // The gain L compensates the zeros inserted by the interpolation
+    uint32_t p = n % L;
+    uint32_t i = q->nof_taps - 1 - n / L;
+    q->filter[p * q->nof_taps + i] = (float)(L * 2.0 * fc * sinc * w);
+  }
+}
+
+int srslte_resample_poly_init(srslte_resample_poly_t* q,
+                              uint32_t                interp,
+                              uint32_t                decim,
+                              uint32_t                max_input_len,
+                              float                   passband,
+                              float                   attenuation_db)
+{
+  if (q == NULL || interp == 0 || decim == 0 || max_input_len == 0 || !(passband > 0.0f && passband < 1.0f) ||
+      attenuation_db < RESAMPLE_POLY_MIN_ATTENUATION_DB) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  bzero(q, sizeof(srslte_resample_poly_t));
+
+  uint32_t g       = resample_poly_gcd(interp, decim);
+  q->interp        = interp / g;
+  q->decim         = decim / g;
+  q->max_input_len = max_input_len;
+
+  // Kaiser estimate of the filter length for the transition band between the passband edge and Nyquist
+  double nyquist  = 0.5 / SRSLTE_MAX(q->interp, q->decim);
+  double delta_f  = nyquist * (1.0 - passband);
+  double nof_taps = (attenuation_db - 7.95) / (14.36 * delta_f) + 1.0;
+  q->nof_taps     = (uint32_t)ceil(nof_taps / q->interp);
+  if (q->nof_taps > RESAMPLE_POLY_MAX_TAPS_PER_PHASE) {
+    ERROR("Resampler %d/%d requires %d taps per branch, reduce the passband or the ratio\n",
+          q->interp,
+          q->decim,
+          q->nof_taps);
+    return SRSLTE_ERROR;
+  }
+
+  q->filter = srslte_vec_f_malloc(q->interp * q->nof_taps);
+  if (q->filter == NULL) {
+    perror("malloc");
+    return SRSLTE_ERROR;
+  }
+
+  q->state = srslte_vec_cf_malloc(q->nof_taps - 1 + max_input_len);
+  if (q->state == NULL) {
+    perror("malloc");
+    return SRSLTE_ERROR;
+  }
+
+  resample_poly_design(q, passband, attenuation_db);
+  srslte_resample_poly_reset(q);
+
+  return SRSLTE_SUCCESS;
+}
+
+float srslte_resample_poly_get_delay(srslte_resample_poly_t* q)
+{
+  if (q == NULL || q->decim == 0) {
+    return 0.0f;
+  }
+
+  return (float)(q->interp * q->nof_taps - 1) / (2.0f * q->decim);
+}
+
+uint32_t srslte_resample_poly_nof_output(srslte_resample_poly_t* q, uint32_t nof_input)
+{
+  if (q == NULL || q->decim == 0) {
+    return 0;
+  }
+
+  uint64_t end = (uint64_t)nof_input * q->interp;
+  if (end <= q->next_t) {
+    return 0;
+  }
+
+  return (uint32_t)((end - q->next_t + q->decim - 1) / q->decim);
+}
+
+uint32_t srslte_resample_poly_nof_input(srslte_resample_poly_t* q, uint32_t nof_output)
+{
+  if (q == NULL || q->interp == 0 || nof_output == 0) {
+    return 0;
+  }
+
+  // Smallest input length whose interpolated grid reaches the last requested output
+  uint64_t last = (uint64_t)q->next_t + (uint64_t)(nof_output - 1) * q->decim + 1;
+  return (uint32_t)((last + q->interp - 1) / q->interp);
+}
+
+void srslte_resample_poly_reset(srslte_resample_poly_t* q)
+{
+  if (q != NULL && q->state != NULL) {
+    srslte_vec_cf_zero(q->state, q->nof_taps - 1);
+    q->next_t = 0;
+  }
+}
+
+int srslte_resample_poly_run(srslte_resample_poly_t* q, const cf_t* input, cf_t* output, uint32_t nof_input)
+{
+  if (q == NULL || input == NULL || output == NULL || q->state == NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  if (nof_input > q->max_input_len) {
+    ERROR("Resampler input length %d exceeds maximum %d\n", nof_input, q->max_input_len);
+    return SRSLTE_ERROR_OUT_OF_BOUNDS;
+  }
+
+  uint32_t hist = q->nof_taps - 1;
+  srslte_vec_cf_copy(&q->state[hist], input, nof_input);
+
+  // Output m lies at t = next_t + m * decim in the interpolated grid, it uses input t / interp and branch t % interp
+  uint64_t end   = (uint64_t)nof_input * q->interp;
+  uint64_t t     = q->next_t;
+  uint32_t count = 0;
+  for (; t < end; t += q->decim) {
+    uint32_t k = (uint32_t)(t / q->interp);
+    uint32_t p = (uint32_t)(t % q->interp);
+
+    output[count++] = srslte_vec_dot_prod_cfc(&q->state[k], &q->filter[p * q->nof_taps], q->nof_taps);
+  }
+  q->next_t = (uint32_t)(t - end);
+
+  // Keep the last samples as history for the next call
+  if (hist > 0) {
+    memmove(q->state, &q->state[nof_input], sizeof(cf_t) * hist);
+  }
+
+  return count;
+}
+
+int srslte_resample_poly_run_s(srslte_resample_poly_t* q, const int16_t* input, int16_t* output, uint32_t nof_input)
+{
+  if (q == NULL || input == NULL || output == NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  if (nof_input > q->max_input_len) {
+    ERROR("Resampler input length %d exceeds maximum %d\n", nof_input, q->max_input_len);
+    return SRSLTE_ERROR_OUT_OF_BOUNDS;
+  }
+
+  // Conversion buffers are only allocated if the int16 interface is used
+  if (q->tmp_in == NULL) {
+    q->tmp_in  = srslte_vec_cf_malloc(q->max_input_len);
+    q->tmp_out = srslte_vec_cf_malloc(q->max_input_len * q->interp / q->decim + 1);
+    if (q->tmp_in == NULL || q->tmp_out == NULL) {
+      perror("malloc");
+      return SRSLTE_ERROR;
+    }
+  }
+
+  srslte_vec_convert_if(input, 1.0f, (float*)q->tmp_in, 2 * nof_input);
+
+  int n = srslte_resample_poly_run(q, q->tmp_in, q->tmp_out, nof_input);
+  if (n > 0) {
+    srslte_vec_convert_fi((float*)q->tmp_out, 1.0f, output, 2 * n);
+  }
+
+  return n;
+}
+
+void srslte_resample_poly_free(srslte_resample_poly_t* q)
+{
+  if (q == NULL) {
+    return;
+  }
+
+  if (q->filter) {
+    free(q->filter);
+  }
+  if (q->state) {
+    free(q->state);
+  }
+  if (q->tmp_in) {
+    free(q->tmp_in);
+  }
+  if (q->tmp_out) {
+    free(q->tmp_out);
+  }
+
+  bzero(q, sizeof(srslte_resample_poly_t));
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/test_common.h"
+#include "srslte/phy/common/phy_common.h"
+#include "srslte/phy/resampling/interp.h"
+#include "srslte/phy/utils/vector.h"
+#include <complex.h>
+#include <math.h>
+#include <stdlib.h>
+
+// Straight line between the input samples, extended with the first and last slopes at the edges
+static int test_interp_linear(srslte_interp_lin_t* q, uint32_t vector_len, uint32_t M, uint32_t off_st)
+{
+  uint32_t off_end = M - off_st;
+  cf_t*    input   = srslte_vec_cf_malloc(vector_len);
+  cf_t*    output  = srslte_vec_cf_malloc(vector_len * M);
+  TESTASSERT(input && output);
+
+  for (uint32_t i = 0; i < vector_len; i++) {
+    input[i] = (float)rand() / RAND_MAX + _Complex_I * (float)rand() / RAND_MAX;
+  }
+
+  TESTASSERT(srslte_interp_linear_resize(q, vector_len, M) == SRSLTE_SUCCESS);
+  srslte_interp_linear_offset(q, input, output, off_st, off_end);
+
+  for (uint32_t k = 0; k < vector_len * M; k++) {
+    int32_t  t = (int32_t)k - (int32_t)off_st;
+    uint32_t i = t < 0 ? 0 : SRSLTE_MIN((uint32_t)t / M, vector_len - 2);
+    cf_t     expected = input[i] + (input[i + 1] - input[i]) * (float)(t - (int32_t)(i * M)) / (float)M;
+    TESTASSERT(cabsf(output[k] - expected) < 1e-4f);
+  }
+
+  free(input);
+  free(output);
+  return SRSLTE_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  srslte_interp_lin_t q;
+  TESTASSERT(srslte_interp_linear_init(&q, 6 * SRSLTE_MAX_PRB, SRSLTE_NRE / 2) == SRSLTE_SUCCESS);
+
+  // The CRS, CRS of ports 2 and 3 and MBSFN factors have a specialized kernel, 4 goes through the generic one
+  uint32_t nof_prb[] = {6, 15, 25, 50, 75, 100};
+  uint32_t factors[] = {6, 3, 2, 4};
+  for (uint32_t b = 0; b < sizeof(nof_prb) / sizeof(nof_prb[0]); b++) {
+    for (uint32_t f = 0; f < sizeof(factors) / sizeof(factors[0]); f++) {
+      uint32_t M = factors[f];
+      for (uint32_t off_st = 0; off_st < M; off_st++) {
+        TESTASSERT(test_interp_linear(&q, SRSLTE_NRE * nof_prb[b] / M, M, off_st) == SRSLTE_SUCCESS);
+      }
+    }
+  }
+
+  srslte_interp_linear_free(&q);
+  printf("Ok\n");
+  return SRSLTE_SUCCESS;
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/phy/resampling/resample_poly.h"
+#include "srslte/phy/utils/debug.h"
+#include "srslte/phy/utils/vector.h"
+#include <complex.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+static uint32_t buffer_size = 1920;
+static uint32_t interp      = 4;
+static uint32_t decim       = 3;
+static uint32_t repetitions = 10;
+static float    passband    = SRSLTE_RESAMPLE_POLY_DEFAULT_PASSBAND;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s [sidrp]\n", prog);
+  printf("\t-s Buffer size [Default %d]\n", buffer_size);
+  printf("\t-i Interpolation factor [Default %d]\n", interp);
+  printf("\t-d Decimation factor [Default %d]\n", decim);
+  printf("\t-r Repetitions [Default %d]\n", repetitions);
+  printf("\t-p Passband [Default %.2f]\n", passband);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+
+  while ((opt = getopt(argc, argv, "sidrp")) != -1) {
+    switch (opt) {
+      case 's':
+        buffer_size = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'i':
+        interp = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'd':
+        decim = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'r':
+        repetitions = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'p':
+        passband = strtof(argv[optind], NULL);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+// Error of the resampled tone against the ideal tone, skipping the filter transient
+static float tone_error(const cf_t* out, uint32_t nof_out, float freq, float delay, uint32_t skip)
+{
+  float err = 0.0f;
+  for (uint32_t m = skip; m < nof_out; m++) {
+    double t   = (double)m * decim / interp - delay;
+    cf_t   ref = cexp(I * 2.0 * M_PI * freq * t);
+    err += crealf((out[m] - ref) * conjf(out[m] - ref));
+  }
+  return sqrtf(err / (nof_out - skip));
+}
+
+int main(int argc, char** argv)
+{
+  struct timeval         t[3] = {};
+  srslte_resample_poly_t q    = {};
+  int                    ret  = SRSLTE_ERROR;
+
+  parse_args(argc, argv);
+
+  uint32_t nof_input = buffer_size * repetitions;
+  uint32_t max_out   = nof_input * interp / decim + repetitions + 1;
+  cf_t*    src       = srslte_vec_cf_malloc(nof_input);
+  cf_t*    dst       = srslte_vec_cf_malloc(max_out);
+  int16_t* src_s     = srslte_vec_i16_malloc(2 * nof_input);
+  int16_t* dst_s     = srslte_vec_i16_malloc(2 * max_out);
+  cf_t*    dst_cf    = srslte_vec_cf_malloc(max_out);
+  if (!src || !dst || !src_s || !dst_s || !dst_cf) {
+    perror("malloc");
+    goto clean_exit;
+  }
+
+  if (srslte_resample_poly_init(
+          &q, interp, decim, buffer_size, passband, SRSLTE_RESAMPLE_POLY_DEFAULT_ATTENUATION_DB)) {
+    ERROR("Error initialising resampler\n");
+    goto clean_exit;
+  }
+
+  // Tone inside the passband, in cycles per input sample
+  float freq = 0.9f * passband * 0.5f * SRSLTE_MIN(1.0f, (float)interp / decim);
+  for (uint32_t i = 0; i < nof_input; i++) {
+    src[i] = cexpf(I * 2.0f * (float)M_PI * freq * i);
+  }
+
+  // Resample in blocks of different sizes to exercise the state between calls
+  uint32_t nof_out = 0;
+  uint32_t offset  = 0;
+  gettimeofday(&t[1], NULL);
+  for (uint32_t r = 0; offset < nof_input; r++) {
+    uint32_t len = SRSLTE_MIN(nof_input - offset, (r % 2) ? buffer_size : buffer_size / 2 + r);
+    uint32_t nof_exp = srslte_resample_poly_nof_output(&q, len);
+    int      n       = srslte_resample_poly_run(&q, &src[offset], &dst[nof_out], len);
+    if (n < 0 || (uint32_t)n != nof_exp) {
+      ERROR("Unexpected number of output samples %d, expected %d\n", n, nof_exp);
+      goto clean_exit;
+    }
+    nof_out += n;
+    offset += len;
+
+    // The input length for a given output length must be exact when decimating
+    if (interp <= decim && srslte_resample_poly_nof_output(&q, srslte_resample_poly_nof_input(&q, r + 1)) != r + 1) {
+      ERROR("Wrong number of input samples for %d output samples\n", r + 1);
+      goto clean_exit;
+    }
+  }
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  uint64_t duration_us = (uint64_t)(t[0].tv_sec * 1000000UL + t[0].tv_usec);
+  printf("Done %.1f Msps\n", nof_input / (double)duration_us);
+
+  float    delay = srslte_resample_poly_get_delay(&q) * decim / interp;
+  uint32_t skip  = (uint32_t)(4 * srslte_resample_poly_get_delay(&q)) + 1;
+  float    err   = tone_error(dst, nof_out, freq, delay, skip);
+  printf("%d/%d: %d taps per branch, %d output samples, rms error %f\n", interp, decim, q.nof_taps, nof_out, err);
+
+  // Same signal through the int16 interface
+  srslte_resample_poly_reset(&q);
+  srslte_vec_convert_fi((float*)src, 8192.0f, src_s, 2 * nof_input);
+  uint32_t nof_out_s = 0;
+  for (offset = 0; offset < nof_input; offset += buffer_size) {
+    int n = srslte_resample_poly_run_s(&q, &src_s[2 * offset], &dst_s[2 * nof_out_s], buffer_size);
+    if (n < 0) {
+      goto clean_exit;
+    }
+    nof_out_s += n;
+  }
+  srslte_vec_convert_if(dst_s, 8192.0f, (float*)dst_cf, 2 * nof_out_s);
+  float err_s = tone_error(dst_cf, nof_out_s, freq, delay, skip);
+  printf("int16: %d output samples, rms error %f\n", nof_out_s, err_s);
+
+  ret = (nof_out == nof_out_s && err < 0.01f && err_s < 0.01f) ? SRSLTE_SUCCESS : SRSLTE_ERROR;
+
+clean_exit:
+  srslte_resample_poly_free(&q);
+  if (src) {
+    free(src);
+  }
+  if (dst) {
+    free(dst);
+  }
+  if (src_s) {
+    free(src_s);
+  }
+  if (dst_s) {
+    free(dst_s);
+  }
+  if (dst_cf) {
+    free(dst_cf);
+  }
+
+  return ret;
+}
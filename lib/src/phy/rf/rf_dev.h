@@ -79,6 +79,15 @@ typedef struct {
                                     bool   blocking,
                                     bool   is_start_of_burst,
                                     bool   is_end_of_burst);
+  // Optional, receives interleaved int16 IQ samples
+  int (*srslte_rf_recv_with_time_multi_s)(void*     h,
+                                          int16_t** data,
+                                          uint32_t  nsamples,
+                                          bool      blocking,
+                                          time_t*   secs,
+                                          double*   frac_secs);
+  // Optional, reads and resets the device telemetry
+  int (*srslte_rf_get_metrics)(void* h, srslte_rf_metrics_t* metrics);
 } rf_dev_t;
 
 /* Define implementation for UHD */
@@ -114,7 +123,9 @@ static rf_dev_t dev_uhd = {"UHD",
                            rf_uhd_recv_with_time,
                            rf_uhd_recv_with_time_multi,
                            rf_uhd_send_timed,
-                           .srslte_rf_send_timed_multi = rf_uhd_send_timed_multi};
+                           .srslte_rf_send_timed_multi       = rf_uhd_send_timed_multi,
+                           .srslte_rf_recv_with_time_multi_s = rf_uhd_recv_with_time_multi_s,
+                           .srslte_rf_get_metrics            = rf_uhd_get_metrics};
 #endif
 
 /* Define implementation for bladeRF */
@@ -225,6 +236,114 @@ static rf_dev_t dev_zmq = {"zmq",
                            .srslte_rf_send_timed_multi = rf_zmq_send_timed_multi};
 #endif
 
+/* Define implementation for shared memory */
+#ifdef ENABLE_SHM
+
+#include "rf_shm_imp.h"
+
+static rf_dev_t dev_shm = {"shm",
+                           rf_shm_devname,
+                           rf_shm_start_rx_stream,
+                           rf_shm_stop_rx_stream,
+                           rf_shm_flush_buffer,
+                           rf_shm_has_rssi,
+                           rf_shm_get_rssi,
+                           rf_shm_suppress_stdout,
+                           rf_shm_register_error_handler,
+                           rf_shm_open,
+                           .srslte_rf_open_multi = rf_shm_open_multi,
+                           rf_shm_close,
+                           rf_shm_set_rx_srate,
+                           rf_shm_set_rx_gain,
+                           rf_shm_set_rx_gain_ch,
+                           rf_shm_set_tx_gain,
+                           rf_shm_set_tx_gain_ch,
+                           rf_shm_get_rx_gain,
+                           rf_shm_get_tx_gain,
+                           rf_shm_get_info,
+                           rf_shm_set_rx_freq,
+                           rf_shm_set_tx_srate,
+                           rf_shm_set_tx_freq,
+                           rf_shm_get_time,
+                           NULL,
+                           rf_shm_recv_with_time,
+                           rf_shm_recv_with_time_multi,
+                           rf_shm_send_timed,
+                           .srslte_rf_send_timed_multi = rf_shm_send_timed_multi};
+#endif
+
+/* Define implementation for file replay */
+#ifdef ENABLE_RF_FILE
+
+#include "rf_file_imp.h"
+
+static rf_dev_t dev_file = {"file",
+                            rf_file_devname,
+                            rf_file_start_rx_stream,
+                            rf_file_stop_rx_stream,
+                            rf_file_flush_buffer,
+                            rf_file_has_rssi,
+                            rf_file_get_rssi,
+                            rf_file_suppress_stdout,
+                            rf_file_register_error_handler,
+                            rf_file_open,
+                            .srslte_rf_open_multi = rf_file_open_multi,
+                            rf_file_close,
+                            rf_file_set_rx_srate,
+                            rf_file_set_rx_gain,
+                            rf_file_set_rx_gain_ch,
+                            rf_file_set_tx_gain,
+                            rf_file_set_tx_gain_ch,
+                            rf_file_get_rx_gain,
+                            rf_file_get_tx_gain,
+                            rf_file_get_info,
+                            rf_file_set_rx_freq,
+                            rf_file_set_tx_srate,
+                            rf_file_set_tx_freq,
+                            rf_file_get_time,
+                            NULL,
+                            rf_file_recv_with_time,
+                            rf_file_recv_with_time_multi,
+                            rf_file_send_timed,
+                            .srslte_rf_send_timed_multi = rf_file_send_timed_multi};
+#endif
+
+/* Define implementation for the eCPRI fronthaul */
+#ifdef ENABLE_ECPRI
+
+#include "rf_ecpri_imp.h"
+
+static rf_dev_t dev_ecpri = {"ecpri",
+                             rf_ecpri_devname,
+                             rf_ecpri_start_rx_stream,
+                             rf_ecpri_stop_rx_stream,
+                             rf_ecpri_flush_buffer,
+                             rf_ecpri_has_rssi,
+                             rf_ecpri_get_rssi,
+                             rf_ecpri_suppress_stdout,
+                             rf_ecpri_register_error_handler,
+                             rf_ecpri_open,
+                             .srslte_rf_open_multi = rf_ecpri_open_multi,
+                             rf_ecpri_close,
+                             rf_ecpri_set_rx_srate,
+                             rf_ecpri_set_rx_gain,
+                             rf_ecpri_set_rx_gain_ch,
+                             rf_ecpri_set_tx_gain,
+                             rf_ecpri_set_tx_gain_ch,
+                             rf_ecpri_get_rx_gain,
+                             rf_ecpri_get_tx_gain,
+                             rf_ecpri_get_info,
+                             rf_ecpri_set_rx_freq,
+                             rf_ecpri_set_tx_srate,
+                             rf_ecpri_set_tx_freq,
+                             rf_ecpri_get_time,
+                             NULL,
+                             rf_ecpri_recv_with_time,
+                             rf_ecpri_recv_with_time_multi,
+                             rf_ecpri_send_timed,
+                             .srslte_rf_send_timed_multi = rf_ecpri_send_timed_multi};
+#endif
+
 //#define ENABLE_DUMMY_DEV
 
 #ifdef ENABLE_DUMMY_DEV
@@ -255,6 +374,15 @@ static rf_dev_t* available_devices[] = {
 #ifdef ENABLE_ZEROMQ
     &dev_zmq,
 #endif
+#ifdef ENABLE_SHM
+    &dev_shm,
+#endif
+#ifdef ENABLE_RF_FILE
+    &dev_file,
+#endif
+#ifdef ENABLE_ECPRI
+    &dev_ecpri,
+#endif
 #ifdef ENABLE_DUMMY_DEV
     &dev_dummy,
 #endif
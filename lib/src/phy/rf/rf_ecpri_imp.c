@@ -0,0 +1,976 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * eCPRI fronthaul module for O-RAN split 7.2x radio units. The RF API carries time-domain baseband, so the module does
+ * the FFT of the transmitted subframes and the IFFT of the received ones: the fronthaul only carries the occupied
+ * subcarriers. Every symbol is sent as a U-plane message (O-RAN WG4 CUS) with the PRBs compressed with block floating
+ * point, and the PRBs without energy are left out of it, so the fronthaul load follows the cell load. Each symbol is
+ * announced with a C-plane section type 1 message, and the uplink is requested with one C-plane message per subframe.
+ *
+ * The messages are carried over UDP, the RU is addressed by tx_addr and tx_port and the uplink is received on rx_port.
+ * The device clock is the uplink: the first U-plane message received sets the time, and from then on every subframe
+ * is handed to the PHY when all its symbols arrived, the next subframe started or rx_timeout_ms elapsed.
+ *
+ * Example: "tx_addr=192.168.1.10,tx_port=44000,rx_port=44001,iq_width=9,eaxc0=0,eaxc1=1"
+ */
+
+#include "rf_ecpri_imp.h"
+#include "rf_helper.h"
+#include <arpa/inet.h>
+#include <complex.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <srslte/phy/common/phy_common.h>
+#include <srslte/phy/common/timestamp.h>
+#include <srslte/phy/dft/dft.h>
+#include <srslte/phy/utils/vector.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define ECPRI_MAX_GAIN_DB (30.0f)
+#define ECPRI_MIN_GAIN_DB (0.0f)
+#define ECPRI_NOF_SYMBOLS (SRSLTE_CP_NORM_SF_NSYMB)
+#define ECPRI_SUBCARRIER_SPACING (15000)
+#define ECPRI_SF_CYCLE (256 * SRSLTE_NOF_SF_X_FRAME) // the frameId has 8 bits
+#define ECPRI_MAX_PKT_LEN (9000)
+#define ECPRI_MAX_SECTIONS (SRSLTE_MAX_PRB / 2 + 1)
+#define ECPRI_SOCKET_BUFFER_LEN (4 * 1024 * 1024)
+
+// eCPRI common header, eAxC and sequence id
+#define ECPRI_HDR_LEN (8)
+#define ECPRI_REVISION (1)
+#define ECPRI_MSG_IQ_DATA (0)
+#define ECPRI_MSG_RT_CTRL (2)
+
+// O-RAN application header: data direction and payload version, frame, subframe, slot and symbol
+#define ECPRI_APP_HDR_LEN (4)
+#define ECPRI_DIR_UL (0)
+#define ECPRI_DIR_DL (1)
+
+// C-plane section type 1 and U-plane sections
+#define ECPRI_CSECTION_LEN (8)
+#define ECPRI_USECTION_LEN (6)
+#define ECPRI_SECTION_TYPE_1 (1)
+#define ECPRI_COMP_BFP (1)
+
+#define ECPRI_DEFAULT_TX_PORT (44000)
+#define ECPRI_DEFAULT_RX_PORT (44001)
+#define ECPRI_DEFAULT_IQ_WIDTH (9)
+#define ECPRI_DEFAULT_SCALE (8192.0)
+#define ECPRI_DEFAULT_EMPTY_TH (1e-6)
+#define ECPRI_DEFAULT_RX_TIMEOUT_MS (10)
+
+typedef struct {
+  // Common attributes
+  char             id[RF_PARAM_LEN];
+  srslte_rf_info_t info;
+  uint32_t         nof_channels;
+  uint32_t         eaxc[SRSLTE_MAX_CHANNELS];
+
+  // RF State
+  double   srate;
+  double   rx_gain;
+  uint32_t symbol_sz;
+  uint32_t nof_prb;
+  uint32_t sf_len;
+
+  // Fronthaul configuration
+  uint32_t           iq_width;      // mantissa bits of the BFP compression
+  float              scale;         // fixed point value of a unit subcarrier
+  float              empty_th;      // power of the PRBs left out, relative to the strongest PRB of the symbol
+  int                rx_timeout_ms; // time to wait for the symbols of a subframe
+  int                sock;
+  struct sockaddr_in tx_addr;
+  uint8_t            seq_id[2][SRSLTE_MAX_CHANNELS]; // per plane and eAxC
+  uint8_t*           pkt;
+
+  // Tx subframe being filled and the subframe index of its first sample
+  cf_t*    tx_sf[SRSLTE_MAX_CHANNELS];
+  uint64_t tx_sf_idx;
+  bool     tx_sf_valid;
+  uint64_t tx_next; // sample index following the last transmission
+  uint64_t tx_min;  // first sample index of the subframes not sent yet
+  int16_t* tx_iq;   // fixed point subcarriers of a symbol
+  float*   tx_prb_pwr;
+  uint64_t tx_nof_prb_sent;
+  uint64_t tx_nof_prb_total;
+  uint64_t tx_nof_bytes;
+
+  // Rx subframe handed to the PHY, it starts at the sample rx_sf_idx * sf_len
+  cf_t*    rx_sf[SRSLTE_MAX_CHANNELS];
+  uint64_t rx_sf_idx;
+  uint32_t rx_sf_offset;
+  uint64_t rx_count;
+  bool     rx_synced;
+  cf_t*    rx_grid[SRSLTE_MAX_CHANNELS]; // FFT bins of the ECPRI_NOF_SYMBOLS symbols
+  uint8_t* rx_pending;                   // message of a later subframe, received while assembling the current one
+  int      rx_pending_len;
+  int16_t  rx_iq[ECPRI_PRB_NOF_IQ];
+
+  srslte_dft_plan_t fft;
+  srslte_dft_plan_t ifft;
+  cf_t*             fft_buffer;
+
+  srslte_rf_error_handler_t error_handler;
+  void*                     error_handler_arg;
+
+  pthread_mutex_t tx_mutex;
+  pthread_mutex_t rx_mutex;
+} rf_ecpri_handler_t;
+
+/*
+ * Static Atributes
+ */
+static const char ecpri_devname[6] = "ecpri";
+
+/*
+ * Helpers
+ */
+
+static void rf_ecpri_now(uint64_t count, double srate, srslte_timestamp_t* now)
+{
+  srslte_timestamp_init(now, count / (uint64_t)srate, (double)(count % (uint64_t)srate) / srate);
+}
+
+static void rf_ecpri_error(rf_ecpri_handler_t* handler, srslte_rf_error_t error)
+{
+  if (handler->error_handler) {
+    handler->error_handler(handler->error_handler_arg, error);
+  }
+}
+
+static void rf_ecpri_update_rates(rf_ecpri_handler_t* handler, double srate)
+{
+  pthread_mutex_lock(&handler->tx_mutex);
+  pthread_mutex_lock(&handler->rx_mutex);
+
+  // The subcarrier spacing is fixed, the FFT size follows the rate
+  int nof_prb = srslte_nof_prb((uint32_t)(srate / ECPRI_SUBCARRIER_SPACING));
+  if (nof_prb <= 0 || (uint32_t)srate % 1000 != 0) {
+    fprintf(stderr, "[ecpri] Error: couldn't update sample rate. %.2f MHz is not an LTE rate\n", srate / 1e6);
+  } else {
+    handler->srate     = srate;
+    handler->symbol_sz = (uint32_t)(srate / ECPRI_SUBCARRIER_SPACING);
+    handler->nof_prb   = (uint32_t)nof_prb;
+    handler->sf_len    = (uint32_t)srate / 1000;
+    srslte_dft_replan(&handler->fft, handler->symbol_sz);
+    srslte_dft_replan(&handler->ifft, handler->symbol_sz);
+
+    // Both directions restart at the new rate
+    handler->tx_sf_valid  = false;
+    handler->tx_next      = 0;
+    handler->tx_min       = 0;
+    handler->rx_count     = 0;
+    handler->rx_sf_idx    = 0;
+    handler->rx_sf_offset = handler->sf_len;
+    handler->rx_synced    = false;
+  }
+  printf("Current sample rate is %.2f MHz (%d PRB)\n", handler->srate / 1e6, handler->nof_prb);
+
+  pthread_mutex_unlock(&handler->rx_mutex);
+  pthread_mutex_unlock(&handler->tx_mutex);
+}
+
+/* Bin of the FFT of the subcarrier k, the DC is not used */
+static inline uint32_t rf_ecpri_bin(const rf_ecpri_handler_t* handler, uint32_t k)
+{
+  uint32_t nsc = handler->nof_prb * SRSLTE_NRE;
+  return (k < nsc / 2) ? handler->symbol_sz - nsc / 2 + k : k - nsc / 2 + 1;
+}
+
+static inline void rf_ecpri_put_u16(uint8_t* p, uint32_t v)
+{
+  p[0] = (uint8_t)(v >> 8);
+  p[1] = (uint8_t)v;
+}
+
+static inline uint32_t rf_ecpri_get_u16(const uint8_t* p)
+{
+  return ((uint32_t)p[0] << 8) | p[1];
+}
+
+/* Writes the eCPRI common header and the O-RAN application header of the symbol of the subframe sf_idx */
+static uint32_t rf_ecpri_put_hdr(rf_ecpri_handler_t* handler,
+                                 uint8_t*            p,
+                                 uint32_t            msg_type,
+                                 uint32_t            ch,
+                                 uint32_t            dir,
+                                 uint64_t            sf_idx,
+                                 uint32_t            symbol)
+{
+  uint32_t plane = (msg_type == ECPRI_MSG_IQ_DATA) ? 0 : 1;
+  p[0]           = ECPRI_REVISION << 4;
+  p[1]           = (uint8_t)msg_type;
+  rf_ecpri_put_u16(&p[4], handler->eaxc[ch]);
+  p[6] = handler->seq_id[plane][ch]++;
+  p[7] = 0x80; // E bit, the message is not fragmented
+
+  uint64_t sf = sf_idx % ECPRI_SF_CYCLE;
+  p[8]        = (uint8_t)((dir << 7) | 1); // payload version 1, no filter index
+  p[9]        = (uint8_t)(sf / SRSLTE_NOF_SF_X_FRAME);
+  p[10]       = (uint8_t)((sf % SRSLTE_NOF_SF_X_FRAME) << 4); // slot 0, the numerology has one slot per subframe
+  p[11]       = (uint8_t)(symbol & 0x3f);
+  return ECPRI_HDR_LEN + ECPRI_APP_HDR_LEN;
+}
+
+static void rf_ecpri_send(rf_ecpri_handler_t* handler, uint8_t* p, uint32_t len)
+{
+  // The payload size excludes the 4 bytes of the common header
+  rf_ecpri_put_u16(&p[2], len - 4);
+  if (sendto(handler->sock, p, len, 0, (struct sockaddr*)&handler->tx_addr, sizeof(handler->tx_addr)) < 0) {
+    perror("[ecpri] sendto");
+  }
+}
+
+/* Sends a C-plane section type 1 message with one section per run of PRBs */
+static void rf_ecpri_send_cplane(rf_ecpri_handler_t* handler,
+                                 uint32_t            ch,
+                                 uint32_t            dir,
+                                 uint64_t            sf_idx,
+                                 uint32_t            symbol,
+                                 uint32_t            nof_symbols,
+                                 const uint32_t*     run_start,
+                                 const uint32_t*     run_len,
+                                 uint32_t            nof_runs)
+{
+  uint8_t* p   = handler->pkt;
+  uint32_t len = rf_ecpri_put_hdr(handler, p, ECPRI_MSG_RT_CTRL, ch, dir, sf_idx, symbol);
+  // Number of sections, section type, compression header and reserved byte
+  p[len++] = (uint8_t)nof_runs;
+  p[len++]     = ECPRI_SECTION_TYPE_1;
+  p[len++]     = (uint8_t)(((handler->iq_width & 0xf) << 4) | ECPRI_COMP_BFP);
+  p[len++]     = 0;
+  for (uint32_t i = 0; i < nof_runs; i++) {
+    // sectionId (12 bits), rb, symInc, startPrbc (10 bits), numPrbc, reMask (12 bits), numSymbol, ef and beamId
+    uint32_t num_prbc = run_len[i] > 255 ? 0 : run_len[i];
+    p[len + 0]        = (uint8_t)(i >> 4);
+    p[len + 1]        = (uint8_t)(((i & 0xf) << 4) | ((run_start[i] >> 8) & 0x3));
+    p[len + 2]        = (uint8_t)run_start[i];
+    p[len + 3]        = (uint8_t)num_prbc;
+    p[len + 4]        = 0xff;
+    p[len + 5]        = (uint8_t)(0xf0 | (nof_symbols & 0xf));
+    p[len + 6]        = 0;
+    p[len + 7]        = 0;
+    len += ECPRI_CSECTION_LEN;
+  }
+  rf_ecpri_send(handler, p, len);
+}
+
+/* Converts the subcarriers of a symbol to fixed point and finds the runs of PRBs with energy. Returns the number of
+ * runs */
+static uint32_t
+rf_ecpri_tx_symbol(rf_ecpri_handler_t* handler, const cf_t* freq, uint32_t* run_start, uint32_t* run_len)
+{
+  uint32_t nof_prb = handler->nof_prb;
+  float    max_pwr = 0.0f;
+  for (uint32_t prb = 0; prb < nof_prb; prb++) {
+    float    pwr = 0.0f;
+    int16_t* iq  = &handler->tx_iq[prb * ECPRI_PRB_NOF_IQ];
+    for (uint32_t i = 0; i < SRSLTE_NRE; i++) {
+      cf_t  v  = freq[rf_ecpri_bin(handler, prb * SRSLTE_NRE + i)];
+      float re = SRSLTE_MAX(SRSLTE_MIN(crealf(v) * handler->scale, INT16_MAX), INT16_MIN);
+      float im = SRSLTE_MAX(SRSLTE_MIN(cimagf(v) * handler->scale, INT16_MAX), INT16_MIN);
+      iq[2 * i]     = (int16_t)lrintf(re);
+      iq[2 * i + 1] = (int16_t)lrintf(im);
+      pwr += re * re + im * im;
+    }
+    handler->tx_prb_pwr[prb] = pwr;
+    max_pwr                  = SRSLTE_MAX(max_pwr, pwr);
+  }
+
+  // A PRB is sent if it has energy above the threshold, even a silent symbol keeps its U-plane message
+  uint32_t nof_runs = 0;
+  float    th       = SRSLTE_MAX(max_pwr * handler->empty_th, 0.5f);
+  for (uint32_t prb = 0; prb < nof_prb; prb++) {
+    if (handler->tx_prb_pwr[prb] < th) {
+      continue;
+    }
+    if (nof_runs > 0 && run_start[nof_runs - 1] + run_len[nof_runs - 1] == prb) {
+      run_len[nof_runs - 1]++;
+    } else {
+      run_start[nof_runs] = prb;
+      run_len[nof_runs]   = 1;
+      nof_runs++;
+    }
+  }
+  return nof_runs;
+}
+
+/* Sends the subframe tx_sf_idx, the samples not written by the PHY are zeros */
+static void rf_ecpri_tx_subframe(rf_ecpri_handler_t* handler)
+{
+  uint32_t nof_prb                       = handler->nof_prb;
+  uint32_t run_start[ECPRI_MAX_SECTIONS] = {};
+  uint32_t run_len[ECPRI_MAX_SECTIONS]   = {};
+
+  for (uint32_t ch = 0; ch < handler->nof_channels; ch++) {
+    // Uplink of the whole subframe
+    uint32_t all_start = 0;
+    rf_ecpri_send_cplane(handler, ch, ECPRI_DIR_UL, handler->tx_sf_idx, 0, ECPRI_NOF_SYMBOLS, &all_start, &nof_prb, 1);
+
+    uint32_t offset = 0;
+    for (uint32_t l = 0; l < ECPRI_NOF_SYMBOLS; l++) {
+      offset += SRSLTE_CP_LEN_NORM(l % SRSLTE_CP_NORM_NSYMB, handler->symbol_sz);
+      srslte_dft_run_c(&handler->fft, &handler->tx_sf[ch][offset], handler->fft_buffer);
+      offset += handler->symbol_sz;
+
+      uint32_t nof_runs = rf_ecpri_tx_symbol(handler, handler->fft_buffer, run_start, run_len);
+      rf_ecpri_send_cplane(handler, ch, ECPRI_DIR_DL, handler->tx_sf_idx, l, 1, run_start, run_len, nof_runs);
+
+      uint8_t* p   = handler->pkt;
+      uint32_t len = rf_ecpri_put_hdr(handler, p, ECPRI_MSG_IQ_DATA, ch, ECPRI_DIR_DL, handler->tx_sf_idx, l);
+      for (uint32_t i = 0; i < nof_runs; i++) {
+        // sectionId (12 bits), rb, symInc, startPrbu (10 bits), numPrbu, udCompHdr and reserved byte
+        p[len + 0] = (uint8_t)(i >> 4);
+        p[len + 1] = (uint8_t)(((i & 0xf) << 4) | ((run_start[i] >> 8) & 0x3));
+        p[len + 2] = (uint8_t)run_start[i];
+        p[len + 3] = (uint8_t)(run_len[i] > 255 ? 0 : run_len[i]);
+        p[len + 4] = (uint8_t)(((handler->iq_width & 0xf) << 4) | ECPRI_COMP_BFP);
+        p[len + 5] = 0;
+        len += ECPRI_USECTION_LEN;
+        for (uint32_t prb = run_start[i]; prb < run_start[i] + run_len[i]; prb++) {
+          len += rf_ecpri_bfp_compress(&handler->tx_iq[prb * ECPRI_PRB_NOF_IQ], handler->iq_width, &p[len]);
+        }
+        handler->tx_nof_prb_sent += run_len[i];
+      }
+      handler->tx_nof_prb_total += nof_prb;
+      handler->tx_nof_bytes += len;
+      rf_ecpri_send(handler, p, len);
+    }
+  }
+  handler->tx_sf_valid = false;
+  handler->tx_min      = (handler->tx_sf_idx + 1) * handler->sf_len;
+}
+
+/* Decodes the sections of a U-plane message into the grid of the channel */
+static void rf_ecpri_rx_sections(rf_ecpri_handler_t* handler, const uint8_t* p, int len, cf_t* grid)
+{
+  float scale = 1.0f / handler->scale;
+  int   n     = ECPRI_HDR_LEN + ECPRI_APP_HDR_LEN;
+  while (n + ECPRI_USECTION_LEN <= len) {
+    uint32_t start_prb = ((p[n + 1] & 0x3u) << 8) | p[n + 2];
+    uint32_t nof_prb   = p[n + 3] ? p[n + 3] : handler->nof_prb;
+    uint32_t iq_width  = p[n + 4] >> 4 ? p[n + 4] >> 4 : 16;
+    int      prb_len   = 1 + (int)(ECPRI_PRB_NOF_IQ * iq_width + 7) / 8;
+    n += ECPRI_USECTION_LEN;
+    for (uint32_t prb = start_prb; prb < start_prb + nof_prb && n + prb_len <= len; prb++) {
+      n += (int)rf_ecpri_bfp_decompress(&p[n], iq_width, handler->rx_iq);
+      if (prb >= handler->nof_prb) {
+        continue;
+      }
+      for (uint32_t i = 0; i < SRSLTE_NRE; i++) {
+        uint32_t k = prb * SRSLTE_NRE + i;
+        grid[rf_ecpri_bin(handler, k)] =
+            (handler->rx_iq[2 * i] + _Complex_I * handler->rx_iq[2 * i + 1]) * scale;
+      }
+    }
+  }
+}
+
+/* Assembles the subframe rx_sf_idx from the U-plane messages and converts it to time domain */
+static void rf_ecpri_rx_subframe(rf_ecpri_handler_t* handler)
+{
+  uint32_t nof_symbols = handler->nof_channels * ECPRI_NOF_SYMBOLS;
+  uint32_t received    = 0;
+
+  for (uint32_t ch = 0; ch < handler->nof_channels; ch++) {
+    srslte_vec_cf_zero(handler->rx_grid[ch], ECPRI_NOF_SYMBOLS * handler->symbol_sz);
+  }
+
+  while (received < nof_symbols) {
+    int len = handler->rx_pending_len;
+    if (len > 0) {
+      handler->rx_pending_len = 0;
+    } else {
+      struct pollfd pfd = {handler->sock, POLLIN, 0};
+      if (poll(&pfd, 1, handler->rx_timeout_ms) <= 0) {
+        break;
+      }
+      len = (int)recv(handler->sock, handler->rx_pending, ECPRI_MAX_PKT_LEN, 0);
+    }
+
+    const uint8_t* p = handler->rx_pending;
+    if (len < ECPRI_HDR_LEN + ECPRI_APP_HDR_LEN || (p[0] >> 4) != ECPRI_REVISION || p[1] != ECPRI_MSG_IQ_DATA) {
+      continue;
+    }
+    uint32_t eaxc = rf_ecpri_get_u16(&p[4]);
+    uint32_t ch   = 0;
+    while (ch < handler->nof_channels && handler->eaxc[ch] != eaxc) {
+      ch++;
+    }
+    uint32_t symbol = p[11] & 0x3fu;
+    if (ch == handler->nof_channels || symbol >= ECPRI_NOF_SYMBOLS) {
+      continue;
+    }
+
+    // The first message sets the device time
+    uint64_t sf = (uint64_t)p[9] * SRSLTE_NOF_SF_X_FRAME + (p[10] >> 4);
+    if (!handler->rx_synced) {
+      handler->rx_synced = true;
+      handler->rx_sf_idx = sf;
+      handler->rx_count  = sf * handler->sf_len;
+    }
+
+    uint64_t delta = (sf + ECPRI_SF_CYCLE - handler->rx_sf_idx % ECPRI_SF_CYCLE) % ECPRI_SF_CYCLE;
+    if (delta == 0) {
+      rf_ecpri_rx_sections(handler, p, len, &handler->rx_grid[ch][symbol * handler->symbol_sz]);
+      received++;
+    } else if (delta < ECPRI_SF_CYCLE / 2) {
+      // The next subframe started, the missing symbols of this one are lost
+      handler->rx_pending_len = len;
+      break;
+    }
+  }
+
+  float    gain   = srslte_convert_dB_to_amplitude(handler->rx_gain);
+  uint32_t offset = 0;
+  for (uint32_t l = 0; l < ECPRI_NOF_SYMBOLS; l++) {
+    uint32_t cp_len = SRSLTE_CP_LEN_NORM(l % SRSLTE_CP_NORM_NSYMB, handler->symbol_sz);
+    for (uint32_t ch = 0; ch < handler->nof_channels; ch++) {
+      cf_t* out = &handler->rx_sf[ch][offset];
+      srslte_dft_run_c(&handler->ifft, &handler->rx_grid[ch][l * handler->symbol_sz], &out[cp_len]);
+      srslte_vec_sc_prod_cfc(&out[cp_len], gain, &out[cp_len], handler->symbol_sz);
+      srslte_vec_cf_copy(out, &out[handler->symbol_sz], cp_len);
+    }
+    offset += cp_len + handler->symbol_sz;
+  }
+  handler->rx_sf_offset = 0;
+}
+
+/*
+ * Public methods
+ */
+
+uint32_t rf_ecpri_bfp_compress(const int16_t iq[ECPRI_PRB_NOF_IQ], uint32_t iq_width, uint8_t* out)
+{
+  // The exponent is the shift that leaves the largest magnitude in iq_width bits with sign
+  int32_t max = 0;
+  for (uint32_t i = 0; i < ECPRI_PRB_NOF_IQ; i++) {
+    int32_t v = iq[i];
+    max       = SRSLTE_MAX(max, v < 0 ? ~v : v);
+  }
+  uint32_t nof_bits = 0;
+  while ((max >> nof_bits) > 0) {
+    nof_bits++;
+  }
+  uint32_t exponent = (nof_bits + 1 > iq_width) ? nof_bits + 1 - iq_width : 0;
+  out[0]            = (uint8_t)exponent; // udCompParam, 4 reserved bits and the exponent
+
+  int32_t  max_m    = (1 << (iq_width - 1)) - 1;
+  uint32_t mask     = (1u << iq_width) - 1;
+  uint32_t acc      = 0;
+  uint32_t acc_bits = 0;
+  uint32_t len      = 1;
+  for (uint32_t i = 0; i < ECPRI_PRB_NOF_IQ; i++) {
+    int32_t m = exponent ? (iq[i] + (1 << (exponent - 1))) >> exponent : iq[i];
+    m         = SRSLTE_MIN(m, max_m);
+    acc       = (acc << iq_width) | ((uint32_t)m & mask);
+    acc_bits += iq_width;
+    while (acc_bits >= 8) {
+      acc_bits -= 8;
+      out[len++] = (uint8_t)(acc >> acc_bits);
+    }
+  }
+  if (acc_bits > 0) {
+    out[len++] = (uint8_t)(acc << (8 - acc_bits));
+  }
+  return len;
+}
+
+uint32_t rf_ecpri_bfp_decompress(const uint8_t* in, uint32_t iq_width, int16_t iq[ECPRI_PRB_NOF_IQ])
+{
+  uint32_t exponent = in[0] & 0xfu;
+  uint32_t mask     = (1u << iq_width) - 1;
+  uint32_t acc      = 0;
+  uint32_t acc_bits = 0;
+  uint32_t len      = 1;
+  for (uint32_t i = 0; i < ECPRI_PRB_NOF_IQ; i++) {
+    while (acc_bits < iq_width) {
+      acc = (acc << 8) | in[len++];
+      acc_bits += 8;
+    }
+    acc_bits -= iq_width;
+    uint32_t u = (acc >> acc_bits) & mask;
+    int32_t  m = (u >> (iq_width - 1)) ? (int32_t)u - (int32_t)(1u << iq_width) : (int32_t)u;
+    iq[i]      = (int16_t)(m * (1 << exponent));
+  }
+  return len;
+}
+
+void rf_ecpri_get_tx_stats(void* h, uint64_t* nof_prb_sent, uint64_t* nof_prb_total, uint64_t* nof_bytes)
+{
+  if (h) {
+    rf_ecpri_handler_t* handler = (rf_ecpri_handler_t*)h;
+    pthread_mutex_lock(&handler->tx_mutex);
+    if (nof_prb_sent) {
+      *nof_prb_sent = handler->tx_nof_prb_sent;
+    }
+    if (nof_prb_total) {
+      *nof_prb_total = handler->tx_nof_prb_total;
+    }
+    if (nof_bytes) {
+      *nof_bytes = handler->tx_nof_bytes;
+    }
+    pthread_mutex_unlock(&handler->tx_mutex);
+  }
+}
+
+void rf_ecpri_suppress_stdout(void* h)
+{
+  // do nothing
+}
+
+void rf_ecpri_register_error_handler(void* h, srslte_rf_error_handler_t new_handler, void* arg)
+{
+  if (h) {
+    rf_ecpri_handler_t* handler = (rf_ecpri_handler_t*)h;
+    handler->error_handler      = new_handler;
+    handler->error_handler_arg  = arg;
+  }
+}
+
+const char* rf_ecpri_devname(void* h)
+{
+  return ecpri_devname;
+}
+
+int rf_ecpri_start_rx_stream(void* h, bool now)
+{
+  return SRSLTE_SUCCESS;
+}
+
+int rf_ecpri_stop_rx_stream(void* h)
+{
+  return SRSLTE_SUCCESS;
+}
+
+void rf_ecpri_flush_buffer(void* h)
+{
+  // do nothing
+}
+
+bool rf_ecpri_has_rssi(void* h)
+{
+  return false;
+}
+
+float rf_ecpri_get_rssi(void* h)
+{
+  return 0.0;
+}
+
+int rf_ecpri_open(char* args, void** h)
+{
+  return rf_ecpri_open_multi(args, h, 1);
+}
+
+int rf_ecpri_open_multi(char* args, void** h, uint32_t nof_channels)
+{
+  int ret = SRSLTE_ERROR;
+  if (h && nof_channels > 0 && nof_channels < SRSLTE_MAX_CHANNELS) {
+    *h = NULL;
+
+    rf_ecpri_handler_t* handler = (rf_ecpri_handler_t*)malloc(sizeof(rf_ecpri_handler_t));
+    if (!handler) {
+      perror("malloc");
+      return SRSLTE_ERROR;
+    }
+    bzero(handler, sizeof(rf_ecpri_handler_t));
+    *h                        = handler;
+    handler->sock             = -1;
+    handler->srate            = 1.92e6;
+    handler->info.max_rx_gain = ECPRI_MAX_GAIN_DB;
+    handler->info.min_rx_gain = ECPRI_MIN_GAIN_DB;
+    handler->info.max_tx_gain = ECPRI_MAX_GAIN_DB;
+    handler->info.min_tx_gain = ECPRI_MIN_GAIN_DB;
+    handler->nof_channels     = nof_channels;
+    strcpy(handler->id, "ecpri\0");
+
+    if (pthread_mutex_init(&handler->tx_mutex, NULL) || pthread_mutex_init(&handler->rx_mutex, NULL)) {
+      perror("Mutex init");
+    }
+
+    // parse args
+    char     tx_addr[RF_PARAM_LEN] = "127.0.0.1";
+    uint32_t tx_port               = ECPRI_DEFAULT_TX_PORT;
+    uint32_t rx_port               = ECPRI_DEFAULT_RX_PORT;
+    uint32_t rx_timeout_ms         = ECPRI_DEFAULT_RX_TIMEOUT_MS;
+    double   scale                 = ECPRI_DEFAULT_SCALE;
+    double   empty_th              = ECPRI_DEFAULT_EMPTY_TH;
+    handler->iq_width              = ECPRI_DEFAULT_IQ_WIDTH;
+    if (args) {
+      parse_string(args, "tx_addr", -1, tx_addr);
+      parse_uint32(args, "tx_port", -1, &tx_port);
+      parse_uint32(args, "rx_port", -1, &rx_port);
+      parse_uint32(args, "rx_timeout_ms", -1, &rx_timeout_ms);
+      parse_uint32(args, "iq_width", -1, &handler->iq_width);
+      parse_double(args, "scale", -1, &scale);
+      parse_double(args, "empty_th", -1, &empty_th);
+      parse_string(args, "id", -1, handler->id);
+    }
+    for (uint32_t i = 0; i < nof_channels; i++) {
+      handler->eaxc[i] = i;
+      if (args) {
+        parse_uint32(args, "eaxc", i, &handler->eaxc[i]);
+      }
+    }
+    if (handler->iq_width < 2 || handler->iq_width > 16) {
+      fprintf(stderr, "[ecpri] Error: invalid iq_width %d, valid widths are 2 to 16 bits\n", handler->iq_width);
+      goto clean_exit;
+    }
+    handler->scale         = (float)scale;
+    handler->empty_th      = (float)empty_th;
+    handler->rx_timeout_ms = (int)rx_timeout_ms;
+
+    handler->tx_addr.sin_family = AF_INET;
+    handler->tx_addr.sin_port   = htons((uint16_t)tx_port);
+    if (inet_pton(AF_INET, tx_addr, &handler->tx_addr.sin_addr) != 1) {
+      fprintf(stderr, "[ecpri] Error: invalid tx_addr %s\n", tx_addr);
+      goto clean_exit;
+    }
+
+    handler->sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (handler->sock < 0) {
+      perror("[ecpri] socket");
+      goto clean_exit;
+    }
+    // The symbols arrive in bursts, the default socket buffer only holds a few subframes
+    int buffer_len = ECPRI_SOCKET_BUFFER_LEN;
+    if (setsockopt(handler->sock, SOL_SOCKET, SO_RCVBUF, &buffer_len, sizeof(buffer_len)) < 0) {
+      perror("[ecpri] setsockopt");
+    }
+    struct sockaddr_in rx_addr = {};
+    rx_addr.sin_family         = AF_INET;
+    rx_addr.sin_port           = htons((uint16_t)rx_port);
+    rx_addr.sin_addr.s_addr    = htonl(INADDR_ANY);
+    if (bind(handler->sock, (struct sockaddr*)&rx_addr, sizeof(rx_addr)) < 0) {
+      perror("[ecpri] bind");
+      goto clean_exit;
+    }
+
+    // Buffers for the largest bandwidth, the rate changes only replan the DFTs
+    handler->pkt        = srslte_vec_u8_malloc(ECPRI_MAX_PKT_LEN);
+    handler->rx_pending = srslte_vec_u8_malloc(ECPRI_MAX_PKT_LEN);
+    handler->tx_iq      = srslte_vec_i16_malloc(SRSLTE_MAX_PRB * ECPRI_PRB_NOF_IQ);
+    handler->tx_prb_pwr = srslte_vec_f_malloc(SRSLTE_MAX_PRB);
+    handler->fft_buffer = srslte_vec_cf_malloc(SRSLTE_SYMBOL_SZ_MAX);
+    if (!handler->pkt || !handler->rx_pending || !handler->tx_iq || !handler->tx_prb_pwr || !handler->fft_buffer) {
+      goto clean_exit;
+    }
+    for (uint32_t i = 0; i < nof_channels; i++) {
+      handler->tx_sf[i]   = srslte_vec_cf_malloc(SRSLTE_SF_LEN_MAX);
+      handler->rx_sf[i]   = srslte_vec_cf_malloc(SRSLTE_SF_LEN_MAX);
+      handler->rx_grid[i] = srslte_vec_cf_malloc(ECPRI_NOF_SYMBOLS * SRSLTE_SYMBOL_SZ_MAX);
+      if (!handler->tx_sf[i] || !handler->rx_sf[i] || !handler->rx_grid[i]) {
+        goto clean_exit;
+      }
+    }
+
+    if (srslte_dft_plan_c(&handler->fft, SRSLTE_SYMBOL_SZ_MAX, SRSLTE_DFT_FORWARD) ||
+        srslte_dft_plan_c(&handler->ifft, SRSLTE_SYMBOL_SZ_MAX, SRSLTE_DFT_BACKWARD)) {
+      fprintf(stderr, "[ecpri] Error: creating DFT plans\n");
+      goto clean_exit;
+    }
+    srslte_dft_plan_set_norm(&handler->fft, true);
+    srslte_dft_plan_set_norm(&handler->ifft, true);
+
+    rf_ecpri_update_rates(handler, 1.92e6);
+
+    ret = SRSLTE_SUCCESS;
+
+  clean_exit:
+    if (ret) {
+      rf_ecpri_close(handler);
+      *h = NULL;
+    }
+  }
+  return ret;
+}
+
+int rf_ecpri_close(void* h)
+{
+  rf_ecpri_handler_t* handler = (rf_ecpri_handler_t*)h;
+
+  if (handler->sock >= 0) {
+    close(handler->sock);
+  }
+  for (uint32_t i = 0; i < SRSLTE_MAX_CHANNELS; i++) {
+    free(handler->tx_sf[i]);
+    free(handler->rx_sf[i]);
+    free(handler->rx_grid[i]);
+  }
+  free(handler->pkt);
+  free(handler->rx_pending);
+  free(handler->tx_iq);
+  free(handler->tx_prb_pwr);
+  free(handler->fft_buffer);
+  srslte_dft_plan_free(&handler->fft);
+  srslte_dft_plan_free(&handler->ifft);
+
+  pthread_mutex_destroy(&handler->tx_mutex);
+  pthread_mutex_destroy(&handler->rx_mutex);
+
+  free(handler);
+
+  return SRSLTE_SUCCESS;
+}
+
+double rf_ecpri_set_rx_srate(void* h, double srate)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_ecpri_handler_t* handler = (rf_ecpri_handler_t*)h;
+    if (srate != handler->srate) {
+      rf_ecpri_update_rates(handler, srate);
+    }
+    ret = handler->srate;
+  }
+  return ret;
+}
+
+double rf_ecpri_set_tx_srate(void* h, double srate)
+{
+  return rf_ecpri_set_rx_srate(h, srate);
+}
+
+int rf_ecpri_set_rx_gain(void* h, double gain)
+{
+  if (h) {
+    rf_ecpri_handler_t* handler = (rf_ecpri_handler_t*)h;
+    handler->rx_gain            = gain;
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int rf_ecpri_set_rx_gain_ch(void* h, uint32_t ch, double gain)
+{
+  return rf_ecpri_set_rx_gain(h, gain);
+}
+
+int rf_ecpri_set_tx_gain(void* h, double gain)
+{
+  // The RU applies the transmission gain
+  return SRSLTE_SUCCESS;
+}
+
+int rf_ecpri_set_tx_gain_ch(void* h, uint32_t ch, double gain)
+{
+  return rf_ecpri_set_tx_gain(h, gain);
+}
+
+double rf_ecpri_get_rx_gain(void* h)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_ecpri_handler_t* handler = (rf_ecpri_handler_t*)h;
+    ret                         = handler->rx_gain;
+  }
+  return ret;
+}
+
+double rf_ecpri_get_tx_gain(void* h)
+{
+  return 0.0;
+}
+
+srslte_rf_info_t* rf_ecpri_get_info(void* h)
+{
+  srslte_rf_info_t* info = NULL;
+  if (h) {
+    rf_ecpri_handler_t* handler = (rf_ecpri_handler_t*)h;
+    info                        = &handler->info;
+  }
+  return info;
+}
+
+double rf_ecpri_set_rx_freq(void* h, uint32_t ch, double freq)
+{
+  // The carrier frequency is configured in the RU by its management plane
+  return freq;
+}
+
+double rf_ecpri_set_tx_freq(void* h, uint32_t ch, double freq)
+{
+  return freq;
+}
+
+void rf_ecpri_get_time(void* h, time_t* secs, double* frac_secs)
+{
+  if (h) {
+    rf_ecpri_handler_t* handler = (rf_ecpri_handler_t*)h;
+    srslte_timestamp_t  ts      = {};
+    pthread_mutex_lock(&handler->rx_mutex);
+    rf_ecpri_now(handler->rx_count, handler->srate, &ts);
+    pthread_mutex_unlock(&handler->rx_mutex);
+    if (secs) {
+      *secs = ts.full_secs;
+    }
+    if (frac_secs) {
+      *frac_secs = ts.frac_secs;
+    }
+  }
+}
+
+int rf_ecpri_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
+{
+  return rf_ecpri_recv_with_time_multi(h, &data, nsamples, blocking, secs, frac_secs);
+}
+
+int rf_ecpri_recv_with_time_multi(void*    h,
+                                  void**   data,
+                                  uint32_t nsamples,
+                                  bool     blocking,
+                                  time_t*  secs,
+                                  double*  frac_secs)
+{
+  int ret = SRSLTE_ERROR;
+
+  if (h && data) {
+    rf_ecpri_handler_t* handler = (rf_ecpri_handler_t*)h;
+
+    pthread_mutex_lock(&handler->rx_mutex);
+
+    for (uint32_t n = 0; n < nsamples;) {
+      if (handler->rx_sf_offset == handler->sf_len) {
+        rf_ecpri_rx_subframe(handler);
+      }
+
+      // set timestamp for this reception, after the first subframe that may have set the time
+      if (n == 0 && secs != NULL && frac_secs != NULL) {
+        srslte_timestamp_t ts = {};
+        rf_ecpri_now(handler->rx_count, handler->srate, &ts);
+        *secs      = ts.full_secs;
+        *frac_secs = ts.frac_secs;
+      }
+
+      uint32_t len = SRSLTE_MIN(handler->sf_len - handler->rx_sf_offset, nsamples - n);
+      for (uint32_t i = 0; i < handler->nof_channels; i++) {
+        if (data[i]) {
+          srslte_vec_cf_copy(&((cf_t*)data[i])[n], &handler->rx_sf[i][handler->rx_sf_offset], len);
+        }
+      }
+      n += len;
+      handler->rx_sf_offset += len;
+      handler->rx_count += len;
+      if (handler->rx_sf_offset == handler->sf_len) {
+        handler->rx_sf_idx++;
+      }
+    }
+
+    ret = nsamples;
+
+    pthread_mutex_unlock(&handler->rx_mutex);
+  }
+
+  return ret;
+}
+
+int rf_ecpri_send_timed(void*  h,
+                        void*  data,
+                        int    nsamples,
+                        time_t secs,
+                        double frac_secs,
+                        bool   has_time_spec,
+                        bool   blocking,
+                        bool   is_start_of_burst,
+                        bool   is_end_of_burst)
+{
+  void* _data[4] = {data, NULL, NULL, NULL};
+
+  return rf_ecpri_send_timed_multi(
+      h, _data, nsamples, secs, frac_secs, has_time_spec, blocking, is_start_of_burst, is_end_of_burst);
+}
+
+int rf_ecpri_send_timed_multi(void*  h,
+                              void*  data[4],
+                              int    nsamples,
+                              time_t secs,
+                              double frac_secs,
+                              bool   has_time_spec,
+                              bool   blocking,
+                              bool   is_start_of_burst,
+                              bool   is_end_of_burst)
+{
+  int ret = SRSLTE_ERROR;
+
+  if (h && data && nsamples > 0) {
+    rf_ecpri_handler_t* handler = (rf_ecpri_handler_t*)h;
+
+    pthread_mutex_lock(&handler->tx_mutex);
+
+    uint64_t idx = handler->tx_next;
+    if (has_time_spec) {
+      idx = (uint64_t)secs * (uint64_t)handler->srate + (uint64_t)round(frac_secs * handler->srate);
+    }
+
+    // The samples of a subframe already sent are dropped
+    uint32_t n   = 0;
+    uint64_t min = handler->tx_sf_valid ? handler->tx_sf_idx * handler->sf_len : handler->tx_min;
+    if (idx < min) {
+      srslte_rf_error_t error = {};
+      error.type              = SRSLTE_RF_ERROR_LATE;
+      rf_ecpri_error(handler, error);
+      n = (uint32_t)SRSLTE_MIN(min - idx, (uint64_t)nsamples);
+      idx += n;
+    }
+
+    while (n < (uint32_t)nsamples) {
+      uint64_t sf_idx = idx / handler->sf_len;
+      uint32_t offset = (uint32_t)(idx % handler->sf_len);
+
+      // A jump to another subframe sends the current one as it is
+      if (handler->tx_sf_valid && sf_idx != handler->tx_sf_idx) {
+        rf_ecpri_tx_subframe(handler);
+      }
+      if (!handler->tx_sf_valid) {
+        for (uint32_t i = 0; i < handler->nof_channels; i++) {
+          srslte_vec_cf_zero(handler->tx_sf[i], handler->sf_len);
+        }
+        handler->tx_sf_idx   = sf_idx;
+        handler->tx_sf_valid = true;
+      }
+
+      uint32_t len = SRSLTE_MIN(handler->sf_len - offset, (uint32_t)nsamples - n);
+      for (uint32_t i = 0; i < handler->nof_channels; i++) {
+        if (data[i]) {
+          srslte_vec_cf_copy(&handler->tx_sf[i][offset], &((cf_t*)data[i])[n], len);
+        }
+      }
+      n += len;
+      idx += len;
+      if (offset + len == handler->sf_len) {
+        rf_ecpri_tx_subframe(handler);
+      }
+    }
+    handler->tx_next = idx;
+
+    pthread_mutex_unlock(&handler->tx_mutex);
+
+    ret = SRSLTE_SUCCESS;
+  }
+
+  return ret;
+}
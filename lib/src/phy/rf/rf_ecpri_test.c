@@ -0,0 +1,187 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "rf_ecpri_imp.h"
+#include "srslte/phy/rf/rf.h"
+#include "srslte/srslte.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+#define NUM_SF (10)
+#define NOF_PRB (6)
+#define SF_LEN (1920)
+#define SRATE (1.92e6)
+
+static cf_t grid[SRSLTE_CP_NORM_SF_NSYMB * NOF_PRB * SRSLTE_NRE];
+static cf_t tx_buffer[NUM_SF][SF_LEN];
+static cf_t ofdm_buffer[SF_LEN];
+static cf_t rx_buffer[SF_LEN];
+
+static int test_bfp()
+{
+  int16_t iq[ECPRI_PRB_NOF_IQ];
+  int16_t out[ECPRI_PRB_NOF_IQ];
+  uint8_t buffer[1 + 2 * ECPRI_PRB_NOF_IQ];
+
+  for (uint32_t iq_width = 2; iq_width <= 16; iq_width++) {
+    for (uint32_t max_bits = 1; max_bits <= 16; max_bits++) {
+      for (uint32_t i = 0; i < ECPRI_PRB_NOF_IQ; i++) {
+        iq[i] = (int16_t)((rand() % (1 << max_bits)) - (1 << (max_bits - 1)));
+      }
+      uint32_t len = rf_ecpri_bfp_compress(iq, iq_width, buffer);
+      if (len != 1 + (ECPRI_PRB_NOF_IQ * iq_width + 7) / 8 || rf_ecpri_bfp_decompress(buffer, iq_width, out) != len) {
+        fprintf(stderr, "Wrong BFP length %d for %d bits\n", len, iq_width);
+        return SRSLTE_ERROR;
+      }
+
+      // The error is the rounding to the shared exponent, a whole step if the mantissa saturates
+      int32_t step = 1 << buffer[0];
+      for (uint32_t i = 0; i < ECPRI_PRB_NOF_IQ; i++) {
+        if (abs(out[i] - iq[i]) > step) {
+          fprintf(stderr, "BFP error %d -> %d with %d bits and exponent %d\n", iq[i], out[i], iq_width, buffer[0]);
+          return SRSLTE_ERROR;
+        }
+        if (iq_width == 16 && out[i] != iq[i]) {
+          fprintf(stderr, "BFP with 16 bits is not lossless\n");
+          return SRSLTE_ERROR;
+        }
+      }
+    }
+  }
+  return SRSLTE_SUCCESS;
+}
+
+static int test_loopback()
+{
+  int         ret = SRSLTE_ERROR;
+  srslte_rf_t du  = {};
+  srslte_rf_t ru  = {};
+  char        du_args[RF_PARAM_LEN];
+  char        ru_args[RF_PARAM_LEN];
+  uint32_t    port = 44000 + (uint32_t)(getpid() % 10000) * 2;
+
+  snprintf(du_args, RF_PARAM_LEN, "tx_port=%d,rx_port=%d,rx_timeout_ms=5", port, port + 1);
+  snprintf(ru_args, RF_PARAM_LEN, "tx_port=%d,rx_port=%d,rx_timeout_ms=5", port + 1, port);
+
+  // The first half of the PRBs carry QPSK, the second half is empty
+  srslte_ofdm_t     ofdm = {};
+  srslte_ofdm_cfg_t cfg  = {};
+  cfg.nof_prb            = NOF_PRB;
+  cfg.cp                 = SRSLTE_CP_NORM;
+  cfg.normalize          = true;
+  cfg.in_buffer          = grid;
+  cfg.out_buffer         = ofdm_buffer;
+  if (srslte_ofdm_tx_init_cfg(&ofdm, &cfg)) {
+    fprintf(stderr, "Error initialising OFDM\n");
+    return SRSLTE_ERROR;
+  }
+  for (uint32_t i = 0; i < NUM_SF; i++) {
+    srslte_vec_cf_zero(grid, SRSLTE_CP_NORM_SF_NSYMB * NOF_PRB * SRSLTE_NRE);
+    for (uint32_t l = 0; l < SRSLTE_CP_NORM_SF_NSYMB; l++) {
+      for (uint32_t k = 0; k < NOF_PRB / 2 * SRSLTE_NRE; k++) {
+        grid[l * NOF_PRB * SRSLTE_NRE + k] = ((rand() & 1) ? M_SQRT1_2 : -M_SQRT1_2) +
+                                             _Complex_I * ((rand() & 1) ? M_SQRT1_2 : -M_SQRT1_2);
+      }
+    }
+    srslte_ofdm_tx_sf(&ofdm);
+    srslte_vec_cf_copy(tx_buffer[i], ofdm_buffer, SF_LEN);
+  }
+  srslte_ofdm_tx_free(&ofdm);
+
+  if (srslte_rf_open_devname(&du, "ecpri", du_args, 1) || srslte_rf_open_devname(&ru, "ecpri", ru_args, 1)) {
+    fprintf(stderr, "Error opening rf\n");
+    goto exit;
+  }
+  srslte_rf_set_tx_srate(&du, SRATE);
+  srslte_rf_set_rx_srate(&ru, SRATE);
+
+  // Every subframe is sent in two halves, the second one without time
+  for (uint32_t i = 0; i < NUM_SF; i++) {
+    if (srslte_rf_send_timed(&du, tx_buffer[i], SF_LEN / 2, 0, i * 1e-3) ||
+        srslte_rf_send(&du, &tx_buffer[i][SF_LEN / 2], SF_LEN / 2, true)) {
+      fprintf(stderr, "Error sending subframe %d\n", i);
+      goto exit;
+    }
+  }
+
+  // The RU side receives what the DU transmitted, with the compression error
+  for (uint32_t i = 0; i < NUM_SF + 1; i++) {
+    srslte_timestamp_t rx_time = {};
+    if (srslte_rf_recv_with_time(&ru, rx_buffer, SF_LEN, true, &rx_time.full_secs, &rx_time.frac_secs) != SF_LEN) {
+      fprintf(stderr, "Error receiving subframe %d\n", i);
+      goto exit;
+    }
+    if (fabs(srslte_timestamp_real(&rx_time) - i * 1e-3) > 1e-9) {
+      fprintf(stderr, "Wrong time %f of subframe %d\n", srslte_timestamp_real(&rx_time), i);
+      goto exit;
+    }
+
+    // The subframe after the last one times out and is zeros
+    float err = 0.0f;
+    float pwr = 0.0f;
+    for (uint32_t k = 0; k < SF_LEN; k++) {
+      cf_t expected = (i < NUM_SF) ? tx_buffer[i][k] : 0.0f;
+      err += __real__((rx_buffer[k] - expected) * conjf(rx_buffer[k] - expected));
+      pwr += __real__(expected * conjf(expected));
+    }
+    if ((i < NUM_SF && sqrtf(err / pwr) > 0.02f) || (i == NUM_SF && err > 0.0f)) {
+      fprintf(stderr, "Subframe %d received with EVM %.3f\n", i, sqrtf(err / pwr));
+      goto exit;
+    }
+  }
+
+  uint64_t nof_prb_sent = 0, nof_prb_total = 0, nof_bytes = 0;
+  rf_ecpri_get_tx_stats(du.handler, &nof_prb_sent, &nof_prb_total, &nof_bytes);
+  if (nof_prb_total != NUM_SF * SRSLTE_CP_NORM_SF_NSYMB * NOF_PRB || nof_prb_sent != nof_prb_total / 2) {
+    fprintf(stderr, "Sent %" PRIu64 " PRB of %" PRIu64 ", expected half of them\n", nof_prb_sent, nof_prb_total);
+    goto exit;
+  }
+  printf("Sent %" PRIu64 " of %" PRIu64 " PRB in %" PRIu64 " bytes\n", nof_prb_sent, nof_prb_total, nof_bytes);
+
+  ret = SRSLTE_SUCCESS;
+
+exit:
+  if (du.handler) {
+    srslte_rf_close(&du);
+  }
+  if (ru.handler) {
+    srslte_rf_close(&ru);
+  }
+  return ret;
+}
+
+int main()
+{
+  srand(0);
+
+  if (test_bfp()) {
+    fprintf(stderr, "BFP test failed!\n");
+    return SRSLTE_ERROR;
+  }
+
+  if (test_loopback()) {
+    fprintf(stderr, "Loopback test failed!\n");
+    return SRSLTE_ERROR;
+  }
+
+  printf("Ok\n");
+  return SRSLTE_SUCCESS;
+}
@@ -0,0 +1,627 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * File replay no-RF module. The Rx channels are read from a recording, interleaved like usrp_capture writes them, and
+ * the Tx channels are optionally written to another file. The device has no clock of its own: the time only advances
+ * by the samples every reception returns, so the PHY runs as fast as its workers consume the subframes and the
+ * recording is decoded faster than real time. When the recording ends the application is stopped with SIGINT, unless
+ * it is looped or followed by zeros.
+ *
+ * Example: "rx_file=capture.dat,file_type=sc16,base_srate=23.04e6,tx_file=tx.dat,eof=stop"
+ */
+
+#include "rf_file_imp.h"
+#include "rf_helper.h"
+#include <math.h>
+#include <pthread.h>
+#include <signal.h>
+#include <srslte/phy/common/phy_common.h>
+#include <srslte/phy/common/timestamp.h>
+#include <srslte/phy/io/filesink.h>
+#include <srslte/phy/io/filesource.h>
+#include <srslte/phy/utils/vector.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FILE_MAX_GAIN_DB (30.0f)
+#define FILE_MIN_GAIN_DB (0.0f)
+#define FILE_TX_BUFFER_LEN (4 * 1024 * 1024)
+#define FILE_ZEROS_LEN (65536)
+
+typedef enum { FILE_EOF_STOP = 0, FILE_EOF_LOOP, FILE_EOF_ZEROS } rf_file_eof_t;
+
+typedef struct {
+  // Common attributes
+  char             id[RF_PARAM_LEN];
+  srslte_rf_info_t info;
+  uint32_t         nof_channels;
+
+  // RF State
+  double        srate;      // radio rate configured by upper layers
+  double        base_srate; // rate of the recording, 0 if it follows the radio rate
+  uint32_t      decim_factor;
+  double        rx_gain;
+  rf_file_eof_t eof;
+  bool          eof_reported;
+
+  // Files
+  srslte_filesource_t source;
+  srslte_filesink_t   sink;
+  bool                has_source;
+  bool                has_sink;
+
+  // Virtual clock of each direction, the time at the last rate change plus the samples since then
+  srslte_timestamp_t rx_time;
+  uint64_t           rx_count;
+  srslte_timestamp_t tx_time;
+  uint64_t           tx_count;
+
+  // Recorded samples of a reception before the decimation
+  cf_t*    decim_buffer[SRSLTE_MAX_CHANNELS];
+  uint32_t decim_buffer_len;
+  cf_t*    zeros; // FILE_ZEROS_LEN samples
+
+  srslte_rf_error_handler_t error_handler;
+  void*                     error_handler_arg;
+
+  pthread_mutex_t mutex;
+} rf_file_handler_t;
+
+/*
+ * Static Atributes
+ */
+static const char file_devname[5] = "file";
+
+/*
+ * Helpers
+ */
+
+static void rf_file_now(const srslte_timestamp_t* base, uint64_t count, double srate, srslte_timestamp_t* now)
+{
+  *now = *base;
+  srslte_timestamp_add(now, count / (uint64_t)srate, (double)(count % (uint64_t)srate) / srate);
+}
+
+static void rf_file_error(rf_file_handler_t* handler, srslte_rf_error_t error)
+{
+  if (handler->error_handler) {
+    handler->error_handler(handler->error_handler_arg, error);
+  }
+}
+
+static void rf_file_update_rates(rf_file_handler_t* handler, double srate)
+{
+  pthread_mutex_lock(&handler->mutex);
+  // Keep both clocks continuous across the rate change
+  srslte_timestamp_t now = {};
+  rf_file_now(&handler->rx_time, handler->rx_count, handler->srate, &now);
+  handler->rx_time  = now;
+  handler->rx_count = 0;
+  rf_file_now(&handler->tx_time, handler->tx_count, handler->srate, &now);
+  handler->tx_time  = now;
+  handler->tx_count = 0;
+
+  // Decimation must be full integer
+  if (handler->base_srate == 0.0) {
+    handler->srate        = srate;
+    handler->decim_factor = 1;
+  } else if (((uint64_t)handler->base_srate % (uint64_t)srate) == 0) {
+    handler->srate        = srate;
+    handler->decim_factor = (uint32_t)(handler->base_srate / srate);
+  } else {
+    fprintf(stderr,
+            "Error: couldn't update sample rate. %.2f is not divisible by %.2f\n",
+            srate / 1e6,
+            handler->base_srate / 1e6);
+  }
+  printf("Current sample rate is %.2f MHz (x%d decimation)\n", handler->srate / 1e6, handler->decim_factor);
+  pthread_mutex_unlock(&handler->mutex);
+}
+
+/* Reads nsamples of every channel from the recording, handling its end. Returns the number of samples read */
+static int rf_file_read(rf_file_handler_t* handler, cf_t** buffer, uint32_t nsamples)
+{
+  uint32_t n       = 0;
+  bool     rewound = false;
+
+  while (n < nsamples) {
+    cf_t* ptr[SRSLTE_MAX_CHANNELS] = {};
+    for (uint32_t i = 0; i < handler->nof_channels; i++) {
+      ptr[i] = &buffer[i][n];
+    }
+    int ret = srslte_filesource_read_multi(&handler->source, (void**)ptr, nsamples - n, handler->nof_channels);
+    if (ret < 0) {
+      return SRSLTE_ERROR;
+    }
+    n += (uint32_t)ret / handler->nof_channels;
+    if (n == nsamples) {
+      break;
+    }
+
+    // End of the recording, an empty one can't be looped
+    if (handler->eof == FILE_EOF_LOOP && (ret > 0 || !rewound)) {
+      srslte_filesource_seek(&handler->source, 0);
+      rewound = true;
+      continue;
+    }
+    if (!handler->eof_reported) {
+      handler->eof_reported = true;
+      printf("[file] End of the recording after %.3f s\n", handler->rx_count / handler->srate);
+      if (handler->eof == FILE_EOF_STOP) {
+        raise(SIGINT);
+      }
+    }
+    for (uint32_t i = 0; i < handler->nof_channels; i++) {
+      srslte_vec_cf_zero(&buffer[i][n], nsamples - n);
+    }
+    n = nsamples;
+  }
+
+  return (int)n;
+}
+
+/*
+ * Public methods
+ */
+
+void rf_file_suppress_stdout(void* h)
+{
+  // do nothing
+}
+
+void rf_file_register_error_handler(void* h, srslte_rf_error_handler_t new_handler, void* arg)
+{
+  if (h) {
+    rf_file_handler_t* handler = (rf_file_handler_t*)h;
+    handler->error_handler     = new_handler;
+    handler->error_handler_arg = arg;
+  }
+}
+
+const char* rf_file_devname(void* h)
+{
+  return file_devname;
+}
+
+int rf_file_start_rx_stream(void* h, bool now)
+{
+  return SRSLTE_SUCCESS;
+}
+
+int rf_file_stop_rx_stream(void* h)
+{
+  return SRSLTE_SUCCESS;
+}
+
+void rf_file_flush_buffer(void* h)
+{
+  // do nothing
+}
+
+bool rf_file_has_rssi(void* h)
+{
+  return false;
+}
+
+float rf_file_get_rssi(void* h)
+{
+  return 0.0;
+}
+
+int rf_file_open(char* args, void** h)
+{
+  return rf_file_open_multi(args, h, 1);
+}
+
+int rf_file_open_multi(char* args, void** h, uint32_t nof_channels)
+{
+  int ret = SRSLTE_ERROR;
+  if (h && nof_channels > 0 && nof_channels < SRSLTE_MAX_CHANNELS) {
+    *h = NULL;
+
+    if (!args || !strlen(args)) {
+      fprintf(stderr, "[file] Error: RF device args are required for file replay no-RF module\n");
+      return SRSLTE_ERROR;
+    }
+
+    rf_file_handler_t* handler = (rf_file_handler_t*)malloc(sizeof(rf_file_handler_t));
+    if (!handler) {
+      perror("malloc");
+      return SRSLTE_ERROR;
+    }
+    bzero(handler, sizeof(rf_file_handler_t));
+    *h                        = handler;
+    handler->srate            = 1.92e6;
+    handler->decim_factor     = 1;
+    handler->info.max_rx_gain = FILE_MAX_GAIN_DB;
+    handler->info.min_rx_gain = FILE_MIN_GAIN_DB;
+    handler->info.max_tx_gain = FILE_MAX_GAIN_DB;
+    handler->info.min_tx_gain = FILE_MIN_GAIN_DB;
+    handler->nof_channels     = nof_channels;
+    strcpy(handler->id, "file\0");
+
+    if (pthread_mutex_init(&handler->mutex, NULL)) {
+      perror("Mutex init");
+    }
+
+    // parse args
+    char rx_file[RF_PARAM_LEN]   = {};
+    char tx_file[RF_PARAM_LEN]   = {};
+    char file_type[RF_PARAM_LEN] = {};
+    char eof[RF_PARAM_LEN]       = {};
+    parse_string(args, "rx_file", -1, rx_file);
+    parse_string(args, "tx_file", -1, tx_file);
+    parse_string(args, "id", -1, handler->id);
+    parse_double(args, "base_srate", -1, &handler->base_srate);
+
+    srslte_datatype_t type = SRSLTE_COMPLEX_FLOAT_BIN;
+    if (parse_string(args, "file_type", -1, file_type) == SRSLTE_SUCCESS) {
+      if (strcmp(file_type, "sc16") == 0) {
+        type = SRSLTE_COMPLEX_SHORT_BIN;
+      } else if (strcmp(file_type, "sc8") == 0) {
+        type = SRSLTE_COMPLEX_BYTE_BIN;
+      } else if (strcmp(file_type, "cf32") != 0) {
+        fprintf(stderr, "[file] Error: invalid file_type %s, valid types are cf32, sc16 and sc8\n", file_type);
+        goto clean_exit;
+      }
+    }
+    if (parse_string(args, "eof", -1, eof) == SRSLTE_SUCCESS) {
+      if (strcmp(eof, "loop") == 0) {
+        handler->eof = FILE_EOF_LOOP;
+      } else if (strcmp(eof, "zeros") == 0) {
+        handler->eof = FILE_EOF_ZEROS;
+      } else if (strcmp(eof, "stop") != 0) {
+        fprintf(stderr, "[file] Error: invalid eof %s, valid values are stop, loop and zeros\n", eof);
+        goto clean_exit;
+      }
+    }
+
+    if (strlen(rx_file) != 0) {
+      if (srslte_filesource_init(&handler->source, rx_file, type) != SRSLTE_SUCCESS) {
+        fprintf(stderr, "[file] Error: opening %s\n", rx_file);
+        goto clean_exit;
+      }
+      handler->has_source = true;
+    } else {
+      fprintf(stdout, "[file] %s Rx file not specified. Receiving zeros.\n", handler->id);
+    }
+
+    if (strlen(tx_file) != 0) {
+      if (srslte_filesink_init(&handler->sink, tx_file, type) != SRSLTE_SUCCESS) {
+        fprintf(stderr, "[file] Error: opening %s\n", tx_file);
+        goto clean_exit;
+      }
+      handler->has_sink = true;
+      handler->zeros    = srslte_vec_cf_malloc(FILE_ZEROS_LEN);
+      if (!handler->zeros) {
+        goto clean_exit;
+      }
+      srslte_vec_cf_zero(handler->zeros, FILE_ZEROS_LEN);
+      srslte_filesink_set_async(&handler->sink, FILE_TX_BUFFER_LEN);
+    }
+
+    rf_file_update_rates(handler, 1.92e6);
+
+    ret = SRSLTE_SUCCESS;
+
+  clean_exit:
+    if (ret) {
+      rf_file_close(handler);
+      *h = NULL;
+    }
+  }
+  return ret;
+}
+
+int rf_file_close(void* h)
+{
+  rf_file_handler_t* handler = (rf_file_handler_t*)h;
+
+  if (handler->has_source) {
+    srslte_filesource_free(&handler->source);
+  }
+  if (handler->has_sink) {
+    srslte_filesink_free(&handler->sink);
+  }
+  for (uint32_t i = 0; i < SRSLTE_MAX_CHANNELS; i++) {
+    free(handler->decim_buffer[i]);
+  }
+  free(handler->zeros);
+
+  pthread_mutex_destroy(&handler->mutex);
+
+  free(handler);
+
+  return SRSLTE_SUCCESS;
+}
+
+double rf_file_set_rx_srate(void* h, double srate)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_file_handler_t* handler = (rf_file_handler_t*)h;
+    rf_file_update_rates(handler, srate);
+    ret = handler->srate;
+  }
+  return ret;
+}
+
+double rf_file_set_tx_srate(void* h, double srate)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_file_handler_t* handler = (rf_file_handler_t*)h;
+    rf_file_update_rates(handler, srate);
+    ret = handler->srate;
+  }
+  return ret;
+}
+
+int rf_file_set_rx_gain(void* h, double gain)
+{
+  if (h) {
+    rf_file_handler_t* handler = (rf_file_handler_t*)h;
+    handler->rx_gain           = gain;
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int rf_file_set_rx_gain_ch(void* h, uint32_t ch, double gain)
+{
+  return rf_file_set_rx_gain(h, gain);
+}
+
+int rf_file_set_tx_gain(void* h, double gain)
+{
+  return SRSLTE_SUCCESS;
+}
+
+int rf_file_set_tx_gain_ch(void* h, uint32_t ch, double gain)
+{
+  return rf_file_set_tx_gain(h, gain);
+}
+
+double rf_file_get_rx_gain(void* h)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_file_handler_t* handler = (rf_file_handler_t*)h;
+    ret                        = handler->rx_gain;
+  }
+  return ret;
+}
+
+double rf_file_get_tx_gain(void* h)
+{
+  return 0.0;
+}
+
+srslte_rf_info_t* rf_file_get_info(void* h)
+{
+  srslte_rf_info_t* info = NULL;
+  if (h) {
+    rf_file_handler_t* handler = (rf_file_handler_t*)h;
+    info                       = &handler->info;
+  }
+  return info;
+}
+
+double rf_file_set_rx_freq(void* h, uint32_t ch, double freq)
+{
+  // The recording has a single carrier, the frequency is not used
+  return freq;
+}
+
+double rf_file_set_tx_freq(void* h, uint32_t ch, double freq)
+{
+  return freq;
+}
+
+void rf_file_get_time(void* h, time_t* secs, double* frac_secs)
+{
+  if (h) {
+    rf_file_handler_t* handler = (rf_file_handler_t*)h;
+    srslte_timestamp_t ts      = {};
+    pthread_mutex_lock(&handler->mutex);
+    rf_file_now(&handler->rx_time, handler->rx_count, handler->srate, &ts);
+    pthread_mutex_unlock(&handler->mutex);
+    if (secs) {
+      *secs = ts.full_secs;
+    }
+    if (frac_secs) {
+      *frac_secs = ts.frac_secs;
+    }
+  }
+}
+
+int rf_file_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
+{
+  return rf_file_recv_with_time_multi(h, &data, nsamples, blocking, secs, frac_secs);
+}
+
+int rf_file_recv_with_time_multi(void*    h,
+                                 void**   data,
+                                 uint32_t nsamples,
+                                 bool     blocking,
+                                 time_t*  secs,
+                                 double*  frac_secs)
+{
+  int ret = SRSLTE_ERROR;
+
+  if (h && data) {
+    rf_file_handler_t* handler = (rf_file_handler_t*)h;
+
+    pthread_mutex_lock(&handler->mutex);
+
+    // set timestamp for this reception
+    srslte_timestamp_t ts = {};
+    rf_file_now(&handler->rx_time, handler->rx_count, handler->srate, &ts);
+    if (secs != NULL && frac_secs != NULL) {
+      *secs      = ts.full_secs;
+      *frac_secs = ts.frac_secs;
+    }
+
+    // The PHY may not want every channel, the recording has them all
+    uint32_t decim = handler->decim_factor;
+    uint32_t len   = nsamples * decim;
+    if (handler->has_source && handler->decim_buffer_len < len) {
+      for (uint32_t i = 0; i < handler->nof_channels; i++) {
+        free(handler->decim_buffer[i]);
+        handler->decim_buffer[i] = srslte_vec_cf_malloc(len);
+        if (!handler->decim_buffer[i]) {
+          handler->decim_buffer_len = 0;
+          goto clean_exit;
+        }
+      }
+      handler->decim_buffer_len = len;
+    }
+
+    if (handler->has_source) {
+      cf_t* buffer[SRSLTE_MAX_CHANNELS] = {};
+      for (uint32_t i = 0; i < handler->nof_channels; i++) {
+        buffer[i] = (decim == 1 && data[i]) ? (cf_t*)data[i] : handler->decim_buffer[i];
+      }
+      if (rf_file_read(handler, buffer, len) < SRSLTE_SUCCESS) {
+        goto clean_exit;
+      }
+
+      float scale = srslte_convert_dB_to_amplitude(handler->rx_gain);
+      for (uint32_t i = 0; i < handler->nof_channels; i++) {
+        cf_t* out = (cf_t*)data[i];
+        if (out == NULL) {
+          continue;
+        }
+        if (decim == 1) {
+          srslte_vec_sc_prod_cfc(buffer[i], scale, out, nsamples);
+        } else {
+          // Averaging decimation
+          float norm = scale / decim;
+          for (uint32_t k = 0; k < nsamples; k++) {
+            cf_t avg = 0.0f;
+            for (uint32_t j = 0; j < decim; j++) {
+              avg += buffer[i][k * decim + j];
+            }
+            out[k] = avg * norm;
+          }
+        }
+      }
+    } else {
+      for (uint32_t i = 0; i < handler->nof_channels; i++) {
+        if (data[i]) {
+          srslte_vec_cf_zero((cf_t*)data[i], nsamples);
+        }
+      }
+    }
+
+    // The virtual clock only advances with the samples handed to the PHY
+    handler->rx_count += nsamples;
+
+    ret = nsamples;
+
+  clean_exit:
+    pthread_mutex_unlock(&handler->mutex);
+  }
+
+  return ret;
+}
+
+int rf_file_send_timed(void*  h,
+                       void*  data,
+                       int    nsamples,
+                       time_t secs,
+                       double frac_secs,
+                       bool   has_time_spec,
+                       bool   blocking,
+                       bool   is_start_of_burst,
+                       bool   is_end_of_burst)
+{
+  void* _data[4] = {data, NULL, NULL, NULL};
+
+  return rf_file_send_timed_multi(
+      h, _data, nsamples, secs, frac_secs, has_time_spec, blocking, is_start_of_burst, is_end_of_burst);
+}
+
+int rf_file_send_timed_multi(void*  h,
+                             void*  data[4],
+                             int    nsamples,
+                             time_t secs,
+                             double frac_secs,
+                             bool   has_time_spec,
+                             bool   blocking,
+                             bool   is_start_of_burst,
+                             bool   is_end_of_burst)
+{
+  int ret = SRSLTE_ERROR;
+
+  if (h && data && nsamples > 0) {
+    rf_file_handler_t* handler = (rf_file_handler_t*)h;
+    if (!handler->has_sink) {
+      return SRSLTE_SUCCESS;
+    }
+
+    pthread_mutex_lock(&handler->mutex);
+
+    // Fill the gap up to the transmission time with zeros, or drop the samples already in the past
+    uint32_t offset = 0;
+    if (has_time_spec) {
+      srslte_timestamp_t now = {};
+      rf_file_now(&handler->tx_time, handler->tx_count, handler->srate, &now);
+      srslte_timestamp_t gap = {};
+      srslte_timestamp_init(&gap, secs, frac_secs);
+      srslte_timestamp_sub(&gap, now.full_secs, now.frac_secs);
+      int64_t nof_gap = (int64_t)round(srslte_timestamp_real(&gap) * handler->srate);
+      if (nof_gap > 0) {
+        void* z[SRSLTE_MAX_CHANNELS] = {};
+        for (uint32_t i = 0; i < handler->nof_channels; i++) {
+          z[i] = handler->zeros;
+        }
+        for (int64_t n = 0; n < nof_gap; n += FILE_ZEROS_LEN) {
+          int len = (int)SRSLTE_MIN(nof_gap - n, FILE_ZEROS_LEN);
+          srslte_filesink_write_multi(&handler->sink, z, len, handler->nof_channels);
+        }
+        handler->tx_count += nof_gap;
+      } else if (nof_gap < 0) {
+        srslte_rf_error_t error = {};
+        error.type              = SRSLTE_RF_ERROR_LATE;
+        rf_file_error(handler, error);
+        offset = (uint32_t)SRSLTE_MIN(-nof_gap, (int64_t)nsamples);
+      }
+    }
+
+    // Missing channels are written as zeros
+    for (int n = (int)offset; n < nsamples; n += FILE_ZEROS_LEN) {
+      int   len                      = SRSLTE_MIN(nsamples - n, FILE_ZEROS_LEN);
+      void* ptr[SRSLTE_MAX_CHANNELS] = {};
+      for (uint32_t i = 0; i < handler->nof_channels; i++) {
+        ptr[i] = data[i] ? (void*)&((cf_t*)data[i])[n] : (void*)handler->zeros;
+      }
+      srslte_filesink_write_multi(&handler->sink, ptr, len, handler->nof_channels);
+    }
+    handler->tx_count += nsamples - offset;
+
+    pthread_mutex_unlock(&handler->mutex);
+
+    ret = SRSLTE_SUCCESS;
+  }
+
+  return ret;
+}
@@ -0,0 +1,252 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/phy/io/filesink.h"
+#include "srslte/phy/io/filesource.h"
+#include "srslte/phy/rf/rf.h"
+#include "srslte/srslte.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+#define NUM_SF (50)
+#define NOF_CHANNELS (2)
+#define TX_OFFSET_MS (4)
+#define MAX_SF_LEN (23040)
+
+static cf_t recording[NOF_CHANNELS][MAX_SF_LEN * NUM_SF];
+static cf_t rx_buffer[NOF_CHANNELS][MAX_SF_LEN];
+static cf_t tx_file_buffer[NOF_CHANNELS][MAX_SF_LEN * (NUM_SF + TX_OFFSET_MS)];
+
+static int write_recording(char* filename, uint32_t nsamples, uint32_t nof_channels)
+{
+  srslte_filesink_t sink = {};
+  void*             ptr[NOF_CHANNELS];
+
+  for (uint32_t j = 0; j < nof_channels; j++) {
+    for (uint32_t i = 0; i < nsamples; i++) {
+      recording[j][i] = ((float)rand() / (float)RAND_MAX) + _Complex_I * ((float)rand() / (float)RAND_MAX);
+    }
+    ptr[j] = recording[j];
+  }
+
+  if (srslte_filesink_init(&sink, filename, SRSLTE_COMPLEX_FLOAT_BIN)) {
+    return SRSLTE_ERROR;
+  }
+  srslte_filesink_write_multi(&sink, ptr, nsamples, nof_channels);
+  srslte_filesink_free(&sink);
+  return SRSLTE_SUCCESS;
+}
+
+static int run_test(double srate, uint32_t decim)
+{
+  int         ret = SRSLTE_ERROR;
+  srslte_rf_t radio;
+  char        rx_file[RF_PARAM_LEN];
+  char        tx_file[RF_PARAM_LEN];
+  char        args[RF_PARAM_LEN];
+  uint32_t    sf_len = (uint32_t)(srate / 1000);
+
+  snprintf(rx_file, RF_PARAM_LEN, "rf_file_test_rx%d.dat", getpid());
+  snprintf(tx_file, RF_PARAM_LEN, "rf_file_test_tx%d.dat", getpid());
+  int args_len =
+      snprintf(args, RF_PARAM_LEN, "rx_file=%s,tx_file=%s,eof=zeros,base_srate=%.0f", rx_file, tx_file, srate * decim);
+  if (args_len < 0 || args_len >= RF_PARAM_LEN) {
+    fprintf(stderr, "RF arguments do not fit in %d bytes\n", RF_PARAM_LEN);
+    return SRSLTE_ERROR;
+  }
+
+  if (write_recording(rx_file, sf_len * decim * NUM_SF, NOF_CHANNELS)) {
+    fprintf(stderr, "Error writing the recording\n");
+    return SRSLTE_ERROR;
+  }
+
+  if (srslte_rf_open_devname(&radio, "file", args, NOF_CHANNELS)) {
+    fprintf(stderr, "Error opening rf\n");
+    goto exit;
+  }
+  srslte_rf_set_rx_srate(&radio, srate);
+  srslte_rf_set_tx_srate(&radio, srate);
+
+  // One subframe more than the recording, which must be zeros
+  for (uint32_t i = 0; i < NUM_SF + 1; i++) {
+    srslte_timestamp_t rx_time = {}, tx_time = {};
+    void*              data_ptr[SRSLTE_MAX_CHANNELS] = {NULL};
+    for (uint32_t j = 0; j < NOF_CHANNELS; j++) {
+      data_ptr[j] = rx_buffer[j];
+    }
+    if (srslte_rf_recv_with_time_multi(&radio, data_ptr, sf_len, true, &rx_time.full_secs, &rx_time.frac_secs) !=
+        sf_len) {
+      fprintf(stderr, "Error receiving subframe %d\n", i);
+      goto exit;
+    }
+
+    // The virtual clock only counts the received samples
+    if (fabs(srslte_timestamp_real(&rx_time) - i * 1e-3) > 1e-9) {
+      fprintf(stderr, "Wrong time %f of subframe %d\n", srslte_timestamp_real(&rx_time), i);
+      goto exit;
+    }
+
+    for (uint32_t j = 0; j < NOF_CHANNELS; j++) {
+      for (uint32_t k = 0; k < sf_len; k++) {
+        cf_t expected = 0.0f;
+        if (i < NUM_SF) {
+          for (uint32_t d = 0; d < decim; d++) {
+            expected += recording[j][(i * sf_len + k) * decim + d];
+          }
+          expected /= decim;
+        }
+        if (cabsf(rx_buffer[j][k] - expected) > 1e-5) {
+          fprintf(stderr, "data mismatch in subframe %d, channel %d, sample %d\n", i, j, k);
+          goto exit;
+        }
+      }
+    }
+
+    // Transmit back what was received TX_OFFSET_MS later, the gap is filled with zeros
+    srslte_timestamp_copy(&tx_time, &rx_time);
+    srslte_timestamp_add(&tx_time, 0, TX_OFFSET_MS * 1e-3);
+    if (i < NUM_SF &&
+        srslte_rf_send_timed_multi(&radio, data_ptr, sf_len, tx_time.full_secs, tx_time.frac_secs, true, true, false)) {
+      fprintf(stderr, "Error sending subframe %d\n", i);
+      goto exit;
+    }
+  }
+  srslte_rf_close(&radio);
+
+  // Check what was transmitted
+  srslte_filesource_t source = {};
+  void*               ptr[NOF_CHANNELS];
+  for (uint32_t j = 0; j < NOF_CHANNELS; j++) {
+    ptr[j] = tx_file_buffer[j];
+  }
+  if (srslte_filesource_init(&source, tx_file, SRSLTE_COMPLEX_FLOAT_BIN)) {
+    goto exit;
+  }
+  int n = srslte_filesource_read_multi(&source, ptr, sf_len * (NUM_SF + TX_OFFSET_MS), NOF_CHANNELS);
+  srslte_filesource_free(&source);
+  if (n != (int)(sf_len * (NUM_SF + TX_OFFSET_MS) * NOF_CHANNELS)) {
+    fprintf(stderr, "Transmitted %d samples, expected %d\n", n, sf_len * (NUM_SF + TX_OFFSET_MS) * NOF_CHANNELS);
+    goto exit;
+  }
+  for (uint32_t j = 0; j < NOF_CHANNELS; j++) {
+    for (uint32_t i = 0; i < sf_len * TX_OFFSET_MS; i++) {
+      if (cabsf(tx_file_buffer[j][i]) > 0.0f) {
+        fprintf(stderr, "Tx gap is not zero at sample %d\n", i);
+        goto exit;
+      }
+    }
+  }
+  if (decim == 1 && memcmp(&tx_file_buffer[0][sf_len * TX_OFFSET_MS], recording[0], sizeof(cf_t) * sf_len * NUM_SF)) {
+    fprintf(stderr, "Tx data mismatch\n");
+    goto exit;
+  }
+
+  printf("Replayed %d subframes at %.2f MHz (x%d decimation)\n", NUM_SF, srate / 1e6, decim);
+
+  ret = SRSLTE_SUCCESS;
+
+exit:
+  unlink(rx_file);
+  unlink(tx_file);
+  return ret;
+}
+
+static int run_loop_test()
+{
+  int         ret = SRSLTE_ERROR;
+  srslte_rf_t radio;
+  char        rx_file[RF_PARAM_LEN];
+  char        args[RF_PARAM_LEN];
+  uint32_t    sf_len = 1920;
+
+  snprintf(rx_file, RF_PARAM_LEN, "rf_file_test_loop%d.dat", getpid());
+  int args_len = snprintf(args, RF_PARAM_LEN, "rx_file=%s,eof=loop", rx_file);
+  if (args_len < 0 || args_len >= RF_PARAM_LEN) {
+    fprintf(stderr, "RF arguments do not fit in %d bytes\n", RF_PARAM_LEN);
+    return SRSLTE_ERROR;
+  }
+
+  // A recording of 2.5 subframes, so the loop happens in the middle of a reception
+  if (write_recording(rx_file, sf_len * 5 / 2, 1)) {
+    fprintf(stderr, "Error writing the recording\n");
+    return SRSLTE_ERROR;
+  }
+  if (srslte_rf_open_devname(&radio, "file", args, 1)) {
+    fprintf(stderr, "Error opening rf\n");
+    goto exit;
+  }
+  srslte_rf_set_rx_srate(&radio, 1.92e6);
+
+  for (uint32_t i = 0; i < 10; i++) {
+    if (srslte_rf_recv_with_time(&radio, rx_buffer[0], sf_len, true, NULL, NULL) != sf_len) {
+      fprintf(stderr, "Error receiving subframe %d\n", i);
+      goto exit;
+    }
+    for (uint32_t k = 0; k < sf_len; k++) {
+      if (cabsf(rx_buffer[0][k] - recording[0][(i * sf_len + k) % (sf_len * 5 / 2)]) > 1e-5) {
+        fprintf(stderr, "data mismatch in looped subframe %d, sample %d\n", i, k);
+        goto exit;
+      }
+    }
+  }
+  srslte_rf_close(&radio);
+
+  printf("Looped a recording of 2.5 subframes\n");
+
+  ret = SRSLTE_SUCCESS;
+
+exit:
+  unlink(rx_file);
+  return ret;
+}
+
+int main()
+{
+  srslte_rf_t radio;
+
+  // Missing arguments must fail
+  char no_args[RF_PARAM_LEN] = {};
+  if (srslte_rf_open_devname(&radio, "file", no_args, 1) == SRSLTE_SUCCESS) {
+    fprintf(stderr, "Opening without arguments should fail\n");
+    return SRSLTE_ERROR;
+  }
+
+  // Recording at the radio rate
+  if (run_test(1.92e6, 1)) {
+    fprintf(stderr, "Test at base rate failed!\n");
+    return SRSLTE_ERROR;
+  }
+
+  // Recording at 23.04 MHz with decimation
+  if (run_test(1.92e6, 12)) {
+    fprintf(stderr, "Test with decimation failed!\n");
+    return SRSLTE_ERROR;
+  }
+
+  // Recording shorter than the run
+  if (run_loop_test()) {
+    fprintf(stderr, "Test with loop failed!\n");
+    return SRSLTE_ERROR;
+  }
+
+  printf("Ok\n");
+  return SRSLTE_SUCCESS;
+}
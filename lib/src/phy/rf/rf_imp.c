@@ -37,12 +37,13 @@ int rf_get_available_devices(char** devnames, int max_strlen)
 
 int srslte_rf_set_rx_gain_th(srslte_rf_t* rf, double gain)
 {
+  // Only takes the request, the gain thread does not hold the mutex while the radio applies a gain
+  pthread_mutex_lock(&rf->mutex);
   if (gain > rf->cur_rx_gain + 2 || gain < rf->cur_rx_gain - 2) {
-    pthread_mutex_lock(&rf->mutex);
     rf->new_rx_gain = gain;
     pthread_cond_signal(&rf->cond);
-    pthread_mutex_unlock(&rf->mutex);
   }
+  pthread_mutex_unlock(&rf->mutex);
   return SRSLTE_SUCCESS;
 }
 
@@ -51,26 +52,34 @@ void srslte_rf_set_tx_rx_gain_offset(srslte_rf_t* rf, double offset)
   rf->tx_rx_gain_offset = offset;
 }
 
-/* This thread listens for set_rx_gain commands to the USRP */
+/* This thread listens for set_rx_gain commands to the USRP. Setting the gain can take some milliseconds, so it is
+ * done without the mutex and the receive thread is never stalled by set_rx_gain_th() */
 static void* thread_gain_fcn(void* h)
 {
   srslte_rf_t* rf = (srslte_rf_t*)h;
 
+  pthread_mutex_lock(&rf->mutex);
   while (rf->thread_gain_run) {
-    pthread_mutex_lock(&rf->mutex);
     while (rf->cur_rx_gain == rf->new_rx_gain) {
       pthread_cond_wait(&rf->cond, &rf->mutex);
     }
-    if (rf->new_rx_gain != rf->cur_rx_gain) {
-      srslte_rf_set_rx_gain(h, rf->new_rx_gain);
-      rf->cur_rx_gain = srslte_rf_get_rx_gain(h);
-      rf->new_rx_gain = rf->cur_rx_gain;
-    }
+    double gain = rf->new_rx_gain;
+    pthread_mutex_unlock(&rf->mutex);
+
+    srslte_rf_set_rx_gain(h, gain);
+    double cur_rx_gain = srslte_rf_get_rx_gain(h);
     if (rf->tx_gain_same_rx) {
-      srslte_rf_set_tx_gain(h, rf->cur_rx_gain + rf->tx_rx_gain_offset);
+      srslte_rf_set_tx_gain(h, cur_rx_gain + rf->tx_rx_gain_offset);
+    }
+
+    pthread_mutex_lock(&rf->mutex);
+    rf->cur_rx_gain = cur_rx_gain;
+    // Keep the requests that arrived meanwhile
+    if (rf->new_rx_gain == gain) {
+      rf->new_rx_gain = cur_rx_gain;
     }
-    pthread_mutex_unlock(&rf->mutex);
   }
+  pthread_mutex_unlock(&rf->mutex);
   return NULL;
 }
 
@@ -260,6 +269,24 @@ int srslte_rf_recv_with_time_multi(srslte_rf_t* rf,
   return ((rf_dev_t*)rf->dev)->srslte_rf_recv_with_time_multi(rf->handler, data, nsamples, blocking, secs, frac_secs);
 }
 
+int srslte_rf_recv_with_time_multi_s(srslte_rf_t* rf,
+                                     int16_t**    data,
+                                     uint32_t     nsamples,
+                                     bool         blocking,
+                                     time_t*      secs,
+                                     double*      frac_secs)
+{
+  if (!srslte_rf_has_recv_s(rf)) {
+    return SRSLTE_ERROR;
+  }
+  return ((rf_dev_t*)rf->dev)->srslte_rf_recv_with_time_multi_s(rf->handler, data, nsamples, blocking, secs, frac_secs);
+}
+
+bool srslte_rf_has_recv_s(srslte_rf_t* rf)
+{
+  return ((rf_dev_t*)rf->dev)->srslte_rf_recv_with_time_multi_s != NULL;
+}
+
 int srslte_rf_set_tx_gain(srslte_rf_t* rf, double gain)
 {
   return ((rf_dev_t*)rf->dev)->srslte_rf_set_tx_gain(rf->handler, gain);
@@ -285,6 +312,14 @@ void srslte_rf_get_time(srslte_rf_t* rf, time_t* secs, double* frac_secs)
   return ((rf_dev_t*)rf->dev)->srslte_rf_get_time(rf->handler, secs, frac_secs);
 }
 
+int srslte_rf_get_metrics(srslte_rf_t* rf, srslte_rf_metrics_t* metrics)
+{
+  if (((rf_dev_t*)rf->dev)->srslte_rf_get_metrics == NULL) {
+    return SRSLTE_ERROR;
+  }
+  return ((rf_dev_t*)rf->dev)->srslte_rf_get_metrics(rf->handler, metrics);
+}
+
 int srslte_rf_sync(srslte_rf_t* rf)
 {
   int ret = SRSLTE_ERROR;
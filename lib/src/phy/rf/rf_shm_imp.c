@@ -0,0 +1,754 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Shared memory no-RF module. Every Tx and Rx channel is a single-producer single-consumer ring of fc32 samples in a
+ * POSIX shared memory object (/dev/shm), so two processes exchange base-band without sockets or syscalls. The ring
+ * is indexed by timestamp: the sample with timestamp t, counted in samples at the base rate since the start, lives in
+ * slot t mod capacity. Like the ZMQ module, every reception first pads the local transmitters with zeros up to the end
+ * of the received block so that both ends advance in lockstep. An end that connects while its peer is running resets
+ * its side of the rings to the timestamps of the peer and starts its clock there.
+ *
+ * Example, eNB: "tx_name=enb_dl,rx_name=enb_ul"  UE: "tx_name=enb_ul,rx_name=enb_dl"
+ */
+
+#include "rf_shm_imp.h"
+#include "rf_helper.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <srslte/phy/common/phy_common.h>
+#include <srslte/phy/common/timestamp.h>
+#include <srslte/phy/utils/vector.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SHM_BASERATE_DEFAULT_HZ (23040000)
+#define SHM_RING_DEFAULT_MS (20)
+#define SHM_HEADER_SIZE (4096)
+#define SHM_SPIN_COUNT (4096)
+#define SHM_POLL_US (20)
+#define SHM_MAX_GAIN_DB (30.0f)
+#define SHM_MIN_GAIN_DB (0.0f)
+
+/* Shared ring header, each timestamp is only written by its own end */
+typedef struct {
+  uint64_t write_ts __attribute__((aligned(64))); // Timestamp of the next sample to write
+  uint64_t read_ts __attribute__((aligned(64)));  // Timestamp of the next sample to read
+} rf_shm_ring_hdr_t;
+
+typedef struct {
+  char               name[RF_PARAM_LEN];
+  rf_shm_ring_hdr_t* hdr;
+  cf_t*              samples;
+  uint32_t           capacity; // Number of samples, power of two
+  size_t             map_size;
+  int                fd;    // Kept open to hold the lock that tells the peer this end is connected
+  pthread_mutex_t    mutex; // Serialises the local writers (Tx and Rx alignment)
+} rf_shm_ring_t;
+
+typedef struct {
+  // Common attributes
+  char             id[RF_PARAM_LEN];
+  srslte_rf_info_t info;
+  uint32_t         nof_channels;
+
+  // RF State
+  uint32_t srate; // radio rate configured by upper layers
+  uint32_t base_srate;
+  uint32_t decim_factor; // decimation factor between base_srate used on transport on radio's rate
+  double   rx_gain;
+  bool     running;
+  bool     tx_align; // pad Tx with zeros up to the end of every reception
+
+  // Rings
+  rf_shm_ring_t tx_ring[SRSLTE_MAX_CHANNELS];
+  rf_shm_ring_t rx_ring[SRSLTE_MAX_CHANNELS];
+
+  // Rx timestamp
+  uint64_t next_rx_ts;
+
+  pthread_mutex_t decim_mutex;
+} rf_shm_handler_t;
+
+/*
+ * Static Atributes
+ */
+static const char shm_devname[4] = "shm";
+
+/*
+ * Ring methods
+ */
+
+static int rf_shm_ring_open(rf_shm_ring_t* q, const char* name, uint32_t capacity, bool is_writer)
+{
+  int ret = SRSLTE_ERROR;
+
+  bzero(q, sizeof(rf_shm_ring_t));
+  snprintf(q->name, RF_PARAM_LEN, "%s%s", name[0] == '/' ? "" : "/", name);
+  q->capacity = capacity;
+  q->map_size = SHM_HEADER_SIZE + (size_t)capacity * sizeof(cf_t);
+
+  q->fd = shm_open(q->name, O_RDWR | O_CREAT, 0666);
+  if (q->fd < 0) {
+    fprintf(stderr, "[shm] Error: opening %s: %s\n", q->name, strerror(errno));
+    return SRSLTE_ERROR;
+  }
+
+  // Every end holds a shared lock while the ring is open. An end that gets the exclusive lock has no peer, not even one
+  // that crashed, so it owns whatever state the ring was left in
+  bool alone = flock(q->fd, LOCK_EX | LOCK_NB) == 0;
+  if (!alone && flock(q->fd, LOCK_SH) < 0) {
+    fprintf(stderr, "[shm] Error: locking %s: %s\n", q->name, strerror(errno));
+    goto clean_exit;
+  }
+
+  // The end without peer sizes the ring, the other one checks they agree
+  struct stat st = {};
+  if (fstat(q->fd, &st) < 0) {
+    fprintf(stderr, "[shm] Error: reading size of %s: %s\n", q->name, strerror(errno));
+    goto clean_exit;
+  }
+  if (alone) {
+    if ((size_t)st.st_size != q->map_size && ftruncate(q->fd, q->map_size) < 0) {
+      fprintf(stderr, "[shm] Error: resizing %s: %s\n", q->name, strerror(errno));
+      goto clean_exit;
+    }
+  } else if ((size_t)st.st_size != q->map_size) {
+    fprintf(stderr,
+            "[shm] Error: %s has %zu B but %zu B were expected, check base_srate and ring_ms match on both ends\n",
+            q->name,
+            (size_t)st.st_size,
+            q->map_size);
+    goto clean_exit;
+  }
+
+  void* ptr = mmap(NULL, q->map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, q->fd, 0);
+  if (ptr == MAP_FAILED) {
+    fprintf(stderr, "[shm] Error: mapping %s: %s\n", q->name, strerror(errno));
+    goto clean_exit;
+  }
+  q->hdr     = (rf_shm_ring_hdr_t*)ptr;
+  q->samples = (cf_t*)((uint8_t*)ptr + SHM_HEADER_SIZE);
+
+  if (alone) {
+    // Discard the state left by a previous run, the peer adopts these timestamps when it connects
+    __atomic_store_n(&q->hdr->write_ts, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&q->hdr->read_ts, 0, __ATOMIC_RELEASE);
+    if (flock(q->fd, LOCK_SH) < 0) {
+      fprintf(stderr, "[shm] Error: locking %s: %s\n", q->name, strerror(errno));
+      goto clean_exit;
+    }
+  } else if (is_writer) {
+    // The reader is waiting at its timestamp, anything written past it by a previous writer is stale
+    __atomic_store_n(&q->hdr->write_ts, __atomic_load_n(&q->hdr->read_ts, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+  } else {
+    // Start reading at the current timestamp of the writer, skipping what a previous reader left unread
+    __atomic_store_n(&q->hdr->read_ts, __atomic_load_n(&q->hdr->write_ts, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+  }
+
+  if (pthread_mutex_init(&q->mutex, NULL)) {
+    perror("Mutex init");
+  }
+
+  ret = SRSLTE_SUCCESS;
+
+clean_exit:
+  if (ret != SRSLTE_SUCCESS) {
+    if (q->hdr) {
+      munmap(q->hdr, q->map_size);
+      q->hdr = NULL;
+    }
+    close(q->fd);
+    q->fd = -1;
+  }
+  return ret;
+}
+
+static void rf_shm_ring_close(rf_shm_ring_t* q)
+{
+  if (q->hdr) {
+    // Only the last end removes the ring, a peer that is still running keeps it for the next connection
+    if (flock(q->fd, LOCK_EX | LOCK_NB) == 0) {
+      shm_unlink(q->name);
+    }
+    munmap(q->hdr, q->map_size);
+    pthread_mutex_destroy(&q->mutex);
+    close(q->fd); // releases the lock
+    q->hdr = NULL;
+    q->fd  = -1;
+  }
+}
+
+/* Returns false if the device is closing */
+static inline bool rf_shm_wait(rf_shm_handler_t* handler, uint32_t* count)
+{
+  // Spin for a little while before falling back to sleep
+  if ((*count)++ > SHM_SPIN_COUNT) {
+    usleep(SHM_POLL_US);
+  }
+  return __atomic_load_n(&handler->running, __ATOMIC_RELAXED);
+}
+
+/* Writes nsamples, each of them repeated interp times, or zeros if buffer is NULL. Waits for room in the ring. */
+static int rf_shm_ring_write(rf_shm_handler_t* handler,
+                             rf_shm_ring_t*    q,
+                             const cf_t*       buffer,
+                             uint64_t          nsamples,
+                             uint32_t          interp)
+{
+  uint64_t mask  = q->capacity - 1;
+  uint64_t w     = q->hdr->write_ts;
+  uint64_t total = nsamples * interp;
+  uint32_t count = 0;
+
+  for (uint64_t n = 0; n < total;) {
+    int64_t used = (int64_t)(w - __atomic_load_n(&q->hdr->read_ts, __ATOMIC_ACQUIRE));
+    used         = SRSLTE_MAX(used, 0);
+    if (used >= q->capacity) {
+      if (!rf_shm_wait(handler, &count)) {
+        return SRSLTE_ERROR;
+      }
+      continue;
+    }
+    count = 0;
+
+    uint64_t len = SRSLTE_MIN(q->capacity - used, total - n);
+    for (uint64_t k = 0; k < len;) {
+      uint64_t slot = (w + k) & mask;
+      uint64_t seg  = SRSLTE_MIN(len - k, q->capacity - slot);
+      if (buffer == NULL) {
+        memset(&q->samples[slot], 0, sizeof(cf_t) * seg);
+      } else if (interp == 1) {
+        memcpy(&q->samples[slot], &buffer[n + k], sizeof(cf_t) * seg);
+      } else {
+        // Zero order hold
+        for (uint64_t j = 0; j < seg; j++) {
+          q->samples[slot + j] = buffer[(n + k + j) / interp];
+        }
+      }
+      k += seg;
+    }
+
+    w += len;
+    n += len;
+    __atomic_store_n(&q->hdr->write_ts, w, __ATOMIC_RELEASE);
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+/* Pads the ring with zeros up to ts. Returns the number of padded samples, negative if ts is in the past. */
+static int64_t rf_shm_ring_align(rf_shm_handler_t* handler, rf_shm_ring_t* q, uint64_t ts)
+{
+  int64_t gap = (int64_t)(ts - q->hdr->write_ts);
+
+  if (gap > 0) {
+    if (rf_shm_ring_write(handler, q, NULL, (uint64_t)gap, 1) < SRSLTE_SUCCESS) {
+      return 0;
+    }
+  }
+
+  return gap;
+}
+
+/* Reads nsamples, each the average of decim ring samples, scaled. Discards them if buffer is NULL. Waits for data. */
+static int rf_shm_ring_read(rf_shm_handler_t* handler,
+                            rf_shm_ring_t*    q,
+                            cf_t*             buffer,
+                            uint32_t          nsamples,
+                            uint32_t          decim,
+                            float             scale)
+{
+  uint64_t mask  = q->capacity - 1;
+  uint64_t r     = q->hdr->read_ts;
+  uint64_t total = (uint64_t)nsamples * decim;
+  uint32_t count = 0;
+
+  for (uint64_t n = 0; n < total;) {
+    int64_t  avail = (int64_t)(__atomic_load_n(&q->hdr->write_ts, __ATOMIC_ACQUIRE) - r);
+    uint64_t len   = (avail > 0) ? SRSLTE_MIN((uint64_t)avail, total - n) : 0;
+    len -= len % decim;
+    if (len == 0) {
+      if (!rf_shm_wait(handler, &count)) {
+        return SRSLTE_ERROR;
+      }
+      continue;
+    }
+    count = 0;
+
+    if (buffer != NULL && decim == 1) {
+      for (uint64_t k = 0; k < len;) {
+        uint64_t slot = (r + k) & mask;
+        uint64_t seg  = SRSLTE_MIN(len - k, q->capacity - slot);
+        srslte_vec_sc_prod_cfc(&q->samples[slot], scale, &buffer[n + k], (uint32_t)seg);
+        k += seg;
+      }
+    } else if (buffer != NULL) {
+      // Averaging decimation
+      float norm = scale / decim;
+      for (uint64_t i = 0; i < len / decim; i++) {
+        cf_t avg = 0.0f;
+        for (uint32_t j = 0; j < decim; j++) {
+          avg += q->samples[(r + i * decim + j) & mask];
+        }
+        buffer[n / decim + i] = avg * norm;
+      }
+    }
+
+    r += len;
+    n += len;
+    __atomic_store_n(&q->hdr->read_ts, r, __ATOMIC_RELEASE);
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+static void rf_shm_update_rates(rf_shm_handler_t* handler, double srate)
+{
+  pthread_mutex_lock(&handler->decim_mutex);
+  // Decimation must be full integer
+  if (((uint64_t)handler->base_srate % (uint64_t)srate) == 0) {
+    handler->srate        = (uint32_t)srate;
+    handler->decim_factor = handler->base_srate / handler->srate;
+  } else {
+    fprintf(stderr,
+            "Error: couldn't update sample rate. %.2f is not divisible by %.2f\n",
+            srate / 1e6,
+            handler->base_srate / 1e6);
+  }
+  printf("Current sample rate is %.2f MHz with a base rate of %.2f MHz (x%d decimation)\n",
+         handler->srate / 1e6,
+         handler->base_srate / 1e6,
+         handler->decim_factor);
+  pthread_mutex_unlock(&handler->decim_mutex);
+}
+
+/*
+ * Public methods
+ */
+
+void rf_shm_suppress_stdout(void* h)
+{
+  // do nothing
+}
+
+void rf_shm_register_error_handler(void* h, srslte_rf_error_handler_t new_handler, void* arg)
+{
+  // do nothing
+}
+
+const char* rf_shm_devname(void* h)
+{
+  return shm_devname;
+}
+
+int rf_shm_start_rx_stream(void* h, bool now)
+{
+  return SRSLTE_SUCCESS;
+}
+
+int rf_shm_stop_rx_stream(void* h)
+{
+  return SRSLTE_SUCCESS;
+}
+
+void rf_shm_flush_buffer(void* h)
+{
+  // do nothing
+}
+
+bool rf_shm_has_rssi(void* h)
+{
+  return false;
+}
+
+float rf_shm_get_rssi(void* h)
+{
+  return 0.0;
+}
+
+int rf_shm_open(char* args, void** h)
+{
+  return rf_shm_open_multi(args, h, 1);
+}
+
+int rf_shm_open_multi(char* args, void** h, uint32_t nof_channels)
+{
+  int ret = SRSLTE_ERROR;
+  if (h && nof_channels < SRSLTE_MAX_CHANNELS) {
+    *h = NULL;
+
+    if (!args || !strlen(args)) {
+      fprintf(stderr, "[shm] Error: RF device args are required for shared memory no-RF module\n");
+      return SRSLTE_ERROR;
+    }
+
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)malloc(sizeof(rf_shm_handler_t));
+    if (!handler) {
+      perror("malloc");
+      return SRSLTE_ERROR;
+    }
+    bzero(handler, sizeof(rf_shm_handler_t));
+    *h                        = handler;
+    handler->base_srate       = SHM_BASERATE_DEFAULT_HZ; // Sample rate for 100 PRB cell
+    handler->rx_gain          = 0.0;
+    handler->info.max_rx_gain = SHM_MAX_GAIN_DB;
+    handler->info.min_rx_gain = SHM_MIN_GAIN_DB;
+    handler->info.max_tx_gain = SHM_MAX_GAIN_DB;
+    handler->info.min_tx_gain = SHM_MIN_GAIN_DB;
+    handler->nof_channels     = nof_channels;
+    handler->running          = true;
+    handler->tx_align         = true;
+    strcpy(handler->id, "shm\0");
+
+    if (pthread_mutex_init(&handler->decim_mutex, NULL)) {
+      perror("Mutex init");
+    }
+
+    // parse args
+    uint32_t ring_ms = SHM_RING_DEFAULT_MS;
+    parse_uint32(args, "base_srate", -1, &handler->base_srate);
+    parse_uint32(args, "ring_ms", -1, &ring_ms);
+    parse_string(args, "id", -1, handler->id);
+    char tmp[RF_PARAM_LEN] = {};
+    if (parse_string(args, "tx_align", -1, tmp) == SRSLTE_SUCCESS) {
+      handler->tx_align = !(strcmp(tmp, "false") == 0 || strcmp(tmp, "no") == 0);
+    }
+
+    rf_shm_update_rates(handler, 1.92e6);
+
+    // Ring capacity, rounded up to a power of two so that slots are a mask of the timestamp
+    uint64_t min_capacity = SRSLTE_MAX((uint64_t)handler->base_srate * ring_ms / 1000, 1);
+    uint32_t capacity     = 1;
+    while (capacity < min_capacity) {
+      capacity <<= 1;
+    }
+
+    for (uint32_t i = 0; i < handler->nof_channels; i++) {
+      char tx_name[RF_PARAM_LEN] = {};
+      char rx_name[RF_PARAM_LEN] = {};
+
+      parse_string(args, "tx_name", i, tx_name);
+      parse_string(args, "rx_name", i, rx_name);
+
+      if (strlen(tx_name) != 0) {
+        if (rf_shm_ring_open(&handler->tx_ring[i], tx_name, capacity, true) != SRSLTE_SUCCESS) {
+          fprintf(stderr, "[shm] Error: opening transmitter\n");
+          goto clean_exit;
+        }
+      } else {
+        fprintf(stdout, "[shm] %s Tx name not specified. Disabling transmitter %d.\n", handler->id, i);
+      }
+
+      if (strlen(rx_name) != 0) {
+        if (rf_shm_ring_open(&handler->rx_ring[i], rx_name, capacity, false) != SRSLTE_SUCCESS) {
+          fprintf(stderr, "[shm] Error: opening receiver\n");
+          goto clean_exit;
+        }
+      } else {
+        fprintf(stdout, "[shm] %s Rx name not specified. Disabling receiver %d.\n", handler->id, i);
+      }
+
+      if (!handler->tx_ring[i].hdr && !handler->rx_ring[i].hdr) {
+        fprintf(stderr, "[shm] Error: Neither Tx name nor Rx name specified.\n");
+        goto clean_exit;
+      }
+    }
+
+    // When the peer is already running, the clock starts at its timestamp so that both ends stay in lockstep
+    if (handler->rx_ring[0].hdr) {
+      handler->next_rx_ts = __atomic_load_n(&handler->rx_ring[0].hdr->read_ts, __ATOMIC_ACQUIRE);
+    } else if (handler->tx_ring[0].hdr) {
+      handler->next_rx_ts = __atomic_load_n(&handler->tx_ring[0].hdr->write_ts, __ATOMIC_ACQUIRE);
+    }
+
+    ret = SRSLTE_SUCCESS;
+
+  clean_exit:
+    if (ret) {
+      rf_shm_close(handler);
+      *h = NULL;
+    }
+  }
+  return ret;
+}
+
+int rf_shm_close(void* h)
+{
+  rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+
+  __atomic_store_n(&handler->running, false, __ATOMIC_RELAXED);
+
+  for (uint32_t i = 0; i < handler->nof_channels; i++) {
+    rf_shm_ring_close(&handler->tx_ring[i]);
+    rf_shm_ring_close(&handler->rx_ring[i]);
+  }
+
+  pthread_mutex_destroy(&handler->decim_mutex);
+
+  free(handler);
+
+  return SRSLTE_SUCCESS;
+}
+
+double rf_shm_set_rx_srate(void* h, double srate)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    rf_shm_update_rates(handler, srate);
+    ret = handler->srate;
+  }
+  return ret;
+}
+
+double rf_shm_set_tx_srate(void* h, double srate)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    rf_shm_update_rates(handler, srate);
+    ret = handler->srate;
+  }
+  return ret;
+}
+
+int rf_shm_set_rx_gain(void* h, double gain)
+{
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    handler->rx_gain          = gain;
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int rf_shm_set_rx_gain_ch(void* h, uint32_t ch, double gain)
+{
+  return rf_shm_set_rx_gain(h, gain);
+}
+
+int rf_shm_set_tx_gain(void* h, double gain)
+{
+  return SRSLTE_SUCCESS;
+}
+
+int rf_shm_set_tx_gain_ch(void* h, uint32_t ch, double gain)
+{
+  return rf_shm_set_tx_gain(h, gain);
+}
+
+double rf_shm_get_rx_gain(void* h)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    ret                       = handler->rx_gain;
+  }
+  return ret;
+}
+
+double rf_shm_get_tx_gain(void* h)
+{
+  return 0.0;
+}
+
+srslte_rf_info_t* rf_shm_get_info(void* h)
+{
+  srslte_rf_info_t* info = NULL;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    info                      = &handler->info;
+  }
+  return info;
+}
+
+double rf_shm_set_rx_freq(void* h, uint32_t ch, double freq)
+{
+  // Channels are mapped to rings by index, the frequency is not used
+  return freq;
+}
+
+double rf_shm_set_tx_freq(void* h, uint32_t ch, double freq)
+{
+  return freq;
+}
+
+void rf_shm_get_time(void* h, time_t* secs, double* frac_secs)
+{
+  if (h) {
+    rf_shm_handler_t*  handler = (rf_shm_handler_t*)h;
+    srslte_timestamp_t ts      = {};
+    srslte_timestamp_init_uint64(&ts, handler->next_rx_ts, handler->base_srate);
+    if (secs) {
+      *secs = ts.full_secs;
+    }
+    if (frac_secs) {
+      *frac_secs = ts.frac_secs;
+    }
+  }
+}
+
+int rf_shm_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
+{
+  return rf_shm_recv_with_time_multi(h, &data, nsamples, blocking, secs, frac_secs);
+}
+
+int rf_shm_recv_with_time_multi(void*    h,
+                                void**   data,
+                                uint32_t nsamples,
+                                bool     blocking,
+                                time_t*  secs,
+                                double*  frac_secs)
+{
+  int ret = SRSLTE_ERROR;
+
+  if (h && data) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+
+    // Protect the access to decim_factor since is a shared variable
+    pthread_mutex_lock(&handler->decim_mutex);
+    uint32_t decim_factor = handler->decim_factor;
+    pthread_mutex_unlock(&handler->decim_mutex);
+
+    uint64_t nsamples_baserate = (uint64_t)nsamples * decim_factor;
+
+    // set timestamp for this reception
+    if (secs != NULL && frac_secs != NULL) {
+      srslte_timestamp_t ts = {};
+      srslte_timestamp_init_uint64(&ts, handler->next_rx_ts, handler->base_srate);
+      *secs      = ts.full_secs;
+      *frac_secs = ts.frac_secs;
+    }
+
+    // Fill the Tx gaps up to the end of this reception, the other end may be waiting for them
+    for (uint32_t i = 0; i < handler->nof_channels && handler->tx_align; i++) {
+      rf_shm_ring_t* q = &handler->tx_ring[i];
+      if (q->hdr) {
+        pthread_mutex_lock(&q->mutex);
+        rf_shm_ring_align(handler, q, handler->next_rx_ts + nsamples_baserate);
+        pthread_mutex_unlock(&q->mutex);
+      }
+    }
+
+    float scale = srslte_convert_dB_to_amplitude(handler->rx_gain);
+    for (uint32_t i = 0; i < handler->nof_channels; i++) {
+      cf_t* buffer = (cf_t*)data[i];
+      if (handler->rx_ring[i].hdr) {
+        if (rf_shm_ring_read(handler, &handler->rx_ring[i], buffer, nsamples, decim_factor, scale) < SRSLTE_SUCCESS) {
+          goto clean_exit;
+        }
+      } else if (buffer) {
+        memset(buffer, 0, sizeof(cf_t) * nsamples);
+      }
+    }
+
+    // update rx time
+    handler->next_rx_ts += nsamples_baserate;
+
+    ret = nsamples;
+  }
+
+clean_exit:
+  return ret;
+}
+
+int rf_shm_send_timed(void*  h,
+                      void*  data,
+                      int    nsamples,
+                      time_t secs,
+                      double frac_secs,
+                      bool   has_time_spec,
+                      bool   blocking,
+                      bool   is_start_of_burst,
+                      bool   is_end_of_burst)
+{
+  void* _data[4] = {data, NULL, NULL, NULL};
+
+  return rf_shm_send_timed_multi(
+      h, _data, nsamples, secs, frac_secs, has_time_spec, blocking, is_start_of_burst, is_end_of_burst);
+}
+
+int rf_shm_send_timed_multi(void*  h,
+                            void*  data[4],
+                            int    nsamples,
+                            time_t secs,
+                            double frac_secs,
+                            bool   has_time_spec,
+                            bool   blocking,
+                            bool   is_start_of_burst,
+                            bool   is_end_of_burst)
+{
+  int ret = SRSLTE_ERROR;
+
+  if (h && data && nsamples > 0) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+
+    // Protect the access to decim_factor since is a shared variable
+    pthread_mutex_lock(&handler->decim_mutex);
+    uint32_t decim_factor = handler->decim_factor;
+    pthread_mutex_unlock(&handler->decim_mutex);
+
+    uint64_t tx_ts = 0;
+    if (has_time_spec) {
+      srslte_timestamp_t ts = {};
+      srslte_timestamp_init(&ts, secs, frac_secs);
+      tx_ts = srslte_timestamp_uint64(&ts, handler->base_srate);
+    }
+
+    for (uint32_t i = 0; i < handler->nof_channels; i++) {
+      rf_shm_ring_t* q = &handler->tx_ring[i];
+      if (!q->hdr) {
+        continue;
+      }
+
+      // Alignment and samples go in one go, an Rx alignment in between would shift them
+      pthread_mutex_lock(&q->mutex);
+      if (has_time_spec) {
+        int64_t gap = rf_shm_ring_align(handler, q, tx_ts);
+        if (gap < 0) {
+          fprintf(stderr,
+                  "[shm] Error: tx time is %.3f ms in the past (%" PRIu64 " < %" PRIu64 ")\n",
+                  -1000.0 * gap / handler->base_srate,
+                  tx_ts,
+                  q->hdr->write_ts);
+          pthread_mutex_unlock(&q->mutex);
+          goto clean_exit;
+        }
+      }
+      int n = rf_shm_ring_write(handler, q, (cf_t*)data[i], (uint64_t)nsamples, decim_factor);
+      pthread_mutex_unlock(&q->mutex);
+      if (n < SRSLTE_SUCCESS) {
+        goto clean_exit;
+      }
+    }
+
+    ret = SRSLTE_SUCCESS;
+  }
+
+clean_exit:
+  return ret;
+}
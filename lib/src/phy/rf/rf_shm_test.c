@@ -0,0 +1,210 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/phy/rf/rf.h"
+#include "srslte/srslte.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define NUM_SF (100)
+#define TX_OFFSET_MS (4)
+#define MAX_SF_LEN (23040)
+
+static cf_t ue_rx_buffer[MAX_SF_LEN * NUM_SF];
+static cf_t enb_tx_buffer[MAX_SF_LEN * NUM_SF];
+static cf_t enb_rx_buffer[MAX_SF_LEN];
+
+static srslte_rf_t ue_radio, enb_radio;
+static uint32_t    sf_len;
+static double      ue_srate;
+static char        ue_args[RF_PARAM_LEN];
+static uint32_t    ue_reconnect_sf; // The UE closes and opens its radio again before this subframe, 0 for never
+static uint64_t    ue_rx_ts[NUM_SF];
+static uint32_t    ue_nof_rx;
+
+static void* ue_thread_function(void* args)
+{
+  // Receive every subframe the eNB transmits, which also keeps the UL ring aligned for the eNB
+  uint64_t rx_end = 0;
+  for (uint32_t i = 0; i < NUM_SF && rx_end < (uint64_t)NUM_SF * sf_len; i++) {
+    if (ue_reconnect_sf && i == ue_reconnect_sf) {
+      // The eNB keeps running, the UE resumes at its timestamp. The arguments are consumed when parsed
+      char args[RF_PARAM_LEN];
+      strncpy(args, ue_args, RF_PARAM_LEN);
+      srslte_rf_close(&ue_radio);
+      if (srslte_rf_open_devname(&ue_radio, "shm", args, 1)) {
+        fprintf(stderr, "Error opening rf again\n");
+        exit(-1);
+      }
+      srslte_rf_set_rx_srate(&ue_radio, ue_srate);
+      srslte_rf_set_tx_srate(&ue_radio, ue_srate);
+    }
+
+    srslte_timestamp_t rx_time                        = {};
+    void*              data_ptr[SRSLTE_MAX_CHANNELS] = {NULL};
+    data_ptr[0]                                      = &ue_rx_buffer[i * sf_len];
+    if (srslte_rf_recv_with_time_multi(&ue_radio, data_ptr, sf_len, true, &rx_time.full_secs, &rx_time.frac_secs) !=
+        sf_len) {
+      fprintf(stderr, "Error receiving subframe %d\n", i);
+      exit(-1);
+    }
+    ue_rx_ts[i] = srslte_timestamp_uint64(&rx_time, ue_srate);
+    rx_end      = ue_rx_ts[i] + sf_len;
+    ue_nof_rx   = i + 1;
+  }
+
+  return NULL;
+}
+
+static int enb_function()
+{
+  for (uint32_t i = 0; i < sf_len * NUM_SF; i++) {
+    enb_tx_buffer[i] = ((float)rand() / (float)RAND_MAX) + _Complex_I * ((float)rand() / (float)RAND_MAX);
+  }
+
+  // Transmit every subframe TX_OFFSET_MS after the received one, as the eNB does
+  for (uint32_t i = 0; i < NUM_SF - TX_OFFSET_MS; i++) {
+    srslte_timestamp_t rx_time = {}, tx_time = {};
+    void*              data_ptr[SRSLTE_MAX_CHANNELS] = {NULL};
+
+    data_ptr[0] = enb_rx_buffer;
+    if (srslte_rf_recv_with_time_multi(&enb_radio, data_ptr, sf_len, true, &rx_time.full_secs, &rx_time.frac_secs) !=
+        sf_len) {
+      fprintf(stderr, "Error receiving subframe %d\n", i);
+      return SRSLTE_ERROR;
+    }
+
+    srslte_timestamp_copy(&tx_time, &rx_time);
+    srslte_timestamp_add(&tx_time, 0, TX_OFFSET_MS * 1e-3);
+    data_ptr[0] = &enb_tx_buffer[i * sf_len];
+    if (srslte_rf_send_timed_multi(
+            &enb_radio, data_ptr, sf_len, tx_time.full_secs, tx_time.frac_secs, true, true, false)) {
+      fprintf(stderr, "Error sending subframe %d\n", i);
+      return SRSLTE_ERROR;
+    }
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+static int run_test(double srate, const char* base_srate, uint32_t reconnect_sf)
+{
+  int       ret = SRSLTE_ERROR;
+  pthread_t ue_thread;
+  char      enb_args[RF_PARAM_LEN];
+
+  char ue_open_args[RF_PARAM_LEN];
+  snprintf(ue_args, RF_PARAM_LEN, "tx_name=shm_test_ul%d,rx_name=shm_test_dl%d,%s", getpid(), getpid(), base_srate);
+  strncpy(ue_open_args, ue_args, RF_PARAM_LEN);
+  snprintf(enb_args, RF_PARAM_LEN, "tx_name=shm_test_dl%d,rx_name=shm_test_ul%d,%s", getpid(), getpid(), base_srate);
+
+  if (srslte_rf_open_devname(&ue_radio, "shm", ue_open_args, 1) ||
+      srslte_rf_open_devname(&enb_radio, "shm", enb_args, 1)) {
+    fprintf(stderr, "Error opening rf\n");
+    return SRSLTE_ERROR;
+  }
+  srslte_rf_set_rx_srate(&ue_radio, srate);
+  srslte_rf_set_tx_srate(&ue_radio, srate);
+  srslte_rf_set_rx_srate(&enb_radio, srate);
+  srslte_rf_set_tx_srate(&enb_radio, srate);
+  sf_len          = (uint32_t)(srate / 1000);
+  ue_srate        = srate;
+  ue_reconnect_sf = reconnect_sf;
+  ue_nof_rx       = 0;
+
+  if (pthread_create(&ue_thread, NULL, ue_thread_function, NULL)) {
+    perror("pthread_create");
+    exit(-1);
+  }
+
+  int enb_ret = enb_function();
+
+  pthread_join(ue_thread, NULL);
+
+  srslte_rf_close(&enb_radio);
+  srslte_rf_close(&ue_radio);
+
+  if (enb_ret) {
+    return SRSLTE_ERROR;
+  }
+
+  // The first subframes are the zeros padded by the eNB reception, then the eNB transmission starts
+  for (uint32_t i = 0; i < ue_nof_rx; i++) {
+    for (uint32_t j = 0; j < sf_len; j++) {
+      uint64_t ts       = ue_rx_ts[i] + j;
+      cf_t     expected = (ts < TX_OFFSET_MS * sf_len) ? 0.0f : enb_tx_buffer[ts - TX_OFFSET_MS * sf_len];
+      if (cabsf(ue_rx_buffer[i * sf_len + j] - expected) > 1e-5) {
+        fprintf(stderr, "data mismatch in subframe %d, sample %d\n", i, j);
+        goto exit;
+      }
+    }
+  }
+  if (ue_nof_rx <= reconnect_sf) {
+    fprintf(stderr, "No subframe received after reconnecting\n");
+    goto exit;
+  }
+
+  printf("Received %d subframes at %.2f MHz (%s)\n", ue_nof_rx, srate / 1e6, base_srate);
+
+  ret = SRSLTE_SUCCESS;
+
+exit:
+  return ret;
+}
+
+int main()
+{
+  // Missing arguments must fail
+  char no_args[RF_PARAM_LEN] = {};
+  if (srslte_rf_open_devname(&enb_radio, "shm", no_args, 1) == SRSLTE_SUCCESS) {
+    fprintf(stderr, "Opening without arguments should fail\n");
+    return SRSLTE_ERROR;
+  }
+
+  // Transport at the radio rate
+  if (run_test(1.92e6, "base_srate=1.92e6", 0)) {
+    fprintf(stderr, "Test at base rate failed!\n");
+    return SRSLTE_ERROR;
+  }
+
+  // Transport at 23.04 MHz with decimation, small ring so that it wraps around
+  if (run_test(1.92e6, "base_srate=23.04e6,ring_ms=8", 0)) {
+    fprintf(stderr, "Test with decimation failed!\n");
+    return SRSLTE_ERROR;
+  }
+
+  // 20 MHz cell
+  if (run_test(23.04e6, "base_srate=23.04e6", 0)) {
+    fprintf(stderr, "Test at 23.04 MHz failed!\n");
+    return SRSLTE_ERROR;
+  }
+
+  // The UE restarts while the eNB is running, and resumes at the timestamp of the eNB
+  if (run_test(1.92e6, "base_srate=1.92e6", NUM_SF / 4)) {
+    fprintf(stderr, "Test with reconnection failed!\n");
+    return SRSLTE_ERROR;
+  }
+
+  printf("Ok\n");
+  return SRSLTE_SUCCESS;
+}
@@ -59,6 +59,13 @@ typedef struct {
   size_t           num_rx_channels;
   size_t           num_tx_channels;
 
+  // Samples exchanged with the driver as CS16 and converted here, see rf_soapy_open_multi()
+  bool     use_cs16;
+  double   cs16_scale;
+  int16_t* rx_cs16[SRSLTE_MAX_PORTS];
+  int16_t* tx_cs16[SRSLTE_MAX_PORTS];
+  size_t   tx_cs16_len;
+
   srslte_rf_error_handler_t soapy_error_handler;
   void*                     soapy_error_handler_arg;
 
@@ -348,6 +355,30 @@ int rf_soapy_open_multi(char* args, void** h, uint32_t num_requested_channels)
   handler->rx_stream_active = false;
   handler->devname          = devname;
 
+  // Exchange the samples with the driver in CS16 when it is the native format of the device (or when format=cs16 is
+  // given), it saves the driver conversion and halves the copies. They are converted with the vector library into
+  // the caller buffers instead. format=cf32 keeps the driver conversion.
+  char format_str[64] = "auto";
+  if (args) {
+    const char format_arg[] = "format=";
+    char*      format_ptr   = strstr(args, format_arg);
+    if (format_ptr) {
+      copy_subdev_string(format_str, format_ptr + strlen(format_arg));
+      remove_substring(args, format_arg);
+      remove_substring(args, format_str);
+    }
+  }
+  double full_scale = 0.0;
+  char*  native     = SoapySDRDevice_getNativeStreamFormat(handler->device, SOAPY_SDR_RX, 0, &full_scale);
+  if (!strcmp(format_str, "cs16") ||
+      (!strcmp(format_str, "auto") && native != NULL && !strcmp(native, SOAPY_SDR_CS16))) {
+    handler->use_cs16   = true;
+    handler->cs16_scale = full_scale > 0.0 ? full_scale : INT16_MAX;
+  }
+  free(native);
+  const char* stream_format = handler->use_cs16 ? SOAPY_SDR_CS16 : SOAPY_SDR_CF32;
+  printf("Using %s samples with the driver\n", stream_format);
+
   // create stream args from device args
   SoapySDRKwargs stream_args = {};
 #if SOAPY_SDR_API_VERSION >= 0x00060000
@@ -367,19 +398,29 @@ int rf_soapy_open_multi(char* args, void** h, uint32_t num_requested_channels)
     if (SoapySDRDevice_setupStream(handler->device,
                                    &handler->rxStream,
                                    SOAPY_SDR_RX,
-                                   SOAPY_SDR_CF32,
+                                   stream_format,
                                    rx_channels,
                                    handler->num_rx_channels,
                                    &stream_args) != 0) {
 #else
     handler->rxStream = SoapySDRDevice_setupStream(
-        handler->device, SOAPY_SDR_RX, SOAPY_SDR_CF32, rx_channels, handler->num_rx_channels, &stream_args);
+        handler->device, SOAPY_SDR_RX, stream_format, rx_channels, handler->num_rx_channels, &stream_args);
     if (handler->rxStream == NULL) {
 #endif
       printf("Rx setupStream fail: %s\n", SoapySDRDevice_lastError());
       return SRSLTE_ERROR;
     }
     handler->rx_mtu = SoapySDRDevice_getStreamMTU(handler->device, handler->rxStream);
+
+    if (handler->use_cs16) {
+      for (int i = 0; i < handler->num_rx_channels; i++) {
+        handler->rx_cs16[i] = srslte_vec_i16_malloc(2 * handler->rx_mtu);
+        if (!handler->rx_cs16[i]) {
+          perror("malloc");
+          return SRSLTE_ERROR;
+        }
+      }
+    }
   }
 
   // Setup Tx streamer
@@ -395,19 +436,31 @@ int rf_soapy_open_multi(char* args, void** h, uint32_t num_requested_channels)
     if (SoapySDRDevice_setupStream(handler->device,
                                    &handler->txStream,
                                    SOAPY_SDR_TX,
-                                   SOAPY_SDR_CF32,
+                                   stream_format,
                                    tx_channels,
                                    handler->num_tx_channels,
                                    &stream_args) != 0) {
 #else
     handler->txStream = SoapySDRDevice_setupStream(
-        handler->device, SOAPY_SDR_TX, SOAPY_SDR_CF32, tx_channels, handler->num_tx_channels, &stream_args);
+        handler->device, SOAPY_SDR_TX, stream_format, tx_channels, handler->num_tx_channels, &stream_args);
     if (handler->txStream == NULL) {
 #endif
       printf("Tx setupStream fail: %s\n", SoapySDRDevice_lastError());
       return SRSLTE_ERROR;
     }
     handler->tx_mtu = SoapySDRDevice_getStreamMTU(handler->device, handler->txStream);
+
+    if (handler->use_cs16) {
+      // Transmissions longer than this are split
+      handler->tx_cs16_len = SRSLTE_MAX(handler->tx_mtu, SRSLTE_SF_LEN_MAX);
+      for (int i = 0; i < handler->num_tx_channels; i++) {
+        handler->tx_cs16[i] = srslte_vec_i16_malloc(2 * handler->tx_cs16_len);
+        if (!handler->tx_cs16[i]) {
+          perror("malloc");
+          return SRSLTE_ERROR;
+        }
+      }
+    }
   }
 
   // init rx/tx rate to lowest LTE rate to avoid decimation warnings
@@ -586,6 +639,15 @@ int rf_soapy_close(void* h)
   if (handler->num_other_errors)
     printf("#other_errors=%d\n", handler->num_other_errors);
 
+  for (int i = 0; i < SRSLTE_MAX_PORTS; i++) {
+    if (handler->rx_cs16[i]) {
+      free(handler->rx_cs16[i]);
+    }
+    if (handler->tx_cs16[i]) {
+      free(handler->tx_cs16[i]);
+    }
+  }
+
   free(handler);
 
   return SRSLTE_SUCCESS;
@@ -814,7 +876,7 @@ int rf_soapy_recv_with_time_multi(void*    h,
     void* buffs_ptr[SRSLTE_MAX_PORTS] = {};
     for (int i = 0; i < handler->num_rx_channels; i++) {
       cf_t* data_c = (cf_t*)data[i];
-      buffs_ptr[i] = &data_c[n];
+      buffs_ptr[i] = handler->use_cs16 ? (void*)handler->rx_cs16[i] : (void*)&data_c[n];
     }
 
     ret = SoapySDRDevice_readStream(
@@ -829,6 +891,11 @@ int rf_soapy_recv_with_time_multi(void*    h,
       // unspecific error
       printf("SoapySDRDevice_readStream returned %d: %s\n", ret, SoapySDR_errToStr(ret));
       handler->num_other_errors++;
+    } else if (handler->use_cs16) {
+      for (int i = 0; i < handler->num_rx_channels; i++) {
+        cf_t* data_c = (cf_t*)data[i];
+        srslte_vec_convert_if(handler->rx_cs16[i], handler->cs16_scale, (float*)&data_c[n], 2 * ret);
+      }
     }
 
     // update rx time only for first segment
@@ -911,14 +978,17 @@ int rf_soapy_send_timed_multi(void*  h,
       tx_samples = nsamples - n;
     }
 #endif
+    if (handler->use_cs16) {
+      tx_samples = SRSLTE_MIN(tx_samples, handler->tx_cs16_len);
+    }
 
-    // (re-)set stream flags
+    // (re-)set stream flags, the end of burst only goes with the last samples
     flags = 0;
-    if (is_start_of_burst && is_end_of_burst) {
+    if (is_start_of_burst && is_end_of_burst && tx_samples == nsamples) {
       flags |= SOAPY_SDR_ONE_PACKET;
     }
 
-    if (is_end_of_burst) {
+    if (is_end_of_burst && n + tx_samples == nsamples) {
       flags |= SOAPY_SDR_END_BURST;
     }
 
@@ -934,7 +1004,12 @@ int rf_soapy_send_timed_multi(void*  h,
     const void* buffs_ptr[SRSLTE_MAX_PORTS] = {};
     for (int i = 0; i < handler->num_tx_channels; i++) {
       cf_t* data_c = data[i] ? data[i] : zero_mem;
-      buffs_ptr[i] = &data_c[n];
+      if (handler->use_cs16) {
+        srslte_vec_convert_fi((float*)&data_c[n], handler->cs16_scale, handler->tx_cs16[i], 2 * tx_samples);
+        buffs_ptr[i] = handler->tx_cs16[i];
+      } else {
+        buffs_ptr[i] = &data_c[n];
+      }
     }
 
     ret = SoapySDRDevice_writeStream(
@@ -31,6 +31,7 @@ private:
   const uhd::fs_path              TREE_DBOARD_RX_FRONTEND_NAME = "/mboards/0/dboards/A/rx_frontends/A/name";
   const std::chrono::milliseconds FE_RX_RESET_SLEEP_TIME_MS    = std::chrono::milliseconds(2000UL);
   uhd::stream_args_t              stream_args;
+  bool                            rx_sc16       = false;
   double                          lo_freq_tx_hz = 0.0;
   double                          lo_freq_rx_hz = 0.0;
 
@@ -137,6 +138,11 @@ public:
       otw_format = dev_addr.pop("otw_format");
     }
 
+    // Set receive host format, sc16 delivers the samples as int16 IQ without conversion
+    if (dev_addr.has_key("rx_cpu_format")) {
+      rx_sc16 = (dev_addr.pop("rx_cpu_format") == "sc16");
+    }
+
     // Samples-Per-Packet option, 0 means automatic
     std::string spp;
     if (dev_addr.has_key("spp")) {
@@ -278,6 +284,7 @@ public:
   {
     UHD_SAFE_C_SAVE_ERROR(this, usrp->set_master_clock_rate(rate);)
   }
+  bool      is_rx_sc16() override { return rx_sc16; }
   uhd_error set_rx_rate(double rate) override { UHD_SAFE_C_SAVE_ERROR(this, usrp->set_rx_rate(rate);) }
   uhd_error set_tx_rate(double rate) override { UHD_SAFE_C_SAVE_ERROR(this, usrp->set_tx_rate(rate);) }
   uhd_error set_command_time(const uhd::time_spec_t& timespec) override
@@ -286,7 +293,9 @@ public:
   }
   uhd_error get_rx_stream(size_t& max_num_samps) override
   {
-    UHD_SAFE_C_SAVE_ERROR(this, rx_stream = nullptr; rx_stream = usrp->get_rx_stream(stream_args);
+    UHD_SAFE_C_SAVE_ERROR(this, uhd::stream_args_t rx_stream_args = stream_args;
+                          rx_stream_args.cpu_format = rx_sc16 ? "sc16" : "fc32";
+                          rx_stream = nullptr; rx_stream = usrp->get_rx_stream(rx_stream_args);
                           max_num_samps = rx_stream->get_max_num_samps();
                           if (max_num_samps == 0UL) {
                             last_error = "The maximum number of receive samples is zero.";
@@ -19,10 +19,13 @@
  *
  */
 
+#include <array>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 #include <uhd.h>
 #include <uhd/types/sensors.h>
 #include <uhd/usrp/multi_usrp.hpp>
@@ -135,9 +138,20 @@ struct rf_uhd_handler_t {
 
   bool rx_stream_enabled = false;
 
+  // Conversion buffers for receiving in a host format different than the stream's
+  std::array<std::vector<cf_t>, SRSLTE_MAX_CHANNELS> rx_convert_buffers;
+
   std::mutex tx_mutex;
   std::mutex rx_mutex;
 
+  // Telemetry, written by the Rx and the asynchronous message threads
+  std::mutex          metrics_mutex;
+  srslte_rf_metrics_t metrics       = {};
+  uhd::time_spec_t    rx_next_time  = {};       ///< Expected timestamp of the next reception
+  bool                rx_next_valid = false;    ///< Set while the Rx stream runs uninterrupted
+  double              rx_delay_min  = INFINITY; ///< Smallest host to device clock offset in the current period
+  double              rx_delay_ref  = INFINITY; ///< Smallest host to device clock offset in the previous period
+
 #if HAVE_ASYNC_THREAD
   // Asynchronous transmission message thread
   bool                    async_thread_running = false;
@@ -183,6 +197,11 @@ static void log_overflow(rf_uhd_handler_t* h)
     h->tx_state = RF_UHD_IMP_TX_STATE_END_OF_BURST;
   }
 
+  {
+    std::unique_lock<std::mutex> lock(h->metrics_mutex);
+    h->metrics.overflow++;
+  }
+
   if (h->uhd_error_handler != nullptr) {
     srslte_rf_error_t error;
     bzero(&error, sizeof(srslte_rf_error_t));
@@ -191,12 +210,21 @@ static void log_overflow(rf_uhd_handler_t* h)
   }
 }
 
-static void log_late(rf_uhd_handler_t* h, bool is_rx)
+static void log_late(rf_uhd_handler_t* h, bool is_rx, size_t channel)
 {
   if (h->tx_state == RF_UHD_IMP_TX_STATE_BURST) {
     h->tx_state = RF_UHD_IMP_TX_STATE_END_OF_BURST;
   }
 
+  {
+    std::unique_lock<std::mutex> lock(h->metrics_mutex);
+    if (is_rx) {
+      h->metrics.rx_late++;
+    } else if (channel < SRSLTE_RF_METRICS_MAX_CHANNELS) {
+      h->metrics.late[channel]++;
+    }
+  }
+
   if (h->uhd_error_handler != nullptr) {
     srslte_rf_error_t error;
     bzero(&error, sizeof(srslte_rf_error_t));
@@ -207,12 +235,17 @@ static void log_late(rf_uhd_handler_t* h, bool is_rx)
 }
 
 #if HAVE_ASYNC_THREAD
-static void log_underflow(rf_uhd_handler_t* h)
+static void log_underflow(rf_uhd_handler_t* h, size_t channel)
 {
   // Flag underflow
   if (h->tx_state == RF_UHD_IMP_TX_STATE_BURST) {
     h->tx_state = RF_UHD_IMP_TX_STATE_END_OF_BURST;
   }
+
+  if (channel < SRSLTE_RF_METRICS_MAX_CHANNELS) {
+    std::unique_lock<std::mutex> lock(h->metrics_mutex);
+    h->metrics.underflow[channel]++;
+  }
   if (h->uhd_error_handler != nullptr) {
     srslte_rf_error_t error;
     bzero(&error, sizeof(srslte_rf_error_t));
@@ -222,6 +255,60 @@ static void log_underflow(rf_uhd_handler_t* h)
 }
 #endif
 
+// Adds a duration to a telemetry histogram, see srslte_rf_metrics_t for the bins
+static void metrics_hist_add(uint32_t* hist, double secs)
+{
+  double   us  = secs * 1e6;
+  uint32_t bin = 0;
+  while (bin < SRSLTE_RF_METRICS_NOF_BINS - 1 and us >= (double)(1U << bin)) {
+    bin++;
+  }
+  hist[bin]++;
+}
+
+// Forgets the previous receptions, the next one starts a new continuous stream
+static void metrics_rx_restart(rf_uhd_handler_t* h)
+{
+  std::unique_lock<std::mutex> lock(h->metrics_mutex);
+  h->rx_next_valid = false;
+  h->rx_delay_min  = INFINITY;
+  h->rx_delay_ref  = INFINITY;
+}
+
+static void metrics_rx(rf_uhd_handler_t*                     h,
+                       const uhd::time_spec_t&               timespec,
+                       size_t                                nsamples,
+                       std::chrono::steady_clock::time_point t_start)
+{
+  std::chrono::steady_clock::time_point t_end    = std::chrono::steady_clock::now();
+  uhd::time_spec_t                      ts_end   = timespec + uhd::time_spec_t((double)nsamples / h->rx_rate);
+  double                                latency  = std::chrono::duration<double>(t_end - t_start).count();
+  double                                host_now = std::chrono::duration<double>(t_end.time_since_epoch()).count();
+
+  std::unique_lock<std::mutex> lock(h->metrics_mutex);
+  h->metrics.nof_recv++;
+  metrics_hist_add(h->metrics.recv_latency_hist, latency);
+
+  // The host and device clocks have an unknown offset, the smallest difference seen recently approximates it. Keeping
+  // the previous period minimum bounds the error due to the drift between both clocks.
+  double offset   = host_now - ts_end.get_real_secs();
+  h->rx_delay_min = SRSLTE_MIN(h->rx_delay_min, offset);
+  metrics_hist_add(h->metrics.rx_delay_hist, offset - SRSLTE_MIN(h->rx_delay_min, h->rx_delay_ref));
+
+  // Detect discontinuities in the received timestamps
+  if (h->rx_next_valid) {
+    int64_t jump = (int64_t)round((timespec - h->rx_next_time).get_real_secs() * h->rx_rate);
+    if (jump != 0) {
+      h->metrics.nof_ts_jumps++;
+      if (llabs(jump) > llabs(h->metrics.max_ts_jump)) {
+        h->metrics.max_ts_jump = jump;
+      }
+    }
+  }
+  h->rx_next_time  = ts_end;
+  h->rx_next_valid = true;
+}
+
 static void log_rx_error(rf_uhd_handler_t* h)
 {
   if (h->uhd_error_handler) {
@@ -239,6 +326,7 @@ static void* async_thread(void* h)
 {
   rf_uhd_handler_t*     handler = (rf_uhd_handler_t*)h;
   uhd::async_metadata_t md;
+  pthread_setname_np(pthread_self(), "RF_UHD_ASYNC");
 
   while (handler->async_thread_running) {
     std::unique_lock<std::mutex> lock(handler->async_mutex);
@@ -260,9 +348,9 @@ static void* async_thread(void* h)
         const uhd::async_metadata_t::event_code_t& event_code = md.event_code;
         if (event_code == uhd::async_metadata_t::EVENT_CODE_UNDERFLOW ||
             event_code == uhd::async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET) {
-          log_underflow(handler);
+          log_underflow(handler, md.channel);
         } else if (event_code == uhd::async_metadata_t::EVENT_CODE_TIME_ERROR) {
-          log_late(handler, false);
+          log_late(handler, false, md.channel);
         } else if (event_code == uhd::async_metadata_t::EVENT_CODE_BURST_ACK) {
           // Makes sure next block will be start of burst
           if (handler->tx_state == RF_UHD_IMP_TX_STATE_BURST) {
@@ -487,6 +575,7 @@ static inline int rf_uhd_start_rx_stream_unsafe(rf_uhd_handler_t* handler)
   }
 
   handler->rx_stream_enabled = true;
+  metrics_rx_restart(handler);
 
   return SRSLTE_SUCCESS;
 }
@@ -939,6 +1028,7 @@ double rf_uhd_set_rx_srate(void* h, double freq)
 
   // Update current rate
   handler->rx_rate = freq;
+  metrics_rx_restart(handler);
 
   return freq;
 }
@@ -1151,26 +1241,38 @@ void rf_uhd_sync_pps(void* h)
   }
 }
 
+int rf_uhd_get_metrics(void* h, srslte_rf_metrics_t* metrics)
+{
+  rf_uhd_handler_t*            handler = (rf_uhd_handler_t*)h;
+  std::unique_lock<std::mutex> lock(handler->metrics_mutex);
+
+  *metrics              = handler->metrics;
+  handler->metrics      = {};
+  handler->rx_delay_ref = handler->rx_delay_min;
+  handler->rx_delay_min = INFINITY;
+
+  return SRSLTE_SUCCESS;
+}
+
 int rf_uhd_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
 {
   return rf_uhd_recv_with_time_multi(h, &data, nsamples, blocking, secs, frac_secs);
 }
 
-int rf_uhd_recv_with_time_multi(void*    h,
-                                void*    data[SRSLTE_MAX_PORTS],
-                                uint32_t nsamples,
-                                bool     blocking,
-                                time_t*  secs,
-                                double*  frac_secs)
+// Receives nsamples of sample_sz bytes in the stream host format, the caller must hold the Rx mutex
+static int rf_uhd_recv_unsafe(rf_uhd_handler_t* handler,
+                              void**            data,
+                              size_t            sample_sz,
+                              uint32_t          nsamples,
+                              time_t*           secs,
+                              double*           frac_secs)
 {
-  rf_uhd_handler_t*            handler = (rf_uhd_handler_t*)h;
-  std::unique_lock<std::mutex> lock(handler->rx_mutex);
-  size_t                       rxd_samples       = 0;
-  size_t                       rxd_samples_total = 0;
-  uint32_t                     trials            = 0;
-  int                          ret               = SRSLTE_ERROR;
-  uhd::time_spec_t             timespec;
-  uhd::rx_metadata_t           md;
+  size_t             rxd_samples       = 0;
+  size_t             rxd_samples_total = 0;
+  uint32_t           trials            = 0;
+  int                ret               = SRSLTE_ERROR;
+  uhd::time_spec_t   timespec;
+  uhd::rx_metadata_t md;
 
   // Check Rx stream has been created
   if (not handler->uhd->is_rx_ready()) {
@@ -1186,11 +1288,12 @@ int rf_uhd_recv_with_time_multi(void*    h,
   }
 
   // Receive stream in multiple blocks
+  std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
   while (rxd_samples_total < nsamples && trials < RF_UHD_IMP_MAX_RX_TRIALS) {
     void* buffs_ptr[SRSLTE_MAX_CHANNELS] = {};
     for (uint32_t i = 0; i < handler->nof_rx_channels; i++) {
-      cf_t* data_c = (cf_t*)data[i];
-      buffs_ptr[i] = &data_c[rxd_samples_total];
+      uint8_t* data_b = (uint8_t*)data[i];
+      buffs_ptr[i]    = &data_b[rxd_samples_total * sample_sz];
     }
 
     size_t num_samps_left = nsamples - rxd_samples_total;
@@ -1214,7 +1317,7 @@ int rf_uhd_recv_with_time_multi(void*    h,
     if (error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW) {
       log_overflow(handler);
     } else if (error_code == uhd::rx_metadata_t::ERROR_CODE_LATE_COMMAND) {
-      log_late(handler, true);
+      log_late(handler, true, 0);
     } else if (error_code == uhd::rx_metadata_t::ERROR_CODE_TIMEOUT) {
       ERROR("Error timed out while receiving samples from UHD.\n");
 
@@ -1236,6 +1339,8 @@ int rf_uhd_recv_with_time_multi(void*    h,
 
   ret = rxd_samples_total;
 
+  metrics_rx(handler, timespec, rxd_samples_total, t_start);
+
   // Set timestamp if provided
   if (secs != nullptr and frac_secs != nullptr) {
     *secs      = timespec.get_full_secs();
@@ -1245,6 +1350,73 @@ int rf_uhd_recv_with_time_multi(void*    h,
   return ret;
 }
 
+// Points the conversion buffers, sized for nsamples, to be received in the stream host format
+static void rf_uhd_recv_convert_buffers(rf_uhd_handler_t* handler, uint32_t nsamples, void** buffs)
+{
+  for (uint32_t i = 0; i < handler->nof_rx_channels; i++) {
+    if (handler->rx_convert_buffers[i].size() < nsamples) {
+      handler->rx_convert_buffers[i].resize(nsamples);
+    }
+    buffs[i] = handler->rx_convert_buffers[i].data();
+  }
+}
+
+int rf_uhd_recv_with_time_multi(void*    h,
+                                void*    data[SRSLTE_MAX_PORTS],
+                                uint32_t nsamples,
+                                bool     blocking,
+                                time_t*  secs,
+                                double*  frac_secs)
+{
+  rf_uhd_handler_t*            handler = (rf_uhd_handler_t*)h;
+  std::unique_lock<std::mutex> lock(handler->rx_mutex);
+
+  if (not handler->uhd->is_rx_sc16()) {
+    return rf_uhd_recv_unsafe(handler, data, sizeof(cf_t), nsamples, secs, frac_secs);
+  }
+
+  // The stream delivers int16 IQ, convert to complex float
+  void* buffs[SRSLTE_MAX_CHANNELS] = {};
+  rf_uhd_recv_convert_buffers(handler, nsamples, buffs);
+
+  int ret = rf_uhd_recv_unsafe(handler, buffs, 2 * sizeof(int16_t), nsamples, secs, frac_secs);
+  for (uint32_t i = 0; i < handler->nof_rx_channels && ret > 0; i++) {
+    if (data[i] != nullptr) {
+      srslte_vec_convert_if((int16_t*)buffs[i], INT16_MAX, (float*)data[i], 2 * ret);
+    }
+  }
+
+  return ret;
+}
+
+int rf_uhd_recv_with_time_multi_s(void*    h,
+                                  int16_t* data[SRSLTE_MAX_PORTS],
+                                  uint32_t nsamples,
+                                  bool     blocking,
+                                  time_t*  secs,
+                                  double*  frac_secs)
+{
+  rf_uhd_handler_t*            handler = (rf_uhd_handler_t*)h;
+  std::unique_lock<std::mutex> lock(handler->rx_mutex);
+
+  if (handler->uhd->is_rx_sc16()) {
+    return rf_uhd_recv_unsafe(handler, (void**)data, 2 * sizeof(int16_t), nsamples, secs, frac_secs);
+  }
+
+  // The stream delivers complex float, convert to int16 IQ
+  void* buffs[SRSLTE_MAX_CHANNELS] = {};
+  rf_uhd_recv_convert_buffers(handler, nsamples, buffs);
+
+  int ret = rf_uhd_recv_unsafe(handler, buffs, sizeof(cf_t), nsamples, secs, frac_secs);
+  for (uint32_t i = 0; i < handler->nof_rx_channels && ret > 0; i++) {
+    if (data[i] != nullptr) {
+      srslte_vec_convert_fi((float*)buffs[i], INT16_MAX, data[i], 2 * ret);
+    }
+  }
+
+  return ret;
+}
+
 int rf_uhd_send_timed(void*  h,
                       void*  data,
                       int    nsamples,
@@ -80,6 +80,13 @@ rf_uhd_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, tim
 SRSLTE_API int
 rf_uhd_recv_with_time_multi(void* h, void** data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs);
 
+SRSLTE_API int rf_uhd_recv_with_time_multi_s(void*     h,
+                                             int16_t** data,
+                                             uint32_t  nsamples,
+                                             bool      blocking,
+                                             time_t*   secs,
+                                             double*   frac_secs);
+
 SRSLTE_API double rf_uhd_set_tx_srate(void* h, double freq);
 
 SRSLTE_API int rf_uhd_set_tx_gain(void* h, double gain);
@@ -92,6 +99,8 @@ SRSLTE_API void rf_uhd_get_time(void* h, time_t* secs, double* frac_secs);
 
 SRSLTE_API void rf_uhd_sync_pps(void* h);
 
+SRSLTE_API int rf_uhd_get_metrics(void* h, srslte_rf_metrics_t* metrics);
+
 SRSLTE_API int rf_uhd_send_timed(void*  h,
                                  void*  data,
                                  int    nsamples,
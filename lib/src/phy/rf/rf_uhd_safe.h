@@ -189,6 +189,7 @@ public:
                           nof_txd_samples = tx_stream->send(buffs_cpp, nsamps_per_buff, metadata, timeout);)
   }
   virtual bool is_rx_ready() { return rx_stream != nullptr; }
+  virtual bool is_rx_sc16() { return false; }
   virtual bool is_tx_ready() { return tx_stream != nullptr; }
 };
 
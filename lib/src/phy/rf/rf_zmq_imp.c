@@ -45,6 +45,7 @@ typedef struct {
   uint32_t tx_freq_mhz[SRSLTE_MAX_CHANNELS];
   uint32_t rx_freq_mhz[SRSLTE_MAX_CHANNELS];
   bool     tx_off;
+  bool     tx_align; // pad Tx with zeros up to the end of every reception
   char     id[RF_PARAM_LEN];
 
   // Server
@@ -197,7 +198,8 @@ int rf_zmq_open_multi(char* args, void** h, uint32_t nof_channels)
   if (h && nof_channels < SRSLTE_MAX_CHANNELS) {
     *h = NULL;
 
-    rf_zmq_handler_t* handler = (rf_zmq_handler_t*)malloc(sizeof(rf_zmq_handler_t));
+    // Aligned, the receivers hold cache line aligned ring buffers
+    rf_zmq_handler_t* handler = (rf_zmq_handler_t*)srslte_vec_malloc(sizeof(rf_zmq_handler_t));
     if (!handler) {
       perror("malloc");
       return SRSLTE_ERROR;
@@ -211,6 +213,7 @@ int rf_zmq_open_multi(char* args, void** h, uint32_t nof_channels)
     handler->info.max_tx_gain = ZMQ_MAX_GAIN_DB;
     handler->info.min_tx_gain = ZMQ_MIN_GAIN_DB;
     handler->nof_channels     = nof_channels;
+    handler->tx_align         = true;
     strcpy(handler->id, "zmq\0");
 
     rf_zmq_opts_t rx_opts = {};
@@ -238,8 +241,13 @@ int rf_zmq_open_multi(char* args, void** h, uint32_t nof_channels)
       // id
       parse_string(args, "id", -1, handler->id);
 
-      // rx_type
+      // tx_align
       char tmp[RF_PARAM_LEN] = {0};
+      if (parse_string(args, "tx_align", -1, tmp) == SRSLTE_SUCCESS) {
+        handler->tx_align = !(strcmp(tmp, "false") == 0 || strcmp(tmp, "no") == 0);
+      }
+
+      // rx_type
       if (parse_string(args, "rx_type", -1, tmp) == SRSLTE_SUCCESS) {
         if (!strcmp(tmp, "sub")) {
           rx_opts.socket_type = ZMQ_SUB;
@@ -670,7 +678,7 @@ int rf_zmq_recv_with_time_multi(void*    h,
     usleep((1000000 * nsamples) / handler->base_srate);
 
     // check for tx gap if we're also transmitting on this radio
-    for (int i = 0; i < handler->nof_channels; i++) {
+    for (int i = 0; i < handler->nof_channels && handler->tx_align; i++) {
       if (handler->transmitter[i].running) {
         rf_zmq_tx_align(&handler->transmitter[i], handler->next_rx_ts + nsamples_baserate);
       }
@@ -732,7 +740,7 @@ int rf_zmq_recv_with_time_multi(void*    h,
     rf_zmq_info(handler->id,
                 " - read %d samples. %d samples available\n",
                 NBYTES2NSAMPLES(nbytes),
-                NBYTES2NSAMPLES(srslte_ringbuffer_status(&handler->receiver[0].ringbuffer)));
+                NBYTES2NSAMPLES(srslte_ringbuffer_spsc_status(&handler->receiver[0].ringbuffer)));
 
     // decimate if needed
     if (decim_factor != 1) {
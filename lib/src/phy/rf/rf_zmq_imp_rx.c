@@ -29,6 +29,7 @@
 static void* rf_zmq_async_rx_thread(void* h)
 {
   rf_zmq_rx_t* q = (rf_zmq_rx_t*)h;
+  pthread_setname_np(pthread_self(), "RF_ZMQ_RX");
 
   while (q->sock && q->running) {
     int     nbytes = 0;
@@ -78,7 +79,7 @@ static void* rf_zmq_async_rx_thread(void* h)
 
       // Try to write in ring buffer
       while (n < 0 && q->running) {
-        n = srslte_ringbuffer_write_timed(&q->ringbuffer, q->temp_buffer, nbytes, ZMQ_TIMEOUT_MS);
+        n = srslte_ringbuffer_spsc_write_timed(&q->ringbuffer, q->temp_buffer, nbytes, ZMQ_TIMEOUT_MS);
       }
 
       // Check write
@@ -87,7 +88,7 @@ static void* rf_zmq_async_rx_thread(void* h)
                     "   - received %d baseband samples (%d B). %d samples available.\n",
                     NBYTES2NSAMPLES(n),
                     n,
-                    NBYTES2NSAMPLES(srslte_ringbuffer_status(&q->ringbuffer)));
+                    NBYTES2NSAMPLES(srslte_ringbuffer_spsc_status(&q->ringbuffer)));
       }
     }
   }
@@ -166,7 +167,7 @@ int rf_zmq_rx_open(rf_zmq_rx_t* q, rf_zmq_opts_t opts, void* zmq_ctx, char* sock
     }
 #endif
 
-    if (srslte_ringbuffer_init(&q->ringbuffer, ZMQ_MAX_BUFFER_SIZE)) {
+    if (srslte_ringbuffer_spsc_init(&q->ringbuffer, ZMQ_MAX_BUFFER_SIZE)) {
       fprintf(stderr, "Error: initiating ringbuffer\n");
       goto clean_exit;
     }
@@ -177,12 +178,6 @@ int rf_zmq_rx_open(rf_zmq_rx_t* q, rf_zmq_opts_t opts, void* zmq_ctx, char* sock
       goto clean_exit;
     }
 
-    q->temp_buffer_convert = srslte_vec_malloc(ZMQ_MAX_BUFFER_SIZE);
-    if (!q->temp_buffer_convert) {
-      fprintf(stderr, "Error: allocating rx buffer\n");
-      goto clean_exit;
-    }
-
     if (pthread_mutex_init(&q->mutex, NULL)) {
       fprintf(stderr, "Error: creating mutex\n");
       goto clean_exit;
@@ -203,21 +198,18 @@ clean_exit:
 
 int rf_zmq_rx_baseband(rf_zmq_rx_t* q, cf_t* buffer, uint32_t nsamples)
 {
-  void*    dst_buffer = buffer;
-  uint32_t sample_sz  = sizeof(cf_t);
-  if (q->sample_format != ZMQ_TYPE_FC32) {
-    dst_buffer = q->temp_buffer_convert;
-    sample_sz  = 2 * sizeof(short);
+  if (q->sample_format == ZMQ_TYPE_FC32) {
+    return srslte_ringbuffer_spsc_read_timed(&q->ringbuffer, buffer, sizeof(cf_t) * nsamples, ZMQ_TIMEOUT_MS);
   }
 
-  int n = srslte_ringbuffer_read_timed(&q->ringbuffer, dst_buffer, sample_sz * nsamples, ZMQ_TIMEOUT_MS);
-  if (n < 0) {
+  // Convert straight from the ring, the samples are only released once converted
+  void* src = NULL;
+  int   n   = srslte_ringbuffer_spsc_read_reserve(&q->ringbuffer, &src, 2 * sizeof(short) * nsamples, ZMQ_TIMEOUT_MS);
+  if (n <= 0) {
     return n;
   }
-
-  if (q->sample_format == ZMQ_TYPE_SC16) {
-    srslte_vec_convert_if(dst_buffer, INT16_MAX, (float*)buffer, 2 * nsamples);
-  }
+  srslte_vec_convert_if(src, INT16_MAX, (float*)buffer, 2 * nsamples);
+  srslte_ringbuffer_spsc_read_commit(&q->ringbuffer, n);
 
   return n;
 }
@@ -241,16 +233,12 @@ void rf_zmq_rx_close(rf_zmq_rx_t* q)
     pthread_detach(q->thread);
   }
 
-  srslte_ringbuffer_free(&q->ringbuffer);
+  srslte_ringbuffer_spsc_free(&q->ringbuffer);
 
   if (q->temp_buffer) {
     free(q->temp_buffer);
   }
 
-  if (q->temp_buffer_convert) {
-    free(q->temp_buffer_convert);
-  }
-
   if (q->sock) {
     zmq_close(q->sock);
     q->sock = NULL;
@@ -34,22 +34,22 @@
 
 int srslte_cfo_init(srslte_cfo_t* h, uint32_t nsamples)
 {
-#if SRSLTE_CFO_USE_EXP_TABLE
   int ret = SRSLTE_ERROR;
   bzero(h, sizeof(srslte_cfo_t));
 
+#if SRSLTE_CFO_USE_EXP_TABLE
   if (srslte_cexptab_init(&h->tab, SRSLTE_CFO_CEXPTAB_SIZE)) {
     goto clean;
   }
+#endif /* SRSLTE_CFO_USE_EXP_TABLE */
   h->cur_cexp = srslte_vec_cf_malloc(nsamples);
   if (!h->cur_cexp) {
     goto clean;
   }
   h->tol         = 0;
-  h->last_freq   = 0;
+  h->last_freq   = NAN;
   h->nsamples    = nsamples;
   h->max_samples = nsamples;
-  srslte_cexptab_gen(&h->tab, h->cur_cexp, h->last_freq, h->nsamples);
 
   ret = SRSLTE_SUCCESS;
 clean:
@@ -57,20 +57,16 @@ clean:
     srslte_cfo_free(h);
   }
   return ret;
-#else  /* SRSLTE_CFO_USE_EXP_TABLE */
-  h->nsamples = nsamples;
-  return SRSLTE_SUCCESS;
-#endif /* SRSLTE_CFO_USE_EXP_TABLE */
 }
 
 void srslte_cfo_free(srslte_cfo_t* h)
 {
 #if SRSLTE_CFO_USE_EXP_TABLE
   srslte_cexptab_free(&h->tab);
+#endif /* SRSLTE_CFO_USE_EXP_TABLE */
   if (h->cur_cexp) {
     free(h->cur_cexp);
   }
-#endif /* SRSLTE_CFO_USE_EXP_TABLE */
   bzero(h, sizeof(srslte_cfo_t));
 }
 
@@ -81,32 +77,69 @@ void srslte_cfo_set_tol(srslte_cfo_t* h, float tol)
 
 int srslte_cfo_resize(srslte_cfo_t* h, uint32_t samples)
 {
-#if SRSLTE_CFO_USE_EXP_TABLE
   if (samples <= h->max_samples) {
-    srslte_cexptab_gen(&h->tab, h->cur_cexp, h->last_freq, samples);
     h->nsamples = samples;
+    // The cached exponential only covers the previous length
+    h->last_freq = NAN;
   } else {
     ERROR("Error in cfo_resize(): nof_samples must be lower than initialized\n");
     return SRSLTE_ERROR;
   }
-#endif /* SRSLTE_CFO_USE_EXP_TABLE */
   return SRSLTE_SUCCESS;
 }
 
-void srslte_cfo_correct(srslte_cfo_t* h, const cf_t* input, cf_t* output, float freq)
+/* Regenerates the cached complex exponential for h->nsamples if freq moved more than the tolerance since it was
+ * generated */
+static void cfo_update_cexp(srslte_cfo_t* h, float freq)
 {
-#if SRSLTE_CFO_USE_EXP_TABLE
-  if (fabs(h->last_freq - freq) > h->tol) {
+  if (isnan(h->last_freq) || fabsf(h->last_freq - freq) > h->tol) {
     h->last_freq = freq;
+#if SRSLTE_CFO_USE_EXP_TABLE
     srslte_cexptab_gen(&h->tab, h->cur_cexp, h->last_freq, h->nsamples);
+#else  /* SRSLTE_CFO_USE_EXP_TABLE */
+    for (int i = 0; i < h->nsamples; i++) {
+      h->cur_cexp[i] = 1.0f;
+    }
+    srslte_vec_apply_cfo(h->cur_cexp, h->last_freq, h->cur_cexp, h->nsamples);
+#endif /* SRSLTE_CFO_USE_EXP_TABLE */
     DEBUG("CFO generating new table for frequency %.4fe-6\n", freq * 1e6);
   }
+}
+
+void srslte_cfo_correct(srslte_cfo_t* h, const cf_t* input, cf_t* output, float freq)
+{
+#if SRSLTE_CFO_USE_EXP_TABLE
+  cfo_update_cexp(h, freq);
   srslte_vec_prod_ccc(h->cur_cexp, input, output, h->nsamples);
 #else  /* SRSLTE_CFO_USE_EXP_TABLE */
+  // Rotating phasor, no table to regenerate when the frequency changes
   srslte_vec_apply_cfo(input, freq, output, h->nsamples);
 #endif /* SRSLTE_CFO_USE_EXP_TABLE */
 }
 
+void srslte_cfo_correct_multi(srslte_cfo_t* h, cf_t** input, cf_t** output, uint32_t nof_ports, float freq)
+{
+#if SRSLTE_CFO_USE_EXP_TABLE
+  for (uint32_t i = 0; i < nof_ports; i++) {
+    if (input[i]) {
+      srslte_cfo_correct(h, input[i], output[i], freq);
+    }
+  }
+#else  /* SRSLTE_CFO_USE_EXP_TABLE */
+  cf_t*    in[SRSLTE_MAX_PORTS]  = {};
+  cf_t*    out[SRSLTE_MAX_PORTS] = {};
+  uint32_t n                     = 0;
+  for (uint32_t i = 0; i < nof_ports && i < SRSLTE_MAX_PORTS; i++) {
+    if (input[i]) {
+      in[n]  = input[i];
+      out[n] = output[i];
+      n++;
+    }
+  }
+  srslte_vec_apply_cfo_multi(in, freq, out, n, h->nsamples);
+#endif /* SRSLTE_CFO_USE_EXP_TABLE */
+}
+
 /* CFO correction which allows to specify the offset within the correction
  * table to allow phase-continuity across multi-subframe transmissions (NB-IoT)
  * Note that when correction table needs to be regenerated, the regeneration
@@ -119,11 +152,7 @@ void srslte_cfo_correct_offset(srslte_cfo_t* h,
                                int           cexp_offset,
                                int           nsamples)
 {
-  if (fabs(h->last_freq - freq) > h->tol) {
-    h->last_freq = freq;
-    srslte_cexptab_gen(&h->tab, h->cur_cexp, h->last_freq, h->nsamples);
-    DEBUG("CFO generating new table for frequency %.4fe-6\n", freq * 1e6);
-  }
+  cfo_update_cexp(h, freq);
   srslte_vec_prod_ccc(&h->cur_cexp[cexp_offset], input, output, nsamples);
 }
 
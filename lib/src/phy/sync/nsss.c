@@ -35,6 +35,29 @@
 #define DO_FREQ_SHIFT 1
 #define SRSLTE_NSSS_RETURN_PSR 0
 
+static void nsss_sync_corr_pci(srslte_nsss_synch_t* q, uint32_t cell_id);
+
+// Smallest length not below min_len without prime factors other than 2, 3 and 5. The DFT of input_size plus the filter
+// length (4 * 7 * 191 samples for two subframes of 1 PRB) is several times slower.
+static uint32_t nsss_corr_len(uint32_t min_len)
+{
+  for (uint32_t len = min_len;; len++) {
+    uint32_t n = len;
+    while (n % 2 == 0) {
+      n /= 2;
+    }
+    while (n % 3 == 0) {
+      n /= 3;
+    }
+    while (n % 5 == 0) {
+      n /= 5;
+    }
+    if (n == 1) {
+      return len;
+    }
+  }
+}
+
 int srslte_nsss_synch_init(srslte_nsss_synch_t* q, uint32_t input_size, uint32_t fft_size)
 {
   if (q != NULL && fft_size <= 2048) {
@@ -45,8 +68,9 @@ int srslte_nsss_synch_init(srslte_nsss_synch_t* q, uint32_t input_size, uint32_t
 
     q->input_size          = input_size;
     q->corr_peak_threshold = 2.0;
+    q->corr_len            = nsss_corr_len(q->input_size + SRSLTE_NSSS_CORR_FILTER_LEN);
 
-    uint32_t buffer_size = SRSLTE_NSSS_CORR_FILTER_LEN + q->input_size + 1;
+    uint32_t buffer_size = q->corr_len;
     DEBUG("NSSS buffer size is %d samples.\n", buffer_size);
     q->tmp_input = srslte_vec_cf_malloc(buffer_size);
     if (!q->tmp_input) {
@@ -70,22 +94,23 @@ int srslte_nsss_synch_init(srslte_nsss_synch_t* q, uint32_t input_size, uint32_t
     srslte_vec_f_zero(q->conv_output_abs, buffer_size);
 
     for (int i = 0; i < SRSLTE_NUM_PCI; i++) {
-      q->nsss_signal_time[i] = srslte_vec_cf_malloc(buffer_size);
-      if (!q->nsss_signal_time[i]) {
+      q->nsss_signal_time[i] = srslte_vec_cf_malloc(SRSLTE_NSSS_CORR_FILTER_LEN);
+      q->nsss_signal_freq[i] = srslte_vec_cf_malloc(buffer_size);
+      if (!q->nsss_signal_time[i] || !q->nsss_signal_freq[i]) {
         fprintf(stderr, "Error allocating memory\n");
         goto clean_and_exit;
       }
-      srslte_vec_cf_zero(q->nsss_signal_time[i], buffer_size);
+      srslte_vec_cf_zero(q->nsss_signal_time[i], SRSLTE_NSSS_CORR_FILTER_LEN);
     }
 
-    // generate NSSS sequences
-    if (srslte_nsss_corr_init(q)) {
-      fprintf(stderr, "Error initiating NSSS detector for fft_size=%d\n", fft_size);
+    if (srslte_conv_fft_cc_init(&q->conv_fft, q->corr_len - SRSLTE_NSSS_CORR_FILTER_LEN, SRSLTE_NSSS_CORR_FILTER_LEN)) {
+      fprintf(stderr, "Error initiating convolution FFT\n");
       goto clean_and_exit;
     }
 
-    if (srslte_conv_fft_cc_init(&q->conv_fft, q->input_size, SRSLTE_NSSS_CORR_FILTER_LEN)) {
-      fprintf(stderr, "Error initiating convolution FFT\n");
+    // generate NSSS sequences
+    if (srslte_nsss_corr_init(q)) {
+      fprintf(stderr, "Error initiating NSSS detector for fft_size=%d\n", fft_size);
       goto clean_and_exit;
     }
 
@@ -107,6 +132,9 @@ void srslte_nsss_synch_free(srslte_nsss_synch_t* q)
       if (q->nsss_signal_time[i]) {
         free(q->nsss_signal_time[i]);
       }
+      if (q->nsss_signal_freq[i]) {
+        free(q->nsss_signal_freq[i]);
+      }
     }
     srslte_conv_fft_cc_free(&q->conv_fft);
     if (q->tmp_input) {
@@ -212,6 +240,11 @@ int srslte_nsss_corr_init(srslte_nsss_synch_t* q)
     // srslte_vec_sc_prod_cfc(npss_signal_time, 1.0/3, npss_signal_time, output_len);
 #endif
 
+    // transform the zero-padded sequence once, the exhaustive search only transforms the input
+    srslte_vec_cf_zero(q->conv_output, q->corr_len);
+    srslte_vec_cf_copy(q->conv_output, q->nsss_signal_time[i], SRSLTE_NSSS_CORR_FILTER_LEN);
+    srslte_dft_run_c(&q->conv_fft.filter_plan, q->conv_output, q->nsss_signal_freq[i]);
+
 #if DUMP_SIGNALS
 #define MAX_FNAME_LEN 40
     char fname[MAX_FNAME_LEN];
@@ -239,15 +272,16 @@ int srslte_nsss_sync_find(srslte_nsss_synch_t* q,
     float peak_value;
     ret = SRSLTE_ERROR;
 
-    // save input
+    // save input and transform it once for all the hypotheses
     memcpy(q->tmp_input, input, q->input_size * sizeof(cf_t));
+    srslte_dft_run_c(&q->conv_fft.input_plan, q->tmp_input, q->conv_fft.input_fft);
 
     if (*cell_id == SRSLTE_CELL_ID_UNKNOWN) {
       DEBUG("N_id_ncell is not set. Perform exhaustive search on input.\n");
 
       // brute-force: correlate with all possible sequences until cell is found
       for (int i = 0; i < SRSLTE_NUM_PCI; i++) {
-        srslte_nsss_sync_find_pci(q, q->tmp_input, i);
+        nsss_sync_corr_pci(q, i);
       }
 
       // find maximum of all correlation maxima
@@ -263,7 +297,7 @@ int srslte_nsss_sync_find(srslte_nsss_synch_t* q,
       DEBUG("Current N_id_ncell is %d.\n", *cell_id);
 
       // run correlation only for given id
-      srslte_nsss_sync_find_pci(q, q->tmp_input, *cell_id);
+      nsss_sync_corr_pci(q, *cell_id);
 
       if (q->peak_values[*cell_id] > q->corr_peak_threshold) {
         ret = SRSLTE_SUCCESS;
@@ -285,8 +319,16 @@ int srslte_nsss_sync_find(srslte_nsss_synch_t* q,
 // Correlates input signal with the NSSS sequence for a given n_id_ncell
 void srslte_nsss_sync_find_pci(srslte_nsss_synch_t* q, cf_t* input, uint32_t cell_id)
 {
-  // correlate input with NSSS sequences
-  uint32_t conv_output_len = srslte_corr_fft_cc_run(&q->conv_fft, input, q->nsss_signal_time[cell_id], q->conv_output);
+  srslte_dft_run_c(&q->conv_fft.input_plan, input, q->conv_fft.input_fft);
+  nsss_sync_corr_pci(q, cell_id);
+}
+
+// Correlates the input already transformed in conv_fft.input_fft with the NSSS sequence for a given n_id_ncell
+static void nsss_sync_corr_pci(srslte_nsss_synch_t* q, uint32_t cell_id)
+{
+  srslte_vec_prod_conj_ccc(q->conv_fft.input_fft, q->nsss_signal_freq[cell_id], q->conv_fft.output_fft, q->corr_len);
+  srslte_dft_run_c(&q->conv_fft.output_plan, q->conv_fft.output_fft, q->conv_output);
+  uint32_t conv_output_len = q->corr_len;
   srslte_vec_abs_cf(q->conv_output, q->conv_output_abs, conv_output_len - 1);
 
   // Find maximum of the absolute value of the correlation
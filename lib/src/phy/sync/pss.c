@@ -410,18 +410,18 @@ void srslte_pss_set_ema_alpha(srslte_pss_t* q, float alpha)
   q->ema_alpha = alpha;
 }
 
-float compute_peak_sidelobe(srslte_pss_t* q, uint32_t corr_peak_pos, uint32_t conv_output_len)
+static float peak_sidelobe(const float* corr, uint32_t corr_peak_pos, uint32_t conv_output_len)
 {
   // Find end of peak lobe to the right
   int pl_ub = corr_peak_pos + 1;
-  while (q->conv_output_avg[pl_ub + 1] <= q->conv_output_avg[pl_ub] && pl_ub < conv_output_len) {
+  while (corr[pl_ub + 1] <= corr[pl_ub] && pl_ub < conv_output_len) {
     pl_ub++;
   }
   // Find end of peak lobe to the left
   int pl_lb;
   if (corr_peak_pos > 2) {
     pl_lb = corr_peak_pos - 1;
-    while (q->conv_output_avg[pl_lb - 1] <= q->conv_output_avg[pl_lb] && pl_lb > 1) {
+    while (corr[pl_lb - 1] <= corr[pl_lb] && pl_lb > 1) {
       pl_lb--;
     }
   } else {
@@ -434,11 +434,16 @@ float compute_peak_sidelobe(srslte_pss_t* q, uint32_t corr_peak_pos, uint32_t co
   }
   int sl_distance_left = pl_lb;
 
-  int   sl_right        = pl_ub + srslte_vec_max_fi(&q->conv_output_avg[pl_ub], sl_distance_right);
-  int   sl_left         = srslte_vec_max_fi(q->conv_output_avg, sl_distance_left);
-  float side_lobe_value = SRSLTE_MAX(q->conv_output_avg[sl_right], q->conv_output_avg[sl_left]);
+  int   sl_right        = pl_ub + srslte_vec_max_fi(&corr[pl_ub], sl_distance_right);
+  int   sl_left         = srslte_vec_max_fi(corr, sl_distance_left);
+  float side_lobe_value = SRSLTE_MAX(corr[sl_right], corr[sl_left]);
+
+  return corr[corr_peak_pos] / side_lobe_value;
+}
 
-  return q->conv_output_avg[corr_peak_pos] / side_lobe_value;
+float compute_peak_sidelobe(srslte_pss_t* q, uint32_t corr_peak_pos, uint32_t conv_output_len)
+{
+  return peak_sidelobe(q->conv_output_avg, corr_peak_pos, conv_output_len);
 }
 
 /** Performs time-domain PSS correlation.
@@ -539,6 +544,78 @@ int srslte_pss_find_pss(srslte_pss_t* q, const cf_t* input, float* corr_peak_val
   return ret;
 }
 
+/** Correlates the input with the three PSS sequences at once, for cell search.
+ * The input is transformed once and each sequence only costs a spectral product and an inverse transform. The
+ * correlation is not averaged with previous calls and the state used by srslte_pss_find_pss() is not modified.
+ *
+ * Stores the peak-to-side-lobe ratio of each N_id_2 in psr and, if not NULL, the peak position in peak_pos (same
+ * convention as srslte_pss_find_pss()). Returns the N_id_2 with the highest ratio.
+ */
+int srslte_pss_find_pss_all(srslte_pss_t* q, const cf_t* input, float psr[3], uint32_t peak_pos[3])
+{
+  if (q == NULL || input == NULL || psr == NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  uint32_t    conv_output_len = q->frame_size;
+  const cf_t* x               = input;
+  bool        use_fft         = false;
+
+#ifdef CONVOLUTION_FFT
+  if (q->frame_size >= q->fft_size) {
+    use_fft = true;
+    // The transform runs over the zero padded copy of the input
+    memcpy(q->tmp_input, input, (q->frame_size * q->decimate) * sizeof(cf_t));
+    x = q->tmp_input;
+    if (q->decimate > 1) {
+      srslte_filt_decim_cc_execute(&(q->filter),
+                                   q->tmp_input,
+                                   q->filter.downsampled_input,
+                                   q->filter.filter_output,
+                                   (q->frame_size * q->decimate));
+      x = q->filter.filter_output;
+    }
+
+    // The input spectrum is shared by the three sequences
+    srslte_dft_run_c(&q->conv_fft.input_plan, x, q->conv_fft.input_fft);
+    conv_output_len = q->conv_fft.output_len - 1;
+  }
+#endif
+
+  int   best_N_id_2 = 0;
+  float best_psr    = -1.0f;
+  for (uint32_t N_id_2 = 0; N_id_2 < 3; N_id_2++) {
+    if (use_fft) {
+      srslte_vec_prod_ccc(
+          q->conv_fft.input_fft, q->pss_signal_freq_full[N_id_2], q->conv_fft.output_fft, q->conv_fft.output_len);
+      srslte_dft_run_c(&q->conv_fft.output_plan, q->conv_fft.output_fft, q->conv_output);
+    } else {
+      for (int i = 0; i < q->frame_size; i++) {
+        q->conv_output[i] = srslte_vec_dot_prod_ccc(q->pss_signal_time[N_id_2], &x[i], q->fft_size);
+      }
+    }
+
+    srslte_vec_abs_square_cf(q->conv_output, q->conv_output_abs, conv_output_len - 1);
+
+    uint32_t corr_peak_pos = srslte_vec_max_fi(q->conv_output_abs, conv_output_len - 1);
+    psr[N_id_2]            = peak_sidelobe(q->conv_output_abs, corr_peak_pos, conv_output_len);
+
+    if (psr[N_id_2] > best_psr) {
+      best_psr    = psr[N_id_2];
+      best_N_id_2 = N_id_2;
+    }
+
+    if (peak_pos) {
+      if (q->decimate > 1) {
+        corr_peak_pos = (corr_peak_pos - (q->filter.num_taps - 2)) * q->decimate;
+      }
+      peak_pos[N_id_2] = use_fft ? corr_peak_pos : corr_peak_pos + q->fft_size;
+    }
+  }
+
+  return best_N_id_2;
+}
+
 /* Computes frequency-domain channel estimation of the PSS symbol
  * input signal is in the time-domain.
  * ce is the returned frequency-domain channel estimates.
@@ -82,11 +82,43 @@ static inline void refsignal_sf_prepare_correlation(srslte_refsignal_dl_sync_t*
   srslte_dft_run_c(&q->conv_fft_cc.filter_plan, ptr_filt, ptr_filt);
 }
 
-static inline void
-refsignal_sf_correlate(srslte_refsignal_dl_sync_t* q, cf_t* ptr_in, float* peak_value, uint32_t* peak_idx, float* rms)
+/* Gets the FFT of the subframe sf of the shared buffer, computing it for the first cell only. Returns NULL if the
+ * buffer being searched is not the shared one */
+static inline const cf_t*
+refsignal_sf_shared_fft(srslte_refsignal_dl_sync_t* q, cf_t* buffer, uint32_t nsamples, uint32_t sf)
 {
-  // Correlate
-  srslte_corr_fft_cc_run_opt(&q->conv_fft_cc, ptr_in, q->conv_fft_cc.filter_fft, q->correlation);
+  if (buffer != q->shared_buffer || nsamples != q->shared_nsamples || q->buffer_fft[sf] == NULL) {
+    return NULL;
+  }
+
+  // The FFT size follows the bandwidth of the cell, forget the previous FFTs if it changed
+  if (q->buffer_fft_len != q->conv_fft_cc.output_len) {
+    q->buffer_fft_len   = q->conv_fft_cc.output_len;
+    q->buffer_fft_valid = 0;
+  }
+
+  if ((q->buffer_fft_valid & (1U << sf)) == 0) {
+    srslte_dft_run_c(&q->conv_fft_cc.input_plan, &buffer[sf * q->ifft.sf_sz], q->buffer_fft[sf]);
+    q->buffer_fft_valid |= (1U << sf);
+  }
+  return q->buffer_fft[sf];
+}
+
+static inline void refsignal_sf_correlate(srslte_refsignal_dl_sync_t* q,
+                                          cf_t*                       ptr_in,
+                                          const cf_t*                 ptr_in_fft,
+                                          float*                      peak_value,
+                                          uint32_t*                   peak_idx,
+                                          float*                      rms)
+{
+  // Correlate, reusing the FFT of the input when given
+  if (ptr_in_fft) {
+    srslte_conv_fft_cc_t* conv = &q->conv_fft_cc;
+    srslte_vec_prod_conj_ccc(ptr_in_fft, conv->filter_fft, conv->output_fft, conv->output_len);
+    srslte_dft_run_c(&conv->output_plan, conv->output_fft, q->correlation);
+  } else {
+    srslte_corr_fft_cc_run_opt(&q->conv_fft_cc, ptr_in, q->conv_fft_cc.filter_fft, q->correlation);
+  }
 
   // Find maximum, calculate RMS and peak
   uint32_t imax = srslte_vec_max_abs_ci(q->correlation, q->ifft.sf_sz);
@@ -295,7 +327,37 @@ void srslte_refsignal_dl_sync_free(srslte_refsignal_dl_sync_t* q)
     }
 
     srslte_conv_fft_cc_free(&q->conv_fft_cc);
+
+    for (int i = 0; i < SRSLTE_NOF_SF_X_FRAME; i++) {
+      if (q->buffer_fft[i]) {
+        free(q->buffer_fft[i]);
+      }
+    }
+  }
+}
+
+int srslte_refsignal_dl_sync_set_buffer(srslte_refsignal_dl_sync_t* q, const cf_t* buffer, uint32_t nsamples)
+{
+  if (q == NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
   }
+
+  // Allocated on first use only, as most users search a buffer for a single cell
+  for (int i = 0; i < SRSLTE_NOF_SF_X_FRAME; i++) {
+    if (q->buffer_fft[i] == NULL) {
+      q->buffer_fft[i] = srslte_vec_cf_malloc(SRSLTE_SF_LEN_MAX * 2);
+      if (q->buffer_fft[i] == NULL) {
+        perror("Allocating buffer_fft\n");
+        return SRSLTE_ERROR;
+      }
+    }
+  }
+
+  q->shared_buffer    = buffer;
+  q->shared_nsamples  = nsamples;
+  q->buffer_fft_valid = 0;
+
+  return SRSLTE_SUCCESS;
 }
 
 int srslte_refsignal_dl_sync_find_peak(srslte_refsignal_dl_sync_t* q, cf_t* buffer, uint32_t nsamples)
@@ -305,6 +367,7 @@ int srslte_refsignal_dl_sync_find_peak(srslte_refsignal_dl_sync_t* q, cf_t* buff
   int      peak_idx   = 0;
   float    rms_avg    = 0;
   uint32_t sf_len     = q->ifft.sf_sz;
+  uint32_t buffer_len = nsamples;
 
   // Load correlation sequence and convert to frequency domain
   refsignal_sf_prepare_correlation(q);
@@ -318,7 +381,8 @@ int srslte_refsignal_dl_sync_find_peak(srslte_refsignal_dl_sync_t* q, cf_t* buff
     uint32_t imax = 0;
     float    peak = 0.0f;
     float    rms  = 0.0f;
-    refsignal_sf_correlate(q, &buffer[n], &peak, &imax, &rms);
+    const cf_t* sf_fft = refsignal_sf_shared_fft(q, buffer, buffer_len, n / sf_len);
+    refsignal_sf_correlate(q, &buffer[n], sf_fft, &peak, &imax, &rms);
 
     rms_avg += rms;
 
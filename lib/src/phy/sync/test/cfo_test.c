@@ -101,6 +101,22 @@ int main(int argc, char** argv)
     mse += cabsf(input[i] - output[i]) / num_samples;
   }
 
+  // Same with the cached exponential on half of the samples, the frequency changes within the tolerance reuse it
+  const float tol = 1e-4f;
+  srslte_cfo_set_tol(&cfocorr, tol);
+  if (srslte_cfo_resize(&cfocorr, num_samples / 2)) {
+    ERROR("Error resizing CFO\n");
+    return -1;
+  }
+  srslte_cfo_correct(&cfocorr, output, output, freq);
+  srslte_cfo_correct(&cfocorr, output, output, freq + tol / 2);
+  srslte_cfo_correct(&cfocorr, output, output, -freq);
+  srslte_cfo_correct(&cfocorr, output, output, -freq - tol / 2);
+
+  for (i = 0; i < num_samples; i++) {
+    mse += cabsf(input[i] - output[i]) / num_samples;
+  }
+
   srslte_cfo_free(&cfocorr);
   free(input);
   free(output);
@@ -173,6 +173,13 @@ int main(int argc, char** argv)
         printf("Detected CP should be %s\n", SRSLTE_CP_ISNORM(cp) ? "Normal" : "Extended");
         exit(-1);
       }
+
+      /* The three sequences correlated at once must single out the transmitted one */
+      float psr[3] = {};
+      if (srslte_pss_find_pss_all(&syncobj.pss, fft_buffer, psr, NULL) != N_id_2) {
+        printf("N_id_2 from the three PSS correlation (%.2f, %.2f, %.2f) should be %d\n", psr[0], psr[1], psr[2], N_id_2);
+        exit(-1);
+      }
     }
     cid++;
   }
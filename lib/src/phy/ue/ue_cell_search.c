@@ -33,6 +33,9 @@
 
 #define CELL_SEARCH_BUFFER_MAX_SAMPLES (3 * SRSLTE_SF_LEN_MAX)
 
+// Minimum number of consistent detections before a N_id_2 scan can stop early
+#define CELL_SEARCH_EARLY_EXIT_MIN_FRAMES 2
+
 int srslte_ue_cellsearch_init(srslte_ue_cellsearch_t* q,
                               uint32_t                max_frames,
                               int(recv_callback)(void*, void*, uint32_t, srslte_timestamp_t*),
@@ -188,6 +191,48 @@ int srslte_ue_cellsearch_set_nof_valid_frames(srslte_ue_cellsearch_t* q, uint32_
   }
 }
 
+void srslte_ue_cellsearch_set_prescreen(srslte_ue_cellsearch_t* q, uint32_t nof_frames, float min_psr)
+{
+  q->prescreen_frames  = nof_frames;
+  q->prescreen_min_psr = min_psr;
+}
+
+void srslte_ue_cellsearch_set_early_exit(srslte_ue_cellsearch_t* q, float min_psr)
+{
+  q->early_exit_psr = min_psr;
+}
+
+/* Receives prescreen_frames frames and correlates each of them with the three PSS sequences at once. Stores the best
+ * PSR of each N_id_2 in max_psr */
+static int prescreen(srslte_ue_cellsearch_t* q, float max_psr[3])
+{
+  srslte_pss_t* pss = &q->ue_sync.sfind.pss;
+
+  for (uint32_t N_id_2 = 0; N_id_2 < 3; N_id_2++) {
+    max_psr[N_id_2] = 0.0f;
+  }
+
+  for (uint32_t i = 0; i < q->prescreen_frames; i++) {
+    srslte_timestamp_t ts = {};
+    if (q->ue_sync.recv_callback(q->ue_sync.stream, q->sf_buffer, q->ue_sync.frame_len, &ts) < 0) {
+      ERROR("Error receiving samples\n");
+      return SRSLTE_ERROR;
+    }
+
+    float psr[3] = {};
+    if (srslte_pss_find_pss_all(pss, q->sf_buffer[0], psr, NULL) < 0) {
+      ERROR("Error correlating PSS\n");
+      return SRSLTE_ERROR;
+    }
+
+    for (uint32_t N_id_2 = 0; N_id_2 < 3; N_id_2++) {
+      max_psr[N_id_2] = SRSLTE_MAX(max_psr[N_id_2], psr[N_id_2]);
+    }
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
 /* Decide the most likely cell based on the mode */
 static void get_cell(srslte_ue_cellsearch_t* q, uint32_t nof_detected_frames, srslte_ue_cellsearch_result_t* found_cell)
 {
@@ -264,8 +309,22 @@ int srslte_ue_cellsearch_scan(srslte_ue_cellsearch_t*       q,
   int      ret                = 0;
   float    max_peak_value     = -1.0;
   uint32_t nof_detected_cells = 0;
+  float    prescreen_psr[3]   = {};
+
+  // Correlate the three PSS on the same samples first, to skip the N_id_2 scans that would not find a cell
+  if (q->prescreen_frames > 0) {
+    if (prescreen(q, prescreen_psr)) {
+      return SRSLTE_ERROR;
+    }
+  }
 
   for (uint32_t N_id_2 = 0; N_id_2 < 3; N_id_2++) {
+    if (q->prescreen_frames > 0 && prescreen_psr[N_id_2] < q->prescreen_min_psr) {
+      INFO("CELL SEARCH: Skipping N_id_2=%d, prescreen PSR=%.2f\n", N_id_2, prescreen_psr[N_id_2]);
+      bzero(&found_cells[N_id_2], sizeof(srslte_ue_cellsearch_result_t));
+      continue;
+    }
+
     INFO("CELL SEARCH: Starting scan for N_id_2=%d\n", N_id_2);
     ret = srslte_ue_cellsearch_scan_N_id_2(q, N_id_2, &found_cells[N_id_2]);
     if (ret < 0) {
@@ -332,6 +391,21 @@ int srslte_ue_cellsearch_scan_N_id_2(srslte_ue_cellsearch_t*        q,
                q->candidates[nof_detected_frames].cfo / 1000);
 
           nof_detected_frames++;
+
+          // Stop once the same cell has been found enough times with a confident correlation
+          if (q->early_exit_psr > 0 && nof_detected_frames >= CELL_SEARCH_EARLY_EXIT_MIN_FRAMES &&
+              q->candidates[nof_detected_frames - 1].psr >= q->early_exit_psr) {
+            bool consistent = true;
+            for (uint32_t i = 0; i < nof_detected_frames - 1 && consistent; i++) {
+              consistent = q->candidates[i].cell_id == q->candidates[nof_detected_frames - 1].cell_id;
+            }
+            if (consistent) {
+              INFO("CELL SEARCH: Early exit after %d frames, PSR=%.2f\n",
+                   nof_detected_frames,
+                   q->candidates[nof_detected_frames - 1].psr);
+              break;
+            }
+          }
         }
       } else if (ret == 0) {
         /* This means a peak is not yet found and ue_sync is in find state
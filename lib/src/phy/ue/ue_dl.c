@@ -73,6 +73,7 @@ int srslte_ue_dl_init(srslte_ue_dl_t* q, cf_t* in_buffer[SRSLTE_MAX_PORTS], uint
     bzero(q, sizeof(srslte_ue_dl_t));
 
     q->pending_ul_dci_count = 0;
+    q->max_prb              = max_prb;
     q->nof_rx_antennas      = nof_rx_antennas;
     q->mi_auto              = true;
     q->mi_manual_index      = 0;
@@ -177,16 +178,65 @@ void srslte_ue_dl_free(srslte_ue_dl_t* q)
         free(q->sf_symbols[j]);
       }
     }
+    srslte_ue_dl_set_c16_storage(q, false);
     bzero(q, sizeof(srslte_ue_dl_t));
   }
 }
 
+int srslte_ue_dl_set_c16_storage(srslte_ue_dl_t* q, bool enable)
+{
+  if (q == NULL) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  if (enable && !q->c16_storage) {
+    q->c16_storage = true;
+    for (uint32_t j = 0; j < q->nof_rx_antennas; j++) {
+      if (srslte_grid_c16_init(&q->sf_symbols_c16[j], q->max_prb)) {
+        srslte_ue_dl_set_c16_storage(q, false);
+        return SRSLTE_ERROR;
+      }
+      for (uint32_t i = 0; i < SRSLTE_MAX_PORTS; i++) {
+        if (srslte_grid_c16_init(&q->ce_c16[i][j], q->max_prb)) {
+          srslte_ue_dl_set_c16_storage(q, false);
+          return SRSLTE_ERROR;
+        }
+      }
+    }
+  } else if (!enable && q->c16_storage) {
+    for (uint32_t j = 0; j < SRSLTE_MAX_PORTS; j++) {
+      srslte_grid_c16_free(&q->sf_symbols_c16[j]);
+      for (uint32_t i = 0; i < SRSLTE_MAX_PORTS; i++) {
+        srslte_grid_c16_free(&q->ce_c16[i][j]);
+      }
+    }
+    q->c16_storage = false;
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+/* The common search space does not depend on the RNTI, so it is computed once per cell for every PHICH
+ * resource and CFI and shared by the SI, P, RA and C-RNTI searches.
+ */
+static void set_common_ss(srslte_ue_dl_t* q)
+{
+  for (int i = 0; i < SRSLTE_MI_NOF_REGS; i++) {
+    srslte_pdcch_set_regs(&q->pdcch, &q->regs[i]);
+    for (int cfi = 1; cfi <= SRSLTE_NOF_CFI; cfi++) {
+      q->current_ss_common[i][SRSLTE_CFI_IDX(cfi)].nof_locations = srslte_pdcch_common_locations(
+          &q->pdcch, q->current_ss_common[i][SRSLTE_CFI_IDX(cfi)].loc, SRSLTE_MAX_CANDIDATES_COM, cfi);
+    }
+  }
+}
+
 int srslte_ue_dl_set_cell(srslte_ue_dl_t* q, srslte_cell_t cell)
 {
   int ret = SRSLTE_ERROR_INVALID_INPUTS;
 
   if (q != NULL && srslte_cell_isvalid(&cell)) {
     q->pending_ul_dci_count = 0;
+    bzero(q->pmi_cache, sizeof(q->pmi_cache));
 
     if (q->cell.id != cell.id || q->cell.nof_prb == 0) {
       if (q->cell.nof_prb != 0) {
@@ -249,6 +299,7 @@ int srslte_ue_dl_set_cell(srslte_ue_dl_t* q, srslte_cell_t cell)
         return SRSLTE_ERROR;
       }
     }
+    set_common_ss(q);
     if (q->pregen_rnti) {
       srslte_ue_dl_set_rnti(q, q->pregen_rnti);
     }
@@ -287,7 +338,7 @@ void srslte_ue_dl_set_rnti(srslte_ue_dl_t* q, uint16_t rnti)
   srslte_dl_sf_cfg_t sf_cfg;
   ZERO_OBJECT(sf_cfg);
 
-  // Compute UE-specific and Common search space for this RNTI
+  // Compute UE-specific search space for this RNTI
   for (int i = 0; i < SRSLTE_MI_NOF_REGS; i++) {
     srslte_pdcch_set_regs(&q->pdcch, &q->regs[i]);
     for (int cfi = 1; cfi <= SRSLTE_NOF_CFI; cfi++) {
@@ -297,8 +348,6 @@ void srslte_ue_dl_set_rnti(srslte_ue_dl_t* q, uint16_t rnti)
         q->current_ss_ue[i][SRSLTE_CFI_IDX(cfi)][sf_idx].nof_locations = srslte_pdcch_ue_locations(
             &q->pdcch, &sf_cfg, q->current_ss_ue[i][SRSLTE_CFI_IDX(cfi)][sf_idx].loc, SRSLTE_MAX_CANDIDATES_UE, rnti);
       }
-      q->current_ss_common[i][SRSLTE_CFI_IDX(cfi)].nof_locations = srslte_pdcch_common_locations(
-          &q->pdcch, q->current_ss_common[i][SRSLTE_CFI_IDX(cfi)].loc, SRSLTE_MAX_CANDIDATES_COM, cfi);
     }
   }
   q->pregen_rnti = rnti;
@@ -355,6 +404,17 @@ static int estimate_pdcch_pcfich(srslte_ue_dl_t* q, srslte_dl_sf_cfg_t* sf, srsl
 
     /* Get channel estimates for each port */
     srslte_chest_dl_estimate_cfg(&q->chest, sf, &cfg->chest_cfg, q->sf_symbols, &q->chest_res);
+    q->nof_estimates++;
+
+    if (q->c16_storage && sf->sf_type == SRSLTE_SF_NORM) {
+      uint32_t nof_symbols = 2 * SRSLTE_CP_NSYMB(q->cell.cp);
+      for (uint32_t j = 0; j < q->nof_rx_antennas; j++) {
+        srslte_grid_c16_store(&q->sf_symbols_c16[j], q->sf_symbols[j], q->cell.nof_prb, nof_symbols);
+        for (uint32_t i = 0; i < q->cell.nof_ports; i++) {
+          srslte_grid_c16_store(&q->ce_c16[i][j], q->chest_res.ce[i][j], q->cell.nof_prb, nof_symbols);
+        }
+      }
+    }
 
     /* First decode PCFICH and obtain CFI */
     if (srslte_pcfich_decode(&q->pcfich, sf, &q->chest_res, q->sf_symbols, &cfi_corr) < 0) {
@@ -380,9 +440,9 @@ static int estimate_pdcch_pcfich(srslte_ue_dl_t* q, srslte_dl_sf_cfg_t* sf, srsl
   }
 }
 
-int srslte_ue_dl_decode_fft_estimate(srslte_ue_dl_t* q, srslte_dl_sf_cfg_t* sf, srslte_ue_dl_cfg_t* cfg)
+int srslte_ue_dl_decode_fft(srslte_ue_dl_t* q, srslte_dl_sf_cfg_t* sf)
 {
-  if (q) {
+  if (q && sf) {
     /* Run FFT for all subframe data */
     for (int j = 0; j < q->nof_rx_antennas; j++) {
       if (sf->sf_type == SRSLTE_SF_MBSFN) {
@@ -391,12 +451,26 @@ int srslte_ue_dl_decode_fft_estimate(srslte_ue_dl_t* q, srslte_dl_sf_cfg_t* sf,
         srslte_ofdm_rx_sf(&q->fft[j]);
       }
     }
-    return estimate_pdcch_pcfich(q, sf, cfg);
+    return SRSLTE_SUCCESS;
   } else {
     return SRSLTE_ERROR_INVALID_INPUTS;
   }
 }
 
+int srslte_ue_dl_estimate(srslte_ue_dl_t* q, srslte_dl_sf_cfg_t* sf, srslte_ue_dl_cfg_t* cfg)
+{
+  return estimate_pdcch_pcfich(q, sf, cfg);
+}
+
+int srslte_ue_dl_decode_fft_estimate(srslte_ue_dl_t* q, srslte_dl_sf_cfg_t* sf, srslte_ue_dl_cfg_t* cfg)
+{
+  int ret = srslte_ue_dl_decode_fft(q, sf);
+  if (ret < SRSLTE_SUCCESS) {
+    return ret;
+  }
+  return srslte_ue_dl_estimate(q, sf, cfg);
+}
+
 int srslte_ue_dl_decode_fft_estimate_noguru(srslte_ue_dl_t*     q,
                                             srslte_dl_sf_cfg_t* sf,
                                             srslte_ue_dl_cfg_t* cfg,
@@ -466,6 +540,10 @@ static int dci_blind_search(srslte_ue_dl_t*     q,
         INFO("Skipping location L=%d, ncce=%d. Already allocated\n", search_space->loc[l].L, search_space->loc[l].ncce);
         continue;
       }
+      if (srslte_pdcch_location_energy(&q->pdcch, &search_space->loc[l]) <= SRSLTE_PDCCH_MIN_ENERGY) {
+        // Not transmitted, none of the formats can be decoded from this location
+        continue;
+      }
       for (uint32_t f = 0; f < search_space->nof_formats; f++) {
         INFO("Searching format %s in %d,%d (%d/%d)\n",
              srslte_dci_format_string(search_space->formats[f]),
@@ -583,13 +661,7 @@ static int find_dci_ss(srslte_ue_dl_t*            q,
     // Disable extended CSI request and SRS request in common SS
     srslte_dci_cfg_set_common_ss(&dci_cfg);
 
-    if (q->pregen_rnti == rnti) {
-      current_ss = &q->current_ss_common[MI_IDX(sf_idx)][SRSLTE_CFI_IDX(cfi)];
-    } else {
-      // If locations are not pre-generated, generate them now
-      current_ss->nof_locations =
-          srslte_pdcch_common_locations(&q->pdcch, current_ss->loc, SRSLTE_MAX_CANDIDATES_COM, cfi);
-    }
+    current_ss = &q->current_ss_common[MI_IDX(sf_idx)][SRSLTE_CFI_IDX(cfi)];
   }
 
   // Search for DCI in the SS
@@ -743,6 +815,9 @@ int srslte_ue_dl_decode_pdsch(srslte_ue_dl_t*     q,
                               srslte_pdsch_cfg_t* pdsch_cfg,
                               srslte_pdsch_res_t  data[SRSLTE_MAX_CODEWORDS])
 {
+  if (q->c16_storage && sf->sf_type == SRSLTE_SF_NORM) {
+    return srslte_pdsch_decode_c16(&q->pdsch, sf, pdsch_cfg, &q->chest_res, q->sf_symbols_c16, q->ce_c16, data);
+  }
   return srslte_pdsch_decode(&q->pdsch, sf, pdsch_cfg, &q->chest_res, q->sf_symbols, data);
 }
 
@@ -760,25 +835,46 @@ int srslte_ue_dl_decode_phich(srslte_ue_dl_t*       q,
                               srslte_phich_grant_t* grant,
                               srslte_phich_res_t*   result)
 {
-  srslte_phich_resource_t n_phich;
+  return srslte_ue_dl_decode_phich_batch(q, sf, cfg, grant, 1, result);
+}
+
+int srslte_ue_dl_decode_phich_batch(srslte_ue_dl_t*            q,
+                                    srslte_dl_sf_cfg_t*        sf,
+                                    srslte_ue_dl_cfg_t*        cfg,
+                                    const srslte_phich_grant_t grant[],
+                                    uint32_t                   nof_grants,
+                                    srslte_phich_res_t         result[])
+{
+  srslte_phich_resource_t n_phich[SRSLTE_UE_DL_MAX_PHICH];
+
+  if (nof_grants > SRSLTE_UE_DL_MAX_PHICH) {
+    ERROR("Too many PHICH grants %d\n", nof_grants);
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
 
   uint32_t sf_idx = sf->tti % 10;
 
   set_mi_value(q, sf, cfg);
 
-  srslte_phich_calc(&q->phich, grant, &n_phich);
-  INFO("Decoding PHICH sf_idx=%d, n_prb_lowest=%d, n_dmrs=%d, I_phich=%d, n_group=%d, n_seq=%d, Ngroups=%d, Nsf=%d\n",
-       sf_idx,
-       grant->n_prb_lowest,
-       grant->n_dmrs,
-       grant->I_phich,
-       n_phich.ngroup,
-       n_phich.nseq,
-       srslte_phich_ngroups(&q->phich),
-       srslte_phich_nsf(&q->phich));
-
-  if (!srslte_phich_decode(&q->phich, sf, &q->chest_res, n_phich, q->sf_symbols, result)) {
-    INFO("Decoded PHICH %d with distance %f\n", result->ack_value, result->distance);
+  for (uint32_t i = 0; i < nof_grants; i++) {
+    srslte_phich_grant_t g = grant[i];
+    srslte_phich_calc(&q->phich, &g, &n_phich[i]);
+    INFO("Decoding PHICH sf_idx=%d, n_prb_lowest=%d, n_dmrs=%d, I_phich=%d, n_group=%d, n_seq=%d, Ngroups=%d, "
+         "Nsf=%d\n",
+         sf_idx,
+         g.n_prb_lowest,
+         g.n_dmrs,
+         g.I_phich,
+         n_phich[i].ngroup,
+         n_phich[i].nseq,
+         srslte_phich_ngroups(&q->phich),
+         srslte_phich_nsf(&q->phich));
+  }
+
+  if (!srslte_phich_decode_batch(&q->phich, sf, &q->chest_res, n_phich, nof_grants, q->sf_symbols, result)) {
+    for (uint32_t i = 0; i < nof_grants; i++) {
+      INFO("Decoded PHICH %d with distance %f\n", result[i].ack_value, result[i].distance);
+    }
     return 0;
   } else {
     ERROR("Error decoding PHICH\n");
@@ -788,7 +884,7 @@ int srslte_ue_dl_decode_phich(srslte_ue_dl_t*       q,
 
 /* Compute the Rank Indicator (RI) and Precoder Matrix Indicator (PMI) by computing the Signal to Interference plus
  * Noise Ratio (SINR), valid for TM4 */
-static int select_pmi(srslte_ue_dl_t* q, uint32_t ri, uint32_t* pmi, float* sinr_db)
+static int select_pmi(srslte_ue_dl_t* q, srslte_ue_dl_cfg_t* cfg, uint32_t ri, uint32_t* pmi, float* sinr_db)
 {
   uint32_t best_pmi = 0;
   float    sinr_list[SRSLTE_MAX_CODEBOOKS];
@@ -797,26 +893,40 @@ static int select_pmi(srslte_ue_dl_t* q, uint32_t ri, uint32_t* pmi, float* sinr
     /* Do nothing */
     return SRSLTE_SUCCESS;
   } else {
-    if (srslte_pdsch_select_pmi(&q->pdsch, &q->chest_res, ri + 1, &best_pmi, sinr_list)) {
-      DEBUG("SINR calculation error");
-      return SRSLTE_ERROR;
+    /* Reuse the selection from the same channel estimate, or from a recent one if the SNR did not change */
+    srslte_ue_dl_pmi_cache_t* cache = &q->pmi_cache[ri % SRSLTE_MAX_LAYERS];
+    uint32_t                  age   = q->nof_estimates - cache->estimate_idx;
+    float                     delta = fabsf(q->chest_res.snr_db - cache->snr_db);
+    bool                      reuse = cache->valid && (age == 0 || (age <= cfg->pmi_max_age &&
+                                                                 delta < SRSLTE_UE_DL_PMI_CACHE_MAX_SNR_DELTA_DB));
+    if (!reuse) {
+      if (srslte_pdsch_select_pmi(&q->pdsch, &q->chest_res, ri + 1, &best_pmi, sinr_list)) {
+        DEBUG("SINR calculation error");
+        return SRSLTE_ERROR;
+      }
+
+      cache->valid        = true;
+      cache->pmi          = best_pmi;
+      cache->sinr_db      = srslte_convert_power_to_dB(sinr_list[best_pmi % SRSLTE_MAX_CODEBOOKS]);
+      cache->snr_db       = q->chest_res.snr_db;
+      cache->estimate_idx = q->nof_estimates;
     }
 
     /* Set PMI */
     if (pmi != NULL) {
-      *pmi = best_pmi;
+      *pmi = cache->pmi;
     }
 
-    /* Set PMI */
+    /* Set SINR */
     if (sinr_db != NULL) {
-      *sinr_db = srslte_convert_power_to_dB(sinr_list[best_pmi % SRSLTE_MAX_CODEBOOKS]);
+      *sinr_db = cache->sinr_db;
     }
   }
 
   return SRSLTE_SUCCESS;
 }
 
-static int select_ri_pmi(srslte_ue_dl_t* q, uint32_t* ri, uint32_t* pmi, float* sinr_db)
+static int select_ri_pmi(srslte_ue_dl_t* q, srslte_ue_dl_cfg_t* cfg, uint32_t* ri, uint32_t* pmi, float* sinr_db)
 {
   float    best_sinr_db = -INFINITY;
   uint32_t best_pmi = 0, best_ri = 0;
@@ -830,7 +940,7 @@ static int select_ri_pmi(srslte_ue_dl_t* q, uint32_t* ri, uint32_t* pmi, float*
     for (uint32_t this_ri = 0; this_ri < max_ri; this_ri++) {
       uint32_t this_pmi     = 0;
       float    this_sinr_db = 0.0f;
-      if (select_pmi(q, this_ri, &this_pmi, &this_sinr_db)) {
+      if (select_pmi(q, cfg, this_ri, &this_pmi, &this_sinr_db)) {
         DEBUG("SINR calculation error");
         return SRSLTE_ERROR;
       }
@@ -895,7 +1005,7 @@ void srslte_ue_dl_gen_cqi_periodic(srslte_ue_dl_t*     q,
       if (cfg->cfg.tm == SRSLTE_TM3) {
         srslte_ue_dl_select_ri(q, &cfg->last_ri, NULL);
       } else if (cfg->cfg.tm == SRSLTE_TM4) {
-        select_ri_pmi(q, &cfg->last_ri, NULL, NULL);
+        select_ri_pmi(q, cfg, &cfg->last_ri, NULL, NULL);
       }
     } else {
       cfg->last_ri = 0;
@@ -914,7 +1024,7 @@ void srslte_ue_dl_gen_cqi_periodic(srslte_ue_dl_t*     q,
       uci_data->value.cqi.wideband.wideband_cqi = wideband_value;
       if (cfg->cfg.tm == SRSLTE_TM4) {
         uint32_t pmi = 0;
-        select_pmi(q, cfg->last_ri, &pmi, NULL);
+        select_pmi(q, cfg, cfg->last_ri, &pmi, NULL);
 
         uci_data->cfg.cqi.pmi_present     = true;
         uci_data->cfg.cqi.rank_is_not_one = (cfg->last_ri != 0);
@@ -984,7 +1094,7 @@ void srslte_ue_dl_gen_cqi_aperiodic(srslte_ue_dl_t*     q,
       /* Loads the latest SINR according to the calculated RI and PMI */
       pmi     = 0;
       sinr_db = 0.0f;
-      select_ri_pmi(q, &cfg->last_ri, &pmi, &sinr_db);
+      select_ri_pmi(q, cfg, &cfg->last_ri, &pmi, &sinr_db);
 
       /* Fill CQI Report */
       uci_data->cfg.cqi.type = SRSLTE_CQI_TYPE_SUBBAND_HL;
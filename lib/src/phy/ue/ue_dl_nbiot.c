@@ -20,6 +20,7 @@
  */
 
 #include "srslte/phy/ue/ue_dl_nbiot.h"
+#include "srslte/phy/utils/simd.h"
 
 #include <assert.h>
 #include <complex.h>
@@ -740,6 +741,52 @@ int srslte_nbiot_ue_dl_decode_npdsch(srslte_nbiot_ue_dl_t* q,
   return ret;
 }
 
+/* Combines one more repetition of the current NPDSCH subframe into its symbol and channel estimate buffers, which
+ * keep the running mean of the nof_combined repetitions already received. The symbols and the estimates of all the
+ * ports are updated in a single pass over the REs.
+ */
+static void nbiot_ue_dl_combine_npdsch_sf(srslte_nbiot_ue_dl_t* q, uint32_t nof_combined)
+{
+  uint32_t    offset  = q->npdsch_cfg.sf_idx * q->nof_re;
+  uint32_t    nof_buf = q->cell.nof_ports + 1;
+  cf_t*       acc[SRSLTE_MAX_PORTS + 1];
+  const cf_t* in[SRSLTE_MAX_PORTS + 1];
+
+  acc[0] = &q->sf_buffer[offset];
+  in[0]  = q->sf_symbols;
+  for (uint32_t p = 0; p < q->cell.nof_ports; p++) {
+    acc[p + 1] = &q->ce_buffer[p][offset];
+    in[p + 1]  = q->ce[p];
+  }
+
+  if (nof_combined == 0) {
+    // first repetition of this subframe
+    for (uint32_t j = 0; j < nof_buf; j++) {
+      srslte_vec_cf_copy(acc[j], in[j], q->nof_re);
+    }
+    return;
+  }
+
+  // acc += (in - acc) / (nof_combined + 1)
+  float w = 1.0f / (nof_combined + 1);
+  int   i = 0;
+#if SRSLTE_SIMD_CF_SIZE
+  simd_f_t w_simd = srslte_simd_f_set1(w);
+  for (; i < q->nof_re - SRSLTE_SIMD_CF_SIZE + 1; i += SRSLTE_SIMD_CF_SIZE) {
+    for (uint32_t j = 0; j < nof_buf; j++) {
+      simd_cf_t a = srslte_simd_cfi_loadu(&acc[j][i]);
+      simd_cf_t x = srslte_simd_cfi_loadu(&in[j][i]);
+      srslte_simd_cfi_storeu(&acc[j][i], srslte_simd_cf_add(a, srslte_simd_cf_mul(srslte_simd_cf_sub(x, a), w_simd)));
+    }
+  }
+#endif /* SRSLTE_SIMD_CF_SIZE */
+  for (; i < q->nof_re; i++) {
+    for (uint32_t j = 0; j < nof_buf; j++) {
+      acc[j][i] += (in[j][i] - acc[j][i]) * w;
+    }
+  }
+}
+
 /** Handles subframe reception of a NPDSCH which doesn't carry the BCCH
  *  - In this NPDSCH config, up to four repetitons are transmitted one after another
  */
@@ -762,46 +809,21 @@ int srslte_nbiot_ue_dl_decode_npdsch_no_bcch(srslte_nbiot_ue_dl_t* q, uint8_t* d
        q->npdsch_cfg.num_sf + 1,
        q->npdsch_cfg.grant.nof_sf * q->npdsch_cfg.grant.nof_rep);
 
-  if (q->npdsch_cfg.num_sf % q->npdsch_cfg.grant.nof_rep == 0) {
-    // copy data and ce symbols for first repetition of each subframe
-    srslte_vec_cf_copy(&q->sf_buffer[q->npdsch_cfg.sf_idx * q->nof_re], q->sf_symbols, q->nof_re);
-    for (int i = 0; i < q->cell.nof_ports; i++) {
-      srslte_vec_cf_copy(&q->ce_buffer[i][q->npdsch_cfg.sf_idx * q->nof_re], q->ce[i], q->nof_re);
-    }
-  } else {
-    // accumulate subframe samples and channel estimates
-    srslte_vec_sum_ccc(&q->sf_buffer[q->npdsch_cfg.sf_idx * q->nof_re],
-                       q->sf_symbols,
-                       &q->sf_buffer[q->npdsch_cfg.sf_idx * q->nof_re],
-                       q->nof_re);
-    for (int i = 0; i < q->cell.nof_ports; i++) {
-      srslte_vec_sum_ccc(&q->ce_buffer[i][q->npdsch_cfg.sf_idx * q->nof_re],
-                         q->ce[i],
-                         &q->ce_buffer[i][q->npdsch_cfg.sf_idx * q->nof_re],
-                         q->nof_re);
-    }
-  }
+  // the buffers of each subframe hold the mean of all its repetitions received so far
+  nbiot_ue_dl_combine_npdsch_sf(q, q->npdsch_cfg.rep_idx);
   q->npdsch_cfg.num_sf++;
   // srslte_nbiot_ue_dl_save_signal(q, input, sfn, sf_idx);
 
   q->npdsch_cfg.rep_idx++;
-  int m = SRSLTE_MIN(q->npdsch_cfg.grant.nof_rep, 4);
+  int  m         = SRSLTE_MIN(q->npdsch_cfg.grant.nof_rep, 4);
+  bool try_early = false;
   if (q->npdsch_cfg.rep_idx % m == 0) {
-    // average accumulated samples
-    srslte_vec_sc_prod_ccc(&q->sf_buffer[q->npdsch_cfg.sf_idx * q->nof_re],
-                           1.0 / m,
-                           &q->sf_buffer[q->npdsch_cfg.sf_idx * q->nof_re],
-                           q->nof_re);
-    for (int i = 0; i < q->cell.nof_ports; i++) {
-      srslte_vec_sc_prod_ccc(&q->ce_buffer[i][q->npdsch_cfg.sf_idx * q->nof_re],
-                             1.0 / m,
-                             &q->ce_buffer[i][q->npdsch_cfg.sf_idx * q->nof_re],
-                             q->nof_re);
-    }
-
     q->npdsch_cfg.sf_idx++;
     if (q->npdsch_cfg.sf_idx == q->npdsch_cfg.grant.nof_sf) {
       q->npdsch_cfg.sf_idx = 0;
+      // all subframes have been received rep_idx times, attempt an early decode at every power of two
+      try_early = q->npdsch_cfg.rep_idx < q->npdsch_cfg.grant.nof_rep &&
+                  (q->npdsch_cfg.rep_idx & (q->npdsch_cfg.rep_idx - 1)) == 0;
     } else {
       q->npdsch_cfg.rep_idx -= m;
     }
@@ -828,6 +850,23 @@ int srslte_nbiot_ue_dl_decode_npdsch_no_bcch(srslte_nbiot_ue_dl_t* q, uint8_t* d
       srslte_nbiot_ue_dl_tb_decoded(q, data);
       ret = SRSLTE_SUCCESS;
     }
+  } else if (try_early && srslte_nbiot_ue_dl_decode_rnti_packet(q,
+                                                                   &q->npdsch_cfg.grant,
+                                                                   data,
+                                                                   tti / 10,
+                                                                   tti % 10,
+                                                                   rnti,
+                                                                   q->sf_buffer,
+                                                                   q->ce_buffer,
+                                                                   q->npdsch_cfg.rep_idx) == SRSLTE_SUCCESS) {
+    // no need to wait for the remaining repetitions
+    INFO("%d.%d: Decoded NPDSCH after %d of %d repetitions.\n",
+         tti / 10,
+         tti % 10,
+         q->npdsch_cfg.rep_idx,
+         q->npdsch_cfg.grant.nof_rep);
+    srslte_nbiot_ue_dl_tb_decoded(q, data);
+    ret = SRSLTE_SUCCESS;
   } else {
     DEBUG("%d.%d: Waiting for %d more subframes.\n",
           tti / 10,
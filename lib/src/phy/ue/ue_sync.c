@@ -37,6 +37,7 @@
 
 #define TRACK_MAX_LOST 10
 #define TRACK_FRAME_SIZE 32
+#define TRACK_STABLE_MAX_OFFSET 1
 #define FIND_NOF_AVG_FRAMES 4
 
 #define PSS_OFFSET                                                                                                     \
@@ -139,6 +140,8 @@ void srslte_ue_sync_reset(srslte_ue_sync_t* q)
   q->mean_sample_offset    = 0.0;
   q->next_rf_sample_offset = 0;
   q->frame_find_cnt        = 0;
+  q->track_period          = 1;
+  q->track_skip_cnt        = 0;
 }
 
 int srslte_ue_sync_start_agc(srslte_ue_sync_t* q,
@@ -226,6 +229,7 @@ int srslte_ue_sync_init_multi_decim_mode(
     q->agc_period                   = 0;
     q->sample_offset_correct_period = DEFAULT_SAMPLE_OFFSET_CORRECT_PERIOD;
     q->sfo_ema                      = DEFAULT_SFO_EMA_COEFF;
+    q->track_max_period             = DEFAULT_TRACK_MAX_PERIOD;
 
     q->max_prb = max_prb;
 
@@ -547,6 +551,13 @@ void srslte_ue_sync_set_sfo_ema(srslte_ue_sync_t* q, float ema_coefficient)
   q->sfo_ema = ema_coefficient;
 }
 
+void srslte_ue_sync_set_track_max_period(srslte_ue_sync_t* q, uint32_t max_period)
+{
+  q->track_max_period = SRSLTE_MAX(max_period, 1);
+  q->track_period     = 1;
+  q->track_skip_cnt   = 0;
+}
+
 void srslte_ue_sync_set_N_id_2(srslte_ue_sync_t* q, uint32_t N_id_2)
 {
   if (!q->file_mode) {
@@ -684,6 +695,14 @@ static int track_peak_ok(srslte_ue_sync_t* q, uint32_t track_idx)
   q->frame_ok_cnt++;
   q->frame_no_cnt = 0;
 
+  // Slow down the PSS tracking while neither the time nor the PSS CFO need correcting, restart on any deviation
+  if (q->pss_is_stable && abs(q->last_sample_offset) <= TRACK_STABLE_MAX_OFFSET) {
+    q->track_period = SRSLTE_MIN(2 * q->track_period, q->track_max_period);
+  } else {
+    q->track_period = 1;
+  }
+  q->track_skip_cnt = q->track_period - 1;
+
   return 1;
 }
 
@@ -691,6 +710,8 @@ static int track_peak_no(srslte_ue_sync_t* q)
 {
 
   /* if we missed too many PSS go back to FIND and consider this frame unsynchronized */
+  q->track_period   = 1;
+  q->track_skip_cnt = 0;
   q->frame_no_cnt++;
   if (q->frame_no_cnt >= TRACK_MAX_LOST) {
     INFO("\n%d frames lost. Going back to FIND\n", (int)q->frame_no_cnt);
@@ -780,12 +801,11 @@ int srslte_ue_sync_zerocopy(srslte_ue_sync_t* q,
         case SF_FIND:
           // Correct CFO before PSS/SSS find using the sync object corrector (initialized for 1 ms)
           if (q->cfo_correct_enable_find) {
-            for (int i = 0; i < q->nof_rx_antennas; i++) {
-              if (input_buffer[i]) {
-                srslte_cfo_correct(
-                    &q->strack.cfo_corr_frame, input_buffer[i], input_buffer[i], -q->cfo_current_value / q->fft_size);
-              }
-            }
+            srslte_cfo_correct_multi(&q->strack.cfo_corr_frame,
+                                     input_buffer,
+                                     input_buffer,
+                                     q->nof_rx_antennas,
+                                     -q->cfo_current_value / q->fft_size);
           }
 
           // Run mode-specific find operation
@@ -812,12 +832,11 @@ int srslte_ue_sync_zerocopy(srslte_ue_sync_t* q,
 
           // Correct CFO before PSS/SSS tracking using the sync object corrector (initialized for 1 ms)
           if (q->cfo_correct_enable_track) {
-            for (int i = 0; i < q->nof_rx_antennas; i++) {
-              if (input_buffer[i]) {
-                srslte_cfo_correct(
-                    &q->strack.cfo_corr_frame, input_buffer[i], input_buffer[i], -q->cfo_current_value / q->fft_size);
-              }
-            }
+            srslte_cfo_correct_multi(&q->strack.cfo_corr_frame,
+                                     input_buffer,
+                                     input_buffer,
+                                     q->nof_rx_antennas,
+                                     -q->cfo_current_value / q->fft_size);
           }
 
           if (q->mode == SYNC_MODE_PSS) {
@@ -883,6 +902,14 @@ int srslte_ue_sync_run_track_pss_mode(srslte_ue_sync_t* q, cf_t* input_buffer[SR
       srslte_agc_process(&q->agc, input_buffer[0], q->sf_len);
     }
 
+    // In low power tracking, skip this PSS occasion if the timing was stable
+    if (q->track_skip_cnt > 0) {
+      q->track_skip_cnt--;
+      q->frame_total_cnt++;
+      INFO("SYNC TRACK: sf_idx=%d, PSS skipped, period=%d\n", q->sf_idx, q->track_period);
+      return 1;
+    }
+
     /* Track PSS around the expected PSS position
      * In tracking phase, the subframe carrying the PSS is always the last one of the frame
      */
@@ -51,6 +51,13 @@ void srslte_bit_interleaver_init(srslte_bit_interleaver_t* q, uint16_t* interlea
     q->interleaver[i] = i_px;
     q->byte_idx[i]    = (uint16_t)(interleaver[i] / 8);
     q->bit_mask[i]    = (uint8_t)(mask[i_px % 8]);
+
+    // The interleaver is a permutation, so the last input bits are the largest indexes
+    if (i_px + SRSLTE_BIT_INTERLEAVER_MAX_TAIL >= nof_bits && q->nof_tail < SRSLTE_BIT_INTERLEAVER_MAX_TAIL) {
+      q->tail_in[q->nof_tail]  = i_px;
+      q->tail_out[q->nof_tail] = (uint16_t)i;
+      q->nof_tail++;
+    }
   }
 }
 
@@ -71,6 +78,30 @@ void srslte_bit_interleaver_free(srslte_bit_interleaver_t* q)
   bzero(q, sizeof(srslte_bit_interleaver_t));
 }
 
+void srslte_bit_interleaver_run_split(srslte_bit_interleaver_t* q,
+                                      const uint8_t*            input,
+                                      const uint8_t*            tail,
+                                      uint32_t                  split,
+                                      uint8_t*                  output)
+{
+  static const uint8_t mask[] = {0x80, 0x40, 0x20, 0x10, 0x8, 0x4, 0x2, 0x1};
+
+  srslte_bit_interleaver_run(q, (uint8_t*)input, output, 0);
+
+  // Overwrite the bits taken from input past split
+  for (uint32_t k = 0; k < q->nof_tail; k++) {
+    uint16_t i_p = q->tail_in[k];
+    if (i_p >= split) {
+      uint16_t j = q->tail_out[k];
+      if (tail[(i_p - split) / 8] & mask[(i_p - split) % 8]) {
+        output[j / 8] |= mask[j % 8];
+      } else {
+        output[j / 8] &= ~(mask[j % 8]);
+      }
+    }
+  }
+}
+
 void srslte_bit_interleaver_run(srslte_bit_interleaver_t* q, uint8_t* input, uint8_t* output, uint16_t w_offset)
 {
   static const uint8_t mask[]     = {0x80, 0x40, 0x20, 0x10, 0x8, 0x4, 0x2, 0x1};
@@ -699,9 +730,59 @@ void srslte_bit_copy(uint8_t* dst, uint32_t dst_offset, uint8_t* src, uint32_t s
 
 void srslte_bit_unpack_vector(uint8_t* packed, uint8_t* unpacked, int nof_bits)
 {
-  uint32_t i, nbytes;
+  uint32_t i = 0, nbytes;
   nbytes = nof_bits / 8;
-  for (i = 0; i < nbytes; i++) {
+
+  // Every packed byte is broadcast to 8 bytes, each one tested with the mask of its bit
+#ifdef LV_HAVE_AVX512
+  const __m512i shuffle512 = _mm512_set_epi64(0x0707070707070707,
+                                              0x0606060606060606,
+                                              0x0505050505050505,
+                                              0x0404040404040404,
+                                              0x0303030303030303,
+                                              0x0202020202020202,
+                                              0x0101010101010101,
+                                              0x0000000000000000);
+  const __m512i mask512    = _mm512_set1_epi64(0x0102040810204080);
+  for (; i + 8 <= nbytes; i += 8) {
+    uint64_t bytes;
+    memcpy(&bytes, &packed[i], sizeof(bytes));
+    // The byte shuffle works in 128-bit lanes, every lane holds all the 8 packed bytes
+    __m512i   v = _mm512_shuffle_epi8(_mm512_set1_epi64((long long)bytes), shuffle512);
+    __mmask64 m = _mm512_test_epi8_mask(v, mask512);
+    _mm512_storeu_si512((__m512i*)unpacked, _mm512_maskz_set1_epi8(m, 1));
+    unpacked += 64;
+  }
+#endif /* LV_HAVE_AVX512 */
+
+#ifdef LV_HAVE_AVX2
+  const __m256i shuffle256 =
+      _mm256_set_epi64x(0x0303030303030303, 0x0202020202020202, 0x0101010101010101, 0x0000000000000000);
+  const __m256i mask256 = _mm256_set1_epi64x(0x0102040810204080);
+  for (; i + 4 <= nbytes; i += 4) {
+    uint32_t bytes;
+    memcpy(&bytes, &packed[i], sizeof(bytes));
+    __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32((int)bytes), shuffle256);
+    v         = _mm256_cmpeq_epi8(_mm256_and_si256(v, mask256), mask256);
+    _mm256_storeu_si256((__m256i*)unpacked, _mm256_and_si256(v, _mm256_set1_epi8(1)));
+    unpacked += 32;
+  }
+#endif /* LV_HAVE_AVX2 */
+
+#ifdef LV_HAVE_SSE
+  const __m128i shuffle128 = _mm_set_epi64x(0x0101010101010101, 0x0000000000000000);
+  const __m128i mask128    = _mm_set1_epi64x(0x0102040810204080);
+  for (; i + 2 <= nbytes; i += 2) {
+    uint16_t bytes;
+    memcpy(&bytes, &packed[i], sizeof(bytes));
+    __m128i v = _mm_shuffle_epi8(_mm_set1_epi16((short)bytes), shuffle128);
+    v         = _mm_cmpeq_epi8(_mm_and_si128(v, mask128), mask128);
+    _mm_storeu_si128((__m128i*)unpacked, _mm_and_si128(v, _mm_set1_epi8(1)));
+    unpacked += 16;
+  }
+#endif /* LV_HAVE_SSE */
+
+  for (; i < nbytes; i++) {
     srslte_bit_unpack(packed[i], &unpacked, 8);
   }
   if (nof_bits % 8) {
@@ -738,11 +819,48 @@ void srslte_bit_unpack(uint32_t value, uint8_t** bits, int nof_bits)
 
 void srslte_bit_pack_vector(uint8_t* unpacked, uint8_t* packed, int nof_bits)
 {
-  uint32_t i, nbytes;
+  uint32_t i = 0, nbytes;
   nbytes = nof_bits / 8;
 
+  // The bytes of every group of 8 are reversed, so the first one is the MSB of the mask
+#ifdef LV_HAVE_AVX512
+  const __m512i reverse512 = _mm512_set_epi64(0x08090a0b0c0d0e0f,
+                                              0x0001020304050607,
+                                              0x08090a0b0c0d0e0f,
+                                              0x0001020304050607,
+                                              0x08090a0b0c0d0e0f,
+                                              0x0001020304050607,
+                                              0x08090a0b0c0d0e0f,
+                                              0x0001020304050607);
+  for (; i + 8 <= nbytes; i += 8) {
+    __m512i  v = _mm512_shuffle_epi8(_mm512_loadu_si512((__m512i*)unpacked), reverse512);
+    uint64_t m = (uint64_t)_mm512_cmpgt_epi8_mask(v, _mm512_setzero_si512());
+    memcpy(&packed[i], &m, sizeof(m));
+    unpacked += 64;
+  }
+#endif /* LV_HAVE_AVX512 */
+
+#ifdef LV_HAVE_AVX2
+  const __m256i reverse256 =
+      _mm256_set_epi64x(0x08090a0b0c0d0e0f, 0x0001020304050607, 0x08090a0b0c0d0e0f, 0x0001020304050607);
+  for (; i + 4 <= nbytes; i += 4) {
+    __m256i  v = _mm256_shuffle_epi8(_mm256_loadu_si256((__m256i*)unpacked), reverse256);
+    uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(v, _mm256_setzero_si256()));
+    memcpy(&packed[i], &m, sizeof(m));
+    unpacked += 32;
+  }
+#endif /* LV_HAVE_AVX2 */
+
 #ifdef LV_HAVE_SSE
-  for (i = 0; i < nbytes; i++) {
+  const __m128i reverse128 = _mm_set_epi64x(0x08090a0b0c0d0e0f, 0x0001020304050607);
+  for (; i + 2 <= nbytes; i += 2) {
+    __m128i  v = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)unpacked), reverse128);
+    uint16_t m = (uint16_t)_mm_movemask_epi8(_mm_cmpgt_epi8(v, _mm_setzero_si128()));
+    memcpy(&packed[i], &m, sizeof(m));
+    unpacked += 16;
+  }
+
+  for (; i < nbytes; i++) {
     // Get 8 Bit
     __m64 mask = _mm_cmpgt_pi8(*((__m64*)unpacked), _mm_set1_pi8(0));
     unpacked += 8;
@@ -754,7 +872,7 @@ void srslte_bit_pack_vector(uint8_t* unpacked, uint8_t* packed, int nof_bits)
     packed[i] = (uint8_t)_mm_movemask_pi8(mask);
   }
 #else  /* LV_HAVE_SSE */
-  for (i = 0; i < nbytes; i++) {
+  for (; i < nbytes; i++) {
     packed[i] = srslte_bit_pack(&unpacked, 8);
   }
 #endif /* LV_HAVE_SSE */
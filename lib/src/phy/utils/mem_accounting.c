@@ -0,0 +1,102 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include "srslte/phy/utils/mem_accounting.h"
+#include "srslte/phy/utils/vector.h"
+
+/* The size and the tag of an allocation are kept in front of it. The header is as large as the largest SIMD
+ * alignment, so the memory given to the caller keeps the alignment of srslte_vec_malloc() */
+#define MEM_HEADER_SIZE (64)
+
+typedef struct {
+  size_t           size;
+  srslte_mem_tag_t tag;
+} mem_header_t;
+
+static srslte_mem_usage_t mem_usage[SRSLTE_MEM_TAG_NOF_TAGS];
+
+static const char* mem_tag_names[SRSLTE_MEM_TAG_NOF_TAGS] = {"softbuffer", "sequence", "buffer_pool"};
+
+const char* srslte_mem_tag_string(srslte_mem_tag_t tag)
+{
+  return (tag < SRSLTE_MEM_TAG_NOF_TAGS) ? mem_tag_names[tag] : "invalid";
+}
+
+void srslte_mem_account(srslte_mem_tag_t tag, int64_t bytes, int64_t objects)
+{
+  if (tag < SRSLTE_MEM_TAG_NOF_TAGS) {
+    __atomic_fetch_add(&mem_usage[tag].bytes, bytes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&mem_usage[tag].objects, objects, __ATOMIC_RELAXED);
+  }
+}
+
+srslte_mem_usage_t srslte_mem_get_usage(srslte_mem_tag_t tag)
+{
+  srslte_mem_usage_t ret = {};
+  if (tag < SRSLTE_MEM_TAG_NOF_TAGS) {
+    ret.bytes   = __atomic_load_n(&mem_usage[tag].bytes, __ATOMIC_RELAXED);
+    ret.objects = __atomic_load_n(&mem_usage[tag].objects, __ATOMIC_RELAXED);
+  }
+  return ret;
+}
+
+void* srslte_mem_malloc(srslte_mem_tag_t tag, size_t size)
+{
+  if (size > UINT32_MAX - MEM_HEADER_SIZE) {
+    return NULL;
+  }
+  uint8_t* ptr = srslte_vec_malloc((uint32_t)(size + MEM_HEADER_SIZE));
+  if (ptr == NULL) {
+    return NULL;
+  }
+
+  mem_header_t* h = (mem_header_t*)ptr;
+  h->size         = size;
+  h->tag          = tag;
+  srslte_mem_account(tag, (int64_t)size, 1);
+
+  return ptr + MEM_HEADER_SIZE;
+}
+
+void srslte_mem_free(void* ptr)
+{
+  if (ptr == NULL) {
+    return;
+  }
+  mem_header_t* h = (mem_header_t*)((uint8_t*)ptr - MEM_HEADER_SIZE);
+  srslte_mem_account(h->tag, -(int64_t)h->size, -1);
+  free(h);
+}
+
+void srslte_mem_fprint(FILE* stream)
+{
+  for (uint32_t i = 0; i < SRSLTE_MEM_TAG_NOF_TAGS; i++) {
+    srslte_mem_usage_t u = srslte_mem_get_usage((srslte_mem_tag_t)i);
+    fprintf(stream,
+            "%-12s %10.1f KiB in %" PRId64 " objects\n",
+            srslte_mem_tag_string((srslte_mem_tag_t)i),
+            u.bytes / 1024.0,
+            u.objects);
+  }
+}
@@ -0,0 +1,305 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "srslte/phy/utils/debug.h"
+#include "srslte/phy/utils/ringbuffer_spsc.h"
+
+#define RINGBUFFER_SPSC_SPIN_COUNT (4096)
+#define RINGBUFFER_SPSC_POLL_US (20)
+
+/* Maps a memory file of the given capacity twice back to back, so that accesses past the end wrap to the start */
+static uint8_t* ringbuffer_spsc_map(uint32_t capacity)
+{
+  int fd = (int)syscall(SYS_memfd_create, "srslte_ringbuffer", 0);
+  if (fd < 0) {
+    perror("memfd_create");
+    return NULL;
+  }
+
+  uint8_t* ret = NULL;
+  if (ftruncate(fd, capacity) < 0) {
+    perror("ftruncate");
+    goto clean_exit;
+  }
+
+  // Reserve the address range first so that both halves are guaranteed to be adjacent
+  void* base = mmap(NULL, 2 * (size_t)capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    perror("mmap");
+    goto clean_exit;
+  }
+
+  for (uint32_t i = 0; i < 2; i++) {
+    void* p = mmap((uint8_t*)base + i * capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    if (p == MAP_FAILED) {
+      perror("mmap");
+      munmap(base, 2 * (size_t)capacity);
+      goto clean_exit;
+    }
+  }
+  ret = (uint8_t*)base;
+
+clean_exit:
+  close(fd);
+  return ret;
+}
+
+static void ringbuffer_spsc_unmap(srslte_ringbuffer_spsc_t* q)
+{
+  if (q->buffer) {
+    munmap(q->buffer, 2 * (size_t)q->capacity);
+    q->buffer = NULL;
+  }
+}
+
+int srslte_ringbuffer_spsc_init(srslte_ringbuffer_spsc_t* q, int capacity)
+{
+  if (q == NULL || capacity <= 0) {
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  // The mirrored mapping only works with whole pages
+  uint32_t page_sz = (uint32_t)sysconf(_SC_PAGESIZE);
+  uint32_t size    = (((uint32_t)capacity + page_sz - 1) / page_sz) * page_sz;
+
+  q->buffer = ringbuffer_spsc_map(size);
+  if (!q->buffer) {
+    return SRSLTE_ERROR;
+  }
+  q->capacity = size;
+  q->active   = true;
+  srslte_ringbuffer_spsc_reset(q);
+
+  return SRSLTE_SUCCESS;
+}
+
+void srslte_ringbuffer_spsc_free(srslte_ringbuffer_spsc_t* q)
+{
+  if (q) {
+    srslte_ringbuffer_spsc_stop(q);
+    ringbuffer_spsc_unmap(q);
+    q->capacity = 0;
+  }
+}
+
+void srslte_ringbuffer_spsc_reset(srslte_ringbuffer_spsc_t* q)
+{
+  // Check first if it is initiated
+  if (q->capacity != 0) {
+    __atomic_store_n(&q->wpm, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&q->rpm, 0, __ATOMIC_RELEASE);
+  }
+}
+
+int srslte_ringbuffer_spsc_resize(srslte_ringbuffer_spsc_t* q, int capacity)
+{
+  ringbuffer_spsc_unmap(q);
+  q->capacity = 0;
+  return srslte_ringbuffer_spsc_init(q, capacity);
+}
+
+int srslte_ringbuffer_spsc_status(srslte_ringbuffer_spsc_t* q)
+{
+  // Load the read index first, it can only grow up to the write index
+  uint64_t rpm = __atomic_load_n(&q->rpm, __ATOMIC_ACQUIRE);
+  uint64_t wpm = __atomic_load_n(&q->wpm, __ATOMIC_ACQUIRE);
+  return (int)(wpm - rpm);
+}
+
+int srslte_ringbuffer_spsc_space(srslte_ringbuffer_spsc_t* q)
+{
+  return (int)q->capacity - srslte_ringbuffer_spsc_status(q);
+}
+
+/* Waits until nof_bytes can be written (or read). Returns SRSLTE_SUCCESS when they can, SRSLTE_ERROR_TIMEOUT if they
+ * could not within timeout_ms and SRSLTE_ERROR if the buffer was stopped. A negative timeout waits forever. */
+static int ringbuffer_spsc_wait(srslte_ringbuffer_spsc_t* q, bool write, int nof_bytes, int32_t timeout_ms)
+{
+  struct timespec deadline = {};
+  uint32_t        count    = 0;
+
+  if (timeout_ms > 0) {
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    long nsec = deadline.tv_nsec + (timeout_ms % 1000L) * 1000000L;
+    deadline.tv_sec += timeout_ms / 1000L + nsec / 1000000000L;
+    deadline.tv_nsec = nsec % 1000000000L;
+  }
+
+  while (true) {
+    int available = write ? srslte_ringbuffer_spsc_space(q) : srslte_ringbuffer_spsc_status(q);
+    if (available >= nof_bytes) {
+      return SRSLTE_SUCCESS;
+    }
+    if (!__atomic_load_n(&q->active, __ATOMIC_ACQUIRE)) {
+      return SRSLTE_ERROR;
+    }
+    if (timeout_ms == 0) {
+      return SRSLTE_ERROR_TIMEOUT;
+    }
+
+    // Spin for a little while before falling back to sleep
+    if (count++ < RINGBUFFER_SPSC_SPIN_COUNT) {
+      continue;
+    }
+    if (timeout_ms > 0) {
+      struct timespec now = {};
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      if (now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec)) {
+        return SRSLTE_ERROR_TIMEOUT;
+      }
+    }
+    usleep(RINGBUFFER_SPSC_POLL_US);
+  }
+}
+
+static int ringbuffer_spsc_write(srslte_ringbuffer_spsc_t* q, void* p, int nof_bytes, int32_t timeout_ms)
+{
+  if (q == NULL || q->buffer == NULL || nof_bytes < 0) {
+    ERROR("Invalid inputs\n");
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  int w_bytes = nof_bytes;
+  if (timeout_ms == 0) {
+    int space = srslte_ringbuffer_spsc_space(q);
+    if (w_bytes > space) {
+      w_bytes = space;
+      ERROR("Buffer overrun: lost %d bytes\n", nof_bytes - w_bytes);
+    }
+  } else {
+    if (nof_bytes > (int)q->capacity) {
+      ERROR("Writing %d bytes exceeds the capacity of %d bytes\n", nof_bytes, q->capacity);
+      return SRSLTE_ERROR_INVALID_INPUTS;
+    }
+    int ret = ringbuffer_spsc_wait(q, true, nof_bytes, timeout_ms);
+    if (ret == SRSLTE_ERROR) {
+      return SRSLTE_SUCCESS;
+    } else if (ret < SRSLTE_SUCCESS) {
+      return ret;
+    }
+  }
+
+  uint64_t wpm = __atomic_load_n(&q->wpm, __ATOMIC_RELAXED);
+  memcpy(&q->buffer[wpm % q->capacity], p, w_bytes);
+  __atomic_store_n(&q->wpm, wpm + w_bytes, __ATOMIC_RELEASE);
+
+  return w_bytes;
+}
+
+int srslte_ringbuffer_spsc_write(srslte_ringbuffer_spsc_t* q, void* ptr, int nof_bytes)
+{
+  return ringbuffer_spsc_write(q, ptr, nof_bytes, 0);
+}
+
+int srslte_ringbuffer_spsc_write_block(srslte_ringbuffer_spsc_t* q, void* ptr, int nof_bytes)
+{
+  return ringbuffer_spsc_write(q, ptr, nof_bytes, -1);
+}
+
+int srslte_ringbuffer_spsc_write_timed(srslte_ringbuffer_spsc_t* q, void* ptr, int nof_bytes, int32_t timeout_ms)
+{
+  return ringbuffer_spsc_write(q, ptr, nof_bytes, timeout_ms);
+}
+
+int srslte_ringbuffer_spsc_write_reserve(srslte_ringbuffer_spsc_t* q, void** p, int nof_bytes, int32_t timeout_ms)
+{
+  if (q == NULL || q->buffer == NULL || p == NULL || nof_bytes < 0 || nof_bytes > (int)q->capacity) {
+    ERROR("Invalid inputs\n");
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  int ret = ringbuffer_spsc_wait(q, true, nof_bytes, timeout_ms);
+  if (ret == SRSLTE_ERROR) {
+    return SRSLTE_SUCCESS;
+  } else if (ret < SRSLTE_SUCCESS) {
+    return ret;
+  }
+
+  *p = &q->buffer[__atomic_load_n(&q->wpm, __ATOMIC_RELAXED) % q->capacity];
+  return nof_bytes;
+}
+
+void srslte_ringbuffer_spsc_write_commit(srslte_ringbuffer_spsc_t* q, int nof_bytes)
+{
+  __atomic_store_n(&q->wpm, __atomic_load_n(&q->wpm, __ATOMIC_RELAXED) + nof_bytes, __ATOMIC_RELEASE);
+}
+
+int srslte_ringbuffer_spsc_read_reserve(srslte_ringbuffer_spsc_t* q, void** p, int nof_bytes, int32_t timeout_ms)
+{
+  if (q == NULL || q->buffer == NULL || p == NULL || nof_bytes < 0 || nof_bytes > (int)q->capacity) {
+    ERROR("Invalid inputs\n");
+    return SRSLTE_ERROR_INVALID_INPUTS;
+  }
+
+  int ret = ringbuffer_spsc_wait(q, false, nof_bytes, timeout_ms);
+  if (ret == SRSLTE_ERROR) {
+    return SRSLTE_SUCCESS;
+  } else if (ret < SRSLTE_SUCCESS) {
+    return ret;
+  }
+
+  *p = &q->buffer[__atomic_load_n(&q->rpm, __ATOMIC_RELAXED) % q->capacity];
+  return nof_bytes;
+}
+
+void srslte_ringbuffer_spsc_read_commit(srslte_ringbuffer_spsc_t* q, int nof_bytes)
+{
+  __atomic_store_n(&q->rpm, __atomic_load_n(&q->rpm, __ATOMIC_RELAXED) + nof_bytes, __ATOMIC_RELEASE);
+}
+
+int srslte_ringbuffer_spsc_read(srslte_ringbuffer_spsc_t* q, void* p, int nof_bytes)
+{
+  return srslte_ringbuffer_spsc_read_timed(q, p, nof_bytes, -1);
+}
+
+int srslte_ringbuffer_spsc_read_timed(srslte_ringbuffer_spsc_t* q, void* p, int nof_bytes, int32_t timeout_ms)
+{
+  // As in srslte_ringbuffer_t, a zero timeout blocks
+  void* src = NULL;
+  int   n   = srslte_ringbuffer_spsc_read_reserve(q, &src, nof_bytes, timeout_ms == 0 ? -1 : timeout_ms);
+  if (n > 0) {
+    memcpy(p, src, n);
+    srslte_ringbuffer_spsc_read_commit(q, n);
+  }
+  return n;
+}
+
+/* The bytes are released straight away, as in srslte_ringbuffer_t, so the producer may overwrite them. Use
+ * srslte_ringbuffer_spsc_read_reserve() to hold them until they have been processed. */
+int srslte_ringbuffer_spsc_read_block(srslte_ringbuffer_spsc_t* q, void** p, int nof_bytes, int32_t timeout_ms)
+{
+  int n = srslte_ringbuffer_spsc_read_reserve(q, p, nof_bytes, timeout_ms == 0 ? -1 : timeout_ms);
+  if (n > 0) {
+    srslte_ringbuffer_spsc_read_commit(q, n);
+  }
+  return n;
+}
+
+void srslte_ringbuffer_spsc_stop(srslte_ringbuffer_spsc_t* q)
+{
+  __atomic_store_n(&q->active, false, __ATOMIC_RELEASE);
+}
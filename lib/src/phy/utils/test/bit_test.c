@@ -0,0 +1,121 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/test_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "srslte/phy/utils/bit.h"
+#include "srslte/phy/utils/vector.h"
+
+#define MAX_BITS (3 * 6144 + 12)
+
+static uint8_t get_bit(const uint8_t* packed, uint32_t i)
+{
+  return (packed[i / 8] >> (7 - i % 8)) & 1;
+}
+
+// The SIMD paths of the vector functions are checked against a bit by bit reference for all the lengths
+static int test_pack_unpack()
+{
+  uint8_t* unpacked = srslte_vec_u8_malloc(MAX_BITS);
+  uint8_t* unpacked2 = srslte_vec_u8_malloc(MAX_BITS);
+  uint8_t* packed   = srslte_vec_u8_malloc(MAX_BITS / 8 + 1);
+  TESTASSERT(unpacked && unpacked2 && packed);
+
+  for (uint32_t nof_bits = 1; nof_bits < 1100; nof_bits++) {
+    for (uint32_t i = 0; i < nof_bits; i++) {
+      unpacked[i] = rand() & 1;
+    }
+    memset(packed, 0xAA, MAX_BITS / 8 + 1);
+    srslte_bit_pack_vector(unpacked, packed, nof_bits);
+    for (uint32_t i = 0; i < nof_bits; i++) {
+      TESTASSERT(get_bit(packed, i) == unpacked[i]);
+    }
+    // The bits after the last one in its byte are zero
+    for (uint32_t i = nof_bits; i < (nof_bits + 7) / 8 * 8; i++) {
+      TESTASSERT(get_bit(packed, i) == 0);
+    }
+
+    memset(unpacked2, 0xAA, MAX_BITS);
+    srslte_bit_unpack_vector(packed, unpacked2, nof_bits);
+    TESTASSERT(memcmp(unpacked, unpacked2, nof_bits) == 0);
+    TESTASSERT(unpacked2[nof_bits] == 0xAA);
+  }
+
+  free(unpacked);
+  free(unpacked2);
+  free(packed);
+  return SRSLTE_SUCCESS;
+}
+
+static int test_interleaver(uint32_t nof_bits, uint16_t w_offset)
+{
+  uint16_t* perm   = srslte_vec_u16_malloc(nof_bits);
+  uint8_t*  input  = srslte_vec_u8_malloc(nof_bits / 8 + 1);
+  uint8_t*  output = srslte_vec_u8_malloc(nof_bits / 8 + 2);
+  TESTASSERT(perm && input && output);
+
+  // Random permutation
+  for (uint32_t i = 0; i < nof_bits; i++) {
+    perm[i] = (uint16_t)i;
+  }
+  for (uint32_t i = nof_bits - 1; i > 0; i--) {
+    uint32_t j = rand() % (i + 1);
+    uint16_t t = perm[i];
+    perm[i]    = perm[j];
+    perm[j]    = t;
+  }
+  for (uint32_t i = 0; i < nof_bits / 8 + 1; i++) {
+    input[i] = (uint8_t)rand();
+  }
+
+  srslte_bit_interleaver_t q;
+  srslte_bit_interleaver_init(&q, perm, nof_bits);
+  srslte_bit_interleaver_run(&q, input, output, w_offset);
+  for (uint32_t i = 0; i < nof_bits; i++) {
+    TESTASSERT(get_bit(output, i + w_offset) == get_bit(input, perm[i]));
+  }
+  srslte_bit_interleaver_free(&q);
+
+  free(perm);
+  free(input);
+  free(output);
+  return SRSLTE_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  srand(0);
+
+  TESTASSERT(test_pack_unpack() == SRSLTE_SUCCESS);
+
+  // Lengths of the turbo coder and rate matching interleavers, with the offset of the parity bits
+  uint32_t lengths[] = {40, 104, 1008, 6144, 2 * 6144 + 8};
+  for (uint32_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+    TESTASSERT(test_interleaver(lengths[i], 0) == SRSLTE_SUCCESS);
+    TESTASSERT(test_interleaver(lengths[i], 4) == SRSLTE_SUCCESS);
+  }
+
+  printf("Ok\n");
+  return SRSLTE_SUCCESS;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/test_common.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "srslte/phy/common/sequence.h"
+#include "srslte/phy/fec/softbuffer.h"
+#include "srslte/phy/utils/mem_accounting.h"
+#include "srslte/phy/utils/simd.h"
+
+static int test_malloc_free()
+{
+  srslte_mem_usage_t before = srslte_mem_get_usage(SRSLTE_MEM_TAG_SEQUENCE);
+
+  uint8_t* a = srslte_mem_malloc(SRSLTE_MEM_TAG_SEQUENCE, 100);
+  uint8_t* b = srslte_mem_malloc(SRSLTE_MEM_TAG_SEQUENCE, 1000);
+  TESTASSERT(a && b);
+  TESTASSERT(SRSLTE_IS_ALIGNED(a) && SRSLTE_IS_ALIGNED(b));
+
+  srslte_mem_usage_t u = srslte_mem_get_usage(SRSLTE_MEM_TAG_SEQUENCE);
+  TESTASSERT(u.bytes == before.bytes + 1100);
+  TESTASSERT(u.objects == before.objects + 2);
+
+  srslte_mem_free(a);
+  srslte_mem_free(b);
+  srslte_mem_free(NULL);
+  u = srslte_mem_get_usage(SRSLTE_MEM_TAG_SEQUENCE);
+  TESTASSERT(u.bytes == before.bytes && u.objects == before.objects);
+
+  return SRSLTE_SUCCESS;
+}
+
+// The codeblocks of a softbuffer are counted when they are first used and released with the softbuffer
+static int test_softbuffer()
+{
+  srslte_softbuffer_rx_t sb = {};
+  TESTASSERT(srslte_softbuffer_rx_init(&sb, 100) == SRSLTE_SUCCESS);
+  TESTASSERT(srslte_mem_get_usage(SRSLTE_MEM_TAG_SOFTBUFFER).bytes == 0);
+
+  TESTASSERT(srslte_softbuffer_rx_get_cb(&sb, 0) != NULL);
+  TESTASSERT(srslte_softbuffer_rx_get_data(&sb, 0) != NULL);
+  srslte_mem_usage_t u = srslte_mem_get_usage(SRSLTE_MEM_TAG_SOFTBUFFER);
+  TESTASSERT(u.bytes == SOFTBUFFER_SIZE * sizeof(int16_t) + 6144 / 8);
+  TESTASSERT(u.objects == 2);
+
+  srslte_softbuffer_rx_free(&sb);
+  u = srslte_mem_get_usage(SRSLTE_MEM_TAG_SOFTBUFFER);
+  TESTASSERT(u.bytes == 0 && u.objects == 0);
+
+  return SRSLTE_SUCCESS;
+}
+
+static int test_account()
+{
+  srslte_mem_account(SRSLTE_MEM_TAG_BUFFER_POOL, 4096, 16);
+  srslte_mem_usage_t u = srslte_mem_get_usage(SRSLTE_MEM_TAG_BUFFER_POOL);
+  TESTASSERT(u.bytes == 4096 && u.objects == 16);
+  srslte_mem_account(SRSLTE_MEM_TAG_BUFFER_POOL, -4096, -16);
+  u = srslte_mem_get_usage(SRSLTE_MEM_TAG_BUFFER_POOL);
+  TESTASSERT(u.bytes == 0 && u.objects == 0);
+
+  // Tags out of range are ignored
+  srslte_mem_account(SRSLTE_MEM_TAG_NOF_TAGS, 1, 1);
+  u = srslte_mem_get_usage(SRSLTE_MEM_TAG_NOF_TAGS);
+  TESTASSERT(u.bytes == 0 && u.objects == 0);
+
+  return SRSLTE_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  TESTASSERT(test_malloc_free() == SRSLTE_SUCCESS);
+  TESTASSERT(test_softbuffer() == SRSLTE_SUCCESS);
+  TESTASSERT(test_account() == SRSLTE_SUCCESS);
+
+  srslte_mem_fprint(stdout);
+
+  printf("Ok\n");
+  return SRSLTE_SUCCESS;
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/test_common.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "srslte/phy/utils/ringbuffer_spsc.h"
+#include "srslte/phy/utils/vector.h"
+
+int N = 1000;
+int M = 10000;
+
+void usage(char* prog)
+{
+  printf("Usage: %s\n", prog);
+  printf("\t-N maximum size of blocks [Default %d]\n", N);
+  printf("\t-M Number of blocks [Default %d]\n", M);
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "NM")) != -1) {
+    switch (opt) {
+      case 'N':
+        N = (int)strtol(argv[optind], NULL, 10);
+        break;
+      case 'M':
+        M = (int)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+// Byte stream shared by all tests, the value of every byte depends on its position
+static uint8_t stream_byte(uint64_t pos)
+{
+  return (uint8_t)((pos * 7) ^ (pos >> 8));
+}
+
+static int test_read_write(srslte_ringbuffer_spsc_t* q)
+{
+  int      capacity = srslte_ringbuffer_spsc_space(q);
+  int      len      = capacity / 3 + 1;
+  uint8_t* in       = srslte_vec_u8_malloc(len);
+  uint8_t* out      = srslte_vec_u8_malloc(len);
+  TESTASSERT(in && out);
+
+  // Go around the ring several times so that both copies cross the end
+  uint64_t pos = 0;
+  for (int i = 0; i < 10; i++) {
+    for (int j = 0; j < len; j++) {
+      in[j] = stream_byte(pos + j);
+    }
+    TESTASSERT(srslte_ringbuffer_spsc_write(q, in, len) == len);
+    TESTASSERT(srslte_ringbuffer_spsc_status(q) == len);
+    TESTASSERT(srslte_ringbuffer_spsc_read(q, out, len) == len);
+    TESTASSERT(!memcmp(in, out, len));
+    pos += len;
+  }
+  TESTASSERT(srslte_ringbuffer_spsc_status(q) == 0);
+
+  free(in);
+  free(out);
+  return SRSLTE_SUCCESS;
+}
+
+static int test_overflow_write(srslte_ringbuffer_spsc_t* q)
+{
+  int      capacity = srslte_ringbuffer_spsc_space(q);
+  uint8_t* in       = srslte_vec_u8_malloc(capacity);
+  TESTASSERT(in);
+  bzero(in, capacity);
+
+  // Non-blocking writes are truncated to the free space
+  TESTASSERT(srslte_ringbuffer_spsc_write(q, in, capacity / 2) == capacity / 2);
+  TESTASSERT(srslte_ringbuffer_spsc_write(q, in, capacity) == capacity - capacity / 2);
+  TESTASSERT(srslte_ringbuffer_spsc_space(q) == 0);
+
+  // Timed writes do not write anything
+  TESTASSERT(srslte_ringbuffer_spsc_write_timed(q, in, 1, 10) == SRSLTE_ERROR_TIMEOUT);
+  TESTASSERT(srslte_ringbuffer_spsc_status(q) == capacity);
+
+  srslte_ringbuffer_spsc_reset(q);
+  TESTASSERT(srslte_ringbuffer_spsc_read_timed(q, in, 1, 10) == SRSLTE_ERROR_TIMEOUT);
+
+  free(in);
+  return SRSLTE_SUCCESS;
+}
+
+static int test_reserve_commit(srslte_ringbuffer_spsc_t* q)
+{
+  int capacity = srslte_ringbuffer_spsc_space(q);
+  int len      = capacity / 2 + 3;
+
+  // Move the indexes close to the end so that the next block crosses it
+  void* p = NULL;
+  TESTASSERT(srslte_ringbuffer_spsc_write_reserve(q, &p, capacity - 5, 0) == capacity - 5);
+  srslte_ringbuffer_spsc_write_commit(q, capacity - 5);
+  TESTASSERT(srslte_ringbuffer_spsc_read_reserve(q, &p, capacity - 5, 0) == capacity - 5);
+  srslte_ringbuffer_spsc_read_commit(q, capacity - 5);
+
+  // The reserved region must be contiguous even if it wraps
+  TESTASSERT(srslte_ringbuffer_spsc_write_reserve(q, &p, len, 0) == len);
+  for (int j = 0; j < len; j++) {
+    ((uint8_t*)p)[j] = stream_byte(j);
+  }
+  TESTASSERT(srslte_ringbuffer_spsc_status(q) == 0);
+  srslte_ringbuffer_spsc_write_commit(q, len);
+  TESTASSERT(srslte_ringbuffer_spsc_status(q) == len);
+
+  // There is not enough room for a second block
+  TESTASSERT(srslte_ringbuffer_spsc_write_reserve(q, &p, len, 0) == SRSLTE_ERROR_TIMEOUT);
+
+  TESTASSERT(srslte_ringbuffer_spsc_read_reserve(q, &p, len, 0) == len);
+  for (int j = 0; j < len; j++) {
+    TESTASSERT(((uint8_t*)p)[j] == stream_byte(j));
+  }
+  srslte_ringbuffer_spsc_read_commit(q, len);
+  TESTASSERT(srslte_ringbuffer_spsc_status(q) == 0);
+
+  return SRSLTE_SUCCESS;
+}
+
+typedef struct {
+  srslte_ringbuffer_spsc_t* q;
+  int                       res;
+  bool                      done;
+} thread_args_t;
+
+static void* write_thread(void* args_)
+{
+  thread_args_t* args = (thread_args_t*)args_;
+  uint8_t*       in   = srslte_vec_u8_malloc(N);
+  uint64_t       pos  = 0;
+  unsigned int   seed = 1;
+  for (int i = 0; i < M && in; i++) {
+    int len = 1 + rand_r(&seed) % N;
+    for (int j = 0; j < len; j++) {
+      in[j] = stream_byte(pos + j);
+    }
+    if (srslte_ringbuffer_spsc_write_block(args->q, in, len) != len) {
+      args->res = SRSLTE_ERROR;
+      break;
+    }
+    pos += len;
+  }
+  free(in);
+  __atomic_store_n(&args->done, true, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+static void* read_thread(void* args_)
+{
+  thread_args_t* args = (thread_args_t*)args_;
+  uint64_t       pos  = 0;
+  unsigned int   seed = 2;
+  while (true) {
+    // Read blocks of a different size than the written ones, holding them in the ring while they are checked
+    void* p   = NULL;
+    int   len = 1 + rand_r(&seed) % N;
+    int   n   = srslte_ringbuffer_spsc_read_reserve(args->q, &p, len, 10);
+    if (n == SRSLTE_ERROR_TIMEOUT) {
+      if (!__atomic_load_n(&args->done, __ATOMIC_ACQUIRE)) {
+        continue;
+      }
+      // Drain the last bytes, fewer than requested
+      n = srslte_ringbuffer_spsc_status(args->q);
+      if (n == 0) {
+        break;
+      }
+      srslte_ringbuffer_spsc_read_reserve(args->q, &p, n, 0);
+    }
+    for (int j = 0; j < n; j++) {
+      if (((uint8_t*)p)[j] != stream_byte(pos + j)) {
+        args->res = SRSLTE_ERROR;
+      }
+    }
+    srslte_ringbuffer_spsc_read_commit(args->q, n);
+    pos += n;
+  }
+  return NULL;
+}
+
+static int test_threaded(srslte_ringbuffer_spsc_t* q)
+{
+  thread_args_t args = {q, SRSLTE_SUCCESS, false};
+  pthread_t     threads[2];
+
+  TESTASSERT(pthread_create(&threads[0], NULL, write_thread, &args) == 0);
+  TESTASSERT(pthread_create(&threads[1], NULL, read_thread, &args) == 0);
+  for (int i = 0; i < 2; i++) {
+    TESTASSERT(pthread_join(threads[i], NULL) == 0);
+  }
+  TESTASSERT(args.res == SRSLTE_SUCCESS);
+  TESTASSERT(srslte_ringbuffer_spsc_status(q) == 0);
+
+  return SRSLTE_SUCCESS;
+}
+
+static int test_stop(srslte_ringbuffer_spsc_t* q)
+{
+  uint8_t x = 0;
+  srslte_ringbuffer_spsc_stop(q);
+
+  // Blocking calls return straight away without data
+  TESTASSERT(srslte_ringbuffer_spsc_read(q, &x, 1) == 0);
+  TESTASSERT(srslte_ringbuffer_spsc_read_timed(q, &x, 1, 1000) == 0);
+  return SRSLTE_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  srslte_ringbuffer_spsc_t q = {};
+  TESTASSERT(srslte_ringbuffer_spsc_init(&q, N) == SRSLTE_SUCCESS);
+  TESTASSERT(srslte_ringbuffer_spsc_space(&q) >= N);
+
+  TESTASSERT(test_read_write(&q) == SRSLTE_SUCCESS);
+  srslte_ringbuffer_spsc_reset(&q);
+  TESTASSERT(test_overflow_write(&q) == SRSLTE_SUCCESS);
+  srslte_ringbuffer_spsc_reset(&q);
+  TESTASSERT(test_reserve_commit(&q) == SRSLTE_SUCCESS);
+
+  TESTASSERT(srslte_ringbuffer_spsc_resize(&q, 2 * N) == SRSLTE_SUCCESS);
+  TESTASSERT(test_threaded(&q) == SRSLTE_SUCCESS);
+  TESTASSERT(test_stop(&q) == SRSLTE_SUCCESS);
+
+  srslte_ringbuffer_spsc_free(&q);
+  printf("Ok\n");
+  return SRSLTE_SUCCESS;
+}
@@ -290,6 +290,24 @@ TEST(
     free(x);
     free(y);)
 
+TEST(
+    srslte_vec_dot_prod_cfc, MALLOC(cf_t, x); MALLOC(float, y); cf_t z = 0.0f;
+
+    cf_t gold = 0.0f;
+    for (int i = 0; i < block_size; i++) {
+      x[i] = RANDOM_CF();
+      y[i] = RANDOM_F();
+    }
+
+    TEST_CALL(z = srslte_vec_dot_prod_cfc(x, y, block_size))
+
+        for (int i = 0; i < block_size; i++) { gold += x[i] * y[i]; }
+
+    mse = cabsf(gold - z) / cabsf(gold);
+
+    free(x);
+    free(y);)
+
 TEST(
     srslte_vec_dot_prod_conj_ccc, MALLOC(cf_t, x); MALLOC(cf_t, y); cf_t z = 0.0f;
 
@@ -355,6 +373,28 @@ TEST(
     free(z_re);
     free(z_im);)
 
+TEST(
+    srslte_vec_prod_conj_stride_ccc, cf_t* x = srslte_vec_cf_malloc(6 * block_size); MALLOC(cf_t, y); MALLOC(cf_t, z);
+    float power = 0.0f;
+
+    cf_t  gold;
+    float gold_power = 0.0f;
+    for (int i = 0; i < 6 * block_size; i++) { x[i] = RANDOM_CF(); }
+    for (int i = 0; i < block_size; i++) { y[i] = RANDOM_CF(); }
+
+    TEST_CALL(power = srslte_vec_prod_conj_stride_ccc(x, 6, y, z, block_size))
+
+        for (int i = 0; i < block_size; i++) {
+          gold = x[6 * i] * conjf(y[i]);
+          mse += cabsf(gold - z[i]);
+          gold_power += __real__ x[6 * i] * __real__ x[6 * i] + __imag__ x[6 * i] * __imag__ x[6 * i];
+        }
+    mse += fabsf(gold_power - power) / gold_power;
+
+    free(x);
+    free(y);
+    free(z);)
+
 TEST(
     srslte_vec_prod_conj_ccc, MALLOC(cf_t, x); MALLOC(cf_t, y); MALLOC(cf_t, z);
 
@@ -451,6 +491,27 @@ TEST(srslte_vec_convert_if, MALLOC(int16_t, x); MALLOC(float, z); float scale =
      free(x);
      free(z);)
 
+TEST(
+    srslte_vec_convert_cf_cs, MALLOC(cf_t, x); int16_t* y = srslte_vec_i16_malloc(block_size * 2); MALLOC(cf_t, z);
+    float scale = 0.0f;
+
+    // Spread the power over a wide range, the error must stay relative to the block peak
+    float peak = 0.0f;
+    for (int i = 0; i < block_size; i++) {
+      x[i] = cexpf(_Complex_I * 0.1f * i) * 1e-3f * (1 + i % 100);
+      peak = SRSLTE_MAX(peak, SRSLTE_MAX(fabsf(__real__ x[i]), fabsf(__imag__ x[i])));
+    }
+
+    TEST_CALL(scale = srslte_vec_convert_cf_cs(x, y, block_size); srslte_vec_convert_cs_cf(y, scale, z, block_size))
+
+        for (int i = 0; i < block_size; i++) { mse += squared_error(x[i], z[i]) / (peak * peak); }
+
+    mse /= block_size;
+
+    free(x);
+    free(y);
+    free(z);)
+
 TEST(
     srslte_vec_prod_fff, MALLOC(float, x); MALLOC(float, y); MALLOC(float, z);
 
@@ -690,6 +751,38 @@ TEST(
 
     free(x);)
 
+TEST(
+    srslte_vec_gather_cf, MALLOC(cf_t, x); MALLOC(uint32_t, idx); MALLOC(cf_t, z);
+
+    for (int i = 0; i < block_size; i++) {
+      x[i]   = RANDOM_CF();
+      idx[i] = block_size - 1 - i;
+    }
+
+    TEST_CALL(srslte_vec_gather_cf(x, idx, z, block_size))
+
+        for (int i = 0; i < block_size; i++) { mse += cabsf(x[idx[i]] - z[i]); }
+
+    free(x);
+    free(idx);
+    free(z);)
+
+TEST(
+    srslte_vec_scatter_cf, MALLOC(cf_t, x); MALLOC(uint32_t, idx); MALLOC(cf_t, z);
+
+    for (int i = 0; i < block_size; i++) {
+      x[i]   = RANDOM_CF();
+      idx[i] = block_size - 1 - i;
+    }
+
+    TEST_CALL(srslte_vec_scatter_cf(x, idx, z, block_size))
+
+        for (int i = 0; i < block_size; i++) { mse += cabsf(x[i] - z[idx[i]]); }
+
+    free(x);
+    free(idx);
+    free(z);)
+
 TEST(srslte_vec_apply_cfo, MALLOC(cf_t, x); MALLOC(cf_t, z);
 
      const float cfo = 0.1f;
@@ -706,6 +799,35 @@ TEST(srslte_vec_apply_cfo, MALLOC(cf_t, x); MALLOC(cf_t, z);
      free(x);
      free(z);)
 
+TEST(srslte_vec_apply_cfo_multi, MALLOC(cf_t, x0); MALLOC(cf_t, x1); MALLOC(cf_t, z0); MALLOC(cf_t, z1);
+
+     const float cfo = 0.1f;
+     cf_t        gold;
+     cf_t*       x[2];
+     cf_t*       z[2];
+     x[0] = x0;
+     x[1] = x1;
+     z[0] = z0;
+     z[1] = z1;
+     for (int i = 0; i < block_size; i++) {
+       x0[i] = RANDOM_CF();
+       x1[i] = RANDOM_CF();
+     }
+
+     TEST_CALL(srslte_vec_apply_cfo_multi(x, cfo, z, 2, block_size))
+
+         for (int p = 0; p < 2; p++) {
+           for (int i = 0; i < block_size; i++) {
+             gold = x[p][i] * cexpf(_Complex_I * 2.0f * (float)M_PI * i * cfo);
+             mse += cabsf(gold - z[p][i]) / cabsf(gold);
+           }
+         } mse /= 2 * block_size;
+
+     free(x0);
+     free(x1);
+     free(z0);
+     free(z1);)
+
 TEST(
     srslte_vec_gen_sine, MALLOC(cf_t, z);
 
@@ -834,6 +956,10 @@ int main(int argc, char** argv)
         test_srslte_vec_dot_prod_ccc(func_names[func_count], &timmings[func_count][size_count], block_size);
     func_count++;
 
+    passed[func_count][size_count] =
+        test_srslte_vec_dot_prod_cfc(func_names[func_count], &timmings[func_count][size_count], block_size);
+    func_count++;
+
     passed[func_count][size_count] =
         test_srslte_vec_dot_prod_conj_ccc(func_names[func_count], &timmings[func_count][size_count], block_size);
     func_count++;
@@ -850,6 +976,10 @@ int main(int argc, char** argv)
         test_srslte_vec_convert_if(func_names[func_count], &timmings[func_count][size_count], block_size);
     func_count++;
 
+    passed[func_count][size_count] =
+        test_srslte_vec_convert_cf_cs(func_names[func_count], &timmings[func_count][size_count], block_size);
+    func_count++;
+
     passed[func_count][size_count] =
         test_srslte_vec_prod_fff(func_names[func_count], &timmings[func_count][size_count], block_size);
     func_count++;
@@ -870,6 +1000,10 @@ int main(int argc, char** argv)
         test_srslte_vec_prod_conj_ccc(func_names[func_count], &timmings[func_count][size_count], block_size);
     func_count++;
 
+    passed[func_count][size_count] =
+        test_srslte_vec_prod_conj_stride_ccc(func_names[func_count], &timmings[func_count][size_count], block_size);
+    func_count++;
+
     passed[func_count][size_count] =
         test_srslte_vec_sc_prod_ccc(func_names[func_count], &timmings[func_count][size_count], block_size);
     func_count++;
@@ -918,10 +1052,22 @@ int main(int argc, char** argv)
         test_srslte_vec_max_abs_ci(func_names[func_count], &timmings[func_count][size_count], block_size);
     func_count++;
 
+    passed[func_count][size_count] =
+        test_srslte_vec_gather_cf(func_names[func_count], &timmings[func_count][size_count], block_size);
+    func_count++;
+
+    passed[func_count][size_count] =
+        test_srslte_vec_scatter_cf(func_names[func_count], &timmings[func_count][size_count], block_size);
+    func_count++;
+
     passed[func_count][size_count] =
         test_srslte_vec_apply_cfo(func_names[func_count], &timmings[func_count][size_count], block_size);
     func_count++;
 
+    passed[func_count][size_count] =
+        test_srslte_vec_apply_cfo_multi(func_names[func_count], &timmings[func_count][size_count], block_size);
+    func_count++;
+
     passed[func_count][size_count] =
         test_srslte_vec_gen_sine(func_names[func_count], &timmings[func_count][size_count], block_size);
     func_count++;
@@ -955,7 +1101,7 @@ int main(int argc, char** argv)
     pclose(p);
   }
 
-  printf("\n");
+  printf("\nVector kernels: %s\n", srslte_vec_simd_isa());
   printf("%32s |", "Subroutine/MSps");
   if (f)
     fprintf(f, "Subroutine/MSps Vs Vector size\t");
@@ -24,6 +24,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 
 #include "srslte/phy/utils/bit.h"
 #include "srslte/phy/utils/debug.h"
@@ -31,6 +32,75 @@
 #include "srslte/phy/utils/vector.h"
 #include "srslte/phy/utils/vector_simd.h"
 
+#ifdef SRSLTE_SIMD_DISPATCH
+#include "vector_simd_dispatch.h"
+
+/* Kernels compiled for AVX2/FMA and AVX-512, see vector_simd_dispatch.h */
+#define X(f)                                                                                                           \
+  extern __typeof__(f) SRSLTE_VEC_SIMD_CONCAT(f, _avx2);                                                               \
+  extern __typeof__(f) SRSLTE_VEC_SIMD_CONCAT(f, _avx512);
+SRSLTE_VEC_SIMD_FUNCTIONS(X)
+#undef X
+
+/* Kernel table, starts with the baseline build and is updated once at load time */
+static struct {
+#define X(f) __typeof__(f)* f;
+  SRSLTE_VEC_SIMD_FUNCTIONS(X)
+#undef X
+} vec_simd = {
+#define X(f) .f = f,
+    SRSLTE_VEC_SIMD_FUNCTIONS(X)
+#undef X
+};
+
+static const char* vec_simd_isa = "baseline";
+
+__attribute__((constructor)) static void vec_simd_dispatch_init(void)
+{
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512cd") && __builtin_cpu_supports("avx512bw") &&
+      __builtin_cpu_supports("avx512dq")) {
+#define X(f) vec_simd.f = SRSLTE_VEC_SIMD_CONCAT(f, _avx512);
+    SRSLTE_VEC_SIMD_FUNCTIONS(X)
+#undef X
+    vec_simd_isa = "AVX-512";
+  } else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+#define X(f) vec_simd.f = SRSLTE_VEC_SIMD_CONCAT(f, _avx2);
+    SRSLTE_VEC_SIMD_FUNCTIONS(X)
+#undef X
+    vec_simd_isa = "AVX2";
+  }
+}
+
+const char* srslte_vec_simd_isa()
+{
+  return vec_simd_isa;
+}
+
+/* From here on, every kernel call goes through the table */
+#define SRSLTE_VEC_SIMD_RENAME(f) (*vec_simd.f)
+#include "vector_simd_dispatch.h"
+#else /* SRSLTE_SIMD_DISPATCH */
+
+const char* srslte_vec_simd_isa()
+{
+#if defined(LV_HAVE_AVX512)
+  return "AVX-512";
+#elif defined(LV_HAVE_AVX2)
+  return "AVX2";
+#elif defined(LV_HAVE_AVX)
+  return "AVX";
+#elif defined(LV_HAVE_SSE)
+  return "SSE";
+#elif defined(HAVE_NEON)
+  return "NEON";
+#else
+  return "none";
+#endif
+}
+#endif /* SRSLTE_SIMD_DISPATCH */
+
 void srslte_vec_xor_bbb(int8_t* x, int8_t* y, int8_t* z, const uint32_t len)
 {
   srslte_vec_xor_bbb_simd(x, y, z, len);
@@ -123,6 +193,24 @@ void srslte_vec_convert_fb(const float* x, const float scale, int8_t* z, const u
   srslte_vec_convert_fb_simd(x, z, scale, len);
 }
 
+float srslte_vec_convert_cf_cs(const cf_t* x, int16_t* z, const uint32_t len)
+{
+  const float* xf = (const float*)x;
+
+  // Scale the largest component to the full int16 range
+  float max   = (len > 0) ? fabsf(xf[srslte_vec_max_abs_fi(xf, 2 * len)]) : 0.0f;
+  float scale = isnormal(max) ? (float)INT16_MAX / max : 1.0f;
+
+  srslte_vec_convert_fi(xf, scale, z, 2 * len);
+
+  return scale;
+}
+
+void srslte_vec_convert_cs_cf(const int16_t* x, const float scale, cf_t* z, const uint32_t len)
+{
+  srslte_vec_convert_if(x, scale, (float*)z, 2 * len);
+}
+
 void srslte_vec_lut_sss(const short* x, const unsigned short* lut, short* y, const uint32_t len)
 {
   srslte_vec_lut_sss_simd(x, lut, y, len);
@@ -140,9 +228,42 @@ void srslte_vec_lut_sis(const short* x, const unsigned int* lut, short* y, const
   }
 }
 
+#define SRSLTE_VEC_HUGEPAGE_SIZE (2U * 1024U * 1024U)
+
+// Linux 6.1 collapses the pages of a range into hugepages synchronously
+#ifndef MADV_COLLAPSE
+#define MADV_COLLAPSE 25
+#endif
+
+static uint32_t hugepage_threshold = 0;
+
+void srslte_vec_set_hugepage_threshold(uint32_t threshold)
+{
+  hugepage_threshold = threshold;
+}
+
+// The buffer is still released with free(), so it comes from posix_memalign, aligned to the hugepage size
+static void* hugepage_malloc(uint32_t size)
+{
+  size_t len = ((size_t)size + SRSLTE_VEC_HUGEPAGE_SIZE - 1) & ~((size_t)SRSLTE_VEC_HUGEPAGE_SIZE - 1);
+  void*  ptr;
+  if (posix_memalign(&ptr, SRSLTE_VEC_HUGEPAGE_SIZE, len)) {
+    return NULL;
+  }
+  if (madvise(ptr, len, MADV_HUGEPAGE)) {
+    return ptr;
+  }
+  // Pages that are already mapped, e.g. with mlockall(), are only collapsed later by khugepaged otherwise
+  madvise(ptr, len, MADV_COLLAPSE);
+  return ptr;
+}
+
 void* srslte_vec_malloc(uint32_t size)
 {
   void* ptr;
+  if (hugepage_threshold > 0 && size >= hugepage_threshold) {
+    return hugepage_malloc(size);
+  }
   if (posix_memalign(&ptr, SRSLTE_SIMD_BIT_ALIGN, size)) {
     return NULL;
   } else {
@@ -235,8 +356,8 @@ void* srslte_vec_realloc(void* ptr, uint32_t old_size, uint32_t new_size)
 #ifndef LV_HAVE_SSE
   return realloc(ptr, new_size);
 #else
-  void* new_ptr;
-  if (posix_memalign(&new_ptr, SRSLTE_SIMD_BIT_ALIGN, new_size)) {
+  void* new_ptr = srslte_vec_malloc(new_size);
+  if (new_ptr == NULL) {
     return NULL;
   } else {
     memcpy(new_ptr, ptr, old_size);
@@ -442,6 +563,12 @@ void srslte_vec_prod_conj_ccc(const cf_t* x, const cf_t* y, cf_t* z, const uint3
   srslte_vec_prod_conj_ccc_simd(x, y, z, len);
 }
 
+// CHEST DL
+float srslte_vec_prod_conj_stride_ccc(const cf_t* x, const uint32_t stride, const cf_t* y, cf_t* z, const uint32_t len)
+{
+  return srslte_vec_prod_conj_stride_ccc_simd(x, stride, y, z, len);
+}
+
 //#define DIV_USE_VEC
 
 // Used in SSS
@@ -470,12 +597,7 @@ cf_t srslte_vec_dot_prod_ccc(const cf_t* x, const cf_t* y, const uint32_t len)
 // Convolution filter and in SSS search
 cf_t srslte_vec_dot_prod_cfc(const cf_t* x, const float* y, const uint32_t len)
 {
-  uint32_t i;
-  cf_t     res = 0;
-  for (i = 0; i < len; i++) {
-    res += x[i] * y[i];
-  }
-  return res;
+  return srslte_vec_dot_prod_cfc_simd(x, y, len);
 }
 
 // SYNC
@@ -667,6 +789,16 @@ void srslte_vec_interleave_add(const cf_t* x, const cf_t* y, cf_t* z, const int
   srslte_vec_interleave_add_simd(x, y, z, len);
 }
 
+void srslte_vec_gather_cf(const cf_t* x, const uint32_t* idx, cf_t* z, const uint32_t len)
+{
+  srslte_vec_gather_cf_simd(x, idx, z, len);
+}
+
+void srslte_vec_scatter_cf(const cf_t* x, const uint32_t* idx, cf_t* z, const uint32_t len)
+{
+  srslte_vec_scatter_cf_simd(x, idx, z, len);
+}
+
 void srslte_vec_gen_sine(cf_t amplitude, float freq, cf_t* z, int len)
 {
   srslte_vec_gen_sine_simd(amplitude, freq, z, len);
@@ -677,6 +809,11 @@ void srslte_vec_apply_cfo(const cf_t* x, float cfo, cf_t* z, int len)
   srslte_vec_apply_cfo_simd(x, cfo, z, len);
 }
 
+void srslte_vec_apply_cfo_multi(cf_t** x, float cfo, cf_t** z, int nof_ports, int len)
+{
+  srslte_vec_apply_cfo_multi_simd(x, cfo, z, nof_ports, len);
+}
+
 float srslte_vec_estimate_frequency(const cf_t* x, int len)
 {
   return srslte_vec_estimate_frequency_simd(x, len);
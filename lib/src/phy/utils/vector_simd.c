@@ -27,6 +27,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef SRSLTE_VEC_SIMD_SUFFIX
+/* Instruction set variant for runtime dispatch, every kernel gets the suffix appended to its name */
+#define SRSLTE_VEC_SIMD_RENAME(f) SRSLTE_VEC_SIMD_CONCAT(f, SRSLTE_VEC_SIMD_SUFFIX)
+#include "vector_simd_dispatch.h"
+#endif /* SRSLTE_VEC_SIMD_SUFFIX */
+
 #include "srslte/phy/utils/simd.h"
 #include "srslte/phy/utils/vector_simd.h"
 
@@ -407,26 +413,26 @@ void srslte_vec_convert_if_simd(const int16_t* x, float* z, const float scale, c
   int         i    = 0;
   const float gain = 1.0f / scale;
 
-#ifdef LV_HAVE_SSE
-  __m128 s = _mm_set1_ps(gain);
-  if (SRSLTE_IS_ALIGNED(z)) {
-    for (; i < len - 3; i += 4) {
-      __m64* ptr = (__m64*)&x[i];
-      __m128 fl  = _mm_cvtpi16_ps(*ptr);
-      __m128 v   = _mm_mul_ps(fl, s);
+#if SRSLTE_SIMD_F_SIZE && SRSLTE_SIMD_S_SIZE
+  simd_f_t s = srslte_simd_f_set1(gain);
+  if (SRSLTE_IS_ALIGNED(x) && SRSLTE_IS_ALIGNED(z)) {
+    for (; i < len - SRSLTE_SIMD_S_SIZE + 1; i += SRSLTE_SIMD_S_SIZE) {
+      simd_f_t a, b;
+      srslte_simd_convert_s_2f(srslte_simd_s_load(&x[i]), &a, &b);
 
-      _mm_store_ps(&z[i], v);
+      srslte_simd_f_store(&z[i], srslte_simd_f_mul(a, s));
+      srslte_simd_f_store(&z[i + SRSLTE_SIMD_F_SIZE], srslte_simd_f_mul(b, s));
     }
   } else {
-    for (; i < len - 3; i += 4) {
-      __m64* ptr = (__m64*)&x[i];
-      __m128 fl  = _mm_cvtpi16_ps(*ptr);
-      __m128 v   = _mm_mul_ps(fl, s);
+    for (; i < len - SRSLTE_SIMD_S_SIZE + 1; i += SRSLTE_SIMD_S_SIZE) {
+      simd_f_t a, b;
+      srslte_simd_convert_s_2f(srslte_simd_s_loadu(&x[i]), &a, &b);
 
-      _mm_storeu_ps(&z[i], v);
+      srslte_simd_f_storeu(&z[i], srslte_simd_f_mul(a, s));
+      srslte_simd_f_storeu(&z[i + SRSLTE_SIMD_F_SIZE], srslte_simd_f_mul(b, s));
     }
   }
-#endif /* LV_HAVE_SSE */
+#endif /* SRSLTE_SIMD_F_SIZE && SRSLTE_SIMD_S_SIZE */
 
   for (; i < len; i++) {
     z[i] = ((float)x[i]) * gain;
@@ -766,6 +772,51 @@ cf_t srslte_vec_dot_prod_ccc_simd(const cf_t* x, const cf_t* y, const int len)
   return result;
 }
 
+cf_t srslte_vec_dot_prod_cfc_simd(const cf_t* x, const float* y, const int len)
+{
+  int  i      = 0;
+  cf_t result = 0;
+
+#if SRSLTE_SIMD_CF_SIZE
+  if (len >= SRSLTE_SIMD_CF_SIZE) {
+    simd_cf_t avx_result = srslte_simd_cf_zero();
+    if (SRSLTE_IS_ALIGNED(x) && SRSLTE_IS_ALIGNED(y)) {
+      for (; i < len - SRSLTE_SIMD_CF_SIZE + 1; i += SRSLTE_SIMD_CF_SIZE) {
+        simd_cf_t xVal = srslte_simd_cfi_load(&x[i]);
+        simd_f_t  yVal = srslte_simd_f_load(&y[i]);
+
+        avx_result = srslte_simd_cf_add(srslte_simd_cf_mul(xVal, yVal), avx_result);
+      }
+    } else {
+      for (; i < len - SRSLTE_SIMD_CF_SIZE + 1; i += SRSLTE_SIMD_CF_SIZE) {
+        simd_cf_t xVal = srslte_simd_cfi_loadu(&x[i]);
+        simd_f_t  yVal = srslte_simd_f_loadu(&y[i]);
+
+        avx_result = srslte_simd_cf_add(srslte_simd_cf_mul(xVal, yVal), avx_result);
+      }
+    }
+
+    __attribute__((aligned(64))) float simd_dotProdVector[SRSLTE_SIMD_CF_SIZE];
+    simd_f_t                           acc_re = srslte_simd_cf_re(avx_result);
+    simd_f_t                           acc_im = srslte_simd_cf_im(avx_result);
+
+    simd_f_t acc = srslte_simd_f_hadd(acc_re, acc_im);
+    for (int j = 2; j < SRSLTE_SIMD_F_SIZE; j *= 2) {
+      acc = srslte_simd_f_hadd(acc, acc);
+    }
+    srslte_simd_f_store(simd_dotProdVector, acc);
+    __real__ result = simd_dotProdVector[0];
+    __imag__ result = simd_dotProdVector[1];
+  }
+#endif
+
+  for (; i < len; i++) {
+    result += (x[i] * y[i]);
+  }
+
+  return result;
+}
+
 #ifdef ENABLE_C16
 c16_t srslte_vec_dot_prod_ccc_c16i_simd(const c16_t* x, const c16_t* y, const int len)
 {
@@ -782,9 +833,9 @@ c16_t srslte_vec_dot_prod_ccc_c16i_simd(const c16_t* x, const c16_t* y, const in
     avx_result = srslte_simd_c16_add(srslte_simd_c16_prod(xVal, yVal), avx_result);
   }
 
-  __attribute__((aligned(256))) c16_t avx_dotProdVector[16] = {0};
+  __attribute__((aligned(256))) c16_t avx_dotProdVector[SRSLTE_SIMD_C16_SIZE] = {0};
   srslte_simd_c16i_store(avx_dotProdVector, avx_result);
-  for (int k = 0; k < 16; k++) {
+  for (int k = 0; k < SRSLTE_SIMD_C16_SIZE; k++) {
     result += avx_dotProdVector[k];
   }
 #endif
@@ -842,6 +893,42 @@ cf_t srslte_vec_dot_prod_conj_ccc_simd(const cf_t* x, const cf_t* y, const int l
   return result;
 }
 
+float srslte_vec_prod_conj_stride_ccc_simd(const cf_t* x, const int stride, const cf_t* y, cf_t* z, const int len)
+{
+  int   i     = 0;
+  float power = 0.0f;
+
+#if SRSLTE_SIMD_CF_SIZE
+  if (len >= SRSLTE_SIMD_CF_SIZE) {
+    simd_f_t acc = srslte_simd_f_zero();
+    for (; i < len - SRSLTE_SIMD_CF_SIZE + 1; i += SRSLTE_SIMD_CF_SIZE) {
+      simd_cf_t a = srslte_simd_cfi_load_stride(&x[i * stride], stride);
+      simd_cf_t b = srslte_simd_cfi_loadu(&y[i]);
+
+      simd_f_t re = srslte_simd_cf_re(a);
+      simd_f_t im = srslte_simd_cf_im(a);
+      acc         = srslte_simd_f_add(acc, srslte_simd_f_add(srslte_simd_f_mul(re, re), srslte_simd_f_mul(im, im)));
+
+      srslte_simd_cfi_storeu(&z[i], srslte_simd_cf_conjprod(a, b));
+    }
+
+    __attribute__((aligned(64))) float simd_power[SRSLTE_SIMD_F_SIZE];
+    srslte_simd_f_store(simd_power, acc);
+    for (int j = 0; j < SRSLTE_SIMD_F_SIZE; j++) {
+      power += simd_power[j];
+    }
+  }
+#endif
+
+  for (; i < len; i++) {
+    cf_t a = x[i * stride];
+    power += __real__ a * __real__ a + __imag__ a * __imag__ a;
+    z[i] = a * conjf(y[i]);
+  }
+
+  return power;
+}
+
 void srslte_vec_prod_cfc_simd(const cf_t* x, const float* y, cf_t* z, const int len)
 {
   int i = 0;
@@ -1621,6 +1708,44 @@ void srslte_vec_interleave_add_simd(const cf_t* x, const cf_t* y, cf_t* z, const
   }
 }
 
+void srslte_vec_gather_cf_simd(const cf_t* x, const uint32_t* idx, cf_t* z, const int len)
+{
+  int i = 0;
+
+  // Every complex sample is moved as a single 64-bit lane
+#if defined(LV_HAVE_AVX512)
+  for (; i < len - 8 + 1; i += 8) {
+    __m256i vidx = _mm256_loadu_si256((__m256i*)&idx[i]);
+    _mm512_storeu_pd((double*)&z[i], _mm512_i32gather_pd(vidx, (const double*)x, sizeof(cf_t)));
+  }
+#elif defined(LV_HAVE_AVX2)
+  for (; i < len - 4 + 1; i += 4) {
+    __m128i vidx = _mm_loadu_si128((__m128i*)&idx[i]);
+    _mm256_storeu_pd((double*)&z[i], _mm256_i32gather_pd((const double*)x, vidx, sizeof(cf_t)));
+  }
+#endif /* LV_HAVE_AVX512 */
+
+  for (; i < len; i++) {
+    z[i] = x[idx[i]];
+  }
+}
+
+void srslte_vec_scatter_cf_simd(const cf_t* x, const uint32_t* idx, cf_t* z, const int len)
+{
+  int i = 0;
+
+#ifdef LV_HAVE_AVX512
+  for (; i < len - 8 + 1; i += 8) {
+    __m256i vidx = _mm256_loadu_si256((__m256i*)&idx[i]);
+    _mm512_i32scatter_pd((double*)z, vidx, _mm512_loadu_pd((const double*)&x[i]), sizeof(cf_t));
+  }
+#endif /* LV_HAVE_AVX512 */
+
+  for (; i < len; i++) {
+    z[idx[i]] = x[i];
+  }
+}
+
 void srslte_vec_gen_sine_simd(cf_t amplitude, float freq, cf_t* z, int len)
 {
   const float TWOPI = 2.0f * (float)M_PI;
@@ -1667,56 +1792,93 @@ void srslte_vec_gen_sine_simd(cf_t amplitude, float freq, cf_t* z, int len)
   }
 }
 
-void srslte_vec_apply_cfo_simd(const cf_t* x, float cfo, cf_t* z, int len)
+// Number of samples after which the rotating phasor is recomputed from the exact phase, bounding its rounding error
+#define APPLY_CFO_RESYNC_LEN 2048
+
+// Returns exp(j·2·pi·cfo·n), the phase is wrapped in double precision so that it stays exact for long vectors
+static inline cf_t apply_cfo_phasor(float cfo, int n)
 {
-  const float TWOPI = 2.0f * (float)M_PI;
-  int         i     = 0;
+  double phase = (double)cfo * (double)n;
+  phase -= floor(phase);
+  return cexpf(_Complex_I * 2.0f * (float)M_PI * (float)phase);
+}
+
+void srslte_vec_apply_cfo_multi_simd(cf_t** x, float cfo, cf_t** z, int nof_ports, int len)
+{
+  int i = 0;
 
 #if SRSLTE_SIMD_CF_SIZE
-  srslte_simd_aligned cf_t _osc[SRSLTE_SIMD_CF_SIZE];
-  srslte_simd_aligned cf_t _phase[SRSLTE_SIMD_CF_SIZE];
+  if (len >= SRSLTE_SIMD_CF_SIZE) {
+    srslte_simd_aligned cf_t _osc[SRSLTE_SIMD_CF_SIZE];
+    srslte_simd_aligned cf_t _phase[SRSLTE_SIMD_CF_SIZE];
 
-  if (i < len - SRSLTE_SIMD_CF_SIZE + 1) {
-    for (int k = 0; k < SRSLTE_SIMD_CF_SIZE; k++) {
-      _osc[k]   = cexpf(_Complex_I * TWOPI * cfo * SRSLTE_SIMD_CF_SIZE);
-      _phase[k] = cexpf(_Complex_I * TWOPI * cfo * k);
+    bool aligned = true;
+    for (int p = 0; p < nof_ports; p++) {
+      aligned &= SRSLTE_IS_ALIGNED(x[p]) && SRSLTE_IS_ALIGNED(z[p]);
     }
-  }
-  simd_cf_t _simd_osc   = srslte_simd_cfi_load(_osc);
-  simd_cf_t _simd_phase = srslte_simd_cfi_load(_phase);
-
-  if (SRSLTE_IS_ALIGNED(x) && SRSLTE_IS_ALIGNED(z)) {
-    for (; i < len - SRSLTE_SIMD_CF_SIZE + 1; i += SRSLTE_SIMD_CF_SIZE) {
-      simd_cf_t a = srslte_simd_cfi_load(&x[i]);
-
-      simd_cf_t r = srslte_simd_cf_prod(a, _simd_phase);
 
-      srslte_simd_cfi_store(&z[i], r);
-
-      _simd_phase = srslte_simd_cf_prod(_simd_phase, _simd_osc);
+    for (int k = 0; k < SRSLTE_SIMD_CF_SIZE; k++) {
+      _osc[k] = apply_cfo_phasor(cfo, SRSLTE_SIMD_CF_SIZE);
     }
-  } else {
-    for (; i < len - SRSLTE_SIMD_F_SIZE + 1; i += SRSLTE_SIMD_F_SIZE) {
-      for (; i < len - SRSLTE_SIMD_CF_SIZE + 1; i += SRSLTE_SIMD_CF_SIZE) {
-        simd_cf_t a = srslte_simd_cfi_loadu(&x[i]);
+    simd_cf_t _simd_osc = srslte_simd_cfi_load(_osc);
 
-        simd_cf_t r = srslte_simd_cf_prod(a, _simd_phase);
-        _simd_phase = srslte_simd_cf_prod(_simd_phase, _simd_osc);
+    while (i < len - SRSLTE_SIMD_CF_SIZE + 1) {
+      // Restart the phasor from the exact phase every APPLY_CFO_RESYNC_LEN samples
+      for (int k = 0; k < SRSLTE_SIMD_CF_SIZE; k++) {
+        _phase[k] = apply_cfo_phasor(cfo, i + k);
+      }
+      simd_cf_t _simd_phase = srslte_simd_cfi_load(_phase);
 
-        srslte_simd_cfi_storeu(&z[i], r);
+      // The same phasor rotates all the ports
+      int end = i + APPLY_CFO_RESYNC_LEN;
+      if (end > len - SRSLTE_SIMD_CF_SIZE + 1) {
+        end = len - SRSLTE_SIMD_CF_SIZE + 1;
+      }
+      if (aligned) {
+        for (; i < end; i += SRSLTE_SIMD_CF_SIZE) {
+          for (int p = 0; p < nof_ports; p++) {
+            simd_cf_t a = srslte_simd_cfi_load(&x[p][i]);
+            srslte_simd_cfi_store(&z[p][i], srslte_simd_cf_prod(a, _simd_phase));
+          }
+          _simd_phase = srslte_simd_cf_prod(_simd_phase, _simd_osc);
+        }
+      } else {
+        for (; i < end; i += SRSLTE_SIMD_CF_SIZE) {
+          for (int p = 0; p < nof_ports; p++) {
+            simd_cf_t a = srslte_simd_cfi_loadu(&x[p][i]);
+            srslte_simd_cfi_storeu(&z[p][i], srslte_simd_cf_prod(a, _simd_phase));
+          }
+          _simd_phase = srslte_simd_cf_prod(_simd_phase, _simd_osc);
+        }
       }
     }
   }
 #endif
-  cf_t osc   = cexpf(_Complex_I * TWOPI * cfo);
-  cf_t phase = cexpf(_Complex_I * TWOPI * cfo * i);
-  for (; i < len; i++) {
-    z[i] = x[i] * phase;
-
-    phase *= osc;
+  if (i < len) {
+    cf_t osc = apply_cfo_phasor(cfo, 1);
+    while (i < len) {
+      cf_t phase = apply_cfo_phasor(cfo, i);
+      int  end   = i + APPLY_CFO_RESYNC_LEN;
+      if (end > len) {
+        end = len;
+      }
+      for (; i < end; i++) {
+        for (int p = 0; p < nof_ports; p++) {
+          z[p][i] = x[p][i] * phase;
+        }
+        phase *= osc;
+      }
+    }
   }
 }
 
+void srslte_vec_apply_cfo_simd(const cf_t* x, float cfo, cf_t* z, int len)
+{
+  cf_t* x_ptr[1] = {(cf_t*)x};
+  cf_t* z_ptr[1] = {z};
+  srslte_vec_apply_cfo_multi_simd(x_ptr, cfo, z_ptr, 1, len);
+}
+
 float srslte_vec_estimate_frequency_simd(const cf_t* x, int len)
 {
   cf_t sum = 0.0f;
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Runtime dispatch of the vector SIMD kernels.
+ *
+ * When the library is configured with ENABLE_SIMD_DISPATCH, vector_simd.c is compiled once per instruction set: with
+ * the baseline flags of the build and again for AVX2/FMA and AVX-512, defining SRSLTE_VEC_SIMD_SUFFIX to _avx2 and
+ * _avx512 so that every kernel gets a suffixed name. vector.c resolves the best variant for the running CPU once, at
+ * load time, and calls the kernels through a function table.
+ *
+ * The first inclusion defines the list of kernels. Every inclusion with SRSLTE_VEC_SIMD_RENAME(f) defined maps the
+ * kernel names onto it, so the header is intentionally not fully guarded.
+ */
+
+#ifndef SRSLTE_VECTOR_SIMD_DISPATCH_H
+#define SRSLTE_VECTOR_SIMD_DISPATCH_H
+
+#define SRSLTE_VEC_SIMD_CONCAT_(a, b) a##b
+#define SRSLTE_VEC_SIMD_CONCAT(a, b) SRSLTE_VEC_SIMD_CONCAT_(a, b)
+
+#ifdef ENABLE_C16
+#define SRSLTE_VEC_SIMD_FUNCTIONS_C16(X)                                                                               \
+  X(srslte_vec_prod_ccc_c16_simd)                                                                                      \
+  X(srslte_vec_dot_prod_ccc_c16i_simd)
+#else /* ENABLE_C16 */
+#define SRSLTE_VEC_SIMD_FUNCTIONS_C16(X)
+#endif /* ENABLE_C16 */
+
+/* Every kernel declared in vector_simd.h */
+#define SRSLTE_VEC_SIMD_FUNCTIONS(X)                                                                                   \
+  X(srslte_vec_xor_bbb_simd)                                                                                           \
+  X(srslte_vec_sum_sss_simd)                                                                                           \
+  X(srslte_vec_sub_sss_simd)                                                                                           \
+  X(srslte_vec_sub_bbb_simd)                                                                                           \
+  X(srslte_vec_acc_ff_simd)                                                                                            \
+  X(srslte_vec_acc_cc_simd)                                                                                            \
+  X(srslte_vec_add_fff_simd)                                                                                           \
+  X(srslte_vec_sub_fff_simd)                                                                                           \
+  X(srslte_vec_sc_prod_cfc_simd)                                                                                       \
+  X(srslte_vec_sc_prod_fff_simd)                                                                                       \
+  X(srslte_vec_sc_prod_ccc_simd)                                                                                       \
+  X(srslte_vec_sc_prod_ccc_simd2)                                                                                      \
+  X(srslte_vec_prod_ccc_split_simd)                                                                                    \
+  X(srslte_vec_prod_sss_simd)                                                                                          \
+  X(srslte_vec_neg_sss_simd)                                                                                           \
+  X(srslte_vec_neg_bbb_simd)                                                                                           \
+  X(srslte_vec_prod_cfc_simd)                                                                                          \
+  X(srslte_vec_prod_fff_simd)                                                                                          \
+  X(srslte_vec_prod_ccc_simd)                                                                                          \
+  X(srslte_vec_prod_conj_ccc_simd)                                                                                     \
+  X(srslte_vec_prod_conj_stride_ccc_simd)                                                                              \
+  X(srslte_vec_div_ccc_simd)                                                                                           \
+  X(srslte_vec_div_cfc_simd)                                                                                           \
+  X(srslte_vec_div_fff_simd)                                                                                           \
+  X(srslte_vec_dot_prod_conj_ccc_simd)                                                                                 \
+  X(srslte_vec_dot_prod_ccc_simd)                                                                                      \
+  X(srslte_vec_dot_prod_cfc_simd)                                                                                      \
+  X(srslte_vec_dot_prod_sss_simd)                                                                                      \
+  X(srslte_vec_abs_cf_simd)                                                                                            \
+  X(srslte_vec_abs_square_cf_simd)                                                                                     \
+  X(srslte_vec_lut_sss_simd)                                                                                           \
+  X(srslte_vec_lut_bbb_simd)                                                                                           \
+  X(srslte_vec_convert_if_simd)                                                                                        \
+  X(srslte_vec_convert_fi_simd)                                                                                        \
+  X(srslte_vec_convert_conj_cs_simd)                                                                                   \
+  X(srslte_vec_convert_fb_simd)                                                                                        \
+  X(srslte_vec_interleave_simd)                                                                                        \
+  X(srslte_vec_interleave_add_simd)                                                                                    \
+  X(srslte_vec_gather_cf_simd)                                                                                         \
+  X(srslte_vec_scatter_cf_simd)                                                                                        \
+  X(srslte_vec_gen_sine_simd)                                                                                          \
+  X(srslte_vec_apply_cfo_simd)                                                                                         \
+  X(srslte_vec_apply_cfo_multi_simd)                                                                                   \
+  X(srslte_vec_estimate_frequency_simd)                                                                                \
+  X(srslte_vec_max_fi_simd)                                                                                            \
+  X(srslte_vec_max_abs_fi_simd)                                                                                        \
+  X(srslte_vec_max_ci_simd)                                                                                            \
+  SRSLTE_VEC_SIMD_FUNCTIONS_C16(X)
+
+#endif // SRSLTE_VECTOR_SIMD_DISPATCH_H
+
+#ifdef SRSLTE_VEC_SIMD_RENAME
+#ifdef ENABLE_C16
+#define srslte_vec_prod_ccc_c16_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_prod_ccc_c16_simd)
+#define srslte_vec_dot_prod_ccc_c16i_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_dot_prod_ccc_c16i_simd)
+#endif /* ENABLE_C16 */
+#define srslte_vec_xor_bbb_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_xor_bbb_simd)
+#define srslte_vec_sum_sss_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_sum_sss_simd)
+#define srslte_vec_sub_sss_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_sub_sss_simd)
+#define srslte_vec_sub_bbb_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_sub_bbb_simd)
+#define srslte_vec_acc_ff_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_acc_ff_simd)
+#define srslte_vec_acc_cc_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_acc_cc_simd)
+#define srslte_vec_add_fff_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_add_fff_simd)
+#define srslte_vec_sub_fff_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_sub_fff_simd)
+#define srslte_vec_sc_prod_cfc_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_sc_prod_cfc_simd)
+#define srslte_vec_sc_prod_fff_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_sc_prod_fff_simd)
+#define srslte_vec_sc_prod_ccc_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_sc_prod_ccc_simd)
+#define srslte_vec_sc_prod_ccc_simd2 SRSLTE_VEC_SIMD_RENAME(srslte_vec_sc_prod_ccc_simd2)
+#define srslte_vec_prod_ccc_split_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_prod_ccc_split_simd)
+#define srslte_vec_prod_sss_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_prod_sss_simd)
+#define srslte_vec_neg_sss_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_neg_sss_simd)
+#define srslte_vec_neg_bbb_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_neg_bbb_simd)
+#define srslte_vec_prod_cfc_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_prod_cfc_simd)
+#define srslte_vec_prod_fff_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_prod_fff_simd)
+#define srslte_vec_prod_ccc_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_prod_ccc_simd)
+#define srslte_vec_prod_conj_ccc_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_prod_conj_ccc_simd)
+#define srslte_vec_prod_conj_stride_ccc_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_prod_conj_stride_ccc_simd)
+#define srslte_vec_div_ccc_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_div_ccc_simd)
+#define srslte_vec_div_cfc_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_div_cfc_simd)
+#define srslte_vec_div_fff_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_div_fff_simd)
+#define srslte_vec_dot_prod_conj_ccc_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_dot_prod_conj_ccc_simd)
+#define srslte_vec_dot_prod_ccc_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_dot_prod_ccc_simd)
+#define srslte_vec_dot_prod_cfc_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_dot_prod_cfc_simd)
+#define srslte_vec_dot_prod_sss_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_dot_prod_sss_simd)
+#define srslte_vec_abs_cf_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_abs_cf_simd)
+#define srslte_vec_abs_square_cf_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_abs_square_cf_simd)
+#define srslte_vec_lut_sss_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_lut_sss_simd)
+#define srslte_vec_lut_bbb_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_lut_bbb_simd)
+#define srslte_vec_convert_if_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_convert_if_simd)
+#define srslte_vec_convert_fi_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_convert_fi_simd)
+#define srslte_vec_convert_conj_cs_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_convert_conj_cs_simd)
+#define srslte_vec_convert_fb_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_convert_fb_simd)
+#define srslte_vec_interleave_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_interleave_simd)
+#define srslte_vec_interleave_add_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_interleave_add_simd)
+#define srslte_vec_gather_cf_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_gather_cf_simd)
+#define srslte_vec_scatter_cf_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_scatter_cf_simd)
+#define srslte_vec_gen_sine_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_gen_sine_simd)
+#define srslte_vec_apply_cfo_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_apply_cfo_simd)
+#define srslte_vec_apply_cfo_multi_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_apply_cfo_multi_simd)
+#define srslte_vec_estimate_frequency_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_estimate_frequency_simd)
+#define srslte_vec_max_fi_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_max_fi_simd)
+#define srslte_vec_max_abs_fi_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_max_abs_fi_simd)
+#define srslte_vec_max_ci_simd SRSLTE_VEC_SIMD_RENAME(srslte_vec_max_ci_simd)
+#endif /* SRSLTE_VEC_SIMD_RENAME */
@@ -21,6 +21,7 @@
 
 #include "srslte/radio/radio.h"
 #include "srslte/common/string_helpers.h"
+#include "srslte/common/threads.h"
 #include "srslte/config.h"
 #include <list>
 #include <string>
@@ -28,35 +29,60 @@
 
 namespace srslte {
 
+/**
+ * Reduces the ratio between two sampling rates to out / in = interp / decim, rounding the rates to Hz.
+ * @return true if the ratio is not an integer or the inverse of an integer
+ */
+static bool rational_ratio(double out_srate, double in_srate, uint32_t& interp, uint32_t& decim)
+{
+  uint64_t a = (uint64_t)round(out_srate);
+  uint64_t b = (uint64_t)round(in_srate);
+  if (a == 0 or b == 0) {
+    return false;
+  }
+
+  uint64_t x = a;
+  uint64_t y = b;
+  while (y != 0) {
+    uint64_t t = y;
+    y          = x % y;
+    x          = t;
+  }
+
+  interp = (uint32_t)(a / x);
+  decim  = (uint32_t)(b / x);
+  return interp != 1 and decim != 1;
+}
+
 radio::radio(srslte::log_filter* log_h_) : logger(nullptr), log_h(log_h_), zeros(nullptr)
 {
   zeros = srslte_vec_cf_malloc(SRSLTE_SF_LEN_MAX);
   srslte_vec_cf_zero(zeros, SRSLTE_SF_LEN_MAX);
-  for (uint32_t i = 0; i < SRSLTE_MAX_CHANNELS; i++) {
-    dummy_buffers[i] = srslte_vec_cf_malloc(SRSLTE_SF_LEN_MAX * SRSLTE_NOF_SF_X_FRAME);
-    srslte_vec_cf_zero(dummy_buffers[i], SRSLTE_SF_LEN_MAX * SRSLTE_NOF_SF_X_FRAME);
-  }
+  dummy_buffer_len = SRSLTE_SF_LEN_MAX * SRSLTE_NOF_SF_X_FRAME;
 }
 
 radio::radio(srslte::logger* logger_) : logger(logger_), log_h(nullptr), zeros(nullptr)
 {
   zeros = srslte_vec_cf_malloc(SRSLTE_SF_LEN_MAX);
   srslte_vec_cf_zero(zeros, SRSLTE_SF_LEN_MAX);
-  for (uint32_t i = 0; i < SRSLTE_MAX_CHANNELS; i++) {
-    dummy_buffers[i] = srslte_vec_cf_malloc(SRSLTE_SF_LEN_MAX);
-  }
+  dummy_buffer_len = SRSLTE_SF_LEN_MAX;
 }
 
 radio::~radio()
 {
+  tx_async_stop();
+  rx_dev_stop();
+
   if (zeros) {
     free(zeros);
     zeros = nullptr;
   }
 
-  for (uint32_t i = 0; i < SRSLTE_MAX_CHANNELS; i++) {
-    if (dummy_buffers[i]) {
-      free(dummy_buffers[i]);
+  for (std::array<cf_t*, SRSLTE_MAX_CHANNELS>& device_buffers : dummy_buffers) {
+    for (cf_t* b : device_buffers) {
+      if (b) {
+        free(b);
+      }
     }
   }
 
@@ -67,6 +93,14 @@ radio::~radio()
   for (srslte_resampler_fft_t& q : decimators) {
     srslte_resampler_fft_free(&q);
   }
+
+  for (srslte_resample_poly_t& q : poly_interpolators) {
+    srslte_resample_poly_free(&q);
+  }
+
+  for (srslte_resample_poly_t& q : poly_decimators) {
+    srslte_resample_poly_free(&q);
+  }
 }
 
 int radio::init(const rf_args_t& args, phy_interface_radio* phy_)
@@ -105,6 +139,11 @@ int radio::init(const rf_args_t& args, phy_interface_radio* phy_)
   nof_carriers = args.nof_carriers;
   fix_srate_hz = args.srate_hz;
 
+  // Fall back to the default passband if it was not given or it is out of range
+  if (args.srate_passband > 0.0f and args.srate_passband < 1.0f) {
+    srate_passband = args.srate_passband;
+  }
+
   cur_tx_freqs.resize(nof_carriers);
   cur_rx_freqs.resize(nof_carriers);
 
@@ -137,6 +176,17 @@ int radio::init(const rf_args_t& args, phy_interface_radio* phy_)
   rf_info.resize(device_args_list.size());
   rx_offset_n.resize(device_args_list.size());
 
+  // Every device discards its unallocated channels in its own buffers, as they may be receiving at the same time
+  dummy_buffers.resize(device_args_list.size());
+  for (std::array<cf_t*, SRSLTE_MAX_CHANNELS>& device_buffers : dummy_buffers) {
+    for (cf_t*& b : device_buffers) {
+      if (b == nullptr) {
+        b = srslte_vec_cf_malloc(dummy_buffer_len);
+        srslte_vec_cf_zero(b, dummy_buffer_len);
+      }
+    }
+  }
+
   tx_channel_mapping.set_config(nof_channels_x_dev, nof_antennas);
   rx_channel_mapping.set_config(nof_channels_x_dev, nof_antennas);
 
@@ -231,6 +281,27 @@ int radio::init(const rf_args_t& args, phy_interface_radio* phy_)
   // Frequency offset
   freq_offset = args.freq_offset;
 
+  // Start the asynchronous transmission with its slots allocated for a subframe of the largest bandwidth
+  tx_async = args.tx_async;
+  if (tx_async) {
+    for (tx_slot_t& slot : tx_slots) {
+      for (uint32_t ch = 0; ch < nof_channels; ch++) {
+        slot.samples[ch].resize(SRSLTE_SF_LEN_MAX);
+      }
+    }
+    tx_async_running = true;
+    tx_async_thread  = std::thread(&radio::tx_async_run, this);
+  }
+
+  // Start a reception thread for every device but the first one, which is served by the caller of rx_now()
+  if (args.rx_dev_threads and rf_devices.size() > 1) {
+    rx_dev_running = true;
+    for (uint32_t device_idx = 1; device_idx < (uint32_t)rf_devices.size(); device_idx++) {
+      rx_dev_done[device_idx] = 0;
+      rx_dev_threads.emplace_back(&radio::rx_dev_run, this, device_idx);
+    }
+  }
+
   return SRSLTE_SUCCESS;
 }
 
@@ -241,12 +312,16 @@ bool radio::is_init()
 
 void radio::stop()
 {
+  // Pending transmissions are dropped, the Tx thread must not access the devices once they are closed
+  tx_async_stop();
+
   // Stop Rx streams as soon as possible to avoid Overflows
   if (radio_is_streaming) {
     for (srslte_rf_t& rf_device : rf_devices) {
       srslte_rf_stop_rx_stream(&rf_device);
     }
   }
+  rx_dev_stop();
   if (zeros) {
     free(zeros);
     zeros = NULL;
@@ -306,32 +381,34 @@ bool radio::rx_now(rf_buffer_interface& buffer, rf_timestamp_interface& rxd_time
   bool                         ret = true;
   rf_buffer_t                  buffer_rx;
   uint32_t                     ratio = SRSLTE_MAX(1, decimators[0].ratio);
+  bool                         poly  = poly_decimators[0].interp != 0;
 
   // If the interpolator have been set, interpolate
   for (uint32_t ch = 0; ch < nof_channels; ch++) {
     // Use rx buffer if decimator is required
-    buffer_rx.set(ch, ratio > 1 ? rx_buffer[ch].data() : buffer.get(ch));
+    buffer_rx.set(ch, (ratio > 1 or poly) ? rx_buffer[ch].data() : buffer.get(ch));
   }
 
-  // Set new buffer size
-  buffer_rx.set_nof_samples(buffer.get_nof_samples() * ratio);
+  // Set new buffer size, the polyphase decimator needs as many samples as its phase requires
+  if (poly) {
+    buffer_rx.set_nof_samples(srslte_resample_poly_nof_input(&poly_decimators[0], buffer.get_nof_samples()));
+  } else {
+    buffer_rx.set_nof_samples(buffer.get_nof_samples() * ratio);
+  }
 
-  if (not radio_is_streaming) {
-    for (srslte_rf_t& rf_device : rf_devices) {
-      srslte_rf_start_rx_stream(&rf_device, false);
-    }
-    radio_is_streaming = true;
+  rx_start_streaming();
 
-    // Flush buffers to compensate settling time
-    if (rf_devices.size() > 1) {
-      for (srslte_rf_t& rf_device : rf_devices) {
-        srslte_rf_flush_buffer(&rf_device);
-      }
+  if (rx_dev_threads.empty()) {
+    for (uint32_t device_idx = 0; device_idx < (uint32_t)rf_devices.size(); device_idx++) {
+      ret &= rx_dev(device_idx, buffer_rx, rxd_time.get_ptr(device_idx));
     }
+  } else {
+    ret = rx_dev_join(buffer_rx, rxd_time);
   }
 
-  for (uint32_t device_idx = 0; device_idx < (uint32_t)rf_devices.size(); device_idx++) {
-    ret &= rx_dev(device_idx, buffer_rx, rxd_time.get_ptr(device_idx));
+  // The end of the reception is the best estimate of the current radio time for the Tx lead time
+  if (ret and std::isnormal(cur_rx_srate)) {
+    rx_time_end = srslte_timestamp_real(&rxd_time.get(0)) + buffer_rx.get_nof_samples() / cur_rx_srate;
   }
 
   // Perform decimation
@@ -341,12 +418,76 @@ bool radio::rx_now(rf_buffer_interface& buffer, rf_timestamp_interface& rxd_time
         srslte_resampler_fft_run(&decimators[ch], buffer_rx.get(ch), buffer.get(ch), buffer_rx.get_nof_samples());
       }
     }
+  } else if (poly) {
+    for (uint32_t ch = 0; ch < nof_channels; ch++) {
+      if (buffer.get(ch) and buffer_rx.get(ch)) {
+        srslte_resample_poly_run(&poly_decimators[ch], buffer_rx.get(ch), buffer.get(ch), buffer_rx.get_nof_samples());
+      }
+    }
+  }
+
+  return ret;
+}
+
+bool radio::rx_now_s(int16_t* buffer[SRSLTE_MAX_CHANNELS], uint32_t nof_samples, rf_timestamp_interface& rxd_time)
+{
+  std::unique_lock<std::mutex> lock(rx_mutex);
+  rf_buffer_t                  buffer_rx;
+
+  if (not has_rx_s()) {
+    log_h->error("The radio cannot receive int16 samples in its current configuration\n");
+    return false;
+  }
+
+  // The pointers are only used to map the logical channels, the device writes int16 samples into them
+  for (uint32_t ch = 0; ch < nof_channels; ch++) {
+    buffer_rx.set(ch, (cf_t*)buffer[ch]);
+  }
+  buffer_rx.set_nof_samples(nof_samples);
+
+  rx_start_streaming();
+
+  bool ret = rx_dev(0, buffer_rx, rxd_time.get_ptr(0), true);
+
+  // The end of the reception is the best estimate of the current radio time for the Tx lead time
+  if (ret and std::isnormal(cur_rx_srate)) {
+    rx_time_end = srslte_timestamp_real(&rxd_time.get(0)) + nof_samples / cur_rx_srate;
   }
 
   return ret;
 }
 
-bool radio::rx_dev(const uint32_t& device_idx, const rf_buffer_interface& buffer, srslte_timestamp_t* rxd_time)
+bool radio::has_rx_s()
+{
+  // The resamplers and the reception from several devices work on float samples
+  return is_initialized and rf_devices.size() == 1 and decimators[0].ratio <= 1 and
+         poly_decimators[0].interp == 0 and srslte_rf_has_recv_s(&rf_devices[0]);
+}
+
+void radio::rx_start_streaming()
+{
+  if (radio_is_streaming) {
+    return;
+  }
+
+  for (srslte_rf_t& rf_device : rf_devices) {
+    srslte_rf_start_rx_stream(&rf_device, false);
+  }
+  radio_is_streaming = true;
+  rx_dev_aligned     = false;
+
+  // Flush buffers to compensate settling time
+  if (rf_devices.size() > 1) {
+    for (srslte_rf_t& rf_device : rf_devices) {
+      srslte_rf_flush_buffer(&rf_device);
+    }
+  }
+}
+
+bool radio::rx_dev(const uint32_t&            device_idx,
+                   const rf_buffer_interface& buffer,
+                   srslte_timestamp_t*        rxd_time,
+                   bool                       int16)
 {
   if (!is_initialized) {
     return false;
@@ -359,7 +500,7 @@ bool radio::rx_dev(const uint32_t& device_idx, const rf_buffer_interface& buffer
 
   // Discard channels not allocated, need to point to valid buffer
   for (uint32_t i = 0; i < SRSLTE_MAX_CHANNELS; i++) {
-    radio_buffers[i] = dummy_buffers[i];
+    radio_buffers[i] = dummy_buffers.at(device_idx)[i];
   }
 
   if (not map_channels(rx_channel_mapping, device_idx, 0, buffer, radio_buffers)) {
@@ -383,8 +524,14 @@ bool radio::rx_dev(const uint32_t& device_idx, const rf_buffer_interface& buffer
   // Subtract number of offset samples
   rx_offset_n.at(device_idx) = nof_samples_offset - ((int)nof_samples - (int)buffer.get_nof_samples());
 
-  int ret =
-      srslte_rf_recv_with_time_multi(&rf_devices[device_idx], radio_buffers, nof_samples, true, full_secs, frac_secs);
+  int ret = 0;
+  if (int16) {
+    ret = srslte_rf_recv_with_time_multi_s(
+        &rf_devices[device_idx], (int16_t**)radio_buffers, nof_samples, true, full_secs, frac_secs);
+  } else {
+    ret =
+        srslte_rf_recv_with_time_multi(&rf_devices[device_idx], radio_buffers, nof_samples, true, full_secs, frac_secs);
+  }
 
   // If the number of received samples filled the buffer, there is nothing else to do
   if (buffer.get_nof_samples() <= nof_samples) {
@@ -394,7 +541,10 @@ bool radio::rx_dev(const uint32_t& device_idx, const rf_buffer_interface& buffer
   // Otherwise, set rest of buffer to zero
   uint32_t nof_zeros = buffer.get_nof_samples() - nof_samples;
   for (auto& b : radio_buffers) {
-    if (b != nullptr) {
+    if (b != nullptr and int16) {
+      int16_t* ptr = (int16_t*)b;
+      srslte_vec_i16_zero(&ptr[2 * nof_samples], 2 * nof_zeros);
+    } else if (b != nullptr) {
       cf_t* ptr = (cf_t*)b;
       srslte_vec_cf_zero(&ptr[nof_samples], nof_zeros);
     }
@@ -403,11 +553,125 @@ bool radio::rx_dev(const uint32_t& device_idx, const rf_buffer_interface& buffer
   return ret > 0;
 }
 
+bool radio::rx_dev_join(const rf_buffer_interface& buffer, rf_timestamp_interface& rxd_time)
+{
+  uint32_t req = 0;
+  {
+    std::unique_lock<std::mutex> lock(rx_dev_mutex);
+    rx_dev_buffer = &buffer;
+    rx_dev_time   = &rxd_time;
+    req           = ++rx_dev_req;
+    rx_dev_cvar.notify_all();
+  }
+
+  bool ret = rx_dev(0, buffer, rxd_time.get_ptr(0));
+
+  // The other devices were receiving meanwhile, so they are usually done by now
+  for (uint32_t device_idx = 1; device_idx < (uint32_t)rf_devices.size(); device_idx++) {
+    while (rx_dev_done[device_idx].load(std::memory_order_acquire) != req) {
+      if (not rx_dev_running) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    ret &= rx_dev_ret[device_idx];
+  }
+
+  if (ret and not rx_dev_aligned) {
+    rx_dev_align(rxd_time, buffer.get_nof_samples());
+    rx_dev_aligned = true;
+  }
+
+  return ret;
+}
+
+void radio::rx_dev_align(const rf_timestamp_interface& rxd_time, uint32_t nof_samples)
+{
+  if (not std::isnormal(cur_rx_srate)) {
+    return;
+  }
+
+  for (uint32_t device_idx = 1; device_idx < (uint32_t)rf_devices.size(); device_idx++) {
+    srslte_timestamp_t diff = rxd_time.get(device_idx);
+    srslte_timestamp_sub(&diff, rxd_time.get(0).full_secs, rxd_time.get(0).frac_secs);
+    int32_t offset = (int32_t)round(srslte_timestamp_real(&diff) * cur_rx_srate);
+
+    if (offset == 0) {
+      continue;
+    }
+    if ((uint32_t)abs(offset) >= nof_samples) {
+      log_h->warning("RF device %d is %.1f ms away from device 0, are they sharing a time reference?\n",
+                     device_idx,
+                     srslte_timestamp_real(&diff) * 1e3);
+      continue;
+    }
+
+    // A device ahead of the first one receives fewer samples in the next call, and the other way around
+    log_h->info("Aligning RF device %d, %+d samples from device 0\n", device_idx, offset);
+    rx_offset_n[device_idx] -= offset;
+  }
+}
+
+void radio::rx_dev_run(uint32_t device_idx)
+{
+  std::string name = "RF_RX" + std::to_string(device_idx);
+  pthread_setname_np(pthread_self(), name.c_str());
+  threads_apply_placement(name.c_str());
+
+  uint32_t req = 0;
+  while (true) {
+    const rf_buffer_interface* buffer   = nullptr;
+    rf_timestamp_interface*    rxd_time = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(rx_dev_mutex);
+      while (rx_dev_running and rx_dev_req == req) {
+        rx_dev_cvar.wait(lock);
+      }
+      if (not rx_dev_running) {
+        break;
+      }
+      req      = rx_dev_req;
+      buffer   = rx_dev_buffer;
+      rxd_time = rx_dev_time;
+    }
+
+    rx_dev_ret[device_idx] = rx_dev(device_idx, *buffer, rxd_time->get_ptr(device_idx));
+    rx_dev_done[device_idx].store(req, std::memory_order_release);
+  }
+}
+
+void radio::rx_dev_stop()
+{
+  {
+    std::unique_lock<std::mutex> lock(rx_dev_mutex);
+    rx_dev_running = false;
+    rx_dev_cvar.notify_all();
+  }
+  for (std::thread& t : rx_dev_threads) {
+    if (t.joinable()) {
+      t.join();
+    }
+  }
+  rx_dev_threads.clear();
+}
+
 bool radio::tx(rf_buffer_interface& buffer, const rf_timestamp_interface& tx_time)
 {
-  bool                         ret = true;
   std::unique_lock<std::mutex> lock(tx_mutex);
 
+  if (tx_async) {
+    tx_async_sob = false;
+    return tx_async_push(&buffer, tx_time);
+  }
+
+  tx_lead(tx_time);
+  return tx_now(buffer, tx_time);
+}
+
+bool radio::tx_now(rf_buffer_interface& buffer, const rf_timestamp_interface& tx_time)
+{
+  bool ret = true;
+
   // If the interpolator have been set, interpolate
   if (interpolators[0].ratio > 1) {
     for (uint32_t ch = 0; ch < nof_channels; ch++) {
@@ -420,6 +684,19 @@ bool radio::tx(rf_buffer_interface& buffer, const rf_timestamp_interface& tx_tim
 
     // Set new buffer size
     buffer.set_nof_samples(buffer.get_nof_samples() * interpolators[0].ratio);
+  } else if (poly_interpolators[0].interp != 0) {
+    int nof_samples = 0;
+    for (uint32_t ch = 0; ch < nof_channels; ch++) {
+      // All channels share the same phase, so they produce the same number of samples
+      nof_samples = srslte_resample_poly_run(
+          &poly_interpolators[ch], buffer.get(ch), tx_buffer[ch].data(), buffer.get_nof_samples());
+
+      // Set the buffer pointer
+      buffer.set(ch, tx_buffer[ch].data());
+    }
+
+    // Set new buffer size
+    buffer.set_nof_samples(SRSLTE_MAX(0, nof_samples));
   }
 
   for (uint32_t device_idx = 0; device_idx < (uint32_t)rf_devices.size(); device_idx++) {
@@ -512,7 +789,7 @@ bool radio::tx_dev(const uint32_t& device_idx, rf_buffer_interface& buffer, cons
     } else if (past_nsamples < 0) {
       // if the gap is bigger than TX_MAX_GAP_ZEROS, stop burst
       if (fabs(srslte_timestamp_real(&ts_overlap)) > tx_max_gap_zeros) {
-        tx_end();
+        tx_end_now();
       } else {
         // Otherwise, transmit zeros
         uint32_t gap_nsamples = abs(past_nsamples);
@@ -569,6 +846,22 @@ void radio::tx_end()
   if (!is_initialized) {
     return;
   }
+
+  std::unique_lock<std::mutex> lock(tx_mutex);
+
+  if (tx_async) {
+    if (!tx_async_sob) {
+      tx_async_sob = true;
+      tx_async_push(nullptr, rf_timestamp_t());
+    }
+    return;
+  }
+
+  tx_end_now();
+}
+
+void radio::tx_end_now()
+{
   if (!is_start_of_burst) {
     for (uint32_t i = 0; i < (uint32_t)rf_devices.size(); i++) {
       srslte_rf_send_timed2(
@@ -580,7 +873,134 @@ void radio::tx_end()
 
 bool radio::get_is_start_of_burst()
 {
-  return is_start_of_burst;
+  // The Tx thread may not have reached the last request yet
+  return tx_async ? tx_async_sob : is_start_of_burst;
+}
+
+double radio::tx_lead(const rf_timestamp_interface& tx_time)
+{
+  double now = rx_time_end;
+  if (now < 0.0) {
+    return INFINITY;
+  }
+
+  double lead    = srslte_timestamp_real(&tx_time.get(0)) - now;
+  float  lead_ms = (float)(lead * 1000.0);
+
+  std::unique_lock<std::mutex> lock(metrics_mutex);
+  tx_lead_sum_ms += lead_ms;
+  tx_lead_count++;
+  tx_lead_min_ms = SRSLTE_MIN(tx_lead_min_ms, lead_ms);
+
+  return lead;
+}
+
+bool radio::tx_async_push(const rf_buffer_interface* buffer, const rf_timestamp_interface& tx_time)
+{
+  std::unique_lock<std::mutex> lock(tx_async_mutex);
+
+  // Wait for a free slot
+  while (tx_async_running and tx_slots_w - tx_slots_r >= tx_async_nof_slots) {
+    tx_async_cvar.wait(lock);
+  }
+  if (not tx_async_running) {
+    return false;
+  }
+
+  // The slot belongs to the producer until the write counter moves past it
+  tx_slot_t& slot = tx_slots[tx_slots_w % tx_async_nof_slots];
+  lock.unlock();
+
+  slot.tx_time.copy(tx_time);
+  slot.end_of_burst = buffer == nullptr;
+  slot.nof_samples  = 0;
+  if (buffer != nullptr) {
+    slot.nof_samples = buffer->get_nof_samples();
+    for (uint32_t ch = 0; ch < nof_channels; ch++) {
+      slot.has_samples[ch] = buffer->get(ch) != nullptr;
+      if (not slot.has_samples[ch]) {
+        continue;
+      }
+      if (slot.samples[ch].size() < slot.nof_samples) {
+        slot.samples[ch].resize(slot.nof_samples);
+      }
+      srslte_vec_cf_copy(slot.samples[ch].data(), buffer->get(ch), slot.nof_samples);
+    }
+  }
+
+  lock.lock();
+  tx_slots_w++;
+  tx_async_cvar.notify_all();
+
+  return true;
+}
+
+void radio::tx_async_flush()
+{
+  std::unique_lock<std::mutex> lock(tx_async_mutex);
+  while (tx_async_running and tx_slots_r != tx_slots_w) {
+    tx_async_cvar.wait(lock);
+  }
+}
+
+void radio::tx_async_run()
+{
+  pthread_setname_np(pthread_self(), "RF_TX");
+  threads_apply_placement("RF_TX");
+
+  rf_buffer_t buffer;
+
+  std::unique_lock<std::mutex> lock(tx_async_mutex);
+  while (true) {
+    while (tx_async_running and tx_slots_r == tx_slots_w) {
+      tx_async_cvar.wait(lock);
+    }
+    if (not tx_async_running) {
+      break;
+    }
+
+    tx_slot_t& slot = tx_slots[tx_slots_r % tx_async_nof_slots];
+    lock.unlock();
+
+    if (slot.end_of_burst) {
+      tx_end_now();
+    } else {
+      // A burst that can not reach the radio in time would be discarded by it anyway. Dropping it here and starting a
+      // new burst keeps the following ones from being delayed behind it.
+      double lead = tx_lead(slot.tx_time);
+      if (lead < 0.0) {
+        log_h->warning("Dropping Tx burst, late by %.1f us\n", -lead * 1e6);
+        {
+          std::unique_lock<std::mutex> metrics_lock(metrics_mutex);
+          rf_metrics.tx_late_drop++;
+          rf_metrics.rf_error = true;
+        }
+        tx_end_now();
+      } else {
+        for (uint32_t ch = 0; ch < nof_channels; ch++) {
+          buffer.set(ch, slot.has_samples[ch] ? slot.samples[ch].data() : nullptr);
+        }
+        buffer.set_nof_samples(slot.nof_samples);
+        tx_now(buffer, slot.tx_time);
+      }
+    }
+
+    lock.lock();
+    tx_slots_r++;
+    tx_async_cvar.notify_all();
+  }
+}
+
+void radio::tx_async_stop()
+{
+  {
+    std::unique_lock<std::mutex> lock(tx_async_mutex);
+    tx_async_running = false;
+    tx_async_cvar.notify_all();
+  }
+  if (tx_async_thread.joinable()) {
+    tx_async_thread.join();
+  }
 }
 
 void radio::release_freq(const uint32_t& carrier_idx)
@@ -665,10 +1085,23 @@ void radio::set_rx_srate(const double& srate)
       }
     }
 
-    // Update decimators
-    uint32_t ratio = (uint32_t)ceil(cur_rx_srate / srate);
+    // Update decimators, non-integer ratios go through the polyphase resampler
+    uint32_t interp = 1;
+    uint32_t decim  = 1;
+    bool     poly   = rational_ratio(srate, cur_rx_srate, interp, decim) and interp < decim;
+    uint32_t ratio  = poly ? 1 : (uint32_t)ceil(cur_rx_srate / srate);
     for (uint32_t ch = 0; ch < nof_channels; ch++) {
       srslte_resampler_fft_init(&decimators[ch], SRSLTE_RESAMPLER_MODE_DECIMATE, ratio);
+      srslte_resample_poly_free(&poly_decimators[ch]);
+      if (poly and srslte_resample_poly_init(&poly_decimators[ch],
+                                             interp,
+                                             decim,
+                                             (uint32_t)rx_buffer[ch].size(),
+                                             srate_passband,
+                                             SRSLTE_RESAMPLE_POLY_DEFAULT_ATTENUATION_DB) != SRSLTE_SUCCESS) {
+        log_h->error("Initialising %d/%d decimator\n", interp, decim);
+        srslte_resample_poly_free(&poly_decimators[ch]);
+      }
     }
 
   } else {
@@ -876,7 +1309,7 @@ double radio::get_dev_cal_tx_adv_sec(const std::string& device_name)
             cur_tx_srate);
         nsamples = blade_default_tx_adv_samples + (int)(blade_default_tx_adv_offset_sec * cur_tx_srate);
       }
-    } else if (device_name == "zmq") {
+    } else if (device_name == "zmq" || device_name == "shm") {
       nsamples = 0;
     }
   } else {
@@ -895,6 +1328,9 @@ void radio::set_tx_srate(const double& srate)
     return;
   }
 
+  // The Tx thread uses the interpolators, wait for it to become idle. No more requests arrive while tx_mutex is held.
+  tx_async_flush();
+
   // If fix sampling rate...
   if (std::isnormal(fix_srate_hz)) {
     // If the sampling rate was not set, set it
@@ -904,10 +1340,23 @@ void radio::set_tx_srate(const double& srate)
       }
     }
 
-    // Update interpolators
-    uint32_t ratio = (uint32_t)ceil(cur_tx_srate / srate);
+    // Update interpolators, non-integer ratios go through the polyphase resampler
+    uint32_t interp = 1;
+    uint32_t decim  = 1;
+    bool     poly   = rational_ratio(cur_tx_srate, srate, interp, decim) and interp > decim;
+    uint32_t ratio  = poly ? 1 : (uint32_t)ceil(cur_tx_srate / srate);
     for (uint32_t ch = 0; ch < nof_channels; ch++) {
       srslte_resampler_fft_init(&interpolators[ch], SRSLTE_RESAMPLER_MODE_INTERPOLATE, ratio);
+      srslte_resample_poly_free(&poly_interpolators[ch]);
+      if (poly and srslte_resample_poly_init(&poly_interpolators[ch],
+                                             interp,
+                                             decim,
+                                             (uint32_t)(tx_buffer[ch].size() * decim / interp),
+                                             srate_passband,
+                                             SRSLTE_RESAMPLE_POLY_DEFAULT_ATTENUATION_DB) != SRSLTE_SUCCESS) {
+        log_h->error("Initialising %d/%d interpolator\n", interp, decim);
+        srslte_resample_poly_free(&poly_interpolators[ch]);
+      }
     }
   } else {
     for (srslte_rf_t& rf_device : rf_devices) {
@@ -934,8 +1383,44 @@ srslte_rf_info_t* radio::get_info()
 
 bool radio::get_metrics(rf_metrics_t* metrics)
 {
-  *metrics   = rf_metrics;
-  rf_metrics = {};
+  std::unique_lock<std::mutex> lock(metrics_mutex);
+  *metrics                = rf_metrics;
+  metrics->tx_lead_min_ms = tx_lead_count ? tx_lead_min_ms : 0.0f;
+  metrics->tx_lead_avg_ms = tx_lead_count ? (float)(tx_lead_sum_ms / tx_lead_count) : 0.0f;
+  rf_metrics              = {};
+  tx_lead_sum_ms          = 0.0;
+  tx_lead_count           = 0;
+  tx_lead_min_ms          = INFINITY;
+  lock.unlock();
+
+  // Merge the telemetry of the devices
+  for (uint32_t device_idx = 0; device_idx < (uint32_t)rf_devices.size(); device_idx++) {
+    srslte_rf_metrics_t dev = {};
+    if (srslte_rf_get_metrics(&rf_devices[device_idx], &dev) != SRSLTE_SUCCESS) {
+      continue;
+    }
+
+    srslte_rf_metrics_t& m = metrics->dev;
+    m.nof_recv += dev.nof_recv;
+    for (uint32_t i = 0; i < SRSLTE_RF_METRICS_NOF_BINS; i++) {
+      m.recv_latency_hist[i] += dev.recv_latency_hist[i];
+      m.rx_delay_hist[i] += dev.rx_delay_hist[i];
+    }
+    m.nof_ts_jumps += dev.nof_ts_jumps;
+    if (llabs(dev.max_ts_jump) > llabs(m.max_ts_jump)) {
+      m.max_ts_jump = dev.max_ts_jump;
+    }
+    m.overflow += dev.overflow;
+    m.rx_late += dev.rx_late;
+    for (uint32_t ch = 0; ch < nof_channels_x_dev; ch++) {
+      uint32_t idx = device_idx * nof_channels_x_dev + ch;
+      if (idx < SRSLTE_RF_METRICS_MAX_CHANNELS) {
+        m.late[idx] += dev.late[ch];
+        m.underflow[idx] += dev.underflow[ch];
+      }
+    }
+  }
+
   return true;
 }
 
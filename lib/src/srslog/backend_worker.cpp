@@ -23,6 +23,8 @@
 #include "formatter.h"
 #include "srslte/srslog/sink.h"
 #include <cassert>
+#include <limits>
+#include <pthread.h>
 
 using namespace srslog;
 
@@ -40,6 +42,8 @@ void backend_worker::create_worker()
   assert(!running_flag && "Only one worker thread should be created");
 
   std::thread t([this]() {
+    // Named so that the application can find it, e.g. for setting its CPU affinity
+    ::pthread_setname_np(::pthread_self(), "SRSLOG");
     running_flag = true;
     do_work();
   });
@@ -63,16 +67,14 @@ void backend_worker::do_work()
   assert(running_flag && "Thread entry function called without running thread");
 
   while (running_flag) {
-    auto item = queue.timed_pop(sleep_period_ms);
-
     // Spin again when the timeout expires.
-    if (!item.first) {
+    if (!queue.timed_pop_batch(batch, max_batch_size, sleep_period_ms)) {
       continue;
     }
 
     report_queue_on_full_once();
 
-    process_log_entry(std::move(item.second));
+    process_log_entries(batch);
   }
 
   // When we reach here, the thread is about to terminate, last chance to
@@ -91,23 +93,48 @@ static void process_flush_command(const detail::flush_backend_cmd& cmd)
   cmd.completion_flag = true;
 }
 
-void backend_worker::process_log_entry(detail::log_entry&& entry)
+void backend_worker::write_pending_buffer()
 {
-  // Check first for flush commands.
-  if (entry.flush_cmd) {
-    process_flush_command(*entry.flush_cmd);
+  if (write_buffer.size() == 0) {
     return;
   }
 
-  // Save sink pointer before moving the entry.
-  sink* s = entry.s;
+  detail::memory_buffer buffer(write_buffer.data(), write_buffer.size());
+  if (auto err_str = write_buffer_sink->write(buffer)) {
+    err_handler(err_str.get_error());
+  }
+  write_buffer.clear();
+}
 
-  std::string result = format_log_entry_to_text(std::move(entry));
-  detail::memory_buffer buffer(result);
+void backend_worker::process_log_entries(
+    std::vector<detail::log_entry>& entries)
+{
+  for (auto& entry : entries) {
+    // Check first for flush commands. Entries pushed by other threads before
+    // the command may still be in the queue, so they are processed first.
+    if (entry.flush_cmd) {
+      std::unique_ptr<detail::flush_backend_cmd> cmd =
+          std::move(entry.flush_cmd);
+      std::vector<detail::log_entry> pending;
+      queue.pop_batch(pending, std::numeric_limits<size_t>::max());
+      write_pending_buffer();
+      process_log_entries(pending);
+      process_flush_command(*cmd);
+      continue;
+    }
 
-  if (auto err_str = s->write(buffer)) {
-    err_handler(err_str.get_error());
+    if (entry.s != write_buffer_sink || write_buffer.size() >= max_write_size) {
+      write_pending_buffer();
+      write_buffer_sink = entry.s;
+    }
+
+    if (!write_buffer_sink->encode(entry, write_buffer)) {
+      format_log_entry_to_text(std::move(entry), write_buffer);
+    }
   }
+  entries.clear();
+
+  write_pending_buffer();
 }
 
 void backend_worker::process_outstanding_entries()
@@ -115,14 +142,7 @@ void backend_worker::process_outstanding_entries()
   assert(!running_flag &&
          "Cannot process outstanding entries while thread is running");
 
-  while (true) {
-    auto item = queue.timed_pop(1);
-
-    // Check if the queue is empty.
-    if (!item.first) {
-      break;
-    }
-
-    process_log_entry(std::move(item.second));
+  while (queue.pop_batch(batch, max_batch_size)) {
+    process_log_entries(batch);
   }
 }
@@ -39,10 +39,19 @@ class backend_worker
   /// periodically.
   static constexpr unsigned sleep_period_ms = 500;
 
+  /// Maximum number of log entries popped from the queue at once.
+  static constexpr size_t max_batch_size = 256;
+
+  /// Formatted entries are accumulated up to this size before writing them to
+  /// their sink in a single call.
+  static constexpr size_t max_write_size = 64 * 1024;
+
 public:
   explicit backend_worker(detail::work_queue<detail::log_entry>& queue) :
     queue(queue), running_flag(false)
-  {}
+  {
+    batch.reserve(max_batch_size);
+  }
 
   backend_worker(const backend_worker&) = delete;
   backend_worker& operator=(const backend_worker&) = delete;
@@ -91,8 +100,12 @@ private:
   /// Entry function used by the secondary thread.
   void do_work();
 
-  /// Processes the log entry.
-  void process_log_entry(detail::log_entry&& entry);
+  /// Formats the input log entries, writing consecutive entries of the same
+  /// sink with a single call.
+  void process_log_entries(std::vector<detail::log_entry>& entries);
+
+  /// Writes the formatted entries accumulated so far to their sink.
+  void write_pending_buffer();
 
   /// Processes outstanding entries in the queue until it gets empty.
   void process_outstanding_entries();
@@ -120,6 +133,9 @@ private:
   };
   std::once_flag start_once_flag;
   std::thread worker_thread;
+  std::vector<detail::log_entry> batch;
+  fmt::memory_buffer write_buffer;
+  sink* write_buffer_sink = nullptr;
 };
 
 } // namespace srslog
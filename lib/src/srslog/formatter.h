@@ -56,11 +56,11 @@ inline void format_hex_dump(const std::vector<uint8_t>& v,
 
 } // namespace detail
 
-/// Formats to text all the fields of a log entry,
-inline std::string format_log_entry_to_text(detail::log_entry&& entry)
+/// Formats to text all the fields of a log entry, appending the result to the
+/// input buffer.
+inline void format_log_entry_to_text(detail::log_entry&& entry,
+                                     fmt::memory_buffer& buffer)
 {
-  fmt::memory_buffer buffer;
-
   // Time stamp data preparation.
   std::tm current_time =
       fmt::gmtime(std::chrono::high_resolution_clock::to_time_t(entry.tp));
@@ -87,7 +87,13 @@ inline std::string format_log_entry_to_text(detail::log_entry&& entry)
 
   // Optional hex dump formatting.
   detail::format_hex_dump(entry.hex_dump, buffer);
+}
 
+/// Formats to text all the fields of a log entry,
+inline std::string format_log_entry_to_text(detail::log_entry&& entry)
+{
+  fmt::memory_buffer buffer;
+  format_log_entry_to_text(std::move(entry), buffer);
   return fmt::to_string(buffer);
 }
 
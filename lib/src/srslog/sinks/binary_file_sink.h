@@ -0,0 +1,183 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLOG_BINARY_FILE_SINK_H
+#define SRSLOG_BINARY_FILE_SINK_H
+
+#include "binary_format.h"
+#include "file_utils.h"
+#include "srslte/srslog/sink.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace srslog {
+
+/// This sink implementation writes log entries to files in the srslog binary
+/// format, skipping the text formatting. The files are turned into text by the
+/// srslog_decoder tool.
+/// The file is written through a shared memory mapping that grows in chunks,
+/// so the written entries reach the page cache without system calls and
+/// survive a crash of the application. The file is truncated to its used size
+/// when closed. File rotation works as in the text file sink.
+class binary_file_sink : public sink
+{
+  /// Size by which the file and its mapping grow.
+  static constexpr size_t chunk_size = 4 * 1024 * 1024;
+
+public:
+  binary_file_sink(std::string name, size_t max_size) :
+    max_size((max_size == 0) ? 0 : std::max<size_t>(max_size, 4 * 1024)),
+    base_filename(std::move(name))
+  {}
+
+  binary_file_sink(const binary_file_sink& other) = delete;
+  binary_file_sink& operator=(const binary_file_sink& other) = delete;
+
+  ~binary_file_sink() override { close(); }
+
+  bool encode(const detail::log_entry& entry,
+              fmt::memory_buffer& buffer) override
+  {
+    binary_format::encode_entry(entry, strings, buffer);
+    return true;
+  }
+
+  detail::error_string write(detail::memory_buffer buffer) override
+  {
+    // Create a new file the first time we hit this method and when the
+    // current one exceeds the maximum size.
+    if (file_index == 0 ||
+        (max_size && fd >= 0 && used + buffer.size() > max_size)) {
+      if (auto err_str = create_file()) {
+        return err_str;
+      }
+    }
+
+    // Do not bother doing any work when the file was closed on a previous
+    // error.
+    if (fd < 0) {
+      return {};
+    }
+
+    return append(buffer.data(), buffer.size());
+  }
+
+  detail::error_string flush() override
+  {
+    if (map && ::msync(map, mapped, MS_ASYNC) != 0) {
+      return file_utils::format_error(
+          fmt::format("Error encountered while flushing log file \"{}\"",
+                      path),
+          errno);
+    }
+    return {};
+  }
+
+private:
+  /// Creates a new file and increments the file index counter. The new file
+  /// starts with the definitions of all the strings known so far, as the
+  /// entries that follow may refer to them.
+  detail::error_string create_file()
+  {
+    close();
+
+    path = file_utils::build_filename_with_index(base_filename, file_index++);
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      return file_utils::format_error(
+          fmt::format("Unable to create log file \"{}\"", path), errno);
+    }
+
+    fmt::memory_buffer header;
+    header.append(binary_format::magic,
+                  binary_format::magic + sizeof(binary_format::magic));
+    strings.encode_all(header);
+    return append(header.data(), header.size());
+  }
+
+  /// Copies data at the end of the used part of the file, growing the mapping
+  /// when needed.
+  detail::error_string append(const char* data, size_t size)
+  {
+    if (used + size > mapped) {
+      size_t new_size = (used + size + chunk_size - 1) / chunk_size * chunk_size;
+      if (::ftruncate(fd, new_size) != 0) {
+        return close_on_error();
+      }
+      void* new_map =
+          (map == nullptr)
+              ? ::mmap(nullptr, new_size, PROT_WRITE, MAP_SHARED, fd, 0)
+              : ::mremap(map, mapped, new_size, MREMAP_MAYMOVE);
+      if (new_map == MAP_FAILED) {
+        return close_on_error();
+      }
+      map = static_cast<char*>(new_map);
+      mapped = new_size;
+    }
+
+    std::memcpy(map + used, data, size);
+    used += size;
+    return {};
+  }
+
+  detail::error_string close_on_error()
+  {
+    int err = errno;
+    close();
+    return file_utils::format_error(
+        fmt::format("Unable to write log file \"{}\"", path), err);
+  }
+
+  /// Unmaps and closes the current file, trimming the unused part of the last
+  /// chunk.
+  void close()
+  {
+    if (map) {
+      ::munmap(map, mapped);
+      map = nullptr;
+    }
+    if (fd >= 0) {
+      if (::ftruncate(fd, used) != 0) {
+        // Keep the padding, the decoder stops at the zeros.
+      }
+      ::close(fd);
+      fd = -1;
+    }
+    mapped = 0;
+    used = 0;
+  }
+
+private:
+  const size_t max_size;
+  const std::string base_filename;
+  std::string path;
+  int fd = -1;
+  char* map = nullptr;
+  size_t mapped = 0;
+  size_t used = 0;
+  uint32_t file_index = 0;
+  binary_format::string_table strings;
+};
+
+} // namespace srslog
+
+#endif // SRSLOG_BINARY_FILE_SINK_H
@@ -0,0 +1,387 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLOG_BINARY_FORMAT_H
+#define SRSLOG_BINARY_FORMAT_H
+
+#include "srslte/srslog/detail/log_entry.h"
+#include <cstring>
+#include <unordered_map>
+
+namespace srslog {
+
+/// Binary encoding of log entries, written by the binary file sink and read
+/// back by the offline decoder.
+///
+/// A file starts with the magic string followed by a sequence of records. Each
+/// record is a one byte type, a 32 bit payload length and the payload. All
+/// integers are stored in the byte order of the host that wrote the file.
+/// Strings that repeat in every entry, like format strings and log names, are
+/// defined once per file with a string record and then referenced by id. An
+/// entry record stores the raw format arguments, the formatting is done by the
+/// decoder. A record type of zero marks the end of the data, files that were
+/// not closed properly end with zeros.
+namespace binary_format {
+
+constexpr char magic[8] = {'S', 'R', 'S', 'L', 'O', 'G', 'B', '1'};
+
+enum class record_type : uint8_t { end = 0, string = 1, entry = 2 };
+
+enum class arg_type : uint8_t {
+  int64 = 0,
+  uint64 = 1,
+  floating = 2,
+  string = 3,
+  character = 4,
+  boolean = 5,
+  pointer = 6
+};
+
+constexpr size_t record_header_size = sizeof(uint8_t) + sizeof(uint32_t);
+
+namespace detail {
+
+template <typename T>
+void append(fmt::memory_buffer& buffer, T value)
+{
+  const char* p = reinterpret_cast<const char*>(&value);
+  buffer.append(p, p + sizeof(T));
+}
+
+inline void append_bytes(fmt::memory_buffer& buffer, const char* p, size_t n)
+{
+  append<uint32_t>(buffer, n);
+  buffer.append(p, p + n);
+}
+
+/// Appends the header of a record, returning the offset of its length field.
+inline size_t begin_record(fmt::memory_buffer& buffer, record_type type)
+{
+  append<uint8_t>(buffer, static_cast<uint8_t>(type));
+  size_t offset = buffer.size();
+  append<uint32_t>(buffer, 0);
+  return offset;
+}
+
+/// Fills the length field of the record started at the given offset.
+inline void end_record(fmt::memory_buffer& buffer, size_t offset)
+{
+  uint32_t len = buffer.size() - offset - sizeof(uint32_t);
+  std::memcpy(buffer.data() + offset, &len, sizeof(len));
+}
+
+/// Visitor that encodes a format argument with its type.
+struct arg_encoder {
+  fmt::memory_buffer& buffer;
+
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value &&
+                          std::is_signed<T>::value>::type
+  operator()(T value)
+  {
+    append(buffer, arg_type::int64);
+    append<int64_t>(buffer, value);
+  }
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value &&
+                          std::is_unsigned<T>::value>::type
+  operator()(T value)
+  {
+    append(buffer, arg_type::uint64);
+    append<uint64_t>(buffer, value);
+  }
+  void operator()(bool value)
+  {
+    append(buffer, arg_type::boolean);
+    append<uint8_t>(buffer, value);
+  }
+  void operator()(char value)
+  {
+    append(buffer, arg_type::character);
+    append(buffer, value);
+  }
+  template <typename T>
+  typename std::enable_if<std::is_floating_point<T>::value>::type
+  operator()(T value)
+  {
+    append(buffer, arg_type::floating);
+    append<double>(buffer, value);
+  }
+  void operator()(const char* value)
+  {
+    append(buffer, arg_type::string);
+    append_bytes(buffer, value, std::strlen(value));
+  }
+  void operator()(fmt::string_view value)
+  {
+    append(buffer, arg_type::string);
+    append_bytes(buffer, value.data(), value.size());
+  }
+  void operator()(const void* value)
+  {
+    append(buffer, arg_type::pointer);
+    append<uint64_t>(buffer, reinterpret_cast<uintptr_t>(value));
+  }
+  /// Types that can not be stored raw, like user types with their own
+  /// formatter.
+  template <typename T>
+  typename std::enable_if<!std::is_arithmetic<T>::value>::type operator()(T)
+  {
+    (*this)(fmt::string_view("<?>"));
+  }
+};
+
+} // namespace detail
+
+/// Assigns ids to the strings of a file and writes their definitions.
+class string_table
+{
+public:
+  /// Returns the id of the string, appending its definition to the buffer the
+  /// first time it is seen.
+  uint32_t get_id(const std::string& s, fmt::memory_buffer& buffer)
+  {
+    auto it = ids.find(s);
+    if (it != ids.end()) {
+      return it->second;
+    }
+    uint32_t id = ids.size();
+    ids.emplace(s, id);
+    encode_definition(id, s, buffer);
+    return id;
+  }
+
+  /// Appends the definitions of all the known strings to the buffer. Used when
+  /// starting a new file.
+  void encode_all(fmt::memory_buffer& buffer) const
+  {
+    for (const auto& s : ids) {
+      encode_definition(s.second, s.first, buffer);
+    }
+  }
+
+private:
+  static void encode_definition(uint32_t id,
+                                const std::string& s,
+                                fmt::memory_buffer& buffer)
+  {
+    size_t offset = detail::begin_record(buffer, record_type::string);
+    detail::append(buffer, id);
+    buffer.append(s.data(), s.data() + s.size());
+    detail::end_record(buffer, offset);
+  }
+
+  std::unordered_map<std::string, uint32_t> ids;
+};
+
+/// Appends the encoded log entry to the buffer, together with the definitions
+/// of its strings when they are new.
+inline void encode_entry(const srslog::detail::log_entry& entry,
+                         string_table& strings,
+                         fmt::memory_buffer& buffer)
+{
+  uint32_t fmt_id = strings.get_id(entry.fmtstring, buffer);
+  uint32_t name_id = strings.get_id(entry.log_name, buffer);
+
+  size_t offset = detail::begin_record(buffer, record_type::entry);
+  detail::append<int64_t>(
+      buffer,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          entry.tp.time_since_epoch())
+          .count());
+  detail::append(buffer, fmt_id);
+  detail::append(buffer, name_id);
+  detail::append(buffer, entry.log_tag);
+  detail::append<uint8_t>(buffer, entry.context.enabled);
+  detail::append(buffer, entry.context.value);
+
+  fmt::basic_format_args<fmt::printf_context> args(entry.store);
+  uint8_t nof_args = 0;
+  while (args.get(nof_args)) {
+    ++nof_args;
+  }
+  detail::append(buffer, nof_args);
+  for (uint8_t i = 0; i != nof_args; ++i) {
+    fmt::visit_format_arg(detail::arg_encoder{buffer}, args.get(i));
+  }
+
+  detail::append_bytes(buffer,
+                       reinterpret_cast<const char*>(entry.hex_dump.data()),
+                       entry.hex_dump.size());
+  detail::end_record(buffer, offset);
+}
+
+/// Reads back the log entries of a binary log file.
+class reader
+{
+public:
+  /// The memory block has to outlive the reader.
+  reader(const char* data, size_t size) : p(data), end(data + size) {}
+
+  /// Returns true if the data starts with the magic string, consuming it.
+  bool read_magic()
+  {
+    if (size_t(end - p) < sizeof(magic) ||
+        std::memcmp(p, magic, sizeof(magic)) != 0) {
+      return false;
+    }
+    p += sizeof(magic);
+    return true;
+  }
+
+  /// Decodes the next entry into the output argument, processing the string
+  /// definitions found on the way. Returns false at the end of the data or on
+  /// a truncated record.
+  bool next(srslog::detail::log_entry& entry)
+  {
+    while (size_t(end - p) >= record_header_size) {
+      auto type = static_cast<record_type>(*p);
+      uint32_t len;
+      std::memcpy(&len, p + 1, sizeof(len));
+      const char* payload = p + record_header_size;
+      if (type == record_type::end || size_t(end - payload) < len) {
+        return false;
+      }
+      p = payload + len;
+
+      if (type == record_type::string && len >= sizeof(uint32_t)) {
+        uint32_t id;
+        std::memcpy(&id, payload, sizeof(id));
+        strings[id].assign(payload + sizeof(id), len - sizeof(id));
+      } else if (type == record_type::entry &&
+                 decode_entry(payload, payload + len, entry)) {
+        return true;
+      }
+      // Skip unknown records.
+    }
+    return false;
+  }
+
+private:
+  template <typename T>
+  bool read(const char*& q, const char* e, T& value)
+  {
+    if (size_t(e - q) < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, q, sizeof(T));
+    q += sizeof(T);
+    return true;
+  }
+
+  bool read_bytes(const char*& q, const char* e, std::string& s)
+  {
+    uint32_t n;
+    if (!read(q, e, n) || size_t(e - q) < n) {
+      return false;
+    }
+    s.assign(q, n);
+    q += n;
+    return true;
+  }
+
+  bool decode_arg(const char*& q,
+                  const char* e,
+                  fmt::dynamic_format_arg_store<fmt::printf_context>& store)
+  {
+    arg_type type;
+    if (!read(q, e, type)) {
+      return false;
+    }
+    switch (type) {
+      case arg_type::int64: {
+        int64_t v;
+        return read(q, e, v) && (store.push_back(v), true);
+      }
+      case arg_type::uint64: {
+        uint64_t v;
+        return read(q, e, v) && (store.push_back(v), true);
+      }
+      case arg_type::floating: {
+        double v;
+        return read(q, e, v) && (store.push_back(v), true);
+      }
+      case arg_type::string: {
+        std::string v;
+        return read_bytes(q, e, v) && (store.push_back(std::move(v)), true);
+      }
+      case arg_type::character: {
+        char v;
+        return read(q, e, v) && (store.push_back(v), true);
+      }
+      case arg_type::boolean: {
+        uint8_t v;
+        return read(q, e, v) && (store.push_back(v != 0), true);
+      }
+      case arg_type::pointer: {
+        uint64_t v;
+        return read(q, e, v) &&
+               (store.push_back(reinterpret_cast<const void*>(v)), true);
+      }
+    }
+    return false;
+  }
+
+  bool decode_entry(const char* q,
+                    const char* e,
+                    srslog::detail::log_entry& entry)
+  {
+    int64_t ns;
+    uint32_t fmt_id, name_id;
+    uint8_t context_enabled, nof_args;
+    if (!read(q, e, ns) || !read(q, e, fmt_id) || !read(q, e, name_id) ||
+        !read(q, e, entry.log_tag) || !read(q, e, context_enabled) ||
+        !read(q, e, entry.context.value) || !read(q, e, nof_args)) {
+      return false;
+    }
+    entry.s = nullptr;
+    entry.tp = std::chrono::high_resolution_clock::time_point(
+        std::chrono::duration_cast<
+            std::chrono::high_resolution_clock::duration>(
+            std::chrono::nanoseconds(ns)));
+    entry.context.enabled = context_enabled != 0;
+    entry.fmtstring = strings[fmt_id];
+    entry.log_name = strings[name_id];
+    entry.store.clear();
+    for (uint8_t i = 0; i != nof_args; ++i) {
+      if (!decode_arg(q, e, entry.store)) {
+        return false;
+      }
+    }
+    std::string hex;
+    if (!read_bytes(q, e, hex)) {
+      return false;
+    }
+    entry.hex_dump.assign(hex.begin(), hex.end());
+    return true;
+  }
+
+private:
+  const char* p;
+  const char* const end;
+  std::unordered_map<uint32_t, std::string> strings;
+};
+
+} // namespace binary_format
+
+} // namespace srslog
+
+#endif // SRSLOG_BINARY_FORMAT_H
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/// Converts the files written by the srslog binary file sink into the text
+/// that the text file sink would have written.
+/// Usage: srslog_decoder <binary log file>... > log.txt
+
+#include "formatter.h"
+#include "sinks/binary_format.h"
+#include <fstream>
+#include <iterator>
+
+using namespace srslog;
+
+static bool decode_file(const char* path)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    fmt::print(stderr, "Unable to open \"{}\"\n", path);
+    return false;
+  }
+  std::string data((std::istreambuf_iterator<char>(in)),
+                   std::istreambuf_iterator<char>());
+
+  binary_format::reader reader(data.data(), data.size());
+  if (!reader.read_magic()) {
+    fmt::print(stderr, "\"{}\" is not a srslog binary log file\n", path);
+    return false;
+  }
+
+  detail::log_entry entry = {};
+  fmt::memory_buffer buffer;
+  while (reader.next(entry)) {
+    format_log_entry_to_text(std::move(entry), buffer);
+    if (buffer.size() > 64 * 1024) {
+      std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+      buffer.clear();
+    }
+  }
+  std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2) {
+    fmt::print(stderr, "Usage: {} <binary log file>...\n", argv[0]);
+    return 1;
+  }
+
+  // Rotated files are decoded in the order they are given.
+  int ret = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (!decode_file(argv[i])) {
+      ret = 1;
+    }
+  }
+
+  return ret;
+}
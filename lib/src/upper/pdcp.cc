@@ -48,6 +48,14 @@ void pdcp::init(srsue::rlc_interface_pdcp* rlc_, srsue::rrc_interface_pdcp* rrc_
 
 void pdcp::stop() {}
 
+void pdcp::set_crypto_offload(bool enable)
+{
+  crypto_offload = enable;
+  for (auto& entity : pdcp_array) {
+    entity.second->set_crypto_offload(enable);
+  }
+}
+
 void pdcp::reestablish()
 {
   for (auto& lcid_it : pdcp_array) {
@@ -115,6 +123,7 @@ void pdcp::add_bearer(uint32_t lcid, pdcp_config_t cfg)
     } else {
       entity.reset(new pdcp_entity_lte{rlc, rrc, gw, task_sched, pdcp_log, lcid, cfg});
     }
+    entity->set_crypto_offload(crypto_offload);
     if (not pdcp_array.insert(std::make_pair(lcid, std::move(entity))).second) {
       pdcp_log->error("Error inserting PDCP entity in to array.\n");
       return;
@@ -44,6 +44,16 @@ void pdcp_entity_base::config_security(as_security_config_t sec_cfg_)
   log->debug_hex(sec_cfg.k_up_enc.data(), 32, "K_up_enc");
   log->debug_hex(sec_cfg.k_rrc_int.data(), 32, "K_rrc_int");
   log->debug_hex(sec_cfg.k_up_int.data(), 32, "K_up_int");
+
+  std::shared_ptr<tx_cipher_ctx_t> ctx(new tx_cipher_ctx_t);
+  ctx->algo      = sec_cfg.cipher_algo;
+  ctx->k_enc     = is_srb() ? sec_cfg.k_rrc_enc : sec_cfg.k_up_enc;
+  ctx->bearer    = cfg.bearer_id - 1;
+  ctx->direction = cfg.tx_direction;
+  if (ctx->algo == CIPHERING_ALGORITHM_ID_128_EEA2) {
+    ctx->aes_key.set(&ctx->k_enc[16]);
+  }
+  tx_cipher_ctx = std::move(ctx);
 }
 
 /****************************************************************************
@@ -67,7 +77,8 @@ void pdcp_entity_base::integrity_generate(uint8_t* msg, uint32_t msg_len, uint32
       security_128_eia1(&k_int[16], count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA2:
-      security_128_eia2(&k_int[16], count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
+      aes_int_key.set(&k_int[16]);
+      security_128_eia2(aes_int_key, count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA3:
       security_128_eia3(&k_int[16], count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, mac);
@@ -105,7 +116,8 @@ bool pdcp_entity_base::integrity_verify(uint8_t* msg, uint32_t msg_len, uint32_t
       security_128_eia1(&k_int[16], count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA2:
-      security_128_eia2(&k_int[16], count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
+      aes_int_key.set(&k_int[16]);
+      security_128_eia2(aes_int_key, count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
       break;
     case INTEGRITY_ALGORITHM_ID_128_EIA3:
       security_128_eia3(&k_int[16], count, cfg.bearer_id - 1, cfg.rx_direction, msg, msg_len, mac_exp);
@@ -165,8 +177,9 @@ void pdcp_entity_base::cipher_encrypt(uint8_t* msg, uint32_t msg_len, uint32_t c
       memcpy(ct, ct_tmp, msg_len);
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA2:
-      security_128_eea2(&(k_enc[16]), count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, ct_tmp);
-      memcpy(ct, ct_tmp, msg_len);
+      // AES-CTR can cipher in place
+      aes_enc_key.set(&k_enc[16]);
+      security_128_eea2(aes_enc_key, count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, ct);
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA3:
       security_128_eea3(&(k_enc[16]), count, cfg.bearer_id - 1, cfg.tx_direction, msg, msg_len, ct_tmp);
@@ -178,6 +191,28 @@ void pdcp_entity_base::cipher_encrypt(uint8_t* msg, uint32_t msg_len, uint32_t c
   log->debug_hex(ct, msg_len, "Cipher encrypt output msg");
 }
 
+void pdcp_entity_base::tx_cipher_ctx_t::cipher_in_place(uint8_t* msg, uint32_t msg_len, uint32_t count) const
+{
+  // EEA1 and EEA3 do not modify the key, they just take it as non-const
+  uint8_t* k = const_cast<uint8_t*>(&k_enc[16]);
+
+  switch (algo) {
+    case CIPHERING_ALGORITHM_ID_EEA0:
+      break;
+    case CIPHERING_ALGORITHM_ID_128_EEA1:
+      security_128_eea1(k, count, bearer, direction, msg, msg_len, msg);
+      break;
+    case CIPHERING_ALGORITHM_ID_128_EEA2:
+      security_128_eea2(aes_key, count, bearer, direction, msg, msg_len, msg);
+      break;
+    case CIPHERING_ALGORITHM_ID_128_EEA3:
+      security_128_eea3(k, count, bearer, direction, msg, msg_len, msg);
+      break;
+    default:
+      break;
+  }
+}
+
 void pdcp_entity_base::cipher_decrypt(uint8_t* ct, uint32_t ct_len, uint32_t count, uint8_t* msg)
 {
   uint8_t* k_enc;
@@ -205,8 +240,8 @@ void pdcp_entity_base::cipher_decrypt(uint8_t* ct, uint32_t ct_len, uint32_t cou
       memcpy(msg, msg_tmp, ct_len);
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA2:
-      security_128_eea2(&k_enc[16], count, cfg.bearer_id - 1, cfg.rx_direction, ct, ct_len, msg_tmp);
-      memcpy(msg, msg_tmp, ct_len);
+      aes_enc_key.set(&k_enc[16]);
+      security_128_eea2(aes_enc_key, count, cfg.bearer_id - 1, cfg.rx_direction, ct, ct_len, msg);
       break;
     case CIPHERING_ALGORITHM_ID_128_EEA3:
       security_128_eea3(&k_enc[16], count, cfg.bearer_id - 1, cfg.rx_direction, ct, ct_len, msg_tmp);
@@ -328,4 +363,53 @@ void pdcp_entity_base::append_mac(const unique_byte_buffer_t& sdu, uint8_t* mac)
   memcpy(&sdu->msg[sdu->N_bytes], mac, 4);
   sdu->N_bytes += 4;
 }
+
+/****************************************************************************
+ * Header compression
+ ***************************************************************************/
+
+void pdcp_entity_base::init_hdr_compressor(const pdcp_rohc_config_t& rohc_cfg)
+{
+  hdr_compressor = make_rohc_compressor(rohc_cfg);
+  if (not rohc_cfg.enabled and not rohc_cfg.profiles.empty()) {
+    log->warning("ROHC of LCID=%d is not enabled, none of the %zd configured profiles is supported\n",
+                 lcid,
+                 rohc_cfg.profiles.size());
+  } else if (hdr_compressor != nullptr and not rohc_cfg.profiles.empty()) {
+    log->warning("ROHC of LCID=%d only uses the uncompressed profile 0x0000, the %zd configured profiles are not "
+                 "supported\n",
+                 lcid,
+                 rohc_cfg.profiles.size());
+  }
+}
+
+bool pdcp_entity_base::compress_header(const unique_byte_buffer_t& sdu)
+{
+  if (hdr_compressor == nullptr or hdr_compressor->compress(sdu.get())) {
+    return true;
+  }
+  log->warning("Dropping SDU of LCID=%d, the header could not be compressed\n", lcid);
+  return false;
+}
+
+bool pdcp_entity_base::decompress_header(const unique_byte_buffer_t& pdu)
+{
+  if (hdr_compressor == nullptr or hdr_compressor->decompress(pdu.get())) {
+    return true;
+  }
+  log->info("Dropping PDU of LCID=%d, the header could not be decompressed\n", lcid);
+  return false;
+}
+
+// Control PDU for interspersed ROHC feedback packet, TS 36.323 section 6.2.5
+void pdcp_entity_base::handle_rohc_feedback(const unique_byte_buffer_t& pdu)
+{
+  uint8_t pdu_type = (pdu->msg[0] >> 4u) & 0x07u;
+  if (pdu_type != PDCP_PDU_TYPE_INTERSPERSED_ROHC_FEEDBACK_PACKET or hdr_compressor == nullptr or pdu->N_bytes < 2) {
+    log->info("Dropping PDCP control PDU\n");
+    return;
+  }
+  hdr_compressor->handle_feedback(&pdu->msg[1], pdu->N_bytes - 1);
+}
+
 } // namespace srslte
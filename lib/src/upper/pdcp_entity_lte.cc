@@ -43,6 +43,7 @@ pdcp_entity_lte::pdcp_entity_lte(srsue::rlc_interface_pdcp* rlc_,
     reordering_window = 0;
   } else if (is_drb()) {
     reordering_window = 2048;
+    init_hdr_compressor(cfg.rohc);
   }
 
   st.next_pdcp_tx_sn           = 0;
@@ -89,6 +90,9 @@ void pdcp_entity_lte::reestablish()
       st.rx_hfn          = 0;
       st.next_pdcp_rx_sn = 0;
     }
+    if (hdr_compressor != nullptr) {
+      hdr_compressor->reset();
+    }
   }
 }
 
@@ -99,6 +103,12 @@ void pdcp_entity_lte::reset()
     log->debug("Reset %s\n", rrc->get_rb_name(lcid).c_str());
   }
   active = false;
+
+  // PDUs still being ciphered are dropped
+  if (tx_crypto != nullptr) {
+    tx_crypto->entity = nullptr;
+    tx_crypto.reset();
+  }
 }
 
 // GW/RRC interface
@@ -109,6 +119,10 @@ void pdcp_entity_lte::write_sdu(unique_byte_buffer_t sdu)
     return;
   }
 
+  if (not compress_header(sdu)) {
+    return;
+  }
+
   // Get COUNT to be used with this packet
   uint32_t tx_count = COUNT(st.tx_hfn, st.next_pdcp_tx_sn);
 
@@ -121,6 +135,14 @@ void pdcp_entity_lte::write_sdu(unique_byte_buffer_t sdu)
 
   write_data_header(sdu, tx_count);
 
+  // DRBs have no MAC. While PDUs are being ciphered in the background, the following ones queue behind them
+  bool do_encryption = encryption_direction == DIRECTION_TX || encryption_direction == DIRECTION_TXRX;
+  bool in_flight     = tx_crypto != nullptr and tx_crypto->next_idx != tx_crypto->next_tx;
+  if (is_drb() and ((crypto_offload and do_encryption) or in_flight)) {
+    submit_crypto_job(std::move(sdu), tx_count, do_encryption);
+    return;
+  }
+
   // Append MAC (SRBs only)
   uint8_t mac[4]       = {};
   bool    do_integrity = integrity_direction == DIRECTION_TX || integrity_direction == DIRECTION_TXRX;
@@ -132,18 +154,12 @@ void pdcp_entity_lte::write_sdu(unique_byte_buffer_t sdu)
     append_mac(sdu, mac);
   }
 
-  if (encryption_direction == DIRECTION_TX || encryption_direction == DIRECTION_TXRX) {
+  if (do_encryption) {
     cipher_encrypt(
         &sdu->msg[cfg.hdr_len_bytes], sdu->N_bytes - cfg.hdr_len_bytes, tx_count, &sdu->msg[cfg.hdr_len_bytes]);
   }
 
-  log->info_hex(sdu->msg,
-                sdu->N_bytes,
-                "TX %s PDU, SN=%d, integrity=%s, encryption=%s",
-                rrc->get_rb_name(lcid).c_str(),
-                st.next_pdcp_tx_sn,
-                srslte_direction_text[integrity_direction],
-                srslte_direction_text[encryption_direction]);
+  log_tx_pdu(sdu, st.next_pdcp_tx_sn);
 
   // Increment NEXT_PDCP_TX_SN and TX_HFN
   st.next_pdcp_tx_sn++;
@@ -155,12 +171,83 @@ void pdcp_entity_lte::write_sdu(unique_byte_buffer_t sdu)
   rlc->write_sdu(lcid, std::move(sdu));
 }
 
+void pdcp_entity_lte::submit_crypto_job(unique_byte_buffer_t pdu, uint32_t tx_count, bool do_encryption)
+{
+  if (tx_crypto == nullptr) {
+    tx_crypto.reset(new tx_crypto_queue_t);
+    tx_crypto->entity = this;
+  }
+  if (tx_crypto->next_idx - tx_crypto->next_tx >= max_crypto_jobs) {
+    log->info_hex(pdu->msg, pdu->N_bytes, "Dropping %s SDU due to full crypto queue", rrc->get_rb_name(lcid).c_str());
+    return;
+  }
+
+  uint32_t idx = tx_crypto->next_idx++;
+  uint32_t sn  = st.next_pdcp_tx_sn;
+
+  // Increment NEXT_PDCP_TX_SN and TX_HFN
+  st.next_pdcp_tx_sn++;
+  if (st.next_pdcp_tx_sn > maximum_pdcp_sn) {
+    st.tx_hfn++;
+    st.next_pdcp_tx_sn = 0;
+  }
+
+  if (not do_encryption or tx_cipher_ctx == nullptr) {
+    tx_crypto_done(idx, sn, std::move(pdu));
+    return;
+  }
+
+  // The task has to be copyable, so the PDU and the result travel in a shared job
+  struct job_t {
+    std::shared_ptr<tx_crypto_queue_t>     queue;
+    std::shared_ptr<const tx_cipher_ctx_t> ctx;
+    unique_byte_buffer_t                   pdu;
+    uint32_t                               idx;
+    uint32_t                               sn;
+    uint32_t                               count;
+    uint32_t                               hdr_len;
+  };
+  std::shared_ptr<job_t> job(new job_t{tx_crypto, tx_cipher_ctx, std::move(pdu), idx, sn, tx_count, cfg.hdr_len_bytes});
+  task_sched_handle      sched = task_sched;
+  task_sched.enqueue_background_task([job, sched](uint32_t worker_id) mutable {
+    job->ctx->cipher_in_place(&job->pdu->msg[job->hdr_len], job->pdu->N_bytes - job->hdr_len, job->count);
+    sched.notify_background_task_result([job]() {
+      if (job->queue->entity != nullptr) {
+        job->queue->entity->tx_crypto_done(job->idx, job->sn, std::move(job->pdu));
+      }
+    });
+  });
+}
+
+void pdcp_entity_lte::tx_crypto_done(uint32_t idx, uint32_t sn, unique_byte_buffer_t pdu)
+{
+  tx_crypto->done.emplace(idx, std::make_pair(sn, std::move(pdu)));
+  for (auto it = tx_crypto->done.find(tx_crypto->next_tx); it != tx_crypto->done.end();
+       it      = tx_crypto->done.find(tx_crypto->next_tx)) {
+    log_tx_pdu(it->second.second, it->second.first);
+    rlc->write_sdu(lcid, std::move(it->second.second));
+    tx_crypto->done.erase(it);
+    tx_crypto->next_tx++;
+  }
+}
+
+void pdcp_entity_lte::log_tx_pdu(const unique_byte_buffer_t& pdu, uint32_t sn)
+{
+  log->info_hex(pdu->msg,
+                pdu->N_bytes,
+                "TX %s PDU, SN=%d, integrity=%s, encryption=%s",
+                rrc->get_rb_name(lcid).c_str(),
+                sn,
+                srslte_direction_text[integrity_direction],
+                srslte_direction_text[encryption_direction]);
+}
+
 // RLC interface
 void pdcp_entity_lte::write_pdu(unique_byte_buffer_t pdu)
 {
-  // drop control PDUs
+  // Control PDUs carry ROHC feedback or PDCP status reports, the latter are not supported
   if (is_drb() && is_control_pdu(pdu)) {
-    log->info("Dropping PDCP control PDU\n");
+    handle_rohc_feedback(pdu);
     return;
   }
 
@@ -281,7 +368,9 @@ void pdcp_entity_lte::handle_um_drb_pdu(srslte::unique_byte_buffer_t pdu)
   }
 
   // Pass to upper layers
-  gw->write_pdu(lcid, std::move(pdu));
+  if (decompress_header(pdu)) {
+    gw->write_pdu(lcid, std::move(pdu));
+  }
 }
 
 // DRBs mapped on RLC AM, without re-ordering (5.1.2.1.2)
@@ -340,7 +429,9 @@ void pdcp_entity_lte::handle_am_drb_pdu(srslte::unique_byte_buffer_t pdu)
   st.last_submitted_pdcp_rx_sn = sn;
 
   // Pass to upper layers
-  gw->write_pdu(lcid, std::move(pdu));
+  if (decompress_header(pdu)) {
+    gw->write_pdu(lcid, std::move(pdu));
+  }
 }
 
 /****************************************************************************
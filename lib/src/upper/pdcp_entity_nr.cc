@@ -44,6 +44,10 @@ pdcp_entity_nr::pdcp_entity_nr(srsue::rlc_interface_pdcp* rlc_,
   encryption_direction = DIRECTION_NONE;
 
   window_size = 1 << (cfg.sn_len - 1);
+  reorder_queue.init(window_size);
+  if (is_drb()) {
+    init_hdr_compressor(cfg.rohc);
+  }
 
   // Timers
   reordering_timer = task_sched.get_unique_timer();
@@ -90,6 +94,11 @@ void pdcp_entity_nr::write_sdu(unique_byte_buffer_t sdu)
     tx_overflow = true;
   }
 
+  // Perform header compression
+  if (not compress_header(sdu)) {
+    return;
+  }
+
   // Start discard timer
   if (cfg.discard_timer != pdcp_discard_timer_t::infinity) {
     timer_handler::unique_timer discard_timer = task_sched.get_unique_timer();
@@ -100,8 +109,6 @@ void pdcp_entity_nr::write_sdu(unique_byte_buffer_t sdu)
     log->debug("Discard Timer set for SN %u. Timeout: %ums\n", tx_next, static_cast<uint32_t>(cfg.discard_timer));
   }
 
-  // Perform header compression TODO
-
   // Integrity protection
   uint8_t mac[4];
   integrity_generate(sdu->msg, sdu->N_bytes, tx_next, mac);
@@ -178,12 +185,12 @@ void pdcp_entity_nr::write_pdu(unique_byte_buffer_t pdu)
   }
 
   // Check if PDU has been received
-  if (reorder_queue.find(rcvd_count) != reorder_queue.end()) {
+  if (reorder_queue.has(rcvd_count)) {
     return; // PDU already present, drop.
   }
 
   // Store PDU in reception buffer
-  reorder_queue[rcvd_count] = std::move(pdu);
+  reorder_queue.add(rcvd_count, std::move(pdu));
 
   // Update RX_NEXT
   if (rcvd_count >= rx_next) {
@@ -213,14 +220,15 @@ void pdcp_entity_nr::write_pdu(unique_byte_buffer_t pdu)
  */
 
 // Deliver all consecutivly associated COUNTs.
-// Update RX_NEXT after submitting to higher layers
+// Update RX_DELIV after submitting to higher layers
 void pdcp_entity_nr::deliver_all_consecutive_counts()
 {
-  for (std::map<uint32_t, unique_byte_buffer_t>::iterator it = reorder_queue.begin();
-       it != reorder_queue.end() && it->first == rx_deliv;
-       reorder_queue.erase(it++)) {
-    log->debug("Delivering SDU with RCVD_COUNT %u\n", it->first);
-
+  // The whole run of in-order SDUs is found in the bitmap and delivered in one go
+  uint32_t nof_sdus = reorder_queue.run_length(rx_deliv);
+  if (nof_sdus > 0) {
+    log->debug("Delivering %u SDUs with RCVD_COUNT %u to %u\n", nof_sdus, rx_deliv, rx_deliv + nof_sdus - 1);
+  }
+  for (uint32_t i = 0; i < nof_sdus; ++i) {
     // Check RX_DELIV overflow
     if (rx_overflow) {
       log->warning("RX_DELIV has overflowed. Droping packet\n");
@@ -231,7 +239,7 @@ void pdcp_entity_nr::deliver_all_consecutive_counts()
     }
 
     // Pass PDCP SDU to the next layers
-    pass_to_upper_layers(std::move(it->second));
+    pass_to_upper_layers(reorder_queue.take(rx_deliv));
 
     // Update RX_DELIV
     rx_deliv = rx_deliv + 1;
@@ -247,14 +255,15 @@ void pdcp_entity_nr::reordering_callback::operator()(uint32_t timer_id)
   parent->log->debug("Reordering timer expired\n");
 
   // Deliver all PDCP SDU(s) with associeted COUNT value(s) < RX_REORD
-  for (std::map<uint32_t, unique_byte_buffer_t>::iterator it = parent->reorder_queue.begin();
-       it != parent->reorder_queue.end() && it->first < parent->rx_reord;
-       parent->reorder_queue.erase(it++)) {
+  uint32_t count = parent->reorder_queue.next_stored(parent->rx_deliv, parent->rx_reord);
+  while (count != parent->rx_reord) {
     // Deliver to upper layers
-    parent->pass_to_upper_layers(std::move(it->second));
+    parent->pass_to_upper_layers(parent->reorder_queue.take(count));
+    count = parent->reorder_queue.next_stored(count + 1, parent->rx_reord);
   }
 
   // Deliver all PDCP SDU(s) consecutivly associeted COUNT value(s) starting from RX_REORD
+  parent->rx_deliv = parent->rx_reord;
   parent->deliver_all_consecutive_counts();
 
   if (parent->rx_deliv < parent->rx_next) {
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/upper/pdcp_entity_base.h"
+
+namespace srslte {
+
+namespace {
+
+// ROHC packet types, RFC 3095 section 5.2
+const uint8_t ROHC_PADDING       = 0xe0; // 11100000
+const uint8_t ROHC_ADD_CID_MASK  = 0xf0; // 1110CCCC, small CIDs 1 to 15
+const uint8_t ROHC_ADD_CID       = 0xe0;
+const uint8_t ROHC_FEEDBACK_MASK = 0xf8; // 11110CCC
+const uint8_t ROHC_FEEDBACK      = 0xf0;
+const uint8_t ROHC_IR            = 0xfc; // 1111110D, the uncompressed profile has no dynamic chain
+
+// CRC-8 of RFC 3095 section 5.9.1, C(x) = 1 + x + x^2 + x^8, computed LSB first from all ones
+uint8_t rohc_crc8(const uint8_t* data, uint32_t len)
+{
+  uint8_t crc = 0xff;
+  for (uint32_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    for (uint32_t b = 0; b < 8; ++b) {
+      crc = (crc & 1u) ? (crc >> 1u) ^ 0xe0u : crc >> 1u;
+    }
+  }
+  return crc;
+}
+
+/**
+ * ROHC uncompressed profile 0x0000, RFC 3095 section 5.10, in unidirectional mode with CID 0
+ *
+ * The packets keep their headers, so this profile only saves the bandwidth of the compressor state machine. It is the
+ * profile every ROHC decompressor supports, and the fallback of the other profiles for packets they do not handle.
+ * The compressor sends the first packets, and one in every IR_REFRESH_PERIOD, as IR packets to set up the context of
+ * the decompressor, and the rest as Normal packets, which with small CIDs are the IP packets as they are.
+ */
+class rohc_uncompressed_profile final : public pdcp_hdr_compressor
+{
+public:
+  explicit rohc_uncompressed_profile(const pdcp_rohc_config_t& cfg) : large_cids(cfg.max_cid > 15) {}
+
+  bool compress(byte_buffer_t* sdu) override
+  {
+    if (sdu->N_bytes == 0) {
+      return false;
+    }
+    // A Normal packet cannot start like a ROHC packet type, such packets are always sent in IR packets
+    if (nof_ir_sent < NOF_INITIAL_IR or nof_since_ir >= IR_REFRESH_PERIOD or sdu->msg[0] >= ROHC_PADDING) {
+      uint32_t hdr_len = large_cids ? 4 : 3;
+      if (sdu->get_headroom() < hdr_len) {
+        return false;
+      }
+      sdu->msg -= hdr_len;
+      sdu->N_bytes += hdr_len;
+      uint8_t* p = sdu->msg;
+      *p++       = ROHC_IR;
+      if (large_cids) {
+        *p++ = 0; // CID 0 as a one octet SDVL value
+      }
+      *p++ = 0; // Profile 0x0000
+      *p   = rohc_crc8(sdu->msg, hdr_len - 1);
+      nof_ir_sent++;
+      nof_since_ir = 0;
+      return true;
+    }
+    nof_since_ir++;
+    if (large_cids) {
+      // The CID goes after the first octet of the IP packet
+      if (sdu->get_headroom() < 1) {
+        return false;
+      }
+      sdu->msg -= 1;
+      sdu->N_bytes += 1;
+      sdu->msg[0] = sdu->msg[1];
+      sdu->msg[1] = 0;
+    }
+    return true;
+  }
+
+  bool decompress(byte_buffer_t* pdu) override
+  {
+    // Skip padding and the feedback piggybacked on the packet, which this mode does not use
+    while (pdu->N_bytes > 0) {
+      if (pdu->msg[0] == ROHC_PADDING) {
+        consume(pdu, 1);
+      } else if ((pdu->msg[0] & ROHC_FEEDBACK_MASK) == ROHC_FEEDBACK) {
+        uint32_t code = pdu->msg[0] & 0x07u;
+        uint32_t len  = code != 0 ? 1 + code : (pdu->N_bytes > 1 ? 2 + pdu->msg[1] : 2);
+        if (len > pdu->N_bytes) {
+          return false;
+        }
+        consume(pdu, len);
+      } else {
+        break;
+      }
+    }
+    if (pdu->N_bytes == 0 or (pdu->msg[0] & ROHC_ADD_CID_MASK) == ROHC_ADD_CID) {
+      // The compressor only uses CID 0
+      return false;
+    }
+
+    uint32_t cid_len = large_cids ? 1 : 0;
+    if (pdu->msg[0] == ROHC_IR) {
+      uint32_t hdr_len = 3 + cid_len;
+      if (pdu->N_bytes < hdr_len or (large_cids and pdu->msg[1] != 0) or pdu->msg[hdr_len - 2] != 0 or
+          rohc_crc8(pdu->msg, hdr_len - 1) != pdu->msg[hdr_len - 1]) {
+        return false;
+      }
+      consume(pdu, hdr_len);
+      context_valid = true;
+      return true;
+    }
+    if (pdu->msg[0] >= ROHC_PADDING or not context_valid) {
+      // Packet types of other profiles, or a Normal packet before the first IR packet
+      return false;
+    }
+    if (large_cids) {
+      if (pdu->N_bytes < 2 or pdu->msg[1] != 0) {
+        return false;
+      }
+      pdu->msg[1] = pdu->msg[0];
+      consume(pdu, 1);
+    }
+    return true;
+  }
+
+  void reset() override
+  {
+    nof_ir_sent   = 0;
+    nof_since_ir  = 0;
+    context_valid = false;
+  }
+
+private:
+  static const uint32_t NOF_INITIAL_IR    = 3;
+  static const uint32_t IR_REFRESH_PERIOD = 256;
+
+  static void consume(byte_buffer_t* pdu, uint32_t len)
+  {
+    pdu->msg += len;
+    pdu->N_bytes -= len;
+  }
+
+  bool     large_cids;
+  uint32_t nof_ir_sent   = 0;
+  uint32_t nof_since_ir  = 0;
+  bool     context_valid = false;
+};
+
+} // namespace
+
+std::unique_ptr<pdcp_hdr_compressor> make_rohc_compressor(const pdcp_rohc_config_t& cfg)
+{
+  if (not cfg.enabled) {
+    return nullptr;
+  }
+  // The configured profiles are compressed with the uncompressed profile, which is always allowed
+  return std::unique_ptr<pdcp_hdr_compressor>(new rohc_uncompressed_profile(cfg));
+}
+
+} // namespace srslte
@@ -25,6 +25,7 @@
 #include "srslte/upper/rlc_tm.h"
 #include "srslte/upper/rlc_um_lte.h"
 #include "srslte/upper/rlc_um_nr.h"
+#include <algorithm>
 
 namespace srslte {
 
@@ -109,8 +110,10 @@ void rlc::get_metrics(rlc_metrics_t& m)
   get_time_interval(metrics_time);
   double secs = (double)metrics_time[0].tv_sec + metrics_time[0].tv_usec * 1e-6;
 
+  // The bearers count their metrics with atomic counters, so only the bearer maps need the lock
+  rwlock_read_guard lock(rwlock);
   for (rlc_map_t::iterator it = rlc_array.begin(); it != rlc_array.end(); ++it) {
-    rlc_bearer_metrics_t metrics = it->second->get_metrics();
+    rlc_bearer_metrics_t metrics = it->second->get_and_reset_metrics();
     rlc_log->info("LCID=%d, RX throughput: %4.6f Mbps. TX throughput: %4.6f Mbps.\n",
                   it->first,
                   (metrics.num_rx_pdu_bytes * 8 / static_cast<double>(1e6)) / secs,
@@ -120,7 +123,7 @@ void rlc::get_metrics(rlc_metrics_t& m)
 
   // Add multicast metrics
   for (rlc_map_t::iterator it = rlc_array_mrb.begin(); it != rlc_array_mrb.end(); ++it) {
-    rlc_bearer_metrics_t metrics = it->second->get_metrics();
+    rlc_bearer_metrics_t metrics = it->second->get_and_reset_metrics();
     rlc_log->info("MCH_LCID=%d, RX throughput: %4.6f Mbps\n",
                   it->first,
                   (metrics.num_rx_pdu_bytes * 8 / static_cast<double>(1e6)) / secs);
@@ -128,7 +131,6 @@ void rlc::get_metrics(rlc_metrics_t& m)
   }
 
   memcpy(&metrics_time[1], &metrics_time[2], sizeof(struct timeval));
-  reset_metrics();
 }
 
 // Reestablish all RLC bearer
@@ -201,6 +203,27 @@ void rlc::write_sdu(uint32_t lcid, unique_byte_buffer_t sdu)
   }
 }
 
+void rlc::write_sdus(uint32_t lcid, std::vector<unique_byte_buffer_t>& sdus)
+{
+  if (not valid_lcid(lcid)) {
+    rlc_log->warning("RLC LCID %d doesn't exist. Deallocating %zd SDUs\n", lcid, sdus.size());
+    sdus.clear();
+    return;
+  }
+
+  auto too_long = [this](const unique_byte_buffer_t& sdu) {
+    if (sdu->N_bytes > RLC_MAX_SDU_SIZE) {
+      rlc_log->warning("Dropping too long SDU of size %d B (Max. size %d B).\n", sdu->N_bytes, RLC_MAX_SDU_SIZE);
+      return true;
+    }
+    return false;
+  };
+  sdus.erase(std::remove_if(sdus.begin(), sdus.end(), too_long), sdus.end());
+
+  rlc_array.at(lcid)->write_sdus_s(sdus);
+  update_bsr(lcid);
+}
+
 void rlc::write_sdu_mch(uint32_t lcid, unique_byte_buffer_t sdu)
 {
   if (valid_lcid_mrb(lcid)) {
@@ -321,6 +344,16 @@ void rlc::write_pdu(uint32_t lcid, uint8_t* payload, uint32_t nof_bytes)
   }
 }
 
+void rlc::write_pdu(uint32_t lcid, srslte::unique_byte_buffer_t pdu)
+{
+  if (valid_lcid(lcid)) {
+    rlc_array.at(lcid)->write_pdu_s(std::move(pdu));
+    update_bsr(lcid);
+  } else {
+    rlc_log->warning("LCID %d doesn't exist. Dropping PDU.\n", lcid);
+  }
+}
+
 // Pass directly to PDCP, no DL througput counting done
 void rlc::write_pdu_bcch_bch(srslte::unique_byte_buffer_t pdu)
 {
@@ -21,6 +21,7 @@
 
 #include "srslte/upper/rlc_am_lte.h"
 
+#include <bitset>
 #include <iostream>
 #include <sstream>
 
@@ -108,11 +109,19 @@ uint32_t rlc_am_lte::get_bearer()
 
 rlc_bearer_metrics_t rlc_am_lte::get_metrics()
 {
-  return metrics;
+  return metrics.get();
+}
+
+rlc_bearer_metrics_t rlc_am_lte::get_and_reset_metrics()
+{
+  tx.reset_metrics();
+  rx.reset_metrics();
+  return metrics.read_and_reset();
 }
 
 void rlc_am_lte::reset_metrics()
 {
+  metrics.reset();
   tx.reset_metrics();
   rx.reset_metrics();
 }
@@ -168,6 +177,14 @@ void rlc_am_lte::write_pdu(uint8_t* payload, uint32_t nof_bytes)
   metrics.num_rx_pdu_bytes += nof_bytes;
 }
 
+void rlc_am_lte::write_pdu(unique_byte_buffer_t pdu)
+{
+  uint32_t nof_bytes = pdu->N_bytes;
+  rx.write_pdu(std::move(pdu));
+  metrics.num_rx_pdus++;
+  metrics.num_rx_pdu_bytes += nof_bytes;
+}
+
 /****************************************************************************
  * Tx subclass implementation
  ***************************************************************************/
@@ -180,6 +197,7 @@ rlc_am_lte::rlc_am_lte_tx::rlc_am_lte_tx(rlc_am_lte* parent_) :
   status_prohibit_timer(parent_->timers->get_unique_timer())
 {
   pthread_mutex_init(&mutex, NULL);
+  tx_sdu_queue.set_delay_histograms(&parent_->metrics.queue_delay, &parent_->metrics.upper_delay);
 }
 
 rlc_am_lte::rlc_am_lte_tx::~rlc_am_lte_tx()
@@ -215,6 +233,12 @@ bool rlc_am_lte::rlc_am_lte_tx::configure(const rlc_config_t& cfg_)
 
   tx_sdu_queue.resize(cfg_.tx_queue_length);
 
+  aqm.reset(cfg_.aqm.mode != rlc_aqm_mode_t::none ? new rlc_aqm(cfg_.aqm) : nullptr);
+  tx_sdu_queue.set_aqm(aqm.get(), &parent->metrics.num_lost_sdus);
+  if (aqm != nullptr) {
+    log->info("%s Tx SDU queue managed by %s\n", RB_NAME, to_string(cfg_.aqm.mode).c_str());
+  }
+
   tx_enabled = true;
 
   return true;
@@ -315,7 +339,7 @@ uint32_t rlc_am_lte::rlc_am_lte_tx::get_buffer_state()
                retx.is_segment ? "true" : "false",
                retx.so_start,
                retx.so_end);
-    if (tx_window.end() != tx_window.find(retx.sn)) {
+    if (tx_window.has_sn(retx.sn)) {
       int req_bytes = required_buffer_size(retx);
       if (req_bytes < 0) {
         log->error("In get_buffer_state(): Removing retx.sn=%d from queue\n", retx.sn);
@@ -461,14 +485,17 @@ void rlc_am_lte::rlc_am_lte_tx::retransmit_random_pdu()
 {
   if (not tx_window.empty()) {
     // randomly select PDU in tx window for retransmission
-    std::map<uint32_t, rlc_amd_tx_pdu_t>::iterator it = tx_window.begin();
-    std::advance(it, rand() % tx_window.size());
-    log->info("Schedule SN=%d for reTx.\n", it->first);
+    uint32_t       n    = rand() % tx_window.size();
     rlc_amd_retx_t retx = {};
-    retx.is_segment     = false;
-    retx.so_start       = 0;
-    retx.so_end         = it->second.buf->N_bytes;
-    retx.sn             = it->first;
+    tx_window.for_each([&n, &retx](uint32_t sn, rlc_amd_tx_pdu_t& pdu) {
+      if (n-- == 0) {
+        retx.so_end = pdu.buf->N_bytes;
+        retx.sn     = sn;
+      }
+    });
+    log->info("Schedule SN=%d for reTx.\n", retx.sn);
+    retx.is_segment = false;
+    retx.so_start   = 0;
     retx_queue.push_back(retx);
   }
 }
@@ -566,7 +593,7 @@ int rlc_am_lte::rlc_am_lte_tx::build_retx_pdu(uint8_t* payload, uint32_t nof_byt
   rlc_amd_retx_t retx = retx_queue.front();
 
   // Sanity check - drop any retx SNs not present in tx_window
-  while (tx_window.end() == tx_window.find(retx.sn)) {
+  while (not tx_window.has_sn(retx.sn)) {
     retx_queue.pop_front();
     if (!retx_queue.empty()) {
       retx = retx_queue.front();
@@ -629,7 +656,7 @@ int rlc_am_lte::rlc_am_lte_tx::build_retx_pdu(uint8_t* payload, uint32_t nof_byt
 
 int rlc_am_lte::rlc_am_lte_tx::build_segment(uint8_t* payload, uint32_t nof_bytes, rlc_amd_retx_t retx)
 {
-  if (tx_window[retx.sn].buf == NULL) {
+  if (not tx_window.has_sn(retx.sn) || tx_window[retx.sn].buf == NULL) {
     log->error("In build_segment: retx.sn=%d has null buffer\n", retx.sn);
     return 0;
   }
@@ -808,10 +835,7 @@ int rlc_am_lte::rlc_am_lte_tx::build_data_pdu(uint8_t* payload, uint32_t nof_byt
     srslte::console("tx_window size: %zd PDUs\n", tx_window.size());
     srslte::console("vt_a = %d, vt_ms = %d, vt_s = %d, poll_sn = %d\n", vt_a, vt_ms, vt_s, poll_sn);
     srslte::console("retx_queue size: %zd PDUs\n", retx_queue.size());
-    std::map<uint32_t, rlc_amd_tx_pdu_t>::iterator txit;
-    for (txit = tx_window.begin(); txit != tx_window.end(); txit++) {
-      srslte::console("tx_window - SN=%d\n", txit->first);
-    }
+    tx_window.for_each([](uint32_t sn, rlc_amd_tx_pdu_t& tx_pdu) { srslte::console("tx_window - SN=%d\n", sn); });
     exit(-1);
 #else
     log->error("Fatal Error: Couldn't allocate PDU in build_data_pdu().\n");
@@ -933,11 +957,12 @@ int rlc_am_lte::rlc_am_lte_tx::build_data_pdu(uint8_t* payload, uint32_t nof_byt
   vt_s      = (vt_s + 1) % MOD;
 
   // Place PDU in tx_window, write header and TX
-  tx_window[header.sn].buf        = std::move(pdu);
-  tx_window[header.sn].header     = header;
-  tx_window[header.sn].is_acked   = false;
-  tx_window[header.sn].retx_count = 0;
-  const byte_buffer_t* buffer_ptr = tx_window[header.sn].buf.get();
+  rlc_amd_tx_pdu_t& tx_pdu        = tx_window.add_pdu(header.sn);
+  tx_pdu.buf                      = std::move(pdu);
+  tx_pdu.header                   = header;
+  tx_pdu.is_acked                 = false;
+  tx_pdu.retx_count               = 0;
+  const byte_buffer_t* buffer_ptr = tx_pdu.buf.get();
 
   uint8_t* ptr = payload;
   rlc_am_write_data_pdu_header(&header, &ptr);
@@ -969,45 +994,50 @@ void rlc_am_lte::rlc_am_lte_tx::handle_control_pdu(uint8_t* payload, uint32_t no
     retx_queue.clear();
   }
 
+  // Mark the NACKed SNs, so that the walk over the window only looks for the NACKs of these
+  std::bitset<RLC_AM_WINDOW_SIZE> nacked;
+  for (uint32_t j = 0; j < status.N_nack; j++) {
+    nacked.set(status.nacks[j].nack_sn % RLC_AM_WINDOW_SIZE);
+  }
+
   // Handle ACKs and NACKs
-  std::map<uint32_t, rlc_amd_tx_pdu_t>::iterator it;
-  bool                                           update_vt_a = true;
-  uint32_t                                       i           = vt_a;
+  bool     update_vt_a = true;
+  uint32_t i           = vt_a;
 
   while (TX_MOD_BASE(i) < TX_MOD_BASE(status.ack_sn) && TX_MOD_BASE(i) < TX_MOD_BASE(vt_s)) {
     bool nack = false;
-    for (uint32_t j = 0; j < status.N_nack; j++) {
+    for (uint32_t j = 0; nacked.test(i % RLC_AM_WINDOW_SIZE) && j < status.N_nack; j++) {
       if (status.nacks[j].nack_sn == i) {
         nack        = true;
         update_vt_a = false;
-        it          = tx_window.find(i);
-        if (tx_window.end() != it) {
+        if (tx_window.has_sn(i)) {
+          rlc_amd_tx_pdu_t& pdu = tx_window[i];
           if (!retx_queue_has_sn(i)) {
             rlc_amd_retx_t retx = {};
             retx.sn             = i;
             retx.is_segment     = false;
             retx.so_start       = 0;
-            retx.so_end         = it->second.buf->N_bytes;
+            retx.so_end         = pdu.buf->N_bytes;
 
             if (status.nacks[j].has_so) {
               // sanity check
-              if (status.nacks[j].so_start >= it->second.buf->N_bytes) {
+              if (status.nacks[j].so_start >= pdu.buf->N_bytes) {
                 // print error but try to send original PDU again
                 log->info("SO_start is larger than original PDU (%d >= %d)\n",
                           status.nacks[j].so_start,
-                          it->second.buf->N_bytes);
+                          pdu.buf->N_bytes);
                 status.nacks[j].so_start = 0;
               }
 
               // check for special SO_end value
               if (status.nacks[j].so_end == 0x7FFF) {
-                status.nacks[j].so_end = it->second.buf->N_bytes;
+                status.nacks[j].so_end = pdu.buf->N_bytes;
               } else {
                 retx.so_end = status.nacks[j].so_end + 1;
               }
 
-              if (status.nacks[j].so_start < it->second.buf->N_bytes &&
-                  status.nacks[j].so_end <= it->second.buf->N_bytes) {
+              if (status.nacks[j].so_start < pdu.buf->N_bytes &&
+                  status.nacks[j].so_end <= pdu.buf->N_bytes) {
                 retx.is_segment = true;
                 retx.so_start   = status.nacks[j].so_start;
               } else {
@@ -1016,7 +1046,7 @@ void rlc_am_lte::rlc_am_lte_tx::handle_control_pdu(uint8_t* payload, uint32_t no
                              i,
                              status.nacks[j].so_start,
                              status.nacks[j].so_end,
-                             it->second.buf->N_bytes);
+                             pdu.buf->N_bytes);
               }
             }
             retx_queue.push_back(retx);
@@ -1027,15 +1057,10 @@ void rlc_am_lte::rlc_am_lte_tx::handle_control_pdu(uint8_t* payload, uint32_t no
 
     if (!nack) {
       // ACKed SNs get marked and removed from tx_window if possible
-      if (tx_window.count(i) > 0) {
-        it = tx_window.find(i);
-        if (it != tx_window.end()) {
-          if (update_vt_a) {
-            tx_window.erase(it);
-            vt_a  = (vt_a + 1) % MOD;
-            vt_ms = (vt_ms + 1) % MOD;
-          }
-        }
+      if (tx_window.has_sn(i) && update_vt_a) {
+        tx_window.remove_pdu(i);
+        vt_a  = (vt_a + 1) % MOD;
+        vt_ms = (vt_ms + 1) % MOD;
       }
     }
     i = (i + 1) % MOD;
@@ -1054,7 +1079,7 @@ void rlc_am_lte::rlc_am_lte_tx::debug_state()
 int rlc_am_lte::rlc_am_lte_tx::required_buffer_size(rlc_amd_retx_t retx)
 {
   if (!retx.is_segment) {
-    if (tx_window.count(retx.sn) == 1) {
+    if (tx_window.has_sn(retx.sn)) {
       if (tx_window[retx.sn].buf) {
         return rlc_am_packed_length(&tx_window[retx.sn].header) + tx_window[retx.sn].buf->N_bytes;
       } else {
@@ -1210,11 +1235,13 @@ void rlc_am_lte::rlc_am_lte_rx::stop()
  * @param payload Pointer to payload
  * @param nof_bytes Payload length
  * @param header Reference to PDU header (unpacked by caller)
+ * @param pdu Buffer the payload is in, kept in the Rx window instead of a copy. If null, the payload is copied
  */
-void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_bytes, rlc_amd_pdu_header_t& header)
+void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu(uint8_t*              payload,
+                                                uint32_t              nof_bytes,
+                                                rlc_amd_pdu_header_t& header,
+                                                unique_byte_buffer_t  pdu_buf)
 {
-  std::map<uint32_t, rlc_amd_rx_pdu_t>::iterator it;
-
   log->info_hex(payload, nof_bytes, "%s Rx data PDU SN=%d (%d B)", RB_NAME, header.sn, nof_bytes);
   log->debug("%s\n", rlc_amd_pdu_header_to_string(header).c_str());
 
@@ -1239,8 +1266,7 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_b
     return;
   }
 
-  it = rx_window.find(header.sn);
-  if (rx_window.end() != it) {
+  if (rx_window.has_sn(header.sn)) {
     if (header.p) {
       log->info("%s Status packet requested through polling bit\n", RB_NAME);
       do_status = true;
@@ -1249,33 +1275,39 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_b
     return;
   }
 
-  // Write to rx window
+  // Write to rx window. The PDU is only read from once it is there, so it gets a buffer of its size
   rlc_amd_rx_pdu_t pdu;
-  pdu.buf = srslte::allocate_unique_buffer(*pool, true);
-  if (pdu.buf == NULL) {
+  if (pdu_buf != nullptr) {
+    // Keep the buffer of the caller, without the header
+    pdu.buf      = std::move(pdu_buf);
+    pdu.buf->msg = payload;
+  } else {
+    pdu.buf = srslte::allocate_unique_buffer(*pool, nof_bytes, nullptr, true);
+    if (pdu.buf == NULL) {
 #ifdef RLC_AM_BUFFER_DEBUG
-    srslte::console("Fatal Error: Couldn't allocate PDU in handle_data_pdu().\n");
-    exit(-1);
+      srslte::console("Fatal Error: Couldn't allocate PDU in handle_data_pdu().\n");
+      exit(-1);
 #else
-    log->error("Fatal Error: Couldn't allocate PDU in handle_data_pdu().\n");
-    return;
+      log->error("Fatal Error: Couldn't allocate PDU in handle_data_pdu().\n");
+      return;
 #endif
-  }
+    }
 
-  // check available space for payload
-  if (nof_bytes > pdu.buf->get_tailroom()) {
-    log->error("%s Discarding SN=%d of size %d B (available space %d B)\n",
-               RB_NAME,
-               header.sn,
-               nof_bytes,
-               pdu.buf->get_tailroom());
-    return;
+    // check available space for payload
+    if (nof_bytes > pdu.buf->get_tailroom()) {
+      log->error("%s Discarding SN=%d of size %d B (available space %d B)\n",
+                 RB_NAME,
+                 header.sn,
+                 nof_bytes,
+                 pdu.buf->get_tailroom());
+      return;
+    }
+    memcpy(pdu.buf->msg, payload, nof_bytes);
   }
-  memcpy(pdu.buf->msg, payload, nof_bytes);
   pdu.buf->N_bytes = nof_bytes;
   pdu.header       = header;
 
-  rx_window[header.sn] = std::move(pdu);
+  rx_window.add_pdu(header.sn) = std::move(pdu);
 
   // Update vr_h
   if (RX_MOD_BASE(header.sn) >= RX_MOD_BASE(vr_h)) {
@@ -1283,10 +1315,8 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_b
   }
 
   // Update vr_ms
-  it = rx_window.find(vr_ms);
-  while (rx_window.end() != it) {
+  while (rx_window.has_sn(vr_ms)) {
     vr_ms = (vr_ms + 1) % MOD;
-    it    = rx_window.find(vr_ms);
   }
 
   // Check poll bit
@@ -1335,8 +1365,6 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu_segment(uint8_t*              pa
                                                         uint32_t              nof_bytes,
                                                         rlc_amd_pdu_header_t& header)
 {
-  std::map<uint32_t, rlc_amd_rx_pdu_segments_t>::iterator it;
-
   log->info_hex(payload,
                 nof_bytes,
                 "%s Rx data PDU segment of SN=%d (%d B), SO=%d, N_li=%d",
@@ -1358,7 +1386,7 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu_segment(uint8_t*              pa
   }
 
   rlc_amd_rx_pdu_t segment;
-  segment.buf = srslte::allocate_unique_buffer(*pool, true);
+  segment.buf = srslte::allocate_unique_buffer(*pool, nof_bytes, nullptr, true);
   if (segment.buf == NULL) {
 #ifdef RLC_AM_BUFFER_DEBUG
     srslte::console("Fatal Error: Couldn't allocate PDU in handle_data_pdu_segment().\n");
@@ -1379,8 +1407,7 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu_segment(uint8_t*              pa
   segment.header       = header;
 
   // Check if we already have a segment from the same PDU
-  it = rx_segments.find(header.sn);
-  if (rx_segments.end() != it) {
+  if (rx_segments.has_sn(header.sn)) {
 
     if (header.p) {
       log->info("%s Status packet requested through polling bit\n", RB_NAME);
@@ -1389,16 +1416,14 @@ void rlc_am_lte::rlc_am_lte_rx::handle_data_pdu_segment(uint8_t*              pa
 
     // Add segment to PDU list and check for complete
     // NOTE: MAY MOVE. Preference would be to capture by value, and then move; but header is stack allocated
-    if (add_segment_and_check(&it->second, &segment)) {
-      rx_segments.erase(it);
+    if (add_segment_and_check(&rx_segments[header.sn], &segment)) {
+      rx_segments.remove_pdu(header.sn);
     }
 
   } else {
 
     // Create new PDU segment list and write to rx_segments
-    rlc_amd_rx_pdu_segments_t pdu;
-    pdu.segments.push_back(std::move(segment));
-    rx_segments[header.sn] = std::move(pdu);
+    rx_segments.add_pdu(header.sn).segments.push_back(std::move(segment));
 
     // Update vr_h
     if (RX_MOD_BASE(header.sn) >= RX_MOD_BASE(vr_h)) {
@@ -1440,7 +1465,7 @@ void rlc_am_lte::rlc_am_lte_rx::reassemble_rx_sdus()
   }
 
   // Iterate through rx_window, assembling and delivering SDUs
-  while (rx_window.end() != rx_window.find(vr_r)) {
+  while (rx_window.has_sn(vr_r)) {
     // Handle any SDU segments
     for (uint32_t i = 0; i < rx_window[vr_r].header.N_li; i++) {
       len = rx_window[vr_r].header.li[i];
@@ -1459,7 +1484,7 @@ void rlc_am_lte::rlc_am_lte_rx::reassemble_rx_sdus()
       }
 
       if (rx_sdu->get_tailroom() >= len) {
-        if ((rx_window[vr_r].buf->msg - rx_window[vr_r].buf->buffer) + len < SRSLTE_MAX_BUFFER_SIZE_BYTES) {
+        if ((rx_window[vr_r].buf->msg - rx_window[vr_r].buf->buffer) + len < rx_window[vr_r].buf->get_capacity()) {
           if (rx_window[vr_r].buf->N_bytes < len) {
             log->error("Dropping corrupted SN=%d\n", vr_r);
             rx_sdu.reset();
@@ -1537,21 +1562,19 @@ void rlc_am_lte::rlc_am_lte_rx::reassemble_rx_sdus()
     // Move the rx_window
     log->debug("Erasing SN=%d.\n", vr_r);
     // also erase any segments of this SN
-    std::map<uint32_t, rlc_amd_rx_pdu_segments_t>::iterator it;
-    it = rx_segments.find(vr_r);
-    if (rx_segments.end() != it) {
+    if (rx_segments.has_sn(vr_r)) {
       log->debug("Erasing segments of SN=%d\n", vr_r);
       std::list<rlc_amd_rx_pdu_t>::iterator segit;
-      for (segit = it->second.segments.begin(); segit != it->second.segments.end(); ++segit) {
+      for (segit = rx_segments[vr_r].segments.begin(); segit != rx_segments[vr_r].segments.end(); ++segit) {
         log->debug(" Erasing segment of SN=%d SO=%d Len=%d N_li=%d\n",
                    segit->header.sn,
                    segit->header.so,
                    segit->buf->N_bytes,
                    segit->header.N_li);
       }
-      it->second.segments.clear();
+      rx_segments.remove_pdu(vr_r);
     }
-    rx_window.erase(vr_r);
+    rx_window.remove_pdu(vr_r);
     vr_r  = (vr_r + 1) % MOD;
     vr_mr = (vr_mr + 1) % MOD;
   }
@@ -1583,6 +1606,18 @@ void rlc_am_lte::rlc_am_lte_rx::reset_metrics()
 }
 
 void rlc_am_lte::rlc_am_lte_rx::write_pdu(uint8_t* payload, const uint32_t nof_bytes)
+{
+  write_pdu(payload, nof_bytes, nullptr);
+}
+
+void rlc_am_lte::rlc_am_lte_rx::write_pdu(unique_byte_buffer_t pdu)
+{
+  uint8_t* payload   = pdu->msg;
+  uint32_t nof_bytes = pdu->N_bytes;
+  write_pdu(payload, nof_bytes, std::move(pdu));
+}
+
+void rlc_am_lte::rlc_am_lte_rx::write_pdu(uint8_t* payload, const uint32_t nof_bytes, unique_byte_buffer_t pdu)
 {
   if (nof_bytes < 1)
     return;
@@ -1606,7 +1641,7 @@ void rlc_am_lte::rlc_am_lte_rx::write_pdu(uint8_t* payload, const uint32_t nof_b
     if (header.rf) {
       handle_data_pdu_segment(payload, payload_len, header);
     } else {
-      handle_data_pdu(payload, payload_len, header);
+      handle_data_pdu(payload, payload_len, header, std::move(pdu));
     }
     pthread_mutex_unlock(&mutex);
   }
@@ -1624,11 +1659,9 @@ void rlc_am_lte::rlc_am_lte_rx::timer_expired(uint32_t timeout_id)
     log->debug("%s reordering timeout expiry - updating vr_ms (was %d)\n", RB_NAME, vr_ms);
 
     // 36.322 v10 Section 5.1.3.2.4
-    vr_ms                                             = vr_x;
-    std::map<uint32_t, rlc_amd_rx_pdu_t>::iterator it = rx_window.find(vr_ms);
-    while (rx_window.end() != it) {
+    vr_ms = vr_x;
+    while (rx_window.has_sn(vr_ms)) {
       vr_ms = (vr_ms + 1) % MOD;
-      it    = rx_window.find(vr_ms);
     }
 
     if (poll_received) {
@@ -1652,38 +1685,51 @@ int rlc_am_lte::rlc_am_lte_rx::get_status_pdu(rlc_status_pdu_t* status, const ui
   status->N_nack = 0;
   status->ack_sn = vr_r; // start with lower edge of the rx window
 
-  // We don't use segment NACKs - just NACK the full PDU
-  uint32_t i = vr_r;
-  while (RX_MOD_BASE(i) < RX_MOD_BASE(vr_ms) && status->N_nack < RLC_AM_WINDOW_SIZE) {
-    if (rx_window.find(i) == rx_window.end()) {
-      status->nacks[status->N_nack].nack_sn = i;
+  // We don't use segment NACKs - just NACK the full PDU, so every NACK takes 12 bits after the 15 bit fixed part
+  uint32_t nof_sn    = RX_MOD_BASE(vr_ms);
+  uint32_t max_nacks = 0;
+  if (max_pdu_size * 8 >= 15) {
+    max_nacks = (max_pdu_size * 8 - 15) / 12;
+  } else {
+    log->warning("Failed to generate small enough status PDU (max_pdu_size=%d)\n", max_pdu_size);
+    nof_sn = 0;
+  }
+
+  // Scan the rx window 64 SNs at a time, NACKing the ones missing from the bitmap
+  for (uint32_t offset = 0; offset < nof_sn; offset += 64) {
+    uint32_t sn       = (vr_r + offset) % MOD;
+    uint32_t nof_bits = SRSLTE_MIN(64, nof_sn - offset);
+    uint64_t mask     = (nof_bits == 64) ? ~0ULL : ((1ULL << nof_bits) - 1);
+    uint64_t received = rx_window.occupancy(sn);
+    bool     full     = false;
+    for (uint64_t missing = ~received & mask; missing != 0; missing &= missing - 1) {
+      uint32_t i = __builtin_ctzll(missing);
+      if (status->N_nack == max_nacks) {
+        // Ignore from here on, including the SNs received afterwards
+        log->debug("Status PDU too big, leaving out NACK SN=%d\n", (sn + i) % MOD);
+        mask = (1ULL << i) - 1;
+        full = true;
+        break;
+      }
+      status->nacks[status->N_nack].nack_sn = (sn + i) % MOD;
       status->N_nack++;
-    } else {
-      // only update ACK_SN if this SN has been received
-      status->ack_sn = i;
-    }
-
-    // make sure we don't exceed grant size
-    if (rlc_am_packed_length(status) > max_pdu_size) {
-      log->debug("Status PDU too big (%d > %d)\n", rlc_am_packed_length(status), max_pdu_size);
-      if (status->N_nack >= 1 && status->N_nack < RLC_AM_WINDOW_SIZE) {
-        log->debug("Removing last NACK SN=%d\n", status->nacks[status->N_nack].nack_sn);
-        status->N_nack--;
-        // make sure we don't have the current ACK_SN in the NACK list
-        if (rlc_am_is_valid_status_pdu(*status) == false) {
-          // No space to send any NACKs
-          log->debug("Resetting N_nack to zero\n");
-          status->N_nack = 0;
-        }
-      } else {
-        log->warning("Failed to generate small enough status PDU (packed_len=%d, max_pdu_size=%d, status->N_nack=%d)\n",
-                     rlc_am_packed_length(status),
-                     max_pdu_size,
-                     status->N_nack);
+    }
+
+    // only update ACK_SN with the highest SN received
+    received &= mask;
+    if (received != 0) {
+      status->ack_sn = (sn + 63 - __builtin_clzll(received)) % MOD;
+    }
+
+    if (full) {
+      // make sure we don't have the current ACK_SN in the NACK list
+      if (rlc_am_is_valid_status_pdu(*status) == false) {
+        // No space to send any NACKs
+        log->debug("Resetting N_nack to zero\n");
+        status->N_nack = 0;
       }
       break;
     }
-    i = (i + 1) % MOD;
   }
 
   pthread_mutex_unlock(&mutex);
@@ -1694,31 +1740,28 @@ int rlc_am_lte::rlc_am_lte_rx::get_status_pdu(rlc_status_pdu_t* status, const ui
 int rlc_am_lte::rlc_am_lte_rx::get_status_pdu_length()
 {
   pthread_mutex_lock(&mutex);
-  rlc_status_pdu_t status = {};
-  status.ack_sn           = vr_ms;
-  uint32_t i              = vr_r;
-  while (RX_MOD_BASE(i) < RX_MOD_BASE(vr_ms) && status.N_nack < RLC_AM_WINDOW_SIZE) {
-    if (rx_window.find(i) == rx_window.end()) {
-      status.N_nack++;
-    }
-    i = (i + 1) % MOD;
+  uint32_t nof_nacks = 0;
+  uint32_t nof_sn    = RX_MOD_BASE(vr_ms);
+  for (uint32_t offset = 0; offset < nof_sn; offset += 64) {
+    uint32_t nof_bits = SRSLTE_MIN(64, nof_sn - offset);
+    uint64_t mask     = (nof_bits == 64) ? ~0ULL : ((1ULL << nof_bits) - 1);
+    nof_nacks += __builtin_popcountll(~rx_window.occupancy((vr_r + offset) % MOD) & mask);
   }
   pthread_mutex_unlock(&mutex);
-  return rlc_am_packed_length(&status);
+  // Same as rlc_am_packed_length() of a status PDU without segment NACKs
+  return (15 + 12 * nof_nacks + 7) / 8;
 }
 
 void rlc_am_lte::rlc_am_lte_rx::print_rx_segments()
 {
-  std::map<uint32_t, rlc_amd_rx_pdu_segments_t>::iterator it;
-  std::stringstream                                       ss;
+  std::stringstream ss;
   ss << "rx_segments:" << std::endl;
-  for (it = rx_segments.begin(); it != rx_segments.end(); it++) {
-    std::list<rlc_amd_rx_pdu_t>::iterator segit;
-    for (segit = it->second.segments.begin(); segit != it->second.segments.end(); segit++) {
-      ss << "    SN=" << segit->header.sn << " SO:" << segit->header.so << " N:" << segit->buf->N_bytes
-         << " N_li: " << segit->header.N_li << std::endl;
+  rx_segments.for_each([&ss](uint32_t sn, rlc_amd_rx_pdu_segments_t& pdu) {
+    for (const rlc_amd_rx_pdu_t& segment : pdu.segments) {
+      ss << "    SN=" << segment.header.sn << " SO:" << segment.header.so << " N:" << segment.buf->N_bytes
+         << " N_li: " << segment.header.N_li << std::endl;
     }
-  }
+  });
   log->debug("%s\n", ss.str().c_str());
 }
 
@@ -2030,32 +2073,99 @@ void rlc_am_read_status_pdu(byte_buffer_t* pdu, rlc_status_pdu_t* status)
   rlc_am_read_status_pdu(pdu->msg, pdu->N_bytes, status);
 }
 
-void rlc_am_read_status_pdu(uint8_t* payload, uint32_t nof_bytes, rlc_status_pdu_t* status)
+// Reads MSB-first bit fields of up to 32 bits, refilling a 64-bit accumulator 32 bits at a time. Reads past the end
+// of the buffer return zeros
+class status_bit_reader
 {
-  uint32_t     i;
-  uint8_t      ext1, ext2;
-  bit_buffer_t tmp;
-  uint8_t*     ptr = tmp.msg;
+public:
+  status_bit_reader(const uint8_t* ptr_, uint32_t nof_bytes) : ptr(ptr_), end(ptr_ + nof_bytes) {}
+
+  uint32_t read(uint32_t nof_bits)
+  {
+    if (acc_bits < nof_bits && end - ptr >= 4) {
+      acc = (acc << 32u) | ((uint32_t)ptr[0] << 24u) | ((uint32_t)ptr[1] << 16u) | ((uint32_t)ptr[2] << 8u) | ptr[3];
+      ptr += 4;
+      acc_bits += 32;
+    }
+    while (acc_bits < nof_bits) {
+      acc = (acc << 8u) | (ptr < end ? *ptr++ : 0);
+      acc_bits += 8;
+    }
+    acc_bits -= nof_bits;
+    return (acc >> acc_bits) & ((1ULL << nof_bits) - 1);
+  }
 
-  srslte_bit_unpack_vector(payload, tmp.msg, nof_bytes * 8);
-  tmp.N_bits = nof_bytes * 8;
+  bool empty() const { return ptr == end && acc_bits == 0; }
 
-  rlc_dc_field_t dc = static_cast<rlc_dc_field_t>(srslte_bit_pack(&ptr, 1));
+private:
+  const uint8_t* ptr;
+  const uint8_t* end;
+  uint64_t       acc      = 0;
+  uint32_t       acc_bits = 0;
+};
+
+// Writes MSB-first bit fields of up to 32 bits, storing the accumulated bits 32 at a time
+class status_bit_writer
+{
+public:
+  explicit status_bit_writer(uint8_t* ptr_) : start(ptr_), ptr(ptr_) {}
+
+  void write(uint32_t value, uint32_t nof_bits)
+  {
+    acc = (acc << nof_bits) | (value & ((1ULL << nof_bits) - 1));
+    acc_bits += nof_bits;
+    if (acc_bits >= 32) {
+      acc_bits -= 32;
+      uint32_t word = acc >> acc_bits;
+      ptr[0]        = word >> 24u;
+      ptr[1]        = word >> 16u;
+      ptr[2]        = word >> 8u;
+      ptr[3]        = word;
+      ptr += 4;
+    }
+  }
+
+  /// Pads the last byte with zeros and returns the number of bytes written
+  uint32_t flush()
+  {
+    while (acc_bits >= 8) {
+      acc_bits -= 8;
+      *ptr++ = acc >> acc_bits;
+    }
+    if (acc_bits > 0) {
+      *ptr++   = acc << (8 - acc_bits);
+      acc_bits = 0;
+    }
+    return ptr - start;
+  }
+
+private:
+  uint8_t* start;
+  uint8_t* ptr;
+  uint64_t acc      = 0;
+  uint32_t acc_bits = 0;
+};
+
+void rlc_am_read_status_pdu(uint8_t* payload, uint32_t nof_bytes, rlc_status_pdu_t* status)
+{
+  status_bit_reader reader(payload, nof_bytes);
+
+  rlc_dc_field_t dc = static_cast<rlc_dc_field_t>(reader.read(1));
 
   if (RLC_DC_FIELD_CONTROL_PDU == dc) {
-    uint8_t cpt = srslte_bit_pack(&ptr, 3); // 3-bit Control PDU Type (0 == status)
+    uint8_t cpt = reader.read(3); // 3-bit Control PDU Type (0 == status)
     if (0 == cpt) {
-      status->ack_sn = srslte_bit_pack(&ptr, 10); // 10 bits ACK_SN
-      ext1           = srslte_bit_pack(&ptr, 1);  // 1 bits E1
+      status->ack_sn = reader.read(10); // 10 bits ACK_SN
+      uint8_t ext1   = reader.read(1);  // 1 bits E1
       status->N_nack = 0;
-      while (ext1) {
-        status->nacks[status->N_nack].nack_sn = srslte_bit_pack(&ptr, 10);
-        ext1                                  = srslte_bit_pack(&ptr, 1); // 1 bits E1
-        ext2                                  = srslte_bit_pack(&ptr, 1); // 1 bits E2
-        if (ext2) {
-          status->nacks[status->N_nack].has_so   = true;
-          status->nacks[status->N_nack].so_start = srslte_bit_pack(&ptr, 15);
-          status->nacks[status->N_nack].so_end   = srslte_bit_pack(&ptr, 15);
+      while (ext1 && status->N_nack < RLC_AM_WINDOW_SIZE && not reader.empty()) {
+        rlc_status_nack_t& nack = status->nacks[status->N_nack];
+        nack.nack_sn            = reader.read(10);
+        ext1                    = reader.read(1); // 1 bits E1
+        nack.has_so             = reader.read(1); // 1 bits E2
+        if (nack.has_so) {
+          nack.so_start = reader.read(15);
+          nack.so_end   = reader.read(15);
         }
         status->N_nack++;
       }
@@ -2070,38 +2180,27 @@ void rlc_am_write_status_pdu(rlc_status_pdu_t* status, byte_buffer_t* pdu)
 
 int rlc_am_write_status_pdu(rlc_status_pdu_t* status, uint8_t* payload)
 {
-  uint32_t     i;
-  uint8_t      ext1;
-  bit_buffer_t tmp;
-  uint8_t*     ptr = tmp.msg;
-
-  srslte_bit_unpack(RLC_DC_FIELD_CONTROL_PDU, &ptr, 1); // D/C
-  srslte_bit_unpack(0, &ptr, 3);                        // CPT (0 == STATUS)
-  srslte_bit_unpack(status->ack_sn, &ptr, 10);          // 10 bit ACK_SN
-  ext1 = (status->N_nack == 0) ? 0 : 1;
-  srslte_bit_unpack(ext1, &ptr, 1); // E1
-  for (i = 0; i < status->N_nack; i++) {
-    srslte_bit_unpack(status->nacks[i].nack_sn, &ptr, 10); // 10 bit NACK_SN
-    ext1 = ((status->N_nack - 1) == i) ? 0 : 1;
-    srslte_bit_unpack(ext1, &ptr, 1); // E1
-    if (status->nacks[i].has_so) {
-      srslte_bit_unpack(1, &ptr, 1); // E2
-      srslte_bit_unpack(status->nacks[i].so_start, &ptr, 15);
-      srslte_bit_unpack(status->nacks[i].so_end, &ptr, 15);
+  status_bit_writer writer(payload);
+
+  writer.write(RLC_DC_FIELD_CONTROL_PDU, 1);     // D/C
+  writer.write(0, 3);                            // CPT (0 == STATUS)
+  writer.write(status->ack_sn, 10);              // 10 bit ACK_SN
+  writer.write(status->N_nack == 0 ? 0 : 1, 1); // E1
+  for (uint32_t i = 0; i < status->N_nack; i++) {
+    const rlc_status_nack_t& nack = status->nacks[i];
+    writer.write(nack.nack_sn, 10);                     // 10 bit NACK_SN
+    writer.write((status->N_nack - 1) == i ? 0 : 1, 1); // E1
+    if (nack.has_so) {
+      writer.write(1, 1); // E2
+      writer.write(nack.so_start, 15);
+      writer.write(nack.so_end, 15);
     } else {
-      srslte_bit_unpack(0, &ptr, 1); // E2
+      writer.write(0, 1); // E2
     }
   }
 
-  // Pad
-  tmp.N_bits    = ptr - tmp.msg;
-  uint8_t n_pad = 8 - (tmp.N_bits % 8);
-  srslte_bit_unpack(0, &ptr, n_pad);
-  tmp.N_bits = ptr - tmp.msg;
-
-  // Pack bits
-  srslte_bit_pack_vector(tmp.msg, payload, tmp.N_bits);
-  return tmp.N_bits / 8;
+  // Pad to a byte
+  return writer.flush();
 }
 
 bool rlc_am_is_valid_status_pdu(const rlc_status_pdu_t& status)
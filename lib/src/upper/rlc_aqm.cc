@@ -0,0 +1,184 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/upper/rlc_aqm.h"
+#include <math.h>
+
+namespace srslte {
+
+// PIE parameters of RFC 8033, for delays in seconds
+static const double pie_alpha          = 0.125;
+static const double pie_beta           = 1.25;
+static const double pie_max_burst_s    = 0.15;
+static const double pie_max_prob_step  = 0.02;
+static const double pie_high_qdelay_s  = 0.25;
+static const double pie_prob_decay     = 0.98;
+static const double pie_safe_drop_prob = 0.2;
+static const double pie_min_accu_prob  = 0.85;
+static const double pie_max_accu_prob  = 8.5;
+
+const uint32_t rlc_aqm::mtu_bytes;
+
+rlc_aqm::rlc_aqm(const rlc_aqm_config_t& cfg) : mode(cfg.mode)
+{
+  uint32_t target_ms   = cfg.target_ms;
+  uint32_t interval_ms = cfg.interval_ms;
+  if (target_ms == 0) {
+    target_ms = (mode == rlc_aqm_mode_t::pie) ? 15 : 5;
+  }
+  if (interval_ms == 0) {
+    interval_ms = (mode == rlc_aqm_mode_t::pie) ? 15 : 100;
+  }
+  target_ns           = target_ms * 1000000ULL;
+  interval_ns         = interval_ms * 1000000ULL;
+  pie.burst_allowance = pie_max_burst_s;
+}
+
+bool rlc_aqm::drop_head(uint64_t enqueue_ns, uint64_t now_ns, uint32_t queue_bytes)
+{
+  uint64_t sojourn_ns = (enqueue_ns != 0 and now_ns > enqueue_ns) ? now_ns - enqueue_ns : 0;
+  switch (mode) {
+    case rlc_aqm_mode_t::codel:
+      return codel_drop(sojourn_ns, now_ns, queue_bytes);
+    case rlc_aqm_mode_t::pie:
+      return pie_drop(sojourn_ns, now_ns, queue_bytes);
+    default:
+      return false;
+  }
+}
+
+/// Dequeue of RFC 8289, called for every SDU taken from the queue instead of looping over the queue
+bool rlc_aqm::codel_drop(uint64_t sojourn_ns, uint64_t now_ns, uint32_t queue_bytes)
+{
+  bool ok_to_drop = false;
+  if (sojourn_ns < target_ns or queue_bytes <= mtu_bytes) {
+    codel.first_above_time = 0;
+  } else if (codel.first_above_time == 0) {
+    codel.first_above_time = now_ns + interval_ns;
+  } else if (now_ns >= codel.first_above_time) {
+    ok_to_drop = true;
+  }
+
+  auto control_law = [this](uint64_t t) { return t + (uint64_t)(interval_ns / sqrt((double)codel.count)); };
+
+  if (codel.dropping) {
+    if (not ok_to_drop) {
+      // The sojourn time went below the target, leave the dropping state
+      codel.dropping = false;
+      return false;
+    }
+    if (now_ns >= codel.drop_next) {
+      codel.count++;
+      codel.drop_next = control_law(codel.drop_next);
+      return true;
+    }
+    return false;
+  }
+
+  if (ok_to_drop) {
+    // Enter the dropping state, resuming from the previous drop rate when it was left recently
+    codel.dropping = true;
+    uint32_t delta = codel.count - codel.lastcount;
+    if (delta > 1 and now_ns - codel.drop_next < 16 * interval_ns) {
+      codel.count = delta;
+    } else {
+      codel.count = 1;
+    }
+    codel.lastcount = codel.count;
+    codel.drop_next = control_law(now_ns);
+    return true;
+  }
+  return false;
+}
+
+bool rlc_aqm::pie_drop(uint64_t sojourn_ns, uint64_t now_ns, uint32_t queue_bytes)
+{
+  pie.qdelay = sojourn_ns * 1e-9;
+  if (pie.last_update == 0) {
+    pie.last_update = now_ns;
+  } else if (now_ns - pie.last_update >= interval_ns) {
+    pie_update(pie.qdelay);
+    pie.last_update = now_ns;
+  }
+
+  // Safeguards against dropping in bursts and on short queues
+  double target_s = target_ns * 1e-9;
+  if (pie.burst_allowance > 0 or (pie.qdelay_old < target_s / 2 and pie.drop_prob < pie_safe_drop_prob) or
+      queue_bytes <= 2 * mtu_bytes) {
+    return false;
+  }
+
+  // Derandomized drop, spreading the drops evenly
+  if (pie.drop_prob == 0) {
+    pie.accu_prob = 0;
+  }
+  pie.accu_prob += pie.drop_prob;
+  if (pie.accu_prob < pie_min_accu_prob) {
+    return false;
+  }
+  if (pie.accu_prob >= pie_max_accu_prob or uniform(rng) < pie.drop_prob) {
+    pie.accu_prob = 0;
+    return true;
+  }
+  return false;
+}
+
+/// Drop probability update of RFC 8033, run every update period
+void rlc_aqm::pie_update(double qdelay_s)
+{
+  double target_s = target_ns * 1e-9;
+  double p        = pie_alpha * (qdelay_s - target_s) + pie_beta * (qdelay_s - pie.qdelay_old);
+
+  // Smaller steps while the probability is low, so that it does not swing
+  if (pie.drop_prob < 0.000001) {
+    p /= 2048;
+  } else if (pie.drop_prob < 0.00001) {
+    p /= 512;
+  } else if (pie.drop_prob < 0.0001) {
+    p /= 128;
+  } else if (pie.drop_prob < 0.001) {
+    p /= 32;
+  } else if (pie.drop_prob < 0.01) {
+    p /= 8;
+  } else if (pie.drop_prob < 0.1) {
+    p /= 2;
+  } else if (p > pie_max_prob_step) {
+    p = pie_max_prob_step;
+  }
+  pie.drop_prob += p;
+
+  if (qdelay_s > pie_high_qdelay_s) {
+    pie.drop_prob += pie_max_prob_step;
+  }
+  if (qdelay_s == 0 and pie.qdelay_old == 0) {
+    pie.drop_prob *= pie_prob_decay;
+  }
+  pie.drop_prob = std::max(0.0, std::min(1.0, pie.drop_prob));
+
+  if (pie.burst_allowance > 0) {
+    pie.burst_allowance = std::max(0.0, pie.burst_allowance - interval_ns * 1e-9);
+  } else if (pie.drop_prob == 0 and qdelay_s < target_s / 2 and pie.qdelay_old < target_s / 2) {
+    pie.burst_allowance = pie_max_burst_s;
+  }
+  pie.qdelay_old = qdelay_s;
+}
+
+} // namespace srslte
@@ -129,12 +129,17 @@ uint32_t rlc_tm::get_buffer_state()
 
 rlc_bearer_metrics_t rlc_tm::get_metrics()
 {
-  return metrics;
+  return metrics.get();
+}
+
+rlc_bearer_metrics_t rlc_tm::get_and_reset_metrics()
+{
+  return metrics.read_and_reset();
 }
 
 void rlc_tm::reset_metrics()
 {
-  metrics = {};
+  metrics.reset();
 }
 
 int rlc_tm::read_pdu(uint8_t* payload, uint32_t nof_bytes)
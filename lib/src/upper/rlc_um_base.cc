@@ -108,6 +108,27 @@ void rlc_um_base::write_sdu(unique_byte_buffer_t sdu)
   }
 }
 
+void rlc_um_base::write_sdus(std::vector<unique_byte_buffer_t>& sdus)
+{
+  if (not tx_enabled || not tx) {
+    log->debug("%s is currently deactivated. Dropping %zd SDUs\n", rb_name.c_str(), sdus.size());
+    metrics.num_lost_sdus += sdus.size();
+    return;
+  }
+
+  uint32_t nof_bytes = 0;
+  for (const unique_byte_buffer_t& sdu : sdus) {
+    nof_bytes += sdu->N_bytes;
+  }
+  uint32_t nof_written = tx->try_write_sdus(sdus);
+  for (uint32_t i = nof_written; i < sdus.size(); i++) {
+    nof_bytes -= sdus[i]->N_bytes;
+  }
+  metrics.num_tx_sdus += nof_written;
+  metrics.num_tx_sdu_bytes += nof_bytes;
+  metrics.num_lost_sdus += sdus.size() - nof_written;
+}
+
 void rlc_um_base::discard_sdu(uint32_t discard_sn)
 {
   if (not tx_enabled || not tx) {
@@ -165,14 +186,28 @@ void rlc_um_base::write_pdu(uint8_t* payload, uint32_t nof_bytes)
   }
 }
 
+void rlc_um_base::write_pdu(unique_byte_buffer_t pdu)
+{
+  if (rx && rx_enabled) {
+    metrics.num_rx_pdus++;
+    metrics.num_rx_pdu_bytes += pdu->N_bytes;
+    rx->handle_data_pdu(std::move(pdu));
+  }
+}
+
 rlc_bearer_metrics_t rlc_um_base::get_metrics()
 {
-  return metrics;
+  return metrics.get();
+}
+
+rlc_bearer_metrics_t rlc_um_base::get_and_reset_metrics()
+{
+  return metrics.read_and_reset();
 }
 
 void rlc_um_base::reset_metrics()
 {
-  metrics = {};
+  metrics.reset();
 }
 
 /****************************************************************************
@@ -211,10 +246,25 @@ rlc_um_base::rlc_um_base_rx::~rlc_um_base_rx() {}
  * Tx subclass implementation (base)
  ***************************************************************************/
 
-rlc_um_base::rlc_um_base_tx::rlc_um_base_tx(rlc_um_base* parent_) : log(parent_->log), pool(parent_->pool) {}
+rlc_um_base::rlc_um_base_tx::rlc_um_base_tx(rlc_um_base* parent_) :
+  log(parent_->log),
+  pool(parent_->pool),
+  metrics(parent_->metrics)
+{
+  tx_sdu_queue.set_delay_histograms(&parent_->metrics.queue_delay, &parent_->metrics.upper_delay);
+}
 
 rlc_um_base::rlc_um_base_tx::~rlc_um_base_tx() {}
 
+void rlc_um_base::rlc_um_base_tx::configure_aqm(const rlc_aqm_config_t& aqm_cfg)
+{
+  aqm.reset(aqm_cfg.mode != rlc_aqm_mode_t::none ? new rlc_aqm(aqm_cfg) : nullptr);
+  tx_sdu_queue.set_aqm(aqm.get(), &metrics.num_lost_sdus);
+  if (aqm != nullptr) {
+    log->info("%s Tx SDU queue managed by %s\n", rb_name.c_str(), to_string(aqm_cfg.mode).c_str());
+  }
+}
+
 void rlc_um_base::rlc_um_base_tx::stop()
 {
   empty_queue();
@@ -284,6 +334,21 @@ int rlc_um_base::rlc_um_base_tx::try_write_sdu(unique_byte_buffer_t sdu)
   return SRSLTE_ERROR;
 }
 
+uint32_t rlc_um_base::rlc_um_base_tx::try_write_sdus(std::vector<unique_byte_buffer_t>& sdus)
+{
+  uint32_t nof_written = tx_sdu_queue.try_write_many(sdus);
+  log->info("%s Tx %d SDUs (tx_sdu_queue_len=%d)\n", rb_name.c_str(), nof_written, tx_sdu_queue.size());
+  for (uint32_t i = nof_written; i < sdus.size(); i++) {
+    log->warning_hex(sdus[i]->msg,
+                     sdus[i]->N_bytes,
+                     "[Dropped SDU] %s Tx SDU (%d B, tx_sdu_queue_len=%d)",
+                     rb_name.c_str(),
+                     sdus[i]->N_bytes,
+                     tx_sdu_queue.size());
+  }
+  return nof_written;
+}
+
 void rlc_um_base::rlc_um_base_tx::discard_sdu(uint32_t discard_sn)
 {
   log->warning("RLC UM: Discard SDU not implemented yet.\n");
@@ -296,21 +361,19 @@ bool rlc_um_base::rlc_um_base_tx::sdu_queue_is_full()
 
 int rlc_um_base::rlc_um_base_tx::build_data_pdu(uint8_t* payload, uint32_t nof_bytes)
 {
-  unique_byte_buffer_t pdu;
-  {
-    std::lock_guard<std::mutex> lock(mutex);
-    log->debug("MAC opportunity - %d bytes\n", nof_bytes);
-
-    if (tx_sdu == nullptr && tx_sdu_queue.is_empty()) {
-      log->info("No data available to be sent\n");
-      return 0;
-    }
+  // Hold the lock for the whole PDU, the derived class packs it without locking again
+  std::lock_guard<std::mutex> lock(mutex);
+  log->debug("MAC opportunity - %d bytes\n", nof_bytes);
 
-    pdu = allocate_unique_buffer(*pool);
-    if (!pdu || pdu->N_bytes != 0) {
-      log->error("Failed to allocate PDU buffer\n");
-      return 0;
-    }
+  if (tx_sdu == nullptr && tx_sdu_queue.is_empty()) {
+    log->info("No data available to be sent\n");
+    return 0;
+  }
+
+  unique_byte_buffer_t pdu = allocate_unique_buffer(*pool);
+  if (!pdu || pdu->N_bytes != 0) {
+    log->error("Failed to allocate PDU buffer\n");
+    return 0;
   }
   return build_data_pdu(std::move(pdu), payload, nof_bytes);
 }
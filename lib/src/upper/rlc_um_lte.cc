@@ -114,14 +114,14 @@ bool rlc_um_lte::rlc_um_lte_tx::configure(const rlc_config_t& cnfg_, std::string
   tx_sdu_queue.resize(cnfg_.tx_queue_length);
 
   rb_name = rb_name_;
+  configure_aqm(cnfg_.aqm);
 
   return true;
 }
 
 int rlc_um_lte::rlc_um_lte_tx::build_data_pdu(unique_byte_buffer_t pdu, uint8_t* payload, uint32_t nof_bytes)
 {
-  std::lock_guard<std::mutex> lock(mutex);
-  rlc_umd_pdu_header_t        header;
+  rlc_umd_pdu_header_t header;
   header.fi      = RLC_FI_FIELD_START_AND_END_ALIGNED;
   header.sn      = vt_us;
   header.N_li    = 0;
@@ -164,35 +164,47 @@ int rlc_um_lte::rlc_um_lte_tx::build_data_pdu(unique_byte_buffer_t pdu, uint8_t*
     header.fi |= RLC_FI_FIELD_NOT_START_ALIGNED; // First byte does not correspond to first byte of SDU
   }
 
-  // Pull SDUs from queue
-  while (pdu_space > head_len + 1 && tx_sdu_queue.size() > 0) {
-    log->debug("pdu_space=%d, head_len=%d\n", pdu_space, head_len);
+  // A new SDU adds the LI of the previous one to the header and needs room for at least one byte after it
+  auto new_sdu_fits = [&header, &head_len, &pdu_space, &last_li]() {
+    if (pdu_space <= head_len + 1) {
+      return false;
+    }
     if (last_li > 0) {
       header.li[header.N_li++] = last_li;
-    }
-    head_len       = rlc_um_packed_length(&header);
-    uint32_t space = pdu_space - head_len;
-    if (space == 0) {
-      // we cannot even fit a single byte of the newly added SDU, remove it again
+      int len                  = rlc_um_packed_length(&header);
       header.N_li--;
-      break;
-    }
-    tx_sdu  = tx_sdu_queue.read();
-    to_move = (space >= tx_sdu->N_bytes) ? tx_sdu->N_bytes : space;
-    log->debug("%s adding new SDU segment - %d bytes of %d remaining\n", rb_name.c_str(), to_move, tx_sdu->N_bytes);
-    memcpy(pdu_ptr, tx_sdu->msg, to_move);
-    last_li = to_move;
-    pdu_ptr += to_move;
-    pdu->N_bytes += to_move;
-    tx_sdu->N_bytes -= to_move;
-    tx_sdu->msg += to_move;
-    if (tx_sdu->N_bytes == 0) {
-      log->debug(
-          "%s Complete SDU scheduled for tx. Stack latency: %ld us\n", rb_name.c_str(), tx_sdu->get_latency_us());
-
-      tx_sdu.reset();
+      return pdu_space > len;
     }
-    pdu_space -= to_move;
+    return true;
+  };
+
+  // Pull SDUs from queue, taking its lock once for all of them
+  if (new_sdu_fits()) {
+    tx_sdu_queue.read_while([&](unique_byte_buffer_t sdu) {
+      log->debug("pdu_space=%d, head_len=%d\n", pdu_space, head_len);
+      if (last_li > 0) {
+        header.li[header.N_li++] = last_li;
+      }
+      head_len       = rlc_um_packed_length(&header);
+      uint32_t space = pdu_space - head_len;
+      tx_sdu         = std::move(sdu);
+      to_move        = (space >= tx_sdu->N_bytes) ? tx_sdu->N_bytes : space;
+      log->debug("%s adding new SDU segment - %d bytes of %d remaining\n", rb_name.c_str(), to_move, tx_sdu->N_bytes);
+      memcpy(pdu_ptr, tx_sdu->msg, to_move);
+      last_li = to_move;
+      pdu_ptr += to_move;
+      pdu->N_bytes += to_move;
+      tx_sdu->N_bytes -= to_move;
+      tx_sdu->msg += to_move;
+      if (tx_sdu->N_bytes == 0) {
+        log->debug(
+            "%s Complete SDU scheduled for tx. Stack latency: %ld us\n", rb_name.c_str(), tx_sdu->get_latency_us());
+
+        tx_sdu.reset();
+      }
+      pdu_space -= to_move;
+      return new_sdu_fits();
+    });
   }
 
   if (tx_sdu) {
@@ -289,6 +301,19 @@ void rlc_um_lte::rlc_um_lte_rx::reset()
 }
 
 void rlc_um_lte::rlc_um_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_bytes)
+{
+  handle_data_pdu(payload, nof_bytes, nullptr);
+}
+
+void rlc_um_lte::rlc_um_lte_rx::handle_data_pdu(unique_byte_buffer_t pdu)
+{
+  uint8_t* payload   = pdu->msg;
+  uint32_t nof_bytes = pdu->N_bytes;
+  handle_data_pdu(payload, nof_bytes, std::move(pdu));
+}
+
+// If pdu_buf is not null, the payload is in it and it is kept in the Rx window instead of a copy
+void rlc_um_lte::rlc_um_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_bytes, unique_byte_buffer_t pdu_buf)
 {
   rlc_umd_pdu_header_t header;
   rlc_um_read_data_pdu_header(payload, nof_bytes, cfg.um.rx_sn_field_length, &header);
@@ -308,12 +333,17 @@ void rlc_um_lte::rlc_um_lte_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_b
 
   // Write to rx window
   rlc_umd_pdu_t pdu = {};
-  pdu.buf           = allocate_unique_buffer(*pool);
-  if (!pdu.buf) {
-    log->error("Discarting packet: no space in buffer pool\n");
-    return;
+  if (pdu_buf != nullptr) {
+    pdu.buf      = std::move(pdu_buf);
+    pdu.buf->msg = payload;
+  } else {
+    pdu.buf = allocate_unique_buffer(*pool, nof_bytes, nullptr);
+    if (!pdu.buf) {
+      log->error("Discarting packet: no space in buffer pool\n");
+      return;
+    }
+    memcpy(pdu.buf->msg, payload, nof_bytes);
   }
-  memcpy(pdu.buf->msg, payload, nof_bytes);
   pdu.buf->N_bytes = nof_bytes;
   // Strip header from PDU
   int header_len = rlc_um_packed_length(&header);
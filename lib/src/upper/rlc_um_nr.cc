@@ -110,17 +110,17 @@ bool rlc_um_nr::rlc_um_nr_tx::configure(const rlc_config_t& cnfg_, std::string r
   tx_sdu_queue.resize(cnfg_.tx_queue_length);
 
   rb_name = rb_name_;
+  configure_aqm(cnfg_.aqm);
 
   return true;
 }
 
 int rlc_um_nr::rlc_um_nr_tx::build_data_pdu(unique_byte_buffer_t pdu, uint8_t* payload, uint32_t nof_bytes)
 {
-  std::lock_guard<std::mutex> lock(mutex);
-  rlc_um_nr_pdu_header_t      header = {};
-  header.si                          = rlc_nr_si_field_t::full_sdu;
-  header.sn                          = TX_Next;
-  header.sn_size                     = cfg.um_nr.sn_field_length;
+  rlc_um_nr_pdu_header_t header = {};
+  header.si                     = rlc_nr_si_field_t::full_sdu;
+  header.sn                     = TX_Next;
+  header.sn_size                = cfg.um_nr.sn_field_length;
 
   uint32_t to_move = 0;
   uint8_t* pdu_ptr = pdu->msg;
@@ -341,16 +341,68 @@ unique_byte_buffer_t rlc_um_nr::rlc_um_nr_rx::rlc_um_nr_strip_pdu_header(const r
     log->error("Discarting packet: no space in buffer pool\n");
     return nullptr;
   }
-  memcpy(sdu->msg, payload, nof_bytes);
-  sdu->N_bytes = nof_bytes;
 
-  // strip RLC header
-  int header_len = rlc_um_nr_packed_length(header);
-  sdu->msg += header_len;
-  sdu->N_bytes -= header_len;
+  // copy the PDU without the RLC header
+  uint32_t header_len = rlc_um_nr_packed_length(header);
+  memcpy(sdu->msg, payload + header_len, nof_bytes - header_len);
+  sdu->N_bytes = nof_bytes - header_len;
   return sdu;
 }
 
+bool rlc_um_nr::rlc_um_nr_rx::write_segment(const rlc_um_nr_pdu_header_t& header,
+                                            const uint8_t*                payload,
+                                            const uint32_t                nof_bytes)
+{
+  uint32_t header_len = rlc_um_nr_packed_length(header);
+  if (nof_bytes <= header_len) {
+    log->error("Discarting %s segment of SN=%d without payload\n", rb_name.c_str(), header.sn);
+    return false;
+  }
+  uint32_t seg_len = nof_bytes - header_len;
+
+  auto it = rx_window.find(header.sn);
+  if (it == rx_window.end()) {
+    // first received segment of this SN, allocate the buffer where the SDU is reassembled
+    log->info("%s placing %s segment of SN=%d in Rx buffer\n",
+              rb_name.c_str(),
+              to_string_short(header.si).c_str(),
+              header.sn);
+    rlc_umd_pdu_segments_nr_t pdu_segments = {};
+    pdu_segments.sdu                       = allocate_unique_buffer(*pool);
+    if (pdu_segments.sdu == nullptr) {
+      log->error("Discarting packet: no space in buffer pool\n");
+      return false;
+    }
+    it = rx_window.emplace(header.sn, std::move(pdu_segments)).first;
+  } else {
+    // other segment for this SN already present, update received data
+    log->info("%s updating SN=%d at SO=%d with %d B\n", rb_name.c_str(), header.sn, header.so, seg_len);
+  }
+
+  rlc_umd_pdu_segments_nr_t& pdu = it->second;
+  if (header.so + seg_len > pdu.sdu->get_tailroom()) {
+    log->error("Cannot fit RLC PDU in SDU buffer (tailroom=%d, len=%d), dropping both. Erasing SN=%d.\n",
+               pdu.sdu->get_tailroom(),
+               header.so + seg_len,
+               header.sn);
+    rx_window.erase(it);
+    metrics.num_lost_pdus++;
+    return false;
+  }
+
+  // place the payload at its offset in the SDU, a retransmitted segment overwriting the same bytes
+  memcpy(pdu.sdu->msg + header.so, payload + header_len, seg_len);
+  uint32_t& range_len = pdu.segments[header.so];
+  range_len           = std::max(range_len, seg_len);
+
+  // calculate total SDU length
+  if (header.si == rlc_nr_si_field_t::last_segment) {
+    pdu.total_sdu_length = header.so + seg_len;
+    log->info("%s updating total SDU length for SN=%d to %d B\n", rb_name.c_str(), header.sn, pdu.total_sdu_length);
+  }
+  return true;
+}
+
 bool rlc_um_nr::rlc_um_nr_rx::has_missing_byte_segment(const uint32_t sn)
 {
   // is at least one missing byte segment of the RLC SDU associated with SN = RX_Next_Reassembly before the last byte of
@@ -362,70 +414,32 @@ bool rlc_um_nr::rlc_um_nr_rx::has_missing_byte_segment(const uint32_t sn)
 void rlc_um_nr::rlc_um_nr_rx::handle_rx_buffer_update(const uint32_t sn)
 {
   if (rx_window.find(sn) != rx_window.end()) {
-    // iterate over received segments and try to assemble full SDU
+    // extend the reassembled data with the byte ranges contiguous to it
     auto& pdu = rx_window.at(sn);
-    for (auto it = pdu.segments.begin(); it != pdu.segments.end();) {
-      log->debug("Have %s segment with SO=%d for SN=%d\n",
-                 to_string_short(it->second.header.si).c_str(),
-                 it->second.header.so,
-                 it->second.header.sn);
-      if (it->second.header.so == pdu.next_expected_so) {
-        if (pdu.next_expected_so == 0) {
-          if (pdu.sdu == nullptr) {
-            // reuse buffer of first segment for final SDU
-            pdu.sdu              = std::move(it->second.buf);
-            pdu.next_expected_so = pdu.sdu->N_bytes;
-            log->debug("Reusing first segment of SN=%d for final SDU\n", it->second.header.sn);
-            it = pdu.segments.erase(it);
-          } else {
-            log->debug("SDU buffer already allocated. Possible retransmission of first segment.\n");
-            if (it->second.header.so != pdu.next_expected_so) {
-              log->error("Invalid PDU. SO doesn't match. Discarting all segments of SN=%d.\n", sn);
-              rx_window.erase(sn);
-              return;
-            }
-          }
-        } else {
-          if (it->second.buf->N_bytes > pdu.sdu->get_tailroom()) {
-            log->error("Cannot fit RLC PDU in SDU buffer (tailroom=%d, len=%d), dropping both. Erasing SN=%d.\n",
-                       rx_sdu->get_tailroom(),
-                       it->second.buf->N_bytes,
-                       it->second.header.sn);
-            rx_window.erase(sn);
-            metrics.num_lost_pdus++;
-            return;
-          }
+    for (auto it = pdu.segments.begin(); it != pdu.segments.end() and it->first <= pdu.next_expected_so;) {
+      log->debug("Appended SO=%d (%d B) of SN=%d\n", it->first, it->second, sn);
+      pdu.next_expected_so = std::max(pdu.next_expected_so, it->first + it->second);
+      it                   = pdu.segments.erase(it);
+    }
 
-          // add this segment to the end of the SDU buffer
-          memcpy(pdu.sdu->msg + pdu.sdu->N_bytes, it->second.buf->msg, it->second.buf->N_bytes);
-          pdu.sdu->N_bytes += it->second.buf->N_bytes;
-          pdu.next_expected_so += it->second.buf->N_bytes;
-          log->debug("Appended SO=%d of SN=%d\n", it->second.header.so, it->second.header.sn);
-          it = pdu.segments.erase(it);
-
-          if (pdu.next_expected_so == pdu.total_sdu_length) {
-            // deliver full SDU to upper layers
-            log->info("Delivering %s SDU SN=%d (%d B)", rb_name.c_str(), sn, pdu.sdu->N_bytes);
-            pdcp->write_pdu(lcid, std::move(pdu.sdu));
-
-            // find next SN in rx buffer
-            if (sn == RX_Next_Reassembly) {
-              RX_Next_Reassembly = ((RX_Next_Reassembly + 1) % cfg.um_nr.mod);
-              while (RX_MOD_NR_BASE(RX_Next_Reassembly) < RX_MOD_NR_BASE(RX_Next_Highest)) {
-                RX_Next_Reassembly = (RX_Next_Reassembly + 1) % cfg.um_nr.mod;
-              }
-              log->debug("Updating RX_Next_Reassembly=%d\n", RX_Next_Reassembly);
-            }
-
-            // delete PDU from rx_window
-            rx_window.erase(sn);
-            return;
-          }
+    if (pdu.total_sdu_length > 0 and pdu.next_expected_so >= pdu.total_sdu_length) {
+      // deliver full SDU to upper layers
+      pdu.sdu->N_bytes = pdu.total_sdu_length;
+      log->info("Delivering %s SDU SN=%d (%d B)", rb_name.c_str(), sn, pdu.sdu->N_bytes);
+      pdcp->write_pdu(lcid, std::move(pdu.sdu));
+
+      // find next SN in rx buffer
+      if (sn == RX_Next_Reassembly) {
+        RX_Next_Reassembly = ((RX_Next_Reassembly + 1) % cfg.um_nr.mod);
+        while (RX_MOD_NR_BASE(RX_Next_Reassembly) < RX_MOD_NR_BASE(RX_Next_Highest)) {
+          RX_Next_Reassembly = (RX_Next_Reassembly + 1) % cfg.um_nr.mod;
         }
-      } else {
-        // handle next segment
-        ++it;
+        log->debug("Updating RX_Next_Reassembly=%d\n", RX_Next_Reassembly);
       }
+
+      // delete PDU from rx_window
+      rx_window.erase(sn);
+      return;
     }
 
     // check for SN outside of rx window
@@ -480,18 +494,6 @@ void rlc_um_nr::rlc_um_nr_rx::handle_rx_buffer_update(const uint32_t sn)
   }
 }
 
-inline void rlc_um_nr::rlc_um_nr_rx::update_total_sdu_length(rlc_umd_pdu_segments_nr_t& pdu_segments,
-                                                             const rlc_umd_pdu_nr_t&    rx_pdu)
-{
-  if (rx_pdu.header.si == rlc_nr_si_field_t::last_segment) {
-    pdu_segments.total_sdu_length = rx_pdu.header.so + rx_pdu.buf->N_bytes;
-    log->info("%s updating total SDU length for SN=%d to %d B\n",
-              rb_name.c_str(),
-              rx_pdu.header.sn,
-              pdu_segments.total_sdu_length);
-  }
-};
-
 // Section 5.2.2.2.2
 void rlc_um_nr::rlc_um_nr_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_bytes)
 {
@@ -514,36 +516,8 @@ void rlc_um_nr::rlc_um_nr_rx::handle_data_pdu(uint8_t* payload, uint32_t nof_byt
     // Nothing else to do here ..
   } else {
     // place PDU in receive buffer
-    rlc_umd_pdu_nr_t rx_pdu = {};
-    rx_pdu.header           = header;
-    rx_pdu.buf              = rlc_um_nr_strip_pdu_header(header, payload, nof_bytes);
-
-    // check if this SN is already present in rx buffer
-    if (rx_window.find(header.sn) == rx_window.end()) {
-      // first received segment of this SN, add to rx buffer
-      log->info("%s placing %s segment of SN=%d in Rx buffer\n",
-                rb_name.c_str(),
-                to_string_short(header.si).c_str(),
-                header.sn);
-      rlc_umd_pdu_segments_nr_t pdu_segments = {};
-      update_total_sdu_length(pdu_segments, rx_pdu);
-      pdu_segments.segments.emplace(header.so, std::move(rx_pdu));
-      rx_window[header.sn] = std::move(pdu_segments);
-    } else {
-      // other segment for this SN already present, update received data
-      log->info("%s updating SN=%d at SO=%d with %d B\n",
-                rb_name.c_str(),
-                rx_pdu.header.sn,
-                rx_pdu.header.so,
-                rx_pdu.buf->N_bytes);
-
-      auto& pdu_segments = rx_window.at(header.sn);
-
-      // calculate total SDU length
-      update_total_sdu_length(pdu_segments, rx_pdu);
-
-      // append to list of segments
-      pdu_segments.segments.emplace(header.so, std::move(rx_pdu));
+    if (not write_segment(header, payload, nof_bytes)) {
+      return;
     }
 
     // handle received segments
@@ -21,6 +21,7 @@
 
 #include "srslte/adt/bounded_bitset.h"
 #include "srslte/common/test_common.h"
+#include <vector>
 
 int test_zero_bitset()
 {
@@ -113,11 +114,71 @@ int test_bitset_bitwise_oper()
   return SRSLTE_SUCCESS;
 }
 
+// The word operations are checked against the bit by bit ones, with ranges that cross the word boundaries
+template <bool reversed>
+int test_bitset_range_oper()
+{
+  srslte::bounded_bitset<150, reversed> mask;
+
+  for (uint32_t size : {1, 25, 64, 100, 128, 150}) {
+    for (uint32_t trial = 0; trial < 50; ++trial) {
+      mask.resize(size);
+      mask.reset();
+      for (uint32_t i = 0; i < size; ++i) {
+        mask.set(i, (rand() % 4) == 0);
+      }
+      uint32_t start = rand() % (size + 1);
+      uint32_t stop  = start + rand() % (size + 1 - start);
+
+      int      lowest[2] = {-1, -1};
+      uint32_t count     = 0;
+      for (uint32_t i = start; i < stop; ++i) {
+        count += mask.test(i) ? 1 : 0;
+        if (lowest[mask.test(i)] < 0) {
+          lowest[mask.test(i)] = i;
+        }
+      }
+      TESTASSERT(mask.count(start, stop) == count);
+      TESTASSERT(mask.any(start, stop) == (count > 0));
+      TESTASSERT(mask.find_lowest(start, stop, false) == lowest[0]);
+      TESTASSERT(mask.find_lowest(start, stop, true) == lowest[1]);
+
+      uint32_t len   = 1 + rand() % 8;
+      int      zeros = -1;
+      for (uint32_t i = 0; i + len <= size and zeros < 0; ++i) {
+        if (mask.count(i, i + len) == 0) {
+          zeros = i;
+        }
+      }
+      TESTASSERT(mask.find_lowest_zeros(len) == zeros);
+
+      std::vector<size_t> set_bits;
+      mask.for_each([&set_bits](size_t pos) { set_bits.push_back(pos); });
+      TESTASSERT(set_bits.size() == mask.count());
+      for (size_t i = 0; i < set_bits.size(); ++i) {
+        TESTASSERT(mask.test(set_bits[i]) and (i == 0 or set_bits[i - 1] < set_bits[i]));
+      }
+
+      srslte::bounded_bitset<150, reversed> filled = mask;
+      bool                                  value  = rand() % 2;
+      filled.fill(start, stop, value);
+      for (uint32_t i = 0; i < size; ++i) {
+        TESTASSERT(filled.test(i) == ((i >= start and i < stop) ? value : mask.test(i)));
+      }
+      TESTASSERT(filled.count() == filled.count(0, size));
+    }
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
 int main()
 {
   TESTASSERT(test_zero_bitset() == SRSLTE_SUCCESS);
   TESTASSERT(test_ones_bitset() == SRSLTE_SUCCESS);
   TESTASSERT(test_bitset_set() == SRSLTE_SUCCESS);
   TESTASSERT(test_bitset_bitwise_oper() == SRSLTE_SUCCESS);
+  TESTASSERT(test_bitset_range_oper<false>() == SRSLTE_SUCCESS);
+  TESTASSERT(test_bitset_range_oper<true>() == SRSLTE_SUCCESS);
   return 0;
 }
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/adt/mpsc_queue.h"
+#include "srslte/common/test_common.h"
+#include <thread>
+#include <vector>
+
+int test_mpsc_queue_basic()
+{
+  srslte::mpsc_queue<int> q(5);
+  TESTASSERT(q.capacity() == 8);
+
+  int v = -1;
+  TESTASSERT(not q.try_pop(v) and v == -1);
+  TESTASSERT(q.empty() and q.size() == 0);
+
+  // Fill the queue, going around it a few times
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 8; ++i) {
+      TESTASSERT(q.try_push(round * 8 + i));
+    }
+    TESTASSERT(not q.try_push(100));
+    TESTASSERT(q.size() == 8);
+    for (int i = 0; i < 8; ++i) {
+      TESTASSERT(q.try_pop(v) and v == round * 8 + i);
+    }
+    TESTASSERT(not q.try_pop(v));
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int test_mpsc_queue_threads()
+{
+  const int nof_producers = 4, nof_items = 10000;
+
+  // Every producer pushes an increasing sequence tagged with its index
+  srslte::mpsc_queue<std::pair<int, int> > q(64);
+  std::vector<std::thread>                 producers;
+  for (int p = 0; p < nof_producers; ++p) {
+    producers.emplace_back([&q, p]() {
+      for (int i = 0; i < nof_items; ++i) {
+        while (not q.try_push(std::make_pair(p, i))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // The elements of every producer must arrive once and in order
+  std::vector<int>    next(nof_producers, 0);
+  int                 count = 0;
+  std::pair<int, int> v;
+  while (count < nof_producers * nof_items) {
+    if (q.try_pop(v)) {
+      TESTASSERT(v.first >= 0 and v.first < nof_producers);
+      TESTASSERT(v.second == next[v.first]);
+      next[v.first]++;
+      count++;
+    }
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  TESTASSERT(not q.try_pop(v));
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_mpsc_queue_basic() == SRSLTE_SUCCESS);
+  TESTASSERT(test_mpsc_queue_threads() == SRSLTE_SUCCESS);
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
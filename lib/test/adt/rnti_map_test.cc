@@ -0,0 +1,136 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/adt/rnti_map.h"
+#include "srslte/common/test_common.h"
+#include <map>
+#include <random>
+
+struct C {
+  static int count;
+  explicit C(int v_ = 0) : v(v_) { count++; }
+  C(const C&) = delete;
+  ~C() { count--; }
+  int v;
+};
+int C::count = 0;
+
+int test_rnti_map_basic()
+{
+  srslte::rnti_map<C> m;
+  TESTASSERT(m.empty() and m.size() == 0);
+  TESTASSERT(m.find(0x46) == m.end());
+
+  TESTASSERT(m.emplace(0x46, 5).second);
+  TESTASSERT(not m.emplace(0x46, 6).second);
+  TESTASSERT(m.size() == 1 and m.count(0x46) == 1 and m[0x46].v == 5);
+  m[0xFFFD].v = 3;
+  TESTASSERT(m.size() == 2 and C::count == 2);
+
+  // The address of an element does not change when others are inserted or erased
+  C* c = &m.find(0xFFFD)->second;
+  for (uint16_t rnti = 0x100; rnti < 0x100 + 199; ++rnti) {
+    m[rnti].v = rnti;
+  }
+  TESTASSERT(m.erase(0x46) == 1 and m.erase(0x46) == 0);
+  TESTASSERT(&m.find(0xFFFD)->second == c and c->v == 3);
+  TESTASSERT(m.count(0x46) == 0 and m.size() == 200 and C::count == 200);
+
+  m.clear();
+  TESTASSERT(m.empty() and m.begin() == m.end() and C::count == 0);
+  return SRSLTE_SUCCESS;
+}
+
+int test_rnti_map_random()
+{
+  srslte::rnti_map<C>                m;
+  std::map<uint16_t, int>            ref;
+  std::mt19937                       rand_gen(0);
+  std::uniform_int_distribution<int> rnti_dist(0x46, 0x46 + 500);
+  std::uniform_real_distribution<>   p_dist;
+  for (uint32_t i = 0; i < 100000; ++i) {
+    uint16_t rnti = rnti_dist(rand_gen);
+    if (p_dist(rand_gen) < 0.5) {
+      bool inserted = m.emplace(rnti, (int)i).second;
+      TESTASSERT(inserted == ref.emplace(rnti, (int)i).second);
+    } else {
+      TESTASSERT(m.erase(rnti) == ref.erase(rnti));
+    }
+  }
+
+  // Iteration visits every element once, in any order
+  TESTASSERT(m.size() == ref.size() and C::count == (int)ref.size());
+  size_t n = 0;
+  for (const auto& e : m) {
+    TESTASSERT(ref.count(e.first) == 1 and ref[e.first] == e.second.v);
+    n++;
+  }
+  TESTASSERT(n == ref.size());
+
+  // Erase while iterating
+  for (auto it = m.begin(); it != m.end();) {
+    if (it->first % 2 == 0) {
+      ref.erase(it->first);
+      it = m.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  TESTASSERT(m.size() == ref.size());
+  for (const auto& e : ref) {
+    TESTASSERT(m.find(e.first) != m.end() and m.find(e.first)->second.v == e.second);
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int test_rnti_map_move()
+{
+  srslte::rnti_map<C> m1, m2;
+  m1[0x46].v  = 1;
+  m1[0x47].v  = 2;
+  C* c        = &m1.find(0x47)->second;
+  m2[0x100].v = 3;
+  TESTASSERT(C::count == 3);
+
+  // The elements of the destination are destroyed and the ones of the source keep their address
+  m2 = std::move(m1);
+  TESTASSERT(C::count == 2);
+  TESTASSERT(m2.size() == 2 and m2.count(0x100) == 0 and &m2.find(0x47)->second == c and c->v == 2);
+  TESTASSERT(m1.empty() and m1.find(0x46) == m1.end());
+
+  // The moved-from maps remain usable
+  m1[0x46].v = 4;
+  srslte::rnti_map<C> m3(std::move(m2));
+  TESTASSERT(m2.empty() and m2.count(0x47) == 0);
+  m2[0x48].v = 5;
+  TESTASSERT(m3.size() == 2 and m3[0x46].v == 1 and m1[0x46].v == 4 and C::count == 4);
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_rnti_map_basic() == SRSLTE_SUCCESS);
+  TESTASSERT(test_rnti_map_random() == SRSLTE_SUCCESS);
+  TESTASSERT(test_rnti_map_move() == SRSLTE_SUCCESS);
+  TESTASSERT(C::count == 0);
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
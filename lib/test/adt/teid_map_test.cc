@@ -0,0 +1,101 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/adt/teid_map.h"
+#include "srslte/common/test_common.h"
+#include <map>
+#include <random>
+
+int test_teid_map_basic()
+{
+  srslte::teid_map<int> m;
+  TESTASSERT(m.empty() and m.find(0) == nullptr and m.find(1) == nullptr);
+
+  uint32_t t1 = m.emplace(5);
+  uint32_t t2 = m.emplace(6);
+  TESTASSERT(t1 != 0 and t2 != 0 and t1 != t2 and m.size() == 2);
+  TESTASSERT(*m.find(t1) == 5 and *m.find(t2) == 6);
+
+  // A freed TEID does not match the next owner of its slot
+  TESTASSERT(m.erase(t1) and not m.erase(t1));
+  uint32_t t3 = m.emplace(7);
+  TESTASSERT(t3 != t1 and (t3 & 0xFFFF) == (t1 & 0xFFFF));
+  TESTASSERT(m.find(t1) == nullptr and *m.find(t3) == 7 and m.size() == 2);
+
+  int sum = 0;
+  m.for_each([&sum](uint32_t teid, int& v) { sum += v; });
+  TESTASSERT(sum == 13);
+
+  m.clear();
+  TESTASSERT(m.empty() and m.find(t2) == nullptr and m.find(t3) == nullptr);
+  return SRSLTE_SUCCESS;
+}
+
+int test_teid_map_full()
+{
+  srslte::teid_map<uint32_t> m;
+  for (uint32_t i = 0; i < srslte::teid_map<uint32_t>::max_size; ++i) {
+    TESTASSERT(m.emplace(i) != 0);
+  }
+  TESTASSERT(m.emplace(0) == 0);
+  TESTASSERT(m.size() == srslte::teid_map<uint32_t>::max_size);
+  return SRSLTE_SUCCESS;
+}
+
+int test_teid_map_random()
+{
+  srslte::teid_map<int>              m;
+  std::map<uint32_t, int>            ref;
+  std::vector<uint32_t>              erased;
+  std::mt19937                       rand_gen(0);
+  std::uniform_real_distribution<>   p_dist;
+  std::uniform_int_distribution<int> pos_dist(0, 1 << 20);
+  for (int i = 0; i < 100000; ++i) {
+    if (ref.size() < 500 and p_dist(rand_gen) < 0.5) {
+      uint32_t teid = m.emplace(i);
+      TESTASSERT(teid != 0 and ref.emplace(teid, i).second);
+    } else if (not ref.empty()) {
+      auto it = ref.begin();
+      std::advance(it, pos_dist(rand_gen) % ref.size());
+      TESTASSERT(m.erase(it->first));
+      erased.push_back(it->first);
+      ref.erase(it);
+    }
+  }
+  TESTASSERT(m.size() == ref.size());
+  for (const auto& e : ref) {
+    TESTASSERT(m.find(e.first) != nullptr and *m.find(e.first) == e.second);
+  }
+  // The generations keep the erased TEIDs from matching, as long as they were not handed out again
+  for (uint32_t teid : erased) {
+    TESTASSERT(m.find(teid) == nullptr or ref.count(teid) == 1);
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_teid_map_basic() == SRSLTE_SUCCESS);
+  TESTASSERT(test_teid_map_full() == SRSLTE_SUCCESS);
+  TESTASSERT(test_teid_map_random() == SRSLTE_SUCCESS);
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
@@ -605,6 +605,65 @@ int test_enum()
   return 0;
 }
 
+int test_mem_arena()
+{
+  uint8_t buf[1024];
+  bit_ref b(&buf[0], sizeof(buf));
+
+  dyn_array<uint32_t> list(50);
+  std::iota(list.begin(), list.end(), 0);
+  TESTASSERT(pack_dyn_seq_of(b, list, 0, 64, integer_packer<uint32_t>(0, 64)) == SRSASN_SUCCESS);
+
+  dyn_array<uint8_t>* escaped = nullptr;
+  const uint32_t*     first_data;
+  {
+    mem_arena arena;
+
+    {
+      arena_scope                 scope(arena);
+      dyn_seq_of<uint32_t, 0, 64> list2;
+      cbit_ref                    b2(&buf[0], sizeof(buf));
+      TESTASSERT(unpack_dyn_seq_of(list2, b2, 0, 64, integer_packer<uint32_t>(0, 64)) == SRSASN_SUCCESS);
+      TESTASSERT(list2 == list);
+      first_data = list2.data();
+    }
+
+    // Once the first message is released, the second one reuses the same memory
+    {
+      arena_scope                 scope(arena);
+      dyn_seq_of<uint32_t, 0, 64> list2;
+      cbit_ref                    b2(&buf[0], sizeof(buf));
+      TESTASSERT(unpack_dyn_seq_of(list2, b2, 0, 64, integer_packer<uint32_t>(0, 64)) == SRSASN_SUCCESS);
+      TESTASSERT(list2.data() == first_data);
+
+      // Arrays may outlive the message and the arena
+      escaped = new dyn_array<uint8_t>(16);
+      {
+        arena_scope        inner(arena);
+        ext_array<uint8_t> ext(100);
+        dyn_array<uint8_t> big(ASN_16K);
+        std::iota(ext.data(), ext.data() + ext.size(), 0);
+        std::fill(big.begin(), big.end(), 1);
+        ext.resize(200);
+        TESTASSERT(ext[99] == 99);
+        *escaped = dyn_array<uint8_t>(ext.data(), 16);
+      }
+    }
+
+    // The block is not reused while an array still lives in it
+    {
+      arena_scope         scope(arena);
+      dyn_array<uint32_t> list3(50);
+      TESTASSERT(list3.data() != first_data);
+    }
+  }
+
+  TESTASSERT(escaped->size() == 16 and (*escaped)[15] == 15);
+  delete escaped;
+
+  return 0;
+}
+
 int test_json_writer()
 {
   json_writer writer;
@@ -640,6 +699,7 @@ int main()
   TESTASSERT(test_seq_of() == 0);
   TESTASSERT(test_copy_ptr() == 0);
   TESTASSERT(test_enum() == 0);
+  TESTASSERT(test_mem_arena() == 0);
   //  TESTASSERT(test_json_writer()==0);
   printf("Success\n");
 }
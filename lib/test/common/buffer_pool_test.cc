@@ -0,0 +1,248 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/buffer_pool.h"
+#include "srslte/common/test_common.h"
+#include <mutex>
+#include <thread>
+
+using namespace srslte;
+
+/*
+ * Buffers allocated for a number of bytes come from the smallest size class they fit in
+ */
+int test_size_classes()
+{
+  byte_buffer_pool pool(4);
+
+  unique_byte_buffer_t small = allocate_unique_buffer(pool, 40, nullptr);
+  TESTASSERT(small != nullptr);
+  TESTASSERT(small->get_capacity() == byte_buffer_pool::small_byte_buffer_capacity);
+  TESTASSERT(small->get_headroom() == byte_buffer_pool::small_buffer_headroom);
+  TESTASSERT(small->get_tailroom() == 256);
+
+  unique_byte_buffer_t medium = allocate_unique_buffer(pool, 1500, nullptr);
+  TESTASSERT(medium != nullptr and medium->get_capacity() == byte_buffer_pool::medium_byte_buffer_capacity);
+  TESTASSERT(medium->get_tailroom() == 2048);
+
+  unique_byte_buffer_t large = allocate_unique_buffer(pool, 5000, nullptr);
+  TESTASSERT(large != nullptr and large->get_capacity() == SRSLTE_MAX_BUFFER_SIZE_BYTES);
+  TESTASSERT(large->get_headroom() == SRSLTE_BUFFER_HEADER_OFFSET);
+
+  // Buffers allocated without a size have the maximum size
+  unique_byte_buffer_t def = allocate_unique_buffer(pool);
+  TESTASSERT(def != nullptr and def->get_capacity() == SRSLTE_MAX_BUFFER_SIZE_BYTES);
+
+  // Too large for any buffer
+  TESTASSERT(allocate_unique_buffer(pool, SRSLTE_MAX_BUFFER_SIZE_BYTES, nullptr) == nullptr);
+
+  // The buffers go back to the pool of their class, and are cleared
+  small->msg += 10;
+  small->N_bytes = 20;
+  byte_buffer_t* small_ptr = small.get();
+  small.reset();
+  small = allocate_unique_buffer(pool, 1, nullptr);
+  TESTASSERT(small.get() == small_ptr);
+  TESTASSERT(small->N_bytes == 0 and small->get_headroom() == byte_buffer_pool::small_buffer_headroom);
+  return SRSLTE_SUCCESS;
+}
+
+/*
+ * When a class is empty, the buffers come from the larger classes
+ */
+int test_fallback()
+{
+  byte_buffer_pool                  pool(2);
+  std::vector<unique_byte_buffer_t> bufs;
+  for (uint32_t i = 0; i < 6; ++i) {
+    bufs.push_back(allocate_unique_buffer(pool, 10, nullptr));
+    TESTASSERT(bufs.back() != nullptr);
+  }
+  TESTASSERT(bufs[1]->get_capacity() == byte_buffer_pool::small_byte_buffer_capacity);
+  TESTASSERT(bufs[3]->get_capacity() == byte_buffer_pool::medium_byte_buffer_capacity);
+  TESTASSERT(bufs[5]->get_capacity() == SRSLTE_MAX_BUFFER_SIZE_BYTES);
+  TESTASSERT(allocate_unique_buffer(pool, 10, nullptr) == nullptr);
+
+  // A returned medium buffer is reused for a small allocation
+  bufs[2].reset();
+  unique_byte_buffer_t b = allocate_unique_buffer(pool, 10, nullptr);
+  TESTASSERT(b != nullptr and b->get_capacity() == byte_buffer_pool::medium_byte_buffer_capacity);
+  return SRSLTE_SUCCESS;
+}
+
+/*
+ * Byte buffers created on their own have the maximum size, whatever they are copied from
+ */
+int test_copy()
+{
+  byte_buffer_pool     pool(1);
+  unique_byte_buffer_t small = allocate_unique_buffer(pool, 10, nullptr);
+  for (uint32_t i = 0; i < 10; ++i) {
+    small->msg[i] = i;
+  }
+  small->N_bytes = 10;
+
+  byte_buffer_t copy(*small);
+  TESTASSERT(copy.get_capacity() == SRSLTE_MAX_BUFFER_SIZE_BYTES and copy.N_bytes == 10);
+  TESTASSERT(memcmp(copy.msg, small->msg, 10) == 0);
+
+  // Assignment keeps the storage, and truncates what does not fit
+  byte_buffer_t large;
+  large.N_bytes = 1000;
+  *small        = large;
+  TESTASSERT(small->get_capacity() == byte_buffer_pool::small_byte_buffer_capacity);
+  TESTASSERT(small->N_bytes == 256 and small->get_tailroom() == 0);
+  return SRSLTE_SUCCESS;
+}
+
+/*
+ * Buffers freed by other threads are reused, and the buffers cached by a thread go back to the pool when it exits
+ */
+int test_threads()
+{
+  const uint32_t       nof_buffers = 512, nof_threads = 4, nof_iterations = 20000;
+  byte_buffer_pool     pool(nof_buffers);
+  std::mutex           mutex;
+  std::vector<uint8_t> errors;
+
+  // Each thread frees the buffers allocated by the previous one
+  std::vector<std::vector<byte_buffer_t*> > handed_over(nof_threads);
+  std::vector<std::thread>                  threads;
+  for (uint32_t t = 0; t < nof_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      std::vector<byte_buffer_t*> mine;
+      for (uint32_t i = 0; i < nof_iterations; ++i) {
+        byte_buffer_t* b = pool.allocate(10, nullptr, true);
+        if (b == nullptr or b->N_bytes != 0) {
+          std::lock_guard<std::mutex> lock(mutex);
+          errors.push_back(t);
+          return;
+        }
+        b->N_bytes = 10;
+        mine.push_back(b);
+        if (mine.size() >= 16) {
+          std::lock_guard<std::mutex> lock(mutex);
+          std::vector<byte_buffer_t*>& next = handed_over[(t + 1) % nof_threads];
+          if (next.size() < 64) {
+            next.insert(next.end(), mine.begin(), mine.end());
+            mine.clear();
+          }
+          mine.insert(mine.end(), handed_over[t].begin(), handed_over[t].end());
+          handed_over[t].clear();
+        }
+        while (mine.size() > 32) {
+          pool.deallocate(mine.back());
+          mine.pop_back();
+        }
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      handed_over[t].insert(handed_over[t].end(), mine.begin(), mine.end());
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  TESTASSERT(errors.empty());
+  for (std::vector<byte_buffer_t*>& v : handed_over) {
+    for (byte_buffer_t* b : v) {
+      pool.deallocate(b);
+    }
+  }
+
+  // The buffers freed here are in the cache of this thread, the rest were given back by the threads that exited
+  std::vector<unique_byte_buffer_t> bufs;
+  for (uint32_t i = 0; i < nof_buffers; ++i) {
+    bufs.push_back(allocate_unique_buffer(pool, 10, nullptr));
+    TESTASSERT(bufs.back() != nullptr);
+    TESTASSERT(bufs.back()->get_capacity() == byte_buffer_pool::small_byte_buffer_capacity);
+  }
+  return SRSLTE_SUCCESS;
+}
+
+/*
+ * Buffers that are not in use, or not from the pool, are not put in the free list
+ */
+int test_double_free()
+{
+  buffer_pool<byte_buffer_t> pool(2);
+  byte_buffer_t*             b = pool.allocate();
+  TESTASSERT(b != nullptr);
+  TESTASSERT(pool.deallocate(b));
+  TESTASSERT(not pool.deallocate(b));
+  byte_buffer_t other;
+  TESTASSERT(not pool.deallocate(&other));
+  TESTASSERT(not pool.deallocate(nullptr));
+
+  TESTASSERT(pool.allocate() != nullptr);
+  TESTASSERT(pool.allocate() != nullptr);
+  TESTASSERT(pool.try_allocate() == nullptr);
+  return SRSLTE_SUCCESS;
+}
+
+/*
+ * Views point into the bytes of their owner, which is told once when each view goes back to the pool
+ */
+static void count_release(void* owner, void* arg)
+{
+  (*static_cast<uint32_t*>(owner))++;
+}
+
+int test_views()
+{
+  byte_buffer_pool pool(2);
+  uint8_t          bytes[100]   = {};
+  uint32_t         nof_released = 0;
+
+  unique_byte_buffer_t v1 = allocate_unique_buffer_view(pool, &bytes[10], 20, count_release, &nof_released, bytes);
+  unique_byte_buffer_t v2 = allocate_unique_buffer_view(pool, &bytes[30], 70, count_release, &nof_released, bytes);
+  TESTASSERT(v1 != nullptr and v2 != nullptr);
+  TESTASSERT(v1->msg == &bytes[10] and v1->N_bytes == 20);
+  TESTASSERT(v1->get_headroom() == 0 and v1->get_tailroom() == 0);
+  TESTASSERT(allocate_unique_buffer_view(pool, bytes, 1, count_release, &nof_released, bytes) == nullptr);
+
+  // Views are used like any other buffer, e.g. by skipping headers
+  v2->msg += 2;
+  v2->N_bytes -= 2;
+  v1.reset();
+  TESTASSERT(nof_released == 1);
+  v2.reset();
+  TESTASSERT(nof_released == 2);
+
+  // They are not taken from the byte buffer classes
+  TESTASSERT(pool.nof_used() == 0);
+  v1 = allocate_unique_buffer_view(pool, bytes, 100, count_release, &nof_released, bytes);
+  TESTASSERT(v1 != nullptr and v1->N_bytes == 100);
+  v1.reset();
+  TESTASSERT(nof_released == 3);
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_size_classes() == SRSLTE_SUCCESS);
+  TESTASSERT(test_fallback() == SRSLTE_SUCCESS);
+  TESTASSERT(test_copy() == SRSLTE_SUCCESS);
+  TESTASSERT(test_threads() == SRSLTE_SUCCESS);
+  TESTASSERT(test_double_free() == SRSLTE_SUCCESS);
+  TESTASSERT(test_views() == SRSLTE_SUCCESS);
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
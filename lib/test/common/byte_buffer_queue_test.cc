@@ -24,6 +24,8 @@
 #include "srslte/common/buffer_pool.h"
 #include "srslte/upper/byte_buffer_queue.h"
 #include <stdio.h>
+#include <unistd.h>
+#include <vector>
 
 using namespace srslte;
 
@@ -71,6 +73,49 @@ int main(int argc, char** argv)
     result = false;
   }
 
+  // Batch write into a bounded queue, the messages that do not fit are left to the caller
+  byte_buffer_queue                 q2(8);
+  std::vector<unique_byte_buffer_t> msgs;
+  for (uint32_t i = 0; i < 10; i++) {
+    msgs.push_back(srslte::allocate_unique_buffer(*byte_buffer_pool::get_instance(), true));
+    memcpy(msgs.back()->msg, &i, 4);
+    msgs.back()->N_bytes = 4;
+  }
+  if (q2.try_write_many(msgs) != 8 || q2.size() != 8 || q2.size_bytes() != 32 || msgs[8] == nullptr) {
+    result = false;
+  }
+
+  // Batch read, stopping after the fifth message
+  uint32_t count = 0;
+  q2.read_while([&count, &result](unique_byte_buffer_t msg) {
+    uint32_t v;
+    memcpy(&v, msg->msg, 4);
+    if (v != count) {
+      result = false;
+    }
+    return ++count < 5;
+  });
+  if (count != 5 || q2.size() != 3 || q2.size_bytes() != 12) {
+    result = false;
+  }
+
+  // The time in the queue and since the entry into the stack are counted when enabled
+  latency_histogram sojourn_delay, upper_delay;
+  byte_buffer_queue q3;
+  q3.set_delay_histograms(&sojourn_delay, &upper_delay);
+  b           = srslte::allocate_unique_buffer(*byte_buffer_pool::get_instance(), true);
+  b->md.rx_ns = latency_clock_ns() - 2000000;
+  q3.write(std::move(b));
+  q3.write(srslte::allocate_unique_buffer(*byte_buffer_pool::get_instance(), true));
+  usleep(1000);
+  q3.read();
+  q3.read();
+  latency_stats_t sojourn = sojourn_delay.read_and_reset();
+  latency_stats_t upper   = upper_delay.read_and_reset();
+  if (sojourn.count != 2 || sojourn.max_us < 1000 || upper.count != 1 || upper.max_us < 2000) {
+    result = false;
+  }
+
   if (result) {
     printf("Passed\n");
     exit(0);
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/latency_histogram.h"
+#include "srslte/common/metrics_counter.h"
+#include "srslte/common/test_common.h"
+#include "srslte/upper/rlc_metrics.h"
+#include <math.h>
+#include <thread>
+#include <vector>
+
+using namespace srslte;
+
+/// The metrics thread reads and resets the counters while the writers increment them, no increment is lost
+int test_read_while_counting()
+{
+  const uint32_t nof_threads    = 4;
+  const uint32_t nof_increments = 100000;
+
+  metrics_counter<uint64_t> pkts;
+  metrics_counter<uint64_t> bytes;
+  std::atomic<bool>         running(true);
+  uint64_t                  read_pkts  = 0;
+  uint64_t                  read_bytes = 0;
+
+  std::thread reader([&]() {
+    while (running) {
+      read_pkts += pkts.read_and_reset();
+      read_bytes += bytes.read_and_reset();
+    }
+  });
+
+  std::vector<std::thread> writers;
+  for (uint32_t t = 0; t < nof_threads; ++t) {
+    writers.emplace_back([&]() {
+      for (uint32_t i = 0; i < nof_increments; ++i) {
+        pkts++;
+        bytes += 100;
+      }
+    });
+  }
+  for (auto& t : writers) {
+    t.join();
+  }
+  running = false;
+  reader.join();
+
+  read_pkts += pkts.read_and_reset();
+  read_bytes += bytes.read_and_reset();
+  TESTASSERT(read_pkts == nof_threads * nof_increments);
+  TESTASSERT(read_bytes == 100 * read_pkts);
+  TESTASSERT(pkts.load() == 0);
+
+  return SRSLTE_SUCCESS;
+}
+
+int test_rlc_bearer_metrics()
+{
+  rlc_bearer_metrics_counters metrics;
+  metrics.num_tx_sdus++;
+  metrics.num_tx_sdu_bytes += 1500;
+  ++metrics.num_rx_pdus;
+  metrics.num_lost_pdus += 2;
+
+  rlc_bearer_metrics_t m = metrics.get();
+  TESTASSERT(m.num_tx_sdus == 1 and m.num_tx_sdu_bytes == 1500);
+  TESTASSERT(m.num_rx_pdus == 1 and m.num_lost_pdus == 2);
+  TESTASSERT(m.num_rx_sdus == 0 and m.num_tx_pdu_bytes == 0);
+
+  // Reading does not reset the counters, read_and_reset() does
+  m = metrics.read_and_reset();
+  TESTASSERT(m.num_tx_sdus == 1 and m.num_lost_pdus == 2);
+  m = metrics.get();
+  TESTASSERT(m.num_tx_sdus == 0 and m.num_tx_sdu_bytes == 0 and m.num_rx_pdus == 0 and m.num_lost_pdus == 0);
+
+  return SRSLTE_SUCCESS;
+}
+
+/// The percentiles are the bucket bounds above the exact ones, which are never more than a quarter above them
+int test_latency_histogram()
+{
+  for (uint32_t b = 1; b < latency_histogram::nof_buckets; b++) {
+    TESTASSERT(latency_histogram::bucket_limit_us(b) > latency_histogram::bucket_limit_us(b - 1));
+    TESTASSERT(latency_histogram::bucket_of(latency_histogram::bucket_limit_us(b - 1)) == b);
+  }
+
+  latency_histogram h;
+  TESTASSERT(h.read_and_reset().count == 0);
+  for (uint32_t us = 1; us <= 1000; us++) {
+    h.observe(us);
+  }
+  h.observe_interval(0, 5000000);
+  latency_stats_t s = h.get();
+  TESTASSERT(s.count == 1000 and s.max_us == 1000);
+  TESTASSERT(fabsf(s.mean_us - 500.5f) < 0.01f);
+  TESTASSERT(s.p50_us >= 500 and s.p50_us <= 625);
+  TESTASSERT(s.p99_us >= 990 and s.p99_us <= 1000);
+
+  s = h.read_and_reset();
+  TESTASSERT(s.count == 1000);
+  TESTASSERT(h.get().count == 0 and h.get().max_us == 0);
+
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_read_while_counting() == SRSLTE_SUCCESS);
+  TESTASSERT(test_rlc_bearer_metrics() == SRSLTE_SUCCESS);
+  TESTASSERT(test_latency_histogram() == SRSLTE_SUCCESS);
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
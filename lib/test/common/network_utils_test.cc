@@ -105,8 +105,84 @@ int test_socket_handler()
   return 0;
 }
 
+int test_udp_batch_handler(bool use_io_uring)
+{
+  srslte::log_ref log("GTPU");
+  log->set_level(srslte::LOG_LEVEL_DEBUG);
+  log->set_hex_limit(128);
+
+  std::mutex                     mutex;
+  std::vector<uint32_t>          rx_lens, pdu_lens;
+  srslte::rx_multisocket_handler sockhandler("RXSOCKETS", log, 65, use_io_uring);
+  using namespace srslte::net_utils;
+
+  int server_fd  = open_socket(addr_family::ipv4, socket_type::datagram, protocol_type::UDP);
+  int server2_fd = open_socket(addr_family::ipv4, socket_type::datagram, protocol_type::UDP);
+  int client_fd  = open_socket(addr_family::ipv4, socket_type::datagram, protocol_type::UDP);
+  TESTASSERT(server_fd >= 0 and server2_fd >= 0 and client_fd >= 0);
+  sockaddr_in server_addrin = {}, server2_addrin = {};
+  TESTASSERT(bind_addr(server_fd, "127.0.0.1", 22152, &server_addrin));
+  TESTASSERT(bind_addr(server2_fd, "127.0.0.1", 22153, &server2_addrin));
+
+  // the batch handler gets the packets of each recvmmsg call in order
+  auto batch_handler = [&mutex, &rx_lens](srslte::rx_multisocket_handler::recvfrom_batch_t batch) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& d : batch) {
+      rx_lens.push_back(d.pdu->N_bytes);
+    }
+  };
+  auto pdu_handler = [&mutex, &pdu_lens](srslte::unique_byte_buffer_t pdu, const sockaddr_in& from) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pdu_lens.push_back(pdu->N_bytes);
+  };
+  TESTASSERT(sockhandler.add_socket_pdu_batch_handler(server_fd, batch_handler));
+  TESTASSERT(sockhandler.add_socket_pdu_handler(server2_fd, pdu_handler));
+  TESTASSERT(not sockhandler.add_socket_pdu_handler(server_fd, pdu_handler));
+
+  const uint32_t nof_pdus  = 200;
+  uint8_t        buf[1500] = {};
+  for (uint32_t i = 0; i < nof_pdus; ++i) {
+    TESTASSERT(sendto(client_fd, buf, 10 + i, 0, (sockaddr*)&server_addrin, sizeof(server_addrin)) > 0);
+    TESTASSERT(sendto(client_fd, buf, 20 + i, 0, (sockaddr*)&server2_addrin, sizeof(server2_addrin)) > 0);
+  }
+
+  for (uint32_t time_elapsed = 0;; time_elapsed += 100) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (rx_lens.size() == nof_pdus and pdu_lens.size() == nof_pdus) {
+        break;
+      }
+    }
+    TESTASSERT(time_elapsed < 3000000);
+    usleep(100);
+  }
+  for (uint32_t i = 0; i < nof_pdus; ++i) {
+    TESTASSERT(rx_lens[i] == 10 + i);
+    TESTASSERT(pdu_lens[i] == 20 + i);
+  }
+
+  // packets to a removed socket are not read
+  TESTASSERT(sockhandler.remove_socket(server_fd));
+  usleep(10000);
+  TESTASSERT(sendto(client_fd, buf, 10, 0, (sockaddr*)&server_addrin, sizeof(server_addrin)) > 0);
+  usleep(10000);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    TESTASSERT(rx_lens.size() == nof_pdus);
+  }
+
+  sockhandler.stop();
+  close(server_fd);
+  close(server2_fd);
+  close(client_fd);
+  return 0;
+}
+
 int main()
 {
   TESTASSERT(test_socket_handler() == 0);
+  TESTASSERT(test_udp_batch_handler(false) == 0);
+  // falls back to epoll if io_uring is not supported
+  TESTASSERT(test_udp_batch_handler(true) == 0);
   return 0;
 }
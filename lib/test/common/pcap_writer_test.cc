@@ -0,0 +1,263 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include "srslte/common/mac_pcap.h"
+#include "srslte/common/pcap_writer.h"
+#include "srslte/common/test_common.h"
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+struct packet_t {
+  pcaprec_hdr_t        header;
+  std::vector<uint8_t> data;
+};
+
+/// Reads the packets of a PCAP file. Returns false if the file is not a complete PCAP file of the given DLT
+static bool read_pcap_file(const std::string& filename, uint32_t dlt, std::vector<packet_t>& packets)
+{
+  std::ifstream        in(filename, std::ios::binary);
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  pcap_hdr_t file_header;
+  if (data.size() < sizeof(file_header)) {
+    return false;
+  }
+  memcpy(&file_header, data.data(), sizeof(file_header));
+  if (file_header.magic_number != 0xa1b2c3d4 or file_header.network != dlt) {
+    return false;
+  }
+  size_t offset = sizeof(file_header);
+  while (offset < data.size()) {
+    packet_t packet;
+    if (data.size() - offset < sizeof(packet.header)) {
+      return false;
+    }
+    memcpy(&packet.header, &data[offset], sizeof(packet.header));
+    offset += sizeof(packet.header);
+    if (data.size() - offset < packet.header.incl_len or packet.header.incl_len != packet.header.orig_len) {
+      return false;
+    }
+    packet.data.assign(&data[offset], &data[offset] + packet.header.incl_len);
+    offset += packet.header.incl_len;
+    packets.push_back(std::move(packet));
+  }
+  return true;
+}
+
+int test_mac_pcap_matches_direct_write()
+{
+  const char* direct_filename = "pcap_writer_test_direct.pcap";
+  const char* async_filename  = "pcap_writer_test_async.pcap";
+
+  std::vector<std::vector<uint8_t> > pdus;
+  for (uint32_t i = 0; i < 100; ++i) {
+    pdus.emplace_back(1 + (i * 37) % 1500, (uint8_t)i);
+  }
+
+  FILE* fd = LTE_PCAP_Open(MAC_LTE_DLT, direct_filename);
+  TESTASSERT(fd != nullptr);
+  srslte::mac_pcap pcap;
+  pcap.open(async_filename, 5);
+  for (uint32_t i = 0; i < pdus.size(); ++i) {
+    MAC_Context_Info_t context = {};
+    context.radioType          = FDD_RADIO;
+    context.direction          = DIRECTION_DOWNLINK;
+    context.rntiType           = C_RNTI;
+    context.rnti               = 0x46 + i;
+    context.ueid               = 5;
+    context.crcStatusOK        = true;
+    context.cc_idx             = i % 2;
+    context.sysFrameNumber     = i / 10;
+    context.subFrameNumber     = i % 10;
+    LTE_PCAP_MAC_WritePDU(fd, &context, pdus[i].data(), pdus[i].size());
+    pcap.write_dl_crnti(pdus[i].data(), pdus[i].size(), 0x46 + i, true, i, i % 2);
+  }
+  LTE_PCAP_Close(fd);
+  pcap.close();
+
+  // Both files have the same packets, apart from the timestamps
+  std::vector<packet_t> direct, async;
+  TESTASSERT(read_pcap_file(direct_filename, MAC_LTE_DLT, direct));
+  TESTASSERT(read_pcap_file(async_filename, MAC_LTE_DLT, async));
+  TESTASSERT(direct.size() == pdus.size());
+  TESTASSERT(async.size() == pdus.size());
+  for (uint32_t i = 0; i < pdus.size(); ++i) {
+    TESTASSERT(async[i].header.incl_len == direct[i].header.incl_len);
+    TESTASSERT(async[i].data == direct[i].data);
+  }
+
+  remove(direct_filename);
+  remove(async_filename);
+  return SRSLTE_SUCCESS;
+}
+
+int test_concurrent_producers()
+{
+  const char*    filename      = "pcap_writer_test_threads.pcap";
+  const uint32_t nof_threads   = 4;
+  const uint32_t nof_pdus      = 20000;
+  const uint8_t  context[]     = {1, 2, 3};
+  uint64_t       nof_written[] = {0, 0, 0, 0};
+
+  // A small ring, so that some packets may be dropped
+  srslte::pcap_writer writer("PCAP_TEST", 256 * 1024);
+  TESTASSERT(writer.open(UDP_DLT, filename));
+
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < nof_threads; ++t) {
+    threads.emplace_back([&writer, &context, &nof_written, t, nof_pdus]() {
+      std::vector<uint8_t> pdu(2000);
+      for (uint32_t i = 0; i < nof_pdus; ++i) {
+        uint32_t len = 8 + (i * 131 + t) % 1900;
+        memcpy(&pdu[0], &t, sizeof(t));
+        memcpy(&pdu[4], &i, sizeof(i));
+        std::fill(pdu.begin() + 8, pdu.begin() + len, (uint8_t)(i + t));
+        if (writer.write(context, sizeof(context), pdu.data(), len)) {
+          nof_written[t]++;
+        }
+        if (i % 64 == 0) {
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  writer.close();
+
+  std::vector<packet_t> packets;
+  TESTASSERT(read_pcap_file(filename, UDP_DLT, packets));
+  TESTASSERT(packets.size() + writer.nof_dropped() == nof_threads * nof_pdus);
+
+  // The packets of every thread are complete and in order
+  uint64_t nof_read[] = {0, 0, 0, 0};
+  int64_t  last_pdu[] = {-1, -1, -1, -1};
+  for (const packet_t& p : packets) {
+    TESTASSERT(memcmp(p.data.data(), context, sizeof(context)) == 0);
+    uint32_t t, i;
+    memcpy(&t, &p.data[3], sizeof(t));
+    memcpy(&i, &p.data[7], sizeof(i));
+    TESTASSERT(t < nof_threads);
+    TESTASSERT((int64_t)i > last_pdu[t]);
+    TESTASSERT(p.data.size() == sizeof(context) + 8 + (i * 131 + t) % 1900);
+    for (uint32_t j = sizeof(context) + 8; j < p.data.size(); ++j) {
+      TESTASSERT(p.data[j] == (uint8_t)(i + t));
+    }
+    last_pdu[t] = i;
+    nof_read[t]++;
+  }
+  for (uint32_t t = 0; t < nof_threads; ++t) {
+    TESTASSERT(nof_read[t] == nof_written[t]);
+  }
+
+  remove(filename);
+  return SRSLTE_SUCCESS;
+}
+
+int test_close_with_producers_in_flight()
+{
+  const char*    filename    = "pcap_writer_test_close.pcap";
+  const uint32_t nof_threads = 4;
+
+  srslte::pcap_writer writer("PCAP_TEST");
+  TESTASSERT(writer.open(UDP_DLT, filename));
+
+  // The producers keep writing while the capture is closed, every packet accepted must be in the file
+  std::atomic<bool>        stop{false};
+  std::atomic<uint64_t>    nof_written{0};
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < nof_threads; ++t) {
+    threads.emplace_back([&writer, &stop, &nof_written]() {
+      std::vector<uint8_t> pdu(200, 0xab);
+      while (not stop.load(std::memory_order_relaxed)) {
+        if (writer.write(nullptr, 0, pdu.data(), pdu.size())) {
+          nof_written.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  writer.close();
+  stop.store(true, std::memory_order_relaxed);
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  std::vector<packet_t> packets;
+  TESTASSERT(read_pcap_file(filename, UDP_DLT, packets));
+  TESTASSERT(nof_written.load() > 0);
+  TESTASSERT(packets.size() == nof_written.load());
+
+  remove(filename);
+  return SRSLTE_SUCCESS;
+}
+
+int test_rotation_by_size()
+{
+  const char* filename    = "pcap_writer_test_rotation.pcap";
+  const char* filenames[] = {"pcap_writer_test_rotation.pcap",
+                             "pcap_writer_test_rotation.1.pcap",
+                             "pcap_writer_test_rotation.2.pcap",
+                             "pcap_writer_test_rotation.3.pcap"};
+
+  srslte::pcap_rotation_t rotation;
+  rotation.max_file_size = 4096;
+
+  srslte::pcap_writer writer("PCAP_TEST");
+  TESTASSERT(writer.open(S1AP_LTE_DLT, filename, rotation));
+  // Every packet takes 116 bytes of the file, so 35 fit in a file after its header
+  std::vector<uint8_t> pdu(100);
+  for (uint32_t i = 0; i < 100; ++i) {
+    pdu[0] = i;
+    TESTASSERT(writer.write(nullptr, 0, pdu.data(), pdu.size()));
+  }
+  writer.close();
+
+  uint32_t nof_packets = 0;
+  for (uint32_t n = 0; n < 3; ++n) {
+    std::vector<packet_t> packets;
+    TESTASSERT(read_pcap_file(filenames[n], S1AP_LTE_DLT, packets));
+    TESTASSERT(packets.size() == (n < 2 ? 35 : 30));
+    for (const packet_t& p : packets) {
+      TESTASSERT(p.data[0] == nof_packets++);
+    }
+  }
+  FILE* f = fopen(filenames[3], "r");
+  TESTASSERT(f == nullptr);
+
+  for (uint32_t n = 0; n < 3; ++n) {
+    remove(filenames[n]);
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_mac_pcap_matches_direct_write() == SRSLTE_SUCCESS);
+  TESTASSERT(test_concurrent_producers() == SRSLTE_SUCCESS);
+  TESTASSERT(test_close_with_producers_in_flight() == SRSLTE_SUCCESS);
+  TESTASSERT(test_rotation_by_size() == SRSLTE_SUCCESS);
+  return SRSLTE_SUCCESS;
+}
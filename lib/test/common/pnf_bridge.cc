@@ -37,6 +37,8 @@ struct pnf_args_t {
   std::string ue_vnf_addr;
   uint16_t    gnb_vnf_port;
   uint16_t    ue_vnf_port;
+  std::string gnb_shm_name;
+  std::string ue_shm_name;
   uint32_t    sf_interval;
   int32_t     num_sf;
   uint32_t    tb_len;
@@ -58,6 +60,8 @@ void parse_args(pnf_args_t* args, int argc, char* argv[])
           ("vnf.ue_addr", bpo::value<string>(&args->ue_vnf_addr)->default_value("127.0.0.1"), "VNF address")
           ("vnf.gnb_port", bpo::value<uint16_t>(&args->gnb_vnf_port)->default_value(3333), "gNB VNF port")
           ("vnf.ue_port", bpo::value<uint16_t>(&args->ue_vnf_port)->default_value(3334), "UE VNF port")
+          ("vnf.gnb_shm_name", bpo::value<string>(&args->gnb_shm_name)->default_value(""), "Shared memory of the gNB VNF instead of UDP")
+          ("vnf.ue_shm_name", bpo::value<string>(&args->ue_shm_name)->default_value(""), "Shared memory of the UE VNF instead of UDP")
           ("sf_interval", bpo::value<uint32_t>(&args->sf_interval)->default_value(1000), "Interval between subframes in us")
           ("num_sf", bpo::value<int32_t>(&args->num_sf)->default_value(-1), "Number of subframes to signal (-1 infinity)")
           ("tb_len", bpo::value<uint32_t>(&args->tb_len)->default_value(1600), "TB lenth (0 for random size)");
@@ -100,6 +104,12 @@ int main(int argc, char** argv)
   srslte::srslte_basic_pnf gnb_pnf(
       "gnb", args.gnb_vnf_addr, args.gnb_vnf_port, args.sf_interval, args.num_sf, args.tb_len);
 
+  if ((not args.ue_shm_name.empty() and not ue_pnf.use_shm(args.ue_shm_name)) or
+      (not args.gnb_shm_name.empty() and not gnb_pnf.use_shm(args.gnb_shm_name))) {
+    printf("Couldn't map the shared memory of the VNFs\n");
+    return -1;
+  }
+
   gnb_pnf.connect_out_rf_queue(ue_pnf.get_in_rf_queue());
 
   ue_pnf.start();
@@ -36,6 +36,7 @@ struct pnf_args_t {
   std::string type;
   std::string vnf_addr;
   uint16_t    vnf_port;
+  std::string shm_name;
   uint32_t    sf_interval;
   int32_t     num_sf;
   uint32_t    tb_len;
@@ -56,6 +57,7 @@ void parse_args(pnf_args_t* args, int argc, char* argv[])
           ("vnf.type", bpo::value<string>(&args->type)->default_value("gnb"), "VNF instance type [gnb,ue]")
           ("vnf.addr", bpo::value<string>(&args->vnf_addr)->default_value("127.0.0.1"), "VNF address")
           ("vnf.port", bpo::value<uint16_t>(&args->vnf_port)->default_value(3333), "VNF port")
+          ("vnf.shm_name", bpo::value<string>(&args->shm_name)->default_value(""), "Shared memory of the VNF instead of UDP")
           ("sf_interval", bpo::value<uint32_t>(&args->sf_interval)->default_value(1000), "Interval between subframes in us")
           ("num_sf", bpo::value<int32_t>(&args->num_sf)->default_value(-1), "Number of subframes to signal (-1 infinity)")
           ("tb_len", bpo::value<uint32_t>(&args->tb_len)->default_value(0), "TB lenth (0 for random size)");
@@ -97,6 +99,11 @@ int main(int argc, char** argv)
 
   srslte::srslte_basic_pnf pnf(args.type, args.vnf_addr, args.vnf_port, args.sf_interval, args.num_sf, args.tb_len);
 
+  if (not args.shm_name.empty() and not pnf.use_shm(args.shm_name)) {
+    printf("Couldn't map the shared memory %s\n", args.shm_name.c_str());
+    return -1;
+  }
+
   pnf.start();
 
   while (running) {
@@ -22,6 +22,7 @@
 #include "srslte/adt/move_callback.h"
 #include "srslte/common/multiqueue.h"
 #include "srslte/common/thread_pool.h"
+#include <array>
 #include <iostream>
 #include <thread>
 #include <unistd.h>
@@ -238,6 +239,65 @@ int test_multiqueue_threading3()
   return 0;
 }
 
+int test_multiqueue_threading4()
+{
+  std::cout << "\n===== TEST multiqueue threading test 4: start =====\n";
+  // Description: several producers push move-only tasks to their own small queues, blocking when they are full,
+  //              while the consumer pops them in batches or one by one. Every task runs once, in the order of its queue
+
+  const int                      nof_producers = 4, nof_tasks = 5000;
+  task_multiqueue                multiqueue(16);
+  std::vector<int>               last_value(nof_producers, -1);
+  std::vector<task_queue_handle> handles;
+  std::vector<std::thread>       producers;
+  std::vector<move_task_t>       batch;
+  bool                           in_order = true;
+  for (int p = 0; p < nof_producers; ++p) {
+    handles.push_back(multiqueue.get_queue_handler());
+  }
+  for (int p = 0; p < nof_producers; ++p) {
+    producers.emplace_back([&handles, &last_value, &in_order, p]() {
+      for (int i = 0; i < nof_tasks; ++i) {
+        auto task = [&last_value, &in_order, p](const std::unique_ptr<int>& v) {
+          in_order &= last_value[p] + 1 == *v;
+          last_value[p] = *v;
+        };
+        handles[p].push(std::bind(task, std::unique_ptr<int>(new int(i))));
+      }
+    });
+  }
+
+  int count = 0;
+  while (count < nof_producers * nof_tasks) {
+    if (count % 2 == 0) {
+      batch.clear();
+      count += multiqueue.try_pop_batch(&batch, 8);
+      for (auto& t : batch) {
+        t();
+      }
+    } else {
+      move_task_t task;
+      TESTASSERT(multiqueue.wait_pop(&task) >= 0)
+      task();
+      count++;
+    }
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  TESTASSERT(in_order)
+  for (int p = 0; p < nof_producers; ++p) {
+    TESTASSERT(last_value[p] == nof_tasks - 1)
+    TESTASSERT(handles[p].size() == 0)
+  }
+  TESTASSERT(multiqueue.try_pop_batch(&batch, 8) == 0)
+
+  std::cout << "outcome: Success\n";
+  std::cout << "===================================================\n";
+
+  return 0;
+}
+
 int test_task_thread_pool()
 {
   std::cout << "\n====== TEST task thread pool test 1: start ======\n";
@@ -343,6 +403,67 @@ int test_task_thread_pool3()
   return 0;
 }
 
+int test_task_thread_pool4()
+{
+  std::cout << "\n====== TEST task thread pool test 4: start ======\n";
+  // Description: high priority tasks run before the normal ones, tasks can be move-only, and the tasks a worker pushes
+  //              to its own queue are stolen by the others while it is busy
+
+  std::mutex            mut;
+  std::vector<int>      order;
+  std::atomic<bool>     release{false};
+  std::atomic<uint32_t> nof_done{0};
+
+  {
+    task_thread_pool thread_pool(1);
+    thread_pool.start();
+    thread_pool.push_task([&release](uint32_t worker_id) {
+      while (not release) {
+        usleep(100);
+      }
+    });
+    auto task = [&mut, &order, &nof_done](std::unique_ptr<int>& val, uint32_t worker_id) {
+      std::lock_guard<std::mutex> lock(mut);
+      order.push_back(*val);
+      nof_done++;
+    };
+    for (int i = 0; i < 4; ++i) {
+      task_thread_pool::task_priority prio =
+          i % 2 == 0 ? task_thread_pool::task_priority::normal : task_thread_pool::task_priority::high;
+      thread_pool.push_task(std::bind(task, std::unique_ptr<int>(new int{i}), std::placeholders::_1), prio);
+    }
+    release = true;
+    while (nof_done < 4) {
+      usleep(100);
+    }
+    thread_pool.stop();
+  }
+  TESTASSERT(order == std::vector<int>({1, 3, 0, 2}));
+
+  const uint32_t   nof_tasks = 100;
+  task_thread_pool thread_pool(2);
+  thread_pool.start();
+  nof_done = 0;
+  thread_pool.push_task([&thread_pool, &nof_done, nof_tasks](uint32_t worker_id) {
+    for (uint32_t i = 0; i < nof_tasks; ++i) {
+      thread_pool.push_task([&nof_done](uint32_t id) { nof_done++; });
+    }
+    // the worker waits for its own tasks, which only the other worker can run
+    while (nof_done < nof_tasks) {
+      usleep(100);
+    }
+  });
+  for (uint32_t time_elapsed = 0; nof_done < nof_tasks; time_elapsed += 100) {
+    TESTASSERT(time_elapsed < 3000000);
+    usleep(100);
+  }
+  thread_pool.stop();
+
+  std::cout << "outcome: Success\n";
+  std::cout << "===================================================\n";
+  return 0;
+}
+
 struct C {
   std::unique_ptr<int> val{new int{5}};
 };
@@ -431,10 +552,12 @@ int main()
   TESTASSERT(test_multiqueue_threading() == 0);
   TESTASSERT(test_multiqueue_threading2() == 0);
   TESTASSERT(test_multiqueue_threading3() == 0);
+  TESTASSERT(test_multiqueue_threading4() == 0);
 
   TESTASSERT(test_task_thread_pool() == 0);
   TESTASSERT(test_task_thread_pool2() == 0);
   TESTASSERT(test_task_thread_pool3() == 0);
+  TESTASSERT(test_task_thread_pool4() == 0);
 
   TESTASSERT(test_inplace_task() == 0);
 }
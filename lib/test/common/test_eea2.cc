@@ -24,6 +24,7 @@
 #include <stdlib.h>
 
 #include "srslte/common/liblte_security.h"
+#include "srslte/common/security.h"
 #include "srslte/srslte.h"
 
 /*
@@ -409,6 +410,34 @@ void test_set_1_block_size()
   free(out);
 }
 
+// same as test_set_1_block_size() with an expanded key
+void test_set_1_expanded_key()
+{
+  uint8_t  key[]     = {0xd3, 0xc5, 0xd5, 0x92, 0x32, 0x7f, 0xb1, 0x1c, 0x40, 0x35, 0xc6, 0x68, 0x0a, 0xf8, 0xc6, 0xd1};
+  uint32_t count     = 0x398a59b4;
+  uint8_t  bearer    = 0x15;
+  uint8_t  direction = 1;
+  uint32_t len_bytes = 32;
+  uint8_t  msg[] = {0x98, 0x1b, 0xa6, 0x82, 0x4c, 0x1b, 0xfb, 0x1a, 0xb4, 0x85, 0x47, 0x20, 0x29, 0xb7, 0x1d, 0x80,
+                   0x8c, 0xe3, 0x3e, 0x2c, 0xc3, 0xc0, 0xb5, 0xfc, 0x1f, 0x3d, 0xe8, 0xa6, 0xdc, 0x66, 0xb1, 0xf0};
+  uint8_t  ct[]  = {0xe9, 0xfe, 0xd8, 0xa6, 0x3d, 0x15, 0x53, 0x04, 0xd7, 0x1d, 0xf2, 0x0b, 0xf3, 0xe8, 0x22, 0x14,
+                  0xb2, 0x0e, 0xd7, 0xda, 0xd2, 0xf2, 0x33, 0xdc, 0x3c, 0x22, 0xd7, 0xbd, 0xee, 0xed, 0x8e, 0x78};
+  uint8_t  out[32];
+
+  srslte::security_aes128_key aes_key;
+  aes_key.set(key);
+
+  // encryption, twice to check the key is reused
+  for (uint32_t i = 0; i < 2; i++) {
+    assert(srslte::security_128_eea2(aes_key, count, bearer, direction, msg, len_bytes, out) == SRSLTE_SUCCESS);
+    assert(arrcmp(ct, out, len_bytes) == 0);
+  }
+
+  // decryption
+  assert(srslte::security_128_eea2(aes_key, count, bearer, direction, ct, len_bytes, out) == SRSLTE_SUCCESS);
+  assert(arrcmp(msg, out, len_bytes) == 0);
+}
+
 // inserted bit flip in msg[0]
 void test_set_1_invalid()
 {
@@ -459,5 +488,6 @@ int main(int argc, char* argv[])
   test_set_5();
   test_set_6();
   test_set_1_block_size();
+  test_set_1_expanded_key();
   test_set_1_invalid();
 }
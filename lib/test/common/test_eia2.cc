@@ -0,0 +1,96 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "srslte/common/liblte_security.h"
+#include "srslte/common/security.h"
+#include "srslte/srslte.h"
+
+/*
+ * Tests
+ *
+ * Document Reference: 33.401 V13.1.0 Annex C.2
+ */
+
+void test_set_2()
+{
+  uint8_t  key[]          = {0xd3, 0xc5, 0xd5, 0x92, 0x32, 0x7f, 0xb1, 0x1c, 0x40, 0x35, 0xc6, 0x68, 0x0a, 0xf8, 0xc6, 0xd1};
+  uint32_t count          = 0x398a59b4;
+  uint8_t  bearer         = 0x1a;
+  uint8_t  direction      = 1;
+  uint32_t len_bytes      = 8;
+  uint8_t  msg[]          = {0x48, 0x45, 0x83, 0xd5, 0xaf, 0xe0, 0x82, 0xae};
+  uint8_t  expected_mac[] = {0xb9, 0x37, 0x87, 0xe6};
+
+  uint8_t mac[4];
+
+  liblte_security_128_eia2(key, count, bearer, direction, msg, len_bytes, mac);
+  for (int i = 0; i < 4; i++) {
+    assert(mac[i] == expected_mac[i]);
+  }
+
+  srslte::security_aes128_key aes_key;
+  aes_key.set(key);
+  srslte::security_128_eia2(aes_key, count, bearer, direction, msg, len_bytes, mac);
+  for (int i = 0; i < 4; i++) {
+    assert(mac[i] == expected_mac[i]);
+  }
+  printf("Test Set 2: Success\n");
+}
+
+// The expanded key must give the same MAC as the reference implementation for any length, including the ones that
+// fill the last CMAC block
+void test_expanded_key_lengths()
+{
+  uint8_t  key[16];
+  uint8_t  msg[100];
+  uint8_t  mac[4], mac_exp[4];
+  uint32_t count = 0x12345678;
+
+  srslte::security_aes128_key aes_key;
+  for (uint32_t k = 0; k < 3; k++) {
+    for (uint32_t i = 0; i < 16; i++) {
+      key[i] = rand() & 0xff;
+    }
+    aes_key.set(key);
+
+    for (uint32_t len = 0; len <= sizeof(msg); len++) {
+      for (uint32_t i = 0; i < len; i++) {
+        msg[i] = rand() & 0xff;
+      }
+      liblte_security_128_eia2(key, count + len, k, len % 2, msg, len, mac_exp);
+      srslte::security_128_eia2(aes_key, count + len, k, len % 2, msg, len, mac);
+      for (int i = 0; i < 4; i++) {
+        assert(mac[i] == mac_exp[i]);
+      }
+    }
+  }
+  printf("Expanded key: Success\n");
+}
+
+int main(int argc, char* argv[])
+{
+  test_set_2();
+  test_expanded_key_lengths();
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/metrics_http_server.h"
+#include "srslte/common/test_common.h"
+#include "srslte/common/thread_metrics.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace srslte;
+
+/// Every thread observes the values 1..1000, two of the threads share their name
+int test_observe_from_threads()
+{
+  const uint32_t nof_threads = 3;
+
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < nof_threads; ++t) {
+    threads.emplace_back([t]() {
+      std::string name = "METRICS_TEST" + std::to_string(t / 2);
+      pthread_setname_np(pthread_self(), name.c_str());
+      for (uint32_t v = 1; v <= 1000; ++v) {
+        thread_metrics::observe(thread_metric::sched_time_us, v);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // The histograms outlive their threads and are merged by thread name
+  std::vector<thread_metrics::histogram_t> histograms = thread_metrics::collect(thread_metric::sched_time_us);
+  TESTASSERT(histograms.size() == 2);
+  TESTASSERT(histograms[0].thread_name == "METRICS_TEST0");
+  TESTASSERT(histograms[1].thread_name == "METRICS_TEST1");
+  TESTASSERT(histograms[0].count == 2000 and histograms[1].count == 1000);
+  TESTASSERT(histograms[0].sum == 2 * 500500 and histograms[1].sum == 500500);
+
+  // Bucket i counts the values in (2^(i-1), 2^i]
+  const thread_metrics::histogram_t& h = histograms[1];
+  TESTASSERT(h.buckets[0] == 1 and h.buckets[1] == 1 and h.buckets[2] == 2 and h.buckets[3] == 4);
+  TESTASSERT(h.buckets[9] == 256 and h.buckets[10] == 1000 - 512);
+  TESTASSERT(h.buckets[11] == 0);
+
+  TESTASSERT(thread_metrics::collect(thread_metric::phy_worker_time_us).empty());
+
+  return SRSLTE_SUCCESS;
+}
+
+int test_openmetrics_text()
+{
+  std::string text;
+  thread_metrics::write_openmetrics("test_", text);
+
+  TESTASSERT(text.find("# TYPE test_sched_time_us histogram\n") != std::string::npos);
+  TESTASSERT(text.find("test_sched_time_us_bucket{thread=\"METRICS_TEST0\",le=\"1\"} 2\n") != std::string::npos);
+  TESTASSERT(text.find("test_sched_time_us_bucket{thread=\"METRICS_TEST1\",le=\"512\"} 512\n") != std::string::npos);
+  TESTASSERT(text.find("test_sched_time_us_bucket{thread=\"METRICS_TEST1\",le=\"1024\"} 1000\n") != std::string::npos);
+  TESTASSERT(text.find("test_sched_time_us_bucket{thread=\"METRICS_TEST1\",le=\"+Inf\"} 1000\n") != std::string::npos);
+  TESTASSERT(text.find("test_sched_time_us_sum{thread=\"METRICS_TEST1\"} 500500\n") != std::string::npos);
+  TESTASSERT(text.find("test_sched_time_us_count{thread=\"METRICS_TEST0\"} 2000\n") != std::string::npos);
+  TESTASSERT(text.find("phy_worker_time_us") == std::string::npos);
+
+  text.clear();
+  pthread_setname_np(pthread_self(), "METRICS_MAIN");
+  thread_metrics::write_thread_cpu_time("test_", text);
+  TESTASSERT(text.find("# TYPE test_thread_cpu_seconds_total counter\n") != std::string::npos);
+  TESTASSERT(text.find("test_thread_cpu_seconds_total{thread=\"METRICS_MAIN\",tid=\"") != std::string::npos);
+
+  return SRSLTE_SUCCESS;
+}
+
+/// Sends a request to the server and returns the whole response
+std::string http_request(uint16_t port, const std::string& request)
+{
+  int         fd   = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr = {};
+  addr.sin_family  = AF_INET;
+  addr.sin_port    = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+    close(fd);
+    return "";
+  }
+  send(fd, request.data(), request.size(), 0);
+
+  std::string response;
+  char        buffer[1024];
+  ssize_t     n;
+  while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, n);
+  }
+  close(fd);
+  return response;
+}
+
+int test_http_server()
+{
+  uint32_t            nof_scrapes = 0;
+  metrics_http_server server;
+  TESTASSERT(server.init("127.0.0.1", 0, [&nof_scrapes]() {
+    nof_scrapes++;
+    return std::string("test_metric 1\n");
+  }));
+  TESTASSERT(server.get_port() != 0);
+
+  std::string response = http_request(server.get_port(), "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  TESTASSERT(response.compare(0, 17, "HTTP/1.1 200 OK\r\n") == 0);
+  TESTASSERT(response.find("Content-Length: 14\r\n") != std::string::npos);
+  TESTASSERT(response.compare(response.size() - 18, 18, "\r\n\r\ntest_metric 1\n") == 0);
+
+  response = http_request(server.get_port(), "GET /metrics?name[]=x HTTP/1.0\r\n\r\n");
+  TESTASSERT(response.compare(0, 17, "HTTP/1.1 200 OK\r\n") == 0);
+
+  response = http_request(server.get_port(), "GET / HTTP/1.1\r\n\r\n");
+  TESTASSERT(response.compare(0, 22, "HTTP/1.1 404 Not Found") == 0);
+
+  response = http_request(server.get_port(), "POST /metrics HTTP/1.1\r\n\r\n");
+  TESTASSERT(response.compare(0, 12, "HTTP/1.1 405") == 0);
+  TESTASSERT(nof_scrapes == 2);
+
+  server.stop();
+  TESTASSERT(http_request(server.get_port(), "GET /metrics HTTP/1.1\r\n\r\n").empty());
+
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_observe_from_threads() == SRSLTE_SUCCESS);
+  TESTASSERT(test_openmetrics_text() == SRSLTE_SUCCESS);
+  TESTASSERT(test_http_server() == SRSLTE_SUCCESS);
+  return SRSLTE_SUCCESS;
+}
@@ -412,6 +412,61 @@ int timers_test6()
   return SRSLTE_SUCCESS;
 }
 
+/**
+ * Description:
+ * - many timers with durations longer than the timing wheel, some of them stopped or re-run on the way
+ * - every running timer has to expire exactly at its timeout, and a stopped one must never expire
+ */
+int timers_test7()
+{
+  timer_handler                            timers;
+  std::mt19937                             gen(7);
+  std::uniform_int_distribution<uint32_t>  dur_dist(0, 3000);
+  const uint32_t                           nof_timers = 500;
+  std::vector<timer_handler::unique_timer> tlist;
+  std::vector<int>                         expected(nof_timers, -1), fired(nof_timers, -1);
+  int                                      now = 0;
+
+  for (uint32_t i = 0; i < nof_timers; ++i) {
+    tlist.push_back(timers.get_unique_timer());
+    uint32_t d = dur_dist(gen);
+    tlist[i].set(d, [&fired, &now, i](uint32_t tid) { fired[i] = now; });
+    tlist[i].run();
+    expected[i] = std::max(d, 1u);
+  }
+
+  while (now < 5000) {
+    now++;
+    timers.step_all();
+    if (now == 500) {
+      // stop a third of the timers and re-run another third with a new duration
+      for (uint32_t i = 0; i < nof_timers; ++i) {
+        if (i % 3 == 0 and tlist[i].is_running()) {
+          tlist[i].stop();
+          expected[i] = -1;
+        } else if (i % 3 == 1 and tlist[i].is_running()) {
+          uint32_t d = dur_dist(gen) + 1;
+          tlist[i].set(d);
+          tlist[i].run();
+          expected[i] = now + d;
+        }
+      }
+    }
+  }
+  for (uint32_t i = 0; i < nof_timers; ++i) {
+    TESTASSERT(fired[i] == expected[i]);
+  }
+  TESTASSERT(timers.nof_running_timers() == 0);
+
+  // freed timers are reused
+  tlist.clear();
+  TESTASSERT(timers.nof_timers() == 0);
+  timer_handler::unique_timer t = timers.get_unique_timer();
+  TESTASSERT(t.id() < nof_timers);
+
+  return SRSLTE_SUCCESS;
+}
+
 int main()
 {
   TESTASSERT(timers_test1() == SRSLTE_SUCCESS);
@@ -420,6 +475,7 @@ int main()
   TESTASSERT(timers_test4() == SRSLTE_SUCCESS);
   TESTASSERT(timers_test5() == SRSLTE_SUCCESS);
   TESTASSERT(timers_test6() == SRSLTE_SUCCESS);
+  TESTASSERT(timers_test7() == SRSLTE_SUCCESS);
   printf("Success\n");
   return 0;
 }
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/test_common.h"
+#include "srslte/common/tti_deadline_watchdog.h"
+#include "srslte/common/tti_trace.h"
+#include <fstream>
+#include <iterator>
+
+using namespace srslte;
+
+/// Radio timestamp of the given time of the host clock
+static srslte_timestamp_t radio_time(int64_t ns)
+{
+  srslte_timestamp_t t = {};
+  t.full_secs          = ns / 1000000000;
+  t.frac_secs          = (ns % 1000000000) / 1e9;
+  return t;
+}
+
+static std::string read_file(const char* filename)
+{
+  std::ifstream in(filename);
+  return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+static size_t count(const std::string& s, const std::string& pattern)
+{
+  size_t n = 0;
+  for (size_t pos = s.find(pattern); pos != std::string::npos; pos = s.find(pattern, pos + 1)) {
+    n++;
+  }
+  return n;
+}
+
+int test_tx_late()
+{
+  tti_deadline_watchdog watchdog;
+  watchdog.init({}, nullptr);
+
+  // Nothing is known about the radio time before the first reception
+  int64_t now = tti_trace::now_ns();
+  watchdog.tx_ready(0, radio_time(now - 1000000));
+  TESTASSERT(watchdog.get_nof_misses() == 0);
+
+  // The subframes are received as soon as they end
+  for (uint32_t tti = 0; tti < 10; tti++) {
+    watchdog.rx_done(tti, radio_time((int64_t)tti_trace::now_ns() - 1000000));
+  }
+  now = tti_trace::now_ns();
+  watchdog.tx_ready(9, radio_time(now + 3000000));
+  TESTASSERT(watchdog.get_nof_misses() == 0);
+
+  // Less than the margin before the Tx time, and after it
+  watchdog.tx_ready(10, radio_time(now + 50000));
+  TESTASSERT(watchdog.get_nof_misses() == 1);
+  watchdog.tx_ready(11, radio_time(now - 500000));
+  TESTASSERT(watchdog.get_nof_misses() == 2);
+
+  return SRSLTE_SUCCESS;
+}
+
+int test_rx_behind()
+{
+  tti_deadline_watchdog watchdog;
+  watchdog.init({}, nullptr);
+
+  int64_t radio_offset = 5000000000;
+  for (uint32_t tti = 0; tti < 10; tti++) {
+    watchdog.rx_done(tti, radio_time((int64_t)tti_trace::now_ns() + radio_offset - 1000000));
+  }
+  TESTASSERT(watchdog.get_nof_misses() == 0);
+
+  // The receiving thread falls 3 ms behind for several TTIs, it is a single miss
+  for (uint32_t tti = 10; tti < 15; tti++) {
+    watchdog.rx_done(tti, radio_time((int64_t)tti_trace::now_ns() + radio_offset - 4000000));
+  }
+  TESTASSERT(watchdog.get_nof_misses() == 1);
+
+  // It catches up and falls behind again
+  watchdog.rx_done(15, radio_time((int64_t)tti_trace::now_ns() + radio_offset - 1000000));
+  watchdog.rx_done(16, radio_time((int64_t)tti_trace::now_ns() + radio_offset - 4000000));
+  TESTASSERT(watchdog.get_nof_misses() == 2);
+
+  return SRSLTE_SUCCESS;
+}
+
+int test_snapshot()
+{
+  const char* filename = "tti_deadline_watchdog_test.txt";
+  remove(filename);
+
+  tti_deadline_watchdog::add_context_source("test queues", []() { return std::string("queue=5"); });
+
+  deadline_watchdog_args_t args;
+  args.dump_filename  = filename;
+  args.max_dumps      = 2;
+  args.dump_period_ms = 0;
+  {
+    tti_deadline_watchdog watchdog;
+    watchdog.init(args, nullptr);
+
+    // Stages of the offending TTI, of a previous one and of one too old for the snapshot
+    int64_t now = tti_trace::now_ns();
+    tti_trace::record(tti_stage::fft, 100, now, now + 100000);
+    tti_trace::record(tti_stage::pusch_decode, 100, now + 100000, now + 600000);
+    tti_trace::record(tti_stage::dl_sched, 98, now - 2000000, now - 1900000);
+    tti_trace::record(tti_stage::worker, 90, now - 10000000, now - 9000000);
+
+    for (uint32_t tti = 90; tti < 100; tti++) {
+      watchdog.rx_done(tti, radio_time((int64_t)tti_trace::now_ns() - 1000000));
+    }
+    watchdog.tx_ready(100, radio_time((int64_t)tti_trace::now_ns() - 200000));
+    watchdog.tx_ready(101, radio_time((int64_t)tti_trace::now_ns() - 200000));
+    watchdog.tx_ready(102, radio_time((int64_t)tti_trace::now_ns() - 200000));
+    TESTASSERT(watchdog.get_nof_misses() == 3);
+  }
+
+  // Only max_dumps snapshots are written
+  std::string snapshot = read_file(filename);
+  TESTASSERT(count(snapshot, "=== Deadline miss tx_late") == 2);
+  TESTASSERT(snapshot.find("=== Deadline miss tx_late in TTI 100") != std::string::npos);
+  TESTASSERT(snapshot.find("=== Deadline miss tx_late in TTI 101") != std::string::npos);
+  TESTASSERT(count(snapshot, "--- test queues\nqueue=5\n") == 2);
+
+  // The stages of the 4 TTIs before the offending one are included
+  std::string first = snapshot.substr(0, snapshot.find("=== Deadline miss tx_late in TTI 101"));
+  TESTASSERT(first.find("     100 fft ") != std::string::npos);
+  TESTASSERT(first.find("     100 pusch_decode ") != std::string::npos);
+  TESTASSERT(first.find("      98 dl_sched ") != std::string::npos);
+  TESTASSERT(first.find("      90 worker") == std::string::npos);
+  TESTASSERT(first.find("dl_sched") < first.find("fft"));
+
+  tti_deadline_watchdog::remove_context_source("test queues");
+  remove(filename);
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_tx_late() == SRSLTE_SUCCESS);
+  TESTASSERT(test_rx_behind() == SRSLTE_SUCCESS);
+  TESTASSERT(test_snapshot() == SRSLTE_SUCCESS);
+  return SRSLTE_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/test_common.h"
+#include "srslte/common/tti_sempahore.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/*
+ * Emulates the PHY worker pool: workers are pushed in TTI order, finish out of order and must release in order
+ */
+int test_release_order()
+{
+  const uint32_t                nof_workers = 8;
+  const uint32_t                nof_tti     = 20000;
+  srslte::tti_semaphore<void*>  sem;
+  std::vector<uint32_t>         order;
+  std::atomic<uint32_t>         free_mask{(1u << nof_workers) - 1};
+  std::vector<std::atomic<int>> job(nof_workers);
+  std::atomic<bool>             running{true};
+  std::vector<std::thread>      threads;
+  int                           ids[nof_workers];
+
+  for (auto& j : job) {
+    j = -1;
+  }
+
+  for (uint32_t w = 0; w < nof_workers; w++) {
+    threads.emplace_back([&, w]() {
+      while (running) {
+        int tti = job[w].load();
+        if (tti < 0) {
+          std::this_thread::yield();
+          continue;
+        }
+        if ((tti * 7 + w) % 5 == 0) {
+          std::this_thread::sleep_for(std::chrono::microseconds(tti % 30));
+        }
+        sem.wait(&ids[w]);
+        order.push_back(tti);
+        job[w] = -1;
+        sem.release();
+        free_mask.fetch_or(1u << w);
+      }
+    });
+  }
+
+  for (uint32_t tti = 0; tti < nof_tti; tti++) {
+    uint32_t mask;
+    while ((mask = free_mask.load()) == 0) {
+      std::this_thread::yield();
+    }
+    uint32_t w = __builtin_ctz(mask);
+    free_mask.fetch_and(~(1u << w));
+    sem.push(&ids[w]);
+    job[w] = tti;
+  }
+  sem.wait_all();
+
+  running = false;
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  TESTASSERT(order.size() == nof_tti);
+  for (uint32_t i = 0; i < nof_tti; i++) {
+    TESTASSERT(order[i] == i);
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int test_wait_single_thread()
+{
+  srslte::tti_semaphore<uint32_t> sem;
+
+  // An empty semaphore must not block
+  sem.wait(1);
+  sem.wait_all();
+
+  sem.push(2);
+  sem.push(3);
+  sem.wait(2);
+  sem.release();
+  sem.wait(3);
+  sem.release();
+  sem.wait_all();
+
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_wait_single_thread() == SRSLTE_SUCCESS);
+  TESTASSERT(test_release_order() == SRSLTE_SUCCESS);
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/test_common.h"
+#include "srslte/common/tti_trace.h"
+#include <fstream>
+#include <iterator>
+#include <pthread.h>
+#include <thread>
+
+using namespace srslte;
+
+/// Every thread records 1000 TTIs with stages of known durations, the worker stage of TTI i lasting i us
+int test_record_from_threads()
+{
+  const uint32_t nof_threads = 4;
+
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < nof_threads; ++t) {
+    threads.emplace_back([t]() {
+      std::string name = "TRACE_TEST" + std::to_string(t);
+      pthread_setname_np(pthread_self(), name.c_str());
+      uint64_t now = 1000000000ul * (t + 1);
+      for (uint32_t tti = 0; tti < 1000; ++tti) {
+        tti_trace::set_thread_tti(tti * nof_threads + t);
+        tti_trace::record(tti_stage::fft, tti_trace::get_thread_tti(), now, now + 10000);
+        tti_trace::record(tti_stage::worker, tti_trace::get_thread_tti(), now, now + 1000 * (tti + 1));
+        now += 1000000;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // The spans outlive their threads
+  std::vector<tti_trace::thread_spans_t> spans = tti_trace::collect();
+  TESTASSERT(spans.size() == nof_threads);
+  for (const tti_trace::thread_spans_t& t : spans) {
+    TESTASSERT(t.thread_name.compare(0, 10, "TRACE_TEST") == 0);
+    TESTASSERT(t.spans.size() == 2000);
+    for (uint32_t i = 0; i < t.spans.size(); i += 2) {
+      TESTASSERT(t.spans[i].stage == tti_stage::fft);
+      TESTASSERT(t.spans[i].duration_ns == 10000);
+      TESTASSERT(t.spans[i + 1].stage == tti_stage::worker);
+      TESTASSERT(t.spans[i + 1].tti == t.spans[i].tti);
+      TESTASSERT(t.spans[i + 1].duration_ns == 1000 * (i / 2 + 1));
+    }
+  }
+
+  std::vector<tti_trace::span_t> tti = tti_trace::collect_tti(10 * nof_threads + 2);
+  TESTASSERT(tti.size() == 2);
+  TESTASSERT(tti[0].stage == tti_stage::fft or tti[1].stage == tti_stage::fft);
+  TESTASSERT(tti[0].start_ns == 3000000000ul + 10 * 1000000);
+
+  // The percentiles have a resolution of 1/4 of an octave
+  tti_trace::stage_summary_t fft = tti_trace::get_summary(tti_stage::fft);
+  TESTASSERT(fft.count == nof_threads * 1000);
+  TESTASSERT(fft.p50_us == 10 and fft.p99_us == 10 and fft.max_us == 10);
+
+  tti_trace::stage_summary_t worker = tti_trace::get_summary(tti_stage::worker);
+  TESTASSERT(worker.count == nof_threads * 1000);
+  TESTASSERT(worker.max_us == 1000);
+  TESTASSERT(worker.p50_us >= 500 and worker.p50_us <= 500 * 5 / 4);
+  TESTASSERT(worker.p99_us >= 990 and worker.p99_us <= 1000);
+
+  TESTASSERT(tti_trace::get_summary(tti_stage::rf_send).count == 0);
+  std::string summary = tti_trace::summary_to_string();
+  TESTASSERT(summary.find("fft") != std::string::npos);
+  TESTASSERT(summary.find("worker") != std::string::npos);
+  TESTASSERT(summary.find("rf_send") == std::string::npos);
+
+  return SRSLTE_SUCCESS;
+}
+
+/// A thread keeps its last spans only
+int test_buffer_wraparound()
+{
+  std::thread thread([]() {
+    pthread_setname_np(pthread_self(), "TRACE_WRAP");
+    for (uint32_t i = 0; i < tti_trace::thread_buffer_size + 100; ++i) {
+      tti_span span(tti_stage::rf_recv, i);
+    }
+  });
+  thread.join();
+
+  bool found = false;
+  for (const tti_trace::thread_spans_t& t : tti_trace::collect()) {
+    if (t.thread_name == "TRACE_WRAP") {
+      found = true;
+      TESTASSERT(t.spans.size() == tti_trace::thread_buffer_size);
+      TESTASSERT(t.spans.front().tti == 100);
+      TESTASSERT(t.spans.back().tti == tti_trace::thread_buffer_size + 99);
+      for (uint32_t i = 1; i < t.spans.size(); ++i) {
+        TESTASSERT(t.spans[i].start_ns >= t.spans[i - 1].start_ns);
+      }
+    }
+  }
+  TESTASSERT(found);
+
+  return SRSLTE_SUCCESS;
+}
+
+int test_chrome_trace()
+{
+  const char* filename = "tti_trace_test.json";
+  TESTASSERT(tti_trace::write_chrome_trace(filename));
+
+  std::ifstream in(filename);
+  std::string   json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  TESTASSERT(json.compare(0, 15, "{\"displayTimeUn") == 0);
+  TESTASSERT(json.find("\"args\":{\"name\":\"TRACE_TEST0\"}") != std::string::npos);
+  TESTASSERT(json.find("{\"name\":\"worker\",\"cat\":\"tti\",\"ph\":\"X\"") != std::string::npos);
+  TESTASSERT(json.find("\"ts\":3010000.000,\"dur\":10.000,\"args\":{\"tti\":42}") != std::string::npos);
+  TESTASSERT(json.compare(json.size() - 4, 4, "\n]}\n") == 0);
+
+  // One metadata event per thread and one event per span
+  size_t nof_events = 0;
+  for (size_t pos = json.find("\"ph\":"); pos != std::string::npos; pos = json.find("\"ph\":", pos + 1)) {
+    nof_events++;
+  }
+  TESTASSERT(nof_events == 5 + 4 * 2000 + tti_trace::thread_buffer_size);
+
+  remove(filename);
+  return SRSLTE_SUCCESS;
+}
+
+/// The hardware events of the spans of every thread add up per stage
+int test_counters()
+{
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < 2; ++t) {
+    threads.emplace_back([]() {
+      perf_counter_values c;
+      c.cycles        = 2000;
+      c.instructions  = 3000;
+      c.l1d_misses    = 30;
+      c.llc_misses    = 3;
+      c.branch_misses = 6;
+      for (uint32_t i = 0; i < 10; ++i) {
+        tti_trace::record_counters(tti_stage::pdsch_decode, c);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  perf_counter_values c = tti_trace::get_counters(tti_stage::pdsch_decode);
+  TESTASSERT(c.cycles == 40000 and c.instructions == 60000);
+  TESTASSERT(c.ipc() == 1.5);
+  TESTASSERT(c.per_kinstr(c.l1d_misses) == 10 and c.per_kinstr(c.llc_misses) == 1);
+  TESTASSERT(c.per_kinstr(c.branch_misses) == 2);
+  TESTASSERT(tti_trace::get_counters(tti_stage::pusch_decode).cycles == 0);
+
+  // Without a PMU, e.g. in a VM, the counters stay disabled and the spans do not read them
+  if (perf_counters::enable()) {
+    perf_counter_values start, end;
+    TESTASSERT(perf_counters::read(&start));
+    {
+      tti_span span(tti_stage::chest);
+      for (volatile uint32_t i = 0; i < 100000; ++i) {
+      }
+    }
+    TESTASSERT(perf_counters::read(&end));
+    TESTASSERT((end - start).instructions >= 100000);
+    TESTASSERT(tti_trace::get_counters(tti_stage::chest).instructions >= 100000);
+  } else {
+    perf_counter_values v;
+    TESTASSERT(not perf_counters::is_enabled());
+    TESTASSERT(not perf_counters::read(&v));
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_record_from_threads() == SRSLTE_SUCCESS);
+  TESTASSERT(test_buffer_wraparound() == SRSLTE_SUCCESS);
+  TESTASSERT(test_chrome_trace() == SRSLTE_SUCCESS);
+  TESTASSERT(test_counters() == SRSLTE_SUCCESS);
+  return SRSLTE_SUCCESS;
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/test_common.h"
+#include "srslte/mac/drx.h"
+
+using srslte::tti_point;
+
+srslte::drx_cfg_t make_test_cfg(bool short_cycle)
+{
+  srslte::drx_cfg_t cfg;
+  cfg.enabled           = true;
+  cfg.on_duration_timer = 4;
+  cfg.inactivity_timer  = 10;
+  cfg.retx_timer        = 4;
+  cfg.long_cycle        = 40;
+  cfg.long_cycle_offset = 5;
+  if (short_cycle) {
+    cfg.short_cycle       = 10;
+    cfg.short_cycle_timer = 2;
+  }
+  return cfg;
+}
+
+int test_disabled()
+{
+  srslte::drx_active_time drx;
+  for (uint32_t i = 0; i < 10240; ++i) {
+    drx.step(tti_point{i});
+    TESTASSERT(drx.is_active(tti_point{i}));
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int test_on_duration()
+{
+  srslte::drx_active_time drx;
+  drx.set_config(make_test_cfg(false));
+
+  // The on duration starts in every TTI with (tti - offset) % cycle == 0, also across the TTI wrap-around
+  for (uint32_t i = 10200; i < 10240 + 100; ++i) {
+    tti_point tti{i % 10240};
+    drx.step(tti);
+    uint32_t pos = ((i % 10240) + 10240 - 5) % 40;
+    TESTASSERT(drx.is_active(tti) == (pos < 4));
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int test_inactivity_and_retx()
+{
+  srslte::drx_active_time drx;
+  drx.set_config(make_test_cfg(false));
+
+  // PDCCH in the last subframe of the on duration keeps the UE active for the inactivity timer
+  tti_point pdcch_tti{48};
+  drx.step(pdcch_tti);
+  TESTASSERT(drx.is_active(pdcch_tti));
+  drx.new_pdcch(pdcch_tti);
+  for (uint32_t i = 49; i < 80; ++i) {
+    tti_point tti{i};
+    drx.step(tti);
+    TESTASSERT(drx.is_active(tti) == (i <= 48 + 10));
+  }
+
+  // A failed DL TB is retransmitted after the HARQ RTT while the retransmission timer runs. It overlaps with the on
+  // duration that starts in TTI 85
+  drx.dl_tb_failed(tti_point{80}, 3);
+  for (uint32_t i = 80; i < 100; ++i) {
+    tti_point tti{i};
+    drx.step(tti);
+    TESTASSERT(drx.is_active(tti) == (i >= 85 and i < 88 + 4));
+  }
+
+  // A reset stops all the timers
+  drx.new_pdcch(tti_point{100});
+  drx.reset();
+  TESTASSERT(not drx.is_active(tti_point{101}));
+  return SRSLTE_SUCCESS;
+}
+
+int test_short_cycle_and_drx_command()
+{
+  srslte::drx_active_time drx;
+  drx.set_config(make_test_cfg(true));
+
+  // The short cycle is used for 2 short cycles once the inactivity timer expires
+  drx.new_pdcch(tti_point{45});
+  for (uint32_t i = 45; i < 130; ++i) {
+    tti_point tti{i};
+    drx.step(tti);
+    bool     in_short_cycle = i >= 56 and i < 76;
+    uint32_t cycle          = in_short_cycle ? 10 : 40;
+    bool     active = i <= 55 or ((i + 10240 - 5) % cycle) < 4;
+    TESTASSERT(drx.is_active(tti) == active);
+  }
+
+  // The DRX Command stops the on duration, the long cycle is used without short cycle
+  drx.set_config(make_test_cfg(false));
+  drx.step(tti_point{166});
+  TESTASSERT(drx.is_active(tti_point{166}));
+  drx.drx_command(tti_point{166});
+  TESTASSERT(not drx.is_active(tti_point{166}));
+  TESTASSERT(not drx.is_active(tti_point{168}));
+  TESTASSERT(drx.is_active(tti_point{205}));
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_disabled() == SRSLTE_SUCCESS);
+  TESTASSERT(test_on_duration() == SRSLTE_SUCCESS);
+  TESTASSERT(test_inactivity_and_retx() == SRSLTE_SUCCESS);
+  TESTASSERT(test_short_cycle_and_drx_command() == SRSLTE_SUCCESS);
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
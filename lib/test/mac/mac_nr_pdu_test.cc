@@ -470,6 +470,58 @@ int mac_ul_sch_pdu_unpack_test5()
   return SRSLTE_SUCCESS;
 }
 
+int mac_dl_sch_pdu_pack_inplace_test7()
+{
+  // SDUs written in place after the subheader, as RLC does
+  byte_buffer_t tx_buffer;
+
+  srslte::mac_nr_sch_pdu tx_pdu;
+  tx_pdu.init_tx(&tx_buffer, 600);
+
+  // Long subheader, kept for a short SDU
+  uint32_t max_len = 0;
+  uint8_t* sdu     = tx_pdu.reserve_sdu(4, &max_len);
+  TESTASSERT(sdu == tx_buffer.msg + 3);
+  TESTASSERT(max_len == 597);
+  memset(sdu, 0xab, 10);
+  TESTASSERT(tx_pdu.commit_sdu(10) == SRSLTE_SUCCESS);
+  TESTASSERT(tx_buffer.N_bytes == 13);
+
+  // Short subheader
+  tx_buffer.N_bytes = 0;
+  tx_pdu.init_tx(&tx_buffer, 200);
+  sdu = tx_pdu.reserve_sdu(4, &max_len);
+  TESTASSERT(max_len == 198);
+  memset(sdu, 0xcd, max_len);
+  TESTASSERT(tx_pdu.commit_sdu(max_len) == SRSLTE_SUCCESS);
+  TESTASSERT(tx_pdu.get_remaing_len() == 0);
+  TESTASSERT(tx_pdu.reserve_sdu(4, &max_len) == nullptr);
+
+  // The PDU reads back as one subPDU
+  srslte::mac_nr_sch_pdu pdu;
+  pdu.unpack(tx_buffer.msg, tx_buffer.N_bytes);
+  TESTASSERT(pdu.get_num_subpdus() == 1);
+  TESTASSERT(pdu.get_subpdu(0).get_lcid() == 4);
+  TESTASSERT(pdu.get_subpdu(0).get_sdu_length() == 198);
+  TESTASSERT(pdu.get_subpdu(0).get_sdu() == tx_buffer.msg + 2);
+
+  // 16-bit L field for the short SDU of the first PDU
+  tx_buffer.N_bytes = 0;
+  tx_pdu.init_tx(&tx_buffer, 600);
+  sdu = tx_pdu.reserve_sdu(4, &max_len);
+  memset(sdu, 0xab, 10);
+  tx_pdu.commit_sdu(10);
+  tx_pdu.pack();
+  pdu.init_rx();
+  pdu.unpack(tx_buffer.msg, tx_buffer.N_bytes);
+  TESTASSERT(pdu.get_num_subpdus() == 2);
+  TESTASSERT(pdu.get_subpdu(0).get_total_length() == 13);
+  TESTASSERT(pdu.get_subpdu(0).get_sdu_length() == 10);
+  TESTASSERT(pdu.get_subpdu(1).get_lcid() == mac_nr_sch_subpdu::PADDING);
+
+  return SRSLTE_SUCCESS;
+}
+
 int main(int argc, char** argv)
 {
 #if PCAP
@@ -507,6 +559,11 @@ int main(int argc, char** argv)
     return SRSLTE_ERROR;
   }
 
+  if (mac_dl_sch_pdu_pack_inplace_test7()) {
+    fprintf(stderr, "mac_dl_sch_pdu_pack_inplace_test7() failed.\n");
+    return SRSLTE_ERROR;
+  }
+
   if (mac_ul_sch_pdu_unpack_test1()) {
     fprintf(stderr, "mac_ul_sch_pdu_unpack_test1() failed.\n");
     return SRSLTE_ERROR;
@@ -0,0 +1,705 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * End-to-end PHY benchmark. Runs the eNodeB and UE subframe chains back to back (PDCCH and PDSCH in the downlink,
+ * PUSCH in the uplink) over an ideal channel for every combination of bandwidth, transmission mode, number of
+ * antennas and MCS. Reports, for each configuration, the mean processing time of every stage per subframe, the
+ * block error rates and the number of cells a single core could serve in real time, in CSV or JSON.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "srslte/phy/utils/random.h"
+#include "srslte/srslte.h"
+
+#define MAX_LIST_LEN 32
+#define MAX_DATABUFFER_SIZE (6144 * 16 * 3 / 8)
+
+typedef enum {
+  STAGE_ENB_DL_CTRL = 0,
+  STAGE_ENB_DL_PDSCH,
+  STAGE_ENB_DL_IFFT,
+  STAGE_UE_DL_FFT,
+  STAGE_UE_DL_CHEST,
+  STAGE_UE_DL_PDCCH,
+  STAGE_UE_DL_PDSCH,
+  STAGE_UE_UL_ENCODE,
+  STAGE_ENB_UL_FFT,
+  STAGE_ENB_UL_CHEST,
+  STAGE_ENB_UL_PUSCH,
+  NOF_STAGES
+} bench_stage_t;
+
+static const char* stage_names[NOF_STAGES] = {"enb_dl_ctrl",
+                                              "enb_dl_pdsch",
+                                              "enb_dl_ifft",
+                                              "ue_dl_fft",
+                                              "ue_dl_chest",
+                                              "ue_dl_pdcch",
+                                              "ue_dl_pdsch",
+                                              "ue_ul_encode",
+                                              "enb_ul_fft",
+                                              "enb_ul_chest",
+                                              "enb_ul_pusch"};
+
+static bool stage_is_enb(bench_stage_t s)
+{
+  return s <= STAGE_ENB_DL_IFFT || s >= STAGE_ENB_UL_FFT;
+}
+
+typedef struct {
+  uint32_t nof_prb;
+  uint32_t tm;
+  uint32_t nof_ant;
+  uint32_t nof_ports;
+  uint32_t mcs;
+} bench_cfg_t;
+
+typedef struct {
+  double   stage_us[NOF_STAGES];
+  uint64_t dl_bits;
+  uint64_t ul_bits;
+  uint32_t dl_tbs;
+  uint32_t dl_errors;
+  uint32_t ul_tbs;
+  uint32_t ul_errors;
+} bench_res_t;
+
+static char*    prb_list     = "6,15,25,50,75,100";
+static char*    tm_list      = "1,2,3,4";
+static char*    ant_list     = "1,2,4";
+static char*    mcs_list     = "0,10,20,28";
+static uint32_t nof_sf       = 100;
+static bool     enable_256qam;
+static uint32_t seed         = 0;
+static bool     json         = false;
+static char*    output_fname = NULL;
+
+static const uint16_t rnti = 0x1234;
+static const uint32_t cfi  = 2;
+
+void usage(char* prog)
+{
+  printf("Usage: %s [ptamnqsjo]\n", prog);
+  printf("\t-p comma separated cell.nof_prb [Default %s]\n", prb_list);
+  printf("\t-t comma separated transmission modes [Default %s]\n", tm_list);
+  printf("\t-a comma separated number of antennas, the eNodeB ports and the UE receive antennas. TM1 transmits from "
+         "a single port [Default %s]\n",
+         ant_list);
+  printf("\t-m comma separated MCS or 'all' [Default %s]\n", mcs_list);
+  printf("\t-n number of subframes per configuration [Default %d]\n", nof_sf);
+  printf("\t-q use the 256QAM MCS table in the downlink [Default %s]\n", enable_256qam ? "yes" : "no");
+  printf("\t-s seed [Default 0=time]\n");
+  printf("\t-j output JSON instead of CSV [Default CSV]\n");
+  printf("\t-o output file name [Default stdout]\n");
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "ptamnqsjo")) != -1) {
+    switch (opt) {
+      case 'p':
+        prb_list = argv[optind];
+        break;
+      case 't':
+        tm_list = argv[optind];
+        break;
+      case 'a':
+        ant_list = argv[optind];
+        break;
+      case 'm':
+        mcs_list = argv[optind];
+        break;
+      case 'n':
+        nof_sf = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'q':
+        enable_256qam = true;
+        break;
+      case 's':
+        seed = (uint32_t)strtoul(argv[optind], NULL, 0);
+        break;
+      case 'j':
+        json = true;
+        break;
+      case 'o':
+        output_fname = argv[optind];
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+static uint32_t parse_list(const char* str, uint32_t* list)
+{
+  uint32_t n = 0;
+  char*    end;
+  while (n < MAX_LIST_LEN && *str) {
+    list[n++] = (uint32_t)strtoul(str, &end, 10);
+    if (*end != ',') {
+      break;
+    }
+    str = end + 1;
+  }
+  return n;
+}
+
+static inline double bench_usec()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e6 + t.tv_nsec * 1e-3;
+}
+
+/* Ideal channel, receive antenna r gets the sum of the ports weighted with the row r of a Hadamard matrix, which
+ * keeps the spatial layers separable. With a single port every antenna receives the same signal */
+static void channel(cf_t* tx[SRSLTE_MAX_PORTS], cf_t* rx[SRSLTE_MAX_PORTS], uint32_t nof_ports, uint32_t nof_ant, int n)
+{
+  for (uint32_t r = 0; r < nof_ant; r++) {
+    srslte_vec_cf_copy(rx[r], tx[0], n);
+    for (uint32_t p = 1; p < nof_ports; p++) {
+      if (__builtin_popcount(r & p) % 2) {
+        srslte_vec_sub_ccc(rx[r], tx[p], rx[r], n);
+      } else {
+        srslte_vec_sum_ccc(rx[r], tx[p], rx[r], n);
+      }
+    }
+  }
+}
+
+static void set_dl_dci(srslte_dci_dl_t* dci, srslte_tm_t tm, uint32_t mcs)
+{
+  bzero(dci, sizeof(srslte_dci_dl_t));
+  dci->rnti                    = rnti;
+  dci->alloc_type              = SRSLTE_RA_ALLOC_TYPE0;
+  dci->type0_alloc.rbg_bitmask = 0xffffffff; // All PRB
+
+  if (tm < SRSLTE_TM3) {
+    dci->format        = SRSLTE_DCI_FORMAT1;
+    dci->tb[0].mcs_idx = mcs;
+    dci->tb[1].mcs_idx = 0;
+    dci->tb[1].rv      = 1;
+  } else {
+    dci->format = (tm == SRSLTE_TM3) ? SRSLTE_DCI_FORMAT2A : SRSLTE_DCI_FORMAT2;
+    for (uint32_t i = 0; i < SRSLTE_MAX_TB; i++) {
+      dci->tb[i].mcs_idx = mcs;
+      dci->tb[i].cw_idx  = i;
+    }
+  }
+}
+
+static void set_ue_dl_cfg(srslte_ue_dl_cfg_t* ue_dl_cfg, srslte_tm_t tm, srslte_softbuffer_rx_t** softbuffer_rx)
+{
+  bzero(ue_dl_cfg, sizeof(srslte_ue_dl_cfg_t));
+  ue_dl_cfg->cfg.tm                       = tm;
+  ue_dl_cfg->cfg.pdsch.decoder_type       = SRSLTE_MIMO_DECODER_MMSE;
+  ue_dl_cfg->cfg.pdsch.max_nof_iterations = 10;
+  ue_dl_cfg->cfg.pdsch.use_tbs_index_alt  = enable_256qam;
+  ue_dl_cfg->cfg.pdsch.power_scale        = true;
+  ue_dl_cfg->cfg.pdsch.p_b                = (tm > SRSLTE_TM1) ? 1 : 0;
+  ue_dl_cfg->cfg.pdsch.rnti               = rnti;
+  for (uint32_t i = 0; i < SRSLTE_MAX_CODEWORDS; i++) {
+    ue_dl_cfg->cfg.pdsch.softbuffers.rx[i] = softbuffer_rx[i];
+  }
+
+  ue_dl_cfg->chest_cfg.filter_coef[0] = 4;
+  ue_dl_cfg->chest_cfg.filter_coef[1] = 1;
+  ue_dl_cfg->chest_cfg.filter_type    = SRSLTE_CHEST_FILTER_GAUSS;
+  ue_dl_cfg->chest_cfg.noise_alg      = SRSLTE_NOISE_ALG_REFS;
+  ue_dl_cfg->chest_cfg.estimator_alg  = SRSLTE_ESTIMATOR_ALG_AVERAGE;
+}
+
+/* Runs nof_sf subframes of a configuration, returns SRSLTE_ERROR if a stage fails to process a subframe */
+static int run_config(const bench_cfg_t* c, srslte_random_t random, bench_res_t* res)
+{
+  srslte_cell_t cell = {.nof_prb         = c->nof_prb,
+                        .nof_ports       = c->nof_ports,
+                        .id              = 1,
+                        .cp              = SRSLTE_CP_NORM,
+                        .phich_resources = SRSLTE_PHICH_R_1,
+                        .phich_length    = SRSLTE_PHICH_NORM};
+  srslte_tm_t tm  = (srslte_tm_t)(c->tm - 1);
+  int         ret = SRSLTE_ERROR;
+  int         n   = SRSLTE_SF_LEN_PRB(c->nof_prb);
+
+  srslte_enb_dl_t*        enb_dl                           = calloc(1, sizeof(srslte_enb_dl_t));
+  srslte_ue_dl_t*         ue_dl                            = calloc(1, sizeof(srslte_ue_dl_t));
+  srslte_enb_ul_t*        enb_ul                           = calloc(1, sizeof(srslte_enb_ul_t));
+  srslte_ue_ul_t*         ue_ul                            = calloc(1, sizeof(srslte_ue_ul_t));
+  cf_t*                   dl_tx[SRSLTE_MAX_PORTS]          = {};
+  cf_t*                   dl_rx[SRSLTE_MAX_PORTS]          = {};
+  cf_t*                   ul_buffer                        = srslte_vec_cf_malloc(n);
+  srslte_softbuffer_tx_t  softbuffer_tx[SRSLTE_MAX_TB]     = {};
+  srslte_softbuffer_rx_t  softbuffer_rx[SRSLTE_MAX_TB]     = {};
+  srslte_softbuffer_rx_t* softbuffer_rx_ptr[SRSLTE_MAX_TB] = {};
+  srslte_softbuffer_tx_t  ul_softbuffer_tx                 = {};
+  srslte_softbuffer_rx_t  ul_softbuffer_rx                 = {};
+  uint8_t*                data_tx[SRSLTE_MAX_TB]           = {};
+  uint8_t*                data_rx[SRSLTE_MAX_TB]           = {};
+
+  bzero(res, sizeof(bench_res_t));
+
+  if (!enb_dl || !ue_dl || !enb_ul || !ue_ul || !ul_buffer) {
+    ERROR("Error allocating memory\n");
+    goto quit;
+  }
+  for (uint32_t i = 0; i < SRSLTE_MAX_PORTS; i++) {
+    dl_tx[i] = srslte_vec_cf_malloc(n);
+    dl_rx[i] = srslte_vec_cf_malloc(n);
+    if (!dl_tx[i] || !dl_rx[i]) {
+      ERROR("Error allocating memory\n");
+      goto quit;
+    }
+    srslte_vec_cf_zero(dl_tx[i], n);
+  }
+  for (uint32_t i = 0; i < SRSLTE_MAX_TB; i++) {
+    data_tx[i] = srslte_vec_u8_malloc(MAX_DATABUFFER_SIZE);
+    data_rx[i] = srslte_vec_u8_malloc(MAX_DATABUFFER_SIZE);
+    if (!data_tx[i] || !data_rx[i] || srslte_softbuffer_tx_init(&softbuffer_tx[i], c->nof_prb) ||
+        srslte_softbuffer_rx_init(&softbuffer_rx[i], c->nof_prb)) {
+      ERROR("Error allocating memory\n");
+      goto quit;
+    }
+    softbuffer_rx_ptr[i] = &softbuffer_rx[i];
+  }
+  if (srslte_softbuffer_tx_init(&ul_softbuffer_tx, c->nof_prb) ||
+      srslte_softbuffer_rx_init(&ul_softbuffer_rx, c->nof_prb)) {
+    ERROR("Error allocating memory\n");
+    goto quit;
+  }
+
+  // eNodeB and UE, the UE uplink writes in the buffer the eNodeB uplink reads
+  srslte_refsignal_dmrs_pusch_cfg_t dmrs_pusch_cfg = {};
+  if (srslte_enb_dl_init(enb_dl, dl_tx, c->nof_prb) || srslte_enb_dl_set_cell(enb_dl, cell) ||
+      srslte_enb_dl_add_rnti(enb_dl, rnti) || srslte_ue_dl_init(ue_dl, dl_rx, c->nof_prb, c->nof_ant) ||
+      srslte_ue_dl_set_cell(ue_dl, cell) || srslte_enb_ul_init(enb_ul, ul_buffer, c->nof_prb) ||
+      srslte_enb_ul_set_cell(enb_ul, cell, &dmrs_pusch_cfg, NULL) || srslte_enb_ul_add_rnti(enb_ul, rnti) ||
+      srslte_ue_ul_init(ue_ul, ul_buffer, c->nof_prb) || srslte_ue_ul_set_cell(ue_ul, cell)) {
+    ERROR("Error initiating the PHY objects\n");
+    goto quit;
+  }
+  srslte_ue_dl_set_rnti(ue_dl, rnti);
+  srslte_ue_ul_set_rnti(ue_ul, rnti);
+
+  // Uplink grant over the largest number of PRB the DFT precoder supports
+  srslte_dci_ul_t dci_ul = {};
+  dci_ul.rnti            = rnti;
+  dci_ul.freq_hop_fl     = SRSLTE_RA_PUSCH_HOP_DISABLED;
+  dci_ul.tb.mcs_idx      = c->mcs;
+  dci_ul.type2_alloc.riv = srslte_ra_type2_to_riv(srslte_dft_precoding_get_valid_prb(c->nof_prb), 0, c->nof_prb);
+
+  srslte_ue_ul_cfg_t ue_ul_cfg          = {};
+  ue_ul_cfg.grant_available             = true;
+  ue_ul_cfg.ul_cfg.dmrs                 = dmrs_pusch_cfg;
+  ue_ul_cfg.ul_cfg.pusch.rnti           = rnti;
+  ue_ul_cfg.ul_cfg.pusch.enable_64qam   = true;
+  ue_ul_cfg.ul_cfg.pusch.softbuffers.tx = &ul_softbuffer_tx;
+
+  srslte_pusch_cfg_t enb_pusch_cfg = {};
+  enb_pusch_cfg.rnti               = rnti;
+  enb_pusch_cfg.enable_64qam       = true;
+  enb_pusch_cfg.max_nof_iterations = 10;
+  enb_pusch_cfg.softbuffers.rx     = &ul_softbuffer_rx;
+
+  if (srslte_ue_ul_pregen_signals(ue_ul, &ue_ul_cfg)) {
+    ERROR("Error pregenerating the UL signals\n");
+    goto quit;
+  }
+
+  // PDCCH locations of the UE
+  uint32_t              nof_locations[SRSLTE_NOF_SF_X_FRAME];
+  srslte_dci_location_t dci_locations[SRSLTE_NOF_SF_X_FRAME][SRSLTE_MAX_CANDIDATES_UE];
+  for (uint32_t i = 0; i < SRSLTE_NOF_SF_X_FRAME; i++) {
+    srslte_dl_sf_cfg_t sf_cfg_dl = {};
+    sf_cfg_dl.tti                = i;
+    sf_cfg_dl.cfi                = cfi;
+    nof_locations[i] =
+        srslte_pdcch_ue_locations(&enb_dl->pdcch, &sf_cfg_dl, dci_locations[i], SRSLTE_MAX_CANDIDATES_UE, rnti);
+  }
+
+  srslte_dci_cfg_t dci_cfg = {};
+  srslte_dci_dl_t  dci;
+  set_dl_dci(&dci, tm, c->mcs);
+
+  for (uint32_t sf_idx = 0; sf_idx < nof_sf; sf_idx++) {
+    srslte_dl_sf_cfg_t sf_cfg_dl = {};
+    sf_cfg_dl.tti                = sf_idx % 10;
+    sf_cfg_dl.cfi                = cfi;
+    sf_cfg_dl.sf_type            = SRSLTE_SF_NORM;
+    srslte_ul_sf_cfg_t ul_sf     = {};
+    ul_sf.tti                    = sf_idx % 10;
+    double t0, t1;
+
+    for (uint32_t i = 0; i < SRSLTE_MAX_TB; i++) {
+      for (uint32_t j = 0; j < MAX_DATABUFFER_SIZE; j++) {
+        data_tx[i][j] = (uint8_t)srslte_random_uniform_int_dist(random, 0, 255);
+      }
+    }
+
+    // The narrow cells do not fit the high MCS in the subframes with synchronization signals, as in phy_dl_test
+    dci.location = dci_locations[sf_idx % 10][(sf_idx / 10) % nof_locations[sf_idx % 10]];
+    for (uint32_t i = 0; i < SRSLTE_MAX_TB && c->nof_prb <= 15 && (i == 0 || tm >= SRSLTE_TM3); i++) {
+      dci.tb[i].mcs_idx = (sf_idx % 5 == 0) ? (c->nof_prb == 6 ? 0 : SRSLTE_MIN(c->mcs, 27)) : c->mcs;
+    }
+
+    /*
+     * eNodeB downlink
+     */
+    srslte_pdsch_cfg_t pdsch_cfg = {};
+    if (srslte_ra_dl_dci_to_grant(&cell, &sf_cfg_dl, tm, enable_256qam, &dci, &pdsch_cfg.grant)) {
+      ERROR("Computing DL grant sf_idx=%d\n", sf_idx);
+      goto quit;
+    }
+    for (uint32_t i = 0; i < SRSLTE_MAX_CODEWORDS; i++) {
+      pdsch_cfg.softbuffers.tx[i] = &softbuffer_tx[i];
+    }
+    pdsch_cfg.power_scale = true;
+    pdsch_cfg.p_b         = (tm > SRSLTE_TM1) ? 1 : 0;
+    pdsch_cfg.rnti        = rnti;
+
+    t0 = bench_usec();
+    srslte_enb_dl_put_base(enb_dl, &sf_cfg_dl);
+    if (srslte_enb_dl_put_pdcch_dl(enb_dl, &dci_cfg, &dci)) {
+      ERROR("Error putting PDCCH sf_idx=%d\n", sf_idx);
+      goto quit;
+    }
+    t1 = bench_usec();
+    res->stage_us[STAGE_ENB_DL_CTRL] += t1 - t0;
+    if (srslte_enb_dl_put_pdsch(enb_dl, &pdsch_cfg, data_tx) < 0) {
+      ERROR("Error putting PDSCH sf_idx=%d\n", sf_idx);
+      goto quit;
+    }
+    t0 = bench_usec();
+    res->stage_us[STAGE_ENB_DL_PDSCH] += t0 - t1;
+    srslte_enb_dl_gen_signal(enb_dl);
+    res->stage_us[STAGE_ENB_DL_IFFT] += bench_usec() - t0;
+
+    channel(dl_tx, dl_rx, c->nof_ports, c->nof_ant, n);
+
+    /*
+     * UE downlink
+     */
+    srslte_ue_dl_cfg_t ue_dl_cfg;
+    srslte_dci_dl_t    dci_dl[SRSLTE_MAX_DCI_MSG] = {};
+    set_ue_dl_cfg(&ue_dl_cfg, tm, softbuffer_rx_ptr);
+    ue_dl_cfg.cfg.dci = dci_cfg;
+
+    t0 = bench_usec();
+    if (srslte_ue_dl_decode_fft(ue_dl, &sf_cfg_dl) < 0) {
+      ERROR("Error in the UE FFT sf_idx=%d\n", sf_idx);
+      goto quit;
+    }
+    t1 = bench_usec();
+    res->stage_us[STAGE_UE_DL_FFT] += t1 - t0;
+    if (srslte_ue_dl_estimate(ue_dl, &sf_cfg_dl, &ue_dl_cfg) < 0) {
+      ERROR("Error estimating the DL channel sf_idx=%d\n", sf_idx);
+      goto quit;
+    }
+    t0 = bench_usec();
+    res->stage_us[STAGE_UE_DL_CHEST] += t0 - t1;
+    int nof_grants = srslte_ue_dl_find_dl_dci(ue_dl, &sf_cfg_dl, &ue_dl_cfg, rnti, dci_dl);
+    t1             = bench_usec();
+    res->stage_us[STAGE_UE_DL_PDCCH] += t1 - t0;
+
+    srslte_pdsch_res_t pdsch_res[SRSLTE_MAX_CODEWORDS] = {};
+    for (uint32_t i = 0; i < SRSLTE_MAX_CODEWORDS; i++) {
+      pdsch_res[i].payload = data_rx[i];
+    }
+    if (nof_grants < 1 || srslte_ra_dl_dci_to_grant(
+                              &cell, &sf_cfg_dl, tm, enable_256qam, &dci_dl[0], &ue_dl_cfg.cfg.pdsch.grant)) {
+      // A missed PDCCH loses the transport blocks of the subframe
+      ue_dl_cfg.cfg.pdsch.grant = pdsch_cfg.grant;
+    } else {
+      for (uint32_t i = 0; i < SRSLTE_MAX_CODEWORDS; i++) {
+        srslte_softbuffer_rx_reset(&softbuffer_rx[i]);
+      }
+      t0 = bench_usec();
+      if (srslte_ue_dl_decode_pdsch(ue_dl, &sf_cfg_dl, &ue_dl_cfg.cfg.pdsch, pdsch_res)) {
+        ERROR("Error decoding PDSCH sf_idx=%d\n", sf_idx);
+        goto quit;
+      }
+      res->stage_us[STAGE_UE_DL_PDSCH] += bench_usec() - t0;
+    }
+
+    for (uint32_t i = 0; i < SRSLTE_MAX_CODEWORDS; i++) {
+      if (pdsch_cfg.grant.tb[i].enabled) {
+        uint32_t tbs = (uint32_t)pdsch_cfg.grant.tb[i].tbs;
+        res->dl_tbs++;
+        if (!pdsch_res[i].crc || memcmp(data_tx[i], data_rx[i], tbs / 8) != 0) {
+          res->dl_errors++;
+        } else {
+          res->dl_bits += tbs;
+        }
+      }
+    }
+
+    /*
+     * UE uplink
+     */
+    if (srslte_ue_ul_dci_to_pusch_grant(ue_ul, &ul_sf, &ue_ul_cfg, &dci_ul, &ue_ul_cfg.ul_cfg.pusch.grant)) {
+      ERROR("Invalid UL grant for MCS %d\n", c->mcs);
+      goto quit;
+    }
+    srslte_ue_ul_pusch_hopping(ue_ul, &ul_sf, &ue_ul_cfg, &ue_ul_cfg.ul_cfg.pusch.grant);
+    srslte_softbuffer_tx_reset(&ul_softbuffer_tx);
+    srslte_pusch_data_t pusch_data = {};
+    pusch_data.ptr                 = data_tx[0];
+
+    t0 = bench_usec();
+    if (srslte_ue_ul_encode(ue_ul, &ul_sf, &ue_ul_cfg, &pusch_data) < 0) {
+      ERROR("Error encoding PUSCH sf_idx=%d\n", sf_idx);
+      goto quit;
+    }
+    res->stage_us[STAGE_UE_UL_ENCODE] += bench_usec() - t0;
+
+    /*
+     * eNodeB uplink
+     */
+    if (srslte_ra_ul_dci_to_grant(&cell, &ul_sf, &ue_ul_cfg.ul_cfg.hopping, &dci_ul, &enb_pusch_cfg.grant)) {
+      ERROR("Computing UL grant sf_idx=%d\n", sf_idx);
+      goto quit;
+    }
+    enb_pusch_cfg.grant.n_prb_tilde[0] = enb_pusch_cfg.grant.n_prb[0];
+    enb_pusch_cfg.grant.n_prb_tilde[1] = enb_pusch_cfg.grant.n_prb[1];
+    srslte_softbuffer_rx_reset(&ul_softbuffer_rx);
+    srslte_pusch_res_t pusch_res = {};
+    pusch_res.data               = data_rx[0];
+
+    t0 = bench_usec();
+    srslte_enb_ul_fft(enb_ul);
+    t1 = bench_usec();
+    res->stage_us[STAGE_ENB_UL_FFT] += t1 - t0;
+    srslte_chest_ul_estimate_pusch(&enb_ul->chest, &ul_sf, &enb_pusch_cfg, enb_ul->sf_symbols, &enb_ul->chest_res);
+    t0 = bench_usec();
+    res->stage_us[STAGE_ENB_UL_CHEST] += t0 - t1;
+    if (srslte_pusch_decode(
+            &enb_ul->pusch, &ul_sf, &enb_pusch_cfg, &enb_ul->chest_res, enb_ul->sf_symbols, &pusch_res)) {
+      ERROR("Error decoding PUSCH sf_idx=%d\n", sf_idx);
+      goto quit;
+    }
+    res->stage_us[STAGE_ENB_UL_PUSCH] += bench_usec() - t0;
+
+    uint32_t ul_tbs = enb_pusch_cfg.grant.tb.tbs;
+    res->ul_tbs++;
+    if (!pusch_res.crc || memcmp(data_tx[0], data_rx[0], ul_tbs / 8) != 0) {
+      res->ul_errors++;
+    } else {
+      res->ul_bits += ul_tbs;
+    }
+  }
+
+  ret = SRSLTE_SUCCESS;
+
+quit:
+  if (enb_dl) {
+    srslte_enb_dl_free(enb_dl);
+    free(enb_dl);
+  }
+  if (ue_dl) {
+    srslte_ue_dl_free(ue_dl);
+    free(ue_dl);
+  }
+  if (enb_ul) {
+    srslte_enb_ul_free(enb_ul);
+    free(enb_ul);
+  }
+  if (ue_ul) {
+    srslte_ue_ul_free(ue_ul);
+    free(ue_ul);
+  }
+  for (uint32_t i = 0; i < SRSLTE_MAX_PORTS; i++) {
+    free(dl_tx[i]);
+    free(dl_rx[i]);
+  }
+  for (uint32_t i = 0; i < SRSLTE_MAX_TB; i++) {
+    srslte_softbuffer_tx_free(&softbuffer_tx[i]);
+    srslte_softbuffer_rx_free(&softbuffer_rx[i]);
+    free(data_tx[i]);
+    free(data_rx[i]);
+  }
+  srslte_softbuffer_tx_free(&ul_softbuffer_tx);
+  srslte_softbuffer_rx_free(&ul_softbuffer_rx);
+  free(ul_buffer);
+  return ret;
+}
+
+static void print_result(FILE* f, const bench_cfg_t* c, const bench_res_t* res, bool first)
+{
+  double enb_us = 0, ue_us = 0;
+  double stage_us[NOF_STAGES];
+  for (uint32_t s = 0; s < NOF_STAGES; s++) {
+    stage_us[s] = res->stage_us[s] / nof_sf;
+    if (stage_is_enb((bench_stage_t)s)) {
+      enb_us += stage_us[s];
+    } else {
+      ue_us += stage_us[s];
+    }
+  }
+  // A cell needs the eNodeB processing of one DL and one UL subframe every millisecond
+  double cells_per_core = enb_us > 0 ? 1000.0 / enb_us : 0;
+  double dl_mbps        = (double)res->dl_bits / nof_sf / 1000.0;
+  double ul_mbps        = (double)res->ul_bits / nof_sf / 1000.0;
+  double dl_bler        = res->dl_tbs ? (double)res->dl_errors / res->dl_tbs : 0;
+  double ul_bler        = res->ul_tbs ? (double)res->ul_errors / res->ul_tbs : 0;
+
+  if (json) {
+    fprintf(f,
+            "%s  {\"nof_prb\": %d, \"tm\": %d, \"nof_ports\": %d, \"nof_rx_ant\": %d, \"mcs\": %d, \"nof_sf\": %d, ",
+            first ? "" : ",\n",
+            c->nof_prb,
+            c->tm,
+            c->nof_ports,
+            c->nof_ant,
+            c->mcs,
+            nof_sf);
+    for (uint32_t s = 0; s < NOF_STAGES; s++) {
+      fprintf(f, "\"%s_us\": %.2f, ", stage_names[s], stage_us[s]);
+    }
+    fprintf(f,
+            "\"enb_us\": %.2f, \"ue_us\": %.2f, \"cells_per_core\": %.2f, \"dl_mbps\": %.2f, \"ul_mbps\": %.2f, "
+            "\"dl_bler\": %.3f, \"ul_bler\": %.3f}",
+            enb_us,
+            ue_us,
+            cells_per_core,
+            dl_mbps,
+            ul_mbps,
+            dl_bler,
+            ul_bler);
+  } else {
+    fprintf(f, "%d,%d,%d,%d,%d,%d,", c->nof_prb, c->tm, c->nof_ports, c->nof_ant, c->mcs, nof_sf);
+    for (uint32_t s = 0; s < NOF_STAGES; s++) {
+      fprintf(f, "%.2f,", stage_us[s]);
+    }
+    fprintf(
+        f, "%.2f,%.2f,%.2f,%.2f,%.2f,%.3f,%.3f\n", enb_us, ue_us, cells_per_core, dl_mbps, ul_mbps, dl_bler, ul_bler);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  uint32_t prbs[MAX_LIST_LEN];
+  uint32_t tms[MAX_LIST_LEN];
+  uint32_t ants[MAX_LIST_LEN];
+  uint32_t mcss[MAX_LIST_LEN];
+  uint32_t nof_mcs;
+  FILE*    f     = stdout;
+  bool     first = true;
+  int      ret   = SRSLTE_SUCCESS;
+
+  parse_args(argc, argv);
+
+  uint32_t max_mcs  = enable_256qam ? 27 : 28;
+  uint32_t nof_prbs = parse_list(prb_list, prbs);
+  uint32_t nof_tms  = parse_list(tm_list, tms);
+  uint32_t nof_ants = parse_list(ant_list, ants);
+  if (!strcmp(mcs_list, "all")) {
+    for (nof_mcs = 0; nof_mcs <= max_mcs; nof_mcs++) {
+      mcss[nof_mcs] = nof_mcs;
+    }
+  } else {
+    nof_mcs = parse_list(mcs_list, mcss);
+  }
+  if (!nof_prbs || !nof_tms || !nof_ants || !nof_mcs || !nof_sf) {
+    usage(argv[0]);
+    exit(-1);
+  }
+
+  if (!seed) {
+    seed = time(NULL);
+  }
+  srslte_random_t random = srslte_random_init(seed);
+
+  if (output_fname) {
+    f = fopen(output_fname, "w");
+    if (!f) {
+      perror("fopen");
+      exit(-1);
+    }
+  }
+
+  if (json) {
+    fprintf(f, "[\n");
+  } else {
+    fprintf(f, "nof_prb,tm,nof_ports,nof_rx_ant,mcs,nof_sf,");
+    for (uint32_t s = 0; s < NOF_STAGES; s++) {
+      fprintf(f, "%s_us,", stage_names[s]);
+    }
+    fprintf(f, "enb_us,ue_us,cells_per_core,dl_mbps,ul_mbps,dl_bler,ul_bler\n");
+  }
+
+  for (uint32_t p = 0; p < nof_prbs; p++) {
+    for (uint32_t t = 0; t < nof_tms; t++) {
+      for (uint32_t a = 0; a < nof_ants; a++) {
+        bench_cfg_t c = {};
+        c.nof_prb     = prbs[p];
+        c.tm          = tms[t];
+        c.nof_ant     = ants[a];
+        c.nof_ports   = (tms[t] == 1) ? 1 : ants[a];
+
+        // TM1 transmits from one port to any number of antennas, the other modes need 2 or 4 ports
+        if (!srslte_nofprb_isvalid(c.nof_prb) || c.tm < 1 || c.tm > 4 || c.nof_ant < 1 ||
+            c.nof_ant > SRSLTE_MAX_PORTS || (c.tm > 1 && c.nof_ports != 2 && c.nof_ports != 4)) {
+          continue;
+        }
+
+        for (uint32_t m = 0; m < nof_mcs; m++) {
+          bench_res_t res;
+          c.mcs = mcss[m];
+          if (c.mcs > max_mcs) {
+            continue;
+          }
+          if (run_config(&c, random, &res)) {
+            ERROR("Error running nof_prb=%d, tm=%d, nof_ant=%d, mcs=%d\n", c.nof_prb, c.tm, c.nof_ant, c.mcs);
+            ret = SRSLTE_ERROR;
+            continue;
+          }
+          print_result(f, &c, &res, first);
+          first = false;
+        }
+      }
+    }
+  }
+
+  if (json) {
+    fprintf(f, "\n]\n");
+  }
+
+  if (first) {
+    ERROR("No configuration was run\n");
+    ret = SRSLTE_ERROR;
+  }
+
+  if (output_fname) {
+    fclose(f);
+  }
+  srslte_random_free(random);
+
+  return ret;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "file_test_utils.h"
+#include "src/srslog/formatter.h"
+#include "src/srslog/sinks/binary_file_sink.h"
+#include "testing_helpers.h"
+#include <iterator>
+
+using namespace srslog;
+
+static constexpr char log_filename[] = "binary_file_sink_test.log";
+
+/// Builds a log entry that uses all the supported argument types.
+static detail::log_entry build_log_entry(unsigned i)
+{
+  using tp_ty = std::chrono::time_point<std::chrono::high_resolution_clock>;
+  tp_ty tp(std::chrono::microseconds(1000000 * i + 123456));
+
+  fmt::dynamic_format_arg_store<fmt::printf_context> store;
+  store.push_back(-int(i));
+  store.push_back(i);
+  store.push_back(1.5 * i);
+  store.push_back(std::string("text") + std::to_string(i));
+  store.push_back('c');
+  store.push_back(uint64_t(1) << 40);
+
+  return {nullptr,
+          tp,
+          {i, (i % 2) == 0},
+          "Entry %d %u %.1f %s %c %llu",
+          std::move(store),
+          (i % 3) ? "MAC" : "RLC",
+          'I',
+          std::vector<uint8_t>(i % 5, 0xab)};
+}
+
+/// Returns the text the text sink would write for the log entry.
+static std::string to_text(detail::log_entry&& entry)
+{
+  fmt::memory_buffer buffer;
+  format_log_entry_to_text(std::move(entry), buffer);
+  return fmt::to_string(buffer);
+}
+
+/// Decodes the binary log file in the specified path into text.
+static std::string decode_file(const std::string& path)
+{
+  std::ifstream in(path, std::ios::binary);
+  std::string data((std::istreambuf_iterator<char>(in)),
+                   std::istreambuf_iterator<char>());
+
+  binary_format::reader reader(data.data(), data.size());
+  if (!reader.read_magic()) {
+    return "invalid file";
+  }
+  std::string text;
+  detail::log_entry entry = {};
+  while (reader.next(entry)) {
+    text += to_text(std::move(entry));
+  }
+  return text;
+}
+
+static bool when_entries_are_written_then_decoded_text_is_valid()
+{
+  file_test_utils::scoped_file_deleter deleter(
+      file_utils::build_filename_with_index(log_filename, 0));
+  std::string expected;
+  {
+    binary_file_sink file(log_filename, 0);
+
+    for (unsigned i = 0; i != 10; ++i) {
+      fmt::memory_buffer buffer;
+      ASSERT_EQ(file.encode(build_log_entry(i), buffer), true);
+      file.write(detail::memory_buffer(buffer.data(), buffer.size()));
+      expected += to_text(build_log_entry(i));
+    }
+    file.flush();
+
+    // The file is decodable while it is still being written, e.g. after a
+    // crash of the application.
+    ASSERT_EQ(
+        decode_file(file_utils::build_filename_with_index(log_filename, 0)),
+        expected);
+  }
+
+  ASSERT_EQ(decode_file(file_utils::build_filename_with_index(log_filename, 0)),
+            expected);
+
+  return true;
+}
+
+static bool when_data_written_exceeds_size_threshold_then_new_file_is_created()
+{
+  std::string filename0 =
+      file_utils::build_filename_with_index(log_filename, 0);
+  std::string filename1 =
+      file_utils::build_filename_with_index(log_filename, 1);
+  file_test_utils::scoped_file_deleter deleter = {filename0, filename1};
+
+  std::string expected0, expected1;
+  {
+    binary_file_sink file(log_filename, 4096);
+
+    // Every entry is about 100 bytes, so the second file is created after
+    // about 40 entries.
+    for (unsigned i = 0; i != 60; ++i) {
+      fmt::memory_buffer buffer;
+      file.encode(build_log_entry(i), buffer);
+      file.write(detail::memory_buffer(buffer.data(), buffer.size()));
+      (i < 30 ? expected0 : expected1) += to_text(build_log_entry(i));
+    }
+  }
+
+  // Each file decodes on its own, the strings are defined again in the second
+  // file.
+  std::string text0 = decode_file(filename0);
+  std::string text1 = decode_file(filename1);
+  ASSERT_EQ(text0.compare(0, expected0.size(), expected0), 0);
+  ASSERT_EQ(text0 + text1, expected0 + expected1);
+  ASSERT_EQ(file_test_utils::file_exists(
+                file_utils::build_filename_with_index(log_filename, 2)),
+            false);
+
+  return true;
+}
+
+int main()
+{
+  TEST_FUNCTION(when_entries_are_written_then_decoded_text_is_valid);
+  TEST_FUNCTION(
+      when_data_written_exceeds_size_threshold_then_new_file_is_created);
+
+  return 0;
+}
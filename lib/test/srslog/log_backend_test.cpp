@@ -22,6 +22,7 @@
 #include "src/srslog/log_backend_impl.h"
 #include "srslte/srslog/sink.h"
 #include "testing_helpers.h"
+#include <thread>
 
 using namespace srslog;
 
@@ -211,6 +212,73 @@ static bool when_empty_handler_is_used_then_backend_does_not_crash()
   return true;
 }
 
+namespace {
+
+/// A Spy implementation of a log sink that appends all the received buffers.
+class appending_sink_spy : public sink
+{
+public:
+  detail::error_string write(detail::memory_buffer buffer) override
+  {
+    str.append(buffer.data(), buffer.size());
+    return {};
+  }
+
+  detail::error_string flush() override { return {}; }
+
+  const std::string& received_buffer() const { return str; }
+
+private:
+  std::string str;
+};
+
+} // namespace
+
+static bool
+when_entries_are_pushed_from_several_threads_then_all_are_written_in_order()
+{
+  appending_sink_spy spy;
+
+  log_backend_impl backend;
+  backend.start();
+
+  const int nof_threads = 4, nof_entries = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nof_threads; ++t) {
+    threads.emplace_back([&backend, &spy, t]() {
+      for (int i = 0; i < nof_entries; ++i) {
+        fmt::dynamic_format_arg_store<fmt::printf_context> store;
+        store.push_back(t);
+        store.push_back(i);
+        backend.push(
+            {&spy, {}, {0, false}, "T%d %d", std::move(store), "", '\0'});
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // Stop the backend to ensure the entries have been processed.
+  backend.stop();
+
+  // Entries of different threads interleave, but each thread keeps its order.
+  std::vector<int> next(nof_threads, 0);
+  const std::string& text = spy.received_buffer();
+  for (size_t pos = text.find('T'); pos != std::string::npos;
+       pos = text.find('T', pos + 1)) {
+    int t = 0, i = 0;
+    ASSERT_EQ(std::sscanf(text.c_str() + pos, "T%d %d", &t, &i), 2);
+    ASSERT_EQ(i, next[t]);
+    ++next[t];
+  }
+  for (int t = 0; t < nof_threads; ++t) {
+    ASSERT_EQ(next[t], nof_entries);
+  }
+
+  return true;
+}
+
 int main()
 {
   TEST_FUNCTION(when_backend_is_started_then_is_started_returns_true);
@@ -223,6 +291,8 @@ int main()
   TEST_FUNCTION(when_sink_write_fails_then_error_handler_is_invoked);
   TEST_FUNCTION(when_handler_is_set_after_start_then_handler_is_not_used);
   TEST_FUNCTION(when_empty_handler_is_used_then_backend_does_not_crash);
+  TEST_FUNCTION(
+      when_entries_are_pushed_from_several_threads_then_all_are_written_in_order);
 
   return 0;
 }
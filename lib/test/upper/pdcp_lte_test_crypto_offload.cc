@@ -0,0 +1,132 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+#include "pdcp_lte_test.h"
+#include "pdcp_lte_test.h"
+#include <unistd.h>
+
+// RLC UM dummy that keeps all the SDUs written by PDCP
+class rlc_recorder : public srsue::rlc_interface_pdcp
+{
+public:
+  void write_sdu(uint32_t lcid, srslte::unique_byte_buffer_t sdu) { sdus.push_back(std::move(sdu)); }
+  void discard_sdu(uint32_t lcid, uint32_t discard_sn) {}
+  bool rb_is_um(uint32_t lcid) { return true; }
+  bool sdu_queue_is_full(uint32_t lcid) { return false; }
+
+  std::vector<srslte::unique_byte_buffer_t> sdus;
+};
+
+/*
+ * The PDUs ciphered in the background must be the same, and reach RLC in the same order, as the ones ciphered in
+ * the calling thread
+ */
+int test_tx_offload(srslte::CIPHERING_ALGORITHM_ID_ENUM cipher_algo,
+                    srslte::byte_buffer_pool*           pool,
+                    srslte::log_ref                     log)
+{
+  const uint32_t nof_sdus = 300;
+
+  srslte::pdcp_config_t cfg = {1,
+                               srslte::PDCP_RB_IS_DRB,
+                               srslte::SECURITY_DIRECTION_UPLINK,
+                               srslte::SECURITY_DIRECTION_DOWNLINK,
+                               srslte::PDCP_SN_LEN_7,
+                               srslte::pdcp_t_reordering_t::ms500,
+                               srslte::pdcp_discard_timer_t::infinity};
+  srslte::as_security_config_t sec_cfg_test = sec_cfg;
+  sec_cfg_test.cipher_algo                  = cipher_algo;
+
+  srslte::task_scheduler  task_sched{512, 2, 100};
+  rlc_recorder            rlc, rlc_ref;
+  rrc_dummy               rrc(log);
+  gw_dummy                gw(log);
+  srslte::pdcp_entity_lte pdcp(&rlc, &rrc, &gw, &task_sched, log, 0, cfg);
+  srslte::pdcp_entity_lte pdcp_ref(&rlc_ref, &rrc, &gw, &task_sched, log, 0, cfg);
+  for (srslte::pdcp_entity_lte* p : {&pdcp, &pdcp_ref}) {
+    p->config_security(sec_cfg_test);
+    p->enable_integrity(srslte::DIRECTION_TXRX);
+    p->enable_encryption(srslte::DIRECTION_TXRX);
+  }
+  pdcp.set_crypto_offload(true);
+
+  // Goes over a few SN wraparounds. Short PDUs queued after long ones are likely to be ciphered first
+  for (srslte::pdcp_entity_lte* p : {&pdcp, &pdcp_ref}) {
+    for (uint32_t i = 0; i < nof_sdus; ++i) {
+      uint32_t                     len = (i % 2 == 0) ? 1400 + i : 10 + i % 20;
+      srslte::unique_byte_buffer_t sdu = srslte::allocate_unique_buffer(*pool);
+      for (uint32_t j = 0; j < len; ++j) {
+        sdu->msg[j] = i + j;
+      }
+      sdu->N_bytes = len;
+      p->write_sdu(std::move(sdu));
+    }
+  }
+  TESTASSERT(rlc_ref.sdus.size() == nof_sdus);
+
+  // The results are written to RLC from the calling thread
+  for (uint32_t t = 0; t < 10000 and rlc.sdus.size() < nof_sdus; ++t) {
+    task_sched.run_pending_tasks();
+    usleep(100);
+  }
+  TESTASSERT(rlc.sdus.size() == nof_sdus);
+  for (uint32_t i = 0; i < nof_sdus; ++i) {
+    TESTASSERT(compare_two_packets(rlc.sdus[i], rlc_ref.sdus[i]) == 0);
+  }
+
+  // PDUs still in the background pool when the entity is reset are dropped
+  rlc.sdus.clear();
+  for (uint32_t i = 0; i < 10; ++i) {
+    srslte::unique_byte_buffer_t sdu = srslte::allocate_unique_buffer(*pool);
+    sdu->N_bytes                     = 10;
+    pdcp.write_sdu(std::move(sdu));
+  }
+  pdcp.reset();
+  usleep(10000);
+  task_sched.run_pending_tasks();
+  TESTASSERT(rlc.sdus.empty());
+
+  task_sched.stop();
+  return SRSLTE_SUCCESS;
+}
+
+int run_all_tests(srslte::byte_buffer_pool* pool)
+{
+  // Setup log
+  srslte::log_ref log("PDCP LTE Test Crypto Offload");
+  log->set_level(srslte::LOG_LEVEL_DEBUG);
+  log->set_hex_limit(128);
+
+  TESTASSERT(test_tx_offload(srslte::CIPHERING_ALGORITHM_ID_128_EEA1, pool, log) == SRSLTE_SUCCESS);
+  TESTASSERT(test_tx_offload(srslte::CIPHERING_ALGORITHM_ID_128_EEA2, pool, log) == SRSLTE_SUCCESS);
+  TESTASSERT(test_tx_offload(srslte::CIPHERING_ALGORITHM_ID_128_EEA3, pool, log) == SRSLTE_SUCCESS);
+
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  if (run_all_tests(srslte::byte_buffer_pool::get_instance()) != SRSLTE_SUCCESS) {
+    fprintf(stderr, "pdcp_lte_test_crypto_offload() failed\n");
+    return SRSLTE_ERROR;
+  }
+
+  return SRSLTE_SUCCESS;
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+#include "pdcp_lte_test.h"
+
+// RLC dummy that keeps all the SDUs written by PDCP
+class rlc_recorder : public srsue::rlc_interface_pdcp
+{
+public:
+  void write_sdu(uint32_t lcid, srslte::unique_byte_buffer_t sdu) { sdus.push_back(std::move(sdu)); }
+  void discard_sdu(uint32_t lcid, uint32_t discard_sn) {}
+  bool rb_is_um(uint32_t lcid) { return true; }
+  bool sdu_queue_is_full(uint32_t lcid) { return false; }
+
+  std::vector<srslte::unique_byte_buffer_t> sdus;
+};
+
+srslte::unique_byte_buffer_t make_ip_packet(srslte::byte_buffer_pool* pool, uint32_t len, uint8_t first_byte)
+{
+  srslte::unique_byte_buffer_t sdu = srslte::allocate_unique_buffer(*pool);
+  sdu->msg[0]                      = first_byte;
+  for (uint32_t i = 1; i < len; ++i) {
+    sdu->msg[i] = i;
+  }
+  sdu->N_bytes = len;
+  return sdu;
+}
+
+/*
+ * Packets go through the compressor and decompressor unchanged, with IR packets at the start and once per refresh
+ * period
+ */
+int test_rohc_roundtrip(uint16_t max_cid, srslte::byte_buffer_pool* pool)
+{
+  srslte::pdcp_rohc_config_t cfg;
+  cfg.enabled = true;
+  cfg.max_cid = max_cid;
+
+  std::unique_ptr<srslte::pdcp_hdr_compressor> comp   = srslte::make_rohc_compressor(cfg);
+  std::unique_ptr<srslte::pdcp_hdr_compressor> decomp = srslte::make_rohc_compressor(cfg);
+  TESTASSERT(comp != nullptr and decomp != nullptr);
+
+  uint32_t ir_len     = max_cid > 15 ? 4 : 3;
+  uint32_t normal_len = max_cid > 15 ? 1 : 0;
+  uint32_t nof_ir     = 0;
+  for (uint32_t i = 0; i < 600; ++i) {
+    srslte::unique_byte_buffer_t sdu = make_ip_packet(pool, 40 + i % 100, 0x45);
+    srslte::unique_byte_buffer_t ref = make_ip_packet(pool, 40 + i % 100, 0x45);
+    TESTASSERT(comp->compress(sdu.get()));
+    bool is_ir = sdu->msg[0] == 0xfc;
+    nof_ir += is_ir ? 1 : 0;
+    TESTASSERT(sdu->N_bytes == ref->N_bytes + (is_ir ? ir_len : normal_len));
+    TESTASSERT(is_ir == (i < 3 or i == 259 or i == 516));
+    TESTASSERT(decomp->decompress(sdu.get()));
+    TESTASSERT(compare_two_packets(sdu, ref) == 0);
+  }
+  TESTASSERT(nof_ir == 5);
+
+  // Packets that start like a ROHC packet type are sent in IR packets
+  srslte::unique_byte_buffer_t sdu = make_ip_packet(pool, 20, 0xf0);
+  srslte::unique_byte_buffer_t ref = make_ip_packet(pool, 20, 0xf0);
+  TESTASSERT(comp->compress(sdu.get()));
+  TESTASSERT(sdu->msg[0] == 0xfc);
+  TESTASSERT(decomp->decompress(sdu.get()));
+  TESTASSERT(compare_two_packets(sdu, ref) == 0);
+
+  // Padding in front of the packet is skipped
+  sdu = make_ip_packet(pool, 20, 0x45);
+  ref = make_ip_packet(pool, 20, 0x45);
+  TESTASSERT(comp->compress(sdu.get()));
+  sdu->msg--;
+  sdu->N_bytes++;
+  sdu->msg[0] = 0xe0;
+  TESTASSERT(decomp->decompress(sdu.get()));
+  TESTASSERT(compare_two_packets(sdu, ref) == 0);
+  return SRSLTE_SUCCESS;
+}
+
+/*
+ * The decompressor drops Normal packets until it gets a valid IR packet
+ */
+int test_rohc_context(srslte::byte_buffer_pool* pool)
+{
+  srslte::pdcp_rohc_config_t cfg;
+  TESTASSERT(srslte::make_rohc_compressor(cfg) == nullptr);
+  cfg.enabled = true;
+
+  std::unique_ptr<srslte::pdcp_hdr_compressor> comp   = srslte::make_rohc_compressor(cfg);
+  std::unique_ptr<srslte::pdcp_hdr_compressor> decomp = srslte::make_rohc_compressor(cfg);
+
+  // Lost IR packets
+  for (uint32_t i = 0; i < 3; ++i) {
+    srslte::unique_byte_buffer_t sdu = make_ip_packet(pool, 40, 0x45);
+    TESTASSERT(comp->compress(sdu.get()));
+  }
+  srslte::unique_byte_buffer_t sdu = make_ip_packet(pool, 40, 0x45);
+  TESTASSERT(comp->compress(sdu.get()));
+  TESTASSERT(not decomp->decompress(sdu.get()));
+
+  // IR packet with a wrong CRC
+  comp->reset();
+  sdu = make_ip_packet(pool, 40, 0x45);
+  TESTASSERT(comp->compress(sdu.get()));
+  TESTASSERT(sdu->msg[0] == 0xfc);
+  sdu->msg[2] ^= 0x01;
+  TESTASSERT(not decomp->decompress(sdu.get()));
+
+  // Add-CID packets are for other contexts
+  sdu = make_ip_packet(pool, 40, 0x45);
+  TESTASSERT(comp->compress(sdu.get()));
+  sdu->msg--;
+  sdu->N_bytes++;
+  sdu->msg[0] = 0xe1;
+  TESTASSERT(not decomp->decompress(sdu.get()));
+
+  // The context is set up by the next IR packet, and cleared by a reset
+  sdu = make_ip_packet(pool, 40, 0x45);
+  TESTASSERT(comp->compress(sdu.get()));
+  TESTASSERT(decomp->decompress(sdu.get()));
+  sdu = make_ip_packet(pool, 40, 0x45);
+  TESTASSERT(comp->compress(sdu.get()));
+  TESTASSERT(sdu->msg[0] == 0x45);
+  TESTASSERT(decomp->decompress(sdu.get()));
+  decomp->reset();
+  sdu = make_ip_packet(pool, 40, 0x45);
+  TESTASSERT(comp->compress(sdu.get()));
+  TESTASSERT(sdu->msg[0] == 0x45);
+  TESTASSERT(not decomp->decompress(sdu.get()));
+  return SRSLTE_SUCCESS;
+}
+
+/*
+ * SDUs written to a PDCP entity with ROHC are delivered unchanged by the peer entity
+ */
+int test_rohc_entity(srslte::byte_buffer_pool* pool, srslte::log_ref log)
+{
+  srslte::pdcp_config_t cfg_tx = {1,
+                                  srslte::PDCP_RB_IS_DRB,
+                                  srslte::SECURITY_DIRECTION_UPLINK,
+                                  srslte::SECURITY_DIRECTION_DOWNLINK,
+                                  srslte::PDCP_SN_LEN_12,
+                                  srslte::pdcp_t_reordering_t::ms500,
+                                  srslte::pdcp_discard_timer_t::infinity};
+  srslte::pdcp_config_t cfg_rx = {1,
+                                  srslte::PDCP_RB_IS_DRB,
+                                  srslte::SECURITY_DIRECTION_DOWNLINK,
+                                  srslte::SECURITY_DIRECTION_UPLINK,
+                                  srslte::PDCP_SN_LEN_12,
+                                  srslte::pdcp_t_reordering_t::ms500,
+                                  srslte::pdcp_discard_timer_t::infinity};
+  cfg_tx.rohc.enabled = true;
+  cfg_rx.rohc.enabled = true;
+
+  srsue::stack_test_dummy stack;
+  rlc_recorder            rlc;
+  rrc_dummy               rrc(log);
+  gw_dummy                gw(log);
+  srslte::pdcp_entity_lte pdcp_tx(&rlc, &rrc, &gw, &stack.task_sched, log, 0, cfg_tx);
+  srslte::pdcp_entity_lte pdcp_rx(&rlc, &rrc, &gw, &stack.task_sched, log, 0, cfg_rx);
+  for (srslte::pdcp_entity_lte* p : {&pdcp_tx, &pdcp_rx}) {
+    p->config_security(sec_cfg);
+    p->enable_integrity(srslte::DIRECTION_TXRX);
+    p->enable_encryption(srslte::DIRECTION_TXRX);
+  }
+
+  const uint32_t nof_sdus = 10;
+  for (uint32_t i = 0; i < nof_sdus; ++i) {
+    pdcp_tx.write_sdu(make_ip_packet(pool, 100, 0x45));
+  }
+  TESTASSERT(rlc.sdus.size() == nof_sdus);
+  for (uint32_t i = 0; i < nof_sdus; ++i) {
+    pdcp_rx.write_pdu(std::move(rlc.sdus[i]));
+  }
+  TESTASSERT(gw.rx_count == nof_sdus);
+  srslte::unique_byte_buffer_t out = srslte::allocate_unique_buffer(*pool);
+  srslte::unique_byte_buffer_t ref = make_ip_packet(pool, 100, 0x45);
+  gw.get_last_pdu(out);
+  TESTASSERT(compare_two_packets(out, ref) == 0);
+
+  // After a re-establishment the decompressor waits for a new IR packet
+  pdcp_rx.reestablish();
+  rlc.sdus.clear();
+  pdcp_tx.write_sdu(make_ip_packet(pool, 100, 0x45));
+  pdcp_rx.write_pdu(std::move(rlc.sdus[0]));
+  TESTASSERT(gw.rx_count == nof_sdus);
+  return SRSLTE_SUCCESS;
+}
+
+int run_all_tests(srslte::byte_buffer_pool* pool)
+{
+  // Setup log
+  srslte::log_ref log("PDCP LTE Test ROHC");
+  log->set_level(srslte::LOG_LEVEL_DEBUG);
+  log->set_hex_limit(128);
+
+  TESTASSERT(test_rohc_roundtrip(15, pool) == SRSLTE_SUCCESS);
+  TESTASSERT(test_rohc_roundtrip(16383, pool) == SRSLTE_SUCCESS);
+  TESTASSERT(test_rohc_context(pool) == SRSLTE_SUCCESS);
+  TESTASSERT(test_rohc_entity(pool, log) == SRSLTE_SUCCESS);
+
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  if (run_all_tests(srslte::byte_buffer_pool::get_instance()) != SRSLTE_SUCCESS) {
+    fprintf(stderr, "pdcp_lte_test_rohc() failed\n");
+    return SRSLTE_ERROR;
+  }
+
+  return SRSLTE_SUCCESS;
+}
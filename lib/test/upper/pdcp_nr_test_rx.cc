@@ -225,6 +225,37 @@ int test_rx_all(srslte::byte_buffer_pool* pool, srslte::log_ref log)
     test8_pdus.push_back(std::move(event_pdu2));
     TESTASSERT(test_rx(std::move(test8_pdus), test8_init_state, srslte::PDCP_SN_LEN_12, 1, tst_sdu1, pool, log) == 0);
   }
+
+  /*
+   * RX Test 9: PDCP Entity with SN LEN = 12
+   * Test reception of 130 packets in reverse order, spanning several words of the reception buffer bitmap.
+   * All of them are delivered at once when COUNT 0 arrives.
+   */
+  {
+    std::vector<uint32_t> test9_counts(130);
+    std::iota(test9_counts.rbegin(), test9_counts.rend(), 0); // From COUNT 129 down to 0
+    std::vector<pdcp_test_event_t> test9_pdus =
+        gen_expected_pdus_vector(tst_sdu1, test9_counts, srslte::PDCP_SN_LEN_12, sec_cfg, pool, log);
+    pdcp_initial_state test9_init_state = {};
+    TESTASSERT(test_rx(std::move(test9_pdus), test9_init_state, srslte::PDCP_SN_LEN_12, 130, tst_sdu1, pool, log) ==
+               0);
+  }
+
+  /*
+   * RX Test 10: PDCP Entity with SN LEN = 12
+   * Test reception of 129 packets with COUNT 0 missing, starting at an RX_DELIV close to the end of the buffer.
+   * They are all delivered when t-Reordering expires.
+   */
+  {
+    std::vector<uint32_t> test10_counts(129);
+    std::iota(test10_counts.begin(), test10_counts.end(), 2001); // COUNT 2000 is missing
+    std::vector<pdcp_test_event_t> test10_pdus =
+        gen_expected_pdus_vector(tst_sdu1, test10_counts, srslte::PDCP_SN_LEN_12, sec_cfg, pool, log);
+    test10_pdus.back().ticks             = 500;
+    pdcp_initial_state test10_init_state = {.tx_next = 2000, .rx_next = 2000, .rx_deliv = 2000, .rx_reord = 0};
+    TESTASSERT(test_rx(std::move(test10_pdus), test10_init_state, srslte::PDCP_SN_LEN_12, 129, tst_sdu1, pool, log) ==
+               0);
+  }
   return 0;
 }
 
@@ -0,0 +1,405 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Throughput benchmark of the user plane of PDCP and RLC
+ *
+ * SDUs go through a transmitting PDCP and RLC entity, the RLC PDUs are read in MAC-sized opportunities, dropped at
+ * the configured rate, and written into a receiving RLC and PDCP entity, which deliver them to a dummy GW. The status
+ * PDUs of RLC AM go the opposite way. Everything runs in a single thread, one TTI per loop iteration.
+ *
+ * The time and the heap allocations of each layer are accounted separately: entering a layer through one of the
+ * interfaces pauses the accounting of the calling layer.
+ */
+
+#include "srslte/common/buffer_pool.h"
+#include "srslte/common/log_filter.h"
+#include "srslte/common/security.h"
+#include "srslte/common/task_scheduler.h"
+#include "srslte/upper/pdcp_entity_lte.h"
+#include "srslte/upper/rlc.h"
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <random>
+#ifdef HAVE_5GNR
+#include "srslte/upper/pdcp_entity_nr.h"
+#endif
+
+using namespace srslte;
+namespace bpo = boost::program_options;
+
+typedef struct {
+  std::string rat;
+  std::string mode;
+  uint32_t    nof_sdus;
+  uint32_t    sdu_size;
+  uint32_t    sdus_per_tti;
+  uint32_t    opp_size;
+  float       pdu_drop_rate;
+  uint32_t    pdcp_sn_len;
+  uint32_t    rlc_sn_len;
+  uint32_t    cipher_algo;
+  uint32_t    log_level;
+} benchmark_args_t;
+
+void parse_args(benchmark_args_t* args, int argc, char* argv[])
+{
+  bpo::options_description general("General options");
+  general.add_options()("help,h", "Produce help message");
+
+  // clang-format off
+  bpo::options_description common("Benchmark options");
+  common.add_options()
+      ("rat",           bpo::value<std::string>(&args->rat)->default_value("LTE"), "The PDCP and RLC version to use (LTE/NR)")
+      ("mode",          bpo::value<std::string>(&args->mode)->default_value("UM"), "The RLC mode (AM/UM). NR only supports UM")
+      ("nof_sdus",      bpo::value<uint32_t>(&args->nof_sdus)->default_value(100000), "Number of SDUs to transmit")
+      ("sdu_size",      bpo::value<uint32_t>(&args->sdu_size)->default_value(1500), "Size of the SDUs")
+      ("sdus_per_tti",  bpo::value<uint32_t>(&args->sdus_per_tti)->default_value(8), "Number of SDUs written in a TTI")
+      ("opp_size",      bpo::value<uint32_t>(&args->opp_size)->default_value(1505), "Size of the MAC opportunities")
+      ("pdu_drop_rate", bpo::value<float>(&args->pdu_drop_rate)->default_value(0.0), "Rate at which RLC PDUs are dropped")
+      ("pdcp_sn_len",   bpo::value<uint32_t>(&args->pdcp_sn_len)->default_value(12), "PDCP SN length (LTE: 7/12, NR: 12/18)")
+      ("rlc_sn_len",    bpo::value<uint32_t>(&args->rlc_sn_len)->default_value(10), "RLC UM SN length, which sets the window size (LTE: 5/10, NR: 6/12)")
+      ("cipher",        bpo::value<uint32_t>(&args->cipher_algo)->default_value(2), "Ciphering algorithm (0=EEA0, 1=EEA1, 2=EEA2, 3=EEA3)")
+      ("loglevel",      bpo::value<uint32_t>(&args->log_level)->default_value(srslte::LOG_LEVEL_NONE), "Log level (1=Error,2=Warning,3=Info,4=Debug)");
+  // clang-format on
+
+  bpo::options_description cmdline_options;
+  cmdline_options.add(common).add(general);
+
+  bpo::variables_map vm;
+  bpo::store(bpo::command_line_parser(argc, argv).options(cmdline_options).run(), vm);
+  bpo::notify(vm);
+
+  if (vm.count("help") > 0) {
+    std::cout << "Usage: " << argv[0] << " [OPTIONS]" << std::endl << std::endl;
+    std::cout << common << std::endl << general << std::endl;
+    exit(0);
+  }
+}
+
+/*
+ * Per layer accounting
+ */
+enum layer_t { PDCP_TX, RLC_TX, RLC_RX, PDCP_RX, NOF_LAYERS };
+static const char* layer_names[NOF_LAYERS] = {"PDCP TX", "RLC TX", "RLC RX", "PDCP RX"};
+
+struct layer_stats_t {
+  uint64_t nof_calls  = 0;
+  uint64_t ns         = 0;
+  uint64_t nof_allocs = 0;
+};
+
+static layer_stats_t                                  layer_stats[NOF_LAYERS];
+static int                                            cur_layer = -1;
+static std::chrono::high_resolution_clock::time_point last_mark;
+
+// Charges the time since the last mark to the current layer
+static void mark_time()
+{
+  auto now = std::chrono::high_resolution_clock::now();
+  if (cur_layer >= 0) {
+    layer_stats[cur_layer].ns += std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_mark).count();
+  }
+  last_mark = now;
+}
+
+class layer_scope
+{
+public:
+  explicit layer_scope(layer_t layer) : prev(cur_layer)
+  {
+    mark_time();
+    cur_layer = layer;
+    layer_stats[layer].nof_calls++;
+  }
+  ~layer_scope()
+  {
+    mark_time();
+    cur_layer = prev;
+  }
+
+private:
+  int prev;
+};
+
+// All heap allocations of the process are charged to the layer running at the time
+void* operator new(std::size_t size)
+{
+  if (cur_layer >= 0) {
+    layer_stats[cur_layer].nof_allocs++;
+  }
+  void* ptr = malloc(size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+  free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  free(ptr);
+}
+
+/*
+ * Dummy upper and lower layers, and proxies that charge each call to the layer it enters
+ */
+class rrc_dummy : public srsue::rrc_interface_pdcp, public srsue::rrc_interface_rlc
+{
+public:
+  void        write_pdu(uint32_t lcid, unique_byte_buffer_t pdu) final {}
+  void        write_pdu_bcch_bch(unique_byte_buffer_t pdu) final {}
+  void        write_pdu_bcch_dlsch(unique_byte_buffer_t pdu) final {}
+  void        write_pdu_pcch(unique_byte_buffer_t pdu) final {}
+  void        write_pdu_mch(uint32_t lcid, unique_byte_buffer_t pdu) final {}
+  void        max_retx_attempted() final {}
+  std::string get_rb_name(uint32_t lcid) final { return "DRB1"; }
+};
+
+class gw_dummy : public srsue::gw_interface_pdcp
+{
+public:
+  void write_pdu(uint32_t lcid, unique_byte_buffer_t pdu) final
+  {
+    nof_sdus++;
+    nof_bytes += pdu->N_bytes;
+  }
+  void write_pdu_mch(uint32_t lcid, unique_byte_buffer_t pdu) final {}
+
+  uint64_t nof_sdus  = 0;
+  uint64_t nof_bytes = 0;
+};
+
+// Lets the transmitting PDCP entity write into the transmitting RLC
+class rlc_tx_proxy : public srsue::rlc_interface_pdcp
+{
+public:
+  explicit rlc_tx_proxy(rlc* rlc_) : rlc_tx(rlc_) {}
+
+  void write_sdu(uint32_t lcid, unique_byte_buffer_t sdu) final
+  {
+    layer_scope scope(RLC_TX);
+    rlc_tx->write_sdu(lcid, std::move(sdu));
+  }
+  void discard_sdu(uint32_t lcid, uint32_t discard_sn) final { rlc_tx->discard_sdu(lcid, discard_sn); }
+  bool rb_is_um(uint32_t lcid) final { return rlc_tx->rb_is_um(lcid); }
+  bool sdu_queue_is_full(uint32_t lcid) final { return rlc_tx->sdu_queue_is_full(lcid); }
+
+private:
+  rlc* rlc_tx;
+};
+
+// Lets an RLC entity deliver its SDUs to a PDCP entity
+class pdcp_rx_proxy : public srsue::pdcp_interface_rlc
+{
+public:
+  void write_pdu(uint32_t lcid, unique_byte_buffer_t sdu) final
+  {
+    layer_scope scope(PDCP_RX);
+    pdcp_rx->write_pdu(std::move(sdu));
+  }
+  void write_pdu_bcch_bch(unique_byte_buffer_t sdu) final {}
+  void write_pdu_bcch_dlsch(unique_byte_buffer_t sdu) final {}
+  void write_pdu_pcch(unique_byte_buffer_t sdu) final {}
+  void write_pdu_mch(uint32_t lcid, unique_byte_buffer_t sdu) final {}
+
+  pdcp_entity_base* pdcp_rx = nullptr;
+};
+
+// Transfers all the buffered PDUs of one RLC entity to the other, in opportunities of opp_size bytes
+static uint32_t mac_transfer(rlc&                                   from,
+                             rlc&                                   to,
+                             uint32_t                               lcid,
+                             const benchmark_args_t&                args,
+                             std::mt19937&                          rand_gen,
+                             std::uniform_real_distribution<float>& real_dist)
+{
+  std::vector<uint8_t> payload(args.opp_size);
+  uint32_t             nof_pdus = 0;
+  while (from.get_buffer_state(lcid) > 0) {
+    int len;
+    {
+      layer_scope scope(RLC_TX);
+      len = from.read_pdu(lcid, payload.data(), args.opp_size);
+    }
+    if (len <= 0) {
+      break;
+    }
+    nof_pdus++;
+    if (real_dist(rand_gen) < args.pdu_drop_rate) {
+      continue;
+    }
+    layer_scope scope(RLC_RX);
+    to.write_pdu(lcid, payload.data(), len);
+  }
+  return nof_pdus;
+}
+
+int run_benchmark(const benchmark_args_t& args)
+{
+  const uint32_t lcid = 3;
+  bool           is_nr = args.rat == "NR";
+
+  srslte::logmap::set_default_log_level(static_cast<LOG_LEVEL_ENUM>(args.log_level));
+  byte_buffer_pool* pool = byte_buffer_pool::get_instance();
+  task_scheduler    task_sched;
+  rrc_dummy         rrc;
+  gw_dummy          gw;
+
+  // RLC
+  rlc_config_t rlc_cfg;
+  if (is_nr) {
+    rlc_cfg = rlc_config_t::default_rlc_um_nr_config(args.rlc_sn_len);
+  } else if (args.mode == "AM") {
+    rlc_cfg = rlc_config_t::default_rlc_am_config();
+  } else {
+    rlc_cfg = rlc_config_t::default_rlc_um_config(args.rlc_sn_len);
+  }
+  rlc           rlc_tx("RLC_TX"), rlc_rx("RLC_RX");
+  pdcp_rx_proxy pdcp_tx_side, pdcp_rx_side; // The former only gets AM status PDUs, which are not passed to PDCP
+  rlc_tx.init(&pdcp_tx_side, &rrc, task_sched.get_timer_handler(), 0);
+  rlc_rx.init(&pdcp_rx_side, &rrc, task_sched.get_timer_handler(), 0);
+  rlc_tx.add_bearer(lcid, rlc_cfg);
+  rlc_rx.add_bearer(lcid, rlc_cfg);
+  rlc_tx_proxy rlc_tx_if(&rlc_tx);
+
+  // PDCP
+  pdcp_config_t tx_cfg(1,
+                       PDCP_RB_IS_DRB,
+                       SECURITY_DIRECTION_DOWNLINK,
+                       SECURITY_DIRECTION_UPLINK,
+                       args.pdcp_sn_len,
+                       pdcp_t_reordering_t::ms100,
+                       pdcp_discard_timer_t::infinity);
+  pdcp_config_t rx_cfg(1,
+                       PDCP_RB_IS_DRB,
+                       SECURITY_DIRECTION_UPLINK,
+                       SECURITY_DIRECTION_DOWNLINK,
+                       args.pdcp_sn_len,
+                       pdcp_t_reordering_t::ms100,
+                       pdcp_discard_timer_t::infinity);
+  std::unique_ptr<pdcp_entity_base> pdcp_tx, pdcp_rx;
+  if (is_nr) {
+#ifdef HAVE_5GNR
+    pdcp_tx.reset(new pdcp_entity_nr(&rlc_tx_if, &rrc, &gw, &task_sched, logmap::get("PDCP_TX"), lcid, tx_cfg));
+    pdcp_rx.reset(new pdcp_entity_nr(&rlc_tx_if, &rrc, &gw, &task_sched, logmap::get("PDCP_RX"), lcid, rx_cfg));
+#else
+    fprintf(stderr, "NR support is not enabled in this build\n");
+    return SRSLTE_ERROR;
+#endif
+  } else {
+    pdcp_tx.reset(new pdcp_entity_lte(&rlc_tx_if, &rrc, &gw, &task_sched, logmap::get("PDCP_TX"), lcid, tx_cfg));
+    pdcp_rx.reset(new pdcp_entity_lte(&rlc_tx_if, &rrc, &gw, &task_sched, logmap::get("PDCP_RX"), lcid, rx_cfg));
+  }
+  pdcp_rx_side.pdcp_rx = pdcp_rx.get();
+
+  as_security_config_t sec_cfg = {};
+  for (uint32_t i = 0; i < 32; ++i) {
+    sec_cfg.k_up_enc[i] = i;
+  }
+  sec_cfg.integ_algo  = INTEGRITY_ALGORITHM_ID_EIA0;
+  sec_cfg.cipher_algo = static_cast<CIPHERING_ALGORITHM_ID_ENUM>(args.cipher_algo);
+  for (pdcp_entity_base* e : {pdcp_tx.get(), pdcp_rx.get()}) {
+    e->config_security(sec_cfg);
+    e->enable_encryption(DIRECTION_TXRX);
+  }
+
+  // Run one TTI per iteration, and keep going without new SDUs until RLC AM has recovered the lost PDUs
+  std::mt19937                          rand_gen(1234);
+  std::uniform_real_distribution<float> real_dist(0.0, 1.0);
+  uint64_t                              nof_pdus = 0, nof_status_pdus = 0;
+  uint32_t                              nof_sent = 0, nof_flush_ttis = 0;
+  auto                                  t_start = std::chrono::high_resolution_clock::now();
+  while (nof_sent < args.nof_sdus or (args.mode == "AM" and gw.nof_sdus < nof_sent and nof_flush_ttis++ < 10000)) {
+    for (uint32_t i = 0; i < args.sdus_per_tti and nof_sent < args.nof_sdus; ++i, ++nof_sent) {
+      unique_byte_buffer_t sdu = allocate_unique_buffer(*pool, true);
+      if (sdu == nullptr) {
+        fprintf(stderr, "Could not allocate SDU\n");
+        return SRSLTE_ERROR;
+      }
+      sdu->N_bytes = args.sdu_size;
+      layer_scope scope(PDCP_TX);
+      pdcp_tx->write_sdu(std::move(sdu));
+    }
+    nof_pdus += mac_transfer(rlc_tx, rlc_rx, lcid, args, rand_gen, real_dist);
+    nof_status_pdus += mac_transfer(rlc_rx, rlc_tx, lcid, args, rand_gen, real_dist);
+    task_sched.tic();
+    task_sched.run_pending_tasks();
+  }
+  double total_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - t_start).count();
+
+  // Report
+  printf("%s %s: %u SDUs of %u B, opportunities of %u B, drop rate %.3f, EEA%u\n",
+         args.rat.c_str(),
+         is_nr ? "UM" : args.mode.c_str(),
+         nof_sent,
+         args.sdu_size,
+         args.opp_size,
+         args.pdu_drop_rate,
+         args.cipher_algo);
+  printf("%-8s %12s %12s %12s %12s\n", "Layer", "Calls", "ns/call", "ns/SDU", "allocs/SDU");
+  double layers_ns = 0;
+  for (uint32_t i = 0; i < NOF_LAYERS; ++i) {
+    const layer_stats_t& s = layer_stats[i];
+    printf("%-8s %12" PRIu64 " %12.1f %12.1f %12.3f\n",
+           layer_names[i],
+           s.nof_calls,
+           s.nof_calls > 0 ? (double)s.ns / s.nof_calls : 0.0,
+           nof_sent > 0 ? (double)s.ns / nof_sent : 0.0,
+           nof_sent > 0 ? (double)s.nof_allocs / nof_sent : 0.0);
+    layers_ns += s.ns;
+  }
+  printf("Delivered %" PRIu64 " SDUs (%.1f Mbit), %" PRIu64 " RLC data PDUs and %" PRIu64 " status PDUs\n",
+         gw.nof_sdus,
+         gw.nof_bytes * 8 / 1e6,
+         nof_pdus,
+         nof_status_pdus);
+  printf("PDCP+RLC: %.1f ns/PDU, %.0f PDUs/s, %.1f ns/SDU (%.1f ms wall time)\n",
+         nof_pdus > 0 ? layers_ns / nof_pdus : 0.0,
+         layers_ns > 0 ? nof_pdus / (layers_ns * 1e-9) : 0.0,
+         nof_sent > 0 ? layers_ns / nof_sent : 0.0,
+         total_ns / 1e6);
+
+  rlc_tx.stop();
+  rlc_rx.stop();
+  if (args.pdu_drop_rate == 0 and gw.nof_sdus != nof_sent) {
+    fprintf(stderr, "Only %" PRIu64 " of %u SDUs were delivered without PDU losses\n", gw.nof_sdus, nof_sent);
+    return SRSLTE_ERROR;
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  benchmark_args_t args = {};
+  parse_args(&args, argc, argv);
+
+  int ret = run_benchmark(args);
+  byte_buffer_pool::cleanup();
+  return ret;
+}
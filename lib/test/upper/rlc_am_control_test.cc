@@ -71,10 +71,51 @@ int status_pdu_with_nacks_test1()
   return SRSLTE_SUCCESS;
 }
 
+// Status PDU with a full window of NACKs, some of them for segments
+int status_pdu_with_many_nacks_test()
+{
+  srslte::rlc_status_pdu_t s1, s2;
+  srslte::byte_buffer_t    b1, b2;
+
+  s1.ack_sn = 1000;
+  s1.N_nack = RLC_AM_WINDOW_SIZE;
+  for (uint32_t i = 0; i < s1.N_nack; i++) {
+    s1.nacks[i].nack_sn = (488 + i) % 1024;
+    if (i % 7 == 0) {
+      s1.nacks[i].has_so   = true;
+      s1.nacks[i].so_start = i * 3;
+      s1.nacks[i].so_end   = 0x7fff - i;
+    }
+  }
+  rlc_am_write_status_pdu(&s1, &b1);
+  TESTASSERT(b1.N_bytes == rlc_am_packed_length(&s1));
+
+  rlc_am_read_status_pdu(&b1, &s2);
+  TESTASSERT(s2.ack_sn == s1.ack_sn);
+  TESTASSERT(s2.N_nack == s1.N_nack);
+  for (uint32_t i = 0; i < s2.N_nack; i++) {
+    TESTASSERT(s2.nacks[i].nack_sn == s1.nacks[i].nack_sn);
+    TESTASSERT(s2.nacks[i].has_so == s1.nacks[i].has_so);
+    if (s2.nacks[i].has_so) {
+      TESTASSERT(s2.nacks[i].so_start == s1.nacks[i].so_start);
+      TESTASSERT(s2.nacks[i].so_end == s1.nacks[i].so_end);
+    }
+  }
+  rlc_am_write_status_pdu(&s2, &b2);
+  TESTASSERT(b2.N_bytes == b1.N_bytes);
+  TESTASSERT(memcmp(b2.msg, b1.msg, b1.N_bytes) == 0);
+
+  // A truncated PDU must not be read past its end
+  rlc_am_read_status_pdu(b1.msg, 10, &s2);
+  TESTASSERT(s2.N_nack <= 10 * 8 / 12);
+  return SRSLTE_SUCCESS;
+}
+
 int main(int argc, char** argv)
 {
   TESTASSERT(simple_status_pdu_test1() == SRSLTE_SUCCESS);
   TESTASSERT(status_pdu_with_nacks_test1() == SRSLTE_SUCCESS);
+  TESTASSERT(status_pdu_with_many_nacks_test() == SRSLTE_SUCCESS);
 
   return SRSLTE_SUCCESS;
 }
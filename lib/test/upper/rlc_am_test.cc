@@ -247,6 +247,55 @@ bool concat_test()
   return SRSLTE_SUCCESS;
 }
 
+static void count_view_release(void* owner, void* arg)
+{
+  (*static_cast<uint32_t*>(owner))++;
+}
+
+// PDUs passed as views of a larger buffer are kept in the Rx window without a copy, until they are reassembled
+bool view_test()
+{
+  rlc_am_tester tester;
+  timer_handler timers(8);
+  byte_buffer_t pdu_bufs[NBUFS];
+
+  rlc_am_lte rlc1(rrc_log1, 1, &tester, &tester, &timers);
+  rlc_am_lte rlc2(rrc_log2, 1, &tester, &tester, &timers);
+
+  if (not rlc1.configure(rlc_config_t::default_rlc_am_config())) {
+    return -1;
+  }
+  if (not rlc2.configure(rlc_config_t::default_rlc_am_config())) {
+    return -1;
+  }
+
+  basic_test_tx(&rlc1, pdu_bufs);
+
+  // Write the PDUs into RLC2 in reverse order, so that they wait in the Rx window
+  byte_buffer_pool* pool         = byte_buffer_pool::get_instance();
+  uint32_t          nof_released = 0;
+  for (int i = NBUFS - 1; i >= 0; i--) {
+    unique_byte_buffer_t view = srslte::allocate_unique_buffer_view(
+        *pool, pdu_bufs[i].msg, pdu_bufs[i].N_bytes, count_view_release, &nof_released, nullptr);
+    TESTASSERT(view != nullptr);
+    rlc2.write_pdu(std::move(view));
+    if (i > 0) {
+      TESTASSERT(tester.n_sdus == 0);
+    }
+  }
+  TESTASSERT(nof_released == NBUFS);
+
+  TESTASSERT(tester.n_sdus == NBUFS);
+  for (int i = 0; i < tester.n_sdus; i++) {
+    TESTASSERT(tester.sdus[i]->N_bytes == 1);
+    TESTASSERT(*(tester.sdus[i]->msg) == i);
+  }
+
+  TESTASSERT(rx_is_tx(rlc1.get_metrics(), rlc2.get_metrics()));
+
+  return SRSLTE_SUCCESS;
+}
+
 bool segment_test(bool in_seq_rx)
 {
   rlc_am_tester         tester;
@@ -1561,6 +1610,12 @@ int main(int argc, char** argv)
   };
   byte_buffer_pool::get_instance()->cleanup();
 
+  if (view_test()) {
+    printf("view_test failed\n");
+    exit(-1);
+  };
+  byte_buffer_pool::get_instance()->cleanup();
+
   if (segment_test(true)) {
     printf("segment_test with in-order PDU reception failed\n");
     exit(-1);
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srslte/common/test_common.h"
+#include "srslte/upper/byte_buffer_queue.h"
+#include "srslte/upper/rlc_aqm.h"
+#include <unistd.h>
+
+using namespace srslte;
+
+static const uint64_t ms = 1000000;
+
+/// Dequeues one SDU per ms for duration_ms, all having waited sojourn_ms, and returns the number of drops
+uint32_t run_standing_queue(rlc_aqm& aqm, uint64_t& now, uint32_t duration_ms, uint32_t sojourn_ms, uint32_t bytes)
+{
+  uint32_t drops = 0;
+  for (uint32_t i = 0; i < duration_ms; i++) {
+    now += ms;
+    if (aqm.drop_head(now - sojourn_ms * ms, now, bytes)) {
+      drops++;
+    }
+  }
+  return drops;
+}
+
+int test_codel()
+{
+  rlc_aqm_config_t cfg = {};
+  cfg.mode             = rlc_aqm_mode_t::codel;
+  rlc_aqm  aqm(cfg);
+  uint64_t now = 1000 * ms;
+
+  // Below the target nothing is dropped, however long the queue
+  TESTASSERT(run_standing_queue(aqm, now, 1000, 4, 100000) == 0);
+
+  // A standing delay above the target is tolerated for one interval, then drops at an increasing rate
+  TESTASSERT(run_standing_queue(aqm, now, 99, 20, 100000) == 0);
+  uint32_t first  = run_standing_queue(aqm, now, 500, 20, 100000);
+  uint32_t second = run_standing_queue(aqm, now, 500, 20, 100000);
+  TESTASSERT(first > 1);
+  TESTASSERT(second > first);
+
+  // Leaving the dropping state as soon as the delay is back below the target
+  TESTASSERT(run_standing_queue(aqm, now, 100, 1, 100000) == 0);
+
+  // A queue of at most one MTU is never emptied
+  TESTASSERT(run_standing_queue(aqm, now, 1000, 50, rlc_aqm::mtu_bytes) == 0);
+
+  return SRSLTE_SUCCESS;
+}
+
+int test_pie()
+{
+  rlc_aqm_config_t cfg = {};
+  cfg.mode             = rlc_aqm_mode_t::pie;
+  rlc_aqm  aqm(cfg);
+  uint64_t now = 1000 * ms;
+
+  // The short queue safeguard holds even with a large delay
+  TESTASSERT(run_standing_queue(aqm, now, 1000, 100, 2 * rlc_aqm::mtu_bytes) == 0);
+  double p = aqm.get_drop_probability();
+  TESTASSERT(p > 0);
+
+  // The drop probability keeps rising while the delay stays above the target
+  uint32_t drops = run_standing_queue(aqm, now, 2000, 100, 100000);
+  TESTASSERT(drops > 0);
+  TESTASSERT(aqm.get_drop_probability() > p);
+
+  // And decays once the queue is drained
+  p = aqm.get_drop_probability();
+  run_standing_queue(aqm, now, 2000, 0, 100000);
+  TESTASSERT(aqm.get_drop_probability() < p);
+
+  return SRSLTE_SUCCESS;
+}
+
+/// The queue drops at its head when read, counting the drops, and never drops the last SDUs
+int test_queue_aqm()
+{
+  const uint32_t nof_sdus = 20;
+
+  rlc_aqm_config_t cfg = {};
+  cfg.mode             = rlc_aqm_mode_t::codel;
+  cfg.target_ms        = 1;
+  cfg.interval_ms      = 1;
+  rlc_aqm                   aqm(cfg);
+  metrics_counter<uint32_t> drops;
+  byte_buffer_queue         q;
+  q.set_aqm(&aqm, &drops);
+
+  for (uint32_t i = 0; i < nof_sdus; i++) {
+    unique_byte_buffer_t sdu = allocate_unique_buffer(*byte_buffer_pool::get_instance());
+    sdu->N_bytes             = 1000;
+    sdu->msg[0]              = i;
+    q.write(std::move(sdu));
+  }
+  // The delay has to stay above the target for an interval before the first drop
+  TESTASSERT(q.read()->msg[0] == 0);
+  usleep(5000);
+  TESTASSERT(q.read()->msg[0] == 1);
+  usleep(5000);
+  TESTASSERT(q.read()->msg[0] == 3);
+  TESTASSERT(drops.load() == 1);
+
+  uint32_t nof_read = 3;
+  usleep(5000);
+  q.read_while([&nof_read](unique_byte_buffer_t sdu) {
+    nof_read++;
+    return true;
+  });
+  TESTASSERT(q.is_empty());
+  TESTASSERT(drops.load() > 1);
+  TESTASSERT(nof_read + drops.load() == nof_sdus);
+
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_codel() == SRSLTE_SUCCESS);
+  TESTASSERT(test_pie() == SRSLTE_SUCCESS);
+  TESTASSERT(test_queue_aqm() == SRSLTE_SUCCESS);
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
@@ -563,6 +563,52 @@ int rlc_um_nr_test8()
   return SRSLTE_SUCCESS;
 }
 
+// Segments received out of order and twice, the SDU is reassembled from the byte ranges of the segments
+int rlc_um_nr_test9()
+{
+  rlc_um_nr_test_context1 ctxt;
+
+  const uint32_t sdu_size = 100;
+
+  ctxt.tester.set_expected_sdu_len(sdu_size);
+
+  // Push one SDU into RLC1
+  byte_buffer_pool*    pool    = byte_buffer_pool::get_instance();
+  unique_byte_buffer_t sdu_buf = srslte::allocate_unique_buffer(*pool, true);
+  memset(sdu_buf->msg, 0x5a, sdu_size);
+  sdu_buf->N_bytes = sdu_size;
+  ctxt.rlc1.write_sdu(std::move(sdu_buf));
+
+  // Read PDUs from RLC1 with grant of 25 Bytes each
+  const uint32_t       max_num_pdus = 10;
+  uint32               num_pdus     = 0;
+  unique_byte_buffer_t pdu_bufs[max_num_pdus];
+
+  while (ctxt.rlc1.get_buffer_state() != 0 && num_pdus < max_num_pdus) {
+    pdu_bufs[num_pdus]          = srslte::allocate_unique_buffer(*pool, true);
+    int len                     = ctxt.rlc1.read_pdu(pdu_bufs[num_pdus]->msg, 25);
+    pdu_bufs[num_pdus]->N_bytes = len;
+    write_pdu_to_pcap(4, pdu_bufs[num_pdus]->msg, pdu_bufs[num_pdus]->N_bytes);
+    num_pdus++;
+  }
+  TESTASSERT(num_pdus > 3);
+
+  // Write the last segment first, then the middle ones twice, and the first one at the end
+  ctxt.rlc2.write_pdu(pdu_bufs[num_pdus - 1]->msg, pdu_bufs[num_pdus - 1]->N_bytes);
+  for (uint32_t i = 1; i < num_pdus - 1; i++) {
+    ctxt.rlc2.write_pdu(pdu_bufs[i]->msg, pdu_bufs[i]->N_bytes);
+    ctxt.rlc2.write_pdu(pdu_bufs[i]->msg, pdu_bufs[i]->N_bytes);
+  }
+  TESTASSERT(0 == ctxt.tester.get_num_sdus());
+  ctxt.rlc2.write_pdu(pdu_bufs[0]->msg, pdu_bufs[0]->N_bytes);
+
+  TESTASSERT(1 == ctxt.tester.get_num_sdus());
+  TESTASSERT(ctxt.tester.sdus.at(0)->N_bytes == sdu_size);
+  TESTASSERT(*(ctxt.tester.sdus[0]->msg) == 0x5a);
+
+  return SRSLTE_SUCCESS;
+}
+
 int main(int argc, char** argv)
 {
 #if PCAP
@@ -613,6 +659,11 @@ int main(int argc, char** argv)
     return SRSLTE_ERROR;
   }
 
+  if (rlc_um_nr_test9()) {
+    fprintf(stderr, "rlc_um_nr_test9() failed.\n");
+    return SRSLTE_ERROR;
+  }
+
   byte_buffer_pool::get_instance()->cleanup();
 
   return SRSLTE_SUCCESS;
@@ -114,6 +114,39 @@ int meas_obj_test()
   return 0;
 }
 
+int batch_test()
+{
+  rlc_um_lte_test_context1 ctxt;
+
+  // Push 5 SDUs into RLC1 at once
+  byte_buffer_pool*                 pool = byte_buffer_pool::get_instance();
+  std::vector<unique_byte_buffer_t> sdus;
+  for (int i = 0; i < NBUFS; i++) {
+    sdus.push_back(srslte::allocate_unique_buffer(*pool, true));
+    sdus.back()->msg[0]  = i; // Write the index into the buffer
+    sdus.back()->N_bytes = 1; // Give each buffer a size of 1 byte
+  }
+  ctxt.rlc1.write_sdus(sdus);
+
+  TESTASSERT(14 == ctxt.rlc1.get_buffer_state());
+  TESTASSERT(NBUFS == ctxt.rlc1.get_metrics().num_tx_sdus);
+
+  // Read all the SDUs in a single PDU
+  byte_buffer_t pdu_buf;
+  pdu_buf.N_bytes = ctxt.rlc1.read_pdu(pdu_buf.msg, 14);
+  TESTASSERT(13 == pdu_buf.N_bytes); // 2 bytes of fixed header and 6 of LIs
+  TESTASSERT(0 == ctxt.rlc1.get_buffer_state());
+
+  ctxt.rlc2.write_pdu(pdu_buf.msg, pdu_buf.N_bytes);
+  TESTASSERT(NBUFS == ctxt.tester.get_num_sdus());
+  for (uint32_t i = 0; i < ctxt.tester.sdus.size(); i++) {
+    TESTASSERT(ctxt.tester.sdus.at(i)->N_bytes == 1);
+    TESTASSERT(*(ctxt.tester.sdus[i]->msg) == i);
+  }
+
+  return 0;
+}
+
 int loss_test()
 {
   rlc_um_lte_test_context1 ctxt;
@@ -446,6 +479,11 @@ int main(int argc, char** argv)
   }
   byte_buffer_pool::get_instance()->cleanup();
 
+  if (batch_test()) {
+    return -1;
+  }
+  byte_buffer_pool::get_instance()->cleanup();
+
   if (loss_test()) {
     return -1;
   }
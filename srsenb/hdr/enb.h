@@ -28,6 +28,7 @@
 #ifndef SRSENB_ENB_H
 #define SRSENB_ENB_H
 
+#include <map>
 #include <pthread.h>
 #include <stdarg.h>
 #include <string>
@@ -81,6 +82,7 @@ struct log_args_t {
   int         all_hex_limit;
   int         file_max_size;
   std::string filename;
+  bool        binary;
 };
 
 struct gui_args_t {
@@ -92,9 +94,18 @@ struct general_args_t {
   float       metrics_period_secs;
   bool        metrics_csv_enable;
   std::string metrics_csv_filename;
+  bool        metrics_http_enable;
+  std::string metrics_http_address;
+  uint16_t    metrics_http_port;
   bool        print_buffer_state;
   std::string eia_pref_list;
   std::string eea_pref_list;
+  uint32_t    hugepage_threshold;
+  std::string tti_trace_filename;
+  bool        perf_counters;
+
+  // CPU placement of the threads, indexed by the prefix of the thread names
+  std::map<std::string, std::string> thread_placement;
 };
 
 struct all_args_t {
@@ -132,6 +143,7 @@ public:
 
   // eNodeB command interface
   void cmd_cell_gain(uint32_t cell_id, float gain) override;
+  void cmd_cell_pci(uint32_t cell_id, uint32_t pci) override;
 
 private:
   const static int ENB_POOL_SIZE = 1024 * 10;
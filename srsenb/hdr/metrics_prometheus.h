@@ -0,0 +1,79 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        metrics_prometheus.h
+ * Description: Metrics class serving the metrics to Prometheus over HTTP.
+ *****************************************************************************/
+
+#ifndef SRSENB_METRICS_PROMETHEUS_H
+#define SRSENB_METRICS_PROMETHEUS_H
+
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+
+#include "srslte/common/metrics_http_server.h"
+#include "srslte/common/metrics_hub.h"
+#include "srslte/interfaces/enb_metrics_interface.h"
+
+namespace srsenb {
+
+/**
+ * Serves the eNB metrics in the Prometheus/OpenMetrics text format at http://<address>:<port>/metrics
+ *
+ * The metrics of the users, the cells and the radio are formatted when the metrics hub reports them and served until
+ * the next report. Their counters are accumulated here, as the hub reports the values of the last period. The
+ * histograms and the CPU time of the threads are read at every scrape, without disturbing the threads, and so is the
+ * memory of each subsystem.
+ */
+class metrics_prometheus : public srslte::metrics_listener<enb_metrics_t>
+{
+public:
+  bool init(const std::string& address, uint16_t port);
+
+  void set_metrics(const enb_metrics_t& m, const uint32_t period_usec);
+  void stop();
+
+private:
+  struct ue_totals_t {
+    uint64_t dl_pkts   = 0;
+    uint64_t dl_errors = 0;
+    uint64_t dl_bytes  = 0;
+    uint64_t ul_pkts   = 0;
+    uint64_t ul_errors = 0;
+    uint64_t ul_bytes  = 0;
+  };
+
+  std::string scrape();
+
+  srslte::metrics_http_server     server;
+  std::map<uint16_t, ue_totals_t> ue_totals;
+  std::map<uint32_t, ue_totals_t> cell_totals;
+  srslte::rf_metrics_t            rf_totals = {};
+  std::mutex                      mutex;
+  std::string                     last_report;
+};
+
+} // namespace srsenb
+
+#endif // SRSENB_METRICS_PROMETHEUS_H
@@ -28,11 +28,14 @@
 #include <iostream>
 #include <libconfig.h++>
 #include <list>
+#include <map>
+#include <memory>
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <sys/stat.h>
 #include <typeinfo>
 
 namespace srsenb {
@@ -248,6 +251,10 @@ public:
 
   static int parse_section(std::string filename, section* s);
 
+  /// The files are only read once, the parsers of their sections sharing the same tree. A file is read again when it
+  /// changes on disk, so that a reload of the configuration only reads the files that were regenerated
+  static Config* get_file(const std::string& filename);
+
   static bool lookupValue(Setting& root, const char* name, std::string* val) { return root.lookupValue(name, *val); }
   static bool lookupValue(Setting& root, const char* name, uint8_t* val)
   {
@@ -314,6 +321,18 @@ public:
   }
 
 private:
+  /// A file is considered unchanged while its inode, size and nanosecond modification and status change times are
+  /// the same, so that a file replaced or rewritten within the same second is read again
+  struct cached_file_t {
+    std::unique_ptr<Config> cfg;
+    dev_t                   dev   = 0;
+    ino_t                   ino   = 0;
+    off_t                   size  = 0;
+    struct timespec         mtime = {};
+    struct timespec         ctime = {};
+  };
+  static std::map<std::string, cached_file_t> file_cache;
+
   std::list<section*> sections;
   std::string         filename;
 };
@@ -22,6 +22,9 @@
 #ifndef SRSENB_CC_WORKER_H
 #define SRSENB_CC_WORKER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <string.h>
 
 #include "phy_common.h"
@@ -37,10 +40,12 @@ public:
   ~cc_worker();
   void init(phy_common* phy, srslte::log* log_h, uint32_t cc_idx);
   void reset();
+  int  set_cell(const srslte_cell_t& cell);
 
-  cf_t* get_buffer_rx(uint32_t antenna_idx);
-  cf_t* get_buffer_tx(uint32_t antenna_idx);
-  void  set_tti(uint32_t tti);
+  cf_t*    get_buffer_rx(uint32_t antenna_idx);
+  int16_t* get_buffer_rx_s(uint32_t antenna_idx);
+  cf_t*    get_buffer_tx(uint32_t antenna_idx);
+  void     set_tti(uint32_t tti);
 
   int      add_rnti(uint16_t rnti);
   void     rem_rnti(uint16_t rnti);
@@ -66,23 +71,45 @@ private:
   constexpr static float PUSCH_RL_SNR_DB_TH = 1.0f;
   constexpr static float PUCCH_RL_CORR_TH   = 0.15f;
 
+  // Per grant PDSCH encoding state, filled in the preparation step and consumed in the encoding and report steps
+  struct pdsch_job_t {
+    srslte_dl_cfg_t dl_cfg = {};
+    bool            valid  = false;
+    int             ret    = SRSLTE_SUCCESS;
+  };
+
+  bool prepare_pdsch_rnti(stack_interface_phy_lte::dl_sched_grant_t& grant, pdsch_job_t& job);
+  void encode_pdsch_jobs(uint32_t tx_idx, stack_interface_phy_lte::dl_sched_grant_t* grants);
   int  encode_pdsch(stack_interface_phy_lte::dl_sched_grant_t* grants, uint32_t nof_grants);
   int  encode_pmch(stack_interface_phy_lte::dl_sched_grant_t* grant, srslte_mbsfn_cfg_t* mbsfn_cfg);
-  void decode_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_grant,
-                         srslte_ul_cfg_t&                           ul_cfg,
-                         srslte_pusch_res_t&                        pusch_res);
+  // Per grant PUSCH decoding state, filled in the preparation and decoding steps and consumed in the report step
+  struct pusch_job_t {
+    srslte_ul_cfg_t       ul_cfg       = {};
+    srslte_pusch_res_t    pusch_res    = {};
+    srslte_chest_ul_res_t chest_res    = {};
+    bool                  uci_required = false;
+    bool                  valid        = false;
+  };
+
+  void prepare_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_grant, pusch_job_t& job);
+  void decode_pusch_rnti(uint32_t rx_idx, pusch_job_t& job);
+  void decode_pusch_jobs(uint32_t rx_idx);
+  void report_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_grant, pusch_job_t& job);
   void decode_pusch(stack_interface_phy_lte::ul_sched_grant_t* grants, uint32_t nof_pusch);
   int  encode_phich(stack_interface_phy_lte::ul_sched_ack_t* acks, uint32_t nof_acks);
   int  encode_pdcch_dl(stack_interface_phy_lte::dl_sched_grant_t* grants, uint32_t nof_grants);
   int  encode_pdcch_ul(stack_interface_phy_lte::ul_sched_grant_t* grants, uint32_t nof_grants);
+  int  encode_pdcch();
   int  decode_pucch();
+  void decode_srs();
 
   /* Common objects */
   srslte::log* log_h     = nullptr;
   phy_common*  phy       = nullptr;
   bool         initiated = false;
 
-  cf_t*    signal_buffer_rx[SRSLTE_MAX_PORTS] = {};
+  cf_t*    signal_buffer_rx[SRSLTE_MAX_PORTS]   = {};
+  int16_t* signal_buffer_rx_s[SRSLTE_MAX_PORTS] = {}; ///< Interleaved int16 samples, only with rx_int16
   cf_t*    signal_buffer_tx[SRSLTE_MAX_PORTS] = {};
   uint32_t tti_rx = 0, tti_tx_dl = 0, tti_tx_ul = 0;
 
@@ -94,6 +121,34 @@ private:
 
   srslte_softbuffer_tx_t temp_mbsfn_softbuffer = {};
 
+  // DCI messages of the subframe, packed by encode_pdcch_dl/ul and encoded together by encode_pdcch
+  srslte_dci_msg_t pdcch_msgs[2 * stack_interface_phy_lte::MAX_GRANTS] = {};
+  uint32_t         pdcch_nof_msgs                                       = 0;
+
+  // Optional pool of PUSCH codeblock decoders
+  srslte_sch_cb_pool_t pusch_cb_pool       = {};
+  bool                 pusch_cb_pool_ready = false;
+
+  // Optional pool of threads decoding the PUSCH of different users in parallel. Each thread uses its own PUSCH
+  // receiver from enb_ul, the worker thread uses receiver 0
+  std::unique_ptr<srslte::task_thread_pool> pusch_ue_pool;
+  pusch_job_t                               pusch_jobs[stack_interface_phy_lte::MAX_GRANTS];
+  uint32_t                                  pusch_nof_jobs    = 0;
+  std::atomic<uint32_t>                     pusch_next_job    = {0};
+  uint32_t                                  pusch_nof_helpers = 0;
+  std::mutex                                pusch_ue_mutex;
+  std::condition_variable                   pusch_ue_cvar;
+
+  // Optional pool of threads encoding the PDSCH of different users in parallel. Each thread uses its own PDSCH
+  // transmitter from enb_dl, the worker thread uses transmitter 0
+  std::unique_ptr<srslte::task_thread_pool> pdsch_ue_pool;
+  pdsch_job_t                               pdsch_jobs[stack_interface_phy_lte::MAX_GRANTS];
+  uint32_t                                  pdsch_nof_jobs    = 0;
+  std::atomic<uint32_t>                     pdsch_next_job    = {0};
+  uint32_t                                  pdsch_nof_helpers = 0;
+  std::mutex                                pdsch_ue_mutex;
+  std::condition_variable                   pdsch_ue_cvar;
+
   // Class to store user information
   class ue
   {
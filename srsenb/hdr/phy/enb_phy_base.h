@@ -46,6 +46,8 @@ public:
   virtual void get_metrics(phy_metrics_t* m) = 0;
 
   virtual void cmd_cell_gain(uint32_t cell_idx, float gain_db) = 0;
+
+  virtual int cmd_cell_pci(uint32_t cell_id, uint32_t pci) = 0;
 };
 
 } // namespace srsenb
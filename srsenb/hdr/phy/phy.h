@@ -69,6 +69,14 @@ public:
   void get_metrics(phy_metrics_t metrics[ENB_METRICS_MAX_USERS]) override;
 
   void cmd_cell_gain(uint32_t cell_id, float gain_db) override;
+  int  cmd_cell_pci(uint32_t cell_id, uint32_t pci) override;
+
+  /**
+   * Changes the cell of a carrier without restarting the PHY. The TTIs in flight are finished first and the workers
+   * regenerate the cell dependent state of the carrier, keeping its buffers. Only the PCI can change, the bandwidth and
+   * the number of ports set the sampling rate and the RF channels
+   */
+  int reconfigure_cell(uint32_t cc_idx, const srslte_cell_t& cell);
 
   void radio_overflow() override{};
   void radio_failure() override{};
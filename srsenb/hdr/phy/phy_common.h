@@ -29,11 +29,13 @@
 #include "srslte/common/log.h"
 #include "srslte/common/thread_pool.h"
 #include "srslte/common/threads.h"
+#include "srslte/common/tti_deadline_watchdog.h"
 #include "srslte/interfaces/enb_interfaces.h"
 #include "srslte/interfaces/enb_metrics_interface.h"
 #include "srslte/interfaces/radio_interfaces.h"
 #include "srslte/phy/channel/channel.h"
 #include "srslte/radio/radio.h"
+#include <array>
 #include <map>
 #include <srslte/common/tti_sempahore.h>
 #include <string.h>
@@ -44,6 +46,7 @@ class phy_common
 {
 public:
   phy_common() = default;
+  ~phy_common();
 
   bool
        init(const phy_cell_cfg_list_t& cell_list_, srslte::radio_interface_phy* radio_handler, stack_interface_phy_lte* mac);
@@ -64,6 +67,18 @@ public:
    */
   void worker_end(void* tx_sem_id, srslte::rf_buffer_t& buffer, srslte::rf_timestamp_t& tx_time);
 
+  /**
+   * Processing time of the PHY workers, used for sizing the worker pool
+   *
+   * @param time_us time a worker took to process a TTI, not including the wait for the transmission of previous TTIs
+   */
+  void report_worker_time(uint32_t time_us);
+
+  /**
+   * Gets the statistics of the processing times reported since the last call and resets them
+   */
+  void get_worker_time(uint32_t& mean_us, uint32_t& max_us, uint32_t& count);
+
   // Common objects
   phy_args_t params = {};
 
@@ -118,6 +133,15 @@ public:
 
     return ret;
   };
+  /// Returns the carrier index of the cell with the rr.conf cell identifier, or the number of carriers if not found
+  uint32_t get_cc_idx(uint32_t cell_id)
+  {
+    uint32_t cc_idx = 0;
+    while (cc_idx < cell_list.size() and cell_list[cc_idx].cell_id != cell_id) {
+      cc_idx++;
+    }
+    return cc_idx;
+  };
   uint32_t get_rf_port(uint32_t cc_idx)
   {
     uint32_t ret = 0;
@@ -151,6 +175,12 @@ public:
     it->gain_db = gain_db;
   }
 
+  /**
+   * Changes the cell of a carrier and regenerates its PUSCH DMRS base sequences. It must be called with the workers
+   * drained, the carrier keeps its bandwidth and number of ports
+   */
+  bool set_cell(uint32_t cc_idx, const srslte_cell_t& cell);
+
   float get_cell_gain(uint32_t cc_idx)
   {
     if (cc_idx < cell_list.size()) {
@@ -159,12 +189,20 @@ public:
     return 0.0f;
   }
 
-  // Common Physical Uplink DMRS configuration
+  // Common Physical Uplink DMRS configuration, set before init()
   srslte_refsignal_dmrs_pusch_cfg_t dmrs_pusch_cfg = {};
 
-  srslte::radio_interface_phy* radio      = nullptr;
-  stack_interface_phy_lte*     stack      = nullptr;
-  srslte::channel_ptr          dl_channel = nullptr;
+  // PUSCH DMRS base sequences of a carrier, shared by the UL of all the workers
+  const srslte_refsignal_ul_dmrs_cache_t* get_dmrs_cache(uint32_t cc_idx)
+  {
+    return cc_idx < dmrs_cache.size() ? &dmrs_cache[cc_idx] : nullptr;
+  }
+
+  srslte::radio_interface_phy*   radio      = nullptr;
+  stack_interface_phy_lte*       stack      = nullptr;
+  srslte::channel_ptr            dl_channel = nullptr;
+  srslte::tti_deadline_watchdog* watchdog   = nullptr;
+  bool                           rx_int16   = false; ///< The UL is received as int16, set before the first subframe
 
   /**
    * UE Database object, direct public access, all PHY threads should be able to access this attribute directly
@@ -174,6 +212,7 @@ public:
   void configure_mbsfn(phy_interface_stack_lte::phy_cfg_mbsfn_t* cfg);
   void build_mch_table();
   void build_mcch_table();
+  void build_mbsfn_sf_table();
   bool is_mbsfn_sf(srslte_mbsfn_cfg_t* cfg, uint32_t phy_tti);
   void set_mch_period_stop(uint32_t stop);
 
@@ -189,6 +228,15 @@ private:
 
   phy_cell_cfg_list_t cell_list;
 
+  std::vector<srslte_refsignal_ul_dmrs_cache_t> dmrs_cache;
+  bool                                          generate_dmrs_cache(uint32_t cc_idx);
+
+  // Worker processing time statistics
+  std::mutex worker_time_mutex;
+  uint64_t   worker_time_sum_us = 0;
+  uint32_t   worker_time_max_us = 0;
+  uint32_t   worker_time_count  = 0;
+
   bool                                     have_mtch_stop   = false;
   pthread_mutex_t                          mtch_mutex       = {};
   pthread_cond_t                           mtch_cvar        = {};
@@ -199,7 +247,19 @@ private:
   uint8_t                                  mcch_table[10]   = {};
   uint32_t                                 mch_period_stop  = 0;
   bool                                     is_mch_subframe(srslte_mbsfn_cfg_t* cfg, uint32_t phy_tti);
-  bool                                     is_mcch_subframe(srslte_mbsfn_cfg_t* cfg, uint32_t phy_tti);
+
+  /// MBSFN type of every subframe of the frames after which all the MBSFN periods repeat, built by configure_mbsfn()
+  struct mbsfn_sf_t {
+    enum { none, mcch, mch, mch_data } type = none;
+    uint32_t sf_alloc_idx                   = 0; ///< Position in the common subframe allocation, for mch_data
+  };
+  static const uint32_t mbsfn_table_nof_frames = 256;
+  std::array<mbsfn_sf_t, mbsfn_table_nof_frames * SRSLTE_NOF_SF_X_FRAME> mbsfn_sf_table;
+  uint16_t                                                               mbsfn_area_id           = 0;
+  uint32_t                                                               non_mbsfn_region_length = 1;
+  uint32_t                                                               mcch_mcs                = 2;
+  uint32_t                                                               mch_data_mcs            = 2;
+  bool                                                                   mch_data_mcs_present    = false;
 };
 
 } // namespace srsenb
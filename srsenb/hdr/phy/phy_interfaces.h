@@ -25,6 +25,7 @@
 #include <inttypes.h>
 #include <srslte/asn1/rrc_asn1.h>
 #include <srslte/common/interfaces_common.h>
+#include <srslte/common/tti_deadline_watchdog.h>
 #include <srslte/phy/channel/channel.h>
 #include <vector>
 
@@ -51,14 +52,23 @@ struct phy_args_t {
   float       max_prach_offset_us = 10;
   int         pusch_max_its       = 10;
   bool        pusch_8bit_decoder  = false;
+  int         pusch_cb_workers    = 0;
+  int         pusch_ue_workers    = 0;
+  int         pdsch_ue_workers    = 0;
+  int         prach_workers       = 1;
   float       tx_amplitude        = 1.0f;
   int         nof_phy_threads     = 1;
+  int         min_phy_threads     = 0;
   std::string equalizer_mode      = "mmse";
   float       estimator_fil_w     = 1.0f;
   bool        pusch_meas_epre     = true;
   bool        pusch_meas_evm      = false;
   bool        pusch_meas_ta       = true;
   bool        pucch_meas_ta       = true;
+  bool        numa_workers        = false;
+  bool        rx_int16            = false;
+
+  srslte::deadline_watchdog_args_t deadline_watchdog;
 
   srslte::channel::args_t dl_channel_args;
   srslte::channel::args_t ul_channel_args;
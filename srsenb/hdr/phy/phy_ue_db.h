@@ -23,6 +23,7 @@
 #define SRSENB_PHY_UE_DB_H_
 
 #include "phy_interfaces.h"
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <srslte/adt/circular_array.h>
@@ -110,6 +111,64 @@ private:
    */
   mutable std::mutex mutex;
 
+  /**
+   * Configuration of a UE as seen by the configuration getters. It is a copy of the configuration fields of the UE
+   * database entry, so that the PHY workers can read it without taking the mutex.
+   */
+  struct ue_cfg_t {
+    struct cell_cfg_t {
+      cell_state_t      state      = cell_state_none; ///< Configuration state
+      uint32_t          enb_cc_idx = 0;               ///< Corresponding eNb cell/carrier index
+      srslte::phy_cfg_t phy_cfg;                      ///< Configuration, it has a default constructor
+    };
+    std::array<cell_cfg_t, SRSLTE_MAX_CARRIERS> cell_cfg        = {}; ///< Cell configuration, indexed by ue_cell_idx
+    srslte::phy_cfg_t                           pcell_cfg_stash = {}; ///< Stashed Cell configuration
+  };
+  typedef std::map<uint16_t, ue_cfg_t> cfg_snapshot_t;
+
+  /**
+   * Read-copy-update of the UE configurations
+   * -----------------------------------------
+   * Readers register in the reader counter of the current epoch and read the current snapshot without locking. The
+   * writers, serialized by the mutex, publish a new snapshot after every configuration change. The previous snapshot is
+   * freed once the epoch has been flipped twice and the reader counters of both epochs have drained, as any reader that
+   * loaded it is registered in one of them.
+   */
+  std::atomic<const cfg_snapshot_t*> cfg_snapshot   = {nullptr};
+  std::atomic<uint32_t>              cfg_epoch      = {0};
+  mutable std::atomic<uint32_t>      cfg_readers[2] = {};
+
+  /**
+   * Holds the current configuration snapshot while it is read
+   */
+  class cfg_reader
+  {
+  public:
+    explicit cfg_reader(const phy_ue_db& db) : readers(db.cfg_readers[db.cfg_epoch.load() & 1u])
+    {
+      readers++;
+      snapshot = db.cfg_snapshot.load();
+    }
+    ~cfg_reader() { readers--; }
+    cfg_reader(const cfg_reader&) = delete;
+    cfg_reader& operator=(const cfg_reader&) = delete;
+
+    /**
+     * @return The configuration of the given RNTI, nullptr if it does not exist
+     */
+    const ue_cfg_t* find(uint16_t rnti) const;
+
+  private:
+    std::atomic<uint32_t>& readers;
+    const cfg_snapshot_t*  snapshot = nullptr;
+  };
+
+  /**
+   * Publishes the configuration of the UE database for the configuration getters and waits until the previous one can
+   * be freed, it is not thread safe protected
+   */
+  void _publish_config();
+
   /**
    * Stack interface
    */
@@ -159,6 +218,11 @@ private:
    */
   inline uint32_t _get_ue_cc_idx(uint16_t rnti, uint32_t enb_cc_idx) const;
 
+  /**
+   * Same as the above, from a configuration snapshot
+   */
+  static inline uint32_t _get_ue_cc_idx(const ue_cfg_t& ue_cfg, uint32_t enb_cc_idx);
+
   /**
    * Gets the eNb Cell/Carrier index in which the UCI shall be carried. This corresponds to the serving cell with lowest
    * index that has an UL grant available.
@@ -233,6 +297,11 @@ private:
   inline srslte::phy_cfg_t _get_rnti_config(uint16_t rnti, uint32_t enb_cc_idx, bool stashed) const;
 
 public:
+  phy_ue_db() = default;
+  ~phy_ue_db();
+  phy_ue_db(const phy_ue_db&) = delete;
+  phy_ue_db& operator=(const phy_ue_db&) = delete;
+
   /**
    * Initialises the UE database with the stack and cell list
    * @param stack_ptr points to the stack (read/write)
@@ -27,6 +27,7 @@
 #include "srslte/common/log.h"
 #include "srslte/common/threads.h"
 #include "srslte/interfaces/enb_interfaces.h"
+#include <atomic>
 
 // Setting ENABLE_PRACH_GUI to non zero enables a GUI showing signal received in the PRACH window.
 #define ENABLE_PRACH_GUI 0
@@ -37,30 +38,30 @@
 
 namespace srsenb {
 
-class prach_worker : srslte::thread
+class prach_worker
 {
 public:
-  prach_worker(uint32_t cc_idx_) : buffer_pool(8), thread("PRACH_WORKER") { cc_idx = cc_idx_; }
+  prach_worker(uint32_t cc_idx_) : buffer_pool(8) { cc_idx = cc_idx_; }
 
   int  init(const srslte_cell_t&      cell_,
             const srslte_prach_cfg_t& prach_cfg_,
             stack_interface_phy_lte*  mac,
             srslte::log*              log_h,
-            int                       priority);
+            int                       priority,
+            uint32_t                  nof_workers = 1);
   int  new_tti(uint32_t tti, cf_t* buffer);
+  int  new_tti_s(uint32_t tti, const int16_t* buffer);
   void set_max_prach_offset_us(float delay_us);
   void stop();
 
 private:
-  uint32_t cc_idx             = 0;
-  uint32_t prach_nof_det      = 0;
-  uint32_t prach_indices[165] = {};
-  float    prach_offsets[165] = {};
-  float    prach_p2avg[165]   = {};
+  /// Saves the subframe if it is a PRACH TTI, either from float samples or from int16 samples with full scale INT16_MAX
+  int save_sf(uint32_t tti_rx, const cf_t* buffer_rx, const int16_t* buffer_rx_s);
+
+  uint32_t cc_idx = 0;
 
   srslte_cell_t      cell      = {};
   srslte_prach_cfg_t prach_cfg = {};
-  srslte_prach_t     prach     = {};
 
 #if defined(ENABLE_GUI) and ENABLE_PRACH_GUI
   plot_real_t                              plot_real;
@@ -87,17 +88,34 @@ private:
   srslte::buffer_pool<sf_buffer>  buffer_pool;
   srslte::block_queue<sf_buffer*> pending_buffers;
 
+  /// Detection thread. Every detector has its own PRACH object, so that consecutive occasions are processed in parallel
+  class detector : public srslte::thread
+  {
+  public:
+    detector(prach_worker* parent_, uint32_t idx) : thread("PRACH_WORKER" + std::to_string(idx)), parent(parent_) {}
+
+    srslte_prach_t prach              = {};
+    uint32_t       prach_nof_det      = 0;
+    uint32_t       prach_indices[165] = {};
+    float          prach_offsets[165] = {};
+    float          prach_p2avg[165]   = {};
+
+  private:
+    void          run_thread() final;
+    prach_worker* parent = nullptr;
+  };
+  std::vector<std::unique_ptr<detector> > detectors;
+
   sf_buffer*               current_buffer      = nullptr;
   srslte::log*             log_h               = nullptr;
   stack_interface_phy_lte* stack               = nullptr;
   float                    max_prach_offset_us = 0.0f;
   bool                     initiated           = false;
-  bool                     running             = false;
+  std::atomic<bool>        running             = {false};
   uint32_t                 nof_sf              = 0;
   uint32_t                 sf_cnt              = 0;
 
-  void run_thread() final;
-  int  run_tti(sf_buffer* b);
+  int run_tti(detector& d, sf_buffer* b);
 };
 
 class prach_worker_pool
@@ -114,14 +132,15 @@ public:
             const srslte_prach_cfg_t& prach_cfg_,
             stack_interface_phy_lte*  mac,
             srslte::log*              log_h,
-            int                       priority)
+            int                       priority,
+            uint32_t                  nof_workers = 1)
   {
     // Create PRACH worker if required
     while (cc_idx >= prach_vec.size()) {
       prach_vec.push_back(std::unique_ptr<prach_worker>(new prach_worker(prach_vec.size())));
     }
 
-    prach_vec[cc_idx]->init(cell_, prach_cfg_, mac, log_h, priority);
+    prach_vec[cc_idx]->init(cell_, prach_cfg_, mac, log_h, priority, nof_workers);
   }
 
   void set_max_prach_offset_us(float delay_us)
@@ -146,6 +165,15 @@ public:
     }
     return ret;
   }
+
+  int new_tti_s(uint32_t cc_idx, uint32_t tti, const int16_t* buffer)
+  {
+    int ret = SRSLTE_ERROR;
+    if (cc_idx < prach_vec.size()) {
+      ret = prach_vec[cc_idx]->new_tti_s(tti, buffer);
+    }
+    return ret;
+  }
 };
 } // namespace srsenb
 #endif // SRSENB_PRACH_WORKER_H
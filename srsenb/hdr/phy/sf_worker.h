@@ -27,6 +27,8 @@
 
 #include "cc_worker.h"
 #include "phy_common.h"
+#include "srslte/common/time_prof.h"
+#include "srslte/common/tti_trace.h"
 #include "srslte/srslte.h"
 
 namespace srsenb {
@@ -37,9 +39,11 @@ public:
   sf_worker() = default;
   ~sf_worker();
   void init(phy_common* phy, srslte::log* log_h);
+  int  set_cell(uint32_t cc_idx, const srslte_cell_t& cell);
 
-  cf_t* get_buffer_rx(uint32_t cc_idx, uint32_t antenna_idx);
-  void  set_time(uint32_t tti_, uint32_t tx_worker_cnt_, const srslte::rf_timestamp_t& tx_time_);
+  cf_t*    get_buffer_rx(uint32_t cc_idx, uint32_t antenna_idx);
+  int16_t* get_buffer_rx_s(uint32_t cc_idx, uint32_t antenna_idx);
+  void     set_time(uint32_t tti_, uint32_t tx_worker_cnt_, const srslte::rf_timestamp_t& tx_time_);
 
   int      add_rnti(uint16_t rnti, uint32_t cc_idx);
   void     rem_rnti(uint16_t rnti);
@@ -59,6 +63,7 @@ public:
 
 private:
   void work_imp() final;
+  void end_tti(srslte::rf_buffer_t& tx_buffer, srslte::tti_span& worker_span);
 
   /* Common objects */
   srslte::log* log_h     = nullptr;
@@ -71,6 +76,7 @@ private:
   uint32_t               t_rx = 0, t_tx_dl = 0, t_tx_ul = 0;
   uint32_t               tx_worker_cnt = 0;
   srslte::rf_timestamp_t tx_time       = {};
+  srslte::tprof_measure  tti_meas;
 
   std::vector<std::unique_ptr<cc_worker> > cc_workers;
 
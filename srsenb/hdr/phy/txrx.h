@@ -30,9 +30,15 @@
 #include "srslte/config.h"
 #include "srslte/phy/channel/channel.h"
 #include "srslte/radio/radio.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
 
 namespace srsenb {
 
+class sf_worker;
+
 class txrx final : public srslte::thread
 {
 public:
@@ -46,8 +52,20 @@ public:
             uint32_t                     prio);
   void stop();
 
+  /**
+   * Runs a task in the TX/RX thread between two TTIs, once all the workers have finished their TTIs, and waits for
+   * it. The task runs directly if the thread is not running
+   */
+  void run_drained(std::function<void()> task);
+
 private:
-  void run_thread() override;
+  void       run_thread() override;
+  sf_worker* wait_worker();
+  void       update_nof_active_workers();
+  void       run_drained_tasks();
+
+  // Period at which the processing time of the workers is logged and the number of active workers updated
+  const static uint32_t WORKER_SCALING_PERIOD_TTI = 1000;
 
   stack_interface_phy_lte*     stack        = nullptr;
   srslte::radio_interface_phy* radio_h      = nullptr;
@@ -60,9 +78,22 @@ private:
   // Main system TTI counter
   uint32_t tti = 0;
 
+  srslte::tti_deadline_watchdog watchdog;
+
   uint32_t tx_worker_cnt = 0;
   uint32_t nof_workers   = 0;
   bool     running       = false;
+
+  // Workers the pool hands out TTIs to, between min_workers and nof_workers
+  uint32_t min_workers        = 0;
+  uint32_t nof_active_workers = 0;
+  uint32_t scaling_tti_count  = 0;
+
+  // Tasks waiting for the workers to be drained
+  std::mutex                         drained_mutex;
+  std::vector<std::function<void()>> drained_tasks;
+  std::atomic<bool>                  drained_pending{false};
+  bool                               drained_closed = true; ///< Tasks run directly, the thread is not running
 };
 
 } // namespace srsenb
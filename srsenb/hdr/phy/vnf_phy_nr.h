@@ -61,6 +61,12 @@ public:
     // Do nothing
   }
 
+  int cmd_cell_pci(uint32_t cell_id, uint32_t pci) override
+  {
+    // Not supported
+    return SRSLTE_ERROR;
+  }
+
 private:
   srslte::logger* logger = nullptr;
 
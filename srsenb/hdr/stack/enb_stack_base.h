@@ -22,6 +22,7 @@
 #ifndef SRSLTE_ENB_STACK_BASE_H
 #define SRSLTE_ENB_STACK_BASE_H
 
+#include "srslte/common/pcap_writer.h"
 #include "srslte/interfaces/enb_interfaces.h"
 #include "srsue/hdr/stack/upper/gw.h"
 #include <string>
@@ -67,15 +68,21 @@ typedef struct {
 } core_less_args_t;
 
 typedef struct {
-  std::string      type;
-  uint32_t         sync_queue_size; // Max allowed difference between PHY and Stack clocks (in TTI)
-  mac_args_t       mac;
-  s1ap_args_t      s1ap;
-  pcap_args_t      mac_pcap;
-  pcap_args_t      s1ap_pcap;
-  stack_log_args_t log;
-  embms_args_t     embms;
-  core_less_args_t coreless;
+  std::string             type;
+  uint32_t                sync_queue_size;        // Max allowed difference between PHY and Stack clocks (in TTI)
+  bool                    io_uring;               // Read the S1AP, GTP-U and M1-U sockets through io_uring
+  bool                    up_thread;              // Run PDCP and GTP-U in their own threads
+  uint32_t                nof_up_workers;         // Number of user-plane threads the RNTIs are sharded among
+  uint32_t                nof_background_threads; // Threads of the stack task scheduler for offloaded work
+  bool                    pdcp_crypto_offload;    // Cipher the DRB PDUs in the background threads
+  mac_args_t              mac;
+  s1ap_args_t             s1ap;
+  pcap_args_t             mac_pcap;
+  pcap_args_t             s1ap_pcap;
+  srslte::pcap_rotation_t pcap_rotation; // Applies to the MAC and S1AP captures
+  stack_log_args_t        log;
+  embms_args_t            embms;
+  core_less_args_t        coreless;
 } stack_args_t;
 
 struct stack_metrics_t;
@@ -91,6 +98,9 @@ public:
 
   // eNB metrics interface
   virtual bool get_metrics(stack_metrics_t* metrics) = 0;
+
+  // eNB command interface
+  virtual void cmd_cell_pci(uint32_t cell_id, uint32_t pci) = 0;
 };
 
 } // namespace srsenb
@@ -34,6 +34,7 @@
 #include "upper/pdcp.h"
 #include "upper/rlc.h"
 #include "upper/s1ap.h"
+#include "upper/up_proxy.h"
 
 #include "enb_stack_base.h"
 #include "srsenb/hdr/enb.h"
@@ -49,7 +50,9 @@ class enb_stack_lte final : public enb_stack_base,
                             public srslte::thread
 {
 public:
-  enb_stack_lte(srslte::logger* logger_);
+  /// The background threads decode the large UL-DCCH messages of the RRC. Without stack_up_thread they also cipher the
+  /// PDCP PDUs. With none, that work runs in the stack thread
+  explicit enb_stack_lte(srslte::logger* logger_, uint32_t nof_background_threads = 1);
   ~enb_stack_lte() final;
 
   // eNB stack base interface
@@ -58,6 +61,7 @@ public:
   void        stop() final;
   std::string get_type() final;
   bool        get_metrics(stack_metrics_t* metrics) final;
+  void        cmd_cell_pci(uint32_t cell_id, uint32_t pci) final;
 
   /* PHY-MAC interface */
   int  sr_detected(uint32_t tti, uint16_t rnti) final { return mac.sr_detected(tti, rnti); }
@@ -77,10 +81,18 @@ public:
   {
     return mac.cqi_info(tti, rnti, cc_idx, cqi_value);
   }
+  int sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t cc_idx, uint32_t sb_idx, uint32_t cqi_value) final
+  {
+    return mac.sb_cqi_info(tti, rnti, cc_idx, sb_idx, cqi_value);
+  }
   int snr_info(uint32_t tti, uint16_t rnti, uint32_t cc_idx, float snr_db) final
   {
     return mac.snr_info(tti, rnti, cc_idx, snr_db);
   }
+  int ul_sb_snr_info(uint32_t tti, uint16_t rnti, uint32_t cc_idx, const float* snr_db, uint32_t nof_sb) final
+  {
+    return mac.ul_sb_snr_info(tti, rnti, cc_idx, snr_db, nof_sb);
+  }
   int ta_info(uint32_t tti, uint16_t rnti, float ta_us) override { return mac.ta_info(tti, rnti, ta_us); }
   int ack_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t tb_idx, bool ack) final
   {
@@ -110,10 +122,37 @@ public:
 
 private:
   static const int STACK_MAIN_THREAD_PRIO = 4;
+  static const int STACK_UP_THREAD_PRIO   = 4;
+
+  /// User-plane thread, the only one that accesses the PDCP entities of the RNTIs of its shard. The first one also
+  /// runs GTP-U
+  class up_worker final : public srslte::thread
+  {
+  public:
+    up_worker(enb_stack_lte* stack_, uint32_t idx_) :
+      thread("UPLANE" + std::to_string(idx_)),
+      stack(stack_),
+      idx(idx_)
+    {}
+
+    srslte::task_scheduler        task_sched{512, 0, 128};
+    srslte::task_queue_handle     queue, sync_queue;
+    std::unique_ptr<srsenb::pdcp> pdcp;
+    std::atomic<bool>             running{false};
+
+  private:
+    void           run_thread() override { stack->run_up_thread(idx); }
+    enb_stack_lte* stack;
+    uint32_t       idx;
+  };
+
   // thread loop
   void run_thread() override;
-  void stop_impl();
-  void tti_clock_impl();
+  void        run_up_thread(uint32_t idx);
+  void        stop_up_impl(uint32_t idx);
+  void        stop_impl();
+  void        tti_clock_impl();
+  std::string get_queue_depths();
   void handle_mme_rx_packet(srslte::unique_byte_buffer_t pdu,
                             const sockaddr_in&           from,
                             const sctp_sndrcvinfo&       sri,
@@ -127,17 +166,25 @@ private:
   srslte::task_scheduler    task_sched;
   srslte::task_queue_handle enb_task_queue, gtpu_task_queue, mme_task_queue, sync_task_queue;
 
+  // user-plane threads, created in init() if args.up_thread is set. The RNTIs are sharded among them and the other
+  // layers reach PDCP and GTP-U through the proxies
+  std::vector<std::unique_ptr<up_worker>> up_workers;
+  srslte::task_queue_handle               gtpu_ul_task_queue;
+  std::unique_ptr<pdcp_up_proxy>          pdcp_proxy, gtpu_side_pdcp;
+  std::unique_ptr<gtpu_up_proxy>          gtpu_proxy;
+  std::unique_ptr<gtpu_pdcp_proxy>        gtpu_ul_proxy;
+
   // components that layers depend on (need to be destroyed after layers)
   std::unique_ptr<srslte::rx_multisocket_handler> rx_sockets;
 
-  srsenb::mac       mac;
-  srslte::mac_pcap  mac_pcap;
-  srsenb::rlc       rlc;
-  srsenb::pdcp      pdcp;
-  srsenb::rrc       rrc;
-  srsenb::gtpu      gtpu;
-  srsenb::s1ap      s1ap;
-  srslte::s1ap_pcap s1ap_pcap;
+  srsenb::mac                   mac;
+  srslte::mac_pcap              mac_pcap;
+  srsenb::rlc                   rlc;
+  std::unique_ptr<srsenb::pdcp> pdcp; ///< Created in init() when the user plane runs in the stack thread
+  srsenb::rrc                   rrc;
+  srsenb::gtpu                  gtpu;
+  srsenb::s1ap                  s1ap;
+  srslte::s1ap_pcap             s1ap_pcap;
 
   srslte::logger*           logger = nullptr;
   srslte::byte_buffer_pool* pool   = nullptr;
@@ -44,6 +44,7 @@
 // This is needed for GW
 #include "srslte/interfaces/ue_interfaces.h"
 #include "srsue/hdr/stack/upper/gw.h"
+#include <mutex>
 
 namespace srsenb {
 
@@ -64,12 +65,13 @@ public:
   void        stop() final;
   std::string get_type() final;
   bool        get_metrics(srsenb::stack_metrics_t* metrics) final;
+  void        cmd_cell_pci(uint32_t cell_id, uint32_t pci) final {}
 
   // PHY->MAC interface
   int sf_indication(const uint32_t tti);
   int rx_data_indication(rx_data_ind_t& grant);
 
-  // Temporary GW interface
+  // Temporary GW interface, the SDUs are passed to SDAP by the stack thread
   void write_sdu(uint32_t lcid, srslte::unique_byte_buffer_t sdu);
   bool is_lcid_enabled(uint32_t lcid);
   bool switch_on();
@@ -81,6 +83,7 @@ public:
 private:
   void run_thread() final;
   void run_tti_impl(uint32_t tti);
+  void write_dl_sdus();
 
   // args
   srsenb::stack_args_t    args   = {};
@@ -102,6 +105,11 @@ private:
   //  std::unique_ptr<ngap>      m_ngap;
   //  std::unique_ptr<srsenb::gtpu> m_gtpu;
 
+  // SDUs written by the GW since the stack thread last passed them to SDAP, with their LCID
+  std::mutex                                                      dl_sdu_mutex;
+  std::vector<std::pair<uint32_t, srslte::unique_byte_buffer_t> > dl_sdus, dl_sdus_burst;
+  std::vector<srslte::unique_byte_buffer_t>                       dl_bearer_sdus;
+
   // state
   bool     running     = false;
   uint32_t current_tti = 10240;
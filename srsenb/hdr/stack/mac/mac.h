@@ -24,6 +24,7 @@
 
 #include "scheduler.h"
 #include "scheduler_metric.h"
+#include "srslte/adt/rnti_map.h"
 #include "srslte/common/log.h"
 #include "srslte/common/mac_pcap.h"
 #include "srslte/common/task_scheduler.h"
@@ -61,7 +62,9 @@ public:
   int ri_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t ri_value) override;
   int pmi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t pmi_value) override;
   int cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t cqi_value) override;
+  int sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi_value) override;
   int snr_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, float snr) override;
+  int ul_sb_snr_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, const float* snr, uint32_t nof_sb) override;
   int ta_info(uint32_t tti, uint16_t rnti, float ta_us) override;
   int ack_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t tb_idx, bool ack) override;
   int crc_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t nof_bytes, bool crc_res) override;
@@ -107,6 +110,7 @@ private:
 
   bool     check_ue_exists(uint16_t rnti);
   uint16_t allocate_rnti();
+  void     flush_dl_buffer_states();
 
   std::mutex rnti_mutex;
 
@@ -135,8 +139,12 @@ private:
 
   sched_interface::dl_pdu_mch_t mch = {};
 
+  /* HARQ softbuffers shared by all the UEs, it must outlive them */
+  softbuffer_pool softbuffers;
+
   /* Map of active UEs */
-  std::map<uint16_t, std::unique_ptr<ue> > ue_db, ues_to_rem;
+  srslte::rnti_map<std::unique_ptr<ue> >   ue_db;
+  std::map<uint16_t, std::unique_ptr<ue> > ues_to_rem;
   uint16_t                                 last_rnti = 70;
 
   srslte::block_queue<std::unique_ptr<ue> > ue_pool; ///< Pool of pre-allocated UE objects
@@ -158,6 +166,7 @@ private:
   typedef struct {
     uint8_t                pcch_payload_buffer[pcch_payload_buffer_len] = {};
     srslte_softbuffer_tx_t bcch_softbuffer_tx[NOF_BCCH_DLSCH_MSG]       = {};
+    uint8_t*               bcch_payload[NOF_BCCH_DLSCH_MSG]             = {}; ///< SIBs packed by RRC, set in cell_cfg()
     srslte_softbuffer_tx_t pcch_softbuffer_tx                           = {};
     srslte_softbuffer_tx_t rar_softbuffer_tx                            = {};
   } common_buffers_t;
@@ -176,6 +185,28 @@ private:
 
   // pointer to MAC PCAP object
   srslte::mac_pcap* pcap = nullptr;
+
+  // Last scheduler decisions, added to the snapshots of the PHY deadline misses
+  struct sched_decision_t {
+    static const uint32_t max_grants       = 4;
+    uint32_t              tti              = 0;
+    uint32_t              enb_cc_idx       = 0;
+    bool                  dl               = false;
+    uint32_t              cfi              = 0;
+    uint32_t              nof_grants       = 0;
+    uint32_t              nof_rar          = 0;
+    uint32_t              nof_bc           = 0;
+    uint32_t              nof_phich        = 0;
+    uint16_t              rnti[max_grants] = {};
+    uint32_t              tbs[max_grants]  = {};
+  };
+  void        save_sched_decision(uint32_t tti, uint32_t enb_cc_idx, const sched_interface::dl_sched_res_t& res);
+  void        save_sched_decision(uint32_t tti, uint32_t enb_cc_idx, const sched_interface::ul_sched_res_t& res);
+  std::string sched_decisions_to_string();
+
+  std::mutex                       sched_decisions_mutex;
+  std::array<sched_decision_t, 64> sched_decisions;
+  uint32_t                         nof_sched_decisions = 0;
 };
 
 } // namespace srsenb
@@ -22,12 +22,15 @@
 #ifndef SRSENB_MAC_METRICS_H
 #define SRSENB_MAC_METRICS_H
 
+#include "srslte/common/latency_histogram.h"
+
 namespace srsenb {
 
 // MAC metrics per user
 
 struct mac_metrics_t {
   uint16_t rnti;
+  uint32_t cc_idx;
   uint32_t nof_tti;
   int      tx_pkts;
   int      tx_errors;
@@ -41,6 +44,9 @@ struct mac_metrics_t {
   float    dl_ri;
   float    dl_pmi;
   float    phr;
+
+  /// From the build of the MAC PDUs until their HARQ ACK, retransmissions included
+  srslte::latency_stats_t harq_ack_delay;
 };
 
 } // namespace srsenb
@@ -114,8 +114,6 @@ private:
   srslte::block_queue<srslte::unique_byte_buffer_t>
       ue_rx_pdu_queue; ///< currently only DCH PDUs supported (add BCH, PCH, etc)
 
-  srslte::unique_byte_buffer_t ue_rlc_buffer;
-
   srslte::mac_nr_sch_pdu ue_rx_pdu;
 };
 
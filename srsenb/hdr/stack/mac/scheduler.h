@@ -24,10 +24,14 @@
 
 #include "scheduler_grid.h"
 #include "scheduler_harq.h"
+#include "scheduler_trace.h"
 #include "scheduler_ue.h"
+#include "srslte/adt/mpsc_queue.h"
 #include "srslte/common/log.h"
+#include "srslte/common/thread_pool.h"
 #include "srslte/interfaces/enb_interfaces.h"
 #include "srslte/interfaces/sched_interface.h"
+#include <condition_variable>
 #include <map>
 #include <mutex>
 #include <pthread.h>
@@ -55,6 +59,9 @@ inline bool is_in_tti_interval(uint32_t tti, uint32_t tti1, uint32_t tti2)
  *
  * The subclass sched_ue is thread-safe so that access to shared variables like buffer states
  * from scheduler thread and other threads is protected for each individual user.
+ *
+ * The CQI, RI, PMI, SR and UL CRC reports are pushed to a lock-free queue and only applied at the start of the
+ * next dl_sched/ul_sched or UE (re)configuration, so that the PHY workers do not contend for the scheduler lock.
  */
 
 class sched : public sched_interface
@@ -71,8 +78,8 @@ public:
   public:
     virtual ~metric_dl() = default;
     /* Virtual methods for user metric calculation */
-    virtual void set_params(const sched_cell_params_t& cell_params_)                          = 0;
-    virtual void sched_users(std::map<uint16_t, sched_ue>& ue_db, dl_sf_sched_itf* tti_sched) = 0;
+    virtual void set_params(const sched_cell_params_t& cell_params_)           = 0;
+    virtual void sched_users(sched_ue_list& ue_db, dl_sf_sched_itf* tti_sched) = 0;
   };
 
   class metric_ul
@@ -80,8 +87,8 @@ public:
   public:
     virtual ~metric_ul() = default;
     /* Virtual methods for user metric calculation */
-    virtual void set_params(const sched_cell_params_t& cell_params_)                          = 0;
-    virtual void sched_users(std::map<uint16_t, sched_ue>& ue_db, ul_sf_sched_itf* tti_sched) = 0;
+    virtual void set_params(const sched_cell_params_t& cell_params_)           = 0;
+    virtual void sched_users(sched_ue_list& ue_db, ul_sf_sched_itf* tti_sched) = 0;
   };
 
   /*************************************************************
@@ -96,6 +103,7 @@ public:
   void init(rrc_interface_mac* rrc);
   int  cell_cfg(const std::vector<cell_cfg_t>& cell_cfg) override;
   void set_sched_cfg(sched_args_t* sched_cfg);
+  bool start_trace(const std::string& filename);
   int  reset() final;
 
   int  ue_cfg(uint16_t rnti, const ue_cfg_t& ue_cfg) final;
@@ -118,11 +126,13 @@ public:
   int dl_ri_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t ri_value) final;
   int dl_pmi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t pmi_value) final;
   int dl_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t cqi_value) final;
+  int dl_sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi_value) final;
   int ul_crc_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, bool crc) final;
   int ul_sr_info(uint32_t tti, uint16_t rnti) override;
   int ul_bsr(uint16_t rnti, uint32_t lcg_id, uint32_t bsr) final;
   int ul_phr(uint16_t rnti, int phr) final;
   int ul_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t cqi, uint32_t ul_ch_code) final;
+  int ul_sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi_value) final;
 
   int dl_sched(uint32_t tti, uint32_t enb_cc_idx, dl_sched_res_t& sched_result) final;
   int ul_sched(uint32_t tti, uint32_t enb_cc_idx, ul_sched_res_t& sched_result) final;
@@ -139,18 +149,33 @@ public:
 
 protected:
   void new_tti(srslte::tti_point tti_rx);
+  void new_tti_parallel(srslte::tti_point tti_rx);
+  void start_cc_workers();
   bool is_generated(srslte::tti_point, uint32_t enb_cc_idx) const;
   // Helper methods
   template <typename Func>
   int ue_db_access(uint16_t rnti, Func, const char* func_name = nullptr);
 
+  /// UE feedback reported by the PHY workers
+  struct ue_feedback_t {
+    enum type_t { dl_cqi, dl_sb_cqi, dl_ri, dl_pmi, ul_cqi, ul_sb_cqi, ul_crc, ul_sr } type;
+    uint32_t tti;
+    uint16_t rnti;
+    uint32_t enb_cc_idx;
+    uint32_t value;
+    uint32_t arg; ///< subband index or UL channel code
+  };
+  int  push_feedback(const ue_feedback_t& fb);
+  void process_feedback();
+  void apply_feedback(const ue_feedback_t& fb);
+
   // args
   srslte::log_ref                  log_h;
   rrc_interface_mac*               rrc       = nullptr;
   sched_args_t                     sched_cfg = {};
   std::vector<sched_cell_params_t> sched_cell_params;
 
-  std::map<uint16_t, sched_ue> ue_db;
+  sched_ue_list ue_db;
 
   // independent schedulers for each carrier
   std::vector<std::unique_ptr<carrier_sched> > carrier_schedulers;
@@ -161,6 +186,19 @@ protected:
   srslte::tti_point last_tti;
   std::mutex        sched_mutex;
   bool              configured = false;
+
+  // feedback waiting to be applied by the scheduler
+  srslte::mpsc_queue<ue_feedback_t> feedback_queue{4096};
+
+  // workers allocating the carriers in parallel
+  std::unique_ptr<srslte::task_thread_pool> cc_workers;
+  std::vector<uint32_t>                     cc_pending;
+  uint32_t                                  nof_cc_running = 0;
+  std::mutex                                cc_mutex;
+  std::condition_variable                   cc_cvar;
+
+  // recording of the scheduler inputs, if enabled
+  std::unique_ptr<sched_trace> trace;
 };
 
 } // namespace srsenb
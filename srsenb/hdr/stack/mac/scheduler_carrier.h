@@ -32,10 +32,10 @@ class ra_sched;
 class sched::carrier_sched
 {
 public:
-  explicit carrier_sched(rrc_interface_mac*            rrc_,
-                         std::map<uint16_t, sched_ue>* ue_db_,
-                         uint32_t                      enb_cc_idx_,
-                         sched_result_list*            sched_results_);
+  explicit carrier_sched(rrc_interface_mac* rrc_,
+                         sched_ue_list*     ue_db_,
+                         uint32_t           enb_cc_idx_,
+                         sched_result_list* sched_results_);
   ~carrier_sched();
   void                   reset();
   void                   carrier_cfg(const sched_cell_params_t& sched_params_);
@@ -43,6 +43,14 @@ public:
   const cc_sched_result& generate_tti_result(srslte::tti_point tti_rx);
   int                    dl_rach_info(dl_sched_rar_info_t rar_info);
 
+  // steps of generate_tti_result(), for carriers scheduled in parallel
+  //! Allocate PHICH, broadcast and RA. Writes the results shared with other carriers, must run sequentially
+  void alloc_ctrl(srslte::tti_point tti_rx);
+  //! Allocate user data. Only reads the UE state shared with other carriers, may run concurrently
+  void alloc_data(srslte::tti_point tti_rx);
+  //! Generate the DCIs and results, updating the UE state. Must run sequentially in carrier order
+  const cc_sched_result& finish_tti_result(srslte::tti_point tti_rx);
+
   // getters
   const ra_sched* get_ra_sched() const { return ra_sched_ptr.get(); }
   //! Get a subframe result for a given tti
@@ -60,7 +68,7 @@ private:
   const sched_cell_params_t*    cc_cfg = nullptr;
   srslte::log_ref               log_h;
   rrc_interface_mac*            rrc   = nullptr;
-  std::map<uint16_t, sched_ue>* ue_db = nullptr;
+  sched_ue_list*                ue_db = nullptr;
   std::unique_ptr<metric_dl>    dl_metric;
   std::unique_ptr<metric_ul>    ul_metric;
   const uint32_t                enb_cc_idx;
@@ -115,7 +123,7 @@ public:
   using dl_sched_rar_t       = sched_interface::dl_sched_rar_t;
   using dl_sched_rar_grant_t = sched_interface::dl_sched_rar_grant_t;
 
-  explicit ra_sched(const sched_cell_params_t& cfg_, std::map<uint16_t, sched_ue>& ue_db_);
+  explicit ra_sched(const sched_cell_params_t& cfg_, sched_ue_list& ue_db_);
   void dl_sched(sf_sched* tti_sched);
   void ul_sched(sf_sched* sf_dl_sched, sf_sched* sf_msg3_sched);
   int  dl_rach_info(dl_sched_rar_info_t rar_info);
@@ -125,7 +133,7 @@ private:
   // args
   srslte::log_ref               log_h;
   const sched_cell_params_t*    cc_cfg = nullptr;
-  std::map<uint16_t, sched_ue>* ue_db  = nullptr;
+  sched_ue_list*                ue_db  = nullptr;
 
   std::deque<sf_sched::pending_rar_t> pending_rars;
   uint32_t                            rar_aggr_level   = 2;
@@ -25,6 +25,9 @@
 #include "srslte/adt/bounded_bitset.h"
 #include "srslte/adt/interval.h"
 #include "srslte/interfaces/sched_interface.h"
+#include <algorithm>
+#include <array>
+#include <vector>
 
 namespace srsenb {
 
@@ -55,6 +58,48 @@ struct tti_params_t {
   uint32_t tti_rx_ack_dl() const { return tti_tx_ul; }
 };
 
+//! MCS and TBS of a DCI format 1A with the N_PRB^1A of the broadcast/RAR allocations (TS 36.213 7.1.7)
+struct sched_format1a_t {
+  int      mcs     = -1; ///< -1 if no MCS fits the payload
+  int      tbs     = -1; ///< TBS in bits
+  uint32_t n_prb1a = 2;  ///< N_PRB^1A column of the TBS table, 2 or 3
+};
+
+//! Lookup tables of the MCS and TBS of a cell, for the DL or the UL, and for the 64QAM or 256QAM CQI and MCS tables
+class sched_mcs_table
+{
+public:
+  const static uint32_t max_nof_ctrl_symbols = 4;
+
+  void init(const srslte_cell_t& cell, uint32_t max_mcs, bool use_tbs_index_alt, bool is_ul);
+
+  uint32_t max_mcs() const { return max_mcs_; }
+  uint32_t default_max_Qm() const;
+  //! TBS in bytes of the given MCS and number of PRBs
+  uint32_t tbs_bytes(uint32_t mcs, uint32_t nof_prb) const { return tbs[(nof_prb - 1) * nof_mcs + mcs]; }
+  //! Lowest MCS whose TBS with nof_prb PRBs fits nof_bytes, or -1 if none does
+  int min_mcs(uint32_t nof_bytes, uint32_t nof_prb) const;
+  //! Highest MCS up to max_mcs whose code rate with nof_re RE is supported by the CQI
+  uint32_t search_mcs(uint32_t cqi, uint32_t nof_prb, uint32_t nof_re, uint32_t max_Qm) const;
+  //! Precomputed search_mcs() with the default max Qm and the approximate number of RE of nof_prb PRBs
+  uint32_t cqi_to_mcs(uint32_t cqi, uint32_t nof_prb, uint32_t nof_ctrl_symbols = 1) const
+  {
+    uint32_t row = (is_ul ? 0 : nof_ctrl_symbols - 1) * nof_cqis + std::min(cqi, nof_cqis - 1);
+    return cqi_mcs[row * cell_nof_prb + nof_prb - 1];
+  }
+
+private:
+  const static uint32_t nof_cqis = 16;
+
+  uint32_t              cell_nof_prb      = 0;
+  uint32_t              max_mcs_          = 0;
+  uint32_t              nof_mcs           = 0;
+  bool                  use_tbs_index_alt = false;
+  bool                  is_ul             = false;
+  std::vector<uint16_t> tbs;     ///< TBS in bytes indexed by [nof_prb - 1][mcs]
+  std::vector<uint8_t>  cqi_mcs; ///< MCS indexed by [nof_ctrl_symbols - 1][cqi][nof_prb - 1]
+};
+
 //! structs to bundle together all the sched arguments, and share them with all the sched sub-components
 class sched_cell_params_t
 {
@@ -69,6 +114,10 @@ public:
   // convenience getters
   uint32_t prb_to_rbg(uint32_t nof_prbs) const { return (nof_prbs + (P - 1)) / P; }
   uint32_t nof_prb() const { return cfg.cell.nof_prb; }
+  const sched_mcs_table& get_mcs_table(bool use_tbs_index_alt, bool is_ul) const
+  {
+    return mcs_tables[2 * (is_ul ? 1 : 0) + (use_tbs_index_alt ? 1 : 0)];
+  }
 
   uint32_t                                       enb_cc_idx = 0;
   sched_interface::cell_cfg_t                    cfg        = {};
@@ -77,6 +126,8 @@ public:
   std::array<sched_dci_cce_t, 3>                 common_locations = {};
   std::array<std::array<sched_dci_cce_t, 10>, 3> rar_locations    = {};
   std::array<uint32_t, 3>                        nof_cce_table    = {}; ///< map cfix -> nof cces in PDCCH
+  std::array<sched_mcs_table, 4>                 mcs_tables; ///< DL, DL 256QAM, UL and UL with the 256QAM CQI table
+  sched_format1a_t                               sib_format1a[sched_interface::MAX_SIBS]; ///< format 1A of each SIB
   uint32_t                                       P                = 0;
   uint32_t                                       nof_rbgs         = 0;
 };
@@ -145,6 +196,33 @@ void generate_cce_location(srslte_regs_t*   regs,
                            uint32_t         sf_idx = 0,
                            uint16_t         rnti   = SRSLTE_INVALID_RNTI);
 
+/**
+ * Finds a range of L contiguous empty PRBs. The smallest run of empty PRBs that fits L is used, so that the large
+ * runs are kept for other allocations. If none fits L, the largest run is used instead
+ * @param used_prbs PRBs of the UL grid that are already taken
+ * @param L Size of the requested UL allocation in PRBs
+ * @param alloc Found allocation. It is guaranteed that 0 <= alloc->L <= L
+ * @return true if the requested allocation of size L was strictly met
+ */
+bool find_ul_alloc(const prbmask_t& used_prbs, uint32_t L, prb_interval* alloc);
+
+/**
+ * Finds a range of L contiguous empty PRBs, taking the range whose PRBs belong to the best subbands. Without subband
+ * measurements, or if no range of L empty PRBs exists, it behaves as the function above
+ * @param used_prbs PRBs of the UL grid that are already taken
+ * @param sb_prbs PRBs grouped by the quality of their subband, from the best group to the worst
+ * @param L Size of the requested UL allocation in PRBs
+ * @param alloc Found allocation. It is guaranteed that 0 <= alloc->L <= L
+ * @return true if the requested allocation of size L was strictly met
+ */
+bool find_ul_alloc(const prbmask_t&                 used_prbs,
+                   const std::array<prbmask_t, 4>& sb_prbs,
+                   uint32_t                         L,
+                   prb_interval*                    alloc);
+
+//! Lowest MCS of DCI format 1A, and its TBS, that fits a payload of tbs_bytes
+sched_format1a_t get_format1a_tbs(uint32_t tbs_bytes);
+
 } // namespace sched_utils
 
 } // namespace srsenb
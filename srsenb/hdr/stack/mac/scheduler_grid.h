@@ -110,6 +110,7 @@ public:
   uint32_t    nof_cces() const { return cc_cfg->nof_cce_table[current_cfix]; }
   size_t      nof_allocs() const { return dci_record_list.size(); }
   size_t      nof_alloc_combinations() const { return get_alloc_tree().nof_leaves(); }
+  uint64_t    nof_pruned_allocs() const { return pruned_counter; }
   std::string result_to_string(bool verbose = false) const;
 
 private:
@@ -139,6 +140,7 @@ private:
 
   // PDCCH allocation algorithm
   bool        alloc_dci_record(const alloc_record_t& record, uint32_t cfix);
+  void        prune_tree_leaves(alloc_tree_t& tree, size_t leaf_start);
   static bool add_tree_node_leaves(alloc_tree_t&          tree,
                                    int                    node_idx,
                                    const alloc_record_t&  dci_record,
@@ -154,6 +156,11 @@ private:
   uint32_t                    current_cfix = 0;
   std::vector<alloc_tree_t>   alloc_trees;     ///< List of PDCCH alloc trees, where index is the cfi index
   std::vector<alloc_record_t> dci_record_list; ///< Keeps a record of all the PDCCH allocations done so far
+
+  std::vector<std::pair<uint32_t, size_t> > leaf_rank; ///< scratch buffer used to prune the alloc tree
+
+  // metrics
+  uint64_t pruned_counter = 0; ///< Number of DCI allocations whose combinations were cut to the max_pdcch_leaves cap
 };
 
 //! manages a subframe grid resources, namely CCE and DL/UL RB allocations
@@ -317,7 +324,11 @@ public:
 
 private:
   ctrl_code_t alloc_dl_ctrl(uint32_t aggr_lvl, uint32_t tbs_bytes, uint16_t rnti);
-  int         generate_format1a(prb_interval prb_range, uint32_t tbs, uint32_t rv, uint16_t rnti, srslte_dci_dl_t* dci);
+  int         generate_format1a(prb_interval            prb_range,
+                                const sched_format1a_t& format1a,
+                                uint32_t                rv,
+                                uint16_t                rnti,
+                                srslte_dci_dl_t*        dci);
   void set_bc_sched_result(const pdcch_grid_t::alloc_result_t& dci_result, sched_interface::dl_sched_res_t* dl_result);
   void set_rar_sched_result(const pdcch_grid_t::alloc_result_t& dci_result, sched_interface::dl_sched_res_t* dl_result);
   void set_dl_data_sched_result(const pdcch_grid_t::alloc_result_t& dci_result,
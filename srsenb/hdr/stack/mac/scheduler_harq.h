@@ -27,13 +27,23 @@
 #include "srslte/common/tti_point.h"
 #include "srslte/interfaces/sched_interface.h"
 #include <map>
+#include <memory>
 
 namespace srsenb {
 
+/// Bitmasks of the HARQ processes of an entity, indexed by pid. The processes keep them up to date at every change of
+/// state, so that the scheduler finds the processes to use with a couple of word operations instead of a scan
+struct harq_masks_t {
+  static const size_t max_harqs = 32;
+
+  srslte::bounded_bitset<max_harqs> active; ///< Processes with a TB in flight, the rest are empty
+  srslte::bounded_bitset<max_harqs> retx;   ///< Processes with a NACKed TB pending retransmission
+};
+
 class harq_proc
 {
 public:
-  void     init(uint32_t id);
+  void     init(uint32_t id, harq_masks_t* masks = nullptr);
   void     set_cfg(uint32_t max_retx);
   void     reset(uint32_t tb_idx);
   uint32_t get_id() const;
@@ -52,6 +62,7 @@ protected:
   bool has_pending_retx_common(uint32_t tb_idx) const;
   int  set_ack_common(uint32_t tb_idx, bool ack);
   void reset_pending_data_common();
+  void update_masks();
 
   enum ack_t { NULL_ACK, NACK, ACK };
 
@@ -65,6 +76,7 @@ protected:
   srslte::tti_point               tti;
   int                             last_mcs[SRSLTE_MAX_TB];
   int                             last_tbs[SRSLTE_MAX_TB];
+  harq_masks_t*                   masks = nullptr;
 
   srslte::log_ref log_h;
 };
@@ -163,7 +175,9 @@ private:
 
   srslte::log_ref log_h;
 
-  std::vector<dl_harq_proc> dl_harqs;
+  // Kept in the heap, the processes point to them and the entity moves with the UE carriers
+  std::unique_ptr<harq_masks_t> dl_masks;
+  std::vector<dl_harq_proc>     dl_harqs;
   std::vector<ul_harq_proc> ul_harqs;
 };
 
@@ -23,6 +23,7 @@
 #define SRSENB_SCHEDULER_METRIC_H
 
 #include "scheduler.h"
+#include <vector>
 
 namespace srsenb {
 
@@ -32,10 +33,10 @@ class dl_metric_rr : public sched::metric_dl
 
 public:
   void set_params(const sched_cell_params_t& cell_params_) final;
-  void sched_users(std::map<uint16_t, sched_ue>& ue_db, dl_sf_sched_itf* tti_sched) final;
+  void sched_users(sched_ue_list& ue_db, dl_sf_sched_itf* tti_sched) override;
 
-private:
-  bool          find_allocation(uint32_t min_nof_rbg, uint32_t max_nof_rbg, rbgmask_t* rbgmask);
+protected:
+  bool find_allocation(uint32_t min_nof_rbg, uint32_t max_nof_rbg, const cc_sched_ue& carrier, rbgmask_t* rbgmask);
   dl_harq_proc* allocate_user(sched_ue* user);
 
   const sched_cell_params_t* cc_cfg = nullptr;
@@ -47,17 +48,75 @@ class ul_metric_rr : public sched::metric_ul
 {
 public:
   void set_params(const sched_cell_params_t& cell_params_) final;
-  void sched_users(std::map<uint16_t, sched_ue>& ue_db, ul_sf_sched_itf* tti_sched) final;
+  void sched_users(sched_ue_list& ue_db, ul_sf_sched_itf* tti_sched) override;
 
-private:
-  bool          find_allocation(uint32_t L, prb_interval* alloc);
+protected:
+  bool          find_allocation(uint32_t L, const cc_sched_ue& carrier, prb_interval* alloc);
+  uint32_t      count_newtx_users(sched_ue_list& ue_db);
   ul_harq_proc* allocate_user_newtx_prbs(sched_ue* user);
   ul_harq_proc* allocate_user_retx_prbs(sched_ue* user);
+  /// TTI of the PDCCH of the UL grants for the current TTI
+  srslte::tti_point ul_pdcch_tti() const { return srslte::tti_point{current_tti} - FDD_HARQ_DELAY_UL_MS; }
 
   const sched_cell_params_t* cc_cfg = nullptr;
   srslte::log_ref            log_h;
-  ul_sf_sched_itf*           tti_alloc   = nullptr;
-  uint32_t                   current_tti = 0;
+  ul_sf_sched_itf*           tti_alloc       = nullptr;
+  uint32_t                   current_tti     = 0;
+  uint32_t                   nof_newtx_users = 0; ///< users still waiting for a new transmission in this TTI
+};
+
+/// Average rate served to every user of a carrier
+class sched_rate_avg
+{
+public:
+  struct ue_prio_t {
+    float     prio;
+    uint32_t  idx;  ///< Position of the user in the UE database
+    float     rate; ///< Achievable rate per PRB at the current CQI
+    float*    avg;  ///< Average served rate
+    sched_ue* user;
+  };
+
+  explicit sched_rate_avg(bool fair_) : fair(fair_) {}
+  void set_window(uint32_t nof_ttis) { alpha = 1.0f / std::max(nof_ttis, 1u); }
+
+  /// Builds the list of users in decreasing order of priority, ties are broken in a round-robin fashion
+  const std::vector<ue_prio_t>&
+  sort_users(sched_ue_list& ue_db, uint32_t tti, uint32_t enb_cc_idx, bool is_ul);
+
+  /// Updates the average rate of the user with the number of PRBs allocated to it in this TTI
+  void update(const ue_prio_t& ue, uint32_t nof_prb) { *ue.avg += alpha * (nof_prb * ue.rate - *ue.avg); }
+
+private:
+  bool                    fair  = true;
+  float                   alpha = 0.01f;
+  srslte::rnti_map<float> avg;
+  std::vector<ue_prio_t>  prio_list;
+};
+
+/// Proportional fair metric, or max C/I metric when fairness is disabled. Users are served in decreasing order of their
+/// achievable rate, which is divided by their average served rate for PF
+class dl_metric_pf : public dl_metric_rr
+{
+public:
+  explicit dl_metric_pf(bool fair) : rate_avg(fair) {}
+  void set_window(uint32_t nof_ttis) { rate_avg.set_window(nof_ttis); }
+  void sched_users(sched_ue_list& ue_db, dl_sf_sched_itf* tti_sched) final;
+
+private:
+  sched_rate_avg rate_avg;
+};
+
+class ul_metric_pf : public ul_metric_rr
+{
+public:
+  explicit ul_metric_pf(bool fair) : rate_avg(fair) {}
+  void set_window(uint32_t nof_ttis) { rate_avg.set_window(nof_ttis); }
+  void sched_users(sched_ue_list& ue_db, ul_sf_sched_itf* tti_sched) final;
+
+private:
+  sched_rate_avg        rate_avg;
+  std::vector<uint32_t> retx_prbs;
 };
 
 } // namespace srsenb
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#ifndef SRSENB_SCHEDULER_TRACE_H
+#define SRSENB_SCHEDULER_TRACE_H
+
+#include "srslte/interfaces/sched_interface.h"
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace srsenb {
+
+/**
+ * Trace of the scheduler inputs, so that the load of a running eNB can be replayed offline against the scheduler
+ * (see srsenb/test/mac/sched_replay.cc). Every call to the scheduler is written as one text line, in the order the
+ * calls are received, with the name of the event followed by its integer arguments. The cell and UE configurations
+ * only keep the fields that the scheduler uses.
+ */
+class sched_trace
+{
+public:
+  using args_t = std::vector<int64_t>;
+
+  ~sched_trace();
+  bool open(const std::string& filename);
+  void close();
+
+  // writers
+  void event(const char* name, std::initializer_list<int64_t> args);
+  void cell_cfg(const std::vector<sched_interface::cell_cfg_t>& cell_cfg);
+  void ue_cfg(uint16_t rnti, const sched_interface::ue_cfg_t& ue_cfg);
+
+  // readers
+  static bool read_event(FILE* f, std::string* name, args_t* args);
+  static bool decode_cell_cfg(const args_t& args, sched_interface::cell_cfg_t* cell_cfg);
+  static bool decode_ue_cfg(const args_t& args, sched_interface::ue_cfg_t* ue_cfg);
+
+private:
+  void write(const char* name, const int64_t* args, size_t nof_args);
+
+  std::mutex mutex;
+  FILE*      f = nullptr;
+};
+
+} // namespace srsenb
+
+#endif // SRSENB_SCHEDULER_TRACE_H
@@ -23,8 +23,11 @@
 #define SRSENB_SCHEDULER_UE_H
 
 #include "scheduler_common.h"
+#include "srslte/adt/rnti_map.h"
 #include "srslte/common/log.h"
+#include "srslte/mac/drx.h"
 #include "srslte/mac/pdu.h"
+#include <cmath>
 #include <map>
 #include <vector>
 
@@ -36,8 +39,28 @@ namespace srsenb {
 typedef enum { UCI_PUSCH_NONE = 0, UCI_PUSCH_CQI, UCI_PUSCH_ACK, UCI_PUSCH_ACK_CQI } uci_pusch_t;
 enum class cc_st { active, idle, activating, deactivating };
 
+//! Outer loop link adaptation. Offsets the MCS derived from the CQI based on the HARQ feedback of the first
+//! transmissions, lowering it by one step on every NACK and raising it by a fraction of a step on every ACK, so that
+//! the BLER converges to the target BLER
+class sched_olla
+{
+public:
+  void  set_target_bler(float target_bler);
+  void  new_feedback(bool ack);
+  void  reset() { offset = 0; }
+  int   mcs_offset() const { return (int)std::floor(offset); }
+  float get_offset() const { return offset; }
+
+private:
+  float step_up   = 0; ///< 0 if disabled
+  float step_down = 1;
+  float offset    = 0;
+};
+
 struct cc_sched_ue {
   const static int SCHED_MAX_HARQ_PROC = FDD_HARQ_DELAY_UL_MS + FDD_HARQ_DELAY_DL_MS;
+  /// Subband CQIs older than this are not used for the DL allocation, which falls back to the wideband CQI
+  const static uint32_t SCHED_MAX_SB_CQI_AGE_MS = 100;
 
   cc_sched_ue(const sched_interface::ue_cfg_t& cfg_,
               const sched_cell_params_t&       cell_cfg_,
@@ -56,6 +79,10 @@ struct cc_sched_ue {
   uint32_t                   get_required_prb_ul(uint32_t req_bytes);
   const sched_cell_params_t* get_cell_cfg() const { return cell_params; }
   void                       set_dl_cqi(uint32_t tti_tx_dl, uint32_t dl_cqi);
+  void                       set_dl_sb_cqi(uint32_t tti_tx_dl, uint32_t sb_idx, uint32_t sb_cqi);
+  void                       set_ul_sb_cqi(uint32_t tti, uint32_t sb_idx, uint32_t sb_cqi);
+  bool                       is_dl_sb_cqi_valid(uint32_t tti_tx_dl) const;
+  uint32_t                   get_max_mcs(bool is_ul) const;
   int   cqi_to_tbs(uint32_t nof_prb, uint32_t nof_re, bool use_tbs_index_alt, bool is_ul, uint32_t* mcs);
   cc_st cc_state() const { return cc_state_; }
 
@@ -71,6 +98,15 @@ struct cc_sched_ue {
   uint32_t ul_cqi_tti = 0;
   bool     dl_cqi_rx  = false;
 
+  /// RBGs grouped by the offset of the CQI of their subband from the wideband CQI, from the best (+2) to the worst
+  /// (-1). All the RBGs are in the group of offset 0 until the UE reports subband CQIs
+  std::array<rbgmask_t, 4> dl_sb_rbgs;
+  uint32_t                 dl_sb_cqi_tti = 0;
+
+  /// PRBs grouped in the same way by the UL CQI of their subband, measured on the SRS
+  std::array<prbmask_t, 4> ul_sb_prbs;
+  uint32_t                 ul_sb_cqi_tti = 0;
+
   // Enables or disables uplink 64QAM. Not yet functional.
   bool ul_64qam_enabled = false;
 
@@ -78,10 +114,16 @@ struct cc_sched_ue {
   uint32_t max_aggr_level = 3;
   int      fixed_mcs_ul = 0, fixed_mcs_dl = 0;
 
+  sched_olla dl_olla, ul_olla;
+
   // Allowed DCI locations per per CFI and per subframe
   std::array<std::array<sched_dci_cce_t, 10>, 3> dci_locations = {};
 
 private:
+  int  alloc_tbs_from_mcs(uint32_t nof_prb, uint32_t cqi_mcs, uint32_t req_bytes, bool is_ul, int* mcs);
+  void reset_dl_sb_rbgs();
+  void reset_ul_sb_prbs();
+
   // config
   srslte::log_ref                  log_h;
   const sched_interface::ue_cfg_t* cfg         = nullptr;
@@ -174,6 +216,8 @@ public:
   void set_dl_ri(uint32_t tti, uint32_t enb_cc_idx, uint32_t ri);
   void set_dl_pmi(uint32_t tti, uint32_t enb_cc_idx, uint32_t ri);
   void set_dl_cqi(uint32_t tti, uint32_t enb_cc_idx, uint32_t cqi);
+  void set_dl_sb_cqi(uint32_t tti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi);
+  void set_ul_sb_cqi(uint32_t tti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi);
   int  set_ack_info(uint32_t tti, uint32_t enb_cc_idx, uint32_t tb_idx, bool ack);
   void set_ul_crc(srslte::tti_point tti_rx, uint32_t enb_cc_idx, bool crc_res);
 
@@ -221,6 +265,9 @@ public:
   void set_sr();
   void unset_sr();
 
+  /// Whether the UE monitors the PDCCH in the TTI, i.e. it is in DRX Active Time or it has a pending SR
+  bool pdcch_active(srslte::tti_point tti_tx_dl) const { return sr or drx.is_active(tti_tx_dl); }
+
   int generate_dl_dci_format(uint32_t                          pid,
                              sched_interface::dl_sched_data_t* data,
                              uint32_t                          tti,
@@ -311,6 +358,9 @@ private:
 
   bool phy_config_dedicated_enabled = false;
 
+  /* DRX timers of the UE, kept in sync with the UE by the DCIs and the DL HARQ feedback */
+  srslte::drx_active_time drx;
+
   srslte::tti_point        current_tti;
   std::vector<cc_sched_ue> carriers; ///< map of UE CellIndex to carrier configuration
 
@@ -319,7 +369,7 @@ private:
   std::deque<ce_cmd> pending_ces;
 };
 
-using sched_ue_list = std::map<uint16_t, sched_ue>;
+using sched_ue_list = srslte::rnti_map<sched_ue>;
 
 } // namespace srsenb
 
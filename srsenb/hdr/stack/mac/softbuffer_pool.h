@@ -0,0 +1,81 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSENB_SOFTBUFFER_POOL_H
+#define SRSENB_SOFTBUFFER_POOL_H
+
+#include "srslte/srslte.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace srsenb {
+
+/**
+ * Pool of HARQ softbuffers shared by all the UEs of the eNB
+ *
+ * A HARQ process takes a softbuffer when it starts a transmission and gives it back when the TB is acknowledged or
+ * the UE is reset, so that the memory follows the number of active HARQ processes instead of the number of UEs.
+ * The softbuffers are grouped in size classes by the number of code blocks they hold, and a TB takes one of the
+ * smallest class that fits it. The softbuffers are allocated on demand and kept in the pool once released.
+ */
+class softbuffer_pool
+{
+public:
+  softbuffer_pool() = default;
+  softbuffer_pool(const softbuffer_pool&) = delete;
+  softbuffer_pool& operator=(const softbuffer_pool&) = delete;
+  ~softbuffer_pool();
+
+  /// The RX softbuffers hold 8-bit soft bits if rx_8bit is set, for the 8-bit PUSCH decoder
+  void init(uint32_t max_nof_prb, bool rx_8bit = false);
+
+  /// Makes *slot point to a softbuffer that fits a TB of tbs bytes, keeping the current one if it is large enough
+  srslte_softbuffer_tx_t* reserve(srslte_softbuffer_tx_t** slot, uint32_t tbs);
+  srslte_softbuffer_rx_t* reserve(srslte_softbuffer_rx_t** slot, uint32_t tbs);
+
+  /// Gives the softbuffer of *slot, if any, back to the pool
+  void release(srslte_softbuffer_tx_t** slot);
+  void release(srslte_softbuffer_rx_t** slot);
+
+  size_t nof_tx_allocated() const { return tx_buffers.size(); }
+  size_t nof_rx_allocated() const { return rx_buffers.size(); }
+
+private:
+  struct size_class_t {
+    uint32_t                             nof_prb;
+    uint32_t                             max_cb;
+    std::vector<srslte_softbuffer_tx_t*> free_tx;
+    std::vector<srslte_softbuffer_rx_t*> free_rx;
+  };
+
+  size_class_t* find_class(uint32_t max_cb);
+
+  std::mutex                                           mutex;
+  bool                                                 rx_8bit = false;
+  std::vector<size_class_t>                            classes;
+  std::vector<std::unique_ptr<srslte_softbuffer_tx_t>> tx_buffers;
+  std::vector<std::unique_ptr<srslte_softbuffer_rx_t>> rx_buffers;
+};
+
+} // namespace srsenb
+
+#endif // SRSENB_SOFTBUFFER_POOL_H
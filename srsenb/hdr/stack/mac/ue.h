@@ -23,14 +23,17 @@
 #define SRSENB_UE_H
 
 #include "mac_metrics.h"
+#include "softbuffer_pool.h"
 #include "srslte/common/block_queue.h"
 #include "srslte/common/log.h"
 #include "srslte/common/mac_pcap.h"
+#include "srslte/common/metrics_counter.h"
 #include "srslte/interfaces/enb_interfaces.h"
 #include "srslte/interfaces/sched_interface.h"
 #include "srslte/mac/pdu.h"
 #include "srslte/mac/pdu_queue.h"
 #include "ta.h"
+#include <atomic>
 #include <pthread.h>
 #include <vector>
 
@@ -46,6 +49,7 @@ public:
      rlc_interface_mac*       rlc,
      phy_interface_stack_lte* phy_,
      srslte::log_ref          log_,
+     softbuffer_pool*         softbuffers_,
      uint32_t                 nof_cells_,
      uint32_t                 nof_rx_harq_proc = SRSLTE_FDD_NOF_HARQ,
      uint32_t                 nof_tx_harq_proc = SRSLTE_FDD_NOF_HARQ * SRSLTE_MAX_TB);
@@ -74,9 +78,14 @@ public:
   uint8_t*
   generate_mch_pdu(uint32_t harq_pid, sched_interface::dl_pdu_mch_t sched, uint32_t nof_pdu_elems, uint32_t grant_size);
 
-  srslte_softbuffer_tx_t*
-                          get_tx_softbuffer(const uint32_t ue_cc_idx, const uint32_t harq_process, const uint32_t tb_idx);
-  srslte_softbuffer_rx_t* get_rx_softbuffer(const uint32_t ue_cc_idx, const uint32_t tti);
+  srslte_softbuffer_tx_t* get_tx_softbuffer(const uint32_t ue_cc_idx,
+                                            const uint32_t harq_process,
+                                            const uint32_t tb_idx,
+                                            const uint32_t tbs);
+  srslte_softbuffer_rx_t* get_rx_softbuffer(const uint32_t ue_cc_idx, const uint32_t tti, const uint32_t tbs);
+  void                    set_dl_harq_tti(uint32_t enb_cc_idx, uint32_t tti_tx, uint32_t ue_cc_idx, uint32_t pid);
+  void                    release_tx_softbuffer(uint32_t enb_cc_idx, uint32_t tti_ack, uint32_t tb_idx);
+  void                    release_rx_softbuffer(uint32_t ue_cc_idx, uint32_t tti);
 
   bool     process_pdus();
   uint8_t* request_buffer(const uint32_t ue_cc_idx, const uint32_t tti, const uint32_t len);
@@ -91,23 +100,95 @@ public:
   void metrics_dl_ri(uint32_t dl_cqi);
   void metrics_dl_pmi(uint32_t dl_cqi);
   void metrics_dl_cqi(uint32_t dl_cqi);
+  void metrics_dl_buffer(uint32_t lcid, uint32_t buffer);
+  void metrics_dl_ack(uint32_t enb_cc_idx, uint32_t tti_ack, uint32_t tb_idx);
+  void metrics_pcell(uint32_t enb_cc_idx);
   void metrics_cnt();
 
+  /// Stores the latest DL RLC buffer state of lcid, to be passed to the scheduler by flush_dl_buffer_state(). Returns
+  /// false if lcid is out of range, in which case it has to be passed directly
+  bool set_dl_buffer_state(uint32_t lcid, uint32_t tx_queue, uint32_t retx_queue);
+  /// Calls f(lcid, tx_queue, retx_queue) once for every bearer whose buffer state was set since the previous flush
+  template <typename F>
+  void flush_dl_buffer_state(F&& f)
+  {
+    uint32_t dirty = dl_buffer_dirty.exchange(0, std::memory_order_acq_rel);
+    for (uint32_t lcid = 0; dirty != 0; lcid++, dirty >>= 1u) {
+      if (dirty & 1u) {
+        uint64_t state = dl_buffer_state[lcid].load(std::memory_order_acquire);
+        f(lcid, (uint32_t)(state >> 32u), (uint32_t)state);
+      }
+    }
+  }
+
   bool is_phy_added = false;
   int  read_pdu(uint32_t lcid, uint8_t* payload, uint32_t requested_bytes) final;
 
 private:
-  uint32_t allocate_cc_buffers(const uint32_t num_cc = 1); ///< Add and initialize softbuffers for CC
-
+  uint32_t allocate_cc_buffers(const uint32_t num_cc = 1); ///< Add the softbuffer slots of num_cc carriers
+  void     release_softbuffers();
+
+  static const uint32_t max_ul_subh = 20; ///< Maximum number of subheaders of a UL-SCH PDU
+
+  /// UL-SCH PDU demultiplexed by the PHY worker that decoded it. It is written in front of the PDU bytes, so that the
+  /// stack thread only passes the SDUs to RLC and the CEs to the scheduler, in the order of the PDU
+  struct ul_demux_t {
+    struct sdu_t {
+      uint32_t lcid;
+      uint32_t offset; ///< Position of the SDU from the start of the PDU
+      uint32_t nof_bytes;
+      bool     route; ///< False for the all zero CCCH SDUs of the UL transmissions with CQI only
+    };
+    struct ce_t {
+      srslte::ul_sch_lcid type;
+      float               phr;
+      uint16_t            c_rnti;
+      uint32_t            bsr_lcg;
+      uint32_t            bsr_bytes[4];
+    };
+    uint32_t                       nof_sdus;
+    uint32_t                       nof_ces;
+    uint32_t                       lcid_most_data;
+    std::array<sdu_t, max_ul_subh> sdus;
+    std::array<ce_t, max_ul_subh>  ces;
+  };
+  static const uint32_t ul_demux_len = sizeof(ul_demux_t); ///< Bytes of the UL buffers in front of the PDU
+
+  void demux_pdu(uint8_t* buffer, uint32_t nof_bytes);
   void allocate_sdu(srslte::sch_pdu* pdu, uint32_t lcid, uint32_t sdu_len);
-  bool process_ce(srslte::sch_subh* subh);
+  bool process_ce(const ul_demux_t::ce_t& ce);
   void allocate_ce(srslte::sch_pdu* pdu, uint32_t lcid);
 
-  uint32_t      phr_counter    = 0;
-  uint32_t      dl_cqi_counter = 0;
-  uint32_t      dl_ri_counter  = 0;
-  uint32_t      dl_pmi_counter = 0;
-  mac_metrics_t metrics        = {};
+  /// Metrics updated by the PHY workers and the stack thread and read by the metrics thread without any lock. The
+  /// averages are kept as a sum and a number of samples, the buffers hold the last state reported by RLC and the BSRs
+  struct metrics_counters {
+    srslte::metrics_counter<uint32_t> nof_tti;
+    srslte::metrics_counter<int>      tx_pkts;
+    srslte::metrics_counter<int>      tx_errors;
+    srslte::metrics_counter<int>      tx_brate;
+    srslte::metrics_counter<int>      rx_pkts;
+    srslte::metrics_counter<int>      rx_errors;
+    srslte::metrics_counter<int>      rx_brate;
+    srslte::metrics_counter<uint32_t> dl_cqi_sum;
+    srslte::metrics_counter<uint32_t> dl_cqi_count;
+    srslte::metrics_counter<uint32_t> dl_ri_sum;
+    srslte::metrics_counter<uint32_t> dl_ri_count;
+    srslte::metrics_counter<uint32_t> dl_pmi_sum;
+    srslte::metrics_counter<uint32_t> dl_pmi_count;
+    srslte::metrics_counter<int>      phr_sum;
+    srslte::metrics_counter<uint32_t> phr_count;
+    srslte::metrics_counter<uint32_t> pcell;
+    srslte::latency_histogram         harq_ack_delay;
+
+    std::array<srslte::metrics_counter<uint32_t>, sched_interface::MAX_LC>       dl_buffer;
+    std::array<srslte::metrics_counter<uint32_t>, sched_interface::MAX_LC_GROUP> ul_buffer;
+  };
+  metrics_counters metrics;
+
+  /// Latest DL RLC buffer state of every bearer, as tx_queue << 32 | retx_queue, and the bitmap of the bearers set
+  /// since the last flush. Set by the stack thread at every RLC write and flushed once per TTI before the DL scheduling
+  std::array<std::atomic<uint64_t>, sched_interface::MAX_LC> dl_buffer_state = {};
+  std::atomic<uint32_t>                                       dl_buffer_dirty{0};
 
   srslte::mac_pcap* pcap             = nullptr;
   uint64_t          conres_id        = 0;
@@ -118,14 +199,24 @@ private:
   int               nof_rx_harq_proc = 0;
   int               nof_tx_harq_proc = 0;
 
-  typedef std::vector<srslte_softbuffer_tx_t>
+  // The softbuffers are taken from the pool by the active HARQ processes only, the idle ones point to NULL
+  softbuffer_pool* softbuffers = nullptr;
+
+  typedef std::vector<srslte_softbuffer_tx_t*>
                                        cc_softbuffer_tx_list_t; ///< List of Tx softbuffers for all HARQ processes of one carrier
   std::vector<cc_softbuffer_tx_list_t> softbuffer_tx;           ///< List of softbuffer lists for Tx
 
-  typedef std::vector<srslte_softbuffer_rx_t>
+  typedef std::vector<srslte_softbuffer_rx_t*>
                                        cc_softbuffer_rx_list_t; ///< List of Rx softbuffers for all HARQ processes of one carrier
   std::vector<cc_softbuffer_rx_list_t> softbuffer_rx;           ///< List of softbuffer lists for Rx
 
+  struct dl_harq_t {
+    uint32_t ue_cc_idx;
+    uint32_t pid;
+  };
+  /// DL HARQ process transmitted in every TTI of every eNB carrier, to find the softbuffer of an ACK
+  std::vector<std::array<dl_harq_t, SRSLTE_FDD_NOF_HARQ> > dl_harq_tti;
+
   typedef std::vector<uint8_t*> cc_buffer_ptr_t; ///< List of buffer pointers for RX HARQ processes of one carrier
   std::vector<cc_buffer_ptr_t>  pending_buffers; ///< List of buffer pointer list for Rx
 
@@ -136,9 +227,10 @@ private:
   srslte::block_queue<uint32_t> pending_ta_commands;
   ta                            ta_fsm;
 
-  // For UL there are multiple buffers per PID and are managed by pdu_queue
+  // For UL there are multiple buffers per PID and are managed by pdu_queue. Each buffer holds the ul_demux_t of the
+  // PDU followed by the PDU itself, the PHY writes the PDU only
   srslte::pdu_queue pdus;
-  srslte::sch_pdu   mac_msg_dl, mac_msg_ul;
+  srslte::sch_pdu   mac_msg_dl;
   srslte::mch_pdu   mch_mac_msg_dl;
 
   rlc_interface_mac*       rlc = nullptr;
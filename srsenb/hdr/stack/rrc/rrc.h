@@ -25,6 +25,8 @@
 #include "rrc_bearer_cfg.h"
 #include "rrc_cell_cfg.h"
 #include "rrc_metrics.h"
+#include "rrc_paging.h"
+#include "rrc_recfg_cache.h"
 #include "srsenb/hdr/stack/upper/common_enb.h"
 #include "srslte/common/block_queue.h"
 #include "srslte/common/buffer_pool.h"
@@ -66,6 +68,9 @@ public:
 
   void stop();
   void get_metrics(rrc_metrics_t& m);
+
+  /// Changes the PCI of a cell after the PHY has been reconfigured, used for reestablishment and handover
+  void set_cell_pci(uint32_t cell_id, uint32_t pci);
   void tti_clock();
 
   // rrc_interface_mac
@@ -145,9 +150,10 @@ private:
   std::unique_ptr<cell_info_common_list> cell_common_list;
 
   // state
-  std::unique_ptr<freq_res_common_list>          pucch_res_list;
-  std::map<uint16_t, std::unique_ptr<ue> >       users; // NOTE: has to have fixed addr
-  std::map<uint32_t, asn1::rrc::paging_record_s> pending_paging;
+  std::unique_ptr<freq_res_common_list>    pucch_res_list;
+  std::map<uint16_t, std::unique_ptr<ue> > users; // NOTE: has to have fixed addr
+  std::unique_ptr<paging_manager>          pager;
+  recfg_template_cache                     recfg_cache;
 
   void     process_release_complete(uint16_t rnti);
   void     rem_user(uint16_t rnti);
@@ -183,8 +189,6 @@ private:
   asn1::rrc::sib_type7_s sib7;
 
   void rem_user_thread(uint16_t rnti);
-
-  std::mutex paging_mutex;
 };
 
 } // namespace srsenb
@@ -43,10 +43,20 @@ public:
   uint8_t                             get_ncc() const { return ncc; }
   bool                                is_as_sec_cfg_valid() const { return k_enb_present; }
 
+  /// Derives the keys of the target cell of a handover, so that regenerate_keys_handover() only has to apply them
+  void prepare_keys_handover(uint32_t new_pci, uint32_t new_dl_earfcn);
   void regenerate_keys_handover(uint32_t new_pci, uint32_t new_dl_earfcn);
 
 private:
-  void generate_as_keys();
+  struct ho_keys_t {
+    bool                         present   = false;
+    uint32_t                     pci       = 0;
+    uint32_t                     dl_earfcn = 0;
+    uint8_t                      k_enb[32] = {}; // K_eNB*
+    srslte::as_security_config_t sec_cfg   = {};
+  };
+
+  void generate_as_keys(uint8_t* key, srslte::as_security_config_t& as_cfg);
 
   srslte::log_ref               log_h{"RRC"};
   const rrc_cfg_t*              cfg                   = nullptr;
@@ -55,6 +65,7 @@ private:
   uint8_t                       k_enb[32]             = {}; // Provided by MME
   srslte::as_security_config_t  sec_cfg               = {};
   uint8_t                       ncc                   = 0;
+  ho_keys_t                     ho_keys;
 };
 
 class bearer_cfg_handler
@@ -34,11 +34,15 @@ public:
     uint32_t nof_users[100][80];
   };
 
-  const static uint32_t             N_PUCCH_MAX_PRB = 4; // Maximum number of PRB to use for PUCCH ACK/NACK in CS mode
-  const static uint32_t             N_PUCCH_MAX_RES = 3 * SRSLTE_NRE * N_PUCCH_MAX_PRB;
-  pucch_idx_sched_t                 sr_sched        = {};
-  pucch_idx_sched_t                 cqi_sched       = {};
-  std::array<bool, N_PUCCH_MAX_RES> n_pucch_cs_used = {};
+  // Maximum number of PRB to use for PUCCH ACK/NACK in CS mode
+  const static uint32_t                  N_PUCCH_MAX_PRB  = 4;
+  const static uint32_t                  N_PUCCH_MAX_RES  = 3 * SRSLTE_NRE * N_PUCCH_MAX_PRB;
+  const static uint32_t                  N_SRS_MAX_OFFSET = 320; // Largest SRS periodicity in FDD
+  const static uint32_t                  N_SRS_SLOTS      = 16;  // 2 transmission combs x 8 cyclic shifts per offset
+  pucch_idx_sched_t                      sr_sched         = {};
+  pucch_idx_sched_t                      cqi_sched        = {};
+  std::array<bool, N_PUCCH_MAX_RES>      n_pucch_cs_used  = {};
+  std::array<uint16_t, N_SRS_MAX_OFFSET> srs_used         = {}; // Bitmask of the SRS slots in use per offset
 };
 
 /** Storage of CQI/SR/PUCCH CS resources across multiple frequencies and for multiple users */
@@ -147,7 +151,16 @@ public:
     uint32_t sr_I             = 0;
   };
 
-  const sr_res_t* get_sr_res() const { return sr_res_present ? &sr_res : nullptr; }
+  struct srs_res_t {
+    uint32_t offset       = 0; ///< SRS subframe offset within the period
+    uint32_t slot         = 0; ///< Comb/cyclic shift slot within the offset
+    uint32_t I_srs        = 0;
+    uint32_t tx_comb      = 0;
+    uint32_t cyclic_shift = 0;
+  };
+
+  const sr_res_t*  get_sr_res() const { return sr_res_present ? &sr_res : nullptr; }
+  const srs_res_t* get_srs_res() const { return srs_res_present ? &srs_res : nullptr; }
   const uint16_t* get_n_pucch_cs() const { return n_pucch_cs_present ? &n_pucch_cs_idx : nullptr; }
   bool            is_pucch_cs_allocated() const { return n_pucch_cs_present; }
 
@@ -157,6 +170,8 @@ private:
   bool dealloc_cqi_resources(uint32_t ue_cc_idx);
   bool alloc_sr_resources(uint32_t period);
   bool dealloc_sr_resources();
+  bool alloc_srs_resources(uint32_t period);
+  bool dealloc_srs_resources();
   bool alloc_pucch_cs_resources();
   bool dealloc_pucch_cs_resources();
 
@@ -169,7 +184,9 @@ private:
   std::vector<cell_ctxt_dedicated> cell_ded_list;
   bool                             sr_res_present     = false;
   bool                             n_pucch_cs_present = false;
+  bool                             srs_res_present    = false;
   sr_res_t                         sr_res             = {};
+  srs_res_t                        srs_res            = {};
   uint16_t                         n_pucch_cs_idx     = 0;
 };
 
@@ -26,6 +26,7 @@
 #include "srslte/asn1/rrc_asn1.h"
 #include "srslte/common/security.h"
 #include "srslte/interfaces/enb_rrc_interface_types.h"
+#include "srslte/interfaces/rlc_interface_types.h"
 #include <array>
 
 namespace srsenb {
@@ -38,11 +39,22 @@ struct rrc_cfg_sr_t {
   uint32_t                                                   nof_subframes;
 };
 
+// PCell sounding reference signals. The cell-wide part goes in SIB2, each UE gets its own I_SRS/comb/cyclic shift
+struct rrc_cfg_srs_t {
+  bool     enabled   = false;
+  uint32_t bw_cfg    = 0;     ///< Cell SRS bandwidth configuration C_SRS (0-7)
+  uint32_t sf_cfg    = 0;     ///< Cell SRS subframe configuration (0-14)
+  bool     simul_ack = false; ///< ackNackSRS-SimultaneousTransmission
+  uint32_t period    = 40;    ///< UE SRS periodicity in ms (2, 5, 10, 20, 40, 80, 160 or 320)
+  uint32_t bw        = 0;     ///< UE SRS bandwidth B_SRS (0-3), frequency hopping is used when B_SRS > 0
+};
+
 typedef struct {
   bool                                          configured;
   asn1::rrc::lc_ch_cfg_s::ul_specific_params_s_ lc_cfg;
   asn1::rrc::pdcp_cfg_s                         pdcp_cfg;
   asn1::rrc::rlc_cfg_c                          rlc_cfg;
+  srslte::rlc_aqm_config_t                      aqm; // eNB-side only, not signalled to the UE
 } rrc_cfg_qci_t;
 
 #define MAX_NOF_QCI 10
@@ -59,6 +71,7 @@ struct rrc_cfg_t {
   asn1::rrc::pdsch_cfg_ded_s::p_a_e_  pdsch_cfg;
   rrc_cfg_sr_t                        sr_cfg;
   rrc_cfg_cqi_t                       cqi_cfg;
+  rrc_cfg_srs_t                       srs_cfg;
   rrc_cfg_qci_t                       qci_cfg[MAX_NOF_QCI];
   bool                                enable_mbsfn;
   uint16_t                            mbms_mcs;
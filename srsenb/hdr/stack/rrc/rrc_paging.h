@@ -0,0 +1,81 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSENB_RRC_PAGING_H
+#define SRSENB_RRC_PAGING_H
+
+#include "srslte/asn1/rrc_asn1.h"
+#include "srslte/common/common.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace srsenb {
+
+/**
+ * Paging records of the UEs, stored by paging occasion (TS 36.304 Section 7). The paging occasion of a UE is computed
+ * when its record is added, and the PCCH message of the occasion is packed again. The check done every TTI reads the
+ * size of the packed message of the occasion without locking.
+ */
+class paging_manager
+{
+public:
+  /// T is the default paging cycle in radio frames and Nb = nB * T
+  paging_manager(uint32_t T_, uint32_t Nb);
+
+  /// Adds the paging record of the UE. Returns false if the UE has a pending record or if it can't be paged
+  bool add_paging_record(uint32_t ueid, const asn1::rrc::paging_record_s& record);
+
+  /// Size of the PCCH message of the paging occasion of the TTI, 0 if it is not a paging occasion with records
+  uint32_t pending_pcch_bytes(uint32_t tti) const;
+
+  /// Moves the PCCH message of the paging occasion of the TTI to the buffer. Its records are removed, except the ones
+  /// that didn't fit in the message. Returns the number of records sent
+  uint32_t pop_pcch(uint32_t tti, srslte::byte_buffer_t* pdu, asn1::rrc::pcch_msg_s* msg);
+
+  /// Number of pending records
+  uint32_t nof_records() const { return nof_pending; }
+
+private:
+  struct paging_occasion_t {
+    std::mutex                              mutex;
+    std::atomic<uint32_t>                   nof_bytes{0}; ///< Size of the packed PCCH message
+    std::vector<uint32_t>                   ueids;
+    std::vector<asn1::rrc::paging_record_s> records;
+    std::vector<uint8_t>                    pdu;
+    void                                    pack();
+  };
+
+  int occasion_idx(uint32_t tti) const;
+
+  uint32_t T  = 0;
+  uint32_t N  = 0;
+  uint32_t Ns = 0;
+  int      sf_to_is[10]; ///< Index i_s of the paging occasion in each subframe of a paging frame, -1 if none
+
+  // Indexed by (SFN mod T) * Ns + i_s, only the paging frames are used
+  std::vector<paging_occasion_t> occasions;
+  std::atomic<uint32_t>          nof_pending{0};
+};
+
+} // namespace srsenb
+
+#endif // SRSENB_RRC_PAGING_H
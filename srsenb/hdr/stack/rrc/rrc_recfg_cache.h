@@ -0,0 +1,74 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSENB_RRC_RECFG_CACHE_H
+#define SRSENB_RRC_RECFG_CACHE_H
+
+#include "srslte/asn1/rrc_asn1.h"
+#include "srslte/common/common.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace srsenb {
+
+/**
+ * Packed radioResourceConfigDedicated of the RRC Connection Reconfigurations, by bearer profile. The profile describes
+ * everything the radioResourceConfigDedicated is built from, except the CQI configuration of the UE, which has a fixed
+ * size and is patched in the copy of the template. The first UE of every profile creates its template, the position
+ * of the CQI fields being found by packing it again with each of them changed.
+ */
+class recfg_template_cache
+{
+public:
+  static const uint32_t max_templates = 64;
+
+  /// Packs the DL-DCCH message, which has to be an RRCConnectionReconfiguration-r8. The radioResourceConfigDedicated is
+  /// taken from the template of the profile, which is created if missing. Returns false if the message can't be packed
+  bool pack(const std::string& profile, const asn1::rrc::dl_dcch_msg_s& msg, srslte::byte_buffer_t* pdu);
+
+  uint32_t nof_templates() const { return templates.size(); }
+  uint32_t nof_hits() const { return hits; }
+
+private:
+  struct field_t {
+    uint32_t offset;   ///< Position of the first bit in the template
+    uint32_t nof_bits; ///< Size of the field
+  };
+  struct template_t {
+    std::vector<uint8_t> bytes;
+    uint32_t             nof_bits = 0;
+    std::vector<field_t> fields; ///< In the order of cqi_fields()
+  };
+
+  template_t*       get_template(const std::string& profile, const asn1::rrc::rr_cfg_ded_s& rr_cfg_ded);
+  bool              create_template(const asn1::rrc::rr_cfg_ded_s& rr_cfg_ded, template_t& t);
+  asn1::SRSASN_CODE
+  pack_rr_cfg_ded(asn1::bit_ref& bref, const template_t& t, const asn1::rrc::rr_cfg_ded_s& rr_cfg_ded);
+
+  std::unordered_map<std::string, template_t> templates;
+  std::vector<uint8_t>                        scratch; ///< Template being patched
+  uint32_t                                    hits = 0;
+};
+
+} // namespace srsenb
+
+#endif // SRSENB_RRC_RECFG_CACHE_H
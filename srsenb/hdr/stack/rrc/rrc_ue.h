@@ -68,7 +68,7 @@ public:
   void handle_rrc_reconf_complete(asn1::rrc::rrc_conn_recfg_complete_s* msg, srslte::unique_byte_buffer_t pdu);
   void handle_security_mode_complete(asn1::rrc::security_mode_complete_s* msg);
   void handle_security_mode_failure(asn1::rrc::security_mode_fail_s* msg);
-  bool handle_ue_cap_info(asn1::rrc::ue_cap_info_s* msg);
+  bool handle_ue_cap_info(asn1::rrc::ue_cap_info_s* msg, asn1::rrc::ue_eutra_cap_s* eutra_cap = nullptr);
   void handle_ue_init_ctxt_setup_req(const asn1::s1ap::init_context_setup_request_s& msg);
   bool handle_ue_ctxt_mod_req(const asn1::s1ap::ue_context_mod_request_s& msg);
 
@@ -92,6 +92,9 @@ public:
   void send_dl_ccch(asn1::rrc::dl_ccch_msg_s* dl_ccch_msg);
   bool send_dl_dcch(const asn1::rrc::dl_dcch_msg_s* dl_dcch_msg,
                     srslte::unique_byte_buffer_t    pdu = srslte::unique_byte_buffer_t());
+  /// Same as send_dl_dcch(), for an RRCConnectionReconfiguration-r8 packed with the template of its bearer profile
+  bool send_dl_dcch_recfg(const asn1::rrc::dl_dcch_msg_s* dl_dcch_msg,
+                          srslte::unique_byte_buffer_t    pdu = srslte::unique_byte_buffer_t());
 
   uint16_t rnti   = 0;
   rrc*     parent = nullptr;
@@ -137,6 +140,31 @@ private:
   class mac_controller;
   std::unique_ptr<mac_controller> mac_ctrl;
 
+  // UL-DCCH messages decoded in the background task pool. They are handled in the order they were received
+  struct ul_dcch_rx_t {
+    uint32_t                     lcid = 0;
+    srslte::unique_byte_buffer_t pdu;
+    bool                         unpacked = false;
+    asn1::rrc::ul_dcch_msg_s     msg;
+    bool                         eutra_cap_unpacked = false; ///< EUTRA capabilities of a UECapabilityInformation
+    asn1::rrc::ue_eutra_cap_s    eutra_cap;
+  };
+  struct ul_dcch_rx_queue_t {
+    ue*                                                user     = nullptr;
+    uint32_t                                           next_idx = 0;
+    uint32_t                                           next_rx  = 0;
+    std::map<uint32_t, std::shared_ptr<ul_dcch_rx_t> > done;
+  };
+  const static uint32_t               ul_dcch_bg_min_len = 128; ///< Shorter messages are decoded in the stack thread
+  std::shared_ptr<ul_dcch_rx_queue_t> ul_dcch_rx;
+
+  static void decode_ul_dcch(ul_dcch_rx_t& rx);
+  void        ul_dcch_decoded(uint32_t idx, std::shared_ptr<ul_dcch_rx_t> rx);
+  void        handle_ul_dcch(ul_dcch_rx_t& rx);
+
+  void        send_packed_dl_dcch(const asn1::rrc::dl_dcch_msg_s* dl_dcch_msg, srslte::unique_byte_buffer_t pdu);
+  std::string recfg_profile(const asn1::rrc::rr_cfg_ded_s& rr_cfg_ded) const;
+
   ///< Helper to fill RR config dedicated struct for RRR Connection Setup/Reestablish
   void fill_rrc_setup_rr_config_dedicated(asn1::rrc::rr_cfg_ded_s* rr_cfg);
 
@@ -19,12 +19,17 @@
  *
  */
 
+#include <array>
 #include <map>
 #include <string.h>
+#include <vector>
 
 #include "common_enb.h"
+#include "srslte/adt/rnti_map.h"
+#include "srslte/adt/teid_map.h"
 #include "srslte/common/buffer_pool.h"
 #include "srslte/common/logmap.h"
+#include "srslte/common/network_utils.h"
 #include "srslte/common/threads.h"
 #include "srslte/interfaces/enb_interfaces.h"
 #include "srslte/srslte.h"
@@ -59,10 +64,14 @@ public:
 
   // stack interface
   void handle_gtpu_s1u_rx_packet(srslte::unique_byte_buffer_t pdu, const sockaddr_in& addr);
+  void handle_gtpu_s1u_rx_batch(srslte::rx_multisocket_handler::recvfrom_batch_t batch);
   void handle_gtpu_m1u_rx_packet(srslte::unique_byte_buffer_t pdu, const sockaddr_in& addr);
+  /// Sends the uplink PDUs written by PDCP since the last call
+  void flush_tx();
 
 private:
-  static const int GTPU_PORT = 2152;
+  static const int      GTPU_PORT    = 2152;
+  static const uint32_t MAX_TX_BATCH = 32;
 
   srslte::byte_buffer_pool* pool  = nullptr;
   stack_interface_gtpu_lte* stack = nullptr;
@@ -104,23 +113,33 @@ private:
     uint32_t teids_out[SRSENB_N_RADIO_BEARERS];
     uint32_t spgw_addrs[SRSENB_N_RADIO_BEARERS];
   } bearer_map;
-  std::map<uint16_t, bearer_map> rnti_bearers;
+  srslte::rnti_map<bearer_map> rnti_bearers;
 
   typedef struct {
     uint16_t rnti;
     uint16_t lcid;
   } rnti_lcid_t;
-  std::map<uint32_t, rnti_lcid_t> teidin_to_rntilcid_map;
+  // TEIDs In are allocated by the map, so that the lookup of every received PDU is an array access
+  srslte::teid_map<rnti_lcid_t> teidin_to_rntilcid_map;
 
   // Socket file descriptor
   int fd = -1;
 
+  // Uplink PDUs waiting for flush_tx(), sent with a single sendmmsg call
+  std::vector<srslte::unique_byte_buffer_t> tx_pdus;
+  std::array<sockaddr_in, MAX_TX_BATCH>     tx_addrs;
+  std::array<mmsghdr, MAX_TX_BATCH>         tx_msgs;
+  std::array<iovec, MAX_TX_BATCH>           tx_iovs;
+  // Downlink SDUs of one bearer, passed to PDCP together
+  std::vector<srslte::unique_byte_buffer_t> rx_sdus;
+
   void echo_response(in_addr_t addr, in_port_t port, uint16_t seq);
+  /// Handles an S1-U packet, returns true if it is a data PDU for the bearer in rnti_lcid
+  bool read_s1u_packet(srslte::unique_byte_buffer_t& pdu, const sockaddr_in& addr, rnti_lcid_t* rnti_lcid);
 
   /****************************************************************************
    * TEID to RNIT/LCID helper functions
    ***************************************************************************/
-  uint32_t    next_teid_in = 0;
   uint32_t    allocate_teidin(uint16_t rnti, uint16_t lcid);
   void        free_teidin(uint16_t rnti, uint16_t lcid);
   void        free_teidin(uint16_t rnti);
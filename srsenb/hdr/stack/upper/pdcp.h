@@ -38,6 +38,9 @@ public:
   void init(rlc_interface_pdcp* rlc_, rrc_interface_pdcp* rrc_, gtpu_interface_pdcp* gtpu_);
   void stop();
 
+  // Cipher the DRB PDUs of all users in the background threads of the task scheduler
+  void set_crypto_offload(bool enable);
+
   // pdcp_interface_rlc
   void write_pdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu) override;
   void write_pdu_mch(uint32_t lcid, srslte::unique_byte_buffer_t sdu) {}
@@ -47,6 +50,7 @@ public:
   void add_user(uint16_t rnti) override;
   void rem_user(uint16_t rnti) override;
   void write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu) override;
+  void write_sdus(uint16_t rnti, uint32_t lcid, std::vector<srslte::unique_byte_buffer_t>& sdus) override;
   void add_bearer(uint16_t rnti, uint32_t lcid, srslte::pdcp_config_t cnfg) override;
   void del_bearer(uint16_t rnti, uint32_t lcid) override;
   void config_security(uint16_t rnti, uint32_t lcid, srslte::as_security_config_t cfg_sec) override;
@@ -112,6 +116,7 @@ private:
   srslte::task_sched_handle task_sched;
   srslte::log_ref           log_h;
   srslte::byte_buffer_pool* pool;
+  bool                      crypto_offload = false;
 };
 
 } // namespace srsenb
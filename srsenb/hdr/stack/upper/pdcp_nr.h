@@ -61,6 +61,9 @@ public:
   void enable_integrity(uint16_t rnti, uint32_t lcid) final;
   void enable_encryption(uint16_t rnti, uint32_t lcid) final;
 
+  // pdcp_interface_sdap_nr
+  void write_sdus(uint16_t rnti, uint32_t lcid, std::vector<srslte::unique_byte_buffer_t>& sdus) final;
+
 private:
   class user_interface_rlc final : public srsue::rlc_interface_pdcp
   {
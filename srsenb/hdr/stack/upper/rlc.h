@@ -19,6 +19,7 @@
  *
  */
 
+#include "srsenb/hdr/stack/upper/rlc_metrics.h"
 #include "srslte/interfaces/enb_interfaces.h"
 #include "srslte/interfaces/ue_interfaces.h"
 #include "srslte/upper/rlc.h"
@@ -58,6 +59,9 @@ public:
   bool resume_bearer(uint16_t rnti, uint32_t lcid);
   void reestablish(uint16_t rnti) final;
 
+  /// Reads and resets the metrics of the bearers of the user, from any thread
+  void get_metrics(uint16_t rnti, rlc_ue_metrics_t& metrics);
+
   // rlc_interface_pdcp
   void        write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu);
   void        discard_sdu(uint16_t rnti, uint32_t lcid, uint32_t discard_sn);
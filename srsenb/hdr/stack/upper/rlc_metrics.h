@@ -0,0 +1,36 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSENB_RLC_METRICS_H
+#define SRSENB_RLC_METRICS_H
+
+#include "srslte/upper/rlc_metrics.h"
+
+namespace srsenb {
+
+/// RLC metrics of a user, per radio bearer
+struct rlc_ue_metrics_t {
+  srslte::rlc_bearer_metrics_t bearer[SRSLTE_N_RADIO_BEARERS];
+};
+
+} // namespace srsenb
+
+#endif // SRSENB_RLC_METRICS_H
@@ -116,13 +116,16 @@ private:
   bool                     mme_connected       = false;
   bool                     running             = false;
   uint32_t                 next_enb_ue_s1ap_id = 1; // Next ENB-side UE identifier
-  uint16_t                 next_ue_stream_id   = 1; // Next UE SCTP stream identifier
+  uint16_t                 nof_ue_streams      = 1; // SCTP streams for UE-associated signalling, agreed with the MME
   srslte::unique_timer     mme_connect_timer, s1setup_timeout;
 
   // Protocol IEs sent with every UL S1AP message
   asn1::s1ap::tai_s        tai;
   asn1::s1ap::eutran_cgi_s eutran_cgi;
 
+  // Memory of the decoded S1AP PDUs, reused from one PDU to the next
+  asn1::mem_arena rx_arena;
+
   // PCAP
   srslte::s1ap_pcap* pcap = nullptr;
 
@@ -199,8 +202,7 @@ private:
     bool send_erab_setup_response(const asn1::s1ap::erab_setup_resp_s& res_);
     bool was_uectxtrelease_requested() const { return release_requested; }
 
-    ue_ctxt_t ctxt      = {};
-    uint16_t  stream_id = 1;
+    ue_ctxt_t ctxt = {};
 
   private:
     bool
@@ -42,6 +42,7 @@ public:
 
   // Interface for GTPU
   void write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t pdu) final;
+  void write_sdus(uint16_t rnti, uint32_t lcid, std::vector<srslte::unique_byte_buffer_t>& sdus) final;
 
 private:
   srslte::log_ref           m_log{"SDAP"};
@@ -0,0 +1,230 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        up_proxy.h
+ * Description: Interfaces of the PDCP and GTP-U layers used by the other
+ *              layers when the user plane runs in its own threads.
+ *****************************************************************************/
+
+#ifndef SRSENB_UP_PROXY_H
+#define SRSENB_UP_PROXY_H
+
+#include "pdcp.h"
+#include "srslte/common/logmap.h"
+#include "srslte/common/task_scheduler.h"
+#include "srslte/interfaces/enb_interfaces.h"
+#include <future>
+#include <vector>
+
+namespace srsenb {
+
+/// PDCP entities of the RNTIs of one user-plane shard and the queue of the thread that owns them
+struct up_shard_t {
+  srsenb::pdcp*             pdcp;
+  srslte::task_queue_handle queue;
+};
+
+/// The C-RNTIs are allocated consecutively, so the UEs are spread evenly among the shards
+inline uint32_t up_shard_idx(uint16_t rnti, uint32_t nof_shards)
+{
+  return rnti % nof_shards;
+}
+
+/**
+ * The calls are queued, in order, to the thread of the shard of the RNTI, so the PDCP entities of a shard are only
+ * accessed by its thread. The calls that return a value wait for that thread to run them. The calls for local_shard
+ * run directly, the caller being the thread of that shard.
+ */
+class pdcp_up_proxy final : public pdcp_interface_rrc, public pdcp_interface_rlc, public pdcp_interface_gtpu
+{
+public:
+  explicit pdcp_up_proxy(std::vector<up_shard_t> shards_, int local_shard_ = -1) :
+    shards(std::move(shards_)),
+    local_shard(local_shard_)
+  {}
+
+  // pdcp_interface_rlc
+  void write_pdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu) override
+  {
+    run(rnti,
+        [rnti, lcid](srsenb::pdcp* p, srslte::unique_byte_buffer_t& pdu) { p->write_pdu(rnti, lcid, std::move(pdu)); },
+        std::move(sdu));
+  }
+
+  // pdcp_interface_gtpu
+  void write_sdus(uint16_t rnti, uint32_t lcid, std::vector<srslte::unique_byte_buffer_t>& sdus) override
+  {
+    run(rnti,
+        [rnti, lcid](srsenb::pdcp* p, std::vector<srslte::unique_byte_buffer_t>& v) { p->write_sdus(rnti, lcid, v); },
+        std::move(sdus));
+    sdus.clear();
+  }
+
+  // pdcp_interface_rrc and pdcp_interface_gtpu
+  void write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu) override
+  {
+    run(rnti,
+        [rnti, lcid](srsenb::pdcp* p, srslte::unique_byte_buffer_t& pdu) { p->write_sdu(rnti, lcid, std::move(pdu)); },
+        std::move(sdu));
+  }
+
+  // pdcp_interface_rrc
+  void reset(uint16_t rnti) override
+  {
+    run(rnti, [rnti](srsenb::pdcp* p) { p->reset(rnti); });
+  }
+  void add_user(uint16_t rnti) override
+  {
+    run(rnti, [rnti](srsenb::pdcp* p) { p->add_user(rnti); });
+  }
+  void rem_user(uint16_t rnti) override
+  {
+    run(rnti, [rnti](srsenb::pdcp* p) { p->rem_user(rnti); });
+  }
+  void add_bearer(uint16_t rnti, uint32_t lcid, srslte::pdcp_config_t cnfg) override
+  {
+    run(rnti, [rnti, lcid, cnfg](srsenb::pdcp* p) { p->add_bearer(rnti, lcid, cnfg); });
+  }
+  void del_bearer(uint16_t rnti, uint32_t lcid) override
+  {
+    run(rnti, [rnti, lcid](srsenb::pdcp* p) { p->del_bearer(rnti, lcid); });
+  }
+  void config_security(uint16_t rnti, uint32_t lcid, srslte::as_security_config_t sec_cfg) override
+  {
+    run(rnti, [rnti, lcid, sec_cfg](srsenb::pdcp* p) { p->config_security(rnti, lcid, sec_cfg); });
+  }
+  void enable_integrity(uint16_t rnti, uint32_t lcid) override
+  {
+    run(rnti, [rnti, lcid](srsenb::pdcp* p) { p->enable_integrity(rnti, lcid); });
+  }
+  void enable_encryption(uint16_t rnti, uint32_t lcid) override
+  {
+    run(rnti, [rnti, lcid](srsenb::pdcp* p) { p->enable_encryption(rnti, lcid); });
+  }
+  bool get_bearer_state(uint16_t rnti, uint32_t lcid, srslte::pdcp_lte_state_t* state) override
+  {
+    std::promise<bool> result;
+    run(rnti, [rnti, lcid, state, &result](srsenb::pdcp* p) {
+      result.set_value(p->get_bearer_state(rnti, lcid, state));
+    });
+    return result.get_future().get();
+  }
+  bool set_bearer_state(uint16_t rnti, uint32_t lcid, const srslte::pdcp_lte_state_t& state) override
+  {
+    std::promise<bool> result;
+    run(rnti, [rnti, lcid, &state, &result](srsenb::pdcp* p) {
+      result.set_value(p->set_bearer_state(rnti, lcid, state));
+    });
+    return result.get_future().get();
+  }
+  void reestablish(uint16_t rnti) override
+  {
+    run(rnti, [rnti](srsenb::pdcp* p) { p->reestablish(rnti); });
+  }
+
+private:
+  template <typename Func, typename... Args>
+  void run(uint16_t rnti, Func&& func, Args&&... args)
+  {
+    uint32_t    idx   = up_shard_idx(rnti, shards.size());
+    up_shard_t& shard = shards[idx];
+    if ((int)idx == local_shard) {
+      func(shard.pdcp, args...);
+    } else {
+      shard.queue.push(std::bind(std::forward<Func>(func), shard.pdcp, std::forward<Args>(args)...));
+    }
+  }
+
+  std::vector<up_shard_t> shards;
+  int                     local_shard = -1;
+};
+
+/// Calls of RRC, queued to the user-plane thread that runs GTP-U
+class gtpu_up_proxy final : public gtpu_interface_rrc
+{
+public:
+  gtpu_up_proxy(gtpu_interface_rrc* gtpu_, srslte::task_queue_handle up_queue_) :
+    gtpu(gtpu_),
+    up_queue(std::move(up_queue_))
+  {}
+
+  uint32_t add_bearer(uint16_t rnti, uint32_t lcid, uint32_t addr, uint32_t teid_out) override
+  {
+    std::promise<uint32_t> teid_in;
+    up_queue.push([this, rnti, lcid, addr, teid_out, &teid_in]() {
+      teid_in.set_value(gtpu->add_bearer(rnti, lcid, addr, teid_out));
+    });
+    return teid_in.get_future().get();
+  }
+  void rem_bearer(uint16_t rnti, uint32_t lcid) override
+  {
+    gtpu_interface_rrc* g = gtpu;
+    up_queue.push([g, rnti, lcid]() { g->rem_bearer(rnti, lcid); });
+  }
+  void mod_bearer_rnti(uint16_t old_rnti, uint16_t new_rnti) override
+  {
+    gtpu_interface_rrc* g = gtpu;
+    up_queue.push([g, old_rnti, new_rnti]() { g->mod_bearer_rnti(old_rnti, new_rnti); });
+  }
+  void rem_user(uint16_t rnti) override
+  {
+    gtpu_interface_rrc* g = gtpu;
+    up_queue.push([g, rnti]() { g->rem_user(rnti); });
+  }
+
+private:
+  gtpu_interface_rrc*       gtpu = nullptr;
+  srslte::task_queue_handle up_queue;
+};
+
+/**
+ * Uplink PDUs of the shards that don't run GTP-U. The thread of GTP-U pushes the downlink SDUs to the shards waiting
+ * for room, so the uplink PDUs are dropped instead when its queue is full, and the two threads never wait for each
+ * other.
+ */
+class gtpu_pdcp_proxy final : public gtpu_interface_pdcp
+{
+public:
+  gtpu_pdcp_proxy(gtpu_interface_pdcp* gtpu_, srslte::task_queue_handle gtpu_queue_) :
+    gtpu(gtpu_),
+    gtpu_queue(std::move(gtpu_queue_))
+  {}
+
+  void write_pdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t pdu) override
+  {
+    gtpu_interface_pdcp* g   = gtpu;
+    auto                 ret = gtpu_queue.try_push(std::bind(
+        [g, rnti, lcid](srslte::unique_byte_buffer_t& p) { g->write_pdu(rnti, lcid, std::move(p)); }, std::move(pdu)));
+    if (not ret.first) {
+      log_h->warning("Dropping uplink PDU of rnti=0x%x, lcid=%d. The GTP-U thread is busy\n", rnti, lcid);
+    }
+  }
+
+private:
+  gtpu_interface_pdcp*      gtpu = nullptr;
+  srslte::task_queue_handle gtpu_queue;
+  srslte::log_ref           log_h{"GTPU"};
+};
+
+} // namespace srsenb
+
+#endif // SRSENB_UP_PROXY_H
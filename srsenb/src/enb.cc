@@ -66,7 +66,7 @@ int enb::init(const all_args_t& args_, srslte::logger* logger_)
 
   // Create layers
   if (args.stack.type == "lte") {
-    std::unique_ptr<enb_stack_lte> lte_stack(new enb_stack_lte(logger));
+    std::unique_ptr<enb_stack_lte> lte_stack(new enb_stack_lte(logger, args.stack.nof_background_threads));
     if (!lte_stack) {
       srslte::console("Error creating eNB stack.\n");
       return SRSLTE_ERROR;
@@ -214,6 +214,16 @@ void enb::cmd_cell_gain(uint32_t cell_id, float gain)
   phy->cmd_cell_gain(cell_id, gain);
 }
 
+void enb::cmd_cell_pci(uint32_t cell_id, uint32_t pci)
+{
+  // The PHY changes first, the RRC only follows if the cell could be changed
+  if (phy->cmd_cell_pci(cell_id, pci) != SRSLTE_SUCCESS) {
+    srslte::console("Error changing the PCI of cell ID %d\n", cell_id);
+    return;
+  }
+  stack->cmd_cell_pci(cell_id, pci);
+}
+
 srslte::LOG_LEVEL_ENUM enb::level(std::string l)
 {
   std::transform(l.begin(), l.end(), l.begin(), ::toupper);
@@ -390,6 +390,145 @@ int phr_cnfg_parser::parse(libconfig::Setting& root)
   return 0;
 }
 
+static bool extract_drx_start_offset(drx_cfg_c::setup_s_::long_drx_cycle_start_offset_c_* store_ptr,
+                                     const char*                                           name,
+                                     Setting&                                              root)
+{
+  using offset_t = drx_cfg_c::setup_s_::long_drx_cycle_start_offset_c_;
+  uint32_t offset;
+  if (not root.lookupValue(name, offset) or offset >= store_ptr->type().to_number()) {
+    fprintf(stderr, "Invalid or missing %s, it must be lower than the long DRX cycle\n", name);
+    return false;
+  }
+  switch (store_ptr->type().value) {
+    case offset_t::types::sf10:
+      store_ptr->sf10() = offset;
+      break;
+    case offset_t::types::sf20:
+      store_ptr->sf20() = offset;
+      break;
+    case offset_t::types::sf32:
+      store_ptr->sf32() = offset;
+      break;
+    case offset_t::types::sf40:
+      store_ptr->sf40() = offset;
+      break;
+    case offset_t::types::sf64:
+      store_ptr->sf64() = offset;
+      break;
+    case offset_t::types::sf80:
+      store_ptr->sf80() = offset;
+      break;
+    case offset_t::types::sf128:
+      store_ptr->sf128() = offset;
+      break;
+    case offset_t::types::sf160:
+      store_ptr->sf160() = offset;
+      break;
+    case offset_t::types::sf256:
+      store_ptr->sf256() = offset;
+      break;
+    case offset_t::types::sf320:
+      store_ptr->sf320() = offset;
+      break;
+    case offset_t::types::sf512:
+      store_ptr->sf512() = offset;
+      break;
+    case offset_t::types::sf640:
+      store_ptr->sf640() = offset;
+      break;
+    case offset_t::types::sf1024:
+      store_ptr->sf1024() = offset;
+      break;
+    case offset_t::types::sf1280:
+      store_ptr->sf1280() = offset;
+      break;
+    case offset_t::types::sf2048:
+      store_ptr->sf2048() = offset;
+      break;
+    case offset_t::types::sf2560:
+      store_ptr->sf2560() = offset;
+      break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+int drx_cnfg_parser::parse(libconfig::Setting& root)
+{
+  if (not root.exists("drx_cnfg")) {
+    mac_cfg->drx_cfg_present = false;
+    return 0;
+  }
+  mac_cfg->drx_cfg_present = true;
+  mac_cfg->drx_cfg.set_setup();
+  drx_cfg_c::setup_s_& s   = mac_cfg->drx_cfg.setup();
+  Setting&             drx = root["drx_cnfg"];
+
+  if (not parse_enum_by_number(s.on_dur_timer, "on_duration_timer", drx)) {
+    return -1;
+  }
+  if (not parse_enum_by_number(s.drx_inactivity_timer, "drx_inactivity_timer", drx)) {
+    return -1;
+  }
+  if (not parse_enum_by_number(s.drx_retx_timer, "drx_retx_timer", drx)) {
+    return -1;
+  }
+  field_asn1_choice_number<drx_cfg_c::setup_s_::long_drx_cycle_start_offset_c_> offset(
+      "long_drx_cycle_start_offset", "long_drx_cycle", &extract_drx_start_offset, &s.long_drx_cycle_start_offset);
+  if (offset.parse(drx) != 0) {
+    return -1;
+  }
+
+  // The short DRX cycle is optional
+  s.short_drx_present = drx.exists("short_drx_cycle");
+  if (s.short_drx_present) {
+    if (not parse_enum_by_number(s.short_drx.short_drx_cycle, "short_drx_cycle", drx)) {
+      return -1;
+    }
+    uint32_t short_cycle_timer = 0;
+    if (not drx.lookupValue("drx_short_cycle_timer", short_cycle_timer) or short_cycle_timer < 1 or
+        short_cycle_timer > 16) {
+      fprintf(stderr, "Invalid or missing drx_short_cycle_timer, valid values are 1 to 16\n");
+      return -1;
+    }
+    s.short_drx.drx_short_cycle_timer = short_cycle_timer;
+  }
+  return 0;
+}
+
+int srs_cnfg_parser::parse(libconfig::Setting& root)
+{
+  *srs_cfg = {};
+  if (not root.exists("srs_cnfg")) {
+    return 0;
+  }
+  Setting& srs = root["srs_cnfg"];
+
+  if (not srs.lookupValue("bw_cfg", srs_cfg->bw_cfg) or srs_cfg->bw_cfg > 7) {
+    fprintf(stderr, "Invalid or missing srs_cnfg.bw_cfg, valid values are 0 to 7\n");
+    return -1;
+  }
+  if (not srs.lookupValue("subframe_cfg", srs_cfg->sf_cfg) or srs_cfg->sf_cfg > 14) {
+    fprintf(stderr, "Invalid or missing srs_cnfg.subframe_cfg, valid values are 0 to 14\n");
+    return -1;
+  }
+  const uint32_t valid_periods[] = {2, 5, 10, 20, 40, 80, 160, 320};
+  if (not srs.lookupValue("period", srs_cfg->period) or
+      std::find(std::begin(valid_periods), std::end(valid_periods), srs_cfg->period) == std::end(valid_periods)) {
+    fprintf(stderr, "Invalid or missing srs_cnfg.period, valid values are 2, 5, 10, 20, 40, 80, 160 and 320\n");
+    return -1;
+  }
+  if (srs.lookupValue("bw", srs_cfg->bw) and srs_cfg->bw > 3) {
+    fprintf(stderr, "Invalid srs_cnfg.bw, valid values are 0 to 3\n");
+    return -1;
+  }
+  srs.lookupValue("ack_nack_simul_tx", srs_cfg->simul_ack);
+  srs_cfg->enabled = true;
+  return 0;
+}
+
 int field_qci::parse(libconfig::Setting& root)
 {
   auto nof_qci = (uint32_t)root.getLength();
@@ -512,6 +651,24 @@ int field_qci::parse(libconfig::Setting& root)
       }
     }
 
+    // Optional active queue management of the RLC Tx SDU queue
+    cfg[qci].aqm = {};
+    if (q["rlc_config"].exists("aqm")) {
+      libconfig::Setting& aqm = q["rlc_config"]["aqm"];
+      std::string         mode;
+      aqm.lookupValue("mode", mode);
+      if (mode == "codel") {
+        cfg[qci].aqm.mode = srslte::rlc_aqm_mode_t::codel;
+      } else if (mode == "pie") {
+        cfg[qci].aqm.mode = srslte::rlc_aqm_mode_t::pie;
+      } else if (mode != "none") {
+        ERROR("Invalid aqm mode %s for qci=%d. Valid values: none, codel, pie\n", mode.c_str(), qci);
+        return -1;
+      }
+      aqm.lookupValue("target_ms", cfg[qci].aqm.target_ms);
+      aqm.lookupValue("interval_ms", cfg[qci].aqm.interval_ms);
+    }
+
     // Parse logical channel configuration section
     if (!q.exists("logical_channel_config")) {
       fprintf(stderr, "Error section logical_channel_config not found for qci=%d\n", qci);
@@ -606,6 +763,7 @@ int parse_rr(all_args_t* args_, rrc_cfg_t* rrc_cfg_)
   rrc_cfg_->mac_cnfg.phr_cfg.set(
       mac_main_cfg_s::phr_cfg_c_::types::release); // default is release if "phr_cnfg" is not found
   mac_cnfg.add_field(new phr_cnfg_parser(&rrc_cfg_->mac_cnfg.phr_cfg));
+  mac_cnfg.add_field(new drx_cnfg_parser(&rrc_cfg_->mac_cnfg)); // DRX is not configured if "drx_cnfg" is not found
   //  mac_cnfg.add_field(new phr_cnfg_parser(&rrc_cfg_->mac_cnfg.phr_cfg));
 
   parser::section ulsch_cnfg("ulsch_cnfg");
@@ -650,6 +808,8 @@ int parse_rr(all_args_t* args_, rrc_cfg_t* rrc_cfg_)
   cqi_report_cnfg.add_field(new parser::field<bool>("simultaneousAckCQI", &rrc_cfg_->cqi_cfg.simultaneousAckCQI));
   cqi_report_cnfg.add_field(new field_sf_mapping(rrc_cfg_->cqi_cfg.sf_mapping, &rrc_cfg_->cqi_cfg.nof_subframes, 1));
 
+  phy_cfg_.add_field(new srs_cnfg_parser(&rrc_cfg_->srs_cfg)); // SRS is not configured if "srs_cnfg" is not found
+
   /* RRC config section */
   parser::section rrc_cnfg("cell_list");
   rrc_cnfg.set_optional(&rrc_cfg_->meas_cfg_present);
@@ -705,6 +865,9 @@ static int parse_meas_report_desc(rrc_meas_cfg_t* meas_cfg, Setting& root)
       asn1_parsers::opt_number_to_enum(quant.filt_coef_rsrp, quant.filt_coef_rsrp_present, root, "rsrp_config"));
   HANDLEPARSERCODE(
       asn1_parsers::opt_number_to_enum(quant.filt_coef_rsrq, quant.filt_coef_rsrq_present, root, "rsrq_config"));
+  if (root.exists("ho_prep_rsrp_thres")) {
+    HANDLEPARSERCODE(parse_bounded_number(meas_cfg->ho_prep_rsrp_thres, root["ho_prep_rsrp_thres"], -1, 97));
+  }
 
   return SRSLTE_SUCCESS;
 }
@@ -907,6 +1070,18 @@ int set_derived_args(all_args_t* args_, rrc_cfg_t* rrc_cfg_, phy_cfg_t* phy_cfg_
   // set config for RRC's base cell
   rrc_cfg_->cell = cell_cfg_;
 
+  // Enable the cell SRS in SIB2 if the PCell SRS is configured in rr.conf
+  if (rrc_cfg_->srs_cfg.enabled) {
+    srs_ul_cfg_common_c& srs_common = rrc_cfg_->sibs[1].sib2().rr_cfg_common.srs_ul_cfg_common;
+    srs_common.set_setup();
+    srs_common.setup().srs_bw_cfg.value =
+        (srs_ul_cfg_common_c::setup_s_::srs_bw_cfg_opts::options)rrc_cfg_->srs_cfg.bw_cfg;
+    srs_common.setup().srs_sf_cfg.value =
+        (srs_ul_cfg_common_c::setup_s_::srs_sf_cfg_opts::options)rrc_cfg_->srs_cfg.sf_cfg;
+    srs_common.setup().ack_nack_srs_simul_tx = rrc_cfg_->srs_cfg.simul_ack;
+    phy_cfg_->srs_ul_cnfg                    = srs_common;
+  }
+
   // Set S1AP related params from cell list
   args_->stack.s1ap.enb_id  = args_->enb.enb_id;
   args_->stack.s1ap.cell_id = rrc_cfg_->cell_list.at(0).cell_id;
@@ -1094,12 +1269,15 @@ int set_derived_args(all_args_t* args_, rrc_cfg_t* rrc_cfg_, phy_cfg_t* phy_cfg_
   // MAC needs to know the cell bandwidth to dimension softbuffers
   args_->stack.mac.nof_prb = args_->enb.n_prb;
 
+  // The 8-bit PUSCH decoder combines the retransmissions in 8-bit softbuffers, with half the memory
+  args_->stack.mac.pusch_8bit_softbuffers = args_->phy.pusch_8bit_decoder;
+
   // RRC needs eNB id for SIB1 packing
   rrc_cfg_->enb_id = args_->stack.s1ap.enb_id;
 
-  // Set sync queue capacity to 1 for ZMQ
-  if (args_->rf.device_name == "zmq") {
-    srslte::logmap::get("ENB")->info("Using sync queue size of one for ZMQ based radio.");
+  // Set sync queue capacity to 1 for ZMQ and shared memory
+  if (args_->rf.device_name == "zmq" || args_->rf.device_name == "shm") {
+    srslte::logmap::get("ENB")->info("Using sync queue size of one for %s based radio.", args_->rf.device_name.c_str());
     args_->stack.sync_queue_size = 1;
   } else {
     // use default size
@@ -1520,7 +1698,7 @@ int parse_sibs(all_args_t* args_, rrc_cfg_t* rrc_cfg_, srsenb::phy_cfg_t* phy_co
     return SRSLTE_ERROR;
   }
 
-  // SRS not yet supported
+  // The cell SRS is enabled later on if rr.conf configures srs_cnfg
   sib2->rr_cfg_common.srs_ul_cfg_common.set(srs_ul_cfg_common_c::types::release);
   if (sib2->freq_info.ul_bw_present) {
     asn1::number_to_enum(sib2->freq_info.ul_bw, args_->enb.n_prb);
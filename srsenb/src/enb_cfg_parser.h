@@ -548,6 +548,28 @@ private:
   asn1::rrc::mac_main_cfg_s::phr_cfg_c_* phr_cfg;
 };
 
+class drx_cnfg_parser : public parser::field_itf
+{
+public:
+  explicit drx_cnfg_parser(asn1::rrc::mac_main_cfg_s* mac_cfg_) : mac_cfg(mac_cfg_) {}
+  int         parse(Setting& root) override;
+  const char* get_name() override { return "drx_cnfg"; }
+
+private:
+  asn1::rrc::mac_main_cfg_s* mac_cfg;
+};
+
+class srs_cnfg_parser : public parser::field_itf
+{
+public:
+  explicit srs_cnfg_parser(rrc_cfg_srs_t* srs_cfg_) : srs_cfg(srs_cfg_) {}
+  int         parse(Setting& root) override;
+  const char* get_name() override { return "srs_cnfg"; }
+
+private:
+  rrc_cfg_srs_t* srs_cfg;
+};
+
 class mbsfn_sf_cfg_list_parser : public parser::field_itf
 {
 public:
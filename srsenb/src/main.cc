@@ -30,7 +30,12 @@
 #include "srslte/common/config_file.h"
 #include "srslte/common/crash_handler.h"
 #include "srslte/common/logger_srslog_wrapper.h"
+#include "srslte/common/perf_counters.h"
 #include "srslte/common/signal_handler.h"
+#include "srslte/common/threads.h"
+#include "srslte/common/tti_trace.h"
+#include "srslte/phy/utils/mem_accounting.h"
+#include "srslte/phy/utils/vector.h"
 #include "srslte/srslog/srslog.h"
 
 #include <boost/program_options.hpp>
@@ -42,6 +47,7 @@
 
 #include "srsenb/hdr/enb.h"
 #include "srsenb/hdr/metrics_csv.h"
+#include "srsenb/hdr/metrics_prometheus.h"
 #include "srsenb/hdr/metrics_stdout.h"
 
 using namespace std;
@@ -90,6 +96,7 @@ void parse_args(all_args_t* args, int argc, char* argv[])
 
     ("rf.dl_earfcn",      bpo::value<uint32_t>(&args->enb.dl_earfcn)->default_value(0),   "Force Downlink EARFCN for single cell")
     ("rf.srate",          bpo::value<double>(&args->rf.srate_hz)->default_value(0.0),     "Force Tx and Rx sampling rate in Hz")
+    ("rf.srate_passband", bpo::value<float>(&args->rf.srate_passband)->default_value(0.8f), "Resampler passband (fraction of Nyquist) for non-integer rf.srate ratios")
     ("rf.rx_gain",        bpo::value<float>(&args->rf.rx_gain)->default_value(50),        "Front-end receiver gain")
     ("rf.tx_gain",        bpo::value<float>(&args->rf.tx_gain)->default_value(70),        "Front-end transmitter gain")
     ("rf.tx_gain[0]",     bpo::value<float>(&args->rf.tx_gain_ch[0])->default_value(-1),  "Front-end transmitter gain CH0")
@@ -103,6 +110,8 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("rf.device_name",       bpo::value<string>(&args->rf.device_name)->default_value("auto"),       "Front-end device name")
     ("rf.device_args",       bpo::value<string>(&args->rf.device_args)->default_value("auto"),       "Front-end device arguments")
     ("rf.time_adv_nsamples", bpo::value<string>(&args->rf.time_adv_nsamples)->default_value("auto"), "Transmission time advance")
+    ("rf.tx_async", bpo::value<bool>(&args->rf.tx_async)->default_value(false), "Hand the transmissions to the driver from a dedicated thread")
+    ("rf.rx_dev_threads", bpo::value<bool>(&args->rf.rx_dev_threads)->default_value(false), "Receive from every RF device in its own thread")
 
     ("gui.enable",        bpo::value<bool>(&args->gui.enable)->default_value(false),          "Enable GUI plots")
 
@@ -131,12 +140,15 @@ void parse_args(all_args_t* args, int argc, char* argv[])
 
     ("log.filename",      bpo::value<string>(&args->log.filename)->default_value("/tmp/ue.log"),"Log filename")
     ("log.file_max_size", bpo::value<int>(&args->log.file_max_size)->default_value(-1), "Maximum file size (in kilobytes). When passed, multiple files are created. Default -1 (single file)")
+    ("log.binary",        bpo::value<bool>(&args->log.binary)->default_value(false), "Write the log file in the srslog binary format, converted to text by srslog_decoder")
 
     /* PCAP */
     ("pcap.enable",    bpo::value<bool>(&args->stack.mac_pcap.enable)->default_value(false),         "Enable MAC packet captures for wireshark")
     ("pcap.filename",  bpo::value<string>(&args->stack.mac_pcap.filename)->default_value("enb_mac.pcap"), "MAC layer capture filename")
     ("pcap.s1ap_enable",   bpo::value<bool>(&args->stack.s1ap_pcap.enable)->default_value(false),         "Enable S1AP packet captures for wireshark")
     ("pcap.s1ap_filename", bpo::value<string>(&args->stack.s1ap_pcap.filename)->default_value("enb_s1ap.pcap"), "S1AP layer capture filename")
+    ("pcap.max_file_size",     bpo::value<uint64_t>(&args->stack.pcap_rotation.max_file_size)->default_value(0),     "Start a new capture file when the current one would exceed this size in bytes. 0 disables it")
+    ("pcap.max_file_duration", bpo::value<uint32_t>(&args->stack.pcap_rotation.max_file_duration)->default_value(0), "Start a new capture file every this number of seconds. 0 disables it")
 
     /* MCS section */
     ("scheduler.pdsch_mcs", bpo::value<int>(&args->stack.mac.sched.pdsch_mcs)->default_value(-1), "Optional fixed PDSCH MCS (ignores reported CQIs if specified)")
@@ -146,6 +158,12 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("scheduler.max_aggr_level", bpo::value<int>(&args->stack.mac.sched.max_aggr_level)->default_value(-1), "Optional maximum aggregation level index (l=log2(L)) ")
     ("scheduler.max_nof_ctrl_symbols", bpo::value<uint32_t>(&args->stack.mac.sched.max_nof_ctrl_symbols)->default_value(3), "Number of control symbols")
     ("scheduler.min_nof_ctrl_symbols", bpo::value<uint32_t>(&args->stack.mac.sched.min_nof_ctrl_symbols)->default_value(1), "Minimum number of control symbols")
+    ("scheduler.policy", bpo::value<string>(&args->stack.mac.sched.policy)->default_value("time_rr"), "Scheduler policy (time_rr, pf or max_ci)")
+    ("scheduler.pf_window", bpo::value<uint32_t>(&args->stack.mac.sched.pf_window)->default_value(100), "Number of TTIs the PF policy averages the served rate over")
+    ("scheduler.nof_cc_workers", bpo::value<uint32_t>(&args->stack.mac.sched.nof_cc_workers)->default_value(0), "Number of threads allocating the carriers in parallel (0 to disable)")
+    ("scheduler.max_pdcch_leaves", bpo::value<uint32_t>(&args->stack.mac.sched.max_pdcch_leaves)->default_value(64), "Maximum number of PDCCH allocation combinations kept per DCI (0 for no limit)")
+    ("scheduler.target_bler", bpo::value<float>(&args->stack.mac.sched.target_bler)->default_value(0), "Target BLER of the outer loop link adaptation of the MCS (0 to disable)")
+    ("scheduler.trace_filename", bpo::value<string>(&args->stack.mac.sched_trace_filename)->default_value(""), "Records the scheduler inputs to this file for offline replay (empty to disable)")
 
     /* Downlink Channel emulator section */
     ("channel.dl.enable",            bpo::value<bool>(&args->phy.dl_channel_args.enable)->default_value(false),               "Enable/Disable internal Downlink channel emulator")
@@ -190,11 +208,33 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("expert.metrics_period_secs", bpo::value<float>(&args->general.metrics_period_secs)->default_value(1.0), "Periodicity for metrics in seconds")
     ("expert.metrics_csv_enable",  bpo::value<bool>(&args->general.metrics_csv_enable)->default_value(false), "Write metrics to CSV file")
     ("expert.metrics_csv_filename", bpo::value<string>(&args->general.metrics_csv_filename)->default_value("/tmp/enb_metrics.csv"), "Metrics CSV filename")
+    ("expert.metrics_http_enable",  bpo::value<bool>(&args->general.metrics_http_enable)->default_value(false), "Serve the metrics to Prometheus over HTTP")
+    ("expert.metrics_http_address", bpo::value<string>(&args->general.metrics_http_address)->default_value("127.0.0.1"), "Address where the metrics are served")
+    ("expert.metrics_http_port",    bpo::value<uint16_t>(&args->general.metrics_http_port)->default_value(9121), "Port where the metrics are served at /metrics")
     ("expert.pusch_max_its", bpo::value<int>(&args->phy.pusch_max_its)->default_value(8), "Maximum number of turbo decoder iterations")
     ("expert.pusch_8bit_decoder", bpo::value<bool>(&args->phy.pusch_8bit_decoder)->default_value(false), "Use 8-bit for LLR representation and turbo decoder trellis computation (Experimental)")
+    ("expert.pusch_cb_workers", bpo::value<int>(&args->phy.pusch_cb_workers)->default_value(0), "Number of extra threads decoding PUSCH codeblocks in parallel (0 disables)")
+    ("expert.pusch_ue_workers", bpo::value<int>(&args->phy.pusch_ue_workers)->default_value(0), "Number of extra threads decoding the PUSCH of different UEs in parallel (0 disables)")
+    ("expert.pdsch_ue_workers", bpo::value<int>(&args->phy.pdsch_ue_workers)->default_value(0), "Number of extra threads encoding the PDSCH of different UEs in parallel (0 disables)")
+    ("expert.prach_workers", bpo::value<int>(&args->phy.prach_workers)->default_value(1), "Number of threads per carrier detecting PRACH occasions in parallel")
+    ("expert.hugepage_threshold", bpo::value<uint32_t>(&args->general.hugepage_threshold)->default_value(0), "Allocate the PHY and RF buffers of at least this many bytes on 2 MB hugepages (0 disables)")
+    ("expert.tti_trace_filename", bpo::value<string>(&args->general.tti_trace_filename)->default_value(""), "Write the timing of the last TTI stages to this file in the Chrome trace format on exit (empty disables)")
+    ("expert.perf_counters", bpo::value<bool>(&args->general.perf_counters)->default_value(false), "Count the cycles, instructions, cache misses and branch mispredictions of the TTI stages with the hardware performance counters")
+    ("expert.io_uring", bpo::value<bool>(&args->stack.io_uring)->default_value(false), "Read the S1AP/GTP-U sockets through io_uring instead of epoll, if the kernel supports it")
+    ("expert.stack_up_thread", bpo::value<bool>(&args->stack.up_thread)->default_value(false), "Run the user plane (PDCP and GTP-U) in a thread separate from the control plane")
+    ("expert.stack_up_workers", bpo::value<uint32_t>(&args->stack.nof_up_workers)->default_value(1), "Number of user-plane threads the UEs are distributed among, with stack_up_thread")
+    ("expert.stack_background_threads", bpo::value<uint32_t>(&args->stack.nof_background_threads)->default_value(1), "Number of stack threads decoding large RRC messages and, without stack_up_thread, ciphering PDCP PDUs (0 runs them in the stack thread)")
+    ("expert.pdcp_crypto_offload", bpo::value<bool>(&args->stack.pdcp_crypto_offload)->default_value(true), "Cipher the PDCP PDUs of the DRBs in the stack background threads, without stack_up_thread")
+    ("expert.s1ap_sctp_streams", bpo::value<uint16_t>(&args->stack.s1ap.nof_sctp_streams)->default_value(8), "Number of SCTP streams requested to the MME, the UE-associated signalling is spread among all but stream 0")
+    ("expert.rx_int16", bpo::value<bool>(&args->phy.rx_int16)->default_value(false), "Receive the UL as int16 samples and convert them in the FFT, if the radio supports it")
     ("expert.pusch_meas_evm", bpo::value<bool>(&args->phy.pusch_meas_evm)->default_value(false), "Enable/Disable PUSCH EVM measure")
     ("expert.tx_amplitude", bpo::value<float>(&args->phy.tx_amplitude)->default_value(0.6), "Transmit amplitude factor")
     ("expert.nof_phy_threads", bpo::value<int>(&args->phy.nof_phy_threads)->default_value(3), "Number of PHY threads")
+    ("expert.deadline_dump_filename", bpo::value<string>(&args->phy.deadline_watchdog.dump_filename)->default_value(""), "Append a snapshot of the last TTIs to this file when a TTI misses its deadline (empty disables)")
+    ("expert.deadline_tx_margin_us", bpo::value<uint32_t>(&args->phy.deadline_watchdog.tx_margin_us)->default_value(100), "Minimum time between the Tx of a TTI reaching the radio and its Tx time")
+    ("expert.deadline_rx_lag_us", bpo::value<uint32_t>(&args->phy.deadline_watchdog.rx_lag_us)->default_value(1000), "Maximum reception delay of a subframe over the usual one")
+    ("expert.deadline_max_dumps", bpo::value<uint32_t>(&args->phy.deadline_watchdog.max_dumps)->default_value(10), "Maximum number of deadline miss snapshots")
+    ("expert.min_phy_threads", bpo::value<int>(&args->phy.min_phy_threads)->default_value(0), "Minimum number of active PHY threads when the pool is sized with the load (0 keeps all of them active)")
     ("expert.max_prach_offset_us", bpo::value<float>(&args->phy.max_prach_offset_us)->default_value(30), "Maximum allowed RACH offset (in us)")
     ("expert.equalizer_mode", bpo::value<string>(&args->phy.equalizer_mode)->default_value("mmse"), "Equalizer mode")
     ("expert.estimator_fil_w", bpo::value<float>(&args->phy.estimator_fil_w)->default_value(0.1), "Chooses the coefficients for the 3-tap channel estimator centered filter.")
@@ -216,6 +256,7 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("vnf.type", bpo::value<string>(&args->phy.vnf_args.type)->default_value("gnb"), "VNF instance type [gnb,ue]")
     ("vnf.addr", bpo::value<string>(&args->phy.vnf_args.bind_addr)->default_value("localhost"), "Address to bind VNF interface")
     ("vnf.port", bpo::value<uint16_t>(&args->phy.vnf_args.bind_port)->default_value(3333), "Bind port")
+    ("vnf.shm_name", bpo::value<string>(&args->phy.vnf_args.shm_name)->default_value(""), "Shared memory rings with a PNF in the same host, instead of UDP")
     ("log.vnf_level",     bpo::value<string>(&args->phy.vnf_args.log_level),   "VNF log level")
     ("log.vnf_hex_limit", bpo::value<int>(&args->phy.vnf_args.log_hex_limit),  "VNF log hex dump limit")
 
@@ -225,6 +266,17 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("coreless.ip_netmask", bpo::value<string>(&args->stack.coreless.gw_args.tun_dev_netmask)->default_value("255.255.255.0"), "Netmask of the TUN device")
     ("coreless.drb_lcid", bpo::value<uint8_t>(&args->stack.coreless.drb_lcid)->default_value(4), "LCID of the dummy DRB")
     ("coreless.rnti", bpo::value<uint16_t >(&args->stack.coreless.rnti)->default_value(1234), "RNTI of the dummy user")
+
+    // Thread placement, "cpus[:policy[:priority]]" for all the threads whose name starts with the given prefix
+    ("threads.stack",   bpo::value<string>(&args->general.thread_placement["STACK"]),        "Placement of the stack thread")
+    ("threads.txrx",    bpo::value<string>(&args->general.thread_placement["TXRX"]),         "Placement of the PHY Tx/Rx thread")
+    ("threads.workers", bpo::value<string>(&args->general.thread_placement["WORKER"]),       "Placement of the PHY workers")
+    ("threads.prach",   bpo::value<string>(&args->general.thread_placement["PRACH_WORKER"]), "Placement of the PRACH worker")
+    ("threads.sockets", bpo::value<string>(&args->general.thread_placement["ENBSOCKETS"]),   "Placement of the S1AP/GTP-U socket thread")
+    ("threads.rf",      bpo::value<string>(&args->general.thread_placement["RF_"]),          "Placement of the RF driver threads")
+    ("threads.logger",  bpo::value<string>(&args->general.thread_placement["SRSLOG"]),       "Placement of the log backend thread")
+    ("threads.metrics", bpo::value<string>(&args->general.thread_placement["METRICS_HUB"]),  "Placement of the metrics thread")
+    ("threads.numa_workers", bpo::value<bool>(&args->phy.numa_workers)->default_value(false), "Spread the PHY workers over the NUMA nodes of their CPUs, with their buffers on the same node")
     ;
 
   // Positional options - config file location
@@ -396,6 +448,13 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     cout << "Failed to read DRB configuration file " << args->enb_files.drb_config << " - exiting" << endl;
     exit(1);
   }
+
+  for (const auto& p : args->general.thread_placement) {
+    if (!threads_set_placement(p.first.c_str(), p.second.c_str())) {
+      cout << "Error parsing the placement " << p.second << " of the " << p.first << " threads - exiting" << endl;
+      exit(1);
+    }
+  }
 }
 
 static bool do_metrics = false;
@@ -425,6 +484,8 @@ static void* input_loop(metrics_stdout* metrics, srsenb::enb_command_interface*
           metrics->toggle_print(do_metrics);
         } else if (cmd[0] == "q") {
           raise(SIGTERM);
+        } else if (cmd[0] == "tti") {
+          cout << srslte::tti_trace::summary_to_string();
         } else if (cmd[0] == "cell_gain") {
           if (cmd.size() != 3) {
             cout << "Usage: " << cmd[0] << " [cell identifier] [gain in dB]" << endl;
@@ -437,11 +498,25 @@ static void* input_loop(metrics_stdout* metrics, srsenb::enb_command_interface*
 
           // Set cell gain
           control->cmd_cell_gain(cell_id, gain_db);
+        } else if (cmd[0] == "cell_pci") {
+          if (cmd.size() != 3) {
+            cout << "Usage: " << cmd[0] << " [cell identifier] [PCI]" << endl;
+            continue;
+          }
+
+          // Parse command arguments
+          uint32_t cell_id = srslte::string_cast<uint32_t>(cmd[1]);
+          uint32_t pci     = srslte::string_cast<uint32_t>(cmd[2]);
+
+          // Change the cell PCI
+          control->cmd_cell_pci(cell_id, pci);
         } else {
           cout << "Available commands: " << endl;
           cout << "          t: starts console trace" << endl;
           cout << "          q: quit srsenb" << endl;
+          cout << "        tti: print the processing time of the TTI stages" << endl;
           cout << "  cell_gain: set relative cell gain" << endl;
+          cout << "   cell_pci: change the PCI of a cell" << endl;
           cout << endl;
         }
       }
@@ -459,6 +534,7 @@ static size_t fixup_log_file_maxsize(int x)
 int main(int argc, char* argv[])
 {
   srslte_register_signal_handler();
+  srslte_register_mem_dump_signal_handler();
   all_args_t                         args = {};
   srslte::metrics_hub<enb_metrics_t> metricshub;
   metrics_stdout                     metrics_screen;
@@ -467,11 +543,19 @@ int main(int argc, char* argv[])
 
   srslte_debug_handle_crash(argc, argv);
   parse_args(&args, argc, argv);
+  srslte_vec_set_hugepage_threshold(args.general.hugepage_threshold);
+  if (args.general.perf_counters and not srslte::perf_counters::enable()) {
+    cout << "Warning: The hardware performance counters are not available, check perf_event_paranoid" << endl;
+  }
 
   // Setup logging.
-  log_sink = (args.log.filename == "stdout")
-                 ? srslog::create_stdout_sink()
-                 : srslog::create_file_sink(args.log.filename, fixup_log_file_maxsize(args.log.file_max_size));
+  if (args.log.filename == "stdout") {
+    log_sink = srslog::create_stdout_sink();
+  } else if (args.log.binary) {
+    log_sink = &srslog::fetch_binary_file_sink(args.log.filename, fixup_log_file_maxsize(args.log.file_max_size));
+  } else {
+    log_sink = srslog::create_file_sink(args.log.filename, fixup_log_file_maxsize(args.log.file_max_size));
+  }
   if (!log_sink) {
     return SRSLTE_ERROR;
   }
@@ -498,6 +582,9 @@ int main(int argc, char* argv[])
     return SRSLTE_ERROR;
   }
 
+  // The log backend and the RF drivers start their own threads, place them now that they are running
+  threads_apply_placement_all();
+
   // Set metrics
   metricshub.init(enb.get(), args.general.metrics_period_secs);
   metricshub.add_listener(&metrics_screen);
@@ -509,6 +596,13 @@ int main(int argc, char* argv[])
     metrics_file.set_handle(enb.get());
   }
 
+  srsenb::metrics_prometheus metrics_http;
+  if (args.general.metrics_http_enable) {
+    if (metrics_http.init(args.general.metrics_http_address, args.general.metrics_http_port)) {
+      metricshub.add_listener(&metrics_http);
+    }
+  }
+
   // create input thread
   std::thread input(&input_loop, &metrics_screen, (enb_command_interface*)enb.get());
 
@@ -519,6 +613,10 @@ int main(int argc, char* argv[])
   }
   int cnt = 0;
   while (running) {
+    if (mem_dump_requested) {
+      mem_dump_requested = 0;
+      srslte_mem_fprint(stdout);
+    }
     if (args.general.print_buffer_state) {
       cnt++;
       if (cnt == 1000) {
@@ -531,6 +629,10 @@ int main(int argc, char* argv[])
   input.join();
   metricshub.stop();
   enb->stop();
+  if (not args.general.tti_trace_filename.empty()) {
+    cout << srslte::tti_trace::summary_to_string();
+    srslte::tti_trace::write_chrome_trace(args.general.tti_trace_filename);
+  }
   cout << "---  exiting  ---" << endl;
 
   return SRSLTE_SUCCESS;
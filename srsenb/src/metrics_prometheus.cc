@@ -0,0 +1,272 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/metrics_prometheus.h"
+#include "srslte/common/openmetrics_writer.h"
+#include "srslte/common/thread_metrics.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+namespace srsenb {
+
+namespace {
+
+std::string rnti_label(uint16_t rnti, uint32_t cc_idx)
+{
+  char s[64];
+  snprintf(s, sizeof(s), "rnti=\"0x%x\",cell=\"%u\"", rnti, cc_idx);
+  return s;
+}
+
+std::string cell_label(uint32_t cc_idx)
+{
+  return "cell=\"" + std::to_string(cc_idx) + "\"";
+}
+
+/// NaN values, e.g. the MCS of a user without transmissions, are reported as 0
+double value_or_zero(float v)
+{
+  return std::isnan(v) ? 0.0 : v;
+}
+
+/// Statistics of a latency reported as a gauge each, with the suffix appended to the name of the latency
+struct latency_quantile_t {
+  const char* suffix;
+  const char* help;
+  uint32_t srslte::latency_stats_t::*value;
+};
+const latency_quantile_t latency_quantiles[] = {
+    {"_p50_seconds", "Median", &srslte::latency_stats_t::p50_us},
+    {"_p99_seconds", "99th percentile", &srslte::latency_stats_t::p99_us},
+    {"_max_seconds", "Maximum", &srslte::latency_stats_t::max_us},
+};
+
+} // namespace
+
+bool metrics_prometheus::init(const std::string& address, uint16_t port)
+{
+  return server.init(address, port, [this]() { return scrape(); });
+}
+
+void metrics_prometheus::stop()
+{
+  server.stop();
+}
+
+void metrics_prometheus::set_metrics(const enb_metrics_t& metrics, const uint32_t period_usec)
+{
+  const mac_metrics_t* mac    = metrics.stack.mac;
+  uint32_t             nof_ue = std::min<uint32_t>(metrics.stack.rrc.n_ues, ENB_METRICS_MAX_USERS);
+
+  // Accumulate the counters of the period, forgetting the users that left
+  std::map<uint16_t, ue_totals_t> new_ue_totals;
+  std::map<uint32_t, float>       cell_dl_brate, cell_ul_brate;
+  std::map<uint32_t, uint32_t>    cell_nof_ue;
+  for (auto& c : cell_totals) {
+    cell_nof_ue[c.first] = 0;
+  }
+  for (uint32_t i = 0; i < nof_ue; i++) {
+    ue_totals_t& t = new_ue_totals[mac[i].rnti];
+    t              = ue_totals[mac[i].rnti];
+    ue_totals_t& c = cell_totals[mac[i].cc_idx];
+    for (ue_totals_t* p : {&t, &c}) {
+      p->dl_pkts += mac[i].tx_pkts;
+      p->dl_errors += mac[i].tx_errors;
+      p->dl_bytes += mac[i].tx_brate / 8;
+      p->ul_pkts += mac[i].rx_pkts;
+      p->ul_errors += mac[i].rx_errors;
+      p->ul_bytes += mac[i].rx_brate / 8;
+    }
+    cell_nof_ue[mac[i].cc_idx]++;
+    if (mac[i].nof_tti > 0) {
+      cell_dl_brate[mac[i].cc_idx] += mac[i].tx_brate / (mac[i].nof_tti * 1e-3f);
+      cell_ul_brate[mac[i].cc_idx] += mac[i].rx_brate / (mac[i].nof_tti * 1e-3f);
+    }
+  }
+  ue_totals = std::move(new_ue_totals);
+
+  rf_totals.rf_o += metrics.rf.rf_o;
+  rf_totals.rf_u += metrics.rf.rf_u;
+  rf_totals.rf_l += metrics.rf.rf_l;
+  rf_totals.tx_late_drop += metrics.rf.tx_late_drop;
+
+  srslte::openmetrics_writer w("srsenb_");
+
+  w.family("ues", "gauge", "Number of connected users");
+  w.sample(metrics.stack.rrc.n_ues);
+  w.family("s1ap_connected", "gauge", "Whether the S1 connection to the MME is up");
+  w.sample(metrics.stack.s1ap.status == S1AP_READY ? 1 : 0);
+
+  // Radio
+  w.family("rf_overflows_total", "counter", "Receive overflows of the radio");
+  w.sample(rf_totals.rf_o);
+  w.family("rf_underflows_total", "counter", "Transmit underflows of the radio");
+  w.sample(rf_totals.rf_u);
+  w.family("rf_late_total", "counter", "Late transmissions of the radio");
+  w.sample(rf_totals.rf_l);
+  w.family("rf_tx_late_drops_total", "counter", "Bursts dropped because they would have been transmitted late");
+  w.sample(rf_totals.tx_late_drop);
+  w.family("rf_tx_lead_min_seconds", "gauge", "Minimum time left until a burst is on air when it reaches the driver");
+  w.sample(metrics.rf.tx_lead_min_ms * 1e-3);
+
+  // Cells
+  w.family("cell_ues", "gauge", "Number of users whose PCell is the cell");
+  for (auto& c : cell_nof_ue) {
+    w.sample(cell_label(c.first), c.second);
+  }
+  w.family("cell_dl_bitrate_bps", "gauge", "DL MAC bitrate of the cell in the last period");
+  for (auto& c : cell_totals) {
+    w.sample(cell_label(c.first), cell_dl_brate[c.first]);
+  }
+  w.family("cell_ul_bitrate_bps", "gauge", "UL MAC bitrate of the cell in the last period");
+  for (auto& c : cell_totals) {
+    w.sample(cell_label(c.first), cell_ul_brate[c.first]);
+  }
+  w.family("cell_dl_bytes_total", "counter", "Acknowledged DL MAC bytes of the cell");
+  for (auto& c : cell_totals) {
+    w.sample(cell_label(c.first), c.second.dl_bytes);
+  }
+  w.family("cell_ul_bytes_total", "counter", "Correctly received UL MAC bytes of the cell");
+  for (auto& c : cell_totals) {
+    w.sample(cell_label(c.first), c.second.ul_bytes);
+  }
+
+  // Users
+  struct ue_gauge_t {
+    const char* name;
+    const char* help;
+    double (*get)(const mac_metrics_t&, const phy_metrics_t&);
+  };
+  static const ue_gauge_t ue_gauges[] = {
+      {"ue_dl_cqi", "Average wideband CQI reported by the user",
+       [](const mac_metrics_t& m, const phy_metrics_t&) { return value_or_zero(m.dl_cqi); }},
+      {"ue_dl_ri", "Average rank indicator reported by the user",
+       [](const mac_metrics_t& m, const phy_metrics_t&) { return value_or_zero(m.dl_ri); }},
+      {"ue_dl_mcs", "Average DL MCS of the user",
+       [](const mac_metrics_t&, const phy_metrics_t& p) { return value_or_zero(p.dl.mcs); }},
+      {"ue_ul_mcs", "Average UL MCS of the user",
+       [](const mac_metrics_t&, const phy_metrics_t& p) { return value_or_zero(p.ul.mcs); }},
+      {"ue_ul_sinr_db", "Average PUSCH SINR of the user",
+       [](const mac_metrics_t&, const phy_metrics_t& p) { return value_or_zero(p.ul.sinr); }},
+      {"ue_ul_turbo_iters", "Average turbo decoder iterations of the user",
+       [](const mac_metrics_t&, const phy_metrics_t& p) { return value_or_zero(p.ul.turbo_iters); }},
+      {"ue_phr_db", "Average power headroom reported by the user",
+       [](const mac_metrics_t& m, const phy_metrics_t&) { return value_or_zero(m.phr); }},
+      {"ue_dl_buffer_bytes", "Bytes pending in the DL buffers of the user",
+       [](const mac_metrics_t& m, const phy_metrics_t&) { return (double)m.dl_buffer; }},
+      {"ue_ul_buffer_bytes", "Bytes pending in the UL buffers reported by the user",
+       [](const mac_metrics_t& m, const phy_metrics_t&) { return (double)m.ul_buffer; }},
+      {"ue_dl_bitrate_bps", "DL MAC bitrate of the user in the last period",
+       [](const mac_metrics_t& m, const phy_metrics_t&) {
+         return m.nof_tti > 0 ? m.tx_brate / (m.nof_tti * 1e-3) : 0.0;
+       }},
+      {"ue_ul_bitrate_bps", "UL MAC bitrate of the user in the last period",
+       [](const mac_metrics_t& m, const phy_metrics_t&) {
+         return m.nof_tti > 0 ? m.rx_brate / (m.nof_tti * 1e-3) : 0.0;
+       }},
+  };
+  for (const ue_gauge_t& g : ue_gauges) {
+    w.family(g.name, "gauge", g.help);
+    for (uint32_t i = 0; i < nof_ue; i++) {
+      w.sample(rnti_label(mac[i].rnti, mac[i].cc_idx), g.get(mac[i], metrics.phy[i]));
+    }
+  }
+  w.family("ue_rrc_state", "gauge", "RRC state of the user, RRC_STATE_REGISTERED is 7");
+  for (uint32_t i = 0; i < nof_ue; i++) {
+    w.sample(rnti_label(mac[i].rnti, mac[i].cc_idx), metrics.stack.rrc.ues[i].state);
+  }
+
+  struct ue_counter_t {
+    const char* name;
+    const char* help;
+    uint64_t ue_totals_t::*total;
+  };
+  static const ue_counter_t ue_counters[] = {
+      {"ue_dl_pkts_total", "DL transport blocks sent to the user", &ue_totals_t::dl_pkts},
+      {"ue_dl_errors_total", "DL transport blocks not acknowledged by the user", &ue_totals_t::dl_errors},
+      {"ue_dl_bytes_total", "Acknowledged DL MAC bytes of the user", &ue_totals_t::dl_bytes},
+      {"ue_ul_pkts_total", "UL transport blocks received from the user", &ue_totals_t::ul_pkts},
+      {"ue_ul_errors_total", "UL transport blocks of the user with CRC errors", &ue_totals_t::ul_errors},
+      {"ue_ul_bytes_total", "Correctly received UL MAC bytes of the user", &ue_totals_t::ul_bytes},
+  };
+  for (const ue_counter_t& c : ue_counters) {
+    w.family(c.name, "counter", c.help);
+    for (uint32_t i = 0; i < nof_ue; i++) {
+      w.sample(rnti_label(mac[i].rnti, mac[i].cc_idx), ue_totals[mac[i].rnti].*c.total);
+    }
+  }
+
+  // Latencies of the last period, left out when nothing was observed
+  for (const latency_quantile_t& q : latency_quantiles) {
+    std::string help = std::string(q.help) + " time from the build of the DL MAC PDUs of the user until their HARQ ACK";
+    w.family((std::string("ue_harq_ack_delay") + q.suffix).c_str(), "gauge", help.c_str());
+    for (uint32_t i = 0; i < nof_ue; i++) {
+      if (mac[i].harq_ack_delay.count > 0) {
+        w.sample(rnti_label(mac[i].rnti, mac[i].cc_idx), mac[i].harq_ack_delay.*q.value * 1e-6);
+      }
+    }
+  }
+  struct bearer_latency_t {
+    const char* name;
+    const char* help;
+    srslte::latency_stats_t srslte::rlc_bearer_metrics_t::*stats;
+  };
+  static const bearer_latency_t bearer_latencies[] = {
+      {"ue_bearer_dl_upper_delay", " time of the DL SDUs of the bearer from their reception by GTP-U until RLC",
+       &srslte::rlc_bearer_metrics_t::upper_delay},
+      {"ue_bearer_dl_queue_delay", " time of the DL SDUs of the bearer in the RLC queue",
+       &srslte::rlc_bearer_metrics_t::queue_delay},
+  };
+  for (const bearer_latency_t& l : bearer_latencies) {
+    for (const latency_quantile_t& q : latency_quantiles) {
+      w.family((std::string(l.name) + q.suffix).c_str(), "gauge", (std::string(q.help) + l.help).c_str());
+      for (uint32_t i = 0; i < nof_ue; i++) {
+        for (uint32_t lcid = 0; lcid < SRSLTE_N_RADIO_BEARERS; lcid++) {
+          const srslte::latency_stats_t& stats = metrics.stack.rlc[i].bearer[lcid].*l.stats;
+          if (stats.count > 0) {
+            w.sample(rnti_label(mac[i].rnti, mac[i].cc_idx) + ",lcid=\"" + std::to_string(lcid) + "\"",
+                     stats.*q.value * 1e-6);
+          }
+        }
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  last_report = std::move(w.str());
+}
+
+std::string metrics_prometheus::scrape()
+{
+  std::string text;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    text = last_report;
+  }
+  srslte::thread_metrics::write_openmetrics("srsenb_", text);
+  srslte::thread_metrics::write_thread_cpu_time("srsenb_", text);
+  srslte::thread_metrics::write_memory_usage("srsenb_", text);
+  return text;
+}
+
+} // namespace srsenb
@@ -43,23 +43,54 @@ void parser::add_section(parser::section* s)
   sections.push_back(s);
 }
 
-int parser::parse()
+std::map<std::string, parser::cached_file_t> parser::file_cache;
+
+Config* parser::get_file(const std::string& filename)
 {
-  // open file
-  Config cfg;
+  struct stat st = {};
+  if (stat(filename.c_str(), &st) != 0) {
+    std::cerr << "I/O error while reading file: " << filename << std::endl;
+    file_cache.erase(filename);
+    return nullptr;
+  }
+
+  cached_file_t& f = file_cache[filename];
+  if (f.cfg != nullptr and f.dev == st.st_dev and f.ino == st.st_ino and f.size == st.st_size and
+      f.mtime.tv_sec == st.st_mtim.tv_sec and f.mtime.tv_nsec == st.st_mtim.tv_nsec and
+      f.ctime.tv_sec == st.st_ctim.tv_sec and f.ctime.tv_nsec == st.st_ctim.tv_nsec) {
+    return f.cfg.get();
+  }
 
+  std::unique_ptr<Config> cfg(new Config);
   try {
-    cfg.readFile(filename.c_str());
+    cfg->readFile(filename.c_str());
   } catch (const FileIOException& fioex) {
     std::cerr << "I/O error while reading file: " << filename << std::endl;
-    return (-1);
+    file_cache.erase(filename);
+    return nullptr;
   } catch (const ParseException& pex) {
     std::cerr << "Parse error at " << pex.getFile() << ":" << pex.getLine() << " - " << pex.getError() << std::endl;
+    file_cache.erase(filename);
+    return nullptr;
+  }
+  f.cfg   = std::move(cfg);
+  f.dev   = st.st_dev;
+  f.ino   = st.st_ino;
+  f.size  = st.st_size;
+  f.mtime = st.st_mtim;
+  f.ctime = st.st_ctim;
+  return f.cfg.get();
+}
+
+int parser::parse()
+{
+  Config* cfg = get_file(filename);
+  if (cfg == nullptr) {
     return (-1);
   }
 
   for (auto s : sections) {
-    if (s->parse(cfg.getRoot())) {
+    if (s->parse(cfg->getRoot())) {
       return -1;
     }
   }
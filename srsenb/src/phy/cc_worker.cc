@@ -21,6 +21,7 @@
 
 #include "srslte/common/log.h"
 #include "srslte/common/threads.h"
+#include "srslte/common/tti_trace.h"
 #include "srslte/srslte.h"
 
 #include "srsenb/hdr/phy/cc_worker.h"
@@ -61,14 +62,24 @@ cc_worker::cc_worker()
 
 cc_worker::~cc_worker()
 {
+  // Stop the PUSCH and PDSCH helpers before releasing their receivers and transmitters
+  pusch_ue_pool.reset();
+  pdsch_ue_pool.reset();
+
   srslte_softbuffer_tx_free(&temp_mbsfn_softbuffer);
   srslte_enb_dl_free(&enb_dl);
   srslte_enb_ul_free(&enb_ul);
+  if (pusch_cb_pool_ready) {
+    srslte_sch_cb_pool_free(&pusch_cb_pool);
+  }
 
   for (int p = 0; p < SRSLTE_MAX_PORTS; p++) {
     if (signal_buffer_rx[p]) {
       free(signal_buffer_rx[p]);
     }
+    if (signal_buffer_rx_s[p]) {
+      free(signal_buffer_rx_s[p]);
+    }
     if (signal_buffer_tx[p]) {
       free(signal_buffer_tx[p]);
     }
@@ -101,6 +112,14 @@ void cc_worker::init(phy_common* phy_, srslte::log* log_h_, uint32_t cc_idx_)
       return;
     }
     srslte_vec_cf_zero(signal_buffer_rx[p], 2 * sf_len);
+    if (phy->params.rx_int16) {
+      signal_buffer_rx_s[p] = srslte_vec_i16_malloc(2 * sf_len);
+      if (!signal_buffer_rx_s[p]) {
+        ERROR("Error allocating memory\n");
+        return;
+      }
+      srslte_vec_i16_zero(signal_buffer_rx_s[p], 2 * sf_len);
+    }
     signal_buffer_tx[p] = srslte_vec_cf_malloc(2 * sf_len);
     if (!signal_buffer_tx[p]) {
       ERROR("Error allocating memory\n");
@@ -112,6 +131,13 @@ void cc_worker::init(phy_common* phy_, srslte::log* log_h_, uint32_t cc_idx_)
     ERROR("Error initiating ENB DL\n");
     return;
   }
+  // One extra PDSCH transmitter for each PDSCH helper thread
+  uint32_t nof_pdsch_helpers = phy->params.pdsch_ue_workers > 0 ? (uint32_t)phy->params.pdsch_ue_workers : 0;
+  if (srslte_enb_dl_add_pdsch_tx(&enb_dl, nof_pdsch_helpers)) {
+    ERROR("Error initiating ENB DL PDSCH transmitters\n");
+    return;
+  }
+
   if (srslte_enb_dl_set_cell(&enb_dl, cell)) {
     ERROR("Error initiating ENB DL\n");
     return;
@@ -121,6 +147,15 @@ void cc_worker::init(phy_common* phy_, srslte::log* log_h_, uint32_t cc_idx_)
     return;
   }
 
+  // One extra PUSCH receiver for each PUSCH helper thread
+  uint32_t nof_pusch_helpers = phy->params.pusch_ue_workers > 0 ? (uint32_t)phy->params.pusch_ue_workers : 0;
+  if (srslte_enb_ul_add_pusch_rx(&enb_ul, nof_pusch_helpers)) {
+    ERROR("Error initiating ENB UL PUSCH receivers\n");
+    return;
+  }
+
+  srslte_enb_ul_set_dmrs_cache(&enb_ul, phy->get_dmrs_cache(cc_idx));
+
   if (srslte_enb_ul_set_cell(&enb_ul, cell, &phy->dmrs_pusch_cfg, nullptr)) {
     ERROR("Error initiating ENB UL\n");
     return;
@@ -147,8 +182,31 @@ void cc_worker::init(phy_common* phy_, srslte::log* log_h_, uint32_t cc_idx_)
   Info("Component Carrier Worker %d configured cell %d PRB\n", cc_idx, nof_prb);
 
   if (phy->params.pusch_8bit_decoder) {
-    enb_ul.pusch.llr_is_8bit        = true;
-    enb_ul.pusch.ul_sch.llr_is_8bit = true;
+    for (uint32_t i = 0; i <= nof_pusch_helpers; i++) {
+      srslte_pusch_t* pusch     = srslte_enb_ul_pusch_rx_pusch(&enb_ul, i);
+      pusch->llr_is_8bit        = true;
+      pusch->ul_sch.llr_is_8bit = true;
+    }
+  }
+
+  if (phy->params.pusch_cb_workers > 0) {
+    if (srslte_sch_cb_pool_init(&pusch_cb_pool, (uint32_t)phy->params.pusch_cb_workers)) {
+      ERROR("Error initiating PUSCH codeblock decoder pool\n");
+      exit(-1);
+    }
+    pusch_cb_pool_ready = true;
+    for (uint32_t i = 0; i <= nof_pusch_helpers; i++) {
+      srslte_sch_set_cb_pool(&srslte_enb_ul_pusch_rx_pusch(&enb_ul, i)->ul_sch, &pusch_cb_pool);
+    }
+  }
+
+  if (nof_pusch_helpers > 0) {
+    pusch_ue_pool.reset(new srslte::task_thread_pool(nof_pusch_helpers));
+    pusch_ue_pool->start();
+  }
+  if (nof_pdsch_helpers > 0) {
+    pdsch_ue_pool.reset(new srslte::task_thread_pool(nof_pdsch_helpers));
+    pdsch_ue_pool->start();
   }
   initiated = true;
 
@@ -163,11 +221,40 @@ void cc_worker::reset()
   ue_db.clear();
 }
 
+int cc_worker::set_cell(const srslte_cell_t& cell)
+{
+  // The buffers, DFT plans and PUSCH DMRS cache of the carrier are kept, only the cell dependent state is regenerated
+  if (srslte_enb_dl_set_cell(&enb_dl, cell)) {
+    ERROR("Error setting ENB DL cell\n");
+    return SRSLTE_ERROR;
+  }
+  if (srslte_enb_ul_set_cell(&enb_ul, cell, &phy->dmrs_pusch_cfg, nullptr)) {
+    ERROR("Error setting ENB UL cell\n");
+    return SRSLTE_ERROR;
+  }
+
+  // The PDSCH/PUSCH scrambling and PUCCH format 2 sequences of the RNTIs depend on the PCI. Those of the carrier RNTIs
+  // are generated again here, the others are generated on their first use
+  for (auto& it : ue_db) {
+    if (pregen_sequences(it.first) != SRSLTE_SUCCESS) {
+      ERROR("Error generating sequences for rnti=0x%x\n", it.first);
+      return SRSLTE_ERROR;
+    }
+  }
+  Info("Component Carrier Worker %d configured cell PCI=%d\n", cc_idx, cell.id);
+  return SRSLTE_SUCCESS;
+}
+
 cf_t* cc_worker::get_buffer_rx(uint32_t antenna_idx)
 {
   return signal_buffer_rx[antenna_idx];
 }
 
+int16_t* cc_worker::get_buffer_rx_s(uint32_t antenna_idx)
+{
+  return signal_buffer_rx_s[antenna_idx];
+}
+
 cf_t* cc_worker::get_buffer_tx(uint32_t antenna_idx)
 {
   return signal_buffer_tx[antenna_idx];
@@ -228,13 +315,29 @@ void cc_worker::work_ul(const srslte_ul_sf_cfg_t& ul_sf_cfg, stack_interface_phy
   log_h->step(ul_sf.tti);
 
   // Process UL signal
-  srslte_enb_ul_fft(&enb_ul);
+  {
+    srslte::tti_span span(srslte::tti_stage::fft);
+    if (phy->rx_int16) {
+      srslte_enb_ul_fft_s(&enb_ul, signal_buffer_rx_s[0]);
+    } else {
+      srslte_enb_ul_fft(&enb_ul);
+    }
+  }
 
   // Decode pending UL grants for the tti they were scheduled
-  decode_pusch(ul_grants.pusch, ul_grants.nof_grants);
+  {
+    srslte::tti_span span(srslte::tti_stage::pusch_decode);
+    decode_pusch(ul_grants.pusch, ul_grants.nof_grants);
+  }
 
   // Decode remaining PUCCH ACKs not associated with PUSCH transmission and SR signals
-  decode_pucch();
+  {
+    srslte::tti_span span(srslte::tti_stage::pucch_decode);
+    decode_pucch();
+  }
+
+  // Measure the sounding reference signals of the users that transmit them in this subframe
+  decode_srs();
 }
 
 void cc_worker::work_dl(const srslte_dl_sf_cfg_t&            dl_sf_cfg,
@@ -243,7 +346,8 @@ void cc_worker::work_dl(const srslte_dl_sf_cfg_t&            dl_sf_cfg,
                         srslte_mbsfn_cfg_t*                  mbsfn_cfg)
 {
   std::lock_guard<std::mutex> lock(mutex);
-  dl_sf = dl_sf_cfg;
+  dl_sf          = dl_sf_cfg;
+  pdcch_nof_msgs = 0;
 
   // Put base signals (references, PBCH, PCFICH and PSS/SSS) into the resource grid
   srslte_enb_dl_put_base(&enb_dl, &dl_sf);
@@ -251,6 +355,7 @@ void cc_worker::work_dl(const srslte_dl_sf_cfg_t&            dl_sf_cfg,
   // Put DL grants to resource grid. PDSCH data will be encoded as well.
   if (dl_sf_cfg.sf_type == SRSLTE_SF_NORM) {
     encode_pdcch_dl(dl_grants.pdsch, dl_grants.nof_grants);
+    srslte::tti_span span(srslte::tti_stage::pdsch_encode);
     encode_pdsch(dl_grants.pdsch, dl_grants.nof_grants);
   } else {
     if (mbsfn_cfg->enable) {
@@ -261,11 +366,16 @@ void cc_worker::work_dl(const srslte_dl_sf_cfg_t&            dl_sf_cfg,
   // Put UL grants to resource grid.
   encode_pdcch_ul(ul_grants.pusch, ul_grants.nof_grants);
 
+  // Encode the DL and UL DCI of the subframe
+  encode_pdcch();
+
   // Put pending PHICH HARQ ACK/NACK indications into subframe
   encode_phich(ul_grants.phich, ul_grants.nof_phich);
 
   // Generate signal and transmit
+  srslte::tti_span ifft_span(srslte::tti_stage::ifft);
   srslte_enb_dl_gen_signal(&enb_dl);
+  ifft_span.stop();
 
   // Scale if cell gain is set
   float cell_gain_db = phy->get_cell_gain(cc_idx);
@@ -278,11 +388,10 @@ void cc_worker::work_dl(const srslte_dl_sf_cfg_t&            dl_sf_cfg,
   }
 }
 
-void cc_worker::decode_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_grant,
-                                  srslte_ul_cfg_t&                           ul_cfg,
-                                  srslte_pusch_res_t&                        pusch_res)
+void cc_worker::prepare_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_grant, pusch_job_t& job)
 {
-  uint16_t rnti = ul_grant.dci.rnti;
+  uint16_t         rnti   = ul_grant.dci.rnti;
+  srslte_ul_cfg_t& ul_cfg = job.ul_cfg;
 
   // Invalid RNTI
   if (rnti == 0) {
@@ -298,7 +407,7 @@ void cc_worker::decode_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_
   ul_cfg = phy->ue_db.get_ul_config(rnti, cc_idx);
 
   // Fill UCI configuration
-  bool uci_required =
+  job.uci_required =
       phy->ue_db.fill_uci_cfg(tti_rx, cc_idx, rnti, ul_grant.dci.cqi_request, true, ul_cfg.pusch.uci_cfg);
 
   if (ul_cfg.pusch.softbuffers.rx) {
@@ -322,20 +431,52 @@ void cc_worker::decode_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_
   }
   phy->ue_db.set_last_ul_tb(rnti, cc_idx, ul_pid, grant.tb);
 
-  // Run PUSCH decoder
+  // Prepare PUSCH decoder
   ul_cfg.pusch.softbuffers.rx = ul_grant.softbuffer_rx;
-  pusch_res.data              = ul_grant.data;
-  if (pusch_res.data) {
-    if (srslte_enb_ul_get_pusch(&enb_ul, &ul_sf, &ul_cfg.pusch, &pusch_res)) {
-      Error("Decoding PUSCH for RNTI %x\n", rnti);
+  job.pusch_res.data          = ul_grant.data;
+  job.valid                   = true;
+}
+
+void cc_worker::decode_pusch_rnti(uint32_t rx_idx, pusch_job_t& job)
+{
+  if (!job.valid) {
+    return;
+  }
+
+  // Run PUSCH decoder
+  if (job.pusch_res.data) {
+    if (srslte_enb_ul_get_pusch_rx(&enb_ul, rx_idx, &ul_sf, &job.ul_cfg.pusch, &job.pusch_res)) {
+      Error("Decoding PUSCH for RNTI %x\n", job.ul_cfg.pusch.rnti);
+      job.valid = false;
       return;
     }
   }
+
+  // Keep the measurements of the receiver that decoded this grant
+  job.chest_res = *srslte_enb_ul_pusch_rx_chest_res(&enb_ul, rx_idx);
+}
+
+void cc_worker::decode_pusch_jobs(uint32_t rx_idx)
+{
+  // Take pending grants until none is left
+  for (uint32_t i = pusch_next_job++; i < pusch_nof_jobs; i = pusch_next_job++) {
+    decode_pusch_rnti(rx_idx, pusch_jobs[i]);
+  }
+}
+
+void cc_worker::report_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_grant, pusch_job_t& job)
+{
+  uint16_t rnti = ul_grant.dci.rnti;
+
+  if (!job.valid) {
+    return;
+  }
+
   // Save PHICH scheduling for this user. Each user can have just 1 PUSCH dci per TTI
-  ue_db[rnti]->phich_grant.n_prb_lowest = grant.n_prb_tilde[0];
+  ue_db[rnti]->phich_grant.n_prb_lowest = job.ul_cfg.pusch.grant.n_prb_tilde[0];
   ue_db[rnti]->phich_grant.n_dmrs       = ul_grant.dci.n_dmrs;
 
-  float snr_db = enb_ul.chest_res.snr_db;
+  float snr_db = job.chest_res.snr_db;
 
   // Notify MAC of RL status
   if (snr_db >= PUSCH_RL_SNR_DB_TH) {
@@ -343,46 +484,84 @@ void cc_worker::decode_pusch_rnti(stack_interface_phy_lte::ul_sched_grant_t& ul_
     phy->stack->snr_info(ul_sf.tti, rnti, cc_idx, snr_db);
 
     // Notify MAC of Time Alignment only if it enabled and valid measurement, ignore value otherwise
-    if (ul_cfg.pusch.meas_ta_en and not std::isnan(enb_ul.chest_res.ta_us) and not std::isinf(enb_ul.chest_res.ta_us)) {
-      phy->stack->ta_info(ul_sf.tti, rnti, enb_ul.chest_res.ta_us);
+    if (job.ul_cfg.pusch.meas_ta_en and not std::isnan(job.chest_res.ta_us) and not std::isinf(job.chest_res.ta_us)) {
+      phy->stack->ta_info(ul_sf.tti, rnti, job.chest_res.ta_us);
     }
   }
 
   // Send UCI data to MAC
-  if (uci_required) {
-    phy->ue_db.send_uci_data(tti_rx, rnti, cc_idx, ul_cfg.pusch.uci_cfg, pusch_res.uci);
+  if (job.uci_required) {
+    phy->ue_db.send_uci_data(tti_rx, rnti, cc_idx, job.ul_cfg.pusch.uci_cfg, job.pusch_res.uci);
   }
 
   // Save statistics only if data was provided
   if (ul_grant.data != nullptr) {
     // Save metrics stats
-    ue_db[rnti]->metrics_ul(ul_grant.dci.tb.mcs_idx, 0, enb_ul.chest_res.snr_db, pusch_res.avg_iterations_block);
+    ue_db[rnti]->metrics_ul(ul_grant.dci.tb.mcs_idx, 0, snr_db, job.pusch_res.avg_iterations_block);
   }
 }
 
 void cc_worker::decode_pusch(stack_interface_phy_lte::ul_sched_grant_t* grants, uint32_t nof_pusch)
 {
-  // Iterate over all the grants, all the grants need to report MAC the CRC status
+  nof_pusch = SRSLTE_MIN(nof_pusch, (uint32_t)stack_interface_phy_lte::MAX_GRANTS);
+
+  // Read the UE configurations and compute the grants, the user database is only accessed from this thread
+  for (uint32_t i = 0; i < nof_pusch; i++) {
+    pusch_jobs[i] = {};
+    prepare_pusch_rnti(grants[i], pusch_jobs[i]);
+  }
+
+  // Decode the grants, in parallel with the PUSCH helpers if there are any
+  pusch_nof_jobs = nof_pusch;
+  pusch_next_job = 0;
+  if (pusch_ue_pool != nullptr && nof_pusch > 1) {
+    uint32_t nof_helpers = SRSLTE_MIN((uint32_t)pusch_ue_pool->nof_workers(), nof_pusch - 1);
+
+    {
+      std::lock_guard<std::mutex> lock(pusch_ue_mutex);
+      pusch_nof_helpers = nof_helpers;
+    }
+
+    for (uint32_t i = 0; i < nof_helpers; i++) {
+      pusch_ue_pool->push_task([this](uint32_t worker_id) {
+        decode_pusch_jobs(worker_id + 1);
+
+        std::lock_guard<std::mutex> lock(pusch_ue_mutex);
+        pusch_nof_helpers--;
+        pusch_ue_cvar.notify_one();
+      });
+    }
+
+    decode_pusch_jobs(0);
+
+    // Wait for all the helpers, their grants may still be in progress
+    std::unique_lock<std::mutex> lock(pusch_ue_mutex);
+    while (pusch_nof_helpers > 0) {
+      pusch_ue_cvar.wait(lock);
+    }
+  } else {
+    decode_pusch_jobs(0);
+  }
+
+  // Iterate over all the grants in order, all the grants need to report MAC the CRC status
   for (uint32_t i = 0; i < nof_pusch; i++) {
     // Get grant itself and RNTI
     stack_interface_phy_lte::ul_sched_grant_t& ul_grant = grants[i];
     uint16_t                                   rnti     = ul_grant.dci.rnti;
+    pusch_job_t&                               job      = pusch_jobs[i];
 
-    srslte_pusch_res_t pusch_res = {};
-    srslte_ul_cfg_t    ul_cfg    = {};
-
-    // Decodes PUSCH for the given grant
-    decode_pusch_rnti(ul_grant, ul_cfg, pusch_res);
+    // Notify MAC of the PUSCH measurements and UCI
+    report_pusch_rnti(ul_grant, job);
 
     // Notify MAC new received data and HARQ Indication value
     if (ul_grant.data != nullptr) {
       // Inform MAC about the CRC result
-      phy->stack->crc_info(tti_rx, rnti, cc_idx, ul_cfg.pusch.grant.tb.tbs / 8, pusch_res.crc);
+      phy->stack->crc_info(tti_rx, rnti, cc_idx, job.ul_cfg.pusch.grant.tb.tbs / 8, job.pusch_res.crc);
 
       // Logging
       if (log_h->get_level() >= srslte::LOG_LEVEL_INFO) {
         char str[512];
-        srslte_pusch_rx_info(&ul_cfg.pusch, &pusch_res, &enb_ul.chest_res, str, sizeof(str));
+        srslte_pusch_rx_info(&job.ul_cfg.pusch, &job.pusch_res, &job.chest_res, str, sizeof(str));
         log_h->info("PUSCH: cc=%d, %s\n", cc_idx, str);
       }
     }
@@ -427,11 +606,56 @@ int cc_worker::decode_pucch()
   return 0;
 }
 
+void cc_worker::decode_srs()
+{
+  // The subbands are the ones of the DL subband CQI reports, the 6 PRB cells only have the wideband measurement
+  int      sb_size = srslte_cqi_hl_get_subband_size(enb_ul.cell.nof_prb);
+  uint32_t nof_sb  = sb_size > 0 ? (uint32_t)srslte_cqi_hl_get_no_subbands(enb_ul.cell.nof_prb) : 0;
+  float    snr_sb_db[SRSLTE_MAX_PRB];
+  if (sb_size <= 0) {
+    sb_size = enb_ul.cell.nof_prb;
+  }
+
+  for (auto& iter : ue_db) {
+    uint16_t rnti = iter.first;
+    if (not SRSLTE_RNTI_ISUSER(rnti)) {
+      continue;
+    }
+
+    srslte_ul_cfg_t ul_cfg = phy->ue_db.get_ul_config(rnti, cc_idx);
+    if (not ul_cfg.srs.configured or
+        srslte_refsignal_srs_send_cs(ul_cfg.srs.subframe_config, ul_sf.tti % SRSLTE_NOF_SF_X_FRAME) != 1 or
+        srslte_refsignal_srs_send_ue(ul_cfg.srs.I_srs, ul_sf.tti) != 1) {
+      continue;
+    }
+
+    if (srslte_enb_ul_get_srs(&enb_ul, &ul_sf, &ul_cfg.srs, &phy->dmrs_pusch_cfg, sb_size, snr_sb_db)) {
+      Error("SRS: Error estimating rnti=0x%x\n", rnti);
+      continue;
+    }
+
+    // The wideband SNR drives the UL MCS as the PUSCH one, the subbands drive the frequency-selective allocation
+    if (enb_ul.chest_res.snr_db >= PUSCH_RL_SNR_DB_TH) {
+      phy->stack->snr_info(ul_sf.tti, rnti, cc_idx, enb_ul.chest_res.snr_db);
+      phy->stack->ul_sb_snr_info(ul_sf.tti, rnti, cc_idx, snr_sb_db, nof_sb);
+    }
+
+    Info("SRS: rnti=0x%x, snr=%.1f dB, tti=%d\n", rnti, enb_ul.chest_res.snr_db, ul_sf.tti);
+  }
+}
+
 int cc_worker::encode_phich(stack_interface_phy_lte::ul_sched_ack_t* acks, uint32_t nof_acks)
 {
-  for (uint32_t i = 0; i < nof_acks; i++) {
+  srslte_phich_grant_t grants[stack_interface_phy_lte::MAX_GRANTS];
+  uint8_t              hi[stack_interface_phy_lte::MAX_GRANTS];
+  uint32_t             nof_hi = 0;
+
+  // All the HI of the subframe are encoded at once, one pass per PHICH group
+  for (uint32_t i = 0; i < nof_acks && nof_hi < (uint32_t)stack_interface_phy_lte::MAX_GRANTS; i++) {
     if (acks[i].rnti && ue_db.count(acks[i].rnti)) {
-      srslte_enb_dl_put_phich(&enb_dl, &ue_db[acks[i].rnti]->phich_grant, acks[i].ack);
+      grants[nof_hi] = ue_db[acks[i].rnti]->phich_grant;
+      hi[nof_hi]     = acks[i].ack;
+      nof_hi++;
 
       Info("PHICH: rnti=0x%x, hi=%d, I_lowest=%d, n_dmrs=%d, tti_tx_dl=%d\n",
            acks[i].rnti,
@@ -441,7 +665,7 @@ int cc_worker::encode_phich(stack_interface_phy_lte::ul_sched_ack_t* acks, uint3
            tti_tx_dl);
     }
   }
-  return SRSLTE_SUCCESS;
+  return srslte_enb_dl_put_phich_batch(&enb_dl, grants, hi, nof_hi);
 }
 
 int cc_worker::encode_pdcch_ul(stack_interface_phy_lte::ul_sched_grant_t* grants, uint32_t nof_grants)
@@ -458,10 +682,12 @@ int cc_worker::encode_pdcch_ul(stack_interface_phy_lte::ul_sched_grant_t* grants
         }
       }
 
-      if (srslte_enb_dl_put_pdcch_ul(&enb_dl, &dci_cfg, &grants[i].dci)) {
+      if (pdcch_nof_msgs >= 2 * stack_interface_phy_lte::MAX_GRANTS ||
+          srslte_enb_dl_pack_pdcch_ul(&enb_dl, &dci_cfg, &grants[i].dci, &pdcch_msgs[pdcch_nof_msgs])) {
         ERROR("Error putting PUSCH %d\n", i);
         return SRSLTE_ERROR;
       }
+      pdcch_nof_msgs++;
 
       // Logging
       if (log_h->get_level() >= srslte::LOG_LEVEL_INFO) {
@@ -488,10 +714,12 @@ int cc_worker::encode_pdcch_dl(stack_interface_phy_lte::dl_sched_grant_t* grants
         }
       }
 
-      if (srslte_enb_dl_put_pdcch_dl(&enb_dl, &dci_cfg, &grants[i].dci)) {
+      if (pdcch_nof_msgs >= 2 * stack_interface_phy_lte::MAX_GRANTS ||
+          srslte_enb_dl_pack_pdcch_dl(&enb_dl, &dci_cfg, &grants[i].dci, &pdcch_msgs[pdcch_nof_msgs])) {
         ERROR("Error putting PDCCH %d\n", i);
         return SRSLTE_ERROR;
       }
+      pdcch_nof_msgs++;
 
       if (LOG_THIS(rnti) and log_h->get_level() >= srslte::LOG_LEVEL_INFO) {
         // Logging
@@ -504,6 +732,14 @@ int cc_worker::encode_pdcch_dl(stack_interface_phy_lte::dl_sched_grant_t* grants
   return 0;
 }
 
+int cc_worker::encode_pdcch()
+{
+  // All the DCI of the subframe are scrambled, modulated and mapped to the control region in one pass
+  int ret        = srslte_enb_dl_put_pdcch_batch(&enb_dl, pdcch_msgs, pdcch_nof_msgs);
+  pdcch_nof_msgs = 0;
+  return ret;
+}
+
 int cc_worker::encode_pmch(stack_interface_phy_lte::dl_sched_grant_t* grant, srslte_mbsfn_cfg_t* mbsfn_cfg)
 {
   srslte_pmch_cfg_t pmch_cfg;
@@ -534,57 +770,128 @@ int cc_worker::encode_pmch(stack_interface_phy_lte::dl_sched_grant_t* grant, srs
   return SRSLTE_SUCCESS;
 }
 
+bool cc_worker::prepare_pdsch_rnti(stack_interface_phy_lte::dl_sched_grant_t& grant, pdsch_job_t& job)
+{
+  uint16_t rnti = grant.dci.rnti;
+
+  if (!rnti || !ue_db.count(rnti)) {
+    Error("User rnti=0x%x not found in cc_worker=%d\n", rnti, cc_idx);
+    return false;
+  }
+
+  job.dl_cfg = phy->ue_db.get_dl_config(rnti, cc_idx);
+
+  // Compute DL grant
+  if (srslte_ra_dl_dci_to_grant(&enb_dl.cell,
+                                &dl_sf,
+                                job.dl_cfg.tm,
+                                job.dl_cfg.pdsch.use_tbs_index_alt,
+                                &grant.dci,
+                                &job.dl_cfg.pdsch.grant)) {
+    Error("Computing DL grant\n");
+  }
+
+  // Set soft buffer
+  for (uint32_t j = 0; j < SRSLTE_MAX_CODEWORDS; j++) {
+    job.dl_cfg.pdsch.softbuffers.tx[j] = grant.softbuffer_tx[j];
+  }
+
+  job.valid = true;
+
+  // Grants can only be encoded concurrently if each of them writes its own resource elements only
+  return srslte_pdsch_encode_is_grant_local(&enb_dl.pdsch, &job.dl_cfg.pdsch);
+}
+
+void cc_worker::encode_pdsch_jobs(uint32_t tx_idx, stack_interface_phy_lte::dl_sched_grant_t* grants)
+{
+  // Take pending grants until none is left
+  for (uint32_t i = pdsch_next_job++; i < pdsch_nof_jobs; i = pdsch_next_job++) {
+    pdsch_job_t& job = pdsch_jobs[i];
+    if (job.valid) {
+      job.ret = srslte_enb_dl_put_pdsch_tx(&enb_dl, tx_idx, &job.dl_cfg.pdsch, grants[i].data);
+    }
+  }
+}
+
 int cc_worker::encode_pdsch(stack_interface_phy_lte::dl_sched_grant_t* grants, uint32_t nof_grants)
 {
+  nof_grants = SRSLTE_MIN(nof_grants, (uint32_t)stack_interface_phy_lte::MAX_GRANTS);
 
-  /* Scales the Resources Elements affected by the power allocation (p_b) */
-  // srslte_enb_dl_prepare_power_allocation(&enb_dl);
+  // Read the UE configurations and compute the grants, the user database is only accessed from this thread
+  bool parallel = (pdsch_ue_pool != nullptr && nof_grants > 1);
   for (uint32_t i = 0; i < nof_grants; i++) {
-    uint16_t rnti = grants[i].dci.rnti;
-
-    if (rnti && ue_db.count(rnti)) {
-      srslte_dl_cfg_t dl_cfg = phy->ue_db.get_dl_config(rnti, cc_idx);
+    pdsch_jobs[i] = {};
+    if (!prepare_pdsch_rnti(grants[i], pdsch_jobs[i]) && pdsch_jobs[i].valid) {
+      parallel = false;
+    }
+  }
 
-      // Compute DL grant
-      if (srslte_ra_dl_dci_to_grant(
-              &enb_dl.cell, &dl_sf, dl_cfg.tm, dl_cfg.pdsch.use_tbs_index_alt, &grants[i].dci, &dl_cfg.pdsch.grant)) {
-        Error("Computing DL grant\n");
-      }
+  // Encode the grants, in parallel with the PDSCH helpers if there are any
+  pdsch_nof_jobs = nof_grants;
+  pdsch_next_job = 0;
+  if (parallel) {
+    uint32_t nof_helpers = SRSLTE_MIN((uint32_t)pdsch_ue_pool->nof_workers(), nof_grants - 1);
 
-      // Set soft buffer
-      for (uint32_t j = 0; j < SRSLTE_MAX_CODEWORDS; j++) {
-        dl_cfg.pdsch.softbuffers.tx[j] = grants[i].softbuffer_tx[j];
-      }
+    {
+      std::lock_guard<std::mutex> lock(pdsch_ue_mutex);
+      pdsch_nof_helpers = nof_helpers;
+    }
 
-      // Encode PDSCH
-      if (srslte_enb_dl_put_pdsch(&enb_dl, &dl_cfg.pdsch, grants[i].data)) {
-        Error("Error putting PDSCH %d\n", i);
-        return SRSLTE_ERROR;
-      }
+    for (uint32_t i = 0; i < nof_helpers; i++) {
+      pdsch_ue_pool->push_task([this, grants](uint32_t worker_id) {
+        encode_pdsch_jobs(worker_id + 1, grants);
 
-      // Save pending ACK
-      if (SRSLTE_RNTI_ISUSER(rnti)) {
-        // Push whole DCI
-        phy->ue_db.set_ack_pending(tti_tx_ul, cc_idx, grants[i].dci);
-      }
+        std::lock_guard<std::mutex> lock(pdsch_ue_mutex);
+        pdsch_nof_helpers--;
+        pdsch_ue_cvar.notify_one();
+      });
+    }
 
-      if (LOG_THIS(rnti) and log_h->get_level() >= srslte::LOG_LEVEL_INFO) {
-        // Logging
-        char str[512];
-        srslte_pdsch_tx_info(&dl_cfg.pdsch, str, 512);
-        log_h->info("PDSCH: cc=%d, %s, tti_tx_dl=%d\n", cc_idx, str, tti_tx_dl);
-      }
+    encode_pdsch_jobs(0, grants);
 
-      // Save metrics stats
-      ue_db[rnti]->metrics_dl(grants[i].dci.tb[0].mcs_idx);
-    } else {
-      Error("User rnti=0x%x not found in cc_worker=%d\n", rnti, cc_idx);
+    // Wait for all the helpers, their grants may still be in progress
+    std::unique_lock<std::mutex> lock(pdsch_ue_mutex);
+    while (pdsch_nof_helpers > 0) {
+      pdsch_ue_cvar.wait(lock);
     }
+  } else {
+    encode_pdsch_jobs(0, grants);
   }
 
-  // srslte_enb_dl_apply_power_allocation(&enb_dl);
+  // Report the grants in order
+  int ret = SRSLTE_SUCCESS;
+  for (uint32_t i = 0; i < nof_grants; i++) {
+    uint16_t     rnti = grants[i].dci.rnti;
+    pdsch_job_t& job  = pdsch_jobs[i];
 
-  return SRSLTE_SUCCESS;
+    if (!job.valid) {
+      continue;
+    }
+
+    if (job.ret) {
+      Error("Error putting PDSCH %d\n", i);
+      ret = SRSLTE_ERROR;
+      continue;
+    }
+
+    // Save pending ACK
+    if (SRSLTE_RNTI_ISUSER(rnti)) {
+      // Push whole DCI
+      phy->ue_db.set_ack_pending(tti_tx_ul, cc_idx, grants[i].dci);
+    }
+
+    if (LOG_THIS(rnti) and log_h->get_level() >= srslte::LOG_LEVEL_INFO) {
+      // Logging
+      char str[512];
+      srslte_pdsch_tx_info(&job.dl_cfg.pdsch, str, 512);
+      log_h->info("PDSCH: cc=%d, %s, tti_tx_dl=%d\n", cc_idx, str, tti_tx_dl);
+    }
+
+    // Save metrics stats
+    ue_db[rnti]->metrics_dl(grants[i].dci.tb[0].mcs_idx);
+  }
+
+  return ret;
 }
 
 /************ METRICS interface ********************/
@@ -25,6 +25,7 @@
 #include <string>
 #include <strings.h>
 #include <sys/mman.h>
+#include <thread>
 #include <unistd.h>
 
 #include "srsenb/hdr/phy/phy.h"
@@ -110,22 +111,64 @@ int phy::init(const phy_args_t&            args,
   radio       = radio_;
   nof_workers = args.nof_phy_threads;
 
+  // A subframe is transmitted FDD_HARQ_DELAY_UL_MS after its reception, no more workers than that can be in flight
+  if (nof_workers > FDD_HARQ_DELAY_UL_MS) {
+    srslte::console("Using %d PHY threads, the HARQ delay is %d ms\n", FDD_HARQ_DELAY_UL_MS, FDD_HARQ_DELAY_UL_MS);
+    nof_workers = FDD_HARQ_DELAY_UL_MS;
+  }
+
   workers_common.params = args;
 
+  parse_common_config(cfg);
+
   workers_common.init(cfg.phy_cell_cfg, radio, stack_);
 
-  parse_common_config(cfg);
+  // Plan the DFTs of every bandwidth up to the largest cell once, workers and reconfigurations reuse the plans
+  uint32_t max_prb = 0;
+  for (const phy_cell_cfg_t& cell_cfg : cfg.phy_cell_cfg) {
+    max_prb = SRSLTE_MAX(max_prb, cell_cfg.cell.nof_prb);
+  }
+  if (max_prb > 0 &&
+      (srslte_enb_dl_preplan(max_prb) != SRSLTE_SUCCESS || srslte_enb_ul_preplan(max_prb) != SRSLTE_SUCCESS)) {
+    log_h->warning("Error pre-planning DFTs for %d PRB\n", max_prb);
+  }
+
+  // Each worker runs on the CPUs of one NUMA node, its buffers are placed on that node when they are first touched
+  if (args.numa_workers && !threads_spread_placement("WORKER", nof_workers)) {
+    log_h->info("The PHY workers are not spread, their CPUs are on a single NUMA node\n");
+  }
+
+  // Initialise the workers concurrently, one thread each, so that the memory policy of a NUMA node only applies to
+  // the buffers of its worker. The DFT plans are shared through the plan cache
+  std::vector<std::thread> init_threads;
+  for (uint32_t i = 0; i < nof_workers; i++) {
+    init_threads.emplace_back([this, i, &args]() {
+      int node = args.numa_workers ? threads_placement_node(("WORKER" + std::to_string(i)).c_str()) : -1;
+      if (node >= 0 && !threads_set_memory_node(node)) {
+        log_h->warning("Error placing the buffers of worker %d on NUMA node %d\n", i, node);
+      }
+      workers[i].init(&workers_common, log_vec.at(i).get());
+    });
+  }
+  for (std::thread& t : init_threads) {
+    t.join();
+  }
 
   // Add workers to workers pool and start threads
   for (uint32_t i = 0; i < nof_workers; i++) {
-    workers[i].init(&workers_common, log_vec.at(i).get());
     workers_pool.init_worker(i, &workers[i], WORKERS_THREAD_PRIO);
   }
 
   // For each carrier, initialise PRACH worker
   for (uint32_t cc = 0; cc < cfg.phy_cell_cfg.size(); cc++) {
     prach_cfg.root_seq_idx = cfg.phy_cell_cfg[cc].root_seq_idx;
-    prach.init(cc, cfg.phy_cell_cfg[cc].cell, prach_cfg, stack_, log_vec.at(0).get(), PRACH_WORKER_THREAD_PRIO);
+    prach.init(cc,
+               cfg.phy_cell_cfg[cc].cell,
+               prach_cfg,
+               stack_,
+               log_vec.at(0).get(),
+               PRACH_WORKER_THREAD_PRIO,
+               (uint32_t)args.prach_workers);
   }
   prach.set_max_prach_offset_us(args.max_prach_offset_us);
 
@@ -225,6 +268,50 @@ void phy::cmd_cell_gain(uint32_t cell_id, float gain_db)
   workers_common.set_cell_gain(cell_id, gain_db);
 }
 
+int phy::cmd_cell_pci(uint32_t cell_id, uint32_t pci)
+{
+  uint32_t cc_idx = workers_common.get_cc_idx(cell_id);
+  if (cc_idx >= workers_common.get_nof_carriers()) {
+    srslte::console("cell ID %d not found\n", cell_id);
+    return SRSLTE_ERROR;
+  }
+
+  srslte_cell_t cell = workers_common.get_cell(cc_idx);
+  cell.id            = pci;
+  return reconfigure_cell(cc_idx, cell);
+}
+
+int phy::reconfigure_cell(uint32_t cc_idx, const srslte_cell_t& cell)
+{
+  srslte_cell_t current = workers_common.get_cell(cc_idx);
+  if (cc_idx >= workers_common.get_nof_carriers() || cell.id >= SRSLTE_NUM_PCI || cell.nof_prb != current.nof_prb ||
+      cell.nof_ports != current.nof_ports || cell.cp != current.cp || cell.phich_length != current.phich_length ||
+      cell.phich_resources != current.phich_resources || cell.frame_type != current.frame_type) {
+    log_h->error("Only the PCI of carrier %d can be changed without restarting\n", cc_idx);
+    return SRSLTE_ERROR;
+  }
+
+  int ret = SRSLTE_SUCCESS;
+  tx_rx.run_drained([this, cc_idx, &cell, &ret]() {
+    if (not workers_common.set_cell(cc_idx, cell)) {
+      ret = SRSLTE_ERROR;
+      return;
+    }
+    for (uint32_t i = 0; i < nof_workers; i++) {
+      if (workers[i].set_cell(cc_idx, cell) != SRSLTE_SUCCESS) {
+        ret = SRSLTE_ERROR;
+      }
+    }
+  });
+
+  if (ret == SRSLTE_SUCCESS) {
+    log_h->info("Carrier %d reconfigured with PCI=%d\n", cc_idx, cell.id);
+  } else {
+    log_h->error("Error reconfiguring carrier %d with PCI=%d\n", cc_idx, cell.id);
+  }
+  return ret;
+}
+
 /***** RRC->PHY interface **********/
 
 void phy::set_config(uint16_t rnti, const phy_rrc_cfg_list_t& phy_cfg_list)
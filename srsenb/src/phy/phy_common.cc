@@ -23,8 +23,8 @@
 #include "srslte/asn1/rrc_asn1.h"
 #include "srslte/common/log.h"
 #include "srslte/common/threads.h"
+#include "srslte/common/tti_trace.h"
 #include "srslte/phy/channel/channel.h"
-#include <sstream>
 
 #include <assert.h>
 
@@ -55,6 +55,13 @@ void phy_common::reset()
   }
 }
 
+phy_common::~phy_common()
+{
+  for (auto& cache : dmrs_cache) {
+    srslte_refsignal_dmrs_pusch_cache_free(&cache);
+  }
+}
+
 bool phy_common::init(const phy_cell_cfg_list_t&   cell_list_,
                       srslte::radio_interface_phy* radio_h_,
                       stack_interface_phy_lte*     stack_)
@@ -78,6 +85,16 @@ bool phy_common::init(const phy_cell_cfg_list_t&   cell_list_,
     q.resize(cell_list.size());
   }
 
+  // Generate the PUSCH DMRS base sequences of every carrier once for all the workers
+  dmrs_cache.resize(cell_list.size(), srslte_refsignal_ul_dmrs_cache_t{});
+  for (uint32_t cc = 0; cc < cell_list.size(); cc++) {
+    if (srslte_refsignal_dmrs_pusch_cache_init(&dmrs_cache[cc], cell_list[cc].cell.nof_prb) != SRSLTE_SUCCESS ||
+        not generate_dmrs_cache(cc)) {
+      ERROR("Error generating PUSCH DMRS for carrier %d\n", cc);
+      return false;
+    }
+  }
+
   // Set UE PHY data-base stack and configuration
   ue_db.init(stack, params, cell_list);
 
@@ -85,6 +102,33 @@ bool phy_common::init(const phy_cell_cfg_list_t&   cell_list_,
   return true;
 }
 
+bool phy_common::generate_dmrs_cache(uint32_t cc_idx)
+{
+  srslte_refsignal_ul_t refsignal = {};
+  bool                  ret       = false;
+  if (srslte_refsignal_ul_init(&refsignal, cell_list[cc_idx].cell.nof_prb) == SRSLTE_SUCCESS &&
+      srslte_refsignal_ul_set_cell(&refsignal, cell_list[cc_idx].cell) == SRSLTE_SUCCESS &&
+      srslte_refsignal_dmrs_pusch_cache_set(&refsignal, &dmrs_cache[cc_idx], &dmrs_pusch_cfg) == SRSLTE_SUCCESS) {
+    ret = true;
+  }
+  srslte_refsignal_ul_free(&refsignal);
+  return ret;
+}
+
+bool phy_common::set_cell(uint32_t cc_idx, const srslte_cell_t& cell)
+{
+  if (cc_idx >= cell_list.size() || cell.nof_prb != cell_list[cc_idx].cell.nof_prb ||
+      cell.nof_ports != cell_list[cc_idx].cell.nof_ports) {
+    return false;
+  }
+  cell_list[cc_idx].cell = cell;
+  if (not generate_dmrs_cache(cc_idx)) {
+    ERROR("Error generating PUSCH DMRS for carrier %d\n", cc_idx);
+    return false;
+  }
+  return true;
+}
+
 void phy_common::stop()
 {
   semaphore.wait_all();
@@ -135,13 +179,38 @@ void phy_common::worker_end(void* tx_sem_id, srslte::rf_buffer_t& buffer, srslte
     dl_channel->run(buffer.to_cf_t(), buffer.to_cf_t(), buffer.get_nof_samples(), tx_time.get(0));
   }
 
+  if (watchdog != nullptr) {
+    watchdog->tx_ready(srslte::tti_trace::get_thread_tti(), tx_time.get(0));
+  }
+
   // Always transmit on single radio
+  srslte::tti_span span(srslte::tti_stage::rf_send);
   radio->tx(buffer, tx_time);
+  span.stop();
 
   // Allow next TTI to transmit
   semaphore.release();
 }
 
+void phy_common::report_worker_time(uint32_t time_us)
+{
+  std::lock_guard<std::mutex> lock(worker_time_mutex);
+  worker_time_sum_us += time_us;
+  worker_time_max_us = SRSLTE_MAX(worker_time_max_us, time_us);
+  worker_time_count++;
+}
+
+void phy_common::get_worker_time(uint32_t& mean_us, uint32_t& max_us, uint32_t& count)
+{
+  std::lock_guard<std::mutex> lock(worker_time_mutex);
+  mean_us            = worker_time_count > 0 ? (uint32_t)(worker_time_sum_us / worker_time_count) : 0;
+  max_us             = worker_time_max_us;
+  count              = worker_time_count;
+  worker_time_sum_us = 0;
+  worker_time_max_us = 0;
+  worker_time_count  = 0;
+}
+
 void phy_common::set_mch_period_stop(uint32_t stop)
 {
   pthread_mutex_lock(&mtch_mutex);
@@ -157,6 +226,7 @@ void phy_common::configure_mbsfn(phy_interface_stack_lte::phy_cfg_mbsfn_t* cfg)
 
   build_mch_table();
   build_mcch_table();
+  build_mbsfn_sf_table();
   sib13_configured = true;
   mcch_configured  = true;
 }
@@ -164,7 +234,7 @@ void phy_common::configure_mbsfn(phy_interface_stack_lte::phy_cfg_mbsfn_t* cfg)
 void phy_common::build_mch_table()
 {
   // First reset tables
-  ZERO_OBJECT(mcch_table);
+  ZERO_OBJECT(mch_table);
 
   // 40 element table represents 4 frames (40 subframes)
   uint32_t nof_sfs = 0;
@@ -177,12 +247,6 @@ void phy_common::build_mch_table()
   } else {
     fprintf(stderr, "No valid SF alloc\n");
   }
-  // Debug
-  std::stringstream ss;
-  ss << "|";
-  for (uint32_t j = 0; j < 40; j++) {
-    ss << (int)mch_table[j] << "|";
-  }
 
   stack->set_sched_dl_tti_mask(mch_table, nof_sfs);
 }
@@ -193,116 +257,94 @@ void phy_common::build_mcch_table()
 
   generate_mcch_table(mcch_table,
                       static_cast<uint32_t>(mbsfn.mbsfn_area_info.mcch_cfg_r9.sf_alloc_info_r9.to_number()));
-
-  std::stringstream ss;
-  ss << "|";
-  for (uint32_t j = 0; j < 10; j++) {
-    ss << (int)mcch_table[j] << "|";
-  }
 }
 
-bool phy_common::is_mcch_subframe(srslte_mbsfn_cfg_t* cfg, uint32_t phy_tti)
+void phy_common::build_mbsfn_sf_table()
 {
-  uint32_t sfn; // System Frame Number
-  uint8_t  sf;  // Subframe
-  uint8_t  offset;
-  uint8_t  period;
-
-  sfn = phy_tti / 10;
-  sf  = phy_tti % 10;
-
-  if (sib13_configured) {
-    mbsfn_area_info_r9_s* area_info = &mbsfn.mbsfn_area_info;
-
-    offset = area_info->mcch_cfg_r9.mcch_offset_r9;
-    period = area_info->mcch_cfg_r9.mcch_repeat_period_r9.to_number();
-
-    if ((sfn % period == offset) && mcch_table[sf] > 0) {
-      cfg->mbsfn_area_id           = area_info->mbsfn_area_id_r9;
-      cfg->non_mbsfn_region_length = area_info->non_mbsfn_region_len.to_number();
-      cfg->mbsfn_mcs               = area_info->mcch_cfg_r9.sig_mcs_r9.to_number();
-      cfg->enable                  = true;
-      cfg->is_mcch                 = true;
-      have_mtch_stop               = false;
-      return true;
+  mbsfn_sf_table.fill({});
+
+  mbsfn_sf_cfg_s*       subfr_cnfg = &mbsfn.mbsfn_subfr_cnfg;
+  mbsfn_area_info_r9_s* area_info  = &mbsfn.mbsfn_area_info;
+
+  mbsfn_area_id           = area_info->mbsfn_area_id_r9;
+  non_mbsfn_region_length = area_info->non_mbsfn_region_len.to_number();
+  mcch_mcs                = area_info->mcch_cfg_r9.sig_mcs_r9.to_number();
+
+  // The MCS of the MCH subframes is the one of the last PMCH
+  mbsfn_area_cfg_r9_s* area_r9         = &mbsfn.mcch.msg.c1().mbsfn_area_cfg_r9();
+  uint32_t             mbsfn_per_frame = 0;
+  mch_data_mcs_present                 = area_r9->pmch_info_list_r9.size() > 0;
+  if (mch_data_mcs_present) {
+    mch_data_mcs    = area_r9->pmch_info_list_r9.back().pmch_cfg_r9.data_mcs_r9;
+    mbsfn_per_frame = area_r9->pmch_info_list_r9[0].pmch_cfg_r9.sf_alloc_end_r9 /
+                      area_r9->pmch_info_list_r9[0].pmch_cfg_r9.mch_sched_period_r9.to_number();
+  }
+
+  uint32_t mcch_offset = area_info->mcch_cfg_r9.mcch_offset_r9;
+  uint32_t mcch_period = area_info->mcch_cfg_r9.mcch_repeat_period_r9.to_number();
+  uint32_t offset      = subfr_cnfg->radioframe_alloc_offset;
+  uint32_t period      = subfr_cnfg->radioframe_alloc_period.to_number();
+
+  for (uint32_t sfn = 0; sfn < mbsfn_table_nof_frames; sfn++) {
+    for (uint32_t sf = 0; sf < SRSLTE_NOF_SF_X_FRAME; sf++) {
+      mbsfn_sf_t& e = mbsfn_sf_table[sfn * SRSLTE_NOF_SF_X_FRAME + sf];
+      if ((sfn % mcch_period == mcch_offset) && mcch_table[sf] > 0) {
+        e.type = mbsfn_sf_t::mcch;
+      } else if (subfr_cnfg->sf_alloc.type() == mbsfn_sf_cfg_s::sf_alloc_c_::types::one_frame) {
+        if ((sfn % period == offset) && (mch_table[sf] > 0)) {
+          // Position of the subframe in the common subframe allocation, to find the PMCH it belongs to
+          uint32_t frame_alloc_idx = sfn % area_r9->common_sf_alloc_period_r9.to_number();
+          e.type                   = mbsfn_sf_t::mch_data;
+          e.sf_alloc_idx           = frame_alloc_idx * mbsfn_per_frame + ((sf < 4) ? sf - 1 : sf - 3);
+        }
+      } else if (subfr_cnfg->sf_alloc.type() == mbsfn_sf_cfg_s::sf_alloc_c_::types::four_frames) {
+        uint32_t idx = sfn % period;
+        if ((idx >= offset) && (idx < offset + 4) && mch_table[(idx - offset) * 10 + sf] > 0) {
+          // TODO: check for MCCH configuration, set MCS and decode
+          e.type = mbsfn_sf_t::mch;
+        }
+      }
     }
   }
-  return false;
 }
 
 bool phy_common::is_mch_subframe(srslte_mbsfn_cfg_t* cfg, uint32_t phy_tti)
 {
-  uint32_t sfn; // System Frame Number
-  uint8_t  sf;  // Subframe
-  uint8_t  offset;
-  uint8_t  period;
-
-  sfn = phy_tti / 10;
-  sf  = phy_tti % 10;
-
   // Set some defaults
   cfg->mbsfn_area_id           = 0;
   cfg->non_mbsfn_region_length = 1;
   cfg->mbsfn_mcs               = 2;
   cfg->enable                  = false;
   cfg->is_mcch                 = false;
-  // Check for MCCH
-  if (is_mcch_subframe(cfg, phy_tti)) {
-    return true;
-  }
-  if (not mcch_configured) {
+  if (not sib13_configured or not mcch_configured) {
     return false;
   }
 
-  // Not MCCH, check for MCH
-  mbsfn_sf_cfg_s*       subfr_cnfg = &mbsfn.mbsfn_subfr_cnfg;
-  mbsfn_area_info_r9_s* area_info  = &mbsfn.mbsfn_area_info;
-
-  offset = subfr_cnfg->radioframe_alloc_offset;
-  period = subfr_cnfg->radioframe_alloc_period.to_number();
-
-  if (subfr_cnfg->sf_alloc.type() == mbsfn_sf_cfg_s::sf_alloc_c_::types::one_frame) {
-    if ((sfn % period == offset) && (mch_table[sf] > 0)) {
-      if (sib13_configured) {
-        cfg->mbsfn_area_id           = area_info->mbsfn_area_id_r9;
-        cfg->non_mbsfn_region_length = area_info->non_mbsfn_region_len.to_number();
-        if (mcch_configured) {
-          // Iterate through PMCH configs to see which one applies in the current frame
-          mbsfn_area_cfg_r9_s* area_r9 = &mbsfn.mcch.msg.c1().mbsfn_area_cfg_r9();
+  // All the MBSFN periods divide the table, which holds the whole configuration of the subframe but the MCH stop
+  uint32_t          sfn = phy_tti / SRSLTE_NOF_SF_X_FRAME;
+  const mbsfn_sf_t& e =
+      mbsfn_sf_table[(sfn % mbsfn_table_nof_frames) * SRSLTE_NOF_SF_X_FRAME + phy_tti % SRSLTE_NOF_SF_X_FRAME];
+  if (e.type == mbsfn_sf_t::none) {
+    return false;
+  }
 
-          uint32_t frame_alloc_idx = sfn % area_r9->common_sf_alloc_period_r9.to_number();
-          uint32_t mbsfn_per_frame = area_r9->pmch_info_list_r9[0].pmch_cfg_r9.sf_alloc_end_r9 /
-                                     +area_r9->pmch_info_list_r9[0].pmch_cfg_r9.mch_sched_period_r9.to_number();
-          uint32_t sf_alloc_idx = frame_alloc_idx * mbsfn_per_frame + ((sf < 4) ? sf - 1 : sf - 3);
-          while (!have_mtch_stop) {
-            pthread_cond_wait(&mtch_cvar, &mtch_mutex);
-          }
-
-          for (uint32_t i = 0; i < area_r9->pmch_info_list_r9.size(); i++) {
-            if (sf_alloc_idx <= mch_period_stop) {
-              cfg->mbsfn_mcs = mbsfn.mcch.msg.c1().mbsfn_area_cfg_r9().pmch_info_list_r9[i].pmch_cfg_r9.data_mcs_r9;
-              cfg->enable    = true;
-            }
-          }
-        }
-      }
-      return true;
+  cfg->mbsfn_area_id           = mbsfn_area_id;
+  cfg->non_mbsfn_region_length = non_mbsfn_region_length;
+  if (e.type == mbsfn_sf_t::mcch) {
+    cfg->mbsfn_mcs = mcch_mcs;
+    cfg->enable    = true;
+    cfg->is_mcch   = true;
+    have_mtch_stop = false;
+  } else if (e.type == mbsfn_sf_t::mch_data) {
+    while (!have_mtch_stop) {
+      pthread_cond_wait(&mtch_cvar, &mtch_mutex);
     }
-  } else if (subfr_cnfg->sf_alloc.type() == mbsfn_sf_cfg_s::sf_alloc_c_::types::four_frames) {
-    uint8_t idx = sfn % period;
-    if ((idx >= offset) && (idx < offset + 4)) {
-      if (mch_table[(idx * 10) + sf] > 0) {
-        if (sib13_configured) {
-          cfg->mbsfn_area_id           = area_info->mbsfn_area_id_r9;
-          cfg->non_mbsfn_region_length = area_info->non_mbsfn_region_len.to_number();
-          // TODO: check for MCCH configuration, set MCS and decode
-        }
-        return true;
-      }
+    if (mch_data_mcs_present and e.sf_alloc_idx <= mch_period_stop) {
+      cfg->mbsfn_mcs = mch_data_mcs;
+      cfg->enable    = true;
     }
   }
-
-  return false;
+  return true;
 }
 
 bool phy_common::is_mbsfn_sf(srslte_mbsfn_cfg_t* cfg, uint32_t phy_tti)
@@ -20,9 +20,52 @@
  */
 
 #include "srsenb/hdr/phy/phy_ue_db.h"
+#include <thread>
 
 using namespace srsenb;
 
+phy_ue_db::~phy_ue_db()
+{
+  delete cfg_snapshot.load();
+}
+
+const phy_ue_db::ue_cfg_t* phy_ue_db::cfg_reader::find(uint16_t rnti) const
+{
+  if (snapshot == nullptr) {
+    return nullptr;
+  }
+  auto it = snapshot->find(rnti);
+  return (it != snapshot->end()) ? &it->second : nullptr;
+}
+
+void phy_ue_db::_publish_config()
+{
+  // Private function not mutexed
+
+  // Copy the configuration fields of every UE
+  cfg_snapshot_t* next = new cfg_snapshot_t;
+  for (const auto& iter : ue_db) {
+    ue_cfg_t& ue_cfg = (*next)[iter.first];
+    for (uint32_t ue_cc_idx = 0; ue_cc_idx < SRSLTE_MAX_CARRIERS; ue_cc_idx++) {
+      const cell_info_t& cell_info          = iter.second.cell_info[ue_cc_idx];
+      ue_cfg.cell_cfg[ue_cc_idx].state      = cell_info.state;
+      ue_cfg.cell_cfg[ue_cc_idx].enb_cc_idx = cell_info.enb_cc_idx;
+      ue_cfg.cell_cfg[ue_cc_idx].phy_cfg    = cell_info.phy_cfg;
+    }
+    ue_cfg.pcell_cfg_stash = iter.second.pcell_cfg_stash;
+  }
+  const cfg_snapshot_t* prev = cfg_snapshot.exchange(next);
+
+  // Wait for the readers that might still hold the previous snapshot
+  for (uint32_t i = 0; i < 2; i++) {
+    uint32_t epoch = cfg_epoch.fetch_xor(1u) & 1u;
+    while (cfg_readers[epoch].load() != 0) {
+      std::this_thread::yield();
+    }
+  }
+  delete prev;
+}
+
 void phy_ue_db::init(stack_interface_phy_lte*   stack_ptr,
                      const phy_args_t&          phy_args_,
                      const phy_cell_cfg_list_t& cell_cfg_list_)
@@ -123,6 +166,21 @@ inline uint32_t phy_ue_db::_get_ue_cc_idx(uint16_t rnti, uint32_t enb_cc_idx) co
   return ue_cc_idx;
 }
 
+inline uint32_t phy_ue_db::_get_ue_cc_idx(const ue_cfg_t& ue_cfg, uint32_t enb_cc_idx)
+{
+  uint32_t ue_cc_idx = 0;
+
+  for (; ue_cc_idx < SRSLTE_MAX_CARRIERS; ue_cc_idx++) {
+    const ue_cfg_t::cell_cfg_t& cell_cfg = ue_cfg.cell_cfg[ue_cc_idx];
+    if (cell_cfg.enb_cc_idx == enb_cc_idx and
+        (cell_cfg.state == cell_state_primary or cell_cfg.state == cell_state_secondary_active)) {
+      return ue_cc_idx;
+    }
+  }
+
+  return ue_cc_idx;
+}
+
 uint32_t phy_ue_db::_get_uci_enb_cc_idx(uint32_t tti, uint16_t rnti) const
 {
   // Find the lowest index available PUSCH grant
@@ -240,21 +298,28 @@ inline srslte::phy_cfg_t phy_ue_db::_get_rnti_config(uint16_t rnti, uint32_t enb
     return default_cfg;
   }
 
-  // Make sure the C-RNTI exists and the cell/carrier is configured
-  if (_assert_enb_cc(rnti, enb_cc_idx) != SRSLTE_SUCCESS) {
-    ERROR("Trying to access cell/carrier %d in RNTI 0x%X. It is not active.\n", enb_cc_idx, rnti);
+  // Read the configuration snapshot, without locking
+  cfg_reader      reader(*this);
+  const ue_cfg_t* ue_cfg = reader.find(rnti);
+  if (ue_cfg == nullptr) {
+    ERROR("Trying to access RNTI 0x%X, it does not exist.\n", rnti);
     return default_cfg;
   }
 
-  uint32_t ue_cc_idx = _get_ue_cc_idx(rnti, enb_cc_idx);
+  // Make sure the cell/carrier is configured
+  uint32_t ue_cc_idx = _get_ue_cc_idx(*ue_cfg, enb_cc_idx);
+  if (ue_cc_idx == SRSLTE_MAX_CARRIERS) {
+    ERROR("Trying to access cell/carrier %d in RNTI 0x%X. It is not active.\n", enb_cc_idx, rnti);
+    return default_cfg;
+  }
 
   // Return Stashed configuration if PCell and stashed is true
   if (ue_cc_idx == 0 and stashed) {
-    return ue_db.at(rnti).pcell_cfg_stash;
+    return ue_cfg->pcell_cfg_stash;
   }
 
   // Otherwise return current configuration
-  return ue_db.at(rnti).cell_info.at(ue_cc_idx).phy_cfg;
+  return ue_cfg->cell_cfg[ue_cc_idx].phy_cfg;
 }
 
 void phy_ue_db::clear_tti_pending_ack(uint32_t tti)
@@ -339,6 +404,8 @@ void phy_ue_db::addmod_rnti(uint16_t rnti, const phy_interface_rrc_lte::phy_rrc_
 
   // Load new UL configuration
   ue.cell_info[0].phy_cfg.ul_cfg = ue.pcell_cfg_stash.ul_cfg;
+
+  _publish_config();
 }
 
 void phy_ue_db::rem_rnti(uint16_t rnti)
@@ -347,6 +414,7 @@ void phy_ue_db::rem_rnti(uint16_t rnti)
 
   if (ue_db.count(rnti) != 0) {
     ue_db.erase(rnti);
+    _publish_config();
   }
 }
 
@@ -361,6 +429,8 @@ void phy_ue_db::complete_config(uint16_t rnti)
 
   // Apply stashed configuration
   ue_db[rnti].cell_info[0].phy_cfg = ue_db[rnti].pcell_cfg_stash;
+
+  _publish_config();
 }
 
 void phy_ue_db::activate_deactivate_scell(uint16_t rnti, uint32_t ue_cc_idx, bool activate)
@@ -381,35 +451,40 @@ void phy_ue_db::activate_deactivate_scell(uint16_t rnti, uint32_t ue_cc_idx, boo
   }
   // Set scell state
   cell_info.state = (activate) ? cell_state_secondary_active : cell_state_secondary_inactive;
+
+  _publish_config();
 }
 
 bool phy_ue_db::is_pcell(uint16_t rnti, uint32_t enb_cc_idx) const
 {
-  std::lock_guard<std::mutex> lock(mutex);
-  return _assert_enb_pcell(rnti, enb_cc_idx) == SRSLTE_SUCCESS;
+  cfg_reader      reader(*this);
+  const ue_cfg_t* ue_cfg = reader.find(rnti);
+  if (ue_cfg == nullptr) {
+    ERROR("Trying to access RNTI 0x%X, it does not exist.\n", rnti);
+    return false;
+  }
+
+  uint32_t ue_cc_idx = _get_ue_cc_idx(*ue_cfg, enb_cc_idx);
+  return ue_cc_idx < SRSLTE_MAX_CARRIERS and ue_cfg->cell_cfg[ue_cc_idx].state == cell_state_primary;
 }
 
 srslte_dl_cfg_t phy_ue_db::get_dl_config(uint16_t rnti, uint32_t enb_cc_idx) const
 {
-  std::lock_guard<std::mutex> lock(mutex);
   return _get_rnti_config(rnti, enb_cc_idx, false).dl_cfg;
 }
 
 srslte_dci_cfg_t phy_ue_db::get_dci_dl_config(uint16_t rnti, uint32_t enb_cc_idx) const
 {
-  std::lock_guard<std::mutex> lock(mutex);
   return _get_rnti_config(rnti, enb_cc_idx, false).dl_cfg.dci;
 }
 
 srslte_ul_cfg_t phy_ue_db::get_ul_config(uint16_t rnti, uint32_t enb_cc_idx) const
 {
-  std::lock_guard<std::mutex> lock(mutex);
   return _get_rnti_config(rnti, enb_cc_idx, false).ul_cfg;
 }
 
 srslte_dci_cfg_t phy_ue_db::get_dci_ul_config(uint16_t rnti, uint32_t enb_cc_idx) const
 {
-  std::lock_guard<std::mutex> lock(mutex);
   return _get_rnti_config(rnti, enb_cc_idx, true).dl_cfg.dci;
 }
 
@@ -612,6 +687,14 @@ void phy_ue_db::send_uci_data(uint32_t                  tti,
           break;
       }
       stack->cqi_info(tti, rnti, cqi_cc_idx, cqi_value);
+
+      // Subband CQIs of the higher layer configured reports
+      if (uci_cfg.cqi.type == SRSLTE_CQI_TYPE_SUBBAND_HL) {
+        for (uint32_t sb_idx = 0; sb_idx < uci_cfg.cqi.N; sb_idx++) {
+          uint32_t sb_cqi = srslte_cqi_hl_get_subband_cqi(&uci_cfg.cqi, &uci_value.cqi.subband_hl, sb_idx);
+          stack->sb_cqi_info(tti, rnti, cqi_cc_idx, sb_idx, sb_cqi);
+        }
+      }
     }
 
     // Precoding Matrix indicator (TM4)
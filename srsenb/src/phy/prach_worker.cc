@@ -28,7 +28,8 @@ int prach_worker::init(const srslte_cell_t&      cell_,
                        const srslte_prach_cfg_t& prach_cfg_,
                        stack_interface_phy_lte*  stack_,
                        srslte::log*              log_h_,
-                       int                       priority)
+                       int                       priority,
+                       uint32_t                  nof_workers)
 {
   log_h     = log_h_;
   stack     = stack_;
@@ -37,20 +38,28 @@ int prach_worker::init(const srslte_cell_t&      cell_,
 
   max_prach_offset_us = 50;
 
-  if (srslte_prach_init(&prach, srslte_symbol_sz(cell.nof_prb))) {
-    return -1;
-  }
+  for (uint32_t i = 0; i < std::max(nof_workers, 1u); i++) {
+    detectors.emplace_back(new detector(this, i));
+    srslte_prach_t* prach = &detectors.back()->prach;
 
-  if (srslte_prach_set_cfg(&prach, &prach_cfg, cell.nof_prb)) {
-    ERROR("Error initiating PRACH\n");
-    return -1;
-  }
+    if (srslte_prach_init(prach, srslte_symbol_sz(cell.nof_prb))) {
+      return -1;
+    }
 
-  srslte_prach_set_detect_factor(&prach, 60);
+    if (srslte_prach_set_cfg(prach, &prach_cfg, cell.nof_prb)) {
+      ERROR("Error initiating PRACH\n");
+      return -1;
+    }
 
-  nof_sf = (uint32_t)ceilf(prach.T_tot * 1000);
+    srslte_prach_set_detect_factor(prach, 60);
+  }
+
+  nof_sf = (uint32_t)ceilf(detectors.front()->prach.T_tot * 1000);
 
-  start(priority);
+  running = true;
+  for (auto& d : detectors) {
+    d->start(priority);
+  }
   initiated = true;
 
   sf_cnt = 0;
@@ -72,12 +81,16 @@ int prach_worker::init(const srslte_cell_t&      cell_,
 
 void prach_worker::stop()
 {
-  running      = false;
-  sf_buffer* s = nullptr;
-  pending_buffers.push(s);
-  wait_thread_finish();
-
-  srslte_prach_free(&prach);
+  running = false;
+  for (size_t i = 0; i < detectors.size(); i++) {
+    sf_buffer* s = nullptr;
+    pending_buffers.push(s);
+  }
+  for (auto& d : detectors) {
+    d->wait_thread_finish();
+    srslte_prach_free(&d->prach);
+  }
+  detectors.clear();
 }
 
 void prach_worker::set_max_prach_offset_us(float delay_us)
@@ -86,9 +99,19 @@ void prach_worker::set_max_prach_offset_us(float delay_us)
 }
 
 int prach_worker::new_tti(uint32_t tti_rx, cf_t* buffer_rx)
+{
+  return save_sf(tti_rx, buffer_rx, nullptr);
+}
+
+int prach_worker::new_tti_s(uint32_t tti_rx, const int16_t* buffer_rx)
+{
+  return save_sf(tti_rx, nullptr, buffer_rx);
+}
+
+int prach_worker::save_sf(uint32_t tti_rx, const cf_t* buffer_rx, const int16_t* buffer_rx_s)
 {
   // Save buffer only if it's a PRACH TTI
-  if (srslte_prach_tti_opportunity(&prach, tti_rx, -1) || sf_cnt) {
+  if (srslte_prach_tti_opportunity(&detectors.front()->prach, tti_rx, -1) || sf_cnt) {
     if (sf_cnt == 0) {
       current_buffer = buffer_pool.allocate();
       if (!current_buffer) {
@@ -101,9 +124,12 @@ int prach_worker::new_tti(uint32_t tti_rx, cf_t* buffer_rx)
       return -1;
     }
     if (current_buffer->nof_samples + SRSLTE_SF_LEN_PRB(cell.nof_prb) < sf_buffer_sz) {
-      memcpy(&current_buffer->samples[sf_cnt * SRSLTE_SF_LEN_PRB(cell.nof_prb)],
-             buffer_rx,
-             sizeof(cf_t) * SRSLTE_SF_LEN_PRB(cell.nof_prb));
+      cf_t* samples = &current_buffer->samples[sf_cnt * SRSLTE_SF_LEN_PRB(cell.nof_prb)];
+      if (buffer_rx_s) {
+        srslte_vec_convert_if(buffer_rx_s, INT16_MAX, (float*)samples, 2 * SRSLTE_SF_LEN_PRB(cell.nof_prb));
+      } else {
+        memcpy(samples, buffer_rx, sizeof(cf_t) * SRSLTE_SF_LEN_PRB(cell.nof_prb));
+      }
       current_buffer->nof_samples += SRSLTE_SF_LEN_PRB(cell.nof_prb);
       if (sf_cnt == 0) {
         current_buffer->tti = tti_rx;
@@ -121,14 +147,19 @@ int prach_worker::new_tti(uint32_t tti_rx, cf_t* buffer_rx)
   return 0;
 }
 
-int prach_worker::run_tti(sf_buffer* b)
+int prach_worker::run_tti(detector& d, sf_buffer* b)
 {
-  if (srslte_prach_tti_opportunity(&prach, b->tti, -1)) {
+  uint32_t& prach_nof_det = d.prach_nof_det;
+  uint32_t* prach_indices = d.prach_indices;
+  float*    prach_offsets = d.prach_offsets;
+  float*    prach_p2avg   = d.prach_p2avg;
+
+  if (srslte_prach_tti_opportunity(&d.prach, b->tti, -1)) {
     // Detect possible PRACHs
-    if (srslte_prach_detect_offset(&prach,
+    if (srslte_prach_detect_offset(&d.prach,
                                    prach_cfg.freq_offset,
-                                   &b->samples[prach.N_cp],
-                                   nof_sf * SRSLTE_SF_LEN_PRB(cell.nof_prb) - prach.N_cp,
+                                   &b->samples[d.prach.N_cp],
+                                   nof_sf * SRSLTE_SF_LEN_PRB(cell.nof_prb) - d.prach.N_cp,
                                    prach_indices,
                                    prach_offsets,
                                    prach_p2avg,
@@ -166,17 +197,16 @@ int prach_worker::run_tti(sf_buffer* b)
   return 0;
 }
 
-void prach_worker::run_thread()
+void prach_worker::detector::run_thread()
 {
-  running = true;
-  while (running) {
-    sf_buffer* b = pending_buffers.wait_pop();
-    if (running && b) {
-      int ret = run_tti(b);
+  while (parent->running) {
+    sf_buffer* b = parent->pending_buffers.wait_pop();
+    if (parent->running && b) {
+      int ret = parent->run_tti(*this, b);
       b->reset();
-      buffer_pool.deallocate(b);
+      parent->buffer_pool.deallocate(b);
       if (ret) {
-        running = false;
+        parent->running = false;
       }
     }
   }
@@ -20,10 +20,12 @@
  */
 
 #include "srslte/common/log.h"
+#include "srslte/common/thread_metrics.h"
 #include "srslte/common/threads.h"
 #include "srslte/srslte.h"
 
 #include "srsenb/hdr/phy/sf_worker.h"
+#include <thread>
 
 #define Error(fmt, ...)                                                                                                \
   if (SRSLTE_DEBUG_ENABLED)                                                                                            \
@@ -77,16 +79,21 @@ void sf_worker::init(phy_common* phy_, srslte::log* log_h_)
   phy   = phy_;
   log_h = log_h_;
 
-  // Initialise each component carrier workers
+  // Create each component carrier worker
   for (uint32_t i = 0; i < phy->get_nof_carriers(); i++) {
-    // Create pointer
-    auto q = new cc_worker();
-
-    // Initialise
-    q->init(phy, log_h, i);
+    cc_workers.push_back(std::unique_ptr<cc_worker>(new cc_worker()));
+  }
 
-    // Create unique pointer
-    cc_workers.push_back(std::unique_ptr<cc_worker>(q));
+  // The carriers are independent, initialise them concurrently. The threads inherit the memory policy of this one
+  std::vector<std::thread> init_threads;
+  for (uint32_t i = 1; i < cc_workers.size(); i++) {
+    init_threads.emplace_back([this, i]() { cc_workers[i]->init(phy, log_h, i); });
+  }
+  if (not cc_workers.empty()) {
+    cc_workers[0]->init(phy, log_h, 0);
+  }
+  for (std::thread& t : init_threads) {
+    t.join();
   }
 
   if (srslte_softbuffer_tx_init(&temp_mbsfn_softbuffer, phy->get_nof_prb(0))) {
@@ -111,6 +118,11 @@ cf_t* sf_worker::get_buffer_rx(uint32_t cc_idx, uint32_t antenna_idx)
   return cc_workers[cc_idx]->get_buffer_rx(antenna_idx);
 }
 
+int16_t* sf_worker::get_buffer_rx_s(uint32_t cc_idx, uint32_t antenna_idx)
+{
+  return cc_workers[cc_idx]->get_buffer_rx_s(antenna_idx);
+}
+
 void sf_worker::set_time(uint32_t tti_, uint32_t tx_worker_cnt_, const srslte::rf_timestamp_t& tx_time_)
 {
   tti_rx    = tti_;
@@ -129,6 +141,14 @@ void sf_worker::set_time(uint32_t tti_, uint32_t tx_worker_cnt_, const srslte::r
   }
 }
 
+int sf_worker::set_cell(uint32_t cc_idx, const srslte_cell_t& cell)
+{
+  if (cc_idx >= cc_workers.size()) {
+    return SRSLTE_ERROR;
+  }
+  return cc_workers[cc_idx]->set_cell(cell);
+}
+
 int sf_worker::pregen_sequences(uint16_t rnti)
 {
   for (auto& w : cc_workers) {
@@ -166,6 +186,9 @@ uint32_t sf_worker::get_nof_rnti()
 void sf_worker::work_imp()
 {
   std::lock_guard<std::mutex> lock(work_mutex);
+  tti_meas.start();
+  srslte::tti_trace::set_thread_tti(tti_rx);
+  srslte::tti_span worker_span(srslte::tti_stage::worker);
 
   srslte_ul_sf_cfg_t ul_sf = {};
   srslte_dl_sf_cfg_t dl_sf = {};
@@ -179,7 +202,7 @@ void sf_worker::work_imp()
   }
 
   if (!running) {
-    phy->worker_end(this, tx_buffer, tx_time);
+    end_tti(tx_buffer, worker_span);
     return;
   }
 
@@ -215,14 +238,14 @@ void sf_worker::work_imp()
   if (sf_type == SRSLTE_SF_NORM) {
     if (stack->get_dl_sched(tti_tx_dl, dl_grants) < 0) {
       Error("Getting DL scheduling from MAC\n");
-      phy->worker_end(this, tx_buffer, tx_time);
+      end_tti(tx_buffer, worker_span);
       return;
     }
   } else {
     dl_grants[0].cfi = mbsfn_cfg.non_mbsfn_region_length;
     if (stack->get_mch_sched(tti_tx_dl, mbsfn_cfg.is_mcch, dl_grants)) {
       Error("Getting MCH packets from MAC\n");
-      phy->worker_end(this, tx_buffer, tx_time);
+      end_tti(tx_buffer, worker_span);
       return;
     }
   }
@@ -234,7 +257,7 @@ void sf_worker::work_imp()
   // Get UL scheduling for the TX TTI from MAC
   if (stack->get_ul_sched(tti_tx_ul, ul_grants_tx) < 0) {
     Error("Getting UL scheduling from MAC\n");
-    phy->worker_end(this, tx_buffer, tx_time);
+    end_tti(tx_buffer, worker_span);
     return;
   }
 
@@ -258,7 +281,7 @@ void sf_worker::work_imp()
 
   Debug("Sending to radio\n");
   tx_buffer.set_nof_samples(SRSLTE_SF_LEN_PRB(phy->get_nof_prb(0)));
-  phy->worker_end(this, tx_buffer, tx_time);
+  end_tti(tx_buffer, worker_span);
 
 #ifdef DEBUG_WRITE_FILE
   fwrite(signal_buffer_tx, SRSLTE_SF_LEN_PRB(phy->cell.nof_prb) * sizeof(cf_t), 1, f);
@@ -279,6 +302,15 @@ void sf_worker::work_imp()
 #endif
 }
 
+void sf_worker::end_tti(srslte::rf_buffer_t& tx_buffer, srslte::tti_span& worker_span)
+{
+  worker_span.stop();
+  uint32_t worker_us = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(tti_meas.stop()).count();
+  phy->report_worker_time(worker_us);
+  srslte::thread_metrics::observe(srslte::thread_metric::phy_worker_time_us, worker_us);
+  phy->worker_end(this, tx_buffer, tx_time);
+}
+
 /************ METRICS interface ********************/
 uint32_t sf_worker::get_metrics(phy_metrics_t metrics[ENB_METRICS_MAX_USERS])
 {
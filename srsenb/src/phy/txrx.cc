@@ -19,10 +19,12 @@
  *
  */
 
+#include <future>
 #include <unistd.h>
 
 #include "srslte/common/log.h"
 #include "srslte/common/threads.h"
+#include "srslte/common/tti_trace.h"
 #include "srslte/srslte.h"
 
 #include "srsenb/hdr/phy/sf_worker.h"
@@ -69,12 +71,27 @@ bool txrx::init(stack_interface_phy_lte*     stack_,
 
   nof_workers = workers_pool->get_nof_workers();
 
+  // Start with all the workers active, the pool shrinks after the first period if the load allows it
+  nof_active_workers = nof_workers;
+  min_workers        = nof_workers;
+  if (worker_com->params.min_phy_threads > 0) {
+    min_workers = SRSLTE_MIN((uint32_t)worker_com->params.min_phy_threads, nof_workers);
+  }
+  workers_pool->set_nof_active_workers(nof_active_workers);
+
   // Instantiate UL channel emulator
   if (worker_com->params.ul_channel_args.enable) {
     ul_channel =
         srslte::channel_ptr(new srslte::channel(worker_com->params.ul_channel_args, worker_com->get_nof_rf_channels()));
   }
 
+  watchdog.init(worker_com->params.deadline_watchdog, log_h);
+  worker_com->watchdog = &watchdog;
+
+  {
+    std::lock_guard<std::mutex> lock(drained_mutex);
+    drained_closed = false;
+  }
   start(prio_);
   return true;
 }
@@ -85,14 +102,48 @@ void txrx::stop()
     running = false;
     wait_thread_finish();
   }
+  watchdog.stop();
+}
+
+void txrx::run_drained(std::function<void()> task)
+{
+  std::promise<void>           done;
+  std::unique_lock<std::mutex> lock(drained_mutex);
+  if (drained_closed) {
+    lock.unlock();
+    task();
+    return;
+  }
+  drained_tasks.push_back([&task, &done]() {
+    task();
+    done.set_value();
+  });
+  drained_pending = true;
+  lock.unlock();
+  done.get_future().wait();
+}
+
+void txrx::run_drained_tasks()
+{
+  std::vector<std::function<void()>> tasks;
+  {
+    std::lock_guard<std::mutex> lock(drained_mutex);
+    tasks.swap(drained_tasks);
+    drained_pending = false;
+  }
+  for (auto& t : tasks) {
+    t();
+  }
 }
 
 void txrx::run_thread()
 {
-  sf_worker*             worker    = nullptr;
-  srslte::rf_buffer_t    buffer    = {};
-  srslte::rf_timestamp_t timestamp = {};
-  uint32_t               sf_len    = SRSLTE_SF_LEN_PRB(worker_com->get_nof_prb(0));
+  sf_worker*             worker                       = nullptr;
+  srslte::rf_buffer_t    buffer                       = {};
+  int16_t*               buffer_s[SRSLTE_MAX_CHANNELS] = {};
+  srslte::rf_timestamp_t timestamp                    = {};
+  uint32_t               sf_len                       = SRSLTE_SF_LEN_PRB(worker_com->get_nof_prb(0));
+  uint32_t               nof_ports                    = worker_com->get_nof_ports(0);
 
   float samp_rate = srslte_sampling_freq_hz(worker_com->get_nof_prb(0));
 
@@ -116,6 +167,13 @@ void txrx::run_thread()
     ul_channel->set_srate(static_cast<uint32_t>(samp_rate));
   }
 
+  // The UL channel emulator works on float samples and the radio may not be able to deliver int16 ones
+  bool rx_int16 = worker_com->params.rx_int16 and not ul_channel and radio_h->has_rx_s();
+  if (worker_com->params.rx_int16 and not rx_int16) {
+    srslte::console("Warning: The UL cannot be received as int16 samples, receiving float samples instead\n");
+  }
+  worker_com->rx_int16 = rx_int16;
+
   log_h->info("Starting RX/TX thread nof_prb=%d, sf_len=%d\n", worker_com->get_nof_prb(0), sf_len);
 
   // Set TTI so that first TX is at tti=0
@@ -123,26 +181,40 @@ void txrx::run_thread()
 
   // Main loop
   while (running) {
+    // The workers are drained before the pending tasks, which may change what the workers use
+    if (drained_pending and workers_pool->wait_idle()) {
+      log_h->info("Running tasks with the PHY workers drained at tti=%d\n", tti);
+      run_drained_tasks();
+    }
+
     tti    = TTI_ADD(tti, 1);
-    worker = (sf_worker*)workers_pool->wait_worker(tti);
+    worker = wait_worker();
     if (worker) {
       // Multiple cell buffer mapping
       for (uint32_t cc = 0; cc < worker_com->get_nof_carriers(); cc++) {
         uint32_t rf_port = worker_com->get_rf_port(cc);
         for (uint32_t p = 0; p < worker_com->get_nof_ports(cc); p++) {
           // WARNING: The number of ports for all cells must be the same
-          buffer.set(rf_port, p, worker_com->get_nof_ports(0), worker->get_buffer_rx(cc, p));
+          buffer.set(rf_port, p, nof_ports, worker->get_buffer_rx(cc, p));
+          buffer_s[rf_port * nof_ports + p] = worker->get_buffer_rx_s(cc, p);
         }
       }
 
       buffer.set_nof_samples(sf_len);
-      radio_h->rx_now(buffer, timestamp);
+      srslte::tti_span recv_span(srslte::tti_stage::rf_recv, tti);
+      if (rx_int16) {
+        radio_h->rx_now_s(buffer_s, sf_len, timestamp);
+      } else {
+        radio_h->rx_now(buffer, timestamp);
+      }
+      recv_span.stop();
+      watchdog.rx_done(tti, timestamp.get(0));
 
       if (ul_channel) {
         ul_channel->run(buffer.to_cf_t(), buffer.to_cf_t(), sf_len, timestamp.get(0));
       }
 
-      // Compute TX time: Any transmission happens in TTI+4 thus advance 4 ms the reception time
+      // Compute TX time: Any transmission happens FDD_HARQ_DELAY_UL_MS after the reception
       timestamp.add(FDD_HARQ_DELAY_UL_MS * 1e-3);
 
       Debug("Setting TTI=%d, tx_mutex=%d, tx_time=%ld:%f to worker %d\n",
@@ -161,17 +233,79 @@ void txrx::run_thread()
 
       // Trigger prach worker execution
       for (uint32_t cc = 0; cc < worker_com->get_nof_carriers(); cc++) {
-        prach->new_tti(cc, tti, buffer.get(worker_com->get_rf_port(cc), 0, worker_com->get_nof_ports(0)));
+        uint32_t rf_port = worker_com->get_rf_port(cc);
+        if (rx_int16) {
+          prach->new_tti_s(cc, tti, buffer_s[rf_port * nof_ports]);
+        } else {
+          prach->new_tti(cc, tti, buffer.get(rf_port, 0, nof_ports));
+        }
       }
 
       // Advance stack in time
       stack->tti_clock();
 
+      if (++scaling_tti_count == WORKER_SCALING_PERIOD_TTI) {
+        scaling_tti_count = 0;
+        update_nof_active_workers();
+      }
+
     } else {
       // wait_worker() only returns NULL if it's being closed. Quit now to avoid unnecessary loops here
       running = false;
     }
   }
+
+  // The tasks pushed from now on run directly, no worker is started anymore
+  {
+    std::lock_guard<std::mutex> lock(drained_mutex);
+    drained_closed = true;
+  }
+  run_drained_tasks();
+}
+
+sf_worker* txrx::wait_worker()
+{
+  if (nof_active_workers < nof_workers) {
+    // Do not wait for a busy worker while there are idle ones out of the active set, take one of them instead
+    auto worker = (sf_worker*)workers_pool->wait_worker_nb(tti);
+    if (worker != nullptr) {
+      return worker;
+    }
+    nof_active_workers++;
+    workers_pool->set_nof_active_workers(nof_active_workers);
+    Info("All PHY workers busy at tti=%d, increasing active workers to %d\n", tti, nof_active_workers);
+  }
+  return (sf_worker*)workers_pool->wait_worker(tti);
+}
+
+/* A worker is busy for the processing time of its TTI and a new TTI starts every millisecond, so the pipeline needs as
+ * many workers as milliseconds take the slowest TTIs plus one to absorb the jitter. The active workers are reduced one
+ * at a time, and only after a whole period below the current number, whereas a busy pool is grown immediately by
+ * wait_worker()
+ */
+void txrx::update_nof_active_workers()
+{
+  uint32_t mean_us = 0, max_us = 0, count = 0;
+  worker_com->get_worker_time(mean_us, max_us, count);
+
+  Info("PHY workers: %d/%d active, TTI processing time mean=%d us, max=%d us over %d TTIs\n",
+       nof_active_workers,
+       nof_workers,
+       mean_us,
+       max_us,
+       count);
+
+  if (min_workers == nof_workers || count == 0) {
+    return;
+  }
+
+  uint32_t nof_needed = SRSLTE_MIN(nof_workers, SRSLTE_MAX(min_workers, (max_us + 999) / 1000 + 1));
+  if (nof_needed == nof_active_workers) {
+    return;
+  }
+  nof_active_workers = nof_needed > nof_active_workers ? nof_needed : nof_active_workers - 1;
+  workers_pool->set_nof_active_workers(nof_active_workers);
+  Info("Setting active PHY workers to %d\n", nof_active_workers);
 }
 
 } // namespace srsenb
@@ -22,6 +22,8 @@
 #include "srsenb/hdr/stack/enb_stack_lte.h"
 #include "srsenb/hdr/enb.h"
 #include "srslte/common/network_utils.h"
+#include "srslte/common/thread_metrics.h"
+#include "srslte/common/tti_deadline_watchdog.h"
 #include "srslte/srslte.h"
 #include <srslte/interfaces/enb_metrics_interface.h>
 
@@ -29,10 +31,9 @@ using namespace srslte;
 
 namespace srsenb {
 
-enb_stack_lte::enb_stack_lte(srslte::logger* logger_) :
-  task_sched(512, 0, 128),
+enb_stack_lte::enb_stack_lte(srslte::logger* logger_, uint32_t nof_background_threads) :
+  task_sched(512, nof_background_threads, 128),
   logger(logger_),
-  pdcp(&task_sched, "PDCP"),
   thread("STACK"),
   mac(&task_sched),
   s1ap(&task_sched),
@@ -40,8 +41,7 @@ enb_stack_lte::enb_stack_lte(srslte::logger* logger_) :
 {
   enb_task_queue  = task_sched.make_task_queue();
   mme_task_queue  = task_sched.make_task_queue();
-  gtpu_task_queue = task_sched.make_task_queue();
-  // sync_queue is added in init()
+  // gtpu_queue and sync_queue are added in init()
 
   pool = byte_buffer_pool::get_instance();
 }
@@ -93,25 +93,70 @@ int enb_stack_lte::init(const stack_args_t& args_, const rrc_cfg_t& rrc_cfg_)
 
   // Set up pcap and trace
   if (args.mac_pcap.enable) {
-    mac_pcap.open(args.mac_pcap.filename.c_str());
+    mac_pcap.open(args.mac_pcap.filename.c_str(), 0, args.pcap_rotation);
     mac.start_pcap(&mac_pcap);
   }
   if (args.s1ap_pcap.enable) {
-    s1ap_pcap.open(args.s1ap_pcap.filename.c_str());
+    s1ap_pcap.open(args.s1ap_pcap.filename.c_str(), args.pcap_rotation);
     s1ap.start_pcap(&s1ap_pcap);
   }
 
   // Init Rx socket handler
-  rx_sockets.reset(new srslte::rx_multisocket_handler("ENBSOCKETS", stack_log));
+  rx_sockets.reset(new srslte::rx_multisocket_handler("ENBSOCKETS", stack_log, 65, args.io_uring));
 
   // add sync queue
   sync_task_queue = task_sched.make_task_queue(args.sync_queue_size);
 
+  // PDCP and GTP-U run in the user-plane threads if enabled, the other layers reach them through the proxies
+  pdcp_interface_rlc*  rlc_pdcp  = nullptr;
+  pdcp_interface_rrc*  rrc_pdcp  = nullptr;
+  pdcp_interface_gtpu* gtpu_pdcp = nullptr;
+  gtpu_interface_rrc*  rrc_gtpu  = nullptr;
+  if (args.up_thread) {
+    std::vector<up_shard_t> shards;
+    for (uint32_t i = 0; i < std::max(args.nof_up_workers, 1u); ++i) {
+      up_workers.emplace_back(new up_worker(this, i));
+      up_worker& w = *up_workers.back();
+      w.pdcp.reset(new srsenb::pdcp(&w.task_sched, "PDCP"));
+      w.queue      = w.task_sched.make_task_queue();
+      w.sync_queue = w.task_sched.make_task_queue(args.sync_queue_size);
+      shards.push_back({w.pdcp.get(), w.queue});
+    }
+    // GTP-U runs in the first worker
+    srslte::task_scheduler& gtpu_sched = up_workers[0]->task_sched;
+    gtpu_task_queue                    = gtpu_sched.make_task_queue();
+    gtpu_ul_task_queue                 = gtpu_sched.make_task_queue();
+    pdcp_proxy.reset(new pdcp_up_proxy(shards));
+    gtpu_side_pdcp.reset(new pdcp_up_proxy(shards, 0));
+    gtpu_proxy.reset(new gtpu_up_proxy(&gtpu, up_workers[0]->queue));
+    gtpu_ul_proxy.reset(new gtpu_pdcp_proxy(&gtpu, gtpu_ul_task_queue));
+    rlc_pdcp  = pdcp_proxy.get();
+    rrc_pdcp  = pdcp_proxy.get();
+    gtpu_pdcp = gtpu_side_pdcp.get();
+    rrc_gtpu  = gtpu_proxy.get();
+  } else {
+    pdcp.reset(new srsenb::pdcp(&task_sched, "PDCP"));
+    gtpu_task_queue = task_sched.make_task_queue();
+    rlc_pdcp        = pdcp.get();
+    rrc_pdcp        = pdcp.get();
+    gtpu_pdcp       = pdcp.get();
+    rrc_gtpu        = &gtpu;
+  }
+
   // Init all layers
   mac.init(args.mac, rrc_cfg.cell_list, phy, &rlc, &rrc, mac_log);
-  rlc.init(&pdcp, &rrc, &mac, task_sched.get_timer_handler(), rlc_log);
-  pdcp.init(&rlc, &rrc, &gtpu);
-  rrc.init(rrc_cfg, phy, &mac, &rlc, &pdcp, &s1ap, &gtpu);
+  rlc.init(rlc_pdcp, &rrc, &mac, task_sched.get_timer_handler(), rlc_log);
+  if (args.up_thread) {
+    for (uint32_t i = 0; i < up_workers.size(); ++i) {
+      gtpu_interface_pdcp* pdcp_gtpu = i == 0 ? static_cast<gtpu_interface_pdcp*>(&gtpu) : gtpu_ul_proxy.get();
+      up_workers[i]->pdcp->init(&rlc, &rrc, pdcp_gtpu);
+    }
+  } else {
+    pdcp->init(&rlc, &rrc, &gtpu);
+    // The ciphered PDUs are handed back to the stack thread, in order, by the tx crypto queue of each bearer
+    pdcp->set_crypto_offload(args.pdcp_crypto_offload && args.nof_background_threads > 0);
+  }
+  rrc.init(rrc_cfg, phy, &mac, &rlc, rrc_pdcp, &s1ap, rrc_gtpu);
   if (s1ap.init(args.s1ap, &rrc, this) != SRSLTE_SUCCESS) {
     stack_log->error("Couldn't initialize S1AP\n");
     return SRSLTE_ERROR;
@@ -120,15 +165,21 @@ int enb_stack_lte::init(const stack_args_t& args_, const rrc_cfg_t& rrc_cfg_)
                 args.s1ap.mme_addr,
                 args.embms.m1u_multiaddr,
                 args.embms.m1u_if_addr,
-                &pdcp,
+                gtpu_pdcp,
                 this,
                 args.embms.enable)) {
     stack_log->error("Couldn't initialize GTPU\n");
     return SRSLTE_ERROR;
   }
 
+  srslte::tti_deadline_watchdog::add_context_source("stack queues", [this]() { return get_queue_depths(); });
+
   started = true;
   start(STACK_MAIN_THREAD_PRIO);
+  for (auto& w : up_workers) {
+    w->running = true;
+    w->start(STACK_UP_THREAD_PRIO);
+  }
 
   return SRSLTE_SUCCESS;
 }
@@ -140,7 +191,24 @@ void enb_stack_lte::tti_clock()
 
 void enb_stack_lte::tti_clock_impl()
 {
+  // Sample the load of the stack once per TTI
+  size_t queue_depth =
+      enb_task_queue.size() + mme_task_queue.size() + gtpu_task_queue.size() + sync_task_queue.size();
+  if (args.up_thread) {
+    queue_depth += gtpu_ul_task_queue.size();
+  }
+  for (auto& w : up_workers) {
+    queue_depth += w->queue.size() + w->sync_queue.size();
+  }
+  srslte::thread_metrics::observe(srslte::thread_metric::stack_queue_depth, queue_depth);
+  srslte::thread_metrics::observe(srslte::thread_metric::buffer_pool_used, pool->nof_used());
+
   task_sched.tic();
+  for (auto& w : up_workers) {
+    // The PDCP timers of a user-plane thread that falls behind are late rather than blocking this thread
+    srslte::task_scheduler* sched = &w->task_sched;
+    w->sync_queue.try_push([sched]() { sched->tic(); });
+  }
   rrc.tti_clock();
 }
 
@@ -154,13 +222,26 @@ void enb_stack_lte::stop()
 
 void enb_stack_lte::stop_impl()
 {
+  srslte::tti_deadline_watchdog::remove_context_source("stack queues");
   rx_sockets->stop();
 
   s1ap.stop();
-  gtpu.stop();
+  if (args.up_thread) {
+    // GTP-U and PDCP are stopped in their threads, after the calls already queued by the other layers. GTP-U stops
+    // first, so that no downlink SDUs are pushed to the stopped shards
+    for (uint32_t i = 0; i < up_workers.size(); ++i) {
+      up_workers[i]->queue.push([this, i]() { stop_up_impl(i); });
+      up_workers[i]->wait_thread_finish();
+      up_workers[i]->task_sched.stop();
+    }
+  } else {
+    gtpu.stop();
+  }
   mac.stop();
   rlc.stop();
-  pdcp.stop();
+  if (not args.up_thread) {
+    pdcp->stop();
+  }
   rrc.stop();
 
   if (args.mac_pcap.enable) {
@@ -175,29 +256,86 @@ void enb_stack_lte::stop_impl()
   started = false;
 }
 
+void enb_stack_lte::stop_up_impl(uint32_t idx)
+{
+  if (idx == 0) {
+    gtpu.stop();
+  }
+  up_workers[idx]->pdcp->stop();
+  up_workers[idx]->running = false;
+}
+
+std::string enb_stack_lte::get_queue_depths()
+{
+  char s[128];
+  snprintf(s,
+           sizeof(s),
+           "enb=%zu mme=%zu gtpu=%zu sync=%zu",
+           enb_task_queue.size(),
+           mme_task_queue.size(),
+           gtpu_task_queue.size(),
+           sync_task_queue.size());
+  std::string depths(s);
+  if (args.up_thread) {
+    depths += " gtpu_ul=" + std::to_string(gtpu_ul_task_queue.size());
+  }
+  for (uint32_t i = 0; i < up_workers.size(); ++i) {
+    depths += " up" + std::to_string(i) + "=" + std::to_string(up_workers[i]->queue.size());
+  }
+  return depths + "\n";
+}
+
+void enb_stack_lte::cmd_cell_pci(uint32_t cell_id, uint32_t pci)
+{
+  enb_task_queue.push([this, cell_id, pci]() { rrc.set_cell_pci(cell_id, pci); });
+}
+
 bool enb_stack_lte::get_metrics(stack_metrics_t* metrics)
 {
-  // use stack thread to query metrics
+  // use stack thread to query the RRC and S1AP metrics
   auto ret = enb_task_queue.try_push([this]() {
     stack_metrics_t metrics{};
-    mac.get_metrics(metrics.mac);
     rrc.get_metrics(metrics.rrc);
     s1ap.get_metrics(metrics.s1ap);
     pending_stack_metrics.push(metrics);
   });
+  if (not ret.first) {
+    return false;
+  }
 
-  if (ret.first) {
-    // wait for result
-    *metrics = pending_stack_metrics.wait_pop();
-    return true;
+  // MAC and RLC count their metrics with atomic counters, so they are read from this thread in the meantime
+  *metrics = {};
+  mac.get_metrics(metrics->mac);
+  for (uint32_t i = 0; i < ENB_METRICS_MAX_USERS and metrics->mac[i].rnti != SRSLTE_INVALID_RNTI; i++) {
+    rlc.get_metrics(metrics->mac[i].rnti, metrics->rlc[i]);
   }
-  return false;
+
+  // wait for result
+  stack_metrics_t upper = pending_stack_metrics.wait_pop();
+  metrics->rrc          = upper.rrc;
+  metrics->s1ap         = upper.s1ap;
+  return true;
 }
 
 void enb_stack_lte::run_thread()
 {
   while (started) {
     task_sched.run_next_task();
+    // send the uplink GTP-U PDUs generated by the task in one go
+    if (not args.up_thread) {
+      gtpu.flush_tx();
+    }
+  }
+}
+
+void enb_stack_lte::run_up_thread(uint32_t idx)
+{
+  up_worker& w = *up_workers[idx];
+  while (w.running) {
+    w.task_sched.run_next_task();
+    if (idx == 0) {
+      gtpu.flush_tx();
+    }
   }
 }
 
@@ -231,24 +369,28 @@ void enb_stack_lte::remove_mme_socket(int fd)
 
 void enb_stack_lte::add_gtpu_s1u_socket_handler(int fd)
 {
-  auto gtpu_s1u_handler = [this](srslte::unique_byte_buffer_t pdu, const sockaddr_in& from) {
-    auto task_handler = [this, from](srslte::unique_byte_buffer_t& t) {
-      gtpu.handle_gtpu_s1u_rx_packet(std::move(t), from);
+  // All the packets read by one recvmmsg call are handled by the same stack task
+  auto gtpu_s1u_handler = [this](srslte::rx_multisocket_handler::recvfrom_batch_t batch) {
+    auto task_handler = [this](srslte::rx_multisocket_handler::recvfrom_batch_t& b) {
+      gtpu.handle_gtpu_s1u_rx_batch(std::move(b));
     };
-    gtpu_task_queue.push(std::bind(task_handler, std::move(pdu)));
+    gtpu_task_queue.push(std::bind(task_handler, std::move(batch)));
   };
-  rx_sockets->add_socket_pdu_handler(fd, gtpu_s1u_handler);
+  rx_sockets->add_socket_pdu_batch_handler(fd, gtpu_s1u_handler);
 }
 
 void enb_stack_lte::add_gtpu_m1u_socket_handler(int fd)
 {
-  auto gtpu_m1u_handler = [this](srslte::unique_byte_buffer_t pdu, const sockaddr_in& from) {
-    auto task_handler = [this, from](srslte::unique_byte_buffer_t& t) {
-      gtpu.handle_gtpu_m1u_rx_packet(std::move(t), from);
+  // All the packets read by one recvmmsg call are handled by the same stack task
+  auto gtpu_m1u_handler = [this](srslte::rx_multisocket_handler::recvfrom_batch_t batch) {
+    auto task_handler = [this](srslte::rx_multisocket_handler::recvfrom_batch_t& b) {
+      for (auto& d : b) {
+        gtpu.handle_gtpu_m1u_rx_packet(std::move(d.pdu), d.from);
+      }
     };
-    gtpu_task_queue.push(std::bind(task_handler, std::move(pdu)));
+    gtpu_task_queue.push(std::bind(task_handler, std::move(batch)));
   };
-  rx_sockets->add_socket_pdu_handler(fd, gtpu_m1u_handler);
+  rx_sockets->add_socket_pdu_batch_handler(fd, gtpu_m1u_handler);
 }
 
 } // namespace srsenb
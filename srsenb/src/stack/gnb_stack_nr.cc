@@ -184,7 +184,34 @@ int gnb_stack_nr::rx_data_indication(rx_data_ind_t& grant)
 // Temporary GW interface
 void gnb_stack_nr::write_sdu(uint32_t lcid, srslte::unique_byte_buffer_t sdu)
 {
-  m_pdcp->write_sdu(args.coreless.rnti, lcid, std::move(sdu));
+  // The SDUs that arrive while the stack thread is busy are passed to SDAP in a single burst
+  std::lock_guard<std::mutex> lock(dl_sdu_mutex);
+  if (dl_sdus.empty()) {
+    gw_task_queue.push([this]() { write_dl_sdus(); });
+  }
+  dl_sdus.emplace_back(lcid, std::move(sdu));
+}
+
+void gnb_stack_nr::write_dl_sdus()
+{
+  {
+    std::lock_guard<std::mutex> lock(dl_sdu_mutex);
+    std::swap(dl_sdus, dl_sdus_burst);
+  }
+
+  // Consecutive SDUs of the same bearer are passed to SDAP in one call
+  uint32_t lcid = 0;
+  for (auto& s : dl_sdus_burst) {
+    if (not dl_bearer_sdus.empty() and s.first != lcid) {
+      m_sdap->write_sdus(args.coreless.rnti, lcid, dl_bearer_sdus);
+    }
+    lcid = s.first;
+    dl_bearer_sdus.push_back(std::move(s.second));
+  }
+  if (not dl_bearer_sdus.empty()) {
+    m_sdap->write_sdus(args.coreless.rnti, lcid, dl_bearer_sdus);
+  }
+  dl_sdus_burst.clear();
 }
 
 bool gnb_stack_nr::is_lcid_enabled(uint32_t lcid)
@@ -19,6 +19,7 @@
  *
  */
 
+#include <cmath>
 #include <pthread.h>
 #include <srslte/interfaces/sched_interface.h>
 #include <string.h>
@@ -29,7 +30,10 @@
 #include "srslte/common/log.h"
 #include "srslte/common/log_helper.h"
 #include "srslte/common/rwlock_guard.h"
+#include "srslte/common/thread_metrics.h"
 #include "srslte/common/time_prof.h"
+#include "srslte/common/tti_deadline_watchdog.h"
+#include "srslte/common/tti_trace.h"
 
 //#define WRITE_SIB_PCAP
 using namespace asn1::rrc;
@@ -72,9 +76,13 @@ bool mac::init(const mac_args_t&        args_,
     stack_task_queue = task_sched.make_task_queue();
 
     scheduler.init(rrc);
+    softbuffers.init(args.nof_prb, args.pusch_8bit_softbuffers);
 
     // Set default scheduler configuration
     scheduler.set_sched_cfg(&args.sched);
+    if (not args.sched_trace_filename.empty()) {
+      scheduler.start_trace(args.sched_trace_filename);
+    }
 
     // Init softbuffer for SI messages
     common_buffers.resize(cells.size());
@@ -94,6 +102,9 @@ bool mac::init(const mac_args_t&        args_,
     // Pre-alloc UE objects for first attaching users
     prealloc_ue(10);
 
+    srslte::tti_deadline_watchdog::add_context_source("MAC scheduler",
+                                                      [this]() { return sched_decisions_to_string(); });
+
     started = true;
   }
 
@@ -104,6 +115,7 @@ void mac::stop()
 {
   srslte::rwlock_write_guard lock(rwlock);
   if (started) {
+    srslte::tti_deadline_watchdog::remove_context_source("MAC scheduler");
     ue_db.clear();
     for (auto& cc : common_buffers) {
       for (int i = 0; i < NOF_BCCH_DLSCH_MSG; i++) {
@@ -147,7 +159,13 @@ int mac::rlc_buffer_state(uint16_t rnti, uint32_t lc_id, uint32_t tx_queue, uint
   int                       ret = -1;
   if (ue_db.count(rnti)) {
     if (rnti != SRSLTE_MRNTI) {
-      ret = scheduler.dl_rlc_buffer_state(rnti, lc_id, tx_queue, retx_queue);
+      // Coalesced per TTI and passed to the scheduler before the next DL scheduling, see flush_dl_buffer_states()
+      if (ue_db[rnti]->set_dl_buffer_state(lc_id, tx_queue, retx_queue)) {
+        ret = 0;
+      } else {
+        ue_db[rnti]->metrics_dl_buffer(lc_id, tx_queue + retx_queue);
+        ret = scheduler.dl_rlc_buffer_state(rnti, lc_id, tx_queue, retx_queue);
+      }
     } else {
       for (uint32_t i = 0; i < mch.num_mtch_sched; i++) {
         if (lc_id == mch.mtch_sched[i].lcid) {
@@ -162,6 +180,20 @@ int mac::rlc_buffer_state(uint16_t rnti, uint32_t lc_id, uint32_t tx_queue, uint
   return ret;
 }
 
+/// Passes to the scheduler the DL RLC buffer states set since the previous TTI, once per bearer
+void mac::flush_dl_buffer_states()
+{
+  srslte::rwlock_read_guard lock(rwlock);
+  for (auto& u : ue_db) {
+    uint16_t rnti = u.first;
+    ue*      user = u.second.get();
+    user->flush_dl_buffer_state([this, rnti, user](uint32_t lcid, uint32_t tx_queue, uint32_t retx_queue) {
+      user->metrics_dl_buffer(lcid, tx_queue + retx_queue);
+      scheduler.dl_rlc_buffer_state(rnti, lcid, tx_queue, retx_queue);
+    });
+  }
+}
+
 int mac::bearer_ue_cfg(uint16_t rnti, uint32_t lc_id, sched_interface::ue_bearer_cfg_t* cfg)
 {
   int                       ret = -1;
@@ -219,6 +251,9 @@ int mac::ue_cfg(uint16_t rnti, sched_interface::ue_cfg_t* cfg)
   }
 
   // Update Scheduler configuration
+  if (cfg != nullptr and not cfg->supported_cc_list.empty()) {
+    ue_ptr->metrics_pcell(cfg->supported_cc_list[0].enb_cc_idx);
+  }
   if (cfg != nullptr and scheduler.ue_cfg(rnti, *cfg) == SRSLTE_ERROR) {
     Error("Registering new UE rnti=0x%x to SCHED\n", rnti);
     return SRSLTE_ERROR;
@@ -273,6 +308,14 @@ int mac::ue_set_crnti(uint16_t temp_crnti, uint16_t crnti, sched_interface::ue_c
 int mac::cell_cfg(const std::vector<sched_interface::cell_cfg_t>& cell_cfg_)
 {
   cell_config = cell_cfg_;
+
+  // The SIBs are packed once by RRC before configuring the cells, so they are not requested on every transmission
+  for (uint32_t cc = 0; cc < cell_config.size() and cc < common_buffers.size(); ++cc) {
+    for (uint32_t i = 0; i < NOF_BCCH_DLSCH_MSG; ++i) {
+      common_buffers[cc].bcch_payload[i] =
+          (cell_config[cc].sibs[i].len > 0 and rrc_h != nullptr) ? rrc_h->read_pdu_bcch_dlsch(cc, i) : nullptr;
+    }
+  }
   return scheduler.cell_cfg(cell_config);
 }
 
@@ -305,6 +348,8 @@ int mac::ack_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t tb_
   ue_db[rnti]->metrics_tx(ack, nof_bytes);
 
   if (ack) {
+    ue_db[rnti]->release_tx_softbuffer(enb_cc_idx, tti, tb_idx);
+    ue_db[rnti]->metrics_dl_ack(enb_cc_idx, tti, tb_idx);
     if (nof_bytes > 64) { // do not count RLC status messages only
       rrc_h->set_activity_user(rnti);
       log_h->info("DL activity rnti=0x%x, n_bytes=%d\n", rnti, nof_bytes);
@@ -336,6 +381,7 @@ int mac::crc_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, uint32_t
   if (crc) {
     Info("Pushing PDU rnti=0x%x, tti_rx=%d, nof_bytes=%d\n", rnti, tti_rx, nof_bytes);
     ue_db[rnti]->push_pdu(ue_cc_idx, tti_rx, nof_bytes);
+    ue_db[rnti]->release_rx_softbuffer(ue_cc_idx, tti_rx);
     stack_task_queue.push([this]() { process_pdus(); });
   } else {
     ue_db[rnti]->deallocate_pdu(ue_cc_idx, tti_rx);
@@ -390,6 +436,20 @@ int mac::cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t cqi
   return SRSLTE_SUCCESS;
 }
 
+int mac::sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi_value)
+{
+  log_h->step(tti);
+  srslte::rwlock_read_guard lock(rwlock);
+
+  if (not check_ue_exists(rnti)) {
+    return SRSLTE_ERROR;
+  }
+
+  scheduler.dl_sb_cqi_info(tti, rnti, enb_cc_idx, sb_idx, cqi_value);
+
+  return SRSLTE_SUCCESS;
+}
+
 int mac::snr_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, float snr)
 {
   log_h->step(tti);
@@ -403,6 +463,28 @@ int mac::snr_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, float snr)
   return scheduler.ul_cqi_info(tti, rnti, enb_cc_idx, cqi, 0);
 }
 
+int mac::ul_sb_snr_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, const float* snr, uint32_t nof_sb)
+{
+  log_h->step(tti);
+  srslte::rwlock_read_guard lock(rwlock);
+
+  if (not check_ue_exists(rnti)) {
+    return SRSLTE_ERROR;
+  }
+
+  int ret = SRSLTE_SUCCESS;
+  for (uint32_t sb_idx = 0; sb_idx < nof_sb; sb_idx++) {
+    if (std::isnan(snr[sb_idx])) {
+      continue;
+    }
+    uint32_t cqi = srslte_cqi_from_snr(snr[sb_idx]);
+    if (scheduler.ul_sb_cqi_info(tti, rnti, enb_cc_idx, sb_idx, cqi) != SRSLTE_SUCCESS) {
+      ret = SRSLTE_ERROR;
+    }
+  }
+  return ret;
+}
+
 int mac::ta_info(uint32_t tti, uint16_t rnti, float ta_us)
 {
   srslte::rwlock_read_guard lock(rwlock);
@@ -457,6 +539,9 @@ uint16_t mac::reserve_new_crnti(const sched_interface::ue_cfg_t& ue_cfg)
   if (pcap != nullptr) {
     ue_ptr->start_pcap(pcap);
   }
+  if (not ue_cfg.supported_cc_list.empty()) {
+    ue_ptr->metrics_pcell(ue_cfg.supported_cc_list[0].enb_cc_idx);
+  }
 
   {
     srslte::rwlock_write_guard lock(rwlock);
@@ -491,6 +576,7 @@ void mac::rach_detected(uint32_t tti, uint32_t enb_cc_idx, uint32_t preamble_idx
   if (pcap != nullptr) {
     ue_ptr->start_pcap(pcap);
   }
+  ue_ptr->metrics_pcell(enb_cc_idx);
 
   {
     srslte::rwlock_write_guard lock(rwlock);
@@ -547,7 +633,7 @@ void mac::prealloc_ue(uint32_t nof_ue)
 {
   for (uint32_t i = 0; i < nof_ue; i++) {
     std::unique_ptr<ue> ptr = std::unique_ptr<ue>(
-        new ue(allocate_rnti(), args.nof_prb, &scheduler, rrc_h, rlc_h, phy_h, log_h, cells.size()));
+        new ue(allocate_rnti(), args.nof_prb, &scheduler, rrc_h, rlc_h, phy_h, log_h, &softbuffers, cells.size()));
     ue_pool.push(std::move(ptr));
   }
 }
@@ -560,19 +646,27 @@ int mac::get_dl_sched(uint32_t tti_tx_dl, dl_sched_list_t& dl_sched_res_list)
 
   log_h->step(TTI_SUB(tti_tx_dl, FDD_HARQ_DELAY_UL_MS));
 
+  flush_dl_buffer_states();
+
   for (uint32_t enb_cc_idx = 0; enb_cc_idx < cell_config.size(); enb_cc_idx++) {
     // Run scheduler with current info
     sched_interface::dl_sched_res_t sched_result = {};
+    srslte::tti_span                sched_span(srslte::tti_stage::dl_sched);
+    srslte::thread_metric_timer     sched_timer(srslte::thread_metric::sched_time_us);
     if (scheduler.dl_sched(tti_tx_dl, enb_cc_idx, sched_result) < 0) {
       Error("Running scheduler\n");
       return SRSLTE_ERROR;
     }
+    sched_span.stop();
+    sched_timer.stop();
+    save_sched_decision(tti_tx_dl, enb_cc_idx, sched_result);
 
     int         n            = 0;
     dl_sched_t* dl_sched_res = &dl_sched_res_list[enb_cc_idx];
 
     {
       srslte::rwlock_read_guard lock(rwlock);
+      srslte::tti_span          build_span(srslte::tti_stage::mac_pdu_build);
 
       // Copy data grants
       for (uint32_t i = 0; i < sched_result.nof_data_elems; i++) {
@@ -585,9 +679,18 @@ int mac::get_dl_sched(uint32_t tti_tx_dl, dl_sched_list_t& dl_sched_res_list)
           // Copy dci info
           dl_sched_res->pdsch[n].dci = sched_result.data[i].dci;
 
+          ue_db[rnti]->set_dl_harq_tti(
+              enb_cc_idx, tti_tx_dl, sched_result.data[i].dci.ue_cc_idx, sched_result.data[i].dci.pid);
+
           for (uint32_t tb = 0; tb < SRSLTE_MAX_TB; tb++) {
-            dl_sched_res->pdsch[n].softbuffer_tx[tb] =
-                ue_db[rnti]->get_tx_softbuffer(sched_result.data[i].dci.ue_cc_idx, sched_result.data[i].dci.pid, tb);
+            // Disabled TBs do not take a softbuffer from the pool
+            if (sched_result.data[i].tbs[tb] == 0) {
+              dl_sched_res->pdsch[n].softbuffer_tx[tb] = nullptr;
+              dl_sched_res->pdsch[n].data[tb]          = nullptr;
+              continue;
+            }
+            dl_sched_res->pdsch[n].softbuffer_tx[tb] = ue_db[rnti]->get_tx_softbuffer(
+                sched_result.data[i].dci.ue_cc_idx, sched_result.data[i].dci.pid, tb, sched_result.data[i].tbs[tb]);
 
             // If the Rx soft-buffer is not given, abort transmission
             if (dl_sched_res->pdsch[n].softbuffer_tx[tb] == nullptr) {
@@ -664,7 +767,7 @@ int mac::get_dl_sched(uint32_t tti_tx_dl, dl_sched_list_t& dl_sched_res_list)
       if (sched_result.bc[i].type == sched_interface::dl_sched_bc_t::BCCH) {
         dl_sched_res->pdsch[n].softbuffer_tx[0] =
             &common_buffers[enb_cc_idx].bcch_softbuffer_tx[sched_result.bc[i].index];
-        dl_sched_res->pdsch[n].data[0] = rrc_h->read_pdu_bcch_dlsch(enb_cc_idx, sched_result.bc[i].index);
+        dl_sched_res->pdsch[n].data[0] = common_buffers[enb_cc_idx].bcch_payload[sched_result.bc[i].index];
 #ifdef WRITE_SIB_PCAP
         if (pcap) {
           pcap->write_dl_sirnti(dl_sched_res->pdsch[n].data[0], sched_result.bc[i].tbs, true, tti_tx_dl, enb_cc_idx);
@@ -855,10 +958,15 @@ int mac::get_ul_sched(uint32_t tti_tx_ul, ul_sched_list_t& ul_sched_res_list)
 
     // Run scheduler with current info
     sched_interface::ul_sched_res_t sched_result = {};
+    srslte::tti_span                sched_span(srslte::tti_stage::ul_sched);
+    srslte::thread_metric_timer     sched_timer(srslte::thread_metric::sched_time_us);
     if (scheduler.ul_sched(tti_tx_ul, enb_cc_idx, sched_result) < 0) {
       Error("Running scheduler\n");
       return SRSLTE_ERROR;
     }
+    sched_span.stop();
+    sched_timer.stop();
+    save_sched_decision(tti_tx_ul, enb_cc_idx, sched_result);
 
     {
       srslte::rwlock_read_guard lock(rwlock);
@@ -877,8 +985,8 @@ int mac::get_ul_sched(uint32_t tti_tx_ul, ul_sched_list_t& ul_sched_res_list)
             phy_ul_sched_res->pusch[n].current_tx_nb = sched_result.pusch[i].current_tx_nb;
             phy_ul_sched_res->pusch[n].needs_pdcch   = sched_result.pusch[i].needs_pdcch;
             phy_ul_sched_res->pusch[n].dci           = sched_result.pusch[i].dci;
-            phy_ul_sched_res->pusch[n].softbuffer_rx =
-                ue_db[rnti]->get_rx_softbuffer(sched_result.pusch[i].dci.ue_cc_idx, tti_tx_ul);
+            phy_ul_sched_res->pusch[n].softbuffer_rx = ue_db[rnti]->get_rx_softbuffer(
+                sched_result.pusch[i].dci.ue_cc_idx, tti_tx_ul, sched_result.pusch[i].tbs);
 
             // If the Rx soft-buffer is not given, abort reception
             if (phy_ul_sched_res->pusch[n].softbuffer_rx == nullptr) {
@@ -914,6 +1022,75 @@ int mac::get_ul_sched(uint32_t tti_tx_ul, ul_sched_list_t& ul_sched_res_list)
   return SRSLTE_SUCCESS;
 }
 
+void mac::save_sched_decision(uint32_t tti, uint32_t enb_cc_idx, const sched_interface::dl_sched_res_t& res)
+{
+  sched_decision_t d = {};
+  d.tti              = tti;
+  d.enb_cc_idx       = enb_cc_idx;
+  d.dl               = true;
+  d.cfi              = res.cfi;
+  d.nof_grants       = res.nof_data_elems;
+  d.nof_rar          = res.nof_rar_elems;
+  d.nof_bc           = res.nof_bc_elems;
+  for (uint32_t i = 0; i < SRSLTE_MIN(res.nof_data_elems, sched_decision_t::max_grants); i++) {
+    d.rnti[i] = res.data[i].dci.rnti;
+    d.tbs[i]  = res.data[i].tbs[0] + res.data[i].tbs[1];
+  }
+
+  std::lock_guard<std::mutex> lock(sched_decisions_mutex);
+  sched_decisions[nof_sched_decisions++ % sched_decisions.size()] = d;
+}
+
+void mac::save_sched_decision(uint32_t tti, uint32_t enb_cc_idx, const sched_interface::ul_sched_res_t& res)
+{
+  sched_decision_t d = {};
+  d.tti              = tti;
+  d.enb_cc_idx       = enb_cc_idx;
+  d.nof_grants       = res.nof_dci_elems;
+  d.nof_phich        = res.nof_phich_elems;
+  for (uint32_t i = 0; i < SRSLTE_MIN(res.nof_dci_elems, sched_decision_t::max_grants); i++) {
+    d.rnti[i] = res.pusch[i].dci.rnti;
+    d.tbs[i]  = res.pusch[i].tbs;
+  }
+
+  std::lock_guard<std::mutex> lock(sched_decisions_mutex);
+  sched_decisions[nof_sched_decisions++ % sched_decisions.size()] = d;
+}
+
+std::string mac::sched_decisions_to_string()
+{
+  std::string s;
+  char        line[256];
+
+  std::lock_guard<std::mutex> lock(sched_decisions_mutex);
+  uint32_t first = nof_sched_decisions > sched_decisions.size() ? nof_sched_decisions - sched_decisions.size() : 0;
+  for (uint32_t i = first; i < nof_sched_decisions; i++) {
+    const sched_decision_t& d = sched_decisions[i % sched_decisions.size()];
+    int n = d.dl ? snprintf(line,
+                            sizeof(line),
+                            "tti=%d cc=%d DL cfi=%d data=%d rar=%d bc=%d",
+                            d.tti,
+                            d.enb_cc_idx,
+                            d.cfi,
+                            d.nof_grants,
+                            d.nof_rar,
+                            d.nof_bc)
+                 : snprintf(line,
+                            sizeof(line),
+                            "tti=%d cc=%d UL pusch=%d phich=%d",
+                            d.tti,
+                            d.enb_cc_idx,
+                            d.nof_grants,
+                            d.nof_phich);
+    for (uint32_t j = 0; j < SRSLTE_MIN(d.nof_grants, sched_decision_t::max_grants); j++) {
+      n += snprintf(line + n, sizeof(line) - n, " 0x%x:%d", d.rnti[j], d.tbs[j]);
+    }
+    s += line;
+    s += "\n";
+  }
+  return s;
+}
+
 bool mac::process_pdus()
 {
   srslte::rwlock_read_guard lock(rwlock);
@@ -941,7 +1118,8 @@ void mac::write_mcch(sib_type2_s* sib2_, sib_type13_r9_s* sib13_, mcch_msg_s* mc
   current_mcch_length = bref.distance_bytes(&mcch_payload_buffer[1]);
   current_mcch_length = current_mcch_length + rlc_header_len;
   ue_db[SRSLTE_MRNTI] =
-      std::unique_ptr<ue>{new ue(SRSLTE_MRNTI, args.nof_prb, &scheduler, rrc_h, rlc_h, phy_h, log_h, cells.size())};
+      std::unique_ptr<ue>{new ue(
+          SRSLTE_MRNTI, args.nof_prb, &scheduler, rrc_h, rlc_h, phy_h, log_h, &softbuffers, cells.size())};
 
   rrc_h->add_user(SRSLTE_MRNTI, {});
 }
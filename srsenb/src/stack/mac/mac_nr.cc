@@ -37,8 +37,6 @@ mac_nr::mac_nr() : pool(srslte::byte_buffer_pool::get_instance()), log_h("MAC")
   for (int i = 0; i < SRSLTE_FDD_NOF_HARQ; i++) {
     ue_tx_buffer.emplace_back(srslte::allocate_unique_buffer(*pool));
   }
-
-  ue_rlc_buffer = srslte::allocate_unique_buffer(*pool);
 }
 
 mac_nr::~mac_nr()
@@ -137,18 +135,18 @@ void mac_nr::get_dl_config(const uint32_t                               tti,
     ue_tx_buffer.at(buffer_index)->clear();
     ue_tx_pdu.init_tx(ue_tx_buffer.at(buffer_index).get(), args.tb_size);
 
-    // read RLC PDU
-    ue_rlc_buffer->clear();
-    int pdu_len = rlc_h->read_pdu(args.rnti, 4, ue_rlc_buffer->msg, args.tb_size - 2);
+    // read RLC PDU straight into the MAC PDU
+    uint32_t max_len = 0;
+    uint8_t* rd      = ue_tx_pdu.reserve_sdu(4, &max_len);
+    int      pdu_len = rd != nullptr ? rlc_h->read_pdu(args.rnti, 4, rd, max_len) : 0;
 
     // Only create PDU if RLC has something to tx
     if (pdu_len > 0) {
       log_h->info("Adding MAC PDU for RNTI=%d\n", args.rnti);
-      ue_rlc_buffer->N_bytes = pdu_len;
-      log_h->info_hex(ue_rlc_buffer->msg, ue_rlc_buffer->N_bytes, "Read %d B from RLC\n", ue_rlc_buffer->N_bytes);
+      log_h->info_hex(rd, pdu_len, "Read %d B from RLC\n", pdu_len);
 
       // add to MAC PDU and pack
-      ue_tx_pdu.add_sdu(4, ue_rlc_buffer->msg, ue_rlc_buffer->N_bytes);
+      ue_tx_pdu.commit_sdu(pdu_len);
       ue_tx_pdu.pack();
 
       log_h->debug_hex(ue_tx_buffer.at(buffer_index)->msg,
@@ -231,7 +229,7 @@ int mac_nr::handle_pdu(srslte::unique_byte_buffer_t pdu)
   ue_rx_pdu.unpack(pdu->msg, pdu->N_bytes);
 
   for (uint32_t i = 0; i < ue_rx_pdu.get_num_subpdus(); ++i) {
-    srslte::mac_nr_sch_subpdu subpdu = ue_rx_pdu.get_subpdu(i);
+    const srslte::mac_nr_sch_subpdu& subpdu = ue_rx_pdu.get_subpdu(i);
     log_h->info("Handling subPDU %d/%d: lcid=%d, sdu_len=%d\n",
                 i,
                 ue_rx_pdu.get_num_subpdus(),
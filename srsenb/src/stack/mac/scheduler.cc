@@ -128,6 +128,19 @@ bool sched_cell_params_t::set_cfg(uint32_t                             enb_cc_id
   P        = srslte_ra_type0_P(cfg.cell.nof_prb);
   nof_rbgs = srslte::ceil_div(cfg.cell.nof_prb, P);
 
+  // precompute the MCS and TBS lookup tables
+  uint32_t max_mcs_dl = sched_cfg->pdsch_max_mcs >= 0 ? sched_cfg->pdsch_max_mcs : 28;
+  uint32_t max_mcs_ul = sched_cfg->pusch_max_mcs >= 0 ? sched_cfg->pusch_max_mcs : 28;
+  mcs_tables[0].init(cfg.cell, max_mcs_dl, false, false);
+  mcs_tables[1].init(cfg.cell, std::min(max_mcs_dl, 27u), true, false);
+  mcs_tables[2].init(cfg.cell, max_mcs_ul, false, true);
+  mcs_tables[3].init(cfg.cell, max_mcs_ul, true, true);
+
+  // the SIBs are packed once by RRC, so their format 1A MCS and TBS only change with the cell configuration
+  for (uint32_t i = 0; i < sched_interface::MAX_SIBS; ++i) {
+    sib_format1a[i] = cfg.sibs[i].len > 0 ? sched_utils::get_format1a_tbs(cfg.sibs[i].len) : sched_format1a_t{};
+  }
+
   return true;
 }
 
@@ -139,7 +152,12 @@ bool sched_cell_params_t::set_cfg(uint32_t                             enb_cc_id
 
 sched::sched() : log_h(srslte::logmap::get("MAC")) {}
 
-sched::~sched() {}
+sched::~sched()
+{
+  if (cc_workers != nullptr) {
+    cc_workers->stop();
+  }
+}
 
 void sched::init(rrc_interface_mac* rrc_)
 {
@@ -154,6 +172,7 @@ void sched::init(rrc_interface_mac* rrc_)
 int sched::reset()
 {
   std::lock_guard<std::mutex> lock(sched_mutex);
+  process_feedback();
   configured = false;
   for (std::unique_ptr<carrier_sched>& c : carrier_schedulers) {
     c->reset();
@@ -168,11 +187,40 @@ void sched::set_sched_cfg(sched_interface::sched_args_t* sched_cfg_)
   if (sched_cfg_ != nullptr) {
     sched_cfg = *sched_cfg_;
   }
+  start_cc_workers();
+}
+
+bool sched::start_trace(const std::string& filename)
+{
+  std::lock_guard<std::mutex> lock(sched_mutex);
+  trace.reset(new sched_trace{});
+  if (not trace->open(filename)) {
+    Error("SCHED: Failed to open trace file %s\n", filename.c_str());
+    trace.reset();
+    return false;
+  }
+  log_h->info("SCHED: Recording the scheduler inputs to %s\n", filename.c_str());
+  return true;
+}
+
+void sched::start_cc_workers()
+{
+  // The calling thread allocates one of the carriers, the workers the others
+  if (sched_cfg.nof_cc_workers == 0 or carrier_schedulers.size() < 2 or cc_workers != nullptr) {
+    return;
+  }
+  uint32_t nof_workers = std::min(sched_cfg.nof_cc_workers, (uint32_t)carrier_schedulers.size() - 1);
+  cc_workers.reset(new srslte::task_thread_pool(nof_workers));
+  cc_workers->start();
+  log_h->info("SCHED: Allocating %zd carriers in parallel with %d workers\n", carrier_schedulers.size(), nof_workers);
 }
 
 int sched::cell_cfg(const std::vector<sched_interface::cell_cfg_t>& cell_cfg)
 {
   std::lock_guard<std::mutex> lock(sched_mutex);
+  if (trace != nullptr) {
+    trace->cell_cfg(cell_cfg);
+  }
   // Setup derived config params
   sched_cell_params.resize(cell_cfg.size());
   for (uint32_t cc_idx = 0; cc_idx < cell_cfg.size(); ++cc_idx) {
@@ -192,6 +240,7 @@ int sched::cell_cfg(const std::vector<sched_interface::cell_cfg_t>& cell_cfg)
   for (uint32_t i = 0; i < sched_cell_params.size(); ++i) {
     carrier_schedulers[i]->carrier_cfg(sched_cell_params[i]);
   }
+  start_cc_workers();
 
   configured = true;
 
@@ -207,6 +256,10 @@ int sched::cell_cfg(const std::vector<sched_interface::cell_cfg_t>& cell_cfg)
 int sched::ue_cfg(uint16_t rnti, const sched_interface::ue_cfg_t& ue_cfg)
 {
   std::lock_guard<std::mutex> lock(sched_mutex);
+  if (trace != nullptr) {
+    trace->ue_cfg(rnti, ue_cfg);
+  }
+  process_feedback();
   // Add or config user
   auto it = ue_db.find(rnti);
   if (it == ue_db.end()) {
@@ -222,6 +275,10 @@ int sched::ue_cfg(uint16_t rnti, const sched_interface::ue_cfg_t& ue_cfg)
 int sched::ue_rem(uint16_t rnti)
 {
   std::lock_guard<std::mutex> lock(sched_mutex);
+  if (trace != nullptr) {
+    trace->event("ue_rem", {rnti});
+  }
+  process_feedback();
   if (ue_db.count(rnti) > 0) {
     ue_db.erase(rnti);
   } else {
@@ -238,6 +295,9 @@ bool sched::ue_exists(uint16_t rnti)
 
 void sched::phy_config_enabled(uint16_t rnti, bool enabled)
 {
+  if (trace != nullptr) {
+    trace->event("phy_cfg", {rnti, enabled});
+  }
   // TODO: Check if correct use of last_tti
   ue_db_access(
       rnti, [this, enabled](sched_ue& ue) { ue.phy_config_enabled(last_tti.to_uint(), enabled); }, __PRETTY_FUNCTION__);
@@ -245,11 +305,17 @@ void sched::phy_config_enabled(uint16_t rnti, bool enabled)
 
 int sched::bearer_ue_cfg(uint16_t rnti, uint32_t lc_id, sched_interface::ue_bearer_cfg_t* cfg_)
 {
+  if (trace != nullptr) {
+    trace->event("bearer_cfg", {rnti, lc_id, cfg_->direction, cfg_->group, cfg_->priority, cfg_->pbr, cfg_->bsd});
+  }
   return ue_db_access(rnti, [lc_id, cfg_](sched_ue& ue) { ue.set_bearer_cfg(lc_id, cfg_); });
 }
 
 int sched::bearer_ue_rem(uint16_t rnti, uint32_t lc_id)
 {
+  if (trace != nullptr) {
+    trace->event("bearer_rem", {rnti, lc_id});
+  }
   return ue_db_access(rnti, [lc_id](sched_ue& ue) { ue.rem_bearer(lc_id); });
 }
 
@@ -273,16 +339,25 @@ uint32_t sched::get_ul_buffer(uint16_t rnti)
 
 int sched::dl_rlc_buffer_state(uint16_t rnti, uint32_t lc_id, uint32_t tx_queue, uint32_t retx_queue)
 {
+  if (trace != nullptr) {
+    trace->event("dl_rlc_bs", {rnti, lc_id, tx_queue, retx_queue});
+  }
   return ue_db_access(rnti, [&](sched_ue& ue) { ue.dl_buffer_state(lc_id, tx_queue, retx_queue); });
 }
 
 int sched::dl_mac_buffer_state(uint16_t rnti, uint32_t ce_code, uint32_t nof_cmds)
 {
+  if (trace != nullptr) {
+    trace->event("dl_mac_bs", {rnti, ce_code, nof_cmds});
+  }
   return ue_db_access(rnti, [ce_code, nof_cmds](sched_ue& ue) { ue.mac_buffer_state(ce_code, nof_cmds); });
 }
 
 int sched::dl_ack_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t tb_idx, bool ack)
 {
+  if (trace != nullptr) {
+    trace->event("dl_ack", {tti, rnti, enb_cc_idx, tb_idx, ack});
+  }
   int ret = -1;
   ue_db_access(rnti, [&](sched_ue& ue) { ret = ue.set_ack_info(tti, enb_cc_idx, tb_idx, ack); }, __PRETTY_FUNCTION__);
   return ret;
@@ -290,54 +365,105 @@ int sched::dl_ack_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_
 
 int sched::ul_crc_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, bool crc)
 {
-  return ue_db_access(
-      rnti, [tti_rx, enb_cc_idx, crc](sched_ue& ue) { ue.set_ul_crc(srslte::tti_point{tti_rx}, enb_cc_idx, crc); });
+  if (trace != nullptr) {
+    trace->event("ul_crc", {tti_rx, rnti, enb_cc_idx, crc});
+  }
+  return push_feedback({ue_feedback_t::ul_crc, tti_rx, rnti, enb_cc_idx, crc, 0});
 }
 
 int sched::dl_ri_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t ri_value)
 {
-  return ue_db_access(rnti, [tti, enb_cc_idx, ri_value](sched_ue& ue) { ue.set_dl_ri(tti, enb_cc_idx, ri_value); });
+  if (trace != nullptr) {
+    trace->event("dl_ri", {tti, rnti, enb_cc_idx, ri_value});
+  }
+  return push_feedback({ue_feedback_t::dl_ri, tti, rnti, enb_cc_idx, ri_value, 0});
 }
 
 int sched::dl_pmi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t pmi_value)
 {
-  return ue_db_access(rnti, [tti, enb_cc_idx, pmi_value](sched_ue& ue) { ue.set_dl_pmi(tti, enb_cc_idx, pmi_value); });
+  if (trace != nullptr) {
+    trace->event("dl_pmi", {tti, rnti, enb_cc_idx, pmi_value});
+  }
+  return push_feedback({ue_feedback_t::dl_pmi, tti, rnti, enb_cc_idx, pmi_value, 0});
 }
 
 int sched::dl_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t cqi_value)
 {
-  return ue_db_access(rnti, [tti, enb_cc_idx, cqi_value](sched_ue& ue) { ue.set_dl_cqi(tti, enb_cc_idx, cqi_value); });
+  if (trace != nullptr) {
+    trace->event("dl_cqi", {tti, rnti, enb_cc_idx, cqi_value});
+  }
+  return push_feedback({ue_feedback_t::dl_cqi, tti, rnti, enb_cc_idx, cqi_value, 0});
+}
+
+int sched::dl_sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi_value)
+{
+  if (trace != nullptr) {
+    trace->event("dl_sb_cqi", {tti, rnti, enb_cc_idx, sb_idx, cqi_value});
+  }
+  return push_feedback({ue_feedback_t::dl_sb_cqi, tti, rnti, enb_cc_idx, cqi_value, sb_idx});
 }
 
 int sched::dl_rach_info(uint32_t enb_cc_idx, dl_sched_rar_info_t rar_info)
 {
   std::lock_guard<std::mutex> lock(sched_mutex);
+  if (trace != nullptr) {
+    trace->event("dl_rach",
+                 {enb_cc_idx,
+                  rar_info.preamble_idx,
+                  rar_info.ta_cmd,
+                  rar_info.temp_crnti,
+                  rar_info.msg3_size,
+                  rar_info.prach_tti});
+  }
   return carrier_schedulers[enb_cc_idx]->dl_rach_info(rar_info);
 }
 
 int sched::ul_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t cqi, uint32_t ul_ch_code)
 {
-  return ue_db_access(rnti, [&](sched_ue& ue) { ue.set_ul_cqi(tti, enb_cc_idx, cqi, ul_ch_code); });
+  if (trace != nullptr) {
+    trace->event("ul_cqi", {tti, rnti, enb_cc_idx, cqi, ul_ch_code});
+  }
+  return push_feedback({ue_feedback_t::ul_cqi, tti, rnti, enb_cc_idx, cqi, ul_ch_code});
+}
+
+int sched::ul_sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi_value)
+{
+  if (trace != nullptr) {
+    trace->event("ul_sb_cqi", {tti, rnti, enb_cc_idx, sb_idx, cqi_value});
+  }
+  return push_feedback({ue_feedback_t::ul_sb_cqi, tti, rnti, enb_cc_idx, cqi_value, sb_idx});
 }
 
 int sched::ul_bsr(uint16_t rnti, uint32_t lcg_id, uint32_t bsr)
 {
+  if (trace != nullptr) {
+    trace->event("ul_bsr", {rnti, lcg_id, bsr});
+  }
   return ue_db_access(rnti, [lcg_id, bsr](sched_ue& ue) { ue.ul_buffer_state(lcg_id, bsr); });
 }
 
 int sched::ul_buffer_add(uint16_t rnti, uint32_t lcid, uint32_t bytes)
 {
+  if (trace != nullptr) {
+    trace->event("ul_buffer_add", {rnti, lcid, bytes});
+  }
   return ue_db_access(rnti, [lcid, bytes](sched_ue& ue) { ue.ul_buffer_add(lcid, bytes); });
 }
 
 int sched::ul_phr(uint16_t rnti, int phr)
 {
+  if (trace != nullptr) {
+    trace->event("ul_phr", {rnti, phr});
+  }
   return ue_db_access(rnti, [phr](sched_ue& ue) { ue.ul_phr(phr); }, __PRETTY_FUNCTION__);
 }
 
 int sched::ul_sr_info(uint32_t tti, uint16_t rnti)
 {
-  return ue_db_access(rnti, [](sched_ue& ue) { ue.set_sr(); }, __PRETTY_FUNCTION__);
+  if (trace != nullptr) {
+    trace->event("ul_sr", {tti, rnti});
+  }
+  return push_feedback({ue_feedback_t::ul_sr, tti, rnti, 0, 0, 0});
 }
 
 void sched::set_dl_tti_mask(uint8_t* tti_mask, uint32_t nof_sfs)
@@ -387,11 +513,15 @@ int sched::dl_sched(uint32_t tti_tx_dl, uint32_t enb_cc_idx, sched_interface::dl
   }
 
   std::lock_guard<std::mutex> lock(sched_mutex);
+  if (trace != nullptr) {
+    trace->event("dl_sched", {tti_tx_dl, enb_cc_idx});
+  }
   if (enb_cc_idx >= carrier_schedulers.size()) {
     return 0;
   }
 
   tti_point tti_rx = tti_point{tti_tx_dl} - FDD_HARQ_DELAY_UL_MS;
+  process_feedback();
   new_tti(tti_rx);
 
   // copy result
@@ -408,12 +538,16 @@ int sched::ul_sched(uint32_t tti, uint32_t enb_cc_idx, srsenb::sched_interface::
   }
 
   std::lock_guard<std::mutex> lock(sched_mutex);
+  if (trace != nullptr) {
+    trace->event("ul_sched", {tti, enb_cc_idx});
+  }
   if (enb_cc_idx >= carrier_schedulers.size()) {
     return 0;
   }
 
   // Compute scheduling Result for tti_rx
   tti_point tti_rx = tti_point{tti} - FDD_HARQ_DELAY_UL_MS - FDD_HARQ_DELAY_DL_MS;
+  process_feedback();
   new_tti(tti_rx);
 
   // copy result
@@ -429,6 +563,11 @@ void sched::new_tti(tti_point tti_rx)
 {
   last_tti = std::max(last_tti, tti_rx);
 
+  if (cc_workers != nullptr) {
+    new_tti_parallel(tti_rx);
+    return;
+  }
+
   // Generate sched results for all CCs, if not yet generated
   for (size_t cc_idx = 0; cc_idx < carrier_schedulers.size(); ++cc_idx) {
     if (not is_generated(tti_rx, cc_idx)) {
@@ -443,6 +582,58 @@ void sched::new_tti(tti_point tti_rx)
   }
 }
 
+/// Generate scheduling decision for tti_rx, allocating the user data of the CCs in parallel
+/// NOTE: The data allocation only reads the UE state shared between CCs. The results, which update the UE buffers and
+///       HARQs, are then generated sequentially in CC order, so that the outcome does not depend on the thread timing.
+///       A CC does not see the allocations of the other CCs for the same TTI, and may grant a UE more resources than
+///       the data left once the previous CCs are served
+void sched::new_tti_parallel(tti_point tti_rx)
+{
+  cc_pending.clear();
+  for (uint32_t cc_idx = 0; cc_idx < carrier_schedulers.size(); ++cc_idx) {
+    if (not is_generated(tti_rx, cc_idx)) {
+      cc_pending.push_back(cc_idx);
+    }
+  }
+  if (cc_pending.empty()) {
+    return;
+  }
+
+  // Setup tti-specific vars of the UE
+  for (auto& user : ue_db) {
+    user.second.new_tti(tti_rx);
+  }
+  for (uint32_t cc_idx : cc_pending) {
+    carrier_schedulers[cc_idx]->alloc_ctrl(tti_rx);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(cc_mutex);
+    nof_cc_running = cc_pending.size() - 1;
+  }
+  for (uint32_t i = 1; i < cc_pending.size(); ++i) {
+    carrier_sched* carrier = carrier_schedulers[cc_pending[i]].get();
+    cc_workers->push_task([this, carrier, tti_rx](uint32_t worker_id) {
+      carrier->alloc_data(tti_rx);
+      std::lock_guard<std::mutex> lock(cc_mutex);
+      if (--nof_cc_running == 0) {
+        cc_cvar.notify_one();
+      }
+    });
+  }
+  carrier_schedulers[cc_pending[0]]->alloc_data(tti_rx);
+  {
+    std::unique_lock<std::mutex> lock(cc_mutex);
+    while (nof_cc_running > 0) {
+      cc_cvar.wait(lock);
+    }
+  }
+
+  for (uint32_t cc_idx : cc_pending) {
+    carrier_schedulers[cc_idx]->finish_tti_result(tti_rx);
+  }
+}
+
 /// Check if TTI result is generated
 bool sched::is_generated(srslte::tti_point tti_rx, uint32_t enb_cc_idx) const
 {
@@ -451,6 +642,63 @@ bool sched::is_generated(srslte::tti_point tti_rx, uint32_t enb_cc_idx) const
          sf_result->get_cc(enb_cc_idx)->is_generated(tti_rx);
 }
 
+/// Queues the feedback of a UE, to be applied by the scheduler before its next decision. The PHY workers that report
+/// the feedback do not wait for the scheduler lock unless the queue is full
+int sched::push_feedback(const ue_feedback_t& fb)
+{
+  if (not feedback_queue.try_push(fb)) {
+    std::lock_guard<std::mutex> lock(sched_mutex);
+    process_feedback();
+    apply_feedback(fb);
+  }
+  return SRSLTE_SUCCESS;
+}
+
+/// Applies the queued feedback in the order it was received. Must be called with the scheduler lock held
+void sched::process_feedback()
+{
+  ue_feedback_t fb;
+  while (feedback_queue.try_pop(fb)) {
+    apply_feedback(fb);
+  }
+}
+
+void sched::apply_feedback(const ue_feedback_t& fb)
+{
+  auto it = ue_db.find(fb.rnti);
+  if (it == ue_db.end()) {
+    Error("User rnti=0x%x not found.\n", fb.rnti);
+    return;
+  }
+  sched_ue& ue = it->second;
+  switch (fb.type) {
+    case ue_feedback_t::dl_cqi:
+      ue.set_dl_cqi(fb.tti, fb.enb_cc_idx, fb.value);
+      break;
+    case ue_feedback_t::dl_sb_cqi:
+      ue.set_dl_sb_cqi(fb.tti, fb.enb_cc_idx, fb.arg, fb.value);
+      break;
+    case ue_feedback_t::dl_ri:
+      ue.set_dl_ri(fb.tti, fb.enb_cc_idx, fb.value);
+      break;
+    case ue_feedback_t::dl_pmi:
+      ue.set_dl_pmi(fb.tti, fb.enb_cc_idx, fb.value);
+      break;
+    case ue_feedback_t::ul_cqi:
+      ue.set_ul_cqi(fb.tti, fb.enb_cc_idx, fb.value, fb.arg);
+      break;
+    case ue_feedback_t::ul_sb_cqi:
+      ue.set_ul_sb_cqi(fb.tti, fb.enb_cc_idx, fb.arg, fb.value);
+      break;
+    case ue_feedback_t::ul_crc:
+      ue.set_ul_crc(tti_point{fb.tti}, fb.enb_cc_idx, fb.value > 0);
+      break;
+    case ue_feedback_t::ul_sr:
+      ue.set_sr();
+      break;
+  }
+}
+
 // Common way to access ue_db elements in a read locking way
 template <typename Func>
 int sched::ue_db_access(uint16_t rnti, Func f, const char* func_name)
@@ -496,23 +744,12 @@ prb_interval prb_interval::rbgs_to_prbs(const rbg_interval& rbgs, uint32_t P)
 
 rbg_interval rbg_interval::rbgmask_to_rbgs(const rbgmask_t& mask)
 {
-  int rb_start = -1;
-  for (uint32_t i = 0; i < mask.size(); i++) {
-    if (rb_start == -1) {
-      if (mask.test(i)) {
-        rb_start = i;
-      }
-    } else {
-      if (!mask.test(i)) {
-        return rbg_interval(rb_start, i);
-      }
-    }
-  }
-  if (rb_start != -1) {
-    return rbg_interval(rb_start, mask.size());
-  } else {
+  int rb_start = mask.find_lowest(0, mask.size());
+  if (rb_start == -1) {
     return rbg_interval();
   }
+  int rb_stop = mask.find_lowest(rb_start, mask.size(), false);
+  return rbg_interval(rb_start, rb_stop == -1 ? mask.size() : rb_stop);
 }
 
 prb_interval prb_interval::riv_to_prbs(uint32_t riv, uint32_t nof_prbs, int nof_vrbs)
@@ -525,6 +762,69 @@ prb_interval prb_interval::riv_to_prbs(uint32_t riv, uint32_t nof_prbs, int nof_
   return {rb_start, rb_start + l_crb};
 }
 
+void sched_mcs_table::init(const srslte_cell_t& cell, uint32_t max_mcs, bool use_tbs_index_alt_, bool is_ul_)
+{
+  cell_nof_prb      = cell.nof_prb;
+  use_tbs_index_alt = use_tbs_index_alt_;
+  is_ul             = is_ul_;
+  // MCS 28 of the 256QAM table is reserved for retransmissions
+  nof_mcs  = (use_tbs_index_alt and not is_ul) ? 28 : 29;
+  max_mcs_ = std::min(max_mcs, nof_mcs - 1);
+
+  tbs.resize(cell_nof_prb * nof_mcs);
+  for (uint32_t n = 1; n <= cell_nof_prb; ++n) {
+    for (uint32_t mcs = 0; mcs < nof_mcs; ++mcs) {
+      int tbs_idx                  = srslte_ra_tbs_idx_from_mcs(mcs, use_tbs_index_alt, is_ul);
+      tbs[(n - 1) * nof_mcs + mcs] = (uint16_t)(srslte_ra_tbs_from_idx((uint32_t)tbs_idx, n) / 8);
+    }
+  }
+
+  // The number of RE matches the estimations of the PRBs required by a UE
+  uint32_t nof_rows = is_ul ? 1 : max_nof_ctrl_symbols;
+  cqi_mcs.resize(nof_rows * nof_cqis * cell_nof_prb);
+  for (uint32_t row = 0; row < nof_rows; ++row) {
+    for (uint32_t cqi = 0; cqi < nof_cqis; ++cqi) {
+      for (uint32_t n = 1; n <= cell_nof_prb; ++n) {
+        uint32_t nof_re = is_ul ? 2 * (SRSLTE_CP_NSYMB(cell.cp) - 1) * n * SRSLTE_NRE
+                                : srslte_ra_dl_approx_nof_re(&cell, n, row + 1);
+        cqi_mcs[(row * nof_cqis + cqi) * cell_nof_prb + n - 1] = (uint8_t)search_mcs(cqi, n, nof_re, default_max_Qm());
+      }
+    }
+  }
+}
+
+uint32_t sched_mcs_table::default_max_Qm() const
+{
+  return is_ul ? 4 : (use_tbs_index_alt ? 8 : 6);
+}
+
+int sched_mcs_table::min_mcs(uint32_t nof_bytes, uint32_t nof_prb) const
+{
+  // Linear search, as the TBS of a single PRB is not monotonic with the MCS (TS 36.213 Table 7.1.7.2.1-1, I_TBS=6)
+  auto row = tbs.begin() + (nof_prb - 1) * nof_mcs;
+  auto it  = std::find_if(row, row + nof_mcs, [nof_bytes](uint16_t t) { return t >= nof_bytes; });
+  return it != row + nof_mcs ? (int)(it - row) : -1;
+}
+
+uint32_t sched_mcs_table::search_mcs(uint32_t cqi, uint32_t nof_prb, uint32_t nof_re, uint32_t max_Qm) const
+{
+  // Take the upper bound code-rate
+  float    max_coderate = srslte_cqi_to_coderate(std::min(cqi + 1u, 15u), use_tbs_index_alt);
+  uint32_t sel_mcs      = max_mcs_ + 1;
+  float    coderate     = 99;
+  uint32_t Qm           = 0;
+
+  do {
+    sel_mcs--;
+    coderate = srslte_coderate(8 * tbs_bytes(sel_mcs, nof_prb), nof_re);
+    srslte_mod_t mod =
+        (is_ul) ? srslte_ra_ul_mod_from_mcs(sel_mcs) : srslte_ra_dl_mod_from_mcs(sel_mcs, use_tbs_index_alt);
+    Qm = SRSLTE_MIN(max_Qm, srslte_mod_bits_x_symbol(mod));
+  } while (sel_mcs > 0 && coderate > SRSLTE_MIN(max_coderate, 0.930 * Qm));
+
+  return sel_mcs;
+}
+
 namespace sched_utils {
 
 void generate_cce_location(srslte_regs_t*   regs_,
@@ -551,6 +851,95 @@ void generate_cce_location(srslte_regs_t*   regs_,
   }
 }
 
+bool find_ul_alloc(const prbmask_t& used_prbs, uint32_t L, prb_interval* alloc)
+{
+  // Best fit among the runs of empty PRBs, the allocation is placed at the start of the run to keep the grid compact
+  prb_interval best{};
+  bool         fits = false;
+  for (int start = used_prbs.find_lowest(0, used_prbs.size(), false); start >= 0;) {
+    int          stop = used_prbs.find_lowest(start, used_prbs.size());
+    prb_interval run{(uint32_t)start, stop >= 0 ? (uint32_t)stop : (uint32_t)used_prbs.size()};
+    start = stop >= 0 ? used_prbs.find_lowest(stop, used_prbs.size(), false) : -1;
+    if (run.length() >= L) {
+      if (not fits or run.length() < best.length()) {
+        best = run;
+        fits = true;
+      }
+    } else if (not fits and run.length() > best.length()) {
+      best = run;
+    }
+  }
+  *alloc = {best.start(), best.start() + std::min(best.length(), L)};
+  if (alloc->length() == 0) {
+    return false;
+  }
+
+  // Make sure L is allowed by SC-FDMA modulation
+  while (!srslte_dft_precoding_valid_prb(alloc->length())) {
+    alloc->resize_by(-1);
+  }
+  return alloc->length() == L;
+}
+
+bool find_ul_alloc(const prbmask_t&                 used_prbs,
+                   const std::array<prbmask_t, 4>& sb_prbs,
+                   uint32_t                         L,
+                   prb_interval*                    alloc)
+{
+  // All the PRBs are in the same group until the UE is sounded
+  const prbmask_t& neutral = sb_prbs[2];
+  if (L == 0 or neutral.size() != used_prbs.size() or neutral.count() == neutral.size()) {
+    return find_ul_alloc(used_prbs, L, alloc);
+  }
+
+  // The PRBs of the best group weigh the most
+  // Window of L empty PRBs with the highest weight, the lowest one for equal weights
+  prb_interval best{};
+  uint32_t     best_weight = 0;
+  bool         found       = false;
+  for (int start = used_prbs.find_lowest_zeros(L); start >= 0; start = used_prbs.find_lowest_zeros(L, start + 1)) {
+    uint32_t w = 0;
+    for (uint32_t g = 0; g < sb_prbs.size(); ++g) {
+      if (sb_prbs[g].size() == used_prbs.size()) {
+        w += (sb_prbs.size() - 1 - g) * sb_prbs[g].count(start, start + L);
+      }
+    }
+    if (not found or w > best_weight) {
+      best        = {(uint32_t)start, start + L};
+      best_weight = w;
+      found       = true;
+    }
+  }
+  if (not found) {
+    return find_ul_alloc(used_prbs, L, alloc);
+  }
+  *alloc = best;
+
+  // Make sure L is allowed by SC-FDMA modulation
+  while (!srslte_dft_precoding_valid_prb(alloc->length())) {
+    alloc->resize_by(-1);
+  }
+  return alloc->length() == L;
+}
+
+sched_format1a_t get_format1a_tbs(uint32_t tbs_bytes)
+{
+  sched_format1a_t ret;
+  int              tbs = tbs_bytes * 8;
+  for (int i = 0; i < 27; i++) {
+    for (uint32_t n_prb1a = 2; n_prb1a <= 3; ++n_prb1a) {
+      int tbs_i = srslte_ra_tbs_from_idx(i, n_prb1a);
+      if (tbs_i >= tbs) {
+        ret.mcs     = i;
+        ret.tbs     = tbs_i;
+        ret.n_prb1a = n_prb1a;
+        return ret;
+      }
+    }
+  }
+  return ret;
+}
+
 } // namespace sched_utils
 
 } // namespace srsenb
@@ -137,7 +137,7 @@ void bc_sched::reset()
  *                 RAR scheduling
  *******************************************************/
 
-ra_sched::ra_sched(const sched_cell_params_t& cfg_, std::map<uint16_t, sched_ue>& ue_db_) :
+ra_sched::ra_sched(const sched_cell_params_t& cfg_, sched_ue_list& ue_db_) :
   cc_cfg(&cfg_),
   log_h(srslte::logmap::get("MAC")),
   ue_db(&ue_db_)
@@ -263,10 +263,10 @@ void ra_sched::reset()
  *                 Carrier scheduling
  *******************************************************/
 
-sched::carrier_sched::carrier_sched(rrc_interface_mac*            rrc_,
-                                    std::map<uint16_t, sched_ue>* ue_db_,
-                                    uint32_t                      enb_cc_idx_,
-                                    sched_result_list*            sched_results_) :
+sched::carrier_sched::carrier_sched(rrc_interface_mac* rrc_,
+                                    sched_ue_list*     ue_db_,
+                                    uint32_t           enb_cc_idx_,
+                                    sched_result_list* sched_results_) :
   rrc(rrc_),
   ue_db(ue_db_),
   log_h(srslte::logmap::get("MAC ")),
@@ -294,9 +294,22 @@ void sched::carrier_sched::carrier_cfg(const sched_cell_params_t& cell_params_)
   ra_sched_ptr.reset(new ra_sched{*cc_cfg, *ue_db});
 
   // Setup data scheduling algorithms
-  dl_metric.reset(new srsenb::dl_metric_rr{});
+  const std::string& policy = cc_cfg->sched_cfg->policy;
+  if (policy == "pf" or policy == "max_ci") {
+    std::unique_ptr<dl_metric_pf> dl_pf(new dl_metric_pf{policy == "pf"});
+    std::unique_ptr<ul_metric_pf> ul_pf(new ul_metric_pf{policy == "pf"});
+    dl_pf->set_window(cc_cfg->sched_cfg->pf_window);
+    ul_pf->set_window(cc_cfg->sched_cfg->pf_window);
+    dl_metric = std::move(dl_pf);
+    ul_metric = std::move(ul_pf);
+  } else {
+    if (policy != "time_rr") {
+      log_h->warning("SCHED: Unknown scheduler policy %s, using time_rr\n", policy.c_str());
+    }
+    dl_metric.reset(new srsenb::dl_metric_rr{});
+    ul_metric.reset(new srsenb::ul_metric_rr{});
+  }
   dl_metric->set_params(*cc_cfg);
-  ul_metric.reset(new srsenb::ul_metric_rr{});
   ul_metric->set_params(*cc_cfg);
 
   // Initiate the tti_scheduler for each TTI
@@ -311,6 +324,13 @@ void sched::carrier_sched::set_dl_tti_mask(uint8_t* tti_mask, uint32_t nof_sfs)
 }
 
 const cc_sched_result& sched::carrier_sched::generate_tti_result(tti_point tti_rx)
+{
+  alloc_ctrl(tti_rx);
+  alloc_data(tti_rx);
+  return finish_tti_result(tti_rx);
+}
+
+void sched::carrier_sched::alloc_ctrl(tti_point tti_rx)
 {
   sf_sched*        tti_sched = get_sf_sched(tti_rx);
   sf_sched_result* sf_result = prev_sched_results->get_sf(tti_rx);
@@ -335,6 +355,11 @@ const cc_sched_result& sched::carrier_sched::generate_tti_result(tti_point tti_r
     sf_sched* sf_msg3_sched = get_sf_sched(tti_rx + MSG3_DELAY_MS);
     ra_sched_ptr->ul_sched(tti_sched, sf_msg3_sched);
   }
+}
+
+void sched::carrier_sched::alloc_data(tti_point tti_rx)
+{
+  sf_sched* tti_sched = get_sf_sched(tti_rx);
 
   /* Prioritize PDCCH scheduling for DL and UL data in a RoundRobin fashion */
   if ((tti_rx.to_uint() % 2) == 0) {
@@ -347,6 +372,12 @@ const cc_sched_result& sched::carrier_sched::generate_tti_result(tti_point tti_r
   if ((tti_rx.to_uint() % 2) == 1) {
     alloc_ul_users(tti_sched);
   }
+}
+
+const cc_sched_result& sched::carrier_sched::finish_tti_result(tti_point tti_rx)
+{
+  sf_sched*        tti_sched = get_sf_sched(tti_rx);
+  cc_sched_result* cc_result = prev_sched_results->get_cc(tti_rx, enb_cc_idx);
 
   /* Select the winner DCI allocation combination, store all the scheduling results */
   tti_sched->generate_sched_results(*ue_db);
@@ -23,6 +23,8 @@
 #include "srsenb/hdr/stack/mac/scheduler.h"
 #include "srslte/common/log_helper.h"
 #include "srslte/common/logmap.h"
+#include <algorithm>
+#include <inttypes.h>
 #include <srslte/interfaces/sched_interface.h>
 
 using srslte::tti_point;
@@ -218,6 +220,7 @@ bool pdcch_grid_t::alloc_dci_record(const alloc_record_t& record, uint32_t cfix)
   }
 
   if (ret) {
+    prune_tree_leaves(tree, tree.prev_end);
     tree.prev_start = tree.prev_end;
     tree.prev_end   = tree.dci_alloc_tree.size();
   }
@@ -225,6 +228,52 @@ bool pdcch_grid_t::alloc_dci_record(const alloc_record_t& record, uint32_t cfix)
   return ret;
 }
 
+/**
+ * Bounds the growth of the alloc tree. If the last DCI allocation generated more than max_pdcch_leaves combinations,
+ * only the ones that leave the most aligned CCE groups free for the following DCIs are kept. The search becomes a
+ * beam search, so an allocation may fail even though a valid combination exists.
+ */
+void pdcch_grid_t::prune_tree_leaves(alloc_tree_t& tree, size_t leaf_start)
+{
+  uint32_t max_leaves = cc_cfg->sched_cfg->max_pdcch_leaves;
+  size_t   nof_leaves = tree.dci_alloc_tree.size() - leaf_start;
+  if (max_leaves == 0 or nof_leaves <= max_leaves) {
+    return;
+  }
+
+  // rank the new leaves by the number of free CCE groups of aggregation levels 2, 4 and 8
+  leaf_rank.resize(nof_leaves);
+  for (size_t i = 0; i < nof_leaves; ++i) {
+    const pdcch_mask_t& mask        = tree.dci_alloc_tree[leaf_start + i].node.total_mask;
+    uint32_t            free_groups = 0;
+    for (uint32_t L = 2; L <= 8; L *= 2) {
+      for (uint32_t ncce = 0; ncce + L <= tree.nof_cces; ncce += L) {
+        free_groups += mask.any(ncce, ncce + L) ? 0 : 1;
+      }
+    }
+    leaf_rank[i] = {free_groups, leaf_start + i};
+  }
+  using rank_t     = std::pair<uint32_t, size_t>;
+  auto better      = [](const rank_t& a, const rank_t& b) {
+    return a.first > b.first or (a.first == b.first and a.second < b.second);
+  };
+  auto lower_index = [](const rank_t& a, const rank_t& b) { return a.second < b.second; };
+  std::partial_sort(leaf_rank.begin(), leaf_rank.begin() + max_leaves, leaf_rank.end(), better);
+
+  // Compact the kept leaves in their original order. Their parents are below leaf_start, so they are not affected
+  std::sort(leaf_rank.begin(), leaf_rank.begin() + max_leaves, lower_index);
+  for (size_t i = 0; i < max_leaves; ++i) {
+    tree.dci_alloc_tree[leaf_start + i] = tree.dci_alloc_tree[leaf_rank[i].second];
+  }
+  tree.dci_alloc_tree.erase(tree.dci_alloc_tree.begin() + leaf_start + max_leaves, tree.dci_alloc_tree.end());
+
+  pruned_counter++;
+  log_h->debug("SCHED: Pruned PDCCH allocation combinations from %zu to %u (total=%" PRIu64 ")\n",
+               nof_leaves,
+               max_leaves,
+               pruned_counter);
+}
+
 //! Algorithm to compute a valid PDCCH allocation
 bool pdcch_grid_t::add_tree_node_leaves(alloc_tree_t&          tree,
                                         int                    parent_node_idx,
@@ -526,39 +575,9 @@ bool sf_grid_t::reserve_ul_prbs(const prbmask_t& prbmask, bool strict)
   return ret;
 }
 
-/**
- * Finds a range of L contiguous PRBs that are empty
- * @param L Size of the requested UL allocation in PRBs
- * @param alloc Found allocation. It is guaranteed that 0 <= alloc->L <= L
- * @return true if the requested allocation of size L was strictly met
- */
 bool sf_grid_t::find_ul_alloc(uint32_t L, prb_interval* alloc) const
 {
-  *alloc = {};
-  for (uint32_t n = 0; n < ul_mask.size() && alloc->length() < L; n++) {
-    if (not ul_mask.test(n) && alloc->length() == 0) {
-      alloc->displace_to(n);
-    }
-    if (not ul_mask.test(n)) {
-      alloc->resize_by(1);
-    } else if (alloc->length() > 0) {
-      // avoid edges
-      if (n < 3) {
-        *alloc = {};
-      } else {
-        break;
-      }
-    }
-  }
-  if (alloc->length() == 0) {
-    return false;
-  }
-
-  // Make sure L is allowed by SC-FDMA modulation
-  while (!srslte_dft_precoding_valid_prb(alloc->length())) {
-    alloc->resize_by(-1);
-  }
-  return alloc->length() == L;
+  return sched_utils::find_ul_alloc(ul_mask, L, alloc);
 }
 
 /*******************************************************
@@ -898,9 +917,12 @@ void sf_sched::set_bc_sched_result(const pdcch_grid_t::alloc_result_t& dci_resul
     // assign NCCE/L
     bc->dci.location = dci_result[bc_alloc.dci_idx]->dci_pos;
 
-    /* Generate DCI format1A */
-    prb_interval prb_range = prb_interval::rbgs_to_prbs(bc_alloc.rbg_range, cc_cfg->P);
-    int          tbs       = generate_format1a(prb_range, bc_alloc.req_bytes, bc_alloc.rv, bc_alloc.rnti, &bc->dci);
+    /* Generate DCI format1A. The MCS and TBS of the SIBs are precomputed with the cell configuration */
+    prb_interval     prb_range = prb_interval::rbgs_to_prbs(bc_alloc.rbg_range, cc_cfg->P);
+    sched_format1a_t format1a  = bc_alloc.alloc_type == alloc_type_t::DL_BC
+                                    ? cc_cfg->sib_format1a[bc_alloc.sib_idx]
+                                    : sched_utils::get_format1a_tbs(bc_alloc.req_bytes);
+    int tbs = generate_format1a(prb_range, format1a, bc_alloc.rv, bc_alloc.rnti, &bc->dci);
 
     // Setup BC/Paging processes
     if (bc_alloc.alloc_type == alloc_type_t::DL_BC) {
@@ -967,7 +989,11 @@ void sf_sched::set_rar_sched_result(const pdcch_grid_t::alloc_result_t& dci_resu
 
     /* Generate DCI format1A */
     prb_interval prb_range = prb_interval::rbgs_to_prbs(rar_alloc.alloc_data.rbg_range, cc_cfg->P);
-    int tbs = generate_format1a(prb_range, rar_alloc.alloc_data.req_bytes, 0, rar_alloc.alloc_data.rnti, &rar->dci);
+    int tbs = generate_format1a(prb_range,
+                                sched_utils::get_format1a_tbs(rar_alloc.alloc_data.req_bytes),
+                                0,
+                                rar_alloc.alloc_data.rnti,
+                                &rar->dci);
     if (tbs <= 0) {
       log_h->warning("SCHED: Error RAR, ra_rnti_idx=%d, rbgs=%s, dci=(%d,%d)\n",
                      rar_alloc.alloc_data.rnti,
@@ -1253,53 +1279,36 @@ uint32_t sf_sched::get_nof_ctrl_symbols() const
   return tti_alloc.get_cfi() + ((cc_cfg->cfg.cell.nof_prb <= 10) ? 1 : 0);
 }
 
-int sf_sched::generate_format1a(prb_interval     prb_range,
-                                uint32_t         tbs_bytes,
-                                uint32_t         rv,
-                                uint16_t         rnti,
-                                srslte_dci_dl_t* dci)
+int sf_sched::generate_format1a(prb_interval            prb_range,
+                                const sched_format1a_t& format1a,
+                                uint32_t                rv,
+                                uint16_t                rnti,
+                                srslte_dci_dl_t*        dci)
 {
-  /* Calculate I_tbs for this TBS */
-  int tbs = tbs_bytes * 8;
-  int i;
-  int mcs = -1;
-  for (i = 0; i < 27; i++) {
-    if (srslte_ra_tbs_from_idx(i, 2) >= tbs) {
-      dci->type2_alloc.n_prb1a = srslte_ra_type2_t::SRSLTE_RA_TYPE2_NPRB1A_2;
-      mcs                      = i;
-      tbs                      = srslte_ra_tbs_from_idx(i, 2);
-      break;
-    }
-    if (srslte_ra_tbs_from_idx(i, 3) >= tbs) {
-      dci->type2_alloc.n_prb1a = srslte_ra_type2_t::SRSLTE_RA_TYPE2_NPRB1A_3;
-      mcs                      = i;
-      tbs                      = srslte_ra_tbs_from_idx(i, 3);
-      break;
-    }
-  }
-  if (i == 28) {
-    Error("Can't allocate Format 1A for TBS=%d\n", tbs);
+  if (format1a.mcs < 0) {
+    Error("Can't allocate Format 1A for rnti=0x%x\n", rnti);
     return -1;
   }
 
-  Debug("ra_tbs=%d/%d, tbs_bytes=%d, tbs=%d, mcs=%d\n",
-        srslte_ra_tbs_from_idx(mcs, 2),
-        srslte_ra_tbs_from_idx(mcs, 3),
-        tbs_bytes,
-        tbs,
-        mcs);
+  Debug("ra_tbs=%d/%d, tbs=%d, mcs=%d\n",
+        srslte_ra_tbs_from_idx(format1a.mcs, 2),
+        srslte_ra_tbs_from_idx(format1a.mcs, 3),
+        format1a.tbs,
+        format1a.mcs);
 
+  dci->type2_alloc.n_prb1a =
+      format1a.n_prb1a == 2 ? srslte_ra_type2_t::SRSLTE_RA_TYPE2_NPRB1A_2 : srslte_ra_type2_t::SRSLTE_RA_TYPE2_NPRB1A_3;
   dci->alloc_type       = SRSLTE_RA_ALLOC_TYPE2;
   dci->type2_alloc.mode = srslte_ra_type2_t::SRSLTE_RA_TYPE2_LOC;
   dci->type2_alloc.riv  = srslte_ra_type2_to_riv(prb_range.length(), prb_range.start(), cc_cfg->cfg.cell.nof_prb);
   dci->pid              = 0;
-  dci->tb[0].mcs_idx    = mcs;
+  dci->tb[0].mcs_idx    = format1a.mcs;
   dci->tb[0].rv         = rv;
   dci->format           = SRSLTE_DCI_FORMAT1A;
   dci->rnti             = rnti;
   dci->ue_cc_idx        = std::numeric_limits<uint32_t>::max();
 
-  return tbs;
+  return format1a.tbs;
 }
 
 } // namespace srsenb
@@ -37,10 +37,11 @@ namespace srsenb {
  *
  ******************************************************/
 
-void harq_proc::init(uint32_t id_)
+void harq_proc::init(uint32_t id_, harq_masks_t* masks_)
 {
   log_h = srslte::logmap::get("MAC ");
   id    = id_;
+  masks = masks_;
 }
 
 void harq_proc::set_cfg(uint32_t max_retx_)
@@ -57,6 +58,7 @@ void harq_proc::reset(uint32_t tb_idx)
   last_mcs[tb_idx]  = -1;
   last_tbs[tb_idx]  = -1;
   tx_cnt[tb_idx]    = 0;
+  update_masks();
 }
 
 uint32_t harq_proc::get_id() const
@@ -107,6 +109,7 @@ int harq_proc::set_ack_common(uint32_t tb_idx, bool ack_)
   } else if (ack_) {
     active[tb_idx] = false;
   }
+  update_masks();
   return SRSLTE_SUCCESS;
 }
 
@@ -120,6 +123,7 @@ void harq_proc::new_tx_common(uint32_t tb_idx, tti_point tti_, int mcs, int tbs)
   last_tbs[tb_idx] = tbs;
 
   active[tb_idx] = true;
+  update_masks();
 }
 
 void harq_proc::new_retx_common(uint32_t tb_idx, tti_point tti_, int* mcs, int* tbs)
@@ -127,6 +131,7 @@ void harq_proc::new_retx_common(uint32_t tb_idx, tti_point tti_, int* mcs, int*
   ack_state[tb_idx] = NACK;
   tti               = tti_;
   n_rtx[tb_idx]++;
+  update_masks();
   if (mcs) {
     *mcs = last_mcs[tb_idx];
   }
@@ -142,6 +147,15 @@ void harq_proc::reset_pending_data_common()
     for (bool& tb : active) {
       tb = false;
     }
+    update_masks();
+  }
+}
+
+void harq_proc::update_masks()
+{
+  if (masks != nullptr) {
+    masks->active.set(id, not is_empty());
+    masks->retx.set(id, has_pending_retx_common(0) or has_pending_retx_common(1));
   }
 }
 
@@ -299,12 +313,15 @@ uint32_t ul_harq_proc::get_pending_data() const
  *******************/
 
 harq_entity::harq_entity(size_t nof_dl_harqs, size_t nof_ul_harqs) :
+  dl_masks(new harq_masks_t{}),
   dl_harqs(nof_dl_harqs),
   ul_harqs(nof_ul_harqs),
   log_h(srslte::logmap::get("MAC "))
 {
+  dl_masks->active.resize(nof_dl_harqs);
+  dl_masks->retx.resize(nof_dl_harqs);
   for (uint32_t i = 0; i < dl_harqs.size(); ++i) {
-    dl_harqs[i].init(i);
+    dl_harqs[i].init(i, dl_masks.get());
   }
   for (uint32_t i = 0; i < ul_harqs.size(); ++i) {
     ul_harqs[i].init(i);
@@ -342,8 +359,8 @@ dl_harq_proc* harq_entity::get_empty_dl_harq(uint32_t tti_tx_dl)
     return h->is_empty() ? h : nullptr;
   }
 
-  auto it = std::find_if(dl_harqs.begin(), dl_harqs.end(), [](dl_harq_proc& h) { return h.is_empty(); });
-  return it != dl_harqs.end() ? &(*it) : nullptr;
+  int pid = dl_masks->active.find_lowest(0, nof_dl_harqs(), false);
+  return pid >= 0 ? &dl_harqs[pid] : nullptr;
 }
 
 dl_harq_proc* harq_entity::get_pending_dl_harq(uint32_t tti_tx_dl)
@@ -388,13 +405,10 @@ void harq_entity::reset_pending_data(srslte::tti_point tti_rx)
   // Reset ACK state of UL Harq
   get_ul_harq(tti_tx_ul.to_uint())->reset_pending_data();
 
-  // Reset any DL harq which has 0 retxs
-  for (auto& h : dl_harqs) {
+  // Reset any DL harq which has 0 retxs and delete old DL harq procs. Only the active ones have anything to reset
+  dl_masks->active.for_each([this, tti_tx_dl](size_t pid) {
+    dl_harq_proc& h = dl_harqs[pid];
     h.reset_pending_data();
-  }
-
-  // delete old DL harq procs
-  for (auto& h : dl_harqs) {
     if (not h.is_empty()) {
       if (tti_tx_dl > h.get_tti() + 100) {
         srslte::logmap::get("MAC")->info("SCHED: pid=%d is old. tti_pid=%d, now is %d, resetting\n",
@@ -406,7 +420,7 @@ void harq_entity::reset_pending_data(srslte::tti_point tti_rx)
         }
       }
     }
-  }
+  });
 }
 
 /**
@@ -419,7 +433,9 @@ dl_harq_proc* harq_entity::get_oldest_dl_harq(uint32_t tti_tx_dl)
   tti_point t_tx_dl{tti_tx_dl};
   int       oldest_idx = -1;
   uint32_t  oldest_tti = 0;
-  for (const dl_harq_proc& h : dl_harqs) {
+  // Only the processes in the retx mask can have a pending retx
+  dl_masks->retx.for_each([&](size_t pid) {
+    const dl_harq_proc& h = dl_harqs[pid];
     if (h.has_pending_retx(0, tti_tx_dl) or h.has_pending_retx(1, tti_tx_dl)) {
       uint32_t x = t_tx_dl - h.get_tti();
       if (x > oldest_tti) {
@@ -427,7 +443,7 @@ dl_harq_proc* harq_entity::get_oldest_dl_harq(uint32_t tti_tx_dl)
         oldest_tti = x;
       }
     }
-  }
+  });
   return (oldest_idx >= 0) ? &dl_harqs[oldest_idx] : nullptr;
 }
 
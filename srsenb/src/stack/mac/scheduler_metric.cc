@@ -23,10 +23,13 @@
 #include "srsenb/hdr/stack/mac/scheduler_harq.h"
 #include "srslte/common/log_helper.h"
 #include "srslte/common/logmap.h"
+#include <algorithm>
 #include <string.h>
 
 namespace srsenb {
 
+using srslte::tti_point;
+
 /*****************************************************************
  *
  * Downlink Metric
@@ -39,7 +42,7 @@ void dl_metric_rr::set_params(const sched_cell_params_t& cell_params_)
   log_h  = srslte::logmap::get("MAC ");
 }
 
-void dl_metric_rr::sched_users(std::map<uint16_t, sched_ue>& ue_db, dl_sf_sched_itf* tti_sched)
+void dl_metric_rr::sched_users(sched_ue_list& ue_db, dl_sf_sched_itf* tti_sched)
 {
   tti_alloc = tti_sched;
 
@@ -60,24 +63,46 @@ void dl_metric_rr::sched_users(std::map<uint16_t, sched_ue>& ue_db, dl_sf_sched_
   }
 }
 
-bool dl_metric_rr::find_allocation(uint32_t min_nof_rbg, uint32_t max_nof_rbg, rbgmask_t* rbgmask)
+/**
+ * Finds the free RBGs for a user, taking first the RBGs of its subbands with the best CQI and, for the same CQI, the
+ * lowest RBGs first. Without recent subband CQIs, the lowest free RBGs are taken
+ * @param min_nof_rbg minimum number of RBGs of the allocation
+ * @param max_nof_rbg maximum number of RBGs of the allocation
+ * @param carrier carrier of the user, with its RBGs grouped by subband CQI
+ * @param rbgmask Found allocation
+ * @return true if at least min_nof_rbg RBGs were found
+ */
+bool dl_metric_rr::find_allocation(uint32_t           min_nof_rbg,
+                                   uint32_t           max_nof_rbg,
+                                   const cc_sched_ue& carrier,
+                                   rbgmask_t*         rbgmask)
 {
   if (tti_alloc->get_dl_mask().all()) {
     return false;
   }
   // 1's for free rbgs
-  rbgmask_t localmask = ~(tti_alloc->get_dl_mask());
+  rbgmask_t freemask = ~(tti_alloc->get_dl_mask());
+  if (freemask.count() < min_nof_rbg) {
+    return false;
+  }
 
-  uint32_t i = 0, nof_alloc = 0;
-  for (; i < localmask.size() and nof_alloc < max_nof_rbg; ++i) {
-    if (localmask.test(i)) {
+  rbgmask_t localmask(freemask.size());
+  uint32_t  nof_alloc   = 0;
+  auto      take_lowest = [&localmask, &nof_alloc, max_nof_rbg](const rbgmask_t& candidates) {
+    for (int i = candidates.find_lowest(0, candidates.size()); i >= 0 and nof_alloc < max_nof_rbg;
+         i     = candidates.find_lowest(i + 1, candidates.size())) {
+      localmask.set(i);
       nof_alloc++;
     }
+  };
+  if (carrier.is_dl_sb_cqi_valid(tti_alloc->get_tti_tx_dl())) {
+    for (const rbgmask_t& sb_rbgs : carrier.dl_sb_rbgs) {
+      take_lowest(freemask & sb_rbgs);
+    }
+  } else {
+    // The subband CQIs are too old, all the RBGs are taken as having the wideband CQI
+    take_lowest(freemask);
   }
-  if (nof_alloc < min_nof_rbg) {
-    return false;
-  }
-  localmask.fill(i, localmask.size(), false);
   *rbgmask = localmask;
   return true;
 }
@@ -93,12 +118,18 @@ dl_harq_proc* dl_metric_rr::allocate_user(sched_ue* user)
   if (not p.first) {
     return nullptr;
   }
-  uint32_t cell_idx = p.second;
+  uint32_t           cell_idx = p.second;
+  const cc_sched_ue* carrier  = user->find_ue_carrier(cc_cfg->enb_cc_idx);
 
   alloc_outcome_t code;
   uint32_t        tti_dl = tti_alloc->get_tti_tx_dl();
   dl_harq_proc*   h      = user->get_pending_dl_harq(tti_dl, cell_idx);
 
+  // Do not allocate a user that is not monitoring the PDCCH due to DRX
+  if (not user->pdcch_active(tti_point{tti_dl})) {
+    return nullptr;
+  }
+
   // Schedule retx if we have space
   if (h != nullptr) {
     // Try to reuse the same mask
@@ -115,7 +146,7 @@ dl_harq_proc* dl_metric_rr::allocate_user(sched_ue* user)
 
     // If previous mask does not fit, find another with exact same number of rbgs
     size_t nof_rbg = retx_mask.count();
-    if (find_allocation(nof_rbg, nof_rbg, &retx_mask)) {
+    if (find_allocation(nof_rbg, nof_rbg, *carrier, &retx_mask)) {
       code = tti_alloc->alloc_dl_user(user, retx_mask, h->get_id());
       if (code == alloc_outcome_t::SUCCESS) {
         return h;
@@ -134,7 +165,7 @@ dl_harq_proc* dl_metric_rr::allocate_user(sched_ue* user)
     rbg_interval req_rbgs = user->get_required_dl_rbgs(cell_idx);
     if (req_rbgs.stop() > 0) {
       rbgmask_t newtx_mask(tti_alloc->get_dl_mask().size());
-      if (find_allocation(req_rbgs.start(), req_rbgs.stop(), &newtx_mask)) {
+      if (find_allocation(req_rbgs.start(), req_rbgs.stop(), *carrier, &newtx_mask)) {
         // some empty spaces were found
         code = tti_alloc->alloc_dl_user(user, newtx_mask, h->get_id());
         if (code == alloc_outcome_t::SUCCESS) {
@@ -161,7 +192,7 @@ void ul_metric_rr::set_params(const sched_cell_params_t& cell_params_)
   log_h  = srslte::logmap::get("MAC ");
 }
 
-void ul_metric_rr::sched_users(std::map<uint16_t, sched_ue>& ue_db, ul_sf_sched_itf* tti_sched)
+void ul_metric_rr::sched_users(sched_ue_list& ue_db, ul_sf_sched_itf* tti_sched)
 {
   tti_alloc   = tti_sched;
   current_tti = tti_alloc->get_tti_tx_ul();
@@ -186,7 +217,8 @@ void ul_metric_rr::sched_users(std::map<uint16_t, sched_ue>& ue_db, ul_sf_sched_
   }
 
   // give priority in a time-domain RR basis
-  iter = ue_db.begin();
+  nof_newtx_users = count_newtx_users(ue_db);
+  iter            = ue_db.begin();
   std::advance(iter, priority_idx);
   for (uint32_t ue_count = 0; ue_count < ue_db.size(); ++iter, ++ue_count) {
     if (iter == ue_db.end()) {
@@ -197,40 +229,27 @@ void ul_metric_rr::sched_users(std::map<uint16_t, sched_ue>& ue_db, ul_sf_sched_
   }
 }
 
-/**
- * Finds a range of L contiguous PRBs that are empty
- * @param L Size of the requested UL allocation in PRBs
- * @param alloc Found allocation. It is guaranteed that 0 <= alloc->L <= L
- * @return true if the requested allocation of size L was strictly met
- */
-bool ul_metric_rr::find_allocation(uint32_t L, prb_interval* alloc)
+bool ul_metric_rr::find_allocation(uint32_t L, const cc_sched_ue& carrier, prb_interval* alloc)
+{
+  return sched_utils::find_ul_alloc(tti_alloc->get_ul_mask(), carrier.ul_sb_prbs, L, alloc);
+}
+
+/// Counts the users that may get a new transmission in this TTI, among which the free PRBs are shared
+uint32_t ul_metric_rr::count_newtx_users(sched_ue_list& ue_db)
 {
-  const prbmask_t* used_rb = &tti_alloc->get_ul_mask();
-  *alloc                   = {};
-  for (uint32_t n = 0; n < used_rb->size() && alloc->length() < L; n++) {
-    if (not used_rb->test(n) && alloc->length() == 0) {
-      alloc->displace_to(n);
+  uint32_t count = 0;
+  for (auto& u : ue_db) {
+    sched_ue* user = &u.second;
+    auto      p    = user->get_active_cell_index(cc_cfg->enb_cc_idx);
+    if (not p.first or tti_alloc->is_ul_alloc(user->get_rnti())) {
+      continue;
     }
-    if (not used_rb->test(n)) {
-      alloc->resize_by(1);
-    } else if (alloc->length() > 0) {
-      // avoid edges
-      if (n < 3) {
-        *alloc = {};
-      } else {
-        break;
-      }
+    if (user->get_ul_harq(current_tti, p.second)->is_empty(0) and
+        user->get_pending_ul_new_data(current_tti, p.second) > 0 and user->pdcch_active(ul_pdcch_tti())) {
+      count++;
     }
   }
-  if (alloc->length() == 0) {
-    return false;
-  }
-
-  // Make sure L is allowed by SC-FDMA modulation
-  while (!srslte_dft_precoding_valid_prb(alloc->length())) {
-    alloc->resize_by(-1);
-  }
-  return alloc->length() == L;
+  return count;
 }
 
 ul_harq_proc* ul_metric_rr::allocate_user_retx_prbs(sched_ue* user)
@@ -262,7 +281,12 @@ ul_harq_proc* ul_metric_rr::allocate_user_retx_prbs(sched_ue* user)
       return nullptr;
     }
 
-    if (find_allocation(alloc.length(), &alloc)) {
+    // An adaptive retx needs a PDCCH, which is not monitored by the UE outside DRX Active Time
+    if (not user->pdcch_active(ul_pdcch_tti())) {
+      return nullptr;
+    }
+
+    if (find_allocation(alloc.length(), *user->find_ue_carrier(cc_cfg->enb_cc_idx), &alloc)) {
       ret = tti_alloc->alloc_ul_user(user, alloc);
       if (ret == alloc_outcome_t::SUCCESS) {
         return h;
@@ -291,11 +315,17 @@ ul_harq_proc* ul_metric_rr::allocate_user_newtx_prbs(sched_ue* user)
   ul_harq_proc* h            = user->get_ul_harq(current_tti, cell_idx);
 
   // find an empty PID
-  if (h->is_empty(0) and pending_data > 0) {
-    uint32_t     pending_rb = user->get_required_prb_ul(cell_idx, pending_data);
+  if (h->is_empty(0) and pending_data > 0 and user->pdcch_active(ul_pdcch_tti())) {
+    uint32_t pending_rb = user->get_required_prb_ul(cell_idx, pending_data);
+    if (nof_newtx_users > 1) {
+      // Leave a fair share of the free PRBs to the users that come next
+      uint32_t free_prbs = cc_cfg->nof_prb() - tti_alloc->get_ul_mask().count();
+      pending_rb         = std::min(pending_rb, std::max(srslte::ceil_div(free_prbs, nof_newtx_users), 1u));
+    }
+    nof_newtx_users = nof_newtx_users > 0 ? nof_newtx_users - 1 : 0;
     prb_interval alloc{};
 
-    find_allocation(pending_rb, &alloc);
+    find_allocation(pending_rb, *user->find_ue_carrier(cc_cfg->enb_cc_idx), &alloc);
     if (alloc.length() > 0) { // at least one PRB was scheduled
       alloc_outcome_t ret = tti_alloc->alloc_ul_user(user, alloc);
       if (ret == alloc_outcome_t::SUCCESS) {
@@ -309,4 +339,92 @@ ul_harq_proc* ul_metric_rr::allocate_user_newtx_prbs(sched_ue* user)
   return nullptr;
 }
 
+/*****************************************************************
+ *
+ * Proportional Fair and Max C/I Metrics
+ *
+ *****************************************************************/
+
+const std::vector<sched_rate_avg::ue_prio_t>&
+sched_rate_avg::sort_users(sched_ue_list& ue_db, uint32_t tti, uint32_t enb_cc_idx, bool is_ul)
+{
+  prio_list.clear();
+  uint32_t idx = 0;
+  for (auto& u : ue_db) {
+    float*       ue_avg  = &avg[u.first];
+    float        rate    = 0;
+    cc_sched_ue* carrier = u.second.find_ue_carrier(enb_cc_idx);
+    if (carrier != nullptr) {
+      rate = srslte_cqi_to_coderate(is_ul ? carrier->ul_cqi : carrier->dl_cqi, false);
+    }
+    float prio = fair ? rate / std::max(*ue_avg, 1e-3f) : rate;
+    prio_list.push_back({prio, idx, rate, ue_avg, &u.second});
+    idx++;
+  }
+
+  // New users start with a zero average, drop the averages of the users that left. The other averages do not move
+  if (avg.size() > ue_db.size()) {
+    for (auto it = avg.begin(); it != avg.end();) {
+      if (ue_db.count(it->first) == 0) {
+        it = avg.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  // Users with the same priority are served in a time-domain RR basis
+  uint32_t nof_ues = (uint32_t)prio_list.size();
+  uint32_t offset  = nof_ues - tti % nof_ues;
+  std::sort(prio_list.begin(), prio_list.end(), [nof_ues, offset](const ue_prio_t& a, const ue_prio_t& b) {
+    if (a.prio != b.prio) {
+      return a.prio > b.prio;
+    }
+    return (a.idx + offset) % nof_ues < (b.idx + offset) % nof_ues;
+  });
+  return prio_list;
+}
+
+void dl_metric_pf::sched_users(sched_ue_list& ue_db, dl_sf_sched_itf* tti_sched)
+{
+  tti_alloc = tti_sched;
+
+  if (ue_db.empty()) {
+    return;
+  }
+
+  const auto& users = rate_avg.sort_users(ue_db, tti_alloc->get_tti_tx_dl(), cc_cfg->enb_cc_idx, false);
+  for (const auto& ue : users) {
+    // The served rate is measured with the RBGs the allocation took from the grid
+    size_t nof_rbg = tti_alloc->get_dl_mask().count();
+    allocate_user(ue.user);
+    rate_avg.update(ue, (tti_alloc->get_dl_mask().count() - nof_rbg) * cc_cfg->P);
+  }
+}
+
+void ul_metric_pf::sched_users(sched_ue_list& ue_db, ul_sf_sched_itf* tti_sched)
+{
+  tti_alloc   = tti_sched;
+  current_tti = tti_alloc->get_tti_tx_ul();
+
+  if (ue_db.empty()) {
+    return;
+  }
+
+  // allocate reTxs first, remembering the PRBs taken by every user
+  const auto& users = rate_avg.sort_users(ue_db, current_tti, cc_cfg->enb_cc_idx, true);
+  retx_prbs.resize(users.size());
+  for (size_t i = 0; i < users.size(); ++i) {
+    size_t nof_prb = tti_alloc->get_ul_mask().count();
+    allocate_user_retx_prbs(users[i].user);
+    retx_prbs[i] = tti_alloc->get_ul_mask().count() - nof_prb;
+  }
+  nof_newtx_users = count_newtx_users(ue_db);
+  for (size_t i = 0; i < users.size(); ++i) {
+    size_t nof_prb = tti_alloc->get_ul_mask().count();
+    allocate_user_newtx_prbs(users[i].user);
+    rate_avg.update(users[i], retx_prbs[i] + tti_alloc->get_ul_mask().count() - nof_prb);
+  }
+}
+
 } // namespace srsenb
@@ -0,0 +1,255 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include "srsenb/hdr/stack/mac/scheduler_trace.h"
+#include <cinttypes>
+#include <cstring>
+
+namespace srsenb {
+
+namespace {
+
+//! Reads the arguments of an event in order, failing if there are less than expected
+class args_reader
+{
+public:
+  explicit args_reader(const sched_trace::args_t& args_) : args(args_) {}
+  template <typename T>
+  bool next(T* v)
+  {
+    if (pos >= args.size()) {
+      return false;
+    }
+    *v = static_cast<T>(args[pos++]);
+    return true;
+  }
+
+private:
+  const sched_trace::args_t& args;
+  size_t                     pos = 0;
+};
+
+} // namespace
+
+sched_trace::~sched_trace()
+{
+  close();
+}
+
+bool sched_trace::open(const std::string& filename)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  f = fopen(filename.c_str(), "w");
+  return f != nullptr;
+}
+
+void sched_trace::close()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (f != nullptr) {
+    fclose(f);
+    f = nullptr;
+  }
+}
+
+void sched_trace::write(const char* name, const int64_t* args, size_t nof_args)
+{
+  // one line per event, built first so that concurrent events are not interleaved
+  char   line[1024];
+  size_t n = snprintf(line, sizeof(line), "%s", name);
+  for (size_t i = 0; i < nof_args and n < sizeof(line); ++i) {
+    n += snprintf(line + n, sizeof(line) - n, " %" PRId64, args[i]);
+  }
+  if (n >= sizeof(line) - 1) {
+    return;
+  }
+  line[n++] = '\n';
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (f != nullptr) {
+    fwrite(line, 1, n, f);
+  }
+}
+
+void sched_trace::event(const char* name, std::initializer_list<int64_t> args)
+{
+  write(name, args.begin(), args.size());
+}
+
+void sched_trace::cell_cfg(const std::vector<sched_interface::cell_cfg_t>& cell_cfg)
+{
+  for (uint32_t cc = 0; cc < cell_cfg.size(); ++cc) {
+    const sched_interface::cell_cfg_t& c = cell_cfg[cc];
+
+    args_t args = {cc,
+                   c.cell.nof_prb,
+                   c.cell.nof_ports,
+                   c.cell.id,
+                   c.cell.cp,
+                   c.cell.phich_length,
+                   c.cell.phich_resources,
+                   c.si_window_ms,
+                   c.prach_config,
+                   c.prach_nof_preambles,
+                   c.prach_freq_offset,
+                   c.prach_rar_window,
+                   c.prach_contention_resolution_timer,
+                   c.maxharq_msg3tx,
+                   c.n1pucch_an,
+                   c.delta_pucch_shift,
+                   c.nrb_pucch,
+                   c.nrb_cqi,
+                   c.ncs_an,
+                   c.initial_dl_cqi,
+                   c.srs_subframe_config,
+                   c.srs_subframe_offset,
+                   c.srs_bw_config};
+    args.push_back(sched_interface::MAX_SIBS);
+    for (const auto& sib : c.sibs) {
+      args.push_back(sib.len);
+      args.push_back(sib.period_rf);
+    }
+    args.push_back(c.scell_list.size());
+    for (const auto& scell : c.scell_list) {
+      args.push_back(scell.enb_cc_idx);
+      args.push_back(scell.cross_carrier_scheduling);
+      args.push_back(scell.ul_allowed);
+    }
+    write("cell", args.data(), args.size());
+  }
+  event("cell_cfg", {(int64_t)cell_cfg.size()});
+}
+
+void sched_trace::ue_cfg(uint16_t rnti, const sched_interface::ue_cfg_t& ue_cfg)
+{
+  args_t args = {rnti,
+                 ue_cfg.maxharq_tx,
+                 ue_cfg.continuous_pusch,
+                 ue_cfg.use_tbs_index_alt,
+                 (int64_t)ue_cfg.dl_ant_info.tx_mode,
+                 ue_cfg.uci_offset.I_offset_ack,
+                 ue_cfg.uci_offset.I_offset_cqi,
+                 ue_cfg.uci_offset.I_offset_ri,
+                 ue_cfg.pucch_cfg.sr_configured,
+                 ue_cfg.pucch_cfg.I_sr,
+                 ue_cfg.pucch_cfg.n_pucch_sr,
+                 ue_cfg.pucch_cfg.N_pucch_1};
+  args.push_back(ue_cfg.supported_cc_list.size());
+  for (const auto& cc : ue_cfg.supported_cc_list) {
+    args.push_back(cc.enb_cc_idx);
+    args.push_back(cc.active);
+    args.push_back(cc.dl_cfg.tm);
+    args.push_back(cc.aperiodic_cqi_period);
+    args.push_back(cc.dl_cfg.cqi_report.periodic_configured);
+    args.push_back(cc.dl_cfg.cqi_report.aperiodic_configured);
+    args.push_back(cc.dl_cfg.cqi_report.pmi_idx);
+  }
+  args.push_back(sched_interface::MAX_LC);
+  for (const auto& bearer : ue_cfg.ue_bearers) {
+    args.push_back(bearer.direction);
+    args.push_back(bearer.group);
+    args.push_back(bearer.priority);
+    args.push_back(bearer.pbr);
+    args.push_back(bearer.bsd);
+  }
+  write("ue_cfg", args.data(), args.size());
+}
+
+bool sched_trace::read_event(FILE* f, std::string* name, args_t* args)
+{
+  char line[1024];
+  while (fgets(line, sizeof(line), f) != nullptr) {
+    char* saveptr = nullptr;
+    char* tok     = strtok_r(line, " \n", &saveptr);
+    if (tok == nullptr) {
+      continue;
+    }
+    *name = tok;
+    args->clear();
+    while ((tok = strtok_r(nullptr, " \n", &saveptr)) != nullptr) {
+      args->push_back(strtoll(tok, nullptr, 10));
+    }
+    return true;
+  }
+  return false;
+}
+
+bool sched_trace::decode_cell_cfg(const args_t& args, sched_interface::cell_cfg_t* c)
+{
+  args_reader r(args);
+  uint32_t    cc = 0, nof_sibs = 0, nof_scells = 0;
+
+  *c       = {};
+  bool ret = r.next(&cc) and r.next(&c->cell.nof_prb) and r.next(&c->cell.nof_ports) and r.next(&c->cell.id) and
+             r.next(&c->cell.cp) and r.next(&c->cell.phich_length) and r.next(&c->cell.phich_resources) and
+             r.next(&c->si_window_ms) and r.next(&c->prach_config) and r.next(&c->prach_nof_preambles) and
+             r.next(&c->prach_freq_offset) and r.next(&c->prach_rar_window) and
+             r.next(&c->prach_contention_resolution_timer) and r.next(&c->maxharq_msg3tx) and
+             r.next(&c->n1pucch_an) and r.next(&c->delta_pucch_shift) and r.next(&c->nrb_pucch) and
+             r.next(&c->nrb_cqi) and r.next(&c->ncs_an) and r.next(&c->initial_dl_cqi) and
+             r.next(&c->srs_subframe_config) and r.next(&c->srs_subframe_offset) and r.next(&c->srs_bw_config) and
+             r.next(&nof_sibs) and nof_sibs <= sched_interface::MAX_SIBS;
+  for (uint32_t i = 0; ret and i < nof_sibs; ++i) {
+    ret = r.next(&c->sibs[i].len) and r.next(&c->sibs[i].period_rf);
+  }
+  ret = ret and r.next(&nof_scells);
+  if (ret) {
+    c->scell_list.resize(nof_scells);
+  }
+  for (uint32_t i = 0; ret and i < nof_scells; ++i) {
+    ret = r.next(&c->scell_list[i].enb_cc_idx) and r.next(&c->scell_list[i].cross_carrier_scheduling) and
+          r.next(&c->scell_list[i].ul_allowed);
+  }
+  return ret;
+}
+
+bool sched_trace::decode_ue_cfg(const args_t& args, sched_interface::ue_cfg_t* ue_cfg)
+{
+  args_reader r(args);
+  uint16_t    rnti = 0;
+  uint32_t    nof_cc = 0, nof_lc = 0;
+
+  *ue_cfg  = {};
+  bool ret = r.next(&rnti) and r.next(&ue_cfg->maxharq_tx) and r.next(&ue_cfg->continuous_pusch) and
+             r.next(&ue_cfg->use_tbs_index_alt) and r.next(&ue_cfg->dl_ant_info.tx_mode) and
+             r.next(&ue_cfg->uci_offset.I_offset_ack) and r.next(&ue_cfg->uci_offset.I_offset_cqi) and
+             r.next(&ue_cfg->uci_offset.I_offset_ri) and r.next(&ue_cfg->pucch_cfg.sr_configured) and
+             r.next(&ue_cfg->pucch_cfg.I_sr) and r.next(&ue_cfg->pucch_cfg.n_pucch_sr) and
+             r.next(&ue_cfg->pucch_cfg.N_pucch_1) and r.next(&nof_cc) and nof_cc <= SRSLTE_MAX_CARRIERS;
+  if (ret) {
+    ue_cfg->supported_cc_list.resize(nof_cc);
+  }
+  for (auto& cc : ue_cfg->supported_cc_list) {
+    ret = ret and r.next(&cc.enb_cc_idx) and r.next(&cc.active) and r.next(&cc.dl_cfg.tm) and
+          r.next(&cc.aperiodic_cqi_period) and r.next(&cc.dl_cfg.cqi_report.periodic_configured) and
+          r.next(&cc.dl_cfg.cqi_report.aperiodic_configured) and r.next(&cc.dl_cfg.cqi_report.pmi_idx);
+  }
+  ret = ret and r.next(&nof_lc) and nof_lc <= sched_interface::MAX_LC;
+  for (uint32_t i = 0; ret and i < nof_lc; ++i) {
+    auto& bearer = ue_cfg->ue_bearers[i];
+    ret = r.next(&bearer.direction) and r.next(&bearer.group) and r.next(&bearer.priority) and r.next(&bearer.pbr) and
+          r.next(&bearer.bsd);
+  }
+  return ret;
+}
+
+} // namespace srsenb
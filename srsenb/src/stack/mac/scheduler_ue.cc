@@ -68,11 +68,9 @@ uint32_t get_mac_subheader_sdu_size(uint32_t sdu_bytes)
 uint32_t count_prb_per_tb(const sched_cell_params_t& cell_params, const rbgmask_t& bitmask)
 {
   uint32_t nof_prb = 0;
-  for (uint32_t i = 0; i < bitmask.size(); i++) {
-    if (bitmask.test(i)) {
-      nof_prb += std::min(cell_params.cfg.cell.nof_prb - (i * cell_params.P), cell_params.P);
-    }
-  }
+  bitmask.for_each([&nof_prb, &cell_params](size_t i) {
+    nof_prb += std::min(cell_params.cfg.cell.nof_prb - ((uint32_t)i * cell_params.P), cell_params.P);
+  });
   return nof_prb;
 }
 
@@ -124,6 +122,8 @@ void sched_ue::set_cfg(const sched_interface::ue_cfg_t& cfg_)
   // update bearer cfgs
   lch_handler.set_cfg(cfg_);
 
+  drx.set_config(cfg.drx_cfg);
+
   // in case carriers have been removed
   while (carriers.size() > cfg.supported_cc_list.size()) {
     // TODO: distinguish cell deactivation from reconfiguration
@@ -167,6 +167,7 @@ void sched_ue::reset()
   phy_config_dedicated_enabled = false;
   cqi_request_tti              = 0;
   carriers.clear();
+  drx.reset();
 
   // erase all bearers
   for (uint32_t i = 0; i < cfg.ue_bearers.size(); ++i) {
@@ -179,6 +180,7 @@ void sched_ue::new_tti(srslte::tti_point new_tti)
   current_tti = new_tti;
 
   lch_handler.new_tti();
+  drx.step(new_tti + FDD_HARQ_DELAY_DL_MS);
 }
 
 /// sanity check the UE CC configuration
@@ -299,6 +301,12 @@ int sched_ue::set_ack_info(uint32_t tti_rx, uint32_t enb_cc_idx, uint32_t tb_idx
     tbs_acked                   = p2.second;
     if (tbs_acked > 0) {
       Debug("SCHED: Set DL ACK=%d for rnti=0x%x, pid=%d, tb=%d, tti=%d\n", ack, rnti, p2.first, tb_idx, tti_rx);
+      if (c->harq_ent.dl_harq_procs()[p2.first].nof_retx(tb_idx) == 0) {
+        c->dl_olla.new_feedback(ack);
+      }
+      if (not ack) {
+        drx.dl_tb_failed(tti_point{tti_rx} - FDD_HARQ_DELAY_DL_MS, p2.first);
+      }
     } else {
       Warning("SCHED: Received ACK info for unknown TTI=%d\n", tti_rx);
     }
@@ -315,6 +323,8 @@ void sched_ue::set_ul_crc(srslte::tti_point tti_rx, uint32_t enb_cc_idx, bool cr
     auto ret = c->harq_ent.set_ul_crc(tti_rx, 0, crc_res);
     if (not ret.first) {
       log_h->warning("Received UL CRC for invalid tti_rx=%d\n", (int)tti_rx.to_uint());
+    } else if (c->harq_ent.ul_harq_procs()[ret.second].nof_retx(0) == 0) {
+      c->ul_olla.new_feedback(crc_res);
     }
   } else {
     log_h->warning("Received UL CRC for invalid cell index %d\n", enb_cc_idx);
@@ -353,6 +363,26 @@ void sched_ue::set_dl_cqi(uint32_t tti, uint32_t enb_cc_idx, uint32_t cqi)
   }
 }
 
+void sched_ue::set_dl_sb_cqi(uint32_t tti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi)
+{
+  cc_sched_ue* c = find_ue_carrier(enb_cc_idx);
+  if (c != nullptr and c->cc_state() != cc_st::idle) {
+    c->set_dl_sb_cqi(tti, sb_idx, cqi);
+  } else {
+    log_h->warning("Received DL subband CQI for invalid enb cell index %d\n", enb_cc_idx);
+  }
+}
+
+void sched_ue::set_ul_sb_cqi(uint32_t tti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi)
+{
+  cc_sched_ue* c = find_ue_carrier(enb_cc_idx);
+  if (c != nullptr and c->cc_state() != cc_st::idle) {
+    c->set_ul_sb_cqi(tti, sb_idx, cqi);
+  } else {
+    log_h->warning("Received UL subband CQI for invalid enb cell index %d\n", enb_cc_idx);
+  }
+}
+
 void sched_ue::set_ul_cqi(uint32_t tti, uint32_t enb_cc_idx, uint32_t cqi, uint32_t ul_ch_code)
 {
   cc_sched_ue* c = find_ue_carrier(enb_cc_idx);
@@ -503,6 +533,9 @@ int sched_ue::generate_dl_dci_format(uint32_t                          pid,
     default:
       Error("DCI format (%d) not implemented\n", dci_format);
   }
+  if (tbs > 0) {
+    drx.new_pdcch(tti_point{tti_tx_dl});
+  }
   return tbs;
 }
 
@@ -831,6 +864,11 @@ int sched_ue::generate_format0(sched_interface::ul_sched_data_t* data,
     }
   }
 
+  // The UL DCI is transmitted FDD_HARQ_DELAY_UL_MS before the PUSCH
+  if (needs_pdcch and (tbs > 0 or (tbs == 0 and dci->tb.mcs_idx == 29))) {
+    drx.new_pdcch(tti_point{tti} - FDD_HARQ_DELAY_UL_MS);
+  }
+
   return tbs;
 }
 
@@ -1205,36 +1243,40 @@ cc_sched_ue* sched_ue::find_ue_carrier(uint32_t enb_cc_idx)
 
 int cc_sched_ue::cqi_to_tbs(uint32_t nof_prb, uint32_t nof_re, bool use_tbs_index_alt, bool is_ul, uint32_t* mcs)
 {
-
-  uint32_t cqi     = is_ul ? ul_cqi : dl_cqi;
-  uint32_t max_mcs = is_ul ? max_mcs_ul : (cfg->use_tbs_index_alt) ? max_mcs_dl_alt : max_mcs_dl;
-  uint32_t max_Qm  = is_ul and not ul_64qam_enabled ? 4 : (not is_ul and use_tbs_index_alt ? 8 : 6);
-
-  // Take the upper bound code-rate
-  float    max_coderate = srslte_cqi_to_coderate(std::min(cqi + 1u, 15u), use_tbs_index_alt);
-  int      sel_mcs      = max_mcs + 1;
-  float    coderate     = 99;
-  int      tbs          = 0;
-  uint32_t Qm           = 0;
-
-  do {
-    sel_mcs--;
-    uint32_t tbs_idx = srslte_ra_tbs_idx_from_mcs(sel_mcs, use_tbs_index_alt, is_ul);
-    tbs              = srslte_ra_tbs_from_idx(tbs_idx, nof_prb);
-    coderate         = srslte_coderate(tbs, nof_re);
-    srslte_mod_t mod =
-        (is_ul) ? srslte_ra_ul_mod_from_mcs(sel_mcs) : srslte_ra_dl_mod_from_mcs(sel_mcs, use_tbs_index_alt);
-    Qm = SRSLTE_MIN(max_Qm, srslte_mod_bits_x_symbol(mod));
-  } while (sel_mcs > 0 && coderate > SRSLTE_MIN(max_coderate, 0.930 * Qm));
+  const sched_mcs_table& table   = cell_params->get_mcs_table(use_tbs_index_alt, is_ul);
+  uint32_t               cqi     = is_ul ? ul_cqi : dl_cqi;
+  uint32_t               max_Qm  = is_ul and ul_64qam_enabled ? 6 : table.default_max_Qm();
+  uint32_t               sel_mcs = table.search_mcs(cqi, nof_prb, nof_re, max_Qm);
 
   if (mcs != nullptr) {
-    *mcs = (uint32_t)sel_mcs;
+    *mcs = sel_mcs;
   }
 
   // If coderate > SRSLTE_MIN(max_coderate, 0.930 * Qm) we should set TBS=0. We don't because it's not correctly
   // handled by the scheduler, but we might be scheduling undecodable codewords at very low SNR
 
-  return tbs;
+  return 8 * table.tbs_bytes(sel_mcs, nof_prb);
+}
+
+/************************************************************************************************
+ *                                sched_olla
+ ***********************************************************************************************/
+
+void sched_olla::set_target_bler(float target_bler)
+{
+  // With p the BLER, the offset is stable when p * step_down = (1 - p) * step_up
+  step_up = (target_bler > 0 and target_bler < 1) ? step_down * target_bler / (1 - target_bler) : 0;
+  offset  = 0;
+}
+
+void sched_olla::new_feedback(bool ack)
+{
+  // Bound the offset so that it recovers quickly from a change of the channel
+  const float min_offset = -10, max_offset = 4;
+  if (step_up == 0) {
+    return;
+  }
+  offset = ack ? std::min(offset + step_up, max_offset) : std::max(offset - step_down, min_offset);
 }
 
 /************************************************************************************************
@@ -1268,6 +1310,11 @@ cc_sched_ue::cc_sched_ue(const sched_interface::ue_cfg_t& cfg_,
   fixed_mcs_dl = cell_params->sched_cfg->pdsch_mcs;
   fixed_mcs_ul = cell_params->sched_cfg->pusch_mcs;
 
+  dl_olla.set_target_bler(cell_params->sched_cfg->target_bler);
+  ul_olla.set_target_bler(cell_params->sched_cfg->target_bler);
+  reset_dl_sb_rbgs();
+  reset_ul_sb_prbs();
+
   // Generate allowed CCE locations
   for (int cfi = 0; cfi < 3; cfi++) {
     for (int sf_idx = 0; sf_idx < 10; sf_idx++) {
@@ -1286,9 +1333,33 @@ void cc_sched_ue::reset()
   dl_cqi_tti = 0;
   ul_cqi     = 1;
   ul_cqi_tti = 0;
+  dl_olla.reset();
+  ul_olla.reset();
+  reset_dl_sb_rbgs();
+  reset_ul_sb_prbs();
   harq_ent.reset();
 }
 
+void cc_sched_ue::reset_dl_sb_rbgs()
+{
+  for (auto& rbgs : dl_sb_rbgs) {
+    rbgs.resize(cell_params->nof_rbgs);
+    rbgs.reset();
+  }
+  dl_sb_rbgs[2].fill(0, cell_params->nof_rbgs, true);
+  dl_sb_cqi_tti = 0;
+}
+
+void cc_sched_ue::reset_ul_sb_prbs()
+{
+  for (auto& prbs : ul_sb_prbs) {
+    prbs.resize(cell_params->nof_prb());
+    prbs.reset();
+  }
+  ul_sb_prbs[2].fill(0, cell_params->nof_prb(), true);
+  ul_sb_cqi_tti = 0;
+}
+
 void cc_sched_ue::set_cfg(const sched_interface::ue_cfg_t& cfg_)
 {
   cfg     = &cfg_;
@@ -1375,31 +1446,46 @@ int cc_sched_ue::alloc_tbs(uint32_t nof_prb, uint32_t nof_re, uint32_t req_bytes
   uint32_t sel_mcs = 0;
 
   // TODO: Compute real spectral efficiency based on PUSCH-UCI configuration
-  int tbs_bytes = cqi_to_tbs(nof_prb, nof_re, cfg->use_tbs_index_alt, is_ul, &sel_mcs) / 8;
+  cqi_to_tbs(nof_prb, nof_re, cfg->use_tbs_index_alt, is_ul, &sel_mcs);
+
+  return alloc_tbs_from_mcs(nof_prb, sel_mcs, req_bytes, is_ul, mcs);
+}
+
+/* Highest MCS of the UE, given the configured limit and the UL modulations its category supports */
+uint32_t cc_sched_ue::get_max_mcs(bool is_ul) const
+{
+  if (not is_ul) {
+    return cfg->use_tbs_index_alt ? max_mcs_dl_alt : max_mcs_dl;
+  }
+  // The UL MCS above 20 are 64QAM (TS 36.213 Table 8.6.1-1)
+  return ul_64qam_enabled ? max_mcs_ul : std::min(max_mcs_ul, 20u);
+}
+
+/* Applies the link adaptation offset to the MCS derived from the CQI, and lowers it if less bytes are requested */
+int cc_sched_ue::alloc_tbs_from_mcs(uint32_t nof_prb, uint32_t cqi_mcs, uint32_t req_bytes, bool is_ul, int* mcs)
+{
+  const sched_mcs_table& table   = cell_params->get_mcs_table(cfg->use_tbs_index_alt, is_ul);
+  uint32_t               max_mcs = std::min(get_max_mcs(is_ul), table.max_mcs());
+  int                    sel_mcs = (int)cqi_mcs + (is_ul ? ul_olla : dl_olla).mcs_offset();
+  sel_mcs                        = std::max(0, std::min(sel_mcs, (int)max_mcs));
+  int tbs_bytes                  = table.tbs_bytes(sel_mcs, nof_prb);
 
   /* If less bytes are requested, lower the MCS */
   if (tbs_bytes > (int)req_bytes && req_bytes > 0) {
-    int req_tbs_idx = srslte_ra_tbs_to_table_idx(req_bytes * 8, nof_prb);
-    int req_mcs     = srslte_ra_mcs_from_tbs_idx(req_tbs_idx, cfg->use_tbs_index_alt, is_ul);
-    while (cfg->use_tbs_index_alt and req_mcs < 0 and req_tbs_idx < 33) {
-      // some tbs_idx are invalid for 256QAM. See TS 36.213 - Table 7.1.7.1-1A
-      req_mcs = srslte_ra_mcs_from_tbs_idx(++req_tbs_idx, cfg->use_tbs_index_alt, is_ul);
-    }
-
-    if (req_mcs >= 0 and req_mcs < (int)sel_mcs) {
+    int req_mcs = table.min_mcs(req_bytes, nof_prb);
+    if (req_mcs >= 0 and req_mcs < sel_mcs) {
       sel_mcs   = req_mcs;
-      tbs_bytes = srslte_ra_tbs_from_idx(req_tbs_idx, nof_prb) / 8;
+      tbs_bytes = table.tbs_bytes(sel_mcs, nof_prb);
     }
   }
   // Avoid the unusual case n_prb=1, mcs=6 tbs=328 (used in voip)
   if (nof_prb == 1 && sel_mcs == 6) {
     sel_mcs--;
-    uint32_t tbs_idx = srslte_ra_tbs_idx_from_mcs(sel_mcs, cfg->use_tbs_index_alt, is_ul);
-    tbs_bytes        = srslte_ra_tbs_from_idx(tbs_idx, nof_prb) / 8;
+    tbs_bytes = table.tbs_bytes(sel_mcs, nof_prb);
   }
 
   if (mcs != nullptr && tbs_bytes >= 0) {
-    *mcs = (int)sel_mcs;
+    *mcs = sel_mcs;
   }
 
   return tbs_bytes;
@@ -1417,16 +1503,15 @@ int cc_sched_ue::alloc_tbs_ul(uint32_t nof_prb, uint32_t nof_re, uint32_t req_by
 
 int cc_sched_ue::get_required_prb_dl(uint32_t req_bytes, uint32_t nof_ctrl_symbols)
 {
-  int      mcs    = 0;
-  uint32_t nof_re = 0;
-  int      tbs    = 0;
+  int                    mcs   = 0;
+  int                    tbs   = 0;
+  const sched_mcs_table& table = cell_params->get_mcs_table(cfg->use_tbs_index_alt, false);
 
   uint32_t nbytes = 0;
   uint32_t n;
   for (n = 0; n < cell_params->nof_prb() and nbytes < req_bytes; ++n) {
-    nof_re = srslte_ra_dl_approx_nof_re(&cell_params->cfg.cell, n + 1, nof_ctrl_symbols);
     if (fixed_mcs_dl < 0 or not dl_cqi_rx) {
-      tbs = alloc_tbs_dl(n + 1, nof_re, 0, &mcs);
+      tbs = alloc_tbs_from_mcs(n + 1, table.cqi_to_mcs(dl_cqi, n + 1, nof_ctrl_symbols), 0, false, &mcs);
     } else {
       tbs = srslte_ra_tbs_from_idx(srslte_ra_tbs_idx_from_mcs(fixed_mcs_dl, cfg->use_tbs_index_alt, false), n + 1) / 8;
     }
@@ -1442,9 +1527,10 @@ int cc_sched_ue::get_required_prb_dl(uint32_t req_bytes, uint32_t nof_ctrl_symbo
 
 uint32_t cc_sched_ue::get_required_prb_ul(uint32_t req_bytes)
 {
-  int      mcs    = 0;
-  uint32_t nbytes = 0;
-  uint32_t N_srs  = 0;
+  int                    mcs    = 0;
+  uint32_t               nbytes = 0;
+  uint32_t               N_srs  = 0;
+  const sched_mcs_table& table  = cell_params->get_mcs_table(cfg->use_tbs_index_alt, true);
 
   uint32_t n = 0;
   if (req_bytes == 0) {
@@ -1455,8 +1541,10 @@ uint32_t cc_sched_ue::get_required_prb_ul(uint32_t req_bytes)
   for (n = 1; n < cell_params->nof_prb() && nbytes < req_bytes + 4; n++) {
     uint32_t nof_re = (2 * (SRSLTE_CP_NSYMB(cell_params->cfg.cell.cp) - 1) - N_srs) * n * SRSLTE_NRE;
     int      tbs    = 0;
-    if (fixed_mcs_ul < 0) {
+    if (fixed_mcs_ul < 0 and ul_64qam_enabled) {
       tbs = alloc_tbs_ul(n, nof_re, 0, &mcs);
+    } else if (fixed_mcs_ul < 0) {
+      tbs = alloc_tbs_from_mcs(n, table.cqi_to_mcs(ul_cqi, n), 0, true, &mcs);
     } else {
       tbs = srslte_ra_tbs_from_idx(srslte_ra_tbs_idx_from_mcs(fixed_mcs_ul, false, true), n) / 8;
     }
@@ -1493,6 +1581,57 @@ void cc_sched_ue::set_dl_cqi(uint32_t tti_tx_dl, uint32_t dl_cqi_)
   }
 }
 
+void cc_sched_ue::set_dl_sb_cqi(uint32_t tti_tx_dl, uint32_t sb_idx, uint32_t sb_cqi)
+{
+  // The subbands are aligned with the RBGs (TS 36.213 Tables 7.1.6.1-1 and 7.2.1-3)
+  int sb_size = srslte_cqi_hl_get_subband_size(cell_params->nof_prb());
+  if (sb_size <= 0) {
+    return;
+  }
+  uint32_t rbg_start = sb_idx * sb_size / cell_params->P;
+  uint32_t rbg_end   = std::min((sb_idx + 1) * sb_size / cell_params->P, cell_params->nof_rbgs);
+  if (rbg_start >= rbg_end) {
+    log_h->warning("SCHED: Invalid subband index %d for rnti=0x%x\n", sb_idx, rnti);
+    return;
+  }
+
+  // The reported subband CQIs differ from the wideband CQI by -1 to +2 (TS 36.213 Table 7.2.1-2)
+  int offset = std::max(-1, std::min((int)sb_cqi - (int)dl_cqi, 2));
+  for (auto& rbgs : dl_sb_rbgs) {
+    rbgs.fill(rbg_start, rbg_end, false);
+  }
+  dl_sb_rbgs[2 - offset].fill(rbg_start, rbg_end, true);
+  dl_sb_cqi_tti = tti_tx_dl;
+}
+
+bool cc_sched_ue::is_dl_sb_cqi_valid(uint32_t tti_tx_dl) const
+{
+  return srslte_tti_interval(tti_tx_dl, dl_sb_cqi_tti) <= SCHED_MAX_SB_CQI_AGE_MS;
+}
+
+void cc_sched_ue::set_ul_sb_cqi(uint32_t tti, uint32_t sb_idx, uint32_t sb_cqi)
+{
+  // The SRS subbands have the size of the DL higher layer configured subbands
+  int sb_size = srslte_cqi_hl_get_subband_size(cell_params->nof_prb());
+  if (sb_size <= 0) {
+    return;
+  }
+  uint32_t prb_start = sb_idx * sb_size;
+  uint32_t prb_end   = std::min((sb_idx + 1) * sb_size, cell_params->nof_prb());
+  if (prb_start >= prb_end) {
+    log_h->warning("SCHED: Invalid UL subband index %d for rnti=0x%x\n", sb_idx, rnti);
+    return;
+  }
+
+  // Same grouping as the DL subbands, from two CQI above the wideband UL CQI to one below
+  int offset = std::max(-1, std::min((int)sb_cqi - (int)ul_cqi, 2));
+  for (auto& prbs : ul_sb_prbs) {
+    prbs.fill(prb_start, prb_end, false);
+  }
+  ul_sb_prbs[2 - offset].fill(prb_start, prb_end, true);
+  ul_sb_cqi_tti = tti;
+}
+
 /*******************************************************
  *
  *         Logical Channel Management
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/mac/softbuffer_pool.h"
+#include <algorithm>
+
+namespace srsenb {
+
+// Number of code blocks of a TB of tbs bytes (TS 36.212 Section 5.1.2)
+static uint32_t nof_cb_from_tbs(uint32_t tbs)
+{
+  uint32_t B = tbs * 8 + 24;
+  if (B <= SRSLTE_TCOD_MAX_LEN_CB) {
+    return 1;
+  }
+  return (B + SRSLTE_TCOD_MAX_LEN_CB - 24 - 1) / (SRSLTE_TCOD_MAX_LEN_CB - 24);
+}
+
+softbuffer_pool::~softbuffer_pool()
+{
+  for (auto& b : tx_buffers) {
+    srslte_softbuffer_tx_free(b.get());
+  }
+  for (auto& b : rx_buffers) {
+    srslte_softbuffer_rx_free(b.get());
+  }
+}
+
+void softbuffer_pool::init(uint32_t max_nof_prb, bool rx_8bit_)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  rx_8bit = rx_8bit_;
+
+  // One size class per bandwidth, from the smallest one up to the cell bandwidth
+  classes.clear();
+  const uint32_t prb_list[] = {6, 15, 25, 50, 75, 100};
+  for (uint32_t nof_prb : prb_list) {
+    nof_prb = std::min(nof_prb, max_nof_prb);
+    int tbs = srslte_ra_tbs_from_idx(SRSLTE_RA_NOF_TBS_IDX - 1, nof_prb);
+    if (tbs < 0) {
+      continue;
+    }
+    // Same dimensioning as srslte_softbuffer_tx_init() and srslte_softbuffer_rx_init()
+    uint32_t max_cb = (uint32_t)tbs / (SRSLTE_TCOD_MAX_LEN_CB - 24) + 1;
+    if (classes.empty() or classes.back().max_cb < max_cb) {
+      classes.emplace_back();
+      classes.back().nof_prb = nof_prb;
+      classes.back().max_cb  = max_cb;
+    }
+  }
+}
+
+softbuffer_pool::size_class_t* softbuffer_pool::find_class(uint32_t max_cb)
+{
+  for (auto& c : classes) {
+    if (c.max_cb >= max_cb) {
+      return &c;
+    }
+  }
+  // The largest class is dimensioned for the cell bandwidth
+  return classes.empty() ? nullptr : &classes.back();
+}
+
+srslte_softbuffer_tx_t* softbuffer_pool::reserve(srslte_softbuffer_tx_t** slot, uint32_t tbs)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  uint32_t max_cb = nof_cb_from_tbs(tbs);
+  if (*slot != nullptr) {
+    if ((*slot)->max_cb >= max_cb or (*slot)->max_cb == classes.back().max_cb) {
+      return *slot;
+    }
+    find_class((*slot)->max_cb)->free_tx.push_back(*slot);
+    *slot = nullptr;
+  }
+
+  size_class_t* c = find_class(max_cb);
+  if (c == nullptr) {
+    return nullptr;
+  }
+  if (c->free_tx.empty()) {
+    tx_buffers.emplace_back(new srslte_softbuffer_tx_t{});
+    if (srslte_softbuffer_tx_init(tx_buffers.back().get(), c->nof_prb) != SRSLTE_SUCCESS) {
+      srslte_softbuffer_tx_free(tx_buffers.back().get());
+      tx_buffers.pop_back();
+      return nullptr;
+    }
+    c->free_tx.push_back(tx_buffers.back().get());
+  }
+  *slot = c->free_tx.back();
+  c->free_tx.pop_back();
+  // The softbuffer may hold the state of a previous HARQ process
+  srslte_softbuffer_tx_reset(*slot);
+  return *slot;
+}
+
+srslte_softbuffer_rx_t* softbuffer_pool::reserve(srslte_softbuffer_rx_t** slot, uint32_t tbs)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  uint32_t max_cb = nof_cb_from_tbs(tbs);
+  if (*slot != nullptr) {
+    if ((*slot)->max_cb >= max_cb or (*slot)->max_cb == classes.back().max_cb) {
+      return *slot;
+    }
+    find_class((*slot)->max_cb)->free_rx.push_back(*slot);
+    *slot = nullptr;
+  }
+
+  size_class_t* c = find_class(max_cb);
+  if (c == nullptr) {
+    return nullptr;
+  }
+  if (c->free_rx.empty()) {
+    rx_buffers.emplace_back(new srslte_softbuffer_rx_t{});
+    int ret = rx_8bit ? srslte_softbuffer_rx_init_8bit(rx_buffers.back().get(), c->nof_prb)
+                      : srslte_softbuffer_rx_init(rx_buffers.back().get(), c->nof_prb);
+    if (ret != SRSLTE_SUCCESS) {
+      srslte_softbuffer_rx_free(rx_buffers.back().get());
+      rx_buffers.pop_back();
+      return nullptr;
+    }
+    c->free_rx.push_back(rx_buffers.back().get());
+  }
+  *slot = c->free_rx.back();
+  c->free_rx.pop_back();
+  // The softbuffer may hold the state of a previous HARQ process
+  srslte_softbuffer_rx_reset(*slot);
+  return *slot;
+}
+
+void softbuffer_pool::release(srslte_softbuffer_tx_t** slot)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (*slot != nullptr) {
+    find_class((*slot)->max_cb)->free_tx.push_back(*slot);
+    *slot = nullptr;
+  }
+}
+
+void softbuffer_pool::release(srslte_softbuffer_rx_t** slot)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (*slot != nullptr) {
+    find_class((*slot)->max_cb)->free_rx.push_back(*slot);
+    *slot = nullptr;
+  }
+}
+
+} // namespace srsenb
@@ -26,6 +26,7 @@
 
 #include "srsenb/hdr/stack/mac/ue.h"
 #include "srslte/common/log_helper.h"
+#include "srslte/common/logmap.h"
 #include "srslte/interfaces/enb_interfaces.h"
 
 namespace srsenb {
@@ -37,6 +38,7 @@ ue::ue(uint16_t                 rnti_,
        rlc_interface_mac*       rlc_,
        phy_interface_stack_lte* phy_,
        srslte::log_ref          log_,
+       softbuffer_pool*         softbuffers_,
        uint32_t                 nof_cells_,
        uint32_t                 nof_rx_harq_proc_,
        uint32_t                 nof_tx_harq_proc_) :
@@ -47,9 +49,9 @@ ue::ue(uint16_t                 rnti_,
   rlc(rlc_),
   phy(phy_),
   log_h(log_),
+  softbuffers(softbuffers_),
   mac_msg_dl(20, log_),
   mch_mac_msg_dl(10, log_),
-  mac_msg_ul(20, log_),
   pdus(128),
   nof_rx_harq_proc(nof_rx_harq_proc_),
   nof_tx_harq_proc(nof_tx_harq_proc_),
@@ -66,6 +68,7 @@ ue::ue(uint16_t                 rnti_,
   }
 
   pdus.init(this, log_h);
+  dl_harq_tti.resize(nof_cells_);
 
   // Allocate buffer for PCell
   allocate_cc_buffers();
@@ -73,36 +76,23 @@ ue::ue(uint16_t                 rnti_,
 
 ue::~ue()
 {
-  // Free up all softbuffers for all CCs
-  for (auto cc : softbuffer_rx) {
-    for (auto buffer : cc) {
-      srslte_softbuffer_rx_free(&buffer);
-    }
-  }
-
-  for (auto cc : softbuffer_tx) {
-    for (auto buffer : cc) {
-      srslte_softbuffer_tx_free(&buffer);
-    }
-  }
+  release_softbuffers();
 }
 
 void ue::reset()
 {
-  metrics      = {};
-  nof_failures = 0;
-
-  for (auto cc : softbuffer_rx) {
-    for (auto buffer : cc) {
-      srslte_softbuffer_rx_reset(&buffer);
-    }
+  mac_metrics_t discarded = {};
+  metrics_read(&discarded);
+  for (auto& b : metrics.dl_buffer) {
+    b.reset();
   }
-
-  for (auto cc : softbuffer_tx) {
-    for (auto buffer : cc) {
-      srslte_softbuffer_tx_reset(&buffer);
-    }
+  for (auto& b : metrics.ul_buffer) {
+    b.reset();
   }
+  nof_failures = 0;
+
+  // Flush the HARQ processes
+  release_softbuffers();
 
   for (auto& cc_buffers : pending_buffers) {
     for (auto& harq_buffer : cc_buffers) {
@@ -115,9 +105,8 @@ void ue::reset()
 }
 
 /**
- * Allocate and initialize softbuffers for Tx and Rx and
- * append to current list of CC buffers. It uses the configured
- * number of HARQ processes and cell width.
+ * Append the Tx and Rx softbuffer slots of num_cc carriers to the current list of CC buffers. It uses the
+ * configured number of HARQ processes. The softbuffers themselves are taken from the pool when used.
  *
  * @param num_cc Number of carriers to add buffers for (default 1)
  * @return number of carriers
@@ -125,28 +114,27 @@ void ue::reset()
 uint32_t ue::allocate_cc_buffers(const uint32_t num_cc)
 {
   for (uint32_t i = 0; i < num_cc; ++i) {
-    // create and init Rx buffers for Pcell
-    softbuffer_rx.emplace_back();
-    softbuffer_rx.back().resize(nof_rx_harq_proc);
-    for (auto& buffer : softbuffer_rx.back()) {
-      srslte_softbuffer_rx_init(&buffer, nof_prb);
-    }
+    softbuffer_rx.emplace_back(nof_rx_harq_proc, nullptr);
+    pending_buffers.emplace_back(nof_rx_harq_proc, nullptr);
+    softbuffer_tx.emplace_back(nof_tx_harq_proc, nullptr);
+  }
+  return softbuffer_tx.size();
+}
 
-    pending_buffers.emplace_back();
-    pending_buffers.back().resize(nof_rx_harq_proc);
-    for (auto& buffer : pending_buffers.back()) {
-      buffer = nullptr;
+/// Gives all the softbuffers of the UE back to the pool
+void ue::release_softbuffers()
+{
+  for (auto& cc : softbuffer_rx) {
+    for (auto& buffer : cc) {
+      softbuffers->release(&buffer);
     }
+  }
 
-    // Create and init Tx buffers for Pcell
-    softbuffer_tx.emplace_back();
-    softbuffer_tx.back().resize(nof_tx_harq_proc);
-    for (auto& buffer : softbuffer_tx.back()) {
-      srslte_softbuffer_tx_init(&buffer, nof_prb);
+  for (auto& cc : softbuffer_tx) {
+    for (auto& buffer : cc) {
+      softbuffers->release(&buffer);
     }
-    // don't need to reset because just initiated the buffers
   }
-  return softbuffer_tx.size();
 }
 
 void ue::start_pcap(srslte::mac_pcap* pcap_)
@@ -154,7 +142,7 @@ void ue::start_pcap(srslte::mac_pcap* pcap_)
   pcap = pcap_;
 }
 
-srslte_softbuffer_rx_t* ue::get_rx_softbuffer(const uint32_t ue_cc_idx, const uint32_t tti)
+srslte_softbuffer_rx_t* ue::get_rx_softbuffer(const uint32_t ue_cc_idx, const uint32_t tti, const uint32_t tbs)
 {
   if ((size_t)ue_cc_idx >= softbuffer_rx.size()) {
     ERROR("UE CC Index (%d/%zd) out-of-range\n", ue_cc_idx, softbuffer_rx.size());
@@ -166,11 +154,13 @@ srslte_softbuffer_rx_t* ue::get_rx_softbuffer(const uint32_t ue_cc_idx, const ui
     return nullptr;
   }
 
-  return &softbuffer_rx.at(ue_cc_idx).at(tti % nof_rx_harq_proc);
+  return softbuffers->reserve(&softbuffer_rx.at(ue_cc_idx).at(tti % nof_rx_harq_proc), tbs);
 }
 
-srslte_softbuffer_tx_t*
-ue::get_tx_softbuffer(const uint32_t ue_cc_idx, const uint32_t harq_process, const uint32_t tb_idx)
+srslte_softbuffer_tx_t* ue::get_tx_softbuffer(const uint32_t ue_cc_idx,
+                                              const uint32_t harq_process,
+                                              const uint32_t tb_idx,
+                                              const uint32_t tbs)
 {
   if ((size_t)ue_cc_idx >= softbuffer_tx.size()) {
     ERROR("UE CC Index (%d/%zd) out-of-range\n", ue_cc_idx, softbuffer_tx.size());
@@ -182,7 +172,35 @@ ue::get_tx_softbuffer(const uint32_t ue_cc_idx, const uint32_t harq_process, con
     return nullptr;
   }
 
-  return &softbuffer_tx.at(ue_cc_idx).at((harq_process * SRSLTE_MAX_TB + tb_idx) % nof_tx_harq_proc);
+  uint32_t buffer_idx = (harq_process * SRSLTE_MAX_TB + tb_idx) % nof_tx_harq_proc;
+  return softbuffers->reserve(&softbuffer_tx.at(ue_cc_idx).at(buffer_idx), tbs);
+}
+
+void ue::set_dl_harq_tti(uint32_t enb_cc_idx, uint32_t tti_tx, uint32_t ue_cc_idx, uint32_t pid)
+{
+  if (enb_cc_idx < dl_harq_tti.size()) {
+    dl_harq_tti[enb_cc_idx][tti_tx % SRSLTE_FDD_NOF_HARQ] = {ue_cc_idx, pid};
+  }
+}
+
+/// The TB was acknowledged, its HARQ process no longer needs the softbuffer
+void ue::release_tx_softbuffer(uint32_t enb_cc_idx, uint32_t tti_ack, uint32_t tb_idx)
+{
+  if (enb_cc_idx >= dl_harq_tti.size()) {
+    return;
+  }
+  const dl_harq_t& h = dl_harq_tti[enb_cc_idx][TTI_SUB(tti_ack, FDD_HARQ_DELAY_UL_MS) % SRSLTE_FDD_NOF_HARQ];
+  if (h.ue_cc_idx < softbuffer_tx.size()) {
+    softbuffers->release(&softbuffer_tx[h.ue_cc_idx].at((h.pid * SRSLTE_MAX_TB + tb_idx) % nof_tx_harq_proc));
+  }
+}
+
+/// The TB was decoded, its HARQ process no longer needs the softbuffer
+void ue::release_rx_softbuffer(uint32_t ue_cc_idx, uint32_t tti)
+{
+  if (ue_cc_idx < softbuffer_rx.size()) {
+    softbuffers->release(&softbuffer_rx[ue_cc_idx].at(tti % nof_rx_harq_proc));
+  }
 }
 
 uint8_t* ue::request_buffer(const uint32_t ue_cc_idx, const uint32_t tti, const uint32_t len)
@@ -190,8 +208,11 @@ uint8_t* ue::request_buffer(const uint32_t ue_cc_idx, const uint32_t tti, const
   uint8_t* ret = nullptr;
   if (len > 0) {
     if (!pending_buffers.at(ue_cc_idx).at(tti % nof_rx_harq_proc)) {
-      ret                                                      = pdus.request(len);
-      pending_buffers.at(ue_cc_idx).at(tti % nof_rx_harq_proc) = ret;
+      uint8_t* buffer = pdus.request(ul_demux_len + len);
+      if (buffer != nullptr) {
+        pending_buffers.at(ue_cc_idx).at(tti % nof_rx_harq_proc) = buffer;
+        ret                                                      = buffer + ul_demux_len;
+      }
     } else {
       log_h->error("Requesting buffer for pid %d, not pushed yet\n", tti % nof_rx_harq_proc);
     }
@@ -227,99 +248,135 @@ uint32_t ue::set_ta(int ta_)
   return nof_cmd;
 }
 
-#include <assert.h>
-
-void ue::process_pdu(uint8_t* pdu, uint32_t nof_bytes, srslte::pdu_queue::channel_t channel)
+/// Parses the PDU in the PHY worker that decoded it. The subheaders are kept in the buffer, in front of the PDU
+void ue::demux_pdu(uint8_t* buffer, uint32_t nof_bytes)
 {
+  // Every PHY worker has its own parser, the PDUs of a UE are decoded by different workers. The parser is shared by
+  // all the UEs, so it logs to the MAC log rather than to the log of the UE that created it
+  static thread_local srslte::sch_pdu mac_msg_ul(max_ul_subh, srslte::logmap::get("MAC"));
+
+  ul_demux_t* demux = (ul_demux_t*)buffer;
+  uint8_t*    pdu   = buffer + ul_demux_len;
+
   // Unpack ULSCH MAC PDU
   mac_msg_ul.init_rx(nof_bytes, true);
   mac_msg_ul.parse_packet(pdu);
 
-  Info("0x%x %s\n", rnti, mac_msg_ul.to_string().c_str());
-
-  if (pcap) {
-    pcap->write_ul_crnti(pdu, nof_bytes, rnti, true, last_tti, UL_CC_IDX);
+  if (log_h->get_level() >= srslte::LOG_LEVEL_INFO) {
+    Info("0x%x %s\n", rnti, mac_msg_ul.to_string().c_str());
   }
 
-  pdus.deallocate(pdu);
-
-  uint32_t lcid_most_data = 0;
-  int      most_data      = -99;
+  demux->nof_sdus       = 0;
+  demux->nof_ces        = 0;
+  demux->lcid_most_data = 0;
+  int most_data         = -99;
 
   while (mac_msg_ul.next()) {
-    assert(mac_msg_ul.get());
-    if (mac_msg_ul.get()->is_sdu()) {
+    srslte::sch_subh* subh = mac_msg_ul.get();
+    if (subh->is_sdu()) {
+      ul_demux_t::sdu_t& sdu = demux->sdus[demux->nof_sdus++];
+      sdu.lcid               = subh->get_sdu_lcid();
+      sdu.offset             = subh->get_sdu_ptr() - pdu;
+      sdu.nof_bytes          = subh->get_payload_size();
+      sdu.route              = true;
+
       /* In some cases, an uplink transmission with only CQI has all zeros and gets routed to RRC
        * Compute the checksum if lcid=0 and avoid routing in that case
        */
-      bool route_pdu = true;
-      if (mac_msg_ul.get()->get_sdu_lcid() == 0) {
-        uint8_t* x   = mac_msg_ul.get()->get_sdu_ptr();
+      if (sdu.lcid == 0) {
+        uint8_t* x   = subh->get_sdu_ptr();
         uint32_t sum = 0;
-        for (uint32_t i = 0; i < mac_msg_ul.get()->get_payload_size(); i++) {
+        for (uint32_t i = 0; i < sdu.nof_bytes; i++) {
           sum += x[i];
         }
-        if (sum == 0) {
-          route_pdu = false;
-          Debug("Received all zero PDU\n");
-        }
+        sdu.route = (sum != 0);
       }
 
-      if (route_pdu) {
-        rlc->write_pdu(rnti,
-                       mac_msg_ul.get()->get_sdu_lcid(),
-                       mac_msg_ul.get()->get_sdu_ptr(),
-                       mac_msg_ul.get()->get_payload_size());
+      if ((int)sdu.nof_bytes > most_data) {
+        most_data             = (int)sdu.nof_bytes;
+        demux->lcid_most_data = sdu.lcid;
+      }
+    } else {
+      ul_demux_t::ce_t& ce = demux->ces[demux->nof_ces++];
+      ce                   = {};
+      ce.type              = subh->ul_sch_ce_type();
+      switch (ce.type) {
+        case srslte::ul_sch_lcid::PHR_REPORT:
+          ce.phr = subh->get_phr();
+          break;
+        case srslte::ul_sch_lcid::CRNTI:
+          ce.c_rnti = subh->get_c_rnti();
+          break;
+        case srslte::ul_sch_lcid::TRUNC_BSR:
+        case srslte::ul_sch_lcid::SHORT_BSR:
+        case srslte::ul_sch_lcid::LONG_BSR: {
+          uint32_t buff_size_idx[4] = {};
+          ce.bsr_lcg                = subh->get_bsr(buff_size_idx, ce.bsr_bytes);
+        } break;
+        default:
+          break;
       }
+    }
+  }
+}
 
-      // Indicate scheduler to update BSR counters
-      // sched->ul_recv_len(rnti, mac_msg_ul.get()->get_sdu_lcid(), mac_msg_ul.get()->get_payload_size());
+void ue::process_pdu(uint8_t* buffer, uint32_t nof_bytes, srslte::pdu_queue::channel_t channel)
+{
+  const ul_demux_t* demux = (const ul_demux_t*)buffer;
+  uint8_t*          pdu   = buffer + ul_demux_len;
 
-      // Indicate RRC about successful activity if valid RLC message is received
-      if (mac_msg_ul.get()->get_payload_size() > 64) { // do not count RLC status messages only
-        rrc->set_activity_user(rnti);
-        log_h->debug("UL activity rnti=0x%x, n_bytes=%d\n", rnti, nof_bytes);
-      }
+  if (pcap) {
+    pcap->write_ul_crnti(pdu, nof_bytes, rnti, true, last_tti, UL_CC_IDX);
+  }
 
-      if ((int)mac_msg_ul.get()->get_payload_size() > most_data) {
-        most_data      = (int)mac_msg_ul.get()->get_payload_size();
-        lcid_most_data = mac_msg_ul.get()->get_sdu_lcid();
-      }
+  for (uint32_t i = 0; i < demux->nof_sdus; i++) {
+    const ul_demux_t::sdu_t& sdu = demux->sdus[i];
+    if (sdu.route) {
+      rlc->write_pdu(rnti, sdu.lcid, pdu + sdu.offset, sdu.nof_bytes);
+    } else {
+      Debug("Received all zero PDU\n");
+    }
 
-      // Save contention resolution if lcid == 0
-      if (mac_msg_ul.get()->get_sdu_lcid() == 0 && route_pdu) {
-        int nbytes = srslte::sch_subh::MAC_CE_CONTRES_LEN;
-        if (mac_msg_ul.get()->get_payload_size() >= (uint32_t)nbytes) {
-          uint8_t* ue_cri_ptr = (uint8_t*)&conres_id;
-          uint8_t* pkt_ptr    = mac_msg_ul.get()->get_sdu_ptr(); // Warning here: we want to include the
-          for (int i = 0; i < nbytes; i++) {
-            ue_cri_ptr[nbytes - i - 1] = pkt_ptr[i];
-          }
-        } else {
-          Error("Received CCCH UL message of invalid size=%d bytes\n", mac_msg_ul.get()->get_payload_size());
+    // Indicate scheduler to update BSR counters
+    // sched->ul_recv_len(rnti, sdu.lcid, sdu.nof_bytes);
+
+    // Indicate RRC about successful activity if valid RLC message is received
+    if (sdu.nof_bytes > 64) { // do not count RLC status messages only
+      rrc->set_activity_user(rnti);
+      log_h->debug("UL activity rnti=0x%x, n_bytes=%d\n", rnti, nof_bytes);
+    }
+
+    // Save contention resolution if lcid == 0
+    if (sdu.lcid == 0 && sdu.route) {
+      int nbytes = srslte::sch_subh::MAC_CE_CONTRES_LEN;
+      if (sdu.nof_bytes >= (uint32_t)nbytes) {
+        uint8_t* ue_cri_ptr = (uint8_t*)&conres_id;
+        uint8_t* pkt_ptr    = pdu + sdu.offset; // Warning here: we want to include the
+        for (int i = 0; i < nbytes; i++) {
+          ue_cri_ptr[nbytes - i - 1] = pkt_ptr[i];
         }
+      } else {
+        Error("Received CCCH UL message of invalid size=%d bytes\n", sdu.nof_bytes);
       }
     }
   }
-  mac_msg_ul.reset();
 
   /* Process CE after all SDUs because we need to update BSR after */
   bool bsr_received = false;
-  while (mac_msg_ul.next()) {
-    assert(mac_msg_ul.get());
-    if (!mac_msg_ul.get()->is_sdu()) {
-      // Process MAC Control Element
-      bsr_received |= process_ce(mac_msg_ul.get());
-    }
+  for (uint32_t i = 0; i < demux->nof_ces; i++) {
+    // Process MAC Control Element
+    bsr_received |= process_ce(demux->ces[i]);
   }
 
   // If BSR is not received means that new data has arrived and there is no space for BSR transmission
-  if (!bsr_received && lcid_most_data > 2) {
+  if (!bsr_received && demux->lcid_most_data > 2) {
     // Add BSR to the LCID for which most data was received
-    sched->ul_buffer_add(rnti, lcid_most_data, 256);
+    sched->ul_buffer_add(rnti, demux->lcid_most_data, 256);
     Debug("BSR not received. Giving extra dci\n");
   }
 
+  pdus.deallocate(buffer);
+
   Debug("MAC PDU processed\n");
 }
 
@@ -337,6 +394,7 @@ void ue::deallocate_pdu(const uint32_t ue_cc_idx, const uint32_t tti)
 void ue::push_pdu(const uint32_t ue_cc_idx, const uint32_t tti, uint32_t len)
 {
   if (pending_buffers.at(ue_cc_idx).at(tti % nof_rx_harq_proc)) {
+    demux_pdu(pending_buffers.at(ue_cc_idx).at(tti % nof_rx_harq_proc), len);
     pdus.push(pending_buffers.at(ue_cc_idx).at(tti % nof_rx_harq_proc), len);
     pending_buffers.at(ue_cc_idx).at(tti % nof_rx_harq_proc) = nullptr;
   } else {
@@ -345,51 +403,42 @@ void ue::push_pdu(const uint32_t ue_cc_idx, const uint32_t tti, uint32_t len)
   }
 }
 
-bool ue::process_ce(srslte::sch_subh* subh)
+bool ue::process_ce(const ul_demux_t::ce_t& ce)
 {
-  uint32_t buff_size_idx[4]   = {};
-  uint32_t buff_size_bytes[4] = {};
-  float    phr                = 0;
-  int32_t  idx                = 0;
-  uint16_t old_rnti           = 0;
-  bool     is_bsr             = false;
-  switch (subh->ul_sch_ce_type()) {
+  bool is_bsr = false;
+  switch (ce.type) {
     case srslte::ul_sch_lcid::PHR_REPORT:
-      phr = subh->get_phr();
-      sched->ul_phr(rnti, (int)phr);
-      metrics_phr(phr);
+      sched->ul_phr(rnti, (int)ce.phr);
+      metrics_phr(ce.phr);
       break;
     case srslte::ul_sch_lcid::CRNTI:
-      old_rnti = subh->get_c_rnti();
-      if (sched->ue_exists(old_rnti)) {
-        rrc->upd_user(rnti, old_rnti);
-        rnti = old_rnti;
+      if (sched->ue_exists(ce.c_rnti)) {
+        rrc->upd_user(rnti, ce.c_rnti);
+        rnti = ce.c_rnti;
+        // The UE monitors the PDCCH for the C-RNTI until the contention resolution, regardless of DRX
+        sched->ul_sr_info(last_tti, rnti);
       } else {
-        Error("Updating user C-RNTI: rnti=0x%x already released\n", old_rnti);
+        Error("Updating user C-RNTI: rnti=0x%x already released\n", ce.c_rnti);
       }
       break;
     case srslte::ul_sch_lcid::TRUNC_BSR:
     case srslte::ul_sch_lcid::SHORT_BSR:
-      idx = subh->get_bsr(buff_size_idx, buff_size_bytes);
-      if (idx == -1) {
-        Error("Invalid Index Passed to lc groups\n");
-        break;
-      }
       // Indicate BSR to scheduler
-      sched->ul_bsr(rnti, idx, buff_size_bytes[idx]);
+      sched->ul_bsr(rnti, ce.bsr_lcg, ce.bsr_bytes[ce.bsr_lcg]);
+      metrics.ul_buffer[ce.bsr_lcg].store(ce.bsr_bytes[ce.bsr_lcg]);
       is_bsr = true;
       break;
     case srslte::ul_sch_lcid::LONG_BSR:
-      subh->get_bsr(buff_size_idx, buff_size_bytes);
-      for (idx = 0; idx < sched_interface::MAX_LC_GROUP; ++idx) {
-        sched->ul_bsr(rnti, idx, buff_size_bytes[idx]);
+      for (uint32_t lcg = 0; lcg < sched_interface::MAX_LC_GROUP; ++lcg) {
+        sched->ul_bsr(rnti, lcg, ce.bsr_bytes[lcg]);
+        metrics.ul_buffer[lcg].store(ce.bsr_bytes[lcg]);
       }
       is_bsr = true;
       break;
     case srslte::ul_sch_lcid::PADDING:
       break;
     default:
-      Error("CE:    Invalid lcid=0x%x\n", (int)subh->ul_sch_ce_type());
+      Error("CE:    Invalid lcid=0x%x\n", (int)ce.type);
       break;
   }
   return is_bsr;
@@ -465,8 +514,10 @@ void ue::allocate_ce(srslte::sch_pdu* pdu, uint32_t lcid)
         }
         if (enb_cc_idx == enb_ue_cc_map.size() and pdu->get()->set_scell_activation_cmd(active_scell_list)) {
           phy->set_activation_deactivation_scell(rnti, active_scell_list);
-          // Allocate and initialize Rx/Tx softbuffers for new carriers (exclude PCell)
-          allocate_cc_buffers(active_scell_list.size() - 1);
+          // Add the Rx/Tx softbuffer slots of the new carriers (exclude PCell)
+          if (softbuffer_tx.size() < active_scell_list.size()) {
+            allocate_cc_buffers(active_scell_list.size() - softbuffer_tx.size());
+          }
         } else {
           Error("CE:    Setting SCell Activation CE\n");
         }
@@ -492,6 +543,7 @@ uint8_t* ue::generate_pdu(uint32_t                        ue_cc_idx,
   if (rlc) {
     if (ue_cc_idx < SRSLTE_MAX_CARRIERS && harq_pid < SRSLTE_FDD_NOF_HARQ && tb_idx < SRSLTE_MAX_TB) {
       tx_payload_buffer[ue_cc_idx][harq_pid][tb_idx]->clear();
+      tx_payload_buffer[ue_cc_idx][harq_pid][tb_idx]->md.enqueue_ns = srslte::latency_clock_ns();
       mac_msg_dl.init_tx(tx_payload_buffer[ue_cc_idx][harq_pid][tb_idx].get(), grant_size, false);
       for (uint32_t i = 0; i < nof_pdu_elems; i++) {
         if (pdu[i].lcid <= (uint32_t)srslte::ul_sch_lcid::PHR_REPORT) {
@@ -540,45 +592,105 @@ uint8_t* ue::generate_mch_pdu(uint32_t                      harq_pid,
 }
 
 /******* METRICS interface ***************/
-void ue::metrics_read(mac_metrics_t* metrics_)
+static float metrics_average(srslte::metrics_counter<uint32_t>& sum, srslte::metrics_counter<uint32_t>& count)
 {
-  metrics.rnti      = rnti;
-  metrics.ul_buffer = sched->get_ul_buffer(rnti);
-  metrics.dl_buffer = sched->get_dl_buffer(rnti);
+  uint32_t n = count.read_and_reset();
+  uint32_t s = sum.read_and_reset();
+  return (n > 0) ? (float)s / n : 0.0f;
+}
 
-  memcpy(metrics_, &metrics, sizeof(mac_metrics_t));
+void ue::metrics_read(mac_metrics_t* metrics_)
+{
+  metrics_->rnti      = rnti;
+  metrics_->cc_idx    = metrics.pcell.load();
+  metrics_->nof_tti   = metrics.nof_tti.read_and_reset();
+  metrics_->tx_pkts   = metrics.tx_pkts.read_and_reset();
+  metrics_->tx_errors = metrics.tx_errors.read_and_reset();
+  metrics_->tx_brate  = metrics.tx_brate.read_and_reset();
+  metrics_->rx_pkts   = metrics.rx_pkts.read_and_reset();
+  metrics_->rx_errors = metrics.rx_errors.read_and_reset();
+  metrics_->rx_brate  = metrics.rx_brate.read_and_reset();
+  metrics_->dl_cqi    = metrics_average(metrics.dl_cqi_sum, metrics.dl_cqi_count);
+  metrics_->dl_ri     = metrics_average(metrics.dl_ri_sum, metrics.dl_ri_count);
+  metrics_->dl_pmi    = metrics_average(metrics.dl_pmi_sum, metrics.dl_pmi_count);
+
+  uint32_t nof_phr = metrics.phr_count.read_and_reset();
+  int      phr_sum = metrics.phr_sum.read_and_reset();
+  metrics_->phr    = (nof_phr > 0) ? (float)phr_sum / nof_phr : 0.0f;
+
+  metrics_->harq_ack_delay = metrics.harq_ack_delay.read_and_reset();
+
+  metrics_->dl_buffer = 0;
+  for (auto& b : metrics.dl_buffer) {
+    metrics_->dl_buffer += b.load();
+  }
+  metrics_->ul_buffer = 0;
+  for (auto& b : metrics.ul_buffer) {
+    metrics_->ul_buffer += b.load();
+  }
+}
 
-  phr_counter    = 0;
-  dl_cqi_counter = 0;
-  metrics        = {};
+/// The TB was acknowledged, counts the time since its MAC PDU was built
+void ue::metrics_dl_ack(uint32_t enb_cc_idx, uint32_t tti_ack, uint32_t tb_idx)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (enb_cc_idx >= dl_harq_tti.size() or tb_idx >= SRSLTE_MAX_TB) {
+    return;
+  }
+  const dl_harq_t& h = dl_harq_tti[enb_cc_idx][TTI_SUB(tti_ack, FDD_HARQ_DELAY_UL_MS) % SRSLTE_FDD_NOF_HARQ];
+  if (h.ue_cc_idx < tx_payload_buffer.size() and h.pid < SRSLTE_FDD_NOF_HARQ) {
+    const srslte::unique_byte_buffer_t& pdu = tx_payload_buffer[h.ue_cc_idx][h.pid][tb_idx];
+    if (pdu != nullptr) {
+      metrics.harq_ack_delay.observe_interval(pdu->md.enqueue_ns, srslte::latency_clock_ns());
+    }
+  }
 }
 
 void ue::metrics_phr(float phr)
 {
-  metrics.phr = SRSLTE_VEC_CMA(phr, metrics.phr, phr_counter);
-  phr_counter++;
+  // The reported power headroom is a whole number of dB
+  metrics.phr_sum += (int)phr;
+  metrics.phr_count++;
 }
 
 void ue::metrics_dl_ri(uint32_t dl_ri)
 {
-  if (metrics.dl_ri == 0.0f) {
-    metrics.dl_ri = (float)dl_ri + 1.0f;
-  } else {
-    metrics.dl_ri = SRSLTE_VEC_EMA((float)dl_ri + 1.0f, metrics.dl_ri, 0.5f);
-  }
-  dl_ri_counter++;
+  metrics.dl_ri_sum += dl_ri + 1;
+  metrics.dl_ri_count++;
 }
 
-void ue::metrics_dl_pmi(uint32_t dl_ri)
+void ue::metrics_dl_pmi(uint32_t dl_pmi)
 {
-  metrics.dl_pmi = SRSLTE_VEC_CMA((float)dl_ri, metrics.dl_pmi, dl_pmi_counter);
-  dl_pmi_counter++;
+  metrics.dl_pmi_sum += dl_pmi;
+  metrics.dl_pmi_count++;
 }
 
 void ue::metrics_dl_cqi(uint32_t dl_cqi)
 {
-  metrics.dl_cqi = SRSLTE_VEC_CMA((float)dl_cqi, metrics.dl_cqi, dl_cqi_counter);
-  dl_cqi_counter++;
+  metrics.dl_cqi_sum += dl_cqi;
+  metrics.dl_cqi_count++;
+}
+
+void ue::metrics_dl_buffer(uint32_t lcid, uint32_t buffer)
+{
+  if (lcid < metrics.dl_buffer.size()) {
+    metrics.dl_buffer[lcid].store(buffer);
+  }
+}
+
+bool ue::set_dl_buffer_state(uint32_t lcid, uint32_t tx_queue, uint32_t retx_queue)
+{
+  if (lcid >= dl_buffer_state.size()) {
+    return false;
+  }
+  dl_buffer_state[lcid].store((uint64_t)tx_queue << 32u | retx_queue, std::memory_order_release);
+  dl_buffer_dirty.fetch_or(1u << lcid, std::memory_order_release);
+  return true;
+}
+
+void ue::metrics_pcell(uint32_t enb_cc_idx)
+{
+  metrics.pcell.store(enb_cc_idx);
 }
 
 void ue::metrics_rx(bool crc, uint32_t tbs)
@@ -157,6 +157,14 @@ int rrc::ue::mac_controller::apply_basic_conn_cfg(const asn1::rrc::rr_cfg_ded_s&
   current_sched_ue_cfg.uci_offset.I_offset_ack = rrc_cfg->pusch_cfg.beta_offset_ack_idx;
   current_sched_ue_cfg.uci_offset.I_offset_ri  = rrc_cfg->pusch_cfg.beta_offset_ri_idx;
 
+  // DRX configuration, the scheduler follows the Active Time of the UE
+  current_sched_ue_cfg.drx_cfg = {};
+  if (rr_cfg.mac_main_cfg_present and
+      rr_cfg.mac_main_cfg.type().value == asn1::rrc::rr_cfg_ded_s::mac_main_cfg_c_::types::explicit_value and
+      rr_cfg.mac_main_cfg.explicit_value().drx_cfg_present) {
+    current_sched_ue_cfg.drx_cfg = srslte::make_drx_cfg(rr_cfg.mac_main_cfg.explicit_value().drx_cfg);
+  }
+
   // Configure MAC
   // In case of RRC Connection Setup/Reest message (Msg4), we need to resolve the contention by sending a ConRes CE
   mac->phy_config_enabled(rrc_ue->rnti, false);
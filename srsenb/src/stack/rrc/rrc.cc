@@ -37,10 +37,7 @@ using namespace asn1::rrc;
 
 namespace srsenb {
 
-rrc::rrc(srslte::task_sched_handle task_sched_) : rrc_log("RRC"), task_sched(task_sched_)
-{
-  pending_paging.clear();
-}
+rrc::rrc(srslte::task_sched_handle task_sched_) : rrc_log("RRC"), task_sched(task_sched_) {}
 
 rrc::~rrc() {}
 
@@ -76,6 +73,11 @@ void rrc::init(const rrc_cfg_t&       cfg_,
   nof_si_messages = generate_sibs();
   config_mac();
 
+  // Default paging cycle, should get DRX from user
+  uint32_t T  = cfg.sibs[1].sib2().rr_cfg_common.pcch_cfg.default_paging_cycle.to_number();
+  uint32_t Nb = T * cfg.sibs[1].sib2().rr_cfg_common.pcch_cfg.nb.to_number();
+  pager.reset(new paging_manager(T, Nb));
+
   // Check valid inactivity timeout config
   uint32_t t310 = cfg.sibs[1].sib2().ue_timers_and_consts.t310.to_number();
   uint32_t t311 = cfg.sibs[1].sib2().ue_timers_and_consts.t311.to_number();
@@ -117,6 +119,19 @@ void rrc::get_metrics(rrc_metrics_t& m)
   }
 }
 
+void rrc::set_cell_pci(uint32_t cell_id, uint32_t pci)
+{
+  // The common cell contexts refer to the cell configuration, the UEs see the new PCI from now on
+  auto it = std::find_if(
+      cfg.cell_list.begin(), cfg.cell_list.end(), [cell_id](const cell_cfg_t& c) { return c.cell_id == cell_id; });
+  if (it == cfg.cell_list.end()) {
+    rrc_log->error("Cell ID %d not found\n", cell_id);
+    return;
+  }
+  rrc_log->info("Cell ID %d PCI changed from %d to %d\n", cell_id, it->pci, pci);
+  it->pci = pci;
+}
+
 /*******************************************************************************
   MAC interface
 
@@ -318,18 +333,11 @@ bool rrc::release_erabs(uint32_t rnti)
 
 /*******************************************************************************
   Paging functions
-  These functions use a different mutex because access different shared variables
-  than user map
+  The paging records are stored by paging occasion, the TTI path doesn't lock
 *******************************************************************************/
 
 void rrc::add_paging_id(uint32_t ueid, const asn1::s1ap::ue_paging_id_c& ue_paging_id)
 {
-  std::lock_guard<std::mutex> lock(paging_mutex);
-  if (pending_paging.count(ueid) > 0) {
-    rrc_log->warning("Received Paging for UEID=%d but not yet transmitted\n", ueid);
-    return;
-  }
-
   paging_record_s paging_elem;
   if (ue_paging_id.type().value == asn1::s1ap::ue_paging_id_c::types_opts::imsi) {
     paging_elem.ue_id.set_imsi();
@@ -348,14 +356,14 @@ void rrc::add_paging_id(uint32_t ueid, const asn1::s1ap::ue_paging_id_c& ue_pagi
   }
   paging_elem.cn_domain = paging_record_s::cn_domain_e_::ps;
 
-  pending_paging.insert(std::make_pair(ueid, paging_elem));
+  if (not pager->add_paging_record(ueid, paging_elem)) {
+    rrc_log->warning("Received Paging for UEID=%d but not yet transmitted\n", ueid);
+  }
 }
 
 // Described in Section 7 of 36.304
 bool rrc::is_paging_opportunity(uint32_t tti, uint32_t* payload_len)
 {
-  constexpr static int sf_pattern[4][4] = {{9, 4, -1, 0}, {-1, 9, -1, 4}, {-1, -1, -1, 5}, {-1, -1, -1, 9}};
-
   if (tti == paging_tti) {
     *payload_len = byte_buf_paging.N_bytes;
     rrc_log->debug("Sending paging to extra carriers. Payload len=%d, TTI=%d\n", *payload_len, tti);
@@ -364,89 +372,31 @@ bool rrc::is_paging_opportunity(uint32_t tti, uint32_t* payload_len)
     paging_tti = INVALID_TTI;
   }
 
-  if (pending_paging.empty()) {
+  if (pager == nullptr or pager->pending_pcch_bytes(tti) == 0) {
     return false;
   }
 
   asn1::rrc::pcch_msg_s pcch_msg;
-  pcch_msg.msg.set_c1();
-  paging_s* paging_rec = &pcch_msg.msg.c1().paging();
-
-  // Default paging cycle, should get DRX from user
-  uint32_t T  = cfg.sibs[1].sib2().rr_cfg_common.pcch_cfg.default_paging_cycle.to_number();
-  uint32_t Nb = T * cfg.sibs[1].sib2().rr_cfg_common.pcch_cfg.nb.to_number();
-
-  uint32_t N   = T < Nb ? T : Nb;
-  uint32_t Ns  = Nb / T > 1 ? Nb / T : 1;
-  uint32_t sfn = tti / 10;
-
-  std::vector<uint32_t> ue_to_remove;
-
-  {
-    std::lock_guard<std::mutex> lock(paging_mutex);
-
-    int n = 0;
-    for (auto& item : pending_paging) {
-      if (n >= ASN1_RRC_MAX_PAGE_REC) {
-        break;
-      }
-      const asn1::rrc::paging_record_s& u    = item.second;
-      uint32_t                          ueid = ((uint32_t)item.first) % 1024;
-      uint32_t                          i_s  = (ueid / N) % Ns;
-
-      if ((sfn % T) != (T / N) * (ueid % N)) {
-        continue;
-      }
-
-      int sf_idx = sf_pattern[i_s % 4][(Ns - 1) % 4];
-      if (sf_idx < 0) {
-        rrc_log->error("SF pattern is N/A for Ns=%d, i_s=%d, imsi_decimal=%d\n", Ns, i_s, ueid);
-        continue;
-      }
-
-      if ((uint32_t)sf_idx == (tti % 10)) {
-        paging_rec->paging_record_list_present = true;
-        paging_rec->paging_record_list.push_back(u);
-        ue_to_remove.push_back(ueid);
-        n++;
-        rrc_log->info("Assembled paging for ue_id=%d, tti=%d\n", ueid, tti);
-      }
-    }
-
-    for (unsigned int i : ue_to_remove) {
-      pending_paging.erase(i);
-    }
+  uint32_t              nof_records = pager->pop_pcch(tti, &byte_buf_paging, &pcch_msg);
+  if (nof_records == 0) {
+    return false;
   }
 
-  if (paging_rec->paging_record_list.size() > 0) {
-    byte_buf_paging.clear();
-    asn1::bit_ref bref(byte_buf_paging.msg, byte_buf_paging.get_tailroom());
-    if (pcch_msg.pack(bref) == asn1::SRSASN_ERROR_ENCODE_FAIL) {
-      rrc_log->error("Failed to pack PCCH\n");
-      return false;
-    }
-    byte_buf_paging.N_bytes = (uint32_t)bref.distance_bytes();
-    uint32_t N_bits         = (uint32_t)bref.distance();
-
-    if (payload_len) {
-      *payload_len = byte_buf_paging.N_bytes;
-    }
-    rrc_log->info("Assembling PCCH payload with %d UE identities, payload_len=%d bytes, nbits=%d\n",
-                  paging_rec->paging_record_list.size(),
-                  byte_buf_paging.N_bytes,
-                  N_bits);
-    log_rrc_message("PCCH-Message", Tx, &byte_buf_paging, pcch_msg, pcch_msg.msg.c1().type().to_string());
-
-    paging_tti = tti; // Store paging tti for other carriers
-    return true;
+  if (payload_len) {
+    *payload_len = byte_buf_paging.N_bytes;
   }
+  rrc_log->info("Assembling PCCH payload with %d UE identities, payload_len=%d bytes, tti=%d\n",
+                nof_records,
+                byte_buf_paging.N_bytes,
+                tti);
+  log_rrc_message("PCCH-Message", Tx, &byte_buf_paging, pcch_msg, pcch_msg.msg.c1().type().to_string());
 
-  return false;
+  paging_tti = tti; // Store paging tti for other carriers
+  return true;
 }
 
 void rrc::read_pdu_pcch(uint8_t* payload, uint32_t buffer_size)
 {
-  std::lock_guard<std::mutex> lock(paging_mutex);
   if (byte_buf_paging.N_bytes <= buffer_size) {
     memcpy(payload, byte_buf_paging.msg, byte_buf_paging.N_bytes);
   }
@@ -40,6 +40,7 @@ asn1::rrc::security_algorithm_cfg_s security_cfg_handler::get_security_algorithm
 bool security_cfg_handler::set_security_capabilities(const asn1::s1ap::ue_security_cap_s& caps)
 {
   security_capabilities = caps;
+  ho_keys.present       = false;
 
   // Selects security algorithms (cipher_algo and integ_algo) based on capabilities and config preferences
   // Each position in the bitmap represents an encryption algorithm:
@@ -172,37 +173,53 @@ void security_cfg_handler::set_security_key(const asn1::fixed_bitstring<256, fal
   }
   log_h->info_hex(k_enb, 32, "Key eNodeB (k_enb)");
 
-  generate_as_keys();
+  generate_as_keys(k_enb, sec_cfg);
+  ho_keys.present = false;
 }
 
-void security_cfg_handler::generate_as_keys()
+void security_cfg_handler::generate_as_keys(uint8_t* key, srslte::as_security_config_t& as_cfg)
 {
+  as_cfg.cipher_algo = sec_cfg.cipher_algo;
+  as_cfg.integ_algo  = sec_cfg.integ_algo;
+
   // Generate K_rrc_enc and K_rrc_int
   srslte::security_generate_k_rrc(
-      k_enb, sec_cfg.cipher_algo, sec_cfg.integ_algo, sec_cfg.k_rrc_enc.data(), sec_cfg.k_rrc_int.data());
+      key, as_cfg.cipher_algo, as_cfg.integ_algo, as_cfg.k_rrc_enc.data(), as_cfg.k_rrc_int.data());
 
   // Generate K_up_enc and K_up_int
-  security_generate_k_up(
-      k_enb, sec_cfg.cipher_algo, sec_cfg.integ_algo, sec_cfg.k_up_enc.data(), sec_cfg.k_up_int.data());
+  security_generate_k_up(key, as_cfg.cipher_algo, as_cfg.integ_algo, as_cfg.k_up_enc.data(), as_cfg.k_up_int.data());
 
-  log_h->info_hex(k_enb, 32, "K_eNB (k_enb)");
-  log_h->info_hex(sec_cfg.k_rrc_enc.data(), 32, "RRC Encryption Key (k_rrc_enc)");
-  log_h->info_hex(sec_cfg.k_rrc_int.data(), 32, "RRC Integrity Key (k_rrc_int)");
-  log_h->info_hex(sec_cfg.k_up_enc.data(), 32, "UP Encryption Key (k_up_enc)");
+  log_h->info_hex(key, 32, "K_eNB (k_enb)");
+  log_h->info_hex(as_cfg.k_rrc_enc.data(), 32, "RRC Encryption Key (k_rrc_enc)");
+  log_h->info_hex(as_cfg.k_rrc_int.data(), 32, "RRC Integrity Key (k_rrc_int)");
+  log_h->info_hex(as_cfg.k_up_enc.data(), 32, "UP Encryption Key (k_up_enc)");
 }
 
-void security_cfg_handler::regenerate_keys_handover(uint32_t new_pci, uint32_t new_dl_earfcn)
+void security_cfg_handler::prepare_keys_handover(uint32_t new_pci, uint32_t new_dl_earfcn)
 {
-  log_h->info("Regenerating KeNB with PCI=0x%02x, DL-EARFCN=%d\n", new_pci, new_dl_earfcn);
+  if (ho_keys.present and ho_keys.pci == new_pci and ho_keys.dl_earfcn == new_dl_earfcn) {
+    return;
+  }
+  log_h->info("Preparing KeNB of PCI=0x%02x, DL-EARFCN=%d\n", new_pci, new_dl_earfcn);
   log_h->info_hex(k_enb, 32, "Old K_eNB (k_enb)");
   // Generate K_enb*
-  uint8_t k_enb_star[32];
-  srslte::security_generate_k_enb_star(k_enb, new_pci, new_dl_earfcn, k_enb_star);
+  srslte::security_generate_k_enb_star(k_enb, new_pci, new_dl_earfcn, ho_keys.k_enb);
+  generate_as_keys(ho_keys.k_enb, ho_keys.sec_cfg);
 
-  // K_enb becomes K_enb*
-  memcpy(k_enb, k_enb_star, 32);
+  ho_keys.present   = true;
+  ho_keys.pci       = new_pci;
+  ho_keys.dl_earfcn = new_dl_earfcn;
+}
+
+void security_cfg_handler::regenerate_keys_handover(uint32_t new_pci, uint32_t new_dl_earfcn)
+{
+  prepare_keys_handover(new_pci, new_dl_earfcn);
+  log_h->info("Regenerating KeNB with PCI=0x%02x, DL-EARFCN=%d\n", new_pci, new_dl_earfcn);
 
-  generate_as_keys();
+  // K_enb becomes K_enb*
+  memcpy(k_enb, ho_keys.k_enb, 32);
+  sec_cfg         = ho_keys.sec_cfg;
+  ho_keys.present = false;
 }
 
 /*****************************
@@ -20,6 +20,7 @@
  */
 
 #include "srsenb/hdr/stack/rrc/rrc_cell_cfg.h"
+#include "srslte/phy/ch_estimation/refsignal_ul.h"
 
 using namespace asn1::rrc;
 
@@ -158,6 +159,7 @@ cell_ctxt_dedicated_list::~cell_ctxt_dedicated_list()
     dealloc_cqi_resources(c.ue_cc_idx);
   }
   dealloc_sr_resources();
+  dealloc_srs_resources();
   dealloc_pucch_cs_resources();
 }
 
@@ -208,6 +210,7 @@ bool cell_ctxt_dedicated_list::rem_last_cell()
   uint32_t ue_cc_idx = cell_ded_list.size() - 1;
   if (ue_cc_idx == UE_PCELL_CC_IDX) {
     dealloc_sr_resources();
+    dealloc_srs_resources();
     dealloc_pucch_cs_resources();
   }
   dealloc_cqi_resources(ue_cc_idx);
@@ -230,6 +233,10 @@ bool cell_ctxt_dedicated_list::alloc_cell_resources(uint32_t ue_cc_idx)
         return false;
       }
     }
+    // SRS is optional, the UE is still admitted without it when the cell sounding capacity is exhausted
+    if (cfg.srs_cfg.enabled and not alloc_srs_resources(cfg.srs_cfg.period)) {
+      log_h->warning("Failed to allocate SRS resources for PCell, the UE will not be sounded\n");
+    }
   }
   if (not alloc_cqi_resources(ue_cc_idx, cfg.cqi_cfg.period)) {
     log_h->error("Failed to allocate CQIresources for cell ue_cc_idx=%d\n", ue_cc_idx);
@@ -504,6 +511,70 @@ bool cell_ctxt_dedicated_list::dealloc_sr_resources()
   return false;
 }
 
+bool cell_ctxt_dedicated_list::alloc_srs_resources(uint32_t period)
+{
+  if (srs_res_present) {
+    log_h->error("The user srs resources are already allocated\n");
+    return false;
+  }
+  if (period < 2 or period > pucch_res_common::N_SRS_MAX_OFFSET) {
+    log_h->error("Invalid SRS period %d ms\n", period);
+    return false;
+  }
+
+  // Find the offset with the least number of users whose subframes are all cell SRS subframes
+  int      offset_min = -1;
+  uint32_t min_users  = pucch_res_common::N_SRS_SLOTS;
+  for (uint32_t offset = 0; offset < period; offset++) {
+    bool valid = true;
+    for (uint32_t sf = offset % 10; sf < 10 and valid; sf += SRSLTE_MIN(period, 10)) {
+      valid = srslte_refsignal_srs_send_cs(cfg.srs_cfg.sf_cfg, sf) == 1;
+    }
+    uint32_t nof_users = __builtin_popcount(pucch_res->srs_used[offset]);
+    if (valid and nof_users < min_users) {
+      offset_min = offset;
+      min_users  = nof_users;
+    }
+  }
+  if (offset_min < 0) {
+    log_h->warning("Not enough SRS resources for period=%d and subframe_cfg=%d\n", period, cfg.srs_cfg.sf_cfg);
+    return false;
+  }
+
+  // Take the first free transmission comb/cyclic shift slot, alternating combs first
+  uint32_t slot = 0;
+  while (pucch_res->srs_used[offset_min] & (1u << slot)) {
+    slot++;
+  }
+  pucch_res->srs_used[offset_min] |= (1u << slot);
+
+  // Compute I_srs, 36.213 Table 8.2-1
+  srs_res.offset       = offset_min;
+  srs_res.slot         = slot;
+  srs_res.I_srs        = (period == 2 ? 0 : period - 3) + offset_min;
+  srs_res.tx_comb      = slot % 2;
+  srs_res.cyclic_shift = slot / 2;
+  srs_res_present      = true;
+
+  log_h->info("Allocated SRS resources I_srs=%d, tx_comb=%d, cyclic_shift=%d\n",
+              srs_res.I_srs,
+              srs_res.tx_comb,
+              srs_res.cyclic_shift);
+
+  return true;
+}
+
+bool cell_ctxt_dedicated_list::dealloc_srs_resources()
+{
+  if (srs_res_present) {
+    pucch_res->srs_used[srs_res.offset] &= ~(1u << srs_res.slot);
+    srs_res_present = false;
+    log_h->info("Deallocated SRS resources I_srs=%d\n", srs_res.I_srs);
+    return true;
+  }
+  return false;
+}
+
 bool cell_ctxt_dedicated_list::alloc_pucch_cs_resources()
 {
   cell_ctxt_dedicated* cell = get_ue_cc_idx(UE_PCELL_CC_IDX);
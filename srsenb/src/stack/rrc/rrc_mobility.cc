@@ -632,6 +632,14 @@ void rrc::ue::rrc_mobility::handle_ue_meas_report(const meas_report_s& msg)
       continue;
     }
 
+    // The keys of the eNB cells reported above the threshold are derived before the handover is decided
+    int prep_thres = pcell->cell_common->cell_cfg.meas_cfg.ho_prep_rsrp_thres;
+    if (c != nullptr and prep_thres >= 0 and e.meas_result.rsrp_result_present and
+        e.meas_result.rsrp_result >= prep_thres and rrc_ue->ue_security_cfg.is_as_sec_cfg_valid() and
+        rrc_details::eci_to_enbid(meas_ev.target_eci) == rrc_enb->cfg.enb_id) {
+      rrc_ue->ue_security_cfg.prepare_keys_handover(c->cell_cfg.pci, c->cell_cfg.dl_earfcn);
+    }
+
     // eNB found the respective cell. eNB takes "HO Decision"
     // NOTE: From now we just choose the strongest.
     if (trigger(meas_ev)) {
@@ -1337,6 +1345,9 @@ void rrc::ue::rrc_mobility::intraenb_ho_st::enter(rrc_mobility* f, const ho_meas
   dl_dcch_msg_s dl_dcch_msg;
   f->fill_mobility_reconf_common(dl_dcch_msg, *target_cell, source_cell->cell_cfg.dl_earfcn);
 
+  // Derive the keys of the target cell now, so that only the activation is left for when the UE reaches it
+  f->rrc_ue->ue_security_cfg.prepare_keys_handover(target_cell->cell_cfg.pci, target_cell->cell_cfg.dl_earfcn);
+
   // Apply changes to the MAC scheduler
   f->rrc_ue->mac_ctrl->handle_intraenb_ho_cmd(dl_dcch_msg.msg.c1().rrc_conn_recfg().crit_exts.c1().rrc_conn_recfg_r8());
 
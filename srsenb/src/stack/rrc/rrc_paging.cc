@@ -0,0 +1,149 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/rrc/rrc_paging.h"
+#include <algorithm>
+
+using namespace asn1::rrc;
+
+namespace srsenb {
+
+// Subframe of the paging occasion i_s for each value of Ns, TS 36.304 Section 7.2
+constexpr static int sf_pattern[4][4] = {{9, 4, -1, 0}, {-1, 9, -1, 4}, {-1, -1, -1, 5}, {-1, -1, -1, 9}};
+
+// Upper bound of a PCCH message with the maximum number of IMSI records
+constexpr static uint32_t max_pcch_bytes = 1024;
+
+paging_manager::paging_manager(uint32_t T_, uint32_t Nb) :
+  T(T_),
+  N(std::max(1u, std::min(T_, Nb))),
+  Ns(std::max(1u, Nb / T_)),
+  occasions(T_ * Ns)
+{
+  for (int& i_s : sf_to_is) {
+    i_s = -1;
+  }
+  for (uint32_t i_s = 0; i_s < Ns; i_s++) {
+    int sf_idx = sf_pattern[i_s % 4][(Ns - 1) % 4];
+    if (sf_idx >= 0) {
+      sf_to_is[sf_idx] = i_s;
+    }
+  }
+}
+
+bool paging_manager::add_paging_record(uint32_t ueid, const paging_record_s& record)
+{
+  ueid         = ueid % 1024;
+  uint32_t i_s = (ueid / N) % Ns;
+  if (sf_pattern[i_s % 4][(Ns - 1) % 4] < 0) {
+    return false;
+  }
+  uint32_t           pf       = (T / N) * (ueid % N);
+  paging_occasion_t& occasion = occasions[pf * Ns + i_s];
+
+  std::lock_guard<std::mutex> lock(occasion.mutex);
+  if (std::find(occasion.ueids.begin(), occasion.ueids.end(), ueid) != occasion.ueids.end()) {
+    return false;
+  }
+  occasion.ueids.push_back(ueid);
+  occasion.records.push_back(record);
+  occasion.pack();
+  nof_pending++;
+  return true;
+}
+
+int paging_manager::occasion_idx(uint32_t tti) const
+{
+  int i_s = sf_to_is[tti % 10];
+  if (i_s < 0) {
+    return -1;
+  }
+  return (tti / 10 % T) * Ns + i_s;
+}
+
+uint32_t paging_manager::pending_pcch_bytes(uint32_t tti) const
+{
+  int idx = occasion_idx(tti);
+  if (idx < 0) {
+    return 0;
+  }
+  return occasions[idx].nof_bytes;
+}
+
+uint32_t paging_manager::pop_pcch(uint32_t tti, srslte::byte_buffer_t* pdu, pcch_msg_s* msg)
+{
+  int idx = occasion_idx(tti);
+  if (idx < 0 or occasions[idx].nof_bytes == 0) {
+    return 0;
+  }
+  paging_occasion_t& occasion = occasions[idx];
+
+  // Records being added are sent in the next paging cycle, the TTI can't wait
+  std::unique_lock<std::mutex> lock(occasion.mutex, std::try_to_lock);
+  if (not lock.owns_lock() or occasion.pdu.size() > pdu->get_tailroom()) {
+    return 0;
+  }
+  pdu->clear();
+  memcpy(pdu->msg, occasion.pdu.data(), occasion.pdu.size());
+  pdu->N_bytes = occasion.pdu.size();
+
+  uint32_t nof_sent = std::min((uint32_t)occasion.records.size(), (uint32_t)ASN1_RRC_MAX_PAGE_REC);
+  if (msg != nullptr) {
+    paging_s& paging                  = msg->msg.set_c1().paging();
+    paging.paging_record_list_present = true;
+    paging.paging_record_list.resize(nof_sent);
+    std::copy(occasion.records.begin(), occasion.records.begin() + nof_sent, paging.paging_record_list.begin());
+  }
+
+  occasion.ueids.erase(occasion.ueids.begin(), occasion.ueids.begin() + nof_sent);
+  occasion.records.erase(occasion.records.begin(), occasion.records.begin() + nof_sent);
+  occasion.pack();
+  nof_pending -= nof_sent;
+  return nof_sent;
+}
+
+void paging_manager::paging_occasion_t::pack()
+{
+  if (records.empty()) {
+    pdu.clear();
+    nof_bytes = 0;
+    return;
+  }
+
+  pcch_msg_s pcch_msg;
+  paging_s&  paging                 = pcch_msg.msg.set_c1().paging();
+  uint32_t   nof_records            = std::min((uint32_t)records.size(), (uint32_t)ASN1_RRC_MAX_PAGE_REC);
+  paging.paging_record_list_present = true;
+  paging.paging_record_list.resize(nof_records);
+  std::copy(records.begin(), records.begin() + nof_records, paging.paging_record_list.begin());
+
+  pdu.resize(max_pcch_bytes);
+  asn1::bit_ref bref(pdu.data(), pdu.size());
+  if (pcch_msg.pack(bref) != asn1::SRSASN_SUCCESS) {
+    pdu.clear();
+    nof_bytes = 0;
+    return;
+  }
+  pdu.resize(bref.distance_bytes());
+  nof_bytes = pdu.size();
+}
+
+} // namespace srsenb
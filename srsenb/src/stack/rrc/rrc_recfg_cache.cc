@@ -0,0 +1,201 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/rrc/rrc_recfg_cache.h"
+
+using namespace asn1;
+using namespace asn1::rrc;
+
+namespace srsenb {
+
+using cqi_setup_t = cqi_report_periodic_c::setup_s_;
+
+/// CQI fields of the UE in the radioResourceConfigDedicated, with their size in bits (TS 36.331 CQI-ReportPeriodic)
+struct cqi_field_t {
+  uint16_t cqi_setup_t::*value;
+  uint32_t               nof_bits;
+};
+static const cqi_field_t cqi_fields[] = {{&cqi_setup_t::cqi_pucch_res_idx, 11},
+                                         {&cqi_setup_t::cqi_pmi_cfg_idx, 10},
+                                         {&cqi_setup_t::ri_cfg_idx, 10}};
+
+static const cqi_setup_t* get_cqi_setup(const rr_cfg_ded_s& rr_cfg_ded)
+{
+  if (not rr_cfg_ded.phys_cfg_ded_present or not rr_cfg_ded.phys_cfg_ded.cqi_report_cfg_present or
+      not rr_cfg_ded.phys_cfg_ded.cqi_report_cfg.cqi_report_periodic_present or
+      rr_cfg_ded.phys_cfg_ded.cqi_report_cfg.cqi_report_periodic.type().value != setup_opts::setup) {
+    return nullptr;
+  }
+  return &rr_cfg_ded.phys_cfg_ded.cqi_report_cfg.cqi_report_periodic.setup();
+}
+
+static uint32_t nof_cqi_fields(const cqi_setup_t* setup)
+{
+  return setup == nullptr ? 0 : (setup->ri_cfg_idx_present ? 3 : 2);
+}
+
+static void write_bits(uint8_t* buf, uint32_t offset, uint32_t nof_bits, uint32_t value)
+{
+  for (uint32_t i = 0; i < nof_bits; i++) {
+    uint32_t pos = offset + i;
+    uint8_t  bit = (value >> (nof_bits - 1 - i)) & 1u;
+    buf[pos / 8] = (uint8_t)((buf[pos / 8] & ~(0x80u >> (pos % 8))) | (bit << (7 - pos % 8)));
+  }
+}
+
+static bool pack_standalone(const rr_cfg_ded_s& rr_cfg_ded, std::vector<uint8_t>& bytes, uint32_t& nof_bits)
+{
+  bytes.assign(SRSLTE_MAX_BUFFER_SIZE_BYTES, 0);
+  bit_ref bref(bytes.data(), bytes.size());
+  if (rr_cfg_ded.pack(bref) != SRSASN_SUCCESS) {
+    return false;
+  }
+  nof_bits = bref.distance();
+  bytes.resize((nof_bits + 7) / 8);
+  return true;
+}
+
+bool recfg_template_cache::create_template(const rr_cfg_ded_s& rr_cfg_ded, template_t& t)
+{
+  if (not pack_standalone(rr_cfg_ded, t.bytes, t.nof_bits)) {
+    return false;
+  }
+
+  // The fields have a fixed size, so the packing with the last bit of one field flipped only differs in that bit
+  const cqi_setup_t* setup = get_cqi_setup(rr_cfg_ded);
+  for (uint32_t i = 0; i < nof_cqi_fields(setup); ++i) {
+    rr_cfg_ded_s copy = rr_cfg_ded;
+    copy.phys_cfg_ded.cqi_report_cfg.cqi_report_periodic.setup().*cqi_fields[i].value ^= 1u;
+
+    std::vector<uint8_t> bytes;
+    uint32_t             nof_bits = 0;
+    if (not pack_standalone(copy, bytes, nof_bits) or nof_bits != t.nof_bits) {
+      return false;
+    }
+    uint32_t nof_diffs = 0, last_bit = 0;
+    for (uint32_t b = 0; b < t.nof_bits; ++b) {
+      if (((bytes[b / 8] ^ t.bytes[b / 8]) >> (7 - b % 8)) & 1u) {
+        nof_diffs++;
+        last_bit = b;
+      }
+    }
+    if (nof_diffs != 1 or last_bit + 1 < cqi_fields[i].nof_bits) {
+      return false;
+    }
+    t.fields.push_back({last_bit + 1 - cqi_fields[i].nof_bits, cqi_fields[i].nof_bits});
+  }
+  return true;
+}
+
+recfg_template_cache::template_t* recfg_template_cache::get_template(const std::string&  profile,
+                                                                    const rr_cfg_ded_s& rr_cfg_ded)
+{
+  auto it = templates.find(profile);
+  if (it != templates.end()) {
+    // the profile of the UEs without periodic CQI doesn't depend on the CQI configuration
+    if (it->second.fields.size() != nof_cqi_fields(get_cqi_setup(rr_cfg_ded))) {
+      return nullptr;
+    }
+    hits++;
+    return &it->second;
+  }
+  if (templates.size() >= max_templates) {
+    return nullptr;
+  }
+  template_t t;
+  if (not create_template(rr_cfg_ded, t)) {
+    return nullptr;
+  }
+  return &templates.emplace(profile, std::move(t)).first->second;
+}
+
+SRSASN_CODE
+recfg_template_cache::pack_rr_cfg_ded(bit_ref& bref, const template_t& t, const rr_cfg_ded_s& rr_cfg_ded)
+{
+  scratch = t.bytes;
+
+  const cqi_setup_t* setup = get_cqi_setup(rr_cfg_ded);
+  for (uint32_t i = 0; i < t.fields.size(); ++i) {
+    write_bits(scratch.data(), t.fields[i].offset, t.fields[i].nof_bits, setup->*cqi_fields[i].value);
+  }
+
+  HANDLE_CODE(bref.pack_bytes(scratch.data(), t.nof_bits / 8));
+  if (t.nof_bits % 8 > 0) {
+    HANDLE_CODE(bref.pack(scratch[t.nof_bits / 8] >> (8 - t.nof_bits % 8), t.nof_bits % 8));
+  }
+  return SRSASN_SUCCESS;
+}
+
+bool recfg_template_cache::pack(const std::string& profile, const dl_dcch_msg_s& msg, srslte::byte_buffer_t* pdu)
+{
+  bit_ref bref(pdu->msg, pdu->get_tailroom());
+
+  const rrc_conn_recfg_s&        recfg = msg.msg.c1().rrc_conn_recfg();
+  const rrc_conn_recfg_r8_ies_s& r8    = recfg.crit_exts.c1().rrc_conn_recfg_r8();
+  const template_t*              t     = r8.rr_cfg_ded_present ? get_template(profile, r8.rr_cfg_ded) : nullptr;
+  if (t == nullptr) {
+    if (msg.pack(bref) != SRSASN_SUCCESS) {
+      return false;
+    }
+    pdu->N_bytes = (uint32_t)bref.distance_bytes();
+    return true;
+  }
+
+  // Same as the generated packing, down to the RRCConnectionReconfiguration-r8-IEs
+  auto pack_msg = [&]() -> SRSASN_CODE {
+    HANDLE_CODE(msg.msg.type().pack(bref));
+    HANDLE_CODE(msg.msg.c1().type().pack(bref));
+    HANDLE_CODE(pack_integer(bref, recfg.rrc_transaction_id, (uint8_t)0u, (uint8_t)3u));
+    HANDLE_CODE(recfg.crit_exts.type().pack(bref));
+    HANDLE_CODE(recfg.crit_exts.c1().type().pack(bref));
+
+    HANDLE_CODE(bref.pack(r8.meas_cfg_present, 1));
+    HANDLE_CODE(bref.pack(r8.mob_ctrl_info_present, 1));
+    HANDLE_CODE(bref.pack(r8.ded_info_nas_list_present, 1));
+    HANDLE_CODE(bref.pack(r8.rr_cfg_ded_present, 1));
+    HANDLE_CODE(bref.pack(r8.security_cfg_ho_present, 1));
+    HANDLE_CODE(bref.pack(r8.non_crit_ext_present, 1));
+    if (r8.meas_cfg_present) {
+      HANDLE_CODE(r8.meas_cfg.pack(bref));
+    }
+    if (r8.mob_ctrl_info_present) {
+      HANDLE_CODE(r8.mob_ctrl_info.pack(bref));
+    }
+    if (r8.ded_info_nas_list_present) {
+      HANDLE_CODE(pack_dyn_seq_of(bref, r8.ded_info_nas_list, 1, 11));
+    }
+    HANDLE_CODE(pack_rr_cfg_ded(bref, *t, r8.rr_cfg_ded));
+    if (r8.security_cfg_ho_present) {
+      HANDLE_CODE(r8.security_cfg_ho.pack(bref));
+    }
+    if (r8.non_crit_ext_present) {
+      HANDLE_CODE(r8.non_crit_ext.pack(bref));
+    }
+    return bref.align_bytes_zero();
+  };
+  if (pack_msg() != SRSASN_SUCCESS) {
+    return false;
+  }
+  pdu->N_bytes = (uint32_t)bref.distance_bytes();
+  return true;
+}
+
+} // namespace srsenb
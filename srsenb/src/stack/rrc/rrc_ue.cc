@@ -59,9 +59,18 @@ rrc::ue::ue(rrc* outer_rrc, uint16_t rnti_, const sched_interface::ue_cfg_t& sch
   set_activity_timeout(MSG3_RX_TIMEOUT); // next UE response is Msg3
 
   mobility_handler.reset(new rrc_mobility(this));
+
+  ul_dcch_rx.reset(new ul_dcch_rx_queue_t);
+  ul_dcch_rx->user = this;
 }
 
-rrc::ue::~ue() {}
+rrc::ue::~ue()
+{
+  // Drop the UL-DCCH messages still being decoded
+  if (ul_dcch_rx != nullptr) {
+    ul_dcch_rx->user = nullptr;
+  }
+}
 
 rrc_state_t rrc::ue::get_state()
 {
@@ -138,16 +147,78 @@ void rrc::ue::parse_ul_dcch(uint32_t lcid, srslte::unique_byte_buffer_t pdu)
 {
   set_activity();
 
-  ul_dcch_msg_s  ul_dcch_msg;
-  asn1::cbit_ref bref(pdu->msg, pdu->N_bytes);
-  if (ul_dcch_msg.unpack(bref) != asn1::SRSASN_SUCCESS or
-      ul_dcch_msg.msg.type().value != ul_dcch_msg_type_c::types_opts::c1) {
+  std::shared_ptr<ul_dcch_rx_t> rx(new ul_dcch_rx_t);
+  rx->lcid     = lcid;
+  rx->pdu      = std::move(pdu);
+  uint32_t idx = ul_dcch_rx->next_idx++;
+
+  // Short messages cost less to decode here than to hand over, as long as they do not overtake an earlier one
+  if (rx->pdu->N_bytes < ul_dcch_bg_min_len and ul_dcch_rx->next_rx == idx) {
+    decode_ul_dcch(*rx);
+    ul_dcch_decoded(idx, std::move(rx));
+    return;
+  }
+
+  std::shared_ptr<ul_dcch_rx_queue_t> queue = ul_dcch_rx;
+  srslte::task_sched_handle           sched = parent->task_sched;
+  sched.enqueue_background_task([queue, rx, idx, sched](uint32_t worker_id) mutable {
+    decode_ul_dcch(*rx);
+    sched.notify_background_task_result([queue, rx, idx]() {
+      if (queue->user != nullptr) {
+        queue->user->ul_dcch_decoded(idx, rx);
+      }
+    });
+  });
+}
+
+/// Unpacks the message, and the EUTRA capabilities of a UECapabilityInformation. Runs in the background task pool, so
+/// it only touches rx
+void rrc::ue::decode_ul_dcch(ul_dcch_rx_t& rx)
+{
+  asn1::cbit_ref bref(rx.pdu->msg, rx.pdu->N_bytes);
+  rx.unpacked = rx.msg.unpack(bref) == asn1::SRSASN_SUCCESS and
+                rx.msg.msg.type().value == ul_dcch_msg_type_c::types_opts::c1;
+  if (not rx.unpacked or rx.msg.msg.c1().type() != ul_dcch_msg_type_c::c1_c_::types::ue_cap_info) {
+    return;
+  }
+
+  ue_cap_info_s& ue_cap_info = rx.msg.msg.c1().ue_cap_info();
+  if (ue_cap_info.crit_exts.type() != ue_cap_info_s::crit_exts_c_::types::c1 or
+      ue_cap_info.crit_exts.c1().type() != ue_cap_info_s::crit_exts_c_::c1_c_::types::ue_cap_info_r8) {
+    return;
+  }
+  ue_cap_rat_container_list_l& containers = ue_cap_info.crit_exts.c1().ue_cap_info_r8().ue_cap_rat_container_list;
+  if (containers.size() > 0 and containers[0].rat_type == rat_type_e::eutra) {
+    asn1::cbit_ref cap_bref(containers[0].ue_cap_rat_container.data(), containers[0].ue_cap_rat_container.size());
+    rx.eutra_cap_unpacked = rx.eutra_cap.unpack(cap_bref) == asn1::SRSASN_SUCCESS;
+  }
+}
+
+void rrc::ue::ul_dcch_decoded(uint32_t idx, std::shared_ptr<ul_dcch_rx_t> rx)
+{
+  // Keep the queue, handling a message may remove the UE
+  std::shared_ptr<ul_dcch_rx_queue_t> queue = ul_dcch_rx;
+  queue->done.emplace(idx, std::move(rx));
+  for (auto it = queue->done.find(queue->next_rx); queue->user != nullptr and it != queue->done.end();
+       it      = queue->done.find(queue->next_rx)) {
+    std::shared_ptr<ul_dcch_rx_t> next = std::move(it->second);
+    queue->done.erase(it);
+    queue->next_rx++;
+    queue->user->handle_ul_dcch(*next);
+  }
+}
+
+void rrc::ue::handle_ul_dcch(ul_dcch_rx_t& rx)
+{
+  ul_dcch_msg_s&               ul_dcch_msg = rx.msg;
+  srslte::unique_byte_buffer_t pdu         = std::move(rx.pdu);
+  if (not rx.unpacked) {
     parent->rrc_log->error("Failed to unpack UL-DCCH message\n");
     return;
   }
 
   parent->log_rrc_message(
-      srsenb::to_string((rb_id_t)lcid), Rx, pdu.get(), ul_dcch_msg, ul_dcch_msg.msg.c1().type().to_string());
+      srsenb::to_string((rb_id_t)rx.lcid), Rx, pdu.get(), ul_dcch_msg, ul_dcch_msg.msg.c1().type().to_string());
 
   // reuse PDU
   pdu->clear(); // TODO: name collision with byte_buffer reset
@@ -193,7 +264,7 @@ void rrc::ue::parse_ul_dcch(uint32_t lcid, srslte::unique_byte_buffer_t pdu)
       handle_security_mode_failure(&ul_dcch_msg.msg.c1().security_mode_fail());
       break;
     case ul_dcch_msg_type_c::c1_c_::types::ue_cap_info:
-      if (handle_ue_cap_info(&ul_dcch_msg.msg.c1().ue_cap_info())) {
+      if (handle_ue_cap_info(&ul_dcch_msg.msg.c1().ue_cap_info(), rx.eutra_cap_unpacked ? &rx.eutra_cap : nullptr)) {
         notify_s1ap_ue_ctxt_setup_complete();
         send_connection_reconf(std::move(pdu));
         state = RRC_STATE_WAIT_FOR_CON_RECONF_COMPLETE;
@@ -587,7 +658,7 @@ void rrc::ue::send_connection_reconf(srslte::unique_byte_buffer_t pdu)
   // Reuse same PDU
   pdu->clear();
 
-  send_dl_dcch(&dl_dcch_msg, std::move(pdu));
+  send_dl_dcch_recfg(&dl_dcch_msg, std::move(pdu));
 
   state = RRC_STATE_WAIT_FOR_CON_RECONF_COMPLETE;
 }
@@ -664,7 +735,7 @@ void rrc::ue::send_connection_reconf_new_bearer()
   bearer_list.fill_pending_nas_info(conn_reconf);
 
   if (conn_reconf->rr_cfg_ded_present or conn_reconf->ded_info_nas_list_present) {
-    send_dl_dcch(&dl_dcch_msg);
+    send_dl_dcch_recfg(&dl_dcch_msg);
   }
 }
 
@@ -737,7 +808,7 @@ void rrc::ue::send_ue_cap_enquiry()
   send_dl_dcch(&dl_dcch_msg);
 }
 
-bool rrc::ue::handle_ue_cap_info(ue_cap_info_s* msg)
+bool rrc::ue::handle_ue_cap_info(ue_cap_info_s* msg, ue_eutra_cap_s* eutra_cap)
 {
   parent->rrc_log->info("UECapabilityInformation transaction ID: %d\n", msg->rrc_transaction_id);
   ue_cap_info_r8_ies_s* msg_r8 = &msg->crit_exts.c1().ue_cap_info_r8();
@@ -747,11 +818,16 @@ bool rrc::ue::handle_ue_cap_info(ue_cap_info_s* msg)
       parent->rrc_log->warning("Not handling UE capability information for RAT type %s\n",
                                msg_r8->ue_cap_rat_container_list[i].rat_type.to_string().c_str());
     } else {
-      asn1::cbit_ref bref(msg_r8->ue_cap_rat_container_list[0].ue_cap_rat_container.data(),
-                          msg_r8->ue_cap_rat_container_list[0].ue_cap_rat_container.size());
-      if (eutra_capabilities.unpack(bref) != asn1::SRSASN_SUCCESS) {
-        parent->rrc_log->error("Failed to unpack EUTRA capabilities message\n");
-        return false;
+      if (eutra_cap != nullptr) {
+        // Already unpacked with the message
+        eutra_capabilities = std::move(*eutra_cap);
+      } else {
+        asn1::cbit_ref bref(msg_r8->ue_cap_rat_container_list[0].ue_cap_rat_container.data(),
+                            msg_r8->ue_cap_rat_container_list[0].ue_cap_rat_container.size());
+        if (eutra_capabilities.unpack(bref) != asn1::SRSASN_SUCCESS) {
+          parent->rrc_log->error("Failed to unpack EUTRA capabilities message\n");
+          return false;
+        }
       }
       if (parent->rrc_log->get_level() == srslte::LOG_LEVEL_DEBUG) {
         asn1::json_writer js{};
@@ -1221,6 +1297,8 @@ void rrc::ue::fill_rrc_setup_rr_config_dedicated(asn1::rrc::rr_cfg_ded_s* rr_cfg
   mac_cfg->ul_sch_cfg           = parent->cfg.mac_cnfg.ul_sch_cfg;
   mac_cfg->phr_cfg_present      = true;
   mac_cfg->phr_cfg              = parent->cfg.mac_cnfg.phr_cfg;
+  mac_cfg->drx_cfg_present      = parent->cfg.mac_cnfg.drx_cfg_present;
+  mac_cfg->drx_cfg              = parent->cfg.mac_cnfg.drx_cfg;
   mac_cfg->time_align_timer_ded = parent->cfg.mac_cnfg.time_align_timer_ded;
 
   // Fill physicalConfigDedicated
@@ -1253,6 +1331,21 @@ void rrc::ue::fill_rrc_setup_rr_config_dedicated(asn1::rrc::rr_cfg_ded_s* rr_cfg
   phy_cfg->ul_pwr_ctrl_ded.p0_ue_pucch          = 0;
   phy_cfg->ul_pwr_ctrl_ded.psrs_offset          = 3;
 
+  // Periodic SRS on the PCell, if the cell has the sounding capacity left for this UE
+  const cell_ctxt_dedicated_list::srs_res_t* srs_res = cell_ded_list.get_srs_res();
+  if (srs_res != nullptr) {
+    phy_cfg->srs_ul_cfg_ded_present = true;
+    srs_ul_cfg_ded_c::setup_s_& srs = phy_cfg->srs_ul_cfg_ded.set_setup();
+    srs.srs_bw.value                = (srs_ul_cfg_ded_c::setup_s_::srs_bw_opts::options)parent->cfg.srs_cfg.bw;
+    // b_hop=0 makes a narrow SRS (bw > 0) hop across the whole cell SRS bandwidth
+    srs.srs_hop_bw.value            = srs_ul_cfg_ded_c::setup_s_::srs_hop_bw_opts::hbw0;
+    srs.freq_domain_position        = 0;
+    srs.dur                         = true;
+    srs.srs_cfg_idx                 = srs_res->I_srs;
+    srs.tx_comb                     = srs_res->tx_comb;
+    srs.cyclic_shift.value          = (srs_ul_cfg_ded_c::setup_s_::cyclic_shift_opts::options)srs_res->cyclic_shift;
+  }
+
   // PDSCH
   phy_cfg->pdsch_cfg_ded_present = true;
   phy_cfg->pdsch_cfg_ded.p_a     = parent->cfg.pdsch_cfg;
@@ -1317,16 +1410,27 @@ bool rrc::ue::send_dl_dcch(const dl_dcch_msg_s* dl_dcch_msg, srslte::unique_byte
       return false;
     }
     pdu->N_bytes = (uint32_t)bref.distance_bytes();
+    send_packed_dl_dcch(dl_dcch_msg, std::move(pdu));
+  } else {
+    parent->rrc_log->error("Allocating pdu\n");
+    return false;
+  }
+  return true;
+}
 
-    // send on SRB2 if user is fully registered (after RRC reconfig complete)
-    uint32_t lcid =
-        parent->rlc->has_bearer(rnti, RB_ID_SRB2) && state == RRC_STATE_REGISTERED ? RB_ID_SRB2 : RB_ID_SRB1;
-
-    char buf[32] = {};
-    sprintf(buf, "SRB%d - rnti=0x%x", lcid, rnti);
-    parent->log_rrc_message(buf, Tx, pdu.get(), *dl_dcch_msg, dl_dcch_msg->msg.c1().type().to_string());
-
-    parent->pdcp->write_sdu(rnti, lcid, std::move(pdu));
+bool rrc::ue::send_dl_dcch_recfg(const dl_dcch_msg_s* dl_dcch_msg, srslte::unique_byte_buffer_t pdu)
+{
+  if (!pdu) {
+    pdu = srslte::allocate_unique_buffer(*pool);
+  }
+  if (pdu) {
+    const rr_cfg_ded_s& rr_cfg_ded =
+        dl_dcch_msg->msg.c1().rrc_conn_recfg().crit_exts.c1().rrc_conn_recfg_r8().rr_cfg_ded;
+    if (not parent->recfg_cache.pack(recfg_profile(rr_cfg_ded), *dl_dcch_msg, pdu.get())) {
+      parent->rrc_log->error("Failed to encode DL-DCCH-Msg\n");
+      return false;
+    }
+    send_packed_dl_dcch(dl_dcch_msg, std::move(pdu));
   } else {
     parent->rrc_log->error("Allocating pdu\n");
     return false;
@@ -1334,6 +1438,43 @@ bool rrc::ue::send_dl_dcch(const dl_dcch_msg_s* dl_dcch_msg, srslte::unique_byte
   return true;
 }
 
+void rrc::ue::send_packed_dl_dcch(const dl_dcch_msg_s* dl_dcch_msg, srslte::unique_byte_buffer_t pdu)
+{
+  // send on SRB2 if user is fully registered (after RRC reconfig complete)
+  uint32_t lcid =
+      parent->rlc->has_bearer(rnti, RB_ID_SRB2) && state == RRC_STATE_REGISTERED ? RB_ID_SRB2 : RB_ID_SRB1;
+
+  char buf[32] = {};
+  sprintf(buf, "SRB%d - rnti=0x%x", lcid, rnti);
+  parent->log_rrc_message(buf, Tx, pdu.get(), *dl_dcch_msg, dl_dcch_msg->msg.c1().type().to_string());
+
+  parent->pdcp->write_sdu(rnti, lcid, std::move(pdu));
+}
+
+/**
+ * Bearer profile of the radioResourceConfigDedicated built by send_connection_reconf() and
+ * send_connection_reconf_new_bearer(). The SRBs only depend on their id, the DRBs on their E-RAB and its QCI, and the
+ * dedicated PHY configuration on the eNB configuration and the 256-QAM support of the UE, except the CQI indexes.
+ */
+std::string rrc::ue::recfg_profile(const rr_cfg_ded_s& rr_cfg_ded) const
+{
+  std::string profile = rr_cfg_ded.phys_cfg_ded_present ? "phy" : "";
+  profile += ue_capabilities.support_dl_256qam ? ",256qam" : "";
+  for (const srb_to_add_mod_s& srb : rr_cfg_ded.srb_to_add_mod_list) {
+    profile += ",srb" + std::to_string(srb.srb_id);
+  }
+  for (const drb_to_add_mod_s& drb : rr_cfg_ded.drb_to_add_mod_list) {
+    auto     erab_it = bearer_list.get_erabs().find(drb.eps_bearer_id);
+    uint32_t qci     = erab_it != bearer_list.get_erabs().end() ? erab_it->second.qos_params.qci : 0;
+    profile += ",drb" + std::to_string(drb.drb_id) + ":" + std::to_string(drb.eps_bearer_id) + ":" +
+               std::to_string(drb.lc_ch_id) + ":" + std::to_string(qci);
+  }
+  for (uint8_t drb_id : rr_cfg_ded.drb_to_release_list) {
+    profile += ",rel" + std::to_string(drb_id);
+  }
+  return profile;
+}
+
 void rrc::ue::apply_setup_phy_common(const asn1::rrc::rr_cfg_common_sib_s& config, bool update_phy)
 {
   // Return if no cell is supported
@@ -1468,7 +1609,12 @@ void rrc::ue::apply_rlc_rb_updates()
     if (not drb.rlc_cfg_present) {
       parent->rrc_log->warning("Default RLC DRB config not supported\n");
     }
-    parent->rlc->add_bearer(rnti, drb.lc_ch_id, srslte::make_rlc_config_t(drb.rlc_cfg));
+    srslte::rlc_config_t rlc_cfg = srslte::make_rlc_config_t(drb.rlc_cfg);
+    auto                 erab_it = bearer_list.get_erabs().find(drb.eps_bearer_id);
+    if (erab_it != bearer_list.get_erabs().end()) {
+      rlc_cfg.aqm = parent->cfg.qci_cfg[erab_it->second.qos_params.qci].aqm;
+    }
+    parent->rlc->add_bearer(rnti, drb.lc_ch_id, rlc_cfg);
   }
 }
 
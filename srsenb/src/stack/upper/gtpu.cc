@@ -92,6 +92,7 @@ int gtpu::init(std::string                  gtp_bind_addr_,
 
 void gtpu::stop()
 {
+  flush_tx();
   if (fd) {
     close(fd);
   }
@@ -116,24 +117,63 @@ void gtpu::write_pdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t
     gtpu_log->debug("Tx S1-U PDU -- IP dst addr %s\n", srslte::gtpu_ntoa(ip_pkt->daddr).c_str());
   }
 
+  auto bearers = rnti_bearers.find(rnti);
+  if (bearers == rnti_bearers.end()) {
+    gtpu_log->error("No bearers for rnti=0x%x. Dropping packet\n", rnti);
+    return;
+  }
+
   gtpu_header_t header;
   header.flags        = GTPU_FLAGS_VERSION_V1 | GTPU_FLAGS_GTP_PROTOCOL;
   header.message_type = GTPU_MSG_DATA_PDU;
   header.length       = pdu->N_bytes;
-  header.teid         = rnti_bearers[rnti].teids_out[lcid];
+  header.teid         = bearers->second.teids_out[lcid];
 
   struct sockaddr_in servaddr;
   servaddr.sin_family      = AF_INET;
-  servaddr.sin_addr.s_addr = htonl(rnti_bearers[rnti].spgw_addrs[lcid]);
+  servaddr.sin_addr.s_addr = htonl(bearers->second.spgw_addrs[lcid]);
   servaddr.sin_port        = htons(GTPU_PORT);
 
   if (!gtpu_write_header(&header, pdu.get(), gtpu_log)) {
     gtpu_log->error("Error writing GTP-U Header. Flags 0x%x, Message Type 0x%x\n", header.flags, header.message_type);
     return;
   }
-  if (sendto(fd, pdu->msg, pdu->N_bytes, MSG_EOR, (struct sockaddr*)&servaddr, sizeof(struct sockaddr_in)) < 0) {
-    perror("sendto");
+
+  // The PDU is sent by the next flush_tx(), together with the other PDUs written until then
+  tx_addrs[tx_pdus.size()] = servaddr;
+  tx_pdus.push_back(std::move(pdu));
+  if (tx_pdus.size() == MAX_TX_BATCH) {
+    flush_tx();
+  }
+}
+
+void gtpu::flush_tx()
+{
+  for (uint32_t i = 0; i < tx_pdus.size(); ++i) {
+    tx_iovs[i].iov_base            = tx_pdus[i]->msg;
+    tx_iovs[i].iov_len             = tx_pdus[i]->N_bytes;
+    tx_msgs[i].msg_hdr             = {};
+    tx_msgs[i].msg_hdr.msg_name    = &tx_addrs[i];
+    tx_msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+    tx_msgs[i].msg_hdr.msg_iov     = &tx_iovs[i];
+    tx_msgs[i].msg_hdr.msg_iovlen  = 1;
+  }
+
+  // sendmmsg may send only part of the messages, and fails on the first message that cannot be sent
+  uint32_t nof_sent = 0;
+  while (nof_sent < tx_pdus.size()) {
+    int n = sendmmsg(fd, &tx_msgs[nof_sent], tx_pdus.size() - nof_sent, 0);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("sendmmsg");
+      // drop the message that failed
+      n = 1;
+    }
+    nof_sent += n;
   }
+  tx_pdus.clear();
 }
 
 /* Warning: This function is called before calling gtpu::init() during MCCH initialization.
@@ -153,18 +193,11 @@ uint32_t gtpu::add_bearer(uint16_t rnti, uint32_t lcid, uint32_t addr, uint32_t
                    teid_in);
   }
 
-  // Initialize maps if it's a new RNTI
-  if (rnti_bearers.count(rnti) == 0) {
-    for (int i = 0; i < SRSENB_N_RADIO_BEARERS; i++) {
-      rnti_bearers[rnti].teids_in[i]   = 0;
-      rnti_bearers[rnti].teids_out[i]  = 0;
-      rnti_bearers[rnti].spgw_addrs[i] = 0;
-    }
-  }
-
-  rnti_bearers[rnti].teids_in[lcid]   = teid_in;
-  rnti_bearers[rnti].teids_out[lcid]  = teid_out;
-  rnti_bearers[rnti].spgw_addrs[lcid] = addr;
+  // The bearers of a new RNTI are zero-initialized
+  bearer_map& bearers      = rnti_bearers[rnti];
+  bearers.teids_in[lcid]   = teid_in;
+  bearers.teids_out[lcid]  = teid_out;
+  bearers.spgw_addrs[lcid] = addr;
 
   return teid_in;
 }
@@ -173,17 +206,22 @@ void gtpu::rem_bearer(uint16_t rnti, uint32_t lcid)
 {
   gtpu_log->info("Removing bearer for rnti: 0x%x, lcid: %d\n", rnti, lcid);
 
+  auto it = rnti_bearers.find(rnti);
+  if (it == rnti_bearers.end()) {
+    return;
+  }
+
   // Remove from TEID from map
   free_teidin(rnti, lcid);
 
   // Remove
-  rnti_bearers[rnti].teids_in[lcid]  = 0;
-  rnti_bearers[rnti].teids_out[lcid] = 0;
+  it->second.teids_in[lcid]  = 0;
+  it->second.teids_out[lcid] = 0;
 
   // Remove RNTI if all bearers are removed
   bool rem = true;
   for (int i = 0; i < SRSENB_N_RADIO_BEARERS; i++) {
-    if (rnti_bearers[rnti].teids_in[i] != 0) {
+    if (it->second.teids_in[i] != 0) {
       rem = false;
     }
   }
@@ -206,19 +244,15 @@ void gtpu::mod_bearer_rnti(uint16_t old_rnti, uint16_t new_rnti)
   }
 
   // Change RNTI bearers map
-  auto entry = rnti_bearers.find(old_rnti);
-  if (entry != rnti_bearers.end()) {
-    auto const value = std::move(entry->second);
-    rnti_bearers.erase(entry);
-    rnti_bearers.insert({new_rnti, std::move(value)});
-  }
+  bearer_map value = rnti_bearers.find(old_rnti)->second;
+  rnti_bearers.erase(old_rnti);
+  rnti_bearers.emplace(new_rnti, value);
 
   // Change TEID
-  for (std::map<uint32_t, rnti_lcid_t>::iterator it = teidin_to_rntilcid_map.begin();
-       it != teidin_to_rntilcid_map.end();
-       it++) {
-    if (it->second.rnti == old_rnti) {
-      it->second.rnti = new_rnti;
+  for (uint32_t teid : value.teids_in) {
+    rnti_lcid_t* entry = teidin_to_rntilcid_map.find(teid);
+    if (entry != nullptr) {
+      entry->rnti = new_rnti;
     }
   }
 }
@@ -233,12 +267,41 @@ void gtpu::rem_user(uint16_t rnti)
 }
 
 void gtpu::handle_gtpu_s1u_rx_packet(srslte::unique_byte_buffer_t pdu, const sockaddr_in& addr)
+{
+  rnti_lcid_t rnti_lcid = {};
+  if (read_s1u_packet(pdu, addr, &rnti_lcid)) {
+    pdcp->write_sdu(rnti_lcid.rnti, rnti_lcid.lcid, std::move(pdu));
+  }
+}
+
+void gtpu::handle_gtpu_s1u_rx_batch(srslte::rx_multisocket_handler::recvfrom_batch_t batch)
+{
+  // Consecutive data PDUs of the same bearer are passed to PDCP in one call
+  rnti_lcid_t cur = {};
+  for (srslte::rx_multisocket_handler::rx_datagram_t& d : batch) {
+    rnti_lcid_t rnti_lcid = {};
+    if (not read_s1u_packet(d.pdu, d.from, &rnti_lcid)) {
+      continue;
+    }
+    if (not rx_sdus.empty() and (rnti_lcid.rnti != cur.rnti or rnti_lcid.lcid != cur.lcid)) {
+      pdcp->write_sdus(cur.rnti, cur.lcid, rx_sdus);
+    }
+    cur = rnti_lcid;
+    rx_sdus.push_back(std::move(d.pdu));
+  }
+  if (not rx_sdus.empty()) {
+    pdcp->write_sdus(cur.rnti, cur.lcid, rx_sdus);
+  }
+  rx_sdus.clear();
+}
+
+bool gtpu::read_s1u_packet(srslte::unique_byte_buffer_t& pdu, const sockaddr_in& addr, rnti_lcid_t* rnti_lcid)
 {
   gtpu_log->debug("Received %d bytes from S1-U interface\n", pdu->N_bytes);
 
   gtpu_header_t header;
-  if (not gtpu_read_header(pdu.get(), &header, gtpu_log)) {
-    return;
+  if (pdu->N_bytes < GTPU_BASE_HEADER_LEN or not gtpu_read_header(pdu.get(), &header, gtpu_log)) {
+    return false;
   }
 
   switch (header.message_type) {
@@ -247,20 +310,17 @@ void gtpu::handle_gtpu_s1u_rx_packet(srslte::unique_byte_buffer_t pdu, const soc
       echo_response(addr.sin_addr.s_addr, addr.sin_port, header.seq_number);
       break;
     case GTPU_MSG_DATA_PDU: {
-      rnti_lcid_t rnti_lcid = teidin_to_rntilcid(header.teid);
-      uint16_t    rnti      = rnti_lcid.rnti;
-      uint16_t    lcid      = rnti_lcid.lcid;
-
-      bool user_exists = (rnti_bearers.count(rnti) > 0);
-
-      if (not user_exists) {
+      const rnti_lcid_t* entry = teidin_to_rntilcid_map.find(header.teid);
+      if (entry == nullptr) {
         gtpu_log->error("Unrecognized TEID In=%d for DL PDU. Dropping packet\n", header.teid);
-        return;
+        return false;
       }
+      uint16_t rnti = entry->rnti;
+      uint16_t lcid = entry->lcid;
 
       if (lcid < SRSENB_N_SRB || lcid >= SRSENB_N_RADIO_BEARERS) {
         gtpu_log->error("Invalid LCID for DL PDU: %d - dropping packet\n", lcid);
-        return;
+        return false;
       }
 
       gtpu_log->info_hex(
@@ -269,7 +329,7 @@ void gtpu::handle_gtpu_s1u_rx_packet(srslte::unique_byte_buffer_t pdu, const soc
       struct iphdr* ip_pkt = (struct iphdr*)pdu->msg;
       if (ip_pkt->version != 4 && ip_pkt->version != 6) {
         gtpu_log->error("Invalid IP version to SPGW\n");
-        return;
+        return false;
       } else if (ip_pkt->version == 4) {
         if (ntohs(ip_pkt->tot_len) != pdu->N_bytes) {
           gtpu_log->error("IP Len and PDU N_bytes mismatch\n");
@@ -278,8 +338,9 @@ void gtpu::handle_gtpu_s1u_rx_packet(srslte::unique_byte_buffer_t pdu, const soc
         gtpu_log->debug("Rx S1-U PDU -- IP src addr %s\n", srslte::gtpu_ntoa(ip_pkt->saddr).c_str());
         gtpu_log->debug("Rx S1-U PDU -- IP dst addr %s\n", srslte::gtpu_ntoa(ip_pkt->daddr).c_str());
       }
-      pdcp->write_sdu(rnti, lcid, std::move(pdu));
-    } break;
+      *rnti_lcid = *entry;
+      return true;
+    }
     case GTPU_MSG_END_MARKER: {
       rnti_lcid_t rnti_lcid = teidin_to_rntilcid(header.teid);
       uint16_t    rnti      = rnti_lcid.rnti;
@@ -289,6 +350,7 @@ void gtpu::handle_gtpu_s1u_rx_packet(srslte::unique_byte_buffer_t pdu, const soc
     default:
       break;
   }
+  return false;
 }
 
 void gtpu::handle_gtpu_m1u_rx_packet(srslte::unique_byte_buffer_t pdu, const sockaddr_in& addr)
@@ -327,67 +389,52 @@ void gtpu::echo_response(in_addr_t addr, in_port_t port, uint16_t seq)
  ***************************************************************************/
 uint32_t gtpu::allocate_teidin(uint16_t rnti, uint16_t lcid)
 {
-  uint32_t teid_in = ++next_teid_in;
-  if (teidin_to_rntilcid_map.count(teid_in) != 0) {
-    gtpu_log->error("TEID In already exists\n");
+  uint32_t teid_in = teidin_to_rntilcid_map.emplace(rnti_lcid_t{rnti, lcid});
+  if (teid_in == 0) {
+    gtpu_log->error("No free TEID In for rnti=0x%x, lcid=%d\n", rnti, lcid);
     return 0;
   }
-  rnti_lcid_t rnti_lcid           = {rnti, lcid};
-  teidin_to_rntilcid_map[teid_in] = rnti_lcid;
   gtpu_log->debug("TEID In=%d added\n", teid_in);
   return teid_in;
 }
 
 void gtpu::free_teidin(uint16_t rnti, uint16_t lcid)
 {
-  for (std::map<uint32_t, rnti_lcid_t>::iterator it = teidin_to_rntilcid_map.begin();
-       it != teidin_to_rntilcid_map.end();) {
-    if (it->second.rnti == rnti && it->second.lcid == lcid) {
-      gtpu_log->debug("TEID In=%d erased\n", it->first);
-      it = teidin_to_rntilcid_map.erase(it);
-    } else {
-      it++;
-    }
+  auto it = rnti_bearers.find(rnti);
+  if (it == rnti_bearers.end() or lcid >= SRSENB_N_RADIO_BEARERS) {
+    return;
+  }
+  uint32_t teid = it->second.teids_in[lcid];
+  if (teidin_to_rntilcid_map.erase(teid)) {
+    gtpu_log->debug("TEID In=%d erased\n", teid);
   }
 }
 
 void gtpu::free_teidin(uint16_t rnti)
 {
-  for (std::map<uint32_t, rnti_lcid_t>::iterator it = teidin_to_rntilcid_map.begin();
-       it != teidin_to_rntilcid_map.end();) {
-    if (it->second.rnti == rnti) {
-      gtpu_log->debug("TEID In=%d erased\n", it->first);
-      it = teidin_to_rntilcid_map.erase(it);
-    } else {
-      it++;
-    }
+  for (uint16_t lcid = 0; lcid < SRSENB_N_RADIO_BEARERS; ++lcid) {
+    free_teidin(rnti, lcid);
   }
 }
 
 gtpu::rnti_lcid_t gtpu::teidin_to_rntilcid(uint32_t teidin)
 {
-  rnti_lcid_t rnti_lcid = {};
-  if (teidin_to_rntilcid_map.count(teidin) == 0) {
+  const rnti_lcid_t* entry = teidin_to_rntilcid_map.find(teidin);
+  if (entry == nullptr) {
     gtpu_log->error("TEID=%d In does not exist.\n", teidin);
-    return rnti_lcid;
+    return {};
   }
-  rnti_lcid.rnti = teidin_to_rntilcid_map[teidin].rnti;
-  rnti_lcid.lcid = teidin_to_rntilcid_map[teidin].lcid;
-  return rnti_lcid;
+  return *entry;
 }
 
 uint32_t gtpu::rntilcid_to_teidin(uint16_t rnti, uint16_t lcid)
 {
-  uint32_t teidin = 0;
-  for (const std::pair<const uint32_t, rnti_lcid_t>& item : teidin_to_rntilcid_map) {
-    if (item.second.rnti == rnti and item.second.lcid == lcid) {
-      teidin = item.first;
-    }
-  }
-  if (teidin == 0) {
+  auto it = rnti_bearers.find(rnti);
+  if (it == rnti_bearers.end() or lcid >= SRSENB_N_RADIO_BEARERS or it->second.teids_in[lcid] == 0) {
     gtpu_log->error("Could not find TEID. RNTI=0x%x, LCID=%d.\n", rnti, lcid);
+    return 0;
   }
-  return teidin;
+  return it->second.teids_in[lcid];
 }
 
 /****************************************************************************
@@ -45,6 +45,14 @@ void pdcp::stop()
   users.clear();
 }
 
+void pdcp::set_crypto_offload(bool enable)
+{
+  crypto_offload = enable;
+  for (auto& user : users) {
+    user.second.pdcp->set_crypto_offload(enable);
+  }
+}
+
 void pdcp::add_user(uint16_t rnti)
 {
   if (users.count(rnti) == 0) {
@@ -58,6 +66,7 @@ void pdcp::add_user(uint16_t rnti)
     users[rnti].rlc_itf.rlc   = rlc;
     users[rnti].gtpu_itf.gtpu = gtpu;
     users[rnti].pdcp          = obj;
+    obj->set_crypto_offload(crypto_offload);
   }
 }
 
@@ -161,6 +170,21 @@ void pdcp::write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t
   }
 }
 
+void pdcp::write_sdus(uint16_t rnti, uint32_t lcid, std::vector<srslte::unique_byte_buffer_t>& sdus)
+{
+  auto user_it = users.find(rnti);
+  if (user_it != users.end()) {
+    for (srslte::unique_byte_buffer_t& sdu : sdus) {
+      if (rnti != SRSLTE_MRNTI) {
+        user_it->second.pdcp->write_sdu(lcid, std::move(sdu));
+      } else {
+        user_it->second.pdcp->write_sdu_mch(lcid, std::move(sdu));
+      }
+    }
+  }
+  sdus.clear();
+}
+
 void pdcp::user_interface_gtpu::write_pdu(uint32_t lcid, srslte::unique_byte_buffer_t pdu)
 {
   gtpu->write_pdu(rnti, lcid, std::move(pdu));
@@ -120,6 +120,19 @@ void pdcp_nr::write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer
   }
 }
 
+void pdcp_nr::write_sdus(uint16_t rnti, uint32_t lcid, std::vector<srslte::unique_byte_buffer_t>& sdus)
+{
+  auto user_it = users.find(rnti);
+  if (user_it != users.end()) {
+    for (srslte::unique_byte_buffer_t& sdu : sdus) {
+      user_it->second.pdcp->write_sdu(lcid, std::move(sdu));
+    }
+  } else {
+    m_log->error("Can't write %zd SDUs. RNTI=0x%X doesn't exist.\n", sdus.size(), rnti);
+  }
+  sdus.clear();
+}
+
 void pdcp_nr::user_interface_sdap::write_pdu(uint32_t lcid, srslte::unique_byte_buffer_t pdu)
 {
   sdap->write_pdu(rnti, lcid, std::move(pdu));
@@ -171,6 +171,18 @@ void rlc::reestablish(uint16_t rnti)
   pthread_rwlock_unlock(&rwlock);
 }
 
+void rlc::get_metrics(uint16_t rnti, rlc_ue_metrics_t& metrics)
+{
+  pthread_rwlock_rdlock(&rwlock);
+  auto it = users.find(rnti);
+  if (it != users.end()) {
+    srslte::rlc_metrics_t m = {};
+    it->second.rlc->get_metrics(m);
+    std::copy(std::begin(m.bearer), std::end(m.bearer), std::begin(metrics.bearer));
+  }
+  pthread_rwlock_unlock(&rwlock);
+}
+
 // In the eNodeB, there is no polling for buffer state from the scheduler.
 // This function is called by UE RLC instance every time the tx/retx buffers are updated
 void rlc::update_bsr(uint32_t rnti, uint32_t lcid, uint32_t tx_queue, uint32_t retx_queue)
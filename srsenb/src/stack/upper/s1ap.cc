@@ -440,6 +440,23 @@ bool s1ap::connect_mme()
     return false;
   }
 
+  // Request the streams, the number agreed with the MME comes with the SCTP_COMM_UP notification
+  nof_ue_streams = 1;
+
+  sctp_initmsg initmsg        = {};
+  initmsg.sinit_num_ostreams  = std::max(args.nof_sctp_streams, (uint16_t)2);
+  initmsg.sinit_max_instreams = initmsg.sinit_num_ostreams;
+  if (setsockopt(s1ap_socket.fd(), IPPROTO_SCTP, SCTP_INITMSG, &initmsg, sizeof(initmsg)) != 0) {
+    s1ap_log->warning("Failed to request %d SCTP streams: %s\n", initmsg.sinit_num_ostreams, strerror(errno));
+  }
+  sctp_event_subscribe evnts   = {};
+  evnts.sctp_data_io_event     = 1;
+  evnts.sctp_association_event = 1;
+  evnts.sctp_shutdown_event    = 1;
+  if (setsockopt(s1ap_socket.fd(), IPPROTO_SCTP, SCTP_EVENTS, &evnts, sizeof(evnts)) != 0) {
+    s1ap_log->warning("Failed to subscribe to the SCTP association events: %s\n", strerror(errno));
+  }
+
   // Connect to the MME address
   if (not s1ap_socket.connect_to(args.mme_addr.c_str(), MME_PORT, &mme_addr)) {
     return false;
@@ -506,6 +523,15 @@ bool s1ap::handle_mme_rx_msg(srslte::unique_byte_buffer_t pdu,
       s1ap_log->info("SCTP Association Shutdown. Association: %d\n", sri.sinfo_assoc_id);
       srslte::console("SCTP Association Shutdown. Association: %d\n", sri.sinfo_assoc_id);
       s1ap_socket.reset();
+    } else if (notification->sn_header.sn_type == SCTP_ASSOC_CHANGE and
+               notification->sn_assoc_change.sac_state == SCTP_COMM_UP) {
+      nof_ue_streams = std::max(notification->sn_assoc_change.sac_outbound_streams, (uint16_t)2) - 1;
+      s1ap_log->info("SCTP association with the MME established with %d streams for UE-associated signalling\n",
+                     nof_ue_streams);
+    }
+    // The other notifications carry no S1AP PDU
+    if (s1ap_socket.is_init()) {
+      return true;
     }
   } else if (pdu->N_bytes == 0) {
     s1ap_log->error("SCTP return 0 bytes. Closing socket\n");
@@ -536,7 +562,13 @@ bool s1ap::handle_s1ap_rx_pdu(srslte::byte_buffer_t* pdu)
   s1ap_pdu_c     rx_pdu;
   asn1::cbit_ref bref(pdu->msg, pdu->N_bytes);
 
-  if (rx_pdu.unpack(bref) != asn1::SRSASN_SUCCESS) {
+  // Only the decoding uses the arena, the IEs copied into the UE contexts by the handlers stay on the heap
+  asn1::SRSASN_CODE ret;
+  {
+    asn1::arena_scope scope(rx_arena);
+    ret = rx_pdu.unpack(bref);
+  }
+  if (ret != asn1::SRSASN_SUCCESS) {
     s1ap_log->error("Failed to unpack received PDU\n");
     return false;
   }
@@ -1365,7 +1397,13 @@ bool s1ap::sctp_send_s1ap_pdu(const asn1::s1ap::s1ap_pdu_c& tx_pdu, uint32_t rnt
   } else {
     s1ap_log->info_hex(buf->msg, buf->N_bytes, "Sending %s to MME", procedure_name);
   }
-  uint16_t streamid = rnti == SRSLTE_INVALID_RNTI ? NONUE_STREAM_ID : users.find_ue_rnti(rnti)->stream_id;
+
+  // The UEs are spread among the streams, so that the loss of a message of one UE does not delay the others
+  uint16_t streamid = NONUE_STREAM_ID;
+  ue*      u        = rnti == SRSLTE_INVALID_RNTI ? nullptr : users.find_ue_rnti(rnti);
+  if (u != nullptr) {
+    streamid = 1 + u->ctxt.enb_ue_s1ap_id % nof_ue_streams;
+  }
 
   ssize_t n_sent = sctp_sendmsg(s1ap_socket.fd(),
                                 buf->msg,
@@ -1449,8 +1487,6 @@ s1ap::ue::ue(s1ap* s1ap_ptr_) : s1ap_ptr(s1ap_ptr_), s1ap_log(s1ap_ptr_->s1ap_lo
   ctxt.enb_ue_s1ap_id = s1ap_ptr->next_enb_ue_s1ap_id++;
   gettimeofday(&ctxt.init_timestamp, nullptr);
 
-  stream_id = s1ap_ptr->next_ue_stream_id;
-
   // initialize timers
   ts1_reloc_prep = s1ap_ptr->task_sched.get_unique_timer();
   ts1_reloc_prep.set(ts1_reloc_prep_timeout_ms,
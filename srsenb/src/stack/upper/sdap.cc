@@ -57,4 +57,10 @@ void sdap::write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t
   m_pdcp->write_sdu(rnti, lcid, std::move(pdu));
 }
 
+void sdap::write_sdus(uint16_t rnti, uint32_t lcid, std::vector<srslte::unique_byte_buffer_t>& sdus)
+{
+  // the SDUs are sent without SDAP header, so the burst of the bearer goes to PDCP as is
+  m_pdcp->write_sdus(rnti, lcid, sdus);
+}
+
 } // namespace srsenb
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/mac/scheduler.h"
+#include "srsenb/hdr/stack/mac/ue.h"
+#include "srslte/common/test_common.h"
+#include <atomic>
+#include <map>
+#include <thread>
+
+using namespace srsenb;
+
+const uint32_t nof_workers = 4;
+const uint32_t nof_rounds  = 50;
+const uint32_t sdu_lcids[] = {3, 4};
+const uint32_t sdu_len     = 100;
+const float    phr_db      = 10.1;
+
+/// Records the SDUs the stack thread passes to RLC
+class rlc_recorder : public rlc_interface_mac
+{
+public:
+  int  read_pdu(uint16_t rnti, uint32_t lcid, uint8_t* payload, uint32_t nof_bytes) override { return 0; }
+  void read_pdu_pcch(uint8_t* payload, uint32_t buffer_size) override {}
+  void write_pdu(uint16_t rnti, uint32_t lcid, uint8_t* payload, uint32_t nof_bytes) override
+  {
+    sdus[rnti].emplace_back(lcid, std::vector<uint8_t>(payload, payload + nof_bytes));
+  }
+
+  std::map<uint16_t, std::vector<std::pair<uint32_t, std::vector<uint8_t> > > > sdus;
+};
+
+class rrc_mac_dummy : public rrc_interface_mac
+{
+public:
+  void     add_user(uint16_t rnti, const sched_interface::ue_cfg_t& init_ue_cfg) override {}
+  void     upd_user(uint16_t new_rnti, uint16_t old_rnti) override {}
+  void     set_activity_user(uint16_t rnti) override { nof_activity++; }
+  bool     is_paging_opportunity(uint32_t tti, uint32_t* payload_len) override { return false; }
+  uint8_t* read_pdu_bcch_dlsch(const uint8_t enb_cc_idx, const uint32_t sib_index) override { return nullptr; }
+
+  uint32_t nof_activity = 0;
+};
+
+/// The SDU of every LCID carries the RNTI, the TTI and the LCID, so that it can be matched regardless of the order
+void fill_sdu(uint8_t* sdu, uint16_t rnti, uint32_t tti, uint32_t lcid)
+{
+  for (uint32_t i = 0; i < sdu_len; i++) {
+    sdu[i] = (uint8_t)(rnti + tti * 7 + lcid * 13 + i);
+  }
+}
+
+/// Writes a UL-SCH PDU with a PHR and one SDU per LCID, as the PHY worker of the TTI would decode it
+int write_ul_pdu(ue& user, uint16_t rnti, uint32_t tti, uint32_t* pdu_len)
+{
+  srslte::sch_pdu       pdu(10, srslte::log_ref{"MAC"});
+  srslte::byte_buffer_t buffer;
+  uint8_t               sdu[sdu_len];
+
+  pdu.init_tx(&buffer, 2 * (sdu_len + 3) + 2, true);
+  TESTASSERT(pdu.new_subh());
+  TESTASSERT(pdu.get()->set_phr(phr_db));
+  for (uint32_t lcid : sdu_lcids) {
+    fill_sdu(sdu, rnti, tti, lcid);
+    TESTASSERT(pdu.new_subh());
+    TESTASSERT(pdu.get()->set_sdu(lcid, sdu_len, sdu) == (int)sdu_len);
+  }
+  TESTASSERT(pdu.write_packet(srslte::log_ref{"MAC"}) != nullptr);
+
+  uint8_t* rx_buffer = user.request_buffer(0, tti, buffer.N_bytes);
+  TESTASSERT(rx_buffer != nullptr);
+  memcpy(rx_buffer, buffer.msg, buffer.N_bytes);
+  *pdu_len = buffer.N_bytes;
+  return SRSLTE_SUCCESS;
+}
+
+/*
+ * Several PHY workers decode the PDUs of two UEs in parallel and demultiplex them, while the stack thread passes
+ * their SDUs to RLC. Every SDU must reach RLC once, with its LCID and its bytes, and the CEs must reach the UE
+ */
+int test_demux_in_workers()
+{
+  rlc_recorder    rlc;
+  rrc_mac_dummy   rrc;
+  sched           sched;
+  softbuffer_pool softbuffers;
+
+  // The UEs log to different loggers, the parser of each worker must not be bound to either
+  std::array<uint16_t, 2>                rntis = {0x46, 0x47};
+  std::array<std::unique_ptr<ue>, 2>     users;
+  std::array<srslte::log_ref, 2>         logs  = {srslte::log_ref{"MAC"}, srslte::log_ref{"MAC1"}};
+  for (uint32_t i = 0; i < users.size(); i++) {
+    users[i].reset(new ue(rntis[i], 6, &sched, &rrc, &rlc, nullptr, logs[i], &softbuffers, 1));
+  }
+
+  // The stack thread processes the PDUs as they are pushed
+  std::atomic<bool> running{true};
+  std::thread       stack_thread([&users, &running]() {
+    while (running) {
+      for (auto& u : users) {
+        u->process_pdus();
+      }
+      std::this_thread::yield();
+    }
+  });
+
+  // In every round, each worker decodes the TTI of a different HARQ process
+  int worker_ret = SRSLTE_SUCCESS;
+  for (uint32_t round = 0; round < nof_rounds; round++) {
+    std::array<std::thread, nof_workers> workers;
+    std::array<int, nof_workers>         ret = {};
+    for (uint32_t w = 0; w < nof_workers; w++) {
+      uint32_t tti = round * nof_workers + w;
+      workers[w]   = std::thread([&users, &rntis, &ret, w, tti]() {
+        for (uint32_t i = 0; i < users.size(); i++) {
+          uint32_t len = 0;
+          ret[w] |= write_ul_pdu(*users[i], rntis[i], tti, &len);
+          users[i]->push_pdu(0, tti, len);
+        }
+      });
+    }
+    for (uint32_t w = 0; w < nof_workers; w++) {
+      workers[w].join();
+      worker_ret |= ret[w];
+    }
+  }
+  running = false;
+  stack_thread.join();
+  for (auto& u : users) {
+    u->process_pdus();
+  }
+  TESTASSERT(worker_ret == SRSLTE_SUCCESS);
+
+  // Every SDU reached RLC once
+  for (uint16_t rnti : rntis) {
+    const auto& sdus = rlc.sdus[rnti];
+    TESTASSERT(sdus.size() == nof_rounds * nof_workers * 2);
+    std::vector<uint32_t> nof_rx(nof_rounds * nof_workers);
+    for (const auto& s : sdus) {
+      TESTASSERT(s.second.size() == sdu_len);
+      // The first byte of the SDU gives its TTI
+      uint32_t tti = 0;
+      while (tti < nof_rx.size() and (uint8_t)(rnti + tti * 7 + s.first * 13) != s.second[0]) {
+        tti++;
+      }
+      TESTASSERT(tti < nof_rx.size());
+      uint8_t expected[sdu_len];
+      fill_sdu(expected, rnti, tti, s.first);
+      TESTASSERT(memcmp(expected, s.second.data(), sdu_len) == 0);
+      nof_rx[tti]++;
+    }
+    for (uint32_t n : nof_rx) {
+      TESTASSERT(n == 2);
+    }
+  }
+  TESTASSERT(rrc.nof_activity == 2 * nof_rounds * nof_workers * 2);
+
+  // The PHR of every PDU reached the metrics of its UE
+  srslte::sch_pdu       ref(10, srslte::log_ref{"MAC"});
+  srslte::byte_buffer_t buffer;
+  ref.init_tx(&buffer, 2, true);
+  TESTASSERT(ref.new_subh());
+  TESTASSERT(ref.get()->set_phr(phr_db));
+  ref.write_packet(srslte::log_ref{"MAC"});
+  ref.init_rx(buffer.N_bytes, true);
+  ref.parse_packet(buffer.msg);
+  TESTASSERT(ref.next());
+  for (auto& u : users) {
+    mac_metrics_t metrics = {};
+    u->metrics_read(&metrics);
+    TESTASSERT(metrics.phr == (int)ref.get()->get_phr());
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  srslte::logmap::set_default_log_level(srslte::LOG_LEVEL_NONE);
+
+  TESTASSERT(test_demux_in_workers() == SRSLTE_SUCCESS);
+
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
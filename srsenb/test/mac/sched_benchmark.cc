@@ -0,0 +1,203 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Scheduler benchmark. Drives the scheduler of a single carrier with a synthetic full buffer load (random CQIs and
+ * HARQ feedback drawn from a fixed seed) and reports the scheduling time per TTI and the throughput. Unlike
+ * sched_replay it needs no trace, so it runs the same load on every machine.
+ */
+
+#include "scheduler_test_utils.h"
+#include "srsenb/hdr/stack/mac/scheduler.h"
+#include "srslte/common/tti_point.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <inttypes.h>
+#include <random>
+#include <unistd.h>
+
+using namespace srsenb;
+
+static uint32_t                      nof_prb    = 25;
+static uint32_t                      nof_ues    = 16;
+static uint32_t                      nof_ttis   = 10000;
+static uint32_t                      seed       = 0;
+static float                         bler       = 0.1;
+static sched_interface::sched_args_t sched_args = {};
+
+void usage(char* prog)
+{
+  printf("Usage: %s [pundsbw]\n", prog);
+  printf("\t-p Number of PRBs of the carrier [Default %d]\n", nof_prb);
+  printf("\t-u Number of UEs with full buffers [Default %d]\n", nof_ues);
+  printf("\t-n Number of TTIs [Default %d]\n", nof_ttis);
+  printf("\t-d Rate of the DL and UL transport blocks that are NACKed [Default %.2f]\n", bler);
+  printf("\t-s Seed [Default 0=time]\n");
+  printf("\t-b Scheduler policy (time_rr, pf or max_ci) [Default %s]\n", sched_args.policy.c_str());
+  printf("\t-w Number of threads allocating the carriers in parallel [Default %d]\n", sched_args.nof_cc_workers);
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "pundsbw")) != -1) {
+    switch (opt) {
+      case 'p':
+        nof_prb = (uint32_t)strtol(argv[optind], nullptr, 10);
+        break;
+      case 'u':
+        nof_ues = (uint32_t)strtol(argv[optind], nullptr, 10);
+        break;
+      case 'n':
+        nof_ttis = (uint32_t)strtol(argv[optind], nullptr, 10);
+        break;
+      case 'd':
+        bler = strtof(argv[optind], nullptr);
+        break;
+      case 's':
+        seed = (uint32_t)strtoul(argv[optind], nullptr, 0);
+        break;
+      case 'b':
+        sched_args.policy = argv[optind];
+        break;
+      case 'w':
+        sched_args.nof_cc_workers = (uint32_t)strtol(argv[optind], nullptr, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+/// HARQ feedback of a transport block, forwarded to the scheduler in the TTI it would be received
+struct pending_feedback {
+  srslte::tti_point tti_rx;
+  uint16_t          rnti;
+  uint32_t          tb_idx;
+  bool              ack;
+};
+
+int main(int argc, char** argv)
+{
+  using clock = std::chrono::steady_clock;
+
+  parse_args(argc, argv);
+  srslte::logmap::set_default_log_level(srslte::LOG_LEVEL_NONE);
+
+  if (seed == 0) {
+    seed = std::chrono::system_clock::now().time_since_epoch().count();
+  }
+  std::mt19937                          rand_gen(seed);
+  std::uniform_real_distribution<float> real_dist(0.0, 1.0);
+
+  sched sched_obj;
+  sched_obj.init(nullptr);
+  sched_obj.set_sched_cfg(&sched_args);
+
+  std::vector<sched_interface::cell_cfg_t> cells = {generate_default_cell_cfg(nof_prb)};
+  TESTASSERT(sched_obj.cell_cfg(cells) == SRSLTE_SUCCESS);
+
+  std::vector<uint16_t> rntis;
+  for (uint32_t i = 0; i < nof_ues; ++i) {
+    rntis.push_back(0x46 + i);
+    TESTASSERT(sched_obj.ue_cfg(rntis.back(), generate_default_ue_cfg2()) == SRSLTE_SUCCESS);
+  }
+
+  std::deque<pending_feedback>    dl_acks, ul_crcs;
+  sched_interface::dl_sched_res_t dl_res;
+  sched_interface::ul_sched_res_t ul_res;
+  std::vector<double>             tti_us;
+  uint64_t                        dl_bytes = 0, ul_bytes = 0;
+  tti_us.reserve(nof_ttis);
+
+  srslte::tti_point tti_rx;
+  for (uint32_t n = 0; n < nof_ttis; ++n, ++tti_rx) {
+    // Keep the buffers full and report new CQIs every 5 TTIs
+    for (uint16_t rnti : rntis) {
+      sched_obj.dl_rlc_buffer_state(rnti, RB_ID_DRB1, 1000000, 0);
+      sched_obj.ul_bsr(rnti, 1, 1000000);
+      if (n % 5 == rnti % 5) {
+        sched_obj.dl_cqi_info(tti_rx.to_uint(), rnti, 0, std::uniform_int_distribution<uint32_t>{5, 15}(rand_gen));
+        sched_obj.ul_cqi_info(
+            tti_rx.to_uint(), rnti, 0, std::uniform_int_distribution<uint32_t>{5, 24}(rand_gen), 0);
+      }
+    }
+    while (not dl_acks.empty() and dl_acks.front().tti_rx == tti_rx) {
+      auto& p = dl_acks.front();
+      sched_obj.dl_ack_info(tti_rx.to_uint(), p.rnti, 0, p.tb_idx, p.ack);
+      dl_acks.pop_front();
+    }
+    while (not ul_crcs.empty() and ul_crcs.front().tti_rx == tti_rx) {
+      auto& p = ul_crcs.front();
+      sched_obj.ul_crc_info(tti_rx.to_uint(), p.rnti, 0, p.ack);
+      ul_crcs.pop_front();
+    }
+
+    srslte::tti_point tti_tx_dl = srslte::to_tx_dl(tti_rx);
+    srslte::tti_point tti_tx_ul = srslte::to_tx_ul(tti_rx);
+
+    auto tic = clock::now();
+    sched_obj.dl_sched(tti_tx_dl.to_uint(), 0, dl_res);
+    sched_obj.ul_sched(tti_tx_ul.to_uint(), 0, ul_res);
+    tti_us.push_back(std::chrono::duration<double, std::micro>(clock::now() - tic).count());
+
+    for (uint32_t i = 0; i < dl_res.nof_data_elems; ++i) {
+      for (uint32_t tb = 0; tb < SRSLTE_MAX_TB; ++tb) {
+        if (dl_res.data[i].tbs[tb] > 0) {
+          bool ack = real_dist(rand_gen) >= bler;
+          dl_acks.push_back({srslte::to_tx_dl_ack(tti_rx), dl_res.data[i].dci.rnti, tb, ack});
+          dl_bytes += ack ? dl_res.data[i].tbs[tb] : 0;
+        }
+      }
+    }
+    for (uint32_t i = 0; i < ul_res.nof_dci_elems; ++i) {
+      bool ack = real_dist(rand_gen) >= bler;
+      ul_crcs.push_back({tti_tx_ul, ul_res.pusch[i].dci.rnti, 0, ack});
+      ul_bytes += ack ? ul_res.pusch[i].tbs : 0;
+    }
+  }
+
+  std::vector<double> t = tti_us;
+  std::sort(t.begin(), t.end());
+  auto   percentile = [&t](double p) { return t[std::min((size_t)(p * t.size()), t.size() - 1)]; };
+  double mean       = 0;
+  for (double v : t) {
+    mean += v;
+  }
+  mean /= t.size();
+
+  printf("Scheduled %d TTIs of %d UEs in %d PRBs with policy=%s (seed=%u)\n",
+         nof_ttis,
+         nof_ues,
+         nof_prb,
+         sched_args.policy.c_str(),
+         seed);
+  printf("Scheduling time per TTI: mean=%.2f us, p50=%.1f us, p99=%.1f us, max=%.1f us\n",
+         mean,
+         percentile(0.5),
+         percentile(0.99),
+         t.back());
+  printf("DL: %.2f Mbps, UL: %.2f Mbps\n", dl_bytes * 8 / (nof_ttis * 1e3), ul_bytes * 8 / (nof_ttis * 1e3));
+
+  return SRSLTE_SUCCESS;
+}
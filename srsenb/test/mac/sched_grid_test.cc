@@ -144,6 +144,128 @@ int test_pdcch_one_ue()
   return SRSLTE_SUCCESS;
 }
 
+int test_pdcch_pruning()
+{
+  const uint32_t ENB_CC_IDX = 0;
+  const uint32_t max_leaves = 4;
+  const uint32_t nof_ues    = 8;
+
+  std::vector<sched_cell_params_t> cell_params(1);
+  sched_interface::ue_cfg_t        ue_cfg   = generate_default_ue_cfg();
+  sched_interface::cell_cfg_t      cell_cfg = generate_default_cell_cfg(100);
+  sched_interface::sched_args_t    sched_args{};
+  sched_args.min_nof_ctrl_symbols = 3;
+  sched_args.max_pdcch_leaves     = max_leaves;
+  TESTASSERT(cell_params[ENB_CC_IDX].set_cfg(ENB_CC_IDX, cell_cfg, sched_args));
+
+  std::vector<sched_ue> ues(nof_ues);
+  for (uint32_t i = 0; i < nof_ues; ++i) {
+    ues[i].init(70 + i, cell_params);
+    ues[i].set_cfg(ue_cfg);
+  }
+
+  pdcch_grid_t pdcch;
+  pdcch.init(cell_params[PCell_IDX]);
+  tti_params_t tti_params{std::uniform_int_distribution<uint32_t>{0, 10239}(get_rand_gen())};
+  pdcch.new_tti(tti_params);
+
+  // TEST: the number of combinations never exceeds the cap and the pruning is counted
+  for (auto& u : ues) {
+    if (not pdcch.alloc_dci(alloc_type_t::DL_DATA, 0, &u)) {
+      continue;
+    }
+    TESTASSERT(pdcch.nof_alloc_combinations() <= max_leaves);
+  }
+  TESTASSERT(pdcch.nof_allocs() > 0);
+  TESTASSERT(pdcch.nof_pruned_allocs() > 0);
+
+  // TEST: the kept combinations are still valid
+  pdcch_grid_t::alloc_result_t pdcch_result;
+  pdcch_mask_t                 pdcch_mask;
+  for (size_t idx = 0; idx < pdcch.nof_alloc_combinations(); ++idx) {
+    pdcch.get_allocs(&pdcch_result, &pdcch_mask, idx);
+    TESTASSERT(pdcch_result.size() == pdcch.nof_allocs());
+    TESTASSERT(pdcch_mask.count() == pdcch.nof_allocs());
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+int test_ul_best_fit()
+{
+  // Grid of 25 PRBs with PUCCH at the edges and two runs of empty PRBs of 4 and 12 PRBs
+  prbmask_t used(25);
+  used.fill(0, 2);
+  used.fill(6, 8);
+  used.fill(20, 25);
+
+  // The smallest run that fits is taken, starting at its lower edge
+  prb_interval alloc;
+  TESTASSERT(sched_utils::find_ul_alloc(used, 3, &alloc));
+  TESTASSERT(alloc == prb_interval(2, 5));
+  TESTASSERT(sched_utils::find_ul_alloc(used, 9, &alloc));
+  TESTASSERT(alloc == prb_interval(8, 17));
+
+  // If no run fits, the largest run is taken, shortened to a valid SC-FDMA size
+  TESTASSERT(not sched_utils::find_ul_alloc(used, 13, &alloc));
+  TESTASSERT(alloc == prb_interval(8, 20));
+  used.fill(19, 20);
+  TESTASSERT(not sched_utils::find_ul_alloc(used, 13, &alloc));
+  TESTASSERT(alloc == prb_interval(8, 18));
+
+  used.fill(0, 25);
+  TESTASSERT(not sched_utils::find_ul_alloc(used, 1, &alloc));
+  TESTASSERT(alloc.length() == 0);
+
+  return SRSLTE_SUCCESS;
+}
+
+int test_ul_subband_alloc()
+{
+  // Same grid, with the PRBs grouped by subband quality as after an SRS measurement
+  prbmask_t used(25);
+  used.fill(0, 2);
+  used.fill(6, 8);
+  used.fill(20, 25);
+  std::array<prbmask_t, 4> sb_prbs;
+  for (auto& prbs : sb_prbs) {
+    prbs.resize(25);
+  }
+
+  // Without measurements, it is the best fit
+  sb_prbs[2].fill(0, 25);
+  prb_interval alloc, alloc_best_fit;
+  for (uint32_t L = 1; L < 14; ++L) {
+    bool ret = sched_utils::find_ul_alloc(used, sb_prbs, L, &alloc);
+    TESTASSERT(ret == sched_utils::find_ul_alloc(used, L, &alloc_best_fit));
+    TESTASSERT(alloc == alloc_best_fit);
+  }
+
+  // The best subband is taken, even if a smaller run of empty PRBs fits
+  sb_prbs[2].fill(12, 16, false);
+  sb_prbs[0].fill(12, 16, true);
+  TESTASSERT(sched_utils::find_ul_alloc(used, sb_prbs, 3, &alloc));
+  TESTASSERT(alloc == prb_interval(12, 15));
+  TESTASSERT(sched_utils::find_ul_alloc(used, sb_prbs, 6, &alloc));
+  TESTASSERT(alloc.start() <= 12 and alloc.stop() >= 16);
+
+  // The worst subband is avoided
+  sb_prbs[2].fill(2, 6, false);
+  sb_prbs[3].fill(2, 6, true);
+  TESTASSERT(sched_utils::find_ul_alloc(used, sb_prbs, 2, &alloc));
+  TESTASSERT(alloc == prb_interval(12, 14));
+  sb_prbs[0].reset();
+  sb_prbs[2].fill(8, 20, true);
+  TESTASSERT(sched_utils::find_ul_alloc(used, sb_prbs, 2, &alloc));
+  TESTASSERT(alloc == prb_interval(8, 10));
+
+  // If no window of L empty PRBs exists, the largest run is used
+  TESTASSERT(not sched_utils::find_ul_alloc(used, sb_prbs, 13, &alloc));
+  TESTASSERT(alloc == prb_interval(8, 20));
+
+  return SRSLTE_SUCCESS;
+}
+
 int main()
 {
   srsenb::set_randseed(seed);
@@ -151,5 +273,8 @@ int main()
   srslte::logmap::get("TEST")->set_level(srslte::LOG_LEVEL_INFO);
 
   TESTASSERT(test_pdcch_one_ue() == SRSLTE_SUCCESS);
+  TESTASSERT(test_pdcch_pruning() == SRSLTE_SUCCESS);
+  TESTASSERT(test_ul_best_fit() == SRSLTE_SUCCESS);
+  TESTASSERT(test_ul_subband_alloc() == SRSLTE_SUCCESS);
   printf("Success\n");
 }
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/mac/scheduler_ue.h"
+#include "srslte/common/test_common.h"
+#include <random>
+
+using namespace srsenb;
+
+const uint32_t nof_harqs = 8;
+
+/// Reference of get_pending_dl_harq(), scanning every process
+dl_harq_proc* find_oldest_pending_harq(harq_entity& ent, uint32_t tti_tx_dl)
+{
+  dl_harq_proc* oldest     = nullptr;
+  uint32_t      oldest_tti = 0;
+  for (dl_harq_proc& h : ent.dl_harq_procs()) {
+    if (h.has_pending_retx(0, tti_tx_dl) or h.has_pending_retx(1, tti_tx_dl)) {
+      uint32_t x = srslte::tti_point{tti_tx_dl} - h.get_tti();
+      if (x > oldest_tti) {
+        oldest     = &h;
+        oldest_tti = x;
+      }
+    }
+  }
+  return oldest;
+}
+
+/// Reference of get_empty_dl_harq()
+dl_harq_proc* find_empty_harq(harq_entity& ent)
+{
+  for (dl_harq_proc& h : ent.dl_harq_procs()) {
+    if (h.is_empty()) {
+      return &h;
+    }
+  }
+  return nullptr;
+}
+
+int test_dl_harq_masks()
+{
+  std::mt19937                            rand_gen(0);
+  std::uniform_int_distribution<uint32_t> rand_pct(0, 99);
+  harq_entity                             ent(nof_harqs, nof_harqs);
+  rbgmask_t                               mask(25);
+  ent.set_cfg(4);
+
+  for (uint32_t tti = 0; tti < 20000; tti++) {
+    srslte::tti_point tti_rx{tti};
+    uint32_t          tti_tx_dl = srslte::to_tx_dl(tti_rx).to_uint();
+
+    // ACK or NACK the TBs sent FDD_HARQ_DELAY_DL_MS ago
+    for (uint32_t tb = 0; tb < SRSLTE_MAX_TB; tb++) {
+      ent.set_ack_info(tti, tb, rand_pct(rand_gen) < 80);
+    }
+    ent.reset_pending_data(tti_rx);
+
+    // The masks must find the same processes as a scan
+    TESTASSERT(ent.get_pending_dl_harq(tti_tx_dl) == find_oldest_pending_harq(ent, tti_tx_dl));
+    TESTASSERT(ent.get_empty_dl_harq(tti_tx_dl) == find_empty_harq(ent));
+
+    // Schedule a retx or a new tx, like the scheduler does
+    dl_harq_proc* h = ent.get_pending_dl_harq(tti_tx_dl);
+    if (h != nullptr) {
+      for (uint32_t tb = 0; tb < SRSLTE_MAX_TB; tb++) {
+        if (h->has_pending_retx(tb, tti_tx_dl)) {
+          h->new_retx(mask, tb, tti_tx_dl, nullptr, nullptr, 0);
+        }
+      }
+    } else if (rand_pct(rand_gen) < 70 and (h = ent.get_empty_dl_harq(tti_tx_dl)) != nullptr) {
+      h->new_tx(mask, 0, tti_tx_dl, 10, 1000, 0);
+      if (rand_pct(rand_gen) < 30) {
+        h->new_tx(mask, 1, tti_tx_dl, 10, 1000, 0);
+      }
+    }
+  }
+
+  // Every process is empty after a reset
+  ent.reset();
+  TESTASSERT(ent.get_pending_dl_harq(0) == nullptr);
+  TESTASSERT(ent.get_empty_dl_harq(0) != nullptr);
+
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  srslte::logmap::set_default_log_level(srslte::LOG_LEVEL_NONE);
+
+  TESTASSERT(test_dl_harq_masks() == SRSLTE_SUCCESS);
+
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
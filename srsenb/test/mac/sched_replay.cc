@@ -0,0 +1,279 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/*
+ * Replays a trace of the scheduler inputs recorded by a running eNB (scheduler.trace_filename) against the scheduler,
+ * and reports the scheduling time per TTI, the peak memory and the share of the PRBs that were allocated. The
+ * scheduler arguments can be changed to compare them under the same load.
+ */
+
+#include "scheduler_test_common.h"
+#include "srsenb/hdr/stack/mac/scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace srsenb;
+
+static const char*                   trace_filename = nullptr;
+static sched_interface::sched_args_t sched_args     = {};
+
+void usage(char* prog)
+{
+  printf("Usage: %s -f trace_file\n", prog);
+  printf("\t-p Scheduler policy (time_rr, pf or max_ci) [Default %s]\n", sched_args.policy.c_str());
+  printf("\t-w Number of threads allocating the carriers in parallel [Default %d]\n", sched_args.nof_cc_workers);
+  printf("\t-l Maximum number of PDCCH allocation combinations [Default %d]\n", sched_args.max_pdcch_leaves);
+  printf("\t-c Maximum number of control symbols [Default %d]\n", sched_args.max_nof_ctrl_symbols);
+  printf("\t-b Target BLER of the link adaptation, 0 to disable [Default %.2f]\n", sched_args.target_bler);
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "fpwlcb")) != -1) {
+    switch (opt) {
+      case 'f':
+        trace_filename = argv[optind];
+        break;
+      case 'p':
+        sched_args.policy = argv[optind];
+        break;
+      case 'w':
+        sched_args.nof_cc_workers = (uint32_t)strtol(argv[optind], nullptr, 10);
+        break;
+      case 'l':
+        sched_args.max_pdcch_leaves = (uint32_t)strtol(argv[optind], nullptr, 10);
+        break;
+      case 'c':
+        sched_args.max_nof_ctrl_symbols = (uint32_t)strtol(argv[optind], nullptr, 10);
+        break;
+      case 'b':
+        sched_args.target_bler = strtof(argv[optind], nullptr);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+  if (trace_filename == nullptr) {
+    usage(argv[0]);
+    exit(-1);
+  }
+}
+
+struct replay_stats {
+  std::vector<double> tti_us;
+  uint64_t            nof_events = 0;
+  uint64_t            dl_prbs = 0, dl_tot_prbs = 0, dl_bytes = 0;
+  uint64_t            ul_prbs = 0, ul_tot_prbs = 0, ul_bytes = 0;
+};
+
+static void count_dl(const srslte_cell_t& cell, const sched_interface::dl_sched_res_t& res, replay_stats& stats)
+{
+  srslte::bounded_bitset<100, true> prbs(cell.nof_prb), mask;
+  auto add_dci = [&](const srslte_dci_dl_t& dci, uint32_t tbs) {
+    if (extract_dl_prbmask(cell, dci, &mask) == SRSLTE_SUCCESS) {
+      prbs |= mask;
+    }
+    stats.dl_bytes += tbs;
+  };
+  for (uint32_t i = 0; i < res.nof_data_elems; ++i) {
+    add_dci(res.data[i].dci, res.data[i].tbs[0] + res.data[i].tbs[1]);
+  }
+  for (uint32_t i = 0; i < res.nof_rar_elems; ++i) {
+    add_dci(res.rar[i].dci, res.rar[i].tbs);
+  }
+  for (uint32_t i = 0; i < res.nof_bc_elems; ++i) {
+    add_dci(res.bc[i].dci, res.bc[i].tbs);
+  }
+  stats.dl_prbs += prbs.count();
+  stats.dl_tot_prbs += cell.nof_prb;
+}
+
+static void count_ul(const srslte_cell_t& cell, const sched_interface::ul_sched_res_t& res, replay_stats& stats)
+{
+  for (uint32_t i = 0; i < res.nof_dci_elems; ++i) {
+    uint32_t L = 0, rb_start = 0;
+    srslte_ra_type2_from_riv(res.pusch[i].dci.type2_alloc.riv, &L, &rb_start, cell.nof_prb, cell.nof_prb);
+    stats.ul_prbs += L;
+    stats.ul_bytes += res.pusch[i].tbs;
+  }
+  stats.ul_tot_prbs += cell.nof_prb;
+}
+
+int replay(FILE* f, sched& sched_obj, replay_stats& stats)
+{
+  using clock = std::chrono::steady_clock;
+
+  std::vector<sched_interface::cell_cfg_t> cells, pending_cells;
+  sched_interface::dl_sched_res_t          dl_res;
+  sched_interface::ul_sched_res_t          ul_res;
+  std::string                              name;
+  sched_trace::args_t                      a;
+  double                                   tti_us = 0;
+  bool                                     in_tti = false;
+
+  while (sched_trace::read_event(f, &name, &a)) {
+    stats.nof_events++;
+    if (name == "cell") {
+      pending_cells.emplace_back();
+      TESTASSERT(sched_trace::decode_cell_cfg(a, &pending_cells.back()));
+    } else if (name == "cell_cfg") {
+      cells = std::move(pending_cells);
+      pending_cells.clear();
+      TESTASSERT(sched_obj.cell_cfg(cells) == SRSLTE_SUCCESS);
+    } else if (name == "ue_cfg") {
+      sched_interface::ue_cfg_t ue_cfg;
+      TESTASSERT(sched_trace::decode_ue_cfg(a, &ue_cfg));
+      sched_obj.ue_cfg(a[0], ue_cfg);
+    } else if (name == "dl_sched" or name == "ul_sched") {
+      TESTASSERT(a.size() == 2 and a[1] < (int64_t)cells.size());
+      // A new TTI starts with the DL of the first carrier
+      if (name == "dl_sched" and a[1] == 0) {
+        if (in_tti) {
+          stats.tti_us.push_back(tti_us);
+        }
+        in_tti = true;
+        tti_us = 0;
+      }
+      auto tic = clock::now();
+      if (name == "dl_sched") {
+        sched_obj.dl_sched(a[0], a[1], dl_res);
+      } else {
+        sched_obj.ul_sched(a[0], a[1], ul_res);
+      }
+      tti_us += std::chrono::duration<double, std::micro>(clock::now() - tic).count();
+      if (name == "dl_sched") {
+        count_dl(cells[a[1]].cell, dl_res, stats);
+      } else {
+        count_ul(cells[a[1]].cell, ul_res, stats);
+      }
+    } else if (name == "ue_rem") {
+      sched_obj.ue_rem(a.at(0));
+    } else if (name == "phy_cfg") {
+      sched_obj.phy_config_enabled(a.at(0), a.at(1));
+    } else if (name == "bearer_cfg") {
+      sched_interface::ue_bearer_cfg_t cfg;
+      cfg.direction = (sched_interface::ue_bearer_cfg_t::direction_t)a.at(2);
+      cfg.group     = a.at(3);
+      cfg.priority  = a.at(4);
+      cfg.pbr       = a.at(5);
+      cfg.bsd       = a.at(6);
+      sched_obj.bearer_ue_cfg(a[0], a[1], &cfg);
+    } else if (name == "bearer_rem") {
+      sched_obj.bearer_ue_rem(a.at(0), a.at(1));
+    } else if (name == "dl_rlc_bs") {
+      sched_obj.dl_rlc_buffer_state(a.at(0), a.at(1), a.at(2), a.at(3));
+    } else if (name == "dl_mac_bs") {
+      sched_obj.dl_mac_buffer_state(a.at(0), a.at(1), a.at(2));
+    } else if (name == "dl_ack") {
+      sched_obj.dl_ack_info(a.at(0), a.at(1), a.at(2), a.at(3), a.at(4));
+    } else if (name == "ul_crc") {
+      sched_obj.ul_crc_info(a.at(0), a.at(1), a.at(2), a.at(3));
+    } else if (name == "dl_ri") {
+      sched_obj.dl_ri_info(a.at(0), a.at(1), a.at(2), a.at(3));
+    } else if (name == "dl_pmi") {
+      sched_obj.dl_pmi_info(a.at(0), a.at(1), a.at(2), a.at(3));
+    } else if (name == "dl_cqi") {
+      sched_obj.dl_cqi_info(a.at(0), a.at(1), a.at(2), a.at(3));
+    } else if (name == "dl_sb_cqi") {
+      sched_obj.dl_sb_cqi_info(a.at(0), a.at(1), a.at(2), a.at(3), a.at(4));
+    } else if (name == "dl_rach") {
+      sched_interface::dl_sched_rar_info_t rar_info = {};
+      rar_info.preamble_idx                         = a.at(1);
+      rar_info.ta_cmd                               = a.at(2);
+      rar_info.temp_crnti                           = a.at(3);
+      rar_info.msg3_size                            = a.at(4);
+      rar_info.prach_tti                            = a.at(5);
+      sched_obj.dl_rach_info(a[0], rar_info);
+    } else if (name == "ul_cqi") {
+      sched_obj.ul_cqi_info(a.at(0), a.at(1), a.at(2), a.at(3), a.at(4));
+    } else if (name == "ul_sb_cqi") {
+      sched_obj.ul_sb_cqi_info(a.at(0), a.at(1), a.at(2), a.at(3), a.at(4));
+    } else if (name == "ul_bsr") {
+      sched_obj.ul_bsr(a.at(0), a.at(1), a.at(2));
+    } else if (name == "ul_buffer_add") {
+      sched_obj.ul_buffer_add(a.at(0), a.at(1), a.at(2));
+    } else if (name == "ul_phr") {
+      sched_obj.ul_phr(a.at(0), a.at(1));
+    } else if (name == "ul_sr") {
+      sched_obj.ul_sr_info(a.at(0), a.at(1));
+    } else {
+      printf("Skipping unknown event \"%s\"\n", name.c_str());
+    }
+  }
+  if (in_tti) {
+    stats.tti_us.push_back(tti_us);
+  }
+  return SRSLTE_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+  srslte::logmap::set_default_log_level(srslte::LOG_LEVEL_NONE);
+
+  FILE* f = fopen(trace_filename, "r");
+  if (f == nullptr) {
+    perror("fopen");
+    return SRSLTE_ERROR;
+  }
+
+  sched sched_obj;
+  sched_obj.init(nullptr);
+  sched_obj.set_sched_cfg(&sched_args);
+
+  replay_stats stats;
+  int          ret = replay(f, sched_obj, stats);
+  fclose(f);
+  if (ret != SRSLTE_SUCCESS or stats.tti_us.empty()) {
+    printf("No TTI was scheduled\n");
+    return SRSLTE_ERROR;
+  }
+
+  std::vector<double> t = stats.tti_us;
+  std::sort(t.begin(), t.end());
+  auto percentile = [&t](double p) { return t[std::min((size_t)(p * t.size()), t.size() - 1)]; };
+
+  struct rusage usage = {};
+  getrusage(RUSAGE_SELF, &usage);
+
+  printf("Replayed %zd TTIs (%" PRIu64 " events) with policy=%s\n",
+         t.size(),
+         stats.nof_events,
+         sched_args.policy.c_str());
+  printf("Scheduling time per TTI: p50=%.1f us, p99=%.1f us, max=%.1f us\n",
+         percentile(0.5),
+         percentile(0.99),
+         t.back());
+  printf("DL: %.1f%% of the PRBs allocated, %.2f Mbps\n",
+         stats.dl_tot_prbs > 0 ? 100.0 * stats.dl_prbs / stats.dl_tot_prbs : 0.0,
+         stats.dl_bytes * 8 / (t.size() * 1e3));
+  printf("UL: %.1f%% of the PRBs allocated, %.2f Mbps\n",
+         stats.ul_tot_prbs > 0 ? 100.0 * stats.ul_prbs / stats.ul_tot_prbs : 0.0,
+         stats.ul_bytes * 8 / (t.size() * 1e3));
+  printf("Peak memory: %ld kB\n", usage.ru_maxrss);
+
+  return SRSLTE_SUCCESS;
+}
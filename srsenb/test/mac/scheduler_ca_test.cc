@@ -79,7 +79,8 @@ sim_sched_args generate_default_sim_args(uint32_t nof_prb, uint32_t nof_ccs)
 }
 
 struct test_scell_activation_params {
-  uint32_t pcell_idx = 0;
+  uint32_t pcell_idx      = 0;
+  uint32_t nof_cc_workers = 0;
 };
 
 int test_scell_activation(test_scell_activation_params params)
@@ -108,9 +109,10 @@ int test_scell_activation(test_scell_activation_params params)
   std::iter_swap(cc_idxs.begin(), std::find(cc_idxs.begin(), cc_idxs.end(), params.pcell_idx));
 
   /* Setup simulation arguments struct */
-  sim_sched_args sim_args = generate_default_sim_args(nof_prb, nof_ccs);
-  sim_args.sim_log        = log_global.get();
-  sim_args.start_tti      = start_tti;
+  sim_sched_args sim_args            = generate_default_sim_args(nof_prb, nof_ccs);
+  sim_args.sim_log                   = log_global.get();
+  sim_args.start_tti                 = start_tti;
+  sim_args.sched_args.nof_cc_workers = params.nof_cc_workers;
   sim_args.default_ue_sim_cfg.ue_cfg.supported_cc_list.resize(1);
   sim_args.default_ue_sim_cfg.ue_cfg.supported_cc_list[0].active                                = true;
   sim_args.default_ue_sim_cfg.ue_cfg.supported_cc_list[0].enb_cc_idx                            = cc_idxs[0];
@@ -257,6 +259,11 @@ int main()
     p           = {};
     p.pcell_idx = 1;
     TESTASSERT(test_scell_activation(p) == SRSLTE_SUCCESS);
+
+    // Allocate the carriers in parallel
+    p                = {};
+    p.nof_cc_workers = 1;
+    TESTASSERT(test_scell_activation(p) == SRSLTE_SUCCESS);
   }
 
   return 0;
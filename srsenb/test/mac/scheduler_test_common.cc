@@ -352,10 +352,23 @@ int ue_ctxt_test::new_tti(sched* sched_ptr, srslte::tti_point tti_rx)
   TESTASSERT(fwd_pending_acks(sched_ptr) == SRSLTE_SUCCESS);
   if (sim_cfg.periodic_cqi and (tti_rx.to_uint() % sim_cfg.cqi_Npd) == sim_cfg.cqi_Noffset) {
     for (auto& cc : active_ccs) {
-      sched_ptr->dl_cqi_info(
-          tti_rx.to_uint(), rnti, cc.enb_cc_idx, std::uniform_int_distribution<uint32_t>{5, 24}(get_rand_gen()));
-      sched_ptr->ul_cqi_info(
-          tti_rx.to_uint(), rnti, cc.enb_cc_idx, std::uniform_int_distribution<uint32_t>{5, 24}(get_rand_gen()), 0);
+      uint32_t dl_cqi = std::uniform_int_distribution<uint32_t>{5, 24}(get_rand_gen());
+      sched_ptr->dl_cqi_info(tti_rx.to_uint(), rnti, cc.enb_cc_idx, dl_cqi);
+      // Subband CQIs between one below and two above the wideband CQI
+      uint32_t nof_prb = cell_params[cc.enb_cc_idx].cell.nof_prb;
+      uint32_t sb_size = srslte_cqi_hl_get_subband_size(nof_prb);
+      uint32_t nof_sb  = (nof_prb + sb_size - 1) / sb_size;
+      for (uint32_t sb = 0; sb < nof_sb; ++sb) {
+        uint32_t sb_cqi = dl_cqi + std::uniform_int_distribution<uint32_t>{0, 3}(get_rand_gen()) - 1;
+        sched_ptr->dl_sb_cqi_info(tti_rx.to_uint(), rnti, cc.enb_cc_idx, sb, sb_cqi);
+      }
+      uint32_t ul_cqi = std::uniform_int_distribution<uint32_t>{5, 24}(get_rand_gen());
+      sched_ptr->ul_cqi_info(tti_rx.to_uint(), rnti, cc.enb_cc_idx, ul_cqi, 0);
+      // Same for the UL subbands measured on the SRS
+      for (uint32_t sb = 0; sb < nof_sb; ++sb) {
+        uint32_t sb_cqi = ul_cqi + std::uniform_int_distribution<uint32_t>{0, 3}(get_rand_gen()) - 1;
+        sched_ptr->ul_sb_cqi_info(tti_rx.to_uint(), rnti, cc.enb_cc_idx, sb, sb_cqi);
+      }
     }
   }
 
@@ -1046,6 +1059,11 @@ int common_sched_tester::run_tti(const tti_ev& tti_events)
 
   ue_tester->new_tti(this, tti_info.tti_params.tti_rx);
   process_tti_events(tti_events);
+  {
+    // Apply the queued UE feedback, so that the UE state checked by the tester is the one seen by the scheduler
+    std::lock_guard<std::mutex> lock(sched_mutex);
+    process_feedback();
+  }
   before_sched();
 
   // Call scheduler for all carriers
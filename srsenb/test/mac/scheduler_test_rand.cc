@@ -313,6 +313,10 @@ int sched_tester::test_harqs()
     } else {
       CONDERROR(h->nof_retx(0) != 0, "A new harq was scheduled but with invalid number of retxs\n");
       CONDERROR(not ue_data.ul_harq.is_empty(0), "UL new tx in a UL harq that was not empty\n");
+      // Neither the CQI nor the link adaptation may pick a 64QAM MCS for a UE without UL 64QAM
+      CONDERROR(sim_args0.sched_args.pusch_mcs < 0 and pusch.dci.tb.mcs_idx > 20,
+                "UL MCS=%d exceeds the UE maximum\n",
+                pusch.dci.tb.mcs_idx);
     }
   }
 
@@ -451,6 +455,9 @@ sched_sim_events rand_sim_params(uint32_t nof_ttis)
       boolean_dist() ? -1 : std::uniform_int_distribution<>{0, 24}(srsenb::get_rand_gen());
   sim_gen.sim_args.sched_args.pusch_mcs =
       boolean_dist() ? -1 : std::uniform_int_distribution<>{0, 24}(srsenb::get_rand_gen());
+  uint32_t policy_idx                = std::uniform_int_distribution<uint32_t>{0, 2}(srsenb::get_rand_gen());
+  sim_gen.sim_args.sched_args.policy = std::array<const char*, 3>({"time_rr", "pf", "max_ci"})[policy_idx];
+  sim_gen.sim_args.sched_args.target_bler = boolean_dist() ? 0 : 0.1;
 
   generator.tti_events.resize(nof_ttis);
 
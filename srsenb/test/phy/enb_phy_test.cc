@@ -18,6 +18,7 @@
  * and at http://www.gnu.org/licenses/.
  *
  */
+#include <atomic>
 #include <boost/program_options.hpp>
 #include <boost/program_options/options_description.hpp>
 #include <boost/program_options/parsers.hpp>
@@ -34,6 +35,7 @@
 #include <srslte/phy/utils/random.h>
 #include <srslte/srslog/srslog.h>
 #include <srslte/srslte.h>
+#include <thread>
 
 static inline bool dl_ack_value(uint32_t ue_cc_idx, uint32_t tti)
 {
@@ -86,6 +88,7 @@ private:
   srslte::rf_timestamp_t            ts_rx    = {};
   double                            rx_srate = 0.0;
   bool                              running  = true;
+  std::vector<std::vector<cf_t> >   rx_float; ///< Float samples converted by rx_now_s()
 
   CALLBACK(tx);
   CALLBACK(tx_end);
@@ -142,6 +145,8 @@ public:
 
       ringbuffers_rx.push_back(rb);
     }
+
+    rx_float.resize(nof_channels, std::vector<cf_t>(SRSLTE_SF_LEN_PRB(nof_prb)));
   }
 
   ~dummy_radio()
@@ -251,6 +256,24 @@ public:
     // Return True if err >= SRSLTE_SUCCESS
     return err >= SRSLTE_SUCCESS;
   }
+  bool rx_now_s(int16_t*                        buffer[SRSLTE_MAX_CHANNELS],
+                uint32_t                        nof_samples,
+                srslte::rf_timestamp_interface& rxd_time) override
+  {
+    // Receive float samples and convert them as an int16 radio would
+    srslte::rf_buffer_t buffer_rx;
+    for (uint32_t i = 0; i < rx_float.size(); i++) {
+      buffer_rx.set(i, rx_float[i].data());
+    }
+    buffer_rx.set_nof_samples(nof_samples);
+
+    bool ret = rx_now(buffer_rx, rxd_time);
+    for (uint32_t i = 0; i < rx_float.size(); i++) {
+      srslte_vec_convert_fi((float*)rx_float[i].data(), INT16_MAX, buffer[i], 2 * nof_samples);
+    }
+    return ret;
+  }
+  bool              has_rx_s() override { return true; }
   void              release_freq(const uint32_t& carrier_idx) override{};
   void              set_tx_freq(const uint32_t& channel_idx, const double& freq) override {}
   void              set_rx_freq(const uint32_t& channel_idx, const double& freq) override {}
@@ -462,11 +485,27 @@ public:
 
     return SRSLTE_SUCCESS;
   }
+  int sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t cc_idx, uint32_t sb_idx, uint32_t cqi_value) override
+  {
+    log_h.info("Received subband CQI tti=%d; rnti=0x%x; cc_idx=%d; sb_idx=%d; cqi=%d;\n",
+               tti,
+               rnti,
+               cc_idx,
+               sb_idx,
+               cqi_value);
+
+    return SRSLTE_SUCCESS;
+  }
   int snr_info(uint32_t tti, uint16_t rnti, uint32_t cc_idx, float snr_db) override
   {
     notify_snr_info();
     return 0;
   }
+  int ul_sb_snr_info(uint32_t tti, uint16_t rnti, uint32_t cc_idx, const float* snr_db, uint32_t nof_sb) override
+  {
+    log_h.info("Received subband SNR tti=%d; rnti=0x%x; cc_idx=%d; nof_sb=%d;\n", tti, rnti, cc_idx, nof_sb);
+    return SRSLTE_SUCCESS;
+  }
   int ta_info(uint32_t tti, uint16_t rnti, float ta_us) override
   {
     log_h.info("Received TA INFO tti=%d; rnti=0x%x; ta=%.1f us\n", tti, rnti, ta_us);
@@ -506,8 +545,10 @@ public:
     // Notify test engine
     notify_get_dl_sched();
 
-    /// Make sure it writes the first cell always
-    dl_sched_res[0].cfi = cfi;
+    /// Make sure it writes the CFI of every cell always, including the cells without scheduling
+    for (auto& dl_sched : dl_sched_res) {
+      dl_sched.cfi = cfi;
+    }
 
     // Iterate for each carrier
     uint32_t ue_cc_idx = 0;
@@ -897,6 +938,22 @@ public:
     srslte_softbuffer_tx_free(&softbuffer_tx);
   }
 
+  void set_pci(uint32_t cc_idx, uint32_t pci)
+  {
+    srslte_cell_t cell = ue_dl_v[cc_idx]->cell;
+    cell.id            = pci;
+
+    // Changing the cell generates the cell dependent sequences again, the RNTI ones are generated again too
+    if (srslte_ue_dl_set_cell(ue_dl_v[cc_idx], cell)) {
+      ERROR("Setting UE DL cell\n");
+    }
+    srslte_ue_dl_set_rnti(ue_dl_v[cc_idx], rnti);
+    if (srslte_ue_ul_set_cell(ue_ul_v[cc_idx], cell)) {
+      ERROR("Setting UE UL cell\n");
+    }
+    srslte_ue_ul_set_rnti(ue_ul_v[cc_idx], rnti);
+  }
+
   void reconfigure(const srsenb::phy_interface_rrc_lte::phy_rrc_cfg_list_t& phy_rrc_cfg_)
   {
     // Copy new configuration
@@ -1147,6 +1204,8 @@ public:
     std::string           log_level           = "none";
     uint32_t              tm_u32              = 1;
     uint32_t              period_pcell_rotate = 0;
+    uint32_t              period_pci_change   = 0;
+    bool                  rx_int16            = false;
     srslte_tm_t           tm                  = SRSLTE_TM1;
     args_t()
     {
@@ -1200,9 +1259,16 @@ private:
     change_state_assert = 0,
     change_state_flush,
     change_state_wait_steady,
+    change_state_pci_flush,
+    change_state_pci_reconfigure,
   } change_state_t;
   change_state_t change_state = change_state_assert;
 
+  // The eNb PHY reconfiguration waits for the TTIs in flight, which need the UE, so it runs in its own thread
+  std::thread       pci_thread;
+  std::atomic<bool> pci_done{false};
+  int               pci_ret = SRSLTE_SUCCESS;
+
 public:
   phy_test_bench(args_t& args_, srslte::logger& logger_) : log_h("TEST BENCH")
   {
@@ -1215,6 +1281,7 @@ public:
     // PHY arguments
     phy_args.log.phy_level   = args.log_level;
     phy_args.nof_phy_threads = 1; ///< Set number of phy threads to 1 for avoiding concurrency issues
+    phy_args.rx_int16        = args.rx_int16;
 
     // Create cell configuration
     phy_cfg.phy_cell_cfg.resize(args.nof_enb_cells);
@@ -1321,6 +1388,9 @@ public:
   {
     radio->stop();
     enb_phy->stop();
+    if (pci_thread.joinable()) {
+      pci_thread.join();
+    }
   }
 
   ~phy_test_bench() = default;
@@ -1343,6 +1413,13 @@ public:
 
           change_state = change_state_flush;
           tti_counter  = 0;
+        } else if (args.period_pci_change > 0 and tti_counter >= args.period_pci_change) {
+          log_h.warning("******* PCI change: Disable scheduling *******\n");
+          std::vector<uint32_t> active_cells;
+          stack->set_active_cell_list(active_cells);
+
+          change_state = change_state_pci_flush;
+          tti_counter  = 0;
         }
         break;
       case change_state_flush:
@@ -1372,6 +1449,42 @@ public:
           tti_counter  = 0;
         }
         break;
+      case change_state_pci_flush:
+        if (tti_counter >= 2 * FDD_HARQ_DELAY_DL_MS + FDD_HARQ_DELAY_UL_MS) {
+          log_h.warning("******* PCI change: Reconfigure *******\n");
+
+          // Change the PCI of every eNb cell, keeping them different
+          for (auto& q : phy_cfg.phy_cell_cfg) {
+            q.cell.id = (q.cell.id + args.nof_enb_cells) % SRSLTE_NUM_PCI;
+          }
+
+          pci_done   = false;
+          pci_thread = std::thread([this]() {
+            pci_ret = SRSLTE_SUCCESS;
+            for (uint32_t cc_idx = 0; cc_idx < phy_cfg.phy_cell_cfg.size(); cc_idx++) {
+              pci_ret |= enb_phy->reconfigure_cell(cc_idx, phy_cfg.phy_cell_cfg[cc_idx].cell);
+            }
+            pci_done = true;
+          });
+
+          change_state = change_state_pci_reconfigure;
+          tti_counter  = 0;
+        }
+        break;
+      case change_state_pci_reconfigure:
+        if (pci_done) {
+          pci_thread.join();
+          TESTASSERT(pci_ret == SRSLTE_SUCCESS);
+
+          // The UE follows the eNb once it has changed
+          for (uint32_t cc_idx = 0; cc_idx < phy_cfg.phy_cell_cfg.size(); cc_idx++) {
+            ue_phy->set_pci(cc_idx, phy_cfg.phy_cell_cfg[cc_idx].cell.id);
+          }
+
+          change_state = change_state_wait_steady;
+          tti_counter  = 0;
+        }
+        break;
       case change_state_wait_steady:
         if (tti_counter >= FDD_HARQ_DELAY_DL_MS + FDD_HARQ_DELAY_UL_MS) {
           log_h.warning("******* Cell rotation: Enable scheduling *******\n");
@@ -1420,6 +1533,8 @@ int parse_args(int argc, char** argv, phy_test_bench::args_t& args)
       ("cell.nof_ports", bpo::value<uint32_t>(&args.cell.nof_ports)->default_value(args.cell.nof_ports), "eNb Cell/Carrier number of ports")
       ("tm", bpo::value<uint32_t>(&args.tm_u32)->default_value(args.tm_u32),                             "Transmission mode")
       ("rotation", bpo::value<uint32_t>(&args.period_pcell_rotate),                      "Serving cells rotation period in ms, set to zero to disable")
+      ("pci_change", bpo::value<uint32_t>(&args.period_pci_change),                      "Cells PCI change period in ms, set to zero to disable")
+      ("rx_int16", bpo::value<bool>(&args.rx_int16),                                     "Receive the UL as int16 samples")
       ;
   options.add(common).add_options()("help", "Show this message");
   // clang-format on
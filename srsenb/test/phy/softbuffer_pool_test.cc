@@ -0,0 +1,200 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/mac/softbuffer_pool.h"
+#include "srslte/common/test_common.h"
+#include <array>
+#include <set>
+
+using namespace srsenb;
+
+const uint32_t nof_prb      = 25;
+const uint32_t nof_harq     = 8;
+const uint32_t small_tbs    = 100;  // bytes, a single code block
+const uint32_t large_tbs    = 3000; // bytes, several code blocks, only fits the cell bandwidth class
+const uint32_t too_long_tbs = 9000; // bytes, more than the cell bandwidth can carry
+
+int test_uninitialized()
+{
+  softbuffer_pool         pool;
+  srslte_softbuffer_tx_t* tx = nullptr;
+  srslte_softbuffer_rx_t* rx = nullptr;
+
+  // Without size classes there is nothing to reserve
+  TESTASSERT(pool.reserve(&tx, small_tbs) == nullptr);
+  TESTASSERT(pool.reserve(&rx, small_tbs) == nullptr);
+  TESTASSERT(tx == nullptr and rx == nullptr);
+  TESTASSERT(pool.nof_tx_allocated() == 0 and pool.nof_rx_allocated() == 0);
+
+  // Releasing an empty slot does nothing
+  pool.release(&tx);
+  pool.release(&rx);
+
+  return SRSLTE_SUCCESS;
+}
+
+int test_reserve_release()
+{
+  softbuffer_pool pool;
+  pool.init(nof_prb);
+
+  // A TB takes a softbuffer that fits it
+  srslte_softbuffer_tx_t* tx = nullptr;
+  TESTASSERT(pool.reserve(&tx, small_tbs) != nullptr);
+  TESTASSERT(tx != nullptr and tx->max_cb >= 1);
+  TESTASSERT(pool.nof_tx_allocated() == 1);
+  srslte_softbuffer_tx_t* small = tx;
+
+  // A TB that still fits keeps the softbuffer of the slot
+  TESTASSERT(pool.reserve(&tx, small_tbs) == small);
+  TESTASSERT(pool.nof_tx_allocated() == 1);
+
+  // A larger TB moves the slot to a larger class, and the small softbuffer goes back to the pool
+  TESTASSERT(pool.reserve(&tx, large_tbs) != small);
+  TESTASSERT(tx->max_cb > small->max_cb);
+  TESTASSERT(pool.nof_tx_allocated() == 2);
+  srslte_softbuffer_tx_t* large = tx;
+
+  srslte_softbuffer_tx_t* tx2 = nullptr;
+  TESTASSERT(pool.reserve(&tx2, small_tbs) == small);
+  TESTASSERT(pool.nof_tx_allocated() == 2);
+
+  // A TB longer than the cell bandwidth allows gets the largest class instead of failing
+  srslte_softbuffer_tx_t* tx3 = nullptr;
+  TESTASSERT(pool.reserve(&tx3, too_long_tbs) != nullptr);
+  TESTASSERT(tx3->max_cb == large->max_cb);
+  TESTASSERT(pool.reserve(&tx, too_long_tbs) == large);
+
+  // Releasing empties the slot
+  pool.release(&tx);
+  pool.release(&tx2);
+  pool.release(&tx3);
+  TESTASSERT(tx == nullptr and tx2 == nullptr and tx3 == nullptr);
+  TESTASSERT(pool.nof_tx_allocated() == 3);
+
+  // The same applies to the RX softbuffers, 8-bit ones included
+  for (bool rx_8bit : {false, true}) {
+    softbuffer_pool rx_pool;
+    rx_pool.init(nof_prb, rx_8bit);
+    srslte_softbuffer_rx_t* rx = nullptr;
+    TESTASSERT(rx_pool.reserve(&rx, large_tbs) != nullptr);
+    TESTASSERT(rx->is_8bit == rx_8bit);
+    srslte_softbuffer_rx_t* first = rx;
+    rx_pool.release(&rx);
+    TESTASSERT(rx == nullptr);
+    TESTASSERT(rx_pool.reserve(&rx, large_tbs) == first);
+    TESTASSERT(rx_pool.nof_rx_allocated() == 1);
+  }
+
+  return SRSLTE_SUCCESS;
+}
+
+int test_exhaustion()
+{
+  softbuffer_pool pool;
+  pool.init(nof_prb);
+
+  // Once the free softbuffers of a class run out, the pool allocates new ones
+  std::array<srslte_softbuffer_rx_t*, 4 * nof_harq> slots = {};
+  std::set<srslte_softbuffer_rx_t*>                 taken;
+  for (uint32_t i = 0; i < slots.size(); i++) {
+    TESTASSERT(pool.reserve(&slots[i], large_tbs) != nullptr);
+    taken.insert(slots[i]);
+    TESTASSERT(pool.nof_rx_allocated() == i + 1);
+  }
+  // No softbuffer is handed to two slots
+  TESTASSERT(taken.size() == slots.size());
+
+  // Once they are released, the same number of slots does not allocate again
+  for (srslte_softbuffer_rx_t*& s : slots) {
+    pool.release(&s);
+  }
+  for (srslte_softbuffer_rx_t*& s : slots) {
+    TESTASSERT(pool.reserve(&s, large_tbs) != nullptr);
+    TESTASSERT(taken.count(s) == 1);
+  }
+  TESTASSERT(pool.nof_rx_allocated() == slots.size());
+
+  // Another size class does not take from the free softbuffers of a different one
+  srslte_softbuffer_rx_t* small = nullptr;
+  TESTASSERT(pool.reserve(&small, small_tbs) != nullptr);
+  TESTASSERT(taken.count(small) == 0);
+  TESTASSERT(pool.nof_rx_allocated() == slots.size() + 1);
+
+  return SRSLTE_SUCCESS;
+}
+
+int test_reuse_across_rntis()
+{
+  softbuffer_pool pool;
+  pool.init(nof_prb);
+
+  // The first UE fills its HARQ processes, leaving decoding state in the softbuffers
+  std::array<srslte_softbuffer_rx_t*, nof_harq> ue1 = {};
+  std::set<srslte_softbuffer_rx_t*>             ue1_buffers;
+  for (srslte_softbuffer_rx_t*& s : ue1) {
+    TESTASSERT(pool.reserve(&s, large_tbs) != nullptr);
+    ue1_buffers.insert(s);
+    s->tb_crc = true;
+    for (uint32_t cb = 0; cb < s->max_cb; cb++) {
+      s->cb_crc[cb] = true;
+    }
+  }
+
+  // The first UE is removed and a second one connects
+  for (srslte_softbuffer_rx_t*& s : ue1) {
+    pool.release(&s);
+  }
+  std::array<srslte_softbuffer_rx_t*, nof_harq> ue2 = {};
+  for (srslte_softbuffer_rx_t*& s : ue2) {
+    TESTASSERT(pool.reserve(&s, large_tbs) != nullptr);
+
+    // The second UE takes the softbuffers of the first one, without its state
+    TESTASSERT(ue1_buffers.count(s) == 1);
+    TESTASSERT(not s->tb_crc);
+    for (uint32_t cb = 0; cb < s->max_cb; cb++) {
+      TESTASSERT(not s->cb_crc[cb]);
+    }
+  }
+  TESTASSERT(pool.nof_rx_allocated() == nof_harq);
+
+  // Both UEs active at the same time do not share softbuffers
+  for (srslte_softbuffer_rx_t*& s : ue1) {
+    TESTASSERT(pool.reserve(&s, large_tbs) != nullptr);
+    for (srslte_softbuffer_rx_t* s2 : ue2) {
+      TESTASSERT(s != s2);
+    }
+  }
+  TESTASSERT(pool.nof_rx_allocated() == 2 * nof_harq);
+
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_uninitialized() == SRSLTE_SUCCESS);
+  TESTASSERT(test_reserve_release() == SRSLTE_SUCCESS);
+  TESTASSERT(test_exhaustion() == SRSLTE_SUCCESS);
+  TESTASSERT(test_reuse_across_rntis() == SRSLTE_SUCCESS);
+
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
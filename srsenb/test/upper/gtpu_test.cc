@@ -0,0 +1,194 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/upper/gtpu.h"
+#include "srslte/common/test_common.h"
+#include "srslte/upper/gtpu.h"
+#include <algorithm>
+#include <linux/ip.h>
+
+class pdcp_dummy : public srsenb::pdcp_interface_gtpu
+{
+public:
+  struct call_t {
+    uint16_t rnti;
+    uint32_t lcid;
+    uint32_t nof_sdus;
+  };
+
+  void write_sdu(uint16_t rnti, uint32_t lcid, srslte::unique_byte_buffer_t sdu) override
+  {
+    calls.push_back({rnti, lcid, 1});
+  }
+  void write_sdus(uint16_t rnti, uint32_t lcid, std::vector<srslte::unique_byte_buffer_t>& sdus) override
+  {
+    calls.push_back({rnti, lcid, (uint32_t)sdus.size()});
+    sdus.clear();
+  }
+
+  std::vector<call_t> calls;
+};
+
+class stack_dummy : public srsenb::stack_interface_gtpu_lte
+{
+public:
+  void add_gtpu_s1u_socket_handler(int fd) override {}
+  void add_gtpu_m1u_socket_handler(int fd) override {}
+};
+
+const uint32_t SPGW_ADDR = 0x7f000002; // 127.0.0.2
+
+srslte::unique_byte_buffer_t make_ip_packet(uint32_t len)
+{
+  srslte::unique_byte_buffer_t pdu    = srslte::allocate_unique_buffer(*srslte::byte_buffer_pool::get_instance());
+  struct iphdr*                ip_pkt = (struct iphdr*)pdu->msg;
+  memset(pdu->msg, 0, len);
+  ip_pkt->version = 4;
+  ip_pkt->tot_len = htons(len);
+  pdu->N_bytes    = len;
+  return pdu;
+}
+
+srslte::rx_multisocket_handler::rx_datagram_t make_gtpu_packet(uint32_t teid, uint32_t len)
+{
+  srslte::rx_multisocket_handler::rx_datagram_t d;
+  d.pdu  = make_ip_packet(len);
+  d.from = {};
+
+  srslte::gtpu_header_t header = {};
+  header.flags                 = GTPU_FLAGS_VERSION_V1 | GTPU_FLAGS_GTP_PROTOCOL;
+  header.message_type          = GTPU_MSG_DATA_PDU;
+  header.length                = len;
+  header.teid                  = teid;
+  srslte::gtpu_write_header(&header, d.pdu.get(), srslte::logmap::get("GTPU"));
+  return d;
+}
+
+/*
+ * Data PDUs of a batch are passed to PDCP with one call per run of PDUs of the same bearer
+ */
+int test_rx_batch()
+{
+  pdcp_dummy   pdcp;
+  stack_dummy  stack;
+  srsenb::gtpu gtpu;
+  TESTASSERT(gtpu.init("127.0.0.1", "127.0.0.1", "", "", &pdcp, &stack) == SRSLTE_SUCCESS);
+
+  const uint16_t        nof_users = 200;
+  std::vector<uint32_t> teids_in;
+  for (uint16_t rnti = 0x46; rnti < 0x46 + nof_users; ++rnti) {
+    teids_in.push_back(gtpu.add_bearer(rnti, 3, SPGW_ADDR, rnti));
+    teids_in.push_back(gtpu.add_bearer(rnti, 4, SPGW_ADDR, rnti + 0x1000));
+  }
+  // The TEIDs of the removed bearers are reused with a new generation, and the old TEIDs no longer match
+  for (uint16_t rnti = 0x46; rnti < 0x46 + nof_users; rnti += 2) {
+    gtpu.rem_user(rnti);
+  }
+  std::vector<uint32_t> teids_reused;
+  for (uint16_t rnti = 0x1000; rnti < 0x1000 + nof_users; ++rnti) {
+    teids_reused.push_back(gtpu.add_bearer(rnti, 3, SPGW_ADDR, rnti));
+    TESTASSERT(std::find(teids_in.begin(), teids_in.end(), teids_reused.back()) == teids_in.end());
+  }
+
+  for (uint16_t i = 0; i < nof_users; ++i) {
+    srslte::rx_multisocket_handler::recvfrom_batch_t batch;
+    batch.push_back(make_gtpu_packet(teids_in[2 * i], 100));
+    batch.push_back(make_gtpu_packet(teids_in[2 * i], 101));
+    batch.push_back(make_gtpu_packet(teids_in[2 * i + 1], 102));
+    batch.push_back(make_gtpu_packet(0xffff, 103));
+    batch.push_back(make_gtpu_packet(teids_in[2 * i + 1], 104));
+    pdcp.calls.clear();
+    gtpu.handle_gtpu_s1u_rx_batch(std::move(batch));
+
+    uint16_t rnti = 0x46 + i;
+    if (i % 2 == 0) {
+      TESTASSERT(pdcp.calls.empty());
+      continue;
+    }
+    TESTASSERT(pdcp.calls.size() == 2);
+    TESTASSERT(pdcp.calls[0].rnti == rnti and pdcp.calls[0].lcid == 3 and pdcp.calls[0].nof_sdus == 2);
+    TESTASSERT(pdcp.calls[1].rnti == rnti and pdcp.calls[1].lcid == 4 and pdcp.calls[1].nof_sdus == 2);
+  }
+
+  // The RNTI change is seen by the TEID lookup
+  gtpu.mod_bearer_rnti(0x47, 0x20);
+  srslte::rx_multisocket_handler::recvfrom_batch_t batch;
+  batch.push_back(make_gtpu_packet(teids_in[2], 100));
+  pdcp.calls.clear();
+  gtpu.handle_gtpu_s1u_rx_batch(std::move(batch));
+  TESTASSERT(pdcp.calls.size() == 1 and pdcp.calls[0].rnti == 0x20);
+
+  batch.clear();
+  batch.push_back(make_gtpu_packet(teids_reused[0], 100));
+  pdcp.calls.clear();
+  gtpu.handle_gtpu_s1u_rx_batch(std::move(batch));
+  TESTASSERT(pdcp.calls.size() == 1 and pdcp.calls[0].rnti == 0x1000 and pdcp.calls[0].lcid == 3);
+
+  gtpu.stop();
+  return SRSLTE_SUCCESS;
+}
+
+/*
+ * Uplink PDUs are sent when the batch is full or flushed
+ */
+int test_tx_batch()
+{
+  pdcp_dummy   pdcp;
+  stack_dummy  stack;
+  srsenb::gtpu gtpu;
+  TESTASSERT(gtpu.init("127.0.0.1", "127.0.0.1", "", "", &pdcp, &stack) == SRSLTE_SUCCESS);
+  gtpu.add_bearer(0x46, 3, SPGW_ADDR, 0x1234);
+
+  // SPGW side
+  using namespace srslte::net_utils;
+  int spgw_fd = open_socket(addr_family::ipv4, socket_type::datagram, protocol_type::UDP);
+  TESTASSERT(spgw_fd >= 0);
+  TESTASSERT(bind_addr(spgw_fd, "127.0.0.2", 2152));
+
+  const uint32_t nof_pdus = 40;
+  for (uint32_t i = 0; i < nof_pdus; ++i) {
+    gtpu.write_pdu(0x46, 3, make_ip_packet(100 + i));
+  }
+  uint8_t buf[2048];
+  for (uint32_t i = 0; i < 32; ++i) {
+    TESTASSERT(recv(spgw_fd, buf, sizeof(buf), 0) == (ssize_t)(100 + i + GTPU_BASE_HEADER_LEN));
+    TESTASSERT(buf[4] == 0 and buf[5] == 0 and buf[6] == 0x12 and buf[7] == 0x34);
+  }
+  TESTASSERT(recv(spgw_fd, buf, sizeof(buf), MSG_DONTWAIT) == -1);
+  gtpu.flush_tx();
+  for (uint32_t i = 32; i < nof_pdus; ++i) {
+    TESTASSERT(recv(spgw_fd, buf, sizeof(buf), 0) == (ssize_t)(100 + i + GTPU_BASE_HEADER_LEN));
+  }
+
+  close(spgw_fd);
+  gtpu.stop();
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  srslte::logmap::set_default_log_level(srslte::LOG_LEVEL_NONE);
+
+  TESTASSERT(test_rx_batch() == SRSLTE_SUCCESS);
+  TESTASSERT(test_tx_batch() == SRSLTE_SUCCESS);
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
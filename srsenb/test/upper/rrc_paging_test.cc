@@ -0,0 +1,97 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/rrc/rrc_paging.h"
+#include "srslte/common/test_common.h"
+
+using namespace asn1::rrc;
+using srsenb::paging_manager;
+
+paging_record_s make_tmsi_record(uint32_t m_tmsi)
+{
+  paging_record_s record;
+  record.ue_id.set_s_tmsi();
+  record.ue_id.s_tmsi().mmec.from_number(1);
+  record.ue_id.s_tmsi().m_tmsi.from_number(m_tmsi);
+  record.cn_domain = paging_record_s::cn_domain_e_::ps;
+  return record;
+}
+
+// T = 128, nB = T: one paging occasion in subframe 9 of the radio frames with SFN mod 128 = UE_ID mod 128
+int test_paging_occasion()
+{
+  paging_manager        pager(128, 128);
+  srslte::byte_buffer_t pdu;
+  pcch_msg_s            msg;
+
+  uint32_t ueid = 1000;
+  TESTASSERT(pager.add_paging_record(ueid, make_tmsi_record(5)));
+  TESTASSERT(not pager.add_paging_record(ueid, make_tmsi_record(5)));
+  TESTASSERT(pager.nof_records() == 1);
+
+  uint32_t pf = ueid % 128;
+  for (uint32_t tti = 0; tti < 10240; tti++) {
+    bool is_po = (tti / 10) % 128 == pf and tti % 10 == 9;
+    TESTASSERT((pager.pending_pcch_bytes(tti) > 0) == is_po);
+  }
+
+  uint32_t tti = 10 * pf + 9;
+  TESTASSERT(pager.pop_pcch(tti - 1, &pdu, &msg) == 0);
+  TESTASSERT(pager.pop_pcch(tti, &pdu, &msg) == 1);
+  TESTASSERT(pdu.N_bytes > 0);
+  TESTASSERT(msg.msg.c1().paging().paging_record_list.size() == 1);
+  TESTASSERT(msg.msg.c1().paging().paging_record_list[0].ue_id.s_tmsi().m_tmsi.to_number() == 5);
+  TESTASSERT(pager.pending_pcch_bytes(tti) == 0);
+  TESTASSERT(pager.nof_records() == 0);
+
+  // The message matches the one packed from the records
+  asn1::cbit_ref bref(pdu.msg, pdu.N_bytes);
+  pcch_msg_s     unpacked;
+  TESTASSERT(unpacked.unpack(bref) == asn1::SRSASN_SUCCESS);
+  TESTASSERT(unpacked.msg.c1().paging().paging_record_list.size() == 1);
+  return SRSLTE_SUCCESS;
+}
+
+// The records that don't fit in a message are sent in the next paging cycle
+int test_paging_overflow()
+{
+  paging_manager        pager(32, 32);
+  srslte::byte_buffer_t pdu;
+
+  uint32_t nof_ues = ASN1_RRC_MAX_PAGE_REC + 4;
+  for (uint32_t i = 0; i < nof_ues; i++) {
+    TESTASSERT(pager.add_paging_record(7 + 32 * i, make_tmsi_record(i)));
+  }
+  uint32_t tti = 70 + 9;
+  TESTASSERT(pager.pop_pcch(tti, &pdu, nullptr) == ASN1_RRC_MAX_PAGE_REC);
+  TESTASSERT(pager.pending_pcch_bytes(tti) > 0);
+  TESTASSERT(pager.pop_pcch(tti + 320, &pdu, nullptr) == 4);
+  TESTASSERT(pager.nof_records() == 0);
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_paging_occasion() == SRSLTE_SUCCESS);
+  TESTASSERT(test_paging_overflow() == SRSLTE_SUCCESS);
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
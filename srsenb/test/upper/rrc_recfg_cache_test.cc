@@ -0,0 +1,134 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/rrc/rrc_recfg_cache.h"
+#include "srslte/common/test_common.h"
+
+using namespace asn1::rrc;
+using srsenb::recfg_template_cache;
+
+dl_dcch_msg_s make_recfg(uint8_t transaction_id, uint16_t pucch_res, uint16_t pmi_idx, uint16_t ri_idx, uint8_t nas_len)
+{
+  dl_dcch_msg_s            msg;
+  rrc_conn_recfg_s&        recfg = msg.msg.set_c1().set_rrc_conn_recfg();
+  rrc_conn_recfg_r8_ies_s& r8    = recfg.crit_exts.set_c1().set_rrc_conn_recfg_r8();
+  recfg.rrc_transaction_id       = transaction_id;
+
+  r8.ded_info_nas_list_present = true;
+  r8.ded_info_nas_list.resize(1);
+  r8.ded_info_nas_list[0].resize(nas_len);
+  for (uint32_t i = 0; i < nas_len; i++) {
+    r8.ded_info_nas_list[0][i] = (uint8_t)(transaction_id + i);
+  }
+
+  rr_cfg_ded_s& rr_cfg_ded               = r8.rr_cfg_ded;
+  r8.rr_cfg_ded_present                  = true;
+  rr_cfg_ded.srb_to_add_mod_list_present = true;
+  rr_cfg_ded.srb_to_add_mod_list.resize(1);
+  srb_to_add_mod_s& srb = rr_cfg_ded.srb_to_add_mod_list[0];
+  srb.srb_id            = 2;
+  srb.rlc_cfg_present   = true;
+  srb.lc_ch_cfg_present = true;
+  srb.rlc_cfg.set(srb_to_add_mod_s::rlc_cfg_c_::types_opts::default_value);
+  srb.lc_ch_cfg.set(srb_to_add_mod_s::lc_ch_cfg_c_::types_opts::default_value);
+  rr_cfg_ded.drb_to_add_mod_list_present = true;
+  rr_cfg_ded.drb_to_add_mod_list.resize(1);
+  drb_to_add_mod_s& drb     = rr_cfg_ded.drb_to_add_mod_list[0];
+  drb.drb_id                = 1;
+  drb.eps_bearer_id_present = true;
+  drb.eps_bearer_id         = 5;
+  drb.lc_ch_id_present      = true;
+  drb.lc_ch_id              = 3;
+
+  phys_cfg_ded_s& phy                            = rr_cfg_ded.phys_cfg_ded;
+  rr_cfg_ded.phys_cfg_ded_present                = true;
+  phy.cqi_report_cfg_present                     = true;
+  phy.cqi_report_cfg.cqi_report_periodic_present = true;
+  cqi_report_periodic_c::setup_s_& cqi           = phy.cqi_report_cfg.cqi_report_periodic.set_setup();
+  cqi.cqi_pucch_res_idx                          = pucch_res;
+  cqi.cqi_pmi_cfg_idx                            = pmi_idx;
+  cqi.ri_cfg_idx_present                         = true;
+  cqi.ri_cfg_idx                                 = ri_idx;
+  cqi.simul_ack_nack_and_cqi                     = true;
+  cqi.cqi_format_ind_periodic.set(cqi_report_periodic_c::setup_s_::cqi_format_ind_periodic_c_::types::wideband_cqi);
+  phy.pdsch_cfg_ded_present = true;
+  phy.pdsch_cfg_ded.p_a     = pdsch_cfg_ded_s::p_a_e_::db0;
+  return msg;
+}
+
+int check_pack(recfg_template_cache& cache, const std::string& profile, const dl_dcch_msg_s& msg)
+{
+  srslte::byte_buffer_t pdu, ref;
+  TESTASSERT(cache.pack(profile, msg, &pdu));
+
+  asn1::bit_ref bref(ref.msg, ref.get_tailroom());
+  TESTASSERT(msg.pack(bref) == asn1::SRSASN_SUCCESS);
+  ref.N_bytes = bref.distance_bytes();
+  TESTASSERT(pdu.N_bytes == ref.N_bytes);
+  TESTASSERT(memcmp(pdu.msg, ref.msg, ref.N_bytes) == 0);
+  return SRSLTE_SUCCESS;
+}
+
+// The UEs of the same profile only differ in the CQI indexes, the transaction id and the NAS message
+int test_template_patch()
+{
+  recfg_template_cache cache;
+
+  TESTASSERT(check_pack(cache, "drb5", make_recfg(0, 0, 0, 0, 10)) == SRSLTE_SUCCESS);
+  TESTASSERT(cache.nof_templates() == 1);
+  TESTASSERT(cache.nof_hits() == 0);
+
+  TESTASSERT(check_pack(cache, "drb5", make_recfg(1, 1185, 1023, 1023, 11)) == SRSLTE_SUCCESS);
+  TESTASSERT(check_pack(cache, "drb5", make_recfg(2, 517, 38, 483, 1)) == SRSLTE_SUCCESS);
+  TESTASSERT(check_pack(cache, "drb5", make_recfg(3, 1, 1, 1, 200)) == SRSLTE_SUCCESS);
+  TESTASSERT(cache.nof_templates() == 1);
+  TESTASSERT(cache.nof_hits() == 3);
+  return SRSLTE_SUCCESS;
+}
+
+// A profile with a different set of CQI fields is packed without its template
+int test_template_mismatch()
+{
+  recfg_template_cache cache;
+
+  TESTASSERT(check_pack(cache, "drb5", make_recfg(0, 10, 20, 30, 10)) == SRSLTE_SUCCESS);
+  dl_dcch_msg_s msg = make_recfg(1, 10, 20, 30, 10);
+  msg.msg.c1()
+      .rrc_conn_recfg()
+      .crit_exts.c1()
+      .rrc_conn_recfg_r8()
+      .rr_cfg_ded.phys_cfg_ded.cqi_report_cfg.cqi_report_periodic.setup()
+      .ri_cfg_idx_present = false;
+  TESTASSERT(check_pack(cache, "drb5", msg) == SRSLTE_SUCCESS);
+  TESTASSERT(cache.nof_hits() == 0);
+
+  TESTASSERT(check_pack(cache, "srb2", make_recfg(1, 10, 20, 30, 10)) == SRSLTE_SUCCESS);
+  TESTASSERT(cache.nof_templates() == 2);
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  TESTASSERT(test_template_patch() == SRSLTE_SUCCESS);
+  TESTASSERT(test_template_mismatch() == SRSLTE_SUCCESS);
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
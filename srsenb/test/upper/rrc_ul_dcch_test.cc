@@ -0,0 +1,146 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/enb.h"
+#include "srsenb/src/enb_cfg_parser.h"
+#include "srslte/asn1/rrc_asn1_utils.h"
+#include "srslte/common/test_common.h"
+#include "test_helpers.h"
+#include <iostream>
+#include <unistd.h>
+
+using namespace asn1::rrc;
+
+/// Packs a UECapabilityInformation long enough to be decoded in the background task pool of the RRC
+int make_large_ue_cap_info(srslte::unique_byte_buffer_t& pdu)
+{
+  ue_eutra_cap_s cap;
+  cap.access_stratum_release.value = access_stratum_release_e::rel8;
+  cap.ue_category                  = 4;
+  cap.rf_params.supported_band_list_eutra.resize(ASN1_RRC_MAX_BANDS);
+  cap.meas_params.band_list_eutra.resize(ASN1_RRC_MAX_BANDS);
+  for (uint32_t i = 0; i < ASN1_RRC_MAX_BANDS; i++) {
+    cap.rf_params.supported_band_list_eutra[i].band_eutra = i + 1;
+    cap.meas_params.band_list_eutra[i].inter_freq_band_list.resize(ASN1_RRC_MAX_BANDS);
+  }
+
+  uint8_t       cap_buf[1024];
+  asn1::bit_ref cap_bref(cap_buf, sizeof(cap_buf));
+  TESTASSERT(cap.pack(cap_bref) == asn1::SRSASN_SUCCESS);
+
+  ul_dcch_msg_s         msg;
+  ue_cap_info_s&        ue_cap_info = msg.msg.set_c1().set_ue_cap_info();
+  ue_cap_info_r8_ies_s& r8          = ue_cap_info.crit_exts.set_c1().set_ue_cap_info_r8();
+  r8.ue_cap_rat_container_list.resize(1);
+  r8.ue_cap_rat_container_list[0].rat_type.value = rat_type_e::eutra;
+  r8.ue_cap_rat_container_list[0].ue_cap_rat_container.resize(cap_bref.distance_bytes());
+  memcpy(r8.ue_cap_rat_container_list[0].ue_cap_rat_container.data(), cap_buf, cap_bref.distance_bytes());
+
+  pdu = srslte::allocate_unique_buffer(*srslte::byte_buffer_pool::get_instance(), true);
+  asn1::bit_ref bref(pdu->msg, pdu->get_tailroom());
+  TESTASSERT(msg.pack(bref) == asn1::SRSASN_SUCCESS);
+  pdu->N_bytes = bref.distance_bytes();
+  return SRSLTE_SUCCESS;
+}
+
+rrc_state_t get_ue_state(srsenb::rrc& rrc)
+{
+  rrc_metrics_t metrics = {};
+  rrc.get_metrics(metrics);
+  return metrics.n_ues > 0 ? metrics.ues[0].state : RRC_STATE_IDLE;
+}
+
+/*
+ * A UECapabilityInformation long enough to be decoded in the background is followed by a short
+ * RRCConnectionReconfigurationComplete. The short message must not overtake the long one, otherwise the UE would not
+ * end up registered
+ */
+int test_ul_dcch_order(uint32_t nof_background_threads)
+{
+  printf("\n===== TEST: test_ul_dcch_order() with %d background threads =====\n", nof_background_threads);
+  srslte::scoped_log<srslte::test_log_filter> rrc_log("RRC ");
+  srslte::task_scheduler                      task_sched{512, nof_background_threads, 128};
+  srslte::unique_byte_buffer_t                pdu;
+
+  srsenb::all_args_t args;
+  rrc_cfg_t          cfg;
+  TESTASSERT(test_helpers::parse_default_cfg(&cfg, args) == SRSLTE_SUCCESS);
+
+  srsenb::rrc                       rrc{&task_sched};
+  mac_dummy                         mac;
+  rlc_dummy                         rlc;
+  test_dummies::pdcp_mobility_dummy pdcp;
+  phy_dummy                         phy;
+  test_dummies::s1ap_mobility_dummy s1ap;
+  gtpu_dummy                        gtpu;
+  rrc.init(cfg, &phy, &mac, &rlc, &pdcp, &s1ap, &gtpu);
+
+  uint16_t                  rnti = 0x46;
+  sched_interface::ue_cfg_t ue_cfg;
+  ue_cfg.supported_cc_list.resize(1);
+  ue_cfg.supported_cc_list[0].active     = true;
+  ue_cfg.supported_cc_list[0].enb_cc_idx = 0;
+  rrc.add_user(rnti, ue_cfg);
+
+  rrc_log->set_level(srslte::LOG_LEVEL_NONE); // mute all the startup log
+  TESTASSERT(test_helpers::bring_rrc_to_ue_cap_state(rrc, *task_sched.get_timer_handler(), rnti) == SRSLTE_SUCCESS);
+  rrc_log->set_level(srslte::LOG_LEVEL_INFO);
+  TESTASSERT(get_ue_state(rrc) == RRC_STATE_WAIT_FOR_UE_CAP_INFO);
+
+  // Both messages arrive in the same TTI
+  TESTASSERT(make_large_ue_cap_info(pdu) == SRSLTE_SUCCESS);
+  TESTASSERT(pdu->N_bytes >= 128);
+  rrc.write_pdu(rnti, 1, std::move(pdu));
+  uint8_t rrc_conn_reconf_complete[] = {0x10, 0x00};
+  test_helpers::copy_msg_to_buffer(pdu, rrc_conn_reconf_complete);
+  rrc.write_pdu(rnti, 1, std::move(pdu));
+  rrc.tti_clock();
+
+  // Neither of them is handled until the long one is decoded
+  TESTASSERT(get_ue_state(rrc) == RRC_STATE_WAIT_FOR_UE_CAP_INFO);
+
+  for (uint32_t i = 0; i < 1000 and get_ue_state(rrc) != RRC_STATE_REGISTERED; i++) {
+    task_sched.run_pending_tasks();
+    usleep(1000);
+  }
+  TESTASSERT(get_ue_state(rrc) == RRC_STATE_REGISTERED);
+  TESTASSERT(rrc_log->error_counter == 0);
+
+  task_sched.stop();
+  return SRSLTE_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  srslte::logmap::set_default_log_level(srslte::LOG_LEVEL_INFO);
+
+  if (argc < 3) {
+    argparse::usage(argv[0]);
+    return -1;
+  }
+  argparse::parse_args(argc, argv);
+  TESTASSERT(test_ul_dcch_order(1) == SRSLTE_SUCCESS);
+  TESTASSERT(test_ul_dcch_order(0) == SRSLTE_SUCCESS);
+
+  printf("\nSuccess\n");
+
+  return SRSLTE_SUCCESS;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/upper/pdcp_nr.h"
+#include "srsenb/hdr/stack/upper/sdap.h"
+#include "srslte/common/task_scheduler.h"
+#include "srslte/common/test_common.h"
+
+using namespace srsenb;
+
+const uint16_t rnti     = 0x1234;
+const uint32_t drb_lcid = 4;
+
+/// Records the PDCP PDUs written to RLC
+class rlc_recorder : public rlc_interface_pdcp_nr
+{
+public:
+  void write_sdu(uint16_t rnti_, uint32_t lcid, srslte::unique_byte_buffer_t sdu) override
+  {
+    if (rnti_ == rnti) {
+      pdus.emplace_back(lcid, std::move(sdu));
+    }
+  }
+  bool rb_is_um(uint16_t rnti_, uint32_t lcid) override { return true; }
+  bool sdu_queue_is_full(uint16_t rnti_, uint32_t lcid) override { return false; }
+
+  std::vector<std::pair<uint32_t, srslte::unique_byte_buffer_t> > pdus;
+};
+
+class rrc_dummy : public rrc_interface_pdcp_nr
+{
+public:
+  void write_pdu(uint16_t rnti_, uint32_t lcid, srslte::unique_byte_buffer_t pdu) override {}
+};
+
+srslte::unique_byte_buffer_t make_sdu(uint32_t len, uint8_t value)
+{
+  srslte::unique_byte_buffer_t sdu = srslte::allocate_unique_buffer(*srslte::byte_buffer_pool::get_instance());
+  memset(sdu->msg, value, len);
+  sdu->N_bytes = len;
+  return sdu;
+}
+
+/*
+ * A burst of SDUs written to SDAP reaches RLC through PDCP in order, with consecutive SNs, and the vector is left
+ * empty. The SDUs of an unknown RNTI are dropped
+ */
+int test_write_sdus()
+{
+  srslte::task_scheduler task_sched;
+  rlc_recorder           rlc;
+  rrc_dummy              rrc;
+  pdcp_nr                pdcp(&task_sched, "PDCP");
+  sdap                   sdap_obj;
+
+  pdcp_nr_args_t pdcp_args = {};
+  pdcp_args.log_level      = "none";
+  pdcp.init(pdcp_args, &rlc, &rrc, &sdap_obj);
+  sdap_obj.init(&pdcp, nullptr, nullptr);
+
+  pdcp.add_user(rnti);
+  srslte::pdcp_config_t pdcp_cnfg{drb_lcid,
+                                  srslte::PDCP_RB_IS_DRB,
+                                  srslte::SECURITY_DIRECTION_DOWNLINK,
+                                  srslte::SECURITY_DIRECTION_UPLINK,
+                                  srslte::PDCP_SN_LEN_18,
+                                  srslte::pdcp_t_reordering_t::ms500,
+                                  srslte::pdcp_discard_timer_t::infinity};
+  pdcp.add_bearer(rnti, drb_lcid, pdcp_cnfg);
+
+  const uint32_t                            nof_sdus = 10;
+  std::vector<srslte::unique_byte_buffer_t> sdus;
+  for (uint32_t i = 0; i < nof_sdus; i++) {
+    sdus.push_back(make_sdu(100 + i, i));
+  }
+  sdap_obj.write_sdus(rnti, drb_lcid, sdus);
+  TESTASSERT(sdus.empty());
+
+  TESTASSERT(rlc.pdus.size() == nof_sdus);
+  for (uint32_t i = 0; i < nof_sdus; i++) {
+    // The PDU has the header, the SDU and the 4 byte MAC-I
+    const srslte::unique_byte_buffer_t& pdu     = rlc.pdus[i].second;
+    const uint32_t                      hdr_len = pdcp_cnfg.hdr_len_bytes;
+    TESTASSERT(rlc.pdus[i].first == drb_lcid);
+    TESTASSERT(pdu->N_bytes == hdr_len + 100 + i + 4);
+    uint32_t sn = ((pdu->msg[0] & 0x3U) << 16U) | (pdu->msg[1] << 8U) | pdu->msg[2];
+    TESTASSERT(sn == i);
+    for (uint32_t k = hdr_len; k < pdu->N_bytes - 4; k++) {
+      TESTASSERT(pdu->msg[k] == i);
+    }
+  }
+
+  // Unknown RNTI
+  rlc.pdus.clear();
+  sdus.push_back(make_sdu(100, 0));
+  sdap_obj.write_sdus(rnti + 1, drb_lcid, sdus);
+  TESTASSERT(sdus.empty());
+  TESTASSERT(rlc.pdus.empty());
+
+  pdcp.stop();
+  return SRSLTE_SUCCESS;
+}
+
+int main()
+{
+  srslte::logmap::set_default_log_level(srslte::LOG_LEVEL_NONE);
+
+  TESTASSERT(test_write_sdus() == SRSLTE_SUCCESS);
+
+  printf("Success\n");
+  return SRSLTE_SUCCESS;
+}
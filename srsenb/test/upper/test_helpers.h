@@ -261,7 +261,8 @@ void copy_msg_to_buffer(srslte::unique_byte_buffer_t& pdu, srslte::const_byte_sp
   pdu->N_bytes = msg.size();
 }
 
-int bring_rrc_to_reconf_state(srsenb::rrc& rrc, srslte::timer_handler& timers, uint16_t rnti)
+/// Does the handshaking until the eNB waits for the UECapabilityInformation
+int bring_rrc_to_ue_cap_state(srsenb::rrc& rrc, srslte::timer_handler& timers, uint16_t rnti)
 {
   srslte::unique_byte_buffer_t pdu;
 
@@ -311,6 +312,14 @@ int bring_rrc_to_reconf_state(srsenb::rrc& rrc, srslte::timer_handler& timers, u
   timers.step_all();
   rrc.tti_clock();
 
+  return SRSLTE_SUCCESS;
+}
+
+int bring_rrc_to_reconf_state(srsenb::rrc& rrc, srslte::timer_handler& timers, uint16_t rnti)
+{
+  srslte::unique_byte_buffer_t pdu;
+  TESTASSERT(bring_rrc_to_ue_cap_state(rrc, timers, rnti) == SRSLTE_SUCCESS);
+
   // send UE cap info
   uint8_t ue_cap_info[] = {0x38, 0x01, 0x01, 0x0c, 0x98, 0x00, 0x00, 0x18, 0x00, 0x0f,
                            0x30, 0x20, 0x80, 0x00, 0x01, 0x00, 0x0e, 0x01, 0x00, 0x00};
@@ -31,10 +31,15 @@
 #include "srslte/common/buffer_pool.h"
 #include "srslte/common/log.h"
 #include "srslte/common/log_filter.h"
+#include "srslte/common/threads.h"
 #include "srslte/interfaces/epc_interfaces.h"
+#include <condition_variable>
 #include <cstddef>
+#include <deque>
 #include <fstream>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 
 #define LTE_FDD_ENB_IND_HE_N_BITS 5
 #define LTE_FDD_ENB_IND_HE_MASK 0x1FUL
@@ -47,6 +52,7 @@ typedef struct {
   std::string db_file;
   uint16_t    mcc;
   uint16_t    mnc;
+  uint32_t    nof_workers;
 } hss_args_t;
 
 enum hss_auth_algo { HSS_ALGO_XOR, HSS_ALGO_MILENAGE };
@@ -80,10 +86,12 @@ public:
   int         init(hss_args_t* hss_args, srslte::log_filter* hss_log);
   void        stop(void);
 
-  virtual bool gen_auth_info_answer(uint64_t imsi, uint8_t* k_asme, uint8_t* autn, uint8_t* rand, uint8_t* xres);
+  virtual void gen_auth_info_answer_async(uint64_t imsi, uint32_t mme_ue_s1ap_id, const uint8_t* auts);
   virtual bool gen_update_loc_answer(uint64_t imsi, uint8_t* qci);
 
-  virtual bool resync_sqn(uint64_t imsi, uint8_t* auts);
+  // Answers of the workers, collected by the MME thread when the fd is readable
+  int  get_auth_info_answer_fd() const { return m_answer_fd; }
+  void get_auth_info_answers(std::vector<auth_info_answer_t>* answers);
 
   std::map<std::string, uint64_t> get_ip_to_imsi() const;
 
@@ -92,7 +100,52 @@ private:
   virtual ~hss();
   static hss* m_instance;
 
-  std::map<uint64_t, std::unique_ptr<hss_ue_ctx_t> > m_imsi_to_ue_ctx;
+  struct auth_info_request_t {
+    uint64_t imsi;
+    uint32_t mme_ue_s1ap_id;
+    bool     resync;
+    uint8_t  auts[16];
+  };
+
+  // Generates the authentication vectors of a shard of the subscribers. A subscriber always goes to the same worker,
+  // so the updates of its SQN are serialized without locking
+  class auth_worker : public srslte::thread
+  {
+  public:
+    auth_worker(hss* parent_, uint32_t id);
+    void push(const auth_info_request_t& req);
+    void stop();
+
+  private:
+    void run_thread() override;
+
+    hss*                            parent;
+    std::mutex                      mutex;
+    std::condition_variable         cvar;
+    std::deque<auth_info_request_t> requests;
+    bool                            running = true;
+  };
+
+  void handle_auth_info_request(const auth_info_request_t& req);
+  bool gen_auth_info_answer(uint64_t imsi, uint8_t* k_asme, uint8_t* autn, uint8_t* rand, uint8_t* xres);
+  bool resync_sqn(uint64_t imsi, const uint8_t* auts);
+
+  std::vector<std::unique_ptr<auth_worker> > m_workers;
+  std::mutex                                 m_answer_mutex;
+  std::vector<auth_info_answer_t>            m_answers;
+  int                                        m_answer_fd = -1;
+
+  // Subscribers in the order of the database file, indexed by IMSI. They are only added at startup, so the pointers to
+  // the contexts stay valid
+  std::vector<hss_ue_ctx_t>              m_ue_ctxs;
+  std::unordered_map<uint64_t, uint32_t> m_imsi_to_ue_idx;
+
+  // SQN updates are appended to a log next to the database file, and the log is merged into the database file once it
+  // has as many records as there are subscribers. The mutex serializes all the writes of the SQNs
+  std::mutex  m_sqn_mutex;
+  std::string m_sqn_log_file;
+  int         m_sqn_log_fd      = -1;
+  size_t      m_sqn_log_records = 0;
 
   void gen_rand(uint8_t rand_[16]);
 
@@ -100,23 +153,23 @@ private:
        gen_auth_info_answer_milenage(hss_ue_ctx_t* ue_ctx, uint8_t* k_asme, uint8_t* autn, uint8_t* rand, uint8_t* xres);
   void gen_auth_info_answer_xor(hss_ue_ctx_t* ue_ctx, uint8_t* k_asme, uint8_t* autn, uint8_t* rand, uint8_t* xres);
 
-  void resync_sqn_milenage(hss_ue_ctx_t* ue_ctx, uint8_t* auts);
-  void resync_sqn_xor(hss_ue_ctx_t* ue_ctx, uint8_t* auts);
-
-  std::vector<std::string> split_string(const std::string& str, char delimiter);
-  void                     get_uint_vec_from_hex_str(const std::string& key_str, uint8_t* key, uint len);
+  void resync_sqn_milenage(hss_ue_ctx_t* ue_ctx, const uint8_t* auts, uint8_t* sqn);
+  void resync_sqn_xor(hss_ue_ctx_t* ue_ctx, const uint8_t* auts, uint8_t* sqn);
 
   void increment_ue_sqn(hss_ue_ctx_t* ue_ctx);
-  void increment_seq_after_resync(hss_ue_ctx_t* ue_ctx);
-  void increment_sqn(uint8_t* sqn, uint8_t* next_sqn);
+  void increment_seq_after_resync(const uint8_t* sqn, uint8_t* next_sqn);
+  void increment_sqn(const uint8_t* sqn, uint8_t* next_sqn);
+  void update_sqn(hss_ue_ctx_t* ue_ctx, const uint8_t* sqn);
 
   bool          set_auth_algo(std::string auth_algo);
   bool          read_db_file(std::string db_file);
+  bool          parse_db_line(const char* line, size_t len, hss_ue_ctx_t* ue_ctx);
   bool          write_db_file(std::string db_file);
+  size_t        read_sqn_log(const std::string& log_file);
+  bool          open_sqn_log();
+  void          compact_sqn_log();
   hss_ue_ctx_t* get_ue_ctx(uint64_t imsi);
 
-  std::string hex_string(uint8_t* hex, int size);
-
   std::string db_file;
 
   /*Logs*/
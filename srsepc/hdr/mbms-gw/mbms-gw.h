@@ -34,7 +34,9 @@
 #include "srslte/common/logmap.h"
 #include "srslte/common/threads.h"
 #include "srslte/srslte.h"
+#include <array>
 #include <cstddef>
+#include <sys/socket.h>
 
 namespace srsepc {
 
@@ -48,6 +50,7 @@ typedef struct {
   std::string m1u_multi_addr;
   std::string m1u_multi_if;
   int         m1u_multi_ttl;
+  bool        m1u_gso;
 } mbms_gw_args_t;
 
 struct pseudo_hdr {
@@ -75,7 +78,10 @@ private:
 
   int      init_sgi_mb_if(mbms_gw_args_t* args);
   int      init_m1_u(mbms_gw_args_t* args);
-  void     handle_sgi_md_pdu(srslte::byte_buffer_t* msg);
+  void     read_sgi_mb();
+  bool     handle_sgi_md_pdu(srslte::byte_buffer_t* msg);
+  void     send_m1u(uint32_t nof_pdus);
+  bool     send_m1u_gso(uint32_t nof_pdus);
   uint16_t in_cksum(uint16_t* iphdr, int count);
 
   /* Members */
@@ -89,6 +95,15 @@ private:
   bool               m_m1u_up;
   int                m_m1u;
   struct sockaddr_in m_m1u_multi_addr;
+  bool               m_m1u_gso = false;
+
+  // The packets are read from the TUN interface in batches into the pool buffers, the GTP-U header is written in their
+  // headroom and the batch is sent with a single sendmmsg call, or as one UDP GSO send when the packets have the same
+  // size
+  static const uint32_t                         MAX_BATCH = 32;
+  std::array<srslte::byte_buffer_t*, MAX_BATCH> m_pdus    = {};
+  std::array<mmsghdr, MAX_BATCH>                m_tx_msgs = {};
+  std::array<iovec, MAX_BATCH>                  m_tx_iovs = {};
 };
 
 } // namespace srsepc
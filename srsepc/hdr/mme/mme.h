@@ -74,6 +74,7 @@ private:
   static mme* m_instance;
   s1ap*       m_s1ap;
   mme_gtpc*   m_mme_gtpc;
+  hss*        m_hss;
 
   bool                      m_running;
   srslte::byte_buffer_pool* m_pool;
@@ -82,6 +83,9 @@ private:
   // Timer map
   std::vector<mme_timer_t> timers;
 
+  // Authentication vectors handed over by the HSS workers
+  std::vector<auth_info_answer_t> m_auth_info_answers;
+
   // Timer Methods
   void handle_timer_expire(int timer_fd);
 
@@ -238,6 +238,10 @@ public:
   bool handle_authentication_failure(srslte::byte_buffer_t* nas_rx);
   bool handle_detach_request(srslte::byte_buffer_t* nas_rx);
 
+  /* Authentication vectors, generated by the HSS workers */
+  void request_auth_info(uint8_t eksi, const uint8_t* auts = nullptr);
+  bool handle_auth_info_answer(const auth_info_answer_t& answer);
+
   /* Downlink NAS messages packing */
   bool pack_authentication_request(srslte::byte_buffer_t* nas_buffer);
   bool pack_authentication_reject(srslte::byte_buffer_t* nas_buffer);
@@ -282,6 +286,10 @@ private:
   std::string m_apn;
   std::string m_dns;
 
+  // Authentication vector requested to the HSS, and the eKSI it gets
+  bool    m_auth_info_pending = false;
+  uint8_t m_pending_eksi      = 0;
+
   // Timers timeout values
   uint16_t m_t3413 = 0;
 
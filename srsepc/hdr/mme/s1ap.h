@@ -43,6 +43,7 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <unordered_map>
 
 namespace srsepc {
 
@@ -87,6 +88,9 @@ public:
   virtual nas* find_nas_ctx_from_imsi(uint64_t imsi);
   nas*         find_nas_ctx_from_mme_ue_s1ap_id(uint32_t mme_ue_s1ap_id);
 
+  // Continues the procedure of the UE the authentication vector was generated for
+  void handle_auth_info_answer(const auth_info_answer_t& answer);
+
   bool         release_ue_ecm_ctx(uint32_t mme_ue_s1ap_id);
   void         release_ues_ecm_ctx_in_enb(int32_t enb_assoc);
   virtual bool delete_ue_ctx(uint64_t imsi);
@@ -103,8 +107,8 @@ public:
   s1ap_ctx_mngmt_proc* m_s1ap_ctx_mngmt_proc;
   s1ap_paging*         m_s1ap_paging;
 
-  std::map<uint32_t, uint64_t>   m_tmsi_to_imsi;
-  std::map<uint16_t, enb_ctx_t*> m_active_enbs;
+  std::unordered_map<uint32_t, uint64_t> m_tmsi_to_imsi;
+  std::map<uint16_t, enb_ctx_t*>         m_active_enbs;
 
   // Interfaces
   virtual bool send_initial_context_setup_request(uint64_t imsi, uint16_t erab_to_setup);
@@ -131,12 +135,15 @@ private:
   std::map<int32_t, uint16_t>            m_sctp_to_enb_id;
   std::map<int32_t, std::set<uint32_t> > m_enb_assoc_to_ue_ids;
 
-  std::map<uint64_t, nas*> m_imsi_to_nas_ctx;
-  std::map<uint32_t, nas*> m_mme_ue_s1ap_id_to_nas_ctx;
+  std::unordered_map<uint64_t, nas*> m_imsi_to_nas_ctx;
+  std::unordered_map<uint32_t, nas*> m_mme_ue_s1ap_id_to_nas_ctx;
 
   uint32_t m_next_mme_ue_s1ap_id;
   uint32_t m_next_m_tmsi;
 
+  // Memory of the decoded S1AP PDUs, reused from one PDU to the next
+  asn1::mem_arena m_rx_arena;
+
   // GTP-C Interface
   mme_gtpc* m_mme_gtpc;
 
@@ -22,6 +22,7 @@
 #define SRSEPC_GTPC_H
 
 #include "srsepc/hdr/spgw/spgw.h"
+#include "srslte/adt/teid_map.h"
 #include "srslte/asn1/gtpc.h"
 #include "srslte/interfaces/epc_interfaces.h"
 #include <set>
@@ -46,7 +47,6 @@ public:
   int init_ue_ip(spgw_args_t* args, const std::map<std::string, uint64_t>& ip_to_imsi);
 
   int       get_s11();
-  uint64_t  get_new_ctrl_teid();
   uint64_t  get_new_user_teid();
   in_addr_t get_new_ue_ipv4(uint64_t imsi);
 
@@ -82,14 +82,13 @@ public:
   struct sockaddr_un m_spgw_addr, m_mme_addr;
 
   uint32_t m_h_next_ue_ip;
-  uint64_t m_next_ctrl_teid;
   uint64_t m_next_user_teid;
   uint32_t m_max_paging_queue;
 
-  std::map<uint64_t, uint32_t> m_imsi_to_ctr_teid;           // IMSI to control TEID map. Important to check if UE
-                                                             // is previously connected
-  std::map<uint32_t, spgw_tunnel_ctx*> m_teid_to_tunnel_ctx; // Map control TEID to tunnel ctx. Usefull to get
-                                                             // reply ctrl TEID, UE IP, etc.
+  std::map<uint64_t, uint32_t>       m_imsi_to_ctr_teid;   // IMSI to control TEID map. Important to check if UE
+                                                           // is previously connected
+  srslte::teid_map<spgw_tunnel_ctx*> m_teid_to_tunnel_ctx; // Map control TEID to tunnel ctx. Usefull to get
+                                                           // reply ctrl TEID, UE IP, etc. Allocates the TEIDs
 
   std::set<uint32_t>                 m_ue_ip_addr_pool;
   std::map<uint64_t, struct in_addr> m_imsi_to_ip;
@@ -103,11 +102,6 @@ inline int spgw::gtpc::get_s11()
   return m_s11;
 }
 
-inline uint64_t spgw::gtpc::get_new_ctrl_teid()
-{
-  return m_next_ctrl_teid++;
-}
-
 inline uint64_t spgw::gtpc::get_new_user_teid()
 {
   return m_next_user_teid++;
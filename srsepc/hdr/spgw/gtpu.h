@@ -26,9 +26,17 @@
 #include "srslte/asn1/gtpc.h"
 #include "srslte/common/buffer_pool.h"
 #include "srslte/common/logmap.h"
+#include "srslte/common/threads.h"
 #include "srslte/interfaces/epc_interfaces.h"
+#include <array>
 #include <cstddef>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
 #include <queue>
+#include <sys/socket.h>
+#include <unordered_map>
+#include <vector>
 
 namespace srsepc {
 
@@ -42,12 +50,12 @@ public:
 
   int init_sgi(spgw_args_t* args);
   int init_s1u(spgw_args_t* args);
-  int get_sgi();
-  int get_s1u();
+  int get_paging_fd();
 
-  void handle_sgi_pdu(srslte::byte_buffer_t* msg);
-  void handle_s1u_pdu(srslte::byte_buffer_t* msg);
-  void send_s1u_pdu(srslte::gtp_fteid_t enb_fteid, srslte::byte_buffer_t* msg);
+  void send_s1u_pdu(srslte::gtp_fteid_t enb_fteid, srslte::byte_buffer_t* msg, int s1u);
+
+  // Control plane, called from the SP-GW thread
+  void handle_paging_pdus();
 
   virtual in_addr_t get_s1u_addr();
 
@@ -60,32 +68,93 @@ public:
   spgw*                m_spgw;
   gtpc_interface_gtpu* m_gtpc;
 
-  bool m_sgi_up;
-  int  m_sgi;
-
-  bool        m_s1u_up;
-  int         m_s1u;
-  sockaddr_in m_s1u_addr;
+  // One SGi TUN queue and one S1-U socket per user plane worker
+  bool             m_sgi_up;
+  std::vector<int> m_sgi;
 
-  std::map<in_addr_t, srslte::gtp_fteid_t> m_ip_to_usr_teid; // Map IP to User-plane TEID for downlink traffic
-  std::map<in_addr_t, uint32_t>            m_ip_to_ctr_teid; // IP to control TEID map. Important to check if
-                                                             // UE is attached without an active user-plane
-                                                             // for downlink notifications.
+  bool             m_s1u_up;
+  std::vector<int> m_s1u;
+  sockaddr_in      m_s1u_addr;
 
   srslte::log_ref m_gtpu_log;
 
 private:
+  // Thread that forwards the packets of one SGi queue and one S1-U socket. The packets are read and sent in batches,
+  // and the GTP-U header is added and removed in place in the pool buffers
+  class up_worker : public srslte::thread
+  {
+  public:
+    up_worker(gtpu* parent_, int sgi_, int s1u_, uint32_t id);
+    void stop();
+
+    // Queues a GTP-U PDU for the eNB, sent with the rest of the batch
+    void queue_s1u_pdu(srslte::byte_buffer_t* msg, const sockaddr_in& enb_addr);
+
+  private:
+    void run_thread() override;
+    void read_sgi();
+    void read_s1u();
+    void flush_s1u_tx();
+
+    static const uint32_t MAX_BATCH = 32;
+
+    gtpu* parent;
+    int   sgi;
+    int   s1u;
+    bool  running = false;
+
+    std::array<srslte::byte_buffer_t*, MAX_BATCH> rx_pdus = {};
+    std::array<mmsghdr, MAX_BATCH>                rx_msgs = {};
+    std::array<iovec, MAX_BATCH>                  rx_iovs = {};
+
+    uint32_t                                      nof_tx   = 0;
+    std::array<srslte::byte_buffer_t*, MAX_BATCH> tx_pdus  = {};
+    std::array<sockaddr_in, MAX_BATCH>            tx_addrs = {};
+    std::array<mmsghdr, MAX_BATCH>                tx_msgs  = {};
+    std::array<iovec, MAX_BATCH>                  tx_iovs  = {};
+  };
+
+  // User plane, called from the worker threads
+  void handle_sgi_pdu(srslte::byte_buffer_t* msg, up_worker* worker);
+  void handle_s1u_pdu(srslte::byte_buffer_t* msg, int sgi);
+  bool write_s1u_header(srslte::gtp_fteid_t enb_fteid, srslte::byte_buffer_t* msg, sockaddr_in* enb_addr);
+
+  // Tunnels of a UE IP. The control TEID allows notifying downlink data to UEs attached without user plane
+  struct ue_tunnels_t {
+    bool                has_usr_fteid = false;
+    srslte::gtp_fteid_t usr_fteid     = {};
+    bool                has_ctr_teid  = false;
+    uint32_t            ctr_teid      = 0;
+  };
+  // UE IP to tunnels, in shards with their own lock. The workers look up packets in parallel, and a tunnel update
+  // from the control plane only blocks the lookups of one shard
+  struct tunnel_shard_t {
+    tunnel_shard_t() { pthread_rwlock_init(&rwlock, nullptr); }
+    ~tunnel_shard_t() { pthread_rwlock_destroy(&rwlock); }
+
+    pthread_rwlock_t                            rwlock;
+    std::unordered_map<in_addr_t, ue_tunnels_t> tunnels;
+  };
+  static const uint32_t NOF_TUNNEL_SHARDS = 16;
+
+  tunnel_shard_t& get_shard(in_addr_t ue_ipv4) { return m_tunnel_shards[ntohl(ue_ipv4) % NOF_TUNNEL_SHARDS]; }
+  bool            find_tunnels(in_addr_t ue_ipv4, ue_tunnels_t* tunnels);
+  void            close_sgi_queues();
+
+  tunnel_shard_t                          m_tunnel_shards[NOF_TUNNEL_SHARDS];
+  std::vector<std::unique_ptr<up_worker>> m_workers;
+
+  // Downlink packets of UEs without user plane, handed from the workers to the SP-GW thread for paging
+  std::mutex                                               m_paging_mutex;
+  std::vector<std::pair<uint32_t, srslte::byte_buffer_t*>> m_paging_pdus;
+  int                                                      m_paging_fd = -1;
+
   srslte::byte_buffer_pool* m_pool;
 };
 
-inline int spgw::gtpu::get_sgi()
-{
-  return m_sgi;
-}
-
-inline int spgw::gtpu::get_s1u()
+inline int spgw::gtpu::get_paging_fd()
 {
-  return m_s1u;
+  return m_paging_fd;
 }
 
 inline in_addr_t spgw::gtpu::get_s1u_addr()
@@ -47,6 +47,7 @@ typedef struct {
   std::string sgi_if_addr;
   std::string sgi_if_name;
   uint32_t    max_paging_queue;
+  uint32_t    nof_up_workers;
 } spgw_args_t;
 
 typedef struct spgw_tunnel_ctx {
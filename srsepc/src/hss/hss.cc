@@ -20,18 +20,149 @@
  */
 #include "srsepc/hdr/hss/hss.h"
 #include "srslte/common/security.h"
+#include <cstring>
+#include <fcntl.h>
 #include <inttypes.h> // for printing uint64_t
-#include <iomanip>
-#include <sstream>
-#include <stdlib.h> /* srand, rand */
+#include <stdlib.h>   /* srand, rand */
 #include <string>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 
 namespace srsepc {
 
 hss*            hss::m_instance    = NULL;
 pthread_mutex_t hss_instance_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+namespace {
+
+// The SQN log is not merged into the database file before it has this many records, even with few subscribers
+const size_t min_sqn_log_records = 1024;
+
+struct field_t {
+  const char* str;
+  size_t      len;
+
+  bool        operator==(const char* s) const { return strlen(s) == len and memcmp(s, str, len) == 0; }
+  std::string to_string() const { return std::string(str, len); }
+};
+
+/// Maps the file and calls f(line, len) for each line, without the line terminator, until f returns false. Returns
+/// false if the file can not be read or f returned false
+template <typename F>
+bool for_each_line(const std::string& filename, F&& f)
+{
+  int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st = {};
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return false;
+  }
+  if (st.st_size == 0) {
+    close(fd);
+    return true;
+  }
+  void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+  madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+  bool        ret = true;
+  const char* pos = (const char*)data;
+  const char* end = pos + st.st_size;
+  while (ret and pos < end) {
+    const char* eol = (const char*)memchr(pos, '\n', end - pos);
+    if (eol == nullptr) {
+      eol = end;
+    }
+    size_t len = eol - pos;
+    if (len > 0 and pos[len - 1] == '\r') {
+      len--;
+    }
+    ret = f(pos, len);
+    pos = eol + 1;
+  }
+  munmap(data, st.st_size);
+  return ret;
+}
+
+/// Splits the line at the delimiters into at most max_fields fields. Returns the number of fields in the line
+uint32_t split_fields(const char* line, size_t len, char delimiter, field_t* fields, uint32_t max_fields)
+{
+  const char* end        = line + len;
+  uint32_t    nof_fields = 0;
+  while (true) {
+    const char* delim = (const char*)memchr(line, delimiter, end - line);
+    if (nof_fields < max_fields) {
+      fields[nof_fields].str = line;
+      fields[nof_fields].len = (delim == nullptr ? end : delim) - line;
+    }
+    nof_fields++;
+    if (delim == nullptr) {
+      return nof_fields;
+    }
+    line = delim + 1;
+  }
+}
+
+bool parse_hex(const field_t& field, uint8_t* bytes, uint32_t nof_bytes)
+{
+  if (field.len < 2 * nof_bytes) {
+    return false;
+  }
+  for (uint32_t i = 0; i < 2 * nof_bytes; i++) {
+    char    c = field.str[i];
+    uint8_t nibble;
+    if (c >= '0' and c <= '9') {
+      nibble = c - '0';
+    } else if (c >= 'a' and c <= 'f') {
+      nibble = c - 'a' + 10;
+    } else if (c >= 'A' and c <= 'F') {
+      nibble = c - 'A' + 10;
+    } else {
+      return false;
+    }
+    bytes[i / 2] = (i % 2 == 0) ? nibble << 4U : bytes[i / 2] | nibble;
+  }
+  return true;
+}
+
+bool parse_uint(const field_t& field, uint64_t* value)
+{
+  if (field.len == 0 or field.len > 19) {
+    return false;
+  }
+  uint64_t v = 0;
+  for (size_t i = 0; i < field.len; i++) {
+    if (field.str[i] < '0' or field.str[i] > '9') {
+      return false;
+    }
+    v = v * 10 + (field.str[i] - '0');
+  }
+  *value = v;
+  return true;
+}
+
+/// Writes the bytes in hexadecimal to str, which has room for 2 * nof_bytes + 1 chars
+void hex_to_str(const uint8_t* bytes, uint32_t nof_bytes, char* str)
+{
+  static const char digits[] = "0123456789abcdef";
+  for (uint32_t i = 0; i < nof_bytes; i++) {
+    str[2 * i]     = digits[bytes[i] >> 4U];
+    str[2 * i + 1] = digits[bytes[i] & 0xfU];
+  }
+  str[2 * nof_bytes] = '\0';
+}
+
+} // namespace
+
 hss::hss()
 {
   return;
@@ -68,132 +199,285 @@ int hss::init(hss_args_t* hss_args, srslte::log_filter* hss_log)
   /*Init loggers*/
   m_hss_log = hss_log;
 
+  mcc = hss_args->mcc;
+  mnc = hss_args->mnc;
+
+  db_file = hss_args->db_file;
+
   /*Read user information from DB*/
   if (read_db_file(hss_args->db_file) == false) {
     srslte::console("Error reading user database file %s\n", hss_args->db_file.c_str());
     return -1;
   }
 
-  mcc = hss_args->mcc;
-  mnc = hss_args->mnc;
+  // Apply the SQN updates that were not merged into the DB file yet
+  m_sqn_log_file    = db_file + ".sqn";
+  m_sqn_log_records = read_sqn_log(m_sqn_log_file);
+  if (not open_sqn_log()) {
+    srslte::console("Error opening SQN log file %s\n", m_sqn_log_file.c_str());
+    return -1;
+  }
+  if (m_sqn_log_records > 0) {
+    m_hss_log->info("Merging %zd SQN log records into DB file\n", m_sqn_log_records);
+    compact_sqn_log();
+  }
 
-  db_file = hss_args->db_file;
+  // Wakes up the MME thread when the workers have answers
+  m_answer_fd = eventfd(0, 0);
+  if (m_answer_fd < 0) {
+    m_hss_log->error("Failed to create authentication answer eventfd: %s\n", strerror(errno));
+    return -1;
+  }
+  for (uint32_t i = 0; i < std::max(hss_args->nof_workers, 1u); i++) {
+    m_workers.emplace_back(new auth_worker(this, i));
+    m_workers.back()->start();
+  }
 
-  m_hss_log->info("HSS Initialized. DB file %s, MCC: %d, MNC: %d\n", hss_args->db_file.c_str(), mcc, mnc);
+  m_hss_log->info("HSS Initialized. DB file %s, %zd users, MCC: %d, MNC: %d, %zd workers\n",
+                  hss_args->db_file.c_str(),
+                  m_ue_ctxs.size(),
+                  mcc,
+                  mnc,
+                  m_workers.size());
   srslte::console("HSS Initialized.\n");
   return 0;
 }
 
 void hss::stop()
 {
-  write_db_file(db_file);
+  // The SQNs are only written once no worker updates them
+  for (auto& worker : m_workers) {
+    worker->stop();
+  }
+  m_workers.clear();
+  if (m_answer_fd >= 0) {
+    close(m_answer_fd);
+    m_answer_fd = -1;
+  }
+  std::lock_guard<std::mutex> lock(m_sqn_mutex);
+  if (m_sqn_log_fd >= 0) {
+    if (m_sqn_log_records > 0) {
+      compact_sqn_log();
+    }
+    close(m_sqn_log_fd);
+    m_sqn_log_fd = -1;
+  }
   return;
 }
 
-bool hss::read_db_file(std::string db_filename)
+/*
+ * Authentication vector workers
+ */
+hss::auth_worker::auth_worker(hss* parent_, uint32_t id) : thread("HSS" + std::to_string(id)), parent(parent_) {}
+
+void hss::auth_worker::push(const auth_info_request_t& req)
 {
-  std::ifstream m_db_file;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    requests.push_back(req);
+  }
+  cvar.notify_one();
+}
 
-  m_db_file.open(db_filename.c_str(), std::ifstream::in);
-  if (!m_db_file.is_open()) {
-    return false;
+void hss::auth_worker::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    running = false;
   }
-  m_hss_log->info("Opened DB file: %s\n", db_filename.c_str());
+  cvar.notify_one();
+  wait_thread_finish();
+}
 
-  std::string line;
-  while (std::getline(m_db_file, line)) {
-    if (line[0] != '#' && line.length() > 0) {
-      uint                     column_size = 10;
-      std::vector<std::string> split       = split_string(line, ',');
-      if (split.size() != column_size) {
-        m_hss_log->error("Error parsing UE database. Wrong number of columns in .csv\n");
-        m_hss_log->error("Columns: %zd, Expected %d.\n", split.size(), column_size);
+void hss::auth_worker::run_thread()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    cvar.wait(lock, [this]() { return not running or not requests.empty(); });
+    if (not running) {
+      break;
+    }
+    auth_info_request_t req = requests.front();
+    requests.pop_front();
+    lock.unlock();
+    parent->handle_auth_info_request(req);
+    lock.lock();
+  }
+}
 
-        srslte::console("\nError parsing UE database. Wrong number of columns in user database CSV.\n");
-        srslte::console("Perhaps you are using an old user_db.csv?\n");
-        srslte::console("See 'srsepc/user_db.csv.example' for an example.\n\n");
-        return false;
-      }
-      std::unique_ptr<hss_ue_ctx_t> ue_ctx = std::unique_ptr<hss_ue_ctx_t>(new hss_ue_ctx_t);
-      ue_ctx->name                         = split[0];
-      if (split[1] == std::string("xor")) {
-        ue_ctx->algo = HSS_ALGO_XOR;
-      } else if (split[1] == std::string("mil")) {
-        ue_ctx->algo = HSS_ALGO_MILENAGE;
-      } else {
-        m_hss_log->error("Neither XOR nor MILENAGE configured.\n");
-        return false;
-      }
-      ue_ctx->imsi = strtoull(split[2].c_str(), nullptr, 10);
-      get_uint_vec_from_hex_str(split[3], ue_ctx->key, 16);
-      if (split[4] == std::string("op")) {
-        ue_ctx->op_configured = true;
-        get_uint_vec_from_hex_str(split[5], ue_ctx->op, 16);
-        srslte::compute_opc(ue_ctx->key, ue_ctx->op, ue_ctx->opc);
-      } else if (split[4] == std::string("opc")) {
-        ue_ctx->op_configured = false;
-        get_uint_vec_from_hex_str(split[5], ue_ctx->opc, 16);
-      } else {
-        m_hss_log->error("Neither OP nor OPc configured.\n");
-        return false;
-      }
-      get_uint_vec_from_hex_str(split[6], ue_ctx->amf, 2);
-      get_uint_vec_from_hex_str(split[7], ue_ctx->sqn, 6);
+void hss::gen_auth_info_answer_async(uint64_t imsi, uint32_t mme_ue_s1ap_id, const uint8_t* auts)
+{
+  auth_info_request_t req = {};
+  req.imsi                = imsi;
+  req.mme_ue_s1ap_id      = mme_ue_s1ap_id;
+  req.resync              = auts != nullptr;
+  if (auts != nullptr) {
+    memcpy(req.auts, auts, sizeof(req.auts));
+  }
+  m_workers[imsi % m_workers.size()]->push(req);
+}
 
-      m_hss_log->debug("Added user from DB, IMSI: %015" PRIu64 "\n", ue_ctx->imsi);
-      m_hss_log->debug_hex(ue_ctx->key, 16, "User Key : ");
-      if (ue_ctx->op_configured) {
-        m_hss_log->debug_hex(ue_ctx->op, 16, "User OP : ");
-      }
-      m_hss_log->debug_hex(ue_ctx->opc, 16, "User OPc : ");
-      m_hss_log->debug_hex(ue_ctx->amf, 2, "AMF : ");
-      m_hss_log->debug_hex(ue_ctx->sqn, 6, "SQN : ");
-      ue_ctx->qci = (uint16_t)strtol(split[8].c_str(), nullptr, 10);
-      m_hss_log->debug("Default Bearer QCI: %d\n", ue_ctx->qci);
-
-      if (split[9] == std::string("dynamic")) {
-        ue_ctx->static_ip_addr = "0.0.0.0";
+void hss::handle_auth_info_request(const auth_info_request_t& req)
+{
+  auth_info_answer_t answer = {};
+  answer.imsi               = req.imsi;
+  answer.mme_ue_s1ap_id     = req.mme_ue_s1ap_id;
+  if (req.resync and not resync_sqn(req.imsi, req.auts)) {
+    answer.found = false;
+  } else {
+    answer.found = gen_auth_info_answer(req.imsi, answer.k_asme, answer.autn, answer.rand, answer.xres);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_answer_mutex);
+    m_answers.push_back(answer);
+  }
+  uint64_t one = 1;
+  if (write(m_answer_fd, &one, sizeof(one)) != sizeof(one)) {
+    m_hss_log->error("Failed to notify the MME of an authentication answer\n");
+  }
+}
+
+void hss::get_auth_info_answers(std::vector<auth_info_answer_t>* answers)
+{
+  uint64_t count;
+  if (read(m_answer_fd, &count, sizeof(count)) != sizeof(count)) {
+    m_hss_log->error("Failed to read authentication answer eventfd\n");
+  }
+  answers->clear();
+  std::lock_guard<std::mutex> lock(m_answer_mutex);
+  std::swap(*answers, m_answers);
+}
+
+bool hss::read_db_file(std::string db_filename)
+{
+  m_ue_ctxs.clear();
+  m_imsi_to_ue_idx.clear();
+  m_ip_to_imsi.clear();
+
+  bool ret = for_each_line(db_filename, [this](const char* line, size_t len) {
+    if (len == 0 or line[0] == '#') {
+      return true;
+    }
+    hss_ue_ctx_t ue_ctx = {};
+    if (not parse_db_line(line, len, &ue_ctx)) {
+      return false;
+    }
+    if (not m_imsi_to_ue_idx.insert(std::make_pair(ue_ctx.imsi, (uint32_t)m_ue_ctxs.size())).second) {
+      m_hss_log->warning("Duplicate IMSI %015" PRIu64 " in DB file, keeping the first entry\n", ue_ctx.imsi);
+      return true;
+    }
+    if (ue_ctx.static_ip_addr != "0.0.0.0") {
+      if (m_ip_to_imsi.insert(std::make_pair(ue_ctx.static_ip_addr, ue_ctx.imsi)).second) {
+        m_hss_log->info("static ip addr %s\n", ue_ctx.static_ip_addr.c_str());
       } else {
-        char buf[128] = {0};
-        if (inet_pton(AF_INET, split[9].c_str(), buf)) {
-          if (m_ip_to_imsi.insert(std::make_pair(split[9], ue_ctx->imsi)).second) {
-            ue_ctx->static_ip_addr = split[9];
-            m_hss_log->info("static ip addr %s\n", ue_ctx->static_ip_addr.c_str());
-          } else {
-            m_hss_log->info("duplicate static ip addr %s\n", split[9].c_str());
-            return false;
-          }
-        } else {
-          m_hss_log->info("invalid static ip addr %s, %s\n", split[9].c_str(), strerror(errno));
-          return false;
-        }
+        m_hss_log->info("duplicate static ip addr %s\n", ue_ctx.static_ip_addr.c_str());
+        return false;
       }
-      m_imsi_to_ue_ctx.insert(std::make_pair(ue_ctx->imsi, std::move(ue_ctx)));
     }
+    m_ue_ctxs.push_back(std::move(ue_ctx));
+    return true;
+  });
+  if (ret) {
+    m_hss_log->info("Read DB file: %s, %zd users\n", db_filename.c_str(), m_ue_ctxs.size());
   }
+  return ret;
+}
 
-  if (m_db_file.is_open()) {
-    m_db_file.close();
+bool hss::parse_db_line(const char* line, size_t len, hss_ue_ctx_t* ue_ctx)
+{
+  const uint32_t column_size = 10;
+  field_t        split[column_size];
+  uint32_t       nof_columns = split_fields(line, len, ',', split, column_size);
+  if (nof_columns != column_size) {
+    m_hss_log->error("Error parsing UE database. Wrong number of columns in .csv\n");
+    m_hss_log->error("Columns: %d, Expected %d.\n", nof_columns, column_size);
+
+    srslte::console("\nError parsing UE database. Wrong number of columns in user database CSV.\n");
+    srslte::console("Perhaps you are using an old user_db.csv?\n");
+    srslte::console("See 'srsepc/user_db.csv.example' for an example.\n\n");
+    return false;
+  }
+  ue_ctx->name = split[0].to_string();
+  if (split[1] == "xor") {
+    ue_ctx->algo = HSS_ALGO_XOR;
+  } else if (split[1] == "mil") {
+    ue_ctx->algo = HSS_ALGO_MILENAGE;
+  } else {
+    m_hss_log->error("Neither XOR nor MILENAGE configured.\n");
+    return false;
+  }
+  if (not parse_uint(split[2], &ue_ctx->imsi)) {
+    m_hss_log->error("Invalid IMSI %s\n", split[2].to_string().c_str());
+    return false;
+  }
+  if (not parse_hex(split[3], ue_ctx->key, 16)) {
+    m_hss_log->error("Invalid key. IMSI: %015" PRIu64 "\n", ue_ctx->imsi);
+    return false;
+  }
+  if (split[4] == "op") {
+    ue_ctx->op_configured = true;
+    if (not parse_hex(split[5], ue_ctx->op, 16)) {
+      m_hss_log->error("Invalid OP. IMSI: %015" PRIu64 "\n", ue_ctx->imsi);
+      return false;
+    }
+    srslte::compute_opc(ue_ctx->key, ue_ctx->op, ue_ctx->opc);
+  } else if (split[4] == "opc") {
+    ue_ctx->op_configured = false;
+    if (not parse_hex(split[5], ue_ctx->opc, 16)) {
+      m_hss_log->error("Invalid OPc. IMSI: %015" PRIu64 "\n", ue_ctx->imsi);
+      return false;
+    }
+  } else {
+    m_hss_log->error("Neither OP nor OPc configured.\n");
+    return false;
+  }
+  if (not parse_hex(split[6], ue_ctx->amf, 2) or not parse_hex(split[7], ue_ctx->sqn, 6)) {
+    m_hss_log->error("Invalid AMF or SQN. IMSI: %015" PRIu64 "\n", ue_ctx->imsi);
+    return false;
   }
 
+  m_hss_log->debug("Added user from DB, IMSI: %015" PRIu64 "\n", ue_ctx->imsi);
+  m_hss_log->debug_hex(ue_ctx->key, 16, "User Key : ");
+  if (ue_ctx->op_configured) {
+    m_hss_log->debug_hex(ue_ctx->op, 16, "User OP : ");
+  }
+  m_hss_log->debug_hex(ue_ctx->opc, 16, "User OPc : ");
+  m_hss_log->debug_hex(ue_ctx->amf, 2, "AMF : ");
+  m_hss_log->debug_hex(ue_ctx->sqn, 6, "SQN : ");
+  uint64_t qci;
+  if (not parse_uint(split[8], &qci) or qci > UINT16_MAX) {
+    m_hss_log->error("Invalid QCI. IMSI: %015" PRIu64 "\n", ue_ctx->imsi);
+    return false;
+  }
+  ue_ctx->qci = (uint16_t)qci;
+  m_hss_log->debug("Default Bearer QCI: %d\n", ue_ctx->qci);
+
+  if (split[9] == "dynamic") {
+    ue_ctx->static_ip_addr = "0.0.0.0";
+  } else {
+    char        buf[128] = {0};
+    std::string ip_addr  = split[9].to_string();
+    if (not inet_pton(AF_INET, ip_addr.c_str(), buf)) {
+      m_hss_log->info("invalid static ip addr %s, %s\n", ip_addr.c_str(), strerror(errno));
+      return false;
+    }
+    ue_ctx->static_ip_addr = ip_addr;
+  }
   return true;
 }
 
 bool hss::write_db_file(std::string db_filename)
 {
-  std::string line;
-  uint8_t     k[16];
-  uint8_t     amf[2];
-  uint8_t     op[16];
-  uint8_t     sqn[6];
-
+  // The new DB is written next to the old one and then replaces it, so that the DB file is complete at all times
+  std::string   tmp_filename = db_filename + ".tmp";
   std::ofstream m_db_file;
 
-  m_db_file.open(db_filename.c_str(), std::ofstream::out);
+  m_db_file.open(tmp_filename.c_str(), std::ofstream::out | std::ofstream::trunc);
   if (!m_db_file.is_open()) {
     return false;
   }
-  m_hss_log->info("Opened DB file: %s\n", db_filename.c_str());
+  m_hss_log->info("Opened DB file: %s\n", tmp_filename.c_str());
 
   // Write comment info
   m_db_file << "#                                                                                           \n"
@@ -216,44 +500,106 @@ bool hss::write_db_file(std::string db_filename)
             << "#                                                                                           \n"
             << "# Note: Lines starting by '#' are ignored and will be overwritten                           \n";
 
-  std::map<uint64_t, std::unique_ptr<hss_ue_ctx_t> >::iterator it = m_imsi_to_ue_ctx.begin();
-  while (it != m_imsi_to_ue_ctx.end()) {
-    m_db_file << it->second->name;
-    m_db_file << ",";
-    m_db_file << (it->second->algo == HSS_ALGO_XOR ? "xor" : "mil");
-    m_db_file << ",";
-    m_db_file << std::setfill('0') << std::setw(15) << it->second->imsi;
-    m_db_file << ",";
-    m_db_file << hex_string(it->second->key, 16);
-    m_db_file << ",";
-    if (it->second->op_configured) {
-      m_db_file << "op,";
-      m_db_file << hex_string(it->second->op, 16);
-    } else {
-      m_db_file << "opc,";
-      m_db_file << hex_string(it->second->opc, 16);
-    }
-    m_db_file << ",";
-    m_db_file << hex_string(it->second->amf, 2);
-    m_db_file << ",";
-    m_db_file << hex_string(it->second->sqn, 6);
-    m_db_file << ",";
-    m_db_file << it->second->qci;
-    if (it->second->static_ip_addr != "0.0.0.0") {
-      m_db_file << ",";
-      m_db_file << it->second->static_ip_addr;
+  char key[33], op[33], amf[5], sqn[13];
+  char line[256];
+  for (const hss_ue_ctx_t& ue_ctx : m_ue_ctxs) {
+    hex_to_str(ue_ctx.key, 16, key);
+    hex_to_str(ue_ctx.op_configured ? ue_ctx.op : ue_ctx.opc, 16, op);
+    hex_to_str(ue_ctx.amf, 2, amf);
+    hex_to_str(ue_ctx.sqn, 6, sqn);
+    snprintf(line,
+             sizeof(line),
+             ",%s,%015" PRIu64 ",%s,%s,%s,%s,%s,%d,",
+             ue_ctx.algo == HSS_ALGO_XOR ? "xor" : "mil",
+             ue_ctx.imsi,
+             key,
+             ue_ctx.op_configured ? "op" : "opc",
+             op,
+             amf,
+             sqn,
+             ue_ctx.qci);
+    m_db_file << ue_ctx.name << line;
+    if (ue_ctx.static_ip_addr != "0.0.0.0") {
+      m_db_file << ue_ctx.static_ip_addr << '\n';
     } else {
-      m_db_file << ",dynamic";
+      m_db_file << "dynamic\n";
     }
-    m_db_file << std::endl;
-    it++;
   }
-  if (m_db_file.is_open()) {
-    m_db_file.close();
+  m_db_file.close();
+  if (m_db_file.fail()) {
+    m_hss_log->error("Error writing DB file %s\n", tmp_filename.c_str());
+    return false;
+  }
+  if (rename(tmp_filename.c_str(), db_filename.c_str()) < 0) {
+    m_hss_log->error("Error replacing DB file %s: %s\n", db_filename.c_str(), strerror(errno));
+    return false;
   }
   return true;
 }
 
+size_t hss::read_sqn_log(const std::string& log_file)
+{
+  size_t nof_records = 0;
+  for_each_line(log_file, [this, &nof_records](const char* line, size_t len) {
+    field_t  fields[2];
+    uint64_t imsi;
+    uint8_t  sqn[6];
+    // A record cut short when the EPC stopped is ignored, and dropped when the log is merged
+    nof_records++;
+    if (split_fields(line, len, ',', fields, 2) != 2 or not parse_uint(fields[0], &imsi) or
+        not parse_hex(fields[1], sqn, 6)) {
+      return true;
+    }
+    std::unordered_map<uint64_t, uint32_t>::iterator it = m_imsi_to_ue_idx.find(imsi);
+    if (it != m_imsi_to_ue_idx.end()) {
+      m_ue_ctxs[it->second].set_sqn(sqn);
+    }
+    return true;
+  });
+  return nof_records;
+}
+
+bool hss::open_sqn_log()
+{
+  m_sqn_log_fd = open(m_sqn_log_file.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (m_sqn_log_fd < 0) {
+    m_hss_log->error("Error opening SQN log file %s: %s\n", m_sqn_log_file.c_str(), strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+// Called with the SQN mutex locked
+void hss::compact_sqn_log()
+{
+  // If the DB file can not be written the log keeps all the records, and the merge is retried later
+  if (write_db_file(db_file)) {
+    if (ftruncate(m_sqn_log_fd, 0) < 0) {
+      m_hss_log->error("Error truncating SQN log file %s: %s\n", m_sqn_log_file.c_str(), strerror(errno));
+    }
+  } else {
+    m_hss_log->error("Error merging SQN log file into DB file %s\n", db_file.c_str());
+  }
+  m_sqn_log_records = 0;
+}
+
+void hss::update_sqn(hss_ue_ctx_t* ue_ctx, const uint8_t* sqn)
+{
+  char sqn_str[13];
+  char record[40];
+  hex_to_str(sqn, 6, sqn_str);
+  int len = snprintf(record, sizeof(record), "%015" PRIu64 ",%s\n", ue_ctx->imsi, sqn_str);
+
+  std::lock_guard<std::mutex> lock(m_sqn_mutex);
+  ue_ctx->set_sqn(sqn);
+  if (write(m_sqn_log_fd, record, len) != len) {
+    m_hss_log->error("Error writing SQN log file %s\n", m_sqn_log_file.c_str());
+  }
+  if (++m_sqn_log_records >= std::max(m_ue_ctxs.size(), min_sqn_log_records)) {
+    compact_sqn_log();
+  }
+}
+
 bool hss::gen_auth_info_answer(uint64_t imsi, uint8_t* k_asme, uint8_t* autn, uint8_t* rand, uint8_t* xres)
 {
 
@@ -432,19 +778,17 @@ void hss::gen_auth_info_answer_xor(hss_ue_ctx_t* ue_ctx, uint8_t* k_asme, uint8_
 
 bool hss::gen_update_loc_answer(uint64_t imsi, uint8_t* qci)
 {
-  std::map<uint64_t, std::unique_ptr<hss_ue_ctx_t> >::iterator ue_ctx_it = m_imsi_to_ue_ctx.find(imsi);
-  if (ue_ctx_it == m_imsi_to_ue_ctx.end()) {
-    m_hss_log->info("User not found. IMSI: %015" PRIu64 "\n", imsi);
+  hss_ue_ctx_t* ue_ctx = get_ue_ctx(imsi);
+  if (ue_ctx == nullptr) {
     srslte::console("User not found at HSS. IMSI: %015" PRIu64 "\n", imsi);
     return false;
   }
-  const std::unique_ptr<hss_ue_ctx_t>& ue_ctx = ue_ctx_it->second;
   m_hss_log->info("Found User %015" PRIu64 "\n", imsi);
   *qci = ue_ctx->qci;
   return true;
 }
 
-bool hss::resync_sqn(uint64_t imsi, uint8_t* auts)
+bool hss::resync_sqn(uint64_t imsi, const uint8_t* auts)
 {
   m_hss_log->debug("Re-syncing SQN\n");
   hss_ue_ctx_t* ue_ctx = get_ue_ctx(imsi);
@@ -454,33 +798,35 @@ bool hss::resync_sqn(uint64_t imsi, uint8_t* auts)
     return false;
   }
 
+  uint8_t sqn[6];
+  memcpy(sqn, ue_ctx->sqn, sizeof(sqn));
   switch (ue_ctx->algo) {
     case HSS_ALGO_XOR:
-      resync_sqn_xor(ue_ctx, auts);
+      resync_sqn_xor(ue_ctx, auts, sqn);
       break;
     case HSS_ALGO_MILENAGE:
-      resync_sqn_milenage(ue_ctx, auts);
+      resync_sqn_milenage(ue_ctx, auts, sqn);
       break;
   }
 
-  increment_seq_after_resync(ue_ctx);
+  increment_seq_after_resync(sqn, sqn);
+  update_sqn(ue_ctx, sqn);
   return true;
 }
 
-void hss::resync_sqn_xor(hss_ue_ctx_t* ue_ctx, uint8_t* auts)
+void hss::resync_sqn_xor(hss_ue_ctx_t* ue_ctx, const uint8_t* auts, uint8_t* sqn)
 {
   m_hss_log->error("XOR SQN synchronization not supported yet\n");
   srslte::console("XOR SQNs synchronization not supported yet\n");
   return;
 }
 
-void hss::resync_sqn_milenage(hss_ue_ctx_t* ue_ctx, uint8_t* auts)
+void hss::resync_sqn_milenage(hss_ue_ctx_t* ue_ctx, const uint8_t* auts, uint8_t* sqn)
 {
-  // Get K, AMF, OPC and SQN
+  // Get K, AMF and OPC
   uint8_t* k   = ue_ctx->key;
   uint8_t* amf = ue_ctx->amf;
   uint8_t* opc = ue_ctx->opc;
-  uint8_t* sqn = ue_ctx->sqn;
 
   // Temp variables
   uint8_t last_rand[16];
@@ -523,18 +869,20 @@ void hss::resync_sqn_milenage(hss_ue_ctx_t* ue_ctx, uint8_t* auts)
   srslte::security_milenage_f1_star(k, opc, last_rand, sqn_ms, dummy_amf, mac_s_tmp);
   m_hss_log->debug_hex(mac_s_tmp, 8, "MAC calc : ");
 
-  ue_ctx->set_sqn(sqn_ms);
+  memcpy(sqn, sqn_ms, 6);
   return;
 }
 
 void hss::increment_ue_sqn(hss_ue_ctx_t* ue_ctx)
 {
-  increment_sqn(ue_ctx->sqn, ue_ctx->sqn);
+  uint8_t next_sqn[6];
+  increment_sqn(ue_ctx->sqn, next_sqn);
+  update_sqn(ue_ctx, next_sqn);
   m_hss_log->debug("Incremented SQN  -- IMSI: %015" PRIu64 "\n", ue_ctx->imsi);
   m_hss_log->debug_hex(ue_ctx->sqn, 6, "SQN: ");
 }
 
-void hss::increment_sqn(uint8_t* sqn, uint8_t* next_sqn)
+void hss::increment_sqn(const uint8_t* sqn, uint8_t* next_sqn)
 {
   // The following SQN incrementation function is implemented according to 3GPP TS 33.102 version 11.5.1 Annex C
   uint64_t seq;
@@ -564,11 +912,9 @@ void hss::increment_sqn(uint8_t* sqn, uint8_t* next_sqn)
   return;
 }
 
-void hss::increment_seq_after_resync(hss_ue_ctx_t* ue_ctx)
+void hss::increment_seq_after_resync(const uint8_t* sqn, uint8_t* next_sqn)
 {
   // This function only increment the SEQ part of the SQN for resynchronization purpose
-  uint8_t* sqn = ue_ctx->sqn;
-
   uint64_t seq;
   uint64_t ind;
   uint64_t sqn64;
@@ -589,7 +935,7 @@ void hss::increment_seq_after_resync(hss_ue_ctx_t* ue_ctx)
   nextsqn = (nextseq << LTE_FDD_ENB_IND_HE_N_BITS) | ind;
 
   for (int i = 0; i < 6; i++) {
-    sqn[i] = (nextsqn >> (5 - i) * 8) & 0xFF;
+    next_sqn[i] = (nextsqn >> (5 - i) * 8) & 0xFF;
   }
   return;
 }
@@ -604,48 +950,13 @@ void hss::gen_rand(uint8_t rand_[16])
 
 hss_ue_ctx_t* hss::get_ue_ctx(uint64_t imsi)
 {
-  std::map<uint64_t, std::unique_ptr<hss_ue_ctx_t> >::iterator ue_ctx_it = m_imsi_to_ue_ctx.find(imsi);
-  if (ue_ctx_it == m_imsi_to_ue_ctx.end()) {
+  std::unordered_map<uint64_t, uint32_t>::iterator ue_idx_it = m_imsi_to_ue_idx.find(imsi);
+  if (ue_idx_it == m_imsi_to_ue_idx.end()) {
     m_hss_log->info("User not found. IMSI: %015" PRIu64 "\n", imsi);
     return nullptr;
   }
 
-  return ue_ctx_it->second.get();
-}
-
-/* Helper functions*/
-std::vector<std::string> hss::split_string(const std::string& str, char delimiter)
-{
-  std::vector<std::string> tokens;
-  std::string              token;
-  std::istringstream       tokenStream(str);
-
-  while (std::getline(tokenStream, token, delimiter)) {
-    tokens.push_back(token);
-  }
-  return tokens;
-}
-
-void hss::get_uint_vec_from_hex_str(const std::string& key_str, uint8_t* key, uint len)
-{
-  const char* pos = key_str.c_str();
-
-  for (uint count = 0; count < len; count++) {
-    sscanf(pos, "%2hhx", &key[count]);
-    pos += 2;
-  }
-  return;
-}
-
-std::string hss::hex_string(uint8_t* hex, int size)
-{
-  std::stringstream ss;
-
-  ss << std::hex << std::setfill('0');
-  for (int i = 0; i < size; i++) {
-    ss << std::setw(2) << static_cast<unsigned>(hex[i]);
-  }
-  return ss.str();
+  return &m_ue_ctxs[ue_idx_it->second];
 }
 
 std::map<std::string, uint64_t> hss::get_ip_to_imsi(void) const
@@ -83,6 +83,7 @@ void parse_args(all_args_t* args, int argc, char* argv[])
   string mbms_gw_sgi_mb_if_mask;
   string mbms_gw_m1u_multi_addr;
   string mbms_gw_m1u_multi_if;
+  string mbms_gw_thread_placement;
 
   string log_filename;
 
@@ -106,6 +107,8 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("mbms_gw.m1u_multi_addr",      bpo::value<string>(&mbms_gw_m1u_multi_addr)->default_value("239.255.0.1"), "M1-u GTPu destination multicast address.")
     ("mbms_gw.m1u_multi_if",        bpo::value<string>(&mbms_gw_m1u_multi_if)->default_value("127.0.1.200"), "Local interface IP for M1-U multicast packets.")
     ("mbms_gw.m1u_multi_ttl",       bpo::value<int>(&args->mbms_gw_args.m1u_multi_ttl)->default_value(1), "TTL for M1-U multicast packets.")
+    ("mbms_gw.m1u_gso",             bpo::value<bool>(&args->mbms_gw_args.m1u_gso)->default_value(false), "Send the batches of M1-U packets of the same size with UDP GSO.")
+    ("mbms_gw.thread_placement",    bpo::value<string>(&mbms_gw_thread_placement)->default_value(""), "Placement of the forwarding thread, cpus[:policy[:priority]].")
 
     ("log.all_level",     bpo::value<string>(&args->log_args.all_level)->default_value("info"),   "ALL log level")
     ("log.all_hex_limit", bpo::value<int>(&args->log_args.all_hex_limit)->default_value(32),  "ALL log hex dump limit")
@@ -169,6 +172,11 @@ void parse_args(all_args_t* args, int argc, char* argv[])
   args->mbms_gw_args.m1u_multi_addr = mbms_gw_m1u_multi_addr;
   args->mbms_gw_args.m1u_multi_if   = mbms_gw_m1u_multi_if;
 
+  if (!threads_set_placement("MBMS_GW", mbms_gw_thread_placement.c_str())) {
+    cout << "Error parsing the placement " << mbms_gw_thread_placement << " of the MBMS-GW thread - exiting" << endl;
+    exit(1);
+  }
+
   // Apply all_level to any unset layers
   if (vm.count("log.all_level")) {
     if (!vm.count("log.mbms_gw_level")) {
@@ -30,6 +30,7 @@
 #include <netinet/in.h>
 #include <netinet/udp.h>
 #include <sys/ioctl.h>
+#include <sys/select.h>
 #include <sys/socket.h>
 
 namespace srsepc {
@@ -139,6 +140,13 @@ int mbms_gw::init_sgi_mb_if(mbms_gw_args_t* args)
     m_mbms_gw_log->debug("Set TUN device name: %s\n", args->sgi_mb_if_name.c_str());
   }
 
+  // The packets are read until the interface is empty or the batch is full
+  if (fcntl(m_sgi_mb_if, F_SETFL, fcntl(m_sgi_mb_if, F_GETFL) | O_NONBLOCK) < 0) {
+    m_mbms_gw_log->error("Failed to set TUN device non-blocking: %s\n", strerror(errno));
+    close(m_sgi_mb_if);
+    return SRSLTE_ERROR_CANT_START;
+  }
+
   // Bring up the interface
   int sgi_mb_sock = socket(AF_INET, SOCK_DGRAM, 0);
   if (sgi_mb_sock < 0) {
@@ -231,6 +239,21 @@ int mbms_gw::init_m1_u(mbms_gw_args_t* args)
   m_m1u_multi_addr.sin_family      = AF_INET;
   m_m1u_multi_addr.sin_port        = htons(GTPU_RX_PORT + 1);
   m_m1u_multi_addr.sin_addr.s_addr = inet_addr(args->m1u_multi_addr.c_str());
+
+  for (uint32_t i = 0; i < MAX_BATCH; i++) {
+    m_tx_msgs[i].msg_hdr.msg_name    = &m_m1u_multi_addr;
+    m_tx_msgs[i].msg_hdr.msg_namelen = sizeof(m_m1u_multi_addr);
+    m_tx_msgs[i].msg_hdr.msg_iov     = &m_tx_iovs[i];
+    m_tx_msgs[i].msg_hdr.msg_iovlen  = 1;
+  }
+
+#ifdef UDP_SEGMENT
+  m_m1u_gso = args->m1u_gso;
+#else
+  if (args->m1u_gso) {
+    m_mbms_gw_log->warning("UDP GSO not supported by this build. Sending the M1-U batches with sendmmsg\n");
+  }
+#endif
   m_mbms_gw_log->info("Initialized M1-U\n");
 
   return SRSLTE_SUCCESS;
@@ -240,31 +263,58 @@ void mbms_gw::run_thread()
 {
   // Mark the thread as running
   m_running = true;
-  srslte::byte_buffer_t* msg;
-  msg = m_pool->allocate();
+  for (srslte::byte_buffer_t*& pdu : m_pdus) {
+    pdu = m_pool->allocate("mbms_gw::run_thread");
+  }
 
-  uint8_t seq = 0;
+  fd_set set;
   while (m_running) {
-    msg->clear();
-    int n;
-    do {
-      n = read(m_sgi_mb_if, msg->msg, SRSLTE_MAX_BUFFER_SIZE_BYTES);
-    } while (n == -1 && errno == EAGAIN);
-
+    FD_ZERO(&set);
+    FD_SET(m_sgi_mb_if, &set);
+    int n = select(m_sgi_mb_if + 1, &set, NULL, NULL, NULL);
     if (n < 0) {
-      m_mbms_gw_log->error("Error reading from TUN interface. Error: %s\n", strerror(errno));
-    } else {
-      msg->N_bytes = n;
-      handle_sgi_md_pdu(msg);
+      if (errno != EINTR) {
+        m_mbms_gw_log->error("Error from select on TUN interface. Error: %s\n", strerror(errno));
+      }
+      continue;
     }
+    read_sgi_mb();
+  }
+
+  for (srslte::byte_buffer_t* pdu : m_pdus) {
+    m_pool->deallocate(pdu);
   }
-  m_pool->deallocate(msg);
   return;
 }
 
-void mbms_gw::handle_sgi_md_pdu(srslte::byte_buffer_t* msg)
+void mbms_gw::read_sgi_mb()
+{
+  size_t   buf_len  = SRSLTE_MAX_BUFFER_SIZE_BYTES - SRSLTE_BUFFER_HEADER_OFFSET;
+  uint32_t nof_pdus = 0;
+  while (nof_pdus < MAX_BATCH) {
+    srslte::byte_buffer_t* msg = m_pdus[nof_pdus];
+    msg->clear();
+    ssize_t n = read(m_sgi_mb_if, msg->msg, buf_len);
+    if (n < 0) {
+      if (errno != EAGAIN and errno != EWOULDBLOCK) {
+        m_mbms_gw_log->error("Error reading from TUN interface. Error: %s\n", strerror(errno));
+      }
+      break;
+    }
+    msg->N_bytes = n;
+    if (handle_sgi_md_pdu(msg)) {
+      m_tx_iovs[nof_pdus].iov_base = msg->msg;
+      m_tx_iovs[nof_pdus].iov_len  = msg->N_bytes;
+      nof_pdus++;
+    }
+  }
+  if (nof_pdus > 0) {
+    send_m1u(nof_pdus);
+  }
+}
+
+bool mbms_gw::handle_sgi_md_pdu(srslte::byte_buffer_t* msg)
 {
-  uint8_t               version;
   srslte::gtpu_header_t header;
 
   // Setup GTP-U header
@@ -276,27 +326,87 @@ void mbms_gw::handle_sgi_md_pdu(srslte::byte_buffer_t* msg)
   // Sanity Check IP packet
   if (msg->N_bytes < 20) {
     m_mbms_gw_log->error("IPv4 min len: %d, drop msg len %d\n", 20, msg->N_bytes);
-    return;
+    return false;
   }
 
   // IP Headers
   struct iphdr* iph = (struct iphdr*)msg->msg;
   if (iph->version != 4) {
     m_mbms_gw_log->warning("IPv6 not supported yet.\n");
-    return;
+    return false;
   }
 
-  // Write GTP-U header into packet
+  // Write GTP-U header into the headroom of the packet
   if (!srslte::gtpu_write_header(&header, msg, m_mbms_gw_log)) {
     srslte::console("Error writing GTP-U header on PDU\n");
+    return false;
+  }
+  return true;
+}
+
+void mbms_gw::send_m1u(uint32_t nof_pdus)
+{
+  if (m_m1u_gso and send_m1u_gso(nof_pdus)) {
+    return;
   }
 
-  int n = sendto(m_m1u, msg->msg, msg->N_bytes, 0, (sockaddr*)&m_m1u_multi_addr, sizeof(struct sockaddr));
-  if (n < 0) {
-    srslte::console("Error writing to M1-U socket.\n");
-  } else {
-    m_mbms_gw_log->debug("Sent %d Bytes\n", msg->N_bytes);
+  // sendmmsg may send only part of the messages, and fails on the first message that cannot be sent
+  uint32_t nof_sent = 0;
+  while (nof_sent < nof_pdus) {
+    int n = sendmmsg(m_m1u, &m_tx_msgs[nof_sent], nof_pdus - nof_sent, 0);
+    if (n <= 0) {
+      srslte::console("Error writing to M1-U socket.\n");
+      m_mbms_gw_log->error("Error sending %d packets to M1-U: %s\n", nof_pdus - nof_sent, strerror(errno));
+      return;
+    }
+    nof_sent += n;
+  }
+  m_mbms_gw_log->debug("Sent %d packets\n", nof_pdus);
+}
+
+bool mbms_gw::send_m1u_gso(uint32_t nof_pdus)
+{
+#ifdef UDP_SEGMENT
+  // The kernel splits the payload in datagrams of the size of the first one, only the last one may be shorter
+  size_t seg_size = m_tx_iovs[0].iov_len;
+  size_t total    = 0;
+  for (uint32_t i = 0; i < nof_pdus; i++) {
+    if (m_tx_iovs[i].iov_len > seg_size or (i + 1 < nof_pdus and m_tx_iovs[i].iov_len != seg_size)) {
+      return false;
+    }
+    total += m_tx_iovs[i].iov_len;
+  }
+  if (nof_pdus < 2 or total > UINT16_MAX - sizeof(struct udphdr) - sizeof(struct iphdr)) {
+    return false;
+  }
+
+  char   control[CMSG_SPACE(sizeof(uint16_t))] = {};
+  msghdr msg                                   = m_tx_msgs[0].msg_hdr;
+  msg.msg_iov                                  = m_tx_iovs.data();
+  msg.msg_iovlen                               = nof_pdus;
+  msg.msg_control                              = control;
+  msg.msg_controllen                           = sizeof(control);
+
+  uint16_t gso_size = seg_size;
+  cmsghdr* cm       = CMSG_FIRSTHDR(&msg);
+  cm->cmsg_level    = SOL_UDP;
+  cm->cmsg_type     = UDP_SEGMENT;
+  cm->cmsg_len      = CMSG_LEN(sizeof(gso_size));
+  memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+
+  if (sendmsg(m_m1u, &msg, 0) < 0) {
+    if (errno == EIO or errno == EINVAL or errno == ENOPROTOOPT) {
+      // Not supported by the kernel or the interface, the batches are sent with sendmmsg from now on
+      m_mbms_gw_log->warning("Disabling UDP GSO on M1-U: %s\n", strerror(errno));
+      m_m1u_gso = false;
+    }
+    return false;
   }
+  m_mbms_gw_log->debug("Sent %d packets of %zd bytes with UDP GSO\n", nof_pdus, seg_size);
+  return true;
+#else
+  return false;
+#endif
 }
 
 } // namespace srsepc
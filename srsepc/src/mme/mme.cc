@@ -79,6 +79,9 @@ int mme::init(mme_args_t*         args,
     exit(-1);
   }
 
+  /*Init HSS interface*/
+  m_hss = hss::get_instance();
+
   /*Init GTP-C*/
   m_mme_gtpc = mme_gtpc::get_instance();
   if (!m_mme_gtpc->init(m_mme_gtpc_log)) {
@@ -122,14 +125,16 @@ void mme::run_thread()
   // Get S1-MME and S11 sockets
   int s1mme = m_s1ap->get_s1_mme();
   int s11   = m_mme_gtpc->get_s11();
+  int hss   = m_hss->get_auth_info_answer_fd();
 
   while (m_running) {
     pdu->clear();
-    int max_fd = std::max(s1mme, s11);
+    int max_fd = std::max(std::max(s1mme, s11), hss);
 
     FD_ZERO(&m_set);
     FD_SET(s1mme, &m_set);
     FD_SET(s11, &m_set);
+    FD_SET(hss, &m_set);
 
     // Add timers to select
     for (std::vector<mme_timer_t>::iterator it = timers.begin(); it != timers.end(); ++it) {
@@ -173,6 +178,13 @@ void mme::run_thread()
         pdu->N_bytes = recvfrom(s11, pdu->msg, sz, 0, NULL, NULL);
         m_mme_gtpc->handle_s11_pdu(pdu);
       }
+      // Handle authentication vectors from the HSS
+      if (FD_ISSET(hss, &m_set)) {
+        m_hss->get_auth_info_answers(&m_auth_info_answers);
+        for (const auth_info_answer_t& answer : m_auth_info_answers) {
+          m_s1ap->handle_auth_info_answer(answer);
+        }
+      }
       // Handle NAS Timers
       for (std::vector<mme_timer_t>::iterator it = timers.begin(); it != timers.end();) {
         if (FD_ISSET(it->fd, &m_set)) {
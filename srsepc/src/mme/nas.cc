@@ -207,9 +207,7 @@ bool nas::handle_imsi_attach_request_unknown_ue(uint32_t
                                                 const nas_if_t&                                       itf,
                                                 srslte::log*                                          nas_log)
 {
-  nas*                      nas_ctx;
-  srslte::byte_buffer_t*    nas_tx;
-  srslte::byte_buffer_pool* pool = srslte::byte_buffer_pool::get_instance();
+  nas* nas_ctx;
 
   // Interfaces
   s1ap_interface_nas* s1ap = itf.s1ap;
@@ -263,38 +261,12 @@ bool nas::handle_imsi_attach_request_unknown_ue(uint32_t
   // Save attach request type
   nas_ctx->m_emm_ctx.attach_type = attach_req.eps_attach_type;
 
-  // Get Authentication Vectors from HSS
-  if (!hss->gen_auth_info_answer(nas_ctx->m_emm_ctx.imsi,
-                                 nas_ctx->m_sec_ctx.k_asme,
-                                 nas_ctx->m_sec_ctx.autn,
-                                 nas_ctx->m_sec_ctx.rand,
-                                 nas_ctx->m_sec_ctx.xres)) {
-    srslte::console("User not found. IMSI %015" PRIu64 "\n", nas_ctx->m_emm_ctx.imsi);
-    nas_log->info("User not found. IMSI %015" PRIu64 "\n", nas_ctx->m_emm_ctx.imsi);
-    delete nas_ctx;
-    return false;
-  }
-
-  // Allocate eKSI for this authentication vector
-  // Here we assume a new security context thus a new eKSI
-  nas_ctx->m_sec_ctx.eksi = 0;
-
-  // Save the UE context
-  s1ap->add_nas_ctx_to_imsi_map(nas_ctx);
+  // Save the UE context. It is stored by IMSI once the HSS knows the subscriber
   s1ap->add_nas_ctx_to_mme_ue_s1ap_id_map(nas_ctx);
   s1ap->add_ue_to_enb_set(enb_sri->sinfo_assoc_id, nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
 
-  // Pack NAS Authentication Request in Downlink NAS Transport msg
-  nas_tx = pool->allocate();
-  nas_ctx->pack_authentication_request(nas_tx);
-
-  // Send reply to eNB
-  s1ap->send_downlink_nas_transport(
-      nas_ctx->m_ecm_ctx.enb_ue_s1ap_id, nas_ctx->m_ecm_ctx.mme_ue_s1ap_id, nas_tx, nas_ctx->m_ecm_ctx.enb_sri);
-  pool->deallocate(nas_tx);
-
-  nas_log->info("Downlink NAS: Sending Authentication Request\n");
-  srslte::console("Downlink NAS: Sending Authentication Request\n");
+  // Get Authentication Vectors from HSS. Here we assume a new security context thus a new eKSI
+  nas_ctx->request_auth_info(0);
   return true;
 }
 
@@ -541,23 +513,8 @@ bool nas::handle_guti_attach_request_known_ue(nas*
     srslte::console("GUTI Attach request NAS integrity failed.\n");
     srslte::console("RE-starting authentication procedure.\n");
 
-    // Get Authentication Vectors from HSS
-    if (!hss->gen_auth_info_answer(emm_ctx->imsi, sec_ctx->k_asme, sec_ctx->autn, sec_ctx->rand, sec_ctx->xres)) {
-      srslte::console("User not found. IMSI %015" PRIu64 "\n", emm_ctx->imsi);
-      nas_log->info("User not found. IMSI %015" PRIu64 "\n", emm_ctx->imsi);
-      return false;
-    }
-
-    // Restarting security context. Reseting eKSI to 0.
-    sec_ctx->eksi = 0;
-    nas_tx        = pool->allocate();
-    nas_ctx->pack_authentication_request(nas_tx);
-
-    // Send reply to eNB
-    s1ap->send_downlink_nas_transport(ecm_ctx->enb_ue_s1ap_id, ecm_ctx->mme_ue_s1ap_id, nas_tx, *enb_sri);
-    pool->deallocate(nas_tx);
-    nas_log->info("Downlink NAS: Sent Authentication Request\n");
-    srslte::console("Downlink NAS: Sent Authentication Request\n");
+    // Get Authentication Vectors from HSS. Restarting security context, reseting eKSI to 0.
+    nas_ctx->request_auth_info(0);
     return true;
   }
 }
@@ -893,31 +850,8 @@ bool nas::handle_attach_request(srslte::byte_buffer_t* nas_rx)
     // Save attach request type
     m_emm_ctx.attach_type = attach_req.eps_attach_type;
 
-    // Get Authentication Vectors from HSS
-    if (!m_hss->gen_auth_info_answer(
-            m_emm_ctx.imsi, m_sec_ctx.k_asme, m_sec_ctx.autn, m_sec_ctx.rand, m_sec_ctx.xres)) {
-      srslte::console("User not found. IMSI %015" PRIu64 "\n", m_emm_ctx.imsi);
-      m_nas_log->info("User not found. IMSI %015" PRIu64 "\n", m_emm_ctx.imsi);
-      return false;
-    }
-
-    // Allocate eKSI for this authentication vector
-    // Here we assume a new security context thus a new eKSI
-    m_sec_ctx.eksi = 0;
-
-    // Save the UE context
-    m_s1ap->add_nas_ctx_to_imsi_map(this);
-
-    // Pack NAS Authentication Request in Downlink NAS Transport msg
-    srslte::byte_buffer_t* nas_tx = m_pool->allocate();
-    pack_authentication_request(nas_tx);
-
-    // Send reply to eNB
-    m_s1ap->send_downlink_nas_transport(m_ecm_ctx.enb_ue_s1ap_id, m_ecm_ctx.mme_ue_s1ap_id, nas_tx, m_ecm_ctx.enb_sri);
-    m_pool->deallocate(nas_tx);
-
-    m_nas_log->info("Downlink NAS: Sending Authentication Request\n");
-    srslte::console("Downlink NAS: Sending Authentication Request\n");
+    // Get Authentication Vectors from HSS. Here we assume a new security context thus a new eKSI
+    request_auth_info(0);
     return true;
   } else {
     m_nas_log->error("Attach request from known UE\n");
@@ -1100,7 +1034,6 @@ bool nas::handle_esm_information_response(srslte::byte_buffer_t* nas_rx)
 
 bool nas::handle_identity_response(srslte::byte_buffer_t* nas_rx)
 {
-  srslte::byte_buffer_t*            nas_tx;
   LIBLTE_MME_ID_RESPONSE_MSG_STRUCT id_resp;
 
   LIBLTE_ERROR_ENUM err = liblte_mme_unpack_identity_response_msg((LIBLTE_BYTE_MSG_STRUCT*)nas_rx, &id_resp);
@@ -1120,35 +1053,8 @@ bool nas::handle_identity_response(srslte::byte_buffer_t* nas_rx)
   // Set UE's IMSI
   m_emm_ctx.imsi = imsi;
 
-  // Get Authentication Vectors from HSS
-  if (!m_hss->gen_auth_info_answer(imsi, m_sec_ctx.k_asme, m_sec_ctx.autn, m_sec_ctx.rand, m_sec_ctx.xres)) {
-    srslte::console("User not found. IMSI %015" PRIu64 "\n", imsi);
-    m_nas_log->info("User not found. IMSI %015" PRIu64 "\n", imsi);
-    return false;
-  }
-  // Identity reponse from unknown GUTI atach. Assigning new eKSI.
-  m_sec_ctx.eksi = 0;
-
-  // Make sure UE context was not previously stored in IMSI map
-  nas* nas_ctx = m_s1ap->find_nas_ctx_from_imsi(imsi);
-  if (nas_ctx != nullptr) {
-    m_nas_log->warning("UE context already exists.\n");
-    m_s1ap->delete_ue_ctx(imsi);
-  }
-
-  // Store UE context im IMSI map
-  m_s1ap->add_nas_ctx_to_imsi_map(this);
-
-  // Pack NAS Authentication Request in Downlink NAS Transport msg
-  nas_tx = m_pool->allocate();
-  pack_authentication_request(nas_tx);
-
-  // Send reply to eNB
-  m_s1ap->send_downlink_nas_transport(m_ecm_ctx.enb_ue_s1ap_id, m_ecm_ctx.mme_ue_s1ap_id, nas_tx, m_ecm_ctx.enb_sri);
-  m_pool->deallocate(nas_tx);
-
-  m_nas_log->info("Downlink NAS: Sent Authentication Request\n");
-  srslte::console("Downlink NAS: Sent Authentication Request\n");
+  // Get Authentication Vectors from HSS. Identity reponse from unknown GUTI atach, assigning new eKSI.
+  request_auth_info(0);
   return true;
 }
 
@@ -1176,7 +1082,6 @@ bool nas::handle_authentication_failure(srslte::byte_buffer_t* nas_rx)
 {
   m_nas_log->info("Received Authentication Failure\n");
 
-  srslte::byte_buffer_t*                       nas_tx;
   LIBLTE_MME_AUTHENTICATION_FAILURE_MSG_STRUCT auth_fail;
   LIBLTE_ERROR_ENUM                            err;
 
@@ -1202,33 +1107,9 @@ bool nas::handle_authentication_failure(srslte::byte_buffer_t* nas_rx)
         m_nas_log->error("Missing fail parameter\n");
         return false;
       }
-      if (!m_hss->resync_sqn(m_emm_ctx.imsi, auth_fail.auth_fail_param)) {
-        srslte::console("Resynchronization failed. IMSI %015" PRIu64 "\n", m_emm_ctx.imsi);
-        m_nas_log->info("Resynchronization failed. IMSI %015" PRIu64 "\n", m_emm_ctx.imsi);
-        return false;
-      }
-      // Get Authentication Vectors from HSS
-      if (!m_hss->gen_auth_info_answer(
-              m_emm_ctx.imsi, m_sec_ctx.k_asme, m_sec_ctx.autn, m_sec_ctx.rand, m_sec_ctx.xres)) {
-        srslte::console("User not found. IMSI %015" PRIu64 "\n", m_emm_ctx.imsi);
-        m_nas_log->info("User not found. IMSI %015" PRIu64 "\n", m_emm_ctx.imsi);
-        return false;
-      }
-
-      // Making sure eKSI is different from previous eKSI.
-      m_sec_ctx.eksi = (m_sec_ctx.eksi + 1) % 6;
-
-      // Pack NAS Authentication Request in Downlink NAS Transport msg
-      nas_tx = m_pool->allocate();
-      pack_authentication_request(nas_tx);
-
-      // Send reply to eNB
-      m_s1ap->send_downlink_nas_transport(
-          m_ecm_ctx.enb_ue_s1ap_id, m_ecm_ctx.mme_ue_s1ap_id, nas_tx, m_ecm_ctx.enb_sri);
-      m_pool->deallocate(nas_tx);
-
-      m_nas_log->info("Downlink NAS: Sent Authentication Request\n");
-      srslte::console("Downlink NAS: Sent Authentication Request\n");
+      // Get Authentication Vectors from HSS after resynchronizing the SQN. Making sure eKSI is different from previous
+      // eKSI.
+      request_auth_info((m_sec_ctx.eksi + 1) % 6, auth_fail.auth_fail_param);
       // TODO Start T3460 Timer!
       break;
   }
@@ -1263,6 +1144,59 @@ bool nas::handle_detach_request(srslte::byte_buffer_t* nas_msg)
 }
 
 /*Packing/Unpacking helper functions*/
+/***************************************
+ *
+ * Authentication vectors
+ *
+ ***************************************/
+void nas::request_auth_info(uint8_t eksi, const uint8_t* auts)
+{
+  m_auth_info_pending = true;
+  m_pending_eksi      = eksi;
+  m_hss->gen_auth_info_answer_async(m_emm_ctx.imsi, m_ecm_ctx.mme_ue_s1ap_id, auts);
+}
+
+bool nas::handle_auth_info_answer(const auth_info_answer_t& answer)
+{
+  if (not m_auth_info_pending or answer.imsi != m_emm_ctx.imsi) {
+    m_nas_log->info("Discarding outdated authentication vector. IMSI %015" PRIu64 "\n", answer.imsi);
+    return true;
+  }
+  m_auth_info_pending = false;
+  if (not answer.found) {
+    srslte::console("User not found. IMSI %015" PRIu64 "\n", answer.imsi);
+    m_nas_log->info("User not found. IMSI %015" PRIu64 "\n", answer.imsi);
+    return false;
+  }
+  memcpy(m_sec_ctx.k_asme, answer.k_asme, sizeof(m_sec_ctx.k_asme));
+  memcpy(m_sec_ctx.autn, answer.autn, sizeof(m_sec_ctx.autn));
+  memcpy(m_sec_ctx.rand, answer.rand, sizeof(m_sec_ctx.rand));
+  memcpy(m_sec_ctx.xres, answer.xres, sizeof(m_sec_ctx.xres));
+  m_sec_ctx.eksi = m_pending_eksi;
+
+  // Store UE context in IMSI map, replacing the context previously stored for the IMSI
+  nas* nas_ctx = m_s1ap->find_nas_ctx_from_imsi(m_emm_ctx.imsi);
+  if (nas_ctx != this) {
+    if (nas_ctx != nullptr) {
+      m_nas_log->warning("UE context already exists.\n");
+      m_s1ap->delete_ue_ctx(m_emm_ctx.imsi);
+    }
+    m_s1ap->add_nas_ctx_to_imsi_map(this);
+  }
+
+  // Pack NAS Authentication Request in Downlink NAS Transport msg
+  srslte::byte_buffer_t* nas_tx = m_pool->allocate();
+  pack_authentication_request(nas_tx);
+
+  // Send reply to eNB
+  m_s1ap->send_downlink_nas_transport(m_ecm_ctx.enb_ue_s1ap_id, m_ecm_ctx.mme_ue_s1ap_id, nas_tx, m_ecm_ctx.enb_sri);
+  m_pool->deallocate(nas_tx);
+
+  m_nas_log->info("Downlink NAS: Sent Authentication Request\n");
+  srslte::console("Downlink NAS: Sent Authentication Request\n");
+  return true;
+}
+
 bool nas::pack_authentication_request(srslte::byte_buffer_t* nas_buffer)
 {
   m_nas_log->info("Packing Authentication Request\n");
@@ -40,7 +40,7 @@ namespace srsepc {
  * comminication with the MME
  *
  **********************************************/
-spgw::gtpc::gtpc() : m_h_next_ue_ip(0), m_next_ctrl_teid(1), m_next_user_teid(1), m_max_paging_queue(0)
+spgw::gtpc::gtpc() : m_h_next_ue_ip(0), m_next_user_teid(1), m_max_paging_queue(0)
 {
   return;
 }
@@ -90,13 +90,12 @@ int spgw::gtpc::init(spgw_args_t*                           args,
 
 void spgw::gtpc::stop()
 {
-  std::map<uint32_t, spgw_tunnel_ctx*>::iterator it = m_teid_to_tunnel_ctx.begin();
-  while (it != m_teid_to_tunnel_ctx.end()) {
-    m_gtpc_log->info("Deleting SP-GW GTP-C Tunnel. IMSI: %015" PRIu64 "\n", it->second->imsi);
-    srslte::console("Deleting SP-GW GTP-C Tunnel. IMSI: %015" PRIu64 "\n", it->second->imsi);
-    delete it->second;
-    m_teid_to_tunnel_ctx.erase(it++);
-  }
+  m_teid_to_tunnel_ctx.for_each([this](uint32_t ctrl_teid, spgw_tunnel_ctx* tunnel_ctx) {
+    m_gtpc_log->info("Deleting SP-GW GTP-C Tunnel. IMSI: %015" PRIu64 "\n", tunnel_ctx->imsi);
+    srslte::console("Deleting SP-GW GTP-C Tunnel. IMSI: %015" PRIu64 "\n", tunnel_ctx->imsi);
+    delete tunnel_ctx;
+  });
+  m_teid_to_tunnel_ctx.clear();
   return;
 }
 
@@ -199,6 +198,9 @@ void spgw::gtpc::handle_create_session_request(const struct srslte::gtpc_create_
 
   m_gtpc_log->info("Creating new GTP-C context\n");
   tunnel_ctx = create_gtpc_ctx(cs_req);
+  if (tunnel_ctx == nullptr) {
+    return;
+  }
 
   // Create session response message
   srslte::gtpc_pdu cs_resp_pdu;
@@ -244,13 +246,13 @@ void spgw::gtpc::handle_modify_bearer_request(const struct srslte::gtpc_header&
   m_gtpc_log->info("Received Modified Bearer Request\n");
 
   // Get control tunnel info from mb_req PDU
-  uint32_t                                         ctrl_teid = mb_req_hdr.teid;
-  std::map<uint32_t, spgw_tunnel_ctx_t*>::iterator tunnel_it = m_teid_to_tunnel_ctx.find(ctrl_teid);
-  if (tunnel_it == m_teid_to_tunnel_ctx.end()) {
+  uint32_t            ctrl_teid = mb_req_hdr.teid;
+  spgw_tunnel_ctx_t** tunnel_it = m_teid_to_tunnel_ctx.find(ctrl_teid);
+  if (tunnel_it == nullptr) {
     m_gtpc_log->warning("Could not find TEID %d to modify\n", ctrl_teid);
     return;
   }
-  spgw_tunnel_ctx_t* tunnel_ctx = tunnel_it->second;
+  spgw_tunnel_ctx_t* tunnel_ctx = *tunnel_it;
 
   // Store user DW link TEID
   tunnel_ctx->dw_user_fteid.teid = mb_req.eps_bearer_context_to_modify.s1_u_enb_f_teid.teid;
@@ -308,13 +310,13 @@ void spgw::gtpc::handle_modify_bearer_request(const struct srslte::gtpc_header&
 void spgw::gtpc::handle_delete_session_request(const srslte::gtpc_header&                 header,
                                                const srslte::gtpc_delete_session_request& del_req_pdu)
 {
-  uint32_t                                         ctrl_teid = header.teid;
-  std::map<uint32_t, spgw_tunnel_ctx_t*>::iterator tunnel_it = m_teid_to_tunnel_ctx.find(ctrl_teid);
-  if (tunnel_it == m_teid_to_tunnel_ctx.end()) {
+  uint32_t            ctrl_teid = header.teid;
+  spgw_tunnel_ctx_t** tunnel_it = m_teid_to_tunnel_ctx.find(ctrl_teid);
+  if (tunnel_it == nullptr) {
     m_gtpc_log->warning("Could not find TEID 0x%x to delete session\n", ctrl_teid);
     return;
   }
-  spgw_tunnel_ctx_t* tunnel_ctx = tunnel_it->second;
+  spgw_tunnel_ctx_t* tunnel_ctx = *tunnel_it;
   in_addr_t          ue_ipv4    = tunnel_ctx->ue_ipv4;
   m_gtpu->delete_gtpu_tunnel(ue_ipv4);
   delete_gtpc_ctx(ctrl_teid);
@@ -325,13 +327,13 @@ void spgw::gtpc::handle_release_access_bearers_request(const srslte::gtpc_header
                                                        const srslte::gtpc_release_access_bearers_request& rel_req)
 {
   // Find tunel ctxt
-  uint32_t                                         ctrl_teid = header.teid;
-  std::map<uint32_t, spgw_tunnel_ctx_t*>::iterator tunnel_it = m_teid_to_tunnel_ctx.find(ctrl_teid);
-  if (tunnel_it == m_teid_to_tunnel_ctx.end()) {
+  uint32_t            ctrl_teid = header.teid;
+  spgw_tunnel_ctx_t** tunnel_it = m_teid_to_tunnel_ctx.find(ctrl_teid);
+  if (tunnel_it == nullptr) {
     m_gtpc_log->warning("Could not find TEID 0x%x to release bearers\n", ctrl_teid);
     return;
   }
-  spgw_tunnel_ctx_t* tunnel_ctx = tunnel_it->second;
+  spgw_tunnel_ctx_t* tunnel_ctx = *tunnel_it;
   in_addr_t          ue_ipv4    = tunnel_ctx->ue_ipv4;
 
   // Delete data tunnel & do NOT delete control tunnel
@@ -349,12 +351,12 @@ bool spgw::gtpc::send_downlink_data_notification(uint32_t spgw_ctr_teid)
   struct srslte::gtpc_downlink_data_notification* dl_not = &dl_not_pdu.choice.downlink_data_notification;
 
   // Find MME Ctrl TEID
-  std::map<uint32_t, spgw_tunnel_ctx_t*>::iterator tunnel_it = m_teid_to_tunnel_ctx.find(spgw_ctr_teid);
-  if (tunnel_it == m_teid_to_tunnel_ctx.end()) {
+  spgw_tunnel_ctx_t** tunnel_it = m_teid_to_tunnel_ctx.find(spgw_ctr_teid);
+  if (tunnel_it == nullptr) {
     m_gtpc_log->warning("Could not find TEID 0x%x to send downlink notification.\n", spgw_ctr_teid);
     return false;
   }
-  spgw_tunnel_ctx_t* tunnel_ctx = tunnel_it->second;
+  spgw_tunnel_ctx_t* tunnel_ctx = *tunnel_it;
 
   // Check if there is no Paging already pending.
   if (tunnel_ctx->paging_pending == true) {
@@ -387,13 +389,13 @@ void spgw::gtpc::handle_downlink_data_notification_acknowledge(
   m_gtpc_log->debug("Handling downlink data notification acknowledge\n");
 
   // Find tunel ctxt
-  uint32_t                                         ctrl_teid = header.teid;
-  std::map<uint32_t, spgw_tunnel_ctx_t*>::iterator tunnel_it = m_teid_to_tunnel_ctx.find(ctrl_teid);
-  if (tunnel_it == m_teid_to_tunnel_ctx.end()) {
+  uint32_t            ctrl_teid = header.teid;
+  spgw_tunnel_ctx_t** tunnel_it = m_teid_to_tunnel_ctx.find(ctrl_teid);
+  if (tunnel_it == nullptr) {
     m_gtpc_log->warning("Could not find TEID 0x%x to handle notification acknowldge\n", ctrl_teid);
     return;
   }
-  spgw_tunnel_ctx_t* tunnel_ctx = tunnel_it->second;
+  spgw_tunnel_ctx_t* tunnel_ctx = *tunnel_it;
   if (not_ack.cause.cause_value == srslte::GTPC_CAUSE_VALUE_CONTEXT_NOT_FOUND ||
       not_ack.cause.cause_value == srslte::GTPC_CAUSE_VALUE_UE_ALREADY_RE_ATTACHED ||
       not_ack.cause.cause_value == srslte::GTPC_CAUSE_VALUE_UNABLE_TO_PAGE_UE ||
@@ -415,14 +417,14 @@ void spgw::gtpc::handle_downlink_data_notification_failure_indication(
 {
   m_gtpc_log->debug("Handling downlink data notification failure indication\n");
   // Find tunel ctxt
-  uint32_t                                         ctrl_teid = header.teid;
-  std::map<uint32_t, spgw_tunnel_ctx_t*>::iterator tunnel_it = m_teid_to_tunnel_ctx.find(ctrl_teid);
-  if (tunnel_it == m_teid_to_tunnel_ctx.end()) {
+  uint32_t            ctrl_teid = header.teid;
+  spgw_tunnel_ctx_t** tunnel_it = m_teid_to_tunnel_ctx.find(ctrl_teid);
+  if (tunnel_it == nullptr) {
     m_gtpc_log->warning("Could not find TEID 0x%x to handle notification failure indication\n", ctrl_teid);
     return;
   }
 
-  spgw_tunnel_ctx_t* tunnel_ctx = tunnel_it->second;
+  spgw_tunnel_ctx_t* tunnel_ctx = *tunnel_it;
   if (not_fail.cause.cause_value == srslte::GTPC_CAUSE_VALUE_UE_NOT_RESPONDING ||
       not_fail.cause.cause_value == srslte::GTPC_CAUSE_VALUE_SERVICE_DENIED ||
       not_fail.cause.cause_value == srslte::GTPC_CAUSE_VALUE_UE_ALREADY_RE_ATTACHED) {
@@ -441,8 +443,14 @@ void spgw::gtpc::handle_downlink_data_notification_failure_indication(
  */
 spgw_tunnel_ctx_t* spgw::gtpc::create_gtpc_ctx(const struct srslte::gtpc_create_session_request& cs_req)
 {
-  // Setup uplink control TEID
-  uint64_t spgw_uplink_ctrl_teid = get_new_ctrl_teid();
+  // Setup uplink control TEID, which indexes the context
+  spgw_tunnel_ctx_t* tunnel_ctx            = new spgw_tunnel_ctx_t{};
+  uint32_t           spgw_uplink_ctrl_teid = m_teid_to_tunnel_ctx.emplace(tunnel_ctx);
+  if (spgw_uplink_ctrl_teid == 0) {
+    m_gtpc_log->error("No free control TEID for IMSI %015" PRIu64 "\n", cs_req.imsi);
+    delete tunnel_ctx;
+    return nullptr;
+  }
   // Setup uplink user TEID
   uint64_t spgw_uplink_user_teid = get_new_user_teid();
   // Allocate UE IP
@@ -450,15 +458,13 @@ spgw_tunnel_ctx_t* spgw::gtpc::create_gtpc_ctx(const struct srslte::gtpc_create_
 
   uint8_t default_bearer_id = 5;
 
-  srslte::console("SPGW: Allocated Ctrl TEID %" PRIu64 "\n", spgw_uplink_ctrl_teid);
+  srslte::console("SPGW: Allocated Ctrl TEID %" PRIu32 "\n", spgw_uplink_ctrl_teid);
   srslte::console("SPGW: Allocated User TEID %" PRIu64 "\n", spgw_uplink_user_teid);
   struct in_addr ue_ip_;
   ue_ip_.s_addr = ue_ip;
   srslte::console("SPGW: Allocate UE IP %s\n", inet_ntoa(ue_ip_));
 
   // Save the UE IP to User TEID map
-  spgw_tunnel_ctx_t* tunnel_ctx = new spgw_tunnel_ctx_t{};
-
   tunnel_ctx->imsi = cs_req.imsi;
   tunnel_ctx->ebi  = default_bearer_id;
 
@@ -470,19 +476,18 @@ spgw_tunnel_ctx_t* spgw::gtpc::create_gtpc_ctx(const struct srslte::gtpc_create_
   tunnel_ctx->dw_ctrl_fteid.ipv4 = cs_req.sender_f_teid.ipv4;
   std::memset(&tunnel_ctx->dw_user_fteid, 0, sizeof(srslte::gtp_fteid_t));
 
-  m_teid_to_tunnel_ctx.insert(std::pair<uint32_t, spgw_tunnel_ctx_t*>(spgw_uplink_ctrl_teid, tunnel_ctx));
   m_imsi_to_ctr_teid.insert(std::pair<uint64_t, uint32_t>(cs_req.imsi, spgw_uplink_ctrl_teid));
   return tunnel_ctx;
 }
 
 bool spgw::gtpc::delete_gtpc_ctx(uint32_t ctrl_teid)
 {
-  spgw_tunnel_ctx_t* tunnel_ctx;
-  if (!m_teid_to_tunnel_ctx.count(ctrl_teid)) {
+  spgw_tunnel_ctx_t** tunnel_it = m_teid_to_tunnel_ctx.find(ctrl_teid);
+  if (tunnel_it == nullptr) {
     m_gtpc_log->error("Could not find GTP context to delete.\n");
     return false;
   }
-  tunnel_ctx = m_teid_to_tunnel_ctx[ctrl_teid];
+  spgw_tunnel_ctx_t* tunnel_ctx = *tunnel_it;
 
   // Remove Ctrl TEID from GTP-U Mapping
   m_gtpu->delete_gtpc_tunnel(tunnel_ctx->ue_ipv4);
@@ -501,12 +506,13 @@ bool spgw::gtpc::delete_gtpc_ctx(uint32_t ctrl_teid)
  */
 bool spgw::gtpc::queue_downlink_packet(uint32_t ctrl_teid, srslte::byte_buffer_t* msg)
 {
-  spgw_tunnel_ctx_t* tunnel_ctx;
-  if (!m_teid_to_tunnel_ctx.count(ctrl_teid)) {
+  spgw_tunnel_ctx_t*  tunnel_ctx;
+  spgw_tunnel_ctx_t** tunnel_it = m_teid_to_tunnel_ctx.find(ctrl_teid);
+  if (tunnel_it == nullptr) {
     m_gtpc_log->error("Could not find GTP context to queue.\n");
     goto pkt_discard;
   }
-  tunnel_ctx = m_teid_to_tunnel_ctx[ctrl_teid];
+  tunnel_ctx = *tunnel_it;
   if (!tunnel_ctx->paging_pending) {
     m_gtpc_log->error("Paging not pending. Not queueing packet\n");
     goto pkt_discard;
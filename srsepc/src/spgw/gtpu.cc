@@ -29,6 +29,7 @@
 #include <linux/if_tun.h>
 #include <linux/ip.h>
 #include <netinet/in.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 
@@ -77,21 +78,55 @@ int spgw::gtpu::init(spgw_args_t* args, spgw* spgw, gtpc_interface_gtpu* gtpc, s
     return err;
   }
 
-  m_gtpu_log->info("SPGW GTP-U Initialized.\n");
+  // Wakes up the SP-GW thread when the workers have packets for paging
+  m_paging_fd = eventfd(0, 0);
+  if (m_paging_fd < 0) {
+    m_gtpu_log->error("Failed to create paging eventfd: %s\n", strerror(errno));
+    return SRSLTE_ERROR_CANT_START;
+  }
+
+  // Start the user plane workers
+  for (uint32_t i = 0; i < m_sgi.size(); i++) {
+    m_workers.emplace_back(new up_worker(this, m_sgi[i], m_s1u[i], i));
+    m_workers.back()->start();
+  }
+
+  m_gtpu_log->info("SPGW GTP-U Initialized with %zd user plane workers.\n", m_workers.size());
   srslte::console("SPGW GTP-U Initialized.\n");
   return SRSLTE_SUCCESS;
 }
 
 void spgw::gtpu::stop()
 {
+  for (auto& w : m_workers) {
+    w->stop();
+  }
+  m_workers.clear();
+
   // Clean up SGi interface
   if (m_sgi_up) {
-    close(m_sgi);
+    for (int fd : m_sgi) {
+      close(fd);
+    }
+    m_sgi.clear();
+    m_sgi_up = false;
   }
   // Clean up S1-U socket
   if (m_s1u_up) {
-    close(m_s1u);
+    for (int fd : m_s1u) {
+      close(fd);
+    }
+    m_s1u.clear();
+    m_s1u_up = false;
   }
+  if (m_paging_fd >= 0) {
+    close(m_paging_fd);
+    m_paging_fd = -1;
+  }
+  for (auto& p : m_paging_pdus) {
+    m_pool->deallocate(p.second);
+  }
+  m_paging_pdus.clear();
 }
 
 int spgw::gtpu::init_sgi(spgw_args_t* args)
@@ -103,24 +138,36 @@ int spgw::gtpu::init_sgi(spgw_args_t* args)
     return SRSLTE_ERROR_ALREADY_STARTED;
   }
 
-  // Construct the TUN device
-  m_sgi = open("/dev/net/tun", O_RDWR);
-  m_gtpu_log->info("TUN file descriptor = %d\n", m_sgi);
-  if (m_sgi < 0) {
-    m_gtpu_log->error("Failed to open TUN device: %s\n", strerror(errno));
-    return SRSLTE_ERROR_CANT_START;
-  }
-
+  // Construct the TUN device, with one queue per worker. The kernel spreads the flows over the queues
+  uint32_t nof_queues = std::max(args->nof_up_workers, 1u);
   memset(&ifr, 0, sizeof(ifr));
-  ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+  ifr.ifr_flags = IFF_TUN | IFF_NO_PI | (nof_queues > 1 ? IFF_MULTI_QUEUE : 0);
   strncpy(
       ifr.ifr_ifrn.ifrn_name, args->sgi_if_name.c_str(), std::min(args->sgi_if_name.length(), (size_t)(IFNAMSIZ - 1)));
   ifr.ifr_ifrn.ifrn_name[IFNAMSIZ - 1] = '\0';
 
-  if (ioctl(m_sgi, TUNSETIFF, &ifr) < 0) {
-    m_gtpu_log->error("Failed to set TUN device name: %s\n", strerror(errno));
-    close(m_sgi);
-    return SRSLTE_ERROR_CANT_START;
+  for (uint32_t i = 0; i < nof_queues; i++) {
+    int fd = open("/dev/net/tun", O_RDWR);
+    m_gtpu_log->info("TUN file descriptor = %d\n", fd);
+    if (fd < 0) {
+      m_gtpu_log->error("Failed to open TUN device: %s\n", strerror(errno));
+      close_sgi_queues();
+      return SRSLTE_ERROR_CANT_START;
+    }
+    m_sgi.push_back(fd);
+
+    if (ioctl(fd, TUNSETIFF, &ifr) < 0) {
+      m_gtpu_log->error("Failed to set TUN device name: %s\n", strerror(errno));
+      close_sgi_queues();
+      return SRSLTE_ERROR_CANT_START;
+    }
+
+    // The workers drain the queue until it is empty
+    if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0) {
+      m_gtpu_log->error("Failed to set TUN queue non-blocking: %s\n", strerror(errno));
+      close_sgi_queues();
+      return SRSLTE_ERROR_CANT_START;
+    }
   }
 
   // Bring up the interface
@@ -128,7 +175,7 @@ int spgw::gtpu::init_sgi(spgw_args_t* args)
   if (ioctl(sgi_sock, SIOCGIFFLAGS, &ifr) < 0) {
     m_gtpu_log->error("Failed to bring up socket: %s\n", strerror(errno));
     close(sgi_sock);
-    close(m_sgi);
+    close_sgi_queues();
     return SRSLTE_ERROR_CANT_START;
   }
 
@@ -136,7 +183,7 @@ int spgw::gtpu::init_sgi(spgw_args_t* args)
   if (ioctl(sgi_sock, SIOCSIFFLAGS, &ifr) < 0) {
     m_gtpu_log->error("Failed to set socket flags: %s\n", strerror(errno));
     close(sgi_sock);
-    close(m_sgi);
+    close_sgi_queues();
     return SRSLTE_ERROR_CANT_START;
   }
 
@@ -149,7 +196,7 @@ int spgw::gtpu::init_sgi(spgw_args_t* args)
   if (ioctl(sgi_sock, SIOCSIFADDR, &ifr) < 0) {
     m_gtpu_log->error(
         "Failed to set TUN interface IP. Address: %s, Error: %s\n", args->sgi_if_addr.c_str(), strerror(errno));
-    close(m_sgi);
+    close_sgi_queues();
     close(sgi_sock);
     return SRSLTE_ERROR_CANT_START;
   }
@@ -158,61 +205,75 @@ int spgw::gtpu::init_sgi(spgw_args_t* args)
   ((struct sockaddr_in*)&ifr.ifr_netmask)->sin_addr.s_addr = inet_addr("255.255.255.0");
   if (ioctl(sgi_sock, SIOCSIFNETMASK, &ifr) < 0) {
     m_gtpu_log->error("Failed to set TUN interface Netmask. Error: %s\n", strerror(errno));
-    close(m_sgi);
+    close_sgi_queues();
     close(sgi_sock);
     return SRSLTE_ERROR_CANT_START;
   }
 
   close(sgi_sock);
   m_sgi_up = true;
-  m_gtpu_log->info("Initialized SGi interface\n");
+  m_gtpu_log->info("Initialized SGi interface with %d queues\n", nof_queues);
   return SRSLTE_SUCCESS;
 }
 
-int spgw::gtpu::init_s1u(spgw_args_t* args)
+void spgw::gtpu::close_sgi_queues()
 {
-  // Open S1-U socket
-  m_s1u = socket(AF_INET, SOCK_DGRAM, 0);
-  if (m_s1u == -1) {
-    m_gtpu_log->error("Failed to open socket: %s\n", strerror(errno));
-    return SRSLTE_ERROR_CANT_START;
+  for (int fd : m_sgi) {
+    close(fd);
   }
-  m_s1u_up = true;
+  m_sgi.clear();
+}
 
-  // Bind the socket
+int spgw::gtpu::init_s1u(spgw_args_t* args)
+{
+  // Bind address
   m_s1u_addr.sin_family      = AF_INET;
   m_s1u_addr.sin_addr.s_addr = inet_addr(args->gtpu_bind_addr.c_str());
   m_s1u_addr.sin_port        = htons(GTPU_RX_PORT);
 
-  if (bind(m_s1u, (struct sockaddr*)&m_s1u_addr, sizeof(struct sockaddr_in))) {
-    m_gtpu_log->error("Failed to bind socket: %s\n", strerror(errno));
-    return SRSLTE_ERROR_CANT_START;
+  // Open one S1-U socket per SGi queue. With several sockets, the kernel spreads the eNBs over them
+  for (uint32_t i = 0; i < m_sgi.size(); i++) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1) {
+      m_gtpu_log->error("Failed to open socket: %s\n", strerror(errno));
+      return SRSLTE_ERROR_CANT_START;
+    }
+    m_s1u.push_back(fd);
+    m_s1u_up = true;
+
+    int enable = 1;
+    if (m_sgi.size() > 1 and setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+      m_gtpu_log->error("Failed to set SO_REUSEPORT: %s\n", strerror(errno));
+      return SRSLTE_ERROR_CANT_START;
+    }
+
+    // Bind the socket
+    if (bind(fd, (struct sockaddr*)&m_s1u_addr, sizeof(struct sockaddr_in))) {
+      m_gtpu_log->error("Failed to bind socket: %s\n", strerror(errno));
+      return SRSLTE_ERROR_CANT_START;
+    }
+    m_gtpu_log->info("S1-U socket = %d\n", fd);
   }
-  m_gtpu_log->info("S1-U socket = %d\n", m_s1u);
   m_gtpu_log->info("S1-U IP = %s, Port = %d \n", inet_ntoa(m_s1u_addr.sin_addr), ntohs(m_s1u_addr.sin_port));
 
   m_gtpu_log->info("Initialized S1-U interface\n");
   return SRSLTE_SUCCESS;
 }
 
-void spgw::gtpu::handle_sgi_pdu(srslte::byte_buffer_t* msg)
+void spgw::gtpu::handle_sgi_pdu(srslte::byte_buffer_t* msg, up_worker* worker)
 {
-  bool usr_found = false;
-  bool ctr_found = false;
-
-  std::map<uint32_t, srslte::gtpc_f_teid_ie>::iterator gtpu_fteid_it;
-  std::map<in_addr_t, uint32_t>::iterator              gtpc_teid_it;
-  srslte::gtpc_f_teid_ie                               enb_fteid;
-  uint32_t                                             spgw_teid;
-  struct iphdr*                                        iph = (struct iphdr*)msg->msg;
+  ue_tunnels_t  tunnels;
+  struct iphdr* iph = (struct iphdr*)msg->msg;
   m_gtpu_log->debug("Received SGi PDU. Bytes %d\n", msg->N_bytes);
 
   if (iph->version != 4) {
     m_gtpu_log->warning("IPv6 not supported yet.\n");
+    m_pool->deallocate(msg);
     return;
   }
   if (ntohs(iph->tot_len) < 20) {
     m_gtpu_log->warning("Invalid IP header length. IP length %d.\n", ntohs(iph->tot_len));
+    m_pool->deallocate(msg);
     return;
   }
 
@@ -222,48 +283,68 @@ void spgw::gtpu::handle_sgi_pdu(srslte::byte_buffer_t* msg)
   m_gtpu_log->debug("SGi PDU -- IP dst addr %s\n", srslte::gtpu_ntoa(iph->daddr).c_str());
 
   // Find user and control tunnel
-  gtpu_fteid_it = m_ip_to_usr_teid.find(iph->daddr);
-  if (gtpu_fteid_it != m_ip_to_usr_teid.end()) {
-    usr_found = true;
-    enb_fteid = gtpu_fteid_it->second;
-  }
-  gtpc_teid_it = m_ip_to_ctr_teid.find(iph->daddr);
-  if (gtpc_teid_it != m_ip_to_ctr_teid.end()) {
-    ctr_found = true;
-    spgw_teid = gtpc_teid_it->second;
-  }
+  find_tunnels(iph->daddr, &tunnels);
 
   // Handle SGi packet
-  if (usr_found == false && ctr_found == false) {
-    m_gtpu_log->debug("Packet for unknown UE.\n");
-    goto pkt_discard_out;
-  } else if (usr_found == false && ctr_found == true) {
+  if (tunnels.has_usr_fteid) {
+    sockaddr_in enb_addr;
+    if (write_s1u_header(tunnels.usr_fteid, msg, &enb_addr)) {
+      worker->queue_s1u_pdu(msg, enb_addr);
+    } else {
+      m_pool->deallocate(msg);
+    }
+  } else if (tunnels.has_ctr_teid) {
+    // The paging procedure is run by the SP-GW thread, which owns the GTP-C state
     m_gtpu_log->debug("Packet for attached UE that is not ECM connected.\n");
-    m_gtpu_log->debug("Triggering Donwlink Notification Requset.\n");
-    m_gtpc->send_downlink_data_notification(spgw_teid);
-    m_gtpc->queue_downlink_packet(spgw_teid, msg);
-    return;
-  } else if (usr_found == false && ctr_found == true) {
-    m_gtpu_log->error("User plane tunnel found without a control plane tunnel present.\n");
-    goto pkt_discard_out;
+    {
+      std::lock_guard<std::mutex> lock(m_paging_mutex);
+      m_paging_pdus.emplace_back(tunnels.ctr_teid, msg);
+    }
+    uint64_t one = 1;
+    if (write(m_paging_fd, &one, sizeof(one)) != sizeof(one)) {
+      m_gtpu_log->error("Failed to notify the SP-GW thread of a packet for paging\n");
+    }
   } else {
-    send_s1u_pdu(enb_fteid, msg);
+    m_gtpu_log->debug("Packet for unknown UE.\n");
+    m_pool->deallocate(msg);
   }
-  return;
+}
 
-pkt_discard_out:
-  m_pool->deallocate(msg);
-  return;
+void spgw::gtpu::handle_paging_pdus()
+{
+  uint64_t count;
+  if (read(m_paging_fd, &count, sizeof(count)) != sizeof(count)) {
+    m_gtpu_log->error("Failed to read paging eventfd\n");
+  }
+  std::vector<std::pair<uint32_t, srslte::byte_buffer_t*>> pdus;
+  {
+    std::lock_guard<std::mutex> lock(m_paging_mutex);
+    std::swap(pdus, m_paging_pdus);
+  }
+
+  for (auto& p : pdus) {
+    // The user plane may have been set up since the packet was handed over
+    ue_tunnels_t tunnels;
+    if (find_tunnels(((struct iphdr*)p.second->msg)->daddr, &tunnels) and tunnels.has_usr_fteid) {
+      send_s1u_pdu(tunnels.usr_fteid, p.second, m_s1u[0]);
+      continue;
+    }
+    m_gtpu_log->debug("Triggering Donwlink Notification Requset.\n");
+    m_gtpc->send_downlink_data_notification(p.first);
+    m_gtpc->queue_downlink_packet(p.first, p.second);
+  }
 }
 
-void spgw::gtpu::handle_s1u_pdu(srslte::byte_buffer_t* msg)
+void spgw::gtpu::handle_s1u_pdu(srslte::byte_buffer_t* msg, int sgi)
 {
   srslte::gtpu_header_t header;
-  srslte::gtpu_read_header(msg, &header, m_gtpu_log);
+  if (not srslte::gtpu_read_header(msg, &header, m_gtpu_log)) {
+    return;
+  }
 
   m_gtpu_log->debug("Received PDU from S1-U. Bytes=%d\n", msg->N_bytes);
   m_gtpu_log->debug("TEID 0x%x. Bytes=%d\n", header.teid, msg->N_bytes);
-  int n = write(m_sgi, msg->msg, msg->N_bytes);
+  int n = write(sgi, msg->msg, msg->N_bytes);
   if (n < 0) {
     m_gtpu_log->error("Could not write to TUN interface.\n");
   } else {
@@ -272,13 +353,29 @@ void spgw::gtpu::handle_s1u_pdu(srslte::byte_buffer_t* msg)
   return;
 }
 
-void spgw::gtpu::send_s1u_pdu(srslte::gtp_fteid_t enb_fteid, srslte::byte_buffer_t* msg)
+void spgw::gtpu::send_s1u_pdu(srslte::gtp_fteid_t enb_fteid, srslte::byte_buffer_t* msg, int s1u)
 {
-  // Set eNB destination address
   struct sockaddr_in enb_addr;
-  enb_addr.sin_family      = AF_INET;
-  enb_addr.sin_port        = htons(GTPU_RX_PORT);
-  enb_addr.sin_addr.s_addr = enb_fteid.ipv4;
+  if (write_s1u_header(enb_fteid, msg, &enb_addr)) {
+    // Send packet to destination
+    int n = sendto(s1u, msg->msg, msg->N_bytes, 0, (struct sockaddr*)&enb_addr, sizeof(enb_addr));
+    if (n < 0) {
+      m_gtpu_log->error("Error sending packet to eNB\n");
+    } else if ((unsigned int)n != msg->N_bytes) {
+      m_gtpu_log->error("Mis-match between packet bytes and sent bytes: Sent: %d/%d\n", n, msg->N_bytes);
+    }
+  }
+
+  m_gtpu_log->debug("Deallocating packet after sending S1-U message\n");
+  m_pool->deallocate(msg);
+}
+
+bool spgw::gtpu::write_s1u_header(srslte::gtp_fteid_t enb_fteid, srslte::byte_buffer_t* msg, sockaddr_in* enb_addr)
+{
+  // Set eNB destination address
+  enb_addr->sin_family      = AF_INET;
+  enb_addr->sin_port        = htons(GTPU_RX_PORT);
+  enb_addr->sin_addr.s_addr = enb_fteid.ipv4;
 
   // Setup GTP-U header
   srslte::gtpu_header_t header;
@@ -288,27 +385,14 @@ void spgw::gtpu::send_s1u_pdu(srslte::gtp_fteid_t enb_fteid, srslte::byte_buffer
   header.teid         = enb_fteid.teid;
 
   m_gtpu_log->debug("User plane tunnel found SGi PDU. Forwarding packet to S1-U.\n");
-  m_gtpu_log->debug("eNB F-TEID -- eNB IP %s, eNB TEID 0x%x.\n", inet_ntoa(enb_addr.sin_addr), enb_fteid.teid);
+  m_gtpu_log->debug("eNB F-TEID -- eNB IP %s, eNB TEID 0x%x.\n", inet_ntoa(enb_addr->sin_addr), enb_fteid.teid);
 
-  // Write header into packet
-  int n;
+  // Write header into the headroom of the packet
   if (!srslte::gtpu_write_header(&header, msg, m_gtpu_log)) {
     m_gtpu_log->error("Error writing GTP-U header on PDU\n");
-    goto out;
-  }
-
-  // Send packet to destination
-  n = sendto(m_s1u, msg->msg, msg->N_bytes, 0, (struct sockaddr*)&enb_addr, sizeof(enb_addr));
-  if (n < 0) {
-    m_gtpu_log->error("Error sending packet to eNB\n");
-  } else if ((unsigned int)n != msg->N_bytes) {
-    m_gtpu_log->error("Mis-match between packet bytes and sent bytes: Sent: %d/%d\n", n, msg->N_bytes);
+    return false;
   }
-
-out:
-  m_gtpu_log->debug("Deallocating packet after sending S1-U message\n");
-  m_pool->deallocate(msg);
-  return;
+  return true;
 }
 
 void spgw::gtpu::send_all_queued_packets(srslte::gtp_fteid_t                 dw_user_fteid,
@@ -317,7 +401,7 @@ void spgw::gtpu::send_all_queued_packets(srslte::gtp_fteid_t                 dw_
   m_gtpu_log->debug("Sending all queued packets\n");
   while (!pkt_queue.empty()) {
     srslte::byte_buffer_t* msg = pkt_queue.front();
-    send_s1u_pdu(dw_user_fteid, msg);
+    send_s1u_pdu(dw_user_fteid, msg, m_s1u[0]);
     pkt_queue.pop();
   }
   return;
@@ -333,33 +417,197 @@ bool spgw::gtpu::modify_gtpu_tunnel(in_addr_t ue_ipv4, srslte::gtpc_f_teid_ie dw
   m_gtpu_log->info(
       "Downlink eNB addr %s, U-TEID 0x%x\n", srslte::gtpu_ntoa(dw_user_fteid.ipv4).c_str(), dw_user_fteid.teid);
   m_gtpu_log->info("Uplink C-TEID: 0x%x\n", up_ctrl_teid);
-  m_ip_to_usr_teid[ue_ipv4] = dw_user_fteid;
-  m_ip_to_ctr_teid[ue_ipv4] = up_ctrl_teid;
+  tunnel_shard_t& shard = get_shard(ue_ipv4);
+  pthread_rwlock_wrlock(&shard.rwlock);
+  ue_tunnels_t& tunnels = shard.tunnels[ue_ipv4];
+  tunnels.has_usr_fteid = true;
+  tunnels.usr_fteid     = dw_user_fteid;
+  tunnels.has_ctr_teid  = true;
+  tunnels.ctr_teid      = up_ctrl_teid;
+  pthread_rwlock_unlock(&shard.rwlock);
   return true;
 }
 
 bool spgw::gtpu::delete_gtpu_tunnel(in_addr_t ue_ipv4)
 {
   // Remove GTP-U connections, if any.
-  if (m_ip_to_usr_teid.count(ue_ipv4)) {
-    m_ip_to_usr_teid.erase(ue_ipv4);
-  } else {
+  tunnel_shard_t& shard = get_shard(ue_ipv4);
+  pthread_rwlock_wrlock(&shard.rwlock);
+  auto it    = shard.tunnels.find(ue_ipv4);
+  bool found = it != shard.tunnels.end() and it->second.has_usr_fteid;
+  if (found) {
+    it->second.has_usr_fteid = false;
+    if (not it->second.has_ctr_teid) {
+      shard.tunnels.erase(it);
+    }
+  }
+  pthread_rwlock_unlock(&shard.rwlock);
+  if (not found) {
     m_gtpu_log->error("Could not find GTP-U Tunnel to delete.\n");
-    return false;
   }
-  return true;
+  return found;
 }
 
 bool spgw::gtpu::delete_gtpc_tunnel(in_addr_t ue_ipv4)
 {
   // Remove Ctrl TEID from IP mapping.
-  if (m_ip_to_ctr_teid.count(ue_ipv4)) {
-    m_ip_to_ctr_teid.erase(ue_ipv4);
-  } else {
+  tunnel_shard_t& shard = get_shard(ue_ipv4);
+  pthread_rwlock_wrlock(&shard.rwlock);
+  auto it    = shard.tunnels.find(ue_ipv4);
+  bool found = it != shard.tunnels.end() and it->second.has_ctr_teid;
+  if (found) {
+    it->second.has_ctr_teid = false;
+    if (not it->second.has_usr_fteid) {
+      shard.tunnels.erase(it);
+    }
+  }
+  pthread_rwlock_unlock(&shard.rwlock);
+  if (not found) {
     m_gtpu_log->error("Could not find GTP-C Tunnel info to delete.\n");
-    return false;
   }
-  return true;
+  return found;
+}
+
+bool spgw::gtpu::find_tunnels(in_addr_t ue_ipv4, ue_tunnels_t* tunnels)
+{
+  tunnel_shard_t& shard = get_shard(ue_ipv4);
+  pthread_rwlock_rdlock(&shard.rwlock);
+  auto it    = shard.tunnels.find(ue_ipv4);
+  bool found = it != shard.tunnels.end();
+  if (found) {
+    *tunnels = it->second;
+  }
+  pthread_rwlock_unlock(&shard.rwlock);
+  return found;
+}
+
+/*
+ * User plane workers
+ */
+spgw::gtpu::up_worker::up_worker(gtpu* parent_, int sgi_, int s1u_, uint32_t id) :
+  thread("SPGW_UP" + std::to_string(id)),
+  parent(parent_),
+  sgi(sgi_),
+  s1u(s1u_)
+{
+}
+
+void spgw::gtpu::up_worker::stop()
+{
+  if (running) {
+    running = false;
+    thread_cancel();
+    wait_thread_finish();
+  }
+}
+
+void spgw::gtpu::up_worker::run_thread()
+{
+  running = true;
+  for (uint32_t i = 0; i < MAX_BATCH; i++) {
+    rx_pdus[i]                     = parent->m_pool->allocate("spgw::up_worker::s1u");
+    rx_iovs[i].iov_base            = rx_pdus[i]->msg;
+    rx_iovs[i].iov_len             = SRSLTE_MAX_BUFFER_SIZE_BYTES - SRSLTE_BUFFER_HEADER_OFFSET;
+    rx_msgs[i].msg_hdr.msg_iov     = &rx_iovs[i];
+    rx_msgs[i].msg_hdr.msg_iovlen  = 1;
+    tx_msgs[i].msg_hdr.msg_name    = &tx_addrs[i];
+    tx_msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    tx_msgs[i].msg_hdr.msg_iov     = &tx_iovs[i];
+    tx_msgs[i].msg_hdr.msg_iovlen  = 1;
+  }
+
+  fd_set set;
+  int    max_fd = std::max(s1u, sgi);
+  while (running) {
+    FD_ZERO(&set);
+    FD_SET(s1u, &set);
+    FD_SET(sgi, &set);
+
+    int n = select(max_fd + 1, &set, NULL, NULL, NULL);
+    if (n == -1) {
+      parent->m_gtpu_log->error("Error from select\n");
+      continue;
+    }
+    if (FD_ISSET(sgi, &set)) {
+      read_sgi();
+    }
+    if (FD_ISSET(s1u, &set)) {
+      read_s1u();
+    }
+  }
+
+  for (srslte::byte_buffer_t* pdu : rx_pdus) {
+    parent->m_pool->deallocate(pdu);
+  }
+}
+
+void spgw::gtpu::up_worker::read_sgi()
+{
+  size_t buf_len = SRSLTE_MAX_BUFFER_SIZE_BYTES - SRSLTE_BUFFER_HEADER_OFFSET;
+  for (uint32_t i = 0; i < MAX_BATCH; i++) {
+    /*
+     * SGi messages may need to be queued when waiting for UE Paging procedure.
+     * For this reason, buffers for SGi pdus are allocated here and deallocated
+     * when the batch is sent, at handle_sgi_pdu() when the PDU is dropped or at
+     * gtpc::free_all_queued_packets, which is called when the Downlink Data Notification
+     * procedure fails (see handle_downlink_data_notification_acknowledgment and
+     * handle_downlink_data_notification_failure)
+     */
+    srslte::byte_buffer_t* sgi_msg = parent->m_pool->allocate("spgw::up_worker::sgi_msg");
+    ssize_t                n       = read(sgi, sgi_msg->msg, buf_len);
+    if (n <= 0) {
+      parent->m_pool->deallocate(sgi_msg);
+      break;
+    }
+    sgi_msg->N_bytes = n;
+    parent->handle_sgi_pdu(sgi_msg, this);
+  }
+  flush_s1u_tx();
+}
+
+void spgw::gtpu::up_worker::read_s1u()
+{
+  int n = recvmmsg(s1u, rx_msgs.data(), MAX_BATCH, MSG_DONTWAIT, nullptr);
+  if (n < 0) {
+    if (errno != EAGAIN and errno != EWOULDBLOCK) {
+      parent->m_gtpu_log->error("Failed to read from S1-U socket: %s\n", strerror(errno));
+    }
+    return;
+  }
+  for (int i = 0; i < n; i++) {
+    // The GTP-U header is removed by moving the start of the buffer
+    rx_pdus[i]->N_bytes = rx_msgs[i].msg_len;
+    parent->handle_s1u_pdu(rx_pdus[i], sgi);
+    rx_pdus[i]->clear();
+  }
+}
+
+void spgw::gtpu::up_worker::queue_s1u_pdu(srslte::byte_buffer_t* msg, const sockaddr_in& enb_addr)
+{
+  tx_pdus[nof_tx]          = msg;
+  tx_addrs[nof_tx]         = enb_addr;
+  tx_iovs[nof_tx].iov_base = msg->msg;
+  tx_iovs[nof_tx].iov_len  = msg->N_bytes;
+  if (++nof_tx == MAX_BATCH) {
+    flush_s1u_tx();
+  }
+}
+
+void spgw::gtpu::up_worker::flush_s1u_tx()
+{
+  uint32_t nof_sent = 0;
+  while (nof_sent < nof_tx) {
+    int n = sendmmsg(s1u, &tx_msgs[nof_sent], nof_tx - nof_sent, 0);
+    if (n <= 0) {
+      parent->m_gtpu_log->error("Error sending %d packets to eNB: %s\n", nof_tx - nof_sent, strerror(errno));
+      break;
+    }
+    nof_sent += n;
+  }
+  for (uint32_t i = 0; i < nof_tx; i++) {
+    parent->m_pool->deallocate(tx_pdus[i]);
+  }
+  nof_tx = 0;
 }
 
 } // namespace srsepc
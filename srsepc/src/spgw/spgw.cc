@@ -111,56 +111,34 @@ void spgw::run_thread()
 {
   // Mark the thread as running
   m_running = true;
-  srslte::byte_buffer_t *sgi_msg, *s1u_msg, *s11_msg;
-  s1u_msg = m_pool->allocate("spgw::run_thread::s1u");
+  srslte::byte_buffer_t* s11_msg;
   s11_msg = m_pool->allocate("spgw::run_thread::s11");
 
-  struct sockaddr_in src_addr_in;
   struct sockaddr_un src_addr_un;
-  struct iphdr*      ip_pkt;
 
-  int sgi = m_gtpu->get_sgi();
-  int s1u = m_gtpu->get_s1u();
-  int s11 = m_gtpc->get_s11();
+  // The user plane is forwarded by the GTP-U workers, this thread runs the control plane and the paging
+  int paging = m_gtpu->get_paging_fd();
+  int s11    = m_gtpc->get_s11();
 
   size_t buf_len = SRSLTE_MAX_BUFFER_SIZE_BYTES - SRSLTE_BUFFER_HEADER_OFFSET;
 
   fd_set set;
-  int    max_fd = std::max(s1u, sgi);
-  max_fd        = std::max(max_fd, s11);
+  int    max_fd = std::max(paging, s11);
   while (m_running) {
 
-    s1u_msg->clear();
     s11_msg->clear();
 
     FD_ZERO(&set);
-    FD_SET(s1u, &set);
-    FD_SET(sgi, &set);
+    FD_SET(paging, &set);
     FD_SET(s11, &set);
 
     int n = select(max_fd + 1, &set, NULL, NULL, NULL);
     if (n == -1) {
       m_spgw_log->error("Error from select\n");
     } else if (n) {
-      if (FD_ISSET(sgi, &set)) {
-        /*
-         * SGi messages may need to be queued when waiting for UE Paging procedure.
-         * For this reason, buffers for SGi pdus are allocated here and deallocated
-         * at the gtpu::send_s1u_pdu() when the PDU is sent, at handle_sgi_pdu() when the PDU is dropped or at
-         * gtpc::free_all_queued_packets, which is called when the Downlink Data Notification
-         * procedure fails (see handle_downlink_data_notification_acknowledgment and
-         * handle_downlink_data_notification_failure)
-         */
-        m_spgw_log->debug("Message received at SPGW: SGi Message\n");
-        sgi_msg          = m_pool->allocate("spgw::run_thread::sgi_msg");
-        sgi_msg->N_bytes = read(sgi, sgi_msg->msg, buf_len);
-        m_gtpu->handle_sgi_pdu(sgi_msg);
-      }
-      if (FD_ISSET(s1u, &set)) {
-        m_spgw_log->debug("Message received at SPGW: S1-U Message\n");
-        socklen_t addrlen = sizeof(src_addr_in);
-        s1u_msg->N_bytes  = recvfrom(s1u, s1u_msg->msg, buf_len, 0, (struct sockaddr*)&src_addr_in, &addrlen);
-        m_gtpu->handle_s1u_pdu(s1u_msg);
+      if (FD_ISSET(paging, &set)) {
+        m_spgw_log->debug("SGi packets for paging at SPGW\n");
+        m_gtpu->handle_paging_pdus();
       }
       if (FD_ISSET(s11, &set)) {
         m_spgw_log->debug("Message received at SPGW: S11 Message\n");
@@ -172,7 +150,6 @@ void spgw::run_thread()
       m_spgw_log->debug("No data from select.\n");
     }
   }
-  m_pool->deallocate(s1u_msg);
   m_pool->deallocate(s11_msg);
   return;
 }
@@ -186,8 +186,11 @@ private:
   srslte::log*                    log_phy_lib_h = nullptr;
   srsue::stack_interface_phy_lte* stack         = nullptr;
 
-  srslte::thread_pool                      workers_pool;
-  std::vector<std::unique_ptr<sf_worker> > workers;
+  srslte::thread_pool                       workers_pool;
+  std::vector<std::unique_ptr<sf_worker> >  workers;
+  std::unique_ptr<srslte::task_thread_pool> cc_pool;
+  srslte_sch_cb_pool_t                      pdsch_cb_pool       = {};
+  bool                                      pdsch_cb_pool_ready = false;
   phy_common                               common;
   sync                                     sfsync;
   prach                                    prach_buffer;
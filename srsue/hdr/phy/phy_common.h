@@ -26,6 +26,8 @@
 #include "srslte/adt/circular_array.h"
 #include "srslte/common/gen_mch_tables.h"
 #include "srslte/common/log.h"
+#include "srslte/common/thread_pool.h"
+#include "srslte/common/tti_deadline_watchdog.h"
 #include "srslte/common/tti_sempahore.h"
 #include "srslte/interfaces/radio_interfaces.h"
 #include "srslte/interfaces/ue_interfaces.h"
@@ -54,8 +56,11 @@ class phy_common
 {
 public:
   /* Common variables used by all phy workers */
-  phy_args_t*              args  = nullptr;
-  stack_interface_phy_lte* stack = nullptr;
+  phy_args_t*                    args          = nullptr;
+  stack_interface_phy_lte*       stack         = nullptr;
+  srslte::tti_deadline_watchdog* watchdog      = nullptr;
+  srslte::task_thread_pool*      cc_pool       = nullptr; ///< Helpers decoding the SCells in parallel, NULL if disabled
+  srslte_sch_cb_pool_t*          pdsch_cb_pool = nullptr; ///< PDSCH codeblock decoders of all workers, NULL if disabled
 
   srslte::phy_cfg_mbsfn_t mbsfn_config = {};
 
@@ -110,6 +115,7 @@ public:
                           srslte_phich_grant_t* phich_grant,
                           srslte_dci_ul_t*      dci_ul);
   bool is_any_ul_pending_ack();
+  bool is_ul_pending_ack(uint32_t tti, uint32_t cc_idx);
 
   bool get_ul_received_ack(srslte_ul_sf_cfg_t* sf, uint32_t cc_idx, bool* ack_value, srslte_dci_ul_t* dci_ul);
   void set_ul_received_ack(srslte_dl_sf_cfg_t* sf,
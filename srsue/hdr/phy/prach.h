@@ -26,7 +26,7 @@
 #include "srslte/interfaces/ue_interfaces.h"
 #include "srslte/radio/radio.h"
 #include "srslte/srslte.h"
-#include <bitset>
+#include <array>
 
 namespace srsue {
 
@@ -48,38 +48,38 @@ public:
   phy_interface_mac_lte::prach_info_t get_info() const;
 
 private:
-  bool generate_buffer(uint32_t f_idx);
+  /// Time-domain preamble generated for a frequency resource index and a preamble index
+  struct cached_preamble_t {
+    cf_t*    samples      = nullptr;
+    uint32_t f_idx        = 0;
+    int      preamble_idx = -1; ///< -1 when the entry is empty
+    uint32_t last_used    = 0;
+  };
 
-  bool is_buffer_generated(uint32_t f_idx, uint32_t preamble_index) const
-  {
-    return buffer_bitmask.test(f_idx * 64 + preamble_index);
-  }
-
-  void set_buffer_as_generated(uint32_t f_idx, uint32_t preamble_index)
-  {
-    buffer_bitmask.set(f_idx * 64 + preamble_index);
-  }
+  cf_t* get_preamble(uint32_t f_idx);
+  void  clear_preamble_cache();
 
 private:
-  static constexpr unsigned MAX_LEN_SF    = 3;
-  static constexpr unsigned max_fs        = 12;
-  static constexpr unsigned max_preambles = 64;
+  static constexpr unsigned MAX_LEN_SF           = 3;
+  static constexpr unsigned max_fs               = 12;
+  static constexpr unsigned max_preambles        = 64;
+  static constexpr unsigned nof_cached_preambles = 4;
 
-  srslte::log*                                         log_h            = nullptr;
-  srslte_prach_t                                       prach_obj        = {};
-  srslte_cell_t                                        cell             = {};
-  srslte_cfo_t                                         cfo_h            = {};
-  srslte_prach_cfg_t                                   cfg              = {};
-  std::array<std::array<cf_t*, max_preambles>, max_fs> buffer           = {};
-  cf_t*                                                signal_buffer    = nullptr;
-  int                                                  preamble_idx     = -1;
-  uint32_t                                             len              = 0;
-  int                                                  allowed_subframe = 0;
-  int                                                  transmitted_tti  = 0;
-  float                                                target_power_dbm = 0;
-  bool                                                 mem_initiated    = false;
-  bool                                                 cell_initiated   = false;
-  std::bitset<max_fs * max_preambles>                  buffer_bitmask;
+  srslte::log*                                        log_h            = nullptr;
+  srslte_prach_t                                      prach_obj        = {};
+  srslte_cell_t                                       cell             = {};
+  srslte_cfo_t                                        cfo_h            = {};
+  srslte_prach_cfg_t                                  cfg              = {};
+  std::array<cached_preamble_t, nof_cached_preambles> preamble_cache   = {};
+  uint32_t                                            cache_clock      = 0;
+  cf_t*                                               signal_buffer    = nullptr;
+  int                                                 preamble_idx     = -1;
+  uint32_t                                            len              = 0;
+  int                                                 allowed_subframe = 0;
+  int                                                 transmitted_tti  = 0;
+  float                                               target_power_dbm = 0;
+  bool                                                mem_initiated    = false;
+  bool                                                cell_initiated   = false;
 };
 
 } // namespace srsue
@@ -27,6 +27,7 @@
 #include <srslte/srslte.h>
 
 #include "scell_recv.h"
+#include <atomic>
 
 namespace srsue {
 namespace scell {
@@ -124,6 +125,12 @@ public:
    */
   uint32_t get_earfcn() { return current_earfcn; };
 
+  /**
+   * Get the number of measurements finished since the initiation, used for detecting the end of a measurement
+   * @return the number of measurements
+   */
+  uint32_t get_nof_meas() const { return nof_meas; }
+
   /**
    * Synchronous wait mechanism, used for testing purposes, it waits for the inner thread to return a measurement.
    */
@@ -212,6 +219,7 @@ private:
   uint32_t               intra_freq_meas_period_ms = 200;
   uint32_t               rx_gain_offset_db         = 0;
   srslte::tti_sync_cv    meas_sync; // Only used by scell_search_test
+  std::atomic<uint32_t>  nof_meas{0};
 
   cf_t* search_buffer = nullptr;
 
@@ -48,6 +48,7 @@ public:
   void     reset();
   float    get_last_cfo();
   void     set_agc_enable(bool enable);
+  void     set_cs_opts(uint32_t prescreen_frames, float prescreen_min_psr, float early_exit_psr);
   ret_code run(srslte_cell_t* cell, std::array<uint8_t, SRSLTE_BCH_PAYLOAD_LEN>& bch_payload);
 
 private:
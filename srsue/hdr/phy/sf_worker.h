@@ -82,6 +82,7 @@ private:
 
   void update_measurements();
   void reset_uci(srslte_uci_data_t* uci_data);
+  bool work_dl();
 
   std::vector<cc_worker*> cc_workers;
 
@@ -104,6 +105,11 @@ private:
   uint32_t               tti     = 0;
   srslte::rf_timestamp_t tx_time = {};
 
+  // Join of the SCells decoded by the helper threads
+  std::mutex              cc_mutex;
+  std::condition_variable cc_cvar;
+  uint32_t                nof_cc_running = 0;
+
 };
 
 } // namespace srsue
@@ -37,6 +37,7 @@
 #include "srslte/common/log.h"
 #include "srslte/common/thread_pool.h"
 #include "srslte/common/threads.h"
+#include "srslte/common/tti_deadline_watchdog.h"
 #include "srslte/common/tti_sync_cv.h"
 #include "srslte/interfaces/radio_interfaces.h"
 #include "srslte/interfaces/ue_interfaces.h"
@@ -202,6 +203,19 @@ private:
   sfn_sync                                            sfn_p;
   std::vector<std::unique_ptr<scell::intra_measure> > intra_freq_meas;
 
+  // Measurement of the EARFCNs without a carrier of their own, time-multiplexed on the carriers without an SCell. Each
+  // carrier measures one EARFCN for intra_freq_meas_len_ms and is then retuned to the next one, so the carriers
+  // capture and process different EARFCNs in parallel
+  struct meas_carrier_t {
+    uint32_t earfcn   = 0;     ///< EARFCN the carrier is tuned to for measuring, 0 if none
+    uint32_t nof_meas = 0;     ///< Measurements of the carrier when it was tuned
+    bool     scell    = false; ///< The carrier is taken by an SCell
+  };
+  std::mutex                              multiplexed_meas_mutex;
+  std::map<uint32_t, std::set<uint32_t> > multiplexed_meas; ///< PCIs to measure of every multiplexed EARFCN
+  std::vector<meas_carrier_t>             meas_carriers;
+  void                                    multiplex_meas();
+
   // Pointers to other classes
   stack_interface_phy_lte*     stack            = nullptr;
   srslte::log*                 log_h            = nullptr;
@@ -232,6 +246,8 @@ private:
   // Sync metrics
   sync_metrics_t metrics = {};
 
+  srslte::tti_deadline_watchdog watchdog;
+
   // in-sync / out-of-sync counters
   uint32_t out_of_sync_cnt = 0;
   uint32_t in_sync_cnt     = 0;
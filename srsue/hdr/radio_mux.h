@@ -0,0 +1,149 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        radio_mux.h
+ * Description: Shares one RF frontend between the UEs emulated by a single
+ *              srsUE process.
+ *****************************************************************************/
+
+#ifndef SRSUE_RADIO_MUX_H
+#define SRSUE_RADIO_MUX_H
+
+#include "srslte/common/log_filter.h"
+#include "srslte/radio/radio.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace srsue {
+
+/**
+ * Every UE gets a port that looks like a radio to its PHY. The received samples are stored in a ring buffer, each port
+ * reads them at its own pace and the port that runs out of samples reads the next block from the radio. The samples
+ * transmitted by the ports are added together in a second ring buffer, indexed by their sample time, so that the
+ * timing advance of every UE is kept. They are sent to the radio once the reception is 1 ms away from them.
+ *
+ * Only one carrier with one antenna is supported. The radio runs at the highest sample rate requested by the ports,
+ * ports with a lower rate receive the samples decimated. The first port tunes the radio and sets its gains, the other
+ * ports receive zeros while they are tuned to a different frequency.
+ */
+class radio_mux : public srslte::phy_interface_radio
+{
+public:
+  class port;
+
+  explicit radio_mux(srslte::logger* logger_);
+
+  int  init(const srslte::rf_args_t& args);
+  void stop();
+
+  std::unique_ptr<port> create_port();
+
+  bool get_metrics(srslte::rf_metrics_t* metrics) { return radio.get_metrics(metrics); }
+
+  // Radio callbacks, forwarded to the PHY of every UE
+  void radio_overflow() override;
+  void radio_failure() override;
+
+private:
+  struct port_state_t {
+    srslte::phy_interface_radio* phy      = nullptr;
+    bool                         active   = false;
+    bool                         rx_reset = true; ///< The read index has to be moved to the last sample received
+    uint64_t                     rx_idx   = 0;    ///< Next sample to read from the ring buffer
+    double                       srate    = 0.0;
+    double                       rx_freq  = 0.0;
+  };
+
+  bool     rx_now(uint32_t port_idx, srslte::rf_buffer_interface& buffer, srslte::rf_timestamp_interface& rxd_time);
+  bool     tx(uint32_t port_idx, srslte::rf_buffer_interface& buffer, const srslte::rf_timestamp_interface& tx_time);
+  void     set_srate(uint32_t port_idx, double srate);
+  void     set_rx_freq(uint32_t port_idx, double freq);
+  bool     receive_block(uint32_t nof_samples);
+  void     flush_tx();
+  uint64_t sample_idx(const srslte_timestamp_t& ts) const;
+  void     sample_time(uint64_t idx, srslte_timestamp_t* ts) const;
+
+  srslte::radio      radio;
+  srslte::log_filter log_h;
+  std::mutex         mutex;
+
+  std::vector<port_state_t> ports;
+  double                    srate   = 0.0;
+  double                    rx_freq = 0.0;
+
+  // Both ring buffers are indexed by the sample count since the last sample rate change
+  std::vector<cf_t>  rx_ring;
+  std::vector<cf_t>  rx_block;
+  uint64_t           rx_head    = 0; ///< Next sample to be received
+  srslte_timestamp_t ts_zero    = {}; ///< Time of the sample 0
+  std::vector<cf_t>  tx_ring;
+  uint64_t           tx_head    = 0; ///< Next sample to be sent to the radio
+  bool               tx_started = false;
+};
+
+class radio_mux::port : public srslte::radio_interface_phy, public srslte::radio_base
+{
+public:
+  port(radio_mux* mux_, uint32_t idx_) : mux(mux_), idx(idx_) {}
+
+  std::string get_type() override { return "radio"; }
+  int         init(const srslte::rf_args_t& args_, srslte::phy_interface_radio* phy_) override;
+  void        stop() override;
+  bool        get_metrics(srslte::rf_metrics_t* metrics) override { return mux->get_metrics(metrics); }
+
+  void tx_end() override {}
+  bool tx(srslte::rf_buffer_interface& buffer, const srslte::rf_timestamp_interface& tx_time) override
+  {
+    return mux->tx(idx, buffer, tx_time);
+  }
+  bool rx_now(srslte::rf_buffer_interface& buffer, srslte::rf_timestamp_interface& rxd_time) override
+  {
+    return mux->rx_now(idx, buffer, rxd_time);
+  }
+
+  void set_tx_freq(const uint32_t& carrier_idx, const double& freq) override;
+  void set_rx_freq(const uint32_t& carrier_idx, const double& freq) override { mux->set_rx_freq(idx, freq); }
+  void release_freq(const uint32_t& carrier_idx) override {}
+  void set_tx_gain(const float& gain) override;
+  void set_rx_gain_th(const float& gain) override;
+  void set_rx_gain(const float& gain) override;
+  void set_tx_srate(const double& srate) override {}
+  void set_rx_srate(const double& srate) override { mux->set_srate(idx, srate); }
+  void set_channel_rx_offset(uint32_t ch, int32_t offset_samples) override {}
+
+  double            get_freq_offset() override { return mux->radio.get_freq_offset(); }
+  float             get_rx_gain() override { return mux->radio.get_rx_gain(); }
+  bool              is_continuous_tx() override { return true; }
+  bool              get_is_start_of_burst() override { return false; }
+  bool              is_init() override { return mux->radio.is_init(); }
+  void              reset() override {}
+  srslte_rf_info_t* get_info() override { return mux->radio.get_info(); }
+
+private:
+  radio_mux* mux = nullptr;
+  uint32_t   idx = 0;
+};
+
+} // namespace srsue
+
+#endif // SRSUE_RADIO_MUX_H
@@ -37,6 +37,7 @@ class mac_interface_demux
 public:
   virtual void reset_harq(uint32_t cc_idx)               = 0;
   virtual bool contention_resolution_id_rcv(uint64_t id) = 0;
+  virtual void drx_command()                             = 0;
 };
 
 class demux : public srslte::pdu_queue::process_callback
@@ -79,7 +80,7 @@ private:
   srslte::sch_pdu pending_mac_msg;
   uint8_t         mch_lcids[SRSLTE_N_MCH_LCIDS];
   void            process_sch_pdu_rt(uint8_t* buff, uint32_t nof_bytes);
-  void            process_sch_pdu(srslte::sch_pdu* pdu);
+  void            process_sch_pdu(srslte::sch_pdu* pdu, uint8_t* mac_pdu);
   void            process_mch_pdu(srslte::mch_pdu* pdu);
   bool            process_ce(srslte::sch_subh* subheader);
   void            parse_ta_cmd(srslte::sch_subh* subh);
@@ -32,10 +32,12 @@
 #include "proc_sr.h"
 #include "srslte/common/logmap.h"
 #include "srslte/common/mac_pcap.h"
+#include "srslte/common/metrics_counter.h"
 #include "srslte/common/threads.h"
 #include "srslte/common/timers.h"
 #include "srslte/common/tti_sync_cv.h"
 #include "srslte/interfaces/ue_interfaces.h"
+#include "srslte/mac/drx.h"
 #include "ul_harq.h"
 #include <condition_variable>
 #include <mutex>
@@ -64,6 +66,7 @@ public:
   void     bch_decoded_ok(uint32_t cc_idx, uint8_t* payload, uint32_t len);
   uint16_t get_dl_sched_rnti(uint32_t tti);
   uint16_t get_ul_sched_rnti(uint32_t tti);
+  bool     is_drx_active_time(uint32_t tti);
 
   void mch_decoded(uint32_t len, bool crc);
   void process_mch_pdu(uint32_t len);
@@ -75,7 +78,7 @@ public:
   /******** Interface from RRC (RRC -> MAC) ****************/
   void bcch_start_rx(int si_window_start, int si_window_length);
   void bcch_stop_rx();
-  void pcch_start_rx();
+  void pcch_start_rx(uint32_t paging_cycle, uint32_t pf_offset, uint32_t po_sf_idx);
   void setup_lcid(uint32_t lcid, uint32_t lcg, uint32_t priority, int PBR_x_tti, uint32_t BSD);
   void setup_lcid(const logical_channel_config_t& config);
   void mch_start_rx(uint32_t lcid);
@@ -90,6 +93,7 @@ public:
   /******* interface from demux object ****************/
   void reset_harq(uint32_t cc_idx);
   bool contention_resolution_id_rcv(uint64_t id);
+  void drx_command();
 
   void set_rach_ded_cfg(uint32_t preamble_index, uint32_t prach_mask);
 
@@ -124,6 +128,11 @@ private:
   int ra_window_length = -1, ra_window_start = -1;
   int p_window_start = -1;
 
+  // Paging occasion of the UE, the P-RNTI is searched in every subframe if the paging cycle is 0
+  uint32_t paging_cycle = 0;
+  uint32_t paging_pf    = 0;
+  uint32_t paging_sf    = 0;
+
   // UE-specific RNTIs
   ue_rnti_t uernti;
 
@@ -142,6 +151,10 @@ private:
   bsr_proc bsr_procedure;
   phr_proc phr_procedure;
 
+  /* DRX Active Time, updated by the PHY workers and the stack thread */
+  std::mutex              drx_mutex;
+  srslte::drx_active_time drx;
+
   /* Buffers for PCH reception (not included in DL HARQ) */
   const static uint32_t  pch_payload_buffer_sz = 8 * 1024;
   srslte_softbuffer_rx_t pch_softbuffer;
@@ -166,7 +179,20 @@ private:
   srslte::mac_pcap* pcap              = nullptr;
   bool              is_first_ul_grant = false;
 
-  mac_metrics_t metrics[SRSLTE_MAX_CARRIERS] = {};
+  /// Metrics of a carrier, updated by the PHY workers and read and reset by get_metrics() without locking
+  struct metrics_counters {
+    srslte::metrics_counter<uint32_t> nof_tti;
+    srslte::metrics_counter<int>      tx_pkts;
+    srslte::metrics_counter<int>      tx_errors;
+    srslte::metrics_counter<int>      tx_brate;
+    srslte::metrics_counter<int>      rx_pkts;
+    srslte::metrics_counter<int>      rx_errors;
+    srslte::metrics_counter<int>      rx_brate;
+  };
+  std::array<metrics_counters, SRSLTE_MAX_CARRIERS> metrics;
+
+  void read_metrics(uint32_t cc_idx, mac_metrics_t& m);
+  void reset_metrics();
 
   bool initialized = false;
 
@@ -103,8 +103,7 @@ private:
 
   /// Tx buffer
   srslte::mac_nr_sch_pdu       tx_pdu;
-  srslte::unique_byte_buffer_t tx_buffer  = nullptr;
-  srslte::unique_byte_buffer_t rlc_buffer = nullptr;
+  srslte::unique_byte_buffer_t tx_buffer = nullptr;
 
   srslte::task_multiqueue::queue_handle stack_task_dispatch_queue;
 };
@@ -24,10 +24,12 @@
 
 #include <pthread.h>
 
-#include <vector>
+#include <array>
+#include <atomic>
 
 #include "proc_bsr.h"
 #include "proc_phr.h"
+#include "srslte/adt/span.h"
 #include "srslte/common/common.h"
 #include "srslte/common/log.h"
 #include "srslte/interfaces/ue_interfaces.h"
@@ -76,17 +78,28 @@ public:
 
   void setup_lcid(const logical_channel_config_t& config);
 
-  void print_logical_channel_state(const std::string& info);
+  void print_logical_channel_state(const char* info);
 
 private:
   bool has_logical_channel(const uint32_t& lcid);
   bool pdu_move_to_msg3(uint32_t pdu_sz);
   bool allocate_sdu(uint32_t lcid, srslte::sch_pdu* pdu, int max_sdu_sz);
   bool sched_sdu(logical_channel_config_t* ch, int* sdu_space, int max_sdu_sz);
+  void update_Bj();
+
+  srslte::span<logical_channel_config_t> channels()
+  {
+    return srslte::span<logical_channel_config_t>(logical_channels.data(), nof_logical_channels);
+  }
 
   const static int MAX_NOF_SUBHEADERS = 20;
 
-  std::vector<logical_channel_config_t> logical_channels;
+  // Sorted by priority when they are set up, so that the LCP in pdu_get() only walks them
+  std::array<logical_channel_config_t, SRSLTE_N_RADIO_BEARERS> logical_channels = {};
+  uint32_t                                                     nof_logical_channels = 0;
+
+  // TTIs whose Bj increment has not been applied yet, so that step() does not take the mutex every TTI
+  std::atomic<uint32_t> nof_pending_steps{0};
 
   // Mutex for exclusive access
   std::mutex mutex;
@@ -42,6 +42,7 @@ public:
   void set_config(srslte::sr_cfg_t& cfg);
   void reset();
   void start();
+  bool is_pending() const { return is_pending_sr; }
 
 private:
   bool need_tx(uint32_t tti);
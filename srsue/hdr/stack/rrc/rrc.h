@@ -377,6 +377,8 @@ private:
   void handle_sib3();
   void handle_sib13();
 
+  void start_pcch_rx();
+
   void     handle_con_setup(const asn1::rrc::rrc_conn_setup_s& setup);
   void     handle_con_reest(const asn1::rrc::rrc_conn_reest_s& setup);
   void     handle_rrc_con_reconfig(uint32_t lcid, const asn1::rrc::rrc_conn_recfg_s& reconfig);
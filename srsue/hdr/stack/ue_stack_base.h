@@ -23,6 +23,7 @@
 #define SRSUE_UE_STACK_BASE_H
 
 #include "srslte/common/logger.h"
+#include "srslte/common/pcap_writer.h"
 #include "srslte/interfaces/ue_interfaces.h"
 #include "srsue/hdr/ue_metrics_interface.h"
 
@@ -33,10 +34,11 @@
 namespace srsue {
 
 typedef struct {
-  bool        enable;
-  std::string filename;
-  bool        nas_enable;
-  std::string nas_filename;
+  bool                    enable;
+  std::string             filename;
+  bool                    nas_enable;
+  std::string             nas_filename;
+  srslte::pcap_rotation_t rotation;
 } pcap_args_t;
 
 typedef struct {
@@ -70,6 +72,7 @@ typedef struct {
   gw_args_t        gw;
   uint32_t         sync_queue_size; // Max allowed difference between PHY and Stack clocks (in TTI)
   bool             have_tti_time_stats;
+  bool             pdcp_crypto_offload; // Cipher the DRB PDUs in the background threads
 } stack_args_t;
 
 class ue_stack_base
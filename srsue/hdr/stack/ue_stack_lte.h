@@ -89,6 +89,7 @@ public:
   // MAC Interface for PHY
   uint16_t get_dl_sched_rnti(uint32_t tti) final { return mac.get_dl_sched_rnti(tti); }
   uint16_t get_ul_sched_rnti(uint32_t tti) final { return mac.get_ul_sched_rnti(tti); }
+  bool     is_drx_active_time(uint32_t tti) final { return mac.is_drx_active_time(tti); }
 
   void new_grant_ul(uint32_t cc_idx, mac_grant_ul_t grant, tb_action_ul_t* action) final
   {
@@ -132,9 +133,10 @@ public:
   srslte::ext_task_sched_handle get_task_sched() { return {&task_sched}; }
 
 private:
-  void run_thread() final;
-  void run_tti_impl(uint32_t tti, uint32_t tti_jump);
-  void stop_impl();
+  void        run_thread() final;
+  void        run_tti_impl(uint32_t tti, uint32_t tti_jump);
+  void        stop_impl();
+  std::string get_queue_depths();
   // added for brokerd utelco
   void detach_impl();
 
@@ -23,6 +23,7 @@
 #define SRSUE_GW_H
 
 #include "gw_metrics.h"
+#include "srslte/common/block_queue.h"
 #include "srslte/common/buffer_pool.h"
 #include "srslte/common/common.h"
 #include "srslte/common/interfaces_common.h"
@@ -31,7 +32,10 @@
 #include "srslte/common/threads.h"
 #include "srslte/interfaces/ue_interfaces.h"
 #include "tft_packet_filter.h"
+#include <atomic>
+#include <memory>
 #include <net/if.h>
+#include <vector>
 
 namespace srsue {
 
@@ -43,6 +47,8 @@ struct gw_args_t {
   std::string netns;
   std::string tun_dev_name;
   std::string tun_dev_netmask;
+  uint32_t    nof_tun_queues  = 1;
+  bool        async_tun_write = false;
 };
 
 class gw : public gw_interface_stack, public srslte::thread
@@ -77,25 +83,60 @@ private:
 
   gw_args_t args = {};
 
-  bool         running      = false;
-  bool         run_enable   = false;
-  int32_t      netns_fd     = 0;
-  int32_t      tun_fd       = 0;
-  struct ifreq ifr          = {};
-  int32_t      sock         = 0;
-  bool         if_up        = false;
-  uint32_t     default_lcid = 0;
+  bool                 running      = false;
+  bool                 run_enable   = false;
+  int32_t              netns_fd     = 0;
+  int32_t              tun_fd       = 0;
+  std::vector<int32_t> tun_queue_fds; // Queues of a multi-queue TUN device besides tun_fd
+  struct ifreq         ifr          = {};
+  int32_t              sock         = 0;
+  bool                 if_up        = false;
+  uint32_t             default_lcid = 0;
 
   srslte::log_filter log;
 
   uint32_t current_ip_addr = 0;
   uint8_t  current_if_id[8];
 
-  long           ul_tput_bytes = 0;
-  long           dl_tput_bytes = 0;
-  struct timeval metrics_time[3];
+  std::atomic<long> ul_tput_bytes = {0};
+  long              dl_tput_bytes = 0;
+  struct timeval    metrics_time[3];
+
+  // Reads the uplink packets of one more queue of the TUN device
+  class tun_reader : public srslte::thread
+  {
+  public:
+    tun_reader(gw* parent_, int32_t fd_, uint32_t id);
+
+  private:
+    void run_thread() override;
+
+    gw*     parent;
+    int32_t fd;
+  };
+  std::vector<std::unique_ptr<tun_reader> > tun_readers;
+
+  // Writes the downlink packets to the TUN device, so that the stack thread does not block on it
+  class tun_writer : public srslte::thread
+  {
+  public:
+    explicit tun_writer(gw* parent_);
+    void stop();
+
+    srslte::block_queue<srslte::unique_byte_buffer_t> queue;
+
+  private:
+    static const uint32_t MAX_QUEUE_SIZE = 1024;
+
+    void run_thread() override;
+
+    gw* parent;
+  };
+  std::unique_ptr<tun_writer> dl_writer;
 
   void run_thread();
+  void read_tun(int32_t fd);
+  void write_tun(const srslte::unique_byte_buffer_t& pdu);
   int  init_if(char* err_str);
   int  setup_if_addr4(uint32_t ip_addr, char* err_str);
   int  setup_if_addr6(uint8_t* ipv6_if_id, char* err_str);
@@ -26,7 +26,9 @@
 #include "srslte/common/buffer_pool.h"
 #include "srslte/common/log.h"
 #include "srslte/common/log_filter.h"
+#include <atomic>
 #include <mutex>
+#include <vector>
 
 namespace srsue {
 
@@ -125,11 +127,17 @@ public:
                                       const LIBLTE_MME_TRAFFIC_FLOW_TEMPLATE_STRUCT* tft);
 
 private:
+  void compile_filters();
+
   srslte::log_filter*                             log          = nullptr;
-  uint8_t                                         default_lcid = 0;
+  std::atomic<uint8_t>                            default_lcid = {0};
   std::mutex                                      tft_mutex;
   typedef std::map<uint16_t, tft_packet_filter_t> tft_filter_map_t;
   tft_filter_map_t                                tft_filter_map;
+
+  // The filters that can match, in evaluation precedence order. Packets skip the lock while there are none
+  std::vector<tft_packet_filter_t> compiled_filters;
+  std::atomic<bool>                has_filters = {false};
 };
 
 } // namespace srsue
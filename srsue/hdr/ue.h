@@ -28,6 +28,7 @@
 #ifndef SRSUE_UE_H
 #define SRSUE_UE_H
 
+#include <map>
 #include <pthread.h>
 #include <stdarg.h>
 #include <string>
@@ -37,6 +38,7 @@
 #include "srslte/common/log_filter.h"
 #include "srslte/interfaces/ue_interfaces.h"
 #include "srslte/radio/radio.h"
+#include "radio_mux.h"
 #include "stack/ue_stack_base.h"
 
 #include "ue_metrics_interface.h"
@@ -58,6 +60,7 @@ typedef struct {
   int         all_hex_limit;
   int         file_max_size;
   std::string filename;
+  bool        binary;
 } log_args_t;
 
 typedef struct {
@@ -70,6 +73,16 @@ typedef struct {
   bool        metrics_csv_append;
   int         metrics_csv_flush_period_sec;
   std::string metrics_csv_filename;
+  bool        metrics_http_enable;
+  std::string metrics_http_address;
+  uint16_t    metrics_http_port;
+  uint32_t    hugepage_threshold;
+  std::string tti_trace_filename;
+  bool        perf_counters;
+  uint32_t    nof_ues; ///< Number of UEs emulated by the process, they share the RF frontend
+
+  // CPU placement of the threads, indexed by the prefix of the thread names
+  std::map<std::string, std::string> thread_placement;
 } general_args_t;
 
 typedef struct {
@@ -95,7 +108,8 @@ public:
   ue();
   ~ue();
 
-  int  init(const all_args_t& args_, srslte::logger* logger_);
+  // The UE uses its own radio unless a shared one is given
+  int  init(const all_args_t& args_, srslte::logger* logger_, radio_mux* shared_radio = nullptr);
   void stop();
   bool switch_on();
   bool switch_off();
@@ -25,11 +25,15 @@
 #include "srslte/common/logger_srslog_wrapper.h"
 #include "srslte/common/logmap.h"
 #include "srslte/common/metrics_hub.h"
+#include "srslte/common/perf_counters.h"
 #include "srslte/common/signal_handler.h"
+#include "srslte/common/threads.h"
+#include "srslte/common/tti_trace.h"
 #include "srslte/srslog/srslog.h"
 #include "srslte/srslte.h"
 #include "srslte/version.h"
 #include "srsue/hdr/metrics_csv.h"
+#include "srsue/hdr/metrics_prometheus.h"
 #include "srsue/hdr/metrics_stdout.h"
 #include "srsue/hdr/ue.h"
 #include <boost/program_options.hpp>
@@ -77,6 +81,7 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
     ("rf.dl_earfcn",    bpo::value<string>(&args->phy.dl_earfcn)->default_value("3400"), "Downlink EARFCN list")
     ("rf.ul_earfcn",    bpo::value<string>(&args->phy.ul_earfcn),                        "Uplink EARFCN list. Optional.")
     ("rf.srate",        bpo::value<double>(&args->rf.srate_hz)->default_value(0.0),      "Force Tx and Rx sampling rate in Hz")
+    ("rf.srate_passband", bpo::value<float>(&args->rf.srate_passband)->default_value(0.8f), "Resampler passband (fraction of Nyquist) for non-integer rf.srate ratios")
     ("rf.freq_offset",  bpo::value<float>(&args->rf.freq_offset)->default_value(0),      "(optional) Frequency offset")
     ("rf.dl_freq",      bpo::value<float>(&args->phy.dl_freq)->default_value(-1),        "Downlink Frequency (if positive overrides EARFCN)")
     ("rf.ul_freq",      bpo::value<float>(&args->phy.ul_freq)->default_value(-1),        "Uplink Frequency (if positive overrides EARFCN)")
@@ -99,6 +104,8 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
     ("rf.device_args", bpo::value<string>(&args->rf.device_args)->default_value("auto"), "Front-end device arguments")
     ("rf.time_adv_nsamples", bpo::value<string>(&args->rf.time_adv_nsamples)->default_value("auto"), "Transmission time advance")
     ("rf.continuous_tx", bpo::value<string>(&args->rf.continuous_tx)->default_value("auto"), "Transmit samples continuously to the radio or on bursts (auto/yes/no). Default is auto (yes for UHD, no for rest)")
+    ("rf.tx_async", bpo::value<bool>(&args->rf.tx_async)->default_value(false), "Hand the transmissions to the driver from a dedicated thread")
+    ("rf.rx_dev_threads", bpo::value<bool>(&args->rf.rx_dev_threads)->default_value(false), "Receive from every RF device in its own thread")
 
     ("rf.bands.rx[0].min", bpo::value<float>(&args->rf.ch_rx_bands[0].min)->default_value(0), "Lower frequency boundary for CH0-RX")
     ("rf.bands.rx[0].max", bpo::value<float>(&args->rf.ch_rx_bands[0].max)->default_value(0), "Higher frequency boundary for CH0-RX")
@@ -146,6 +153,8 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
     ("pcap.filename", bpo::value<string>(&args->stack.pcap.filename)->default_value("ue.pcap"), "MAC layer capture filename")
     ("pcap.nas_enable",   bpo::value<bool>(&args->stack.pcap.nas_enable)->default_value(false), "Enable NAS packet captures for wireshark")
     ("pcap.nas_filename", bpo::value<string>(&args->stack.pcap.nas_filename)->default_value("ue_nas.pcap"), "NAS layer capture filename (useful when NAS encryption is enabled)")
+    ("pcap.max_file_size", bpo::value<uint64_t>(&args->stack.pcap.rotation.max_file_size)->default_value(0), "Start a new capture file when the current one would exceed this size in bytes. 0 disables it")
+    ("pcap.max_file_duration", bpo::value<uint32_t>(&args->stack.pcap.rotation.max_file_duration)->default_value(0), "Start a new capture file every this number of seconds. 0 disables it")
 
     ("gui.enable", bpo::value<bool>(&args->gui.enable)->default_value(false), "Enable GUI plots")
 
@@ -175,6 +184,7 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
 
     ("log.filename", bpo::value<string>(&args->log.filename)->default_value("/tmp/ue.log"), "Log filename")
     ("log.file_max_size", bpo::value<int>(&args->log.file_max_size)->default_value(-1), "Maximum file size (in kilobytes). When passed, multiple files are created. Default -1 (single file)")
+    ("log.binary", bpo::value<bool>(&args->log.binary)->default_value(false), "Write the log file in the srslog binary format, converted to text by srslog_decoder")
 
     ("usim.mode", bpo::value<string>(&args->stack.usim.mode)->default_value("soft"), "USIM mode (soft or pcsc)")
     ("usim.algo", bpo::value<string>(&args->stack.usim.algo), "USIM authentication algorithm")
@@ -189,6 +199,8 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
     ("gw.netns", bpo::value<string>(&args->gw.netns)->default_value(""), "Network namespace to for TUN device (empty for default netns)")
     ("gw.ip_devname", bpo::value<string>(&args->gw.tun_dev_name)->default_value("tun_srsue"), "Name of the tun_srsue device")
     ("gw.ip_netmask", bpo::value<string>(&args->gw.tun_dev_netmask)->default_value("255.255.255.0"), "Netmask of the tun_srsue device")
+    ("gw.tun_queues", bpo::value<uint32_t>(&args->gw.nof_tun_queues)->default_value(1), "Number of queues, each with its own reader thread, of the tun_srsue device")
+    ("gw.async_tun_write", bpo::value<bool>(&args->gw.async_tun_write)->default_value(false), "Write the downlink packets to the tun_srsue device from a separate thread")
 
     /* Downlink Channel emulator section */
     ("channel.dl.enable",            bpo::value<bool>(&args->phy.dl_channel_args.enable)->default_value(false),                 "Enable/Disable internal Downlink channel emulator")
@@ -263,6 +275,10 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
      bpo::value<float>(&args->phy.sfo_ema)->default_value(DEFAULT_SFO_EMA_COEFF),
      "EMA coefficient to average sample offsets used to compute SFO")
 
+    ("phy.pss_track_max_period",
+     bpo::value<uint32_t>(&args->phy.pss_track_max_period)->default_value(DEFAULT_TRACK_MAX_PERIOD),
+     "Maximum number of PSS occasions (5 ms) between PSS correlations while the tracking is stable (1 disables)")
+
     ("phy.snr_ema_coeff",
      bpo::value<float>(&args->phy.snr_ema_coeff)->default_value(0.1),
      "Sets the SNR exponential moving average coefficient (Default 0.1)")
@@ -283,6 +299,30 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
      bpo::value<int>(&args->phy.nof_phy_threads)->default_value(3),
      "Number of PHY threads")
 
+    ("phy.nof_cc_helpers",
+     bpo::value<uint32_t>(&args->phy.nof_cc_helpers)->default_value(0),
+     "Number of threads decoding the secondary carriers in parallel with the PHY threads (0 to disable)")
+
+    ("phy.idle_drx",
+     bpo::value<bool>(&args->phy.idle_drx)->default_value(false),
+     "In RRC_IDLE, only demodulate the paging occasions and the SI and RA windows")
+
+    ("phy.deadline_dump_filename",
+     bpo::value<string>(&args->phy.deadline_watchdog.dump_filename)->default_value(""),
+     "Append a snapshot of the last TTIs to this file when a TTI misses its deadline (empty disables)")
+
+    ("phy.deadline_tx_margin_us",
+     bpo::value<uint32_t>(&args->phy.deadline_watchdog.tx_margin_us)->default_value(100),
+     "Minimum time between the Tx of a TTI reaching the radio and its Tx time")
+
+    ("phy.deadline_rx_lag_us",
+     bpo::value<uint32_t>(&args->phy.deadline_watchdog.rx_lag_us)->default_value(1000),
+     "Maximum reception delay of a subframe over the usual one")
+
+    ("phy.deadline_max_dumps",
+     bpo::value<uint32_t>(&args->phy.deadline_watchdog.max_dumps)->default_value(10),
+     "Maximum number of deadline miss snapshots")
+
     ("phy.equalizer_mode",
      bpo::value<string>(&args->phy.equalizer_mode)->default_value("mmse"),
      "Equalizer mode")
@@ -346,6 +386,14 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
      bpo::value<bool>(&args->phy.interpolate_subframe_enabled)->default_value(false),
      "Interpolates in the time domain the channel estimates within 1 subframe.")
 
+    ("phy.wiener_enabled",
+     bpo::value<bool>(&args->phy.wiener_enabled)->default_value(false),
+     "Uses the Wiener channel estimator instead of averaging or interpolating.")
+
+    ("phy.wiener_filter_bank",
+     bpo::value<bool>(&args->phy.wiener_filter_bank)->default_value(false),
+     "The Wiener channel estimator takes its filters from a precomputed bank instead of training them online.")
+
     ("phy.estimator_fil_auto",
      bpo::value<bool>(&args->phy.estimator_fil_auto)->default_value(false),
      "The channel estimator smooths the channel estimate with an adaptative filter.")
@@ -362,6 +410,10 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
      bpo::value<float>(&args->phy.snr_to_cqi_offset)->default_value(0),
      "Sets an offset in the SNR to CQI table. This is used to adjust the reported CQI.")
 
+    ("phy.pmi_max_age",
+     bpo::value<uint32_t>(&args->phy.pmi_max_age)->default_value(0),
+     "Number of subframes a PMI selection is reused for in CSI reports while the SNR does not change.")
+
     ("phy.sss_algorithm",
      bpo::value<string>(&args->phy.sss_algorithm)->default_value("full"),
      "Selects the SSS estimation algorithm.")
@@ -370,10 +422,34 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
      bpo::value<bool>(&args->phy.pdsch_csi_enabled)->default_value(true),
      "Stores the Channel State Information and uses it for weightening the softbits. It is only used in TM1.")
 
+    ("phy.pdsch_irc_enabled",
+     bpo::value<bool>(&args->phy.pdsch_irc_enabled)->default_value(false),
+     "Equalises TM1 PDSCH with interference rejection combining, using the covariance of the CRS residuals. It needs 2 or more RX antennas.")
+
     ("phy.pdsch_8bit_decoder",
        bpo::value<bool>(&args->phy.pdsch_8bit_decoder)->default_value(false),
        "Use 8-bit for LLR representation and turbo decoder trellis computation (Experimental)")
 
+    ("phy.pdsch_c16_storage",
+       bpo::value<bool>(&args->phy.pdsch_c16_storage)->default_value(false),
+       "Decode the PDSCH from an int16 copy of the received grid and channel estimates (Experimental)")
+
+    ("phy.cs_prescreen_frames",
+       bpo::value<uint32_t>(&args->phy.cs_prescreen_frames)->default_value(0),
+       "Number of 5 ms frames correlated with the three PSS before the cell search scans (0 disables)")
+
+    ("phy.cs_prescreen_min_psr",
+       bpo::value<float>(&args->phy.cs_prescreen_min_psr)->default_value(2.0),
+       "Minimum PSS peak-to-side-lobe ratio in the cell search prescreen for a N_id_2 to be scanned")
+
+    ("phy.cs_early_exit_psr",
+       bpo::value<float>(&args->phy.cs_early_exit_psr)->default_value(0.0),
+       "Peak-to-side-lobe ratio above which the cell search stops scanning a N_id_2 early (0 disables)")
+
+    ("phy.pdsch_cb_workers",
+       bpo::value<uint32_t>(&args->phy.pdsch_cb_workers)->default_value(0),
+       "Number of extra threads decoding PDSCH codeblocks in parallel (0 disables)")
+
     ("phy.force_ul_amplitude",
        bpo::value<float>(&args->phy.force_ul_amplitude)->default_value(0.0),
        "Forces the peak amplitude in the PUCCH, PUSCH and SRS (set 0.0 to 1.0, set to 0 or negative for disabling)")
@@ -424,14 +500,56 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
            bpo::value<int>(&args->general.metrics_csv_flush_period_sec)->default_value(-1),
            "Periodicity in s to flush CSV file to disk (-1 for auto)")
 
+    ("general.metrics_http_enable",
+           bpo::value<bool>(&args->general.metrics_http_enable)->default_value(false),
+           "Serve the metrics to Prometheus over HTTP")
+
+    ("general.metrics_http_address",
+           bpo::value<string>(&args->general.metrics_http_address)->default_value("127.0.0.1"),
+           "Address where the metrics are served")
+
+    ("general.metrics_http_port",
+           bpo::value<uint16_t>(&args->general.metrics_http_port)->default_value(9122),
+           "Port where the metrics are served at /metrics")
+
+    ("general.hugepage_threshold",
+           bpo::value<uint32_t>(&args->general.hugepage_threshold)->default_value(0),
+           "Allocate the PHY and RF buffers of at least this many bytes on 2 MB hugepages (0 disables)")
+
+    ("general.tti_trace_filename",
+           bpo::value<string>(&args->general.tti_trace_filename)->default_value(""),
+           "Write the timing of the last TTI stages to this file in the Chrome trace format on exit (empty disables)")
+
+    ("general.perf_counters",
+           bpo::value<bool>(&args->general.perf_counters)->default_value(false),
+           "Count the cycles, instructions, cache misses and branch mispredictions of the TTI stages with the hardware performance counters")
+
+    ("general.nof_ues",
+           bpo::value<uint32_t>(&args->general.nof_ues)->default_value(1),
+           "Number of UEs emulated by the process. They share the RF frontend and use consecutive IMSIs starting at usim.imsi")
+
     ("stack.have_tti_time_stats",
         bpo::value<bool>(&args->stack.have_tti_time_stats)->default_value(true),
         "Calculate TTI execution statistics")
 
+    ("general.pdcp_crypto_offload",
+        bpo::value<bool>(&args->stack.pdcp_crypto_offload)->default_value(false),
+        "Cipher the PDCP PDUs of the DRBs in the stack background threads")
+
     // NR params
     ("vnf.type", bpo::value<string>(&args->phy.vnf_args.type)->default_value("ue"), "VNF instance type [gnb,ue]")
     ("vnf.addr", bpo::value<string>(&args->phy.vnf_args.bind_addr)->default_value("localhost"), "Address to bind VNF interface")
     ("vnf.port", bpo::value<uint16_t>(&args->phy.vnf_args.bind_port)->default_value(3334), "Bind port")
+    ("vnf.shm_name", bpo::value<string>(&args->phy.vnf_args.shm_name)->default_value(""), "Shared memory rings with a PNF in the same host, instead of UDP")
+
+    // Thread placement, "cpus[:policy[:priority]]" for all the threads whose name starts with the given prefix
+    ("threads.stack",   bpo::value<string>(&args->general.thread_placement["STACK"]),       "Placement of the stack thread")
+    ("threads.sync",    bpo::value<string>(&args->general.thread_placement["SYNC"]),        "Placement of the PHY sync thread")
+    ("threads.workers", bpo::value<string>(&args->general.thread_placement["WORKER"]),      "Placement of the PHY workers")
+    ("threads.gw",      bpo::value<string>(&args->general.thread_placement["GW"]),          "Placement of the GW thread")
+    ("threads.rf",      bpo::value<string>(&args->general.thread_placement["RF_"]),         "Placement of the RF driver threads")
+    ("threads.logger",  bpo::value<string>(&args->general.thread_placement["SRSLOG"]),      "Placement of the log backend thread")
+    ("threads.metrics", bpo::value<string>(&args->general.thread_placement["METRICS_HUB"]), "Placement of the metrics thread")
     ;
 
   // Positional options - config file location
@@ -571,14 +689,21 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
     }
   }
 
-  // Set sync queue capacity to 1 for ZMQ
-  if (args->rf.device_name == "zmq") {
+  // Set sync queue capacity to 1 for ZMQ and shared memory
+  if (args->rf.device_name == "zmq" || args->rf.device_name == "shm") {
     args->stack.sync_queue_size = 1;
   } else {
     // use default size
     args->stack.sync_queue_size = MULTIQUEUE_DEFAULT_CAPACITY;
   }
 
+  for (const auto& p : args->general.thread_placement) {
+    if (!threads_set_placement(p.first.c_str(), p.second.c_str())) {
+      cout << "Error parsing the placement " << p.second << " of the " << p.first << " threads - exiting" << endl;
+      exit(1);
+    }
+  }
+
   return SRSLTE_SUCCESS;
 }
 
@@ -613,6 +738,8 @@ static void* input_loop(void* arg)
       } else if (key == "rlf") {
         simulate_rlf = true;
         cout << "Sending Radio Link Failure" << endl;
+      } else if (key == "tti") {
+        cout << srslte::tti_trace::summary_to_string();
       } else if (key == "d") {
 	cout << "Detach" << endl;
 	ue_ptr->detach(); // not switch_off
@@ -637,6 +764,28 @@ static void* input_loop(void* arg)
   return nullptr;
 }
 
+/// Arguments of the UE with the given index when several UEs are emulated, the first one uses the configured ones.
+static all_args_t ue_instance_args(const all_args_t& args, uint32_t idx)
+{
+  all_args_t ue_args = args;
+  if (idx == 0) {
+    return ue_args;
+  }
+
+  // Consecutive IMSIs, keeping the number of digits
+  std::string& imsi = ue_args.stack.usim.imsi;
+  if (not imsi.empty()) {
+    std::string next = std::to_string(strtoull(imsi.c_str(), nullptr, 10) + idx);
+    imsi             = std::string(imsi.size() > next.size() ? imsi.size() - next.size() : 0, '0') + next;
+  }
+
+  std::string suffix = "_" + std::to_string(idx);
+  ue_args.gw.tun_dev_name += std::to_string(idx);
+  ue_args.stack.pcap.filename += suffix;
+  ue_args.stack.pcap.nas_filename += suffix;
+  return ue_args;
+}
+
 /// Adjusts the input value in args from kbytes to bytes.
 static size_t fixup_log_file_maxsize(int x)
 {
@@ -646,17 +795,26 @@ static size_t fixup_log_file_maxsize(int x)
 int main(int argc, char* argv[])
 {
   srslte_register_signal_handler();
+  srslte_register_mem_dump_signal_handler();
   srslte_debug_handle_crash(argc, argv);
 
   all_args_t args = {};
   if (int err = parse_args(&args, argc, argv)) {
     return err;
   }
+  srslte_vec_set_hugepage_threshold(args.general.hugepage_threshold);
+  if (args.general.perf_counters and not srslte::perf_counters::enable()) {
+    cout << "Warning: The hardware performance counters are not available, check perf_event_paranoid" << endl;
+  }
 
   // Setup logging.
-  log_sink = (args.log.filename == "stdout")
-                 ? srslog::create_stdout_sink()
-                 : srslog::create_file_sink(args.log.filename, fixup_log_file_maxsize(args.log.file_max_size));
+  if (args.log.filename == "stdout") {
+    log_sink = srslog::create_stdout_sink();
+  } else if (args.log.binary) {
+    log_sink = &srslog::fetch_binary_file_sink(args.log.filename, fixup_log_file_maxsize(args.log.file_max_size));
+  } else {
+    log_sink = srslog::create_file_sink(args.log.filename, fixup_log_file_maxsize(args.log.file_max_size));
+  }
   if (!log_sink) {
     return SRSLTE_ERROR;
   }
@@ -674,13 +832,40 @@ int main(int argc, char* argv[])
 
   srslte::check_scaling_governor(args.rf.device_name);
 
+  // The emulated UEs share the RF frontend, each one has its own PHY and stack
+  std::unique_ptr<radio_mux> shared_radio;
+  if (args.general.nof_ues > 1) {
+    shared_radio.reset(new radio_mux(&log_wrapper));
+    if (shared_radio->init(args.rf)) {
+      cout << "Error initializing the shared radio - exiting" << endl;
+      return SRSLTE_ERROR;
+    }
+  }
+
   // Create UE instance
   srsue::ue ue;
-  if (ue.init(args, &log_wrapper)) {
+  if (ue.init(args, &log_wrapper, shared_radio.get())) {
     ue.stop();
     return SRSLTE_SUCCESS;
   }
 
+  // The metrics and the console commands refer to the first UE only
+  std::vector<std::unique_ptr<srsue::ue> > other_ues;
+  for (uint32_t i = 1; i < args.general.nof_ues; i++) {
+    other_ues.emplace_back(new srsue::ue());
+    if (other_ues.back()->init(ue_instance_args(args, i), &log_wrapper, shared_radio.get())) {
+      for (auto& u : other_ues) {
+        u->stop();
+      }
+      ue.stop();
+      shared_radio->stop();
+      return SRSLTE_SUCCESS;
+    }
+  }
+
+  // The log backend and the RF drivers start their own threads, place them now that they are running
+  threads_apply_placement_all();
+
   srslte::metrics_hub<ue_metrics_t> metricshub;
   metrics_stdout                    _metrics_screen;
 
@@ -698,26 +883,53 @@ int main(int argc, char* argv[])
     }
   }
 
+  metrics_prometheus metrics_http;
+  if (args.general.metrics_http_enable) {
+    if (metrics_http.init(args.general.metrics_http_address, args.general.metrics_http_port)) {
+      metricshub.add_listener(&metrics_http);
+    }
+  }
+
   pthread_t input;
   pthread_create(&input, nullptr, &input_loop, &ue);//&args);
 
   cout << "Attaching UE..." << endl;
   ue.switch_on();
+  for (auto& u : other_ues) {
+    u->switch_on();
+  }
 
   if (args.gui.enable) {
     ue.start_plot();
   }
 
   while (running) {
+    if (mem_dump_requested) {
+      mem_dump_requested = 0;
+      srslte_mem_fprint(stdout);
+    }
     sleep(1);
   }
 
   ue.switch_off();
+  for (auto& u : other_ues) {
+    u->switch_off();
+  }
   pthread_cancel(input);
   pthread_join(input, nullptr);
   metricshub.stop();
   metrics_file.stop();
   ue.stop();
+  for (auto& u : other_ues) {
+    u->stop();
+  }
+  if (shared_radio) {
+    shared_radio->stop();
+  }
+  if (not args.general.tti_trace_filename.empty()) {
+    cout << srslte::tti_trace::summary_to_string();
+    srslte::tti_trace::write_chrome_trace(args.general.tti_trace_filename);
+  }
   cout << "---  exiting  ---" << endl;
 
   return SRSLTE_SUCCESS;
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsue/hdr/metrics_prometheus.h"
+#include "srslte/common/openmetrics_writer.h"
+#include "srslte/common/thread_metrics.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+namespace srsue {
+
+namespace {
+
+std::string cc_label(uint32_t cc_idx, const info_metrics_t& info)
+{
+  char s[96];
+  snprintf(s, sizeof(s), "cc=\"%u\",pci=\"%u\",earfcn=\"%u\"", cc_idx, info.pci, info.dl_earfcn);
+  return s;
+}
+
+std::string lcid_label(uint32_t lcid)
+{
+  return "lcid=\"" + std::to_string(lcid) + "\"";
+}
+
+/// Statistics of a latency reported as a gauge each, with the suffix appended to the name of the latency
+struct latency_quantile_t {
+  const char* suffix;
+  const char* help;
+  uint32_t srslte::latency_stats_t::*value;
+};
+const latency_quantile_t latency_quantiles[] = {
+    {"_p50_seconds", "Median", &srslte::latency_stats_t::p50_us},
+    {"_p99_seconds", "99th percentile", &srslte::latency_stats_t::p99_us},
+    {"_max_seconds", "Maximum", &srslte::latency_stats_t::max_us},
+};
+
+/// NaN values, e.g. the MCS of a carrier without transmissions, are reported as 0
+double value_or_zero(float v)
+{
+  return std::isnan(v) ? 0.0 : v;
+}
+
+} // namespace
+
+bool metrics_prometheus::init(const std::string& address, uint16_t port)
+{
+  return server.init(address, port, [this]() { return scrape(); });
+}
+
+void metrics_prometheus::stop()
+{
+  server.stop();
+}
+
+void metrics_prometheus::set_metrics(const ue_metrics_t& metrics, const uint32_t period_usec)
+{
+  uint32_t nof_cc = std::min<uint32_t>(metrics.phy.nof_active_cc, SRSLTE_MAX_CARRIERS);
+
+  // Accumulate the counters of the period
+  for (uint32_t cc = 0; cc < nof_cc; cc++) {
+    const mac_metrics_t& mac = metrics.stack.mac[cc];
+    cc_totals[cc].dl_pkts += mac.rx_pkts;
+    cc_totals[cc].dl_errors += mac.rx_errors;
+    cc_totals[cc].dl_bytes += mac.rx_brate / 8;
+    cc_totals[cc].ul_pkts += mac.tx_pkts;
+    cc_totals[cc].ul_errors += mac.tx_errors;
+    cc_totals[cc].ul_bytes += mac.tx_brate / 8;
+  }
+  for (uint32_t lcid = 0; lcid < SRSLTE_N_RADIO_BEARERS; lcid++) {
+    const srslte::rlc_bearer_metrics_t& b = metrics.stack.rlc.bearer[lcid];
+    srslte::rlc_bearer_metrics_t&       t = rlc_totals.bearer[lcid];
+    t.num_tx_sdus += b.num_tx_sdus;
+    t.num_rx_sdus += b.num_rx_sdus;
+    t.num_tx_sdu_bytes += b.num_tx_sdu_bytes;
+    t.num_rx_sdu_bytes += b.num_rx_sdu_bytes;
+    t.num_lost_sdus += b.num_lost_sdus;
+    t.num_tx_pdus += b.num_tx_pdus;
+    t.num_rx_pdus += b.num_rx_pdus;
+    t.num_tx_pdu_bytes += b.num_tx_pdu_bytes;
+    t.num_rx_pdu_bytes += b.num_rx_pdu_bytes;
+    t.num_lost_pdus += b.num_lost_pdus;
+  }
+  rf_totals.rf_o += metrics.rf.rf_o;
+  rf_totals.rf_u += metrics.rf.rf_u;
+  rf_totals.rf_l += metrics.rf.rf_l;
+  rf_totals.tx_late_drop += metrics.rf.tx_late_drop;
+
+  srslte::openmetrics_writer w("srsue_");
+
+  w.family("rrc_connected", "gauge", "Whether the RRC is connected");
+  w.sample(metrics.stack.rrc.state == RRC_STATE_CONNECTED ? 1 : 0);
+  w.family("gw_dl_bitrate_bps", "gauge", "DL IP bitrate of the last period");
+  w.sample(metrics.gw.dl_tput_mbps * 1e6);
+  w.family("gw_ul_bitrate_bps", "gauge", "UL IP bitrate of the last period");
+  w.sample(metrics.gw.ul_tput_mbps * 1e6);
+
+  // Radio
+  w.family("rf_overflows_total", "counter", "Receive overflows of the radio");
+  w.sample(rf_totals.rf_o);
+  w.family("rf_underflows_total", "counter", "Transmit underflows of the radio");
+  w.sample(rf_totals.rf_u);
+  w.family("rf_late_total", "counter", "Late transmissions of the radio");
+  w.sample(rf_totals.rf_l);
+  w.family("rf_tx_late_drops_total", "counter", "Bursts dropped because they would have been transmitted late");
+  w.sample(rf_totals.tx_late_drop);
+
+  // Carriers
+  struct cc_gauge_t {
+    const char* name;
+    const char* help;
+    double (*get)(const ue_metrics_t&, uint32_t);
+  };
+  static const cc_gauge_t cc_gauges[] = {
+      {"cc_rsrp_dbm", "Average RSRP of the carrier",
+       [](const ue_metrics_t& m, uint32_t cc) { return value_or_zero(m.phy.ch[cc].rsrp); }},
+      {"cc_rsrq_db", "Average RSRQ of the carrier",
+       [](const ue_metrics_t& m, uint32_t cc) { return value_or_zero(m.phy.ch[cc].rsrq); }},
+      {"cc_sinr_db", "Average SINR of the carrier",
+       [](const ue_metrics_t& m, uint32_t cc) { return value_or_zero(m.phy.ch[cc].sinr); }},
+      {"cc_pathloss_db", "Average pathloss of the carrier",
+       [](const ue_metrics_t& m, uint32_t cc) { return value_or_zero(m.phy.ch[cc].pathloss); }},
+      {"cc_cfo_hz", "Average carrier frequency offset of the carrier",
+       [](const ue_metrics_t& m, uint32_t cc) { return value_or_zero(m.phy.sync[cc].cfo); }},
+      {"cc_ta_us", "Timing advance of the carrier",
+       [](const ue_metrics_t& m, uint32_t cc) { return value_or_zero(m.phy.sync[cc].ta_us); }},
+      {"cc_dl_mcs", "Average DL MCS of the carrier",
+       [](const ue_metrics_t& m, uint32_t cc) { return value_or_zero(m.phy.dl[cc].mcs); }},
+      {"cc_dl_turbo_iters", "Average turbo decoder iterations of the carrier",
+       [](const ue_metrics_t& m, uint32_t cc) { return value_or_zero(m.phy.dl[cc].turbo_iters); }},
+      {"cc_ul_mcs", "Average UL MCS of the carrier",
+       [](const ue_metrics_t& m, uint32_t cc) { return value_or_zero(m.phy.ul[cc].mcs); }},
+      {"cc_ul_power_dbm", "Average UL transmit power of the carrier",
+       [](const ue_metrics_t& m, uint32_t cc) { return value_or_zero(m.phy.ul[cc].power); }},
+      {"cc_ul_buffer_bytes", "Bytes pending in the UL buffers",
+       [](const ue_metrics_t& m, uint32_t cc) { return (double)m.stack.mac[cc].ul_buffer; }},
+      {"cc_dl_bitrate_bps", "DL MAC bitrate of the carrier in the last period",
+       [](const ue_metrics_t& m, uint32_t cc) {
+         const mac_metrics_t& mac = m.stack.mac[cc];
+         return mac.nof_tti > 0 ? mac.rx_brate / (mac.nof_tti * 1e-3) : 0.0;
+       }},
+      {"cc_ul_bitrate_bps", "UL MAC bitrate of the carrier in the last period",
+       [](const ue_metrics_t& m, uint32_t cc) {
+         const mac_metrics_t& mac = m.stack.mac[cc];
+         return mac.nof_tti > 0 ? mac.tx_brate / (mac.nof_tti * 1e-3) : 0.0;
+       }},
+  };
+  for (const cc_gauge_t& g : cc_gauges) {
+    w.family(g.name, "gauge", g.help);
+    for (uint32_t cc = 0; cc < nof_cc; cc++) {
+      w.sample(cc_label(cc, metrics.phy.info[cc]), g.get(metrics, cc));
+    }
+  }
+
+  struct cc_counter_t {
+    const char* name;
+    const char* help;
+    uint64_t cc_totals_t::*total;
+  };
+  static const cc_counter_t cc_counters[] = {
+      {"cc_dl_pkts_total", "DL transport blocks received in the carrier", &cc_totals_t::dl_pkts},
+      {"cc_dl_errors_total", "DL transport blocks of the carrier with CRC errors", &cc_totals_t::dl_errors},
+      {"cc_dl_bytes_total", "Correctly received DL MAC bytes of the carrier", &cc_totals_t::dl_bytes},
+      {"cc_ul_pkts_total", "UL transport blocks sent in the carrier", &cc_totals_t::ul_pkts},
+      {"cc_ul_errors_total", "UL transport blocks of the carrier not acknowledged", &cc_totals_t::ul_errors},
+      {"cc_ul_bytes_total", "Acknowledged UL MAC bytes of the carrier", &cc_totals_t::ul_bytes},
+  };
+  for (const cc_counter_t& c : cc_counters) {
+    w.family(c.name, "counter", c.help);
+    for (uint32_t cc = 0; cc < nof_cc; cc++) {
+      w.sample(cc_label(cc, metrics.phy.info[cc]), cc_totals[cc].*c.total);
+    }
+  }
+
+  // Bearers, those without any traffic so far are left out
+  struct bearer_counter_t {
+    const char* name;
+    const char* help;
+    double (*get)(const srslte::rlc_bearer_metrics_t&);
+  };
+  static const bearer_counter_t bearer_counters[] = {
+      {"bearer_tx_sdus_total", "RLC SDUs sent in the bearer",
+       [](const srslte::rlc_bearer_metrics_t& b) { return (double)b.num_tx_sdus; }},
+      {"bearer_rx_sdus_total", "RLC SDUs received in the bearer",
+       [](const srslte::rlc_bearer_metrics_t& b) { return (double)b.num_rx_sdus; }},
+      {"bearer_tx_sdu_bytes_total", "RLC SDU bytes sent in the bearer",
+       [](const srslte::rlc_bearer_metrics_t& b) { return (double)b.num_tx_sdu_bytes; }},
+      {"bearer_rx_sdu_bytes_total", "RLC SDU bytes received in the bearer",
+       [](const srslte::rlc_bearer_metrics_t& b) { return (double)b.num_rx_sdu_bytes; }},
+      {"bearer_lost_sdus_total", "RLC SDUs dropped at Tx in the bearer",
+       [](const srslte::rlc_bearer_metrics_t& b) { return (double)b.num_lost_sdus; }},
+      {"bearer_tx_pdus_total", "RLC PDUs sent in the bearer",
+       [](const srslte::rlc_bearer_metrics_t& b) { return (double)b.num_tx_pdus; }},
+      {"bearer_rx_pdus_total", "RLC PDUs received in the bearer",
+       [](const srslte::rlc_bearer_metrics_t& b) { return (double)b.num_rx_pdus; }},
+      {"bearer_lost_pdus_total", "RLC PDUs lost at Rx in the bearer",
+       [](const srslte::rlc_bearer_metrics_t& b) { return (double)b.num_lost_pdus; }},
+  };
+  for (const bearer_counter_t& c : bearer_counters) {
+    w.family(c.name, "counter", c.help);
+    for (uint32_t lcid = 0; lcid < SRSLTE_N_RADIO_BEARERS; lcid++) {
+      const srslte::rlc_bearer_metrics_t& t = rlc_totals.bearer[lcid];
+      if (t.num_tx_pdus > 0 or t.num_rx_pdus > 0) {
+        w.sample(lcid_label(lcid), c.get(t));
+      }
+    }
+  }
+
+  // Latencies of the last period, left out when nothing was observed
+  struct bearer_latency_t {
+    const char* name;
+    const char* help;
+    srslte::latency_stats_t srslte::rlc_bearer_metrics_t::*stats;
+  };
+  static const bearer_latency_t bearer_latencies[] = {
+      {"bearer_ul_upper_delay", " time of the UL SDUs of the bearer from their reception by the GW until RLC",
+       &srslte::rlc_bearer_metrics_t::upper_delay},
+      {"bearer_ul_queue_delay", " time of the UL SDUs of the bearer in the RLC queue",
+       &srslte::rlc_bearer_metrics_t::queue_delay},
+  };
+  for (const bearer_latency_t& l : bearer_latencies) {
+    for (const latency_quantile_t& q : latency_quantiles) {
+      w.family((std::string(l.name) + q.suffix).c_str(), "gauge", (std::string(q.help) + l.help).c_str());
+      for (uint32_t lcid = 0; lcid < SRSLTE_N_RADIO_BEARERS; lcid++) {
+        const srslte::latency_stats_t& stats = metrics.stack.rlc.bearer[lcid].*l.stats;
+        if (stats.count > 0) {
+          w.sample(lcid_label(lcid), stats.*q.value * 1e-6);
+        }
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  last_report = std::move(w.str());
+}
+
+std::string metrics_prometheus::scrape()
+{
+  std::string text;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    text = last_report;
+  }
+  srslte::thread_metrics::write_openmetrics("srsue_", text);
+  srslte::thread_metrics::write_thread_cpu_time("srsue_", text);
+  srslte::thread_metrics::write_memory_usage("srsue_", text);
+  return text;
+}
+
+} // namespace srsue
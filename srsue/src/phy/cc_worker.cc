@@ -19,6 +19,7 @@
  *
  */
 
+#include "srslte/common/tti_trace.h"
 #include "srslte/srslte.h"
 
 #include "srsue/hdr/phy/cc_worker.h"
@@ -99,6 +100,17 @@ cc_worker::cc_worker(uint32_t cc_idx_, uint32_t max_prb, srsue::phy_common* phy_
     ue_dl.pdsch.llr_is_8bit        = true;
     ue_dl.pdsch.dl_sch.llr_is_8bit = true;
   }
+
+  if (phy->args->pdsch_c16_storage) {
+    if (srslte_ue_dl_set_c16_storage(&ue_dl, true)) {
+      Error("Allocating int16 PDSCH grids\n");
+      return;
+    }
+  }
+
+  if (phy->pdsch_cb_pool != nullptr) {
+    srslte_sch_set_cb_pool(&ue_dl.pdsch.dl_sch, phy->pdsch_cb_pool);
+  }
 }
 
 cc_worker::~cc_worker()
@@ -224,6 +236,17 @@ bool cc_worker::work_dl_regular()
     return false;
   }
 
+  // In RRC_IDLE the stack only searches the P-RNTI in the paging occasions, skip the FFT and estimation in between
+  if (phy->args->idle_drx && cc_idx == 0 && phy->stack->get_dl_sched_rnti(CURRENT_TTI) == SRSLTE_INVALID_RNTI &&
+      phy->stack->get_ul_sched_rnti(CURRENT_TTI) == SRSLTE_INVALID_RNTI) {
+    return false;
+  }
+
+  // Outside the DRX Active Time the PDCCH is not monitored, the subframe is only processed for a pending PHICH
+  if (!phy->stack->is_drx_active_time(CURRENT_TTI) && !phy->is_ul_pending_ack(CURRENT_TTI, cc_idx)) {
+    return false;
+  }
+
   sf_cfg_dl.sf_type = SRSLTE_SF_NORM;
 
   // Set default channel estimation
@@ -249,13 +272,21 @@ bool cc_worker::work_dl_regular()
     }
 
     /* Do FFT and extract PDCCH LLR, or quit if no actions are required in this subframe */
-    if (srslte_ue_dl_decode_fft_estimate(&ue_dl, &sf_cfg_dl, &ue_dl_cfg) < 0) {
-      Error("Getting PDCCH FFT estimate\n");
-      return false;
+    {
+      srslte::tti_span span(srslte::tti_stage::fft);
+      srslte_ue_dl_decode_fft(&ue_dl, &sf_cfg_dl);
+    }
+    {
+      srslte::tti_span span(srslte::tti_stage::chest);
+      if (srslte_ue_dl_estimate(&ue_dl, &sf_cfg_dl, &ue_dl_cfg) < 0) {
+        Error("Getting PDCCH FFT estimate\n");
+        return false;
+      }
     }
 
     /* Look for DL and UL dci(s) if this is PCell, or no cross-carrier scheduling is enabled */
     if ((cc_idx == 0) || (!ue_dl_cfg.cfg.dci.cif_present)) {
+      srslte::tti_span span(srslte::tti_stage::pdcch_decode);
       found_dl_grant = decode_pdcch_dl() > 0;
       decode_pdcch_ul();
     }
@@ -450,6 +481,7 @@ int cc_worker::decode_pdsch(srslte_pdsch_ack_resource_t            ack_resource,
 
   // Run PDSCH decoder
   if (decode_enable) {
+    srslte::tti_span span(srslte::tti_stage::pdsch_decode);
     if (srslte_ue_dl_decode_pdsch(&ue_dl, &sf_cfg_dl, &ue_dl_cfg.cfg.pdsch, pdsch_dec)) {
       Error("ERROR: Decoding PDSCH\n");
     }
@@ -541,26 +573,34 @@ int cc_worker::decode_pmch(mac_interface_phy_lte::tb_action_dl_t* action, srslte
 
 void cc_worker::decode_phich()
 {
-  srslte_dci_ul_t      dci_ul      = {};
-  srslte_phich_grant_t phich_grant = {};
-  srslte_phich_res_t   phich_res   = {};
+  srslte_dci_ul_t      dci_ul[SRSLTE_UE_DL_MAX_PHICH]      = {};
+  srslte_phich_grant_t phich_grant[SRSLTE_UE_DL_MAX_PHICH] = {};
+  srslte_phich_res_t   phich_res[SRSLTE_UE_DL_MAX_PHICH]   = {};
+  uint32_t             nof_phich                           = 0;
 
-  // Receive PHICH, in TDD might be more than one
-  for (uint32_t I_phich = 0; I_phich < 2; I_phich++) {
-    phich_grant.I_phich = I_phich;
-    if (phy->get_ul_pending_ack(&sf_cfg_dl, cc_idx, &phich_grant, &dci_ul)) {
-      if (srslte_ue_dl_decode_phich(&ue_dl, &sf_cfg_dl, &ue_dl_cfg, &phich_grant, &phich_res)) {
-        Error("Decoding PHICH\n");
-      }
-      phy->set_ul_received_ack(&sf_cfg_dl, cc_idx, phich_res.ack_value, I_phich, &dci_ul);
-      Info("PHICH: hi=%d, corr=%.1f, I_lowest=%d, n_dmrs=%d, I_phich=%d\n",
-           phich_res.ack_value,
-           phich_res.distance,
-           phich_grant.n_prb_lowest,
-           phich_grant.n_dmrs,
-           I_phich);
+  // Receive PHICH, in TDD might be more than one. All of them are decoded at once, sharing the PHICH group equalization
+  for (uint32_t I_phich = 0; I_phich < SRSLTE_UE_DL_MAX_PHICH; I_phich++) {
+    phich_grant[nof_phich].I_phich = I_phich;
+    if (phy->get_ul_pending_ack(&sf_cfg_dl, cc_idx, &phich_grant[nof_phich], &dci_ul[nof_phich])) {
+      nof_phich++;
     }
   }
+  if (nof_phich == 0) {
+    return;
+  }
+
+  if (srslte_ue_dl_decode_phich_batch(&ue_dl, &sf_cfg_dl, &ue_dl_cfg, phich_grant, nof_phich, phich_res)) {
+    Error("Decoding PHICH\n");
+  }
+  for (uint32_t i = 0; i < nof_phich; i++) {
+    phy->set_ul_received_ack(&sf_cfg_dl, cc_idx, phich_res[i].ack_value, phich_grant[i].I_phich, &dci_ul[i]);
+    Info("PHICH: hi=%d, corr=%.1f, I_lowest=%d, n_dmrs=%d, I_phich=%d\n",
+         phich_res[i].ack_value,
+         phich_res[i].distance,
+         phich_grant[i].n_prb_lowest,
+         phich_grant[i].n_dmrs,
+         phich_grant[i].I_phich);
+  }
 }
 
 void cc_worker::update_measurements(std::vector<rrc_interface_phy_lte::phy_meas_t>& serving_cells,
@@ -703,7 +743,7 @@ int cc_worker::decode_pdcch_ul()
 
   uint16_t ul_rnti = phy->stack->get_ul_sched_rnti(CURRENT_TTI);
 
-  if (ul_rnti) {
+  if (ul_rnti && phy->stack->is_drx_active_time(CURRENT_TTI)) {
     /* Blind search first without cross scheduling then with it if enabled */
     for (int i = 0; i < (ue_dl_cfg.cfg.dci.cif_present ? 2 : 1) && !nof_grants; i++) {
       ue_dl_cfg.cfg.dci.cif_enabled = i > 0;
@@ -767,7 +807,9 @@ bool cc_worker::encode_uplink(mac_interface_phy_lte::tb_action_ul_t* action, srs
   ue_ul_cfg.ul_cfg.pucch.rnti = phy->stack->get_ul_sched_rnti(CURRENT_TTI_TX);
 
   // Encode signal
-  int ret = srslte_ue_ul_encode(&ue_ul, &sf_cfg_ul, &ue_ul_cfg, &data);
+  srslte::tti_span encode_span(srslte::tti_stage::pusch_encode);
+  int              ret = srslte_ue_ul_encode(&ue_ul, &sf_cfg_ul, &ue_ul_cfg, &data);
+  encode_span.stop();
   if (ret < 0) {
     Error("Encoding UL cc=%d\n", cc_idx);
   }
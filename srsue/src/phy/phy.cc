@@ -114,9 +114,7 @@ int phy::init(const phy_args_t& args_, stack_interface_phy_lte* stack_, srslte::
   stack = stack_;
   radio = radio_;
 
-  init(args_);
-
-  return SRSLTE_SUCCESS;
+  return init(args_);
 }
 
 int phy::init(const phy_args_t& args_)
@@ -126,6 +124,12 @@ int phy::init(const phy_args_t& args_)
 
   args = args_;
 
+  // A subframe is transmitted FDD_HARQ_DELAY_DL_MS after its reception, no more workers than that can be in flight
+  if (args.nof_phy_threads > FDD_HARQ_DELAY_DL_MS) {
+    srslte::console("Using %d PHY threads, the HARQ delay is %d ms\n", FDD_HARQ_DELAY_DL_MS, FDD_HARQ_DELAY_DL_MS);
+    args.nof_phy_threads = FDD_HARQ_DELAY_DL_MS;
+  }
+
   // Force frequency if given as argument
   if (args.dl_freq > 0 && args.ul_freq > 0) {
     sfsync.force_freq(args.dl_freq, args.ul_freq);
@@ -159,7 +163,16 @@ int phy::init(const phy_args_t& args_)
   log_h = log_vec.at(0).get();
 
   if (!check_args(args)) {
-    return false;
+    return SRSLTE_ERROR;
+  }
+
+  // All workers and carriers share the PDSCH codeblock decoders
+  if (args.pdsch_cb_workers > 0) {
+    if (srslte_sch_cb_pool_init(&pdsch_cb_pool, args.pdsch_cb_workers)) {
+      log_h->error("Initiating PDSCH codeblock decoder pool\n");
+      return SRSLTE_ERROR;
+    }
+    pdsch_cb_pool_ready = true;
   }
 
   nof_workers = args.nof_phy_threads;
@@ -172,7 +185,7 @@ int phy::init(const phy_args_t& args_)
 
   is_configured = false;
   start();
-  return true;
+  return SRSLTE_SUCCESS;
 }
 
 // Initializes PHY in a thread
@@ -181,6 +194,7 @@ void phy::run_thread()
   std::unique_lock<std::mutex> lock(config_mutex);
   prach_buffer.init(SRSLTE_MAX_PRB, log_h);
   common.init(&args, (srslte::log*)log_vec[0].get(), radio, stack, &sfsync);
+  common.pdsch_cb_pool = pdsch_cb_pool_ready ? &pdsch_cb_pool : nullptr;
 
   // Add workers to workers pool and start threads
   for (uint32_t i = 0; i < nof_workers; i++) {
@@ -190,6 +204,15 @@ void phy::run_thread()
     workers.push_back(std::move(w));
   }
 
+  // The worker of each TTI decodes the PCell, the helpers the SCells
+  if (args.nof_cc_helpers > 0 and args.nof_carriers > 1) {
+    uint32_t nof_helpers = std::min(args.nof_cc_helpers, args.nof_carriers - 1);
+    cc_pool.reset(new srslte::task_thread_pool(nof_helpers));
+    cc_pool->start(WORKERS_THREAD_PRIO);
+    common.cc_pool = cc_pool.get();
+    log_h->info("Decoding %d carriers in parallel with %d helper threads\n", args.nof_carriers, nof_helpers);
+  }
+
   // Warning this must be initialized after all workers have been added to the pool
   sfsync.init(radio,
               stack,
@@ -230,11 +253,18 @@ void phy::stop()
   if (is_configured) {
     sfsync.stop();
     workers_pool.stop();
+    if (cc_pool != nullptr) {
+      cc_pool->stop();
+    }
     prach_buffer.stop();
     wait_thread_finish();
 
     is_configured = false;
   }
+  if (pdsch_cb_pool_ready) {
+    srslte_sch_cb_pool_free(&pdsch_cb_pool);
+    pdsch_cb_pool_ready = false;
+  }
 }
 
 void phy::get_metrics(phy_metrics_t* m)
@@ -22,6 +22,7 @@
 #include <sstream>
 #include <string.h>
 
+#include "srslte/common/tti_trace.h"
 #include "srslte/srslte.h"
 #include "srsue/hdr/phy/phy_common.h"
 
@@ -78,6 +79,7 @@ void phy_common::init(phy_args_t*                  _args,
 void phy_common::set_ue_dl_cfg(srslte_ue_dl_cfg_t* ue_dl_cfg)
 {
   ue_dl_cfg->snr_to_cqi_offset = args->snr_to_cqi_offset;
+  ue_dl_cfg->pmi_max_age       = args->pmi_max_age;
 
   srslte_chest_dl_cfg_t* chest_cfg = &ue_dl_cfg->chest_cfg;
 
@@ -104,13 +106,20 @@ void phy_common::set_ue_dl_cfg(srslte_ue_dl_cfg_t* ue_dl_cfg)
   chest_cfg->sync_error_enable = args->correct_sync_error;
   chest_cfg->estimator_alg =
       args->interpolate_subframe_enabled ? SRSLTE_ESTIMATOR_ALG_INTERPOLATE : SRSLTE_ESTIMATOR_ALG_AVERAGE;
+  if (args->wiener_enabled) {
+    chest_cfg->estimator_alg = SRSLTE_ESTIMATOR_ALG_WIENER;
+    chest_cfg->wiener_mode =
+        args->wiener_filter_bank ? SRSLTE_WIENER_DL_MODE_FILTER_BANK : SRSLTE_WIENER_DL_MODE_ADAPTIVE;
+  }
   chest_cfg->cfo_estimate_enable  = args->cfo_ref_mask != 0;
   chest_cfg->cfo_estimate_sf_mask = args->cfo_ref_mask;
+  chest_cfg->crs_residual_enable  = args->pdsch_irc_enabled;
 }
 
 void phy_common::set_pdsch_cfg(srslte_pdsch_cfg_t* pdsch_cfg)
 {
   pdsch_cfg->csi_enable         = args->pdsch_csi_enabled;
+  pdsch_cfg->irc_enable         = args->pdsch_irc_enabled;
   pdsch_cfg->max_nof_iterations = args->pdsch_max_its;
   pdsch_cfg->meas_evm_en        = args->meas_evm;
   pdsch_cfg->decoder_type       = (args->equalizer_mode == "zf") ? SRSLTE_MIMO_DECODER_ZF : SRSLTE_MIMO_DECODER_MMSE;
@@ -321,6 +330,14 @@ bool phy_common::is_any_ul_pending_ack()
   return false;
 }
 
+// Here TTI is the DL subframe in which the PHICH is received
+bool phy_common::is_ul_pending_ack(uint32_t tti, uint32_t cc_idx)
+{
+  std::lock_guard<std::mutex> lock(pending_ul_ack_mutex);
+
+  return pending_ul_ack[cc_idx][0][tti].enable or pending_ul_ack[cc_idx][1][tti].enable;
+}
+
 // Computes SF->TTI at which PUSCH will be transmitted according to Section 8 of 36.213
 #define tti_pusch_hi(sf)                                                                                               \
   (sf->tti +                                                                                                           \
@@ -569,6 +586,11 @@ void phy_common::worker_end(void*                   tx_sem_id,
       ul_channel->run(buffer.to_cf_t(), buffer.to_cf_t(), buffer.get_nof_samples(), tx_time.get(0));
     }
 
+    if (watchdog != nullptr) {
+      watchdog->tx_ready(srslte::tti_trace::get_thread_tti(), tx_time.get(0));
+    }
+
+    srslte::tti_span span(srslte::tti_stage::rf_send);
     radio_h->tx(buffer, tx_time);
   } else {
     if (radio_h->is_continuous_tx()) {
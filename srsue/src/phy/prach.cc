@@ -43,13 +43,11 @@ void prach::init(uint32_t max_prb, srslte::log* log_h_)
 {
   log_h = log_h_;
 
-  for (auto& i : buffer) {
-    for (auto& j : i) {
-      j = srslte_vec_cf_malloc(SRSLTE_PRACH_MAX_LEN);
-      if (!j) {
-        perror("malloc");
-        return;
-      }
+  for (auto& e : preamble_cache) {
+    e.samples = srslte_vec_cf_malloc(SRSLTE_PRACH_MAX_LEN);
+    if (!e.samples) {
+      perror("malloc");
+      return;
     }
   }
 
@@ -80,10 +78,9 @@ void prach::stop()
     return;
   }
 
-  for (auto& i : buffer) {
-    for (auto& j : i) {
-      free(j);
-    }
+  for (auto& e : preamble_cache) {
+    free(e.samples);
+    e.samples = nullptr;
   }
 
   free(signal_buffer);
@@ -130,7 +127,7 @@ bool prach::set_cell(srslte_cell_t cell_, srslte_prach_cfg_t prach_cfg)
     return false;
   }
 
-  buffer_bitmask.reset();
+  clear_preamble_cache();
   len             = prach_obj.N_seq + prach_obj.N_cp;
   transmitted_tti = -1;
   cell_initiated  = true;
@@ -138,10 +135,27 @@ bool prach::set_cell(srslte_cell_t cell_, srslte_prach_cfg_t prach_cfg)
   return true;
 }
 
-bool prach::generate_buffer(uint32_t f_idx)
+void prach::clear_preamble_cache()
 {
-  if (is_buffer_generated(f_idx, preamble_idx)) {
-    return true;
+  for (auto& e : preamble_cache) {
+    e.preamble_idx = -1;
+    e.last_used    = 0;
+  }
+  cache_clock = 0;
+}
+
+cf_t* prach::get_preamble(uint32_t f_idx)
+{
+  // Look for the preamble in the cache, otherwise take the least recently used entry
+  cached_preamble_t* victim = &preamble_cache[0];
+  for (auto& e : preamble_cache) {
+    if (e.preamble_idx == preamble_idx && e.f_idx == f_idx) {
+      e.last_used = ++cache_clock;
+      return e.samples;
+    }
+    if (e.preamble_idx < 0 || (victim->preamble_idx >= 0 && e.last_used < victim->last_used)) {
+      victim = &e;
+    }
   }
 
   uint32_t freq_offset = cfg.freq_offset;
@@ -149,14 +163,17 @@ bool prach::generate_buffer(uint32_t f_idx)
     freq_offset = srslte_prach_f_ra_tdd(
         cfg.config_idx, cfg.tdd_config.sf_config, (f_idx / 6) * 10, f_idx % 6, cfg.freq_offset, cell.nof_prb);
   }
-  if (srslte_prach_gen(&prach_obj, preamble_idx, freq_offset, buffer[f_idx][preamble_idx])) {
+  if (srslte_prach_gen(&prach_obj, preamble_idx, freq_offset, victim->samples)) {
     Error("Generating PRACH preamble %d\n", preamble_idx);
-    return false;
+    victim->preamble_idx = -1;
+    return nullptr;
   }
 
-  set_buffer_as_generated(f_idx, preamble_idx);
+  victim->f_idx        = f_idx;
+  victim->preamble_idx = preamble_idx;
+  victim->last_used    = ++cache_clock;
 
-  return true;
+  return victim->samples;
 }
 
 bool prach::prepare_to_send(uint32_t preamble_idx_, int allowed_subframe_, float target_power_dbm_)
@@ -237,17 +254,13 @@ cf_t* prach::generate(float cfo, uint32_t* nof_sf, float* target_power)
     }
   }
 
-  if (!generate_buffer(f_idx)) {
-    return nullptr;
-  }
-
-  if (!is_buffer_generated(f_idx, preamble_idx)) {
-    Error("PRACH Buffer not generated: f_idx=%d preamble_idx=%d\n", f_idx, preamble_idx);
+  cf_t* preamble = get_preamble(f_idx);
+  if (preamble == nullptr) {
     return nullptr;
   }
 
   // Correct CFO before transmission
-  srslte_cfo_correct(&cfo_h, buffer[f_idx][preamble_idx], signal_buffer, cfo / srslte_symbol_sz(cell.nof_prb));
+  srslte_cfo_correct(&cfo_h, preamble, signal_buffer, cfo / srslte_symbol_sz(cell.nof_prb));
 
   // pad guard symbols with zeros
   uint32_t nsf = (len - 1) / SRSLTE_SF_LEN_PRB(cell.nof_prb) + 1;
@@ -177,7 +177,9 @@ void intra_measure::measure_proc()
 
   new_cell_itf->cell_meas_reset(cc_idx);
 
-  // Use Cell Reference signal to measure cells in the time domain for all known active PCI
+  // Use Cell Reference signal to measure cells in the time domain for all known active PCI. The FFT of the buffer
+  // subframes used by the peak search is done once and shared by all the PCIs
+  srslte_refsignal_dl_sync_set_buffer(&refsignal_dl_sync, search_buffer, intra_freq_meas_len_ms * current_sflen);
   for (auto id : cells_to_measure) {
     // Do not measure serving cell here since it's measured by workers
     if (id == serving_cell.id) {
@@ -215,6 +217,7 @@ void intra_measure::measure_proc()
   }
 
   // Inform that measurement has finished
+  nof_meas++;
   meas_sync.increase();
 }
 
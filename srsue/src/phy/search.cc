@@ -86,6 +86,12 @@ float search::get_last_cfo()
   return srslte_ue_sync_get_cfo(&ue_mib_sync.ue_sync);
 }
 
+void search::set_cs_opts(uint32_t prescreen_frames, float prescreen_min_psr, float early_exit_psr)
+{
+  srslte_ue_cellsearch_set_prescreen(&cs, prescreen_frames, prescreen_min_psr);
+  srslte_ue_cellsearch_set_early_exit(&cs, early_exit_psr);
+}
+
 void search::set_agc_enable(bool enable)
 {
   if (enable) {
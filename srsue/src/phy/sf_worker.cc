@@ -19,6 +19,8 @@
  *
  */
 
+#include "srslte/common/thread_metrics.h"
+#include "srslte/common/tti_trace.h"
 #include "srslte/interfaces/ue_interfaces.h"
 #include "srslte/srslte.h"
 
@@ -188,28 +190,19 @@ void sf_worker::work_imp()
     return;
   }
 
+  srslte::tti_trace::set_thread_tti(tti);
+  srslte::tti_span            worker_span(srslte::tti_stage::worker);
+  srslte::thread_metric_timer worker_timer(srslte::thread_metric::phy_worker_time_us);
+
   bool     rx_signal_ok    = false;
   bool     tx_signal_ready = false;
   uint32_t nof_samples     = SRSLTE_SF_LEN_PRB(cell.nof_prb);
 
   /***** Downlink Processing *******/
 
-  // Loop through all carriers. carrier_idx=0 is PCell
-  for (uint32_t carrier_idx = 0; carrier_idx < cc_workers.size(); carrier_idx++) {
-
-    // Process all DL and special subframes
-    if (srslte_sfidx_tdd_type(tdd_config, tti % 10) != SRSLTE_TDD_SF_U || cell.frame_type == SRSLTE_FDD) {
-      srslte_mbsfn_cfg_t mbsfn_cfg;
-      ZERO_OBJECT(mbsfn_cfg);
-
-      if (carrier_idx == 0 && phy->is_mbsfn_sf(&mbsfn_cfg, tti)) {
-        cc_workers[0]->work_dl_mbsfn(mbsfn_cfg); // Don't do chest_ok in mbsfn since it trigger measurements
-      } else {
-        if ((carrier_idx == 0) || (phy->scell_cfg[carrier_idx].enabled && phy->scell_cfg[carrier_idx].configured)) {
-          rx_signal_ok = cc_workers[carrier_idx]->work_dl_regular();
-        }
-      }
-    }
+  // Process all DL and special subframes
+  if (srslte_sfidx_tdd_type(tdd_config, tti % 10) != SRSLTE_TDD_SF_U || cell.frame_type == SRSLTE_FDD) {
+    rx_signal_ok = work_dl();
   }
 
   /***** Uplink Generation + Transmission *******/
@@ -256,6 +249,8 @@ void sf_worker::work_imp()
   }
 
   // Call worker_end to transmit the signal
+  worker_span.stop();
+  worker_timer.stop();
   phy->worker_end(this, tx_signal_ready, tx_signal_ptr, tx_time);
 
   if (rx_signal_ok) {
@@ -270,6 +265,67 @@ void sf_worker::work_imp()
 #endif
 }
 
+/* Decodes all the carriers, carrier_idx=0 is PCell. With the helper threads enabled, the SCells are decoded by them
+ * while this worker decodes the PCell, and all are joined before the UL generation. Returns whether the signal of the
+ * last carrier decoded was received correctly */
+bool sf_worker::work_dl()
+{
+  std::array<bool, SRSLTE_MAX_CARRIERS> dl_done = {};
+  std::array<bool, SRSLTE_MAX_CARRIERS> dl_ok   = {};
+
+  for (uint32_t carrier_idx = 1; carrier_idx < cc_workers.size(); carrier_idx++) {
+    if (not(phy->scell_cfg[carrier_idx].enabled && phy->scell_cfg[carrier_idx].configured)) {
+      continue;
+    }
+    dl_done[carrier_idx] = true;
+    if (phy->cc_pool == nullptr) {
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(cc_mutex);
+      nof_cc_running++;
+    }
+    phy->cc_pool->push_task([this, carrier_idx, &dl_ok](uint32_t worker_id) {
+      srslte::tti_trace::set_thread_tti(tti);
+      dl_ok[carrier_idx] = cc_workers[carrier_idx]->work_dl_regular();
+      std::lock_guard<std::mutex> lock(cc_mutex);
+      if (--nof_cc_running == 0) {
+        cc_cvar.notify_one();
+      }
+    });
+  }
+
+  srslte_mbsfn_cfg_t mbsfn_cfg;
+  ZERO_OBJECT(mbsfn_cfg);
+  if (phy->is_mbsfn_sf(&mbsfn_cfg, tti)) {
+    cc_workers[0]->work_dl_mbsfn(mbsfn_cfg); // Don't do chest_ok in mbsfn since it trigger measurements
+  } else {
+    dl_done[0] = true;
+    dl_ok[0]   = cc_workers[0]->work_dl_regular();
+  }
+
+  if (phy->cc_pool == nullptr) {
+    for (uint32_t carrier_idx = 1; carrier_idx < cc_workers.size(); carrier_idx++) {
+      if (dl_done[carrier_idx]) {
+        dl_ok[carrier_idx] = cc_workers[carrier_idx]->work_dl_regular();
+      }
+    }
+  } else {
+    std::unique_lock<std::mutex> lock(cc_mutex);
+    while (nof_cc_running > 0) {
+      cc_cvar.wait(lock);
+    }
+  }
+
+  bool rx_signal_ok = false;
+  for (uint32_t carrier_idx = 0; carrier_idx < cc_workers.size(); carrier_idx++) {
+    if (dl_done[carrier_idx]) {
+      rx_signal_ok = dl_ok[carrier_idx];
+    }
+  }
+  return rx_signal_ok;
+}
+
 /********************* Uplink common control functions ****************************/
 
 void sf_worker::reset_uci(srslte_uci_data_t* uci_data)
@@ -21,6 +21,7 @@
 
 #include "srsue/hdr/phy/sync.h"
 #include "srslte/common/log.h"
+#include "srslte/common/tti_trace.h"
 #include "srslte/phy/channel/channel.h"
 #include "srslte/srslte.h"
 #include "srsue/hdr/phy/sf_worker.h"
@@ -93,6 +94,9 @@ void sync::init(srslte::radio_interface_phy* _radio,
 
   // Initialize cell searcher
   search_p.init(sf_buffer, log_h, nof_rf_channels, this);
+  search_p.set_cs_opts(worker_com->args->cs_prescreen_frames,
+                       worker_com->args->cs_prescreen_min_psr,
+                       worker_com->args->cs_early_exit_psr);
 
   // Initialize SFN synchronizer, it uses only pcell buffer
   sfn_p.init(&ue_sync, worker_com->args, sf_buffer, sf_buffer.size(), log_h);
@@ -103,6 +107,7 @@ void sync::init(srslte::radio_interface_phy* _radio,
     q->init(i, worker_com, this, log_h);
     intra_freq_meas.push_back(std::unique_ptr<scell::intra_measure>(q));
   }
+  meas_carriers.resize(intra_freq_meas.size());
 
   // Allocate Secondary serving cell synchronization
   for (uint32_t i = 1; i < worker_com->args->nof_carriers; i++) {
@@ -110,6 +115,9 @@ void sync::init(srslte::radio_interface_phy* _radio,
     scell_sync[i] = std::unique_ptr<scell::sync>(new scell::sync(this, i * worker_com->args->nof_rx_ant));
   }
 
+  watchdog.init(worker_com->args->deadline_watchdog, log_h);
+  worker_com->watchdog = &watchdog;
+
   reset();
   running = true;
 
@@ -137,6 +145,7 @@ void sync::stop()
   }
   running = false;
   wait_thread_finish();
+  watchdog.stop();
 }
 
 void sync::reset()
@@ -488,7 +497,7 @@ void sync::run_camping_in_sync_state(sf_worker* worker, srslte::rf_buffer_t& syn
 
   worker->set_tti(tti);
 
-  // Compute TX time: Any transmission happens in TTI+4 thus advance 4 ms the reception time
+  // Compute TX time: Any transmission happens FDD_HARQ_DELAY_DL_MS after the reception
   last_rx_time.add(FDD_HARQ_DELAY_DL_MS * 1e-3);
   worker->set_tx_time(last_rx_time);
 
@@ -734,6 +743,7 @@ void sync::set_ue_sync_opts(srslte_ue_sync_t* q, float cfo)
   // Set SFO ema and correct period
   srslte_ue_sync_set_sfo_correct_period(q, worker_com->args->sfo_correct_period);
   srslte_ue_sync_set_sfo_ema(q, worker_com->args->sfo_ema);
+  srslte_ue_sync_set_track_max_period(q, worker_com->args->pss_track_max_period);
 
   sss_alg_t sss_alg = SSS_FULL;
   if (!worker_com->args->sss_algorithm.compare("diff")) {
@@ -889,9 +899,14 @@ int sync::radio_recv_fnc(srslte::rf_buffer_t& data, srslte_timestamp_t* rx_time)
   srslte::rf_timestamp_t& rf_timestamp = (rx_time == nullptr) ? dummy_ts : last_rx_time;
 
   // Receive
+  srslte::tti_span recv_span(srslte::tti_stage::rf_recv, TTI_ADD(tti, 1));
   if (not radio_h->rx_now(data, rf_timestamp)) {
     return SRSLTE_ERROR;
   }
+  recv_span.stop();
+  if (rx_time != nullptr and phy_state.is_camping()) {
+    watchdog.rx_done(TTI_ADD(tti, 1), rf_timestamp.get(0));
+  }
 
   srslte_timestamp_t dummy_flat_ts = {};
 
@@ -924,6 +939,7 @@ int sync::radio_recv_fnc(srslte::rf_buffer_t& data, srslte_timestamp_t* rx_time)
       // Update RX gain
       intra_freq_meas[i]->set_rx_gain_offset(worker_com->get_rx_gain_offset());
     }
+    multiplex_meas();
   }
 
   log_h->debug("SYNC:  received %d samples from radio\n", data.get_nof_samples());
@@ -984,18 +1000,36 @@ void sync::set_rx_gain(float gain)
 void sync::set_inter_frequency_measurement(uint32_t cc_idx, uint32_t earfcn_, srslte_cell_t cell_)
 {
   if (cc_idx < intra_freq_meas.size()) {
+    // Take the carrier out of the multiplexed measurement before the SCell tunes it
+    std::lock_guard<std::mutex> lock(multiplexed_meas_mutex);
+    meas_carriers[cc_idx].earfcn = 0;
+    meas_carriers[cc_idx].scell  = true;
     intra_freq_meas[cc_idx]->set_primary_cell(earfcn_, cell_);
   }
 }
 void sync::set_cells_to_meas(uint32_t earfcn_, const std::set<uint32_t>& pci)
 {
-  bool found = false;
+  std::lock_guard<std::mutex> lock(multiplexed_meas_mutex);
+  bool                        found = false;
   for (size_t i = 0; i < intra_freq_meas.size() and not found; i++) {
-    if (earfcn_ == intra_freq_meas[i]->get_earfcn()) {
+    bool own_carrier = i == 0 or meas_carriers[i].scell or worker_com->scell_cfg[i].configured;
+    if (own_carrier and earfcn_ == intra_freq_meas[i]->get_earfcn()) {
       intra_freq_meas[i]->set_cells_to_meas(pci);
       found = true;
     }
   }
+  for (size_t i = 1; i < intra_freq_meas.size() and not found; i++) {
+    if (not meas_carriers[i].scell and not worker_com->scell_cfg[i].configured) {
+      log_h->info("Neighbour cell measurement of EARFCN=%d multiplexed on the carriers without SCell\n", earfcn_);
+      multiplexed_meas[earfcn_] = pci;
+      found                     = true;
+    }
+  }
+  for (size_t i = 1; i < meas_carriers.size(); i++) {
+    if (meas_carriers[i].earfcn == earfcn_ and multiplexed_meas.count(earfcn_) > 0) {
+      intra_freq_meas[i]->set_cells_to_meas(pci);
+    }
+  }
   if (!found) {
     log_h->error("Neighbour cell measurement not supported in secondary carrier. EARFCN=%d\n", earfcn_);
   }
@@ -1003,11 +1037,75 @@ void sync::set_cells_to_meas(uint32_t earfcn_, const std::set<uint32_t>& pci)
 
 void sync::meas_stop()
 {
+  std::lock_guard<std::mutex> lock(multiplexed_meas_mutex);
+  multiplexed_meas.clear();
+  for (auto& c : meas_carriers) {
+    c = {};
+  }
   for (auto& q : intra_freq_meas) {
     q->meas_stop();
   }
 }
 
+/* Tunes every carrier without SCell that finished measuring its EARFCN to the next multiplexed EARFCN not being
+ * measured by another carrier. Called by the sync thread every subframe, it never blocks on the stack thread */
+void sync::multiplex_meas()
+{
+  std::unique_lock<std::mutex> lock(multiplexed_meas_mutex, std::try_to_lock);
+  if (not lock.owns_lock()) {
+    return;
+  }
+
+  for (uint32_t cc = 1; cc < intra_freq_meas.size(); cc++) {
+    meas_carrier_t&       c = meas_carriers[cc];
+    scell::intra_measure* q = intra_freq_meas[cc].get();
+    if (c.scell or worker_com->scell_cfg[cc].configured) {
+      continue;
+    }
+
+    // Keep measuring the current EARFCN until the measurement finishes
+    bool current = multiplexed_meas.count(c.earfcn) > 0;
+    if (current and q->get_nof_meas() == c.nof_meas) {
+      continue;
+    }
+
+    // Next EARFCN after the current one which is not measured by another carrier
+    uint32_t next = 0;
+    auto     it   = multiplexed_meas.upper_bound(c.earfcn);
+    for (size_t n = 0; n < multiplexed_meas.size() and next == 0; n++, it++) {
+      if (it == multiplexed_meas.end()) {
+        it = multiplexed_meas.begin();
+      }
+      bool busy = false;
+      for (uint32_t other = 1; other < meas_carriers.size(); other++) {
+        busy |= other != cc and meas_carriers[other].earfcn == it->first;
+      }
+      if (not busy) {
+        next = it->first;
+      }
+    }
+
+    if (next == 0 and not current) {
+      if (c.earfcn != 0) {
+        q->meas_stop();
+        c.earfcn = 0;
+      }
+      continue;
+    }
+    if (next == 0 or next == c.earfcn) {
+      // No other EARFCN is waiting, the carrier keeps measuring periodically the current one
+      continue;
+    }
+
+    radio_h->set_rx_freq(cc, srslte_band_fd(next) * 1e6);
+    q->meas_stop();
+    q->set_primary_cell(next, cell);
+    q->set_cells_to_meas(multiplexed_meas[next]);
+    c.earfcn   = next;
+    c.nof_meas = q->get_nof_meas();
+  }
+}
+
 void sync::scell_sync_set(uint32_t cc_idx, const srslte_cell_t& _cell)
 {
   // Ignore if out of range
@@ -0,0 +1,322 @@
+/*
+ * Copyright 2013-2020 Software Radio Systems Limited
+ *
+ * This file is part of srsLTE.
+ *
+ * srsLTE is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsLTE is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsue/hdr/radio_mux.h"
+#include "srslte/phy/utils/vector.h"
+#include <cinttypes>
+#include <cmath>
+
+namespace srsue {
+
+// 20 ms at the highest LTE sample rate
+static const uint32_t ring_len = 20 * 30720;
+
+radio_mux::radio_mux(srslte::logger* logger_) : radio(logger_)
+{
+  log_h.init("RMUX", logger_);
+}
+
+int radio_mux::init(const srslte::rf_args_t& args)
+{
+  if (args.nof_carriers != 1 or args.nof_antennas != 1) {
+    log_h.error("A shared radio supports one carrier with one antenna only\n");
+    return SRSLTE_ERROR;
+  }
+  log_h.set_level(args.log_level);
+
+  rx_ring.resize(ring_len);
+  rx_block.resize(ring_len / 2);
+  tx_ring.resize(ring_len);
+  return radio.init(args, this);
+}
+
+void radio_mux::stop()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  if (radio.is_init()) {
+    radio.tx_end();
+    radio.stop();
+  }
+}
+
+std::unique_ptr<radio_mux::port> radio_mux::create_port()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  ports.emplace_back();
+  return std::unique_ptr<port>(new port(this, ports.size() - 1));
+}
+
+void radio_mux::radio_overflow()
+{
+  for (port_state_t& p : ports) {
+    if (p.active) {
+      p.phy->radio_overflow();
+    }
+  }
+}
+
+void radio_mux::radio_failure()
+{
+  for (port_state_t& p : ports) {
+    if (p.active) {
+      p.phy->radio_failure();
+    }
+  }
+}
+
+uint64_t radio_mux::sample_idx(const srslte_timestamp_t& ts) const
+{
+  srslte_timestamp_t t = ts;
+  srslte_timestamp_sub(&t, ts_zero.full_secs, ts_zero.frac_secs);
+  return (uint64_t)std::max(0L, std::lround(srslte_timestamp_real(&t) * srate));
+}
+
+void radio_mux::sample_time(uint64_t idx, srslte_timestamp_t* ts) const
+{
+  *ts = ts_zero;
+  srslte_timestamp_add(ts, 0, idx / srate);
+}
+
+void radio_mux::set_srate(uint32_t port_idx, double srate_)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  ports[port_idx].srate = srate_;
+
+  double max_srate = 0.0;
+  for (const port_state_t& p : ports) {
+    max_srate = std::max(max_srate, p.active ? p.srate : 0.0);
+  }
+  if (max_srate == srate) {
+    return;
+  }
+
+  // The samples in the ring buffers are lost, all the ports start again from the next received sample
+  log_h.info("Setting sample rate %.2f MHz\n", max_srate / 1e6);
+  srate = max_srate;
+  radio.set_rx_srate(srate);
+  radio.set_tx_srate(srate);
+  rx_head    = 0;
+  tx_head    = 0;
+  tx_started = false;
+  for (port_state_t& p : ports) {
+    p.rx_reset = true;
+  }
+}
+
+void radio_mux::set_rx_freq(uint32_t port_idx, double freq)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  ports[port_idx].rx_freq = freq;
+  if (port_idx == 0 and freq != rx_freq) {
+    rx_freq = freq;
+    radio.set_rx_freq(0, freq);
+  }
+}
+
+bool radio_mux::receive_block(uint32_t nof_samples)
+{
+  nof_samples = std::min(nof_samples, (uint32_t)rx_block.size());
+
+  srslte::rf_buffer_t    buffer(rx_block.data(), nof_samples);
+  srslte::rf_timestamp_t ts;
+  if (not radio.rx_now(buffer, ts)) {
+    return false;
+  }
+  ts_zero = ts.get(0);
+  srslte_timestamp_sub(&ts_zero, 0, rx_head / srate);
+
+  uint32_t pos   = rx_head % ring_len;
+  uint32_t first = std::min(nof_samples, ring_len - pos);
+  srslte_vec_cf_copy(&rx_ring[pos], rx_block.data(), first);
+  srslte_vec_cf_copy(rx_ring.data(), &rx_block[first], nof_samples - first);
+  rx_head += nof_samples;
+
+  flush_tx();
+  return true;
+}
+
+bool radio_mux::rx_now(uint32_t port_idx, srslte::rf_buffer_interface& buffer, srslte::rf_timestamp_interface& rxd_time)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  port_state_t&               p = ports[port_idx];
+
+  // Nothing to share until a sample rate is set
+  if (srate == 0.0) {
+    return radio.rx_now(buffer, rxd_time);
+  }
+
+  // Ports with a lower sample rate are decimated, the ones tuned to another frequency receive zeros
+  uint32_t nof_samples = buffer.get_nof_samples();
+  uint32_t ratio       = 1;
+  bool     silent      = p.rx_freq != rx_freq;
+  if (p.srate > 0.0 and p.srate < srate) {
+    ratio  = (uint32_t)std::lround(srate / p.srate);
+    silent = silent or std::abs(ratio * p.srate - srate) > 1.0;
+  }
+  uint32_t nof_raw = nof_samples * ratio;
+  if (nof_raw > ring_len / 2) {
+    log_h.error("Port %d requested too many samples (%d)\n", port_idx, nof_raw);
+    return false;
+  }
+
+  if (p.rx_reset) {
+    p.rx_idx   = rx_head;
+    p.rx_reset = false;
+  } else if (rx_head > p.rx_idx + ring_len) {
+    // The port fell behind and its samples were overwritten
+    log_h.warning("Port %d lost %" PRIu64 " samples\n", port_idx, rx_head - p.rx_idx);
+    p.rx_idx = rx_head;
+    p.phy->radio_overflow();
+  }
+  while (rx_head < p.rx_idx + nof_raw) {
+    if (not receive_block(p.rx_idx + nof_raw - rx_head)) {
+      return false;
+    }
+  }
+
+  cf_t* out = buffer.get(0);
+  if (silent) {
+    srslte_vec_cf_zero(out, nof_samples);
+  } else if (ratio == 1) {
+    uint32_t pos   = p.rx_idx % ring_len;
+    uint32_t first = std::min(nof_samples, ring_len - pos);
+    srslte_vec_cf_copy(out, &rx_ring[pos], first);
+    srslte_vec_cf_copy(&out[first], rx_ring.data(), nof_samples - first);
+  } else {
+    // Average of consecutive samples, the occupied band of the decimated signal is small compared to the sample rate
+    for (uint32_t i = 0; i < nof_samples; i++) {
+      cf_t acc = 0;
+      for (uint32_t j = 0; j < ratio; j++) {
+        acc += rx_ring[(p.rx_idx + i * ratio + j) % ring_len];
+      }
+      out[i] = acc / (float)ratio;
+    }
+  }
+
+  sample_time(p.rx_idx, rxd_time.get_ptr(0));
+  p.rx_idx += nof_raw;
+  return true;
+}
+
+bool radio_mux::tx(uint32_t port_idx, srslte::rf_buffer_interface& buffer, const srslte::rf_timestamp_interface& tx_time)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  const port_state_t&         p = ports[port_idx];
+
+  if (srate == 0.0 or p.srate != srate) {
+    log_h.debug("Port %d transmits at %.2f MHz, the radio runs at %.2f MHz\n", port_idx, p.srate / 1e6, srate / 1e6);
+    return false;
+  }
+
+  if (not tx_started) {
+    tx_head    = rx_head;
+    tx_started = true;
+    srslte_vec_cf_zero(tx_ring.data(), ring_len);
+  }
+
+  uint32_t nof_samples = buffer.get_nof_samples();
+  uint64_t idx         = sample_idx(tx_time.get(0));
+  if (idx < tx_head or idx + nof_samples > tx_head + ring_len) {
+    log_h.warning("Port %d transmission out of the window (%" PRIu64 " not in [%" PRIu64 ", %" PRIu64 "))\n",
+                  port_idx,
+                  idx,
+                  tx_head,
+                  tx_head + ring_len - nof_samples);
+    return false;
+  }
+
+  cf_t*    in    = buffer.get(0);
+  uint32_t pos   = idx % ring_len;
+  uint32_t first = std::min(nof_samples, ring_len - pos);
+  srslte_vec_sum_ccc(&tx_ring[pos], in, &tx_ring[pos], first);
+  srslte_vec_sum_ccc(tx_ring.data(), &in[first], tx_ring.data(), nof_samples - first);
+  return true;
+}
+
+void radio_mux::flush_tx()
+{
+  if (not tx_started) {
+    return;
+  }
+
+  // The UEs transmit 4 ms after the reception minus their timing advance, keep 1 ms of margin to the reception
+  uint64_t tx_until = rx_head + (uint64_t)(srate / 1000);
+  while (tx_head < tx_until) {
+    uint32_t pos = tx_head % ring_len;
+    uint32_t len = (uint32_t)std::min(tx_until - tx_head, (uint64_t)(ring_len - pos));
+
+    srslte::rf_buffer_t    buffer(&tx_ring[pos], len);
+    srslte::rf_timestamp_t ts;
+    sample_time(tx_head, ts.get_ptr(0));
+    radio.tx(buffer, ts);
+
+    srslte_vec_cf_zero(&tx_ring[pos], len);
+    tx_head += len;
+  }
+}
+
+/*******************************************************************************
+  Port
+*******************************************************************************/
+
+int radio_mux::port::init(const srslte::rf_args_t& args_, srslte::phy_interface_radio* phy_)
+{
+  std::lock_guard<std::mutex> lock(mux->mutex);
+  mux->ports[idx].phy    = phy_;
+  mux->ports[idx].active = true;
+  return SRSLTE_SUCCESS;
+}
+
+void radio_mux::port::stop()
+{
+  std::lock_guard<std::mutex> lock(mux->mutex);
+  mux->ports[idx].active = false;
+}
+
+void radio_mux::port::set_tx_freq(const uint32_t& carrier_idx, const double& freq)
+{
+  if (idx == 0) {
+    mux->radio.set_tx_freq(0, freq);
+  }
+}
+
+void radio_mux::port::set_tx_gain(const float& gain)
+{
+  if (idx == 0) {
+    mux->radio.set_tx_gain(gain);
+  }
+}
+
+void radio_mux::port::set_rx_gain_th(const float& gain)
+{
+  if (idx == 0) {
+    mux->radio.set_rx_gain_th(gain);
+  }
+}
+
+void radio_mux::port::set_rx_gain(const float& gain)
+{
+  if (idx == 0) {
+    mux->radio.set_rx_gain(gain);
+  }
+}
+
+} // namespace srsue
@@ -168,7 +168,7 @@ void demux::process_pdu(uint8_t* mac_pdu, uint32_t nof_bytes, srslte::pdu_queue:
       mac_msg.init_rx(nof_bytes);
       mac_msg.parse_packet(mac_pdu);
       Info("%s\n", mac_msg.to_string().c_str());
-      process_sch_pdu(&mac_msg);
+      process_sch_pdu(&mac_msg, mac_pdu);
       pdus.deallocate(mac_pdu);
       break;
     case srslte::pdu_queue::BCH:
@@ -203,7 +203,8 @@ void demux::process_sch_pdu_rt(uint8_t* buff, uint32_t nof_bytes)
   }
 }
 
-void demux::process_sch_pdu(srslte::sch_pdu* pdu_msg)
+// The RLC PDUs are passed as views of the MAC PDU buffer when possible, which is released after the last of them
+void demux::process_sch_pdu(srslte::sch_pdu* pdu_msg, uint8_t* mac_pdu)
 {
   while (pdu_msg->next()) {
     if (pdu_msg->get()->is_sdu()) {
@@ -225,8 +226,14 @@ void demux::process_sch_pdu(srslte::sch_pdu* pdu_msg)
               pdu_msg->get()->get_sdu_lcid(),
               pdu_msg->get()->get_payload_size());
         if (pdu_msg->get()->get_payload_size() < MAX_PDU_LEN) {
-          rlc->write_pdu(
-              pdu_msg->get()->get_sdu_lcid(), pdu_msg->get()->get_sdu_ptr(), pdu_msg->get()->get_payload_size());
+          srslte::unique_byte_buffer_t view =
+              pdus.share(mac_pdu, pdu_msg->get()->get_sdu_ptr(), pdu_msg->get()->get_payload_size());
+          if (view != nullptr) {
+            rlc->write_pdu(pdu_msg->get()->get_sdu_lcid(), std::move(view));
+          } else {
+            rlc->write_pdu(
+                pdu_msg->get()->get_sdu_lcid(), pdu_msg->get()->get_sdu_ptr(), pdu_msg->get()->get_payload_size());
+          }
         } else {
           char tmp[1024];
           srslte_vec_sprint_hex(tmp, sizeof(tmp), pdu_msg->get()->get_sdu_ptr(), 32);
@@ -294,6 +301,10 @@ bool demux::process_ce(srslte::sch_subh* subh)
       phy_h->set_activation_deactivation_scell(cmd);
       break;
     }
+    case srslte::dl_sch_lcid::DRX_CMD:
+      Info("Received DRX Command\n");
+      mac->drx_command();
+      break;
     case srslte::dl_sch_lcid::PADDING:
       break;
     default:
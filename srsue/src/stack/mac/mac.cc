@@ -31,6 +31,7 @@
 
 #include "srslte/common/log.h"
 #include "srslte/common/pcap.h"
+#include "srslte/common/tti_trace.h"
 #include "srsue/hdr/stack/mac/mac.h"
 
 namespace srsue {
@@ -53,7 +54,6 @@ mac::mac(const char* logname, ext_task_sched_handle task_sched_) :
   pool = srslte::byte_buffer_pool::get_instance();
 
   // Keep initialising members
-  bzero(&metrics, sizeof(mac_metrics_t));
   clear_rntis();
 }
 
@@ -155,7 +155,7 @@ void mac::reconfiguration(const uint32_t& cc_idx, const bool& enable)
 // Implement Section 5.9
 void mac::reset()
 {
-  bzero(&metrics, sizeof(mac_metrics_t));
+  reset_metrics();
 
   Info("Resetting MAC\n");
 
@@ -171,6 +171,10 @@ void mac::reset()
   sr_procedure.reset();
   bsr_procedure.reset();
   phr_procedure.reset();
+  {
+    std::lock_guard<std::mutex> lock(drx_mutex);
+    drx.reset();
+  }
 
   // Setup default LCID 0 with highest priority
   logical_channel_config_t config = {};
@@ -206,10 +210,14 @@ void mac::run_tti(const uint32_t tti)
   phr_procedure.step();
   ra_procedure.step(tti);
   ra_procedure.update_rar_window(ra_window_start, ra_window_length);
+  {
+    std::lock_guard<std::mutex> lock(drx_mutex);
+    drx.step(srslte::tti_point{tti});
+  }
 
   // Count TTI for metrics
-  for (uint32_t i = 0; i < SRSLTE_MAX_CARRIERS; i++) {
-    metrics[i].nof_tti++;
+  for (auto& m : metrics) {
+    m.nof_tti++;
   }
 }
 
@@ -231,9 +239,13 @@ void mac::bcch_stop_rx()
   bcch_start_rx(-1, -1);
 }
 
-void mac::pcch_start_rx()
+void mac::pcch_start_rx(uint32_t paging_cycle_, uint32_t pf_offset, uint32_t po_sf_idx)
 {
+  paging_cycle         = paging_cycle_;
+  paging_pf            = pf_offset;
+  paging_sf            = po_sf_idx;
   this->p_window_start = 1;
+  Info("SCHED: Searching P-RNTI in sf_idx=%d of the frames with SFN mod %d = %d\n", paging_sf, paging_cycle, paging_pf);
 }
 
 void mac::clear_rntis()
@@ -271,6 +283,16 @@ uint16_t mac::get_ul_sched_rnti(uint32_t tti)
   return SRSLTE_INVALID_RNTI;
 }
 
+// Besides the DRX timers, a pending SR or an ongoing RA procedure keep the UE in Active Time (TS 36.321 Section 5.7)
+bool mac::is_drx_active_time(uint32_t tti)
+{
+  if (!uernti.crnti or sr_procedure.is_pending() or not ra_procedure.is_idle()) {
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(drx_mutex);
+  return drx.is_active(srslte::tti_point{tti});
+}
+
 bool mac::is_in_window(uint32_t tti, int* start, int* len)
 {
   uint32_t st = (uint32_t)*start;
@@ -322,12 +344,17 @@ uint16_t mac::get_dl_sched_rnti(uint32_t tti)
     return uernti.temp_rnti;
   }
   if (uernti.crnti) {
+    if (not is_drx_active_time(tti)) {
+      return SRSLTE_INVALID_RNTI;
+    }
     Debug("SCHED: Searching C-RNTI=0x%x\n", uernti.crnti);
     return uernti.crnti;
   }
   if (p_window_start > 0) {
-    Debug("SCHED: Searching P-RNTI\n");
-    return SRSLTE_PRNTI;
+    if (paging_cycle == 0 || ((tti / 10) % paging_cycle == paging_pf && tti % 10 == paging_sf)) {
+      Debug("SCHED: Searching P-RNTI\n");
+      return SRSLTE_PRNTI;
+    }
   }
 
   // turn off DCI search for this TTI
@@ -426,6 +453,15 @@ void mac::tb_decoded(uint32_t cc_idx, mac_grant_dl_t grant, bool ack[SRSLTE_MAX_
     dl_harq.at(cc_idx)->tb_decoded(grant, ack);
     process_pdus();
 
+    if (grant.rnti == uernti.crnti) {
+      std::lock_guard<std::mutex> lock(drx_mutex);
+      for (uint32_t tb = 0; tb < SRSLTE_MAX_CODEWORDS; tb++) {
+        if (grant.tb[tb].tbs && !ack[tb]) {
+          drx.dl_tb_failed(srslte::tti_point{grant.tti}, grant.pid);
+        }
+      }
+    }
+
     for (uint32_t tb = 0; tb < SRSLTE_MAX_CODEWORDS; tb++) {
       if (grant.tb[tb].tbs) {
         if (ack[tb]) {
@@ -463,6 +499,10 @@ void mac::new_grant_dl(uint32_t                               cc_idx,
     if (grant.rnti == uernti.crnti && ra_procedure.is_contention_resolution()) {
       ra_procedure.pdcch_to_crnti(false);
     }
+    if (grant.rnti == uernti.crnti) {
+      std::lock_guard<std::mutex> lock(drx_mutex);
+      drx.new_pdcch(srslte::tti_point{grant.tti});
+    }
     // Assert DL HARQ entity
     if (dl_harq.at(cc_idx) == nullptr) {
       Error("HARQ entity %d has not been created\n", cc_idx);
@@ -511,6 +551,12 @@ bool mac::contention_resolution_id_rcv(uint64_t id)
   return ra_procedure.contention_resolution_id_received(id);
 }
 
+void mac::drx_command()
+{
+  std::lock_guard<std::mutex> lock(drx_mutex);
+  drx.drx_command(srslte::tti_point{phy_h->get_current_tti()});
+}
+
 void mac::new_grant_ul(uint32_t                               cc_idx,
                        mac_interface_phy_lte::mac_grant_ul_t  grant,
                        mac_interface_phy_lte::tb_action_ul_t* action)
@@ -527,7 +573,16 @@ void mac::new_grant_ul(uint32_t                               cc_idx,
     return;
   }
 
-  ul_harq.at(cc_idx)->new_grant_ul(grant, action);
+  // UL DCI for the C-RNTI, received FDD_HARQ_DELAY_DL_MS before the PUSCH
+  if (grant.rnti == uernti.crnti && grant.tb.ndi_present && !grant.is_rar) {
+    std::lock_guard<std::mutex> lock(drx_mutex);
+    drx.new_pdcch(srslte::tti_point{grant.tti_tx} - FDD_HARQ_DELAY_DL_MS);
+  }
+
+  {
+    srslte::tti_span span(srslte::tti_stage::mac_pdu_build);
+    ul_harq.at(cc_idx)->new_grant_ul(grant, action);
+  }
   metrics[cc_idx].tx_pkts++;
 
   if (grant.phich_available) {
@@ -617,6 +672,10 @@ void mac::set_config(mac_cfg_t& mac_cfg)
   phr_procedure.set_config(mac_cfg.phr_cfg);
   sr_procedure.set_config(mac_cfg.sr_cfg);
   ra_procedure.set_config(mac_cfg.rach_cfg);
+  {
+    std::lock_guard<std::mutex> lock(drx_mutex);
+    drx.set_config(mac_cfg.drx_cfg);
+  }
   ul_harq_cfg = mac_cfg.harq_cfg;
   for (auto& i : ul_harq) {
     if (i != nullptr) {
@@ -656,28 +715,46 @@ void mac::mch_start_rx(uint32_t lcid)
   demux_unit.mch_start_rx(lcid);
 }
 
+void mac::reset_metrics()
+{
+  mac_metrics_t discarded;
+  for (uint32_t r = 0; r < SRSLTE_MAX_CARRIERS; r++) {
+    read_metrics(r, discarded);
+  }
+}
+
+void mac::read_metrics(uint32_t cc_idx, mac_metrics_t& m)
+{
+  m           = {};
+  m.nof_tti   = metrics[cc_idx].nof_tti.read_and_reset();
+  m.tx_pkts   = metrics[cc_idx].tx_pkts.read_and_reset();
+  m.tx_errors = metrics[cc_idx].tx_errors.read_and_reset();
+  m.tx_brate  = metrics[cc_idx].tx_brate.read_and_reset();
+  m.rx_pkts   = metrics[cc_idx].rx_pkts.read_and_reset();
+  m.rx_errors = metrics[cc_idx].rx_errors.read_and_reset();
+  m.rx_brate  = metrics[cc_idx].rx_brate.read_and_reset();
+}
+
 void mac::get_metrics(mac_metrics_t m[SRSLTE_MAX_CARRIERS])
 {
   int   tx_pkts          = 0;
   int   tx_errors        = 0;
-  int   tx_brate         = 0;
   int   rx_pkts          = 0;
   int   rx_errors        = 0;
-  int   rx_brate         = 0;
-  int   ul_buffer        = 0;
   float dl_avg_ret       = 0;
   int   dl_avg_ret_count = 0;
 
+  for (uint32_t r = 0; r < SRSLTE_MAX_CARRIERS; r++) {
+    read_metrics(r, m[r]);
+  }
+
   for (uint32_t r = 0; r < dl_harq.size(); r++) {
-    tx_pkts += metrics[r].tx_pkts;
-    tx_errors += metrics[r].tx_errors;
-    tx_brate += metrics[r].tx_brate;
-    rx_pkts += metrics[r].rx_pkts;
-    rx_errors += metrics[r].rx_errors;
-    rx_brate += metrics[r].rx_brate;
-    ul_buffer += metrics[r].ul_buffer;
-
-    if (metrics[r].rx_pkts) {
+    tx_pkts += m[r].tx_pkts;
+    tx_errors += m[r].tx_errors;
+    rx_pkts += m[r].rx_pkts;
+    rx_errors += m[r].rx_errors;
+
+    if (m[r].rx_pkts) {
       dl_avg_ret += dl_harq.at(r)->get_average_retx();
       dl_avg_ret_count++;
     }
@@ -693,10 +770,7 @@ void mac::get_metrics(mac_metrics_t m[SRSLTE_MAX_CARRIERS])
        tx_pkts ? ((float)100 * tx_errors / tx_pkts) : 0.0f,
        ul_harq.at(PCELL_CC_IDX)->get_average_retx());
 
-  metrics[PCELL_CC_IDX].ul_buffer = (int)bsr_procedure.get_buffer_state();
-  memcpy(m, metrics, sizeof(mac_metrics_t) * SRSLTE_MAX_CARRIERS);
-  m = metrics;
-  bzero(&metrics, sizeof(mac_metrics_t) * SRSLTE_MAX_CARRIERS);
+  m[PCELL_CC_IDX].ul_buffer = (int)bsr_procedure.get_buffer_state();
 }
 
 } // namespace srsue
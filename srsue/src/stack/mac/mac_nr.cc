@@ -31,8 +31,7 @@ mac_nr::mac_nr(srslte::ext_task_sched_handle task_sched_) :
   log_h("MAC"),
   task_sched(task_sched_)
 {
-  tx_buffer  = srslte::allocate_unique_buffer(*pool);
-  rlc_buffer = srslte::allocate_unique_buffer(*pool);
+  tx_buffer = srslte::allocate_unique_buffer(*pool);
 }
 
 mac_nr::~mac_nr()
@@ -168,18 +167,17 @@ void mac_nr::get_ul_data(const mac_nr_grant_ul_t& grant, phy_interface_stack_nr:
   tx_pdu.init_tx(tx_buffer.get(), grant.tbs, true);
 
   while (tx_pdu.get_remaing_len() >= MIN_RLC_PDU_LEN) {
-    // read RLC PDU
-    rlc_buffer->clear();
-    uint8_t* rd      = rlc_buffer->msg;
-    int      pdu_len = rlc->read_pdu(args.drb_lcid, rd, tx_pdu.get_remaing_len() - 2);
+    // read RLC PDU straight into the MAC PDU
+    uint32_t max_len = 0;
+    uint8_t* rd      = tx_pdu.reserve_sdu(args.drb_lcid, &max_len);
+    int      pdu_len = rd != nullptr ? rlc->read_pdu(args.drb_lcid, rd, max_len) : 0;
 
     // Add SDU if RLC has something to tx
     if (pdu_len > 0) {
-      rlc_buffer->N_bytes = pdu_len;
-      log_h->info_hex(rlc_buffer->msg, rlc_buffer->N_bytes, "Read %d B from RLC\n", rlc_buffer->N_bytes);
+      log_h->info_hex(rd, pdu_len, "Read %d B from RLC\n", pdu_len);
 
       // add to MAC PDU and pack
-      if (tx_pdu.add_sdu(args.drb_lcid, rlc_buffer->msg, rlc_buffer->N_bytes) != SRSLTE_SUCCESS) {
+      if (tx_pdu.commit_sdu(pdu_len) != SRSLTE_SUCCESS) {
         log_h->error("Error packing MAC PDU\n");
       }
     } else {
@@ -252,7 +250,7 @@ void mac_nr::handle_pdu(srslte::unique_byte_buffer_t pdu)
   rx_pdu.unpack(pdu->msg, pdu->N_bytes);
 
   for (uint32_t i = 0; i < rx_pdu.get_num_subpdus(); ++i) {
-    srslte::mac_nr_sch_subpdu subpdu = rx_pdu.get_subpdu(i);
+    const srslte::mac_nr_sch_subpdu& subpdu = rx_pdu.get_subpdu(i);
     log_h->info("Handling subPDU %d/%d: lcid=%d, sdu_len=%d\n",
                 i,
                 rx_pdu.get_num_subpdus(),
@@ -27,9 +27,6 @@
 #include "srsue/hdr/stack/mac/mux.h"
 #include "srsue/hdr/stack/mac/mac.h"
 
-#include <algorithm>
-#include <set>
-
 namespace srsue {
 
 mux::mux(srslte::log_ref log_) : pdu_msg(MAX_NOF_SUBHEADERS, log_), log_h(log_)
@@ -49,7 +46,8 @@ void mux::reset()
 {
   std::lock_guard<std::mutex> lock(mutex);
 
-  for (auto& channel : logical_channels) {
+  nof_pending_steps = 0;
+  for (auto& channel : channels()) {
     channel.Bj = 0;
   }
   msg3_pending     = false;
@@ -58,22 +56,35 @@ void mux::reset()
 
 void mux::step()
 {
-  std::lock_guard<std::mutex> lock(mutex);
+  nof_pending_steps.fetch_add(1, std::memory_order_relaxed);
+}
+
+// update Bj according to 36.321 Sec 5.4.3.1, mutex should be hold by caller
+void mux::update_Bj()
+{
+  uint32_t nof_steps = nof_pending_steps.exchange(0, std::memory_order_relaxed);
+  if (nof_steps == 0) {
+    return;
+  }
 
-  // update Bj according to 36.321 Sec 5.4.3.1
-  for (auto& channel : logical_channels) {
-    // Add PRB unless it's infinity
+  for (auto& channel : channels()) {
+    // The first TTI clamps a negative Bj as before, the following ones only add the PBR up to the bucket size
+    int64_t Bj = channel.Bj;
+    if (channel.PBR >= 0) {
+      Bj += channel.PBR; // PBR is in kByte/s, conversion in Byte and ms not needed
+    }
+    Bj = SRSLTE_MIN((uint32_t)Bj, channel.bucket_size);
     if (channel.PBR >= 0) {
-      channel.Bj += channel.PBR; // PBR is in kByte/s, conversion in Byte and ms not needed
+      Bj = SRSLTE_MIN(Bj + (int64_t)channel.PBR * (nof_steps - 1), (int64_t)channel.bucket_size);
     }
-    channel.Bj = SRSLTE_MIN((uint32_t)channel.Bj, channel.bucket_size);
+    channel.Bj = (int32_t)Bj;
     Debug("Update Bj: lcid=%d, Bj=%d\n", channel.lcid, channel.Bj);
   }
 }
 
 bool mux::is_pending_any_sdu()
 {
-  for (auto& channel : logical_channels) {
+  for (auto& channel : channels()) {
     if (rlc->has_data_locked(channel.lcid)) {
       return true;
     }
@@ -83,7 +94,7 @@ bool mux::is_pending_any_sdu()
 
 bool mux::has_logical_channel(const uint32_t& lcid)
 {
-  for (auto& channel : logical_channels) {
+  for (auto& channel : channels()) {
     if (channel.lcid == lcid) {
       return true;
     }
@@ -91,45 +102,57 @@ bool mux::has_logical_channel(const uint32_t& lcid)
   return false;
 }
 
-bool priority_compare(const logical_channel_config_t& u1, const logical_channel_config_t& u2)
-{
-  return u1.priority <= u2.priority;
-}
-
 // This is called by RRC (stack thread) during bearer addition
 void mux::setup_lcid(const logical_channel_config_t& config)
 {
   std::lock_guard<std::mutex> lock(mutex);
 
+  // Apply the Bj increments with the old settings
+  update_Bj();
+
   if (has_logical_channel(config.lcid)) {
     // update settings
-    for (auto& channel : logical_channels) {
+    for (auto& channel : channels()) {
       if (channel.lcid == config.lcid) {
         channel = config;
         break;
       }
     }
     // warn user if there is another LCID with same prio
-    for (auto& channel : logical_channels) {
+    for (auto& channel : channels()) {
       if (channel.priority == config.priority && channel.lcid != config.lcid) {
         log_h->warning("LCID %d and %d have same priority.\n", channel.lcid, config.lcid);
       }
     }
-  } else {
+  } else if (nof_logical_channels < logical_channels.size()) {
     // add new entry
-    logical_channels.push_back(config);
+    logical_channels[nof_logical_channels++] = config;
+  } else {
+    Error("Can't add LCID %d, there are already %d logical channels\n", config.lcid, nof_logical_channels);
+    return;
   }
 
-  // sort according to priority (increasing is lower priority)
-  std::sort(logical_channels.begin(), logical_channels.end(), priority_compare);
+  // sort according to priority (increasing is lower priority), channels with the same priority keep their order
+  for (uint32_t i = 1; i < nof_logical_channels; i++) {
+    logical_channel_config_t channel = logical_channels[i];
+    uint32_t                 j       = i;
+    for (; j > 0 && logical_channels[j - 1].priority > channel.priority; j--) {
+      logical_channels[j] = logical_channels[j - 1];
+    }
+    logical_channels[j] = channel;
+  }
 }
 
 // mutex should be hold by caller
-void mux::print_logical_channel_state(const std::string& info)
+void mux::print_logical_channel_state(const char* info)
 {
+  if (log_h->get_level() < srslte::LOG_LEVEL_DEBUG) {
+    return;
+  }
+
   std::string logline = info;
 
-  for (auto& channel : logical_channels) {
+  for (auto& channel : channels()) {
     logline += "\n";
     logline += "- lcid=";
     logline += std::to_string(channel.lcid);
@@ -169,6 +192,8 @@ uint8_t* mux::pdu_get(srslte::byte_buffer_t* payload, uint32_t pdu_sz)
 {
   std::lock_guard<std::mutex> lock(mutex);
 
+  update_Bj();
+
   // Logical Channel Procedure
   payload->clear();
   pdu_msg.init_tx(payload, pdu_sz, true);
@@ -193,7 +218,7 @@ uint8_t* mux::pdu_get(srslte::byte_buffer_t* payload, uint32_t pdu_sz)
   bsr_proc::bsr_t bsr                = {}; // pending data per LCG
   int             total_pending_data = 0;
   int             last_sdu_len       = 0;
-  for (auto& channel : logical_channels) {
+  for (auto& channel : channels()) {
     channel.sched_len  = 0; // reset sched_len for LCID
     channel.buffer_len = rlc->get_buffer_state(channel.lcid);
     total_pending_data += channel.buffer_len + sch_pdu::size_header_sdu(channel.buffer_len);
@@ -239,7 +264,7 @@ uint8_t* mux::pdu_get(srslte::byte_buffer_t* payload, uint32_t pdu_sz)
   // data from any Logical Channel, except data from UL-CCCH;
   // first only those with positive Bj
   uint32_t last_sdu_subheader_len = 0; // needed to keep track of added SDUs and actual required subheades
-  for (auto& channel : logical_channels) {
+  for (auto& channel : channels()) {
     int max_sdu_sz = (channel.PBR < 0) ? -1 : channel.Bj; // this can be zero if no PBR has been allocated
     if (max_sdu_sz != 0) {
       if (sched_sdu(&channel, &sdu_space, max_sdu_sz)) {
@@ -258,7 +283,7 @@ uint8_t* mux::pdu_get(srslte::byte_buffer_t* payload, uint32_t pdu_sz)
   print_logical_channel_state("First round of allocation:");
 
   // If resources remain, allocate regardless of their Bj value
-  for (auto& channel : logical_channels) {
+  for (auto& channel : channels()) {
     if (channel.lcid != 0) {
       // allocate subheader if this LCID has not been scheduled yet but there is data to send
       if (channel.sched_len == 0 && channel.buffer_len > 0) {
@@ -270,7 +295,7 @@ uint8_t* mux::pdu_get(srslte::byte_buffer_t* payload, uint32_t pdu_sz)
 
   print_logical_channel_state("Second round of allocation:");
 
-  for (auto& channel : logical_channels) {
+  for (auto& channel : channels()) {
     if (channel.sched_len != 0) {
       allocate_sdu(channel.lcid, &pdu_msg, channel.sched_len);
 
@@ -298,7 +323,9 @@ uint8_t* mux::pdu_get(srslte::byte_buffer_t* payload, uint32_t pdu_sz)
 
   // Generate MAC PDU and save to buffer
   uint8_t* ret = pdu_msg.write_packet(log_h);
-  Info("%s\n", pdu_msg.to_string().c_str());
+  if (log_h->get_level() >= srslte::LOG_LEVEL_INFO) {
+    Info("%s\n", pdu_msg.to_string().c_str());
+  }
   Debug("Assembled MAC PDU msg size %d/%d bytes\n", pdu_msg.get_pdu_len() - pdu_msg.rem_size(), pdu_sz);
 
   return ret;
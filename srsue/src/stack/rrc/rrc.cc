@@ -997,7 +997,7 @@ void rrc::leave_connected()
   rrc_log->info("Going RRC_IDLE\n");
   if (phy->cell_is_camping()) {
     // Receive paging
-    mac->pcch_start_rx();
+    start_pcch_rx();
   }
 }
 
@@ -1194,6 +1194,45 @@ void rrc::handle_sib1()
   }
 }
 
+/* Computes the paging occasion of the UE according to TS 36.304 Section 7.1 and starts the PCCH reception in it. The
+ * P-RNTI is searched in every subframe until the PCCH configuration of the SIB2 is known */
+void rrc::start_pcch_rx()
+{
+  if (not meas_cells.serving_cell().has_sib2()) {
+    mac->pcch_start_rx(0, 0, 0);
+    return;
+  }
+  const pcch_cfg_s& pcch_cfg = meas_cells.serving_cell().sib2ptr()->rr_cfg_common.pcch_cfg;
+
+  // UE_ID = IMSI mod 1024
+  uint32_t ue_id        = 0;
+  uint8_t  imsi_vec[15] = {};
+  if (usim != nullptr && usim->get_imsi_vec(imsi_vec, 15)) {
+    for (uint8_t digit : imsi_vec) {
+      ue_id = (ue_id * 10 + digit) % 1024;
+    }
+  }
+
+  // The UE specific DRX cycle is not supported, so the paging cycle is the default of the cell
+  uint32_t T  = pcch_cfg.default_paging_cycle.to_number();
+  uint32_t nB = std::max(1U, (uint32_t)(pcch_cfg.nb.to_number() * T));
+  uint32_t N  = std::min(T, nB);
+  uint32_t Ns = std::max(1U, nB / T);
+
+  uint32_t pf  = (T / N) * (ue_id % N);
+  uint32_t i_s = (ue_id / N) % Ns;
+
+  // Paging subframe of i_s for Ns = 1, 2 and 4
+  static const uint32_t po_fdd[3][4] = {{9, 9, 9, 9}, {4, 9, 4, 9}, {0, 4, 5, 9}};
+  static const uint32_t po_tdd[3][4] = {{0, 0, 0, 0}, {0, 5, 0, 5}, {0, 1, 5, 6}};
+  uint32_t              ns_idx       = Ns == 4 ? 2 : Ns - 1;
+  bool     is_tdd = meas_cells.serving_cell().has_sib1() and meas_cells.serving_cell().sib1ptr()->tdd_cfg_present;
+  uint32_t po     = is_tdd ? po_tdd[ns_idx][i_s] : po_fdd[ns_idx][i_s];
+
+  rrc_log->info("Paging occasion UE_ID=%d, T=%d, nB=%d: PF=%d, PO=%d\n", ue_id, T, nB, pf, po);
+  mac->pcch_start_rx(T, pf, po);
+}
+
 void rrc::handle_sib2()
 {
   rrc_log->info("SIB2 received\n");
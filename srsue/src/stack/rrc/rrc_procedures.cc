@@ -1228,7 +1228,7 @@ proc_outcome_t rrc::cell_reselection_proc::step()
     case cs_result_t::changed_cell:
       if (rrc_ptr->state == rrc_state_t::RRC_STATE_IDLE) {
         Info("New cell has been selected, start receiving PCCH\n");
-        rrc_ptr->mac->pcch_start_rx();
+        rrc_ptr->start_pcch_rx();
       }
       break;
     case cs_result_t::no_cell:
@@ -21,6 +21,8 @@
 
 #include "srsue/hdr/stack/ue_stack_lte.h"
 #include "srslte/common/logmap.h"
+#include "srslte/common/thread_metrics.h"
+#include "srslte/common/tti_deadline_watchdog.h"
 #include "srslte/srslte.h"
 #include <algorithm>
 #include <chrono>
@@ -105,11 +107,11 @@ int ue_stack_lte::init(const stack_args_t& args_, srslte::logger* logger_)
 
   // Set up pcap
   if (args.pcap.enable) {
-    mac_pcap.open(args.pcap.filename.c_str());
+    mac_pcap.open(args.pcap.filename.c_str(), 0, args.pcap.rotation);
     mac.start_pcap(&mac_pcap);
   }
   if (args.pcap.nas_enable) {
-    nas_pcap.open(args.pcap.nas_filename.c_str());
+    nas_pcap.open(args.pcap.nas_filename.c_str(), 0, args.pcap.rotation);
     nas.start_pcap(&nas_pcap);
   }
 
@@ -126,9 +128,12 @@ int ue_stack_lte::init(const stack_args_t& args_, srslte::logger* logger_)
   mac.init(phy, &rlc, &rrc);
   rlc.init(&pdcp, &rrc, task_sched.get_timer_handler(), 0 /* RB_ID_SRB0 */);
   pdcp.init(&rlc, &rrc, gw);
+  pdcp.set_crypto_offload(args.pdcp_crypto_offload);
   nas.init(usim.get(), &rrc, gw, args.nas);
   rrc.init(phy, &mac, &rlc, &pdcp, &nas, usim.get(), gw, args.rrc);
 
+  srslte::tti_deadline_watchdog::add_context_source("stack queues", [this]() { return get_queue_depths(); });
+
   running = true;
   start(STACK_MAIN_THREAD_PRIO);
 
@@ -146,6 +151,7 @@ void ue_stack_lte::stop()
 void ue_stack_lte::stop_impl()
 {
   running = false;
+  srslte::tti_deadline_watchdog::remove_context_source("stack queues");
 
   usim->stop();
   nas.stop();
@@ -163,6 +169,19 @@ void ue_stack_lte::stop_impl()
   }
 }
 
+std::string ue_stack_lte::get_queue_depths()
+{
+  char s[128];
+  snprintf(s,
+           sizeof(s),
+           "ue=%zu gw=%zu cfg=%zu sync=%zu\n",
+           ue_task_queue.size(),
+           gw_queue_id.size(),
+           cfg_task_queue.size(),
+           sync_task_queue.size());
+  return s;
+}
+
 bool ue_stack_lte::switch_on()
 {
   if (running) {
@@ -325,6 +344,13 @@ void ue_stack_lte::run_tti_impl(uint32_t tti, uint32_t tti_jump)
   }
   current_tti = tti_point{tti};
 
+  // Sample the load of the stack once per TTI
+  srslte::thread_metrics::observe(srslte::thread_metric::stack_queue_depth,
+                                  ue_task_queue.size() + gw_queue_id.size() + cfg_task_queue.size() +
+                                      sync_task_queue.size());
+  srslte::thread_metrics::observe(srslte::thread_metric::buffer_pool_used,
+                                  byte_buffer_pool::get_instance()->nof_used());
+
   // perform tasks for the received TTI range
   for (uint32_t i = 0; i < tti_jump; ++i) {
     uint32_t next_tti = TTI_SUB(tti, (tti_jump - i - 1));
@@ -20,6 +20,7 @@
  */
 
 #include "srsue/hdr/stack/upper/gw.h"
+#include "srslte/common/latency_histogram.h"
 #include "srslte/upper/ipv6.h"
 
 #include <errno.h>
@@ -74,6 +75,15 @@ void gw::stop()
     run_enable = false;
     if (if_up) {
       close(tun_fd);
+      for (int32_t fd : tun_queue_fds) {
+        close(fd);
+      }
+      for (auto& r : tun_readers) {
+        r->thread_cancel();
+        r->wait_thread_finish();
+      }
+      tun_readers.clear();
+      tun_queue_fds.clear();
 
       // Wait thread to exit gracefully otherwise might leave a mutex locked
       int cnt = 0;
@@ -85,6 +95,10 @@ void gw::stop()
         thread_cancel();
       }
       wait_thread_finish();
+      if (dl_writer != nullptr) {
+        dl_writer->stop();
+        dl_writer.reset();
+      }
 
       current_ip_addr = 0;
     }
@@ -126,9 +140,12 @@ void gw::write_pdu(uint32_t lcid, srslte::unique_byte_buffer_t pdu)
     // Only handle IPv4 and IPv6 packets
     struct iphdr* ip_pkt = (struct iphdr*)pdu->msg;
     if (ip_pkt->version == 4 || ip_pkt->version == 6) {
-      int n = write(tun_fd, pdu->msg, pdu->N_bytes);
-      if (n > 0 && (pdu->N_bytes != (uint32_t)n)) {
-        log.warning("DL TUN/TAP write failure. Wanted to write %d B but only wrote %d B.\n", pdu->N_bytes, n);
+      if (dl_writer != nullptr) {
+        if (not dl_writer->queue.try_push(std::move(pdu))) {
+          log.warning("DL TUN/TAP write queue full. Dropping packet\n");
+        }
+      } else {
+        write_tun(pdu);
       }
     } else {
       log.error("Unsupported IP version. Dropping packet with %d B\n", pdu->N_bytes);
@@ -136,6 +153,14 @@ void gw::write_pdu(uint32_t lcid, srslte::unique_byte_buffer_t pdu)
   }
 }
 
+void gw::write_tun(const srslte::unique_byte_buffer_t& pdu)
+{
+  int n = write(tun_fd, pdu->msg, pdu->N_bytes);
+  if (n > 0 && (pdu->N_bytes != (uint32_t)n)) {
+    log.warning("DL TUN/TAP write failure. Wanted to write %d B but only wrote %d B.\n", pdu->N_bytes, n);
+  }
+}
+
 void gw::write_pdu_mch(uint32_t lcid, srslte::unique_byte_buffer_t pdu)
 {
   if (pdu->N_bytes > 2) {
@@ -182,8 +207,16 @@ int gw::setup_if_addr(uint32_t lcid, uint8_t pdn_type, uint32_t ip_addr, uint8_t
   default_lcid = lcid;
   tft_matcher.set_default_lcid(lcid);
 
-  // Setup a thread to receive packets from the TUN device
+  // Setup a thread to receive packets from each queue of the TUN device
+  if (args.async_tun_write and dl_writer == nullptr) {
+    dl_writer.reset(new tun_writer(this));
+    dl_writer->start(GW_THREAD_PRIO);
+  }
   start(GW_THREAD_PRIO);
+  for (uint32_t i = tun_readers.size(); i < tun_queue_fds.size(); i++) {
+    tun_readers.emplace_back(new tun_reader(this, tun_queue_fds[i], i + 1));
+    tun_readers.back()->start(GW_THREAD_PRIO);
+  }
   return SRSLTE_SUCCESS;
 }
 
@@ -213,6 +246,46 @@ void gw::add_mch_port(uint32_t lcid, uint32_t port)
 /*    GW Receive    */
 /********************/
 void gw::run_thread()
+{
+  running = true;
+  read_tun(tun_fd);
+  running = false;
+  log.info("GW IP receiver thread exiting.\n");
+}
+
+gw::tun_reader::tun_reader(gw* parent_, int32_t fd_, uint32_t id) :
+  thread("GW" + std::to_string(id)),
+  parent(parent_),
+  fd(fd_)
+{
+}
+
+void gw::tun_reader::run_thread()
+{
+  parent->read_tun(fd);
+}
+
+gw::tun_writer::tun_writer(gw* parent_) : thread("GW_DL"), queue(MAX_QUEUE_SIZE), parent(parent_) {}
+
+void gw::tun_writer::stop()
+{
+  // An empty buffer wakes up the thread and tells it to exit
+  queue.push(srslte::unique_byte_buffer_t());
+  wait_thread_finish();
+}
+
+void gw::tun_writer::run_thread()
+{
+  while (true) {
+    srslte::unique_byte_buffer_t pdu = queue.wait_pop();
+    if (pdu == nullptr) {
+      break;
+    }
+    parent->write_tun(pdu);
+  }
+}
+
+void gw::read_tun(int32_t fd)
 {
   uint32 idx     = 0;
   int32  N_bytes = 0;
@@ -226,18 +299,17 @@ void gw::run_thread()
   const static uint32_t ATTACH_WAIT_TOUT = 40; // 4 sec
   uint32_t              attach_wait      = 0;
 
-  log.info("GW IP packet receiver thread run_enable\n");
+  log.info("GW IP packet receiver thread run_enable, fd=%d\n", fd);
 
-  running = true;
   while (run_enable) {
     if (SRSLTE_MAX_BUFFER_SIZE_BYTES - SRSLTE_BUFFER_HEADER_OFFSET > idx) {
-      N_bytes = read(tun_fd, &pdu->msg[idx], SRSLTE_MAX_BUFFER_SIZE_BYTES - SRSLTE_BUFFER_HEADER_OFFSET - idx);
+      N_bytes = read(fd, &pdu->msg[idx], SRSLTE_MAX_BUFFER_SIZE_BYTES - SRSLTE_BUFFER_HEADER_OFFSET - idx);
     } else {
       log.error("GW pdu buffer full - gw receive thread exiting.\n");
       srslte::console("GW pdu buffer full - gw receive thread exiting.\n");
       break;
     }
-    log.debug("Read %d bytes from TUN fd=%d, idx=%d\n", N_bytes, tun_fd, idx);
+    log.debug("Read %d bytes from TUN fd=%d, idx=%d\n", N_bytes, fd, idx);
 
     if (N_bytes > 0) {
       struct iphdr*   ip_pkt  = (struct iphdr*)pdu->msg;
@@ -256,6 +328,7 @@ void gw::run_thread()
         log.debug("IPv%d packet total length: %d Bytes\n", ip_pkt->version, pkt_len);
         // Check if entire packet was received
         if (pkt_len == pdu->N_bytes) {
+          pdu->md.rx_ns = srslte::latency_clock_ns();
           log.info_hex(pdu->msg, pdu->N_bytes, "TX PDU");
 
           while (run_enable && !stack->is_lcid_enabled(default_lcid) && attach_wait < ATTACH_WAIT_TOUT) {
@@ -305,8 +378,6 @@ void gw::run_thread()
       break;
     }
   }
-  running = false;
-  log.info("GW IP receiver thread exiting.\n");
 }
 
 /**************************/
@@ -345,7 +416,7 @@ int gw::init_if(char* err_str)
   }
 
   memset(&ifr, 0, sizeof(ifr));
-  ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+  ifr.ifr_flags = IFF_TUN | IFF_NO_PI | (args.nof_tun_queues > 1 ? IFF_MULTI_QUEUE : 0);
   strncpy(
       ifr.ifr_ifrn.ifrn_name, args.tun_dev_name.c_str(), std::min(args.tun_dev_name.length(), (size_t)(IFNAMSIZ - 1)));
   ifr.ifr_ifrn.ifrn_name[IFNAMSIZ - 1] = 0;
@@ -356,6 +427,25 @@ int gw::init_if(char* err_str)
     return SRSLTE_ERROR_CANT_START;
   }
 
+  // Attach the other queues, the kernel spreads the uplink flows over them
+  for (uint32_t i = 1; i < args.nof_tun_queues; i++) {
+    int32_t fd = open("/dev/net/tun", O_RDWR);
+    if (0 > fd or 0 > ioctl(fd, TUNSETIFF, &ifr)) {
+      err_str = strerror(errno);
+      log.error("Failed to attach TUN queue %d: %s\n", i, err_str);
+      if (fd >= 0) {
+        close(fd);
+      }
+      for (int32_t q : tun_queue_fds) {
+        close(q);
+      }
+      tun_queue_fds.clear();
+      close(tun_fd);
+      return SRSLTE_ERROR_CANT_START;
+    }
+    tun_queue_fds.push_back(fd);
+  }
+
   // Bring up the interface
   sock = socket(AF_INET, SOCK_DGRAM, 0);
   if (0 > ioctl(sock, SIOCGIFFLAGS, &ifr)) {
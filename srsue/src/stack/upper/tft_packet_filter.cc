@@ -386,17 +386,17 @@ bool tft_packet_filter_t::match_port(const srslte::unique_byte_buffer_t& pdu)
 
 uint8_t tft_pdu_matcher::check_tft_filter_match(const srslte::unique_byte_buffer_t& pdu)
 {
+  if (not has_filters) {
+    return default_lcid;
+  }
   std::lock_guard<std::mutex> lock(tft_mutex);
-  uint8_t                     lcid = default_lcid;
-  for (std::pair<const uint16_t, tft_packet_filter_t>& filter_pair : tft_filter_map) {
-    bool match = filter_pair.second.match(pdu);
-    if (match) {
-      lcid = filter_pair.second.lcid;
-      log->debug("Found filter match -- EPS bearer Id %d, LCID %d\n", filter_pair.second.eps_bearer_id, lcid);
-      break;
+  for (tft_packet_filter_t& filter : compiled_filters) {
+    if (filter.match(pdu)) {
+      log->debug("Found filter match -- EPS bearer Id %d, LCID %d\n", filter.eps_bearer_id, filter.lcid);
+      return filter.lcid;
     }
   }
-  return lcid;
+  return default_lcid;
 }
 
 int tft_pdu_matcher::apply_traffic_flow_template(const uint8_t&                                 erab_id,
@@ -412,9 +412,11 @@ int tft_pdu_matcher::apply_traffic_flow_template(const uint8_t&
         auto                it = tft_filter_map.insert(std::make_pair(filter.eval_precedence, filter));
         if (it.second == false) {
           log->error("Error inserting TFT Packet Filter\n");
+          compile_filters();
           return SRSLTE_ERROR_CANT_START;
         }
       }
+      compile_filters();
       break;
     default:
       log->error("Unhandled TFT OP code\n");
@@ -428,4 +430,16 @@ void tft_pdu_matcher::set_default_lcid(const uint8_t lcid)
   default_lcid = lcid;
 }
 
+void tft_pdu_matcher::compile_filters()
+{
+  compiled_filters.clear();
+  for (std::pair<const uint16_t, tft_packet_filter_t>& filter_pair : tft_filter_map) {
+    // A filter without components never matches
+    if (filter_pair.second.active_filters != 0) {
+      compiled_filters.push_back(filter_pair.second);
+    }
+  }
+  has_filters = not compiled_filters.empty();
+}
+
 } // namespace srsue
@@ -51,7 +51,7 @@ ue::~ue()
   stack.reset();
 }
 
-int ue::init(const all_args_t& args_, srslte::logger* logger_)
+int ue::init(const all_args_t& args_, srslte::logger* logger_, radio_mux* shared_radio)
 {
   int ret = SRSLTE_SUCCESS;
   logger  = logger_;
@@ -87,7 +87,17 @@ int ue::init(const all_args_t& args_, srslte::logger* logger_)
       return SRSLTE_ERROR;
     }
 
-    std::unique_ptr<srslte::radio> lte_radio = std::unique_ptr<srslte::radio>(new srslte::radio(logger));
+    std::unique_ptr<srslte::radio_base> lte_radio;
+    srslte::radio_interface_phy*        lte_radio_phy = nullptr;
+    if (shared_radio != nullptr) {
+      std::unique_ptr<radio_mux::port> radio_port = shared_radio->create_port();
+      lte_radio_phy                               = radio_port.get();
+      lte_radio                                   = std::move(radio_port);
+    } else {
+      std::unique_ptr<srslte::radio> own_radio = std::unique_ptr<srslte::radio>(new srslte::radio(logger));
+      lte_radio_phy                            = own_radio.get();
+      lte_radio                                = std::move(own_radio);
+    }
     if (!lte_radio) {
       srslte::console("Error creating radio multi instance.\n");
       return SRSLTE_ERROR;
@@ -100,7 +110,7 @@ int ue::init(const all_args_t& args_, srslte::logger* logger_)
     }
 
     // from here onwards do not exit immediately if something goes wrong as sub-layers may already use interfaces
-    if (lte_phy->init(args.phy, lte_stack.get(), lte_radio.get())) {
+    if (lte_phy->init(args.phy, lte_stack.get(), lte_radio_phy)) {
       srslte::console("Error initializing PHY.\n");
       ret = SRSLTE_ERROR;
     }
@@ -102,6 +102,7 @@ private:
     }
     uint16_t get_dl_sched_rnti(uint32_t tti) override { return rnti; }
     uint16_t get_ul_sched_rnti(uint32_t tti) override { return rnti; }
+    bool     is_drx_active_time(uint32_t tti) override { return true; }
     void new_grant_ul(uint32_t cc_idx, mac_grant_ul_t grant, tb_action_ul_t* action) override { notify_new_grant_ul(); }
     void new_grant_dl(uint32_t cc_idx, mac_grant_dl_t grant, tb_action_dl_t* action) override
     {
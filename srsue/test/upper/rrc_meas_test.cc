@@ -152,7 +152,7 @@ public:
     });
   }
   void bcch_stop_rx() override {}
-  void pcch_start_rx() override {}
+  void pcch_start_rx(uint32_t paging_cycle, uint32_t pf_offset, uint32_t po_sf_idx) override {}
 
   void setup_lcid(uint32_t lcid, uint32_t lcg, uint32_t priority, int PBR_x_tti, uint32_t BSD) override {}
 
@@ -415,6 +415,57 @@ int tft_filter_test_ipv4_tos()
   return 0;
 }
 
+int tft_pdu_matcher_test()
+{
+  srslte::log_filter log1("TFT");
+  log1.set_level(srslte::LOG_LEVEL_DEBUG);
+  log1.set_hex_limit(128);
+
+  srslte::byte_buffer_pool*    pool = srslte::byte_buffer_pool::get_instance();
+  srslte::unique_byte_buffer_t ip_msg1, ip_msg2;
+  ip_msg1 = allocate_unique_buffer(*pool);
+  ip_msg2 = allocate_unique_buffer(*pool);
+
+  ip_msg1->N_bytes = ip_message_len1;
+  memcpy(ip_msg1->msg, ip_tst_message1, ip_message_len1);
+  ip_msg2->N_bytes = ip_message_len2;
+  memcpy(ip_msg2->msg, ip_tst_message2, ip_message_len2);
+
+  // Without TFT all packets go to the default bearer
+  srsue::tft_pdu_matcher matcher(&log1);
+  matcher.set_default_lcid(3);
+  TESTASSERT(matcher.check_tft_filter_match(ip_msg1) == 3);
+
+  // Single remote port 2001, the port of the first message
+  LIBLTE_MME_TRAFFIC_FLOW_TEMPLATE_STRUCT tft = {};
+  tft.tft_op_code                             = LIBLTE_MME_TFT_OPERATION_CODE_CREATE_NEW_TFT;
+  tft.packet_filter_list_size                 = 1;
+  tft.packet_filter_list[0].id                = 1;
+  tft.packet_filter_list[0].eval_precedence   = 2;
+  tft.packet_filter_list[0].filter_size       = 3;
+  tft.packet_filter_list[0].filter[0]         = SINGLE_REMOTE_PORT_TYPE;
+  srslte::uint16_to_uint8(2001, &tft.packet_filter_list[0].filter[1]);
+  TESTASSERT(matcher.apply_traffic_flow_template(6, 4, &tft) == SRSLTE_SUCCESS);
+
+  // A filter without components evaluated first, and the same port with a lower precedence
+  tft.packet_filter_list_size               = 2;
+  tft.packet_filter_list[1]                 = tft.packet_filter_list[0];
+  tft.packet_filter_list[1].eval_precedence = 3;
+  tft.packet_filter_list[0].eval_precedence = 1;
+  tft.packet_filter_list[0].filter_size     = 0;
+  TESTASSERT(matcher.apply_traffic_flow_template(7, 5, &tft) == SRSLTE_SUCCESS);
+
+  TESTASSERT(matcher.check_tft_filter_match(ip_msg1) == 4);
+  TESTASSERT(matcher.check_tft_filter_match(ip_msg2) == 3);
+
+  // Precedences are unique
+  TESTASSERT(matcher.apply_traffic_flow_template(8, 6, &tft) != SRSLTE_SUCCESS);
+  TESTASSERT(matcher.check_tft_filter_match(ip_msg1) == 4);
+
+  printf("Test TFT PDU matcher successfull\n");
+  return 0;
+}
+
 int main(int argc, char** argv)
 {
   srslte::byte_buffer_pool::get_instance();
@@ -436,5 +487,8 @@ int main(int argc, char** argv)
   if (tft_filter_test_ipv6_combined()) {
     return -1;
   }
+  if (tft_pdu_matcher_test()) {
+    return -1;
+  }
   srslte::byte_buffer_pool::cleanup();
 }
@@ -0,0 +1,98 @@
+#!/bin/bash
+
+#
+# Copyright 2013-2020 Software Radio Systems Limited
+#
+# This file is part of srsLTE
+#
+# srsLTE is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as
+# published by the Free Software Foundation, either version 3 of
+# the License, or (at your option) any later version.
+#
+# srsLTE is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# A copy of the GNU Affero General Public License can be found in
+# the LICENSE file in the top-level directory of this distribution
+# and at http://www.gnu.org/licenses/.
+#
+
+
+# Runs a benchmark, extracts a metric from its output and compares it with the baseline stored for the CPU of the
+# machine. The best value of several runs is kept to filter out the noise of the system. Exits with 77 (skipped)
+# when the CPU has no baseline, and records it instead when SRSLTE_PERF_UPDATE is set.
+
+print_use(){
+  echo "Please call script with the test name, baseline folder, metric regex (one capture group), lower|higher,"
+  echo "tolerance in percent, number of runs and the benchmark command"
+  echo "E.g. ./run_perf_test.sh [name] [baseline_dir] [metric] [lower|higher] [tolerance] [nof_runs] [command...]"
+  exit -1
+}
+
+if [ $# -lt 7 ]; then
+  print_use
+fi
+
+name=$1
+baseline_dir=$2
+metric=$3
+better=$4
+tolerance=$5
+nof_runs=$6
+shift 6
+
+# The baselines are per CPU model, SRSLTE_PERF_CPU overrides the name of the file
+cpu=$SRSLTE_PERF_CPU
+if [ -z "$cpu" ]; then
+  cpu=$(grep -m1 "model name" /proc/cpuinfo 2>/dev/null | cut -d: -f2)
+fi
+if [ -z "$cpu" ]; then
+  cpu=$(uname -m)
+fi
+cpu=$(echo "$cpu" | tr -c 'A-Za-z0-9' '_' | tr -s '_' | sed 's/^_//;s/_$//')
+baseline_file=$baseline_dir/$cpu.txt
+
+baseline=$(awk -v n="$name" '$1 == n {print $2}' "$baseline_file" 2>/dev/null)
+if [ -z "$baseline" ] && [ -z "$SRSLTE_PERF_UPDATE" ]; then
+  echo "No baseline of $name in $baseline_file, skipping. Run with SRSLTE_PERF_UPDATE=1 to record it"
+  exit 77
+fi
+
+best=""
+for i in $(seq $nof_runs); do
+  if ! output=$("$@" 2>&1); then
+    echo "$output"
+    echo "Benchmark of $name failed"
+    exit 1
+  fi
+  value=$(echo "$output" | sed -nE "s|.*${metric}.*|\1|p" | head -n1)
+  if [ -z "$value" ]; then
+    echo "$output"
+    echo "The output of $name has no metric matching '$metric'"
+    exit 1
+  fi
+  echo "Run $i of $name: $value"
+  best=$(awk -v b="$best" -v v="$value" -v d="$better" \
+    'BEGIN {print (b == "" || (d == "lower" && v < b) || (d == "higher" && v > b)) ? v : b}')
+done
+
+if [ -n "$SRSLTE_PERF_UPDATE" ]; then
+  mkdir -p "$baseline_dir"
+  { grep -v "^$name " "$baseline_file" 2>/dev/null; echo "$name $best"; } | sort > "$baseline_file.tmp"
+  mv "$baseline_file.tmp" "$baseline_file"
+  echo "Recorded the baseline of $name in $baseline_file: $best"
+  exit 0
+fi
+
+# Positive changes are regressions, whichever the direction of the metric
+change=$(awk -v b="$baseline" -v v="$best" -v d="$better" \
+  'BEGIN {c = 100 * (v - b) / b; printf "%.1f", (d == "lower") ? c : -c}')
+echo "$name on $cpu: $best, baseline $baseline, regression $change% (tolerance $tolerance%)"
+if awk -v c="$change" -v t="$tolerance" 'BEGIN {exit !(c > t)}'; then
+  echo "Performance regression of $name"
+  exit 1
+fi
+exit 0